@@ -17,6 +17,10 @@ layout(std140) uniform u_materialblock {
 	vec2 foobar4;
 };
 
+layout(std430, binding = 2) buffer u_drawdata {
+	vec4 u_draws[];
+};
+
 uniform mat4 u_viewprojection;
 uniform mat4 u_model;
 
@@ -11,10 +11,13 @@
 #include "io/Filesystem.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include "core/Metrics.h"
+#include "core/StringUtil.h"
 #include "core/Tokenizer.h"
 #include "core/concurrent/Concurrency.h"
 #include "util/VarUtil.h"
 #include <SDL.h>
+#include <inttypes.h>
 #include "engine-config.h"
 #ifdef HAVE_SYS_RESOURCE_H
 #include <sys/resource.h>
@@ -39,6 +42,8 @@ void App::runFrameEmscripten() {
 #endif
 
 static void catch_function(int signo) {
+	// don't lose the last lines that are still queued for the log thread
+	Log::flush();
 	core_stacktrace();
 	abort();
 }
@@ -238,7 +243,22 @@ AppState App::onConstruct() {
 	if (!logLevelVal.empty()) {
 		logVar->setVal(logLevelVal);
 	}
+	registerArg("--trace").setDescription("Record the trace scopes and write them as chrome trace json to the given file");
+	_traceFile = getArgVal("--trace");
+	if (!_traceFile.empty()) {
+#ifdef TRACY_ENABLE
+		Log::warn("The trace recorder is not available in tracy builds");
+		_traceFile = "";
+#else
+		_traceRecorder.start();
+		core_trace_set(&_traceRecorder);
+#endif
+	}
+	registerArg("--metrics").setDescription("Write the metrics to the given file - as json for a .json file, otherwise in the prometheus text format");
+	_metricsFile = getArgVal("--metrics");
 	core::Var::get(cfg::CoreSysLog, _syslog ? "true" : "false", "Log to the system log", core::Var::boolValidator);
+	core::Var::get(cfg::CoreLogAsync, "false", "Write the log lines on a background thread",
+				   core::Var::boolValidator);
 
 	Log::init();
 
@@ -260,6 +280,20 @@ AppState App::onConstruct() {
 		}
 	}).setHelp("Toggle application tracing via statsd");
 
+	if (core::memory::enabled()) {
+		for (int i = 0; i < (int)core::MemoryTag::Max; ++i) {
+			const char *tagName = core::memory::tagName((core::MemoryTag)i);
+			_memoryLive[i] = core::Var::get(core::string::format("core_memory_%s_live", tagName), "0",
+											core::CV_READONLY | core::CV_NOPERSIST, "Currently allocated bytes");
+			_memoryPeak[i] = core::Var::get(core::string::format("core_memory_%s_peak", tagName), "0",
+											core::CV_READONLY | core::CV_NOPERSIST, "Peak of the allocated bytes");
+		}
+		command::Command::registerCommand("core_memory", [this](const command::CmdArgs &args) {
+			updateMemoryVars();
+			logMemoryStats(true);
+		}).setHelp("Print the live and peak memory usage per subsystem");
+	}
+
 	AppCommand::init(_timeProvider);
 
 	for (int i = 0; i < _argc; ++i) {
@@ -299,8 +333,11 @@ AppState App::onConstruct() {
 #endif
 	}
 
-	if (!_filesystem->init(_organisation, _appname)) {
-		Log::warn("Failed to initialize the filesystem");
+	{
+		core_trace_scoped(AppInitFilesystem);
+		if (!_filesystem->init(_organisation, _appname)) {
+			Log::warn("Failed to initialize the filesystem");
+		}
 	}
 
 	const io::FilesystemPtr& fs = io::filesystem();
@@ -325,9 +362,11 @@ AppState App::onInit() {
 	Log::debug("Initialize sdl");
 	SDL_Init(SDL_INIT_TIMER|SDL_INIT_EVENTS);
 	Log::debug("Initialize the threadpool");
-	_threadPool->init();
+	// the workers are started with the first task - a lot of command line invocations don't need them at all
+	_threadPool->init(true);
 
 	Log::debug("Initialize the cvars");
+	core_trace_begin(AppLoadVars);
 	const io::FilePtr& varsFile = _filesystem->open(_appname + ".vars");
 	const core::String &content = varsFile->load();
 	core::Tokenizer t(content);
@@ -371,11 +410,13 @@ AppState App::onInit() {
 
 		core::Var::get(name, value.c_str(), flagsMask);
 	}
+	core_trace_end();
 
 	Log::debug("Initialize the log system");
 	Log::init();
 	_logLevelVar = core::Var::getSafe(cfg::CoreLogLevel);
 	_syslogVar = core::Var::getSafe(cfg::CoreSysLog);
+	_logAsyncVar = core::Var::getSafe(cfg::CoreLogAsync);
 
 	core::Var::needsSaving();
 	core::Var::visit([&] (const core::VarPtr& var) {
@@ -442,10 +483,11 @@ void App::onAfterInit() {
 	}
 
 	// we might have changed the loglevel from the commandline
-	if (_logLevelVar->isDirty() || _syslogVar->isDirty()) {
+	if (_logLevelVar->isDirty() || _syslogVar->isDirty() || _logAsyncVar->isDirty()) {
 		Log::init();
 		_logLevelVar->markClean();
 		_syslogVar->markClean();
+		_logAsyncVar->markClean();
 	}
 }
 
@@ -548,14 +590,25 @@ void App::onBeforeRunning() {
 }
 
 AppState App::onRunning() {
-	if (_logLevelVar->isDirty() || _syslogVar->isDirty()) {
+	if (_logLevelVar->isDirty() || _syslogVar->isDirty() || _logAsyncVar->isDirty()) {
 		Log::init();
 		_logLevelVar->markClean();
 		_syslogVar->markClean();
+		_logAsyncVar->markClean();
 	}
 
 	command::Command::update(_deltaFrameSeconds);
 
+	if (_nowSeconds >= _nextMemoryUpdateSeconds) {
+		updateMemoryVars();
+		_nextMemoryUpdateSeconds = _nowSeconds + 1.0;
+	}
+
+	if (!_metricsFile.empty() && _nowSeconds >= _nextMetricsWriteSeconds) {
+		writeMetrics();
+		_nextMetricsWriteSeconds = _nowSeconds + 5.0;
+	}
+
 	if (!_failedToSaveConfiguration && core::Var::needsSaving()) {
 		if (!saveConfiguration()) {
 			_failedToSaveConfiguration = true;
@@ -566,6 +619,100 @@ AppState App::onRunning() {
 	return AppState::Cleanup;
 }
 
+void App::updateMemoryVars() {
+	if (!core::memory::enabled()) {
+		return;
+	}
+	for (int i = 0; i < (int)core::MemoryTag::Max; ++i) {
+		if (!_memoryLive[i]) {
+			continue;
+		}
+		const core::MemoryStats stats = core::memory::stats((core::MemoryTag)i);
+		_memoryLive[i]->replaceVal(core::string::format("%" PRId64, stats.live));
+		_memoryPeak[i]->replaceVal(core::string::format("%" PRId64, stats.peak));
+	}
+}
+
+void App::logMemoryStats(bool info) const {
+	if (!core::memory::enabled()) {
+		if (info) {
+			Log::info("Memory tracking is not compiled in");
+		}
+		return;
+	}
+	for (int i = 0; i < (int)core::MemoryTag::Max; ++i) {
+		const core::MemoryStats stats = core::memory::stats((core::MemoryTag)i);
+		const core::String &live = core::string::humanSize(stats.live);
+		const core::String &peak = core::string::humanSize(stats.peak);
+		if (info) {
+			Log::info("%s: %s (peak: %s, allocations: %" PRId64 ")", core::memory::tagName((core::MemoryTag)i),
+					  live.c_str(), peak.c_str(), stats.allocations);
+		} else {
+			Log::debug("%s: %s (peak: %s, allocations: %" PRId64 ")", core::memory::tagName((core::MemoryTag)i),
+					   live.c_str(), peak.c_str(), stats.allocations);
+		}
+	}
+}
+
+void App::updateMetrics() {
+	static core::Gauge &threads = core::metrics::gauge("threadpool_threads", "The worker threads of the thread pool");
+	static core::Gauge &pending =
+		core::metrics::gauge("threadpool_pending_tasks", "The queued tasks of the thread pool that wait for a worker");
+	static core::Gauge &running = core::metrics::gauge("threadpool_running_tasks", "The tasks that are executed");
+	static core::Gauge &utilization =
+		core::metrics::gauge("threadpool_utilization", "The running tasks relative to the worker threads");
+	const int workers = (int)_threadPool->size();
+	const int runningTasks = _threadPool->runningTasks();
+	threads.set(workers);
+	pending.set(_threadPool->pendingTasks());
+	running.set(runningTasks);
+	utilization.set(workers > 0 ? (double)runningTasks / (double)workers : 0.0);
+
+	if (!core::memory::enabled()) {
+		return;
+	}
+	for (int i = 0; i < (int)core::MemoryTag::Max; ++i) {
+		const char *tagName = core::memory::tagName((core::MemoryTag)i);
+		const core::MemoryStats stats = core::memory::stats((core::MemoryTag)i);
+		core::metrics::gauge(core::string::format("memory_live_bytes{tag=\"%s\"}", tagName),
+							 "Currently allocated bytes per subsystem")
+			.set((double)stats.live);
+		core::metrics::gauge(core::string::format("memory_peak_bytes{tag=\"%s\"}", tagName),
+							 "Peak of the allocated bytes per subsystem")
+			.set((double)stats.peak);
+	}
+}
+
+void App::writeMetrics() {
+	if (_metricsFile.empty()) {
+		return;
+	}
+	updateMetrics();
+	const bool json = core::string::extractExtension(_metricsFile) == "json";
+	const core::String &content = json ? core::metrics::toJSON() : core::metrics::toPrometheus();
+	// collectors like the textfile collector of the node exporter must never see a partially written file
+	const core::String tmpFile = _metricsFile + ".tmp";
+	if (!_filesystem->syswrite(tmpFile, content) || !_filesystem->rename(tmpFile, _metricsFile)) {
+		Log::warn("Failed to write the metrics to %s", _metricsFile.c_str());
+	}
+}
+
+void App::writeTrace() {
+	if (_traceFile.empty()) {
+		return;
+	}
+	_traceRecorder.stop();
+	if (core_trace_set(nullptr) != &_traceRecorder) {
+		Log::warn("The trace callback was replaced while recording");
+	}
+	if (_filesystem->syswrite(_traceFile, _traceRecorder.toChromeJSON())) {
+		Log::info("Wrote %i trace events to %s", (int)_traceRecorder.events(), _traceFile.c_str());
+	} else {
+		Log::error("Failed to write the trace to %s", _traceFile.c_str());
+	}
+	_traceFile = "";
+}
+
 bool App::hasArg(const core::String& arg) const {
 	for (int i = 1; i < _argc; ++i) {
 		if (arg == _argv[i]) {
@@ -681,8 +828,16 @@ AppState App::onCleanup() {
 
 	saveConfiguration();
 
+	writeMetrics();
 	_threadPool->shutdown();
 
+	writeTrace();
+	logMemoryStats(false);
+	for (int i = 0; i < (int)core::MemoryTag::Max; ++i) {
+		_memoryLive[i] = core::VarPtr();
+		_memoryPeak[i] = core::VarPtr();
+	}
+
 	command::Command::shutdown();
 	core::Var::shutdown();
 
@@ -5,7 +5,9 @@
 #pragma once
 
 #include "core/Common.h"
+#include "core/Memory.h"
 #include "core/Trace.h"
+#include "core/TraceRecorder.h"
 #include "core/String.h"
 #include "core/collection/DynamicArray.h"
 #include "core/SharedPtr.h"
@@ -106,8 +108,42 @@ protected:
 	core::TimeProviderPtr _timeProvider;
 	core::VarPtr _logLevelVar;
 	core::VarPtr _syslogVar;
+	core::VarPtr _logAsyncVar;
+	core::VarPtr _memoryLive[(int)core::MemoryTag::Max];
+	core::VarPtr _memoryPeak[(int)core::MemoryTag::Max];
+	double _nextMemoryUpdateSeconds = 0.0;
+	/**
+	 * @brief Records the trace scopes if the application was started with @c --trace
+	 */
+	core::TraceRecorder _traceRecorder;
+	core::String _traceFile;
+	/**
+	 * @brief The file the metrics are written to if the application was started with @c --metrics
+	 */
+	core::String _metricsFile;
+	double _nextMetricsWriteSeconds = 0.0;
 
 	bool toggleTrace();
+	/**
+	 * @brief Publishes the live and peak bytes of the tracking allocator per tag in the @c core_memory_ vars
+	 */
+	void updateMemoryVars();
+	void logMemoryStats(bool info) const;
+	/**
+	 * @brief Stops the recording of the trace scopes and writes them to the file given by @c --trace
+	 */
+	void writeTrace();
+	/**
+	 * @brief Samples the thread pool and the memory usage per subsystem into their gauges
+	 */
+	void updateMetrics();
+	/**
+	 * @brief Writes the metrics to the file given by @c --metrics - as json for a @c .json file, otherwise in the
+	 * prometheus text format. This is done every few seconds while the application is running and on shutdown -
+	 * applications that block in a long running frame can call it after each job.
+	 * @sa core::metrics::toPrometheus()
+	 */
+	void writeMetrics();
 
 	virtual void traceBeginFrame(const char *threadName) override;
 	virtual void traceBegin(const char *threadName, const char* name) override;
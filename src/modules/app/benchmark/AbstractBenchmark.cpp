@@ -9,9 +9,146 @@
 #include "io/Filesystem.h"
 
 #include <SDL.h>
+#include <stdio.h>
+
+#if defined(__LINUX__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#elif defined(__MACOSX__)
+#include <sys/resource.h>
+#elif defined(__WINDOWS__)
+#include <windows.h>
+#include <psapi.h>
+#endif
 
 namespace app {
 
+#if defined(__LINUX__)
+static int openPerfEvent(uint64_t config) {
+	struct perf_event_attr attr;
+	core_memset(&attr, 0, sizeof(attr));
+	attr.type = PERF_TYPE_HARDWARE;
+	attr.size = sizeof(attr);
+	attr.config = config;
+	attr.disabled = 1;
+	// also count the threads that are started by the benchmark
+	attr.inherit = 1;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	return (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+/**
+ * @brief Resets the peak resident memory to the current value - if the platform supports it
+ */
+static void resetPeakResidentMemory() {
+#if defined(__LINUX__)
+	if (FILE *f = fopen("/proc/self/clear_refs", "w")) {
+		fputs("5", f);
+		fclose(f);
+	}
+#endif
+}
+
+/**
+ * @return The peak resident memory of the process in bytes or @c -1 if it is not available
+ */
+static int64_t peakResidentMemory() {
+#if defined(__LINUX__)
+	FILE *f = fopen("/proc/self/status", "r");
+	if (f == nullptr) {
+		return -1;
+	}
+	char line[256];
+	int64_t kb = -1;
+	while (fgets(line, sizeof(line), f) != nullptr) {
+		if (SDL_sscanf(line, "VmHWM: %" SDL_PRIs64 " kB", &kb) == 1) {
+			break;
+		}
+	}
+	fclose(f);
+	return kb < 0 ? -1 : kb * 1024;
+#elif defined(__MACOSX__)
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) {
+		return -1;
+	}
+	// bytes on macOS
+	return (int64_t)usage.ru_maxrss;
+#elif defined(__WINDOWS__)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+		return -1;
+	}
+	return (int64_t)counters.PeakWorkingSetSize;
+#else
+	return -1;
+#endif
+}
+
+void AbstractBenchmark::Run(benchmark::State& st) {
+	SetUp(st);
+	startCounters();
+	BenchmarkCase(st);
+	stopCounters(st);
+	TearDown(st);
+}
+
+void AbstractBenchmark::startCounters() {
+#if defined(__LINUX__)
+	const uint64_t configs[MaxPerfEvents] = {PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_CACHE_MISSES,
+											 PERF_COUNT_HW_BRANCH_MISSES};
+	for (int i = 0; i < MaxPerfEvents; ++i) {
+		// fails if the kernel doesn't allow it (see /proc/sys/kernel/perf_event_paranoid) or in virtual machines
+		_perfEvents[i] = openPerfEvent(configs[i]);
+	}
+#endif
+	resetPeakResidentMemory();
+	_memoryBefore = core::memory::totalStats();
+#if defined(__LINUX__)
+	for (int i = 0; i < MaxPerfEvents; ++i) {
+		if (_perfEvents[i] != -1) {
+			ioctl(_perfEvents[i], PERF_EVENT_IOC_RESET, 0);
+			ioctl(_perfEvents[i], PERF_EVENT_IOC_ENABLE, 0);
+		}
+	}
+#endif
+}
+
+void AbstractBenchmark::stopCounters(benchmark::State& st) {
+#if defined(__LINUX__)
+	static const char *perfEventNames[MaxPerfEvents] = {"cycles", "cachemisses", "branchmisses"};
+	for (int i = 0; i < MaxPerfEvents; ++i) {
+		if (_perfEvents[i] == -1) {
+			continue;
+		}
+		ioctl(_perfEvents[i], PERF_EVENT_IOC_DISABLE, 0);
+		uint64_t value = 0;
+		if (::read(_perfEvents[i], &value, sizeof(value)) == (ssize_t)sizeof(value)) {
+			st.counters[perfEventNames[i]] = benchmark::Counter((double)value, benchmark::Counter::kAvgIterations);
+		}
+		::close(_perfEvents[i]);
+		_perfEvents[i] = -1;
+	}
+#endif
+	if (core::memory::enabled()) {
+		const core::MemoryStats &memoryAfter = core::memory::totalStats();
+		st.counters["allocs"] = benchmark::Counter((double)(memoryAfter.allocations - _memoryBefore.allocations),
+												   benchmark::Counter::kAvgIterations);
+		st.counters["allocbytes"] =
+			benchmark::Counter((double)(memoryAfter.allocatedBytes - _memoryBefore.allocatedBytes),
+							   benchmark::Counter::kAvgIterations, benchmark::Counter::kIs1024);
+	}
+	const int64_t peakRSS = peakResidentMemory();
+	if (peakRSS >= 0) {
+		st.counters["peakrss"] =
+			benchmark::Counter((double)peakRSS, benchmark::Counter::kDefaults, benchmark::Counter::kIs1024);
+	}
+}
+
 SDL_AssertState Test_AssertionHandler(const SDL_AssertData* data, void* userdata) {
 	return SDL_ASSERTION_BREAK;
 }
@@ -7,6 +7,7 @@
 #include <benchmark/benchmark.h>
 #include "app/CommandlineApp.h"
 #include "io/Filesystem.h"
+#include "core/Memory.h"
 #include "core/TimeProvider.h"
 
 namespace app {
@@ -26,6 +27,20 @@ private:
 		virtual app::AppState onCleanup() override;
 	};
 
+	enum PerfEvent { Cycles, CacheMisses, BranchMisses, MaxPerfEvents };
+	/**
+	 * @brief The file descriptors of the hardware counters or @c -1 if they are not available
+	 */
+	int _perfEvents[MaxPerfEvents]{-1, -1, -1};
+	core::MemoryStats _memoryBefore;
+
+	void startCounters();
+	/**
+	 * @brief Reports the allocations per iteration, the peak resident memory and the hardware counters (linux
+	 * only, if the kernel allows it) as user counters
+	 */
+	void stopCounters(benchmark::State &st);
+
 protected:
 	BenchmarkApp *_benchmarkApp = nullptr;
 
@@ -37,6 +52,12 @@ protected:
 	}
 
 public:
+	/**
+	 * @brief Samples the counters around the benchmark loop only - the allocations of @c SetUp() and
+	 * @c TearDown() are not part of the counters
+	 */
+	void Run(benchmark::State& st) override;
+
 	virtual void SetUp(benchmark::State& st) override;
 
 	virtual void TearDown(benchmark::State& st) override;
@@ -24,7 +24,7 @@ ActionButtonCommands& ActionButtonCommands::setHelp(const char* help) {
 }
 
 Command& Command::registerCommand(const char* name, FunctionType&& func) {
-	const core::String cname(name);
+	const core::Name cname(name);
 	const Command c(cname, std::forward<FunctionType>(func));
 	core::ScopedWriteLock lock(_lock);
 	_cmds.put(cname, c);
@@ -33,7 +33,7 @@ Command& Command::registerCommand(const char* name, FunctionType&& func) {
 }
 
 bool Command::unregisterCommand(const char* name) {
-	const core::String cname(name);
+	const core::Name cname(name);
 	core::ScopedWriteLock lock(_lock);
 	const bool removed = _cmds.remove(cname);
 	if (removed) {
@@ -64,8 +64,8 @@ ActionButtonCommands Command::registerActionButton(const core::String& name, Act
 
 bool Command::unregisterActionButton(const core::String& name) {
 	core::ScopedWriteLock lock(_lock);
-	const core::String downB(COMMAND_PRESSED + name);
-	const core::String upB(COMMAND_RELEASED + name);
+	const core::Name downB(COMMAND_PRESSED + name);
+	const core::Name upB(COMMAND_RELEASED + name);
 	int amount = _cmds.remove(downB);
 	amount += _cmds.remove(upB);
 	updateSortedList();
@@ -182,7 +182,7 @@ bool Command::execute(const core::String& command, const CmdArgs& args) {
 	Command cmd;
 	{
 		core::ScopedReadLock scoped(_lock);
-		auto i = _cmds.find(command);
+		auto i = _cmds.find(core::Name::find(command));
 		if (i == _cmds.end()) {
 			Log::debug("could not find command callback for %s", command.c_str());
 			return false;
@@ -6,6 +6,7 @@
 
 #include "core/String.h"
 #include "core/Common.h"
+#include "core/Name.h"
 #include "core/StringUtil.h"
 #include "core/collection/StringMap.h"
 #include "core/collection/DynamicArray.h"
@@ -36,7 +37,7 @@ struct ActionButtonCommands {
  */
 class Command {
 private:
-	typedef core::StringMap<Command> CommandMap;
+	typedef core::NameMap<Command> CommandMap;
 	typedef std::function<void(const CmdArgs&)> FunctionType;
 
 	static CommandMap _cmds core_thread_guarded_by(_lock);
@@ -47,14 +48,14 @@ private:
 	static double _delaySeconds;
 	static core::DynamicArray<core::String> _delayedTokens;
 
-	core::String _name;
+	core::Name _name;
 	const char* _help;
 	FunctionType _func;
 	typedef std::function<int(const core::String&, core::DynamicArray<core::String>& matches)> CompleteFunctionType;
 	mutable CompleteFunctionType _completer;
 
 	Command() :
-		_name(""), _help(nullptr), _func() {
+		_help(nullptr), _func() {
 	}
 
 	Command(const core::String& name, FunctionType&& func) :
@@ -96,8 +97,13 @@ public:
 	static bool execute(const core::String& command, const CmdArgs& args);
 
 	static Command* getCommand(const core::String& name) {
+		// don't intern unknown names
+		const core::Name n = core::Name::find(name);
+		if (n.empty()) {
+			return nullptr;
+		}
 		core::ScopedReadLock lock(_lock);
-		auto i = _cmds.find(name);
+		auto i = _cmds.find(n);
 		if (i == _cmds.end()) {
 			return nullptr;
 		}
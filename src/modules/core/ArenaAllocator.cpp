@@ -0,0 +1,113 @@
+/**
+ * @file
+ */
+
+#include "ArenaAllocator.h"
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+
+namespace core {
+
+ArenaAllocator::ArenaAllocator(size_t blockSize) : _blockSize(blockSize) {
+}
+
+ArenaAllocator::~ArenaAllocator() {
+	release();
+}
+
+ArenaAllocator::Block *ArenaAllocator::allocBlock(size_t capacity) {
+	Block *block = (Block *)core_malloc(HeaderSize + capacity);
+	if (block == nullptr) {
+		return nullptr;
+	}
+	block->next = nullptr;
+	block->capacity = capacity;
+	block->used = 0u;
+	_capacity += capacity;
+	return block;
+}
+
+void *ArenaAllocator::alloc(size_t size, size_t alignment) {
+	core_assert_msg((alignment & (alignment - 1)) == 0, "Alignment must be a power of two");
+	if (size == 0u) {
+		return nullptr;
+	}
+	if (_blocks != nullptr) {
+		uint8_t *data = (uint8_t *)_blocks + HeaderSize;
+		const uintptr_t start = ((uintptr_t)(data + _blocks->used) + (alignment - 1)) & ~(uintptr_t)(alignment - 1);
+		const size_t end = (size_t)(start - (uintptr_t)data) + size;
+		if (end <= _blocks->capacity) {
+			_blocks->used = end;
+			_used += size;
+			_peak = core_max(_peak, _used);
+			_last = (void *)start;
+			return _last;
+		}
+	}
+	// the block data is 16 byte aligned - bigger alignments need some padding
+	const size_t padding = alignment > 16u ? alignment : 0u;
+	Block *block = allocBlock(core_max(_blockSize, size + padding));
+	if (block == nullptr) {
+		return nullptr;
+	}
+	block->next = _blocks;
+	_blocks = block;
+	return alloc(size, alignment);
+}
+
+void *ArenaAllocator::realloc(void *ptr, size_t oldSize, size_t newSize, size_t alignment) {
+	if (ptr == nullptr) {
+		return alloc(newSize, alignment);
+	}
+	if (newSize <= oldSize) {
+		return ptr;
+	}
+	if (ptr == _last) {
+		const size_t offset = (size_t)((uint8_t *)ptr - ((uint8_t *)_blocks + HeaderSize));
+		if (offset + newSize <= _blocks->capacity) {
+			_blocks->used = offset + newSize;
+			_used += newSize - oldSize;
+			_peak = core_max(_peak, _used);
+			return ptr;
+		}
+	}
+	void *newPtr = alloc(newSize, alignment);
+	if (newPtr != nullptr) {
+		core_memcpy(newPtr, ptr, oldSize);
+	}
+	return newPtr;
+}
+
+void ArenaAllocator::reset() {
+	if (_blocks == nullptr) {
+		return;
+	}
+	// keep the oldest block - it's of the configured block size or was allocated for a bigger request
+	Block *keep = _blocks;
+	while (keep->next != nullptr) {
+		Block *next = keep->next;
+		_capacity -= keep->capacity;
+		core_free(keep);
+		keep = next;
+	}
+	keep->used = 0u;
+	_blocks = keep;
+	_last = nullptr;
+	_used = 0u;
+}
+
+void ArenaAllocator::release() {
+	Block *block = _blocks;
+	while (block != nullptr) {
+		Block *next = block->next;
+		core_free(block);
+		block = next;
+	}
+	_blocks = nullptr;
+	_last = nullptr;
+	_used = 0u;
+	_capacity = 0u;
+}
+
+} // namespace core
@@ -0,0 +1,102 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief Linear allocator for short living allocations that are all released at once
+ *
+ * The memory is handed out of larger blocks by just bumping a pointer. Single allocations can't get freed - the
+ * memory of all of them is given back with reset() or release(). This is meant for transient data like the
+ * temporary buffers of a parser that don't survive the load of a file.
+ *
+ * @note Destructors of objects that are placed in the arena are not called.
+ */
+class ArenaAllocator : public core::NonCopyable {
+private:
+	struct Block {
+		Block *next;
+		size_t capacity;
+		size_t used;
+	};
+	static constexpr size_t HeaderSize = (sizeof(Block) + 15u) & ~(size_t)15u;
+
+	Block *_blocks = nullptr;
+	size_t _blockSize;
+	/**
+	 * @brief The last allocation of the current block - this one can grow in place
+	 */
+	void *_last = nullptr;
+	size_t _used = 0u;
+	size_t _capacity = 0u;
+	size_t _peak = 0u;
+
+	Block *allocBlock(size_t capacity);
+
+public:
+	/**
+	 * @param blockSize The size of the blocks the allocations are taken from - bigger allocations get their own
+	 * block
+	 */
+	ArenaAllocator(size_t blockSize = 64u * 1024u);
+	~ArenaAllocator();
+
+	/**
+	 * @param alignment Must be a power of two
+	 * @return @c nullptr if the size is @c 0 or the block could not get allocated
+	 */
+	void *alloc(size_t size, size_t alignment = 16u);
+	/**
+	 * @brief Grows the last allocation in place if possible - otherwise the memory is copied into a new allocation
+	 * @note The arena doesn't track the size of the allocations - the caller has to provide it
+	 */
+	void *realloc(void *ptr, size_t oldSize, size_t newSize, size_t alignment = 16u);
+	/**
+	 * @brief No-op - the memory is given back with reset() or release()
+	 */
+	inline void free(void *) {
+	}
+
+	/**
+	 * @brief Invalidates all allocations but keeps the first block for the next usage
+	 */
+	void reset();
+	/**
+	 * @brief Invalidates all allocations and frees all blocks
+	 */
+	void release();
+
+	/**
+	 * @return The amount of bytes that were handed out since the last reset()
+	 */
+	size_t used() const;
+	/**
+	 * @return The size of all allocated blocks
+	 */
+	size_t capacity() const;
+	/**
+	 * @return The highest value of used() since the construction
+	 */
+	size_t peak() const;
+};
+
+inline size_t ArenaAllocator::used() const {
+	return _used;
+}
+
+inline size_t ArenaAllocator::capacity() const {
+	return _capacity;
+}
+
+inline size_t ArenaAllocator::peak() const {
+	return _peak;
+}
+
+} // namespace core
@@ -6,6 +6,9 @@
 
 #include "core/String.h"
 #include <stdint.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace core {
 
@@ -26,4 +29,28 @@ core::String toBitString(TYPE val) {
 	return str;
 }
 
+/**
+ * @return The amount of trailing zero bits - the result is undefined for @c 0
+ */
+inline int countTrailingZeros(uint64_t x) {
+#ifdef _MSC_VER
+	unsigned long idx;
+	_BitScanForward64(&idx, x);
+	return (int)idx;
+#else
+	return __builtin_ctzll(x);
+#endif
+}
+
+/**
+ * @return The amount of set bits
+ */
+inline int countBits(uint64_t x) {
+#ifdef _MSC_VER
+	return (int)__popcnt64(x);
+#else
+	return __builtin_popcountll(x);
+#endif
+}
+
 } // namespace core
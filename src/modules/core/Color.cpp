@@ -13,6 +13,7 @@
 #include "core/StringUtil.h"
 #include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/HashMap.h"
 #include "math/Octree.h"
 #include <glm/glm.hpp>
 #include <glm/gtc/constants.hpp>
@@ -256,174 +257,421 @@ static int quantizeOctree(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA
 	return (int)n;
 }
 
-static inline float getDistance(const glm::vec4 &p1, const glm::vec4 &p2) {
-	return glm::length(p1 - p2);
+namespace wu {
+
+/**
+ * @brief The histogram uses 5 bits per channel - the first entry of each axis stays empty to simplify the
+ * cumulative moment lookups
+ */
+static constexpr int HistSize = 33;
+
+static inline int index(int r, int g, int b) {
+	return (r * HistSize + g) * HistSize + b;
+}
+
+struct Moments {
+	core::DynamicArray<int64_t> wt;
+	core::DynamicArray<int64_t> mr;
+	core::DynamicArray<int64_t> mg;
+	core::DynamicArray<int64_t> mb;
+	core::DynamicArray<int64_t> ma;
+	core::DynamicArray<double> m2;
+
+	Moments() {
+		const size_t n = HistSize * HistSize * HistSize;
+		wt.resize(n);
+		mr.resize(n);
+		mg.resize(n);
+		mb.resize(n);
+		ma.resize(n);
+		m2.resize(n);
+		wt.fill(0);
+		mr.fill(0);
+		mg.fill(0);
+		mb.fill(0);
+		ma.fill(0);
+		m2.fill(0.0);
+	}
+};
+
+struct Box {
+	// the lower bounds are exclusive, the upper bounds inclusive
+	int r0 = 0, r1 = 0;
+	int g0 = 0, g1 = 0;
+	int b0 = 0, b1 = 0;
+	int vol = 0;
+};
+
+enum class Axis { Red, Green, Blue };
+
+template<typename T>
+static T volume(const Box &c, const core::DynamicArray<T> &m) {
+	return m[index(c.r1, c.g1, c.b1)] - m[index(c.r1, c.g1, c.b0)] - m[index(c.r1, c.g0, c.b1)] +
+		   m[index(c.r1, c.g0, c.b0)] - m[index(c.r0, c.g1, c.b1)] + m[index(c.r0, c.g1, c.b0)] +
+		   m[index(c.r0, c.g0, c.b1)] - m[index(c.r0, c.g0, c.b0)];
 }
 
-static int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
-	core::DynamicArray<glm::vec4> centers;
-	centers.resize(maxTargetBufColors);
-	std::random_device rd;
-	std::mt19937 gen(rd());
-	std::uniform_int_distribution<> dis(0, (int)inputBufColors - 1);
-	for (int i = 0; i < (int)maxTargetBufColors; i++) {
-		centers[i] = core::Color::fromRGBA(inputBuf[dis(gen)]);
-	}
-
-	bool changed = true;
-	while (changed) {
-		changed = false;
-		core::DynamicArray<core::DynamicArray<glm::vec4>> clusters(maxTargetBufColors);
-		for (size_t i = 0; i < inputBufColors; ++i) {
-			const glm::vec4 point = core::Color::fromRGBA(inputBuf[i]);
-			int closest = 0;
-			float closestDistance = getDistance(point, centers[0]);
-			for (int i = 1; i < (int)maxTargetBufColors; i++) {
-				float d = getDistance(point, centers[i]);
-				if (d < closestDistance) {
-					closest = i;
-					closestDistance = d;
-				}
-			}
-			clusters[closest].push_back(point);
+static int64_t bottom(const Box &c, Axis axis, const core::DynamicArray<int64_t> &m) {
+	switch (axis) {
+	case Axis::Red:
+		return -m[index(c.r0, c.g1, c.b1)] + m[index(c.r0, c.g1, c.b0)] + m[index(c.r0, c.g0, c.b1)] -
+			   m[index(c.r0, c.g0, c.b0)];
+	case Axis::Green:
+		return -m[index(c.r1, c.g0, c.b1)] + m[index(c.r1, c.g0, c.b0)] + m[index(c.r0, c.g0, c.b1)] -
+			   m[index(c.r0, c.g0, c.b0)];
+	case Axis::Blue:
+	default:
+		return -m[index(c.r1, c.g1, c.b0)] + m[index(c.r1, c.g0, c.b0)] + m[index(c.r0, c.g1, c.b0)] -
+			   m[index(c.r0, c.g0, c.b0)];
+	}
+}
+
+static int64_t top(const Box &c, Axis axis, int pos, const core::DynamicArray<int64_t> &m) {
+	switch (axis) {
+	case Axis::Red:
+		return m[index(pos, c.g1, c.b1)] - m[index(pos, c.g1, c.b0)] - m[index(pos, c.g0, c.b1)] +
+			   m[index(pos, c.g0, c.b0)];
+	case Axis::Green:
+		return m[index(c.r1, pos, c.b1)] - m[index(c.r1, pos, c.b0)] - m[index(c.r0, pos, c.b1)] +
+			   m[index(c.r0, pos, c.b0)];
+	case Axis::Blue:
+	default:
+		return m[index(c.r1, c.g1, pos)] - m[index(c.r1, c.g0, pos)] - m[index(c.r0, c.g1, pos)] +
+			   m[index(c.r0, c.g0, pos)];
+	}
+}
+
+/**
+ * @brief The weighted variance of the colors in the box
+ */
+static double variance(const Box &c, const Moments &m) {
+	const double dr = (double)volume(c, m.mr);
+	const double dg = (double)volume(c, m.mg);
+	const double db = (double)volume(c, m.mb);
+	const double xx = volume(c, m.m2);
+	return xx - (dr * dr + dg * dg + db * db) / (double)volume(c, m.wt);
+}
+
+/**
+ * @brief Find the cut position on the given axis that minimizes the sum of the variances of both halves
+ */
+static double maximize(const Box &c, Axis axis, int first, int last, int &cut, int64_t wholeR, int64_t wholeG,
+					   int64_t wholeB, int64_t wholeW, const Moments &m) {
+	const int64_t baseR = bottom(c, axis, m.mr);
+	const int64_t baseG = bottom(c, axis, m.mg);
+	const int64_t baseB = bottom(c, axis, m.mb);
+	const int64_t baseW = bottom(c, axis, m.wt);
+	double max = 0.0;
+	cut = -1;
+	for (int i = first; i < last; ++i) {
+		int64_t halfR = baseR + top(c, axis, i, m.mr);
+		int64_t halfG = baseG + top(c, axis, i, m.mg);
+		int64_t halfB = baseB + top(c, axis, i, m.mb);
+		int64_t halfW = baseW + top(c, axis, i, m.wt);
+		if (halfW == 0) {
+			continue;
 		}
-		for (int i = 0; i < (int)maxTargetBufColors; i++) {
-			if (clusters[i].empty()) {
-				continue;
-			}
-			glm::vec4 newCenter(0.0f);
-			for (const glm::vec4 &point : clusters[i]) {
-				newCenter += point;
+		double temp = ((double)halfR * halfR + (double)halfG * halfG + (double)halfB * halfB) / (double)halfW;
+		halfR = wholeR - halfR;
+		halfG = wholeG - halfG;
+		halfB = wholeB - halfB;
+		halfW = wholeW - halfW;
+		if (halfW == 0) {
+			continue;
+		}
+		temp += ((double)halfR * halfR + (double)halfG * halfG + (double)halfB * halfB) / (double)halfW;
+		if (temp > max) {
+			max = temp;
+			cut = i;
+		}
+	}
+	return max;
+}
+
+static bool cut(Box &set1, Box &set2, const Moments &m) {
+	const int64_t wholeR = volume(set1, m.mr);
+	const int64_t wholeG = volume(set1, m.mg);
+	const int64_t wholeB = volume(set1, m.mb);
+	const int64_t wholeW = volume(set1, m.wt);
+
+	int cutR, cutG, cutB;
+	const double maxR = maximize(set1, Axis::Red, set1.r0 + 1, set1.r1, cutR, wholeR, wholeG, wholeB, wholeW, m);
+	const double maxG = maximize(set1, Axis::Green, set1.g0 + 1, set1.g1, cutG, wholeR, wholeG, wholeB, wholeW, m);
+	const double maxB = maximize(set1, Axis::Blue, set1.b0 + 1, set1.b1, cutB, wholeR, wholeG, wholeB, wholeW, m);
+
+	Axis axis;
+	if (maxR >= maxG && maxR >= maxB) {
+		axis = Axis::Red;
+		if (cutR < 0) {
+			// the box can't be split
+			return false;
+		}
+	} else if (maxG >= maxR && maxG >= maxB) {
+		axis = Axis::Green;
+	} else {
+		axis = Axis::Blue;
+	}
+
+	set2.r1 = set1.r1;
+	set2.g1 = set1.g1;
+	set2.b1 = set1.b1;
+
+	switch (axis) {
+	case Axis::Red:
+		set2.r0 = set1.r1 = cutR;
+		set2.g0 = set1.g0;
+		set2.b0 = set1.b0;
+		break;
+	case Axis::Green:
+		set2.g0 = set1.g1 = cutG;
+		set2.r0 = set1.r0;
+		set2.b0 = set1.b0;
+		break;
+	case Axis::Blue:
+		set2.b0 = set1.b1 = cutB;
+		set2.r0 = set1.r0;
+		set2.g0 = set1.g0;
+		break;
+	}
+	set1.vol = (set1.r1 - set1.r0) * (set1.g1 - set1.g0) * (set1.b1 - set1.b0);
+	set2.vol = (set2.r1 - set2.r0) * (set2.g1 - set2.g0) * (set2.b1 - set2.b0);
+	return true;
+}
+
+static void buildMoments(const RGBA *inputBuf, size_t inputBufColors, Moments &m) {
+	for (size_t i = 0; i < inputBufColors; ++i) {
+		const RGBA c = inputBuf[i];
+		const int idx = index((c.r >> 3) + 1, (c.g >> 3) + 1, (c.b >> 3) + 1);
+		m.wt[idx]++;
+		m.mr[idx] += c.r;
+		m.mg[idx] += c.g;
+		m.mb[idx] += c.b;
+		m.ma[idx] += c.a;
+		m.m2[idx] += (double)(c.r * c.r + c.g * c.g + c.b * c.b);
+	}
+
+	// convert the histogram into cumulative moments - this allows to compute the moments of any box with 8 lookups
+	int64_t areaW[HistSize], areaR[HistSize], areaG[HistSize], areaB[HistSize], areaA[HistSize];
+	double area2[HistSize];
+	for (int r = 1; r < HistSize; ++r) {
+		for (int i = 0; i < HistSize; ++i) {
+			areaW[i] = areaR[i] = areaG[i] = areaB[i] = areaA[i] = 0;
+			area2[i] = 0.0;
+		}
+		for (int g = 1; g < HistSize; ++g) {
+			int64_t lineW = 0, lineR = 0, lineG = 0, lineB = 0, lineA = 0;
+			double line2 = 0.0;
+			for (int b = 1; b < HistSize; ++b) {
+				const int idx = index(r, g, b);
+				const int prev = index(r - 1, g, b);
+				lineW += m.wt[idx];
+				lineR += m.mr[idx];
+				lineG += m.mg[idx];
+				lineB += m.mb[idx];
+				lineA += m.ma[idx];
+				line2 += m.m2[idx];
+				areaW[b] += lineW;
+				areaR[b] += lineR;
+				areaG[b] += lineG;
+				areaB[b] += lineB;
+				areaA[b] += lineA;
+				area2[b] += line2;
+				m.wt[idx] = m.wt[prev] + areaW[b];
+				m.mr[idx] = m.mr[prev] + areaR[b];
+				m.mg[idx] = m.mg[prev] + areaG[b];
+				m.mb[idx] = m.mb[prev] + areaB[b];
+				m.ma[idx] = m.ma[prev] + areaA[b];
+				m.m2[idx] = m.m2[prev] + area2[b];
 			}
-			newCenter /= clusters[i].size();
-			if (getDistance(newCenter, centers[i]) > 0.0001f) {
-				centers[i] = newCenter;
-				changed = true;
+		}
+	}
+}
+
+} // namespace wu
+
+/**
+ * @brief Xiaolin Wu's color quantizer
+ *
+ * Works on a 32x32x32 color histogram instead of the input colors - the boxes with the largest variance are split
+ * at the position that minimizes the sum of the variances. The costs are linear in the amount of input colors.
+ */
+static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
+	wu::Moments moments;
+	wu::buildMoments(inputBuf, inputBufColors, moments);
+
+	core::DynamicArray<wu::Box> boxes;
+	core::DynamicArray<double> variances;
+	boxes.resize(maxTargetBufColors);
+	variances.resize(maxTargetBufColors);
+	variances.fill(0.0);
+	boxes[0].r1 = boxes[0].g1 = boxes[0].b1 = wu::HistSize - 1;
+
+	int boxCount = (int)maxTargetBufColors;
+	int next = 0;
+	for (int i = 1; i < (int)maxTargetBufColors; ++i) {
+		if (wu::cut(boxes[next], boxes[i], moments)) {
+			variances[next] = boxes[next].vol > 1 ? wu::variance(boxes[next], moments) : 0.0;
+			variances[i] = boxes[i].vol > 1 ? wu::variance(boxes[i], moments) : 0.0;
+		} else {
+			// don't try to split this box again
+			variances[next] = 0.0;
+			--i;
+		}
+		next = 0;
+		double temp = variances[0];
+		for (int k = 1; k <= i; ++k) {
+			if (variances[k] > temp) {
+				temp = variances[k];
+				next = k;
 			}
 		}
+		if (temp <= 0.0) {
+			boxCount = i + 1;
+			break;
+		}
 	}
 
 	size_t n = 0;
-	for (const glm::vec4 &c : centers) {
-		targetBuf[n++] = core::Color::getRGBA(c);
+	for (int k = 0; k < boxCount; ++k) {
+		const wu::Box &box = boxes[k];
+		const int64_t weight = wu::volume(box, moments.wt);
+		if (weight <= 0) {
+			continue;
+		}
+		const uint8_t r = (uint8_t)(wu::volume(box, moments.mr) / weight);
+		const uint8_t g = (uint8_t)(wu::volume(box, moments.mg) / weight);
+		const uint8_t b = (uint8_t)(wu::volume(box, moments.mb) / weight);
+		const uint8_t a = (uint8_t)(wu::volume(box, moments.ma) / weight);
+		targetBuf[n++] = RGBA(r, g, b, a);
 	}
+
 	for (size_t i = n; i < maxTargetBufColors; ++i) {
 		targetBuf[i] = RGBA(0xFFFFFFFFU);
 	}
 	return (int)n;
 }
 
-static int quantizeWu(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
-	core::Buffer<RGBA> pixels;
-	pixels.append(inputBuf, inputBufColors);
-
-	// Initialize the set of boxes with the full color range
-	core::DynamicArray<ColorBox> boxes;
-	boxes.emplace_back(ColorBox{{0, 0, 0, 255}, {255, 255, 255, 255}, pixels});
-
-	// Iterate until we reach the desired number of boxes
-	while (boxes.size() < maxTargetBufColors) {
-		// Find the box with the largest volume (i.e., the most pixels)
-		int maxVolume = std::numeric_limits<int>::min();
-		size_t maxVolumeIndex = 0;
-		for (size_t i = 0; i < boxes.size(); ++i) {
-			int volume = (boxes[i].max.r - boxes[i].min.r + 1) * (boxes[i].max.g - boxes[i].min.g + 1) *
-						 (boxes[i].max.b - boxes[i].min.b + 1);
-			if (volume > maxVolume) {
-				maxVolume = volume;
-				maxVolumeIndex = i;
-			}
-		}
+static inline int getDistanceSquared(RGBA c, const glm::ivec4 &center) {
+	const glm::ivec4 d = glm::ivec4(c.r, c.g, c.b, c.a) - center;
+	return d.r * d.r + d.g * d.g + d.b * d.b + d.a * d.a;
+}
 
-		// Split the box with the largest volume into two boxes along its longest dimension
-		const ColorBox &box = boxes[maxVolumeIndex];
-		const size_t pixelCount = box.pixels.size();
-		if (pixelCount <= 0) {
-			boxes.erase(maxVolumeIndex);
+/**
+ * @brief Weighted k-means on the unique input colors with a deterministic k-means++ seeding
+ *
+ * This is slower than the other algorithms, but usually gives the best matching palette.
+ */
+static int quantizeKMeans(RGBA *targetBuf, size_t maxTargetBufColors, const RGBA *inputBuf, size_t inputBufColors) {
+	// the histogram of the unique colors
+	core::HashMap<uint32_t, int> histogram;
+	core::DynamicArray<RGBA> colors;
+	for (size_t i = 0; i < inputBufColors; ++i) {
+		auto iter = histogram.find(inputBuf[i].rgba);
+		if (iter != histogram.end()) {
+			++iter->value;
 			continue;
 		}
-
-		int component = 0;
-		int midpoint = 0;
-		if (box.max.r - box.min.r > box.max.g - box.min.g && box.max.r - box.min.r > box.max.b - box.min.b) {
-			component = 0;
-			midpoint = (box.min.r + box.max.r) / 2;
-		} else if (box.max.g - box.min.g > box.max.b - box.min.b) {
-			component = 1;
-			midpoint = (box.min.g + box.max.g) / 2;
-		} else {
-			component = 2;
-			midpoint = (box.min.b + box.max.b) / 2;
+		histogram.put(inputBuf[i].rgba, 1);
+		colors.push_back(inputBuf[i]);
+	}
+	core::DynamicArray<int> weights;
+	weights.reserve(colors.size());
+	for (const RGBA &c : colors) {
+		int weight = 1;
+		histogram.get(c.rgba, weight);
+		weights.push_back(weight);
+	}
+	const int uniqueColors = (int)colors.size();
+	const int k = core_min((int)maxTargetBufColors, uniqueColors);
+
+	// k-means++ seeding - the first center is the most used color
+	core::DynamicArray<glm::ivec4> centers;
+	centers.reserve(k);
+	int first = 0;
+	for (int i = 1; i < uniqueColors; ++i) {
+		if (weights[i] > weights[first]) {
+			first = i;
 		}
-
-		ColorBox box1, box2;
-		box1.pixels.reserve(pixelCount / 2);
-		box2.pixels.reserve(pixelCount / 2);
-		switch (component) {
-		case 0:
-			box1.min = box.min;
-			box1.max = RGBA(midpoint, box.max.g, box.max.b, 255);
-			box2.min = RGBA(midpoint + 1, box.min.g, box.min.b, 255);
-			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.r <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
-				}
+	}
+	centers.push_back(glm::ivec4(colors[first].r, colors[first].g, colors[first].b, colors[first].a));
+	core::DynamicArray<int64_t> minDistances;
+	minDistances.resize(uniqueColors);
+	for (int i = 0; i < uniqueColors; ++i) {
+		minDistances[i] = INT64_MAX;
+	}
+	std::mt19937 gen(0);
+	while ((int)centers.size() < k) {
+		const glm::ivec4 &last = centers.back();
+		int64_t sum = 0;
+		for (int i = 0; i < uniqueColors; ++i) {
+			const int64_t d = (int64_t)getDistanceSquared(colors[i], last) * weights[i];
+			if (d < minDistances[i]) {
+				minDistances[i] = d;
 			}
+			sum += minDistances[i];
+		}
+		if (sum <= 0) {
 			break;
-		case 1:
-			box1.min = box.min;
-			box1.max = RGBA(box.max.r, midpoint, box.max.b, 255);
-			box2.min = RGBA(box.min.r, midpoint + 1, box.min.b, 255);
-			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.g <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
-				}
+		}
+		std::uniform_int_distribution<int64_t> dis(0, sum - 1);
+		int64_t target = dis(gen);
+		int pick = uniqueColors - 1;
+		for (int i = 0; i < uniqueColors; ++i) {
+			target -= minDistances[i];
+			if (target < 0) {
+				pick = i;
+				break;
 			}
-			break;
-		case 2:
-			box1.min = box.min;
-			box1.max = RGBA(box.max.r, box.max.g, midpoint);
-			box2.min = RGBA(box.min.r, box.min.g, midpoint + 1);
-			box2.max = box.max;
-			for (const RGBA &pixel : box.pixels) {
-				if (pixel.b <= midpoint) {
-					box1.pixels.push_back(pixel);
-				} else {
-					box2.pixels.push_back(pixel);
+		}
+		centers.push_back(glm::ivec4(colors[pick].r, colors[pick].g, colors[pick].b, colors[pick].a));
+	}
+
+	// lloyd iterations on the weighted unique colors
+	const int centerCount = (int)centers.size();
+	core::DynamicArray<int> assignment;
+	assignment.resize(uniqueColors);
+	assignment.fill(-1);
+	core::DynamicArray<glm::i64vec4> sums;
+	core::DynamicArray<int64_t> counts;
+	sums.resize(centerCount);
+	counts.resize(centerCount);
+	const int maxIterations = 16;
+	for (int iteration = 0; iteration < maxIterations; ++iteration) {
+		bool changed = false;
+		sums.fill(glm::i64vec4(0));
+		counts.fill(0);
+		for (int i = 0; i < uniqueColors; ++i) {
+			int closest = 0;
+			int closestDistance = getDistanceSquared(colors[i], centers[0]);
+			for (int c = 1; c < centerCount; ++c) {
+				const int d = getDistanceSquared(colors[i], centers[c]);
+				if (d < closestDistance) {
+					closest = c;
+					closestDistance = d;
 				}
 			}
+			if (assignment[i] != closest) {
+				assignment[i] = closest;
+				changed = true;
+			}
+			const RGBA c = colors[i];
+			sums[closest] += glm::i64vec4(c.r, c.g, c.b, c.a) * (int64_t)weights[i];
+			counts[closest] += weights[i];
+		}
+		for (int c = 0; c < centerCount; ++c) {
+			if (counts[c] > 0) {
+				centers[c] = glm::ivec4(sums[c] / counts[c]);
+			}
+		}
+		if (!changed) {
 			break;
 		}
-
-		// Replace the original box with the two split boxes
-		boxes.erase(maxVolumeIndex);
-		boxes.emplace_back(core::move(box1));
-		boxes.emplace_back(core::move(box2));
 	}
 
 	size_t n = 0;
-	for (const ColorBox& box : boxes) {
-		if (box.pixels.empty()) {
-			continue;
-		}
-		RGBA average(0, 0, 0, 255);
-		for (const RGBA& pixel : box.pixels) {
-			average.r += pixel.r;
-			average.g += pixel.g;
-			average.b += pixel.b;
-		}
-		average.r /= box.pixels.size();
-		average.g /= box.pixels.size();
-		average.b /= box.pixels.size();
-		targetBuf[n++] = average;
+	for (const glm::ivec4 &c : centers) {
+		targetBuf[n++] = RGBA(c.r, c.g, c.b, c.a);
 	}
-
 	for (size_t i = n; i < maxTargetBufColors; ++i) {
 		targetBuf[i] = RGBA(0xFFFFFFFFU);
 	}
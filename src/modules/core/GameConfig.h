@@ -8,6 +8,7 @@ namespace cfg {
 
 constexpr const char *ClientMouseRotationSpeed = "cl_cammouserotspeed";
 constexpr const char *ClientVSync = "cl_vsync";
+constexpr const char *ClientIdleTimeout = "cl_idletimeout";
 constexpr const char *ClientDebugSeverity = "cl_debugseverity";
 constexpr const char *ClientMultiSampleSamples = "cl_multisamplesamples";
 constexpr const char *ClientMultiSampleBuffers = "cl_multisamplebuffers";
@@ -32,23 +33,57 @@ constexpr const char *UIBookmarks = "ui_bookmarks";
 constexpr const char *ClientGamma = "cl_gamma";
 constexpr const char *ClientShadowMap = "cl_shadowmap";
 constexpr const char *ClientBloom = "cl_bloom";
+constexpr const char *ClientBloomLevels = "cl_bloomlevels";
+constexpr const char *ClientBloomQuality = "cl_bloomquality";
 constexpr const char *ClientCameraMinZoom = "cl_camminzoom";
 constexpr const char *ClientCameraMaxZoom = "cl_cammaxzoom";
 constexpr const char *ClientCameraZoomSpeed = "cl_camzoomspeed";
 
 constexpr const char *ClientDebugShadowMapCascade = "cl_debug_cascade";
 constexpr const char *ClientDebugShadow = "cl_debug_shadow";
+constexpr const char *ClientShaderCache = "cl_shadercache";
+constexpr const char *ClientTextureCache = "cl_texturecache";
 
 constexpr const char *RenderOutline = "r_renderoutline";
 
 constexpr const char *CoreMaxFPS = "core_maxfps";
 constexpr const char *CoreLogLevel = "core_loglevel";
 constexpr const char *CoreSysLog = "core_syslog";
+constexpr const char *CoreLogAsync = "core_logasync";
+// The amount of log lines the built-in console keeps
+constexpr const char *CoreConsoleLines = "core_consolelines";
 constexpr const char *CorePath = "core_path";
 constexpr const char *CoreColorReduction = "core_colorreduction";
 
 // The size of the mesh chunk
 constexpr const char *VoxelMeshSize = "voxel_meshsize";
+// The surface extractor of the volumes - 0 cubes, 1 marching cubes, 2 surface nets
+constexpr const char *VoxelMeshMode = "voxel_meshmode";
+// The max projected size in pixels of a voxel of a downsampled chunk mesh - 0 disables the level of detail
+constexpr const char *VoxelLODThreshold = "voxel_lodthreshold";
+constexpr const char *VoxelOptimizeMesh = "voxel_optimizemesh";
+// Skip the chunks that were hidden behind other geometry in the previous frame
+constexpr const char *VoxelOcclusionCulling = "voxel_occlusionculling";
+// Render all volumes out of shared buffers with one multi draw indirect call per pass
+constexpr const char *VoxelMultiDrawIndirect = "voxel_multidrawindirect";
+// Experimental: build the quads of the cubic volumes in the vertex shader from a list of visible faces
+constexpr const char *VoxelVertexPulling = "voxel_vertexpulling";
+// Experimental: collect the visible faces of the vertex pulling path with a compute shader
+constexpr const char *VoxelComputeFaces = "voxel_computefaces";
+// Experimental: ray march the volumes in a sparse brick map instead of extracting meshes - for huge volumes
+constexpr const char *VoxelRayMarching = "voxel_raymarching";
+// Blend the transparent voxels with weighted blended order independent transparency instead of sorting them
+constexpr const char *VoxelOrderIndependentTransparency = "voxel_oit";
+// The milliseconds per frame the main thread may spend to hand the dirty chunks to the extractor tasks
+constexpr const char *VoxelExtractionBudget = "voxel_extractionbudget";
+// The kilobytes of chunk meshes that are uploaded per frame - 0 uploads all finished meshes
+constexpr const char *VoxelUploadBudget = "voxel_uploadbudget";
+// Store the extracted chunk meshes in the home path and load them from there if the chunk didn't change
+constexpr const char *VoxelMeshCache = "voxel_meshcache";
+// The degrees the direction from the camera to a chunk may change before its transparent triangles are sorted again
+constexpr const char *VoxelSortAngle = "voxel_sortangle";
+// The amount of transparent triangles that are handed to the sorting tasks per frame - 0 disables the budget
+constexpr const char *VoxelSortBudget = "voxel_sortbudget";
 
 constexpr const char *AppHomePath = "app_homepath";
 
@@ -72,8 +107,18 @@ constexpr const char *VoxformatFillHollow = "voxformat_fillhollow";
 constexpr const char *VoxformatVXLNormalType = "voxformat_vxlnormaltype";
 constexpr const char *VoxformatQBTPaletteMode = "voxformat_qbtpalettemode";
 constexpr const char *VoxformatQBTMergeCompounds = "voxformat_qbtmergecompounds";
+constexpr const char *VoxformatMCRBounds = "voxformat_mcrbounds";
 constexpr const char *VoxformatVOXCreateLayers = "voxformat_voxcreatelayers";
 constexpr const char *VoxformatVOXCreateGroups = "voxformat_voxcreategroups";
 constexpr const char *VoxformatQBSaveLeftHanded = "voxformat_qbsavelefthanded";
+constexpr const char *VoxformatGLTFQuantize = "voxformat_gltfquantize";
+constexpr const char *VoxformatOptimize = "voxformat_optimize";
+// The amount of triangles that are kept by the mesh simplification - 1.0 disables it and 0.0 only stops at the max error
+constexpr const char *VoxformatSimplify = "voxformat_simplify";
+// The max distance in voxels the simplification may move the surface - negative values don't limit the error
+constexpr const char *VoxformatSimplifyError = "voxformat_simplifyerror";
+constexpr const char *VoxformatBakeAmbientOcclusion = "voxformat_bakeao";
+// The max width and height of the textures of imported meshes - 0 keeps the full resolution
+constexpr const char *VoxformatTextureMaxSize = "voxformat_texturemaxsize";
 
 }
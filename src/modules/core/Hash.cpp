@@ -3,6 +3,9 @@
  */
 
 #include "Hash.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include <SDL_endian.h>
 
 namespace core {
 
@@ -68,4 +71,141 @@ uint32_t hash(const void *key, int len, uint32_t seed) {
 	return h1;
 }
 
+// xxHash64 was written by Yann Collet and is released under the BSD 2-Clause license
+// https://github.com/Cyan4973/xxHash
+namespace xxh64 {
+
+static constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+static constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+static constexpr uint64_t Prime3 = 0x165667B19E3779F9ULL;
+static constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ULL;
+static constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ULL;
+
+static inline uint64_t rotl(uint64_t x, int r) {
+	return (x << r) | (x >> (64 - r));
+}
+
+static inline uint64_t read64(const uint8_t *p) {
+	uint64_t v;
+	core_memcpy(&v, p, sizeof(v));
+	return SDL_SwapLE64(v);
+}
+
+static inline uint32_t read32(const uint8_t *p) {
+	uint32_t v;
+	core_memcpy(&v, p, sizeof(v));
+	return SDL_SwapLE32(v);
+}
+
+static inline uint64_t round(uint64_t acc, uint64_t input) {
+	acc += input * Prime2;
+	acc = rotl(acc, 31);
+	return acc * Prime1;
+}
+
+static inline uint64_t mergeRound(uint64_t acc, uint64_t val) {
+	acc ^= round(0, val);
+	return acc * Prime1 + Prime4;
+}
+
+static inline void init(uint64_t acc[4], uint64_t seed) {
+	acc[0] = seed + Prime1 + Prime2;
+	acc[1] = seed + Prime2;
+	acc[2] = seed;
+	acc[3] = seed - Prime1;
+}
+
+static inline void stripe(uint64_t acc[4], const uint8_t *p) {
+	acc[0] = round(acc[0], read64(p));
+	acc[1] = round(acc[1], read64(p + 8));
+	acc[2] = round(acc[2], read64(p + 16));
+	acc[3] = round(acc[3], read64(p + 24));
+}
+
+static uint64_t finalize(const uint64_t acc[4], uint64_t seed, uint64_t totalLen, const uint8_t *p, size_t len) {
+	uint64_t h;
+	if (totalLen >= 32) {
+		h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18);
+		h = mergeRound(h, acc[0]);
+		h = mergeRound(h, acc[1]);
+		h = mergeRound(h, acc[2]);
+		h = mergeRound(h, acc[3]);
+	} else {
+		h = seed + Prime5;
+	}
+	h += totalLen;
+	for (; len >= 8; len -= 8, p += 8) {
+		h ^= round(0, read64(p));
+		h = rotl(h, 27) * Prime1 + Prime4;
+	}
+	if (len >= 4) {
+		h ^= (uint64_t)read32(p) * Prime1;
+		h = rotl(h, 23) * Prime2 + Prime3;
+		p += 4;
+		len -= 4;
+	}
+	for (; len > 0; --len, ++p) {
+		h ^= (*p) * Prime5;
+		h = rotl(h, 11) * Prime1;
+	}
+	h ^= h >> 33;
+	h *= Prime2;
+	h ^= h >> 29;
+	h *= Prime3;
+	h ^= h >> 32;
+	return h;
+}
+
+} // namespace xxh64
+
+uint64_t hash64(const void *data, size_t len, uint64_t seed) {
+	const uint8_t *p = (const uint8_t *)data;
+	uint64_t acc[4];
+	const size_t totalLen = len;
+	xxh64::init(acc, seed);
+	for (; len >= 32; len -= 32, p += 32) {
+		xxh64::stripe(acc, p);
+	}
+	return xxh64::finalize(acc, seed, totalLen, p, len);
+}
+
+Hash64::Hash64(uint64_t seed) {
+	reset(seed);
+}
+
+void Hash64::reset(uint64_t seed) {
+	_seed = seed;
+	_bufSize = 0u;
+	_totalLen = 0u;
+	xxh64::init(_acc, seed);
+}
+
+void Hash64::update(const void *data, size_t len) {
+	const uint8_t *p = (const uint8_t *)data;
+	_totalLen += len;
+	if (_bufSize > 0u) {
+		const size_t fill = core_min(len, sizeof(_buf) - _bufSize);
+		core_memcpy(_buf + _bufSize, p, fill);
+		_bufSize += (uint32_t)fill;
+		p += fill;
+		len -= fill;
+		if (_bufSize < sizeof(_buf)) {
+			return;
+		}
+		xxh64::stripe(_acc, _buf);
+		_bufSize = 0u;
+	}
+	for (; len >= 32; len -= 32, p += 32) {
+		xxh64::stripe(_acc, p);
+	}
+	if (len > 0u) {
+		core_memcpy(_buf, p, len);
+		_bufSize = (uint32_t)len;
+	}
+}
+
+uint64_t Hash64::digest() const {
+	return xxh64::finalize(_acc, _seed, _totalLen, _buf, _bufSize);
+}
+
 } // namespace core
@@ -4,12 +4,42 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 namespace core {
 
 uint32_t hash(const void *key, int len, uint32_t seed = 0u);
 
+/**
+ * @brief Fast non-cryptographic 64 bit content hash (xxHash64) - use this instead of @c md5sum() for cache keys and
+ * the detection of duplicated data
+ * @sa Hash64 for hashing data that is not available in one block
+ */
+uint64_t hash64(const void *data, size_t len, uint64_t seed = 0u);
+
+/**
+ * @brief Streaming version of @c hash64() - the digest is the same as for hashing all the data in one call
+ */
+class Hash64 {
+private:
+	uint64_t _acc[4];
+	uint8_t _buf[32];
+	uint32_t _bufSize = 0u;
+	uint64_t _totalLen = 0u;
+	uint64_t _seed;
+
+public:
+	Hash64(uint64_t seed = 0u);
+
+	void reset(uint64_t seed = 0u);
+	void update(const void *data, size_t len);
+	/**
+	 * @note Doesn't modify the state - you can continue to add data after this
+	 */
+	uint64_t digest() const;
+};
+
 // Fowler–Noll–Vo hash function CC0
 // http://www.isthe.com/chongo/tech/comp/fnv/
 // https://en.wikipedia.org/wiki/Fowler%E2%80%93Noll%E2%80%93Vo_hash_function
@@ -10,6 +10,10 @@
 #include "core/Enum.h"
 #include "core/ArrayLength.h"
 #include "core/Assert.h"
+#include "core/collection/ConcurrentRingQueue.h"
+#include "core/concurrent/Thread.h"
+#include <SDL_timer.h>
+#include <atomic>
 #include <string.h>
 #include <stdio.h>
 
@@ -40,6 +44,47 @@ static FILE* _logfile = nullptr;
 static constexpr int bufSize = 4096;
 static SDL_LogPriority _logLevel = SDL_LOG_PRIORITY_INFO;
 
+/**
+ * @brief A formatted log line that waits for the log thread
+ */
+struct LogRecord {
+	SDL_LogPriority priority = SDL_LOG_PRIORITY_INFO;
+	uint32_t id = 0u;
+	char *message = nullptr;
+
+	LogRecord() {
+	}
+	LogRecord(LogRecord &&other) noexcept : priority(other.priority), id(other.id), message(other.message) {
+		other.message = nullptr;
+	}
+	~LogRecord() {
+		SDL_free(message);
+	}
+	LogRecord &operator=(LogRecord &&other) noexcept {
+		if (this != &other) {
+			SDL_free(message);
+			priority = other.priority;
+			id = other.id;
+			message = other.message;
+			other.message = nullptr;
+		}
+		return *this;
+	}
+};
+
+static constexpr size_t asyncQueueSize = 4096u;
+static std::atomic<bool> _async{false};
+/**
+ * the producers keep the order of their own records - there is only one consumer
+ * @note The queue is never freed - a thread that is still logging may use it while the log is shut down
+ */
+static core::ConcurrentRingQueue<LogRecord> *_asyncQueue = nullptr;
+/**
+ * the threads that are currently pushing a record - the async mode is only stopped if there are none left
+ */
+static std::atomic<int> _asyncWriters{0};
+static core::Thread *_asyncThread = nullptr;
+
 #ifdef HAVE_SYSLOG_H
 static SDL_LogOutputFunction _syslogLogCallback = nullptr;
 static void *_syslogLogCallbackUserData = nullptr;
@@ -64,6 +109,50 @@ static void sysLogOutputFunction(void *userdata, int category, SDL_LogPriority p
 #endif
 }
 
+static int asyncLogThread(void *);
+static void output(SDL_LogPriority priority, uint32_t id, const char *buf);
+
+static void startAsync() {
+	if (priv::_async) {
+		return;
+	}
+	if (priv::_asyncQueue == nullptr) {
+		priv::_asyncQueue = new core::ConcurrentRingQueue<priv::LogRecord>(priv::asyncQueueSize);
+	}
+	priv::_asyncQueue->reset();
+	priv::_asyncThread = new core::Thread("log", asyncLogThread);
+	priv::_async = true;
+}
+
+static void stopAsync() {
+	if (!priv::_async) {
+		return;
+	}
+	priv::_async = false;
+	// wait for the writers that already saw the async mode - their records are part of the final flush
+	while (priv::_asyncWriters > 0) {
+		SDL_Delay(0);
+	}
+	priv::_asyncQueue->abortWait();
+	priv::_asyncThread->join();
+	delete priv::_asyncThread;
+	priv::_asyncThread = nullptr;
+	Log::flush();
+}
+
+void Log::flush() {
+	if (priv::_asyncQueue == nullptr) {
+		return;
+	}
+	priv::LogRecord record;
+	while (priv::_asyncQueue->pop(record)) {
+		output(record.priority, record.id, record.message);
+	}
+	if (priv::_logfile) {
+		fflush(priv::_logfile);
+	}
+}
+
 Log::Level Log::toLogLevel(const char* level) {
 	const core::String string(level);
 	if (core::string::iequals(string, "trace")) {
@@ -138,11 +227,19 @@ void Log::init(const char *logfile) {
 #endif
 		priv::_syslog = false;
 	}
+
+	const core::VarPtr &async = core::Var::get(cfg::CoreLogAsync);
+	if (async && async->boolVal()) {
+		startAsync();
+	} else {
+		stopAsync();
+	}
 }
 
 void Log::shutdown() {
 	// this is one of the last methods that is executed - so don't rely on anything
 	// still being available here - it won't
+	stopAsync();
 #ifdef HAVE_SYSLOG_H
 	if (priv::_syslog) {
 		SDL_LogSetOutputFunction(priv::_syslogLogCallback, priv::_syslogLogCallbackUserData);
@@ -160,74 +257,75 @@ void Log::shutdown() {
 	priv::_syslog = false;
 }
 
-static void traceVA(uint32_t id, const char *msg, va_list args) {
-	char buf[priv::bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
-	if (priv::_logfile) {
-		fprintf(priv::_logfile, "[TRACE] (%u) %s\n", id, buf);
+static void output(SDL_LogPriority priority, uint32_t id, const char *buf) {
+	const char *prefix;
+	const char *color;
+	switch (priority) {
+	case SDL_LOG_PRIORITY_VERBOSE:
+		prefix = "TRACE";
+		color = ANSI_COLOR_GREEN;
+		break;
+	case SDL_LOG_PRIORITY_DEBUG:
+		prefix = "DEBUG";
+		color = ANSI_COLOR_BLUE;
+		break;
+	case SDL_LOG_PRIORITY_INFO:
+		prefix = "INFO";
+		color = ANSI_COLOR_GREEN;
+		break;
+	case SDL_LOG_PRIORITY_WARN:
+		prefix = "WARN";
+		color = ANSI_COLOR_YELLOW;
+		break;
+	default:
+		prefix = "ERROR";
+		color = ANSI_COLOR_RED;
+		break;
 	}
-	if (priv::_syslog) {
-		SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogVerbose(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_GREEN "%s" ANSI_COLOR_RESET "\n", id, buf);
-	}
-}
-
-static void debugVA(uint32_t id, const char *msg, va_list args) {
-	char buf[priv::bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
 	if (priv::_logfile) {
-		fprintf(priv::_logfile, "[DEBUG] (%u) %s\n", id, buf);
+		fprintf(priv::_logfile, "[%s] (%u) %s\n", prefix, id, buf);
 	}
 	if (priv::_syslog) {
-		SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
+		SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, priority, "(%u) %s\n", id, buf);
 	} else {
-		SDL_LogDebug(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_BLUE "%s" ANSI_COLOR_RESET "\n", id, buf);
+		SDL_LogMessage(SDL_LOG_CATEGORY_APPLICATION, priority, "(%u) %s%s" ANSI_COLOR_RESET "\n", id, color, buf);
 	}
 }
 
-static void infoVA(uint32_t id, const char *msg, va_list args) {
-	char buf[priv::bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
-	if (priv::_logfile) {
-		fprintf(priv::_logfile, "[INFO] (%u) %s\n", id, buf);
-	}
-	if (priv::_syslog) {
-		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_GREEN "%s" ANSI_COLOR_RESET "\n", id, buf);
+static int asyncLogThread(void *) {
+	priv::LogRecord record;
+	while (priv::_asyncQueue->waitAndPop(record)) {
+		output(record.priority, record.id, record.message);
 	}
+	return 0;
 }
 
-static void warnVA(uint32_t id, const char *msg, va_list args) {
-	char buf[priv::bufSize];
-	SDL_vsnprintf(buf, sizeof(buf), msg, args);
-	buf[sizeof(buf) - 1] = '\0';
-	if (priv::_logfile) {
-		fprintf(priv::_logfile, "[WARN] (%u) %s\n", id, buf);
-	}
-	if (priv::_syslog) {
-		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_YELLOW "%s" ANSI_COLOR_RESET "\n", id, buf);
+static void write(SDL_LogPriority priority, uint32_t id, const char *buf) {
+	if (priv::_async) {
+		++priv::_asyncWriters;
+		// check again - the async mode might have been stopped in the meantime
+		if (priv::_async) {
+			priv::LogRecord record;
+			record.priority = priority;
+			record.id = id;
+			record.message = SDL_strdup(buf);
+			// block instead of dropping records or writing them out of order
+			while (!priv::_asyncQueue->push(core::move(record))) {
+				SDL_Delay(0);
+			}
+			--priv::_asyncWriters;
+			return;
+		}
+		--priv::_asyncWriters;
 	}
+	output(priority, id, buf);
 }
 
-static void errorVA(uint32_t id, const char *msg, va_list args) {
+static void logVA(SDL_LogPriority priority, uint32_t id, const char *msg, va_list args) {
 	char buf[priv::bufSize];
 	SDL_vsnprintf(buf, sizeof(buf), msg, args);
 	buf[sizeof(buf) - 1] = '\0';
-	if (priv::_logfile) {
-		fprintf(priv::_logfile, "[ERROR] (%u) %s\n", id, buf);
-	}
-	if (priv::_syslog) {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "(%u) %s\n", id, buf);
-	} else {
-		SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "(%u) " ANSI_COLOR_RED "%s" ANSI_COLOR_RESET "\n", id, buf);
-	}
+	write(priority, id, buf);
 }
 
 void Log::trace(const char* msg, ...) {
@@ -236,7 +334,7 @@ void Log::trace(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	traceVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_VERBOSE, 0u, msg, args);
 	va_end(args);
 }
 
@@ -246,7 +344,7 @@ void Log::debug(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	debugVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_DEBUG, 0u, msg, args);
 	va_end(args);
 }
 
@@ -256,7 +354,7 @@ void Log::info(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	infoVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_INFO, 0u, msg, args);
 	va_end(args);
 }
 
@@ -266,7 +364,7 @@ void Log::warn(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	warnVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_WARN, 0u, msg, args);
 	va_end(args);
 }
 
@@ -276,7 +374,7 @@ void Log::error(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	errorVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_ERROR, 0u, msg, args);
 	va_end(args);
 }
 
@@ -286,7 +384,7 @@ void c_logtrace(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	traceVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_VERBOSE, 0u, msg, args);
 	va_end(args);
 }
 
@@ -296,7 +394,7 @@ void c_logdebug(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	debugVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_DEBUG, 0u, msg, args);
 	va_end(args);
 }
 
@@ -306,7 +404,7 @@ void c_loginfo(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	infoVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_INFO, 0u, msg, args);
 	va_end(args);
 }
 
@@ -316,7 +414,7 @@ void c_logwarn(const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	warnVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_WARN, 0u, msg, args);
 	va_end(args);
 }
 
@@ -326,7 +424,7 @@ void c_logerror(CORE_FORMAT_STRING const char* msg, ...) {
 	}
 	va_list args;
 	va_start(args, msg);
-	errorVA(0u, msg, args);
+	logVA(SDL_LOG_PRIORITY_ERROR, 0u, msg, args);
 	va_end(args);
 }
 
@@ -334,5 +432,9 @@ extern "C" void c_logwrite(const char* msg, size_t length) {
 	char buf[priv::bufSize];
 	SDL_memcpy(buf, msg, core_max(priv::bufSize - 1, length));
 	buf[sizeof(buf) - 1] = '\0';
+	if (priv::_async) {
+		write(SDL_LOG_PRIORITY_INFO, 0u, buf);
+		return;
+	}
 	SDL_LogInfo(SDL_LOG_CATEGORY_APPLICATION, "%s", buf);
 }
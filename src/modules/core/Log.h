@@ -25,7 +25,15 @@ public:
 	static Level toLogLevel(const char* level);
 	static const char* toLogLevel(Level level);
 
+	/**
+	 * @brief Applies the log configuration - @c cfg::CoreLogAsync moves the output of the log lines to a
+	 * background thread. The lines are still formatted on the calling thread and keep their order per thread.
+	 */
 	static void init(const char *logfile = nullptr);
+	/**
+	 * @brief Writes the log lines that are still queued for the background thread on the calling thread
+	 */
+	static void flush();
 	static void shutdown();
 	static void trace(CORE_FORMAT_STRING const char* msg, ...) CORE_PRINTF_VARARG_FUNC(1);
 	static void debug(CORE_FORMAT_STRING const char* msg, ...) CORE_PRINTF_VARARG_FUNC(1);
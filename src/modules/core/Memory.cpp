@@ -0,0 +1,219 @@
+/**
+ * @file
+ */
+
+#include "Memory.h"
+#include "core/Trace.h"
+#include <SDL_stdinc.h>
+#include <atomic>
+
+namespace core {
+namespace memory {
+
+namespace {
+
+static const char *TagNames[] = {"default", "volume", "mesh", "memento", "format", "render", "image"};
+static_assert(sizeof(TagNames) / sizeof(TagNames[0]) == (int)MemoryTag::Max, "Tag names don't match the tags");
+
+static thread_local MemoryTag _currentTag = MemoryTag::Default;
+
+#ifdef CORE_MEMORY_TRACKING
+struct Counters {
+	std::atomic<int64_t> live{0};
+	std::atomic<int64_t> peak{0};
+	std::atomic<int64_t> allocations{0};
+	std::atomic<int64_t> allocatedBytes{0};
+};
+static Counters _counters[(int)MemoryTag::Max];
+static std::atomic<bool> _traceEnabled{false};
+
+/**
+ * @brief Stored in front of each allocation - the size keeps the alignment of the underlying allocator
+ */
+struct alignas(16) Header {
+	uint64_t size;
+	uint32_t tag;
+	uint32_t traced;
+};
+static_assert(sizeof(Header) == 16, "The header must keep the 16 byte alignment of the allocations");
+
+static SDL_malloc_func _mallocFunc;
+static SDL_calloc_func _callocFunc;
+static SDL_realloc_func _reallocFunc;
+static SDL_free_func _freeFunc;
+
+static void account(Header *header, uint64_t size) {
+	const MemoryTag tag = _currentTag;
+	header->size = size;
+	header->tag = (uint32_t)tag;
+	header->traced = 0u;
+	Counters &counters = _counters[(int)tag];
+	const int64_t live = counters.live.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+	counters.allocations.fetch_add(1, std::memory_order_relaxed);
+	counters.allocatedBytes.fetch_add((int64_t)size, std::memory_order_relaxed);
+	int64_t peak = counters.peak.load(std::memory_order_relaxed);
+	while (live > peak && !counters.peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+	}
+#ifdef TRACY_ENABLE
+	if (_traceEnabled.load(std::memory_order_relaxed)) {
+		header->traced = 1u;
+		TracyAllocN(header + 1, size, TagNames[header->tag]);
+	}
+#endif
+}
+
+static void unaccount(void *mem, const Header &header) {
+#ifdef TRACY_ENABLE
+	if (header.traced != 0u) {
+		TracyFreeN(mem, TagNames[header.tag]);
+	}
+#else
+	(void)mem;
+#endif
+	_counters[header.tag].live.fetch_sub((int64_t)header.size, std::memory_order_relaxed);
+}
+
+static void *trackedMalloc(size_t size) {
+	Header *header = (Header *)_mallocFunc(size + sizeof(Header));
+	if (header == nullptr) {
+		return nullptr;
+	}
+	account(header, size);
+	return header + 1;
+}
+
+static void *trackedCalloc(size_t nmemb, size_t size) {
+	const size_t bytes = nmemb * size;
+	void *mem = trackedMalloc(bytes);
+	if (mem != nullptr) {
+		SDL_memset(mem, 0, bytes);
+	}
+	return mem;
+}
+
+static void *trackedRealloc(void *mem, size_t size) {
+	if (mem == nullptr) {
+		return trackedMalloc(size);
+	}
+	Header *header = (Header *)mem - 1;
+	const Header old = *header;
+	Header *newHeader = (Header *)_reallocFunc(header, size + sizeof(Header));
+	if (newHeader == nullptr) {
+		// the old block is still valid
+		return nullptr;
+	}
+	unaccount(mem, old);
+	// reallocations stay accounted to the tag of the original allocation
+	const MemoryTag previous = setCurrentTag((MemoryTag)old.tag);
+	account(newHeader, size);
+	setCurrentTag(previous);
+	return newHeader + 1;
+}
+
+static void trackedFree(void *mem) {
+	if (mem == nullptr) {
+		return;
+	}
+	Header *header = (Header *)mem - 1;
+	unaccount(mem, *header);
+	_freeFunc(header);
+}
+
+/**
+ * @brief Replace the allocator before anything is allocated - the allocations that were done with the previous
+ * functions don't have a header
+ */
+static void install() {
+	SDL_GetMemoryFunctions(&_mallocFunc, &_callocFunc, &_reallocFunc, &_freeFunc);
+	SDL_SetMemoryFunctions(trackedMalloc, trackedCalloc, trackedRealloc, trackedFree);
+}
+
+#ifdef _MSC_VER
+#pragma warning(disable : 4073)
+#pragma init_seg(lib)
+static struct Installer {
+	Installer() {
+		install();
+	}
+} _installer;
+#else
+__attribute__((constructor(101))) static void installTracking() {
+	install();
+}
+#endif
+
+#endif // CORE_MEMORY_TRACKING
+
+} // namespace
+
+bool enabled() {
+#ifdef CORE_MEMORY_TRACKING
+	return true;
+#else
+	return false;
+#endif
+}
+
+const char *tagName(MemoryTag tag) {
+	if (tag >= MemoryTag::Max) {
+		return "invalid";
+	}
+	return TagNames[(int)tag];
+}
+
+MemoryStats stats(MemoryTag tag) {
+	MemoryStats stats;
+#ifdef CORE_MEMORY_TRACKING
+	if (tag < MemoryTag::Max) {
+		const Counters &counters = _counters[(int)tag];
+		stats.live = counters.live.load(std::memory_order_relaxed);
+		stats.peak = counters.peak.load(std::memory_order_relaxed);
+		stats.allocations = counters.allocations.load(std::memory_order_relaxed);
+		stats.allocatedBytes = counters.allocatedBytes.load(std::memory_order_relaxed);
+	}
+#endif
+	return stats;
+}
+
+MemoryStats totalStats() {
+	MemoryStats total;
+	for (int i = 0; i < (int)MemoryTag::Max; ++i) {
+		const MemoryStats &s = stats((MemoryTag)i);
+		total.live += s.live;
+		// the peaks of the tags didn't necessarily happen at the same time
+		total.peak += s.peak;
+		total.allocations += s.allocations;
+		total.allocatedBytes += s.allocatedBytes;
+	}
+	return total;
+}
+
+void resetPeak() {
+#ifdef CORE_MEMORY_TRACKING
+	for (int i = 0; i < (int)MemoryTag::Max; ++i) {
+		Counters &counters = _counters[i];
+		counters.peak.store(counters.live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+#endif
+}
+
+MemoryTag currentTag() {
+	return _currentTag;
+}
+
+MemoryTag setCurrentTag(MemoryTag tag) {
+	const MemoryTag previous = _currentTag;
+	_currentTag = tag;
+	return previous;
+}
+
+void setTraceEnabled(bool enabled) {
+#ifdef CORE_MEMORY_TRACKING
+	_traceEnabled = enabled;
+#else
+	(void)enabled;
+#endif
+}
+
+} // namespace memory
+} // namespace core
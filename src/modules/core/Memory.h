@@ -0,0 +1,93 @@
+/**
+ * @file
+ * @brief Accounting of the allocations per subsystem
+ *
+ * All allocations of the application go through the SDL memory functions (@c core_malloc, @c core_aligned_malloc,
+ * the global @c operator new and SDL itself). If the tracking is compiled in (@c USE_MEMORY_TRACKING), the
+ * allocator is replaced before any static initialization and every allocation is accounted to the tag of the
+ * @c core_memory_scope that is active on the allocating thread. Freeing memory is accounted to the tag of the
+ * allocation - regardless of the scope.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace core {
+
+enum class MemoryTag : uint8_t {
+	Default,
+	Volume,
+	Mesh,
+	Memento,
+	Format,
+	Render,
+	Image,
+
+	Max
+};
+
+struct MemoryStats {
+	/** bytes that are currently allocated */
+	int64_t live = 0;
+	/** the highest value of @c live since the start of the application or the last @c memory::resetPeak() call */
+	int64_t peak = 0;
+	/** amount of allocations since the start of the application */
+	int64_t allocations = 0;
+	/** bytes that were allocated since the start of the application - freeing memory doesn't reduce this */
+	int64_t allocatedBytes = 0;
+};
+
+namespace memory {
+
+/**
+ * @return @c false if the tracking allocator is not compiled in - all stats are @c 0 in this case
+ */
+bool enabled();
+const char *tagName(MemoryTag tag);
+MemoryStats stats(MemoryTag tag);
+/**
+ * @brief The sum of all tags
+ */
+MemoryStats totalStats();
+/**
+ * @brief Sets the peak of all tags to the currently allocated bytes - to measure the peak of a single operation
+ */
+void resetPeak();
+
+/**
+ * @return The tag that new allocations on the current thread are accounted to
+ */
+MemoryTag currentTag();
+/**
+ * @return The previous tag of the current thread
+ */
+MemoryTag setCurrentTag(MemoryTag tag);
+
+/**
+ * @brief Report the allocations as named memory pools to tracy
+ * @note Only has an effect if tracy is enabled - allocations that happened before are not reported
+ */
+void setTraceEnabled(bool enabled);
+
+} // namespace memory
+
+/**
+ * @brief Accounts all allocations of the current thread to the given tag for the lifetime of the object
+ * @sa core_memory_scope()
+ */
+class MemoryScope {
+private:
+	MemoryTag _previous;
+
+public:
+	MemoryScope(MemoryTag tag) : _previous(memory::setCurrentTag(tag)) {
+	}
+	~MemoryScope() {
+		memory::setCurrentTag(_previous);
+	}
+};
+
+} // namespace core
+
+#define core_memory_scope(tag) core::MemoryScope __memory_scope__##tag(core::MemoryTag::tag)
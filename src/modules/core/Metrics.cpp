@@ -0,0 +1,348 @@
+/**
+ * @file
+ */
+
+#include "Metrics.h"
+#include "core/Algorithm.h"
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/StringUtil.h"
+#include "core/TimeProvider.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/Lock.h"
+#include <inttypes.h>
+#include <math.h>
+
+namespace core {
+
+Metric::Metric(const core::String &name, const char *help, MetricType type)
+	: _name(name), _help(help == nullptr ? "" : help), _type(type) {
+	const size_t labelStart = name.find_first_of('{');
+	if (labelStart == core::String::npos) {
+		_family = name;
+	} else {
+		_family = name.substr(0, labelStart);
+		// strip the braces
+		_labels = name.substr(labelStart + 1, name.size() - labelStart - 2);
+	}
+}
+
+void Gauge::set(double value) {
+	_value.store(value, std::memory_order_relaxed);
+	core_trace_plot(name().c_str(), value);
+}
+
+void Gauge::add(double delta) {
+	double value = _value.load(std::memory_order_relaxed);
+	while (!_value.compare_exchange_weak(value, value + delta, std::memory_order_relaxed)) {
+	}
+	core_trace_plot(name().c_str(), value + delta);
+}
+
+const double Histogram::UpperBounds[Histogram::Buckets] = {
+	0.00001, 0.000025, 0.00005, 0.0001, 0.00025, 0.0005, 0.001, 0.0025, 0.005, 0.01, 0.025,
+	0.05,	 0.1,	   0.25,	0.5,	1.0,	 2.5,	 5.0,	10.0,	25.0,	50.0, 100.0};
+
+Histogram::Histogram(const core::String &name, const char *help) : Metric(name, help, MetricType::Histogram) {
+	for (int i = 0; i < Buckets; ++i) {
+		_buckets[i].store(0, std::memory_order_relaxed);
+	}
+}
+
+void Histogram::observe(double seconds) {
+	for (int i = 0; i < Buckets; ++i) {
+		if (seconds <= UpperBounds[i]) {
+			_buckets[i].fetch_add(1, std::memory_order_relaxed);
+			break;
+		}
+	}
+	_count.fetch_add(1, std::memory_order_relaxed);
+	_sumNanos.fetch_add((int64_t)llround(seconds * 1e9), std::memory_order_relaxed);
+}
+
+int64_t Histogram::cumulativeCount(int bucket) const {
+	int64_t count = 0;
+	for (int i = 0; i <= bucket; ++i) {
+		count += _buckets[i].load(std::memory_order_relaxed);
+	}
+	return count;
+}
+
+int64_t Histogram::count() const {
+	return _count.load(std::memory_order_relaxed);
+}
+
+double Histogram::sum() const {
+	return (double)_sumNanos.load(std::memory_order_relaxed) / 1e9;
+}
+
+MetricTimer::MetricTimer(Histogram &histogram) : _histogram(histogram), _start(TimeProvider::highResTime()) {
+}
+
+MetricTimer::~MetricTimer() {
+	const uint64_t ticks = TimeProvider::highResTime() - _start;
+	_histogram.observe((double)ticks / (double)TimeProvider::highResTimeResolution());
+}
+
+namespace metrics {
+
+namespace {
+
+struct Registry {
+	core_trace_mutex(core::Lock, lock, "Metrics");
+	core::StringMap<Metric *> byName;
+	core::DynamicArray<Metric *> metrics;
+	/** the first help text that was given for the metrics of a family */
+	core::StringMap<core::String> familyHelp;
+};
+
+/**
+ * @note The metrics are never freed - the references that are kept by the callers stay valid until the end of the
+ * application
+ */
+static Registry &registry() {
+	static Registry *r = new Registry();
+	return *r;
+}
+
+template<class T>
+static T &get(const core::String &name, const char *help, MetricType type) {
+	Registry &r = registry();
+	core::ScopedLock lock(r.lock);
+	Metric *metric = nullptr;
+	if (r.byName.get(name, metric)) {
+		if (metric->type() == type) {
+			return *(T *)metric;
+		}
+		core_assert_msg(false, "Metric %s was registered with another type", name.c_str());
+		Log::error("Metric %s was registered with another type", name.c_str());
+		// keep the caller working - the metric just isn't exported
+		return *new T(name, help);
+	}
+	T *created = new T(name, help);
+	r.byName.put(name, created);
+	r.metrics.push_back(created);
+	if (!created->help().empty() && !r.familyHelp.hasKey(created->family())) {
+		r.familyHelp.put(created->family(), created->help());
+	}
+	return *created;
+}
+
+static core::String familyHelp(const core::String &family) {
+	Registry &r = registry();
+	core::ScopedLock lock(r.lock);
+	core::String help;
+	r.familyHelp.get(family, help);
+	return help;
+}
+
+static core::DynamicArray<Metric *> sortedMetrics() {
+	Registry &r = registry();
+	core::DynamicArray<Metric *> metrics;
+	{
+		core::ScopedLock lock(r.lock);
+		metrics = r.metrics;
+	}
+	// the series of a family must be grouped - the dump is sorted in ascending order by family and name
+	core::sort(metrics.begin(), metrics.end(), [](const Metric *a, const Metric *b) {
+		if (a->family() != b->family()) {
+			return a->family() < b->family();
+		}
+		return a->name() < b->name();
+	});
+	return metrics;
+}
+
+static const char *typeName(MetricType type) {
+	switch (type) {
+	case MetricType::Counter:
+		return "counter";
+	case MetricType::Gauge:
+		return "gauge";
+	case MetricType::Histogram:
+		return "histogram";
+	}
+	return "untyped";
+}
+
+/**
+ * @brief The prometheus text format spells the non-finite values as NaN, +Inf and -Inf
+ */
+static core::String prometheusValue(double value) {
+	if (isnan(value)) {
+		return "NaN";
+	}
+	if (isinf(value)) {
+		return value > 0.0 ? "+Inf" : "-Inf";
+	}
+	return core::string::format("%.17g", value);
+}
+
+/**
+ * @brief json doesn't know the non-finite values - they are written as null
+ */
+static core::String jsonValue(double value) {
+	if (!isfinite(value)) {
+		return "null";
+	}
+	return core::string::format("%.17g", value);
+}
+
+static void appendSeries(core::String &out, const Metric &metric, const char *suffix, const char *extraLabel) {
+	out.append(metric.family());
+	out.append(suffix);
+	const bool hasLabels = !metric.labels().empty();
+	const bool hasExtraLabel = extraLabel != nullptr;
+	if (hasLabels || hasExtraLabel) {
+		out.append("{");
+		out.append(metric.labels());
+		if (hasLabels && hasExtraLabel) {
+			out.append(",");
+		}
+		if (hasExtraLabel) {
+			out.append(extraLabel);
+		}
+		out.append("}");
+	}
+	out.append(" ");
+}
+
+/**
+ * @brief Converts the prometheus labels (e.g. format="vox",mode="load") into the members of a json object
+ */
+static void appendLabelsJSON(core::String &out, const core::String &labels) {
+	out.append("{");
+	size_t i = 0;
+	bool first = true;
+	while (i < labels.size()) {
+		const size_t eq = labels.find_first_of('=', i);
+		if (eq == core::String::npos || eq + 1 >= labels.size() || labels[eq + 1] != '"') {
+			break;
+		}
+		size_t end = eq + 2;
+		while (end < labels.size() && labels[end] != '"') {
+			if (labels[end] == '\\') {
+				++end;
+			}
+			++end;
+		}
+		if (!first) {
+			out.append(",");
+		}
+		first = false;
+		out.append("\"");
+		out.append(core::string::trim(labels.substr(i, eq - i)));
+		out.append("\":");
+		// the escaping of the label values is the same as in json
+		out.append(labels.substr(eq + 1, end - eq));
+		i = end + 2;
+	}
+	out.append("}");
+}
+
+} // namespace
+
+Counter &counter(const core::String &name, const char *help) {
+	return get<Counter>(name, help, MetricType::Counter);
+}
+
+Gauge &gauge(const core::String &name, const char *help) {
+	return get<Gauge>(name, help, MetricType::Gauge);
+}
+
+Histogram &histogram(const core::String &name, const char *help) {
+	return get<Histogram>(name, help, MetricType::Histogram);
+}
+
+core::String toPrometheus() {
+	const core::DynamicArray<Metric *> &metrics = sortedMetrics();
+	core::String out;
+	out.reserve(metrics.size() * 128u);
+	const core::String *family = nullptr;
+	for (const Metric *metric : metrics) {
+		if (family == nullptr || *family != metric->family()) {
+			family = &metric->family();
+			const core::String &help = familyHelp(*family);
+			if (!help.empty()) {
+				out.append(core::string::format("# HELP %s %s\n", family->c_str(), help.c_str()));
+			}
+			out.append(core::string::format("# TYPE %s %s\n", family->c_str(), typeName(metric->type())));
+		}
+		switch (metric->type()) {
+		case MetricType::Counter:
+			appendSeries(out, *metric, "", nullptr);
+			out.append(core::string::format("%" PRId64 "\n", ((const Counter *)metric)->value()));
+			break;
+		case MetricType::Gauge:
+			appendSeries(out, *metric, "", nullptr);
+			out.append(prometheusValue(((const Gauge *)metric)->value()));
+			out.append("\n");
+			break;
+		case MetricType::Histogram: {
+			const Histogram *histogram = (const Histogram *)metric;
+			for (int i = 0; i < Histogram::Buckets; ++i) {
+				const core::String &le = core::string::format("le=\"%g\"", Histogram::UpperBounds[i]);
+				appendSeries(out, *metric, "_bucket", le.c_str());
+				out.append(core::string::format("%" PRId64 "\n", histogram->cumulativeCount(i)));
+			}
+			appendSeries(out, *metric, "_bucket", "le=\"+Inf\"");
+			out.append(core::string::format("%" PRId64 "\n", histogram->count()));
+			appendSeries(out, *metric, "_sum", nullptr);
+			out.append(core::string::format("%.9f\n", histogram->sum()));
+			appendSeries(out, *metric, "_count", nullptr);
+			out.append(core::string::format("%" PRId64 "\n", histogram->count()));
+			break;
+		}
+		}
+	}
+	return out;
+}
+
+core::String toJSON() {
+	const core::DynamicArray<Metric *> &metrics = sortedMetrics();
+	core::String out;
+	out.reserve(metrics.size() * 128u);
+	out.append("{\"metrics\":[");
+	bool first = true;
+	for (const Metric *metric : metrics) {
+		if (!first) {
+			out.append(",");
+		}
+		first = false;
+		out.append(core::string::format("{\"name\":\"%s\",\"type\":\"%s\",\"labels\":", metric->family().c_str(),
+										typeName(metric->type())));
+		appendLabelsJSON(out, metric->labels());
+		switch (metric->type()) {
+		case MetricType::Counter:
+			out.append(core::string::format(",\"value\":%" PRId64, ((const Counter *)metric)->value()));
+			break;
+		case MetricType::Gauge:
+			out.append(",\"value\":");
+			out.append(jsonValue(((const Gauge *)metric)->value()));
+			break;
+		case MetricType::Histogram: {
+			const Histogram *histogram = (const Histogram *)metric;
+			out.append(core::string::format(",\"count\":%" PRId64 ",\"sum\":%.9f,\"buckets\":[", histogram->count(),
+											histogram->sum()));
+			for (int i = 0; i < Histogram::Buckets; ++i) {
+				if (i > 0) {
+					out.append(",");
+				}
+				out.append(core::string::format("{\"le\":%g,\"count\":%" PRId64 "}", Histogram::UpperBounds[i],
+												histogram->cumulativeCount(i)));
+			}
+			out.append("]");
+			break;
+		}
+		}
+		out.append("}");
+	}
+	out.append("]}");
+	return out;
+}
+
+} // namespace metrics
+
+} // namespace core
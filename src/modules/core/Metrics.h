@@ -0,0 +1,168 @@
+/**
+ * @file
+ * @brief Counters, gauges and histograms for the operational monitoring of long running applications
+ *
+ * The metrics are registered once by name and never removed - the returned references stay valid until the end of
+ * the application and should be kept (e.g. in a function local static) by hot paths. Updating a metric is a single
+ * relaxed atomic operation.
+ *
+ * The name may contain prometheus labels - e.g. @c voxformat_load_seconds{format="vox"}. All metrics of the same
+ * name without the labels share the help text of the first registration and must have the same type.
+ *
+ * @sa core::metrics::toPrometheus()
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/String.h"
+#include <atomic>
+#include <stdint.h>
+
+namespace core {
+
+enum class MetricType : uint8_t { Counter, Gauge, Histogram };
+
+class Metric : public NonCopyable {
+private:
+	core::String _name;
+	/** the name without the labels */
+	core::String _family;
+	/** the labels without the braces - e.g. format="vox" */
+	core::String _labels;
+	core::String _help;
+	const MetricType _type;
+
+public:
+	Metric(const core::String &name, const char *help, MetricType type);
+	virtual ~Metric() {}
+
+	const core::String &name() const;
+	const core::String &family() const;
+	const core::String &labels() const;
+	const core::String &help() const;
+	MetricType type() const;
+};
+
+inline const core::String &Metric::name() const {
+	return _name;
+}
+
+inline const core::String &Metric::family() const {
+	return _family;
+}
+
+inline const core::String &Metric::labels() const {
+	return _labels;
+}
+
+inline const core::String &Metric::help() const {
+	return _help;
+}
+
+inline MetricType Metric::type() const {
+	return _type;
+}
+
+/**
+ * @brief A value that only increases - e.g. the amount of executed jobs
+ */
+class Counter : public Metric {
+private:
+	std::atomic<int64_t> _value{0};
+
+public:
+	Counter(const core::String &name, const char *help) : Metric(name, help, MetricType::Counter) {
+	}
+
+	inline void inc(int64_t n = 1) {
+		_value.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	inline int64_t value() const {
+		return _value.load(std::memory_order_relaxed);
+	}
+};
+
+/**
+ * @brief A value that goes up and down - e.g. the amount of queued tasks. Every update is also plotted by the tracer.
+ */
+class Gauge : public Metric {
+private:
+	std::atomic<double> _value{0.0};
+
+public:
+	Gauge(const core::String &name, const char *help) : Metric(name, help, MetricType::Gauge) {
+	}
+
+	void set(double value);
+	void add(double delta);
+
+	inline double value() const {
+		return _value.load(std::memory_order_relaxed);
+	}
+};
+
+/**
+ * @brief The distribution of durations in seconds - in fixed buckets from 10 microseconds to 100 seconds
+ */
+class Histogram : public Metric {
+public:
+	static constexpr int Buckets = 22;
+	/**
+	 * @brief The inclusive upper bounds of the buckets - the durations above the last bound are only part of the
+	 * count and the sum
+	 */
+	static const double UpperBounds[Buckets];
+
+private:
+	std::atomic<int64_t> _buckets[Buckets];
+	std::atomic<int64_t> _count{0};
+	/** the sum in nanoseconds - this allows to use an integer add */
+	std::atomic<int64_t> _sumNanos{0};
+
+public:
+	Histogram(const core::String &name, const char *help);
+
+	void observe(double seconds);
+
+	/**
+	 * @return The amount of observed values that are less than or equal to the upper bound of the given bucket
+	 */
+	int64_t cumulativeCount(int bucket) const;
+	int64_t count() const;
+	double sum() const;
+};
+
+/**
+ * @brief Observes the lifetime of the object in the given histogram
+ */
+class MetricTimer {
+private:
+	Histogram &_histogram;
+	const uint64_t _start;
+
+public:
+	MetricTimer(Histogram &histogram);
+	~MetricTimer();
+};
+
+namespace metrics {
+
+/**
+ * @brief Returns the metric of the given name - it is created on the first call
+ * @note Registering the same name with different types is a programming error
+ */
+Counter &counter(const core::String &name, const char *help = nullptr);
+Gauge &gauge(const core::String &name, const char *help = nullptr);
+Histogram &histogram(const core::String &name, const char *help = nullptr);
+
+/**
+ * @brief The prometheus text exposition format - e.g. for the textfile collector of the node exporter
+ */
+core::String toPrometheus();
+core::String toJSON();
+
+} // namespace metrics
+
+} // namespace core
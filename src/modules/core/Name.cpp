@@ -0,0 +1,76 @@
+/**
+ * @file
+ */
+
+#include "Name.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/ReadWriteLock.h"
+
+namespace core {
+
+namespace {
+
+struct NameTable {
+	core::ReadWriteLock lock{"NameTable"};
+	core::StringMap<const Name::Entry *> entries;
+};
+
+// constructed on first use - names are created during static initialization, too
+static NameTable &nameTable() {
+	static NameTable table;
+	return table;
+}
+
+static const Name::Entry *emptyEntry() {
+	static const Name::Entry entry{core::String(), 0u};
+	return &entry;
+}
+
+} // namespace
+
+const Name::Entry *Name::intern(const core::String &str) {
+	if (str.empty()) {
+		return emptyEntry();
+	}
+	NameTable &table = nameTable();
+	const Entry *entry = nullptr;
+	{
+		core::ScopedReadLock lock(table.lock);
+		if (table.entries.get(str, entry)) {
+			return entry;
+		}
+	}
+	core::ScopedWriteLock lock(table.lock);
+	// another thread might have added it in the meantime
+	if (table.entries.get(str, entry)) {
+		return entry;
+	}
+	entry = new Entry{str, core::StringHash()(str)};
+	table.entries.put(str, entry);
+	return entry;
+}
+
+Name::Name() : _entry(emptyEntry()) {
+}
+
+Name::Name(const char *str) : _entry(intern(str == nullptr ? core::String() : core::String(str))) {
+}
+
+Name::Name(const core::String &str) : _entry(intern(str)) {
+}
+
+Name Name::find(const core::String &str) {
+	NameTable &table = nameTable();
+	const Entry *entry = emptyEntry();
+	core::ScopedReadLock lock(table.lock);
+	table.entries.get(str, entry);
+	return Name(entry);
+}
+
+size_t Name::count() {
+	NameTable &table = nameTable();
+	core::ScopedReadLock lock(table.lock);
+	return table.entries.size();
+}
+
+} // namespace core
@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/collection/HashMap.h"
+#include <stddef.h>
+
+namespace core {
+
+/**
+ * @brief Interned string - every distinct string is stored only once for the lifetime of the application
+ *
+ * Comparing and hashing a name is O(1) - no characters are touched. Creating a name from a string looks it up in a
+ * global table. Keep the name around (e.g. as @c static @c const) to avoid the lookup in the hot paths.
+ *
+ * @note The interned strings are never freed - don't use this for arbitrary user input
+ * @note Thread safe
+ */
+class Name {
+public:
+	struct Entry {
+		core::String str;
+		size_t hash;
+	};
+
+private:
+	const Entry *_entry;
+
+	explicit Name(const Entry *entry) : _entry(entry) {
+	}
+
+	static const Entry *intern(const core::String &str);
+
+public:
+	Name();
+	Name(const char *str);
+	Name(const core::String &str);
+
+	/**
+	 * @return The name for the given string if it was already interned - an empty name otherwise. This doesn't add the
+	 * string to the table.
+	 */
+	static Name find(const core::String &str);
+	/**
+	 * @return The amount of interned strings
+	 */
+	static size_t count();
+
+	inline const core::String &str() const {
+		return _entry->str;
+	}
+
+	inline const char *c_str() const {
+		return _entry->str.c_str();
+	}
+
+	inline operator const core::String &() const {
+		return _entry->str;
+	}
+
+	inline bool empty() const {
+		return _entry->str.empty();
+	}
+
+	inline size_t hash() const {
+		return _entry->hash;
+	}
+
+	inline bool operator==(const Name &other) const {
+		return _entry == other._entry;
+	}
+
+	inline bool operator!=(const Name &other) const {
+		return _entry != other._entry;
+	}
+
+	inline bool operator==(const core::String &other) const {
+		return _entry->str == other;
+	}
+
+	inline bool operator!=(const core::String &other) const {
+		return !(_entry->str == other);
+	}
+
+	inline bool operator==(const char *other) const {
+		return _entry->str == other;
+	}
+
+	inline bool operator!=(const char *other) const {
+		return !(_entry->str == other);
+	}
+};
+
+struct NameHash {
+	inline size_t operator()(const Name &name) const {
+		return name.hash();
+	}
+};
+
+/**
+ * @brief Interned name key based hash map
+ * @sa core::Name
+ * @ingroup Collections
+ */
+template<class VALUETYPE>
+using NameMap = core::HashMap<core::Name, VALUETYPE, core::NameHash>;
+
+} // namespace core
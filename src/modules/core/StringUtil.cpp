@@ -772,8 +772,6 @@ fail:
 	return false;
 }
 
-#undef IS_DIGIT
-
 static inline float parseReal(const char **token, double default_value = 0.0) {
 	(*token) += strspn((*token), " \t");
 	const char *end = (*token) + strcspn((*token), " \t\r");
@@ -808,6 +806,115 @@ void parseReal3(float *x, float *y, float *z, const char **token, float default_
 	*z = parseReal(token, default_z);
 }
 
+const char *parseFloat(const char *p, const char *end, float &out) {
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		++p;
+	}
+	static const double powersOf10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+										1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+	const char *start = p;
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+	uint64_t mantissa = 0u;
+	int digits = 0;
+	int exponent = 0;
+	bool found = false;
+	for (; p < end && IS_DIGIT(*p); ++p) {
+		found = true;
+		if (digits < 19) {
+			mantissa = mantissa * 10u + (uint64_t)(*p - '0');
+			if (mantissa != 0u) {
+				++digits;
+			}
+		} else {
+			++exponent;
+		}
+	}
+	if (p < end && *p == '.') {
+		++p;
+		for (; p < end && IS_DIGIT(*p); ++p) {
+			found = true;
+			if (digits < 19) {
+				mantissa = mantissa * 10u + (uint64_t)(*p - '0');
+				if (mantissa != 0u) {
+					++digits;
+				}
+				--exponent;
+			}
+		}
+	}
+	if (!found) {
+		char buf[64];
+		const size_t n = core_min((size_t)(end - start), sizeof(buf) - 1);
+		core_memcpy(buf, start, n);
+		buf[n] = '\0';
+		char *parsedEnd = nullptr;
+		out = (float)strtod(buf, &parsedEnd);
+		if (parsedEnd == buf) {
+			return nullptr;
+		}
+		return start + (parsedEnd - buf);
+	}
+	if (p < end && (*p == 'e' || *p == 'E')) {
+		const char *e = p + 1;
+		bool negativeExponent = false;
+		if (e < end && (*e == '-' || *e == '+')) {
+			negativeExponent = *e == '-';
+			++e;
+		}
+		if (e < end && IS_DIGIT(*e)) {
+			int value = 0;
+			for (; e < end && IS_DIGIT(*e); ++e) {
+				if (value < 10000) {
+					value = value * 10 + (*e - '0');
+				}
+			}
+			exponent += negativeExponent ? -value : value;
+			p = e;
+		}
+	}
+	double value = (double)mantissa;
+	if (exponent < 0 && exponent >= -22) {
+		value /= powersOf10[-exponent];
+	} else if (exponent > 0 && exponent <= 22) {
+		value *= powersOf10[exponent];
+	} else if (exponent != 0) {
+		value *= pow(10.0, (double)exponent);
+	}
+	out = (float)(negative ? -value : value);
+	return p;
+}
+
+const char *parseInt(const char *p, const char *end, int32_t &out) {
+	while (p < end && (*p == ' ' || *p == '\t')) {
+		++p;
+	}
+	bool negative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		negative = *p == '-';
+		++p;
+	}
+	if (p >= end || !IS_DIGIT(*p)) {
+		return nullptr;
+	}
+	int64_t value = 0;
+	for (; p < end && IS_DIGIT(*p); ++p) {
+		if (value <= INT32_MAX) {
+			value = value * 10 + (*p - '0');
+		}
+	}
+	if (value > INT32_MAX) {
+		return nullptr;
+	}
+	out = (int32_t)(negative ? -value : value);
+	return p;
+}
+
+#undef IS_DIGIT
+
 void parseIVec3(const core::String &in, int32_t *out) {
 	core::DynamicArray<core::String> tokens;
 	tokens.reserve(3);
@@ -395,6 +395,18 @@ void parseReal3(float *x, float *y, float *z, const char **token, float default_
 					   float default_y = 0.0f, float default_z = 0.0f);
 bool parseReal(const char **token, float *out);
 void parseIVec3(const core::String &in, int32_t *out);
+/**
+ * @brief Locale independent number parsing of the given range - the range doesn't have to be null terminated
+ *
+ * Leading blanks are skipped. The values with up to 19 significant digits are parsed without any copies - everything
+ * else (e.g. @c nan or @c inf) is handed over to @c strtod.
+ * @return The position after the number or @c nullptr if there is no number at the given position
+ */
+const char *parseFloat(const char *str, const char *end, float &out);
+/**
+ * @sa parseFloat()
+ */
+const char *parseInt(const char *str, const char *end, int32_t &out);
 
 }
 }
@@ -6,6 +6,7 @@
 #include "core/Var.h"
 #include "core/Log.h"
 #include "core/Common.h"
+#include "core/Memory.h"
 #include "command/Command.h"
 
 #ifdef USE_EMTRACE
@@ -21,7 +22,7 @@ static thread_local const char* _threadName = "Unknown";
 
 }
 
-#ifdef TRACY_ENABLE
+#if defined(TRACY_ENABLE) && !defined(CORE_MEMORY_TRACKING)
 static SDL_malloc_func malloc_func;
 static SDL_calloc_func calloc_func;
 static SDL_realloc_func realloc_func;
@@ -52,7 +53,10 @@ static void wrap_free_func(void *mem) {
 #endif
 
 Trace::Trace() {
-#ifdef TRACY_ENABLE
+#ifdef CORE_MEMORY_TRACKING
+	// the tracking allocator reports the allocations per tag
+	memory::setTraceEnabled(true);
+#elif defined(TRACY_ENABLE)
 	//core_assert(SDL_GetNumAllocations() == 0);
 	SDL_GetMemoryFunctions(&malloc_func, &calloc_func, &realloc_func, &free_func);
 	SDL_SetMemoryFunctions(wrap_malloc_func, wrap_calloc_func, wrap_realloc_func, wrap_free_func);
@@ -67,7 +71,9 @@ Trace::~Trace() {
 #ifdef USE_EMTRACE
 	emscripten_trace_close();
 #endif
-#ifdef TRACY_ENABLE
+#ifdef CORE_MEMORY_TRACKING
+	memory::setTraceEnabled(false);
+#elif defined(TRACY_ENABLE)
 	SDL_SetMemoryFunctions(malloc_func, calloc_func, realloc_func, free_func);
 #endif
 }
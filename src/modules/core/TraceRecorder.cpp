@@ -0,0 +1,167 @@
+/**
+ * @file
+ */
+
+#include "TraceRecorder.h"
+#include "core/StringUtil.h"
+#include <SDL_timer.h>
+#include <atomic>
+
+namespace core {
+
+namespace {
+
+/**
+ * every recording gets a new generation - the threads register a new buffer once they record for a new generation
+ */
+static std::atomic<uint32_t> _nextGeneration{1u};
+
+struct ThreadRegistration {
+	uint32_t generation = 0u;
+	void *buffer = nullptr;
+};
+static thread_local ThreadRegistration _registration;
+
+static void appendEscaped(core::String &out, const char *str) {
+	for (const char *c = str; *c != '\0'; ++c) {
+		if (*c == '"' || *c == '\\') {
+			out.append("\\");
+			out.append(c, 1);
+		} else if ((unsigned char)*c < 0x20) {
+			out.append(" ");
+		} else {
+			out.append(c, 1);
+		}
+	}
+}
+
+} // namespace
+
+TraceRecorder::~TraceRecorder() {
+	stop();
+	core::ScopedLock lock(_lock);
+	for (ThreadBuffer *buffer : _threads) {
+		delete buffer;
+	}
+	_threads.clear();
+}
+
+void TraceRecorder::start() {
+	core::ScopedLock lock(_lock);
+	for (ThreadBuffer *buffer : _threads) {
+		delete buffer;
+	}
+	_threads.clear();
+	_generation = _nextGeneration++;
+	_startTicks = SDL_GetPerformanceCounter();
+	_active = true;
+}
+
+void TraceRecorder::stop() {
+	_active = false;
+}
+
+TraceRecorder::ThreadBuffer *TraceRecorder::threadBuffer(const char *threadName) {
+	if (_registration.generation == _generation) {
+		return (ThreadBuffer *)_registration.buffer;
+	}
+	ThreadBuffer *buffer = new ThreadBuffer();
+	buffer->name = threadName;
+	{
+		core::ScopedLock lock(_lock);
+		buffer->tid = (uint32_t)_threads.size() + 1u;
+		_threads.push_back(buffer);
+	}
+	_registration.generation = _generation;
+	_registration.buffer = buffer;
+	return buffer;
+}
+
+void TraceRecorder::record(const char *threadName, const char *name, bool begin) {
+	if (!_active) {
+		return;
+	}
+	const uint64_t ticks = SDL_GetPerformanceCounter();
+	ThreadBuffer *buffer = threadBuffer(threadName);
+	// only the own thread is recording into the buffer - the lock is just taken by the export
+	core::ScopedLock lock(buffer->lock);
+	if (begin) {
+		if (buffer->droppedDepth > 0 || buffer->events.size() >= MaxEventsPerThread) {
+			++buffer->droppedDepth;
+			++buffer->dropped;
+			return;
+		}
+	} else if (buffer->droppedDepth > 0) {
+		--buffer->droppedDepth;
+		return;
+	}
+	buffer->events.push_back(Event{name, ticks - _startTicks, begin});
+}
+
+void TraceRecorder::traceBeginFrame(const char *threadName) {
+	record(threadName, "Frame", true);
+}
+
+void TraceRecorder::traceBegin(const char *threadName, const char *name) {
+	record(threadName, name, true);
+}
+
+void TraceRecorder::traceEnd(const char *threadName) {
+	record(threadName, nullptr, false);
+}
+
+void TraceRecorder::traceEndFrame(const char *threadName) {
+	record(threadName, nullptr, false);
+}
+
+size_t TraceRecorder::events() const {
+	core::ScopedLock lock(_lock);
+	size_t n = 0u;
+	for (ThreadBuffer *buffer : _threads) {
+		core::ScopedLock bufferLock(buffer->lock);
+		n += buffer->events.size();
+	}
+	return n;
+}
+
+core::String TraceRecorder::toChromeJSON() const {
+	const double ticksToMicros = 1000000.0 / (double)SDL_GetPerformanceFrequency();
+	core::String json;
+	json.reserve(events() * 64u + 256u);
+	json.append("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	bool first = true;
+	core::ScopedLock lock(_lock);
+	for (ThreadBuffer *buffer : _threads) {
+		core::ScopedLock bufferLock(buffer->lock);
+		if (!first) {
+			json.append(",");
+		}
+		first = false;
+		json.append(core::string::format("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+										 buffer->tid));
+		appendEscaped(json, buffer->name.c_str());
+		json.append("\"}}");
+		// the names are taken from the begin events - the chrome format doesn't need them for the end events
+		for (const Event &event : buffer->events) {
+			json.append(",{\"ph\":\"");
+			json.append(event.begin ? "B" : "E");
+			json.append(core::string::format("\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", buffer->tid,
+											 (double)event.ticks * ticksToMicros));
+			if (event.name != nullptr) {
+				json.append(",\"name\":\"");
+				appendEscaped(json, event.name);
+				json.append("\"");
+			}
+			json.append("}");
+		}
+		if (buffer->dropped > 0u) {
+			json.append(core::string::format(",{\"name\":\"%i dropped scopes\",\"ph\":\"i\",\"s\":\"t\",\"pid\":1,"
+											 "\"tid\":%u,\"ts\":0}",
+											 (int)buffer->dropped, buffer->tid));
+		}
+	}
+	json.append("]}");
+	return json;
+}
+
+} // namespace core
@@ -0,0 +1,88 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include <stdint.h>
+
+namespace core {
+
+/**
+ * @brief Records the trace scopes of all threads to write them as chrome trace json
+ *
+ * The events are stored in a buffer per thread - the threads don't contend with each other while recording. The
+ * result can be loaded into @c chrome://tracing or https://ui.perfetto.dev
+ *
+ * @note Only available if the application was not built with tracy - the tracy zones don't call the
+ * @c core::TraceCallback
+ * @note The names of the scopes must be string literals - they are not copied
+ */
+class TraceRecorder : public TraceCallback {
+public:
+	/**
+	 * @brief Scopes that are started after a thread recorded this amount of events are dropped
+	 */
+	static constexpr size_t MaxEventsPerThread = 1u << 21;
+
+private:
+	struct Event {
+		const char *name;
+		uint64_t ticks;
+		bool begin;
+	};
+	struct ThreadBuffer {
+		core::Lock lock;
+		core::String name;
+		uint32_t tid = 0u;
+		/** the amount of open scopes that were dropped - their ends are dropped, too */
+		int droppedDepth = 0;
+		size_t dropped = 0u;
+		core::DynamicArray<Event> events;
+	};
+
+	mutable core::Lock _lock;
+	core::DynamicArray<ThreadBuffer *> _threads;
+	uint32_t _generation = 0u;
+	uint64_t _startTicks = 0u;
+	core::AtomicBool _active{false};
+
+	ThreadBuffer *threadBuffer(const char *threadName);
+	void record(const char *threadName, const char *name, bool begin);
+
+public:
+	~TraceRecorder();
+
+	/**
+	 * @brief Drops the previous recording and starts a new one
+	 * @note No other thread may record while this is executed
+	 */
+	void start();
+	void stop();
+	bool active() const;
+
+	void traceBeginFrame(const char *threadName) override;
+	void traceBegin(const char *threadName, const char *name) override;
+	void traceEnd(const char *threadName) override;
+	void traceEndFrame(const char *threadName) override;
+
+	/**
+	 * @return The amount of recorded events of all threads
+	 */
+	size_t events() const;
+	/**
+	 * @brief Serializes the recorded events in the chrome trace event format
+	 */
+	core::String toChromeJSON() const;
+};
+
+inline bool TraceRecorder::active() const {
+	return _active;
+}
+
+} // namespace core
@@ -30,7 +30,7 @@ void Var::unlock() {
 	_lock.unlockWrite();
 }
 
-VarPtr Var::get(const core::String& name, int value, int32_t flags) {
+VarPtr Var::get(const core::Name& name, int value, int32_t flags) {
 	char buf[64];
 	core::string::formatBuf(buf, sizeof(buf), "%i", value);
 	return get(name, buf, flags);
@@ -55,7 +55,7 @@ bool Var::setVal(float value) {
 	return setVal(core::string::format("%f", value));
 }
 
-VarPtr Var::getSafe(const core::String& name) {
+VarPtr Var::getSafe(const core::Name& name) {
 	const VarPtr& var = get(name);
 	core_assert_msg(var, "var %s doesn't exist yet", name.c_str());
 	return var;
@@ -84,7 +84,7 @@ bool Var::_minMaxValidator(const core::String& value, int nmin, int nmax) {
 	return true;
 }
 
-core::String Var::str(const core::String& name) {
+core::String Var::str(const core::Name& name) {
 	const VarPtr& var = get(name);
 	if (!var) {
 		return "";
@@ -92,7 +92,7 @@ core::String Var::str(const core::String& name) {
 	return var->strVal();
 }
 
-bool Var::boolean(const core::String& name) {
+bool Var::boolean(const core::Name& name) {
 	const VarPtr& var = get(name);
 	if (!var) {
 		return false;
@@ -118,24 +118,22 @@ void Var::vec3Val(float out[3]) const {
 	out[2] = z;
 }
 
-VarPtr Var::get(const core::String& name, const char* value, int32_t flags, const char *help, ValidatorFunc validatorFunc) {
+VarPtr Var::get(const core::Name& name, const char* value, int32_t flags, const char *help, ValidatorFunc validatorFunc) {
 	core_assert(!name.empty());
-	VarMap::iterator i;
-	bool missing;
+	VarPtr v;
 	{
 		ScopedReadLock lock(_lock);
-		i = _vars.find(name);
-		missing = i == _vars.end();
+		_vars.get(name, v);
 	}
 
 	uint32_t flagsMask = flags < 0 ? 0u : static_cast<uint32_t>(flags);
-	if (missing) {
+	if (!v) {
 		// environment variables have higher priority than config file values - but command line
 		// arguments have the highest priority
 		if ((flagsMask & CV_FROMCOMMANDLINE) == 0) {
 			const char* envValue = SDL_getenv(name.c_str());
 			if (envValue == nullptr || envValue[0] == '\0') {
-				const core::String& upper = name.toUpper();
+				const core::String& upper = name.str().toUpper();
 				envValue = SDL_getenv(upper.c_str());
 			}
 			if (envValue != nullptr && envValue[0] != '\0') {
@@ -156,14 +154,13 @@ VarPtr Var::get(const core::String& name, const char* value, int32_t flags, cons
 		_vars.put(name, p);
 		return p;
 	}
-	const VarPtr& v = i->second;
 	if (flags >= 0) {
 		if ((flagsMask & CV_FROMFILE) == CV_FROMFILE && (v->_flags & (CV_FROMCOMMANDLINE | CV_FROMENV)) == 0u) {
 			Log::debug("Look for env var to resolve value of %s", name.c_str());
 			// environment variables have higher priority than config file values
 			const char* envValue = SDL_getenv(name.c_str());
 			if (envValue == nullptr || envValue[0] == '\0') {
-				const core::String& upper = name.toUpper();
+				const core::String& upper = name.str().toUpper();
 				envValue = SDL_getenv(upper.c_str());
 			}
 			if (envValue != nullptr && envValue[0] != '\0') {
@@ -198,7 +195,7 @@ VarPtr Var::get(const core::String& name, const char* value, int32_t flags, cons
 	return v;
 }
 
-Var::Var(const core::String& name, const core::String& value, unsigned int flags, const char *help, ValidatorFunc validatorFunc) :
+Var::Var(const core::Name& name, const core::String& value, unsigned int flags, const char *help, ValidatorFunc validatorFunc) :
 		_name(name), _help(help), _flags(flags), _validator(validatorFunc) {
 	addValueToHistory(value);
 	core_assert(_currentHistoryPos == 0);
@@ -207,17 +204,29 @@ Var::Var(const core::String& name, const core::String& value, unsigned int flags
 Var::~Var() {
 }
 
-void Var::addValueToHistory(const core::String& value) {
+Var::Value Var::toValue(const core::String& value) {
 	Value v;
 	v._value = value;
 	const bool isTrue = v._value == VAR_TRUE;
 	v._intValue = isTrue ? 1 : string::toInt(v._value);
 	v._longValue = isTrue ? 1l : (long)string::toLong(v._value);
 	v._floatValue = isTrue ? 1.0f : string::toFloat(v._value);
-	_history.push_back(v);
+	return v;
+}
+
+void Var::addValueToHistory(const core::String& value) {
+	_history.push_back(toValue(value));
 	Log::debug("new value for %s is %s", _name.c_str(), value.c_str());
 }
 
+void Var::replaceVal(const core::String& value) {
+	if (_history[_currentHistoryPos]._value == value) {
+		return;
+	}
+	_history[_currentHistoryPos] = toValue(value);
+	_dirty = true;
+}
+
 bool Var::useHistory(uint32_t historyIndex) {
 	if (historyIndex >= getHistorySize()) {
 		return false;
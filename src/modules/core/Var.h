@@ -6,6 +6,7 @@
 
 #include "core/GameConfig.h"
 #include "core/SharedPtr.h"
+#include "core/Name.h"
 #include "core/String.h"
 #include "core/collection/Map.h"
 #include "core/collection/DynamicArray.h"
@@ -54,16 +55,19 @@ typedef core::SharedPtr<Var> VarPtr;
  * @code
  * core::Var::get("prefix_name");
  * @endcode
+ *
+ * The vars are registered under their interned @c core::Name - keep a @c core::Name (or the @c VarPtr) around instead
+ * of looking up the var by a string in the hot paths.
  */
 class Var {
 public:
 	typedef bool (*ValidatorFunc)(const core::String& value);
 protected:
 	friend class SharedPtr<Var>;
-	typedef Map<core::String, VarPtr, 64, core::StringHash> VarMap;
+	typedef NameMap<VarPtr> VarMap;
 	static VarMap _vars;
 
-	const core::String _name;
+	const core::Name _name;
 	const char* _help = nullptr;
 	uint32_t _flags;
 	static constexpr int NEEDS_REPLICATE = 1 << 0;
@@ -89,12 +93,13 @@ protected:
 	static void lock();
 	static void unlock();
 
+	static Value toValue(const core::String& value);
 	void addValueToHistory(const core::String& value);
 	static bool _ivec3ListValidator(const core::String& value, int nmin, int nmax);
 	static bool _minMaxValidator(const core::String& value, int nmin, int nmax);
 
 	// invisible - use the static get method
-	Var(const core::String& name, const core::String& value = "", uint32_t flags = 0u, const char *help = nullptr, ValidatorFunc validatorFunc = nullptr);
+	Var(const core::Name& name, const core::String& value = "", uint32_t flags = 0u, const char *help = nullptr, ValidatorFunc validatorFunc = nullptr);
 public:
 	~Var();
 
@@ -128,25 +133,25 @@ public:
 	 *
 	 * @note This is using a read/write lock to allow access from different threads.
 	 */
-	static VarPtr get(const core::String& name, const char* value = nullptr, int32_t flags = -1, const char *help = nullptr, ValidatorFunc validatorFunc = nullptr);
+	static VarPtr get(const core::Name& name, const char* value = nullptr, int32_t flags = -1, const char *help = nullptr, ValidatorFunc validatorFunc = nullptr);
 
-	static inline VarPtr get(const core::String& name, const char* value, const char *help, ValidatorFunc validatorFunc = nullptr) {
+	static inline VarPtr get(const core::Name& name, const char* value, const char *help, ValidatorFunc validatorFunc = nullptr) {
 		return get(name, value, -1, help, validatorFunc);
 	}
 
-	static inline VarPtr get(const core::String& name, const String& value, int32_t flags = -1, const char *help = nullptr, ValidatorFunc validatorFunc = nullptr) {
+	static inline VarPtr get(const core::Name& name, const String& value, int32_t flags = -1, const char *help = nullptr, ValidatorFunc validatorFunc = nullptr) {
 		return get(name, value.c_str(), flags, help, validatorFunc);
 	}
 
 	/**
 	 * @note Same as get(), but uses @c core_assert if no var could be found with the given name.
 	 */
-	static VarPtr getSafe(const core::String& name);
+	static VarPtr getSafe(const core::Name& name);
 
 	/**
 	 * @return empty string if var with given name wasn't found, otherwise the value of the var
 	 */
-	static core::String str(const core::String& name);
+	static core::String str(const core::Name& name);
 
 	/**
 	 * The memory is now owned. Make sure it is available for the whole lifetime of this instance.
@@ -159,9 +164,9 @@ public:
 	/**
 	 * @return @c false if var with given name wasn't found, otherwise the bool value of the var
 	 */
-	static bool boolean(const core::String& name);
+	static bool boolean(const core::Name& name);
 
-	static VarPtr get(const core::String& name, int value, int32_t flags = -1);
+	static VarPtr get(const core::Name& name, int value, int32_t flags = -1);
 
 	static void shutdown();
 
@@ -291,6 +296,11 @@ public:
 	}
 	bool setVal(int value);
 	bool setVal(float value);
+	/**
+	 * @brief Replaces the current value without validating it and without adding it to the history
+	 * @note This is meant for values that are maintained by the application - like statistics in @c CV_READONLY vars
+	 */
+	void replaceVal(const core::String& value);
 	/**
 	 * @return The string value of this var
 	 */
@@ -353,7 +363,7 @@ inline const core::String& Var::strVal() const {
 }
 
 inline const core::String& Var::name() const {
-	return _name;
+	return _name.str();
 }
 
 inline bool Var::isDirty() const {
@@ -4,11 +4,9 @@
 
 #include "Zip.h"
 #include "Log.h"
+#include "Metrics.h"
 #include "Assert.h"
-extern "C" {
-#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES 1
-#include "external/miniz.h"
-}
+#include "ZipBackend.h"
 
 namespace core {
 namespace zip {
@@ -17,24 +15,33 @@ bool uncompress(const uint8_t *inputBuf, size_t inputBufSize,
 		uint8_t* outputBuf, size_t outputBufSize, size_t* finalBufSize) {
 	core_assert_msg(outputBufSize > 0, "Expected to get a outputBufSize > 0 - but got %i", (int)outputBufSize);
 	core_assert_msg(inputBufSize > 0, "Expected to get a inputBufSize > 0 - but got %i", (int)inputBufSize);
-	mz_ulong destLen = outputBufSize;
-	int ret = ::mz_uncompress((unsigned char*)outputBuf, &destLen, (const unsigned char*) inputBuf, (mz_ulong)inputBufSize);
-	if (ret == MZ_OK) {
+	static core::Histogram &inflateSeconds =
+		core::metrics::histogram("zip_inflate_seconds{api=\"buffer\"}", "The time spent to inflate a buffer or stream");
+	static core::Counter &inflatedBytes =
+		core::metrics::counter("zip_inflated_bytes_total{api=\"buffer\"}", "The amount of inflated bytes");
+	zip_ulong destLen = (zip_ulong)outputBufSize;
+	int ret;
+	{
+		core::MetricTimer timer(inflateSeconds);
+		ret = ZIP_FUNC(uncompress)((unsigned char*)outputBuf, &destLen, (const unsigned char*) inputBuf, (zip_ulong)inputBufSize);
+	}
+	if (ret == ZIP_CONST(OK)) {
+		inflatedBytes.inc((int64_t)destLen);
 		if (finalBufSize != nullptr) {
 			*finalBufSize = (size_t)destLen;
 		}
 		return true;
 	}
 
-	if (ret == MZ_MEM_ERROR) {
+	if (ret == ZIP_CONST(MEM_ERROR)) {
 		Log::error("Failed to uncompress input buffer of size %i into output buffer of size %i - there was not enough memory",
 				(int)inputBufSize, (int)outputBufSize);
 	}
-	if (ret == MZ_BUF_ERROR) {
+	if (ret == ZIP_CONST(BUF_ERROR)) {
 		Log::error("Failed to uncompress input buffer of size %i into output buffer of size %i - there was not enough room in the output buffer",
 				(int)inputBufSize, (int)outputBufSize);
 	}
-	if (ret == MZ_DATA_ERROR) {
+	if (ret == ZIP_CONST(DATA_ERROR)) {
 		Log::error("Failed to uncompress input buffer of size %i into output buffer of size %i - the input data was corrupted",
 				(int)inputBufSize, (int)outputBufSize);
 	}
@@ -43,26 +50,32 @@ bool uncompress(const uint8_t *inputBuf, size_t inputBufSize,
 
 uint32_t compressBound(uint32_t in) {
 	core_assert_msg(in > 0, "Expected to get a size > 0 - but got %i", (int)in);
-	return (uint32_t)::mz_compressBound((mz_ulong)in);
+	return (uint32_t)ZIP_FUNC(compressBound)((zip_ulong)in);
 }
 
 bool compress(const uint8_t *inputBuf, size_t inputBufSize,
 		uint8_t* outputBuf, size_t outputBufSize, size_t* finalBufSize) {
 	core_assert_msg(outputBufSize > 0, "Expected to get a outputBufSize > 0 - but got %i", (int)outputBufSize);
 	core_assert_msg(inputBufSize > 0, "Expected to get a inputBufSize > 0 - but got %i", (int)inputBufSize);
-	mz_ulong destLen = outputBufSize;
-	int ret = ::mz_compress((unsigned char*)outputBuf, &destLen, (const unsigned char*) inputBuf, (mz_ulong)inputBufSize);
-	if (ret == MZ_OK) {
+	static core::Histogram &deflateSeconds =
+		core::metrics::histogram("zip_deflate_seconds", "The time spent to deflate a buffer");
+	zip_ulong destLen = (zip_ulong)outputBufSize;
+	int ret;
+	{
+		core::MetricTimer timer(deflateSeconds);
+		ret = ZIP_FUNC(compress)((unsigned char*)outputBuf, &destLen, (const unsigned char*) inputBuf, (zip_ulong)inputBufSize);
+	}
+	if (ret == ZIP_CONST(OK)) {
 		if (finalBufSize != nullptr) {
 			*finalBufSize = (size_t)destLen;
 		}
 		return true;
 	}
-	if (ret == MZ_MEM_ERROR) {
+	if (ret == ZIP_CONST(MEM_ERROR)) {
 		Log::error("Failed to compress input buffer of size %i into output buffer of size %i - there was not enough memory",
 				(int)inputBufSize, (int)outputBufSize);
 	}
-	if (ret == MZ_BUF_ERROR) {
+	if (ret == ZIP_CONST(BUF_ERROR)) {
 		Log::error("Failed to compress input buffer of size %i into output buffer of size %i - there was not enough room in the output buffer",
 				(int)inputBufSize, (int)outputBufSize);
 	}
@@ -0,0 +1,46 @@
+/**
+ * @file
+ *
+ * Selects the deflate implementation at compile time. With @c HAVE_ZLIB (cmake option @c USE_ZLIB) the system zlib
+ * is used - this can also be a zlib compatible implementation with simd optimized inflate and deflate like zlib-ng
+ * in compat mode. Otherwise the bundled miniz is used.
+ *
+ * @note Only include this in translation units - never in headers.
+ */
+
+#pragma once
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#define ZIP_FUNC(name) ::name
+#define ZIP_CONST(name) Z_##name
+#define ZIP_WINDOW_BITS MAX_WBITS
+#define ZIP_ERROR_STRING(ret) ::zError(ret)
+typedef uLongf zip_ulong;
+typedef z_stream zip_stream;
+#else
+extern "C" {
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES 1
+#ifndef MINIZ_NO_STDIO
+#define MINIZ_NO_STDIO
+#endif
+#include "core/external/miniz.h"
+}
+#define ZIP_FUNC(name) ::mz_##name
+#define ZIP_CONST(name) MZ_##name
+#define ZIP_WINDOW_BITS MZ_DEFAULT_WINDOW_BITS
+#define ZIP_ERROR_STRING(ret) ::mz_error(ret)
+typedef mz_ulong zip_ulong;
+typedef mz_stream zip_stream;
+#endif
+
+namespace core {
+namespace zip {
+
+/**
+ * @brief The stream state of the selected backend - forward declare this in headers
+ */
+struct Stream : public zip_stream {};
+
+}
+}
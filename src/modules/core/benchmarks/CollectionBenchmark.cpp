@@ -1,8 +1,11 @@
 #include "app/benchmark/AbstractBenchmark.h"
+#include "core/collection/ConcurrentQueue.h"
+#include "core/collection/ConcurrentRingQueue.h"
 #include "core/collection/Map.h"
 #include "core/Assert.h"
 #include <unordered_map>
 #include <map>
+#include <thread>
 
 class MapBenchmark: public app::AbstractBenchmark {
 };
@@ -53,8 +56,64 @@ BENCHMARK_DEFINE_F(MapBenchmark, compareToMapCore) (benchmark::State& state) {
 	}
 }
 
+class QueueBenchmark: public app::AbstractBenchmark {
+protected:
+	static constexpr int Elements = 100000;
+
+	/**
+	 * @brief The given amount of producer threads are pushing while the calling thread is taking the elements
+	 */
+	template<class QUEUE, class PUSH>
+	void run(benchmark::State& state, QUEUE &queue, PUSH &&push) {
+		const int producers = (int)state.range(0);
+		const int perProducer = Elements / producers;
+		for (auto _ : state) {
+			std::thread threads[16];
+			for (int p = 0; p < producers; ++p) {
+				threads[p] = std::thread([&queue, &push, perProducer]() {
+					for (int i = 0; i < perProducer; ++i) {
+						push(queue, i);
+					}
+				});
+			}
+			core::DynamicArray<int> batch;
+			int received = 0;
+			while (received < perProducer * producers) {
+				int value;
+				if (!queue.waitAndPop(value)) {
+					state.SkipWithError("Failed!");
+					break;
+				}
+				++received;
+				batch.clear();
+				received += (int)queue.popAll(batch);
+			}
+			for (int p = 0; p < producers; ++p) {
+				threads[p].join();
+			}
+		}
+		state.SetItemsProcessed(state.iterations() * perProducer * producers);
+	}
+};
+
+BENCHMARK_DEFINE_F(QueueBenchmark, locked) (benchmark::State& state) {
+	core::ConcurrentQueue<int> queue(Elements);
+	run(state, queue, [](core::ConcurrentQueue<int> &q, int i) { q.push(i); });
+}
+
+BENCHMARK_DEFINE_F(QueueBenchmark, lockFree) (benchmark::State& state) {
+	core::ConcurrentRingQueue<int> queue(4096);
+	run(state, queue, [](core::ConcurrentRingQueue<int> &q, int i) {
+		while (!q.push(i)) {
+			std::this_thread::yield();
+		}
+	});
+}
+
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapCore)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToMapStd)->RangeMultiplier(2)->Range(8, 512);
 BENCHMARK_REGISTER_F(MapBenchmark, compareToUnorderedMapStd)->RangeMultiplier(2)->Range(8, 512);
+BENCHMARK_REGISTER_F(QueueBenchmark, locked)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
+BENCHMARK_REGISTER_F(QueueBenchmark, lockFree)->RangeMultiplier(2)->Range(1, 16)->UseRealTime();
 
 BENCHMARK_MAIN();
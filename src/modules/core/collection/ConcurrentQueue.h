@@ -124,6 +124,26 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Takes all queued elements with just one lock
+	 * @return The amount of elements that were appended to the given collection
+	 */
+	size_t popAll(Collection& out) {
+		core::ScopedLock lock(_mutex);
+		const size_t n = _data.size();
+		if (out.empty()) {
+			// hand over the buffer - the queue allocates a new one with the next push
+			out = core::move(_data);
+		} else {
+			out.reserve(out.size() + n);
+			for (size_t i = 0u; i < n; ++i) {
+				out.emplace_back(core::move(_data[i]));
+			}
+			_data.clear();
+		}
+		return n;
+	}
+
 	bool waitAndPop(Data& poppedValue) {
 		core::ScopedLock lock(_mutex);
 		while (_data.empty() && !_abort) {
@@ -0,0 +1,250 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <thread>
+
+namespace core {
+
+/**
+ * @brief Bounded lock-free multi producer multi consumer queue
+ *
+ * Each slot of the ring carries a sequence number that tells the producers and consumers whether the slot is
+ * free or filled for their lap around the ring (see Dmitry Vyukov's bounded mpmc queue). Producers and consumers
+ * only contend on one atomic position each - there is no lock around push() and pop().
+ *
+ * Only waitAndPop() blocks if the queue is empty - the producers then take the lock to wake the waiting consumers.
+ *
+ * @note The capacity is rounded up to the next power of two. push() fails if the queue is full - use
+ * @c core::ConcurrentQueue if the amount of elements is not bounded.
+ * @sa ConcurrentQueue
+ */
+template<class Data>
+class ConcurrentRingQueue : public core::NonCopyable {
+private:
+	static constexpr size_t CacheLineSize = 64u;
+	static constexpr int SpinCount = 32;
+	struct Cell {
+		std::atomic<size_t> sequence;
+		Data data;
+	};
+
+	Cell *_cells = nullptr;
+	size_t _mask = 0u;
+	alignas(CacheLineSize) std::atomic<size_t> _enqueuePos{0u};
+	alignas(CacheLineSize) std::atomic<size_t> _dequeuePos{0u};
+	alignas(CacheLineSize) std::atomic<int> _waiting{0};
+	std::atomic<bool> _abort{false};
+	core::Lock _mutex;
+	core::ConditionVariable _conditionVariable;
+
+	void wakeup() {
+		// pairs with the increment of _waiting in waitAndPop() - either the consumer sees the new element or we see
+		// the waiting consumer
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (_waiting.load(std::memory_order_relaxed) > 0) {
+			core::ScopedLock lock(_mutex);
+			_conditionVariable.notify_one();
+		}
+	}
+
+	template<class T>
+	bool enqueue(T &&data) {
+		size_t pos = _enqueuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell &cell = _cells[pos & _mask];
+			const size_t seq = cell.sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+			if (diff == 0) {
+				if (_enqueuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					cell.data = core::forward<T>(data);
+					cell.sequence.store(pos + 1u, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				// the consumers didn't free this slot yet - full
+				return false;
+			} else {
+				pos = _enqueuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+public:
+	using value_type = Data;
+	using Key = Data;
+
+	/**
+	 * @param capacity Rounded up to the next power of two
+	 */
+	ConcurrentRingQueue(size_t capacity = 256u) {
+		init(capacity);
+	}
+
+	~ConcurrentRingQueue() {
+		abortWait();
+		delete[] _cells;
+	}
+
+	/**
+	 * @brief Changes the capacity and drops all elements
+	 * @note Not thread safe - no other thread may access the queue while this is executed
+	 */
+	void init(size_t capacity) {
+		size_t size = 2u;
+		while (size < capacity) {
+			size <<= 1u;
+		}
+		if (size != _mask + 1u || _cells == nullptr) {
+			delete[] _cells;
+			_cells = new Cell[size];
+			_mask = size - 1u;
+		}
+		for (size_t i = 0u; i < size; ++i) {
+			_cells[i].data = Data();
+			_cells[i].sequence.store(i, std::memory_order_relaxed);
+		}
+		_enqueuePos.store(0u, std::memory_order_relaxed);
+		_dequeuePos.store(0u, std::memory_order_relaxed);
+	}
+
+	void abortWait() {
+		_abort = true;
+		core::ScopedLock lock(_mutex);
+		_conditionVariable.notify_all();
+	}
+
+	void reset() {
+		_abort = false;
+	}
+
+	void clear() {
+		Data data;
+		while (pop(data)) {
+		}
+	}
+
+	/**
+	 * @return @c false if the queue is full
+	 */
+	bool push(const Data &data) {
+		if (!enqueue(data)) {
+			return false;
+		}
+		wakeup();
+		return true;
+	}
+
+	/**
+	 * @return @c false if the queue is full - the data is not moved in that case
+	 */
+	bool push(Data &&data) {
+		if (!enqueue(core::move(data))) {
+			return false;
+		}
+		wakeup();
+		return true;
+	}
+
+	bool pop(Data &poppedValue) {
+		size_t pos = _dequeuePos.load(std::memory_order_relaxed);
+		for (;;) {
+			Cell &cell = _cells[pos & _mask];
+			const size_t seq = cell.sequence.load(std::memory_order_acquire);
+			const intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1u);
+			if (diff == 0) {
+				if (_dequeuePos.compare_exchange_weak(pos, pos + 1u, std::memory_order_relaxed)) {
+					poppedValue = core::move(cell.data);
+					// free the slot for the next lap of the producers
+					cell.sequence.store(pos + _mask + 1u, std::memory_order_release);
+					return true;
+				}
+			} else if (diff < 0) {
+				// the producers didn't fill this slot yet - empty
+				return false;
+			} else {
+				pos = _dequeuePos.load(std::memory_order_relaxed);
+			}
+		}
+	}
+
+	/**
+	 * @brief Takes all elements that are currently in the queue
+	 * @return The amount of elements that were appended to the given collection
+	 */
+	size_t popAll(core::DynamicArray<Data> &out) {
+		size_t n = 0u;
+		Data data;
+		while (pop(data)) {
+			out.emplace_back(core::move(data));
+			++n;
+		}
+		return n;
+	}
+
+	/**
+	 * @brief Blocks until an element is available or abortWait() was called
+	 * @return @c false if the wait was aborted
+	 */
+	bool waitAndPop(Data &poppedValue) {
+		for (;;) {
+			// producers are usually not far away - spin a little before going to sleep
+			for (int i = 0; i < SpinCount; ++i) {
+				if (_abort) {
+					return false;
+				}
+				if (pop(poppedValue)) {
+					return true;
+				}
+				std::this_thread::yield();
+			}
+			core::ScopedLock lock(_mutex);
+			_waiting.fetch_add(1, std::memory_order_seq_cst);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			// check again after announcing the wait - a producer that pushed before doesn't notify us
+			while (!_abort && empty()) {
+				if (!_conditionVariable.wait(_mutex)) {
+					_waiting.fetch_sub(1, std::memory_order_relaxed);
+					return false;
+				}
+			}
+			_waiting.fetch_sub(1, std::memory_order_relaxed);
+		}
+	}
+
+	/**
+	 * @note Only a snapshot if other threads are modifying the queue
+	 */
+	inline bool empty() const {
+		return size() == 0u;
+	}
+
+	/**
+	 * @note Only a snapshot if other threads are modifying the queue
+	 */
+	inline uint32_t size() const {
+		const size_t dequeuePos = _dequeuePos.load(std::memory_order_acquire);
+		const size_t enqueuePos = _enqueuePos.load(std::memory_order_acquire);
+		if (enqueuePos <= dequeuePos) {
+			return 0u;
+		}
+		return (uint32_t)(enqueuePos - dequeuePos);
+	}
+
+	inline size_t capacity() const {
+		return _mask + 1u;
+	}
+};
+
+} // namespace core
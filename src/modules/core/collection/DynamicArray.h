@@ -11,6 +11,7 @@
 #include <cstdint> // intptr_t - not available in stdint.h
 #include <new>
 #include <initializer_list>
+#include <type_traits>
 
 namespace core {
 
@@ -18,7 +19,8 @@ namespace core {
  * @brief Dynamically growing continuous storage buffer
  *
  * @note This array does not have an upper size limit. Each time the capacity is reached, it will
- * allocate new slots given by the @c INCREASE template parameter.
+ * double the capacity - but at least allocate the amount of slots given by the @c INCREASE template parameter.
+ * Trivially copyable types are relocated with a @c realloc instead of moving them one by one.
  *
  * @note Use a fixed size array to prevent memory allocations - where possible
  * @sa Array
@@ -36,11 +38,14 @@ private:
 		return (size_t)((val + len) & ~len);
 	}
 
-	void checkBufferSize(size_t newSize) {
-		if (_capacity >= newSize) {
+	static constexpr bool Relocatable = std::is_trivially_copyable<TYPE>::value;
+
+	void grow(size_t capacity) {
+		_capacity = capacity;
+		if constexpr (Relocatable) {
+			_buffer = (TYPE*)core_aligned_realloc(_buffer, _capacity * sizeof(TYPE));
 			return;
 		}
-		_capacity = align(newSize);
 		TYPE* newBuffer = (TYPE*)core_aligned_malloc(_capacity * sizeof(TYPE));
 		for (size_t i = 0u; i < _size; ++i) {
 			new ((void*)&newBuffer[i]) TYPE(core::move(_buffer[i]));
@@ -49,6 +54,16 @@ private:
 		core_aligned_free(_buffer);
 		_buffer = newBuffer;
 	}
+
+	/**
+	 * @brief Grows geometrically to get amortized constant costs for appending elements
+	 */
+	void checkBufferSize(size_t newSize) {
+		if (_capacity >= newSize) {
+			return;
+		}
+		grow(align(core_max(newSize, _capacity * 2u)));
+	}
 public:
 	using value_type = TYPE;
 
@@ -212,6 +227,13 @@ public:
 
 	void append(const TYPE* array, size_t n) {
 		checkBufferSize(_size + n);
+		if constexpr (Relocatable) {
+			if (n > 0u) {
+				core_memcpy((void *)&_buffer[_size], (const void *)array, n * sizeof(TYPE));
+				_size += n;
+			}
+			return;
+		}
 		for (size_t i = 0u; i < n; ++i) {
 			new ((void *)&_buffer[_size++]) TYPE(array[i]);
 		}
@@ -334,8 +356,13 @@ public:
 		return _buffer[_size - 1u];
 	}
 
+	/**
+	 * @note Other than the growth when elements are added, this allocates exactly the requested (aligned) capacity
+	 */
 	void reserve(size_t size) {
-		checkBufferSize(size);
+		if (_capacity < size) {
+			grow(align(size));
+		}
 	}
 
 	void insert(size_t size, TYPE type) {
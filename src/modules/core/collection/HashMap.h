@@ -0,0 +1,400 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Assert.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include "core/collection/Map.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <initializer_list>
+
+namespace core {
+
+/**
+ * @brief Growing hash map with open addressing (robin hood hashing with backward shift deletion)
+ *
+ * The slot table only stores the hash and a pointer to the entry. Lookups compare the cached hash before
+ * the key is compared - and the table is rehashed into twice the size once the load factor is reached.
+ * There is no up-front capacity that has to be guessed.
+ *
+ * @note The entries are allocated one by one - the pointers to the keys and values stay valid until the
+ * entry is removed. Iterators are invalidated by any modification of the map.
+ *
+ * @sa Map
+ * @ingroup Collections
+ */
+template<typename KEYTYPE, typename VALUETYPE, typename HASHER = priv::DefaultHasher, typename COMPARE = priv::EqualCompare>
+class HashMap {
+public:
+	using value_type = VALUETYPE;
+	using key_type = KEYTYPE;
+
+	struct KeyValue {
+		inline KeyValue(const KEYTYPE& _key, const VALUETYPE& _value) :
+				key(_key), value(_value), first(key), second(value) {
+		}
+
+		inline KeyValue(const KEYTYPE& _key, VALUETYPE&& _value) :
+				key(_key), value(core::forward<VALUETYPE>(_value)), first(key), second(value) {
+		}
+
+		inline KeyValue(KeyValue &&other) noexcept :
+				key(core::move(other.key)), value(core::move(other.value)), first(key), second(value) {
+		}
+
+		KEYTYPE key;
+		VALUETYPE value;
+		const KEYTYPE &first;
+		const VALUETYPE &second;
+	};
+
+private:
+	struct Slot {
+		/** @c nullptr marks an empty slot */
+		KeyValue *entry;
+		size_t hash;
+	};
+
+	static constexpr size_t MinSlots = 8;
+
+	Slot *_slots = nullptr;
+	/** always a power of two (or 0 if nothing was allocated yet) */
+	size_t _capacity = 0;
+	size_t _size = 0;
+	HASHER _hasher;
+
+	/**
+	 * The slot index is taken from the lower bits - so mix the bits of the user hash. Otherwise the identity
+	 * hash for integers or aligned pointers would put most of the entries into the same slots.
+	 */
+	inline size_t hash(const KEYTYPE& key) const {
+		uint64_t h = (uint64_t)_hasher(key);
+		h ^= h >> 33;
+		h *= 0xff51afd7ed558ccdULL;
+		h ^= h >> 33;
+		return (size_t)h;
+	}
+
+	inline size_t mask() const {
+		return _capacity - 1;
+	}
+
+	/**
+	 * @return The distance of the slot to the slot the entry would ideally be placed at
+	 */
+	inline size_t probeDistance(size_t slotIdx) const {
+		return (slotIdx - (_slots[slotIdx].hash & mask())) & mask();
+	}
+
+	/**
+	 * @return The slot index or @c -1 if the key wasn't found
+	 */
+	intptr_t findSlot(const KEYTYPE& key, size_t hashValue) const {
+		if (_size == 0) {
+			return -1;
+		}
+		size_t idx = hashValue & mask();
+		for (size_t dist = 0; dist < _capacity; ++dist) {
+			const Slot &slot = _slots[idx];
+			if (slot.entry == nullptr) {
+				return -1;
+			}
+			// robin hood invariant: the key would have been placed before this entry
+			if (probeDistance(idx) < dist) {
+				return -1;
+			}
+			if (slot.hash == hashValue && COMPARE()(slot.entry->key, key)) {
+				return (intptr_t)idx;
+			}
+			idx = (idx + 1) & mask();
+		}
+		return -1;
+	}
+
+	/**
+	 * @note The key must not be part of the map and there must be a free slot
+	 */
+	void insertSlot(KeyValue *entry, size_t hashValue) {
+		Slot insert{entry, hashValue};
+		size_t idx = hashValue & mask();
+		size_t dist = 0;
+		for (;;) {
+			Slot &slot = _slots[idx];
+			if (slot.entry == nullptr) {
+				slot = insert;
+				return;
+			}
+			const size_t existingDist = probeDistance(idx);
+			if (existingDist < dist) {
+				// take the slot from the richer entry and continue to place that one
+				core::exchange(slot, insert);
+				dist = existingDist;
+			}
+			idx = (idx + 1) & mask();
+			++dist;
+		}
+	}
+
+	void rehash(size_t capacity) {
+		Slot *oldSlots = _slots;
+		const size_t oldCapacity = _capacity;
+		_slots = (Slot *)core_malloc(capacity * sizeof(Slot));
+		core_assert_msg(_slots != nullptr, "Failed to allocate %i hash map slots", (int)capacity);
+		core_memset(_slots, 0, capacity * sizeof(Slot));
+		_capacity = capacity;
+		for (size_t i = 0; i < oldCapacity; ++i) {
+			if (oldSlots[i].entry != nullptr) {
+				insertSlot(oldSlots[i].entry, oldSlots[i].hash);
+			}
+		}
+		core_free(oldSlots);
+	}
+
+	/**
+	 * @brief Grows the slot table if another entry would exceed the max load factor of 7/8
+	 */
+	void grow() {
+		if (_capacity == 0) {
+			rehash(MinSlots);
+		} else if ((_size + 1) * 8 > _capacity * 7) {
+			rehash(_capacity * 2);
+		}
+	}
+
+	void removeSlot(size_t idx) {
+		delete _slots[idx].entry;
+		// backward shift deletion - this keeps the probe sequences intact without tombstones
+		for (;;) {
+			const size_t next = (idx + 1) & mask();
+			if (_slots[next].entry == nullptr || probeDistance(next) == 0) {
+				break;
+			}
+			_slots[idx] = _slots[next];
+			idx = next;
+		}
+		_slots[idx].entry = nullptr;
+		_slots[idx].hash = 0;
+		--_size;
+	}
+
+	void copy(const HashMap& other) {
+		reserve(other._size);
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+
+	void release() {
+		clear();
+		core_free(_slots);
+		_slots = nullptr;
+		_capacity = 0;
+	}
+
+public:
+	HashMap(std::initializer_list<KeyValue> other) {
+		reserve(other.size());
+		for (auto i = other.begin(); i != other.end(); ++i) {
+			put(i->key, i->value);
+		}
+	}
+	/**
+	 * @param[in] initialSize The amount of entries that can be added before the map has to grow
+	 */
+	HashMap(int initialSize = 0) {
+		if (initialSize > 0) {
+			reserve((size_t)initialSize);
+		}
+	}
+	HashMap(const HashMap& other) : _hasher(other._hasher) {
+		copy(other);
+	}
+	HashMap(HashMap&& other) noexcept :
+			_slots(other._slots), _capacity(other._capacity), _size(other._size), _hasher(other._hasher) {
+		other._slots = nullptr;
+		other._capacity = 0;
+		other._size = 0;
+	}
+	~HashMap() {
+		release();
+	}
+	HashMap &operator=(HashMap &&other) noexcept {
+		if (this != &other) {
+			release();
+			_slots = other._slots;
+			_capacity = other._capacity;
+			_size = other._size;
+			_hasher = other._hasher;
+			other._slots = nullptr;
+			other._capacity = 0;
+			other._size = 0;
+		}
+		return *this;
+	}
+
+	HashMap& operator=(const HashMap& other) {
+		if (this != &other) {
+			clear();
+			copy(other);
+		}
+		return *this;
+	}
+
+	class iterator {
+	private:
+		const HashMap* _map;
+		size_t _slot;
+	public:
+		constexpr iterator() :
+			_map(nullptr), _slot(0) {
+		}
+
+		iterator(const HashMap* map, size_t slot) :
+				_map(map), _slot(slot) {
+		}
+
+		inline KeyValue* operator*() const {
+			return _map->_slots[_slot].entry;
+		}
+
+		iterator& operator++() {
+			for (++_slot; _slot < _map->_capacity; ++_slot) {
+				if (_map->_slots[_slot].entry != nullptr) {
+					return *this;
+				}
+			}
+			_map = nullptr;
+			_slot = 0;
+			return *this;
+		}
+
+		inline KeyValue* operator->() const {
+			return _map->_slots[_slot].entry;
+		}
+
+		inline bool operator!=(const iterator& rhs) const {
+			return _map != rhs._map || _slot != rhs._slot;
+		}
+
+		inline bool operator==(const iterator& rhs) const {
+			return _map == rhs._map && _slot == rhs._slot;
+		}
+	};
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0;
+	}
+
+	/**
+	 * @return The amount of slots - this is growing with the amount of entries
+	 */
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	/**
+	 * @brief Makes sure that the given amount of entries fits into the map without a rehash
+	 */
+	void reserve(size_t entries) {
+		size_t capacity = core_max(_capacity, MinSlots);
+		while (entries * 8 > capacity * 7) {
+			capacity *= 2;
+		}
+		if (capacity != _capacity) {
+			rehash(capacity);
+		}
+	}
+
+	bool get(const KEYTYPE& key, VALUETYPE& value) const {
+		const intptr_t idx = findSlot(key, hash(key));
+		if (idx < 0) {
+			return false;
+		}
+		value = _slots[idx].entry->value;
+		return true;
+	}
+
+	bool hasKey(const KEYTYPE& key) const {
+		return findSlot(key, hash(key)) >= 0;
+	}
+
+	iterator find(const KEYTYPE& key) const {
+		const intptr_t idx = findSlot(key, hash(key));
+		if (idx < 0) {
+			return end();
+		}
+		return iterator(this, (size_t)idx);
+	}
+
+	void emplace(const KEYTYPE& key, VALUETYPE&& value) {
+		const size_t hashValue = hash(key);
+		const intptr_t idx = findSlot(key, hashValue);
+		if (idx >= 0) {
+			_slots[idx].entry->value = core::forward<VALUETYPE>(value);
+			return;
+		}
+		grow();
+		insertSlot(new KeyValue(key, core::forward<VALUETYPE>(value)), hashValue);
+		++_size;
+	}
+
+	void put(const KEYTYPE& key, const VALUETYPE& value) {
+		const size_t hashValue = hash(key);
+		const intptr_t idx = findSlot(key, hashValue);
+		if (idx >= 0) {
+			_slots[idx].entry->value = value;
+			return;
+		}
+		grow();
+		insertSlot(new KeyValue(key, value), hashValue);
+		++_size;
+	}
+
+	iterator begin() const {
+		for (size_t i = 0u; i < _capacity; ++i) {
+			if (_slots[i].entry != nullptr) {
+				return iterator(this, i);
+			}
+		}
+		return end();
+	}
+
+	constexpr iterator end() const {
+		return iterator();
+	}
+
+	/**
+	 * @note Keeps the slot table - use the move assignment of an empty map to free it
+	 */
+	void clear() {
+		for (size_t i = 0u; i < _capacity; ++i) {
+			delete _slots[i].entry;
+			_slots[i].entry = nullptr;
+			_slots[i].hash = 0;
+		}
+		_size = 0;
+	}
+
+	inline void erase(const iterator& iter) {
+		remove(iter->key);
+	}
+
+	bool remove(const KEYTYPE& key) {
+		const intptr_t idx = findSlot(key, hash(key));
+		if (idx < 0) {
+			return false;
+		}
+		removeSlot((size_t)idx);
+		return true;
+	}
+};
+
+}
@@ -0,0 +1,297 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Common.h"
+#include "core/Assert.h"
+#include "core/StandardLib.h"
+#include <new>
+#include <stdint.h>
+#include <initializer_list>
+#include <type_traits>
+
+namespace core {
+
+/**
+ * @brief Continuous storage buffer with space for @c INLINE elements inside the object itself
+ *
+ * @note The heap is only used if more than @c INLINE elements are added. Use this instead of @c DynamicArray for the
+ * small and short lived lists in the hot paths - every @c DynamicArray with at least one element means a heap
+ * allocation.
+ * @note Other than for @c DynamicArray the pointers to the elements are not stable if the container is moved
+ * @sa DynamicArray
+ * @ingroup Collections
+ */
+template<class TYPE, size_t INLINE>
+class SmallVector {
+private:
+	static_assert(INLINE > 0u, "Use DynamicArray if you don't need inline storage");
+	static constexpr bool Relocatable = std::is_trivially_copyable<TYPE>::value;
+
+	TYPE* _buffer;
+	size_t _capacity = INLINE;
+	size_t _size = 0u;
+	alignas(TYPE) uint8_t _inline[INLINE * sizeof(TYPE)];
+
+	inline TYPE* inlineBuffer() {
+		return (TYPE*)_inline;
+	}
+
+	void grow(size_t capacity) {
+		TYPE* newBuffer = (TYPE*)core_aligned_malloc(capacity * sizeof(TYPE));
+		if constexpr (Relocatable) {
+			if (_size > 0u) {
+				core_memcpy((void*)newBuffer, (const void*)_buffer, _size * sizeof(TYPE));
+			}
+		} else {
+			for (size_t i = 0u; i < _size; ++i) {
+				new ((void*)&newBuffer[i]) TYPE(core::move(_buffer[i]));
+				_buffer[i].~TYPE();
+			}
+		}
+		if (!isInline()) {
+			core_aligned_free(_buffer);
+		}
+		_buffer = newBuffer;
+		_capacity = capacity;
+	}
+
+	void checkBufferSize(size_t newSize) {
+		if (_capacity >= newSize) {
+			return;
+		}
+		grow(core_max(newSize, _capacity * 2u));
+	}
+
+	void copyFrom(const SmallVector& other) {
+		checkBufferSize(other._size);
+		for (size_t i = 0u; i < other._size; ++i) {
+			new ((void*)&_buffer[i]) TYPE(other._buffer[i]);
+		}
+		_size = other._size;
+	}
+
+	void moveFrom(SmallVector&& other) {
+		if (!other.isInline()) {
+			_buffer = other._buffer;
+			_capacity = other._capacity;
+			_size = other._size;
+			other._buffer = other.inlineBuffer();
+			other._capacity = INLINE;
+			other._size = 0u;
+			return;
+		}
+		for (size_t i = 0u; i < other._size; ++i) {
+			new ((void*)&_buffer[i]) TYPE(core::move(other._buffer[i]));
+			other._buffer[i].~TYPE();
+		}
+		_size = other._size;
+		other._size = 0u;
+	}
+
+public:
+	using value_type = TYPE;
+	using iterator = TYPE*;
+	using const_iterator = const TYPE*;
+
+	SmallVector() : _buffer(inlineBuffer()) {
+	}
+
+	SmallVector(std::initializer_list<TYPE> other) : _buffer(inlineBuffer()) {
+		reserve(other.size());
+		for (const TYPE& val : other) {
+			push_back(val);
+		}
+	}
+
+	SmallVector(const SmallVector& other) : _buffer(inlineBuffer()) {
+		copyFrom(other);
+	}
+
+	SmallVector(SmallVector&& other) noexcept : _buffer(inlineBuffer()) {
+		moveFrom(core::move(other));
+	}
+
+	~SmallVector() {
+		release();
+	}
+
+	SmallVector& operator=(const SmallVector& other) {
+		if (&other == this) {
+			return *this;
+		}
+		clear();
+		copyFrom(other);
+		return *this;
+	}
+
+	SmallVector& operator=(SmallVector&& other) noexcept {
+		if (&other == this) {
+			return *this;
+		}
+		release();
+		moveFrom(core::move(other));
+		return *this;
+	}
+
+	/**
+	 * @return @c true if the elements are stored inside the object and no heap memory is used
+	 */
+	inline bool isInline() const {
+		return _buffer == (const TYPE*)_inline;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline size_t capacity() const {
+		return _capacity;
+	}
+
+	template<typename... _Args>
+	TYPE& emplace_back(_Args&&... args) {
+		checkBufferSize(_size + 1u);
+		return *new ((void*)&_buffer[_size++]) TYPE(core::forward<_Args>(args)...);
+	}
+
+	void push_back(const TYPE& val) {
+		checkBufferSize(_size + 1u);
+		new ((void*)&_buffer[_size++]) TYPE(val);
+	}
+
+	void append(const TYPE* array, size_t n) {
+		checkBufferSize(_size + n);
+		for (size_t i = 0u; i < n; ++i) {
+			new ((void*)&_buffer[_size++]) TYPE(array[i]);
+		}
+	}
+
+	void pop() {
+		core_assert(_size > 0u);
+		_buffer[--_size].~TYPE();
+	}
+
+	/**
+	 * @brief Removes the elements and keeps the order of the remaining elements
+	 */
+	void erase(size_t index, size_t n = 1) {
+		if (index >= _size || n == 0u) {
+			return;
+		}
+		const size_t delta = core_min(_size - index, n);
+		for (size_t t = index, s = index + delta; s < _size; ++s, ++t) {
+			_buffer[t] = core::move(_buffer[s]);
+		}
+		for (size_t i = _size - delta; i < _size; ++i) {
+			_buffer[i].~TYPE();
+		}
+		_size -= delta;
+	}
+
+	/**
+	 * @return The iterator to the element after the removed ones
+	 */
+	iterator erase(iterator iter, size_t n = 1) {
+		const size_t idx = (size_t)(iter - _buffer);
+		erase(idx, n);
+		return _buffer + idx;
+	}
+
+	void reserve(size_t size) {
+		if (_capacity < size) {
+			grow(size);
+		}
+	}
+
+	void resize(size_t size) {
+		checkBufferSize(size);
+		while (size > _size) {
+			new ((void*)&_buffer[_size++]) TYPE();
+		}
+		while (size < _size) {
+			pop();
+		}
+	}
+
+	void clear() {
+		for (size_t i = 0u; i < _size; ++i) {
+			_buffer[i].~TYPE();
+		}
+		_size = 0u;
+	}
+
+	/**
+	 * @brief Clears the container and frees the heap memory - the inline storage is used again afterwards
+	 */
+	void release() {
+		clear();
+		if (!isInline()) {
+			core_aligned_free(_buffer);
+			_buffer = inlineBuffer();
+			_capacity = INLINE;
+		}
+	}
+
+	inline TYPE* data() {
+		return _buffer;
+	}
+
+	inline const TYPE* data() const {
+		return _buffer;
+	}
+
+	inline TYPE& front() {
+		core_assert(_size > 0u);
+		return _buffer[0];
+	}
+
+	inline const TYPE& front() const {
+		core_assert(_size > 0u);
+		return _buffer[0];
+	}
+
+	inline TYPE& back() {
+		core_assert(_size > 0u);
+		return _buffer[_size - 1u];
+	}
+
+	inline const TYPE& back() const {
+		core_assert(_size > 0u);
+		return _buffer[_size - 1u];
+	}
+
+	inline iterator begin() {
+		return _buffer;
+	}
+
+	inline iterator end() {
+		return _buffer + _size;
+	}
+
+	inline const_iterator begin() const {
+		return _buffer;
+	}
+
+	inline const_iterator end() const {
+		return _buffer + _size;
+	}
+
+	inline TYPE& operator[](size_t idx) {
+		core_assert_msg(idx < _size, "idx is out of bounds: %i vs %i", (int)idx, (int)_size);
+		return _buffer[idx];
+	}
+
+	inline const TYPE& operator[](size_t idx) const {
+		core_assert_msg(idx < _size, "idx is out of bounds: %i vs %i", (int)idx, (int)_size);
+		return _buffer[idx];
+	}
+};
+
+}
@@ -4,18 +4,18 @@
 
 #pragma once
 
-#include "core/collection/Map.h"
+#include "core/collection/HashMap.h"
 #include "core/String.h"
 
 namespace core {
 
 /**
  * @brief String key based hash map
- * @sa core::Map
+ * @sa core::HashMap
  * @sa core::String
  * @ingroup Collections
  */
-template<class VALUETYPE, size_t BUCKETSIZE = 11>
-using StringMap = core::Map<core::String, VALUETYPE, BUCKETSIZE, core::StringHash>;
+template<class VALUETYPE>
+using StringMap = core::HashMap<core::String, VALUETYPE, core::StringHash>;
 
 }
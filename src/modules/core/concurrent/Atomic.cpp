@@ -42,6 +42,10 @@ AtomicInt::AtomicInt(int value) {
 	SDL_AtomicSet(&_value, value);
 }
 
+AtomicInt::AtomicInt(const AtomicInt &other) {
+	SDL_AtomicSet(&_value, SDL_AtomicGet(const_cast<SDL_atomic_t *>(&other._value)));
+}
+
 AtomicInt::operator int() const {
 	return SDL_AtomicGet(const_cast<SDL_atomic_t*>(&_value));
 }
@@ -31,6 +31,7 @@ private:
 	SDL_atomic_t _value;
 public:
 	AtomicInt(int value = 0);
+	AtomicInt(const AtomicInt &other);
 
 	operator int() const;
 
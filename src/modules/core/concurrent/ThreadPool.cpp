@@ -10,21 +10,156 @@
 
 namespace core {
 
+// the pool and the worker index of the current thread - used to push tasks into the queue of the own worker
+static thread_local const ThreadPool *_currentPool = nullptr;
+static thread_local int _currentWorker = -1;
+
+void ThreadPool::WorkerQueue::grow(size_t capacity) {
+	core::DynamicArray<Task> tasks;
+	tasks.resize(capacity);
+	const size_t oldCapacity = _tasks.size();
+	for (size_t i = 0; i < _count; ++i) {
+		tasks[i] = core::move(_tasks[(_head + i) % oldCapacity]);
+	}
+	_tasks = core::move(tasks);
+	_head = 0u;
+}
+
+void ThreadPool::WorkerQueue::push(Task &&task) {
+	core::ScopedLock lock(_lock);
+	if (_count == _tasks.size()) {
+		grow(_tasks.empty() ? 64u : _tasks.size() * 2u);
+	}
+	_tasks[(_head + _count) % _tasks.size()] = core::move(task);
+	++_count;
+}
+
+bool ThreadPool::WorkerQueue::popBack(Task &task) {
+	core::ScopedLock lock(_lock);
+	if (_count == 0u) {
+		return false;
+	}
+	--_count;
+	task = core::move(_tasks[(_head + _count) % _tasks.size()]);
+	return true;
+}
+
+bool ThreadPool::WorkerQueue::popFront(Task &task) {
+	core::ScopedLock lock(_lock);
+	if (_count == 0u) {
+		return false;
+	}
+	task = core::move(_tasks[_head]);
+	_head = (_head + 1u) % _tasks.size();
+	--_count;
+	return true;
+}
+
+size_t ThreadPool::WorkerQueue::clear() {
+	core::ScopedLock lock(_lock);
+	const size_t removed = _count;
+	for (size_t i = 0; i < _count; ++i) {
+		_tasks[(_head + i) % _tasks.size()].reset();
+	}
+	_head = 0u;
+	_count = 0u;
+	return removed;
+}
+
+void ThreadPool::WorkerQueue::reserve(size_t n) {
+	core::ScopedLock lock(_lock);
+	if (n > _tasks.size()) {
+		grow(n);
+	}
+}
+
 ThreadPool::ThreadPool(size_t threads, const char *name) :
 		_threads(threads), _name(name) {
 	if (_name == nullptr) {
 		_name = "ThreadPool";
 	}
+	// tasks might get enqueued before the workers are started
+	_queues = new WorkerQueue[core_max(_threads, (size_t)1)];
+}
+
+void ThreadPool::reserve(size_t n) {
+	const size_t queues = core_max(_threads, (size_t)1);
+	for (size_t i = 0; i < queues; ++i) {
+		_queues[i].reserve(n / queues + 1);
+	}
+}
+
+int ThreadPool::currentWorker() const {
+	if (_currentPool != this) {
+		return -1;
+	}
+	return _currentWorker;
+}
+
+bool ThreadPool::push(Task &&task) {
+	if (_stop) {
+		return false;
+	}
+	if (_lazyStart) {
+		startWorkers();
+	}
+	int worker = currentWorker();
+	if (worker == -1) {
+		// distribute the tasks of foreign threads over all worker queues
+		worker = (int)((unsigned int)_nextQueue.increment() % core_max(_threads, (size_t)1));
+	}
+	_queues[worker].push(core::move(task));
+	++_pendingTasks;
+	// only pay for the lock if there is a worker that waits for new tasks
+	if (_sleepingWorkers > 0) {
+		core::ScopedLock lock(_queueMutex);
+		_queueCondition.notify_one();
+	}
+	return true;
+}
+
+bool ThreadPool::popTask(int worker, Task &task) {
+	const int queues = (int)core_max(_threads, (size_t)1);
+	if (worker != -1 && _queues[worker].popBack(task)) {
+		++_runningTasks;
+		--_pendingTasks;
+		return true;
+	}
+	// steal the oldest task of another worker
+	const int start = worker == -1 ? 0 : worker + 1;
+	for (int i = 0; i < queues; ++i) {
+		const int victim = (start + i) % queues;
+		if (victim == worker) {
+			continue;
+		}
+		if (_queues[victim].popFront(task)) {
+			++_runningTasks;
+			--_pendingTasks;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool ThreadPool::runPendingTask() {
+	Task task;
+	if (!popTask(currentWorker(), task)) {
+		return false;
+	}
+	task();
+	--_runningTasks;
+	return true;
 }
 
 void ThreadPool::abort() {
-	core::ScopedLock lock(_queueMutex);
-	while (!_tasks.empty()) {
-		_tasks.pop();
+	const size_t queues = core_max(_threads, (size_t)1);
+	for (size_t i = 0; i < queues; ++i) {
+		const size_t removed = _queues[i].clear();
+		_pendingTasks.decrement((int)removed);
 	}
 }
 
-void ThreadPool::init() {
+void ThreadPool::init(bool lazy) {
 #ifdef __EMSCRIPTEN__
 #ifndef __EMSCRIPTEN_PTHREADS__
 #error "Compile with -pthread"
@@ -33,6 +168,18 @@ void ThreadPool::init() {
 
 	_force = false;
 	_stop = false;
+	_lazyStart = true;
+	if (!lazy) {
+		startWorkers();
+	}
+}
+
+void ThreadPool::startWorkers() {
+	core::ScopedLock lock(_startMutex);
+	if (!_lazyStart || _stop) {
+		return;
+	}
+	core_trace_scoped(ThreadPoolStartWorkers);
 	_workers.reserve(_threads);
 	for (size_t i = 0; i < _threads; ++i) {
 		_workers.emplace_back([this, i] {
@@ -41,43 +188,51 @@ void ThreadPool::init() {
 				Log::debug("Failed to set thread name for pool thread %i", (int)i);
 			}
 			core_trace_thread(n.c_str());
+			_currentPool = this;
+			_currentWorker = (int)i;
 			for (;;) {
-				std::function<void()> task;
-				{
-					core::ScopedLock lock(this->_queueMutex);
-					if (!this->_stop) {
-						this->_queueCondition.wait(this->_queueMutex, [this] {
-							// predicate must return false if the waiting should continue
-							if (this->_stop) {
-								return true;
-							}
-							if (!this->_tasks.empty()) {
-								return true;
-							}
-							return false;
-						});
-					}
-					if (this->_stop && (this->_force || this->_tasks.empty())) {
-						Log::debug("Shutdown worker thread for %i", (int)i);
-						break;
-					}
-					task = core::move(this->_tasks.front());
-					this->_tasks.pop();
+				Task task;
+				if (popTask((int)i, task)) {
+					core_trace_begin_frame(n.c_str());
+					core_trace_scoped(ThreadPoolWorker);
+					Log::trace("Execute task in %i", (int)i);
+					task();
+					--_runningTasks;
+					Log::trace("End of task in %i", (int)i);
+					core_trace_end_frame(n.c_str());
+					continue;
+				}
+				core::ScopedLock lock(this->_queueMutex);
+				++this->_sleepingWorkers;
+				if (!this->_stop) {
+					this->_queueCondition.wait(this->_queueMutex, [this] {
+						// predicate must return false if the waiting should continue
+						if (this->_stop) {
+							return true;
+						}
+						if (this->_pendingTasks > 0) {
+							return true;
+						}
+						return false;
+					});
+				}
+				--this->_sleepingWorkers;
+				if (this->_stop && (this->_force || this->_pendingTasks <= 0)) {
+					Log::debug("Shutdown worker thread for %i", (int)i);
+					break;
 				}
-
-				core_trace_begin_frame(n.c_str());
-				core_trace_scoped(ThreadPoolWorker);
-				Log::trace("Execute task in %i", (int)i);
-				task();
-				Log::trace("End of task in %i", (int)i);
-				core_trace_end_frame(n.c_str());
 			}
+			_currentPool = nullptr;
+			_currentWorker = -1;
 		});
 	}
+	// the workers must be known before other threads see the started pool - see parallelFor()
+	_lazyStart = false;
 }
 
 ThreadPool::~ThreadPool() {
 	shutdown();
+	delete[] _queues;
 }
 
 void ThreadPool::shutdown(bool wait) {
@@ -85,12 +240,21 @@ void ThreadPool::shutdown(bool wait) {
 		return;
 	}
 	_force = !wait;
-	_stop = true;
-	_queueCondition.notify_all();
+	{
+		// the workers are not started anymore if they were never needed
+		core::ScopedLock lock(_startMutex);
+		_lazyStart = false;
+	}
+	{
+		core::ScopedLock lock(_queueMutex);
+		_stop = true;
+		_queueCondition.notify_all();
+	}
 	for (std::thread &worker : _workers) {
 		worker.join();
 	}
 	_workers.clear();
+	abort();
 }
 
 }
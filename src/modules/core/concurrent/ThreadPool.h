@@ -28,20 +28,134 @@
 #pragma once
 
 #include <thread>
-#include <future>
 #include <functional>
+#include <future>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include "core/Common.h"
 #include "core/collection/DynamicArray.h"
-#include "core/collection/Queue.h"
 #include "core/concurrent/Atomic.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/ConditionVariable.h"
 #include "core/Trace.h"
-#include "core/SharedPtr.h"
 
 namespace core {
 
+/**
+ * @brief Work stealing thread pool
+ *
+ * Each worker has its own task queue. Tasks that are enqueued from inside a worker end up in the queue of that
+ * worker - all other tasks are distributed over the worker queues. A worker without tasks steals from the queues
+ * of the other workers.
+ */
 class ThreadPool final {
 public:
+	/**
+	 * @brief Move only type erased callable. Functors up to @c InlineSize bytes are stored without an allocation.
+	 */
+	class Task {
+	public:
+		static constexpr size_t InlineSize = 48;
+
+		Task() {
+		}
+
+		template<class F, typename = typename std::enable_if<!std::is_same<typename std::decay<F>::type, Task>::value>::type>
+		Task(F &&f) {
+			using Functor = typename std::decay<F>::type;
+			if constexpr (sizeof(Functor) <= InlineSize && alignof(Functor) <= alignof(std::max_align_t) &&
+						  std::is_nothrow_move_constructible<Functor>::value) {
+				new (_storage) Functor(core::forward<F>(f));
+				_ops = &InlineImpl<Functor>::ops;
+			} else {
+				*(Functor **)_storage = new Functor(core::forward<F>(f));
+				_ops = &HeapImpl<Functor>::ops;
+			}
+		}
+
+		Task(Task &&other) noexcept {
+			moveFrom(other);
+		}
+
+		Task &operator=(Task &&other) noexcept {
+			if (this != &other) {
+				reset();
+				moveFrom(other);
+			}
+			return *this;
+		}
+
+		Task(const Task &) = delete;
+		Task &operator=(const Task &) = delete;
+
+		~Task() {
+			reset();
+		}
+
+		void operator()() {
+			_ops->invoke(_storage);
+		}
+
+		explicit operator bool() const {
+			return _ops != nullptr;
+		}
+
+		void reset() {
+			if (_ops != nullptr) {
+				_ops->destroy(_storage);
+				_ops = nullptr;
+			}
+		}
+
+	private:
+		struct Ops {
+			void (*invoke)(void *storage);
+			void (*move)(void *dest, void *src);
+			void (*destroy)(void *storage);
+		};
+
+		template<class F>
+		struct InlineImpl {
+			static void invoke(void *storage) {
+				(*(F *)storage)();
+			}
+			static void move(void *dest, void *src) {
+				new (dest) F(core::move(*(F *)src));
+				((F *)src)->~F();
+			}
+			static void destroy(void *storage) {
+				((F *)storage)->~F();
+			}
+			static constexpr Ops ops{invoke, move, destroy};
+		};
+
+		template<class F>
+		struct HeapImpl {
+			static void invoke(void *storage) {
+				(**(F **)storage)();
+			}
+			static void move(void *dest, void *src) {
+				*(F **)dest = *(F **)src;
+			}
+			static void destroy(void *storage) {
+				delete *(F **)storage;
+			}
+			static constexpr Ops ops{invoke, move, destroy};
+		};
+
+		void moveFrom(Task &other) {
+			_ops = other._ops;
+			if (_ops != nullptr) {
+				_ops->move(_storage, other._storage);
+				other._ops = nullptr;
+			}
+		}
+
+		alignas(std::max_align_t) uint8_t _storage[InlineSize];
+		const Ops *_ops = nullptr;
+	};
+
 	explicit ThreadPool(size_t, const char *name = nullptr);
 	~ThreadPool();
 
@@ -51,8 +165,47 @@ public:
 	template<class F, class ... Args>
 	auto enqueue(F&& f, Args&&... args) -> std::future<typename std::invoke_result<F, Args...>::type>;
 
+	/**
+	 * @brief Enqueue a functor without the overhead of a future
+	 * @return @c false if the pool is stopped and the functor is not executed
+	 */
+	template<class F>
+	bool schedule(F&& f);
+
+	/**
+	 * @brief Calls @c func(rangeStart, rangeEnd) for ranges of @c grain elements of [start, end) on the pool and
+	 * blocks until all of them are executed.
+	 * @note The calling thread executes pending tasks while waiting - so it's fine to call this from inside a task of
+	 * the same pool.
+	 */
+	template<class F>
+	void parallelFor(int start, int end, int grain, F&& func);
+
+	/**
+	 * @brief Execute one pending task on the calling thread
+	 * @return @c false if there was no task to execute
+	 */
+	bool runPendingTask();
+
+	/**
+	 * @return @c true if tasks are queued or executed at the moment
+	 */
+	bool busy() const;
+	/**
+	 * @return The amount of tasks that are queued and not yet executed
+	 */
+	int pendingTasks() const;
+	/**
+	 * @return The amount of tasks that are executed at the moment - by the workers or by threads that wait in
+	 * @c parallelFor()
+	 */
+	int runningTasks() const;
 	size_t size() const;
-	void init();
+	/**
+	 * @param lazy Start the worker threads once the first task is pushed into the pool. Short running applications
+	 * that might not need the pool at all don't pay for spawning the threads then.
+	 */
+	void init(bool lazy = false);
 	/**
 	 * @brief Remove queued and not yet executed tasks
 	 * @note This does not abort the current running task
@@ -62,25 +215,56 @@ public:
 
 	void reserve(size_t n);
 private:
+	/**
+	 * @brief Double ended task queue - the owning worker takes the most recent task from the back,
+	 * other workers steal the oldest task from the front.
+	 */
+	class WorkerQueue {
+	private:
+		core::DynamicArray<Task> _tasks core_thread_guarded_by(_lock);
+		size_t _head core_thread_guarded_by(_lock) = 0u;
+		size_t _count core_thread_guarded_by(_lock) = 0u;
+		core_trace_mutex(core::Lock, _lock, "ThreadPoolWorkerQueue");
+
+		void grow(size_t capacity);
+	public:
+		void push(Task &&task);
+		bool popBack(Task &task);
+		bool popFront(Task &task);
+		size_t clear();
+		void reserve(size_t n);
+	};
+
+	bool push(Task &&task);
+	bool popTask(int worker, Task &task);
+	void startWorkers();
+	int currentWorker() const;
+
 	const size_t _threads;
 	const char *_name;
 	// need to keep track of threads so we can join them
 	core::DynamicArray<std::thread> _workers;
-	// the task queue
-	core::Queue<std::function<void()> > _tasks core_thread_guarded_by(_queueMutex);
+	WorkerQueue *_queues = nullptr;
+	core::AtomicInt _pendingTasks { 0 };
+	/**
+	 * @brief Increased before a popped task is removed from the pending tasks - see @c busy()
+	 */
+	core::AtomicInt _runningTasks { 0 };
+	core::AtomicInt _sleepingWorkers { 0 };
+	core::AtomicInt _nextQueue { 0 };
 
-	// synchronization
+	// synchronization for sleeping workers
 	core_trace_mutex(core::Lock, _queueMutex, "ThreadPoolQueue");
 	core::ConditionVariable _queueCondition;
 	core::AtomicBool _stop { false };
 	core::AtomicBool _force { false };
+	/**
+	 * @brief The workers are not yet started - see init()
+	 */
+	core::AtomicBool _lazyStart { false };
+	core_trace_mutex(core::Lock, _startMutex, "ThreadPoolStart");
 };
 
-inline void ThreadPool::reserve(size_t n) {
-	core::ScopedLock lock(_queueMutex);
-	_tasks.reserve(n);
-}
-
 // add new work item to the pool
 template<class F, class ... Args>
 auto ThreadPool::enqueue(F&& f, Args&&... args)
@@ -90,18 +274,73 @@ auto ThreadPool::enqueue(F&& f, Args&&... args)
 		return std::future<return_type>();
 	}
 
-	core::SharedPtr<std::packaged_task<return_type()> > task = core::make_shared<std::packaged_task<return_type()> >(std::bind(core::forward<F>(f), core::forward<Args>(args)...));
+	std::packaged_task<return_type()> task(std::bind(core::forward<F>(f), core::forward<Args>(args)...));
+	std::future<return_type> res = task.get_future();
+	if (!push(Task(core::move(task)))) {
+		return std::future<return_type>();
+	}
+	return res;
+}
+
+template<class F>
+bool ThreadPool::schedule(F&& f) {
+	if (_stop) {
+		return false;
+	}
+	return push(Task(core::forward<F>(f)));
+}
 
-	std::future<return_type> res = task->get_future();
-	{
-		core::ScopedLock lock(_queueMutex);
-		if (_stop) {
-			return std::future<return_type>();
+template<class F>
+void ThreadPool::parallelFor(int start, int end, int grain, F&& func) {
+	if (end <= start) {
+		return;
+	}
+	if (grain <= 0) {
+		grain = 1;
+	}
+	if (end - start <= grain) {
+		func(start, end);
+		return;
+	}
+	if (_lazyStart) {
+		startWorkers();
+	}
+	if (_workers.empty()) {
+		func(start, end);
+		return;
+	}
+	core::AtomicInt remaining((end - start + grain - 1) / grain);
+	for (int rangeStart = start; rangeStart < end; rangeStart += grain) {
+		const int rangeEnd = core_min(rangeStart + grain, end);
+		auto rangeTask = [&func, &remaining, rangeStart, rangeEnd]() {
+			func(rangeStart, rangeEnd);
+			--remaining;
+		};
+		if (!push(Task(rangeTask))) {
+			rangeTask();
 		}
-		_tasks.emplace([task]() {(*task.get())();});
 	}
-	_queueCondition.notify_one();
-	return res;
+	while (remaining > 0) {
+		if (!runPendingTask()) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+inline int ThreadPool::pendingTasks() const {
+	return _pendingTasks;
+}
+
+inline int ThreadPool::runningTasks() const {
+	return _runningTasks;
+}
+
+inline bool ThreadPool::busy() const {
+	// the pending tasks must be checked first - a popped task is counted as running before it's no longer pending
+	if (_pendingTasks > 0) {
+		return true;
+	}
+	return _runningTasks > 0;
 }
 
 inline size_t ThreadPool::size() const {
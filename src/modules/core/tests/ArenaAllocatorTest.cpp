@@ -0,0 +1,72 @@
+/**
+ * @file
+ */
+
+#include "core/ArenaAllocator.h"
+#include <gtest/gtest.h>
+
+namespace core {
+
+class ArenaAllocatorTest : public testing::Test {};
+
+TEST_F(ArenaAllocatorTest, testAlloc) {
+	ArenaAllocator arena(1024u);
+	EXPECT_EQ(nullptr, arena.alloc(0u));
+	uint8_t *a = (uint8_t *)arena.alloc(10u);
+	uint8_t *b = (uint8_t *)arena.alloc(10u);
+	ASSERT_NE(nullptr, a);
+	ASSERT_NE(nullptr, b);
+	EXPECT_EQ(0u, (uintptr_t)a % 16u);
+	EXPECT_EQ(0u, (uintptr_t)b % 16u);
+	EXPECT_EQ(a + 16, b) << "Both allocations should come from the same block";
+	EXPECT_EQ(20u, arena.used());
+	EXPECT_EQ(1024u, arena.capacity());
+}
+
+TEST_F(ArenaAllocatorTest, testAlignment) {
+	ArenaAllocator arena(1024u);
+	arena.alloc(1u, 1u);
+	void *ptr = arena.alloc(8u, 64u);
+	EXPECT_EQ(0u, (uintptr_t)ptr % 64u);
+	ptr = arena.alloc(2048u, 128u);
+	EXPECT_EQ(0u, (uintptr_t)ptr % 128u);
+}
+
+TEST_F(ArenaAllocatorTest, testBigAllocation) {
+	ArenaAllocator arena(1024u);
+	arena.alloc(16u);
+	void *ptr = arena.alloc(4096u);
+	ASSERT_NE(nullptr, ptr);
+	memset(ptr, 0xff, 4096u);
+	EXPECT_EQ(1024u + 4096u, arena.capacity());
+}
+
+TEST_F(ArenaAllocatorTest, testReallocInPlace) {
+	ArenaAllocator arena(1024u);
+	uint8_t *ptr = (uint8_t *)arena.alloc(16u);
+	ptr[0] = 42;
+	EXPECT_EQ(ptr, arena.realloc(ptr, 16u, 64u)) << "The last allocation should grow in place";
+	uint8_t *other = (uint8_t *)arena.alloc(16u);
+	uint8_t *moved = (uint8_t *)arena.realloc(ptr, 64u, 128u);
+	EXPECT_NE(ptr, moved);
+	EXPECT_NE(other, moved);
+	EXPECT_EQ(42, moved[0]);
+}
+
+TEST_F(ArenaAllocatorTest, testReset) {
+	ArenaAllocator arena(1024u);
+	void *first = arena.alloc(16u);
+	arena.alloc(8192u);
+	arena.alloc(1000u);
+	EXPECT_GT(arena.capacity(), 1024u);
+	const size_t peak = arena.peak();
+	arena.reset();
+	EXPECT_EQ(0u, arena.used());
+	EXPECT_EQ(1024u, arena.capacity());
+	EXPECT_EQ(peak, arena.peak());
+	EXPECT_EQ(first, arena.alloc(16u)) << "The first block should be reused";
+	arena.release();
+	EXPECT_EQ(0u, arena.capacity());
+}
+
+} // namespace core
@@ -22,4 +22,16 @@ TEST(BitsTest, extract1011) {
 	EXPECT_EQ(5u, bits(input, 1, 3));
 }
 
+TEST(BitsTest, countTrailingZeros) {
+	EXPECT_EQ(0, countTrailingZeros(1u));
+	EXPECT_EQ(3, countTrailingZeros(0b1000u));
+	EXPECT_EQ(63, countTrailingZeros(1ull << 63));
+}
+
+TEST(BitsTest, countBits) {
+	EXPECT_EQ(0, countBits(0u));
+	EXPECT_EQ(3, countBits(0b1011u));
+	EXPECT_EQ(64, countBits(~0ull));
+}
+
 }
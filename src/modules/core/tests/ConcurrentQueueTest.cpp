@@ -26,6 +26,23 @@ TEST_F(ConcurrentQueueTest, testPushPop) {
 	}
 }
 
+TEST_F(ConcurrentQueueTest, testPopAll) {
+	core::ConcurrentQueue<int> queue;
+	for (int i = 0; i < 10; ++i) {
+		queue.push(i);
+	}
+	core::DynamicArray<int> out;
+	EXPECT_EQ(10u, queue.popAll(out));
+	EXPECT_TRUE(queue.empty());
+	ASSERT_EQ(10u, out.size());
+	queue.push(10);
+	EXPECT_EQ(1u, queue.popAll(out));
+	ASSERT_EQ(11u, out.size());
+	for (int i = 0; i < 11; ++i) {
+		EXPECT_EQ(i, out[i]);
+	}
+}
+
 TEST_F(ConcurrentQueueTest, testPushWaitAndPop) {
 	core::ConcurrentQueue<int> queue;
 	const int n = 1000;
@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#include "core/collection/ConcurrentRingQueue.h"
+#include <future>
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace collection {
+
+class ConcurrentRingQueueTest : public testing::Test {};
+
+TEST_F(ConcurrentRingQueueTest, testPushPop) {
+	core::ConcurrentRingQueue<int> queue(1000);
+	EXPECT_EQ(1024u, queue.capacity());
+	const int n = 1000;
+	for (int i = 0; i < n; ++i) {
+		ASSERT_TRUE(queue.push(i));
+	}
+	ASSERT_EQ((int)queue.size(), n);
+	for (int i = 0; i < n; ++i) {
+		int v;
+		ASSERT_TRUE(queue.pop(v));
+		ASSERT_EQ(i, v);
+	}
+	int v;
+	EXPECT_FALSE(queue.pop(v));
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(ConcurrentRingQueueTest, testFull) {
+	core::ConcurrentRingQueue<int> queue(4);
+	for (int i = 0; i < 4; ++i) {
+		ASSERT_TRUE(queue.push(i));
+	}
+	EXPECT_FALSE(queue.push(4));
+	int v;
+	ASSERT_TRUE(queue.pop(v));
+	EXPECT_EQ(0, v);
+	EXPECT_TRUE(queue.push(4)) << "The freed slot should be reused in the next lap";
+	EXPECT_EQ(4u, queue.size());
+}
+
+TEST_F(ConcurrentRingQueueTest, testPopAll) {
+	core::ConcurrentRingQueue<int> queue(16);
+	for (int i = 0; i < 10; ++i) {
+		queue.push(i);
+	}
+	core::DynamicArray<int> out;
+	EXPECT_EQ(10u, queue.popAll(out));
+	EXPECT_TRUE(queue.empty());
+	ASSERT_EQ(10u, out.size());
+	for (int i = 0; i < 10; ++i) {
+		EXPECT_EQ(i, out[i]);
+	}
+}
+
+TEST_F(ConcurrentRingQueueTest, testMultipleProducersAndConsumers) {
+	const uint32_t producers = 4u;
+	const uint32_t n = 10000u;
+	core::ConcurrentRingQueue<uint32_t> queue(64);
+	std::thread threads[producers];
+	for (uint32_t p = 0u; p < producers; ++p) {
+		threads[p] = std::thread([&queue, p, n]() {
+			for (uint32_t i = 0u; i < n; ++i) {
+				while (!queue.push(p * n + i)) {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+	auto consume = [&queue, n]() {
+		uint64_t sum = 0u;
+		for (uint32_t i = 0u; i < n * producers / 2u; ++i) {
+			uint32_t v;
+			if (!queue.waitAndPop(v)) {
+				return (uint64_t)0u;
+			}
+			sum += v;
+		}
+		return sum;
+	};
+	std::future<uint64_t> consumer1 = std::async(std::launch::async, consume);
+	std::future<uint64_t> consumer2 = std::async(std::launch::async, consume);
+	for (uint32_t p = 0u; p < producers; ++p) {
+		threads[p].join();
+	}
+	const uint64_t total = (uint64_t)n * producers;
+	EXPECT_EQ(total * (total - 1u) / 2u, consumer1.get() + consumer2.get());
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(ConcurrentRingQueueTest, testAbortWait) {
+	core::ConcurrentRingQueue<int> queue;
+	std::thread threadWait([&]() {
+		int v;
+		EXPECT_FALSE(queue.waitAndPop(v));
+	});
+	std::this_thread::sleep_for(std::chrono::milliseconds(100));
+	queue.abortWait();
+	threadWait.join();
+}
+
+} // namespace collection
@@ -361,4 +361,37 @@ TEST(DynamicArrayTest, testInsertIteratorOperatorInt) {
 	EXPECT_EQ(6, other.end() - other.begin());
 }
 
+TEST(DynamicArrayTest, testGeometricGrowth) {
+	DynamicArray<DynamicArrayStruct, 4> array;
+	for (int i = 0; i < 40; ++i) {
+		array.push_back(DynamicArrayStruct("", i));
+	}
+	EXPECT_EQ(64u, array.capacity()) << array;
+	for (int i = 0; i < 40; ++i) {
+		EXPECT_EQ(i, array[i]._bar) << array;
+	}
+}
+
+TEST(DynamicArrayTest, testReserveExact) {
+	DynamicArray<int, 4> array;
+	array.push_back(1);
+	array.reserve(10);
+	EXPECT_EQ(12u, array.capacity());
+	EXPECT_EQ(1, array[0]);
+}
+
+TEST(DynamicArrayTest, testRelocateTrivial) {
+	DynamicArray<int> array;
+	for (int i = 0; i < 100000; ++i) {
+		array.push_back(i);
+	}
+	const int values[] = {-1, -2, -3};
+	array.append(values, 3);
+	ASSERT_EQ(100003u, array.size());
+	for (int i = 0; i < 100000; ++i) {
+		ASSERT_EQ(i, array[i]);
+	}
+	EXPECT_EQ(-3, array.back());
+}
+
 }
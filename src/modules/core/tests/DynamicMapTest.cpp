@@ -117,7 +117,7 @@ TEST(DynamicMapTest, testIterateRangeBased) {
 }
 
 TEST(DynamicMapTest, testStringSharedPtr) {
-	core::StringMap<core::SharedPtr<core::String>, 4> map;
+	core::StringMap<core::SharedPtr<core::String>> map;
 	auto foobar = core::SharedPtr<core::String>::create("foobar");
 	map.put("foobar", foobar);
 	map.put("barfoo", core::SharedPtr<core::String>::create("barfoo"));
@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/HashMap.h"
+#include "core/collection/StringMap.h"
+
+namespace core {
+
+TEST(RobinHoodHashMapTest, testGrow) {
+	core::HashMap<int, int> map;
+	EXPECT_EQ(0u, map.capacity());
+	for (int i = 0; i < 10000; ++i) {
+		map.put(i, i * 2);
+	}
+	EXPECT_EQ(10000u, map.size());
+	EXPECT_GE(map.capacity(), map.size());
+	for (int i = 0; i < 10000; ++i) {
+		int value = 0;
+		ASSERT_TRUE(map.get(i, value)) << i;
+		EXPECT_EQ(i * 2, value);
+	}
+	EXPECT_FALSE(map.hasKey(10000));
+}
+
+TEST(RobinHoodHashMapTest, testRemove) {
+	core::HashMap<int, int> map;
+	for (int i = 0; i < 1000; ++i) {
+		map.put(i, i);
+	}
+	for (int i = 0; i < 1000; i += 2) {
+		EXPECT_TRUE(map.remove(i));
+	}
+	EXPECT_FALSE(map.remove(0));
+	EXPECT_EQ(500u, map.size());
+	for (int i = 0; i < 1000; ++i) {
+		EXPECT_EQ(i % 2 == 1, map.hasKey(i)) << i;
+	}
+	int cnt = 0;
+	for (auto iter : map) {
+		EXPECT_EQ(1, iter->key % 2);
+		++cnt;
+	}
+	EXPECT_EQ(500, cnt);
+}
+
+TEST(RobinHoodHashMapTest, testStableEntries) {
+	core::HashMap<int, int> map;
+	map.put(1, 42);
+	const int *value = &map.find(1)->value;
+	for (int i = 2; i < 1000; ++i) {
+		map.put(i, i);
+	}
+	EXPECT_EQ(value, &map.find(1)->value) << "Entries must not move when the map grows";
+	EXPECT_EQ(42, *value);
+}
+
+TEST(RobinHoodHashMapTest, testCopyAndMove) {
+	core::StringMap<int> map;
+	map.put("foo", 1);
+	map.put("bar", 2);
+	core::StringMap<int> copy(map);
+	copy.put("foo", 3);
+	int value = 0;
+	EXPECT_TRUE(map.get("foo", value));
+	EXPECT_EQ(1, value);
+	core::StringMap<int> moved(core::move(copy));
+	EXPECT_EQ(0u, copy.size());
+	EXPECT_EQ(2u, moved.size());
+	EXPECT_TRUE(moved.get("foo", value));
+	EXPECT_EQ(3, value);
+}
+
+}
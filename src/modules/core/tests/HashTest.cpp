@@ -0,0 +1,35 @@
+/**
+ * @file
+ */
+
+#include "core/Hash.h"
+#include <gtest/gtest.h>
+
+namespace core {
+
+class HashTest : public testing::Test {};
+
+TEST_F(HashTest, testHash64) {
+	EXPECT_EQ(0xEF46DB3751D8E999ULL, hash64("", 0));
+	EXPECT_EQ(0xD24EC4F1A98C6E5BULL, hash64("a", 1));
+	EXPECT_EQ(0x44BC2CF5AD770999ULL, hash64("abc", 3));
+	EXPECT_EQ(0xFBCEA83C8A378BF1ULL, hash64("Nobody inspects the spammish repetition", 39));
+	EXPECT_NE(hash64("abc", 3), hash64("abc", 3, 1u));
+}
+
+TEST_F(HashTest, testHash64Streaming) {
+	uint8_t buf[1000];
+	for (int i = 0; i < (int)sizeof(buf); ++i) {
+		buf[i] = (uint8_t)(i * 31 + 7);
+	}
+	for (int chunk : {1, 7, 13, 32, 100, 1000}) {
+		Hash64 hasher(42u);
+		for (int i = 0; i < (int)sizeof(buf); i += chunk) {
+			const int n = i + chunk > (int)sizeof(buf) ? (int)sizeof(buf) - i : chunk;
+			hasher.update(buf + i, n);
+		}
+		EXPECT_EQ(hash64(buf, sizeof(buf), 42u), hasher.digest()) << "chunk size " << chunk;
+	}
+}
+
+} // namespace core
@@ -0,0 +1,85 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/Memory.h"
+#include "core/StandardLib.h"
+
+namespace core {
+
+class MemoryTest : public testing::Test {
+protected:
+	void SetUp() override {
+		if (!memory::enabled()) {
+			GTEST_SKIP() << "Memory tracking is not compiled in";
+		}
+	}
+};
+
+TEST_F(MemoryTest, testScope) {
+	EXPECT_EQ(MemoryTag::Default, memory::currentTag());
+	{
+		core_memory_scope(Memento);
+		EXPECT_EQ(MemoryTag::Memento, memory::currentTag());
+		{
+			core_memory_scope(Volume);
+			EXPECT_EQ(MemoryTag::Volume, memory::currentTag());
+		}
+		EXPECT_EQ(MemoryTag::Memento, memory::currentTag());
+	}
+	EXPECT_EQ(MemoryTag::Default, memory::currentTag());
+}
+
+TEST_F(MemoryTest, testAccountToTag) {
+	const MemoryStats before = memory::stats(MemoryTag::Memento);
+	void *mem;
+	{
+		core_memory_scope(Memento);
+		mem = core_malloc(4096);
+	}
+	const MemoryStats allocated = memory::stats(MemoryTag::Memento);
+	EXPECT_EQ(before.live + 4096, allocated.live);
+	EXPECT_GE(allocated.peak, allocated.live);
+	EXPECT_EQ(before.allocations + 1, allocated.allocations);
+	EXPECT_EQ(before.allocatedBytes + 4096, allocated.allocatedBytes);
+
+	// freeing is accounted to the tag of the allocation
+	core_free(mem);
+	EXPECT_EQ(before.live, memory::stats(MemoryTag::Memento).live);
+}
+
+TEST_F(MemoryTest, testReallocKeepsTag) {
+	const MemoryStats before = memory::stats(MemoryTag::Format);
+	void *mem;
+	{
+		core_memory_scope(Format);
+		mem = core_malloc(16);
+	}
+	mem = core_realloc(mem, 1024);
+	ASSERT_NE(nullptr, mem);
+	EXPECT_EQ(before.live + 1024, memory::stats(MemoryTag::Format).live);
+	core_free(mem);
+	EXPECT_EQ(before.live, memory::stats(MemoryTag::Format).live);
+}
+
+TEST_F(MemoryTest, testAlignedAllocation) {
+	const MemoryStats before = memory::stats(MemoryTag::Mesh);
+	void *mem;
+	{
+		core_memory_scope(Mesh);
+		mem = core_aligned_malloc(100);
+	}
+	EXPECT_EQ(0u, (uintptr_t)mem % 16u);
+	EXPECT_GT(memory::stats(MemoryTag::Mesh).live, before.live);
+	core_aligned_free(mem);
+	EXPECT_EQ(before.live, memory::stats(MemoryTag::Mesh).live);
+}
+
+TEST_F(MemoryTest, testTagNames) {
+	for (int i = 0; i < (int)MemoryTag::Max; ++i) {
+		EXPECT_STRNE("invalid", memory::tagName((MemoryTag)i));
+	}
+}
+
+} // namespace core
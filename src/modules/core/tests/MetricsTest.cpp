@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#include "core/Metrics.h"
+#include <gtest/gtest.h>
+#include <math.h>
+
+namespace core {
+
+TEST(MetricsTest, testCounter) {
+	Counter &counter = metrics::counter("metricstest_counter_total", "A test counter");
+	counter.inc();
+	counter.inc(2);
+	EXPECT_EQ(3, counter.value());
+	EXPECT_EQ(&counter, &metrics::counter("metricstest_counter_total"));
+}
+
+TEST(MetricsTest, testGauge) {
+	Gauge &gauge = metrics::gauge("metricstest_gauge");
+	gauge.set(5.0);
+	gauge.add(-2.0);
+	EXPECT_DOUBLE_EQ(3.0, gauge.value());
+}
+
+TEST(MetricsTest, testHistogram) {
+	Histogram &histogram = metrics::histogram("metricstest_seconds");
+	histogram.observe(0.0002);
+	histogram.observe(0.003);
+	histogram.observe(1000.0);
+	EXPECT_EQ(3, histogram.count());
+	EXPECT_NEAR(1000.0032, histogram.sum(), 0.000001);
+	// 0.0001 is the 4th bucket, 0.00025 the 5th
+	EXPECT_EQ(0, histogram.cumulativeCount(3));
+	EXPECT_EQ(1, histogram.cumulativeCount(4));
+	EXPECT_EQ(2, histogram.cumulativeCount(Histogram::Buckets - 1));
+}
+
+TEST(MetricsTest, testPrometheus) {
+	metrics::counter("metricstest_jobs_total{status=\"ok\"}", "The executed jobs").inc(4);
+	metrics::counter("metricstest_jobs_total{status=\"error\"}").inc();
+	metrics::histogram("metricstest_load_seconds{format=\"vox\"}", "The load time").observe(0.5);
+	const core::String &text = metrics::toPrometheus();
+	EXPECT_TRUE(text.contains("# HELP metricstest_jobs_total The executed jobs\n"));
+	EXPECT_TRUE(text.contains("# TYPE metricstest_jobs_total counter\n"));
+	EXPECT_TRUE(text.contains("metricstest_jobs_total{status=\"ok\"} 4\n"));
+	EXPECT_TRUE(text.contains("metricstest_jobs_total{status=\"error\"} 1\n"));
+	EXPECT_TRUE(text.contains("metricstest_load_seconds_bucket{format=\"vox\",le=\"0.5\"} 1\n"));
+	EXPECT_TRUE(text.contains("metricstest_load_seconds_bucket{format=\"vox\",le=\"+Inf\"} 1\n"));
+	EXPECT_TRUE(text.contains("metricstest_load_seconds_count{format=\"vox\"} 1\n"));
+	// the type of a family is only written once
+	EXPECT_EQ(text.find("# TYPE metricstest_jobs_total"), text.rfind("# TYPE metricstest_jobs_total"));
+	// sorted in ascending order
+	EXPECT_LT(text.find("metricstest_jobs_total{status=\"error\"}"), text.find("metricstest_jobs_total{status=\"ok\"}"));
+	EXPECT_LT(text.find("# TYPE metricstest_jobs_total"), text.find("# TYPE metricstest_load_seconds"));
+}
+
+TEST(MetricsTest, testJSON) {
+	metrics::counter("metricstest_json_total{status=\"ok\",format=\"qb\"}").inc();
+	const core::String &json = metrics::toJSON();
+	EXPECT_TRUE(json.contains(
+		"{\"name\":\"metricstest_json_total\",\"type\":\"counter\",\"labels\":{\"status\":\"ok\",\"format\":\"qb\"},"
+		"\"value\":1}"))
+		<< json.c_str();
+}
+
+TEST(MetricsTest, testNonFinite) {
+	metrics::gauge("metricstest_nan").set(NAN);
+	metrics::gauge("metricstest_inf").set(INFINITY);
+	const core::String &json = metrics::toJSON();
+	EXPECT_TRUE(json.contains("{\"name\":\"metricstest_nan\",\"type\":\"gauge\",\"labels\":{},\"value\":null}"))
+		<< json.c_str();
+	EXPECT_TRUE(json.contains("{\"name\":\"metricstest_inf\",\"type\":\"gauge\",\"labels\":{},\"value\":null}"))
+		<< json.c_str();
+	const core::String &text = metrics::toPrometheus();
+	EXPECT_TRUE(text.contains("metricstest_nan NaN\n")) << text.c_str();
+	EXPECT_TRUE(text.contains("metricstest_inf +Inf\n")) << text.c_str();
+}
+
+} // namespace core
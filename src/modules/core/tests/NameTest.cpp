@@ -0,0 +1,52 @@
+/**
+ * @file
+ */
+
+#include "core/Name.h"
+#include <gtest/gtest.h>
+
+namespace core {
+
+class NameTest : public testing::Test {};
+
+TEST_F(NameTest, testIntern) {
+	const Name a("nametest_intern");
+	const Name b(core::String("nametest_intern"));
+	EXPECT_EQ(a, b);
+	EXPECT_EQ(a.c_str(), b.c_str());
+	EXPECT_EQ(a.hash(), b.hash());
+	EXPECT_NE(a, Name("nametest_intern2"));
+	EXPECT_EQ(a, "nametest_intern");
+	EXPECT_EQ(a, core::String("nametest_intern"));
+}
+
+TEST_F(NameTest, testEmpty) {
+	const Name a;
+	EXPECT_TRUE(a.empty());
+	EXPECT_EQ(a, Name(""));
+	EXPECT_EQ(a, Name((const char *)nullptr));
+	EXPECT_STREQ("", a.c_str());
+}
+
+TEST_F(NameTest, testFind) {
+	const size_t count = Name::count();
+	EXPECT_TRUE(Name::find("nametest_find").empty());
+	EXPECT_EQ(count, Name::count());
+	const Name a("nametest_find");
+	EXPECT_EQ(count + 1, Name::count());
+	EXPECT_EQ(a, Name::find("nametest_find"));
+}
+
+TEST_F(NameTest, testNameMap) {
+	NameMap<int> map;
+	map.put("key1", 1);
+	map.put(Name("key2"), 2);
+	int value = 0;
+	EXPECT_TRUE(map.get("key1", value));
+	EXPECT_EQ(1, value);
+	EXPECT_TRUE(map.get(Name::find("key2"), value));
+	EXPECT_EQ(2, value);
+	EXPECT_FALSE(map.hasKey(Name::find("nametest_unknown")));
+}
+
+} // namespace core
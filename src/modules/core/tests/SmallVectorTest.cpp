@@ -0,0 +1,77 @@
+/**
+ * @file
+ */
+
+#include <gtest/gtest.h>
+#include "core/collection/SmallVector.h"
+#include "core/String.h"
+
+namespace core {
+
+TEST(SmallVectorTest, testInlineStorage) {
+	SmallVector<int, 4> array;
+	EXPECT_TRUE(array.isInline());
+	EXPECT_EQ(4u, array.capacity());
+	for (int i = 0; i < 4; ++i) {
+		array.push_back(i);
+	}
+	EXPECT_TRUE(array.isInline());
+	array.push_back(4);
+	EXPECT_FALSE(array.isInline());
+	ASSERT_EQ(5u, array.size());
+	for (int i = 0; i < 5; ++i) {
+		EXPECT_EQ(i, array[i]);
+	}
+	array.release();
+	EXPECT_TRUE(array.isInline());
+	EXPECT_TRUE(array.empty());
+}
+
+TEST(SmallVectorTest, testErase) {
+	SmallVector<core::String, 2> array{"a", "b", "c", "d"};
+	array.erase(1);
+	ASSERT_EQ(3u, array.size());
+	EXPECT_EQ("a", array[0]);
+	EXPECT_EQ("c", array[1]);
+	EXPECT_EQ("d", array[2]);
+	auto iter = array.erase(array.begin());
+	EXPECT_EQ("c", *iter);
+	array.erase(array.begin(), 10);
+	EXPECT_TRUE(array.empty());
+}
+
+TEST(SmallVectorTest, testCopyAndMove) {
+	SmallVector<core::String, 2> small{"a"};
+	SmallVector<core::String, 2> big{"a", "b", "c"};
+
+	SmallVector<core::String, 2> copy(big);
+	ASSERT_EQ(3u, copy.size());
+	EXPECT_EQ("c", copy[2]);
+	copy = small;
+	ASSERT_EQ(1u, copy.size());
+	EXPECT_EQ("a", copy[0]);
+
+	SmallVector<core::String, 2> movedSmall(core::move(small));
+	EXPECT_TRUE(small.empty());
+	EXPECT_TRUE(movedSmall.isInline());
+	ASSERT_EQ(1u, movedSmall.size());
+	EXPECT_EQ("a", movedSmall[0]);
+
+	SmallVector<core::String, 2> movedBig;
+	movedBig = core::move(big);
+	EXPECT_TRUE(big.empty());
+	EXPECT_TRUE(big.isInline());
+	ASSERT_EQ(3u, movedBig.size());
+	EXPECT_EQ("b", movedBig[1]);
+}
+
+TEST(SmallVectorTest, testResize) {
+	SmallVector<int, 2> array;
+	array.resize(8);
+	EXPECT_EQ(8u, array.size());
+	EXPECT_EQ(0, array.back());
+	array.resize(1);
+	EXPECT_EQ(1u, array.size());
+}
+
+} // namespace core
@@ -277,4 +277,31 @@ TEST_F(StringUtilTest, testFileMatchesMultiple) {
 	EXPECT_FALSE(core::string::fileMatchesMultiple("foobar.txt", "bar,foo"));
 }
 
+TEST_F(StringUtilTest, testParseFloatRange) {
+	const char *str = " 1.5e2,-0.25 x";
+	const char *end = str + strlen(str);
+	float value = 0.0f;
+	const char *p = core::string::parseFloat(str, end, value);
+	ASSERT_NE(nullptr, p);
+	EXPECT_FLOAT_EQ(150.0f, value);
+	EXPECT_EQ(',', *p);
+	p = core::string::parseFloat(p + 1, end, value);
+	ASSERT_NE(nullptr, p);
+	EXPECT_FLOAT_EQ(-0.25f, value);
+	EXPECT_EQ(nullptr, core::string::parseFloat(p, end, value));
+}
+
+TEST_F(StringUtilTest, testParseIntRange) {
+	// the range is not null terminated
+	const char *str = "-42 17";
+	int32_t value = 0;
+	const char *p = core::string::parseInt(str, str + 5, value);
+	ASSERT_NE(nullptr, p);
+	EXPECT_EQ(-42, value);
+	p = core::string::parseInt(p, str + 5, value);
+	ASSERT_NE(nullptr, p);
+	EXPECT_EQ(1, value);
+	EXPECT_EQ(nullptr, core::string::parseInt(p, str + 5, value));
+}
+
 }
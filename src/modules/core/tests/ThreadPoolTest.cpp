@@ -5,6 +5,7 @@
 #include <gtest/gtest.h>
 #include "core/concurrent/ThreadPool.h"
 #include "core/concurrent/Atomic.h"
+#include "core/collection/Array.h"
 
 namespace core {
 
@@ -42,4 +43,125 @@ TEST_F(ThreadPoolTest, testMultiplePush) {
 	ASSERT_EQ(x, _count) << "Not all threads were executed";
 }
 
+TEST_F(ThreadPoolTest, testSchedule) {
+	const int x = 1000;
+	core::ThreadPool pool(4);
+	pool.init();
+	for (int i = 0; i < x; ++i) {
+		ASSERT_TRUE(pool.schedule([this] () {
+			++_count;
+		}));
+	}
+	pool.shutdown(true);
+	ASSERT_EQ(x, _count) << "Not all tasks were executed";
+	ASSERT_FALSE(pool.schedule([] () {})) << "A stopped pool should not accept new tasks";
+}
+
+TEST_F(ThreadPoolTest, testEnqueueLargeFunctor) {
+	core::ThreadPool pool(2);
+	pool.init();
+	// exceeds the inline storage of the task
+	const core::Array<int, 64> values {};
+	auto future = pool.enqueue([values] () {
+		return (int)values.size();
+	});
+	ASSERT_EQ(64, future.get());
+}
+
+TEST_F(ThreadPoolTest, testParallelFor) {
+	core::ThreadPool pool(3);
+	pool.init();
+	core::AtomicInt sum;
+	pool.parallelFor(0, 1000, 7, [&sum] (int start, int end) {
+		for (int i = start; i < end; ++i) {
+			sum.increment(i);
+		}
+	});
+	ASSERT_EQ(999 * 1000 / 2, sum);
+}
+
+TEST_F(ThreadPoolTest, testNestedParallelFor) {
+	core::ThreadPool pool(2);
+	pool.init();
+	pool.parallelFor(0, 8, 1, [this, &pool] (int, int) {
+		// the outer task helps to execute the inner ranges - this must not dead lock
+		pool.parallelFor(0, 100, 10, [this] (int start, int end) {
+			_count.increment(end - start);
+		});
+	});
+	ASSERT_EQ(800, _count);
+}
+
+TEST_F(ThreadPoolTest, testLazyInit) {
+	core::ThreadPool pool(2);
+	pool.init(true);
+	auto future = pool.enqueue([this] () {
+		_executed = true;
+	});
+	future.get();
+	ASSERT_TRUE(_executed) << "The workers weren't started with the first task";
+	core::AtomicInt sum;
+	pool.parallelFor(0, 100, 10, [&sum] (int start, int end) {
+		for (int i = start; i < end; ++i) {
+			sum.increment(i);
+		}
+	});
+	ASSERT_EQ(99 * 100 / 2, sum);
+}
+
+TEST_F(ThreadPoolTest, testLazyInitUnused) {
+	core::ThreadPool pool(2);
+	pool.init(true);
+	pool.shutdown(true);
+	EXPECT_FALSE(pool.schedule([this] () {
+		_executed = true;
+	}));
+	EXPECT_FALSE(_executed);
+}
+
+TEST_F(ThreadPoolTest, testBusy) {
+	core::ThreadPool pool(1);
+	pool.init();
+	ASSERT_FALSE(pool.busy());
+	core::AtomicBool release(false);
+	ASSERT_TRUE(pool.schedule([&release, this] () {
+		while (!release) {
+			std::this_thread::yield();
+		}
+		_executed = true;
+	}));
+	// the task is either queued or running
+	ASSERT_TRUE(pool.busy());
+	release = true;
+	while (pool.busy()) {
+		std::this_thread::yield();
+	}
+	ASSERT_TRUE(_executed);
+}
+
+TEST_F(ThreadPoolTest, testPendingTasks) {
+	core::ThreadPool pool(1);
+	pool.init();
+	ASSERT_EQ(0, pool.pendingTasks());
+	core::AtomicBool started(false);
+	core::AtomicBool release(false);
+	ASSERT_TRUE(pool.schedule([&started, &release] () {
+		started = true;
+		while (!release) {
+			std::this_thread::yield();
+		}
+	}));
+	while (!started) {
+		std::this_thread::yield();
+	}
+	// the only worker is blocked - the next tasks stay in the queue
+	ASSERT_TRUE(pool.schedule([this] () { ++_count; }));
+	ASSERT_TRUE(pool.schedule([this] () { ++_count; }));
+	EXPECT_EQ(2, pool.pendingTasks());
+	release = true;
+	pool.shutdown(true);
+	EXPECT_EQ(0, pool.pendingTasks());
+	EXPECT_EQ(2, _count);
+}
+
 }
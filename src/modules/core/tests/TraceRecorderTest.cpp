@@ -0,0 +1,66 @@
+/**
+ * @file
+ */
+
+#include "core/TraceRecorder.h"
+#include "core/StringUtil.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace core {
+
+class TraceRecorderTest : public testing::Test {};
+
+TEST_F(TraceRecorderTest, testRecordOnlyIfActive) {
+	TraceRecorder recorder;
+	recorder.traceBegin("Main", "Scope");
+	recorder.traceEnd("Main");
+	EXPECT_EQ(0u, recorder.events());
+	recorder.start();
+	recorder.traceBegin("Main", "Scope");
+	recorder.traceEnd("Main");
+	recorder.stop();
+	recorder.traceBegin("Main", "Scope");
+	EXPECT_EQ(2u, recorder.events());
+}
+
+TEST_F(TraceRecorderTest, testChromeJSON) {
+	TraceRecorder recorder;
+	recorder.start();
+	recorder.traceBeginFrame("Main");
+	recorder.traceBegin("Main", "Outer");
+	recorder.traceBegin("Main", "Inner");
+	recorder.traceEnd("Main");
+	recorder.traceEnd("Main");
+	recorder.traceEndFrame("Main");
+	std::thread thread([&recorder]() {
+		recorder.traceBegin("Worker \"1\"", "Job");
+		recorder.traceEnd("Worker \"1\"");
+	});
+	thread.join();
+	recorder.stop();
+	EXPECT_EQ(8u, recorder.events());
+
+	const core::String &json = recorder.toChromeJSON();
+	EXPECT_TRUE(core::string::startsWith(json, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[")) << json.c_str();
+	EXPECT_TRUE(core::string::endsWith(json, "]}")) << json.c_str();
+	EXPECT_NE(json.find("\"name\":\"Frame\""), core::String::npos) << json.c_str();
+	EXPECT_NE(json.find("\"name\":\"Outer\""), core::String::npos) << json.c_str();
+	EXPECT_NE(json.find("\"name\":\"Inner\""), core::String::npos) << json.c_str();
+	EXPECT_NE(json.find("\"name\":\"Job\""), core::String::npos) << json.c_str();
+	EXPECT_NE(json.find("\"args\":{\"name\":\"Worker \\\"1\\\"\"}"), core::String::npos) << json.c_str();
+	EXPECT_NE(json.find("\"tid\":2"), core::String::npos) << "The worker should get its own thread id: " << json.c_str();
+}
+
+TEST_F(TraceRecorderTest, testRestartDropsEvents) {
+	TraceRecorder recorder;
+	recorder.start();
+	recorder.traceBegin("Main", "Scope");
+	recorder.traceEnd("Main");
+	recorder.start();
+	EXPECT_EQ(0u, recorder.events());
+	recorder.traceBegin("Main", "Scope");
+	EXPECT_EQ(1u, recorder.events());
+}
+
+} // namespace core
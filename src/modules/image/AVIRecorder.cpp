@@ -8,6 +8,9 @@
 #include "core/Log.h"
 #include "core/Var.h"
 #include "core/concurrent/Thread.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/Trace.h"
+#include "io/BufferedReadWriteStream.h"
 #include "io/Filesystem.h"
 
 namespace image {
@@ -22,27 +25,106 @@ bool AVIRecorder::isRecording() const {
 	return true;
 }
 
+void AVIRecorder::setMaxPendingFrames(uint32_t maxPendingFrames) {
+	_maxPendingFrames = core_max(1u, maxPendingFrames);
+}
+
+void AVIRecorder::waitForQueueSpace() {
+	core::ScopedLock lock(_pendingLock);
+	while (!_stop && (uint32_t)(int)_pendingFrames >= _maxPendingFrames) {
+		_pendingCondition.wait(_pendingLock);
+	}
+}
+
+void AVIRecorder::frameWritten(int amount) {
+	_pendingFrames.decrement(amount);
+	core::ScopedLock lock(_pendingLock);
+	_pendingCondition.notify_all();
+}
+
+void AVIRecorder::queueFrame(image::ImagePtr &&image) {
+	waitForQueueSpace();
+	_pendingFrames.increment();
+	// the pending frames limit keeps the ring from running full - unless several threads are queueing frames
+	if (!_frameQueue.push(core::move(image))) {
+		Log::warn("Dropped a frame - the frame queue is full");
+		frameWritten(1);
+	}
+}
+
 void AVIRecorder::enqueueFrame(const image::ImagePtr &image) {
-	if (!image || !image->isLoaded()) {
+	if (!image || !image->isLoaded() || !isRecording()) {
+		return;
+	}
+	image::ImagePtr copy = image;
+	queueFrame(core::move(copy));
+}
+
+void AVIRecorder::enqueueFrame(image::ImagePtr &&image) {
+	if (!image || !image->isLoaded() || !isRecording()) {
 		return;
 	}
-	_frameQueue.push(image);
+	queueFrame(core::move(image));
 }
 
 uint32_t AVIRecorder::pendingFrames() const {
 	if (_videoWriteStream == nullptr) {
 		return 0u;
 	}
-	return _frameQueue.size();
+	return (uint32_t)(int)_pendingFrames;
+}
+
+void AVIRecorder::encodeBatch(core::DynamicArray<image::ImagePtr> &batch) {
+	core_trace_scoped(AVIRecorderEncodeBatch);
+	const int n = (int)batch.size();
+	core::DynamicArray<uint8_t *> jpegs;
+	jpegs.resize(n);
+	core::DynamicArray<int64_t> sizes;
+	sizes.resize(n);
+	// every frame is a key frame - the jpeg compression doesn't depend on the other frames
+	app::App::getInstance()->threadPool().parallelFor(0, n, 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const image::ImagePtr &image = batch[i];
+			io::BufferedReadWriteStream stream((int64_t)image->width() * image->height());
+			if (image::Image::writeJPEG(stream, image->data(), image->width(), image->height(), 4)) {
+				sizes[i] = stream.size();
+				jpegs[i] = stream.release();
+			} else {
+				sizes[i] = 0;
+				jpegs[i] = nullptr;
+			}
+		}
+	});
+	for (int i = 0; i < n; ++i) {
+		if (jpegs[i] == nullptr) {
+			Log::error("Failed to write jpeg data");
+		} else if (!_avi.writeJPEGFrame(*_videoWriteStream, jpegs[i], (size_t)sizes[i])) {
+			Log::error("Failed to write the avi frame");
+		}
+		core_free(jpegs[i]);
+	}
+	batch.clear();
+	frameWritten(n);
 }
 
 int AVIRecorder::encodeFrame(void *data) {
 	AVIRecorder *inst = (AVIRecorder *)data;
-	while (!inst->_stop) {
-		image::ImagePtr image;
-		while (inst->_frameQueue.pop(image)) {
-			inst->_avi.writeFrame(*inst->_videoWriteStream, image->data(), image->width(), image->height());
+	const size_t batchSize = core_max((size_t)1u, app::App::getInstance()->threadPool().size());
+	core::DynamicArray<image::ImagePtr> batch;
+	batch.reserve(batchSize);
+	image::ImagePtr image;
+	// sleep until a frame is queued - the wait is aborted by stopRecording()
+	while (inst->_frameQueue.waitAndPop(image)) {
+		batch.push_back(core::move(image));
+		while (batch.size() < batchSize && inst->_frameQueue.pop(image)) {
+			batch.push_back(core::move(image));
 		}
+		inst->encodeBatch(batch);
+	}
+	// encode the frames that were queued before the recording was stopped
+	inst->_frameQueue.popAll(batch);
+	if (!batch.empty()) {
+		inst->encodeBatch(batch);
 	}
 	return 0;
 }
@@ -62,6 +144,10 @@ bool AVIRecorder::startRecording(const char *filename, int width, int height) {
 		_videoWriteStream = nullptr;
 		return false;
 	}
+	_stop = false;
+	_pendingFrames = 0;
+	_frameQueue.init(_maxPendingFrames);
+	_frameQueue.reset();
 	Log::debug("Starting avirecorder thread");
 	_thread = new core::Thread("avirecorder", encodeFrame, this);
 	return true;
@@ -72,21 +158,26 @@ bool AVIRecorder::stopRecording() {
 		return false;
 	}
 	_stop = true;
+	_frameQueue.abortWait();
+	{
+		core::ScopedLock lock(_pendingLock);
+		_pendingCondition.notify_all();
+	}
 	return true;
 }
 
 bool AVIRecorder::hasFinished() const {
-	if (!isRecording()) {
+	if (_videoWriteStream == nullptr) {
 		return false;
 	}
 	if (!_stop) {
 		return false;
 	}
-	return _frameQueue.empty();
+	return (int)_pendingFrames == 0;
 }
 
 bool AVIRecorder::flush() {
-	if (!isRecording()) {
+	if (_videoWriteStream == nullptr) {
 		return true;
 	}
 	if (_thread->join() != 0) {
@@ -103,6 +194,11 @@ bool AVIRecorder::flush() {
 void AVIRecorder::abort() {
 	_frameQueue.clear();
 	_stop = true;
+	_frameQueue.abortWait();
+	{
+		core::ScopedLock lock(_pendingLock);
+		_pendingCondition.notify_all();
+	}
 	flush();
 }
 
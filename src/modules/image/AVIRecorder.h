@@ -2,8 +2,12 @@
  * @file
  */
 
-#include "core/collection/ConcurrentQueue.h"
+#pragma once
+
+#include "core/collection/ConcurrentRingQueue.h"
 #include "core/concurrent/Atomic.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
 #include "image/AVI.h"
 #include "image/Image.h"
 #include "io/FileStream.h"
@@ -14,15 +18,34 @@ class Thread;
 
 namespace image {
 
+/**
+ * @brief Records the given frames into a motion jpeg avi
+ *
+ * The frames are compressed in batches on the thread pool of the app and written in the order they were queued.
+ * The amount of frames that are queued or being compressed is bounded - see setMaxPendingFrames().
+ */
 class AVIRecorder {
 private:
 	image::AVI _avi;
 	io::FileStream *_videoWriteStream = nullptr;
-	core::ConcurrentQueue<image::ImagePtr> _frameQueue;
+	/** sized for the max pending frames - see setMaxPendingFrames() */
+	core::ConcurrentRingQueue<image::ImagePtr> _frameQueue;
 	core::AtomicBool _stop = false;
 	core::Thread *_thread = nullptr;
+	/** the frames that are queued or compressed but not yet written */
+	core::AtomicInt _pendingFrames;
+	uint32_t _maxPendingFrames = 16u;
+	core::Lock _pendingLock;
+	core::ConditionVariable _pendingCondition;
 
 	static int encodeFrame(void *data);
+	/**
+	 * @brief Compresses the frames of the batch in parallel and writes them in order
+	 */
+	void encodeBatch(core::DynamicArray<image::ImagePtr> &batch);
+	void waitForQueueSpace();
+	void queueFrame(image::ImagePtr &&image);
+	void frameWritten(int amount);
 
 public:
 	~AVIRecorder() {
@@ -30,7 +53,21 @@ public:
 	}
 	bool isRecording() const;
 	bool startRecording(const char *filename, int width, int height);
+	/**
+	 * @brief Limits the amount of frames that are waiting for the encoding to bound the memory usage
+	 *
+	 * If the limit is reached, enqueueFrame() blocks until the encoder has written a frame.
+	 */
+	void setMaxPendingFrames(uint32_t maxPendingFrames);
+	/**
+	 * @note Blocks if the max amount of pending frames is reached
+	 * @sa setMaxPendingFrames()
+	 */
 	void enqueueFrame(const image::ImagePtr &image);
+	/**
+	 * @brief Hands the image over to the encoding thread without touching the reference count
+	 */
+	void enqueueFrame(image::ImagePtr &&image);
 	/**
 	 * @brief Returns @c true if all queued frames were encoded and are part of the avi
 	 * @note stopRecording() must have been called before!
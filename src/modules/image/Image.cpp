@@ -6,9 +6,13 @@
 #include "core/Color.h"
 #include "core/Log.h"
 #include "app/App.h"
+#include "core/Memory.h"
 #include "core/StringUtil.h"
 #include "core/concurrent/ThreadPool.h"
 #include "core/Assert.h"
+#include "core/Trace.h"
+#include "core/ZipBackend.h"
+#include "core/collection/DynamicArray.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/Filesystem.h"
 #include "core/StandardLib.h"
@@ -59,6 +63,7 @@ Image::~Image() {
 }
 
 bool Image::load(const io::FilePtr& file) {
+	core_memory_scope(Image);
 	uint8_t* buffer;
 	const int length = file->read((void**) &buffer);
 	const bool status = load(buffer, length);
@@ -170,6 +175,7 @@ static int stream_eos(void *user) {
 }
 
 bool Image::load(io::SeekableReadStream &stream, int length) {
+	core_memory_scope(Image);
 	if (length <= 0) {
 		_state = io::IOSTATE_FAILED;
 		Log::debug("Failed to load image %s: buffer empty", _name.c_str());
@@ -254,6 +260,51 @@ void Image::flipVerticalRGBA(uint8_t *pixels, int w, int h) {
 	}
 }
 
+void Image::flipVertical() {
+	if (_data == nullptr || _depth != 4) {
+		return;
+	}
+	flipVerticalRGBA(_data, _width, _height);
+}
+
+bool Image::resize(int width, int height) {
+	if (_data == nullptr || _depth != 4 || width <= 0 || height <= 0) {
+		return false;
+	}
+	if (width == _width && height == _height) {
+		return true;
+	}
+	core_trace_scoped(ImageResize);
+	uint8_t *data = (uint8_t *)STBI_MALLOC((size_t)width * height * 4);
+	for (int y = 0; y < height; ++y) {
+		const int srcY0 = (int)((int64_t)y * _height / height);
+		const int srcY1 = glm::max(srcY0 + 1, (int)((int64_t)(y + 1) * _height / height));
+		for (int x = 0; x < width; ++x) {
+			const int srcX0 = (int)((int64_t)x * _width / width);
+			const int srcX1 = glm::max(srcX0 + 1, (int)((int64_t)(x + 1) * _width / width));
+			uint32_t sum[4]{0u, 0u, 0u, 0u};
+			for (int sy = srcY0; sy < srcY1; ++sy) {
+				const uint8_t *src = _data + ((size_t)sy * _width + srcX0) * 4;
+				for (int sx = srcX0; sx < srcX1; ++sx, src += 4) {
+					for (int c = 0; c < 4; ++c) {
+						sum[c] += src[c];
+					}
+				}
+			}
+			const uint32_t n = (uint32_t)((srcY1 - srcY0) * (srcX1 - srcX0));
+			uint8_t *dst = data + ((size_t)y * width + x) * 4;
+			for (int c = 0; c < 4; ++c) {
+				dst[c] = (uint8_t)((sum[c] + n / 2) / n);
+			}
+		}
+	}
+	stbi_image_free(_data);
+	_data = data;
+	_width = width;
+	_height = height;
+	return true;
+}
+
 // OpenGL Spec 14.8.2 Coordinate Wrapping and Texel Selection
 glm::ivec2 Image::pixels(const glm::vec2 &uv, TextureWrap wrapS, TextureWrap wrapT) const {
 	const float w = (float)width();
@@ -320,7 +371,134 @@ glm::vec2 Image::uv(int x, int y, int w, int h) {
 	return glm::vec2((float)x / (float)w, ((float)h - (float)y) / (float)h);
 }
 
+static PngCompression _pngCompression;
+
+void setPngCompression(const PngCompression &compression) {
+	_pngCompression = compression;
+	_pngCompression.level = glm::clamp(compression.level, 0, 9);
+}
+
+const PngCompression &pngCompression() {
+	return _pngCompression;
+}
+
+static inline void writePngUInt32(uint8_t *out, uint32_t v) {
+	out[0] = (uint8_t)(v >> 24);
+	out[1] = (uint8_t)(v >> 16);
+	out[2] = (uint8_t)(v >> 8);
+	out[3] = (uint8_t)v;
+}
+
+static bool writePngChunk(io::WriteStream &stream, const char *type, const uint8_t *data, size_t size) {
+	uint8_t header[8];
+	writePngUInt32(header, (uint32_t)size);
+	core_memcpy(header + 4, type, 4);
+	zip_ulong crc = ZIP_FUNC(crc32)(0, header + 4, 4);
+	if (size > 0u) {
+		crc = ZIP_FUNC(crc32)(crc, data, (uint32_t)size);
+	}
+	uint8_t footer[4];
+	writePngUInt32(footer, (uint32_t)crc);
+	if (stream.write(header, sizeof(header)) != (int)sizeof(header)) {
+		return false;
+	}
+	if (size > 0u && stream.write(data, size) != (int)size) {
+		return false;
+	}
+	return stream.write(footer, sizeof(footer)) == (int)sizeof(footer);
+}
+
+/**
+ * @brief Single pass png encoder - every row uses the up filter (the first row the sub filter) and is deflated
+ * directly after it was filtered. This trades a few percent of the file size for the per row filter estimation.
+ */
+static bool writePngFast(io::WriteStream &stream, const uint8_t *pixels, int width, int height, int depth, int level) {
+	if (pixels == nullptr || width <= 0 || height <= 0 || depth < 1 || depth > 4) {
+		return false;
+	}
+	core_trace_scoped(WritePngFast);
+	static const uint8_t colorTypes[] = {0, 4, 2, 6};
+	const size_t stride = (size_t)width * depth;
+
+	core::zip::Stream zstream;
+	core_memset(&zstream, 0, sizeof(zstream));
+	if (ZIP_FUNC(deflateInit)(&zstream, level) != ZIP_CONST(OK)) {
+		Log::error("Failed to initialize the png deflate stream");
+		return false;
+	}
+	const size_t rawSize = (stride + 1u) * (size_t)height;
+	core::DynamicArray<uint8_t> compressed;
+	compressed.resize(ZIP_FUNC(deflateBound)(&zstream, (zip_ulong)rawSize));
+	zstream.next_out = compressed.data();
+	zstream.avail_out = (uint32_t)compressed.size();
+
+	core::DynamicArray<uint8_t> line;
+	line.resize(stride + 1u);
+	bool success = true;
+	for (int y = 0; y < height; ++y) {
+		const uint8_t *row = pixels + (size_t)y * stride;
+		uint8_t *out = line.data() + 1;
+		if (y == 0) {
+			line[0] = 1; // sub
+			for (int i = 0; i < depth; ++i) {
+				out[i] = row[i];
+			}
+			for (size_t i = depth; i < stride; ++i) {
+				out[i] = (uint8_t)(row[i] - row[i - depth]);
+			}
+		} else {
+			line[0] = 2; // up
+			const uint8_t *prev = row - stride;
+			for (size_t i = 0; i < stride; ++i) {
+				out[i] = (uint8_t)(row[i] - prev[i]);
+			}
+		}
+		zstream.next_in = line.data();
+		zstream.avail_in = (uint32_t)line.size();
+		const int flush = y == height - 1 ? ZIP_CONST(FINISH) : ZIP_CONST(NO_FLUSH);
+		const int ret = ZIP_FUNC(deflate)(&zstream, flush);
+		if (ret != ZIP_CONST(OK) && ret != ZIP_CONST(STREAM_END)) {
+			Log::error("Failed to deflate the png data: %s", ZIP_ERROR_STRING(ret));
+			success = false;
+			break;
+		}
+	}
+	const size_t compressedSize = compressed.size() - zstream.avail_out;
+	ZIP_FUNC(deflateEnd)(&zstream);
+	if (!success) {
+		return false;
+	}
+
+	static const uint8_t signature[] = {137, 80, 78, 71, 13, 10, 26, 10};
+	if (stream.write(signature, sizeof(signature)) != (int)sizeof(signature)) {
+		return false;
+	}
+	uint8_t ihdr[13];
+	writePngUInt32(ihdr, (uint32_t)width);
+	writePngUInt32(ihdr + 4, (uint32_t)height);
+	ihdr[8] = 8; // bits per channel
+	ihdr[9] = colorTypes[depth - 1];
+	ihdr[10] = 0; // deflate
+	ihdr[11] = 0; // adaptive filtering
+	ihdr[12] = 0; // no interlacing
+	if (!writePngChunk(stream, "IHDR", ihdr, sizeof(ihdr))) {
+		return false;
+	}
+	if (!writePngChunk(stream, "IDAT", compressed.data(), compressedSize)) {
+		return false;
+	}
+	return writePngChunk(stream, "IEND", nullptr, 0u);
+}
+
 uint8_t* createPng(const void *pixels, int width, int height, int depth, int *pngSize) {
+	if (_pngCompression.fast) {
+		io::BufferedReadWriteStream stream((int64_t)width * height * depth / 2);
+		if (!writePngFast(stream, (const uint8_t *)pixels, width, height, depth, _pngCompression.level)) {
+			return nullptr;
+		}
+		*pngSize = (int)stream.size();
+		return stream.release();
+	}
 	return (uint8_t*)stbi_write_png_to_mem((const unsigned char*)pixels, 0, width, height, depth, pngSize);
 }
 
@@ -340,6 +518,9 @@ bool Image::writeJPEG(io::SeekableWriteStream &stream, const uint8_t* buffer, in
 }
 
 bool Image::writePng(io::SeekableWriteStream &stream, const uint8_t* buffer, int width, int height, int depth) {
+	if (_pngCompression.fast) {
+		return writePngFast(stream, buffer, width, height, depth, _pngCompression.level);
+	}
 	return stbi_write_png_to_func(stream_write_func, &stream, width, height, depth, (const void*)buffer, width * depth) != 0;
 }
 
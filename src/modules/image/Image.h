@@ -56,6 +56,15 @@ public:
 	static glm::vec2 uv(int x, int y, int w, int h);
 
 	static void flipVerticalRGBA(uint8_t *pixels, int w, int h);
+	/**
+	 * @brief Flips the rows of the loaded rgba image
+	 */
+	void flipVertical();
+	/**
+	 * @brief Scales the loaded rgba image to the given size - every target pixel is the average of the source pixels it
+	 * covers
+	 */
+	bool resize(int width, int height);
 	bool writePng(io::SeekableWriteStream &stream) const;
 	static bool writePng(io::SeekableWriteStream &stream, const uint8_t* buffer, int width, int height, int depth);
 	/**
@@ -99,6 +108,25 @@ inline ImagePtr createEmptyImage(const core::String& name) {
 	return core::make_shared<Image>(name);
 }
 
+/**
+ * @brief The settings of the png encoder that are used by all png writes of this module
+ */
+struct PngCompression {
+	/**
+	 * Use the fast encoder - one filter for all rows and a single pass deflate - instead of estimating the best
+	 * filter for every row
+	 */
+	bool fast = false;
+	/** The deflate level of the fast encoder (0 is no compression, 1 is the best speed, 9 is the best compression) */
+	int level = 1;
+};
+
+void setPngCompression(const PngCompression &compression);
+const PngCompression &pngCompression();
+
+/**
+ * @note The returned buffer must be freed with core_free()
+ */
 uint8_t* createPng(const void *pixels, int width, int height, int depth, int *pngSize);
 ImagePtr loadImage(const io::FilePtr& file);
 ImagePtr loadImage(const core::String &name, io::SeekableReadStream &stream, int length = -1);
@@ -3,6 +3,7 @@
  */
 
 #include "image/AVI.h"
+#include "image/AVIRecorder.h"
 #include "app/App.h"
 #include "app/tests/AbstractTest.h"
 #include "core/RGBA.h"
@@ -56,4 +57,28 @@ TEST_F(AVITest, testCreate) {
 	ASSERT_TRUE(avi.close(stream));
 }
 
+TEST_F(AVITest, testRecorder) {
+	const core::RGBA r = core::RGBA(255, 0, 0);
+	const core::RGBA pixels[]{r, r, r, r, r, r, r, r, r};
+	AVIRecorder recorder;
+	recorder.setMaxPendingFrames(4u);
+	for (int recording = 0; recording < 2; ++recording) {
+		ASSERT_TRUE(recorder.startRecording("testrecorder.avi", 3, 3));
+		ASSERT_TRUE(recorder.isRecording());
+		for (int i = 0; i < 20; ++i) {
+			image::ImagePtr image = image::createEmptyImage("frame");
+			ASSERT_TRUE(image->loadRGBA((const uint8_t *)pixels, 3, 3));
+			recorder.enqueueFrame(core::move(image));
+			EXPECT_LE(recorder.pendingFrames(), 4u);
+		}
+		ASSERT_TRUE(recorder.stopRecording());
+		EXPECT_FALSE(recorder.isRecording());
+		// the frames that were queued before the stop are still encoded
+		EXPECT_TRUE(recorder.flush());
+		EXPECT_EQ(0u, recorder.pendingFrames());
+	}
+	const io::FilePtr &file = io::filesystem()->open("testrecorder.avi");
+	EXPECT_GT(file->length(), 20 * 3 * 3);
+}
+
 } // namespace image
@@ -89,6 +89,44 @@ TEST_F(ImageTest, testWritePng) {
 	ASSERT_TRUE(image::createEmptyImage("image")->load(stream3, stream1.size()));
 }
 
+TEST_F(ImageTest, testWritePngFast) {
+	const int w = 37;
+	const int h = 23;
+	core::DynamicArray<core::RGBA> pixels;
+	pixels.resize(w * h);
+	for (int y = 0; y < h; ++y) {
+		for (int x = 0; x < w; ++x) {
+			pixels[x + y * w] = core::RGBA(x * 7, y * 11, (x * y) & 0xff, 255 - x);
+		}
+	}
+	const PngCompression old = pngCompression();
+	PngCompression compression;
+	compression.fast = true;
+	for (int level = 0; level <= 9; level += 3) {
+		compression.level = level;
+		setPngCompression(compression);
+		io::BufferedReadWriteStream stream;
+		ASSERT_TRUE(image::Image::writePng(stream, (const uint8_t *)pixels.data(), w, h, 4));
+		stream.seek(0);
+		const image::ImagePtr &img = image::createEmptyImage("image");
+		ASSERT_TRUE(img->load(stream, stream.size())) << "level " << level;
+		ASSERT_EQ(w, img->width());
+		ASSERT_EQ(h, img->height());
+		for (int y = 0; y < h; ++y) {
+			for (int x = 0; x < w; ++x) {
+				ASSERT_EQ(pixels[x + y * w], img->colorAt(x, y)) << "level " << level << " at " << x << ":" << y;
+			}
+		}
+
+		int pngSize = 0;
+		uint8_t *png = image::createPng(pixels.data(), w, h, 4, &pngSize);
+		ASSERT_NE(nullptr, png);
+		EXPECT_EQ(stream.size(), pngSize);
+		core_free(png);
+	}
+	setPngCompression(old);
+}
+
 TEST_F(ImageTest, testGet) {
 	const image::ImagePtr& img = image::loadImage("test-palette-in.png");
 	const core::RGBA rgba = img->colorAt(33, 7);
@@ -96,6 +134,20 @@ TEST_F(ImageTest, testGet) {
 	EXPECT_EQ(rgba, expected) << image::print(img);
 }
 
+TEST_F(ImageTest, testResize) {
+	const uint8_t pixels[] = {
+		0,   0,   0,   255, 255, 255, 255, 255, 10,  20,  30,  255, 10,  20,  30,  255,
+		255, 255, 255, 255, 0,   0,   0,   255, 10,  20,  30,  255, 10,  20,  30,  255,
+	};
+	image::Image img("resize");
+	ASSERT_TRUE(img.loadRGBA(pixels, 4, 2));
+	ASSERT_TRUE(img.resize(2, 1));
+	EXPECT_EQ(2, img.width());
+	EXPECT_EQ(1, img.height());
+	EXPECT_EQ(core::RGBA(128, 128, 128, 255), img.colorAt(0, 0));
+	EXPECT_EQ(core::RGBA(10, 20, 30, 255), img.colorAt(1, 0));
+}
+
 TEST_F(ImageTest, testUVPixelBoundaries) {
 	const image::ImagePtr& img = image::loadImage("test-palette-in.png");
 	ASSERT_EQ(glm::vec2(0.0f, 0.0f), img->uv(0, img->height())) << "lower left corner of the image";
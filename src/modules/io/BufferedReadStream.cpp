@@ -0,0 +1,115 @@
+/**
+ * @file
+ */
+
+#include "BufferedReadStream.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+
+namespace io {
+
+BufferedReadStream::BufferedReadStream(SeekableReadStream &stream, int bufferSize)
+	: _stream(stream), _bufferSize(core_max(bufferSize, 64)) {
+	const uint8_t *mem = _stream.data();
+	if (mem != nullptr) {
+		_begin = mem;
+		_end = mem + _stream.size();
+		_cur = mem + core_min(_stream.pos(), _stream.size());
+		return;
+	}
+	_buffer = (uint8_t *)core_malloc(_bufferSize);
+	_windowPos = _stream.pos();
+	_begin = _cur = _end = _buffer;
+}
+
+BufferedReadStream::~BufferedReadStream() {
+	const int64_t p = pos();
+	if (_stream.pos() != p) {
+		_stream.seek(p);
+	}
+	core_free(_buffer);
+}
+
+bool BufferedReadStream::fill() {
+	_windowPos += (int64_t)(_end - _begin);
+	_begin = _cur = _end = _buffer;
+	const int n = _stream.read(_buffer, _bufferSize);
+	if (n <= 0) {
+		return false;
+	}
+	_end = _buffer + n;
+	return true;
+}
+
+int BufferedReadStream::read(void *dataPtr, size_t dataSize) {
+	uint8_t *out = (uint8_t *)dataPtr;
+	size_t remaining = dataSize;
+	while (remaining > 0u) {
+		const size_t available = (size_t)(_end - _cur);
+		if (available > 0u) {
+			const size_t n = core_min(available, remaining);
+			core_memcpy(out, _cur, n);
+			_cur += n;
+			out += n;
+			remaining -= n;
+			continue;
+		}
+		if (_buffer == nullptr) {
+			// the end of the memory of the wrapped stream was reached
+			break;
+		}
+		if (remaining >= (size_t)_bufferSize) {
+			// don't copy big reads through the buffer
+			_windowPos += (int64_t)(_end - _begin);
+			_begin = _cur = _end = _buffer;
+			const int n = _stream.read(out, remaining);
+			if (n < 0) {
+				return -1;
+			}
+			_windowPos += n;
+			remaining -= (size_t)n;
+			break;
+		}
+		if (!fill()) {
+			break;
+		}
+	}
+	return (int)(dataSize - remaining);
+}
+
+int64_t BufferedReadStream::seek(int64_t position, int whence) {
+	int64_t p;
+	switch (whence) {
+	case SEEK_SET:
+		p = position;
+		break;
+	case SEEK_CUR:
+		p = pos() + position;
+		break;
+	case SEEK_END:
+		p = size() + position;
+		break;
+	default:
+		return -1;
+	}
+	if (p < 0) {
+		return -1;
+	}
+	if (p >= _windowPos && p <= _windowPos + (int64_t)(_end - _begin)) {
+		_cur = _begin + (p - _windowPos);
+		return p;
+	}
+	if (_buffer == nullptr) {
+		// the memory of the wrapped stream is the complete stream - clamp like the memory streams do
+		_cur = _end;
+		return pos();
+	}
+	if (_stream.seek(p) == -1) {
+		return -1;
+	}
+	_windowPos = p;
+	_begin = _cur = _end = _buffer;
+	return p;
+}
+
+} // namespace io
@@ -0,0 +1,168 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "io/Stream.h"
+#include <SDL_endian.h>
+#include <string.h>
+
+namespace io {
+
+/**
+ * @brief Reads the wrapped stream in big blocks and serves the primitive reads from a local window
+ *
+ * The @c readUInt32() and friends of this class are inlined and don't call the virtual @c read() as long as the
+ * value is inside of the window. Use the concrete type (and not the @c SeekableReadStream base) in the loops that
+ * read millions of small values to get the fast path. If the wrapped stream is backed by memory (see
+ * @c SeekableReadStream::data()) the window is the memory of the stream and nothing is copied.
+ *
+ * @note The wrapped stream is positioned at the current position of this stream again when this stream is
+ * destroyed - don't use the wrapped stream while this stream is alive.
+ * @ingroup IO
+ */
+class BufferedReadStream final : public SeekableReadStream {
+private:
+	SeekableReadStream &_stream;
+	/**
+	 * @brief @c nullptr if the memory of the wrapped stream is used
+	 */
+	uint8_t *_buffer = nullptr;
+	const int _bufferSize;
+	const uint8_t *_begin = nullptr;
+	const uint8_t *_cur = nullptr;
+	const uint8_t *_end = nullptr;
+	/**
+	 * @brief The position of @c _begin in the wrapped stream - the wrapped stream is positioned at the end of
+	 * the window
+	 */
+	int64_t _windowPos = 0;
+
+	bool fill();
+
+	template<typename T>
+	inline bool readRaw(T &val) {
+		if (_end - _cur < (ptrdiff_t)sizeof(T)) {
+			return read(&val, sizeof(T)) == (int)sizeof(T);
+		}
+		// a memcpy with a constant size is inlined by the compiler
+		memcpy(&val, _cur, sizeof(T));
+		_cur += sizeof(T);
+		return true;
+	}
+
+public:
+	/**
+	 * @param[in] bufferSize The size of the blocks that are read from the wrapped stream - not used if the
+	 * wrapped stream is backed by memory
+	 */
+	BufferedReadStream(SeekableReadStream &stream, int bufferSize = 64 * 1024);
+	~BufferedReadStream();
+
+	int read(void *dataPtr, size_t dataSize) override;
+	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+	int64_t size() const override;
+	int64_t pos() const override;
+	const uint8_t *data() const override;
+
+	inline int64_t skip(int64_t delta) {
+		if (delta >= 0 && _end - _cur >= delta) {
+			_cur += delta;
+			return pos();
+		}
+		return seek(delta, SEEK_CUR);
+	}
+
+	/**
+	 * @note doesn't advance the stream position
+	 * @return -1 on error - 0 on success
+	 */
+	inline int peekUInt32(uint32_t &val) {
+		if (_end - _cur < (ptrdiff_t)sizeof(val)) {
+			return SeekableReadStream::peekUInt32(val);
+		}
+		memcpy(&val, _cur, sizeof(val));
+		val = SDL_SwapLE32(val);
+		return 0;
+	}
+
+	inline int readUInt8(uint8_t &val) {
+		return readRaw(val) ? 0 : -1;
+	}
+
+	inline int readInt8(int8_t &val) {
+		return readRaw(val) ? 0 : -1;
+	}
+
+	inline int readUInt16(uint16_t &val) {
+		if (!readRaw(val)) {
+			return -1;
+		}
+		val = SDL_SwapLE16(val);
+		return 0;
+	}
+
+	inline int readInt16(int16_t &val) {
+		if (!readRaw(val)) {
+			return -1;
+		}
+		val = (int16_t)SDL_SwapLE16(val);
+		return 0;
+	}
+
+	inline int readUInt32(uint32_t &val) {
+		if (!readRaw(val)) {
+			return -1;
+		}
+		val = SDL_SwapLE32(val);
+		return 0;
+	}
+
+	inline int readInt32(int32_t &val) {
+		if (!readRaw(val)) {
+			return -1;
+		}
+		val = (int32_t)SDL_SwapLE32(val);
+		return 0;
+	}
+
+	inline int readUInt32BE(uint32_t &val) {
+		if (!readRaw(val)) {
+			return -1;
+		}
+		val = SDL_SwapBE32(val);
+		return 0;
+	}
+
+	inline int readInt32BE(int32_t &val) {
+		if (!readRaw(val)) {
+			return -1;
+		}
+		val = (int32_t)SDL_SwapBE32(val);
+		return 0;
+	}
+
+	inline int readFloat(float &val) {
+		uint32_t tmp;
+		if (readUInt32(tmp) != 0) {
+			return -1;
+		}
+		memcpy(&val, &tmp, sizeof(val));
+		return 0;
+	}
+};
+
+inline int64_t BufferedReadStream::size() const {
+	return _stream.size();
+}
+
+inline int64_t BufferedReadStream::pos() const {
+	return _windowPos + (int64_t)(_cur - _begin);
+}
+
+inline const uint8_t *BufferedReadStream::data() const {
+	return _stream.data();
+}
+
+} // namespace io
@@ -60,9 +60,14 @@ public:
 	int64_t seek(int64_t position, int whence = SEEK_SET) override;
 	int64_t pos() const override;
 	int64_t size() const override;
+	const uint8_t *data() const override;
 	int64_t capacity() const;
 };
 
+inline const uint8_t *BufferedReadWriteStream::data() const {
+	return _buffer;
+}
+
 inline int64_t BufferedReadWriteStream::capacity() const {
 	return _capacity;
 }
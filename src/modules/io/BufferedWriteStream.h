@@ -4,13 +4,16 @@
 
 #include "Stream.h"
 #include "core/collection/Buffer.h"
+#include <SDL_endian.h>
+#include <string.h>
 
 namespace io {
 
 /**
  * @note This buffer must be flushed
+ * @note The primitive writes of the concrete type don't go through the virtual @c write() call
  */
-class BufferedWriteStream : public WriteStream {
+class BufferedWriteStream final : public WriteStream {
 private:
 	WriteStream &_stream;
 	core::Buffer<uint8_t> _buffer;
@@ -51,6 +54,30 @@ public:
 		return (int)size;
 	}
 
+	inline bool writeUInt8(uint8_t val) {
+		return BufferedWriteStream::write(&val, sizeof(val)) != -1;
+	}
+
+	inline bool writeUInt16(uint16_t val) {
+		const uint16_t swapped = SDL_SwapLE16(val);
+		return BufferedWriteStream::write(&swapped, sizeof(swapped)) != -1;
+	}
+
+	inline bool writeUInt32(uint32_t val) {
+		const uint32_t swapped = SDL_SwapLE32(val);
+		return BufferedWriteStream::write(&swapped, sizeof(swapped)) != -1;
+	}
+
+	inline bool writeInt32(int32_t val) {
+		return writeUInt32((uint32_t)val);
+	}
+
+	inline bool writeFloat(float val) {
+		uint32_t tmp;
+		memcpy(&tmp, &val, sizeof(tmp));
+		return writeUInt32(tmp);
+	}
+
 	bool flush() override {
 		_stream.write(_buffer.data(), _buffer.size());
 		_buffer.reset();
@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#include "DirectoryListing.h"
+#include "core/Log.h"
+#include "core/StringUtil.h"
+#include "io/File.h"
+#include "io/Filesystem.h"
+
+namespace io {
+
+extern bool fs_stat(const char *path, FilesystemEntry &entry);
+extern core::DynamicArray<FilesystemEntry> fs_scandir(const char *path);
+extern core::String fs_readlink(const char *path);
+
+DirectoryListing::DirectoryListing(const core::String &directory) : _directory(directory) {
+}
+
+void DirectoryListing::populate(int pageSize) {
+	core_trace_scoped(DirectoryListingPopulate);
+	FilesystemEntry dirEntry;
+	if (fs_stat(_directory.c_str(), dirEntry)) {
+		core::ScopedLock lock(_lock);
+		_mtime = dirEntry.mtime;
+	}
+	// reading the names is cheap compared to the stat calls for each entry
+	core::DynamicArray<FilesystemEntry> entries = fs_scandir(_directory.c_str());
+	core::DynamicArray<FilesystemEntry> page;
+	page.reserve(core_min((size_t)pageSize, entries.size()));
+	for (size_t i = 0; i < entries.size(); ++i) {
+		FilesystemEntry &entry = entries[i];
+		normalizePath(entry.name);
+		entry.fullPath = core::string::path(_directory, entry.name);
+		if (entry.type == FilesystemEntry::Type::link) {
+			core::String symlink = fs_readlink(entry.fullPath.c_str());
+			normalizePath(symlink);
+			if (symlink.empty()) {
+				Log::debug("Could not resolve symlink %s", entry.fullPath.c_str());
+				continue;
+			}
+			entry.fullPath = Filesystem::isRelativePath(symlink) ? core::string::path(_directory, symlink) : symlink;
+		}
+		if (!fs_stat(entry.fullPath.c_str(), entry)) {
+			Log::debug("Could not stat file %s", entry.fullPath.c_str());
+		}
+		page.push_back(core::move(entry));
+		if ((int)page.size() >= pageSize) {
+			core::ScopedLock lock(_lock);
+			_entries.append(page.data(), page.size());
+			page.clear();
+		}
+		if (_abort) {
+			Log::debug("Aborted the listing of %s", _directory.c_str());
+			return;
+		}
+	}
+	if (!page.empty()) {
+		core::ScopedLock lock(_lock);
+		_entries.append(page.data(), page.size());
+	}
+	_complete = true;
+}
+
+void DirectoryListing::abort() {
+	_abort = true;
+}
+
+size_t DirectoryListing::fetch(core::DynamicArray<FilesystemEntry> &entities, size_t offset) const {
+	core::ScopedLock lock(_lock);
+	if (offset >= _entries.size()) {
+		return _entries.size();
+	}
+	entities.append(_entries.data() + offset, _entries.size() - offset);
+	return _entries.size();
+}
+
+uint64_t DirectoryListing::mtime() const {
+	core::ScopedLock lock(_lock);
+	return _mtime;
+}
+
+} // namespace io
@@ -0,0 +1,74 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "FilesystemEntry.h"
+#include "core/SharedPtr.h"
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+
+namespace io {
+
+/**
+ * @brief The entries of a directory that are listed on a worker thread
+ *
+ * The entries are published in pages while the directory is listed - the caller can show the first entries of
+ * huge directories while the remaining ones are still resolved.
+ *
+ * @see Filesystem::listAsync()
+ * @ingroup IO
+ */
+class DirectoryListing {
+private:
+	const core::String _directory;
+	core_trace_mutex(core::Lock, _lock, "DirectoryListing");
+	core::DynamicArray<FilesystemEntry> _entries;
+	/**
+	 * @brief The modification time of the directory when the listing was started
+	 */
+	uint64_t _mtime = 0u;
+	core::AtomicBool _complete{false};
+	core::AtomicBool _abort{false};
+
+public:
+	DirectoryListing(const core::String &directory);
+
+	/**
+	 * @brief Lists the directory and publishes the entries in pages of the given size
+	 * @note This is executed on a worker thread
+	 */
+	void populate(int pageSize = 1024);
+	/**
+	 * @brief Stops a running @c populate() after the current page
+	 */
+	void abort();
+
+	/**
+	 * @brief Appends the entries from @c offset on that were listed so far
+	 * @return The offset for the next call
+	 */
+	size_t fetch(core::DynamicArray<FilesystemEntry> &entities, size_t offset = 0u) const;
+	/**
+	 * @return @c true if all entries were listed
+	 */
+	bool complete() const;
+	uint64_t mtime() const;
+	const core::String &directory() const;
+};
+
+inline bool DirectoryListing::complete() const {
+	return _complete;
+}
+
+inline const core::String &DirectoryListing::directory() const {
+	return _directory;
+}
+
+using DirectoryListingPtr = core::SharedPtr<DirectoryListing>;
+
+} // namespace io
@@ -6,6 +6,7 @@
 #include "core/Log.h"
 #include "core/StringUtil.h"
 #include "io/FormatDescription.h"
+#include "io/HttpRangeSource.h"
 #include <SDL.h>
 #ifdef __EMSCRIPTEN__
 #include "system/emscripten_browser_file.h"
@@ -13,6 +14,8 @@
 
 namespace io {
 
+extern bool fs_sync(SDL_RWops *rwops);
+
 void normalizePath(core::String& str) {
 	core::string::replaceAllChars(str, '\\', '/');
 #ifndef __WINDOWS__
@@ -87,6 +90,14 @@ SDL_RWops* File::createRWops(FileMode mode) const {
 	if (mode == FileMode::Write || mode == FileMode::SysWrite) {
 		fmode = "wb";
 	}
+	if (isHttpUrl(_rawPath)) {
+		if (mode == FileMode::Write || mode == FileMode::SysWrite) {
+			Log::error("Can't open %s for writing", _rawPath.c_str());
+			return nullptr;
+		}
+		// only the parts of the file that are read are downloaded
+		return createHttpRWops(_rawPath);
+	}
 	SDL_RWops *rwops = SDL_RWFromFile(_rawPath.c_str(), fmode);
 	if (rwops == nullptr) {
 		Log::debug("Can't open file %s: %s", _rawPath.c_str(), SDL_GetError());
@@ -252,6 +263,13 @@ bool File::flush() {
 	return false;
 }
 
+bool File::sync() {
+	if (_file == nullptr) {
+		return false;
+	}
+	return fs_sync(_file);
+}
+
 void File::close() {
 	if (_file != nullptr) {
 		SDL_RWclose(_file);
@@ -56,6 +56,10 @@ public:
 	bool open(FileMode mode);
 	void close();
 	bool flush();
+	/**
+	 * @brief Writes the buffered data to the storage device and waits until it's there (@c fsync)
+	 */
+	bool sync();
 	int read(void *buf, size_t size, size_t maxnum);
 	long tell() const;
 	long seek(long offset, int seekType) const;
@@ -5,6 +5,7 @@
 #include "FileStream.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
 #include "io/File.h"
 #include <SDL_endian.h>
 #include <SDL_rwops.h>
@@ -18,6 +19,12 @@ FileStream::FileStream(const FilePtr &file) : _file(file) {
 		_rwops = _file->_file;
 		if (_rwops) {
 			_size = SDL_RWsize(_rwops);
+			const FileMode mode = _file->mode();
+			if ((mode == FileMode::Read || mode == FileMode::SysRead) && _size >= MapMinSize) {
+				if (_mapping.map(_file->name()) && _mapping.size() != _size) {
+					_mapping.unmap();
+				}
+			}
 		} else {
 			_size = 0;
 		}
@@ -62,6 +69,12 @@ int FileStream::read(void *dataPtr, size_t dataSize) {
 	if (_rwops == nullptr) {
 		return -1;
 	}
+	if (_mapping.valid()) {
+		const int64_t n = core_min((int64_t)dataSize, core_max((int64_t)0, _size - _pos));
+		core_memcpy(dataPtr, _mapping.data() + _pos, n);
+		_pos += n;
+		return (int)n;
+	}
 	uint8_t *b = (uint8_t*)dataPtr;
 	size_t completeBytesRead = 0;
 	size_t bytesRead = 1;
@@ -78,6 +91,27 @@ int64_t FileStream::seek(int64_t position, int whence) {
 	if (_rwops == nullptr) {
 		return -1;
 	}
+	if (_mapping.valid()) {
+		int64_t p;
+		switch (whence) {
+		case SEEK_SET:
+			p = position;
+			break;
+		case SEEK_CUR:
+			p = _pos + position;
+			break;
+		case SEEK_END:
+			p = _size + position;
+			break;
+		default:
+			return -1;
+		}
+		if (p < 0) {
+			return -1;
+		}
+		_pos = p;
+		return 0;
+	}
 	int64_t p = SDL_RWseek(_rwops, position, whence);
 	_pos = SDL_RWtell(_rwops);
 	if (p == -1) {
@@ -6,6 +6,7 @@
 
 #include "core/Common.h"
 #include "core/SharedPtr.h"
+#include "io/MemoryMappedFile.h"
 #include "io/Stream.h"
 #include <SDL_rwops.h>
 #include <fcntl.h>
@@ -20,6 +21,9 @@ typedef core::SharedPtr<File> FilePtr;
 /**
  * @brief File read and write capable stream
  *
+ * Files that are opened for reading and are bigger than @c MapMinSize are memory mapped. The reads are
+ * served from the mapping then and @c data() gives direct access to the file content.
+ *
  * @note the stream is not flushed automatically. This is either done by calling flush() manually - or when the
  * used file instance is closed.
  * @ingroup IO
@@ -30,9 +34,15 @@ class FileStream : public SeekableReadStream, public SeekableWriteStream {
 private:
 	mutable SDL_RWops *_rwops;
 	FilePtr _file;
+	MemoryMappedFile _mapping;
 	int64_t _size = 0;
 	int64_t _pos = 0;
 public:
+	/**
+	 * Smaller files are not worth the costs of setting up the mapping
+	 */
+	static constexpr int64_t MapMinSize = 64 * 1024;
+
 	FileStream(const FilePtr &file);
 	virtual ~FileStream();
 
@@ -42,6 +52,7 @@ public:
 	int read(void *dataPtr, size_t dataSize) override;
 	int write(const void *dataPtr, size_t dataSize) override;
 	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+	const uint8_t *data() const override;
 	/**
 	 * @brief Flush the pending stream data into the output stream. This is closing the file
 	 * and re-open if afterwards.
@@ -57,4 +68,8 @@ inline int64_t FileStream::pos() const {
 	return _pos;
 }
 
+inline const uint8_t *FileStream::data() const {
+	return _mapping.data();
+}
+
 } // namespace io
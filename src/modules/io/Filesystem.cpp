@@ -10,10 +10,12 @@
 #include "core/StringUtil.h"
 #include "core/Var.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
 #include "engine-config.h"
 #include "io/File.h"
 #include "io/FileStream.h"
 #include "io/FilesystemEntry.h"
+#include "io/HttpRangeSource.h"
 #include <SDL.h>
 #ifndef __WINDOWS__
 #include <unistd.h>
@@ -27,6 +29,7 @@ namespace io {
 extern bool fs_mkdir(const char *path);
 extern bool fs_rmdir(const char *path);
 extern bool fs_unlink(const char *path);
+extern bool fs_rename(const char *oldPath, const char *newPath);
 extern bool fs_exists(const char *path);
 extern bool fs_chdir(const char *path);
 extern core::String fs_realpath(const char *path);
@@ -113,9 +116,20 @@ bool Filesystem::removeFile(const core::String &file) const {
 		Log::error("Can't delete file: No path given");
 		return false;
 	}
+	invalidateListing(file);
 	return fs_unlink(file.c_str());
 }
 
+bool Filesystem::rename(const core::String &oldFile, const core::String &newFile) const {
+	if (oldFile.empty() || newFile.empty()) {
+		Log::error("Can't rename file: No path given");
+		return false;
+	}
+	invalidateListing(oldFile);
+	invalidateListing(newFile);
+	return fs_rename(oldFile.c_str(), newFile.c_str());
+}
+
 bool Filesystem::removeDir(const core::String &dir, bool recursive) const {
 	if (dir.empty()) {
 		Log::error("Can't delete dir: No path given");
@@ -123,6 +137,7 @@ bool Filesystem::removeDir(const core::String &dir, bool recursive) const {
 	}
 
 	if (!recursive) {
+		invalidateListing(dir);
 		return fs_rmdir(dir.c_str());
 	}
 	// TODO: implement me
@@ -133,6 +148,7 @@ bool Filesystem::createDir(const core::String &dir, bool recursive) const {
 	if (dir.empty()) {
 		return false;
 	}
+	invalidateListing(dir);
 
 	if (!recursive) {
 		if (!fs_mkdir(dir.c_str())) {
@@ -222,6 +238,53 @@ bool Filesystem::list(const core::String &directory, core::DynamicArray<Filesyst
 	return true;
 }
 
+DirectoryListingPtr Filesystem::listAsync(const core::String &directory, core::ThreadPool &threadPool) {
+	const core::String &key = core::string::sanitizeDirPath(directory);
+	DirectoryListingPtr listing;
+	bool cached;
+	{
+		core::ScopedLock lock(_listingsLock);
+		cached = _listings.get(key, listing);
+	}
+	if (cached) {
+		if (!listing->complete()) {
+			return listing;
+		}
+		// a single stat call instead of a directory watcher - this also detects the changes that other hosts did
+		// on network filesystems
+		FilesystemEntry entry;
+		if (fs_stat(directory.c_str(), entry) && entry.mtime == listing->mtime()) {
+			return listing;
+		}
+		Log::debug("Directory %s was modified", directory.c_str());
+	}
+	listing = core::make_shared<DirectoryListing>(directory);
+	{
+		core::ScopedLock lock(_listingsLock);
+		if (_listings.size() >= 64u) {
+			// the running listings are kept alive by their tasks and callers
+			_listings.clear();
+		}
+		_listings.put(key, listing);
+	}
+	threadPool.schedule([listing]() { listing->populate(); });
+	return listing;
+}
+
+void Filesystem::invalidateListing(const core::String &path) const {
+	core::String dir = path;
+	while (dir.size() > 1 && dir.last() == '/') {
+		dir.erase(dir.size() - 1);
+	}
+	const core::String &key = core::string::sanitizeDirPath(core::string::extractPath(dir));
+	core::ScopedLock lock(_listingsLock);
+	DirectoryListingPtr listing;
+	if (_listings.get(key, listing)) {
+		listing->abort();
+		_listings.remove(key);
+	}
+}
+
 bool Filesystem::chdir(const core::String &directory) {
 	return fs_chdir(directory.c_str());
 }
@@ -260,6 +323,14 @@ bool Filesystem::isReadableDir(const core::String &name) {
 	return entry.type == FilesystemEntry::Type::dir;
 }
 
+bool Filesystem::stat(const core::String &name, FilesystemEntry &entry) {
+	if (!fs_exists(name.c_str())) {
+		Log::trace("%s doesn't exist", name.c_str());
+		return false;
+	}
+	return fs_stat(name.c_str(), entry);
+}
+
 bool Filesystem::isRelativePath(const core::String &name) {
 	const size_t size = name.size();
 #ifdef __WINDOWS__
@@ -326,6 +397,9 @@ bool Filesystem::pushDir(const core::String &directory) {
 
 // TODO: case insensitive search should be possible - see searchPathFor()
 io::FilePtr Filesystem::open(const core::String &filename, FileMode mode) const {
+	if (isHttpUrl(filename)) {
+		return core::make_shared<io::File>(filename, mode);
+	}
 	if (isReadableDir(filename)) {
 		Log::debug("%s is a directory - skip this", filename.c_str());
 		return core::make_shared<io::File>("", mode);
@@ -413,6 +487,7 @@ long Filesystem::write(const core::String& filename, io::ReadStream &stream) {
 	const core::String &fullPath = _homePath + filename;
 	const core::String path(core::string::extractPath(fullPath.c_str()));
 	createDir(path, true);
+	invalidateListing(fullPath);
 	io::File f(fullPath, FileMode::Write);
 	long written = f.write(stream);
 	f.close();
@@ -423,6 +498,7 @@ bool Filesystem::write(const core::String &filename, const uint8_t *content, siz
 	const core::String &fullPath = _homePath + filename;
 	const core::String path(core::string::extractPath(fullPath.c_str()));
 	createDir(path, true);
+	invalidateListing(fullPath);
 	io::File f(fullPath, FileMode::Write);
 	return f.write(content, length) == static_cast<long>(length);
 }
@@ -438,6 +514,7 @@ bool Filesystem::syswrite(const core::String &filename, const uint8_t *content,
 		Log::error("Failed to write to %s: Could not create the directory", filename.c_str());
 		return false;
 	}
+	invalidateListing(filename);
 	f.open(FileMode::SysWrite);
 	return f.write(content, length) == static_cast<long>(length);
 }
@@ -448,6 +525,7 @@ long Filesystem::syswrite(const core::String& filename, io::ReadStream &stream)
 		Log::error("Failed to write to %s: Could not create the directory", filename.c_str());
 		return false;
 	}
+	invalidateListing(filename);
 	f.open(FileMode::SysWrite);
 	return f.write(stream);
 }
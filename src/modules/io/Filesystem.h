@@ -4,16 +4,23 @@
 
 #pragma once
 
+#include "DirectoryListing.h"
 #include "File.h"
 #include "FilesystemEntry.h"
 #include "core/SharedPtr.h"
 #include "core/String.h"
+#include "core/Trace.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Stack.h"
 #include "core/collection/StringMap.h"
 #include "core/Common.h"
+#include "core/concurrent/Lock.h"
 #include "io/Stream.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace io {
 
 using Paths = core::DynamicArray<core::String>;
@@ -60,6 +67,17 @@ private:
 
 	core::Stack<core::String, 32> _dirStack;
 
+	core_trace_mutex(core::Lock, _listingsLock, "Filesystem");
+	/**
+	 * @brief The cached listings of listAsync() by their directory
+	 */
+	mutable core::StringMap<DirectoryListingPtr> _listings;
+
+	/**
+	 * @brief Drops the cached listing of the directory that contains the given path
+	 */
+	void invalidateListing(const core::String &path) const;
+
 public:
 	~Filesystem();
 
@@ -107,7 +125,24 @@ public:
 	 */
 	bool list(const core::String& directory, core::DynamicArray<FilesystemEntry>& entities, const core::String& filter = "", int depth = 0) const;
 
+	/**
+	 * @brief List all entities in a directory on the given thread pool
+	 *
+	 * The listing is cached. A cached listing is returned as long as the modification time of the directory
+	 * didn't change - or the directory wasn't modified by this filesystem instance. Poll the returned listing
+	 * for the entries - they are published in pages while the directory is listed.
+	 *
+	 * @note The search paths are not taken into account
+	 */
+	DirectoryListingPtr listAsync(const core::String& directory, core::ThreadPool& threadPool);
+
 	static bool isReadableDir(const core::String& name);
+	/**
+	 * @brief Fills the type, the size and the modification time of the given path
+	 * @note The search paths are not taken into account
+	 * @return @c false if the path doesn't exist
+	 */
+	static bool stat(const core::String& name, FilesystemEntry& entry);
 	static bool isRelativePath(const core::String& name);
 
 	static core::String absolutePath(const core::String& path);
@@ -172,6 +207,11 @@ public:
 	 * @param file The full path to the file or relative to the current working dir of your app.
 	 */
 	bool removeFile(const core::String& file) const;
+	/**
+	 * @brief Renames the file without taking the write path into account. An existing target file is replaced.
+	 * @note On most filesystems this is atomic if both paths are on the same volume.
+	 */
+	bool rename(const core::String& oldFile, const core::String& newFile) const;
 private:
 	static bool _list(const core::String& directory, core::DynamicArray<FilesystemEntry>& entities, const core::String& filter = "", int depth = 0);
 };
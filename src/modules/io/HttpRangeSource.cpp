@@ -0,0 +1,464 @@
+/**
+ * @file
+ */
+
+#include "HttpRangeSource.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/StringUtil.h"
+#include <SDL_rwops.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET SocketHandle;
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+typedef int SocketHandle;
+#define INVALID_SOCKET -1
+#define closesocket close
+#endif
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace io {
+
+static constexpr int MaxRedirects = 5;
+// the whole file is kept in memory if the server doesn't support range requests
+static constexpr int64_t MaxDownloadSize = 512 * 1024 * 1024;
+// a stalled server must not block the loading forever
+static constexpr int SocketTimeoutSeconds = 30;
+
+bool isHttpUrl(const core::String &path) {
+	return core::string::startsWith(path, "http://") || core::string::startsWith(path, "https://");
+}
+
+HttpRangeSource::HttpRangeSource(const core::String &url) : _url(url) {
+}
+
+HttpRangeSource::~HttpRangeSource() {
+	disconnect();
+}
+
+bool HttpRangeSource::parseUrl(const core::String &url) {
+	if (core::string::startsWith(url, "https://")) {
+		Log::error("Can't open %s: https is not supported", url.c_str());
+		return false;
+	}
+	if (!core::string::startsWith(url, "http://")) {
+		Log::error("Can't open %s: not a http url", url.c_str());
+		return false;
+	}
+	const core::String &hostAndPath = url.substr(7);
+	const size_t pathStart = hostAndPath.find_first_of('/');
+	core::String host;
+	if (pathStart == core::String::npos) {
+		host = hostAndPath;
+		_path = "/";
+	} else {
+		host = hostAndPath.substr(0, pathStart);
+		_path = hostAndPath.substr(pathStart);
+	}
+	const size_t portStart = host.find_first_of(':');
+	if (portStart == core::String::npos) {
+		_host = host;
+		_port = 80;
+	} else {
+		_host = host.substr(0, portStart);
+		_port = core::string::toInt(host.substr(portStart + 1));
+	}
+	if (_host.empty() || _port <= 0 || _port > 65535) {
+		Log::error("Can't open %s: invalid host", url.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool HttpRangeSource::connect() {
+#ifdef _WIN32
+	static bool wsaInitialized = false;
+	if (!wsaInitialized) {
+		WSADATA wsaData;
+		if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
+			Log::error("Failed to initialize winsock");
+			return false;
+		}
+		wsaInitialized = true;
+	}
+#endif
+	struct addrinfo hints;
+	core_memset(&hints, 0, sizeof(hints));
+	hints.ai_family = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	struct addrinfo *addresses = nullptr;
+	const core::String &port = core::string::toString(_port);
+	if (getaddrinfo(_host.c_str(), port.c_str(), &hints, &addresses) != 0) {
+		Log::error("Failed to resolve %s", _host.c_str());
+		return false;
+	}
+	SocketHandle sock = INVALID_SOCKET;
+	for (struct addrinfo *a = addresses; a != nullptr; a = a->ai_next) {
+		sock = socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+		if (sock == INVALID_SOCKET) {
+			continue;
+		}
+		if (::connect(sock, a->ai_addr, (int)a->ai_addrlen) == 0) {
+			break;
+		}
+		closesocket(sock);
+		sock = INVALID_SOCKET;
+	}
+	freeaddrinfo(addresses);
+	if (sock == INVALID_SOCKET) {
+		Log::error("Failed to connect to %s:%i", _host.c_str(), _port);
+		return false;
+	}
+	// the requests are small and a response is awaited for each of them
+	int noDelay = 1;
+	setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (const char *)&noDelay, sizeof(noDelay));
+#ifdef _WIN32
+	const DWORD timeout = SocketTimeoutSeconds * 1000;
+#else
+	struct timeval timeout;
+	timeout.tv_sec = SocketTimeoutSeconds;
+	timeout.tv_usec = 0;
+#endif
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, (const char *)&timeout, sizeof(timeout));
+	setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, (const char *)&timeout, sizeof(timeout));
+	_socket = (int64_t)sock;
+	_recvPos = _recvEnd = 0;
+	return true;
+}
+
+void HttpRangeSource::disconnect() {
+	if (_socket == -1) {
+		return;
+	}
+	closesocket((SocketHandle)_socket);
+	_socket = -1;
+	_recvPos = _recvEnd = 0;
+}
+
+bool HttpRangeSource::sendRequest(int64_t first, int64_t last) {
+	core::String host = _host;
+	if (_port != 80) {
+		host += core::String::format(":%i", _port);
+	}
+	const core::String &req = core::String::format("GET %s HTTP/1.1\r\n"
+												   "Host: %s\r\n"
+												   "Range: bytes=%lld-%lld\r\n"
+												   "User-Agent: vengi\r\n"
+												   "Connection: keep-alive\r\n"
+												   "\r\n",
+												   _path.c_str(), host.c_str(), (long long)first, (long long)last);
+	const char *data = req.c_str();
+	size_t remaining = req.size();
+	while (remaining > 0u) {
+		const int n = (int)send((SocketHandle)_socket, data, (int)remaining, MSG_NOSIGNAL);
+		if (n <= 0) {
+			return false;
+		}
+		data += n;
+		remaining -= n;
+	}
+	return true;
+}
+
+bool HttpRangeSource::receive(uint8_t *buf, int64_t len) {
+	while (len > 0) {
+		if (_recvPos == _recvEnd) {
+			// read large bodies directly into the target buffer
+			if (buf != nullptr && len >= (int64_t)sizeof(_recvBuf)) {
+				const int n = (int)recv((SocketHandle)_socket, (char *)buf, (int)core_min(len, (int64_t)INT32_MAX), 0);
+				if (n <= 0) {
+					return false;
+				}
+				buf += n;
+				len -= n;
+				continue;
+			}
+			const int n = (int)recv((SocketHandle)_socket, (char *)_recvBuf, (int)sizeof(_recvBuf), 0);
+			if (n <= 0) {
+				return false;
+			}
+			_recvPos = 0;
+			_recvEnd = n;
+		}
+		const int n = (int)core_min((int64_t)(_recvEnd - _recvPos), len);
+		if (buf != nullptr) {
+			core_memcpy(buf, _recvBuf + _recvPos, n);
+			buf += n;
+		}
+		_recvPos += n;
+		len -= n;
+	}
+	return true;
+}
+
+bool HttpRangeSource::readLine(core::String &line) {
+	line.clear();
+	for (;;) {
+		uint8_t c;
+		if (!receive(&c, 1)) {
+			return false;
+		}
+		if (c == '\n') {
+			break;
+		}
+		if (c != '\r') {
+			line += (char)c;
+		}
+		if (line.size() > 8192u) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool HttpRangeSource::readResponse(Response &response) {
+	response = Response();
+	core::String line;
+	if (!readLine(line) || !core::string::startsWith(line, "HTTP/")) {
+		return false;
+	}
+	const size_t statusStart = line.find_first_of(' ');
+	if (statusStart == core::String::npos) {
+		return false;
+	}
+	response.status = core::string::toInt(line.substr(statusStart + 1, 3));
+	for (;;) {
+		if (!readLine(line)) {
+			return false;
+		}
+		if (line.empty()) {
+			break;
+		}
+		const size_t colon = line.find_first_of(':');
+		if (colon == core::String::npos) {
+			continue;
+		}
+		const core::String &name = line.substr(0, colon).toLower();
+		const core::String &value = core::string::trim(line.substr(colon + 1));
+		if (name == "content-length") {
+			response.contentLength = core::string::toLong(value);
+		} else if (name == "content-range") {
+			// bytes 0-0/1234 or bytes */1234
+			const size_t slash = value.rfind('/');
+			if (slash != core::String::npos && value[slash + 1] != '*') {
+				response.totalSize = core::string::toLong(value.substr(slash + 1));
+			}
+		} else if (name == "location") {
+			response.location = value;
+		} else if (name == "connection") {
+			response.close = core::string::iequals(value, "close");
+		} else if (name == "transfer-encoding") {
+			response.chunked = core::string::icontains(value, "chunked");
+		}
+	}
+	return true;
+}
+
+bool HttpRangeSource::request(int64_t first, int64_t last, Response &response) {
+	for (int attempt = 0; attempt < 2; ++attempt) {
+		const bool reused = _socket != -1;
+		if (!reused && !connect()) {
+			return false;
+		}
+		if (sendRequest(first, last) && readResponse(response)) {
+			return true;
+		}
+		disconnect();
+		if (!reused) {
+			break;
+		}
+	}
+	return false;
+}
+
+bool HttpRangeSource::open() {
+	for (int redirect = 0; redirect <= MaxRedirects; ++redirect) {
+		if (!parseUrl(_url)) {
+			return false;
+		}
+		Response response;
+		if (!request(0, 0, response)) {
+			Log::error("Failed to request %s", _url.c_str());
+			return false;
+		}
+		if (response.chunked) {
+			Log::error("Failed to open %s: chunked responses are not supported", _url.c_str());
+			disconnect();
+			return false;
+		}
+		if (response.status >= 300 && response.status < 400 && !response.location.empty()) {
+			disconnect();
+			if (response.location[0] == '/') {
+				_url = core::String::format("http://%s:%i%s", _host.c_str(), _port, response.location.c_str());
+			} else {
+				_url = response.location;
+			}
+			Log::debug("Redirected to %s", _url.c_str());
+			continue;
+		}
+		if (response.status == 206 || response.status == 416) {
+			// 416 is the answer for the range request on an empty file
+			if (response.contentLength > 0 && !receive(nullptr, response.contentLength)) {
+				disconnect();
+				return false;
+			}
+			_size = response.totalSize;
+			if (_size < 0 && response.status == 416) {
+				_size = 0;
+			}
+			if (_size < 0) {
+				Log::error("Failed to open %s: unknown size", _url.c_str());
+				disconnect();
+				return false;
+			}
+		} else if (response.status == 200 && response.contentLength >= 0) {
+			Log::debug("%s doesn't support range requests - download the whole file", _url.c_str());
+			if (response.contentLength > MaxDownloadSize) {
+				Log::error("Failed to open %s: %i MB exceed the download limit", _url.c_str(),
+						   (int)(response.contentLength / 1024 / 1024));
+				disconnect();
+				return false;
+			}
+			_content.resize((size_t)response.contentLength);
+			if (!receive(_content.data(), response.contentLength)) {
+				Log::error("Failed to download %s", _url.c_str());
+				disconnect();
+				return false;
+			}
+			_ranges = false;
+			_size = response.contentLength;
+			disconnect();
+			return true;
+		} else {
+			Log::error("Failed to open %s: http status %i", _url.c_str(), response.status);
+			disconnect();
+			return false;
+		}
+		if (response.close) {
+			disconnect();
+		}
+		return true;
+	}
+	Log::error("Failed to open %s: too many redirects", _url.c_str());
+	return false;
+}
+
+int HttpRangeSource::fetch(int64_t offset, uint8_t *buf, int len) {
+	if (offset < 0 || len < 0 || offset + len > _size) {
+		return -1;
+	}
+	if (len == 0) {
+		return 0;
+	}
+	if (!_ranges) {
+		core_memcpy(buf, _content.data() + offset, len);
+		return len;
+	}
+	Response response;
+	if (!request(offset, offset + len - 1, response)) {
+		Log::error("Failed to request %i bytes of %s", len, _url.c_str());
+		return -1;
+	}
+	if (response.status != 206 || response.chunked || response.contentLength != len) {
+		Log::error("Unexpected response for the range request of %s: http status %i", _url.c_str(),
+				   response.status);
+		disconnect();
+		return -1;
+	}
+	if (!receive(buf, len)) {
+		Log::error("Failed to receive %i bytes of %s", len, _url.c_str());
+		disconnect();
+		return -1;
+	}
+	if (response.close) {
+		disconnect();
+	}
+	return len;
+}
+
+namespace {
+
+struct HttpRWops {
+	HttpRangeSource source;
+	RangeReadStream *stream = nullptr;
+
+	HttpRWops(const core::String &url) : source(url) {
+	}
+	~HttpRWops() {
+		delete stream;
+	}
+};
+
+static inline RangeReadStream *httpStream(SDL_RWops *context) {
+	return ((HttpRWops *)context->hidden.unknown.data1)->stream;
+}
+
+static Sint64 httpSize(SDL_RWops *context) {
+	return httpStream(context)->size();
+}
+
+static Sint64 httpSeek(SDL_RWops *context, Sint64 offset, int whence) {
+	// RW_SEEK_SET, RW_SEEK_CUR and RW_SEEK_END match the stdio values
+	return httpStream(context)->seek(offset, whence);
+}
+
+static size_t httpRead(SDL_RWops *context, void *ptr, size_t size, size_t maxnum) {
+	if (size == 0u) {
+		return 0u;
+	}
+	const int n = httpStream(context)->read(ptr, size * maxnum);
+	if (n < 0) {
+		SDL_Error(SDL_EFREAD);
+		return 0u;
+	}
+	return (size_t)n / size;
+}
+
+static size_t httpWrite(SDL_RWops *, const void *, size_t, size_t) {
+	SDL_Error(SDL_EFWRITE);
+	return 0u;
+}
+
+static int httpClose(SDL_RWops *context) {
+	delete (HttpRWops *)context->hidden.unknown.data1;
+	SDL_FreeRW(context);
+	return 0;
+}
+
+} // namespace
+
+SDL_RWops *createHttpRWops(const core::String &url) {
+	HttpRWops *data = new HttpRWops(url);
+	if (!data->source.open()) {
+		delete data;
+		return nullptr;
+	}
+	data->stream = new RangeReadStream(data->source);
+	SDL_RWops *rwops = SDL_AllocRW();
+	if (rwops == nullptr) {
+		delete data;
+		return nullptr;
+	}
+	rwops->type = SDL_RWOPS_UNKNOWN;
+	rwops->size = httpSize;
+	rwops->seek = httpSeek;
+	rwops->read = httpRead;
+	rwops->write = httpWrite;
+	rwops->close = httpClose;
+	rwops->hidden.unknown.data1 = data;
+	return rwops;
+}
+
+} // namespace io
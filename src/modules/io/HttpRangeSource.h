@@ -0,0 +1,98 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include "io/RangeReadStream.h"
+
+struct SDL_RWops;
+
+namespace io {
+
+/**
+ * @brief Fetches the bytes of a file on a http server with range requests over a persistent connection
+ *
+ * If the server doesn't support range requests, the whole file (up to 512 MB) is downloaded by @c open() and the
+ * fetches are served from memory.
+ *
+ * @note Only plain http is supported - there is no tls implementation available. A server that doesn't answer for
+ * 30 seconds fails the request.
+ * @sa RangeReadStream
+ * @ingroup IO
+ */
+class HttpRangeSource : public RangeSource {
+private:
+	struct Response {
+		int status = 0;
+		int64_t contentLength = -1;
+		/** the total size of the file from the @c Content-Range header */
+		int64_t totalSize = -1;
+		core::String location;
+		bool close = false;
+		bool chunked = false;
+	};
+
+	core::String _url;
+	core::String _host;
+	int _port = 80;
+	core::String _path;
+	int64_t _size = -1;
+	/** the socket handle - -1 if not connected */
+	int64_t _socket = -1;
+	/** the whole file if the server doesn't support range requests */
+	core::DynamicArray<uint8_t> _content;
+	bool _ranges = true;
+
+	uint8_t _recvBuf[4096];
+	int _recvPos = 0;
+	int _recvEnd = 0;
+
+	bool parseUrl(const core::String &url);
+	bool connect();
+	void disconnect();
+	bool sendRequest(int64_t first, int64_t last);
+	bool readResponse(Response &response);
+	bool readLine(core::String &line);
+	/**
+	 * @param[out] buf @c nullptr to skip the bytes
+	 */
+	bool receive(uint8_t *buf, int64_t len);
+	/**
+	 * @brief Sends the range request and reads the response header - reconnects once if the persistent connection
+	 * was closed by the server
+	 */
+	bool request(int64_t first, int64_t last, Response &response);
+
+public:
+	HttpRangeSource(const core::String &url);
+	~HttpRangeSource();
+
+	/**
+	 * @brief Follows the redirects and probes the size of the file
+	 */
+	bool open();
+
+	int64_t size() const override;
+	int fetch(int64_t offset, uint8_t *buf, int len) override;
+};
+
+inline int64_t HttpRangeSource::size() const {
+	return _size;
+}
+
+/**
+ * @return @c true for @c http:// and @c https:// urls
+ */
+bool isHttpUrl(const core::String &path);
+
+/**
+ * @brief Creates a read-only @c SDL_RWops for the given url that reads it through a @c RangeReadStream
+ * @return @c nullptr if the url couldn't get opened
+ * @sa io::File
+ */
+SDL_RWops *createHttpRWops(const core::String &url);
+
+} // namespace io
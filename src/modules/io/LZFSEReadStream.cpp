@@ -4,53 +4,196 @@
 
 #include "LZFSEReadStream.h"
 #include "core/Assert.h"
+#include "core/Common.h"
 #include "core/Log.h"
 #include "core/StandardLib.h"
-#include "core/collection/Buffer.h"
-#include "io/BufferedReadWriteStream.h"
-#include "lzfse.h"
+#include "core/Trace.h"
+#include <stddef.h>
+
+// the internal header is needed for the resumable decoder state and the block header layout - it triggers
+// -Wsign-compare in lzfse_fse.h
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#endif
+extern "C" {
+#include "lzfse_internal.h"
+}
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
 
 namespace io {
 
+// decode at least this amount of bytes per step to not enter the decoder for every small read
+static constexpr int64_t DecodeStep = 64 * 1024;
+// the output buffer is allocated upfront from the sizes in the block headers - don't let a small file request more
+static constexpr int64_t MaxDecompressedSize = 1024 * 1024 * 1024;
+
+static inline uint32_t readLE32(const uint8_t *buf) {
+	return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static inline uint64_t readLE64(const uint8_t *buf) {
+	return (uint64_t)readLE32(buf) | ((uint64_t)readLE32(buf + 4) << 32);
+}
+
 LZFSEReadStream::LZFSEReadStream(io::SeekableReadStream &readStream, int size) {
-	// there is no streaming interface in lzfse, so we need to read the whole stream into memory
-	BufferedReadWriteStream s(readStream, size <= 0 ? readStream.remaining() : size);
-	size_t extractedBufferSize = 10 * s.size();
-	void *auxBuffer = core_malloc(lzfse_decode_scratch_size());
-	_extractedBuffer = (uint8_t *)core_malloc(extractedBufferSize);
-	size_t extractedSize = 0;
-	while (1) {
-		extractedSize = lzfse_decode_buffer(_extractedBuffer, extractedBufferSize, s.getBuffer(), s.size(), auxBuffer);
-		if (extractedSize == 0 || extractedSize == extractedBufferSize) {
-			extractedBufferSize <<= 1;
-			_extractedBuffer = (uint8_t *)core_realloc(_extractedBuffer, extractedBufferSize);
-			continue;
-		}
-		break;
+	_compressedSize = (size_t)(size <= 0 ? readStream.remaining() : size);
+	_compressedBuffer = (uint8_t *)core_malloc(_compressedSize);
+	if (readStream.read(_compressedBuffer, _compressedSize) != (int)_compressedSize) {
+		Log::error("Failed to read %i bytes of lzfse compressed data", (int)_compressedSize);
+		_failed = true;
+		return;
+	}
+	_size = scanBlocks(_compressedBuffer, _compressedSize);
+	if (_size < 0) {
+		Log::error("Invalid lzfse block headers");
+		_size = 0;
+		_failed = true;
+		return;
 	}
-	_readStream = new MemoryReadStream(_extractedBuffer, extractedSize);
-	core_free(auxBuffer);
+	_extractedBuffer = (uint8_t *)core_malloc(core_max(_size, (int64_t)1));
+
+	lzfse_decoder_state *state = (lzfse_decoder_state *)core_malloc(sizeof(lzfse_decoder_state));
+	core_memset(state, 0, sizeof(*state));
+	state->src = _compressedBuffer;
+	state->src_begin = _compressedBuffer;
+	state->src_end = _compressedBuffer + _compressedSize;
+	state->dst = _extractedBuffer;
+	state->dst_begin = _extractedBuffer;
+	state->dst_end = _extractedBuffer;
+	_decoderState = state;
 }
 
 LZFSEReadStream::~LZFSEReadStream() {
-	delete _readStream;
+	core_free(_decoderState);
 	core_free(_extractedBuffer);
+	core_free(_compressedBuffer);
 }
 
-int64_t LZFSEReadStream::seek(int64_t position, int whence) {
-	return _readStream->seek(position, whence);
+int64_t LZFSEReadStream::scanBlocks(const uint8_t *buf, size_t size) {
+	int64_t rawSize = 0;
+	size_t offset = 0u;
+	for (;;) {
+		if (offset + 4u > size) {
+			return -1;
+		}
+		const uint8_t *block = buf + offset;
+		const uint32_t magic = readLE32(block);
+		size_t blockSize;
+		switch (magic) {
+		case LZFSE_ENDOFSTREAM_BLOCK_MAGIC:
+			return rawSize;
+		case LZFSE_UNCOMPRESSED_BLOCK_MAGIC: {
+			if (offset + sizeof(uncompressed_block_header) > size) {
+				return -1;
+			}
+			const uint32_t rawBytes = readLE32(block + offsetof(uncompressed_block_header, n_raw_bytes));
+			blockSize = sizeof(uncompressed_block_header) + rawBytes;
+			rawSize += rawBytes;
+			break;
+		}
+		case LZFSE_COMPRESSEDLZVN_BLOCK_MAGIC:
+			if (offset + sizeof(lzvn_compressed_block_header) > size) {
+				return -1;
+			}
+			blockSize = sizeof(lzvn_compressed_block_header) +
+						readLE32(block + offsetof(lzvn_compressed_block_header, n_payload_bytes));
+			rawSize += readLE32(block + offsetof(lzvn_compressed_block_header, n_raw_bytes));
+			break;
+		case LZFSE_COMPRESSEDV1_BLOCK_MAGIC:
+			if (offset + sizeof(lzfse_compressed_block_header_v1) > size) {
+				return -1;
+			}
+			blockSize = sizeof(lzfse_compressed_block_header_v1) +
+						readLE32(block + offsetof(lzfse_compressed_block_header_v1, n_literal_payload_bytes)) +
+						readLE32(block + offsetof(lzfse_compressed_block_header_v1, n_lmd_payload_bytes));
+			rawSize += readLE32(block + offsetof(lzfse_compressed_block_header_v1, n_raw_bytes));
+			break;
+		case LZFSE_COMPRESSEDV2_BLOCK_MAGIC: {
+			if (offset + offsetof(lzfse_compressed_block_header_v2, freq) > size) {
+				return -1;
+			}
+			// see the layout of the packed fields in lzfse_compressed_block_header_v2
+			const uint8_t *fields = block + offsetof(lzfse_compressed_block_header_v2, packed_fields);
+			const uint32_t literalPayloadBytes = (uint32_t)(readLE64(fields) >> 20) & 0xFFFFFu;
+			const uint32_t lmdPayloadBytes = (uint32_t)(readLE64(fields + 8) >> 40) & 0xFFFFFu;
+			const uint32_t headerSize = (uint32_t)readLE64(fields + 16);
+			if (headerSize < offsetof(lzfse_compressed_block_header_v2, freq) ||
+				headerSize > sizeof(lzfse_compressed_block_header_v2)) {
+				return -1;
+			}
+			blockSize = (size_t)headerSize + literalPayloadBytes + lmdPayloadBytes;
+			rawSize += readLE32(block + offsetof(lzfse_compressed_block_header_v2, n_raw_bytes));
+			break;
+		}
+		default:
+			return -1;
+		}
+		if (blockSize == 0u || blockSize > size - offset || rawSize > MaxDecompressedSize) {
+			return -1;
+		}
+		offset += blockSize;
+	}
 }
 
-int64_t LZFSEReadStream::size() const {
-	return _readStream->size();
+bool LZFSEReadStream::decodeUntil(int64_t size) {
+	if (_decoded >= size) {
+		return true;
+	}
+	if (_failed) {
+		return false;
+	}
+	core_trace_scoped(LZFSEDecode);
+	lzfse_decoder_state *state = (lzfse_decoder_state *)_decoderState;
+	const int64_t target = core_min(_size, core_max(size, _decoded + DecodeStep));
+	state->dst_end = _extractedBuffer + target;
+	const int status = lzfse_decode(state);
+	_decoded = (int64_t)(state->dst - _extractedBuffer);
+	if (status != LZFSE_STATUS_OK && status != LZFSE_STATUS_DST_FULL) {
+		Log::error("Failed to decode the lzfse data at offset %i", (int)_decoded);
+		_failed = true;
+	}
+	return _decoded >= size;
 }
 
-int64_t LZFSEReadStream::pos() const {
-	return _readStream->pos();
+int64_t LZFSEReadStream::seek(int64_t position, int whence) {
+	switch (whence) {
+	case SEEK_SET:
+		_pos = position;
+		break;
+	case SEEK_CUR:
+		_pos += position;
+		break;
+	case SEEK_END:
+		_pos = _size + position;
+		break;
+	default:
+		return -1;
+	}
+	if (_pos < 0) {
+		_pos = 0;
+	} else if (_pos > _size) {
+		_pos = _size;
+	}
+	return _pos;
 }
 
 int LZFSEReadStream::read(void *buf, size_t size) {
-	return _readStream->read(buf, size);
+	const int64_t rem = _size - _pos;
+	if (rem <= 0) {
+		return 0;
+	}
+	if (size > (size_t)rem) {
+		size = (size_t)rem;
+	}
+	if (!decodeUntil(_pos + (int64_t)size)) {
+		return -1;
+	}
+	core_memcpy(buf, _extractedBuffer + _pos, size);
+	_pos += (int64_t)size;
+	return (int)size;
 }
 
 } // namespace io
@@ -5,17 +5,47 @@
 #pragma once
 
 #include "Stream.h"
-#include "io/MemoryReadStream.h"
 
 namespace io {
 
 /**
+ * @brief Decodes lzfse compressed data on demand
+ *
+ * The block headers of the compressed data are scanned once to get the exact decompressed size - the output buffer
+ * is allocated once and the blocks are only decoded when a read or seek reaches them. Data that is never read is
+ * never decoded.
+ *
  * @ingroup IO
  */
 class LZFSEReadStream : public io::SeekableReadStream {
 private:
-	io::MemoryReadStream *_readStream = nullptr;
+	uint8_t *_compressedBuffer = nullptr;
+	size_t _compressedSize = 0u;
 	uint8_t *_extractedBuffer = nullptr;
+	/**
+	 * @brief The size of the decompressed data - the sum of the raw sizes of all blocks
+	 */
+	int64_t _size = 0;
+	/**
+	 * @brief The amount of bytes at the start of the extracted buffer that were already decoded
+	 */
+	int64_t _decoded = 0;
+	int64_t _pos = 0;
+	/**
+	 * @brief The resumable lzfse decoder state
+	 */
+	void *_decoderState = nullptr;
+	bool _failed = false;
+
+	/**
+	 * @return The decompressed size or @c -1 if the block headers are invalid or the decompressed size exceeds the
+	 * supported maximum
+	 */
+	static int64_t scanBlocks(const uint8_t *buf, size_t size);
+	/**
+	 * @brief Decodes the blocks until at least the given amount of bytes is available
+	 */
+	bool decodeUntil(int64_t size);
 
 public:
 	/**
@@ -44,4 +74,12 @@ public:
 	int64_t pos() const override;
 };
 
+inline int64_t LZFSEReadStream::size() const {
+	return _size;
+}
+
+inline int64_t LZFSEReadStream::pos() const {
+	return _pos;
+}
+
 } // namespace io
@@ -0,0 +1,178 @@
+/**
+ * @file
+ */
+
+#include "MappedScratchFile.h"
+#include "core/Log.h"
+
+#if defined(__LINUX__) || defined(__MACOSX__)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#elif defined(__WINDOWS__)
+#include <SDL_stdinc.h>
+#include <windows.h>
+#endif
+
+namespace io {
+
+MappedScratchFile::~MappedScratchFile() {
+	close();
+}
+
+bool MappedScratchFile::contains(const void *ptr) const {
+	const uint8_t *p = (const uint8_t *)ptr;
+	for (const uint8_t *segment : _segments) {
+		if (p >= segment && p < segment + _segmentSize) {
+			return true;
+		}
+	}
+	return false;
+}
+
+#if defined(__LINUX__) || defined(__MACOSX__)
+
+bool MappedScratchFile::open(const core::String &directory, size_t segmentSize) {
+	close();
+	core::String path = directory;
+	if (!path.empty() && path.last() != '/') {
+		path += "/";
+	}
+	path += "vengi-scratch-XXXXXX";
+	_fd = ::mkstemp(path.c_str());
+	if (_fd == -1) {
+		Log::debug("Failed to create the scratch file in %s", directory.c_str());
+		return false;
+	}
+	// the file is removed from the directory right away - the data is freed once the descriptor is closed
+	::unlink(path.c_str());
+	_segmentSize = segmentSize;
+	return true;
+}
+
+void MappedScratchFile::close() {
+	for (uint8_t *segment : _segments) {
+		::munmap(segment, _segmentSize);
+	}
+	_segments.clear();
+	if (_fd != -1) {
+		::close(_fd);
+	}
+	_fd = -1;
+}
+
+bool MappedScratchFile::valid() const {
+	return _fd != -1;
+}
+
+uint8_t *MappedScratchFile::grow() {
+	if (_fd == -1) {
+		return nullptr;
+	}
+	const off_t offset = (off_t)(_segments.size() * _segmentSize);
+	if (::ftruncate(_fd, offset + (off_t)_segmentSize) != 0) {
+		Log::warn("Failed to extend the scratch file to %i segments", (int)_segments.size() + 1);
+		return nullptr;
+	}
+	void *addr = ::mmap(nullptr, _segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, offset);
+	if (addr == MAP_FAILED) {
+		Log::warn("Failed to map segment %i of the scratch file", (int)_segments.size());
+		return nullptr;
+	}
+	_segments.push_back((uint8_t *)addr);
+	return (uint8_t *)addr;
+}
+
+#elif defined(__WINDOWS__)
+
+bool MappedScratchFile::open(const core::String &directory, size_t segmentSize) {
+	close();
+	WCHAR *wdir = (WCHAR *)SDL_iconv_string("UTF-16LE", "UTF-8", directory.c_str(), directory.size() + 1);
+	if (wdir == nullptr) {
+		return false;
+	}
+	WCHAR wpath[MAX_PATH];
+	const UINT unique = GetTempFileNameW(wdir, L"vgs", 0, wpath);
+	SDL_free(wdir);
+	if (unique == 0) {
+		Log::debug("Failed to create the scratch file in %s", directory.c_str());
+		return false;
+	}
+	// the file is deleted once the last handle is closed
+	HANDLE file = CreateFileW(wpath, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+							  FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		DeleteFileW(wpath);
+		Log::debug("Failed to open the scratch file in %s", directory.c_str());
+		return false;
+	}
+	_file = file;
+	_segmentSize = segmentSize;
+	return true;
+}
+
+void MappedScratchFile::close() {
+	for (uint8_t *segment : _segments) {
+		UnmapViewOfFile(segment);
+	}
+	_segments.clear();
+	for (void *mapping : _mappings) {
+		CloseHandle((HANDLE)mapping);
+	}
+	_mappings.clear();
+	if (_file != nullptr) {
+		CloseHandle((HANDLE)_file);
+	}
+	_file = nullptr;
+}
+
+bool MappedScratchFile::valid() const {
+	return _file != nullptr;
+}
+
+uint8_t *MappedScratchFile::grow() {
+	if (_file == nullptr) {
+		return nullptr;
+	}
+	const uint64_t offset = (uint64_t)_segments.size() * _segmentSize;
+	const uint64_t size = offset + _segmentSize;
+	// creating a mapping that is bigger than the file extends the file
+	HANDLE mapping = CreateFileMappingW((HANDLE)_file, nullptr, PAGE_READWRITE, (DWORD)(size >> 32),
+										(DWORD)(size & 0xFFFFFFFFu), nullptr);
+	if (mapping == nullptr) {
+		Log::warn("Failed to extend the scratch file to %i segments", (int)_segments.size() + 1);
+		return nullptr;
+	}
+	void *addr = MapViewOfFile(mapping, FILE_MAP_WRITE, (DWORD)(offset >> 32), (DWORD)(offset & 0xFFFFFFFFu),
+							   _segmentSize);
+	if (addr == nullptr) {
+		Log::warn("Failed to map segment %i of the scratch file", (int)_segments.size());
+		CloseHandle(mapping);
+		return nullptr;
+	}
+	_mappings.push_back(mapping);
+	_segments.push_back((uint8_t *)addr);
+	return (uint8_t *)addr;
+}
+
+#else
+
+bool MappedScratchFile::open(const core::String &directory, size_t segmentSize) {
+	return false;
+}
+
+void MappedScratchFile::close() {
+}
+
+bool MappedScratchFile::valid() const {
+	return false;
+}
+
+uint8_t *MappedScratchFile::grow() {
+	return nullptr;
+}
+
+#endif
+
+} // namespace io
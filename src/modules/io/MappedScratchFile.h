@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include <SDL_platform.h>
+#include <stdint.h>
+
+namespace io {
+
+/**
+ * @brief Temporary file that is mapped into memory in segments of a fixed size
+ *
+ * The memory of the segments is backed by the file instead of the swap - the operating system writes pages that
+ * were not used for a while into the file and drops them from memory. This allows to work on more data than fits
+ * into the memory as long as the working set is small enough. The file is deleted once it is closed.
+ *
+ * The segments stay mapped at the same address until the file is closed - so pointers into the segments stay valid
+ * while the file grows.
+ *
+ * @ingroup IO
+ * @see MemoryMappedFile
+ */
+class MappedScratchFile : public core::NonCopyable {
+private:
+	core::DynamicArray<uint8_t *> _segments;
+	size_t _segmentSize = 0u;
+#ifdef __WINDOWS__
+	void *_file = nullptr;
+	core::DynamicArray<void *> _mappings;
+#else
+	int _fd = -1;
+#endif
+
+public:
+	~MappedScratchFile();
+
+	/**
+	 * @param[in] directory The directory on the system the file is created in - this is not resolved by the virtual
+	 * file system
+	 * @param[in] segmentSize The size of the segments that are mapped by @c grow() - must be a multiple of 64KB (the
+	 * allocation granularity of the mappings on windows)
+	 * @return @c false if the platform doesn't support mappings or the file could not get created
+	 */
+	bool open(const core::String &directory, size_t segmentSize);
+	void close();
+
+	/**
+	 * @brief Extends the file by one segment and maps it
+	 * @return The start of the new segment or @c nullptr if the file could not get extended (e.g. the disk is full)
+	 */
+	uint8_t *grow();
+	/**
+	 * @return @c true if the given address is inside one of the mapped segments
+	 */
+	bool contains(const void *ptr) const;
+
+	bool valid() const;
+	size_t segmentSize() const;
+	size_t segments() const;
+};
+
+inline size_t MappedScratchFile::segmentSize() const {
+	return _segmentSize;
+}
+
+inline size_t MappedScratchFile::segments() const {
+	return _segments.size();
+}
+
+} // namespace io
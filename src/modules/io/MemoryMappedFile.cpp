@@ -0,0 +1,129 @@
+/**
+ * @file
+ */
+
+#include "MemoryMappedFile.h"
+#include "core/Log.h"
+
+#if defined(__LINUX__) || defined(__MACOSX__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#elif defined(__WINDOWS__)
+#include <SDL_stdinc.h>
+#include <windows.h>
+#endif
+
+namespace io {
+
+MemoryMappedFile::~MemoryMappedFile() {
+	unmap();
+}
+
+#if defined(__LINUX__) || defined(__MACOSX__)
+
+bool MemoryMappedFile::map(const core::String &path) {
+	unmap();
+	const int fd = ::open(path.c_str(), O_RDONLY);
+	if (fd == -1) {
+		Log::debug("Failed to open %s for mapping", path.c_str());
+		return false;
+	}
+	struct stat st;
+	if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+		Log::debug("Can't map %s - not a regular file or empty", path.c_str());
+		::close(fd);
+		return false;
+	}
+	void *addr = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping stays valid after the descriptor was closed
+	::close(fd);
+	if (addr == MAP_FAILED) {
+		Log::debug("Failed to map %s", path.c_str());
+		return false;
+	}
+	::madvise(addr, (size_t)st.st_size, MADV_SEQUENTIAL);
+	_data = (const uint8_t *)addr;
+	_size = (int64_t)st.st_size;
+	return true;
+}
+
+void MemoryMappedFile::unmap() {
+	if (_data != nullptr) {
+		::munmap((void *)_data, (size_t)_size);
+	}
+	_data = nullptr;
+	_size = 0;
+}
+
+#elif defined(__WINDOWS__)
+
+bool MemoryMappedFile::map(const core::String &path) {
+	unmap();
+	WCHAR *wpath = (WCHAR *)SDL_iconv_string("UTF-16LE", "UTF-8", path.c_str(), path.size() + 1);
+	if (wpath == nullptr) {
+		return false;
+	}
+	HANDLE file = CreateFileW(wpath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+							  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	SDL_free(wpath);
+	if (file == INVALID_HANDLE_VALUE) {
+		Log::debug("Failed to open %s for mapping", path.c_str());
+		return false;
+	}
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+		CloseHandle(file);
+		return false;
+	}
+	HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		Log::debug("Failed to map %s", path.c_str());
+		CloseHandle(file);
+		return false;
+	}
+	const void *addr = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (addr == nullptr) {
+		Log::debug("Failed to map a view of %s", path.c_str());
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+	_file = file;
+	_mapping = mapping;
+	_data = (const uint8_t *)addr;
+	_size = (int64_t)size.QuadPart;
+	return true;
+}
+
+void MemoryMappedFile::unmap() {
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mapping != nullptr) {
+		CloseHandle((HANDLE)_mapping);
+	}
+	if (_file != nullptr) {
+		CloseHandle((HANDLE)_file);
+	}
+	_file = nullptr;
+	_mapping = nullptr;
+	_data = nullptr;
+	_size = 0;
+}
+
+#else
+
+bool MemoryMappedFile::map(const core::String &path) {
+	return false;
+}
+
+void MemoryMappedFile::unmap() {
+	_data = nullptr;
+	_size = 0;
+}
+
+#endif
+
+} // namespace io
@@ -0,0 +1,60 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/NonCopyable.h"
+#include <SDL_platform.h>
+#include <stdint.h>
+
+namespace io {
+
+/**
+ * @brief Read-only memory mapping of a file on the system
+ *
+ * The mapped bytes are available without copying them into an intermediate buffer. If the platform doesn't
+ * support mappings (or the file is not a real file - like an android asset) @c map() fails and the caller has
+ * to fall back to the usual read calls.
+ *
+ * @ingroup IO
+ * @see FileStream
+ */
+class MemoryMappedFile : public core::NonCopyable {
+private:
+	const uint8_t *_data = nullptr;
+	int64_t _size = 0;
+#ifdef __WINDOWS__
+	void *_file = nullptr;
+	void *_mapping = nullptr;
+#endif
+
+public:
+	~MemoryMappedFile();
+
+	/**
+	 * @param[in] path The path on the system - this is not resolved by the virtual file system
+	 * @return @c false if the file could not get mapped
+	 */
+	bool map(const core::String &path);
+	void unmap();
+
+	bool valid() const;
+	const uint8_t *data() const;
+	int64_t size() const;
+};
+
+inline bool MemoryMappedFile::valid() const {
+	return _data != nullptr;
+}
+
+inline const uint8_t *MemoryMappedFile::data() const {
+	return _data;
+}
+
+inline int64_t MemoryMappedFile::size() const {
+	return _size;
+}
+
+} // namespace io
@@ -0,0 +1,173 @@
+/**
+ * @file
+ */
+
+#include "PrefetchReadStream.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include "core/concurrent/Thread.h"
+
+namespace io {
+
+PrefetchReadStream::PrefetchReadStream(SeekableReadStream &stream, int blockSize, int blocks)
+	: _stream(stream), _size(stream.size()), _blockSize(core_max(blockSize, 4096)) {
+	_pos = _prefetchPos = _stream.pos();
+	// don't reserve more memory than the remaining bytes of the stream need
+	const int64_t neededBlocks = (_size - _pos + _blockSize - 1) / _blockSize;
+	_blockCount = (int)core_max((int64_t)1, core_min((int64_t)blocks, neededBlocks));
+	_memory = (uint8_t *)core_malloc((size_t)_blockCount * (size_t)_blockSize);
+	_blocks = new Block[_blockCount];
+	_endOfStream = _pos >= _size;
+	_thread = new core::Thread("prefetch", prefetch, this);
+}
+
+PrefetchReadStream::~PrefetchReadStream() {
+	{
+		core::ScopedLock lock(_lock);
+		_stop = true;
+		_consumedCondition.notify_all();
+	}
+	_thread->join();
+	delete _thread;
+	_stream.seek(_pos);
+	delete[] _blocks;
+	core_free(_memory);
+}
+
+int PrefetchReadStream::prefetch(void *data) {
+	PrefetchReadStream *stream = (PrefetchReadStream *)data;
+	stream->prefetchLoop();
+	return 0;
+}
+
+void PrefetchReadStream::prefetchLoop() {
+	for (;;) {
+		int slot;
+		int64_t position;
+		uint32_t generation;
+		{
+			core::ScopedLock lock(_lock);
+			while (!_stop && (_endOfStream || _count >= _blockCount)) {
+				_consumedCondition.wait(_lock);
+			}
+			if (_stop) {
+				return;
+			}
+			// the slot is neither consumed nor read by anybody else until the count is increased
+			slot = (_head + _count) % _blockCount;
+			position = _prefetchPos;
+			generation = _generation;
+		}
+
+		int n = -1;
+		if (_stream.pos() == position || _stream.seek(position) != -1) {
+			n = _stream.read(blockData(slot), _blockSize);
+		}
+
+		core::ScopedLock lock(_lock);
+		if (generation != _generation) {
+			// the prefetching was restarted at another position while reading
+			continue;
+		}
+		if (n > 0) {
+			_blocks[slot].pos = position;
+			_blocks[slot].size = n;
+			_prefetchPos += n;
+			++_count;
+		}
+		if (n <= 0 || _prefetchPos >= _size) {
+			_endOfStream = true;
+		}
+		_filledCondition.notify_all();
+	}
+}
+
+bool PrefetchReadStream::nextBlock() {
+	core::ScopedLock lock(_lock);
+	if (_hasBlock) {
+		_hasBlock = false;
+		_head = (_head + 1) % _blockCount;
+		--_count;
+		_consumedCondition.notify_all();
+	}
+	while (_count == 0 && !_endOfStream) {
+		_filledCondition.wait(_lock);
+	}
+	if (_count == 0) {
+		return false;
+	}
+	const Block &block = _blocks[_head];
+	_cur = blockData(_head) + (_pos - block.pos);
+	_end = blockData(_head) + block.size;
+	_hasBlock = true;
+	return true;
+}
+
+void PrefetchReadStream::restart(int64_t position) {
+	core::ScopedLock lock(_lock);
+	++_generation;
+	_head = 0;
+	_count = 0;
+	_prefetchPos = position;
+	_endOfStream = position >= _size;
+	_hasBlock = false;
+	_cur = _end = nullptr;
+	_consumedCondition.notify_all();
+}
+
+int PrefetchReadStream::read(void *dataPtr, size_t dataSize) {
+	uint8_t *out = (uint8_t *)dataPtr;
+	size_t remaining = dataSize;
+	while (remaining > 0u) {
+		if (_cur == _end) {
+			if (!nextBlock()) {
+				break;
+			}
+			continue;
+		}
+		const size_t n = core_min((size_t)(_end - _cur), remaining);
+		core_memcpy(out, _cur, n);
+		_cur += n;
+		out += n;
+		remaining -= n;
+		_pos += (int64_t)n;
+	}
+	return (int)(dataSize - remaining);
+}
+
+int64_t PrefetchReadStream::seek(int64_t position, int whence) {
+	int64_t p;
+	switch (whence) {
+	case SEEK_SET:
+		p = position;
+		break;
+	case SEEK_CUR:
+		p = _pos + position;
+		break;
+	case SEEK_END:
+		p = _size + position;
+		break;
+	default:
+		return -1;
+	}
+	if (p < 0) {
+		return -1;
+	}
+	if (p == _pos) {
+		return p;
+	}
+	if (_hasBlock) {
+		// the current block is only touched by this thread
+		const Block &block = _blocks[_head];
+		if (p >= block.pos && p <= block.pos + block.size) {
+			_cur = blockData(_head) + (p - block.pos);
+			_pos = p;
+			return p;
+		}
+	}
+	restart(p);
+	_pos = p;
+	return p;
+}
+
+} // namespace io
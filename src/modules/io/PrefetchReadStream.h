@@ -0,0 +1,109 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Trace.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "io/Stream.h"
+
+namespace core {
+class Thread;
+}
+
+namespace io {
+
+/**
+ * @brief Reads the wrapped stream on a background thread ahead of the current position
+ *
+ * The next blocks of the stream are read while the caller decodes the current one - this hides the latency of
+ * slow (e.g. network) filesystems. Sequential reads and small seeks inside of the current block are cheap - any
+ * other seek drops the prefetched blocks and restarts the prefetching at the new position.
+ *
+ * @note The wrapped stream is only accessed by the background thread while this stream is alive and is positioned
+ * at the current position of this stream again when this stream is destroyed.
+ * @ingroup IO
+ */
+class PrefetchReadStream final : public SeekableReadStream {
+private:
+	struct Block {
+		int64_t pos = 0;
+		int size = 0;
+	};
+
+	SeekableReadStream &_stream;
+	const int64_t _size;
+	const int _blockSize;
+	int _blockCount;
+	uint8_t *_memory = nullptr;
+	Block *_blocks = nullptr;
+
+	core_trace_mutex(core::Lock, _lock, "PrefetchReadStream");
+	/**
+	 * @brief Signaled by the background thread if a block was read
+	 */
+	core::ConditionVariable _filledCondition;
+	/**
+	 * @brief Signaled if a block was given back to the background thread or the prefetching was restarted
+	 */
+	core::ConditionVariable _consumedCondition;
+	/**
+	 * @brief The ring of read blocks that were not yet consumed - the block at @c _head is the current one
+	 */
+	int _head = 0;
+	int _count = 0;
+	/**
+	 * @brief The stream position of the next block the background thread reads
+	 */
+	int64_t _prefetchPos = 0;
+	/**
+	 * @brief Incremented on every restart to drop the block that is read in the meantime
+	 */
+	uint32_t _generation = 0u;
+	bool _endOfStream = false;
+	bool _stop = false;
+	core::Thread *_thread = nullptr;
+
+	// only accessed by the reading thread
+	const uint8_t *_cur = nullptr;
+	const uint8_t *_end = nullptr;
+	bool _hasBlock = false;
+	int64_t _pos = 0;
+
+	static int prefetch(void *data);
+	void prefetchLoop();
+	inline uint8_t *blockData(int idx) const {
+		return _memory + (size_t)idx * (size_t)_blockSize;
+	}
+	/**
+	 * @brief Gives the current block back to the background thread and waits for the next one
+	 * @return @c false if the end of the stream was reached
+	 */
+	bool nextBlock();
+	void restart(int64_t position);
+
+public:
+	/**
+	 * @param[in] blockSize The size of a single read call on the wrapped stream
+	 * @param[in] blocks The amount of blocks that are read ahead of the current position
+	 */
+	PrefetchReadStream(SeekableReadStream &stream, int blockSize = 1024 * 1024, int blocks = 8);
+	~PrefetchReadStream();
+
+	int read(void *dataPtr, size_t dataSize) override;
+	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+	int64_t size() const override;
+	int64_t pos() const override;
+};
+
+inline int64_t PrefetchReadStream::size() const {
+	return _size;
+}
+
+inline int64_t PrefetchReadStream::pos() const {
+	return _pos;
+}
+
+} // namespace io
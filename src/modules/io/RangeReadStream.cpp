@@ -0,0 +1,135 @@
+/**
+ * @file
+ */
+
+#include "RangeReadStream.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+
+namespace io {
+
+RangeReadStream::RangeReadStream(RangeSource &source, int blockSize, int cacheBlocks, int readAheadBlocks)
+	: _source(source), _size(core_max(source.size(), (int64_t)0)), _blockSize(core_max(blockSize, 1024)),
+	  _readAheadBlocks(core_max(1, core_min(readAheadBlocks, cacheBlocks))) {
+	_blocks.resize(core_max(cacheBlocks, 1));
+	_memory = (uint8_t *)core_malloc(_blocks.size() * (size_t)_blockSize);
+	_fetchBuffer = (uint8_t *)core_malloc((size_t)_readAheadBlocks * (size_t)_blockSize);
+	// the first fetch only gets the block that is needed - a header probe shouldn't transfer more
+	_nextSequentialBlock = -1;
+}
+
+RangeReadStream::~RangeReadStream() {
+	core_free(_fetchBuffer);
+	core_free(_memory);
+}
+
+int RangeReadStream::findBlock(int64_t index) const {
+	for (size_t i = 0; i < _blocks.size(); ++i) {
+		if (_blocks[i].index == index) {
+			return (int)i;
+		}
+	}
+	return -1;
+}
+
+int RangeReadStream::leastRecentlyUsedBlock() const {
+	int slot = 0;
+	for (size_t i = 1; i < _blocks.size(); ++i) {
+		if (_blocks[i].lastUse < _blocks[slot].lastUse) {
+			slot = (int)i;
+		}
+	}
+	return slot;
+}
+
+const uint8_t *RangeReadStream::block(int64_t index, int &size) {
+	int slot = findBlock(index);
+	if (slot == -1) {
+		const int64_t blocks = (_size + _blockSize - 1) / _blockSize;
+		if (index < 0 || index >= blocks) {
+			return nullptr;
+		}
+		int count = 1;
+		if (index == _nextSequentialBlock) {
+			count = (int)core_min((int64_t)_readAheadBlocks, blocks - index);
+			// don't fetch the blocks again that are still cached
+			for (int i = 1; i < count; ++i) {
+				if (findBlock(index + i) != -1) {
+					count = i;
+					break;
+				}
+			}
+		}
+		const int64_t offset = index * _blockSize;
+		const int len = (int)core_min((int64_t)count * _blockSize, _size - offset);
+		if (_source.fetch(offset, _fetchBuffer, len) != len) {
+			Log::error("Failed to fetch %i bytes at offset %i", len, (int)offset);
+			return nullptr;
+		}
+		for (int i = 0; i < count; ++i) {
+			const int s = leastRecentlyUsedBlock();
+			Block &b = _blocks[s];
+			b.index = index + i;
+			b.size = core_min(_blockSize, len - i * _blockSize);
+			b.lastUse = ++_useCounter;
+			core_memcpy(_memory + (size_t)s * (size_t)_blockSize, _fetchBuffer + (size_t)i * (size_t)_blockSize,
+						b.size);
+			if (i == 0) {
+				slot = s;
+			}
+		}
+		_nextSequentialBlock = index + count;
+	}
+	Block &b = _blocks[slot];
+	b.lastUse = ++_useCounter;
+	size = b.size;
+	return _memory + (size_t)slot * (size_t)_blockSize;
+}
+
+int RangeReadStream::read(void *dataPtr, size_t dataSize) {
+	uint8_t *out = (uint8_t *)dataPtr;
+	size_t remaining = core_min(dataSize, (size_t)(_size - _pos));
+	const size_t wanted = remaining;
+	while (remaining > 0u) {
+		int size = 0;
+		const uint8_t *data = block(_pos / _blockSize, size);
+		if (data == nullptr) {
+			if (remaining == wanted) {
+				return -1;
+			}
+			break;
+		}
+		const int blockOffset = (int)(_pos % _blockSize);
+		const size_t n = core_min((size_t)(size - blockOffset), remaining);
+		core_memcpy(out, data + blockOffset, n);
+		out += n;
+		remaining -= n;
+		_pos += (int64_t)n;
+	}
+	return (int)(wanted - remaining);
+}
+
+int64_t RangeReadStream::seek(int64_t position, int whence) {
+	switch (whence) {
+	case SEEK_SET:
+		_pos = position;
+		break;
+	case SEEK_CUR:
+		_pos += position;
+		break;
+	case SEEK_END:
+		_pos = _size + position;
+		break;
+	default:
+		return -1;
+	}
+	if (_pos < 0) {
+		_pos = 0;
+	} else if (_pos > _size) {
+		_pos = _size;
+	}
+	return _pos;
+}
+
+} // namespace io
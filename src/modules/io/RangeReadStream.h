@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include "io/Stream.h"
+
+namespace io {
+
+/**
+ * @brief A random access source of bytes where every access is expensive - e.g. range requests to a remote server
+ * @sa RangeReadStream
+ * @ingroup IO
+ */
+class RangeSource {
+public:
+	virtual ~RangeSource() {}
+	/**
+	 * @return The amount of bytes of the source or -1 if unknown
+	 */
+	virtual int64_t size() const = 0;
+	/**
+	 * @brief Reads @c len bytes at the given offset into the buffer
+	 * @return The amount of bytes that were read or -1 on error
+	 */
+	virtual int fetch(int64_t offset, uint8_t *buf, int len) = 0;
+};
+
+/**
+ * @brief Reads a @c RangeSource through a cache of fixed size blocks
+ *
+ * Only the blocks that are touched are fetched - a format that seeks to the data it needs (e.g. the header of a
+ * thumbnail or a single node) doesn't transfer the whole file. A miss on the block that follows the last fetched
+ * range is treated as a sequential read and fetches the following blocks with the same request. The least recently
+ * used block is replaced if the cache is full.
+ *
+ * @ingroup IO
+ */
+class RangeReadStream final : public SeekableReadStream {
+private:
+	struct Block {
+		/** the index of the block in the source - -1 for an unused slot */
+		int64_t index = -1;
+		int size = 0;
+		uint64_t lastUse = 0u;
+	};
+
+	RangeSource &_source;
+	const int64_t _size;
+	const int _blockSize;
+	const int _readAheadBlocks;
+	core::DynamicArray<Block> _blocks;
+	/** the data of the cached blocks - one block per slot of @c _blocks */
+	uint8_t *_memory = nullptr;
+	/** the destination of a fetch of several blocks before they are put into their slots */
+	uint8_t *_fetchBuffer = nullptr;
+	uint64_t _useCounter = 0u;
+	/** the block after the last fetched range - a miss on this block continues a sequential read */
+	int64_t _nextSequentialBlock = 0;
+	int64_t _pos = 0;
+
+	/**
+	 * @return The data of the block with the given index - fetched from the source if it isn't cached
+	 */
+	const uint8_t *block(int64_t index, int &size);
+	int findBlock(int64_t index) const;
+	int leastRecentlyUsedBlock() const;
+
+public:
+	/**
+	 * @param[in] blockSize The size of the cached blocks and of a single fetch for random reads
+	 * @param[in] cacheBlocks The amount of blocks that are kept
+	 * @param[in] readAheadBlocks The amount of blocks that are fetched with one request for sequential reads
+	 */
+	RangeReadStream(RangeSource &source, int blockSize = 64 * 1024, int cacheBlocks = 64, int readAheadBlocks = 8);
+	~RangeReadStream();
+
+	int read(void *dataPtr, size_t dataSize) override;
+	int64_t seek(int64_t position, int whence = SEEK_SET) override;
+	int64_t size() const override;
+	int64_t pos() const override;
+};
+
+inline int64_t RangeReadStream::size() const {
+	return _size;
+}
+
+inline int64_t RangeReadStream::pos() const {
+	return _pos;
+}
+
+} // namespace io
@@ -4,7 +4,10 @@
 
 #include "Stream.h"
 #include "core/String.h"
+#include "core/ArrayLength.h"
 #include "core/Assert.h"
+#include "core/Hash.h"
+#include "core/StandardLib.h"
 #include <SDL_endian.h>
 #include <SDL_stdinc.h>
 #include <fcntl.h>
@@ -21,16 +24,11 @@ bool WriteStream::writeStringFormat(bool terminate, const char *fmt, ...) {
 	SDL_vsnprintf(text, bufSize, fmt, ap);
 	text[sizeof(text) - 1] = '\0';
 	va_end(ap);
-	const size_t length = SDL_strlen(text);
-	for (size_t i = 0u; i < length; i++) {
-		if (!writeUInt8(uint8_t(text[i]))) {
-			return false;
-		}
-	}
-	if (!terminate) {
-		return true;
+	size_t length = SDL_strlen(text);
+	if (terminate) {
+		++length;
 	}
-	return writeUInt8(uint8_t('\0'));
+	return write(text, length) == (int)length;
 }
 
 bool WriteStream::writeFormat(const char *fmt, ...) {
@@ -83,72 +81,59 @@ bool WriteStream::writeUInt8(uint8_t val) {
 }
 
 bool WriteStream::writeString(const core::String &string, bool terminate) {
-	const size_t length = string.size();
-	for (size_t i = 0u; i < length; i++) {
-		if (!writeUInt8(uint8_t(string[i]))) {
-			return false;
-		}
+	size_t length = string.size();
+	if (terminate) {
+		// the string is always null terminated in memory
+		++length;
 	}
-	if (!terminate) {
+	if (length == 0u) {
 		return true;
 	}
-	return writeUInt8(uint8_t('\0'));
+	return write(string.c_str(), length) == (int)length;
 }
 
 bool WriteStream::writePascalStringUInt16LE(const core::String &str) {
-	uint16_t length = str.size();
+	const uint16_t length = (uint16_t)str.size();
 	if (!writeUInt16(length)) {
 		return false;
 	}
-	for (uint16_t i = 0u; i < length; ++i) {
-		uint8_t chr = str[i];
-		if (!writeUInt8(chr)) {
-			return false;
-		}
+	if (length == 0u) {
+		return true;
 	}
-	return true;
+	return write(str.c_str(), length) == (int)length;
 }
 
 bool WriteStream::writePascalStringUInt16BE(const core::String &str) {
-	uint16_t length = str.size();
+	const uint16_t length = (uint16_t)str.size();
 	if (!writeUInt16BE(length)) {
 		return false;
 	}
-	for (uint16_t i = 0u; i < length; ++i) {
-		uint8_t chr = str[i];
-		if (!writeUInt8(chr)) {
-			return false;
-		}
+	if (length == 0u) {
+		return true;
 	}
-	return true;
+	return write(str.c_str(), length) == (int)length;
 }
 
 bool WriteStream::writePascalStringUInt32LE(const core::String &str) {
-	uint16_t length = str.size();
+	const uint32_t length = (uint32_t)str.size();
 	if (!writeUInt32(length)) {
 		return false;
 	}
-	for (uint16_t i = 0u; i < length; ++i) {
-		uint8_t chr = str[i];
-		if (!writeUInt8(chr)) {
-			return false;
-		}
+	if (length == 0u) {
+		return true;
 	}
-	return true;
+	return write(str.c_str(), length) == (int)length;
 }
 
 bool WriteStream::writePascalStringUInt32BE(const core::String &str) {
-	uint16_t length = str.size();
+	const uint32_t length = (uint32_t)str.size();
 	if (!writeUInt32BE(length)) {
 		return false;
 	}
-	for (uint16_t i = 0u; i < length; ++i) {
-		uint8_t chr = str[i];
-		if (!writeUInt8(chr)) {
-			return false;
-		}
+	if (length == 0u) {
+		return true;
 	}
-	return true;
+	return write(str.c_str(), length) == (int)length;
 }
 
 bool WriteStream::writeInt16(int16_t word) {
@@ -190,6 +175,15 @@ bool WriteStream::writeFloat(float value) {
 	return writeUInt32(tmp.i);
 }
 
+bool WriteStream::writeDouble(double value) {
+	union toint {
+		double f;
+		uint64_t i;
+	} tmp;
+	tmp.f = value;
+	return writeUInt64(tmp.i);
+}
+
 bool WriteStream::writeInt16BE(int16_t word) {
 	const int16_t swappedWord = SDL_SwapBE16(word);
 	return write(&swappedWord, sizeof(int16_t)) != -1;
@@ -285,6 +279,9 @@ bool ReadStream::readFormat(const char *fmt, ...) {
 }
 
 bool ReadStream::readString(int length, char *strbuff, bool terminated) {
+	if (!terminated) {
+		return length <= 0 || read(strbuff, length) == length;
+	}
 	for (int i = 0; i < length; ++i) {
 		uint8_t chr;
 		if (readUInt8(chr) != 0) {
@@ -300,6 +297,18 @@ bool ReadStream::readString(int length, char *strbuff, bool terminated) {
 
 bool ReadStream::readString(int length, core::String &str, bool terminated) {
 	str.clear();
+	if (!terminated && length > 0) {
+		char buf[256];
+		while (length > 0) {
+			const int n = core_min(length, (int)sizeof(buf));
+			if (read(buf, n) != n) {
+				return false;
+			}
+			str.append(buf, n);
+			length -= n;
+		}
+		return true;
+	}
 	str.reserve(length);
 	for (int i = 0; i < length; ++i) {
 		uint8_t chr;
@@ -532,6 +541,102 @@ int ReadStream::readInt64BE(int64_t &val) {
 	return -1;
 }
 
+/**
+ * @brief Converts the little endian values in place - the loop is vectorized by the compiler and a no-op on
+ * little endian machines
+ */
+template<typename T>
+static inline void swapLE(T *vals, size_t n) {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	for (size_t i = 0u; i < n; ++i) {
+		if constexpr (sizeof(T) == 2) {
+			vals[i] = (T)SDL_Swap16((uint16_t)vals[i]);
+		} else if constexpr (sizeof(T) == 8) {
+			vals[i] = (T)SDL_Swap64((uint64_t)vals[i]);
+		} else {
+			vals[i] = (T)SDL_Swap32((uint32_t)vals[i]);
+		}
+	}
+#else
+	(void)vals;
+	(void)n;
+#endif
+}
+
+int ReadStream::readUInt16Array(uint16_t *vals, size_t n) {
+	const int size = (int)(n * sizeof(*vals));
+	if (read(vals, size) != size) {
+		return -1;
+	}
+	swapLE(vals, n);
+	return 0;
+}
+
+int ReadStream::readInt32Array(int32_t *vals, size_t n) {
+	const int size = (int)(n * sizeof(*vals));
+	if (read(vals, size) != size) {
+		return -1;
+	}
+	swapLE(vals, n);
+	return 0;
+}
+
+int ReadStream::readUInt32Array(uint32_t *vals, size_t n) {
+	const int size = (int)(n * sizeof(*vals));
+	if (read(vals, size) != size) {
+		return -1;
+	}
+	swapLE(vals, n);
+	return 0;
+}
+
+int ReadStream::readFloatArray(float *vals, size_t n) {
+	static_assert(sizeof(float) == sizeof(uint32_t), "Unexpected float size");
+	return readUInt32Array((uint32_t *)vals, n);
+}
+
+template<typename T>
+static bool writeArrayLE(WriteStream &stream, const T *vals, size_t n) {
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	T buf[256];
+	while (n > 0u) {
+		const size_t cnt = core_min(n, (size_t)lengthof(buf));
+		core_memcpy(buf, vals, cnt * sizeof(T));
+		swapLE(buf, cnt);
+		if (stream.write(buf, cnt * sizeof(T)) != (int)(cnt * sizeof(T))) {
+			return false;
+		}
+		vals += cnt;
+		n -= cnt;
+	}
+	return true;
+#else
+	const int size = (int)(n * sizeof(T));
+	return size == 0 || stream.write(vals, size) == size;
+#endif
+}
+
+bool WriteStream::writeUInt16Array(const uint16_t *vals, size_t n) {
+	return writeArrayLE(*this, vals, n);
+}
+
+bool WriteStream::writeInt32Array(const int32_t *vals, size_t n) {
+	return writeArrayLE(*this, vals, n);
+}
+
+bool WriteStream::writeUInt32Array(const uint32_t *vals, size_t n) {
+	return writeArrayLE(*this, vals, n);
+}
+
+bool WriteStream::writeFloatArray(const float *vals, size_t n) {
+	return writeArrayLE(*this, (const uint32_t *)vals, n);
+}
+
+bool WriteStream::writeDoubleArray(const double *vals, size_t n) {
+	static_assert(sizeof(double) == sizeof(uint64_t), "Unexpected double size");
+	return writeArrayLE(*this, (const uint64_t *)vals, n);
+}
+
 bool SeekableReadStream::readLine(int length, char *strbuff) {
 	for (int i = 0; i < length; ++i) {
 		uint8_t chr;
@@ -582,8 +687,51 @@ int SeekableReadStream::peekUInt8(uint8_t &val) {
 	return retVal;
 }
 
+StreamData::StreamData(SeekableReadStream &stream) {
+	_size = stream.remaining();
+	if (_size <= 0) {
+		_size = 0;
+		return;
+	}
+	const uint8_t *mem = stream.data();
+	if (mem != nullptr) {
+		_data = mem + stream.pos();
+		stream.seek(0, SEEK_END);
+		return;
+	}
+	_buffer = (uint8_t *)core_malloc(_size);
+	if (stream.read(_buffer, _size) != (int)_size) {
+		core_free(_buffer);
+		_buffer = nullptr;
+		_size = 0;
+		return;
+	}
+	_data = _buffer;
+}
+
+StreamData::~StreamData() {
+	core_free(_buffer);
+}
+
 int64_t SeekableReadStream::skip(int64_t delta) {
 	return seek(delta, SEEK_CUR);
 }
 
+bool hash64(ReadStream &stream, uint64_t &hash, uint64_t seed) {
+	core::Hash64 hasher(seed);
+	uint8_t buf[16384];
+	while (!stream.eos()) {
+		const int n = stream.read(buf, sizeof(buf));
+		if (n < 0) {
+			return false;
+		}
+		if (n == 0) {
+			break;
+		}
+		hasher.update(buf, n);
+	}
+	hash = hasher.digest();
+	return true;
+}
+
 } // namespace io
@@ -111,6 +111,27 @@ public:
 	 * @return -1 on error - 0 on success
 	 */
 	int readDoubleBE(double &val);
+
+	/**
+	 * @brief Reads @c n little endian values with one read call
+	 * @return -1 on error - 0 on success
+	 */
+	int readUInt16Array(uint16_t *vals, size_t n);
+	/**
+	 * @brief Reads @c n little endian values with one read call
+	 * @return -1 on error - 0 on success
+	 */
+	int readInt32Array(int32_t *vals, size_t n);
+	/**
+	 * @brief Reads @c n little endian values with one read call
+	 * @return -1 on error - 0 on success
+	 */
+	int readUInt32Array(uint32_t *vals, size_t n);
+	/**
+	 * @brief Reads @c n little endian values with one read call
+	 * @return -1 on error - 0 on success
+	 */
+	int readFloatArray(float *vals, size_t n);
 	/**
 	 * @brief Read a fixed-width string from a file. It may be null-terminated, but
 	 * the position of the stream is still advanced by the given length
@@ -208,6 +229,16 @@ public:
 	 */
 	int64_t remaining() const;
 	bool empty() const;
+
+	/**
+	 * @brief Direct access to the bytes of the stream - without copying them
+	 * @return @c nullptr if the stream is not backed by memory - otherwise the beginning of the stream with
+	 * @c size() bytes
+	 * @sa StreamData
+	 */
+	virtual const uint8_t *data() const {
+		return nullptr;
+	}
 };
 
 inline int64_t SeekableReadStream::remaining() const {
@@ -244,6 +275,7 @@ public:
 	bool writeUInt32(uint32_t val);
 	bool writeUInt64(uint64_t val);
 	bool writeFloat(float val);
+	bool writeDouble(double val);
 
 	bool writeInt16BE(int16_t val);
 	bool writeInt32BE(int32_t val);
@@ -253,6 +285,27 @@ public:
 	bool writeUInt64BE(uint64_t val);
 	bool writeFloatBE(float val);
 
+	/**
+	 * @brief Writes @c n values in little endian with one write call
+	 */
+	bool writeUInt16Array(const uint16_t *vals, size_t n);
+	/**
+	 * @brief Writes @c n values in little endian with one write call
+	 */
+	bool writeInt32Array(const int32_t *vals, size_t n);
+	/**
+	 * @brief Writes @c n values in little endian with one write call
+	 */
+	bool writeUInt32Array(const uint32_t *vals, size_t n);
+	/**
+	 * @brief Writes @c n values in little endian with one write call
+	 */
+	bool writeFloatArray(const float *vals, size_t n);
+	/**
+	 * @brief Writes @c n values in little endian with one write call
+	 */
+	bool writeDoubleArray(const double *vals, size_t n);
+
 	bool writeStringFormat(bool terminate, CORE_FORMAT_STRING const char *fmt, ...) CORE_PRINTF_VARARG_FUNC(3);
 	/**
 	 * @param terminate If this is @c true the extra null byte is written to the stream
@@ -305,6 +358,33 @@ public:
 	virtual int64_t pos() const = 0;
 };
 
+/**
+ * @brief Gives access to the remaining bytes of a stream as one block of memory. Streams that are backed by
+ * memory (see @c SeekableReadStream::data()) are not copied - all others are read into a temporary buffer.
+ * @note The stream position is advanced to the end of the stream
+ * @ingroup IO
+ */
+class StreamData : public core::NonCopyable {
+private:
+	uint8_t *_buffer = nullptr;
+	const uint8_t *_data = nullptr;
+	int64_t _size = 0;
+
+public:
+	StreamData(SeekableReadStream &stream);
+	~StreamData();
+
+	bool valid() const {
+		return _data != nullptr;
+	}
+	const uint8_t *data() const {
+		return _data;
+	}
+	int64_t size() const {
+		return _size;
+	}
+};
+
 template<class SeekableStream>
 class ScopedStreamPos {
 private:
@@ -324,6 +404,12 @@ public:
 	}
 };
 
+/**
+ * @brief Computes the @c core::hash64() of the remaining bytes of the stream without loading them into memory
+ * @return @c false if the stream could not get read until its end
+ */
+bool hash64(ReadStream &stream, uint64_t &hash, uint64_t seed = 0u);
+
 } // namespace io
 
 
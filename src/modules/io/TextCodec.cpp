@@ -0,0 +1,179 @@
+/**
+ * @file
+ */
+
+#include "TextCodec.h"
+#include "core/Common.h"
+#include "core/StandardLib.h"
+#include <SDL_stdinc.h>
+#include <math.h>
+#include <string.h>
+
+namespace io {
+
+TextReader::TextReader(SeekableReadStream &stream) : _data(stream) {
+	_cur = (const char *)_data.data();
+	_end = _cur + _data.size();
+}
+
+bool TextReader::readLine(const char *&begin, const char *&end) {
+	if (_cur >= _end) {
+		return false;
+	}
+	const char *lineEnd = (const char *)memchr(_cur, '\n', _end - _cur);
+	begin = _cur;
+	if (lineEnd == nullptr) {
+		end = _end;
+		_cur = _end;
+	} else {
+		end = lineEnd;
+		_cur = lineEnd + 1;
+	}
+	if (end > begin && end[-1] == '\r') {
+		--end;
+	}
+	return true;
+}
+
+bool TextReader::readLine(char *buf, size_t bufSize) {
+	const char *begin;
+	const char *end;
+	if (!readLine(begin, end)) {
+		return false;
+	}
+	const size_t len = (size_t)(end - begin);
+	if (len >= bufSize) {
+		return false;
+	}
+	core_memcpy(buf, begin, len);
+	buf[len] = '\0';
+	return true;
+}
+
+namespace {
+
+// "00010203...99"
+static const char DigitPairs[] = "0001020304050607080910111213141516171819"
+								 "2021222324252627282930313233343536373839"
+								 "4041424344454647484950515253545556575859"
+								 "6061626364656667686970717273747576777879"
+								 "8081828384858687888990919293949596979899";
+
+/**
+ * @return The amount of chars written to the end of the given buffer
+ */
+static int formatUInt(char *bufEnd, uint64_t value) {
+	char *p = bufEnd;
+	while (value >= 100u) {
+		const int pair = (int)(value % 100u) * 2;
+		value /= 100u;
+		*--p = DigitPairs[pair + 1];
+		*--p = DigitPairs[pair];
+	}
+	if (value >= 10u) {
+		const int pair = (int)value * 2;
+		*--p = DigitPairs[pair + 1];
+		*--p = DigitPairs[pair];
+	} else {
+		*--p = (char)('0' + value);
+	}
+	return (int)(bufEnd - p);
+}
+
+} // namespace
+
+TextWriter::TextWriter(WriteStream &stream, size_t bufferSize)
+	: _stream(stream), _capacity(core_max(bufferSize, (size_t)256)) {
+	_buffer = (char *)core_malloc(_capacity);
+}
+
+TextWriter::~TextWriter() {
+	flush();
+	core_free(_buffer);
+}
+
+void TextWriter::flushBuffer() {
+	if (_size == 0u) {
+		return;
+	}
+	if (_stream.write(_buffer, _size) != (int)_size) {
+		_failed = true;
+	}
+	_size = 0u;
+}
+
+bool TextWriter::flush() {
+	flushBuffer();
+	return !_failed;
+}
+
+void TextWriter::writeString(const char *str, size_t len) {
+	if (len > _capacity) {
+		flushBuffer();
+		if (_stream.write(str, len) != (int)len) {
+			_failed = true;
+		}
+		return;
+	}
+	core_memcpy(reserve(len), str, len);
+	_size += len;
+}
+
+void TextWriter::writeString(const char *str) {
+	writeString(str, SDL_strlen(str));
+}
+
+void TextWriter::writeInt(int64_t value) {
+	char buf[24];
+	char *bufEnd = buf + sizeof(buf);
+	const bool negative = value < 0;
+	const uint64_t absValue = negative ? 0u - (uint64_t)value : (uint64_t)value;
+	int n = formatUInt(bufEnd, absValue);
+	if (negative) {
+		bufEnd[-++n] = '-';
+	}
+	writeString(bufEnd - n, (size_t)n);
+}
+
+void TextWriter::writeFloat(float value, int decimals) {
+	static const uint64_t powersOf10[] = {1u,		 10u,		100u,		1000u,		 10000u,
+										  100000u,	 1000000u,	10000000u,	100000000u,	 1000000000u};
+	decimals = core_max(0, core_min(decimals, 9));
+	const double absValue = fabs((double)value);
+	// the integer arithmetic is exact for values that fit into 53 bits - everything else goes through printf
+	if (!(absValue < 1e15 / (double)powersOf10[decimals])) {
+		char buf[64];
+		const int n = SDL_snprintf(buf, sizeof(buf), "%.*f", decimals, value);
+		writeString(buf, (size_t)core_max(0, core_min(n, (int)sizeof(buf) - 1)));
+		return;
+	}
+	const uint64_t scaled = (uint64_t)llround(absValue * (double)powersOf10[decimals]);
+	const uint64_t integral = scaled / powersOf10[decimals];
+	uint64_t fraction = scaled % powersOf10[decimals];
+
+	char buf[48];
+	char *bufEnd = buf + sizeof(buf);
+	char *p = bufEnd;
+	for (int i = 0; i < decimals; ++i) {
+		*--p = (char)('0' + fraction % 10u);
+		fraction /= 10u;
+	}
+	if (decimals > 0) {
+		*--p = '.';
+	}
+	p -= formatUInt(p, integral);
+	if (value < 0.0f) {
+		*--p = '-';
+	}
+	writeString(p, (size_t)(bufEnd - p));
+}
+
+void TextWriter::writeHex(uint8_t value) {
+	static const char HexDigits[] = "0123456789ABCDEF";
+	char *p = reserve(2);
+	p[0] = HexDigits[value >> 4];
+	p[1] = HexDigits[value & 0xF];
+	_size += 2;
+}
+
+} // namespace io
@@ -0,0 +1,106 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/String.h"
+#include "io/Stream.h"
+
+namespace io {
+
+/**
+ * @brief Splits the remaining bytes of a stream into lines - mapped files are not copied
+ *
+ * Use @c core::string::parseInt() and @c core::string::parseFloat() to parse the numbers of a line.
+ *
+ * @ingroup IO
+ */
+class TextReader : public core::NonCopyable {
+private:
+	StreamData _data;
+	const char *_cur;
+	const char *_end;
+
+public:
+	TextReader(SeekableReadStream &stream);
+
+	bool valid() const {
+		return _data.valid();
+	}
+
+	/**
+	 * @return @c true if there are no more lines
+	 */
+	bool eos() const {
+		return _cur >= _end;
+	}
+
+	/**
+	 * @brief The next line without the line ending (@c \\n or @c \\r\\n)
+	 * @return @c false if there are no more lines
+	 */
+	bool readLine(const char *&begin, const char *&end);
+	/**
+	 * @brief Like @c readLine() but the line is copied into the given buffer and is null terminated
+	 * @return @c false if there are no more lines or the line doesn't fit into the buffer
+	 */
+	bool readLine(char *buf, size_t bufSize);
+};
+
+/**
+ * @brief Buffered text output without the format string parsing of @c WriteStream::writeStringFormat()
+ *
+ * The integers are converted with a table of the two digit pairs and the floats with a fixed amount of decimals
+ * (like @c %.Nf) are converted via integer arithmetic. The buffer is written to the wrapped stream once it's full,
+ * on @c flush() and on destruction.
+ *
+ * @ingroup IO
+ */
+class TextWriter : public core::NonCopyable {
+private:
+	WriteStream &_stream;
+	char *_buffer;
+	size_t _capacity;
+	size_t _size = 0u;
+	bool _failed = false;
+
+	inline char *reserve(size_t n) {
+		if (_size + n > _capacity) {
+			flushBuffer();
+		}
+		return _buffer + _size;
+	}
+	void flushBuffer();
+
+public:
+	TextWriter(WriteStream &stream, size_t bufferSize = 64 * 1024);
+	~TextWriter();
+
+	void writeString(const char *str, size_t len);
+	void writeString(const char *str);
+	inline void writeString(const core::String &str) {
+		writeString(str.c_str(), str.size());
+	}
+	inline void writeChar(char c) {
+		*reserve(1) = c;
+		++_size;
+	}
+	void writeInt(int64_t value);
+	/**
+	 * @brief Writes the value with the given amount of decimals - the same as @c %.Nf of printf
+	 */
+	void writeFloat(float value, int decimals = 6);
+	/**
+	 * @brief Two upper case hex digits
+	 */
+	void writeHex(uint8_t value);
+
+	/**
+	 * @return @c false if any of the writes to the wrapped stream failed
+	 */
+	bool flush();
+};
+
+} // namespace io
@@ -5,6 +5,9 @@
 #include "ZipArchive.h"
 #include "core/Log.h"
 #include "core/StandardLib.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
+#define MINIZ_NO_ZLIB_COMPATIBLE_NAMES 1
 #include "core/external/miniz.h"
 #include "io/Stream.h"
 
@@ -24,15 +27,29 @@ void ZipArchive::close() {
 	mz_zip_reader_end((mz_zip_archive*)_zip);
 	core_free(_zip);
 	_zip = nullptr;
+	_stream = nullptr;
+	_index.clear();
 }
 
-static size_t ziparchive_read(void *userdata, mz_uint64 offset, void *targetBuf, size_t targetBufSize) {
-	io::SeekableReadStream *stream = (io::SeekableReadStream *)userdata;
-	mz_int64 currentPos = stream->pos();
+size_t ZipArchive::readCallback(void *userdata, uint64_t offset, void *targetBuf, size_t targetBufSize) {
+	ZipArchive *archive = (ZipArchive *)userdata;
+	io::SeekableReadStream *stream = archive->_stream;
 	if ((mz_int64)offset < 0) {
 		Log::error("ziparchive_read: Invalid file offset");
 		return 0;
 	}
+	if (const uint8_t *mem = stream->data()) {
+		// the memory is never modified - no need to lock the concurrent extractions
+		const int64_t size = stream->size();
+		if ((int64_t)offset >= size) {
+			return 0;
+		}
+		const size_t n = core_min(targetBufSize, (size_t)(size - (int64_t)offset));
+		core_memcpy(targetBuf, mem + offset, n);
+		return n;
+	}
+	core::ScopedLock lock(archive->_lock);
+	mz_int64 currentPos = stream->pos();
 	if (currentPos != (mz_int64)offset && stream->seek((mz_int64)offset, SEEK_SET) == -1) {
 		Log::error("ziparchive_read: Failed to seek");
 		return 0;
@@ -68,8 +85,9 @@ bool ZipArchive::open(io::SeekableReadStream *stream) {
 	close();
 	_zip = core_malloc(sizeof(mz_zip_archive));
 	memset(_zip, 0, sizeof(mz_zip_archive));
-	((mz_zip_archive*)_zip)->m_pRead = ziparchive_read;
-	((mz_zip_archive*)_zip)->m_pIO_opaque = stream;
+	_stream = stream;
+	((mz_zip_archive*)_zip)->m_pRead = readCallback;
+	((mz_zip_archive*)_zip)->m_pIO_opaque = this;
 	_files.clear();
 	int64_t size = stream->size();
 	if (!mz_zip_reader_init((mz_zip_archive*)_zip, size, 0)) {
@@ -80,6 +98,7 @@ bool ZipArchive::open(io::SeekableReadStream *stream) {
 	}
 
 	mz_uint numFiles = mz_zip_reader_get_num_files((mz_zip_archive*)_zip);
+	_files.reserve(numFiles);
 
 	mz_zip_archive_file_stat zipStat;
 	for (mz_uint i = 0; i < numFiles; ++i) {
@@ -97,6 +116,7 @@ bool ZipArchive::open(io::SeekableReadStream *stream) {
 		entry.type = FilesystemEntry::Type::file;
 		entry.size = zipStat.m_uncomp_size;
 		entry.mtime = zipStat.m_time;
+		_index.put(entry.name, i);
 		_files.emplace_back(core::move(entry));
 	}
 	_files.sort([](const io::FilesystemEntry &a, const io::FilesystemEntry &b) { return a.name < b.name; });
@@ -104,12 +124,95 @@ bool ZipArchive::open(io::SeekableReadStream *stream) {
 	return true;
 }
 
-bool ZipArchive::load(const core::String &file, io::SeekableWriteStream &out) {
-	if ((mz_zip_archive*)_zip == nullptr) {
+bool ZipArchive::fileIndex(const core::String &file, uint32_t &idx) const {
+	if (_zip == nullptr) {
 		Log::error("No zip archive loaded");
 		return false;
 	}
-	return mz_zip_reader_extract_file_to_callback((mz_zip_archive*)_zip, file.c_str(), ziparchive_write, (void *)&out, 0);
+	if (_index.get(file, idx)) {
+		return true;
+	}
+	// the lookup in the central directory is case insensitive
+	mz_uint32 fileIdx;
+	if (!mz_zip_reader_locate_file_v2((mz_zip_archive *)_zip, file.c_str(), nullptr, 0, &fileIdx)) {
+		return false;
+	}
+	idx = fileIdx;
+	return true;
+}
+
+bool ZipArchive::exists(const core::String &file) const {
+	uint32_t idx;
+	return fileIndex(file, idx);
+}
+
+bool ZipArchive::load(const core::String &file, io::SeekableWriteStream &out) {
+	uint32_t idx;
+	if (!fileIndex(file, idx)) {
+		return false;
+	}
+	return mz_zip_reader_extract_to_callback((mz_zip_archive *)_zip, idx, ziparchive_write, (void *)&out, 0);
+}
+
+bool ZipArchive::load(const core::DynamicArray<core::String> &files,
+					  const core::DynamicArray<io::SeekableWriteStream *> &outs, core::ThreadPool *threadPool) {
+	core_assert(files.size() == outs.size());
+	if (threadPool == nullptr || files.size() <= 1u) {
+		bool success = true;
+		for (size_t i = 0; i < files.size(); ++i) {
+			success &= load(files[i], *outs[i]);
+		}
+		return success;
+	}
+	core::AtomicBool success{true};
+	threadPool->parallelFor(0, (int)files.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			if (!load(files[i], *outs[i])) {
+				success = false;
+			}
+		}
+	});
+	return success;
+}
+
+ZipArchiveEntryStream::ZipArchiveEntryStream(ZipArchive &archive, const core::String &file) {
+	uint32_t idx;
+	if (!archive.fileIndex(file, idx)) {
+		Log::error("Failed to find %s in the zip archive", file.c_str());
+		_eos = true;
+		return;
+	}
+	_iter = mz_zip_reader_extract_iter_new((mz_zip_archive *)archive._zip, idx, 0);
+	if (_iter == nullptr) {
+		Log::error("Failed to start the decompression of %s", file.c_str());
+		_eos = true;
+	}
+}
+
+ZipArchiveEntryStream::~ZipArchiveEntryStream() {
+	if (_iter != nullptr) {
+		mz_zip_reader_extract_iter_free((mz_zip_reader_extract_iter_state *)_iter);
+	}
+}
+
+int ZipArchiveEntryStream::read(void *dataPtr, size_t dataSize) {
+	if (_iter == nullptr) {
+		return -1;
+	}
+	if (_eos || dataSize == 0u) {
+		return 0;
+	}
+	mz_zip_reader_extract_iter_state *state = (mz_zip_reader_extract_iter_state *)_iter;
+	const size_t n = mz_zip_reader_extract_iter_read(state, dataPtr, dataSize);
+	if (state->status < 0) {
+		Log::error("Failed to decompress the zip archive entry");
+		_eos = true;
+		return -1;
+	}
+	if (n < dataSize) {
+		_eos = true;
+	}
+	return (int)n;
 }
 
 } // namespace io
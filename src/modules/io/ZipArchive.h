@@ -1,24 +1,62 @@
+/**
+ * @file
+ */
+
 #pragma once
 
+#include "core/Trace.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/Lock.h"
 #include "io/Filesystem.h"
 #include "io/Stream.h"
 
+namespace core {
+class ThreadPool;
+}
+
 namespace io {
 
 using ZipArchiveFiles = core::DynamicArray<FilesystemEntry>;
 
+/**
+ * @brief Read access to the entries of a zip archive
+ *
+ * The entries can get extracted from different threads at the same time - every extraction has its own inflate
+ * state and only the reads of the compressed data from the wrapped stream are serialized. If the wrapped stream is
+ * backed by memory (see @c SeekableReadStream::data()) the reads don't need a lock at all.
+ *
+ * @ingroup IO
+ */
 class ZipArchive {
+	friend class ZipArchiveEntryStream;
 private:
 	void *_zip = nullptr;
+	io::SeekableReadStream *_stream = nullptr;
 	ZipArchiveFiles _files;
+	/**
+	 * @brief Maps the entry names to their index in the central directory of the archive
+	 */
+	core::StringMap<uint32_t> _index;
+	core_trace_mutex(core::Lock, _lock, "ZipArchive");
+
+	static size_t readCallback(void *userdata, uint64_t offset, void *targetBuf, size_t targetBufSize);
+	bool fileIndex(const core::String &file, uint32_t &idx) const;
 
 public:
 	ZipArchive();
 	~ZipArchive();
 
 	bool open(io::SeekableReadStream *stream);
+	bool exists(const core::String &file) const;
 	bool load(const core::String &file, io::SeekableWriteStream &out);
+	/**
+	 * @brief Extracts the given entries into the output stream with the same index
+	 * @param threadPool If not @c null the entries are extracted in parallel
+	 * @return @c false if any of the entries could not get extracted
+	 */
+	bool load(const core::DynamicArray<core::String> &files, const core::DynamicArray<io::SeekableWriteStream *> &outs,
+			  core::ThreadPool *threadPool = nullptr);
 	void close();
 
 	const ZipArchiveFiles &files() const;
@@ -28,4 +66,36 @@ inline const ZipArchiveFiles &ZipArchive::files() const {
 	return _files;
 }
 
+/**
+ * @brief Decompresses a single entry of a zip archive while reading it - the entry is never extracted to memory in
+ * full
+ *
+ * @note The archive must stay open while this stream is alive
+ * @ingroup IO
+ */
+class ZipArchiveEntryStream : public io::ReadStream {
+private:
+	void *_iter = nullptr;
+	bool _eos = false;
+
+public:
+	ZipArchiveEntryStream(ZipArchive &archive, const core::String &file);
+	virtual ~ZipArchiveEntryStream();
+
+	/**
+	 * @return @c false if the entry does not exist or can't get decompressed
+	 */
+	bool valid() const;
+	int read(void *dataPtr, size_t dataSize) override;
+	bool eos() const override;
+};
+
+inline bool ZipArchiveEntryStream::valid() const {
+	return _iter != nullptr;
+}
+
+inline bool ZipArchiveEntryStream::eos() const {
+	return _eos;
+}
+
 } // namespace io
@@ -4,35 +4,44 @@
 
 #include "ZipReadStream.h"
 #include "core/Log.h"
+#include "core/Metrics.h"
 #include "core/StandardLib.h"
-#define MINIZ_NO_STDIO
-#include "core/external/miniz.h"
+#include "core/TimeProvider.h"
+#include "core/ZipBackend.h"
 #include "core/Assert.h"
 
 namespace io {
 
 ZipReadStream::ZipReadStream(io::SeekableReadStream &readStream, int size)
 	: _readStream(readStream), _size(size), _remaining(size) {
-	_stream = (mz_stream *)core_malloc(sizeof(*_stream));
+	_stream = (core::zip::Stream *)core_malloc(sizeof(*_stream));
 	core_memset(_stream, 0, sizeof(*_stream));
-	_stream->zalloc = Z_NULL;
-	_stream->zfree = Z_NULL;
+	_stream->zalloc = nullptr;
+	_stream->zfree = nullptr;
 	uint8_t gzipHeader[2];
 	readStream.readUInt8(gzipHeader[0]);
 	readStream.readUInt8(gzipHeader[1]);
 	if (gzipHeader[0] == 0x1F && gzipHeader[1] == 0x8B) {
 		readStream.skip(8); // gzip header is 10 bytes
-		mz_inflateInit2(_stream, -MZ_DEFAULT_WINDOW_BITS);
+		ZIP_FUNC(inflateInit2)(_stream, -ZIP_WINDOW_BITS);
 	} else {
 		readStream.seek(-2, SEEK_CUR);
-		if (mz_inflateInit(_stream) != MZ_OK) {
+		if (ZIP_FUNC(inflateInit)(_stream) != ZIP_CONST(OK)) {
 			Log::error("Failed to initialize zip stream");
 		}
 	}
 }
 
 ZipReadStream::~ZipReadStream() {
-	mz_inflateEnd(_stream);
+	if (_inflatedBytes > 0) {
+		static core::Histogram &inflateSeconds =
+			core::metrics::histogram("zip_inflate_seconds{api=\"stream\"}", "The time spent to inflate a buffer or stream");
+		static core::Counter &inflatedBytes =
+			core::metrics::counter("zip_inflated_bytes_total{api=\"stream\"}", "The amount of inflated bytes");
+		inflateSeconds.observe((double)_inflateTicks / (double)core::TimeProvider::highResTimeResolution());
+		inflatedBytes.inc(_inflatedBytes);
+	}
+	ZIP_FUNC(inflateEnd)(_stream);
 	core_free(_stream);
 }
 
@@ -81,22 +90,25 @@ int ZipReadStream::read(void *buf, size_t size) {
 		_stream->avail_out = (unsigned int)size;
 		_stream->next_out = targetPtr;
 
-		const int retval = mz_inflate(_stream, MZ_NO_FLUSH);
+		const uint64_t inflateStart = core::TimeProvider::highResTime();
+		const int retval = ZIP_FUNC(inflate)(_stream, ZIP_CONST(NO_FLUSH));
+		_inflateTicks += core::TimeProvider::highResTime() - inflateStart;
 		switch (retval) {
-		case MZ_OK:
-		case MZ_STREAM_END:
+		case ZIP_CONST(OK):
+		case ZIP_CONST(STREAM_END):
 			break;
 		default:
-			Log::debug("error while reading the stream: '%s'", mz_error(retval));
+			Log::debug("error while reading the stream: '%s'", ZIP_ERROR_STRING(retval));
 			return -1;
 		}
 
 		const size_t outputSize = size - (size_t)_stream->avail_out;
+		_inflatedBytes += (int64_t)outputSize;
 		targetPtr += outputSize;
 		core_assert(size >= outputSize);
 		size -= outputSize;
 
-		if (retval == MZ_STREAM_END) {
+		if (retval == ZIP_CONST(STREAM_END)) {
 			_eos = true;
 			if (size > 0) {
 				Log::debug("attempting to read past the end of the stream");
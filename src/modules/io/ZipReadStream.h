@@ -6,7 +6,11 @@
 
 #include "Stream.h"
 
-struct mz_stream_s;
+namespace core {
+namespace zip {
+struct Stream;
+}
+} // namespace core
 
 namespace io {
 
@@ -17,12 +21,15 @@ namespace io {
  */
 class ZipReadStream : public io::ReadStream {
 private:
-	struct mz_stream_s *_stream;
+	core::zip::Stream *_stream;
 	io::SeekableReadStream &_readStream;
 	uint8_t _buf[256 * 1024] {};
 	const int _size;
 	int _remaining;
 	bool _eos = false;
+	/** the time spent in inflate - observed once per stream to keep the clock reads out of the small reads */
+	uint64_t _inflateTicks = 0u;
+	int64_t _inflatedBytes = 0;
 
 public:
 	/**
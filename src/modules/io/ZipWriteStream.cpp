@@ -4,27 +4,191 @@
 
 #include "ZipWriteStream.h"
 #include "core/StandardLib.h"
-#include "core/external/miniz.h"
+#include "core/ZipBackend.h"
 #include "core/Assert.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 
 namespace io {
 
-ZipWriteStream::ZipWriteStream(io::WriteStream &outStream, int level) : _outStream(outStream) {
-	_stream = (mz_stream *)core_malloc(sizeof(*_stream));
+/**
+ * @brief The amount of input bytes that are compressed independently in parallel mode
+ */
+static constexpr size_t ZipBlockSize = 128 * 1024;
+
+struct ZipBlock {
+	core::DynamicArray<uint8_t> data;
+	uint32_t adler = 1u;
+};
+
+/**
+ * @brief Compresses the given input into a raw deflate block. A block that is not the last one is finished with a
+ * sync flush - this aligns it to a byte boundary and allows to just concatenate the blocks.
+ */
+static bool compressBlock(const uint8_t *input, size_t size, int level, bool last, ZipBlock &block) {
+	core::zip::Stream stream;
+	core_memset(&stream, 0, sizeof(stream));
+	if (ZIP_FUNC(deflateInit2)(&stream, level, ZIP_CONST(DEFLATED), -ZIP_WINDOW_BITS, 8,
+								ZIP_CONST(DEFAULT_STRATEGY)) != ZIP_CONST(OK)) {
+		return false;
+	}
+	// the sync flush marker needs a few more bytes
+	block.data.resize(ZIP_FUNC(deflateBound)(&stream, (zip_ulong)size) + 16);
+	stream.next_in = (unsigned char *)input;
+	stream.avail_in = (unsigned int)size;
+	stream.next_out = block.data.data();
+	stream.avail_out = (unsigned int)block.data.size();
+	const int retVal = ZIP_FUNC(deflate)(&stream, last ? ZIP_CONST(FINISH) : ZIP_CONST(SYNC_FLUSH));
+	const bool success = last ? retVal == ZIP_CONST(STREAM_END) : (retVal == ZIP_CONST(OK) && stream.avail_in == 0);
+	block.data.resize(block.data.size() - stream.avail_out);
+	ZIP_FUNC(deflateEnd)(&stream);
+	block.adler = (uint32_t)ZIP_FUNC(adler32)(1, (const unsigned char *)input, (unsigned int)size);
+	return success;
+}
+
+/**
+ * @brief Computes the adler32 checksum of two concatenated buffers from their checksums
+ * @param len2 The length of the second buffer
+ */
+static uint32_t adler32Combine(uint32_t adler1, uint32_t adler2, size_t len2) {
+	const uint32_t base = 65521u;
+	const uint32_t rem = (uint32_t)(len2 % base);
+	uint32_t sum1 = adler1 & 0xffffu;
+	uint32_t sum2 = (rem * sum1) % base;
+	sum1 += (adler2 & 0xffffu) + base - 1u;
+	sum2 += ((adler1 >> 16) & 0xffffu) + ((adler2 >> 16) & 0xffffu) + base - rem;
+	if (sum1 >= base) {
+		sum1 -= base;
+	}
+	if (sum1 >= base) {
+		sum1 -= base;
+	}
+	if (sum2 >= (base << 1)) {
+		sum2 -= (base << 1);
+	}
+	if (sum2 >= base) {
+		sum2 -= base;
+	}
+	return sum1 | (sum2 << 16);
+}
+
+ZipWriteStream::ZipWriteStream(io::WriteStream &outStream, int level, core::ThreadPool *threadPool)
+	: _outStream(outStream), _level(level) {
+	if (threadPool != nullptr && threadPool->size() > 1) {
+		_threadPool = threadPool;
+		// the array only grows linear - so reserve the memory for one batch of blocks
+		_input.reserve(ZipBlockSize * _threadPool->size());
+		return;
+	}
+	_stream = (core::zip::Stream *)core_malloc(sizeof(*_stream));
 	core_memset(_stream, 0, sizeof(*_stream));
-	_stream->zalloc = Z_NULL;
-	_stream->zfree = Z_NULL;
-	mz_deflateInit(_stream, level);
+	_stream->zalloc = nullptr;
+	_stream->zfree = nullptr;
+	ZIP_FUNC(deflateInit)(_stream, level);
 }
 
 ZipWriteStream::~ZipWriteStream() {
 	ZipWriteStream::flush();
-	const int retVal = mz_deflateEnd(_stream);
+	if (_stream == nullptr) {
+		return;
+	}
+	const int retVal = ZIP_FUNC(deflateEnd)(_stream);
 	core_free(_stream);
-	core_assert(retVal == MZ_OK);
+	core_assert(retVal == ZIP_CONST(OK));
+}
+
+int ZipWriteStream::writeOutput(const void *buf, size_t size) {
+	if (size == 0u) {
+		return 0;
+	}
+	if (_outStream.write(buf, size) != (int)size) {
+		return -1;
+	}
+	_pos += (int64_t)size;
+	return (int)size;
+}
+
+int ZipWriteStream::compressBlocks(bool last) {
+	const size_t inputSize = _input.size();
+	size_t blocks = inputSize / ZipBlockSize;
+	if (last && (blocks == 0u || inputSize % ZipBlockSize != 0u)) {
+		// the remaining bytes - or an empty final block to terminate the deflate stream
+		++blocks;
+	}
+	if (blocks == 0u) {
+		return 0;
+	}
+
+	core::DynamicArray<ZipBlock> compressed;
+	compressed.resize(blocks);
+	core::AtomicInt failed(0);
+	_threadPool->parallelFor(0, (int)blocks, 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const size_t offset = (size_t)i * ZipBlockSize;
+			const size_t size = core_min(ZipBlockSize, inputSize - offset);
+			const bool lastBlock = last && i == (int)blocks - 1;
+			if (!compressBlock(_input.data() + offset, size, _level, lastBlock, compressed[i])) {
+				++failed;
+			}
+		}
+	});
+	if (failed > 0) {
+		return -1;
+	}
+
+	int writtenBytes = 0;
+	if (!_headerWritten) {
+		// zlib header with a 32k window and the compression level hint
+		uint8_t levelFlags = 0x9c;
+		if (_level >= 0 && _level <= 1) {
+			levelFlags = 0x01;
+		} else if (_level >= 2 && _level <= 5) {
+			levelFlags = 0x5e;
+		} else if (_level >= 7) {
+			levelFlags = 0xda;
+		}
+		const uint8_t header[] = {0x78, levelFlags};
+		if (writeOutput(header, sizeof(header)) == -1) {
+			return -1;
+		}
+		writtenBytes += (int)sizeof(header);
+		_headerWritten = true;
+	}
+	for (size_t i = 0; i < blocks; ++i) {
+		const ZipBlock &block = compressed[i];
+		if (writeOutput(block.data.data(), block.data.size()) == -1) {
+			return -1;
+		}
+		writtenBytes += (int)block.data.size();
+		const size_t offset = i * ZipBlockSize;
+		_adler = adler32Combine(_adler, block.adler, core_min(ZipBlockSize, inputSize - offset));
+	}
+	if (last) {
+		const uint8_t trailer[] = {(uint8_t)(_adler >> 24), (uint8_t)(_adler >> 16), (uint8_t)(_adler >> 8),
+								   (uint8_t)_adler};
+		if (writeOutput(trailer, sizeof(trailer)) == -1) {
+			return -1;
+		}
+		writtenBytes += (int)sizeof(trailer);
+		_input.clear();
+	} else {
+		_input.erase(0, blocks * ZipBlockSize);
+	}
+	return writtenBytes;
 }
 
 int ZipWriteStream::write(const void *buf, size_t size) {
+	if (_threadPool != nullptr) {
+		if (_finished) {
+			return -1;
+		}
+		_input.append((const uint8_t *)buf, size);
+		if (_input.size() < ZipBlockSize * _threadPool->size()) {
+			return 0;
+		}
+		return compressBlocks(false);
+	}
+
 	_stream->next_in = (unsigned char *)buf;
 	_stream->avail_in = static_cast<unsigned int>(size);
 
@@ -33,8 +197,8 @@ int ZipWriteStream::write(const void *buf, size_t size) {
 		_stream->avail_out = sizeof(_out);
 		_stream->next_out = _out;
 
-		const int retVal = mz_deflate(_stream, MZ_NO_FLUSH);
-		if (retVal != MZ_OK) {
+		const int retVal = ZIP_FUNC(deflate)(_stream, ZIP_CONST(NO_FLUSH));
+		if (retVal != ZIP_CONST(OK)) {
 			return -1;
 		}
 
@@ -51,12 +215,20 @@ int ZipWriteStream::write(const void *buf, size_t size) {
 }
 
 bool ZipWriteStream::flush() {
+	if (_threadPool != nullptr) {
+		if (_finished) {
+			return true;
+		}
+		_finished = true;
+		return compressBlocks(true) != -1;
+	}
+
 	_stream->avail_in = 0;
 	_stream->avail_out = sizeof(_out);
 	_stream->next_out = _out;
 
-	const int retVal = mz_deflate(_stream, MZ_FINISH);
-	if (retVal == MZ_STREAM_ERROR) {
+	const int retVal = ZIP_FUNC(deflate)(_stream, ZIP_CONST(FINISH));
+	if (retVal == ZIP_CONST(STREAM_ERROR)) {
 		return false;
 	}
 
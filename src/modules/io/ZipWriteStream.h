@@ -5,12 +5,21 @@
 #pragma once
 
 #include "Stream.h"
+#include "core/collection/DynamicArray.h"
 
-struct mz_stream_s;
+namespace core {
+namespace zip {
+struct Stream;
+}
+class ThreadPool;
+} // namespace core
 
 namespace io {
 
 /**
+ * If a thread pool is given, the input is split into blocks that are compressed independently on the pool (like pigz
+ * does it). The blocks are concatenated into one valid zlib stream - so the result can be read by every zlib reader.
+ *
  * @see BufferedZipReadStream
  * @see ZipReadStream
  * @see WriteStream
@@ -18,17 +27,35 @@ namespace io {
  */
 class ZipWriteStream : public io::WriteStream {
 private:
-	struct mz_stream_s *_stream;
+	core::zip::Stream *_stream = nullptr;
 	io::WriteStream &_outStream;
 	uint8_t _out[256 * 1024] {};
 	int64_t _pos = 0;
 
+	// parallel mode
+	core::ThreadPool *_threadPool = nullptr;
+	const int _level;
+	core::DynamicArray<uint8_t> _input;
+	uint32_t _adler = 1u;
+	bool _headerWritten = false;
+	bool _finished = false;
+
+	int writeOutput(const void *buf, size_t size);
+	/**
+	 * @param last compress all of the pending input and finish the zlib stream. Otherwise only complete blocks are
+	 * compressed and the rest stays pending.
+	 * @return @c -1 on error - otherwise the amount of compressed bytes that were written to the output stream
+	 */
+	int compressBlocks(bool last);
+
 public:
 	/**
 	 * @param outStream The buffer that receives the writes for the compressed data.
 	 * @param level The compression level (0 is no compression, 1 is the best speed, 9 is the best compression).
+	 * @param threadPool If not @c null and the pool has more than one thread, the data is compressed in parallel
+	 * blocks. The writes are buffered until enough blocks are available for the pool.
 	 */
-	ZipWriteStream(io::WriteStream &outStream, int level = 6);
+	ZipWriteStream(io::WriteStream &outStream, int level = 6, core::ThreadPool *threadPool = nullptr);
 	virtual ~ZipWriteStream();
 
 	/**
@@ -6,6 +6,7 @@
 
 #if !defined(__LINUX__) && !defined(__MACOSX__) && !defined(__WINDOWS__) && !defined(__EMSCRIPTEN__)
 #include "io/Filesystem.h"
+#include <SDL_rwops.h>
 
 namespace io {
 
@@ -25,6 +26,10 @@ bool fs_unlink(const char *path) {
 	return false;
 }
 
+bool fs_rename(const char *oldPath, const char *newPath) {
+	return false;
+}
+
 bool fs_exists(const char *path) {
 	return false;
 }
@@ -50,6 +55,10 @@ core::String fs_readlink(const char *path) {
 	return path;
 }
 
+bool fs_sync(SDL_RWops *rwops) {
+	return false;
+}
+
 core::String fs_cwd() {
 	return "/";
 }
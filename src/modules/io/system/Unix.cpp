@@ -16,6 +16,8 @@
 #include <dirent.h>
 #include <errno.h>
 #include <pwd.h>
+#include <SDL_rwops.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <unistd.h>
@@ -214,6 +216,14 @@ bool fs_unlink(const char *path) {
 	return ret == 0;
 }
 
+bool fs_rename(const char *oldPath, const char *newPath) {
+	const int ret = rename(oldPath, newPath);
+	if (ret != 0) {
+		Log::error("Failed to rename %s to %s: %s", oldPath, newPath, strerror(errno));
+	}
+	return ret == 0;
+}
+
 bool fs_exists(const char *path) {
 	const int ret = access(path, F_OK);
 	if (ret != 0) {
@@ -280,6 +290,22 @@ core::String fs_readlink(const char *path) {
 	return buf;
 }
 
+bool fs_sync(SDL_RWops *rwops) {
+#ifdef HAVE_STDIO_H
+	if (rwops->type != SDL_RWOPS_STDFILE) {
+		return false;
+	}
+	FILE *fp = rwops->hidden.stdio.fp;
+	if (fflush(fp) != 0 || fsync(fileno(fp)) != 0) {
+		Log::error("Failed to sync the file: %s", strerror(errno));
+		return false;
+	}
+	return true;
+#else
+	return false;
+#endif
+}
+
 static int fs_scandir_filter(const struct dirent *dent) {
 	return strcmp(dent->d_name, ".") != 0 && strcmp(dent->d_name, "..") != 0;
 }
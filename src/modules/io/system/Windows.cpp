@@ -12,6 +12,7 @@
 #include "core/StringUtil.h"
 #include "core/Log.h"
 #include "io/Filesystem.h"
+#include <SDL_rwops.h>
 #include <SDL_stdinc.h>
 
 #include "windirent.h"
@@ -96,6 +97,21 @@ bool fs_unlink(const char *path) {
 	return ret == 0;
 }
 
+bool fs_rename(const char *oldPath, const char *newPath) {
+	WCHAR *wold = io_UTF8ToStringW(oldPath);
+	WCHAR *wnew = io_UTF8ToStringW(newPath);
+	priv::denormalizePath(wold);
+	priv::denormalizePath(wnew);
+	// in opposite to _wrename this replaces an existing target file
+	const BOOL ret = MoveFileExW(wold, wnew, MOVEFILE_REPLACE_EXISTING);
+	SDL_free(wold);
+	SDL_free(wnew);
+	if (!ret) {
+		Log::error("Failed to rename %s to %s: %i", oldPath, newPath, (int)GetLastError());
+	}
+	return ret;
+}
+
 bool fs_rmdir(const char *path) {
 	WCHAR *wpath = io_UTF8ToStringW(path);
 	priv::denormalizePath(wpath);
@@ -179,6 +195,17 @@ core::String fs_readlink(const char *path) {
 	return "";
 }
 
+bool fs_sync(SDL_RWops *rwops) {
+	if (rwops->type != SDL_RWOPS_WINFILE) {
+		return false;
+	}
+	if (!FlushFileBuffers((HANDLE)rwops->hidden.windowsio.h)) {
+		Log::error("Failed to sync the file: %u", (unsigned int)GetLastError());
+		return false;
+	}
+	return true;
+}
+
 static int fs_scandir_filter(const struct dirent *dent) {
 	return strcmp(dent->d_name, ".") != 0 && strcmp(dent->d_name, "..") != 0;
 }
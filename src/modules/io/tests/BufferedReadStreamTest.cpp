@@ -0,0 +1,104 @@
+/**
+ * @file
+ */
+
+#include "io/BufferedReadStream.h"
+#include "io/BufferedReadWriteStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+/**
+ * @brief Hides the memory of the wrapped stream to test the buffered code path
+ */
+class NoDataReadStream : public SeekableReadStream {
+private:
+	SeekableReadStream &_stream;
+
+public:
+	NoDataReadStream(SeekableReadStream &stream) : _stream(stream) {
+	}
+	int read(void *dataPtr, size_t dataSize) override {
+		return _stream.read(dataPtr, dataSize);
+	}
+	int64_t seek(int64_t position, int whence) override {
+		return _stream.seek(position, whence);
+	}
+	int64_t size() const override {
+		return _stream.size();
+	}
+	int64_t pos() const override {
+		return _stream.pos();
+	}
+};
+
+class BufferedReadStreamTest : public testing::TestWithParam<bool> {
+protected:
+	BufferedReadWriteStream _source;
+
+	void SetUp() override {
+		for (uint32_t i = 0u; i < 1000u; ++i) {
+			ASSERT_TRUE(_source.writeUInt32(i));
+			ASSERT_TRUE(_source.writeUInt16((uint16_t)i));
+			ASSERT_TRUE(_source.writeUInt8((uint8_t)i));
+			ASSERT_TRUE(_source.writeFloat((float)i));
+		}
+		_source.seek(0);
+	}
+};
+
+TEST_P(BufferedReadStreamTest, testRead) {
+	NoDataReadStream noData(_source);
+	SeekableReadStream &wrapped = GetParam() ? (SeekableReadStream &)_source : (SeekableReadStream &)noData;
+	{
+		// the odd buffer size makes the values cross the window borders
+		BufferedReadStream stream(wrapped, 67);
+		for (uint32_t i = 0u; i < 1000u; ++i) {
+			uint32_t val32;
+			ASSERT_EQ(0, stream.readUInt32(val32));
+			ASSERT_EQ(i, val32);
+			uint16_t val16;
+			ASSERT_EQ(0, stream.readUInt16(val16));
+			ASSERT_EQ((uint16_t)i, val16);
+			uint8_t val8;
+			ASSERT_EQ(0, stream.readUInt8(val8));
+			ASSERT_EQ((uint8_t)i, val8);
+			float valf;
+			ASSERT_EQ(0, stream.readFloat(valf));
+			ASSERT_FLOAT_EQ((float)i, valf);
+		}
+		EXPECT_TRUE(stream.eos());
+		uint8_t val8;
+		EXPECT_EQ(-1, stream.readUInt8(val8));
+		EXPECT_EQ(0, stream.seek(0));
+		EXPECT_EQ(11, stream.skip(11));
+		uint32_t val32;
+		ASSERT_EQ(0, stream.peekUInt32(val32));
+		EXPECT_EQ(1u, val32);
+		EXPECT_EQ(11, stream.pos());
+	}
+	EXPECT_EQ(11, _source.pos()) << "The wrapped stream should be positioned at the position of the buffered stream";
+}
+
+TEST_P(BufferedReadStreamTest, testReadArray) {
+	BufferedReadWriteStream arrays;
+	uint32_t values[300];
+	for (uint32_t i = 0u; i < 300u; ++i) {
+		values[i] = i * 7u;
+	}
+	ASSERT_TRUE(arrays.writeUInt32Array(values, 300));
+	ASSERT_EQ((int64_t)sizeof(values), arrays.size());
+	arrays.seek(0);
+	NoDataReadStream noDataArrays(arrays);
+	BufferedReadStream stream(GetParam() ? (SeekableReadStream &)arrays : (SeekableReadStream &)noDataArrays, 64);
+	uint32_t read[300];
+	ASSERT_EQ(0, stream.readUInt32Array(read, 300));
+	for (uint32_t i = 0u; i < 300u; ++i) {
+		ASSERT_EQ(values[i], read[i]);
+	}
+	EXPECT_EQ(-1, stream.readUInt32Array(read, 1));
+}
+
+INSTANTIATE_TEST_SUITE_P(Memory, BufferedReadStreamTest, testing::Bool());
+
+} // namespace io
@@ -4,6 +4,7 @@
 
 #include "io/FileStream.h"
 #include "core/FourCC.h"
+#include "core/StandardLib.h"
 #include "io/Filesystem.h"
 #include <gtest/gtest.h>
 
@@ -97,4 +98,44 @@ TEST_F(FileStreamTest, testFileStreamWrite) {
 	EXPECT_EQ(8l, file->length());
 }
 
+TEST_F(FileStreamTest, testFileStreamMapped) {
+	const int size = (int)FileStream::MapMinSize + 17;
+	uint8_t *content = (uint8_t *)core_malloc(size);
+	for (int i = 0; i < size; ++i) {
+		content[i] = (uint8_t)(i % 251);
+	}
+	{
+		const FilePtr &file = _fs.open("filestream-mappedtest", io::FileMode::SysWrite);
+		ASSERT_TRUE(file->validHandle());
+		EXPECT_EQ((long)size, file->write(content, size));
+	}
+	{
+		const FilePtr &file = _fs.open("filestream-mappedtest", io::FileMode::SysRead);
+		FileStream stream(file);
+		EXPECT_EQ(size, stream.size());
+		ASSERT_NE(nullptr, stream.data()) << "Failed to map the file";
+		EXPECT_EQ(0, core_memcmp(content, stream.data(), size));
+
+		uint8_t chr;
+		EXPECT_EQ(0, stream.seek(1000));
+		EXPECT_EQ(0, stream.readUInt8(chr));
+		EXPECT_EQ(content[1000], chr);
+		EXPECT_EQ(0, stream.seek(-1, SEEK_END));
+		EXPECT_EQ(0, stream.readUInt8(chr));
+		EXPECT_EQ(content[size - 1], chr);
+		EXPECT_TRUE(stream.eos());
+		EXPECT_EQ(-1, stream.readUInt8(chr));
+
+		EXPECT_EQ(0, stream.seek(10));
+		StreamData streamData(stream);
+		ASSERT_TRUE(streamData.valid());
+		EXPECT_EQ(stream.data() + 10, streamData.data()) << "The mapped data should not get copied";
+		EXPECT_EQ(size - 10, streamData.size());
+		EXPECT_TRUE(stream.eos());
+	}
+	// the file must not be mapped anymore
+	EXPECT_TRUE(_fs.removeFile("filestream-mappedtest"));
+	core_free(content);
+}
+
 } // namespace io
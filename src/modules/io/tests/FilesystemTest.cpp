@@ -3,11 +3,14 @@
  */
 
 #include "io/Filesystem.h"
+#include "io/File.h"
 #include "core/Algorithm.h"
 #include "core/Enum.h"
 #include "core/StringUtil.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/FormatDescription.h"
 #include <gtest/gtest.h>
+#include <thread>
 
 
 namespace core {
@@ -55,6 +58,44 @@ TEST_F(FilesystemTest, testListDirectory) {
 	fs.shutdown();
 }
 
+static void waitForListing(const io::DirectoryListingPtr &listing) {
+	for (int i = 0; i < 1000 && !listing->complete(); ++i) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	ASSERT_TRUE(listing->complete());
+}
+
+TEST_F(FilesystemTest, testListAsync) {
+	io::Filesystem fs;
+	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
+	EXPECT_TRUE(fs.createDir("listasynctest/dir1"));
+	EXPECT_TRUE(fs.syswrite("listasynctest/file1", "1"));
+	EXPECT_TRUE(fs.syswrite("listasynctest/file2", "2"));
+	core::ThreadPool threadPool(1, "FilesystemTest");
+	threadPool.init();
+
+	io::DirectoryListingPtr listing = fs.listAsync("listasynctest/", threadPool);
+	waitForListing(listing);
+	core::DynamicArray<io::FilesystemEntry> entities;
+	EXPECT_EQ(3u, listing->fetch(entities));
+	EXPECT_EQ(3u, entities.size()) << entities;
+	EXPECT_EQ(3u, listing->fetch(entities, 3u));
+	EXPECT_EQ(3u, entities.size()) << "No new entries are expected";
+
+	EXPECT_EQ(listing.get(), fs.listAsync("listasynctest/", threadPool).get()) << "Expected the cached listing";
+
+	// modifying the directory drops the cached listing
+	EXPECT_TRUE(fs.syswrite("listasynctest/file3", "3"));
+	io::DirectoryListingPtr modified = fs.listAsync("listasynctest/", threadPool);
+	EXPECT_NE(listing.get(), modified.get());
+	waitForListing(modified);
+	entities.clear();
+	EXPECT_EQ(4u, modified->fetch(entities));
+	EXPECT_TRUE(fs.removeFile("listasynctest/file3"));
+	threadPool.shutdown(true);
+	fs.shutdown();
+}
+
 TEST_F(FilesystemTest, testDirectoryExists) {
 	io::Filesystem fs;
 	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
@@ -72,6 +113,20 @@ TEST_F(FilesystemTest, testFileExists) {
 	EXPECT_FALSE(fs.exists("iotestdoesnotexist.txt"));
 }
 
+TEST_F(FilesystemTest, testStat) {
+	io::Filesystem fs;
+	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
+	const io::FilePtr &file = fs.open("iotest.txt");
+	ASSERT_TRUE(file->validHandle());
+	io::FilesystemEntry entry;
+	ASSERT_TRUE(io::Filesystem::stat(file->name(), entry));
+	EXPECT_TRUE(entry.isFile());
+	EXPECT_EQ((uint64_t)file->length(), entry.size);
+	EXPECT_GT(entry.mtime, 0u);
+	EXPECT_FALSE(io::Filesystem::stat("iotestdoesnotexist.txt", entry));
+	fs.shutdown();
+}
+
 TEST_F(FilesystemTest, testListDirectoryFilter) {
 	io::Filesystem fs;
 	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
@@ -206,6 +261,20 @@ TEST_F(FilesystemTest, testWriteNewDir) {
 	fs.shutdown();
 }
 
+TEST_F(FilesystemTest, testRename) {
+	io::Filesystem fs;
+	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
+	EXPECT_TRUE(fs.write("renamesource", "123"));
+	EXPECT_TRUE(fs.write("renametarget", "456"));
+	const core::String source = fs.open("renamesource")->name();
+	const core::String target = fs.open("renametarget")->name();
+	EXPECT_TRUE(fs.rename(source, target)) << "Failed to replace " << target.c_str();
+	EXPECT_EQ("123", fs.load("renametarget"));
+	EXPECT_FALSE(fs.exists(source));
+	EXPECT_TRUE(fs.removeFile(target));
+	fs.shutdown();
+}
+
 TEST_F(FilesystemTest, testCreateDirRecursive) {
 	io::Filesystem fs;
 	EXPECT_TRUE(fs.init("test", "test")) << "Failed to initialize the filesystem";
@@ -0,0 +1,80 @@
+/**
+ * @file
+ */
+
+#include "io/LZFSEReadStream.h"
+#include "core/collection/DynamicArray.h"
+#include "io/MemoryReadStream.h"
+#include "lzfse.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class LZFSEReadStreamTest : public testing::Test {
+protected:
+	static constexpr int Size = 1000000;
+	core::DynamicArray<uint8_t> _compressed;
+
+	static uint8_t value(int i) {
+		// some repetition to get compressed blocks - but not too much to get several of them
+		return (uint8_t)((i / 7) * 13 + (i % 251));
+	}
+
+	void SetUp() override {
+		core::DynamicArray<uint8_t> raw(Size);
+		for (int i = 0; i < Size; ++i) {
+			raw[i] = value(i);
+		}
+		_compressed.resize(Size + 4096);
+		const size_t compressedSize =
+			lzfse_encode_buffer(_compressed.data(), _compressed.size(), raw.data(), raw.size(), nullptr);
+		ASSERT_GT(compressedSize, 0u);
+		_compressed.resize(compressedSize);
+	}
+};
+
+TEST_F(LZFSEReadStreamTest, testRead) {
+	MemoryReadStream source(_compressed.data(), (uint32_t)_compressed.size());
+	LZFSEReadStream stream(source);
+	EXPECT_EQ(Size, stream.size()) << "The size should be known without decoding the data";
+	uint8_t buf[1000];
+	int offset = 0;
+	while (!stream.eos()) {
+		const int n = stream.read(buf, 777);
+		ASSERT_GT(n, 0);
+		for (int i = 0; i < n; ++i) {
+			ASSERT_EQ(value(offset + i), buf[i]) << "at offset " << offset + i;
+		}
+		offset += n;
+	}
+	EXPECT_EQ(Size, offset);
+	EXPECT_EQ(0, stream.read(buf, 1));
+}
+
+TEST_F(LZFSEReadStreamTest, testSeek) {
+	MemoryReadStream source(_compressed.data(), (uint32_t)_compressed.size());
+	LZFSEReadStream stream(source);
+	for (int64_t p : {500000, 10, 65535, 65536, 999999, 12345, 0}) {
+		EXPECT_EQ(p, stream.seek(p));
+		uint8_t val;
+		ASSERT_EQ(0, stream.readUInt8(val)) << "at position " << p;
+		EXPECT_EQ(value((int)p), val) << "at position " << p;
+	}
+	EXPECT_EQ(Size - 32, stream.seek(-32, SEEK_END));
+}
+
+TEST_F(LZFSEReadStreamTest, testInvalidBlockHeaders) {
+	// a v2 block with all sizes set to zero would never advance the block scan
+	uint8_t zeroSizes[128] = {'b', 'v', 'x', '2'};
+	MemoryReadStream zeroSource(zeroSizes, sizeof(zeroSizes));
+	LZFSEReadStream zeroStream(zeroSource);
+	EXPECT_EQ(0, zeroStream.size());
+
+	// an uncompressed block that claims more bytes than the stream contains
+	uint8_t tooLarge[64] = {'b', 'v', 'x', '-', 0xff, 0xff, 0xff, 0xff};
+	MemoryReadStream tooLargeSource(tooLarge, sizeof(tooLarge));
+	LZFSEReadStream tooLargeStream(tooLargeSource);
+	EXPECT_EQ(0, tooLargeStream.size());
+}
+
+} // namespace io
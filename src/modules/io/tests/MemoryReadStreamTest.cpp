@@ -4,6 +4,7 @@
 
 #include "io/MemoryReadStream.h"
 #include "core/ArrayLength.h"
+#include "core/Hash.h"
 #include <gtest/gtest.h>
 
 namespace io {
@@ -38,4 +39,16 @@ TEST_F(MemoryReadStreamTest, testSeekStream) {
 	EXPECT_EQ(1u, byte);
 }
 
+TEST_F(MemoryReadStreamTest, testHash64) {
+	uint8_t buf[40000];
+	for (int i = 0; i < lengthof(buf); ++i) {
+		buf[i] = (uint8_t)(i * 13);
+	}
+	MemoryReadStream stream(buf, sizeof(buf));
+	uint64_t hash = 0u;
+	ASSERT_TRUE(hash64(stream, hash));
+	EXPECT_EQ(core::hash64(buf, sizeof(buf)), hash);
+	EXPECT_TRUE(stream.eos());
+}
+
 } // namespace io
@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+
+#include "io/PrefetchReadStream.h"
+#include "io/BufferedReadWriteStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class PrefetchReadStreamTest : public testing::Test {
+protected:
+	static constexpr int Size = 100000;
+	BufferedReadWriteStream _source;
+
+	void SetUp() override {
+		for (int i = 0; i < Size; ++i) {
+			ASSERT_TRUE(_source.writeUInt8((uint8_t)(i * 13)));
+		}
+		_source.seek(0);
+	}
+};
+
+TEST_F(PrefetchReadStreamTest, testRead) {
+	PrefetchReadStream stream(_source, 4096, 4);
+	EXPECT_EQ(Size, stream.size());
+	uint8_t buf[1000];
+	int offset = 0;
+	while (!stream.eos()) {
+		// the odd read size makes the reads cross the block borders
+		const int n = stream.read(buf, 777);
+		ASSERT_GT(n, 0);
+		for (int i = 0; i < n; ++i) {
+			ASSERT_EQ((uint8_t)((offset + i) * 13), buf[i]) << "at offset " << offset + i;
+		}
+		offset += n;
+	}
+	EXPECT_EQ(Size, offset);
+	EXPECT_EQ(0, stream.read(buf, 1));
+}
+
+TEST_F(PrefetchReadStreamTest, testSeek) {
+	{
+		PrefetchReadStream stream(_source, 4096, 4);
+		for (int64_t p : {50000, 10, 4095, 4096, 99999, 12345, 12346, 12000}) {
+			EXPECT_EQ(p, stream.seek(p));
+			uint8_t val;
+			ASSERT_EQ(0, stream.readUInt8(val)) << "at position " << p;
+			EXPECT_EQ((uint8_t)(p * 13), val) << "at position " << p;
+			EXPECT_EQ(p + 1, stream.pos());
+		}
+		EXPECT_EQ(Size - 1, stream.seek(-1, SEEK_END));
+		EXPECT_EQ(20, stream.skip(-(Size - 1 - 20)));
+	}
+	EXPECT_EQ(20, _source.pos()) << "The wrapped stream should be positioned at the position of the prefetch stream";
+}
+
+} // namespace io
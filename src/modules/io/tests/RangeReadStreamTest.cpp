@@ -0,0 +1,87 @@
+/**
+ * @file
+ */
+
+#include "io/RangeReadStream.h"
+#include "core/StandardLib.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class MemoryRangeSource : public RangeSource {
+public:
+	static constexpr int Size = 100000;
+	uint8_t data[Size];
+	int fetches = 0;
+	int64_t fetchedBytes = 0;
+
+	MemoryRangeSource() {
+		for (int i = 0; i < Size; ++i) {
+			data[i] = (uint8_t)(i * 13);
+		}
+	}
+
+	int64_t size() const override {
+		return Size;
+	}
+
+	int fetch(int64_t offset, uint8_t *buf, int len) override {
+		if (offset < 0 || offset + len > Size) {
+			return -1;
+		}
+		core_memcpy(buf, data + offset, len);
+		++fetches;
+		fetchedBytes += len;
+		return len;
+	}
+};
+
+TEST(RangeReadStreamTest, testRead) {
+	MemoryRangeSource source;
+	RangeReadStream stream(source, 4096, 8, 4);
+	EXPECT_EQ(MemoryRangeSource::Size, stream.size());
+	uint8_t buf[1000];
+	int offset = 0;
+	while (!stream.eos()) {
+		// the odd read size makes the reads cross the block borders
+		const int n = stream.read(buf, 777);
+		ASSERT_GT(n, 0);
+		for (int i = 0; i < n; ++i) {
+			ASSERT_EQ((uint8_t)((offset + i) * 13), buf[i]) << "at offset " << offset + i;
+		}
+		offset += n;
+	}
+	EXPECT_EQ(MemoryRangeSource::Size, offset);
+	EXPECT_EQ(0, stream.read(buf, 1));
+	EXPECT_EQ(MemoryRangeSource::Size, source.fetchedBytes) << "Every byte should only be fetched once";
+	EXPECT_LT(source.fetches, (MemoryRangeSource::Size + 4095) / 4096) << "The sequential reads should be read ahead";
+}
+
+TEST(RangeReadStreamTest, testSeek) {
+	MemoryRangeSource source;
+	RangeReadStream stream(source, 4096, 8, 4);
+	for (int64_t p : {50000, 10, 4095, 4096, 99999, 12345, 12346, 12000}) {
+		EXPECT_EQ(p, stream.seek(p));
+		uint8_t val;
+		ASSERT_EQ(0, stream.readUInt8(val)) << "at position " << p;
+		EXPECT_EQ((uint8_t)(p * 13), val) << "at position " << p;
+		EXPECT_EQ(p + 1, stream.pos());
+	}
+	EXPECT_EQ(MemoryRangeSource::Size - 1, stream.seek(-1, SEEK_END));
+	EXPECT_EQ(20, stream.skip(-(MemoryRangeSource::Size - 1 - 20)));
+}
+
+TEST(RangeReadStreamTest, testFetchOnlyTouchedBlocks) {
+	MemoryRangeSource source;
+	RangeReadStream stream(source, 4096, 8, 4);
+	uint8_t buf[16];
+	ASSERT_EQ(16, stream.read(buf, sizeof(buf)));
+	stream.seek(80000);
+	ASSERT_EQ(16, stream.read(buf, sizeof(buf)));
+	stream.seek(0);
+	ASSERT_EQ(16, stream.read(buf, sizeof(buf)));
+	EXPECT_EQ(2, source.fetches);
+	EXPECT_EQ(2 * 4096, source.fetchedBytes);
+}
+
+} // namespace io
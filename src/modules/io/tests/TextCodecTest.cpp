@@ -0,0 +1,87 @@
+/**
+ * @file
+ */
+
+#include "io/TextCodec.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
+#include <gtest/gtest.h>
+
+namespace io {
+
+class TextCodecTest : public testing::Test {
+protected:
+	core::String toString(const BufferedReadWriteStream &stream) const {
+		return core::String((const char *)stream.getBuffer(), (size_t)stream.size());
+	}
+};
+
+TEST_F(TextCodecTest, testReadLines) {
+	const char text[] = "first\r\n\nthird\nlast";
+	MemoryReadStream stream(text, sizeof(text) - 1);
+	TextReader reader(stream);
+	ASSERT_TRUE(reader.valid());
+	char buf[16];
+	ASSERT_TRUE(reader.readLine(buf, sizeof(buf)));
+	EXPECT_STREQ("first", buf);
+	ASSERT_TRUE(reader.readLine(buf, sizeof(buf)));
+	EXPECT_STREQ("", buf);
+	ASSERT_TRUE(reader.readLine(buf, sizeof(buf)));
+	EXPECT_STREQ("third", buf);
+	EXPECT_FALSE(reader.eos());
+	ASSERT_TRUE(reader.readLine(buf, sizeof(buf)));
+	EXPECT_STREQ("last", buf);
+	EXPECT_TRUE(reader.eos());
+	EXPECT_FALSE(reader.readLine(buf, sizeof(buf)));
+}
+
+TEST_F(TextCodecTest, testWriteNumbers) {
+	BufferedReadWriteStream stream;
+	{
+		TextWriter writer(stream);
+		writer.writeInt(0);
+		writer.writeChar(' ');
+		writer.writeInt(-1234567890123ll);
+		writer.writeChar(' ');
+		writer.writeInt(255);
+		writer.writeChar(' ');
+		writer.writeFloat(1.5f, 4);
+		writer.writeChar(' ');
+		writer.writeFloat(-0.25f);
+		writer.writeChar(' ');
+		writer.writeFloat(0.99999f, 2);
+		writer.writeChar(' ');
+		writer.writeFloat(3.0f, 0);
+		writer.writeChar(' ');
+		writer.writeHex(0xA5);
+		writer.writeHex(0x0F);
+		EXPECT_TRUE(writer.flush());
+	}
+	EXPECT_EQ("0 -1234567890123 255 1.5000 -0.250000 1.00 3 A50F", toString(stream));
+}
+
+TEST_F(TextCodecTest, testWriteBigFloat) {
+	BufferedReadWriteStream stream;
+	{
+		TextWriter writer(stream);
+		writer.writeFloat(1e20f, 1);
+	}
+	EXPECT_EQ("100000002004087734272.0", toString(stream));
+}
+
+TEST_F(TextCodecTest, testWriteLongString) {
+	BufferedReadWriteStream stream;
+	core::String str;
+	for (int i = 0; i < 1000; ++i) {
+		str += "0123456789";
+	}
+	{
+		TextWriter writer(stream, 256);
+		writer.writeString("start");
+		writer.writeString(str);
+		writer.writeString("end");
+	}
+	EXPECT_EQ("start" + str + "end", toString(stream));
+}
+
+} // namespace io
@@ -4,6 +4,7 @@
 
 #include "io/ZipArchive.h"
 #include "core/ArrayLength.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
@@ -36,4 +37,52 @@ TEST_F(ZipArchiveTest, testZipArchive) {
 	EXPECT_EQ("dir/file.txt", files[2].name);
 }
 
+TEST_F(ZipArchiveTest, testLoadParallel) {
+	io::Filesystem fs;
+	fs.init("test", "test");
+	const io::FilePtr &file = fs.open("iotest.zip", io::FileMode::Read);
+	FileStream fileStream(file);
+	ZipArchive archive;
+	ASSERT_TRUE(archive.open(&fileStream));
+	EXPECT_TRUE(archive.exists("dir/file.txt"));
+	EXPECT_FALSE(archive.exists("dir/missing.txt"));
+
+	core::ThreadPool threadPool(2, "ZipArchiveTest");
+	threadPool.init();
+	BufferedReadWriteStream out1;
+	BufferedReadWriteStream out2;
+	const core::DynamicArray<core::String> files{"file.txt", "dir/file.txt"};
+	const core::DynamicArray<io::SeekableWriteStream *> outs{&out1, &out2};
+	ASSERT_TRUE(archive.load(files, outs, &threadPool));
+	EXPECT_EQ(17, out1.size());
+	EXPECT_EQ(15, out2.size());
+	EXPECT_EQ(0, memcmp("root file content", out1.getBuffer(), 17));
+	EXPECT_EQ(0, memcmp("content in dir/", out2.getBuffer(), 15));
+}
+
+TEST_F(ZipArchiveTest, testEntryStream) {
+	io::Filesystem fs;
+	fs.init("test", "test");
+	const io::FilePtr &file = fs.open("iotest.zip", io::FileMode::Read);
+	FileStream fileStream(file);
+	ZipArchive archive;
+	ASSERT_TRUE(archive.open(&fileStream));
+
+	ZipArchiveEntryStream stream(archive, "file2.txt");
+	ASSERT_TRUE(stream.valid());
+	char buf[32];
+	// read in small pieces to not decompress the entry in one step
+	int n = 0;
+	while (!stream.eos()) {
+		const int read = stream.read(buf + n, 4);
+		ASSERT_GE(read, 0);
+		n += read;
+	}
+	ASSERT_EQ(25, n);
+	EXPECT_EQ(0, memcmp("yet another file in root\n", buf, 25));
+
+	ZipArchiveEntryStream missing(archive, "missing.txt");
+	EXPECT_FALSE(missing.valid());
+}
+
 } // namespace io
@@ -2,6 +2,9 @@
  * @file
  */
 
+#include "core/Zip.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
@@ -44,7 +47,8 @@ TEST_F(ZipStreamTest, testZipStream) {
 TEST_F(ZipStreamTest, testZipStreamNoSize) {
 	const int n = 64;
 	const int size = n * 4 * sizeof(uint32_t);
-	const int expectedZippedSize = 134;
+	// the compressed size depends on the deflate implementation (miniz or zlib)
+	int64_t expectedZippedSize = 0;
 	BufferedReadWriteStream stream(size);
 	{
 		ZipWriteStream w(stream);
@@ -55,7 +59,9 @@ TEST_F(ZipStreamTest, testZipStreamNoSize) {
 			ASSERT_TRUE(w.writeInt32(i + 3)) << "unexpected write failure for step: " << i;
 		}
 		ASSERT_TRUE(w.flush());
-		ASSERT_EQ(expectedZippedSize, w.size());
+		expectedZippedSize = w.size();
+		ASSERT_GT(expectedZippedSize, 0);
+		ASSERT_LT(expectedZippedSize, size);
 		ASSERT_EQ(expectedZippedSize, stream.size());
 		for (int i = 0; i < n; ++i) {
 			stream.writeUInt32(0xdeadbeef);
@@ -67,7 +73,7 @@ TEST_F(ZipStreamTest, testZipStreamNoSize) {
 	}
 	stream.seek(0);
 	{
-		ZipReadStream r(stream, expectedZippedSize);
+		ZipReadStream r(stream, (int)expectedZippedSize);
 		for (int i = 0; i < n; ++i) {
 			int32_t n;
 			ASSERT_FALSE(r.eos());
@@ -90,4 +96,58 @@ TEST_F(ZipStreamTest, testZipStreamNoSize) {
 	}
 }
 
+TEST_F(ZipStreamTest, testZipStreamParallel) {
+	core::ThreadPool threadPool(4, "ZipStreamTest");
+	threadPool.init();
+	// a few blocks with a partial one at the end
+	const int n = 300000;
+	BufferedReadWriteStream stream(n);
+	{
+		ZipWriteStream w(stream, 6, &threadPool);
+		for (int i = 0; i < n; ++i) {
+			ASSERT_TRUE(w.writeInt32(i * 7 % 1021)) << "unexpected write failure for step: " << i;
+		}
+		ASSERT_TRUE(w.flush());
+		ASSERT_EQ(w.size(), stream.size());
+	}
+	const int size = (int)stream.size();
+	stream.seek(0);
+	{
+		ZipReadStream r(stream, size);
+		for (int i = 0; i < n; ++i) {
+			int32_t v;
+			ASSERT_EQ(0, r.readInt32(v)) << "unexpected read failure for step: " << i;
+			ASSERT_EQ(i * 7 % 1021, v) << "unexpected extracted value for step: " << i;
+		}
+		ASSERT_TRUE(r.eos());
+	}
+
+	// the concatenated blocks must be a valid zlib stream including the checksum
+	core::DynamicArray<uint8_t> uncompressed;
+	uncompressed.resize(n * sizeof(int32_t));
+	size_t uncompressedSize = 0;
+	ASSERT_TRUE(core::zip::uncompress(stream.getBuffer(), size, uncompressed.data(), uncompressed.size(),
+									  &uncompressedSize));
+	ASSERT_EQ(uncompressed.size(), uncompressedSize);
+	threadPool.shutdown();
+}
+
+TEST_F(ZipStreamTest, testZipStreamParallelEmpty) {
+	core::ThreadPool threadPool(2, "ZipStreamTest");
+	threadPool.init();
+	BufferedReadWriteStream stream(64);
+	{
+		ZipWriteStream w(stream, 6, &threadPool);
+		ASSERT_TRUE(w.flush());
+	}
+	const int size = (int)stream.size();
+	ASSERT_GT(size, 0);
+	stream.seek(0);
+	ZipReadStream r(stream, size);
+	uint8_t v;
+	ASSERT_EQ(-1, r.readUInt8(v));
+	ASSERT_TRUE(r.eos());
+	threadPool.shutdown();
+}
+
 } // namespace io
@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#include "BVH.h"
+#include "core/Algorithm.h"
+#include "core/Trace.h"
+
+namespace math {
+
+void BVH::clear() {
+	_entries.clear();
+	_nodes.clear();
+}
+
+void BVH::reserve(size_t entries) {
+	_entries.reserve(entries);
+	_nodes.reserve(entries / MaxLeafEntries * 2 + 1);
+}
+
+void BVH::add(int id, const AABB<float> &aabb) {
+	_entries.push_back(Entry{aabb, aabb.getCenter(), id});
+}
+
+void BVH::build() {
+	core_trace_scoped(BVHBuild);
+	_nodes.clear();
+	if (_entries.empty()) {
+		return;
+	}
+	build_r(0, (int)_entries.size());
+}
+
+void BVH::build_r(int start, int end) {
+	const int nodeIdx = (int)_nodes.size();
+	_nodes.emplace_back();
+	AABB<float> aabb = _entries[start].aabb;
+	AABB<float> centers(_entries[start].center, _entries[start].center);
+	for (int i = start + 1; i < end; ++i) {
+		aabb.accumulate(_entries[i].aabb);
+		centers.accumulate(_entries[i].center);
+	}
+	_nodes[nodeIdx].aabb = aabb;
+
+	const int count = end - start;
+	if (count <= MaxLeafEntries) {
+		_nodes[nodeIdx].start = start;
+		_nodes[nodeIdx].count = count;
+		return;
+	}
+
+	const glm::vec3 &extents = centers.getWidth();
+	int axis = 0;
+	if (extents.y > extents[axis]) {
+		axis = 1;
+	}
+	if (extents.z > extents[axis]) {
+		axis = 2;
+	}
+	core::sort(_entries.begin() + start, _entries.begin() + end,
+			   [axis](const Entry &lhs, const Entry &rhs) { return lhs.center[axis] < rhs.center[axis]; });
+	const int mid = start + count / 2;
+	// the left child directly follows the parent node
+	build_r(start, mid);
+	const int right = (int)_nodes.size();
+	build_r(mid, end);
+	// don't keep a reference - the recursion might have re-allocated the nodes
+	_nodes[nodeIdx].right = right;
+}
+
+} // namespace math
@@ -0,0 +1,100 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "AABB.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+
+namespace math {
+
+/**
+ * @brief Static bounding volume hierarchy over axis aligned boxes that are identified by an integer id
+ *
+ * Add all boxes with @c add() and call @c build() afterwards. The hierarchy is not updated incrementally - if
+ * the boxes change, it has to be rebuilt.
+ *
+ * The entries are split at the median of the longest axis of the node bounds - the nodes are stored in depth
+ * first order, the left child always directly follows its parent.
+ */
+class BVH {
+public:
+	static constexpr int MaxLeafEntries = 4;
+
+private:
+	struct Entry {
+		AABB<float> aabb;
+		glm::vec3 center;
+		int id;
+	};
+	struct Node {
+		AABB<float> aabb;
+		/** index of the first entry for leaf nodes */
+		int start = 0;
+		/** amount of entries - @c 0 for inner nodes */
+		int count = 0;
+		/** index of the second child for inner nodes */
+		int right = -1;
+	};
+
+	core::DynamicArray<Entry> _entries;
+	core::DynamicArray<Node> _nodes;
+
+	void build_r(int start, int end);
+
+public:
+	void clear();
+	void reserve(size_t entries);
+	void add(int id, const AABB<float> &aabb);
+	/**
+	 * @brief Creates the hierarchy for all boxes that were added since the last @c clear() call
+	 */
+	void build();
+
+	inline size_t size() const {
+		return _entries.size();
+	}
+
+	inline bool empty() const {
+		return _entries.empty();
+	}
+
+	/**
+	 * @brief Calls the given functor with the id of every box that is hit by the given ray
+	 * @note The candidates are not sorted by distance - the callers have to perform their own (exact) intersection tests
+	 * @param func Functor with the signature @code void(int id) @endcode
+	 */
+	template<class FUNC>
+	void raycast(const glm::vec3 &rayOrigin, const glm::vec3 &rayDirection, float rayLength, FUNC &&func) const {
+		if (_nodes.empty()) {
+			return;
+		}
+		// the depth is limited by the median split - 64 levels are more than enough for any amount of entries
+		int stack[64];
+		int stackSize = 0;
+		stack[stackSize++] = 0;
+		while (stackSize > 0) {
+			const Node &node = _nodes[stack[--stackSize]];
+			float distance;
+			if (!node.aabb.intersect(rayOrigin, rayDirection, rayLength, distance)) {
+				continue;
+			}
+			if (node.count > 0) {
+				for (int i = node.start; i < node.start + node.count; ++i) {
+					const Entry &entry = _entries[i];
+					if (entry.aabb.intersect(rayOrigin, rayDirection, rayLength, distance)) {
+						func(entry.id);
+					}
+				}
+				continue;
+			}
+			const int nodeIdx = (int)(&node - _nodes.data());
+			stack[stackSize++] = node.right;
+			stack[stackSize++] = nodeIdx + 1;
+		}
+	}
+};
+
+} // namespace math
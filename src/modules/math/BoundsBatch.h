@@ -0,0 +1,153 @@
+/**
+ * @file
+ * @brief Bounding volumes in structure of arrays layout for the batched frustum tests
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include <glm/exponential.hpp>
+#include <glm/vec3.hpp>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace math {
+
+/**
+ * @brief Axis aligned boxes in structure of arrays layout - each component is stored in its own array
+ *
+ * This allows to test four boxes at once against a plane - see Frustum::isVisible(const AABBBatch&, uint64_t*)
+ */
+class AABBBatch {
+private:
+	core::DynamicArray<float> _mins[3];
+	core::DynamicArray<float> _maxs[3];
+
+public:
+	void reserve(size_t n) {
+		for (int i = 0; i < 3; ++i) {
+			_mins[i].reserve(n);
+			_maxs[i].reserve(n);
+		}
+	}
+
+	void add(const glm::vec3 &mins, const glm::vec3 &maxs) {
+		for (int i = 0; i < 3; ++i) {
+			_mins[i].push_back(mins[i]);
+			_maxs[i].push_back(maxs[i]);
+		}
+	}
+
+	void clear() {
+		for (int i = 0; i < 3; ++i) {
+			_mins[i].clear();
+			_maxs[i].clear();
+		}
+	}
+
+	inline size_t size() const {
+		return _mins[0].size();
+	}
+
+	inline bool empty() const {
+		return _mins[0].empty();
+	}
+
+	/**
+	 * @param axis @c 0 for x, @c 1 for y and @c 2 for z
+	 */
+	inline const float *mins(int axis) const {
+		return _mins[axis].data();
+	}
+
+	inline const float *maxs(int axis) const {
+		return _maxs[axis].data();
+	}
+
+	inline glm::vec3 mins(size_t idx) const {
+		return glm::vec3(_mins[0][idx], _mins[1][idx], _mins[2][idx]);
+	}
+
+	inline glm::vec3 maxs(size_t idx) const {
+		return glm::vec3(_maxs[0][idx], _maxs[1][idx], _maxs[2][idx]);
+	}
+};
+
+/**
+ * @brief Spheres in structure of arrays layout - see Frustum::isVisible(const SphereBatch&, uint64_t*)
+ */
+class SphereBatch {
+private:
+	core::DynamicArray<float> _center[3];
+	core::DynamicArray<float> _radius;
+
+public:
+	void reserve(size_t n) {
+		for (int i = 0; i < 3; ++i) {
+			_center[i].reserve(n);
+		}
+		_radius.reserve(n);
+	}
+
+	void add(const glm::vec3 &center, float radius) {
+		for (int i = 0; i < 3; ++i) {
+			_center[i].push_back(center[i]);
+		}
+		_radius.push_back(radius);
+	}
+
+	/**
+	 * @brief Adds the bounding sphere of the given box
+	 */
+	void addBounds(const glm::vec3 &mins, const glm::vec3 &maxs) {
+		const glm::vec3 halfSize = (maxs - mins) * 0.5f;
+		add(mins + halfSize, glm::sqrt(halfSize.x * halfSize.x + halfSize.y * halfSize.y + halfSize.z * halfSize.z));
+	}
+
+	void clear() {
+		for (int i = 0; i < 3; ++i) {
+			_center[i].clear();
+		}
+		_radius.clear();
+	}
+
+	inline size_t size() const {
+		return _radius.size();
+	}
+
+	inline bool empty() const {
+		return _radius.empty();
+	}
+
+	inline const float *center(int axis) const {
+		return _center[axis].data();
+	}
+
+	inline const float *radius() const {
+		return _radius.data();
+	}
+
+	inline glm::vec3 center(size_t idx) const {
+		return glm::vec3(_center[0][idx], _center[1][idx], _center[2][idx]);
+	}
+
+	inline float radius(size_t idx) const {
+		return _radius[idx];
+	}
+};
+
+/**
+ * @return The amount of words of the visibility mask for @c n bounding volumes - one bit per volume
+ */
+inline constexpr size_t visibilityMaskWords(size_t n) {
+	return (n + 63u) / 64u;
+}
+
+/**
+ * @return @c true if the bit of the given bounding volume is set in the visibility mask
+ */
+inline bool isVisible(const uint64_t *mask, size_t idx) {
+	return (mask[idx / 64u] >> (idx % 64u)) & 1u;
+}
+
+} // namespace math
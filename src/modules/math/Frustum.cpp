@@ -7,11 +7,128 @@
 #include "core/Assert.h"
 #include "core/GLM.h"
 #include "math/AABB.h"
+#include "math/BoundsBatch.h"
 #include <glm/gtc/matrix_access.hpp>
 #include <glm/gtc/matrix_transform.hpp>
+#include <string.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FRUSTUM_BATCH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define FRUSTUM_BATCH_NEON 1
+#include <arm_neon.h>
+#endif
 
 namespace math {
 
+namespace batch {
+
+static constexpr int Lanes = 4;
+
+/**
+ * @brief One value per lane - maps to one SSE2 or NEON register if available
+ */
+struct Float4 {
+#if defined(FRUSTUM_BATCH_SSE2)
+	__m128 v;
+
+	static inline Float4 load(const float *p) {
+		return {_mm_loadu_ps(p)};
+	}
+	static inline Float4 set1(float f) {
+		return {_mm_set1_ps(f)};
+	}
+#elif defined(FRUSTUM_BATCH_NEON)
+	float32x4_t v;
+
+	static inline Float4 load(const float *p) {
+		return {vld1q_f32(p)};
+	}
+	static inline Float4 set1(float f) {
+		return {vdupq_n_f32(f)};
+	}
+#else
+	float v[Lanes];
+
+	static inline Float4 load(const float *p) {
+		Float4 r;
+		for (int i = 0; i < Lanes; ++i) {
+			r.v[i] = p[i];
+		}
+		return r;
+	}
+	static inline Float4 set1(float f) {
+		Float4 r;
+		for (int i = 0; i < Lanes; ++i) {
+			r.v[i] = f;
+		}
+		return r;
+	}
+#endif
+};
+
+#if defined(FRUSTUM_BATCH_SSE2)
+static inline Float4 operator+(const Float4 &a, const Float4 &b) {
+	return {_mm_add_ps(a.v, b.v)};
+}
+static inline Float4 operator*(const Float4 &a, const Float4 &b) {
+	return {_mm_mul_ps(a.v, b.v)};
+}
+/**
+ * @return One bit per lane where @c a < @c b
+ */
+static inline int lessMask(const Float4 &a, const Float4 &b) {
+	return _mm_movemask_ps(_mm_cmplt_ps(a.v, b.v));
+}
+#elif defined(FRUSTUM_BATCH_NEON)
+static inline Float4 operator+(const Float4 &a, const Float4 &b) {
+	return {vaddq_f32(a.v, b.v)};
+}
+static inline Float4 operator*(const Float4 &a, const Float4 &b) {
+	return {vmulq_f32(a.v, b.v)};
+}
+static inline int lessMask(const Float4 &a, const Float4 &b) {
+	static const uint32_t bits[Lanes] = {1u, 2u, 4u, 8u};
+	const uint32x4_t mask = vandq_u32(vcltq_f32(a.v, b.v), vld1q_u32(bits));
+	const uint32x2_t sum = vpadd_u32(vget_low_u32(mask), vget_high_u32(mask));
+	return (int)(vget_lane_u32(sum, 0) + vget_lane_u32(sum, 1));
+}
+#else
+static inline Float4 operator+(const Float4 &a, const Float4 &b) {
+	Float4 r;
+	for (int i = 0; i < Lanes; ++i) {
+		r.v[i] = a.v[i] + b.v[i];
+	}
+	return r;
+}
+static inline Float4 operator*(const Float4 &a, const Float4 &b) {
+	Float4 r;
+	for (int i = 0; i < Lanes; ++i) {
+		r.v[i] = a.v[i] * b.v[i];
+	}
+	return r;
+}
+static inline int lessMask(const Float4 &a, const Float4 &b) {
+	int mask = 0;
+	for (int i = 0; i < Lanes; ++i) {
+		if (a.v[i] < b.v[i]) {
+			mask |= 1 << i;
+		}
+	}
+	return mask;
+}
+#endif
+
+static constexpr int AllLanes = (1 << Lanes) - 1;
+
+static inline size_t setLanes(uint64_t *mask, size_t idx, int lanes) {
+	mask[idx / 64u] |= (uint64_t)lanes << (idx % 64u);
+	return (size_t)((lanes & 1) + ((lanes >> 1) & 1) + ((lanes >> 2) & 1) + ((lanes >> 3) & 1));
+}
+
+} // namespace batch
+
 static const glm::vec4 cornerVecs[FRUSTUM_VERTICES_MAX] = {
 	glm::vec4(-1.0f,  1.0f,  1.0f, 1.0f), glm::vec4(-1.0f, -1.0f,  1.0f, 1.0f),
 	glm::vec4( 1.0f,  1.0f,  1.0f, 1.0f), glm::vec4( 1.0f, -1.0f,  1.0f, 1.0f),
@@ -187,6 +304,79 @@ bool Frustum::isVisible(const glm::vec3& pos) const {
 	return true;
 }
 
+size_t Frustum::isVisible(const AABBBatch& boxes, uint64_t* visible) const {
+	core_trace_scoped(FrustumIsVisibleBatch);
+	const size_t n = boxes.size();
+	memset(visible, 0, visibilityMaskWords(n) * sizeof(uint64_t));
+	// the vertex that is the furthest along the plane normal is the same for all boxes
+	const float *positive[FRUSTUM_PLANES_MAX][3];
+	for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+		const glm::vec3& normal = _planes[p].norm();
+		for (int axis = 0; axis < 3; ++axis) {
+			positive[p][axis] = normal[axis] > 0.0f ? boxes.maxs(axis) : boxes.mins(axis);
+		}
+	}
+	const batch::Float4 zero = batch::Float4::set1(0.0f);
+	size_t count = 0u;
+	size_t i = 0u;
+	for (; i + batch::Lanes <= n; i += batch::Lanes) {
+		int outside = 0;
+		for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX && outside != batch::AllLanes; ++p) {
+			const Plane& plane = _planes[p];
+			const glm::vec3& normal = plane.norm();
+			const batch::Float4 dist = batch::Float4::load(positive[p][0] + i) * batch::Float4::set1(normal.x) +
+									   batch::Float4::load(positive[p][1] + i) * batch::Float4::set1(normal.y) +
+									   batch::Float4::load(positive[p][2] + i) * batch::Float4::set1(normal.z) +
+									   batch::Float4::set1(plane.dist());
+			outside |= batch::lessMask(dist, zero);
+		}
+		count += batch::setLanes(visible, i, ~outside & batch::AllLanes);
+	}
+	for (; i < n; ++i) {
+		bool inside = true;
+		for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX; ++p) {
+			const glm::vec3 vertex(positive[p][0][i], positive[p][1][i], positive[p][2][i]);
+			if (_planes[p].isBackSide(vertex)) {
+				inside = false;
+				break;
+			}
+		}
+		if (inside) {
+			count += batch::setLanes(visible, i, 1);
+		}
+	}
+	return count;
+}
+
+size_t Frustum::isVisible(const SphereBatch& spheres, uint64_t* visible) const {
+	core_trace_scoped(FrustumIsVisibleSphereBatch);
+	const size_t n = spheres.size();
+	memset(visible, 0, visibilityMaskWords(n) * sizeof(uint64_t));
+	size_t count = 0u;
+	size_t i = 0u;
+	for (; i + batch::Lanes <= n; i += batch::Lanes) {
+		const batch::Float4 x = batch::Float4::load(spheres.center(0) + i);
+		const batch::Float4 y = batch::Float4::load(spheres.center(1) + i);
+		const batch::Float4 z = batch::Float4::load(spheres.center(2) + i);
+		const batch::Float4 negativeRadius = batch::Float4::load(spheres.radius() + i) * batch::Float4::set1(-1.0f);
+		int outside = 0;
+		for (uint8_t p = 0; p < FRUSTUM_PLANES_MAX && outside != batch::AllLanes; ++p) {
+			const Plane& plane = _planes[p];
+			const glm::vec3& normal = plane.norm();
+			const batch::Float4 dist = x * batch::Float4::set1(normal.x) + y * batch::Float4::set1(normal.y) +
+									   z * batch::Float4::set1(normal.z) + batch::Float4::set1(plane.dist());
+			outside |= batch::lessMask(dist, negativeRadius);
+		}
+		count += batch::setLanes(visible, i, ~outside & batch::AllLanes);
+	}
+	for (; i < n; ++i) {
+		if (isVisible(spheres.center(i), spheres.radius(i))) {
+			count += batch::setLanes(visible, i, 1);
+		}
+	}
+	return count;
+}
+
 FrustumResult Frustum::test(const glm::vec3& mins, const glm::vec3& maxs) const {
 	core_trace_scoped(FrustumTest);
 	FrustumResult result = FrustumResult::Inside;
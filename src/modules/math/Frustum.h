@@ -11,6 +11,8 @@ namespace math {
 
 template<class T>
 class AABB;
+class AABBBatch;
+class SphereBatch;
 
 enum class FrustumPlanes {
 	Right,
@@ -58,6 +60,22 @@ public:
 
 	bool isVisible(const glm::vec3& center, float radius) const;
 
+	/**
+	 * @brief Tests all boxes of the batch - four boxes are tested at once with SSE2 or NEON if available
+	 * @param[out] visible One bit per box with the same result as isVisible(mins, maxs) - must hold at least
+	 * visibilityMaskWords(boxes.size()) words
+	 * @return The amount of visible boxes
+	 */
+	size_t isVisible(const AABBBatch& boxes, uint64_t* visible) const;
+
+	/**
+	 * @brief Tests all spheres of the batch - four spheres are tested at once with SSE2 or NEON if available
+	 * @param[out] visible One bit per sphere with the same result as isVisible(center, radius) - must hold at least
+	 * visibilityMaskWords(spheres.size()) words
+	 * @return The amount of visible spheres
+	 */
+	size_t isVisible(const SphereBatch& spheres, uint64_t* visible) const;
+
 	void split(const glm::mat4& transform, glm::vec3 out[FRUSTUM_VERTICES_MAX]) const;
 
 	void updateVertices(const glm::mat4& view, const glm::mat4& projection);
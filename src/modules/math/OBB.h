@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "AABB.h"
 #include "core/GLM.h"
 #include <glm/mat4x4.hpp>
 #include <glm/vec3.hpp>
@@ -80,11 +81,29 @@ public:
 		return _extents.z * (T)2;
 	}
 
+	/**
+	 * @return The world space axis aligned box that encloses the rotated box
+	 */
+	AABB<T> toAABB() const {
+		AABB<T> aabb;
+		for (int i = 0; i < 8; ++i) {
+			const glm::vec4 corner((i & 1) ? _extents.x : -_extents.x, (i & 2) ? _extents.y : -_extents.y,
+								   (i & 4) ? _extents.z : -_extents.z, 1.0f);
+			const Vec &p = Vec(_rotation * corner) + _origin;
+			if (i == 0) {
+				aabb = AABB<T>(p, p);
+			} else {
+				aabb.accumulate(p);
+			}
+		}
+		return aabb;
+	}
+
 	bool contains(const glm::vec3 &point) const {
-		const Vec min = _origin - _extents;
-		const Vec max = _origin + _extents;
+		const Vec min = -_extents;
+		const Vec max = _extents;
 
-		const glm::vec4 &p = _inv * glm::vec4(point, 1.0f);
+		const glm::vec4 &p = _inv * glm::vec4(point - _origin, 1.0f);
 		const T x = (T)p.x;
 		const T y = (T)p.y;
 		const T z = (T)p.z;
@@ -92,11 +111,12 @@ public:
 	}
 
 	bool intersect(const glm::vec3& inRayOrigin, const glm::vec3& inRayDirection, float rayLength, float& distance) const {
-		const Vec minsV = _origin - _extents;
-		const Vec maxsV = _origin + _extents;
+		const Vec minsV = -_extents;
+		const Vec maxsV = _extents;
 
-		const glm::vec3 &rayOrigin = _inv * glm::vec4(inRayOrigin, 1.0f);
-		const glm::vec3 &rayDirection = _inv* glm::vec4(inRayDirection, 1.0f);
+		// the tests are performed in the space of the box - centered around the origin
+		const glm::vec3 &rayOrigin = _inv * glm::vec4(inRayOrigin - _origin, 1.0f);
+		const glm::vec3 &rayDirection = _inv * glm::vec4(inRayDirection, 0.0f);
 		glm::vec3 pos1;
 		glm::vec3 pos2;
 		double t_near = -rayLength;
@@ -19,6 +19,11 @@ extern math::AABB<int> computeAABB(const Frustum& area, const glm::vec3& gridSiz
 
 /**
  * @note Given NODE type must implement @c aabb() and return math::AABB<TYPE>
+ *
+ * With a looseness greater than @c 1 the bounds of the child nodes are enlarged by that factor around their center -
+ * a loose octree. The items are put into the child that contains their center if its loose bounds contain them.
+ * This keeps small items out of the upper levels even if they cross a split plane and allows them to move a bit
+ * without changing their node - see update().
  */
 template<class NODE, typename TYPE = int>
 class Octree {
@@ -101,9 +106,116 @@ public:
 		int _depth;
 		const Octree* _octree;
 		const AABB<TYPE> _aabb;
+		/**
+		 * @brief The bounds the items of this node are contained in - the same as the node bounds if the octree
+		 * isn't loose
+		 */
+		AABB<TYPE> _looseAabb;
 		Contents _contents;
 		std::vector<OctreeNode> _nodes;
 
+		inline bool loose() const {
+			return _octree->_looseness > 1.0f;
+		}
+
+		/**
+		 * @return The index of the child node for the given position - see split()
+		 */
+		inline int childIndex(const glm::tvec3<TYPE>& pos) const {
+			const glm::tvec3<TYPE>& center = _aabb.getCenter();
+			return (pos.x >= center.x ? 4 : 0) | (pos.y >= center.y ? 2 : 0) | (pos.z >= center.z ? 1 : 0);
+		}
+
+		/**
+		 * @return The index of the child node the given bounds belong to - @c -1 if they must stay in this node
+		 */
+		int childFor(const AABB<TYPE>& area) const {
+			if (_nodes.empty()) {
+				return -1;
+			}
+			if (loose()) {
+				const int idx = childIndex(area.getCenter());
+				return _nodes[idx]._looseAabb.containsAABB(area) ? idx : -1;
+			}
+			for (int i = 0; i < (int)_nodes.size(); ++i) {
+				if (_nodes[i]._aabb.containsAABB(area)) {
+					return i;
+				}
+			}
+			return -1;
+		}
+
+		template<class FUNC>
+		void visitContents(FUNC&& func) const {
+			for (const NODE& item : _contents) {
+				func(item);
+			}
+			for (const OctreeNode& node : _nodes) {
+				node.visitContents(func);
+			}
+		}
+
+		/**
+		 * @brief Distributes the given items over this node and its children
+		 * @param scratch Buffer for at least @c n items that is shared by the whole build
+		 * @param children Buffer for at least @c n child indices that is shared by the whole build
+		 */
+		void build(NODE* items, size_t n, std::vector<NODE>& scratch, std::vector<int>& children) {
+			if (n == 0u) {
+				return;
+			}
+			if (_nodes.empty()) {
+				createNodes();
+			}
+			size_t offsets[8] {};
+			for (size_t i = 0u; i < n; ++i) {
+				const int child = childFor(aabb(items[i]));
+				children[i] = child;
+				if (child == -1) {
+					_contents.push_back(items[i]);
+				} else {
+					++offsets[child];
+				}
+			}
+			size_t starts[8];
+			size_t fitting = 0u;
+			for (int c = 0; c < 8; ++c) {
+				starts[c] = fitting;
+				fitting += offsets[c];
+				offsets[c] = starts[c];
+			}
+			// counting sort by child - the buffers are free again before the children are built
+			for (size_t i = 0u; i < n; ++i) {
+				if (children[i] != -1) {
+					scratch[offsets[children[i]]++] = items[i];
+				}
+			}
+			std::copy(scratch.begin(), scratch.begin() + fitting, items);
+			for (int c = 0; c < (int)_nodes.size(); ++c) {
+				_nodes[c].build(items + starts[c], offsets[c] - starts[c], scratch, children);
+			}
+		}
+
+		/**
+		 * @brief Searches the node that holds the given item
+		 * @param area The bounds the item had when it was put into the node
+		 */
+		OctreeNode* find(const NODE& item, const AABB<TYPE>& area, typename Contents::iterator& iter) {
+			if (!_looseAabb.containsAABB(area)) {
+				return nullptr;
+			}
+			for (OctreeNode& node : _nodes) {
+				if (OctreeNode* found = node.find(item, area, iter)) {
+					return found;
+				}
+			}
+			iter = std::find(_contents.begin(), _contents.end(), item);
+			if (iter == _contents.end()) {
+				return nullptr;
+			}
+			return this;
+		}
+
 		template<class FUNC>
 		inline void visit(FUNC&& func) const {
 			core_trace_scoped(OctreeNodeVisit);
@@ -131,6 +243,7 @@ public:
 			_nodes.reserve(8);
 			for (size_t i = 0u; i < 8; ++i) {
 				_nodes.emplace_back(OctreeNode(subareas[i], _maxDepth, _depth + 1, _octree));
+				_nodes.back()._looseAabb = _octree->looseAABB(subareas[i]);
 				if (_octree->_listener != nullptr) {
 					_octree->_listener->onNodeCreated(*this, _nodes.back());
 				}
@@ -146,7 +259,7 @@ public:
 		}
 
 		OctreeNode(const AABB<TYPE>& bounds, int maxDepth, int depth, const Octree* octree) :
-				_maxDepth(maxDepth), _depth(depth), _octree(octree), _aabb(bounds) {
+				_maxDepth(maxDepth), _depth(depth), _octree(octree), _aabb(bounds), _looseAabb(bounds) {
 		}
 
 		inline int depth() const {
@@ -167,6 +280,13 @@ public:
 			return _aabb;
 		}
 
+		/**
+		 * @brief The bounds that contain all items of this node and its children
+		 */
+		inline const AABB<TYPE>& looseAabb() const {
+			return _looseAabb;
+		}
+
 		inline const Contents& getContents() const {
 			return _contents;
 		}
@@ -187,7 +307,7 @@ public:
 		bool remove(const NODE& item) {
 			core_trace_scoped(OctreeNodeRemove);
 			const AABB<TYPE>& area = aabb(item);
-			if (!aabb().containsAABB(area)) {
+			if (!_looseAabb.containsAABB(area)) {
 				return false;
 			}
 			for (typename Octree<NODE, TYPE>::OctreeNode& node : _nodes) {
@@ -208,7 +328,7 @@ public:
 		bool insert(const NODE& item) {
 			core_trace_scoped(OctreeNodeInsert);
 			const AABB<TYPE>& area = aabb(item);
-			if (!aabb().containsAABB(area)) {
+			if (!_looseAabb.containsAABB(area)) {
 				return false;
 			}
 
@@ -216,11 +336,9 @@ public:
 				createNodes();
 			}
 
-			for (typename Octree<NODE, TYPE>::OctreeNode& node : _nodes) {
-				if (!node.insert(item)) {
-					continue;
-				}
-				return true;
+			const int child = childFor(area);
+			if (child != -1) {
+				return _nodes[child].insert(item);
 			}
 
 			_contents.push_back(item);
@@ -252,8 +370,8 @@ public:
 					continue;
 				}
 
-				const AABB<TYPE>& aabb = node.aabb();
-				if (aabb.containsAABB(queryArea)) {
+				const AABB<TYPE>& aabb = node.looseAabb();
+				if (!loose() && aabb.containsAABB(queryArea)) {
 					node.query(queryArea, results);
 					// the queried area is completely part of the node - so no other node can be involved
 					break;
@@ -285,8 +403,8 @@ public:
 					continue;
 				}
 
-				const AABB<TYPE>& aabb = node.aabb();
-				if (aabb.containsAABB(queryAreaAABB)) {
+				const AABB<TYPE>& aabb = node.looseAabb();
+				if (!loose() && aabb.containsAABB(queryAreaAABB)) {
 					node.query(queryArea, queryAreaAABB, results);
 					// the queried area is completely part of the node - so no other node can be involved
 					break;
@@ -302,12 +420,63 @@ public:
 				}
 			}
 		}
+
+		template<class FUNC>
+		void visitIntersecting(const AABB<TYPE>& queryArea, FUNC&& func) const {
+			for (const NODE& item : _contents) {
+				if (intersects(queryArea, aabb(item))) {
+					func(item);
+				}
+			}
+			for (const OctreeNode& node : _nodes) {
+				if (node.isEmpty()) {
+					continue;
+				}
+				const AABB<TYPE>& aabb = node.looseAabb();
+				if (queryArea.containsAABB(aabb)) {
+					node.visitContents(func);
+				} else if (intersects(aabb, queryArea)) {
+					node.visitIntersecting(queryArea, func);
+				}
+			}
+		}
+
+		template<class FUNC>
+		void visitVisible(const Frustum& queryArea, FUNC&& func) const {
+			for (const NODE& item : _contents) {
+				const auto& itemAABB = aabb(item);
+				if (queryArea.isVisible(itemAABB.mins(), itemAABB.maxs())) {
+					func(item);
+				}
+			}
+			for (const OctreeNode& node : _nodes) {
+				if (node.isEmpty()) {
+					continue;
+				}
+				const AABB<TYPE>& aabb = node.looseAabb();
+				const FrustumResult result = queryArea.test(aabb.mins(), aabb.maxs());
+				if (FrustumResult::Intersect == result) {
+					node.visitVisible(queryArea, func);
+				} else if (FrustumResult::Inside == result) {
+					node.visitContents(func);
+				}
+			}
+		}
 	};
 private:
 	OctreeNode _root;
 	// dirty flag can be used for query caches
 	bool _dirty = false;
 	const IOctreeListener* _listener = nullptr;
+	float _looseness = 1.0f;
+
+	AABB<TYPE> looseAABB(const AABB<TYPE>& bounds) const {
+		if (_looseness <= 1.0f) {
+			return bounds;
+		}
+		const glm::tvec3<TYPE> grow(glm::vec3(bounds.getWidth()) * ((_looseness - 1.0f) * 0.5f));
+		return AABB<TYPE>(bounds.mins() - grow, bounds.maxs() + grow);
+	}
 
 	template<class VISITOR>
 	void visit(const Frustum& queryArea, const AABB<TYPE>& queryAABB, VISITOR&& visitor, const glm::vec<3, TYPE>& minSize) const {
@@ -334,8 +503,12 @@ private:
 	}
 
 public:
-	Octree(const AABB<TYPE>& aabb, int maxDepth = 10) :
-			_root(aabb, maxDepth, 0, this) {
+	/**
+	 * @param looseness The factor the bounds of the child nodes are enlarged by - e.g. @c 2 for a loose octree, @c 1
+	 * for tight bounds. The items must still fit into the given bounds of the root node.
+	 */
+	Octree(const AABB<TYPE>& aabb, int maxDepth = 10, float looseness = 1.0f) :
+			_root(aabb, maxDepth, 0, this), _looseness(looseness) {
 	}
 
 	inline int count() const {
@@ -361,6 +534,56 @@ public:
 		return false;
 	}
 
+	/**
+	 * @brief Removes all items and distributes the given items over the nodes
+	 *
+	 * The items are partitioned level by level instead of descending from the root for every single item.
+	 *
+	 * @return The amount of items that didn't fit into the octree
+	 */
+	template<class ITER>
+	int build(ITER first, ITER last) {
+		core_trace_scoped(OctreeBuild);
+		clear();
+		std::vector<NODE> items;
+		int skipped = 0;
+		for (ITER i = first; i != last; ++i) {
+			if (_root.aabb().containsAABB(OctreeNode::aabb(*i))) {
+				items.push_back(*i);
+			} else {
+				++skipped;
+			}
+		}
+		std::vector<NODE> scratch(items.begin(), items.end());
+		std::vector<int> children(items.size());
+		_root.build(items.data(), items.size(), scratch, children);
+		return skipped;
+	}
+
+	/**
+	 * @brief Moves the given item to the node that matches its new bounds
+	 *
+	 * The item keeps its node as long as the (loose) bounds of the node contain the new bounds of the item.
+	 *
+	 * @param previous The bounds of the item when it was inserted or updated the last time
+	 * @return @c false if the item wasn't found or doesn't fit into the octree anymore - it's removed then
+	 */
+	bool update(const NODE& item, const AABB<TYPE>& previous) {
+		core_trace_scoped(OctreeUpdate);
+		typename Contents::iterator iter;
+		OctreeNode* node = _root.find(item, previous, iter);
+		if (node == nullptr) {
+			return false;
+		}
+		_dirty = true;
+		if (node->_looseAabb.containsAABB(OctreeNode::aabb(item))) {
+			*iter = item;
+			return true;
+		}
+		node->_contents.erase(iter);
+		return _root.insert(item);
+	}
+
 	inline const AABB<TYPE>& aabb() const {
 		core_trace_scoped(OctreeAABB);
 		return _root.aabb();
@@ -377,6 +600,26 @@ public:
 		_root.query(area, AABB<TYPE>(areaAABB.mins(), areaAABB.maxs()), results);
 	}
 
+	/**
+	 * @brief Calls the given functor for all items whose bounds intersect the given area - the items are not copied
+	 * @param func Functor with the signature @code void(const NODE& item) @endcode
+	 */
+	template<class FUNC>
+	inline void visitIntersecting(const AABB<TYPE>& area, FUNC&& func) const {
+		core_trace_scoped(OctreeVisitIntersecting);
+		_root.visitIntersecting(area, func);
+	}
+
+	/**
+	 * @brief Calls the given functor for all items that are visible in the given frustum - the items are not copied
+	 * @param func Functor with the signature @code void(const NODE& item) @endcode
+	 */
+	template<class FUNC>
+	inline void visitVisible(const Frustum& area, FUNC&& func) const {
+		core_trace_scoped(OctreeVisitVisible);
+		_root.visitVisible(area, func);
+	}
+
 	/**
 	 * @brief Executes the given visitor for all visible nodes in this octree.
 	 * @note As there might not be nodes yet for the potential visible nodes, the visitor
@@ -0,0 +1,67 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "math/BoundsBatch.h"
+#include "math/Frustum.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+class FrustumBenchmark : public app::AbstractBenchmark {
+protected:
+	math::Frustum _frustum;
+	math::AABBBatch _boxes;
+	math::SphereBatch _spheres;
+	core::DynamicArray<uint64_t> _visible;
+
+	void setup(int n) {
+		const glm::mat4 &view = glm::lookAt(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		const glm::mat4 &projection = glm::perspective(glm::radians(60.0f), 1.5f, 0.1f, 2000.0f);
+		_frustum.update(view, projection);
+		_boxes.clear();
+		_spheres.clear();
+		for (int i = 0; i < n; ++i) {
+			// chunks of a grid around the camera
+			const glm::vec3 mins((float)(i % 64 - 32) * 32.0f, (float)((i / 64) % 8 - 4) * 32.0f,
+								 (float)(i / 512 - 32) * 32.0f);
+			const glm::vec3 maxs = mins + 32.0f;
+			_boxes.add(mins, maxs);
+			_spheres.addBounds(mins, maxs);
+		}
+		_visible.resize(math::visibilityMaskWords(n));
+	}
+};
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, isVisible)(benchmark::State &state) {
+	setup((int)state.range(0));
+	for (auto _ : state) {
+		size_t visible = 0u;
+		for (size_t i = 0u; i < _boxes.size(); ++i) {
+			if (_frustum.isVisible(_boxes.mins(i), _boxes.maxs(i))) {
+				++visible;
+			}
+		}
+		benchmark::DoNotOptimize(visible);
+	}
+}
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, isVisibleBatch)(benchmark::State &state) {
+	setup((int)state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(_frustum.isVisible(_boxes, _visible.data()));
+	}
+}
+
+BENCHMARK_DEFINE_F(FrustumBenchmark, isVisibleSphereBatch)(benchmark::State &state) {
+	setup((int)state.range(0));
+	for (auto _ : state) {
+		benchmark::DoNotOptimize(_frustum.isVisible(_spheres, _visible.data()));
+	}
+}
+
+BENCHMARK_REGISTER_F(FrustumBenchmark, isVisible)->RangeMultiplier(4)->Range(256, 65536);
+BENCHMARK_REGISTER_F(FrustumBenchmark, isVisibleBatch)->RangeMultiplier(4)->Range(256, 65536);
+BENCHMARK_REGISTER_F(FrustumBenchmark, isVisibleSphereBatch)->RangeMultiplier(4)->Range(256, 65536);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,140 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "math/AABB.h"
+#include "math/Octree.h"
+#include <vector>
+
+namespace {
+
+class Item {
+private:
+	math::AABB<int> _bounds;
+	int _id;
+
+public:
+	Item(const math::AABB<int> &bounds, int id) : _bounds(bounds), _id(id) {
+	}
+
+	const math::AABB<int> &aabb() const {
+		return _bounds;
+	}
+
+	bool operator==(const Item &rhs) const {
+		return rhs._id == _id;
+	}
+};
+
+using ItemOctree = math::Octree<Item, int>;
+
+static const math::AABB<int> Bounds(0, 0, 0, 4096, 4096, 4096);
+
+static Item createItem(int id, int offset) {
+	const int x = (id * 7919 + offset) % 4000;
+	const int y = (id * 104729) % 4000;
+	const int z = (id * 1299709) % 4000;
+	const int size = 4 + id % 28;
+	return Item(math::AABB<int>(x, y, z, x + size, y + size, z + size), id);
+}
+
+static std::vector<Item> createItems(int n) {
+	std::vector<Item> items;
+	items.reserve(n);
+	for (int i = 0; i < n; ++i) {
+		items.push_back(createItem(i, 0));
+	}
+	return items;
+}
+
+} // namespace
+
+class OctreeBenchmark : public app::AbstractBenchmark {};
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, insert)(benchmark::State &state) {
+	const std::vector<Item> &items = createItems((int)state.range(0));
+	for (auto _ : state) {
+		ItemOctree octree(Bounds, 8);
+		for (const Item &item : items) {
+			octree.insert(item);
+		}
+		benchmark::DoNotOptimize(octree.count());
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, build)(benchmark::State &state) {
+	const std::vector<Item> &items = createItems((int)state.range(0));
+	for (auto _ : state) {
+		ItemOctree octree(Bounds, 8);
+		octree.build(items.begin(), items.end());
+		benchmark::DoNotOptimize(octree.count());
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, query)(benchmark::State &state) {
+	const std::vector<Item> &items = createItems((int)state.range(0));
+	ItemOctree octree(Bounds, 8);
+	octree.build(items.begin(), items.end());
+	const math::AABB<int> area(1024, 1024, 1024, 2048, 2048, 2048);
+	for (auto _ : state) {
+		ItemOctree::Contents contents;
+		octree.query(area, contents);
+		benchmark::DoNotOptimize(contents.size());
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, visitIntersecting)(benchmark::State &state) {
+	const std::vector<Item> &items = createItems((int)state.range(0));
+	ItemOctree octree(Bounds, 8);
+	octree.build(items.begin(), items.end());
+	const math::AABB<int> area(1024, 1024, 1024, 2048, 2048, 2048);
+	for (auto _ : state) {
+		size_t n = 0u;
+		octree.visitIntersecting(area, [&](const Item &item) { ++n; });
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+static void move(benchmark::State &state, float looseness, bool update) {
+	const int n = (int)state.range(0);
+	std::vector<Item> items = createItems(n);
+	ItemOctree octree(Bounds, 8, looseness);
+	octree.build(items.begin(), items.end());
+	int frame = 0;
+	for (auto _ : state) {
+		++frame;
+		for (int i = 0; i < n; ++i) {
+			const Item moved = createItem(i, frame);
+			if (update) {
+				octree.update(moved, items[i].aabb());
+			} else {
+				octree.remove(items[i]);
+				octree.insert(moved);
+			}
+			items[i] = moved;
+		}
+	}
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, removeInsert)(benchmark::State &state) {
+	move(state, 1.0f, false);
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, update)(benchmark::State &state) {
+	move(state, 1.0f, true);
+}
+
+BENCHMARK_DEFINE_F(OctreeBenchmark, updateLoose)(benchmark::State &state) {
+	move(state, 2.0f, true);
+}
+
+BENCHMARK_REGISTER_F(OctreeBenchmark, insert)->RangeMultiplier(4)->Range(256, 65536);
+BENCHMARK_REGISTER_F(OctreeBenchmark, build)->RangeMultiplier(4)->Range(256, 65536);
+BENCHMARK_REGISTER_F(OctreeBenchmark, query)->RangeMultiplier(4)->Range(256, 65536);
+BENCHMARK_REGISTER_F(OctreeBenchmark, visitIntersecting)->RangeMultiplier(4)->Range(256, 65536);
+BENCHMARK_REGISTER_F(OctreeBenchmark, removeInsert)->RangeMultiplier(4)->Range(256, 4096);
+BENCHMARK_REGISTER_F(OctreeBenchmark, update)->RangeMultiplier(4)->Range(256, 4096);
+BENCHMARK_REGISTER_F(OctreeBenchmark, updateLoose)->RangeMultiplier(4)->Range(256, 4096);
+
+BENCHMARK_MAIN();
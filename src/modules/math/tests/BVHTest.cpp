@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "core/collection/DynamicArray.h"
+#include "math/AABB.h"
+#include "math/BVH.h"
+#include "math/OBB.h"
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace math {
+
+class BVHTest : public app::AbstractTest {};
+
+TEST_F(BVHTest, testEmpty) {
+	BVH bvh;
+	bvh.build();
+	int hits = 0;
+	bvh.raycast(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 100.0f, [&](int) { ++hits; });
+	EXPECT_EQ(0, hits);
+}
+
+TEST_F(BVHTest, testRaycast) {
+	BVH bvh;
+	// a row of boxes along the x axis and a second row above them
+	for (int i = 0; i < 100; ++i) {
+		const glm::vec3 mins((float)i * 2.0f, 0.0f, 0.0f);
+		bvh.add(i, AABB<float>(mins, mins + 1.0f));
+		const glm::vec3 above((float)i * 2.0f, 10.0f, 0.0f);
+		bvh.add(i + 100, AABB<float>(above, above + 1.0f));
+	}
+	bvh.build();
+	EXPECT_EQ(200u, bvh.size());
+
+	core::DynamicArray<int> hits;
+	bvh.raycast(glm::vec3(-10.0f, 0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f), 1000.0f, [&](int id) { hits.push_back(id); });
+	ASSERT_EQ(100u, hits.size());
+	for (int id : hits) {
+		EXPECT_LT(id, 100);
+	}
+
+	hits.clear();
+	bvh.raycast(glm::vec3(42.5f, 100.0f, 0.5f), glm::vec3(0.0f, -1.0f, 0.0f), 1000.0f, [&](int id) { hits.push_back(id); });
+	ASSERT_EQ(2u, hits.size());
+	EXPECT_TRUE(hits[0] == 21 || hits[0] == 121);
+	EXPECT_TRUE(hits[1] == 21 || hits[1] == 121);
+
+	hits.clear();
+	bvh.raycast(glm::vec3(43.5f, 100.0f, 0.5f), glm::vec3(0.0f, -1.0f, 0.0f), 1000.0f, [&](int id) { hits.push_back(id); });
+	EXPECT_TRUE(hits.empty()) << "The ray passes between the boxes";
+}
+
+TEST_F(BVHTest, testOBBToAABB) {
+	const glm::mat3 rotation = glm::mat3(glm::rotate(glm::mat4(1.0f), glm::radians(45.0f), glm::vec3(0.0f, 1.0f, 0.0f)));
+	const OBB<float> obb(glm::vec3(10.0f, 0.0f, 0.0f), glm::vec3(1.0f), rotation);
+	const AABB<float> &aabb = obb.toAABB();
+	const float halfDiagonal = glm::sqrt(2.0f);
+	EXPECT_NEAR(10.0f - halfDiagonal, aabb.getLowerX(), 0.0001f);
+	EXPECT_NEAR(10.0f + halfDiagonal, aabb.getUpperX(), 0.0001f);
+	EXPECT_NEAR(-1.0f, aabb.getLowerY(), 0.0001f);
+	EXPECT_NEAR(1.0f, aabb.getUpperY(), 0.0001f);
+	EXPECT_TRUE(obb.contains(glm::vec3(10.0f, 0.5f, 0.0f)));
+	EXPECT_FALSE(obb.contains(glm::vec3(0.0f)));
+
+	float distance = 0.0f;
+	EXPECT_TRUE(obb.intersect(glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 100.0f, distance));
+	EXPECT_FALSE(obb.intersect(glm::vec3(0.0f, 5.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 100.0f, distance));
+}
+
+} // namespace math
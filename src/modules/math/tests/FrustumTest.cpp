@@ -7,6 +7,7 @@
 #include "core/GLM.h"
 #include "core/StringUtil.h"
 #include "math/AABB.h"
+#include "math/BoundsBatch.h"
 #include <glm/gtc/matrix_transform.hpp>
 
 namespace math {
@@ -152,4 +153,39 @@ TEST_F(FrustumTest, testOrthoFrustum) {
 	EXPECT_FALSE(frustum.isVisible(glm::ivec3(-66, -32, 64), glm::ivec3(-65, 0, 96)));
 }
 
+TEST_F(FrustumTest, testBatchVisibility) {
+	// 4 boxes per lane group plus a tail that is tested in scalar code
+	AABBBatch boxes;
+	SphereBatch spheres;
+	for (int i = 0; i < 103; ++i) {
+		const glm::vec3 mins((float)(i % 13) * 40.0f - 100.0f, (float)(i % 7) * 30.0f - 90.0f, (float)(i % 5) * 20.0f - 40.0f);
+		const glm::vec3 maxs = mins + glm::vec3((float)(1 + i % 3) * 4.0f);
+		boxes.add(mins, maxs);
+		spheres.addBounds(mins, maxs);
+	}
+	ASSERT_EQ(103u, boxes.size());
+	uint64_t visibleBoxes[visibilityMaskWords(103)];
+	uint64_t visibleSpheres[visibilityMaskWords(103)];
+	const size_t boxCount = _frustum.isVisible(boxes, visibleBoxes);
+	const size_t sphereCount = _frustum.isVisible(spheres, visibleSpheres);
+	size_t expectedBoxes = 0u;
+	size_t expectedSpheres = 0u;
+	for (size_t i = 0u; i < boxes.size(); ++i) {
+		const bool box = _frustum.isVisible(boxes.mins(i), boxes.maxs(i));
+		const bool sphere = _frustum.isVisible(spheres.center(i), spheres.radius(i));
+		EXPECT_EQ(box, isVisible(visibleBoxes, i)) << "box " << i;
+		EXPECT_EQ(sphere, isVisible(visibleSpheres, i)) << "sphere " << i;
+		if (box) {
+			++expectedBoxes;
+		}
+		if (sphere) {
+			++expectedSpheres;
+		}
+	}
+	EXPECT_EQ(expectedBoxes, boxCount);
+	EXPECT_EQ(expectedSpheres, sphereCount);
+	EXPECT_GT(boxCount, 0u);
+	EXPECT_LT(boxCount, boxes.size());
+}
+
 }
@@ -140,6 +140,65 @@ TEST_F(OctreeTest, testQuery) {
 	}
 }
 
+TEST_F(OctreeTest, testBuild) {
+	std::vector<oc::Item> items;
+	for (int i = 0; i < 100; ++i) {
+		const int p = (i * 37) % 95;
+		items.emplace_back(AABB<int>(p, (i * 13) % 95, (i * 7) % 95, p + 4, (i * 13) % 95 + 4, (i * 7) % 95 + 4), i);
+	}
+	items.emplace_back(AABB<int>(-10, -10, -10, 10, 10, 10), 100);
+	Octree<oc::Item, int> inserted({0, 0, 0, 100, 100, 100}, 4);
+	for (const oc::Item& item : items) {
+		inserted.insert(item);
+	}
+	Octree<oc::Item, int> built({0, 0, 0, 100, 100, 100}, 4);
+	EXPECT_EQ(1, built.build(items.begin(), items.end())) << "Expected the item outside of the octree to be skipped";
+	EXPECT_EQ(inserted.count(), built.count());
+	EXPECT_EQ(100, built.count());
+	const AABB<int> area(20, 20, 20, 60, 60, 60);
+	Octree<oc::Item, int>::Contents expected;
+	inserted.query(area, expected);
+	Octree<oc::Item, int>::Contents contents;
+	built.query(area, contents);
+	EXPECT_EQ(expected.size(), contents.size());
+	size_t visited = 0u;
+	built.visitIntersecting(area, [&](const oc::Item &item) { ++visited; });
+	EXPECT_EQ(expected.size(), visited);
+}
+
+TEST_F(OctreeTest, testLooseUpdate) {
+	Octree<oc::Item, int> octree({0, 0, 0, 128, 128, 128}, 4, 2.0f);
+	const oc::Item item({62, 62, 62, 66, 66, 66}, 1);
+	EXPECT_TRUE(octree.insert(item));
+	EXPECT_EQ(1, octree.count());
+	const oc::Item moved({70, 70, 70, 74, 74, 74}, 1);
+	EXPECT_TRUE(octree.update(moved, item.aabb()));
+	EXPECT_EQ(1, octree.count());
+	Octree<oc::Item, int>::Contents contents;
+	octree.query({71, 71, 71, 72, 72, 72}, contents);
+	EXPECT_EQ(1u, contents.size()) << "Expected to find the item at the new position";
+	contents.clear();
+	octree.query({62, 62, 62, 64, 64, 64}, contents);
+	EXPECT_EQ(0u, contents.size()) << "Expected to not find the item at the old position";
+	const oc::Item far({2, 2, 2, 4, 4, 4}, 1);
+	EXPECT_TRUE(octree.update(far, moved.aabb()));
+	EXPECT_EQ(1, octree.count());
+	EXPECT_FALSE(octree.update(far, moved.aabb())) << "Expected to not find the item with the outdated bounds";
+	EXPECT_TRUE(octree.remove(far));
+	EXPECT_EQ(0, octree.count());
+}
+
+TEST_F(OctreeTest, testVisitVisible) {
+	Octree<oc::Item, int> octree({0, 0, 0, 128, 128, 128}, 4);
+	EXPECT_TRUE(octree.insert({{2, 2, 2, 4, 4, 4}, 1}));
+	EXPECT_TRUE(octree.insert({{20, 20, 20, 24, 24, 24}, 2}));
+	EXPECT_TRUE(octree.insert({{100, 100, 100, 104, 104, 104}, 3}));
+	const math::Frustum frustum(glm::vec3(0.0f), glm::vec3(32.0f));
+	int visited = 0;
+	octree.visitVisible(frustum, [&](const oc::Item &item) { ++visited; });
+	EXPECT_EQ(2, visited);
+}
+
 TEST_F(OctreeTest, testOctreeVisitOrthoFrustum) {
 	const glm::vec3 mins(0.0f);
 	const glm::vec3 maxs(128.0f);
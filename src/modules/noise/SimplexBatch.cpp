@@ -0,0 +1,526 @@
+/**
+ * @file
+ */
+
+#include "SimplexBatch.h"
+#include "Simplex.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NOISE_BATCH_SSE2 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define NOISE_BATCH_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace noise {
+
+namespace batch {
+
+// the skewing factors of Simplex.h
+static constexpr float F2 = 0.366025403f;
+static constexpr float G2 = 0.211324865f;
+static constexpr float F3 = 0.333333333f;
+static constexpr float G3 = 0.166666667f;
+
+/**
+ * @brief One value per lane - maps to one SSE2 or NEON register if available
+ */
+struct Float4 {
+#if defined(NOISE_BATCH_SSE2)
+	__m128 v;
+
+	static inline Float4 load(const float *p) {
+		return {_mm_loadu_ps(p)};
+	}
+	static inline Float4 set1(float f) {
+		return {_mm_set1_ps(f)};
+	}
+	inline void store(float *p) const {
+		_mm_storeu_ps(p, v);
+	}
+#elif defined(NOISE_BATCH_NEON)
+	float32x4_t v;
+
+	static inline Float4 load(const float *p) {
+		return {vld1q_f32(p)};
+	}
+	static inline Float4 set1(float f) {
+		return {vdupq_n_f32(f)};
+	}
+	inline void store(float *p) const {
+		vst1q_f32(p, v);
+	}
+#else
+	float v[BatchLanes];
+
+	static inline Float4 load(const float *p) {
+		Float4 r;
+		for (int i = 0; i < BatchLanes; ++i) {
+			r.v[i] = p[i];
+		}
+		return r;
+	}
+	static inline Float4 set1(float f) {
+		Float4 r;
+		for (int i = 0; i < BatchLanes; ++i) {
+			r.v[i] = f;
+		}
+		return r;
+	}
+	inline void store(float *p) const {
+		for (int i = 0; i < BatchLanes; ++i) {
+			p[i] = v[i];
+		}
+	}
+#endif
+};
+
+#if defined(NOISE_BATCH_SSE2)
+static inline Float4 operator+(const Float4 &a, const Float4 &b) {
+	return {_mm_add_ps(a.v, b.v)};
+}
+static inline Float4 operator-(const Float4 &a, const Float4 &b) {
+	return {_mm_sub_ps(a.v, b.v)};
+}
+static inline Float4 operator*(const Float4 &a, const Float4 &b) {
+	return {_mm_mul_ps(a.v, b.v)};
+}
+static inline Float4 max(const Float4 &a, const Float4 &b) {
+	return {_mm_max_ps(a.v, b.v)};
+}
+/**
+ * @return @c 1.0 for the lanes where @c a >= @c b - otherwise @c 0.0
+ */
+static inline Float4 greaterEqual(const Float4 &a, const Float4 &b) {
+	return {_mm_and_ps(_mm_cmpge_ps(a.v, b.v), _mm_set1_ps(1.0f))};
+}
+/**
+ * @brief Same rounding as the @c FASTFLOOR macro of Simplex.h - values <= 0 are rounded down by one
+ */
+static inline Float4 fastFloor(const Float4 &a) {
+	const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v));
+	const __m128 below = _mm_and_ps(_mm_cmple_ps(a.v, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+	return {_mm_sub_ps(truncated, below)};
+}
+#elif defined(NOISE_BATCH_NEON)
+static inline Float4 operator+(const Float4 &a, const Float4 &b) {
+	return {vaddq_f32(a.v, b.v)};
+}
+static inline Float4 operator-(const Float4 &a, const Float4 &b) {
+	return {vsubq_f32(a.v, b.v)};
+}
+static inline Float4 operator*(const Float4 &a, const Float4 &b) {
+	return {vmulq_f32(a.v, b.v)};
+}
+static inline Float4 max(const Float4 &a, const Float4 &b) {
+	return {vmaxq_f32(a.v, b.v)};
+}
+static inline Float4 greaterEqual(const Float4 &a, const Float4 &b) {
+	const uint32x4_t one = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+	return {vreinterpretq_f32_u32(vandq_u32(vcgeq_f32(a.v, b.v), one))};
+}
+static inline Float4 fastFloor(const Float4 &a) {
+	const uint32x4_t one = vreinterpretq_u32_f32(vdupq_n_f32(1.0f));
+	const float32x4_t truncated = vcvtq_f32_s32(vcvtq_s32_f32(a.v));
+	const uint32x4_t below = vandq_u32(vcleq_f32(a.v, vdupq_n_f32(0.0f)), one);
+	return {vsubq_f32(truncated, vreinterpretq_f32_u32(below))};
+}
+#else
+static inline Float4 operator+(const Float4 &a, const Float4 &b) {
+	Float4 r;
+	for (int i = 0; i < BatchLanes; ++i) {
+		r.v[i] = a.v[i] + b.v[i];
+	}
+	return r;
+}
+static inline Float4 operator-(const Float4 &a, const Float4 &b) {
+	Float4 r;
+	for (int i = 0; i < BatchLanes; ++i) {
+		r.v[i] = a.v[i] - b.v[i];
+	}
+	return r;
+}
+static inline Float4 operator*(const Float4 &a, const Float4 &b) {
+	Float4 r;
+	for (int i = 0; i < BatchLanes; ++i) {
+		r.v[i] = a.v[i] * b.v[i];
+	}
+	return r;
+}
+static inline Float4 max(const Float4 &a, const Float4 &b) {
+	Float4 r;
+	for (int i = 0; i < BatchLanes; ++i) {
+		r.v[i] = core_max(a.v[i], b.v[i]);
+	}
+	return r;
+}
+static inline Float4 greaterEqual(const Float4 &a, const Float4 &b) {
+	Float4 r;
+	for (int i = 0; i < BatchLanes; ++i) {
+		r.v[i] = a.v[i] >= b.v[i] ? 1.0f : 0.0f;
+	}
+	return r;
+}
+static inline Float4 fastFloor(const Float4 &a) {
+	Float4 r;
+	for (int i = 0; i < BatchLanes; ++i) {
+		r.v[i] = (float)(a.v[i] > 0.0f ? (int)a.v[i] : (int)a.v[i] - 1);
+	}
+	return r;
+}
+#endif
+
+/**
+ * @brief The gradients of @c details::grad() as vectors - the dot products are done on all lanes at once
+ */
+struct Gradients {
+	float grad2[8][2];
+	float grad3[16][3];
+
+	Gradients() {
+		for (int h = 0; h < 8; ++h) {
+			grad2[h][0] = details::grad(h, 1.0f, 0.0f);
+			grad2[h][1] = details::grad(h, 0.0f, 1.0f);
+		}
+		for (int h = 0; h < 16; ++h) {
+			grad3[h][0] = details::grad(h, 1.0f, 0.0f, 0.0f);
+			grad3[h][1] = details::grad(h, 0.0f, 1.0f, 0.0f);
+			grad3[h][2] = details::grad(h, 0.0f, 0.0f, 1.0f);
+		}
+	}
+};
+
+static const Gradients s_gradients;
+
+/**
+ * @brief The 4 lane version of @c noise::noise(const glm::vec2&)
+ */
+static Float4 simplex(const Float4 &x, const Float4 &y, const details::LutType *perm) {
+	const Float4 zero = Float4::set1(0.0f);
+	const Float4 one = Float4::set1(1.0f);
+	const Float4 g2 = Float4::set1(G2);
+
+	// Skew the input space to determine which simplex cell we're in
+	const Float4 s = (x + y) * Float4::set1(F2);
+	const Float4 i = fastFloor(x + s);
+	const Float4 j = fastFloor(y + s);
+	const Float4 t = (i + j) * g2;
+	const Float4 x0 = x - (i - t);
+	const Float4 y0 = y - (j - t);
+
+	// lower triangle for x0 > y0 - upper triangle otherwise
+	const Float4 i1 = one - greaterEqual(y0, x0);
+	const Float4 j1 = one - i1;
+
+	const Float4 x1 = x0 - i1 + g2;
+	const Float4 y1 = y0 - j1 + g2;
+	const Float4 x2 = x0 - one + Float4::set1(2.0f * G2);
+	const Float4 y2 = y0 - one + Float4::set1(2.0f * G2);
+
+	Float4 t0 = max(Float4::set1(0.5f) - x0 * x0 - y0 * y0, zero);
+	Float4 t1 = max(Float4::set1(0.5f) - x1 * x1 - y1 * y1, zero);
+	Float4 t2 = max(Float4::set1(0.5f) - x2 * x2 - y2 * y2, zero);
+	t0 = t0 * t0;
+	t1 = t1 * t1;
+	t2 = t2 * t2;
+
+	// the permutation table lookups can't be done in the registers
+	float li[BatchLanes], lj[BatchLanes], li1[BatchLanes];
+	i.store(li);
+	j.store(lj);
+	i1.store(li1);
+	float g[3][2][BatchLanes];
+	for (int l = 0; l < BatchLanes; ++l) {
+		const int ii = (int)li[l] & 0xff;
+		const int jj = (int)lj[l] & 0xff;
+		const int oi = (int)li1[l];
+		const int oj = 1 - oi;
+		const int h[3] = {perm[ii + perm[jj]] & 7, perm[ii + oi + perm[jj + oj]] & 7,
+						  perm[ii + 1 + perm[jj + 1]] & 7};
+		for (int c = 0; c < 3; ++c) {
+			g[c][0][l] = s_gradients.grad2[h[c]][0];
+			g[c][1][l] = s_gradients.grad2[h[c]][1];
+		}
+	}
+
+	const Float4 n0 = t0 * t0 * (Float4::load(g[0][0]) * x0 + Float4::load(g[0][1]) * y0);
+	const Float4 n1 = t1 * t1 * (Float4::load(g[1][0]) * x1 + Float4::load(g[1][1]) * y1);
+	const Float4 n2 = t2 * t2 * (Float4::load(g[2][0]) * x2 + Float4::load(g[2][1]) * y2);
+	return Float4::set1(40.0f) * (n0 + n1 + n2);
+}
+
+/**
+ * @brief The 4 lane version of @c noise::noise(const glm::vec3&)
+ */
+static Float4 simplex(const Float4 &x, const Float4 &y, const Float4 &z, const details::LutType *perm) {
+	const Float4 zero = Float4::set1(0.0f);
+	const Float4 one = Float4::set1(1.0f);
+	const Float4 g3 = Float4::set1(G3);
+
+	// Skew the input space to determine which simplex cell we're in
+	const Float4 s = (x + y + z) * Float4::set1(F3);
+	const Float4 i = fastFloor(x + s);
+	const Float4 j = fastFloor(y + s);
+	const Float4 k = fastFloor(z + s);
+	const Float4 t = (i + j + k) * g3;
+	const Float4 x0 = x - (i - t);
+	const Float4 y0 = y - (j - t);
+	const Float4 z0 = z - (k - t);
+
+	// the branch free version of the simplex order selection - the products are logical ands, the max is an or
+	const Float4 xy = greaterEqual(x0, y0);
+	const Float4 yz = greaterEqual(y0, z0);
+	const Float4 xz = greaterEqual(x0, z0);
+	const Float4 i1 = xy * xz;
+	const Float4 j1 = (one - xy) * yz;
+	const Float4 k1 = (one - xz) * (one - yz);
+	const Float4 i2 = max(xy, xz);
+	const Float4 j2 = max(one - xy, yz);
+	const Float4 k2 = max(one - xz, one - yz);
+
+	const Float4 x1 = x0 - i1 + g3;
+	const Float4 y1 = y0 - j1 + g3;
+	const Float4 z1 = z0 - k1 + g3;
+	const Float4 x2 = x0 - i2 + Float4::set1(2.0f * G3);
+	const Float4 y2 = y0 - j2 + Float4::set1(2.0f * G3);
+	const Float4 z2 = z0 - k2 + Float4::set1(2.0f * G3);
+	const Float4 x3 = x0 - one + Float4::set1(3.0f * G3);
+	const Float4 y3 = y0 - one + Float4::set1(3.0f * G3);
+	const Float4 z3 = z0 - one + Float4::set1(3.0f * G3);
+
+	const Float4 radius = Float4::set1(0.6f);
+	Float4 t0 = max(radius - x0 * x0 - y0 * y0 - z0 * z0, zero);
+	Float4 t1 = max(radius - x1 * x1 - y1 * y1 - z1 * z1, zero);
+	Float4 t2 = max(radius - x2 * x2 - y2 * y2 - z2 * z2, zero);
+	Float4 t3 = max(radius - x3 * x3 - y3 * y3 - z3 * z3, zero);
+	t0 = t0 * t0;
+	t1 = t1 * t1;
+	t2 = t2 * t2;
+	t3 = t3 * t3;
+
+	// the permutation table lookups can't be done in the registers
+	float li[BatchLanes], lj[BatchLanes], lk[BatchLanes];
+	float lo[6][BatchLanes];
+	i.store(li);
+	j.store(lj);
+	k.store(lk);
+	i1.store(lo[0]);
+	j1.store(lo[1]);
+	k1.store(lo[2]);
+	i2.store(lo[3]);
+	j2.store(lo[4]);
+	k2.store(lo[5]);
+	float g[4][3][BatchLanes];
+	for (int l = 0; l < BatchLanes; ++l) {
+		const int ii = (int)li[l] & 0xff;
+		const int jj = (int)lj[l] & 0xff;
+		const int kk = (int)lk[l] & 0xff;
+		const int oi1 = (int)lo[0][l];
+		const int oj1 = (int)lo[1][l];
+		const int ok1 = (int)lo[2][l];
+		const int oi2 = (int)lo[3][l];
+		const int oj2 = (int)lo[4][l];
+		const int ok2 = (int)lo[5][l];
+		const int h[4] = {perm[ii + perm[jj + perm[kk]]] & 15, perm[ii + oi1 + perm[jj + oj1 + perm[kk + ok1]]] & 15,
+						  perm[ii + oi2 + perm[jj + oj2 + perm[kk + ok2]]] & 15,
+						  perm[ii + 1 + perm[jj + 1 + perm[kk + 1]]] & 15};
+		for (int c = 0; c < 4; ++c) {
+			g[c][0][l] = s_gradients.grad3[h[c]][0];
+			g[c][1][l] = s_gradients.grad3[h[c]][1];
+			g[c][2][l] = s_gradients.grad3[h[c]][2];
+		}
+	}
+
+	const Float4 n0 =
+		t0 * t0 * (Float4::load(g[0][0]) * x0 + Float4::load(g[0][1]) * y0 + Float4::load(g[0][2]) * z0);
+	const Float4 n1 =
+		t1 * t1 * (Float4::load(g[1][0]) * x1 + Float4::load(g[1][1]) * y1 + Float4::load(g[1][2]) * z1);
+	const Float4 n2 =
+		t2 * t2 * (Float4::load(g[2][0]) * x2 + Float4::load(g[2][1]) * y2 + Float4::load(g[2][2]) * z2);
+	const Float4 n3 =
+		t3 * t3 * (Float4::load(g[3][0]) * x3 + Float4::load(g[3][1]) * y3 + Float4::load(g[3][2]) * z3);
+	return Float4::set1(32.0f) * (n0 + n1 + n2 + n3);
+}
+
+/**
+ * @brief The fractal brownian motion parameters - if @c fbm is @c false the plain noise is evaluated
+ */
+struct Octaves {
+	bool fbm = false;
+	uint8_t octaves = 0;
+	float lacunarity = 2.0f;
+	float gain = 0.5f;
+};
+
+/**
+ * @brief The 4 lane version of @c details::fBm_t()
+ */
+template<class... Lanes>
+static Float4 sample(const Octaves &octaves, const details::LutType *perm, const Lanes &...lanes) {
+	if (!octaves.fbm) {
+		return simplex(lanes..., perm);
+	}
+	Float4 sum = Float4::set1(0.0f);
+	float freq = 1.0f;
+	float amp = 0.5f;
+	for (uint8_t i = 0; i < octaves.octaves; ++i) {
+		const Float4 f = Float4::set1(freq);
+		sum = sum + simplex((lanes * f)..., perm) * Float4::set1(amp);
+		freq *= octaves.lacunarity;
+		amp *= octaves.gain;
+	}
+	return sum;
+}
+
+/**
+ * @brief Writes the first @c n lanes to the output buffer
+ */
+static inline void store(const Float4 &v, float *out, size_t n) {
+	if (n >= (size_t)BatchLanes) {
+		v.store(out);
+		return;
+	}
+	float lanes[BatchLanes];
+	v.store(lanes);
+	for (size_t l = 0; l < n; ++l) {
+		out[l] = lanes[l];
+	}
+}
+
+static void points(const glm::vec2 *points, size_t n, float *out, const Octaves &octaves) {
+	const details::LutType *perm = details::perm;
+	float x[BatchLanes], y[BatchLanes];
+	for (size_t i = 0; i < n; i += BatchLanes) {
+		const size_t lanes = core_min(n - i, (size_t)BatchLanes);
+		for (size_t l = 0; l < (size_t)BatchLanes; ++l) {
+			// the unused lanes of the last batch just repeat the last point
+			const glm::vec2 &p = points[i + core_min(l, lanes - 1)];
+			x[l] = p.x;
+			y[l] = p.y;
+		}
+		store(sample(octaves, perm, Float4::load(x), Float4::load(y)), out + i, lanes);
+	}
+}
+
+static void points(const glm::vec3 *points, size_t n, float *out, const Octaves &octaves) {
+	const details::LutType *perm = details::perm;
+	float x[BatchLanes], y[BatchLanes], z[BatchLanes];
+	for (size_t i = 0; i < n; i += BatchLanes) {
+		const size_t lanes = core_min(n - i, (size_t)BatchLanes);
+		for (size_t l = 0; l < (size_t)BatchLanes; ++l) {
+			const glm::vec3 &p = points[i + core_min(l, lanes - 1)];
+			x[l] = p.x;
+			y[l] = p.y;
+			z[l] = p.z;
+		}
+		store(sample(octaves, perm, Float4::load(x), Float4::load(y), Float4::load(z)), out + i, lanes);
+	}
+}
+
+/**
+ * @brief Evaluates one row of a grid along the x axis
+ * @param rest The already scaled y (and z) coordinates of the row
+ */
+template<class... Rest>
+static void row(float *out, int startX, int width, float frequency, const Octaves &octaves,
+				const details::LutType *perm, const Rest &...rest) {
+	const Float4 freq = Float4::set1(frequency);
+	float x[BatchLanes];
+	for (int i = 0; i < width; i += BatchLanes) {
+		for (int l = 0; l < BatchLanes; ++l) {
+			x[l] = (float)(startX + i + l);
+		}
+		store(sample(octaves, perm, Float4::load(x) * freq, rest...), out + i, (size_t)(width - i));
+	}
+}
+
+/**
+ * @brief Distributes the rows over the thread pool - the workers use the permutation table of the calling thread
+ */
+template<class FUNC>
+static void rows(int amount, core::ThreadPool *threadPool, FUNC &&func) {
+	if (threadPool != nullptr && threadPool->size() > 1) {
+		threadPool->parallelFor(0, amount, 1, func);
+	} else {
+		func(0, amount);
+	}
+}
+
+static void grid(float *out, const glm::ivec2 &mins, const glm::ivec2 &dim, float frequency, const Octaves &octaves,
+				 core::ThreadPool *threadPool) {
+	if (dim.x <= 0 || dim.y <= 0) {
+		return;
+	}
+	core_trace_scoped(NoiseGrid2);
+	const details::LutType *perm = details::perm;
+	rows(dim.y, threadPool, [&](int start, int end) {
+		for (int y = start; y < end; ++y) {
+			const Float4 fy = Float4::set1((float)(mins.y + y) * frequency);
+			row(out + (size_t)y * dim.x, mins.x, dim.x, frequency, octaves, perm, fy);
+		}
+	});
+}
+
+static void grid(float *out, const glm::ivec3 &mins, const glm::ivec3 &dim, float frequency, const Octaves &octaves,
+				 core::ThreadPool *threadPool) {
+	if (dim.x <= 0 || dim.y <= 0 || dim.z <= 0) {
+		return;
+	}
+	core_trace_scoped(NoiseGrid3);
+	const details::LutType *perm = details::perm;
+	rows(dim.y * dim.z, threadPool, [&](int start, int end) {
+		for (int r = start; r < end; ++r) {
+			const int y = r % dim.y;
+			const int z = r / dim.y;
+			const Float4 fy = Float4::set1((float)(mins.y + y) * frequency);
+			const Float4 fz = Float4::set1((float)(mins.z + z) * frequency);
+			row(out + (size_t)r * dim.x, mins.x, dim.x, frequency, octaves, perm, fy, fz);
+		}
+	});
+}
+
+} // namespace batch
+
+void noiseBatch(const glm::vec2 *points, size_t n, float *out) {
+	batch::points(points, n, out, batch::Octaves());
+}
+
+void noiseBatch(const glm::vec3 *points, size_t n, float *out) {
+	batch::points(points, n, out, batch::Octaves());
+}
+
+void fBmBatch(const glm::vec2 *points, size_t n, float *out, uint8_t octaves, float lacunarity, float gain) {
+	batch::points(points, n, out, batch::Octaves{true, octaves, lacunarity, gain});
+}
+
+void fBmBatch(const glm::vec3 *points, size_t n, float *out, uint8_t octaves, float lacunarity, float gain) {
+	batch::points(points, n, out, batch::Octaves{true, octaves, lacunarity, gain});
+}
+
+void noiseGrid(float *out, const glm::ivec2 &mins, const glm::ivec2 &dim, float frequency,
+			   core::ThreadPool *threadPool) {
+	batch::grid(out, mins, dim, frequency, batch::Octaves(), threadPool);
+}
+
+void noiseGrid(float *out, const glm::ivec3 &mins, const glm::ivec3 &dim, float frequency,
+			   core::ThreadPool *threadPool) {
+	batch::grid(out, mins, dim, frequency, batch::Octaves(), threadPool);
+}
+
+void fBmGrid(float *out, const glm::ivec2 &mins, const glm::ivec2 &dim, float frequency, uint8_t octaves,
+			 float lacunarity, float gain, core::ThreadPool *threadPool) {
+	batch::grid(out, mins, dim, frequency, batch::Octaves{true, octaves, lacunarity, gain}, threadPool);
+}
+
+void fBmGrid(float *out, const glm::ivec3 &mins, const glm::ivec3 &dim, float frequency, uint8_t octaves,
+			 float lacunarity, float gain, core::ThreadPool *threadPool) {
+	batch::grid(out, mins, dim, frequency, batch::Octaves{true, octaves, lacunarity, gain}, threadPool);
+}
+
+} // namespace noise
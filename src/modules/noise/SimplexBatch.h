@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Batched versions of the 2d and 3d simplex noise functions of @c Simplex.h
+ *
+ * The samples are evaluated in groups of four lanes (SSE2 or NEON - with a scalar fallback). The results are the same
+ * as calling @c noise::noise() or @c noise::fBm() for each sample - up to float rounding. The scalar versions skew
+ * the coordinates in double precision. For samples exactly on a simplex cell boundary the two versions can pick
+ * different cells - and as the 3d noise is not perfectly continuous there, such samples can differ by a few
+ * thousandths.
+ */
+
+#pragma once
+
+#include <glm/fwd.hpp>
+#include <stddef.h>
+#include <stdint.h>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace noise {
+
+/**
+ * @brief The amount of samples that are evaluated at once
+ */
+static constexpr int BatchLanes = 4;
+
+/**
+ * @brief Evaluates the 2d simplex noise for @c n points and writes the values to @c out
+ */
+void noiseBatch(const glm::vec2 *points, size_t n, float *out);
+/**
+ * @brief Evaluates the 3d simplex noise for @c n points and writes the values to @c out
+ */
+void noiseBatch(const glm::vec3 *points, size_t n, float *out);
+
+/**
+ * @brief Evaluates the 2d simplex noise fractal brownian motion sum for @c n points and writes the values to @c out
+ */
+void fBmBatch(const glm::vec2 *points, size_t n, float *out, uint8_t octaves = 4, float lacunarity = 2.0f,
+			  float gain = 0.5f);
+/**
+ * @brief Evaluates the 3d simplex noise fractal brownian motion sum for @c n points and writes the values to @c out
+ */
+void fBmBatch(const glm::vec3 *points, size_t n, float *out, uint8_t octaves = 4, float lacunarity = 2.0f,
+			  float gain = 0.5f);
+
+/**
+ * @brief Fills the buffer with the 2d simplex noise of a regular grid
+ *
+ * @code out[x + y * dim.x] = noise(glm::vec2(mins.x + x, mins.y + y) * frequency) @endcode
+ *
+ * @param[out] out must be of size @c dim.x * dim.y
+ * @param threadPool if given, the rows of the grid are distributed over the threads of the pool
+ */
+void noiseGrid(float *out, const glm::ivec2 &mins, const glm::ivec2 &dim, float frequency = 1.0f,
+			   core::ThreadPool *threadPool = nullptr);
+/**
+ * @brief Fills the buffer with the 3d simplex noise of a regular grid
+ *
+ * @code out[x + y * dim.x + z * dim.x * dim.y] = noise(glm::vec3(mins.x + x, mins.y + y, mins.z + z) * frequency) @endcode
+ *
+ * @param[out] out must be of size @c dim.x * dim.y * dim.z
+ * @param threadPool if given, the rows of the grid are distributed over the threads of the pool
+ */
+void noiseGrid(float *out, const glm::ivec3 &mins, const glm::ivec3 &dim, float frequency = 1.0f,
+			   core::ThreadPool *threadPool = nullptr);
+
+/**
+ * @brief Same as noiseGrid() - but with the fractal brownian motion sum of the noise
+ * @sa noise::fBm()
+ */
+void fBmGrid(float *out, const glm::ivec2 &mins, const glm::ivec2 &dim, float frequency = 1.0f, uint8_t octaves = 4,
+			 float lacunarity = 2.0f, float gain = 0.5f, core::ThreadPool *threadPool = nullptr);
+/**
+ * @brief Same as noiseGrid() - but with the fractal brownian motion sum of the noise
+ * @sa noise::fBm()
+ */
+void fBmGrid(float *out, const glm::ivec3 &mins, const glm::ivec3 &dim, float frequency = 1.0f, uint8_t octaves = 4,
+			 float lacunarity = 2.0f, float gain = 0.5f, core::ThreadPool *threadPool = nullptr);
+
+} // namespace noise
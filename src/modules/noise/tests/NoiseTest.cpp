@@ -5,9 +5,14 @@
 #include "app/tests/AbstractTest.h"
 #include "io/FileStream.h"
 #include "noise/Noise.h"
+#include "noise/Simplex.h"
+#include "noise/SimplexBatch.h"
 #include "image/Image.h"
 #include "core/GLM.h"
 #include "core/StringUtil.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
+#include <random>
 
 namespace noise {
 
@@ -38,10 +43,103 @@ protected:
 		EXPECT_TRUE(image::Image::writePng(stream, buffer, width, height, components));
 		noise.shutdown();
 	}
+
+	template<class VEC>
+	core::DynamicArray<VEC> randomPoints(size_t n) {
+		std::mt19937 gen(42);
+		std::uniform_real_distribution<float> distribution(-100.0f, 100.0f);
+		core::DynamicArray<VEC> points;
+		points.resize(n);
+		for (size_t i = 0; i < n; ++i) {
+			for (int c = 0; c < VEC::length(); ++c) {
+				points[i][c] = distribution(gen);
+			}
+		}
+		return points;
+	}
 };
 
 TEST_F(NoiseTest, testSeamlessNoise) {
 	seamlessNoise();
 }
 
+TEST_F(NoiseTest, testNoiseBatch2) {
+	// not a multiple of the lanes to also check the remaining points
+	const core::DynamicArray<glm::vec2> &points = randomPoints<glm::vec2>(1001);
+	core::DynamicArray<float> values;
+	values.resize(points.size());
+	noiseBatch(points.data(), points.size(), values.data());
+	for (size_t i = 0; i < points.size(); ++i) {
+		ASSERT_NEAR(noise::noise(points[i]), values[i], 0.0001f) << "point " << i;
+	}
+}
+
+TEST_F(NoiseTest, testNoiseBatch3) {
+	const core::DynamicArray<glm::vec3> &points = randomPoints<glm::vec3>(1001);
+	core::DynamicArray<float> values;
+	values.resize(points.size());
+	noiseBatch(points.data(), points.size(), values.data());
+	for (size_t i = 0; i < points.size(); ++i) {
+		ASSERT_NEAR(noise::noise(points[i]), values[i], 0.0001f) << "point " << i;
+	}
+}
+
+TEST_F(NoiseTest, testFBmBatch) {
+	const core::DynamicArray<glm::vec3> &points = randomPoints<glm::vec3>(257);
+	core::DynamicArray<float> values;
+	values.resize(points.size());
+	fBmBatch(points.data(), points.size(), values.data(), 5, 2.0f, 0.6f);
+	for (size_t i = 0; i < points.size(); ++i) {
+		ASSERT_NEAR(noise::fBm(points[i], 5, 2.0f, 0.6f), values[i], 0.0001f) << "point " << i;
+	}
+}
+
+TEST_F(NoiseTest, testNoiseGrid2) {
+	const glm::ivec2 mins(-13, 7);
+	const glm::ivec2 dim(37, 11);
+	const float frequency = 0.05f;
+	core::DynamicArray<float> values;
+	values.resize(dim.x * dim.y);
+	fBmGrid(values.data(), mins, dim, frequency, 3);
+	for (int y = 0; y < dim.y; ++y) {
+		for (int x = 0; x < dim.x; ++x) {
+			const glm::vec2 pos(mins.x + x, mins.y + y);
+			ASSERT_NEAR(noise::fBm(pos * frequency, 3), values[x + y * dim.x], 0.0001f) << x << ":" << y;
+		}
+	}
+}
+
+TEST_F(NoiseTest, testNoiseGrid3Parallel) {
+	const glm::ivec3 mins(-20, -3, 5);
+	const glm::ivec3 dim(33, 17, 9);
+	const float frequency = 0.1f;
+	core::DynamicArray<float> serial;
+	serial.resize(dim.x * dim.y * dim.z);
+	core::DynamicArray<float> parallel;
+	parallel.resize(serial.size());
+	core::ThreadPool pool(4);
+	pool.init();
+	noiseGrid(serial.data(), mins, dim, frequency);
+	noiseGrid(parallel.data(), mins, dim, frequency, &pool);
+	pool.shutdown();
+	// the grid positions hit the simplex cell boundaries - there the float and double precision of the scalar
+	// version can pick different cells
+	int mismatches = 0;
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			for (int x = 0; x < dim.x; ++x) {
+				const int idx = x + y * dim.x + z * dim.x * dim.y;
+				const glm::vec3 pos(mins.x + x, mins.y + y, mins.z + z);
+				const float expected = noise::noise(pos * frequency);
+				ASSERT_NEAR(expected, serial[idx], 0.01f) << x << ":" << y << ":" << z;
+				if (glm::abs(expected - serial[idx]) > 0.0001f) {
+					++mismatches;
+				}
+				ASSERT_FLOAT_EQ(serial[idx], parallel[idx]) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+	EXPECT_LT(mismatches, (int)serial.size() / 100);
+}
+
 }
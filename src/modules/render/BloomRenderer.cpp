@@ -3,18 +3,13 @@
  */
 
 #include "BloomRenderer.h"
-#include "ConvolutionShaderConstants.h"
-#include "ConvolutionShader.h"
-#include "TextureShader.h"
+#include "core/Common.h"
+#include "core/GameConfig.h"
 #include "core/Log.h"
-#include "core/ArrayLength.h"
-#include "video/Camera.h"
 #include "video/FrameBufferConfig.h"
 #include "video/Renderer.h"
 #include "video/ScopedBlendMode.h"
-#include "video/ScopedFrameBuffer.h"
 #include "video/ScopedState.h"
-#include "video/ScopedViewPort.h"
 #include "video/Shader.h"
 #include "video/Texture.h"
 #include "video/Types.h"
@@ -22,13 +17,22 @@
 namespace render {
 
 BloomRenderer::BloomRenderer()
-	: _convolutionShader(shader::ConvolutionShader::getInstance()),
+	: _downsampleShader(shader::BloomdownsampleShader::getInstance()),
+	  _upsampleShader(shader::BloomupsampleShader::getInstance()),
 	  _textureShader(shader::TextureShader::getInstance()), _combine2Shader(shader::Combine2Shader::getInstance()) {
 }
 
 bool BloomRenderer::init(bool yFlipped, int width, int height) {
-	if (!_convolutionShader.setup()) {
-		Log::error("Failed to init the convolution shader");
+	_levelsVar = core::Var::get(cfg::ClientBloomLevels, "5", "The amount of downsampled levels of the bloom",
+								core::Var::minMaxValidator<1, MaxLevels>);
+	_quality = core::Var::get(cfg::ClientBloomQuality, "1", "1 for the wide bloom filters, 0 for slow gpus",
+							  core::Var::minMaxValidator<0, 1>);
+	if (!_downsampleShader.setup()) {
+		Log::error("Failed to init the bloom downsample shader");
+		return false;
+	}
+	if (!_upsampleShader.setup()) {
+		Log::error("Failed to init the bloom upsample shader");
 		return false;
 	}
 	if (!_textureShader.setup()) {
@@ -42,120 +46,89 @@ bool BloomRenderer::init(bool yFlipped, int width, int height) {
 
 	resize(width, height);
 
-	_black = video::createEmptyTexture("**black**");
 	_yFlipped = yFlipped;
 	_bufferIndex = _vbo.createFullscreenQuad();
 	_texBufferIndex = _vbo.create();
 
-	core_assert_always(_convolutionData.create(_convolutionFragData));
-
-	core_assert(_convolutionShader.getLocationPos() == _textureShader.getLocationPos());
-	core_assert(_convolutionShader.getLocationTexcoord() == _textureShader.getLocationTexcoord());
-	core_assert(_convolutionShader.getLocationPos() == _combine2Shader.getLocationPos());
-	core_assert(_convolutionShader.getLocationTexcoord() == _combine2Shader.getLocationTexcoord());
+	core_assert(_downsampleShader.getLocationPos() == _textureShader.getLocationPos());
+	core_assert(_downsampleShader.getLocationTexcoord() == _textureShader.getLocationTexcoord());
+	core_assert(_downsampleShader.getLocationPos() == _upsampleShader.getLocationPos());
+	core_assert(_downsampleShader.getLocationTexcoord() == _upsampleShader.getLocationTexcoord());
+	core_assert(_downsampleShader.getLocationPos() == _combine2Shader.getLocationPos());
+	core_assert(_downsampleShader.getLocationTexcoord() == _combine2Shader.getLocationTexcoord());
 	core_assert_always(_vbo.addAttribute(_combine2Shader.getPosAttribute(_bufferIndex, &glm::vec2::x)));
 	core_assert_always(_vbo.addAttribute(_combine2Shader.getTexcoordAttribute(_texBufferIndex, &glm::vec2::x)));
 	return true;
 }
 
 bool BloomRenderer::resize(int width, int height) {
-	video::TextureConfig tcfg = video::createDefaultTextureConfig();
-	tcfg.filterMin(video::TextureFilter::Nearest);
-	tcfg.filterMag(video::TextureFilter::Linear);
-	tcfg.borderColor(glm::vec4(0.0f));
-
-	video::FrameBufferConfig bloomCfg;
-	bloomCfg.dimension(glm::ivec2(width, height));
-	bloomCfg.addTextureAttachment(tcfg, video::FrameBufferAttachment::Color0);
-
-	for (int i = 0; i < lengthof(_bloom); ++i) {
-		if (!_bloom[i].init(bloomCfg)) {
-			Log::error("Failed to init the bloom framebuffer %i", i);
-			return false;
-		}
+	_width = width;
+	_height = height;
+	for (int i = 0; i < _levels; ++i) {
+		_mips[i].shutdown();
 	}
+	_levels = _levelsVar->intVal();
+	_levelsVar->markClean();
+
+	video::TextureConfig tcfg = video::createDefaultTextureConfig();
+	// the filters rely on the bilinear filtering of the samples
+	tcfg.filter(video::TextureFilter::Linear);
 
-	for (int i = 0; i < passes(); ++i) {
-		const int h = height / (1 << (i + 1));
-		const int w = width / (1 << (i + 1));
+	for (int i = 0; i < _levels; ++i) {
+		const int w = core_max(1, width >> (i + 1));
+		const int h = core_max(1, height >> (i + 1));
 		video::FrameBufferConfig cfg;
 		cfg.dimension(glm::ivec2(w, h));
 		cfg.addTextureAttachment(tcfg, video::FrameBufferAttachment::Color0);
-		_frameBuffers0[i].shutdown();
-		_frameBuffers1[i].shutdown();
-		_frameBuffers2[i].shutdown();
-		if (!_frameBuffers0[i].init(cfg) || !_frameBuffers1[i].init(cfg) || !_frameBuffers2[i].init(cfg)) {
-			Log::error("Failed to init the downsampling framebuffer %i", i);
+		if (!_mips[i].init(cfg)) {
+			Log::error("Failed to init the bloom framebuffer %i", i);
 			return false;
 		}
 	}
 	return true;
 }
 
-void BloomRenderer::blur(const video::TexturePtr &source, video::FrameBuffer &dest, bool horizontal) {
-	constexpr int filterSize = shader::ConvolutionShaderConstants::getFilterSize();
-	const float halfWidth = (float)(filterSize - 1) * 0.5f;
-	const float offset = 1.2f / (float)source->width();
-	const float x = horizontal ? offset : 0.0f;
-	{
-		const float y0 = (float)0.0f - halfWidth;
-		const float z0 = x * y0;
-		_convolutionFragData.offsets0.x = offset * y0 - z0;
-		_convolutionFragData.offsets0.y = z0;
-	}
-	{
-		const float y1 = (float)1.0f - halfWidth;
-		const float z1 = x * y1;
-		_convolutionFragData.offsets1.x = offset * y1 - z1;
-		_convolutionFragData.offsets1.y = z1;
-	}
-	{
-		const float y2 = (float)2.0f - halfWidth;
-		const float z2 = x * y2;
-		_convolutionFragData.offsets2.x = offset * y2 - z2;
-		_convolutionFragData.offsets2.y = z2;
-	}
-	_convolutionFragData.coefficients0 = 0.25f;
-	_convolutionFragData.coefficients1 = 0.5f;
-	_convolutionFragData.coefficients2 = 0.25f;
-	core_assert_always(_convolutionData.update(_convolutionFragData));
-	core_assert_always(_convolutionShader.setConv(_convolutionData.getConvUniformBuffer()));
-	core_assert_always(video::bindTexture(video::TextureUnit::Zero, source));
+void BloomRenderer::downsample(const video::TexturePtr &source, video::FrameBuffer &dest, bool highQuality) {
 	dest.bind(true);
-	video::viewport(0, 0, source->width(), source->height());
-	video::drawArrays(video::Primitive::Triangles, 6);
+	if (highQuality) {
+		video::ScopedShader scoped(_downsampleShader);
+		core_assert_always(_downsampleShader.setTexture(video::TextureUnit::Zero));
+		core_assert_always(video::bindTexture(video::TextureUnit::Zero, source));
+		video::drawArrays(video::Primitive::Triangles, 6);
+	} else {
+		// the bilinear filtering averages 2x2 texels in one sample
+		video::ScopedShader scoped(_textureShader);
+		core_assert_always(_textureShader.setTexture(video::TextureUnit::Zero));
+		core_assert_always(video::bindTexture(video::TextureUnit::Zero, source));
+		video::drawArrays(video::Primitive::Triangles, 6);
+	}
 }
 
-void BloomRenderer::apply(video::FrameBuffer *sources, video::FrameBuffer *dests) {
-	for (int i = 0; i < passes(); i++) {
-		const int l = passes() - i - 1;
-		{
-			video::ScopedShader scoped(_combine2Shader);
-			dests[l].bind(true);
-			core_assert_always(_combine2Shader.setTexture0(video::TextureUnit::Zero));
-			core_assert_always(_combine2Shader.setTexture1(video::TextureUnit::One));
-			const video::TexturePtr &srcTex = sources[l].texture();
-			if (i != 0) {
-				const video::TexturePtr &destTex = dests[l + 1].texture();
-				core_assert_always(video::bindTexture(video::TextureUnit::One, destTex));
-			} else {
-				core_assert_always(video::bindTexture(video::TextureUnit::One, _black));
-			}
-			core_assert_always(video::bindTexture(video::TextureUnit::Zero, srcTex));
-			video::drawArrays(video::Primitive::Triangles, 6);
-		}
-		{
-			video::ScopedShader scoped(_convolutionShader);
-			blur(dests[l].texture(), sources[l], true);
-			blur(sources[l].texture(), dests[l], false);
-		}
+void BloomRenderer::upsample(const video::TexturePtr &source, bool highQuality) {
+	if (highQuality) {
+		video::ScopedShader scoped(_upsampleShader);
+		core_assert_always(_upsampleShader.setTexture(video::TextureUnit::Zero));
+		core_assert_always(video::bindTexture(video::TextureUnit::Zero, source));
+		video::drawArrays(video::Primitive::Triangles, 6);
+	} else {
+		video::ScopedShader scoped(_textureShader);
+		core_assert_always(_textureShader.setTexture(video::TextureUnit::Zero));
+		core_assert_always(video::bindTexture(video::TextureUnit::Zero, source));
+		video::drawArrays(video::Primitive::Triangles, 6);
 	}
 }
 
 void BloomRenderer::render(const video::TexturePtr& srcTexture, const video::TexturePtr& glowTexture) {
+	if (_levelsVar->isDirty()) {
+		resize(_width, _height);
+	}
+	if (_levels <= 0) {
+		return;
+	}
 	video::ScopedState depthTest(video::State::DepthTest, false);
 	video::ScopedState scissor(video::State::Scissor, false);
-	video::ScopedBlendMode blendMode(video::BlendMode::One, video::BlendMode::OneMinusSourceAlpha);
+	video::ScopedState blend(video::State::Blend, false);
+	const bool highQuality = _quality->intVal() != 0;
 
 	// backup the current state
 	video::Id oldFB = video::currentFramebuffer();
@@ -163,104 +136,66 @@ void BloomRenderer::render(const video::TexturePtr& srcTexture, const video::Tex
 	video::getViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 
 	_vbo.createFullscreenTextureBufferYFlipped(_texBufferIndex);
+	core_assert_always(_vbo.bind());
 
-	{
-		video::ScopedShader scoped(_convolutionShader);
-		core_assert_always(_convolutionShader.setImage(video::TextureUnit::Zero));
-		core_assert_always(_vbo.bind());
-		blur(glowTexture, _bloom[0], false);
-		blur(_bloom[0].texture(), _bloom[1], true);
+	// the first level is of half the resolution of the glow texture
+	downsample(glowTexture, _mips[0], highQuality);
+	for (int i = 1; i < _levels; ++i) {
+		downsample(_mips[i - 1].texture(), _mips[i], highQuality);
 	}
 
-	// prepare the first source buffer by rendering the glow texture into it.
 	{
-		video::ScopedShader scoped(_textureShader);
-		core_assert_always(_textureShader.setTexture(video::TextureUnit::Zero));
-		_frameBuffers0[0].bind(true);
-		video::bindTexture(video::TextureUnit::Zero, _bloom[1].texture());
-		video::drawArrays(video::Primitive::Triangles, 6);
-	}
-
-	for (int i = 1; i < passes(); ++i) {
-		{
-			video::ScopedShader scoped(_convolutionShader);
-			blur(_frameBuffers0[i - 1].texture(), _frameBuffers1[i - 1], false);
-			blur(_frameBuffers1[i - 1].texture(), _frameBuffers2[i - 1], true);
-		}
-		{
-			video::ScopedShader scoped(_textureShader);
-			// blit into the next source buffer
-			_frameBuffers0[i].bind(true);
-			// use the texture from the final blur stage
-			const video::TexturePtr &blurTex = _frameBuffers2[i - 1].texture();
-			core_assert_always(video::bindTexture(video::TextureUnit::Zero, blurTex));
-			video::drawArrays(video::Primitive::Triangles, 6);
+		// add each level to the next bigger one
+		video::ScopedState additive(video::State::Blend, true);
+		video::ScopedBlendMode blendMode(video::BlendMode::One, video::BlendMode::One);
+		for (int i = _levels - 1; i > 0; --i) {
+			_mips[i - 1].bind(false);
+			upsample(_mips[i].texture(), highQuality);
 		}
 	}
 
-	apply(_frameBuffers0, _frameBuffers1);
-
-	{
-		video::ScopedShader scoped(_combine2Shader);
-		_bloom[0].bind(true);
-		video::bindTexture(video::TextureUnit::Zero, glowTexture);
-		video::bindTexture(video::TextureUnit::One, _frameBuffers1[0].texture());
-		video::drawArrays(video::Primitive::Triangles, 6);
+	if (!_yFlipped) {
+		_vbo.unbind();
+		_vbo.createFullscreenTextureBuffer(_texBufferIndex);
+		core_assert_always(_vbo.bind());
 	}
-
+	// restore previous fbo and viewport
+	video::bindFramebuffer(oldFB);
+	video::viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 	{
-		if (!_yFlipped) {
-			_vbo.unbind();
-			_vbo.createFullscreenTextureBuffer(_texBufferIndex);
-			_vbo.bind();
-		}
-		// restore previous fbo and viewport
-		video::bindFramebuffer(oldFB);
-		video::viewport(viewport[0], viewport[1], viewport[2], viewport[3]);
 		video::ScopedShader scoped(_combine2Shader);
+		core_assert_always(_combine2Shader.setTexture0(video::TextureUnit::Zero));
+		core_assert_always(_combine2Shader.setTexture1(video::TextureUnit::One));
 		video::bindTexture(video::TextureUnit::Zero, srcTexture);
-		video::bindTexture(video::TextureUnit::One, _bloom[0].texture());
+		video::bindTexture(video::TextureUnit::One, glowTexture);
 		video::drawArrays(video::Primitive::Triangles, 6);
-		_vbo.unbind();
 	}
+	{
+		video::ScopedState additive(video::State::Blend, true);
+		video::ScopedBlendMode blendMode(video::BlendMode::One, video::BlendMode::One);
+		upsample(_mips[0].texture(), highQuality);
+	}
+	_vbo.unbind();
 }
 
 video::TexturePtr BloomRenderer::texture() const {
-	return texture1(0);
-}
-
-video::TexturePtr BloomRenderer::texture0(int pass) const {
-	core_assert(pass >= 0 && pass < passes());
-	return _frameBuffers0[pass].texture(video::FrameBufferAttachment::Color0);
+	return texture(0);
 }
 
-video::TexturePtr BloomRenderer::texture1(int pass) const {
-	core_assert(pass >= 0 && pass < passes());
-	return _frameBuffers1[pass].texture(video::FrameBufferAttachment::Color0);
-}
-
-video::TexturePtr BloomRenderer::texture2(int pass) const {
-	core_assert(pass >= 0 && pass < passes());
-	return _frameBuffers2[pass].texture(video::FrameBufferAttachment::Color0);
+video::TexturePtr BloomRenderer::texture(int level) const {
+	core_assert(level >= 0 && level < _levels);
+	return _mips[level].texture(video::FrameBufferAttachment::Color0);
 }
 
 void BloomRenderer::shutdown() {
-	for (int i = 0; i < passes(); ++i) {
-		_frameBuffers0[i].shutdown();
-		_frameBuffers1[i].shutdown();
-		_frameBuffers2[i].shutdown();
-	}
-	for (int i = 0; i < lengthof(_bloom); ++i) {
-		_bloom[i].shutdown();
+	for (int i = 0; i < _levels; ++i) {
+		_mips[i].shutdown();
 	}
-	_convolutionData.shutdown();
-	_convolutionShader.shutdown();
+	_levels = 0;
+	_downsampleShader.shutdown();
+	_upsampleShader.shutdown();
 	_textureShader.shutdown();
 	_combine2Shader.shutdown();
-	if (_black) {
-		_black->shutdown();
-		_black = video::TexturePtr();
-	}
 	_vbo.shutdown();
 }
 
@@ -4,10 +4,11 @@
 
 #pragma once
 
-#include "ConvolutionData.h"
-#include "ConvolutionShader.h"
+#include "BloomdownsampleShader.h"
+#include "BloomupsampleShader.h"
 #include "Combine2Shader.h"
 #include "TextureShader.h"
+#include "core/Var.h"
 #include "video/Buffer.h"
 #include "video/Camera.h"
 #include "video/FrameBuffer.h"
@@ -18,30 +19,38 @@
 
 namespace render {
 
-#define DOWNSAMPLE_PASSES 5
-
 /**
- * @brief Renders a textures with the shader::BlurShader
+ * @brief Blurs the glow texture in a chain of downsampled framebuffers and adds the result to the scene
+ *
+ * The glow texture is downsampled into levels of half, quarter, ... of the resolution. Afterwards the levels are
+ * upsampled again and each of them is added to the next bigger one. Even the biggest level is only of half the
+ * framebuffer resolution.
+ *
+ * The amount of levels is configured by @c cfg::ClientBloomLevels - @c cfg::ClientBloomQuality switches between
+ * the 13 tap downsample and 3x3 tent upsample filters and single bilinear taps for slow gpus.
  */
 class BloomRenderer : public core::NonCopyable {
+public:
+	static constexpr int MaxLevels = 8;
+
 private:
-	alignas(16) shader::ConvolutionData::ConvData _convolutionFragData;
-	shader::ConvolutionData _convolutionData;
-	shader::ConvolutionShader &_convolutionShader;
+	shader::BloomdownsampleShader &_downsampleShader;
+	shader::BloomupsampleShader &_upsampleShader;
 	shader::TextureShader &_textureShader;
 	shader::Combine2Shader &_combine2Shader;
 	video::Buffer _vbo;
 	int _bufferIndex = -1;
 	int _texBufferIndex = -1;
 	bool _yFlipped = false;
-	video::FrameBuffer _bloom[2];
-	video::FrameBuffer _frameBuffers0[DOWNSAMPLE_PASSES];
-	video::FrameBuffer _frameBuffers1[DOWNSAMPLE_PASSES];
-	video::FrameBuffer _frameBuffers2[DOWNSAMPLE_PASSES];
-	video::TexturePtr _black;
+	int _width = 0;
+	int _height = 0;
+	int _levels = 0;
+	video::FrameBuffer _mips[MaxLevels];
+	core::VarPtr _levelsVar;
+	core::VarPtr _quality;
 
-	void apply(video::FrameBuffer *sources, video::FrameBuffer *dests);
-	void blur(const video::TexturePtr &source, video::FrameBuffer &dest, bool horizontal);
+	void downsample(const video::TexturePtr &source, video::FrameBuffer &dest, bool highQuality);
+	void upsample(const video::TexturePtr &source, bool highQuality);
 
 public:
 	BloomRenderer();
@@ -52,7 +61,10 @@ public:
 
 	bool resize(int width, int height);
 
-	static constexpr int passes() { return DOWNSAMPLE_PASSES; }
+	/**
+	 * @return The amount of downsampled levels of the mip chain
+	 */
+	int levels() const;
 
 	/**
 	 * @sa init()
@@ -63,17 +75,22 @@ public:
 	 * @param srcTexture The video::TexturePtr of the original texture
 	 * @param glowTexture The video::TexturePtr of the glow texture that should get blurred and combined with
 	 * the original texture
-	 * @note The result is put into a texture that can get queried to continue to use it
+	 * @note The result is rendered into the currently bound framebuffer
 	 * @see texture()
 	 */
 	void render(const video::TexturePtr& srcTexture, const video::TexturePtr& glowTexture);
 	/**
-	 * @return video::TexturePtr of the render() pass
+	 * @return video::TexturePtr with the blurred glow of the render() pass
 	 */
 	video::TexturePtr texture() const;
-	video::TexturePtr texture0(int pass) const;
-	video::TexturePtr texture1(int pass) const;
-	video::TexturePtr texture2(int pass) const;
+	/**
+	 * @return video::TexturePtr of the given mip chain level
+	 */
+	video::TexturePtr texture(int level) const;
 };
 
+inline int BloomRenderer::levels() const {
+	return _levels;
+}
+
 } // namespace render
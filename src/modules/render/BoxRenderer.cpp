@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "BoxRenderer.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "video/Camera.h"
+#include "video/Renderer.h"
+
+namespace render {
+
+bool BoxRenderer::init() {
+	if (!_boxShader.setup()) {
+		Log::error("Failed to initialize the box shader");
+		return false;
+	}
+	_uniformBlock.create(_uniformBlockData);
+
+	const Vertex vertices[8] = {
+		{glm::vec3(0.0f, 0.0f, 0.0f)}, {glm::vec3(1.0f, 0.0f, 0.0f)}, {glm::vec3(1.0f, 1.0f, 0.0f)},
+		{glm::vec3(0.0f, 1.0f, 0.0f)}, {glm::vec3(0.0f, 0.0f, 1.0f)}, {glm::vec3(1.0f, 0.0f, 1.0f)},
+		{glm::vec3(1.0f, 1.0f, 1.0f)}, {glm::vec3(0.0f, 1.0f, 1.0f)}};
+	// the twelve edges of the cube
+	const uint32_t indices[CubeIndices] = {0, 1, 1, 2, 2, 3, 3, 0, 4, 5, 5, 6, 6, 7, 7, 4, 0, 4, 1, 5, 2, 6, 3, 7};
+
+	const int32_t vertexIndex = _vbo.create(vertices, sizeof(vertices));
+	if (vertexIndex == -1) {
+		Log::error("Could not create vbo for the box vertices");
+		return false;
+	}
+	if (_vbo.create(indices, sizeof(indices), video::BufferType::IndexBuffer) == -1) {
+		Log::error("Could not create vbo for the box indices");
+		return false;
+	}
+	_instanceIndex = _vbo.create();
+	if (_instanceIndex == -1) {
+		Log::error("Could not create vbo for the box instances");
+		return false;
+	}
+	_vbo.setMode(_instanceIndex, video::BufferMode::Dynamic);
+	core_assert_always(_vbo.addAttribute(_boxShader.getPosAttribute(vertexIndex, &Vertex::pos)));
+	video::Attribute attributeMins = _boxShader.getMinsAttribute(_instanceIndex, &Instance::mins);
+	attributeMins.divisor = 1;
+	core_assert_always(_vbo.addAttribute(attributeMins));
+	video::Attribute attributeMaxs = _boxShader.getMaxsAttribute(_instanceIndex, &Instance::maxs);
+	attributeMaxs.divisor = 1;
+	core_assert_always(_vbo.addAttribute(attributeMaxs));
+	return true;
+}
+
+void BoxRenderer::shutdown() {
+	_vbo.shutdown();
+	_instanceIndex = -1;
+	_uniformBlock.shutdown();
+	_boxShader.shutdown();
+	_instances.clear();
+	_dirty = false;
+}
+
+void BoxRenderer::clear() {
+	_instances.clear();
+	_dirty = true;
+}
+
+void BoxRenderer::add(const glm::vec3 &mins, const glm::vec3 &maxs) {
+	_instances.push_back(Instance{mins, maxs});
+	_dirty = true;
+}
+
+void BoxRenderer::render(const video::Camera &camera, const glm::mat4 &model) {
+	if (_instances.empty() || _instanceIndex == -1) {
+		return;
+	}
+	core_trace_scoped(BoxRendererRender);
+	if (_dirty) {
+		core_assert_always(_vbo.update(_instanceIndex, _instances.data(), _instances.size() * sizeof(Instance)));
+		_dirty = false;
+	}
+	_uniformBlockData.viewprojection = camera.viewProjectionMatrix();
+	_uniformBlockData.model = model;
+	_uniformBlockData.color = _color;
+	core_assert_always(_uniformBlock.update(_uniformBlockData));
+
+	video::ScopedShader scoped(_boxShader);
+	core_assert_always(_boxShader.setUniformblock(_uniformBlock.getUniformblockUniformBuffer()));
+	video::ScopedBuffer scopedBuf(_vbo);
+	video::drawElementsInstanced<uint32_t>(video::Primitive::Lines, CubeIndices, (int)_instances.size());
+}
+
+} // namespace render
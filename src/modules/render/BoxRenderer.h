@@ -0,0 +1,70 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "BoxShader.h"
+#include "core/IComponent.h"
+#include "core/collection/DynamicArray.h"
+#include "video/Buffer.h"
+#include <glm/vec3.hpp>
+#include <glm/vec4.hpp>
+
+namespace video {
+class Camera;
+}
+
+namespace render {
+
+/**
+ * @brief Renders the outlines of many axis aligned boxes with one instanced draw call
+ *
+ * The edges of a unit cube are uploaded once and every box is an instance that only consists of its min and max
+ * corner. Changing the boxes is a small buffer write instead of rebuilding the line geometry of every box.
+ */
+class BoxRenderer : public core::IComponent {
+private:
+	struct Vertex {
+		glm::vec3 pos;
+	};
+	struct Instance {
+		glm::vec3 mins;
+		glm::vec3 maxs;
+	};
+	static constexpr uint32_t CubeIndices = 24u;
+
+	shader::BoxShader _boxShader;
+	alignas(16) shader::BoxData::UniformblockData _uniformBlockData;
+	shader::BoxData _uniformBlock;
+	video::Buffer _vbo;
+	int32_t _instanceIndex = -1;
+	core::DynamicArray<Instance> _instances;
+	glm::vec4 _color{1.0f};
+	/** the instances must be uploaded before the next draw */
+	bool _dirty = false;
+
+public:
+	bool init() override;
+	void shutdown() override;
+
+	void setColor(const glm::vec4 &color);
+	/**
+	 * @brief Removes all boxes
+	 */
+	void clear();
+	void add(const glm::vec3 &mins, const glm::vec3 &maxs);
+	size_t size() const;
+
+	void render(const video::Camera &camera, const glm::mat4 &model = glm::mat4(1.0f));
+};
+
+inline void BoxRenderer::setColor(const glm::vec4 &color) {
+	_color = color;
+}
+
+inline size_t BoxRenderer::size() const {
+	return _instances.size();
+}
+
+} // namespace render
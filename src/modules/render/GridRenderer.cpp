@@ -3,17 +3,21 @@
  */
 
 #include "GridRenderer.h"
+#include "core/Color.h"
 #include "core/Trace.h"
 #include "math/AABB.h"
-#include "math/Plane.h"
 #include "core/Log.h"
 #include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
 #include "video/Camera.h"
+#include "video/Renderer.h"
+#include "video/ScopedState.h"
+#include <glm/gtc/matrix_transform.hpp>
 
 namespace render {
 
 GridRenderer::GridRenderer(bool renderAABB, bool renderGrid) :
-		_renderAABB(renderAABB), _renderGrid(renderGrid) {
+		_gridShader(shader::GridShader::getInstance()), _renderAABB(renderAABB), _renderGrid(renderGrid) {
 }
 
 bool GridRenderer::init() {
@@ -21,6 +25,79 @@ bool GridRenderer::init() {
 		Log::error("Failed to initialize the shape renderer");
 		return false;
 	}
+	if (!_gridShader.setup()) {
+		Log::error("Failed to initialize the grid shader");
+		return false;
+	}
+	_gridData.create(_vertData);
+	_gridData.create(_fragData);
+
+	// the outline is a unit cube that is scaled to the region
+	_shapeBuilder.clear();
+	_shapeBuilder.aabb(glm::vec3(0.0f), glm::vec3(1.0f));
+	_aabbMeshIndex = _shapeRenderer.create(_shapeBuilder);
+	_shapeBuilder.clear();
+
+	// the six faces of a unit cube with a counter clockwise winding seen from the outside, followed by
+	// the plane for the endless grid
+	core::DynamicArray<Vertex> vertices;
+	core::DynamicArray<uint32_t> indices;
+	vertices.reserve(6 * 4 + 4);
+	indices.reserve(CubeIndices + PlaneIndices);
+	for (int axis = 0; axis < 3; ++axis) {
+		for (int side = 0; side < 2; ++side) {
+			glm::vec3 normal(0.0f);
+			normal[axis] = side == 0 ? -1.0f : 1.0f;
+			glm::vec3 u(0.0f);
+			glm::vec3 v(0.0f);
+			u[(axis + 1) % 3] = 0.5f;
+			v[(axis + 2) % 3] = 0.5f;
+			if (side == 0) {
+				glm::vec3 tmp = u;
+				u = v;
+				v = tmp;
+			}
+			glm::vec4 mask(1.0f, 1.0f, 1.0f, 0.0f);
+			mask[axis] = 0.0f;
+			const glm::vec3 center = glm::vec3(0.5f) + normal * 0.5f;
+			const uint32_t startIndex = (uint32_t)vertices.size();
+			vertices.push_back(Vertex{glm::vec4(center - u - v, 1.0f), mask});
+			vertices.push_back(Vertex{glm::vec4(center + u - v, 1.0f), mask});
+			vertices.push_back(Vertex{glm::vec4(center + u + v, 1.0f), mask});
+			vertices.push_back(Vertex{glm::vec4(center - u + v, 1.0f), mask});
+			indices.push_back(startIndex + 0);
+			indices.push_back(startIndex + 1);
+			indices.push_back(startIndex + 2);
+			indices.push_back(startIndex + 0);
+			indices.push_back(startIndex + 2);
+			indices.push_back(startIndex + 3);
+		}
+	}
+	const glm::vec4 planeMask(1.0f, 0.0f, 1.0f, 0.0f);
+	const uint32_t planeStartIndex = (uint32_t)vertices.size();
+	vertices.push_back(Vertex{glm::vec4(-1.0f, 0.0f, -1.0f, 1.0f), planeMask});
+	vertices.push_back(Vertex{glm::vec4(-1.0f, 0.0f, 1.0f, 1.0f), planeMask});
+	vertices.push_back(Vertex{glm::vec4(1.0f, 0.0f, 1.0f, 1.0f), planeMask});
+	vertices.push_back(Vertex{glm::vec4(1.0f, 0.0f, -1.0f, 1.0f), planeMask});
+	indices.push_back(planeStartIndex + 0);
+	indices.push_back(planeStartIndex + 1);
+	indices.push_back(planeStartIndex + 2);
+	indices.push_back(planeStartIndex + 0);
+	indices.push_back(planeStartIndex + 2);
+	indices.push_back(planeStartIndex + 3);
+	core_assert(indices.size() == CubeIndices + PlaneIndices);
+
+	const int32_t vertexIndex = _vbo.create(vertices.data(), vertices.size() * sizeof(Vertex));
+	if (vertexIndex == -1) {
+		Log::error("Could not create vbo for the grid vertices");
+		return false;
+	}
+	if (_vbo.create(indices.data(), indices.size() * sizeof(uint32_t), video::BufferType::IndexBuffer) == -1) {
+		Log::error("Could not create vbo for the grid indices");
+		return false;
+	}
+	core_assert_always(_vbo.addAttribute(_gridShader.getPosAttribute(vertexIndex, &Vertex::pos)));
+	core_assert_always(_vbo.addAttribute(_gridShader.getMaskAttribute(vertexIndex, &Vertex::mask)));
 
 	return true;
 }
@@ -30,7 +107,6 @@ bool GridRenderer::setGridResolution(int resolution) {
 		return false;
 	}
 	_resolution = resolution;
-	_dirty = true;
 	return true;
 }
 
@@ -39,92 +115,67 @@ int GridRenderer::gridResolution() const {
 }
 
 void GridRenderer::update(const math::AABB<float>& aabb) {
-	if (!_dirty && _aabb == aabb) {
-		return;
-	}
 	_aabb = aabb;
-	_shapeBuilder.clear();
-	_shapeBuilder.aabb(aabb, false);
-	_shapeRenderer.createOrUpdate(_aabbMeshIndex, _shapeBuilder);
-
-	_shapeBuilder.clear();
-	_shapeBuilder.aabbGridXY(aabb, false, (float)_resolution);
-	_shapeRenderer.createOrUpdate(_gridMeshIndexXYFar, _shapeBuilder);
-
-	_shapeBuilder.clear();
-	_shapeBuilder.aabbGridXZ(aabb, false, (float)_resolution);
-	_shapeRenderer.createOrUpdate(_gridMeshIndexXZFar, _shapeBuilder);
-
-	_shapeBuilder.clear();
-	_shapeBuilder.aabbGridYZ(aabb, false, (float)_resolution);
-	_shapeRenderer.createOrUpdate(_gridMeshIndexYZFar, _shapeBuilder);
-
-	_shapeBuilder.clear();
-	_shapeBuilder.aabbGridXY(aabb, true, (float)_resolution);
-	_shapeRenderer.createOrUpdate(_gridMeshIndexXYNear, _shapeBuilder);
-
-	_shapeBuilder.clear();
-	_shapeBuilder.aabbGridXZ(aabb, true, (float)_resolution);
-	_shapeRenderer.createOrUpdate(_gridMeshIndexXZNear, _shapeBuilder);
-
-	_shapeBuilder.clear();
-	_shapeBuilder.aabbGridYZ(aabb, true, (float)_resolution);
-	_shapeRenderer.createOrUpdate(_gridMeshIndexYZNear, _shapeBuilder);
-
-	_dirty = false;
 }
 
 void GridRenderer::clear() {
 	 _shapeBuilder.clear();
-	 _dirty = false;
+}
+
+void GridRenderer::renderGridMesh(const video::Camera &camera, const glm::mat4 &model, const glm::vec3 &origin,
+								  float fadeDistance, uint32_t indices, uint32_t indexOffset) {
+	_vertData.viewprojection = camera.viewProjectionMatrix();
+	_vertData.model = model;
+	_fragData.color = core::Color::White;
+	_fragData.origin = glm::vec4(origin, (float)_resolution);
+	_fragData.eye = glm::vec4(camera.eye(), fadeDistance);
+	core_assert_always(_gridData.update(_vertData));
+	core_assert_always(_gridData.update(_fragData));
+
+	video::ScopedShader scoped(_gridShader);
+	core_assert_always(_gridShader.setVert(_gridData.getVertUniformBuffer()));
+	core_assert_always(_gridShader.setFrag(_gridData.getFragUniformBuffer()));
+	video::ScopedBuffer scopedBuf(_vbo);
+	video::drawElements<uint32_t>(video::Primitive::Triangles, indices, (void *)(indexOffset * sizeof(uint32_t)));
 }
 
 void GridRenderer::render(const video::Camera& camera, const math::AABB<float>& aabb) {
 	core_trace_scoped(GridRendererRender);
 
-	if (_dirty && aabb.isValid()) {
-		update(aabb);
+	if (!aabb.isValid()) {
+		return;
 	}
-
-	_shapeRenderer.hide(_aabbMeshIndex, !_renderAABB);
-	if (_renderGrid && aabb.isValid()) {
-		const glm::vec3 &center = aabb.getCenter();
-		const glm::vec3 &halfWidth = aabb.getWidth() / 2.0f;
-		const math::Plane planeLeft  (glm::left,     center + glm::vec3(-halfWidth.x, 0.0f, 0.0f));
-		const math::Plane planeRight (glm::right,    center + glm::vec3( halfWidth.x, 0.0f, 0.0f));
-		const math::Plane planeBottom(glm::down,     center + glm::vec3(0.0f, -halfWidth.y, 0.0f));
-		const math::Plane planeTop   (glm::up,       center + glm::vec3(0.0f,  halfWidth.y, 0.0f));
-		const math::Plane planeNear  (glm::forward,  center + glm::vec3(0.0f, 0.0f, -halfWidth.z));
-		const math::Plane planeFar   (glm::backward, center + glm::vec3(0.0f, 0.0f,  halfWidth.z));
-
-		const glm::vec3 &eye = camera.eye();
-		_shapeRenderer.hide(_gridMeshIndexXYFar,  !planeFar.isBackSide(eye));
-		_shapeRenderer.hide(_gridMeshIndexXYNear, !planeNear.isBackSide(eye));
-		_shapeRenderer.hide(_gridMeshIndexXZFar,  !planeTop.isBackSide(eye));
-		_shapeRenderer.hide(_gridMeshIndexXZNear, !planeBottom.isBackSide(eye));
-		_shapeRenderer.hide(_gridMeshIndexYZFar,  !planeRight.isBackSide(eye));
-		_shapeRenderer.hide(_gridMeshIndexYZNear, !planeLeft.isBackSide(eye));
-	} else {
-		_shapeRenderer.hide(_gridMeshIndexXYFar,  true);
-		_shapeRenderer.hide(_gridMeshIndexXYNear, true);
-		_shapeRenderer.hide(_gridMeshIndexXZFar,  true);
-		_shapeRenderer.hide(_gridMeshIndexXZNear, true);
-		_shapeRenderer.hide(_gridMeshIndexYZFar,  true);
-		_shapeRenderer.hide(_gridMeshIndexYZNear, true);
+	const glm::mat4 &model = glm::scale(glm::translate(glm::mat4(1.0f), aabb.getLowerCorner()), aabb.getWidth());
+	if (_renderAABB) {
+		_shapeRenderer.render(_aabbMeshIndex, camera, model);
 	}
-	_shapeRenderer.renderAll(camera);
+	if (_renderGrid) {
+		// only the sides that are behind the region (seen from the camera) are visible
+		video::ScopedState cullFace(video::State::CullFace, true);
+		video::cullFace(video::Face::Front);
+		renderGridMesh(camera, model, aabb.getLowerCorner(), 0.0f, CubeIndices, 0u);
+		video::cullFace(video::Face::Back);
+	}
+}
+
+void GridRenderer::renderPlane(const video::Camera& camera, float height) {
+	core_trace_scoped(GridRendererRenderPlane);
+
+	const float fadeDistance = glm::min(camera.farPlane(), 256.0f * (float)_resolution);
+	const glm::vec3 &eye = camera.eye();
+	const glm::vec3 center(eye.x, height, eye.z);
+	const glm::mat4 &model = glm::scale(glm::translate(glm::mat4(1.0f), center), glm::vec3(fadeDistance, 1.0f, fadeDistance));
+	video::ScopedState cullFace(video::State::CullFace, false);
+	renderGridMesh(camera, model, glm::vec3(0.0f), fadeDistance, PlaneIndices, CubeIndices);
 }
 
 void GridRenderer::shutdown() {
 	_aabbMeshIndex = -1;
-	_gridMeshIndexXYNear = -1;
-	_gridMeshIndexXYFar = -1;
-	_gridMeshIndexXZNear = -1;
-	_gridMeshIndexXZFar = -1;
-	_gridMeshIndexYZNear = -1;
-	_gridMeshIndexYZFar = -1;
 	_shapeRenderer.shutdown();
 	_shapeBuilder.shutdown();
+	_gridData.shutdown();
+	_gridShader.shutdown();
+	_vbo.shutdown();
 }
 
 }
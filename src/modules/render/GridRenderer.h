@@ -4,7 +4,9 @@
 
 #pragma once
 
+#include "GridShader.h"
 #include "render/ShapeRenderer.h"
+#include "video/Buffer.h"
 #include "video/ShapeBuilder.h"
 #include "math/AABB.h"
 #include "core/IComponent.h"
@@ -18,28 +20,37 @@ namespace render {
 /**
  * @brief Renders a grid or bounding box for a given region
  *
- * @note Also hides sides of the grid that would occlude the view to the inside
- *
- * @todo Might be a good idea to implement this as a two sides plane view with backface culling
+ * The grid lines are computed in the fragment shader on a static unit cube that is scaled to the region - so
+ * changing the region or the resolution doesn't rebuild any geometry. Only the back faces of the cube are
+ * rendered to not occlude the view to the inside.
  */
 class GridRenderer {
 protected:
+	struct Vertex {
+		glm::vec4 pos;
+		glm::vec4 mask;
+	};
+	static constexpr uint32_t CubeIndices = 36u;
+	static constexpr uint32_t PlaneIndices = 6u;
+
 	video::ShapeBuilder _shapeBuilder;
 	render::ShapeRenderer _shapeRenderer;
+	shader::GridShader &_gridShader;
+	shader::GridData _gridData;
+	alignas(16) shader::GridData::VertData _vertData;
+	alignas(16) shader::GridData::FragData _fragData;
+	video::Buffer _vbo;
 	math::AABB<float> _aabb;
 
 	int32_t _aabbMeshIndex = -1;
-	int32_t _gridMeshIndexXYNear = -1;
-	int32_t _gridMeshIndexXYFar = -1;
-	int32_t _gridMeshIndexXZNear = -1;
-	int32_t _gridMeshIndexXZFar = -1;
-	int32_t _gridMeshIndexYZNear = -1;
-	int32_t _gridMeshIndexYZFar = -1;
 
 	int _resolution = 1;
 	bool _renderAABB;
 	bool _renderGrid;
-	bool _dirty = false;
+
+	void renderGridMesh(const video::Camera &camera, const glm::mat4 &model, const glm::vec3 &origin,
+						float fadeDistance, uint32_t indices, uint32_t indexOffset);
+
 public:
 	GridRenderer(bool renderAABB = false, bool renderGrid = true);
 
@@ -47,10 +58,15 @@ public:
 	int gridResolution() const;
 
 	/**
-	 * @param aabb The region to do the plane culling with
+	 * @param aabb The region to render the grid and the bounding box for
 	 */
 	void render(const video::Camera& camera, const math::AABB<float>& aabb);
 
+	/**
+	 * @brief Renders an endless grid plane on the given height that fades out with the distance to the camera
+	 */
+	void renderPlane(const video::Camera& camera, float height);
+
 	bool renderAABB() const;
 	void setRenderAABB(bool renderAABB);
 
@@ -58,7 +74,7 @@ public:
 	void setRenderGrid(bool renderGrid);
 
 	/**
-	 * @brief Update the internal render buffers for the new region.
+	 * @brief Remembers the region - there are no render buffers that depend on it
 	 * @param region The region to render the grid for
 	 */
 	void update(const math::AABB<float>& region);
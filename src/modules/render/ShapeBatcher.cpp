@@ -0,0 +1,130 @@
+/**
+ * @file
+ */
+
+#include "ShapeBatcher.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "video/Camera.h"
+#include "video/Renderer.h"
+
+namespace render {
+
+ShapeBatcher::ShapeBatcher() : _colorShader(shader::ColorShader::getInstance()) {
+	_batches[BatchLines].primitive = video::Primitive::Lines;
+	_batches[BatchTriangles].primitive = video::Primitive::Triangles;
+}
+
+bool ShapeBatcher::init() {
+	if (!_colorShader.setup()) {
+		Log::error("Failed to setup color shader");
+		return false;
+	}
+	_uniformBlock.create(_uniformBlockData);
+
+	for (int i = 0; i < BatchMax; ++i) {
+		Batch &batch = _batches[i];
+		batch.vertexIndex = batch.vbo.create();
+		if (batch.vertexIndex == -1) {
+			Log::error("Could not create vbo for vertices");
+			return false;
+		}
+		batch.indexIndex = batch.vbo.create(nullptr, 0, video::BufferType::IndexBuffer);
+		if (batch.indexIndex == -1) {
+			Log::error("Could not create vbo for indices");
+			return false;
+		}
+		// the content is replaced every frame
+		batch.vbo.setMode(batch.vertexIndex, video::BufferMode::Stream);
+		batch.vbo.setMode(batch.indexIndex, video::BufferMode::Stream);
+		core_assert_always(batch.vbo.addAttribute(_colorShader.getPosAttribute(batch.vertexIndex, &Vertex::pos)));
+		core_assert_always(batch.vbo.addAttribute(_colorShader.getColorAttribute(batch.vertexIndex, &Vertex::color)));
+	}
+	return true;
+}
+
+void ShapeBatcher::shutdown() {
+	for (int i = 0; i < BatchMax; ++i) {
+		Batch &batch = _batches[i];
+		batch.vbo.shutdown();
+		batch.vertexIndex = -1;
+		batch.indexIndex = -1;
+		batch.vertices.release();
+		batch.indices.release();
+	}
+	_uniformBlock.shutdown();
+	_colorShader.shutdown();
+}
+
+bool ShapeBatcher::add(const video::ShapeBuilder &shapeBuilder, const glm::mat4 &model) {
+	Batch *batch;
+	switch (shapeBuilder.primitive()) {
+	case video::Primitive::Lines:
+		batch = &_batches[BatchLines];
+		break;
+	case video::Primitive::Triangles:
+		batch = &_batches[BatchTriangles];
+		break;
+	default:
+		Log::warn("Unsupported primitive for the shape batcher");
+		return false;
+	}
+	const uint32_t offset = (uint32_t)batch->vertices.size();
+	const video::ShapeBuilder::Indices &indices = shapeBuilder.getIndices();
+	batch->vertices.reserve(offset + shapeBuilder.getVertices().size());
+	batch->indices.reserve(batch->indices.size() + indices.size());
+	shapeBuilder.iterate([&](const glm::vec3 &pos, const glm::vec2 &, const glm::vec4 &color, const glm::vec3 &) {
+		batch->vertices.emplace_back(Vertex{model * glm::vec4(pos, 1.0f), color});
+	});
+	for (uint32_t index : indices) {
+		batch->indices.push_back(offset + index);
+	}
+	return true;
+}
+
+int ShapeBatcher::flush(const video::Camera &camera) {
+	core_trace_scoped(ShapeBatcherFlush);
+	int drawCalls = 0;
+	for (int i = 0; i < BatchMax; ++i) {
+		Batch &batch = _batches[i];
+		if (batch.indices.empty()) {
+			continue;
+		}
+		if (drawCalls == 0) {
+			_uniformBlockData.model = glm::mat4(1.0f);
+			_uniformBlockData.viewprojection = camera.viewProjectionMatrix();
+			core_assert_always(_uniformBlock.update(_uniformBlockData));
+			core_assert_always(_colorShader.activate());
+			core_assert_always(_colorShader.setUniformblock(_uniformBlock.getUniformblockUniformBuffer()));
+		}
+		core_assert_always(batch.vbo.update(batch.vertexIndex, batch.vertices.data(), batch.vertices.size() * sizeof(Vertex)));
+		core_assert_always(batch.vbo.update(batch.indexIndex, batch.indices.data(),
+											batch.indices.size() * sizeof(video::ShapeBuilder::Indices::value_type)));
+		video::ScopedBuffer scopedBuf(batch.vbo);
+		video::drawElements<video::ShapeBuilder::Indices::value_type>(batch.primitive, batch.indices.size());
+		++drawCalls;
+	}
+	if (drawCalls > 0) {
+		_colorShader.deactivate();
+	}
+	clear();
+	return drawCalls;
+}
+
+void ShapeBatcher::clear() {
+	for (int i = 0; i < BatchMax; ++i) {
+		_batches[i].vertices.clear();
+		_batches[i].indices.clear();
+	}
+}
+
+bool ShapeBatcher::empty() const {
+	for (int i = 0; i < BatchMax; ++i) {
+		if (!_batches[i].indices.empty()) {
+			return false;
+		}
+	}
+	return true;
+}
+
+} // namespace render
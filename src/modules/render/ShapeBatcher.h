@@ -0,0 +1,78 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "ColorShader.h"
+#include "core/IComponent.h"
+#include "core/collection/DynamicArray.h"
+#include "video/Buffer.h"
+#include "video/ShapeBuilder.h"
+#include "video/Types.h"
+#include <glm/mat4x4.hpp>
+
+namespace video {
+class Camera;
+}
+
+namespace render {
+
+/**
+ * @brief Collects the transient shapes of a frame and renders them with one draw call per primitive type
+ *
+ * Other than the @c ShapeRenderer there are no persistent meshes - the shapes are transformed on the cpu,
+ * streamed into one vertex and index buffer per primitive and the batch is cleared after @c flush().
+ *
+ * @see ShapeRenderer
+ * @see video::ShapeBuilder
+ */
+class ShapeBatcher : public core::IComponent {
+private:
+	struct Vertex {
+		glm::vec4 pos;
+		glm::vec4 color;
+	};
+
+	struct Batch {
+		video::Primitive primitive = video::Primitive::Triangles;
+		video::Buffer vbo;
+		int32_t vertexIndex = -1;
+		int32_t indexIndex = -1;
+		core::DynamicArray<Vertex> vertices;
+		video::ShapeBuilder::Indices indices;
+	};
+	enum { BatchLines, BatchTriangles, BatchMax };
+	Batch _batches[BatchMax];
+
+	alignas(16) shader::ColorData::UniformblockData _uniformBlockData;
+	shader::ColorData _uniformBlock;
+	shader::ColorShader &_colorShader;
+
+public:
+	ShapeBatcher();
+
+	bool init() override;
+	void shutdown() override;
+
+	/**
+	 * @brief Adds the geometry of the given @c video::ShapeBuilder to the batch of its primitive
+	 * @param model The transform that is applied to the vertices before they are added
+	 * @return @c false if the primitive of the shape builder is not supported - only lines and triangles are batched
+	 */
+	bool add(const video::ShapeBuilder &shapeBuilder, const glm::mat4 &model = glm::mat4(1.0f));
+
+	/**
+	 * @brief Renders and clears all the shapes that were added since the last flush
+	 * @return The amount of draw calls that were issued
+	 */
+	int flush(const video::Camera &camera);
+
+	/**
+	 * @brief Drops the collected shapes without rendering them
+	 */
+	void clear();
+	bool empty() const;
+};
+
+} // namespace render
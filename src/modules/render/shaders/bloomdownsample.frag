@@ -0,0 +1,31 @@
+/**
+ * @brief Downsamples the texture into the next smaller level of the bloom mip chain
+ *
+ * This is the 13 tap filter of the call of duty advanced warfare presentation - the four overlapping 2x2 boxes
+ * avoid the flickering of a plain bilinear downsample.
+ */
+uniform sampler2D u_texture;
+$in vec2 v_texcoord;
+layout(location = 0) $out vec4 o_color;
+
+void main(void) {
+	vec2 t = 1.0 / vec2(textureSize(u_texture, 0));
+	vec4 a = $texture2D(u_texture, v_texcoord + t * vec2(-2.0, 2.0));
+	vec4 b = $texture2D(u_texture, v_texcoord + t * vec2(0.0, 2.0));
+	vec4 c = $texture2D(u_texture, v_texcoord + t * vec2(2.0, 2.0));
+	vec4 d = $texture2D(u_texture, v_texcoord + t * vec2(-2.0, 0.0));
+	vec4 e = $texture2D(u_texture, v_texcoord);
+	vec4 f = $texture2D(u_texture, v_texcoord + t * vec2(2.0, 0.0));
+	vec4 g = $texture2D(u_texture, v_texcoord + t * vec2(-2.0, -2.0));
+	vec4 h = $texture2D(u_texture, v_texcoord + t * vec2(0.0, -2.0));
+	vec4 i = $texture2D(u_texture, v_texcoord + t * vec2(2.0, -2.0));
+	vec4 j = $texture2D(u_texture, v_texcoord + t * vec2(-1.0, 1.0));
+	vec4 k = $texture2D(u_texture, v_texcoord + t * vec2(1.0, 1.0));
+	vec4 l = $texture2D(u_texture, v_texcoord + t * vec2(-1.0, -1.0));
+	vec4 m = $texture2D(u_texture, v_texcoord + t * vec2(1.0, -1.0));
+
+	o_color = e * 0.125;
+	o_color += (a + c + g + i) * 0.03125;
+	o_color += (b + d + f + h) * 0.0625;
+	o_color += (j + k + l + m) * 0.125;
+}
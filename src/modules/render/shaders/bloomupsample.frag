@@ -0,0 +1,21 @@
+/**
+ * @brief Upsamples a level of the bloom mip chain with a 3x3 tent filter - the result is added to the next bigger
+ * level by the blending
+ */
+uniform sampler2D u_texture;
+$in vec2 v_texcoord;
+layout(location = 0) $out vec4 o_color;
+
+void main(void) {
+	vec2 t = 1.0 / vec2(textureSize(u_texture, 0));
+	vec4 sum = $texture2D(u_texture, v_texcoord) * 4.0;
+	sum += $texture2D(u_texture, v_texcoord + t * vec2(-1.0, 0.0)) * 2.0;
+	sum += $texture2D(u_texture, v_texcoord + t * vec2(1.0, 0.0)) * 2.0;
+	sum += $texture2D(u_texture, v_texcoord + t * vec2(0.0, -1.0)) * 2.0;
+	sum += $texture2D(u_texture, v_texcoord + t * vec2(0.0, 1.0)) * 2.0;
+	sum += $texture2D(u_texture, v_texcoord + t * vec2(-1.0, -1.0));
+	sum += $texture2D(u_texture, v_texcoord + t * vec2(1.0, -1.0));
+	sum += $texture2D(u_texture, v_texcoord + t * vec2(-1.0, 1.0));
+	sum += $texture2D(u_texture, v_texcoord + t * vec2(1.0, 1.0));
+	o_color = sum / 16.0;
+}
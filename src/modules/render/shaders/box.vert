@@ -0,0 +1,19 @@
+layout(std140) uniform u_uniformblock {
+	mat4 u_viewprojection;
+	mat4 u_model;
+	vec4 u_color;
+};
+
+// the corner of the unit cube
+layout(location = 0) $in vec3 a_pos;
+// the bounds of the box - one pair per instance
+layout(location = 1) $in vec3 a_mins;
+layout(location = 2) $in vec3 a_maxs;
+
+$out vec4 v_color;
+
+void main()
+{
+	v_color = u_color;
+	gl_Position = u_viewprojection * u_model * vec4(mix(a_mins, a_maxs, a_pos), 1.0);
+}
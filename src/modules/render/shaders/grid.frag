@@ -0,0 +1,37 @@
+$in vec3 v_pos;
+$in vec3 v_mask;
+
+layout(std140) uniform u_frag {
+	vec4 u_color;
+	// xyz is the origin of the grid, w the distance of the lines
+	vec4 u_origin;
+	// xyz is the camera position, w the distance where the grid is faded out - 0 disables the fading
+	vec4 u_eye;
+};
+
+layout(location = 0) $out vec4 o_color;
+layout(location = 1) $out vec4 o_glow;
+
+void main()
+{
+	vec3 coord = (v_pos - u_origin.xyz) / u_origin.w;
+	vec3 derivative = fwidth(coord);
+	vec3 grid = abs(fract(coord - 0.5) - 0.5) / max(derivative, vec3(0.0001));
+	// the normal axis of the plane doesn't produce lines
+	grid = mix(vec3(1000.0), grid, v_mask);
+	float line = min(grid.x, min(grid.y, grid.z));
+	float alpha = 1.0 - min(line, 1.0);
+	// fade out the lines before the cells get smaller than a few pixels to reduce the moire pattern
+	vec3 cellsPerPixel = derivative * v_mask;
+	alpha *= 1.0 - clamp(max(cellsPerPixel.x, max(cellsPerPixel.y, cellsPerPixel.z)) * 2.0 - 0.5, 0.0, 1.0);
+	if (u_eye.w > 0.0) {
+		alpha *= 1.0 - smoothstep(0.0, u_eye.w, distance(v_pos, u_eye.xyz));
+	}
+	alpha *= u_color.a;
+	// don't write the depth of the transparent parts
+	if (alpha <= 0.01) {
+		discard;
+	}
+	o_color = vec4(u_color.rgb, alpha);
+	o_glow = vec4(0.0, 0.0, 0.0, 0.0);
+}
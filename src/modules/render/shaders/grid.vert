@@ -0,0 +1,19 @@
+layout(std140) uniform u_vert {
+	mat4 u_viewprojection;
+	mat4 u_model;
+};
+
+layout(location = 0) $in vec4 a_pos;
+// the axes of the plane - the normal axis is 0
+layout(location = 1) $in vec3 a_mask;
+
+$out vec3 v_pos;
+$out vec3 v_mask;
+
+void main()
+{
+	vec4 worldPos = u_model * a_pos;
+	v_pos = worldPos.xyz;
+	v_mask = a_mask;
+	gl_Position = u_viewprojection * worldPos;
+}
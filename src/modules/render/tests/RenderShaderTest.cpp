@@ -3,7 +3,11 @@
  */
 
 #include "video/tests/AbstractGLTest.h"
+#include "BloomdownsampleShader.h"
+#include "BloomupsampleShader.h"
+#include "BoxShader.h"
 #include "ColorShader.h"
+#include "GridShader.h"
 #include "TextureShader.h"
 namespace render {
 
@@ -23,6 +27,30 @@ TEST_P(RenderShaderTest, testColorShader) {
 	shader.shutdown();
 }
 
+TEST_P(RenderShaderTest, testBloomDownsampleShader) {
+	shader::BloomdownsampleShader shader;
+	EXPECT_TRUE(shader.setup());
+	shader.shutdown();
+}
+
+TEST_P(RenderShaderTest, testBloomUpsampleShader) {
+	shader::BloomupsampleShader shader;
+	EXPECT_TRUE(shader.setup());
+	shader.shutdown();
+}
+
+TEST_P(RenderShaderTest, testBoxShader) {
+	shader::BoxShader shader;
+	EXPECT_TRUE(shader.setup());
+	shader.shutdown();
+}
+
+TEST_P(RenderShaderTest, testGridShader) {
+	shader::GridShader shader;
+	EXPECT_TRUE(shader.setup());
+	shader.shutdown();
+}
+
 VIDEO_SHADERTEST(RenderShaderTest)
 
 }
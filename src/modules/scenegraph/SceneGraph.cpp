@@ -3,51 +3,105 @@
  */
 
 #include "SceneGraph.h"
+#include "app/App.h"
 #include "core/Algorithm.h"
 #include "core/Common.h"
 #include "core/Log.h"
 #include "core/Pair.h"
 #include "core/StringUtil.h"
+#include "core/collection/Map.h"
+#include "core/Trace.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/MaterialColor.h"
+#include "voxel/OccupancyPyramid.h"
 #include "voxel/Palette.h"
+#include "voxel/PaletteLookup.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraphNode.h"
-#include "voxelutil/VolumeMerger.h"
-#include "voxelutil/VolumeVisitor.h"
+#include <new>
 
 namespace scenegraph {
 
-SceneGraph::SceneGraph(int nodes) : _nodes(nodes), _activeAnimation(DEFAULT_ANIMATION) {
+static core::AtomicInt s_sceneGraphRevision;
+
+SceneGraph::SceneGraph(int nodes) : _activeAnimation(DEFAULT_ANIMATION) {
+	reserve(nodes);
 	clear();
 	_animations.push_back(_activeAnimation);
 }
 
 SceneGraph::~SceneGraph() {
-	for (const auto &entry : _nodes) {
-		entry->value.release();
+	destroyNodes();
+}
+
+void SceneGraph::markChanged() {
+	_revision = (uint32_t)s_sceneGraphRevision.increment(1) + 1u;
+}
+
+void SceneGraph::destroyNodes() {
+	markChanged();
+	for (NodeBlock *block : _nodeBlocks) {
+		if (block == nullptr) {
+			continue;
+		}
+		for (int i = 0; i < NodeBlockSize; ++i) {
+			if (block->used & (1u << i)) {
+				block->slot(i)->~SceneGraphNode();
+			}
+		}
+		delete block;
 	}
-	_nodes.clear();
+	_nodeBlocks.clear();
+	_nodeCount = 0;
+}
+
+void SceneGraph::insertNode(int nodeId, SceneGraphNode &&node) {
+	const int blockIdx = nodeId >> NodeBlockBits;
+	if (blockIdx >= (int)_nodeBlocks.size()) {
+		_nodeBlocks.resize(blockIdx + 1);
+	}
+	NodeBlock *block = _nodeBlocks[blockIdx];
+	if (block == nullptr) {
+		block = new NodeBlock;
+		_nodeBlocks[blockIdx] = block;
+	}
+	const int slotIdx = nodeId & NodeBlockMask;
+	core_assert((block->used & (1u << slotIdx)) == 0u);
+	new (block->slot(slotIdx)) SceneGraphNode(core::forward<SceneGraphNode>(node));
+	block->used |= 1u << slotIdx;
+	++_nodeCount;
+	markChanged();
 }
 
 SceneGraph::SceneGraph(SceneGraph &&other) noexcept {
-	_nodes = core::move(other._nodes);
+	_nodeBlocks = core::move(other._nodeBlocks);
+	_nodeCount = other._nodeCount;
+	other._nodeCount = 0;
 	_nextNodeId = other._nextNodeId;
 	other._nextNodeId = 0;
 	_activeNodeId = other._activeNodeId;
 	other._activeNodeId = InvalidNodeId;
 	_animations = core::move(other._animations);
 	_activeAnimation = core::move(other._activeAnimation);
+	markChanged();
+	other.markChanged();
 }
 
 SceneGraph &SceneGraph::operator=(SceneGraph &&other) noexcept {
 	if (this != &other) {
-		_nodes = core::move(other._nodes);
+		destroyNodes();
+		_nodeBlocks = core::move(other._nodeBlocks);
+		_nodeCount = other._nodeCount;
+		other._nodeCount = 0;
 		_nextNodeId = other._nextNodeId;
 		other._nextNodeId = 0;
 		_activeNodeId = other._activeNodeId;
 		other._activeNodeId = InvalidNodeId;
 		_animations = core::move(other._animations);
 		_activeAnimation = core::move(other._activeAnimation);
+		markChanged();
+		other.markChanged();
 	}
 	return *this;
 }
@@ -60,8 +114,8 @@ bool SceneGraph::setAnimation(const core::String &animation) {
 		return false;
 	}
 	_activeAnimation = animation;
-	for (const auto &entry : _nodes) {
-		entry->value.setAnimation(animation);
+	for (auto iter = beginAll(); iter != end(); ++iter) {
+		(*iter).setAnimation(animation);
 	}
 	return true;
 }
@@ -87,8 +141,8 @@ bool SceneGraph::removeAnimation(const core::String &animation) {
 		return false;
 	}
 	_animations.erase(iter);
-	for (const auto &entry : _nodes) {
-		entry->value.removeAnimation(animation);
+	for (auto iter = beginAll(); iter != end(); ++iter) {
+		(*iter).removeAnimation(animation);
 	}
 	if (_animations.empty()) {
 		addAnimation(DEFAULT_ANIMATION);
@@ -101,8 +155,8 @@ bool SceneGraph::removeAnimation(const core::String &animation) {
 
 bool SceneGraph::hasAnimations() const {
 	for (const core::String &animation : animations())  {
-		for (const auto &entry : _nodes) {
-			if (entry->value.keyFrames(animation).size() > 1) {
+		for (auto iter = beginAll(); iter != end(); ++iter) {
+			if ((*iter).keyFrames(animation).size() > 1) {
 				return true;
 			}
 		}
@@ -123,6 +177,26 @@ FrameIndex SceneGraph::maxFrames(const core::String &animation) const {
 	return maxFrame;
 }
 
+void SceneGraph::bakeAnimation() const {
+	core_trace_scoped(BakeAnimation);
+	core::DynamicArray<const SceneGraphNode *> nodes;
+	for (auto iter = beginAll(); iter != end(); ++iter) {
+		const SceneGraphNode &node = *iter;
+		if (!node.hasBakedTransforms()) {
+			nodes.push_back(&node);
+		}
+	}
+	if (nodes.empty()) {
+		return;
+	}
+	// every node only writes its own baked transforms
+	app::App::getInstance()->threadPool().parallelFor(0, (int)nodes.size(), 1, [&](int start, int end) {
+		for (int n = start; n < end; ++n) {
+			nodes[n]->bakeTransforms();
+		}
+	});
+}
+
 int SceneGraph::activeNode() const {
 	return _activeNodeId;
 }
@@ -143,19 +217,16 @@ voxel::Palette &SceneGraph::firstPalette() const {
 }
 
 SceneGraphNode& SceneGraph::node(int nodeId) const {
-	auto iter = _nodes.find(nodeId);
-	if (iter == _nodes.end()) {
+	SceneGraphNode *n = nodePtr(nodeId);
+	if (n == nullptr) {
 		Log::error("No node for id %i found in the scene graph - returning root node", nodeId);
-		return _nodes.find(0)->value;
+		return *nodePtr(0);
 	}
-	return iter->value;
+	return *n;
 }
 
 bool SceneGraph::hasNode(int nodeId) const {
-	if (nodeId == InvalidNodeId) {
-		return false;
-	}
-	return _nodes.find(nodeId) != _nodes.end();
+	return nodePtr(nodeId) != nullptr;
 }
 
 const SceneGraphNode& SceneGraph::root() const {
@@ -163,11 +234,11 @@ const SceneGraphNode& SceneGraph::root() const {
 }
 
 int SceneGraph::prevModelNode(int nodeId) const {
-	auto iter = _nodes.find(nodeId);
-	if (iter ==  _nodes.end()) {
+	const SceneGraphNode *ownNodePtr = nodePtr(nodeId);
+	if (ownNodePtr == nullptr) {
 		return InvalidNodeId;
 	}
-	const SceneGraphNode &ownNode = iter->second;
+	const SceneGraphNode &ownNode = *ownNodePtr;
 	if (ownNode.parent() == InvalidNodeId) {
 		return InvalidNodeId;
 	}
@@ -193,11 +264,11 @@ int SceneGraph::prevModelNode(int nodeId) const {
 }
 
 int SceneGraph::nextModelNode(int nodeId) const {
-	auto iter = _nodes.find(nodeId);
-	if (iter ==  _nodes.end()) {
+	const SceneGraphNode *ownNodePtr = nodePtr(nodeId);
+	if (ownNodePtr == nullptr) {
 		return InvalidNodeId;
 	}
-	const SceneGraphNode &ownNode = iter->second;
+	const SceneGraphNode &ownNode = *ownNodePtr;
 	if (ownNode.parent() == InvalidNodeId) {
 		return InvalidNodeId;
 	}
@@ -224,26 +295,60 @@ int SceneGraph::nextModelNode(int nodeId) const {
 }
 
 void SceneGraph::updateTransforms_r(SceneGraphNode &n) {
-	for (SceneGraphKeyFrame &keyframe : *n.keyFrames()) {
-		keyframe.transform().update(*this, n, keyframe.frameIdx);
+	const SceneGraphKeyFrames &kfs = ((const SceneGraphNode &)n).keyFrames();
+	for (size_t i = 0; i < kfs.size(); ++i) {
+		// only use the mutable accessor for dirty transforms - this keeps the cached transforms of the
+		// unchanged nodes valid. The update propagates the changes down the subtree.
+		if (kfs[i].transform().dirty()) {
+			n.keyFrame((KeyFrameIndex)i).transform().update(*this, n, kfs[i].frameIdx);
+		}
 	}
 	for (int childrenId : n.children()) {
 		updateTransforms_r(node(childrenId));
 	}
 }
 
+bool SceneGraph::hasDirtyTransforms(const core::String &animation) const {
+	for (auto iter = beginAll(); iter != end(); ++iter) {
+		const SceneGraphKeyFramesMap &map = (*iter).allKeyFrames();
+		auto kfsIter = map.find(animation);
+		if (kfsIter == map.end()) {
+			continue;
+		}
+		for (const SceneGraphKeyFrame &keyframe : kfsIter->value) {
+			if (keyframe.transform().dirty()) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
 void SceneGraph::updateTransforms() {
 	const core::String animId = _activeAnimation;
 	for (const core::String &animation : animations()) {
+		if (!hasDirtyTransforms(animation)) {
+			continue;
+		}
 		core_assert_always(setAnimation(animation));
 		updateTransforms_r(node(0));
 	}
-	core_assert_always(setAnimation(animId));
+	if (_activeAnimation != animId) {
+		core_assert_always(setAnimation(animId));
+	}
 }
 
 voxel::Region SceneGraph::groupRegion() const {
 	int nodeId = activeNode();
-	voxel::Region region = node(nodeId).region();
+	if (_groupRegionCache.revision == _revision && _groupRegionCache.activeNode == nodeId &&
+		_groupRegionCache.regionRevision == SceneGraphNode::regionRevision()) {
+		return _groupRegionCache.region;
+	}
+	_groupRegionCache.revision = _revision;
+	_groupRegionCache.activeNode = nodeId;
+	_groupRegionCache.regionRevision = SceneGraphNode::regionRevision();
+	voxel::Region &region = _groupRegionCache.region;
+	region = node(nodeId).region();
 	if (!region.isValid()) {
 		return region;
 	}
@@ -261,7 +366,13 @@ voxel::Region SceneGraph::groupRegion() const {
 }
 
 voxel::Region SceneGraph::region() const {
-	voxel::Region r;
+	if (_regionCache.revision == _revision && _regionCache.regionRevision == SceneGraphNode::regionRevision()) {
+		return _regionCache.region;
+	}
+	_regionCache.revision = _revision;
+	_regionCache.regionRevision = SceneGraphNode::regionRevision();
+	voxel::Region &r = _regionCache.region;
+	r = voxel::Region();
 	bool validVolume = false;
 	for (const SceneGraphNode& node : *this) {
 		if (validVolume) {
@@ -275,18 +386,18 @@ voxel::Region SceneGraph::region() const {
 }
 
 SceneGraphNode* SceneGraph::findNodeByName(const core::String& name) {
-	for (const auto& entry : _nodes) {
-		Log::trace("node name: %s", entry->value.name().c_str());
-		if (entry->value.name() == name) {
-			return &entry->value;
+	for (auto iter = beginAll(); iter != end(); ++iter) {
+		Log::trace("node name: %s", (*iter).name().c_str());
+		if ((*iter).name() == name) {
+			return &*iter;
 		}
 	}
 	return nullptr;
 }
 
 SceneGraphNode* SceneGraph::first() {
-	for (const auto& entry : _nodes) {
-		return &entry->value;
+	for (auto iter = beginAll(); iter != end(); ++iter) {
+		return &*iter;
 	}
 	return nullptr;
 }
@@ -309,14 +420,14 @@ int SceneGraph::emplace(SceneGraphNode &&node, int parent) {
 		return InvalidNodeId;
 	}
 	if (parent >= 0) {
-		auto parentIter = _nodes.find(parent);
-		if (parentIter == _nodes.end()) {
+		SceneGraphNode *parentNode = nodePtr(parent);
+		if (parentNode == nullptr) {
 			Log::error("Could not find parent node with id %i", parent);
 			node.release();
 			return InvalidNodeId;
 		}
 		Log::debug("Add child %i to node %i", nodeId, parent);
-		parentIter->value.addChild(nodeId);
+		parentNode->addChild(nodeId);
 	}
 	++_nextNodeId;
 	node.setId(nodeId);
@@ -332,7 +443,7 @@ int SceneGraph::emplace(SceneGraphNode &&node, int parent) {
 	node.setParent(parent);
 	node.setAnimation(_activeAnimation);
 	Log::debug("Adding scene graph node of type %i with id %i and parent %i", (int)node.type(), node.id(), node.parent());
-	_nodes.emplace(nodeId, core::forward<SceneGraphNode>(node));
+	insertNode(nodeId, core::forward<SceneGraphNode>(node));
 	return nodeId;
 }
 
@@ -378,6 +489,7 @@ bool SceneGraph::changeParent(int nodeId, int newParentId) {
 		return false;
 	}
 	n.setParent(newParentId);
+	markChanged();
 	const SceneGraphNode &parentNode = node(newParentId);
 
 	for (const core::String &animation : animations()) {
@@ -395,34 +507,42 @@ bool SceneGraph::changeParent(int nodeId, int newParentId) {
 }
 
 bool SceneGraph::removeNode(int nodeId, bool recursive) {
-	auto iter = _nodes.find(nodeId);
-	if (iter == _nodes.end()) {
+	SceneGraphNode *n = nodePtr(nodeId);
+	if (n == nullptr) {
 		Log::debug("Could not remove node %i - not found", nodeId);
 		return false;
 	}
-	if (iter->value.type() == SceneGraphNodeType::Root) {
+	if (n->type() == SceneGraphNodeType::Root) {
 		core_assert(nodeId == 0);
 		clear();
 		return true;
 	}
 	bool state = true;
-	const int parent = iter->value.parent();
+	const int parent = n->parent();
 	SceneGraphNode &parentNode = node(parent);
 	parentNode.removeChild(nodeId);
 
 	if (recursive) {
-		state = iter->value.children().empty();
-		for (int childId : iter->value.children()) {
+		state = n->children().empty();
+		for (int childId : n->children()) {
 			state |= removeNode(childId, recursive);
 		}
 	} else {
 		// reparent any children
-		for (int childId : iter->value.children()) {
+		for (int childId : n->children()) {
 			node(childId).setParent(parent);
 			parentNode.addChild(childId);
 		}
 	}
-	_nodes.erase(iter);
+	NodeBlock *block = _nodeBlocks[nodeId >> NodeBlockBits];
+	n->~SceneGraphNode();
+	block->used &= ~(1u << (nodeId & NodeBlockMask));
+	--_nodeCount;
+	markChanged();
+	if (block->used == 0u) {
+		delete block;
+		_nodeBlocks[nodeId >> NodeBlockBits] = nullptr;
+	}
 	if (_activeNodeId == nodeId) {
 		if (!empty(SceneGraphNodeType::Model)) {
 			// get the first model node
@@ -435,39 +555,30 @@ bool SceneGraph::removeNode(int nodeId, bool recursive) {
 }
 
 void SceneGraph::reserve(size_t size) {
+	_nodeBlocks.reserve((size + NodeBlockMask) >> NodeBlockBits);
 }
 
 bool SceneGraph::empty(SceneGraphNodeType type) const {
-	for (const auto& entry : _nodes) {
-		if (entry->value.type() == type) {
-			return false;
-		}
-	}
-	return true;
+	return begin(type) == end();
 }
 
 size_t SceneGraph::size(SceneGraphNodeType type) const {
 	size_t n = 0;
-	for (const auto& entry : _nodes) {
-		if (entry->value.type() == type) {
-			++n;
-		}
+	for (auto iter = begin(type); iter != end(); ++iter) {
+		++n;
 	}
 	return n;
 }
 
 void SceneGraph::clear() {
-	for (const auto &entry : _nodes) {
-		entry->value.release();
-	}
-	_nodes.clear();
+	destroyNodes();
 	_nextNodeId = 1;
 
 	SceneGraphNode node(SceneGraphNodeType::Root);
 	node.setName("root");
 	node.setId(0);
 	node.setParent(InvalidNodeId);
-	_nodes.emplace(0, core::move(node));
+	insertNode(0, core::move(node));
 }
 
 const SceneGraphNode *SceneGraph::operator[](int modelIdx) const {
@@ -493,13 +604,16 @@ SceneGraphNode *SceneGraph::operator[](int modelIdx) {
 }
 
 voxel::Palette SceneGraph::mergePalettes(bool removeUnused, int emptyIndex) const {
+	core_trace_scoped(MergePalettes);
 	voxel::Palette palette;
 	bool tooManyColors = false;
+	// the colors that are already part of the merged palette - most nodes share most of their colors
+	core::Map<uint32_t, bool, 1031> knownColors(voxel::PaletteMaxColors);
 	for (const SceneGraphNode &node : *this) {
 		const voxel::Palette &nodePalette = node.palette();
 		for (int i = 0; i < nodePalette.colorCount(); ++i) {
 			const core::RGBA rgba = nodePalette.color(i);
-			if (palette.hasColor(rgba)) {
+			if (knownColors.hasKey(rgba.rgba)) {
 				continue;
 			}
 			uint8_t index = 0;
@@ -510,6 +624,7 @@ voxel::Palette SceneGraph::mergePalettes(bool removeUnused, int emptyIndex) cons
 					break;
 				}
 			}
+			knownColors.put(rgba.rgba, true);
 			if (nodePalette.hasGlow(i)) {
 				palette.setGlow(index, 1.0f);
 			}
@@ -524,19 +639,38 @@ voxel::Palette SceneGraph::mergePalettes(bool removeUnused, int emptyIndex) cons
 		for (int i = 0; i < voxel::PaletteMaxColors; ++i) {
 			palette.removeGlow(i);
 		}
+		core::DynamicArray<const SceneGraphNode *> nodes;
+		nodes.reserve(size());
 		for (const SceneGraphNode &node : *this) {
-			core::Array<bool, voxel::PaletteMaxColors> used;
-			if (removeUnused) {
-				used.fill(false);
-				voxelutil::visitVolume(*node.volume(), [&used] (int, int, int, const voxel::Voxel &voxel) {
-					used[voxel.getColor()] = true;
-				});
-			} else {
-				used.fill(true);
+			nodes.push_back(&node);
+		}
+		core::DynamicArray<core::Array<bool, voxel::PaletteMaxColors>> used;
+		used.resize(nodes.size());
+		// the used colors of the nodes are collected in parallel - the palette is built in the node order
+		app::App::getInstance()->threadPool().parallelFor(0, (int)nodes.size(), 1, [&](int start, int end) {
+			for (int n = start; n < end; ++n) {
+				core::Array<bool, voxel::PaletteMaxColors> &nodeUsed = used[n];
+				if (!removeUnused) {
+					nodeUsed.fill(true);
+					continue;
+				}
+				nodeUsed.fill(false);
+				const voxel::RawVolume *volume = nodes[n]->volume();
+				const voxel::Region &region = volume->region();
+				const glm::ivec3 &dim = region.getDimensionsInVoxels();
+				const voxel::Voxel *data = (const voxel::Voxel *)volume->data();
+				const size_t voxels = (size_t)dim.x * (size_t)dim.y * (size_t)dim.z;
+				for (size_t v = 0u; v < voxels; ++v) {
+					if (!voxel::isAir(data[v].getMaterial())) {
+						nodeUsed[data[v].getColor()] = true;
+					}
+				}
 			}
-			const voxel::Palette &nodePalette = node.palette();
+		});
+		for (size_t n = 0; n < nodes.size(); ++n) {
+			const voxel::Palette &nodePalette = nodes[n]->palette();
 			for (int i = 0; i < nodePalette.colorCount(); ++i) {
-				if (!used[i]) {
+				if (!used[n][i]) {
 					Log::trace("color %i not used, skip it for this node", i);
 					continue;
 				}
@@ -565,52 +699,126 @@ SceneGraph::MergedVolumePalette SceneGraph::merge(bool transform) const {
 		}
 	}
 
-	core::DynamicArray<const SceneGraphNode *> nodes;
-	nodes.reserve(n);
+	core_trace_scoped(SceneGraphMerge);
+	/**
+	 * @brief The part of a node volume that is copied into the merged volume
+	 */
+	struct MergeSource {
+		const SceneGraphNode *node = nullptr;
+		/**
+		 * @brief The voxels of the source volume that might not be air
+		 */
+		voxel::Region sourceRegion;
+		/**
+		 * @brief The offset from the source voxels to the merged voxels - there is no rotation
+		 */
+		glm::ivec3 offset{0};
+		/**
+		 * @brief The color indices of the node palette in the merged palette
+		 */
+		uint8_t colors[voxel::PaletteMaxColors]{};
+	};
+	core::DynamicArray<MergeSource> sources;
+	sources.reserve(n);
 
 	voxel::Region mergedRegion = voxel::Region::InvalidRegion;
 	const voxel::Palette &palette = mergePalettes(true);
 	const KeyFrameIndex keyFrameIdx = 0;
 
 	for (const SceneGraphNode &node : *this) {
-		nodes.push_back(&node);
-
 		voxel::Region region = node.region();
+		glm::ivec3 offset(0);
 		if (transform) {
 			const SceneGraphTransform &transform = node.transform(keyFrameIdx);
 			const glm::vec3 &translation = transform.worldTranslation();
 			region.shift(translation);
+			offset = region.getLowerCorner() - node.region().getLowerCorner();
+			// TODO: rotation
 		}
 		if (mergedRegion.isValid()) {
 			mergedRegion.accumulate(region);
 		} else {
 			mergedRegion = region;
 		}
-	}
 
-	voxel::RawVolume* merged = new voxel::RawVolume(mergedRegion);
-	for (size_t i = 0; i < nodes.size(); ++i) {
-		const SceneGraphNode* node = nodes[i];
-		const voxel::Region& sourceRegion = node->region();
-		voxel::Region destRegion = sourceRegion;
-		if (transform) {
-			const SceneGraphTransform &transform = node->transform(keyFrameIdx);
-			const glm::vec3 &translation = transform.worldTranslation();
-			destRegion.shift(translation);
-			// TODO: rotation
+		// the bounds are only growing - but they never miss a voxel
+		const voxel::RawVolume *volume = node.volume();
+		voxel::Region sourceRegion = volume->region();
+		sourceRegion.cropTo(voxel::Region(volume->mins(), volume->maxs()));
+		if (!sourceRegion.isValid()) {
+			continue;
 		}
-
-		voxelutil::mergeVolumes(merged, node->volume(), destRegion, sourceRegion, [node, &palette] (voxel::Voxel& voxel) {
-			if (isAir(voxel.getMaterial())) {
-				return false;
+		MergeSource source;
+		source.node = &node;
+		source.sourceRegion = sourceRegion;
+		source.offset = offset;
+		sources.push_back(source);
+	}
+
+	// the nodes usually share their colors - the closest match is only searched once per color
+	voxel::PaletteLookup lookup(palette);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	threadPool.parallelFor(0, (int)sources.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			MergeSource &source = sources[i];
+			const voxel::Palette &nodePalette = source.node->palette();
+			for (int c = 0; c < nodePalette.colorCount(); ++c) {
+				source.colors[c] = lookup.findClosestIndex(nodePalette.color(c));
 			}
-			const core::RGBA color = node->palette().color(voxel.getColor());
-			const uint8_t index = palette.getClosestMatch(color);
-			voxel.setColor(index);
-			return true;
-		});
-	}
-	return MergedVolumePalette{merged, palette};
+		}
+	});
+
+	const glm::ivec3 &mergedMins = mergedRegion.getLowerCorner();
+	const glm::ivec3 &dim = mergedRegion.getDimensionsInVoxels();
+	const size_t sliceSize = (size_t)dim.x * (size_t)dim.y;
+	voxel::Voxel *merged = (voxel::Voxel *)core_malloc(sliceSize * (size_t)dim.z * sizeof(voxel::Voxel));
+	constexpr int occupancyLevel = 1;
+	constexpr int brickMask = voxel::OccupancyPyramid::brickSize(occupancyLevel) - 1;
+	// each task owns the z slices of the merged volume - the overlapping nodes are applied in the node order
+	threadPool.parallelFor(0, dim.z, 1, [&](int start, int end) {
+		core_memset((void *)(merged + (size_t)start * sliceSize), 0, (size_t)(end - start) * sliceSize * sizeof(voxel::Voxel));
+		for (const MergeSource &source : sources) {
+			const voxel::RawVolume *volume = source.node->volume();
+			const voxel::Region &region = volume->region();
+			const glm::ivec3 &srcDim = region.getDimensionsInVoxels();
+			const voxel::Voxel *src = (const voxel::Voxel *)volume->data();
+			const voxel::OccupancyPyramid *occupancy = volume->occupancy();
+			const glm::ivec3 &srcMins = source.sourceRegion.getLowerCorner();
+			const glm::ivec3 &srcMaxs = source.sourceRegion.getUpperCorner();
+			const int z0 = core_max(srcMins.z, mergedMins.z + start - source.offset.z);
+			const int z1 = core_min(srcMaxs.z, mergedMins.z + end - 1 - source.offset.z);
+			for (int z = z0; z <= z1; ++z) {
+				for (int y = srcMins.y; y <= srcMaxs.y; ++y) {
+					const voxel::Voxel *srcRow = src + (size_t)(y - region.getLowerY()) * srcDim.x +
+												 (size_t)(z - region.getLowerZ()) * srcDim.x * srcDim.y;
+					const glm::ivec3 destPos = glm::ivec3(0, y, z) + source.offset - mergedMins;
+					voxel::Voxel *destRow = merged + (size_t)destPos.y * dim.x + (size_t)destPos.z * sliceSize;
+					const int srcX = region.getLowerX();
+					const int destX = source.offset.x - mergedMins.x;
+					for (int x = srcMins.x; x <= srcMaxs.x;) {
+						int xEnd = srcMaxs.x;
+						if (occupancy != nullptr) {
+							// skip the empty bricks of the source volume
+							xEnd = core_min(xEnd, x + brickMask - ((x - region.getLowerX()) & brickMask));
+							if (!occupancy->occupied(occupancyLevel, glm::ivec3(x, y, z))) {
+								x = xEnd + 1;
+								continue;
+							}
+						}
+						for (; x <= xEnd; ++x) {
+							voxel::Voxel voxel = srcRow[x - srcX];
+							if (isAir(voxel.getMaterial())) {
+								continue;
+							}
+							voxel.setColor(source.colors[voxel.getColor()]);
+							destRow[x + destX] = voxel;
+						}
+					}
+				}
+			}
+		}
+	});
+	return MergedVolumePalette{voxel::RawVolume::createRaw(merged, mergedRegion), palette};
 }
 
 } // namespace voxel
@@ -7,6 +7,7 @@
 #include "SceneGraphNode.h"
 #include "core/Pair.h"
 #include "core/collection/DynamicArray.h"
+#include "voxel/Region.h"
 
 namespace voxel {
 class RawVolume;
@@ -19,21 +20,66 @@ using SceneGraphAnimationIds = core::DynamicArray<core::String>;
 /**
  * @brief The internal format for the save/load methods.
  *
+ * The nodes are stored by their id in fixed size blocks. Node ids are never reused, so the id is the
+ * index into the blocks and the iteration walks the nodes in memory order. The blocks are never moved,
+ * references to a node stay valid until the node is removed.
+ *
  * @sa SceneGraph
  * @sa SceneGraphNode
  */
 class SceneGraph {
 protected:
-	core::Map<int, SceneGraphNode> _nodes;
+	static constexpr int NodeBlockBits = 5;
+	static constexpr int NodeBlockSize = 1 << NodeBlockBits;
+	static constexpr int NodeBlockMask = NodeBlockSize - 1;
+
+	struct NodeBlock {
+		/** bit mask of the slots that hold a node */
+		uint32_t used = 0u;
+		alignas(SceneGraphNode) uint8_t storage[NodeBlockSize * sizeof(SceneGraphNode)];
+
+		inline SceneGraphNode *slot(int idx) {
+			return (SceneGraphNode *)storage + idx;
+		}
+	};
+	static_assert(NodeBlockSize <= 32, "The used mask must be able to hold all slots of a block");
+
+	core::DynamicArray<NodeBlock *> _nodeBlocks;
+	size_t _nodeCount = 0;
 	int _nextNodeId = 0;
 	int _activeNodeId = InvalidNodeId;
 	SceneGraphAnimationIds _animations;
 	core::String _activeAnimation;
+	/**
+	 * @brief Changed whenever nodes are added, removed or moved in the hierarchy. The value is unique across all
+	 * scene graph instances - this allows the renderers to detect that their cached node states are stale.
+	 * @sa SceneGraphNode::revision()
+	 */
+	uint32_t _revision = 0u;
+
+	struct RegionCache {
+		uint32_t revision = 0u;
+		uint32_t regionRevision = 0u;
+		int activeNode = InvalidNodeId;
+		voxel::Region region;
+	};
+	/**
+	 * @brief The regions are accumulated over all model nodes - they are only recalculated if the structure
+	 * of the graph or the region of any node changed
+	 * @sa SceneGraphNode::regionRevision()
+	 */
+	mutable RegionCache _regionCache;
+	mutable RegionCache _groupRegionCache;
 
+	void markChanged();
 	void updateTransforms_r(SceneGraphNode &node);
+	bool hasDirtyTransforms(const core::String &animation) const;
+	SceneGraphNode *nodePtr(int nodeId) const;
+	void destroyNodes();
+	void insertNode(int nodeId, SceneGraphNode &&node);
 
 public:
-	SceneGraph(int nodes = 262144);
+	SceneGraph(int nodes = 0);
 	~SceneGraph();
 
 	SceneGraph(SceneGraph&& other) noexcept;
@@ -41,6 +87,14 @@ public:
 
 	int activeNode() const;
 	bool setActiveNode(int nodeId);
+	/**
+	 * @return The structural revision of the scene graph - if this value didn't change, the same nodes are still
+	 * part of the graph and only the per node revisions have to be checked for changes.
+	 * @sa SceneGraphNode::revision()
+	 */
+	uint32_t revision() const {
+		return _revision;
+	}
 	/**
 	 * @brief Returns the first valid palette from any of the nodes
 	 */
@@ -59,6 +113,7 @@ public:
 
 	/**
 	 * @return The full region of the whole scene
+	 * @note The result is cached until a node is added, removed or any node region changed
 	 */
 	voxel::Region region() const;
 	/**
@@ -74,6 +129,13 @@ public:
 	bool addAnimation(const core::String &animation);
 	bool removeAnimation(const core::String &animation);
 	FrameIndex maxFrames(const core::String &animation) const;
+	/**
+	 * @brief Interpolates the transforms of all frames of the active animation for all nodes on the thread pool
+	 * @note Call this before the animation is played or exported. Nodes with unchanged key frames are not baked
+	 * again.
+	 * @sa SceneGraphNode::bakeTransforms()
+	 */
+	void bakeAnimation() const;
 	/**
 	 * Checks if at least one of the nodes has multiple keyframes
 	 */
@@ -86,6 +148,9 @@ public:
 	bool setAnimation(const core::String &animation);
 	const core::String &activeAnimation() const;
 
+	/**
+	 * @brief Updates the dirty transforms of all animations. Only the subtrees of the modified nodes are updated.
+	 */
 	void updateTransforms();
 
 	/**
@@ -138,7 +203,7 @@ public:
 	 */
 	size_t size(SceneGraphNodeType type = SceneGraphNodeType::Model) const;
 	size_t nodeSize() const {
-		return _nodes.size();
+		return _nodeCount;
 	}
 
 	using MergedVolumePalette = core::Pair<voxel::RawVolume*, voxel::Palette>;
@@ -170,6 +235,10 @@ public:
 
 		iterator(int startNodeId, int endNodeId, SceneGraphNodeType filter, const SceneGraph *sceneGraph) :
 				_startNodeId(startNodeId), _endNodeId(endNodeId), _filter(filter), _sceneGraph(sceneGraph) {
+			if (_filter == SceneGraphNodeType::Max) {
+				// end iterator
+				_startNodeId = _endNodeId;
+			}
 			while (_startNodeId != _endNodeId) {
 				if (!_sceneGraph->hasNode(_startNodeId)) {
 					++_startNodeId;
@@ -289,4 +358,20 @@ public:
 	}
 };
 
+inline SceneGraphNode *SceneGraph::nodePtr(int nodeId) const {
+	if (nodeId < 0 || nodeId >= _nextNodeId) {
+		return nullptr;
+	}
+	const int blockIdx = nodeId >> NodeBlockBits;
+	if (blockIdx >= (int)_nodeBlocks.size()) {
+		return nullptr;
+	}
+	NodeBlock *block = _nodeBlocks[blockIdx];
+	const int slotIdx = nodeId & NodeBlockMask;
+	if (block == nullptr || (block->used & (1u << slotIdx)) == 0u) {
+		return nullptr;
+	}
+	return block->slot(slotIdx);
+}
+
 } // namespace voxel
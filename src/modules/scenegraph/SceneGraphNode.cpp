@@ -6,6 +6,7 @@
 #include "core/Assert.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
+#include "core/concurrent/Atomic.h"
 #include <glm/gtx/matrix_decompose.hpp>
 #include "util/Easing.h"
 #include "voxel/MaterialColor.h"
@@ -286,6 +287,11 @@ SceneGraphNode::SceneGraphNode(SceneGraphNode &&move) noexcept {
 	_keyFrames = move._keyFrames;
 	move._keyFrames = nullptr;
 	_keyFramesMap = core::move(move._keyFramesMap);
+	++move._keyFramesRevision;
+	_revision = move._revision;
+	++move._revision;
+	_cachedTransform.keyFrames = nullptr;
+	_bakedTransforms.keyFrames = nullptr;
 	_properties = core::move(move._properties);
 	_children = core::move(move._children);
 	_type = move._type;
@@ -311,6 +317,11 @@ SceneGraphNode &SceneGraphNode::operator=(SceneGraphNode &&move) noexcept {
 	_keyFrames = move._keyFrames;
 	move._keyFrames = nullptr;
 	_keyFramesMap = core::move(move._keyFramesMap);
+	++move._keyFramesRevision;
+	_revision = move._revision;
+	++move._revision;
+	_cachedTransform.keyFrames = nullptr;
+	_bakedTransforms.keyFrames = nullptr;
 	_properties = core::move(move._properties);
 	_children = core::move(move._children);
 	_type = move._type;
@@ -320,7 +331,7 @@ SceneGraphNode &SceneGraphNode::operator=(SceneGraphNode &&move) noexcept {
 }
 
 SceneGraphNode::SceneGraphNode(SceneGraphNodeType type)
-	: _type(type), _flags(VolumeOwned | Visible), _properties(128) {
+	: _type(type), _flags(VolumeOwned | Visible) {
 	// ensure that there is at least one animation with keyframes
 	setAnimation(DEFAULT_ANIMATION);
 }
@@ -345,6 +356,7 @@ bool SceneGraphNode::removeAnimation(const core::String &anim) {
 	if (_keyFrames == &iter->value) {
 		_keyFrames = nullptr;
 	}
+	++_keyFramesRevision;
 	_keyFramesMap.erase(iter);
 	if (_keyFramesMap.empty()) {
 		setAnimation(DEFAULT_ANIMATION);
@@ -364,6 +376,9 @@ bool SceneGraphNode::setAnimation(const core::String &anim) {
 	}
 
 	Log::debug("Switched animation for node %s (%i) to %s", _name.c_str(), _id, anim.c_str());
+	if (_keyFrames != &iter->value) {
+		++_keyFramesRevision;
+	}
 	_keyFrames = &iter->value;
 	core_assert_msg(!_keyFrames->empty(), "Empty keyframes for anim %s", anim.c_str());
 	return true;
@@ -375,6 +390,7 @@ void SceneGraphNode::setPalette(const voxel::Palette &palette) {
 	}
 	_palette.setValue(palette);
 	_palette.value()->markDirty();
+	++_revision;
 }
 
 const voxel::Palette &SceneGraphNode::palette() const {
@@ -398,6 +414,7 @@ voxel::Palette &SceneGraphNode::palette() {
 bool SceneGraphNode::setPivot(const glm::vec3 &pivot) {
 	if (voxel::RawVolume *v = volume()) {
 		v->region().setPivot(pivot);
+		markRegionChanged();
 		return true;
 	}
 	return false;
@@ -415,6 +432,7 @@ glm::vec3 SceneGraphNode::worldPivot() const {
  * @brief Apply the given @c translation vector to all keyframe transform of this node
  */
 void SceneGraphNode::translate(const glm::vec3 &translation) {
+	++_keyFramesRevision;
 	for (auto* keyFrames : _keyFramesMap) {
 		for (SceneGraphKeyFrame &keyFrame : keyFrames->value) {
 			SceneGraphTransform &transform = keyFrame.transform();
@@ -424,6 +442,17 @@ void SceneGraphNode::translate(const glm::vec3 &translation) {
 }
 
 
+static core::AtomicInt s_regionRevision;
+
+uint32_t SceneGraphNode::regionRevision() {
+	return (uint32_t)(int)s_regionRevision;
+}
+
+void SceneGraphNode::markRegionChanged() {
+	++_revision;
+	s_regionRevision.increment(1);
+}
+
 void SceneGraphNode::release() {
 	if (_flags & VolumeOwned) {
 		delete _volume;
@@ -437,6 +466,7 @@ void SceneGraphNode::releaseOwnership() {
 
 void SceneGraphNode::setVolume(voxel::RawVolume *volume, bool transferOwnership) {
 	release();
+	markRegionChanged();
 	if (transferOwnership) {
 		_flags |= VolumeOwned;
 	} else {
@@ -447,6 +477,7 @@ void SceneGraphNode::setVolume(voxel::RawVolume *volume, bool transferOwnership)
 
 void SceneGraphNode::setVolume(const voxel::RawVolume *volume, bool transferOwnership) {
 	release();
+	markRegionChanged();
 	if (transferOwnership) {
 		_flags |= VolumeOwned;
 	} else {
@@ -472,6 +503,7 @@ bool SceneGraphNode::setReference(int nodeId) {
 		return false;
 	}
 	_referenceId = nodeId;
+	++_revision;
 	return true;
 }
 
@@ -532,17 +564,23 @@ const SceneGraphNodeChildren &SceneGraphNode::children() const {
 	return _children;
 }
 
-const core::StringMap<core::String> &SceneGraphNode::properties() const {
+const SceneGraphNodeProperties &SceneGraphNode::properties() const {
 	return _properties;
 }
 
-core::StringMap<core::String> &SceneGraphNode::properties() {
+SceneGraphNodeProperties &SceneGraphNode::properties() {
+	// the caller might modify the properties
+	++_revision;
 	return _properties;
 }
 
 core::String SceneGraphNode::property(const core::String &key) const {
 	core::String value;
-	_properties.get(key, value);
+	// a key that was never interned can't be part of the properties
+	const core::Name name = core::Name::find(key);
+	if (!name.empty()) {
+		_properties.get(name, value);
+	}
 	return value;
 }
 
@@ -550,33 +588,28 @@ float SceneGraphNode::propertyf(const core::String& key) const {
 	return property(key).toFloat();
 }
 
-void SceneGraphNode::addProperties(const core::StringMap<core::String> &map) {
+void SceneGraphNode::addProperties(const SceneGraphNodeProperties &map) {
 	for (const auto &entry : map) {
-		setProperty(entry->key, entry->value);
+		_properties.put(entry->key, entry->value);
 	}
+	++_revision;
 }
 
 bool SceneGraphNode::setProperty(const core::String& key, const char *value) {
-	if (_properties.size() >= _properties.capacity()) {
-		return false;
-	}
 	_properties.put(key, value);
+	++_revision;
 	return true;
 }
 
 bool SceneGraphNode::setProperty(const core::String& key, bool value) {
-	if (_properties.size() >= _properties.capacity()) {
-		return false;
-	}
 	_properties.put(key, core::string::toString(value));
+	++_revision;
 	return true;
 }
 
 bool SceneGraphNode::setProperty(const core::String& key, const core::String& value) {
-	if (_properties.size() >= _properties.capacity()) {
-		return false;
-	}
 	_properties.put(key, value);
+	++_revision;
 	return true;
 }
 
@@ -626,9 +659,15 @@ const SceneGraphKeyFrames &SceneGraphNode::keyFrames(const core::String &anim) c
 }
 
 SceneGraphKeyFrames *SceneGraphNode::keyFrames() {
+	// the caller might modify the key frames
+	++_keyFramesRevision;
 	return _keyFrames;
 }
 
+void SceneGraphNode::markKeyFramesDirty() {
+	++_keyFramesRevision;
+}
+
 bool SceneGraphNode::hasActiveAnimation() const {
 	return _keyFrames != nullptr;
 }
@@ -693,6 +732,7 @@ bool SceneGraphNode::setKeyFrames(const SceneGraphKeyFrames &kf) {
 
 void SceneGraphNode::setAllKeyFrames(const SceneGraphKeyFramesMap &map, const core::String &animation) {
 	_keyFramesMap = map;
+	++_keyFramesRevision;
 	setAnimation(animation);
 }
 
@@ -790,7 +830,42 @@ SceneGraphTransform SceneGraphNode::transformForFrame(const SceneGraphKeyFrames
 }
 
 SceneGraphTransform SceneGraphNode::transformForFrame(FrameIndex frameIdx) const {
-	return transformForFrame(keyFrames(), frameIdx);
+	const SceneGraphKeyFrames &kfs = keyFrames();
+	if (frameIdx >= 0 && _bakedTransforms.keyFrames == &kfs && _bakedTransforms.revision == _keyFramesRevision) {
+		// the transforms after the last key frame don't change anymore
+		const int bakedIdx = core_min(frameIdx, (FrameIndex)_bakedTransforms.transforms.size() - 1);
+		return _bakedTransforms.transforms[bakedIdx];
+	}
+	if (_cachedTransform.keyFrames == &kfs && _cachedTransform.frameIdx == frameIdx &&
+		_cachedTransform.revision == _keyFramesRevision) {
+		return _cachedTransform.transform;
+	}
+	_cachedTransform.transform = transformForFrame(kfs, frameIdx);
+	_cachedTransform.keyFrames = &kfs;
+	_cachedTransform.frameIdx = frameIdx;
+	_cachedTransform.revision = _keyFramesRevision;
+	return _cachedTransform.transform;
+}
+
+bool SceneGraphNode::hasBakedTransforms() const {
+	return _bakedTransforms.keyFrames == &keyFrames() && _bakedTransforms.revision == _keyFramesRevision;
+}
+
+void SceneGraphNode::bakeTransforms() const {
+	if (hasBakedTransforms()) {
+		return;
+	}
+	const SceneGraphKeyFrames &kfs = keyFrames();
+	FrameIndex maxFrameIdx = 0;
+	for (const auto &keyframe : kfs) {
+		maxFrameIdx = core_max(keyframe.frameIdx, maxFrameIdx);
+	}
+	_bakedTransforms.transforms.resize((size_t)maxFrameIdx + 1);
+	for (FrameIndex frameIdx = 0; frameIdx <= maxFrameIdx; ++frameIdx) {
+		_bakedTransforms.transforms[frameIdx] = transformForFrame(kfs, frameIdx);
+	}
+	_bakedTransforms.keyFrames = &kfs;
+	_bakedTransforms.revision = _keyFramesRevision;
 }
 
 FrameIndex SceneGraphNode::maxFrame(const core::String &animation) const {
@@ -6,10 +6,12 @@
 
 #include "core/Optional.h"
 #include "core/RGBA.h"
+#include "core/Name.h"
 #include "core/String.h"
 #include "core/ArrayLength.h"
 #include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/SmallVector.h"
 #include "core/collection/StringMap.h"
 #include "voxel/Palette.h"
 
@@ -179,10 +181,13 @@ public:
 	}
 };
 
-using SceneGraphNodeChildren = const core::Buffer<int, 32>;
+using SceneGraphNodeChildren = const core::SmallVector<int, 4>;
 using SceneGraphKeyFrames = core::DynamicArray<SceneGraphKeyFrame>;
 using SceneGraphKeyFramesMap = core::StringMap<SceneGraphKeyFrames>;
-using SceneGraphNodeProperties = core::StringMap<core::String>;
+/**
+ * the keys are interned - most of the nodes share the same property names
+ */
+using SceneGraphNodeProperties = core::NameMap<core::String>;
 
 #define InvalidNodeId (-1)
 
@@ -217,9 +222,42 @@ protected:
 	voxel::RawVolume *_volume = nullptr;
 	SceneGraphKeyFramesMap _keyFramesMap;
 	SceneGraphKeyFrames *_keyFrames = nullptr;
-	core::Buffer<int, 32> _children;
+	core::SmallVector<int, 4> _children;
 	SceneGraphNodeProperties _properties;
 	mutable core::Optional<voxel::Palette> _palette;
+	/**
+	 * @brief Increased for every (possible) modification of the key frames - this invalidates the cached
+	 * interpolated transform
+	 */
+	uint32_t _keyFramesRevision = 0u;
+	/**
+	 * @brief Increased for every change of the node state that is relevant for rendering (volume, palette,
+	 * visibility, pivot, reference and properties)
+	 */
+	uint32_t _revision = 0u;
+	struct CachedTransform {
+		const SceneGraphKeyFrames *keyFrames = nullptr;
+		uint32_t revision = 0u;
+		FrameIndex frameIdx = 0;
+		SceneGraphTransform transform;
+	};
+	/**
+	 * @brief The last interpolated transform of the active animation - scrubbing through the animation or
+	 * rendering the same frame again doesn't need to interpolate the transforms of unchanged nodes
+	 */
+	mutable CachedTransform _cachedTransform;
+	struct BakedTransforms {
+		const SceneGraphKeyFrames *keyFrames = nullptr;
+		uint32_t revision = 0u;
+		/**
+		 * @brief One interpolated transform per frame - starting at frame @c 0 up to the last key frame
+		 */
+		core::DynamicArray<SceneGraphTransform> transforms;
+	};
+	/**
+	 * @brief The interpolated transforms of all frames of the active animation - see bakeTransforms()
+	 */
+	mutable BakedTransforms _bakedTransforms;
 
 	/**
 	 * @brief Called in emplace() if a parent id is given
@@ -227,6 +265,11 @@ protected:
 	void setParent(int id);
 	void setId(int id);
 	void sortKeyFrames();
+	/**
+	 * @brief Called for changes of the volume, the pivot or the locked state
+	 * @sa regionRevision()
+	 */
+	void markRegionChanged();
 
 public:
 	~SceneGraphNode() { release(); }
@@ -296,6 +339,20 @@ public:
 	 */
 	void setVolume(const voxel::RawVolume *volume, bool transferOwnership);
 
+	/**
+	 * @return A value that changes whenever the volume, the palette, the visibility, the pivot, the reference,
+	 * the properties or the key frames of this node were modified. Renderers compare this against the value
+	 * of the last update to skip unchanged nodes.
+	 * @note Modifying the palette or the volume region in place is not detected - call @c markDirty() then.
+	 */
+	uint32_t revision() const;
+	void markDirty();
+	/**
+	 * @return A value that is changed whenever the volume, the pivot or the locked state of any node was
+	 * modified. This allows the scene graph to cache the regions of the model nodes.
+	 */
+	static uint32_t regionRevision();
+
 	// meta data
 
 	const core::String &name() const;
@@ -307,11 +364,11 @@ public:
 	void setLocked(bool locked);
 
 	const SceneGraphNodeChildren &children() const;
-	const core::StringMap<core::String> &properties() const;
-	core::StringMap<core::String> &properties();
+	const SceneGraphNodeProperties &properties() const;
+	SceneGraphNodeProperties &properties();
 	core::String property(const core::String& key) const;
 	float propertyf(const core::String& key) const;
-	void addProperties(const core::StringMap<core::String>& map);
+	void addProperties(const SceneGraphNodeProperties& map);
 
 	bool setProperty(const core::String& key, const char *value);
 	bool setProperty(const core::String& key, bool value);
@@ -327,6 +384,10 @@ public:
 	 * @sa hasActiveAnimation()
 	 */
 	SceneGraphKeyFrames *keyFrames();
+	/**
+	 * @brief Invalidates the cached transforms if the key frames were modified through the const accessors
+	 */
+	void markKeyFramesDirty();
 	/**
 	 * @brief Set the keyframes for the current active animation
 	 */
@@ -349,10 +410,26 @@ public:
 	 * @brief Interpolates the transforms for the given frame. It searches the keyframe before and after
 	 * the given input frame and interpolates according to the given delta frames between the particular
 	 * keyframes.
+	 * @note The result for the active animation is cached until the key frames are modified. If the
+	 * animation was baked, this is a lookup into the baked transforms.
+	 * @sa bakeTransforms()
 	 */
 	SceneGraphTransform transformForFrame(FrameIndex frameIdx) const;
 	SceneGraphTransform transformForFrame(const core::String &animation, FrameIndex frameIdx) const;
 	SceneGraphTransform transformForFrame(const SceneGraphKeyFrames &kfs, FrameIndex frameIdx) const;
+	/**
+	 * @brief Interpolates the transforms of all frames of the active animation up to the last key frame. The
+	 * playback or the export of an animation doesn't need to search and interpolate the key frames for every
+	 * frame then.
+	 * @note The baked transforms are discarded once the key frames are modified - a second call is a no-op if the
+	 * key frames didn't change.
+	 * @sa SceneGraph::bakeAnimation()
+	 */
+	void bakeTransforms() const;
+	/**
+	 * @return @c true if the transforms of the active animation are baked and up to date
+	 */
+	bool hasBakedTransforms() const;
 
 	/**
 	 * @note Only use this accessor if you know that the given key frame index exists
@@ -487,7 +564,16 @@ inline bool SceneGraphNode::visible() const {
 	return _flags & Visible;
 }
 
+inline uint32_t SceneGraphNode::revision() const {
+	return _revision + _keyFramesRevision;
+}
+
+inline void SceneGraphNode::markDirty() {
+	markRegionChanged();
+}
+
 inline void SceneGraphNode::setVisible(bool visible) {
+	++_revision;
 	if (visible) {
 		_flags |= Visible;
 	} else {
@@ -505,7 +591,7 @@ inline void SceneGraphNode::setLocked(bool locked) {
 	} else {
 		_flags &= ~Locked;
 	}
-
+	markRegionChanged();
 }
 
 } // namespace voxel
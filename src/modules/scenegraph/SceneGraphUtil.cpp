@@ -122,7 +122,8 @@ int addSceneGraphNodes(SceneGraph &target, SceneGraph &source, int parent) {
 	return nodesAdded;
 }
 
-static int copySceneGraphNode_r(SceneGraph &target, const SceneGraph &source, const SceneGraphNode &sourceNode, int parent) {
+static int copySceneGraphNode_r(SceneGraph &target, const SceneGraph &source, const SceneGraphNode &sourceNode, int parent,
+								core::Map<int, int> &nodeMapping) {
 	SceneGraphNode newNode(sourceNode.type());
 	copy(sourceNode, newNode);
 	if (newNode.type() == SceneGraphNodeType::Model) {
@@ -133,24 +134,41 @@ static int copySceneGraphNode_r(SceneGraph &target, const SceneGraph &source, co
 		Log::error("Failed to add node to the scene graph");
 		return 0;
 	}
+	nodeMapping.put(sourceNode.id(), newNodeId);
 
 	int nodesAdded = sourceNode.type() == SceneGraphNodeType::Model ? 1 : 0;
 	for (int sourceNodeIdx : sourceNode.children()) {
 		core_assert(source.hasNode(sourceNodeIdx));
-		SceneGraphNode &sourceChildNode = source.node(sourceNodeIdx);
-		nodesAdded += addSceneGraphNode_r(target, source, sourceChildNode, newNodeId);
+		const SceneGraphNode &sourceChildNode = source.node(sourceNodeIdx);
+		nodesAdded += copySceneGraphNode_r(target, source, sourceChildNode, newNodeId, nodeMapping);
 	}
 
 	return nodesAdded;
 }
 
-int copySceneGraph(SceneGraph &target, const SceneGraph &source) {
+int copySceneGraph(SceneGraph &target, const SceneGraph &source, int parent, core::Map<int, int> *outNodeMapping) {
 	const SceneGraphNode &sourceRoot = source.root();
 	int nodesAdded = 0;
-	const int parent = target.root().id();
 	target.node(parent).addProperties(sourceRoot.properties());
+	core::Map<int, int> nodeMapping;
 	for (int sourceNodeId : sourceRoot.children()) {
-		nodesAdded += copySceneGraphNode_r(target, source, source.node(sourceNodeId), parent);
+		nodesAdded += copySceneGraphNode_r(target, source, source.node(sourceNodeId), parent, nodeMapping);
+	}
+	// the node ids of the target scene graph are not the same - so the references must be updated
+	for (const auto &entry : nodeMapping) {
+		SceneGraphNode &node = target.node(entry->value);
+		if (node.type() != SceneGraphNodeType::ModelReference) {
+			continue;
+		}
+		auto iter = nodeMapping.find(node.reference());
+		if (iter == nodeMapping.end()) {
+			Log::warn("Referenced node %i was not copied", node.reference());
+			continue;
+		}
+		node.setReference(iter->value);
+	}
+	if (outNodeMapping != nullptr) {
+		*outNodeMapping = core::move(nodeMapping);
 	}
 	return nodesAdded;
 }
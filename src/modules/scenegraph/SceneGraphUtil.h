@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "core/collection/Map.h"
 #include "scenegraph/SceneGraph.h"
 
 namespace scenegraph {
@@ -18,7 +19,15 @@ int addNodeToSceneGraph(SceneGraph &sceneGraph, SceneGraphNode &node, int parent
 
 int addSceneGraphNodes(SceneGraph& target, SceneGraph& source, int parent);
 
-int copySceneGraph(SceneGraph &target, const SceneGraph &source, int parent);
+/**
+ * @brief Copies the nodes of the source scene graph - including the volumes - below the given parent node of the
+ * target scene graph. Model references are updated to point to the copied nodes.
+ * @param[out] nodeMapping If not @c null this is filled with the ids of the source nodes mapped to the ids of the
+ * copied nodes
+ * @return The amount of copied model nodes
+ */
+int copySceneGraph(SceneGraph &target, const SceneGraph &source, int parent,
+				   core::Map<int, int> *nodeMapping = nullptr);
 
 int createNodeReference(SceneGraph &target, const SceneGraphNode &node);
 
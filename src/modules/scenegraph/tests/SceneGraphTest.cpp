@@ -48,6 +48,26 @@ TEST_F(SceneGraphTest, testHasNode) {
 	EXPECT_FALSE(sceneGraph.hasNode(2));
 }
 
+TEST_F(SceneGraphTest, testManyNodes) {
+	SceneGraph sceneGraph;
+	const SceneGraphNode *root = &sceneGraph.root();
+	for (int i = 0; i < 200; ++i) {
+		SceneGraphNode node(SceneGraphNodeType::Group);
+		EXPECT_EQ(i + 1, sceneGraph.emplace(core::move(node)));
+	}
+	EXPECT_EQ(root, &sceneGraph.root()) << "Adding nodes must not move the existing ones";
+	EXPECT_EQ(201u, sceneGraph.nodeSize());
+	for (int i = 1; i <= 100; ++i) {
+		EXPECT_TRUE(sceneGraph.removeNode(i, false));
+	}
+	EXPECT_FALSE(sceneGraph.hasNode(100));
+	EXPECT_TRUE(sceneGraph.hasNode(101));
+	EXPECT_EQ(101u, sceneGraph.nodeSize());
+	EXPECT_EQ(100u, sceneGraph.size(SceneGraphNodeType::Group));
+	SceneGraphNode node(SceneGraphNodeType::Group);
+	EXPECT_EQ(201, sceneGraph.emplace(core::move(node))) << "Node ids are not reused";
+}
+
 TEST_F(SceneGraphTest, testNodeRoot) {
 	SceneGraph sceneGraph;
 	const SceneGraphNode& root = sceneGraph.node(0);
@@ -254,6 +274,41 @@ TEST_F(SceneGraphTest, testMerge) {
 	delete merged.first;
 }
 
+TEST_F(SceneGraphTest, testMergeTranslatedOverlap) {
+	SceneGraph sceneGraph;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setName("node1");
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 3));
+		v->setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		v->setVoxel(3, 3, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		node.setVolume(v, true);
+		sceneGraph.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setName("node2");
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 1));
+		v->setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+		node.setVolume(v, true);
+		SceneGraphTransform transform;
+		transform.setWorldTranslation(glm::vec3(3.0f));
+		node.setTransform(0, transform);
+		sceneGraph.emplace(core::move(node));
+	}
+	SceneGraph::MergedVolumePalette merged = sceneGraph.merge(true);
+	ASSERT_NE(nullptr, merged.first);
+	EXPECT_EQ(voxel::Region(0, 4), merged.first->region());
+	const voxel::Voxel &first = merged.first->voxel(0, 0, 0);
+	ASSERT_FALSE(voxel::isAir(first.getMaterial()));
+	const voxel::Voxel &overlap = merged.first->voxel(3, 3, 3);
+	ASSERT_FALSE(voxel::isAir(overlap.getMaterial()));
+	// the later node wins where the nodes overlap
+	EXPECT_NE(first.getColor(), overlap.getColor());
+	EXPECT_TRUE(voxel::isAir(merged.first->voxel(4, 4, 4).getMaterial()));
+	delete merged.first;
+}
+
 TEST_F(SceneGraphTest, testKeyframes) {
 	SceneGraphNode node(SceneGraphNodeType::Group);
 	EXPECT_EQ(InvalidKeyFrame, node.addKeyFrame(0));
@@ -274,6 +329,116 @@ TEST_F(SceneGraphTest, testKeyframes) {
 	EXPECT_EQ(1u, kfs.size());
 }
 
+TEST_F(SceneGraphTest, testTransformForFrameCache) {
+	SceneGraph sceneGraph;
+	int nodeId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Group);
+		nodeId = sceneGraph.emplace(core::move(node));
+	}
+	SceneGraphNode &node = sceneGraph.node(nodeId);
+	ASSERT_NE(InvalidKeyFrame, node.addKeyFrame(10));
+	const KeyFrameIndex keyFrameIdx = node.keyFrameForFrame(10);
+	node.transform(keyFrameIdx).setLocalTranslation(glm::vec3(10.0f, 0.0f, 0.0f));
+	sceneGraph.updateTransforms();
+	EXPECT_FLOAT_EQ(5.0f, node.transformForFrame(5).worldTranslation().x);
+	EXPECT_FLOAT_EQ(5.0f, node.transformForFrame(5).worldTranslation().x);
+
+	node.transform(keyFrameIdx).setLocalTranslation(glm::vec3(20.0f, 0.0f, 0.0f));
+	sceneGraph.updateTransforms();
+	EXPECT_FLOAT_EQ(10.0f, node.transformForFrame(5).worldTranslation().x) << "The cached transform wasn't invalidated";
+}
+
+TEST_F(SceneGraphTest, testBakeAnimation) {
+	SceneGraph sceneGraph;
+	int nodeId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Group);
+		nodeId = sceneGraph.emplace(core::move(node));
+	}
+	SceneGraphNode &node = sceneGraph.node(nodeId);
+	ASSERT_NE(InvalidKeyFrame, node.addKeyFrame(10));
+	const KeyFrameIndex keyFrameIdx = node.keyFrameForFrame(10);
+	node.transform(keyFrameIdx).setLocalTranslation(glm::vec3(10.0f, 0.0f, 0.0f));
+	sceneGraph.updateTransforms();
+	EXPECT_FALSE(node.hasBakedTransforms());
+	sceneGraph.bakeAnimation();
+	EXPECT_TRUE(node.hasBakedTransforms());
+	const SceneGraphNode &constNode = node;
+	for (FrameIndex frameIdx = 0; frameIdx <= 12; ++frameIdx) {
+		EXPECT_FLOAT_EQ(constNode.transformForFrame(constNode.keyFrames(), frameIdx).worldTranslation().x,
+						constNode.transformForFrame(frameIdx).worldTranslation().x)
+			<< "Frame " << frameIdx;
+	}
+
+	node.transform(keyFrameIdx).setLocalTranslation(glm::vec3(20.0f, 0.0f, 0.0f));
+	sceneGraph.updateTransforms();
+	EXPECT_FALSE(node.hasBakedTransforms()) << "Modifying the key frames must discard the baked transforms";
+	EXPECT_FLOAT_EQ(10.0f, node.transformForFrame(5).worldTranslation().x);
+	sceneGraph.bakeAnimation();
+	EXPECT_FLOAT_EQ(10.0f, node.transformForFrame(5).worldTranslation().x);
+}
+
+TEST_F(SceneGraphTest, testRevision) {
+	SceneGraph sceneGraph;
+	uint32_t graphRevision = sceneGraph.revision();
+	int nodeId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 1)), true);
+		nodeId = sceneGraph.emplace(core::move(node));
+	}
+	EXPECT_NE(graphRevision, sceneGraph.revision());
+	graphRevision = sceneGraph.revision();
+
+	SceneGraphNode &node = sceneGraph.node(nodeId);
+	const SceneGraphNode &constNode = node;
+	uint32_t nodeRevision = node.revision();
+	EXPECT_EQ(nodeRevision, constNode.revision());
+	constNode.transformForFrame(0);
+	EXPECT_EQ(nodeRevision, node.revision()) << "Read access must not change the revision";
+
+	node.setVisible(false);
+	EXPECT_NE(nodeRevision, node.revision());
+	nodeRevision = node.revision();
+	node.setVolume(new voxel::RawVolume(voxel::Region(0, 2)), true);
+	EXPECT_NE(nodeRevision, node.revision());
+	nodeRevision = node.revision();
+	node.setTransform(0, SceneGraphTransform());
+	EXPECT_NE(nodeRevision, node.revision());
+	EXPECT_EQ(graphRevision, sceneGraph.revision()) << "Node modifications must not change the graph revision";
+
+	sceneGraph.removeNode(nodeId, false);
+	EXPECT_NE(graphRevision, sceneGraph.revision());
+}
+
+TEST_F(SceneGraphTest, testRegionCache) {
+	SceneGraph sceneGraph;
+	int nodeId;
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 1)), true);
+		nodeId = sceneGraph.emplace(core::move(node));
+	}
+	EXPECT_EQ(voxel::Region(0, 1), sceneGraph.region());
+	{
+		SceneGraphNode node(SceneGraphNodeType::Model);
+		node.setVolume(new voxel::RawVolume(voxel::Region(2, 3)), true);
+		sceneGraph.emplace(core::move(node));
+	}
+	EXPECT_EQ(voxel::Region(0, 3), sceneGraph.region()) << "Adding a node must invalidate the cached region";
+	EXPECT_EQ(voxel::Region(0, 1), sceneGraph.groupRegion());
+
+	SceneGraphNode &node = sceneGraph.node(nodeId);
+	node.setVolume(new voxel::RawVolume(voxel::Region(-2, 1)), true);
+	EXPECT_EQ(voxel::Region(-2, 3), sceneGraph.region()) << "Replacing a volume must invalidate the cached region";
+	EXPECT_EQ(voxel::Region(-2, 1), sceneGraph.groupRegion());
+
+	node.volume()->translate(glm::ivec3(-1));
+	node.markDirty();
+	EXPECT_EQ(voxel::Region(-3, 3), sceneGraph.region());
+}
+
 TEST_F(SceneGraphTest, testMoveParentAsNewChild) {
 	SceneGraph sceneGraph;
 	int originalParentNodeId = 1;
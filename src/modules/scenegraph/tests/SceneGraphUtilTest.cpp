@@ -34,4 +34,37 @@ TEST_F(SceneGraphUtilTest, testAddSceneGraphNodes) {
 	ASSERT_EQ(1, target.node(2).parent());
 }
 
+TEST_F(SceneGraphUtilTest, testCopySceneGraph) {
+	SceneGraph source;
+	{
+		// create a gap in the node ids
+		SceneGraphNode node(SceneGraphNodeType::Group);
+		node.setName("removed");
+		ASSERT_TRUE(source.removeNode(source.emplace(core::move(node)), false));
+	}
+	int modelNodeId = -1;
+	{
+		SceneGraphNode node;
+		node.setName("model");
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 1)), true);
+		modelNodeId = source.emplace(core::move(node));
+	}
+	{
+		SceneGraphNode node(SceneGraphNodeType::ModelReference);
+		node.setName("reference");
+		node.setReference(modelNodeId);
+		source.emplace(core::move(node));
+	}
+	SceneGraph target;
+	EXPECT_EQ(1, copySceneGraph(target, source, target.root().id()));
+	const SceneGraphNode *model = target.findNodeByName("model");
+	ASSERT_NE(nullptr, model);
+	ASSERT_NE(nullptr, model->volume());
+	EXPECT_NE(source.node(modelNodeId).volume(), model->volume()) << "The volume should be copied";
+	EXPECT_EQ(voxel::Region(0, 1), model->region());
+	const SceneGraphNode *reference = target.findNodeByName("reference");
+	ASSERT_NE(nullptr, reference);
+	EXPECT_EQ(model->id(), reference->reference());
+}
+
 } // namespace voxelformat
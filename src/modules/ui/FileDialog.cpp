@@ -78,7 +78,11 @@ static core::String assemblePath(const core::String &dir, const io::FilesystemEn
 void FileDialog::applyFilter(video::OpenFileMode type) {
 	_files.clear();
 	_files.reserve(_entities.size());
+	_sortFiles = true;
 	for (size_t i = 0; i < _entities.size(); ++i) {
+		if (hide(_entities[i].name)) {
+			continue;
+		}
 		if (_entities[i].type == io::FilesystemEntry::Type::dir) {
 			_files.push_back(&_entities[i]);
 			continue;
@@ -199,15 +203,46 @@ bool FileDialog::openDir(video::OpenFileMode type, const io::FormatDescription*
 
 bool FileDialog::readDir(video::OpenFileMode type) {
 	_entities.clear();
-	if (!io::filesystem()->list(_currentPath, _entities)) {
-		Log::warn("Failed to list dir %s", _currentPath.c_str());
-		return false;
-	}
-
-	applyFilter(type);
+	_files.clear();
+	_listing = io::filesystem()->listAsync(_currentPath, app::App::getInstance()->threadPool());
+	_listingOffset = 0u;
+	_pendingListing = io::DirectoryListingPtr();
+	_listingCheckMillis = app::App::getInstance()->timeProvider()->tickNow();
+	updateListing(type);
 	return true;
 }
 
+void FileDialog::updateListing(video::OpenFileMode type) {
+	if (!_listing) {
+		return;
+	}
+	const uint64_t now = app::App::getInstance()->timeProvider()->tickNow();
+	bool changed = false;
+	if (_pendingListing) {
+		// keep showing the old entities until the new listing is complete to not flicker
+		if (_pendingListing->complete()) {
+			_entities.clear();
+			_listing = _pendingListing;
+			_listingOffset = 0u;
+			_pendingListing = io::DirectoryListingPtr();
+			changed = true;
+		}
+	} else if (_listing->complete() && now - _listingCheckMillis > 1000UL) {
+		_listingCheckMillis = now;
+		const io::DirectoryListingPtr &listing =
+			io::filesystem()->listAsync(_currentPath, app::App::getInstance()->threadPool());
+		if (listing.get() != _listing.get()) {
+			_pendingListing = listing;
+		}
+	}
+	const size_t offset = _listing->fetch(_entities, _listingOffset);
+	if (changed || offset != _listingOffset) {
+		// the pointers in _files are invalid after the entities were modified
+		_listingOffset = offset;
+		applyFilter(type);
+	}
+}
+
 bool FileDialog::quickAccessEntry(video::OpenFileMode type, const core::String& path, float width, const char *title, const char *icon) {
 	if (path.empty()) {
 		return false;
@@ -374,7 +409,7 @@ bool FileDialog::entitiesPanel(video::OpenFileMode type) {
 
 		// Sort files
 		if (ImGuiTableSortSpecs *specs = ImGui::TableGetSortSpecs()) {
-			if (specs->SpecsDirty && _files.size() > 1U) {
+			if ((specs->SpecsDirty || _sortFiles) && _files.size() > 1U) {
 				for (int n = 0; n < specs->SpecsCount; n++) {
 					const ImGuiTableColumnSortSpecs &spec = specs->Specs[n];
 					if (spec.SortDirection == ImGuiSortDirection_Ascending) {
@@ -384,6 +419,7 @@ bool FileDialog::entitiesPanel(video::OpenFileMode type) {
 					}
 				}
 				specs->SpecsDirty = false;
+				_sortFiles = false;
 			}
 		}
 
@@ -402,71 +438,102 @@ bool FileDialog::entitiesPanel(video::OpenFileMode type) {
 			ImGui::TableNextColumn();
 		}
 
-		// add filtered and sorted directory entries
-		for (size_t i = 0; i < _files.size(); ++i) {
-			const io::FilesystemEntry entry = *_files[i];
-			if (hide(entry.name)) {
-				continue;
-			}
-			ImGui::TableNextColumn();
-			const bool selected = i == _entryIndex;
-			if (selected) {
-				_selectedEntry = *_files[i];
-			}
-			const char *icon = iconForType(entry.type);
-			const float x = ImGui::GetCursorPosX();
-			if (icon != nullptr) {
-				ImGui::TextUnformatted(icon);
-			} else {
-				ImGui::TextUnformatted("");
-			}
-			ImGui::SameLine();
-			ImGui::SetCursorPosX(x + 1.5f * (float)imguiApp()->fontSize());
-			if (ImGui::Selectable(entry.name.c_str(), selected, ImGuiSelectableFlags_AllowDoubleClick, size)) {
-				resetState();
-				_entryIndex = i;
-				_selectedEntry = *_files[i];
-				if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
-					if (entry.isDirectory()) {
-						setCurrentPath(type, assemblePath(_currentPath, *_files[i]));
+		// add filtered and sorted directory entries - only the visible rows are submitted
+		core::String changeDir;
+		ImGuiListClipper clipper;
+		clipper.Begin((int)_files.size());
+		while (clipper.Step()) {
+			for (size_t i = (size_t)clipper.DisplayStart; i < (size_t)clipper.DisplayEnd; ++i) {
+				const io::FilesystemEntry entry = *_files[i];
+				ImGui::TableNextColumn();
+				const bool selected = i == _entryIndex;
+				if (selected) {
+					_selectedEntry = *_files[i];
+				}
+				const char *icon = iconForType(entry.type);
+				const float x = ImGui::GetCursorPosX();
+				// the preview replaces the icon
+				if (!thumbnail(entry, ImGui::GetTextLineHeight())) {
+					if (icon != nullptr) {
+						ImGui::TextUnformatted(icon);
 					} else {
-						doubleClickedFile = true;
+						ImGui::TextUnformatted("");
 					}
 				}
-			}
-			if (entry.type == io::FilesystemEntry::Type::dir) {
-				if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
-					_dragAndDropName = core::string::path(_currentPath, entry.name);
-					ImGui::TextUnformatted(_dragAndDropName.c_str());
-					ImGui::SetDragDropPayload(FILEDIALOGBOOKMARKDND, &_dragAndDropName, sizeof(core::String),
-												ImGuiCond_Always);
-					ImGui::EndDragDropSource();
+				ImGui::SameLine();
+				ImGui::SetCursorPosX(x + 1.5f * (float)imguiApp()->fontSize());
+				if (ImGui::Selectable(entry.name.c_str(), selected, ImGuiSelectableFlags_AllowDoubleClick, size)) {
+					resetState();
+					_entryIndex = i;
+					_selectedEntry = *_files[i];
+					if (ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left)) {
+						if (entry.isDirectory()) {
+							// the entities are cleared when changing the directory
+							changeDir = assemblePath(_currentPath, *_files[i]);
+						} else {
+							doubleClickedFile = true;
+						}
+					}
 				}
-			}
-			ImGui::TableNextColumn();
-			const core::String &humanSize = core::string::humanSize(entry.size);
-			ImGui::TextUnformatted(humanSize.c_str());
-			ImGui::TableNextColumn();
-			if (entry.isDirectory()) {
-				ImGui::TextUnformatted("directory");
-			} else {
-				const core::String &fileExt = core::string::extractExtension(entry.name);
-				if (fileExt.empty()) {
-					ImGui::TextUnformatted("-");
+				if (entry.type == io::FilesystemEntry::Type::dir) {
+					if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
+						_dragAndDropName = core::string::path(_currentPath, entry.name);
+						ImGui::TextUnformatted(_dragAndDropName.c_str());
+						ImGui::SetDragDropPayload(FILEDIALOGBOOKMARKDND, &_dragAndDropName, sizeof(core::String),
+													ImGuiCond_Always);
+						ImGui::EndDragDropSource();
+					}
+				}
+				ImGui::TableNextColumn();
+				const core::String &humanSize = core::string::humanSize(entry.size);
+				ImGui::TextUnformatted(humanSize.c_str());
+				ImGui::TableNextColumn();
+				if (entry.isDirectory()) {
+					ImGui::TextUnformatted("directory");
 				} else {
-					ImGui::TextUnformatted(fileExt.c_str());
+					const core::String &fileExt = core::string::extractExtension(entry.name);
+					if (fileExt.empty()) {
+						ImGui::TextUnformatted("-");
+					} else {
+						ImGui::TextUnformatted(fileExt.c_str());
+					}
 				}
+				ImGui::TableNextColumn();
+				const core::String &lastModified = core::TimeProvider::toString(entry.mtime);
+				ImGui::TextUnformatted(lastModified.c_str());
 			}
-			ImGui::TableNextColumn();
-			const core::String &lastModified = core::TimeProvider::toString(entry.mtime);
-			ImGui::TextUnformatted(lastModified.c_str());
 		}
 		ImGui::EndTable();
+		if (!changeDir.empty()) {
+			setCurrentPath(type, changeDir);
+		}
 	}
 	ImGui::EndChild();
 	return doubleClickedFile;
 }
 
+bool FileDialog::thumbnail(const io::FilesystemEntry &entry, float size) {
+	if (!_thumbnails || !entry.isFile()) {
+		return false;
+	}
+	const video::TexturePtr &texture = _thumbnails(assemblePath(_currentPath, entry));
+	if (!texture) {
+		return false;
+	}
+	// uploads the preview once it was created
+	const video::Id handle = texture->handle();
+	if (!texture->isLoaded()) {
+		return false;
+	}
+	ImGui::Image(handle, ImVec2(size, size));
+	if (ImGui::IsItemHovered()) {
+		ImGui::BeginTooltip();
+		ImGui::Image(handle, ImVec2((float)texture->width(), (float)texture->height()));
+		ImGui::EndTooltip();
+	}
+	return true;
+}
+
 void FileDialog::addBookmark(const core::String &bookmark) {
 	Log::error("Add new bookmark: %s", bookmark.c_str());
 	removeBookmark(bookmark);
@@ -643,6 +710,7 @@ bool FileDialog::showFileDialog(video::FileDialogOptions &options, core::String
 		if (ImGui::IsKeyPressed(ImGuiKey_Escape)) {
 			ImGui::CloseCurrentPopup();
 		}
+		updateListing(type);
 		currentPathPanel(type);
 		quickAccessPanel(type, _bookmarks->strVal());
 		ImGui::SameLine();
@@ -658,7 +726,9 @@ bool FileDialog::showFileDialog(video::FileDialogOptions &options, core::String
 			_selectedEntry.type = io::FilesystemEntry::Type::file;
 			_entryIndex = -1;
 		}
-		ImGui::CheckboxVar("Show hidden##filedialog", _showHidden);
+		if (ImGui::CheckboxVar("Show hidden##filedialog", _showHidden)) {
+			applyFilter(type);
+		}
 		popupNewFolder();
 		if (popupAlreadyExists()) {
 			buffer = assemblePath(_currentPath, _selectedEntry);
@@ -8,9 +8,11 @@
 
 #include "core/TimedValue.h"
 #include "core/collection/DynamicArray.h"
+#include "io/DirectoryListing.h"
 #include "io/FilesystemEntry.h"
 #include "core/Var.h"
 #include "video/FileDialogOptions.h"
+#include "video/Texture.h"
 #ifdef __EMSCRIPTEN__
 #include "io/system/emscripten_browser_file.h"
 #endif
@@ -21,6 +23,12 @@ struct FormatDescription;
 
 namespace ui {
 
+/**
+ * @brief Returns the texture with the preview of the given file - or an empty texture pointer if the file has no
+ * preview. The texture may still be loading and is only shown once it's loaded.
+ */
+using FileDialogThumbnails = std::function<video::TexturePtr(const core::String &file)>;
+
 class FileDialog {
 private:
 	// current active path
@@ -29,6 +37,13 @@ private:
 	core::DynamicArray<io::FilesystemEntry> _entities;
 	// sorted and filtered pointers to the cached file system entities
 	core::DynamicArray<const io::FilesystemEntry*> _files;
+	// the entities are fetched from the listing while the directory is listed in the background
+	io::DirectoryListingPtr _listing;
+	size_t _listingOffset = 0u;
+	// a new listing of the current directory that replaces the current one once it's complete
+	io::DirectoryListingPtr _pendingListing;
+	uint64_t _listingCheckMillis = 0u;
+	bool _sortFiles = false;
 
 	using TimedError = core::TimedValue<core::String>;
 	TimedError _error;
@@ -51,6 +66,7 @@ private:
 	TimedError _newFolderError;
 
 	core::String _dragAndDropName;
+	FileDialogThumbnails _thumbnails;
 
 	void setCurrentPath(video::OpenFileMode type, const core::String& path);
 	void selectFilter(video::OpenFileMode type, int index);
@@ -58,6 +74,10 @@ private:
 	void resetState();
 	void applyFilter(video::OpenFileMode type);
 	bool readDir(video::OpenFileMode type);
+	/**
+	 * @brief Fetches the entities that were listed since the last call and checks the directory for modifications
+	 */
+	void updateListing(video::OpenFileMode type);
 	void removeBookmark(const core::String &bookmark);
 	void addBookmark(const core::String &bookmark);
 	bool quickAccessEntry(video::OpenFileMode type, const core::String& path, float width, const char *title = nullptr, const char *icon = nullptr);
@@ -72,6 +92,11 @@ private:
 	 */
 	bool entitiesPanel(video::OpenFileMode type);
 	void showError(const TimedError &error) const;
+	/**
+	 * @brief Shows the preview of the given file if it's loaded - the preview is only requested for the visible rows
+	 * @return @c true if the preview was shown
+	 */
+	bool thumbnail(const io::FilesystemEntry &entry, float size);
 
 #ifdef __EMSCRIPTEN__
 	static void uploadHandler(std::string const& filename, std::string const& mimetype, std::string_view buffer, void* userdata);
@@ -79,6 +104,7 @@ private:
 
 public:
 	void construct();
+	void setThumbnails(const FileDialogThumbnails &thumbnails);
 
 	bool openDir(video::OpenFileMode type, const io::FormatDescription* formats, const core::String& filename = "");
 	/**
@@ -90,4 +116,8 @@ public:
 						const io::FormatDescription **formatDesc = nullptr);
 };
 
+inline void FileDialog::setThumbnails(const FileDialogThumbnails &thumbnails) {
+	_thumbnails = thumbnails;
+}
+
 }
@@ -20,6 +20,7 @@
 #include "core/Log.h"
 #include "io/FormatDescription.h"
 #include "math/Rect.h"
+#include "video/GPUTimer.h"
 #include "video/Renderer.h"
 #include "video/Shader.h"
 #include "video/ScopedViewPort.h"
@@ -511,7 +512,20 @@ app::AppState IMGUIApp::onRunning() {
 	ImGui::EndFrame();
 	ImGui::Render();
 
-	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	{
+		video_gpu_scoped(ImGui);
+		ImDrawData *drawData = ImGui::GetDrawData();
+		ImGui_ImplOpenGL3_RenderDrawData(drawData);
+		// the imgui backend doesn't use the renderer functions - so count the draw calls here
+		video::RenderStats &stats = video::renderStats();
+		for (int i = 0; i < drawData->CmdListsCount; ++i) {
+			stats.drawCalls += (uint32_t)drawData->CmdLists[i]->CmdBuffer.Size;
+		}
+		stats.triangles += (uint64_t)(drawData->TotalIdxCount / 3);
+		stats.bufferUploads += (uint32_t)drawData->CmdListsCount * 2u;
+		stats.bufferUploadBytes += (uint64_t)drawData->TotalVtxCount * sizeof(ImDrawVert) +
+								   (uint64_t)drawData->TotalIdxCount * sizeof(ImDrawIdx);
+	}
 
 	// Update and Render additional Platform Windows
 	if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable) {
@@ -118,8 +118,16 @@ public:
 	void showBindingsDialog();
 	void showTexturesDialog();
 	void fileDialog(const video::FileDialogSelectionCallback& callback, const video::FileDialogOptions& options, video::OpenFileMode mode, const io::FormatDescription* formats = nullptr, const core::String &filename = "") override;
+	/**
+	 * @brief Shows the previews of the given provider in the file dialog
+	 */
+	void setFileDialogThumbnails(const FileDialogThumbnails &thumbnails);
 };
 
+inline void IMGUIApp::setFileDialogThumbnails(const FileDialogThumbnails &thumbnails) {
+	_fileDialog.setThumbnails(thumbnails);
+}
+
 inline void IMGUIApp::showBindingsDialog() {
 	_showBindingsDialog = true;
 }
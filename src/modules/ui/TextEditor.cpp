@@ -22,6 +22,7 @@ TextEditor::TextEditor() : _startTime(SDL_GetTicks()) {
 	SetPalette(GetDarkPalette());
 	SetLanguageDefinition(LanguageDefinition::Lua());
 	_lines.push_back(Line());
+	_lineStates.push_back(LineState());
 }
 
 TextEditor::~TextEditor() {
@@ -469,6 +470,7 @@ void TextEditor::RemoveLine(int aStart, int aEnd) {
 	_breakpoints = core::move(btmp);
 
 	_lines.erase(aStart, aEnd);
+	_lineStates.erase(aStart, aEnd);
 	core_assert(!_lines.empty());
 
 	_textChanged = true;
@@ -498,6 +500,7 @@ void TextEditor::RemoveLine(int aIndex) {
 	_breakpoints = core::move(btmp);
 
 	_lines.erase(_lines.begin() + aIndex);
+	_lineStates.erase(_lineStates.begin() + aIndex);
 	core_assert(!_lines.empty());
 
 	_textChanged = true;
@@ -507,6 +510,7 @@ TextEditor::Line &TextEditor::InsertLine(int aIndex) {
 	core_assert(!_readOnly);
 
 	_lines.insert(_lines.begin() + aIndex, Line());
+	_lineStates.insert(_lineStates.begin() + aIndex, LineState());
 	auto &result = _lines[aIndex];
 
 	ErrorMarkers etmp;
@@ -739,18 +743,19 @@ void TextEditor::Render() {
 	snprintf(buf, 16, " %d ", globalLineMax);
 	_textStart = ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(), FLT_MAX, -1.0f, buf, nullptr, nullptr).x +
 				 (float)_leftMargin;
+	_spaceSize = ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(), FLT_MAX, -1.0f, " ", nullptr, nullptr).x;
+	// only the visible lines are laid out and rendered - they are also colorized first in the next frame
+	_visibleLineMin = lineNo;
+	_visibleLineMax = lineMax;
 
 	if (!_lines.empty()) {
-		float spaceSize =
-			ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(), FLT_MAX, -1.0f, " ", nullptr, nullptr).x;
+		const float spaceSize = _spaceSize;
 
 		while (lineNo <= lineMax) {
 			ImVec2 lineStartScreenPos = ImVec2(cursorScreenPos.x, cursorScreenPos.y + lineNo * _charAdvance.y);
 			ImVec2 textScreenPos = ImVec2(lineStartScreenPos.x + _textStart, lineStartScreenPos.y);
 
 			Line &line = _lines[lineNo];
-			longest =
-				core_max(_textStart + TextDistanceToLineStart(Coordinates(lineNo, GetLineMaxColumn(lineNo))), longest);
 			int columnNo = 0;
 			Coordinates lineStartCoord(lineNo, 0);
 			Coordinates lineEndCoord(lineNo, GetLineMaxColumn(lineNo));
@@ -914,8 +919,14 @@ void TextEditor::Render() {
 			if (!_lineBuffer.empty()) {
 				const ImVec2 newOffset(textScreenPos.x + bufferOffset.x, textScreenPos.y + bufferOffset.y);
 				drawList->AddText(newOffset, prevColor, _lineBuffer.c_str());
+				bufferOffset.x += ImGui::GetFont()
+									  ->CalcTextSizeA(ImGui::GetFontSize(), FLT_MAX, -1.0f, _lineBuffer.c_str(),
+													  nullptr, nullptr)
+									  .x;
 				_lineBuffer.clear();
 			}
+			// the text layout of the line gives its width - no need to measure it again
+			longest = core_max(_textStart + bufferOffset.x, longest);
 
 			++lineNo;
 		}
@@ -996,6 +1007,9 @@ void TextEditor::SetText(const core::String &aText) {
 		}
 	}
 
+	_lineStates.clear();
+	_lineStates.resize(_lines.size());
+
 	_textChanged = true;
 	_scrollToTop = true;
 
@@ -1022,6 +1036,9 @@ void TextEditor::SetTextLines(const core::DynamicArray<core::String> &aLines) {
 		}
 	}
 
+	_lineStates.clear();
+	_lineStates.resize(_lines.size());
+
 	_textChanged = true;
 	_scrollToTop = true;
 
@@ -1821,7 +1838,8 @@ void TextEditor::Colorize(int aFromLine, int aLines) {
 	_colorRangeMax = core_max(_colorRangeMax, toLine);
 	_colorRangeMin = core_max(0, _colorRangeMin);
 	_colorRangeMax = core_max(_colorRangeMin, _colorRangeMax);
-	_checkComments = true;
+	_commentRangeMin = core_max(0, core_min(_commentRangeMin, aFromLine));
+	_commentRangeMax = core_max(_commentRangeMax, toLine);
 }
 
 void TextEditor::ColorizeRange(int aFromLine, int aToLine) {
@@ -1927,131 +1945,203 @@ void TextEditor::ColorizeRange(int aFromLine, int aToLine) {
 	}
 }
 
-void TextEditor::ColorizeInternal() {
-	if (_lines.empty() || !_colorizerEnabled)
+void TextEditor::ColorizeComments() {
+	if (_commentRangeMin >= _commentRangeMax) {
 		return;
+	}
+	const size_t endLine = _lines.size();
+	if (_lineStates.size() != endLine) {
+		// not in sync - rescan the whole text
+		_lineStates.clear();
+		_lineStates.resize(endLine);
+		_commentRangeMin = 0;
+	}
+	const int endIndex = 0;
+	size_t currentLine = (size_t)core_max(0, core_min(_commentRangeMin, (int)endLine - 1));
+	// resume with the state the scanner had at the start of the first changed line - inserted lines don't have a
+	// state yet
+	while (currentLine > 0 && !_lineStates[currentLine].mValid) {
+		--currentLine;
+	}
+	LineState startState;
+	if (currentLine > 0) {
+		startState = _lineStates[currentLine];
+	}
+	size_t commentStartLine = startState.mWithinMultiLineComment ? currentLine - 1 : endLine;
+	int commentStartIndex = endIndex;
+	bool withinString = startState.mWithinString;
+	bool withinSingleLineComment = startState.mWithinSingleLineComment;
+	bool withinPreproc = startState.mWithinPreproc;
+	bool firstChar = startState.mFirstChar; // there is no other non-whitespace characters in the line before
+	bool concatenate = startState.mConcatenate; // '\' on the very end of the line
+	int currentIndex = 0;
+	// the state at the start of the line that is scanned next
+	auto lineStart = [&]() {
+		if (currentLine >= endLine) {
+			return false;
+		}
+		LineState state;
+		state.mValid = true;
+		state.mWithinString = withinString;
+		state.mWithinMultiLineComment = commentStartLine < currentLine;
+		state.mWithinSingleLineComment = withinSingleLineComment;
+		state.mWithinPreproc = withinPreproc;
+		state.mFirstChar = firstChar;
+		state.mConcatenate = concatenate;
+		if ((int)currentLine >= _commentRangeMax && _lineStates[currentLine] == state) {
+			// the following lines are unchanged and start with the same state - they don't change either
+			return true;
+		}
+		_lineStates[currentLine] = state;
+		return false;
+	};
+	lineStart();
+	while (currentLine < endLine || currentIndex < endIndex) {
+		TextEditor::Line &line = _lines[currentLine];
+
+		if (currentIndex == 0 && !concatenate) {
+			withinSingleLineComment = false;
+			withinPreproc = false;
+			firstChar = true;
+		}
 
-	if (_checkComments) {
-		size_t endLine = _lines.size();
-		int endIndex = 0;
-		size_t commentStartLine = endLine;
-		int commentStartIndex = endIndex;
-		bool withinString = false;
-		bool withinSingleLineComment = false;
-		bool withinPreproc = false;
-		bool firstChar = true;	  // there is no other non-whitespace characters in the line before
-		bool concatenate = false; // '\' on the very end of the line
-		size_t currentLine = 0;
-		int currentIndex = 0;
-		while (currentLine < endLine || currentIndex < endIndex) {
-			TextEditor::Line &line = _lines[currentLine];
-
-			if (currentIndex == 0 && !concatenate) {
-				withinSingleLineComment = false;
-				withinPreproc = false;
-				firstChar = true;
-			}
-
-			concatenate = false;
+		concatenate = false;
 
-			if (!line.empty()) {
-				TextEditor::Glyph &g = line[currentIndex];
-				TextEditor::Char c = g.mChar;
+		if (!line.empty()) {
+			TextEditor::Glyph &g = line[currentIndex];
+			TextEditor::Char c = g.mChar;
 
-				if (c != (Char)_languageDefinition.mPreprocChar && !SDL_isspace(c)) {
-					firstChar = false;
-				}
+			if (c != (Char)_languageDefinition.mPreprocChar && !SDL_isspace(c)) {
+				firstChar = false;
+			}
 
-				if (currentIndex == (int)line.size() - 1 && line[line.size() - 1].mChar == '\\')
-					concatenate = true;
+			if (currentIndex == (int)line.size() - 1 && line[line.size() - 1].mChar == '\\')
+				concatenate = true;
 
-				bool inComment = (commentStartLine < currentLine ||
-								  (commentStartLine == currentLine && commentStartIndex <= currentIndex));
+			bool inComment = (commentStartLine < currentLine ||
+							  (commentStartLine == currentLine && commentStartIndex <= currentIndex));
 
-				if (withinString) {
-					line[currentIndex].mMultiLineComment = inComment;
+			if (withinString) {
+				line[currentIndex].mMultiLineComment = inComment;
 
-					if (c == '\"') {
-						if (currentIndex + 1 < (int)line.size() && line[currentIndex + 1].mChar == '\"') {
-							currentIndex += 1;
-							if (currentIndex < (int)line.size())
-								line[currentIndex].mMultiLineComment = inComment;
-						} else
-							withinString = false;
-					} else if (c == '\\') {
+				if (c == '\"') {
+					if (currentIndex + 1 < (int)line.size() && line[currentIndex + 1].mChar == '\"') {
 						currentIndex += 1;
 						if (currentIndex < (int)line.size())
 							line[currentIndex].mMultiLineComment = inComment;
-					}
-				} else {
-					if (firstChar && c == (Char)_languageDefinition.mPreprocChar)
-						withinPreproc = true;
-
-					if (c == '\"') {
-						withinString = true;
+					} else
+						withinString = false;
+				} else if (c == '\\') {
+					currentIndex += 1;
+					if (currentIndex < (int)line.size())
 						line[currentIndex].mMultiLineComment = inComment;
-					} else {
-						auto pred = [](const char &a, const Glyph &b) { return (Char)a == b.mChar; };
-						auto from = line.begin() + currentIndex;
-						core::String &startStr = _languageDefinition.mCommentStart;
-						core::String &singleStartStr = _languageDefinition.mSingleLineComment;
-
-						if (singleStartStr.size() > 0 && currentIndex + singleStartStr.size() <= line.size() &&
-							equals(singleStartStr.begin(), singleStartStr.end(), from, from + singleStartStr.size(),
-								   pred)) {
-							withinSingleLineComment = true;
-						} else if (!withinSingleLineComment && currentIndex + startStr.size() <= line.size() &&
-								   equals(startStr.begin(), startStr.end(), from, from + startStr.size(), pred)) {
-							commentStartLine = currentLine;
-							commentStartIndex = currentIndex;
-						}
+				}
+			} else {
+				if (firstChar && c == (Char)_languageDefinition.mPreprocChar)
+					withinPreproc = true;
 
-						inComment = (commentStartLine < currentLine ||
-									 (commentStartLine == currentLine && commentStartIndex <= currentIndex));
+				if (c == '\"') {
+					withinString = true;
+					line[currentIndex].mMultiLineComment = inComment;
+				} else {
+					auto pred = [](const char &a, const Glyph &b) { return (Char)a == b.mChar; };
+					auto from = line.begin() + currentIndex;
+					core::String &startStr = _languageDefinition.mCommentStart;
+					core::String &singleStartStr = _languageDefinition.mSingleLineComment;
+
+					if (singleStartStr.size() > 0 && currentIndex + singleStartStr.size() <= line.size() &&
+						equals(singleStartStr.begin(), singleStartStr.end(), from, from + singleStartStr.size(),
+							   pred)) {
+						withinSingleLineComment = true;
+					} else if (!withinSingleLineComment && currentIndex + startStr.size() <= line.size() &&
+							   equals(startStr.begin(), startStr.end(), from, from + startStr.size(), pred)) {
+						commentStartLine = currentLine;
+						commentStartIndex = currentIndex;
+					}
 
-						line[currentIndex].mMultiLineComment = inComment;
-						line[currentIndex].mComment = withinSingleLineComment;
+					inComment = (commentStartLine < currentLine ||
+								 (commentStartLine == currentLine && commentStartIndex <= currentIndex));
 
-						core::String &endStr = _languageDefinition.mCommentEnd;
-						if (currentIndex + 1 >= (int)endStr.size() &&
-							equals(endStr.begin(), endStr.end(), from + 1 - endStr.size(), from + 1, pred)) {
-							commentStartIndex = endIndex;
-							commentStartLine = endLine;
-						}
+					line[currentIndex].mMultiLineComment = inComment;
+					line[currentIndex].mComment = withinSingleLineComment;
+
+					core::String &endStr = _languageDefinition.mCommentEnd;
+					if (currentIndex + 1 >= (int)endStr.size() &&
+						equals(endStr.begin(), endStr.end(), from + 1 - endStr.size(), from + 1, pred)) {
+						commentStartIndex = endIndex;
+						commentStartLine = endLine;
 					}
 				}
-				line[currentIndex].mPreprocessor = withinPreproc;
-				currentIndex += core::utf8::lengthInt((int)c);
-				if (currentIndex >= (int)line.size()) {
-					currentIndex = 0;
-					++currentLine;
-				}
-			} else {
+			}
+			line[currentIndex].mPreprocessor = withinPreproc;
+			currentIndex += core::utf8::lengthInt((int)c);
+			if (currentIndex >= (int)line.size()) {
 				currentIndex = 0;
 				++currentLine;
+				if (lineStart()) {
+					break;
+				}
+			}
+		} else {
+			currentIndex = 0;
+			++currentLine;
+			if (lineStart()) {
+				break;
 			}
 		}
-		_checkComments = false;
 	}
+	_commentRangeMin = std::numeric_limits<int>::max();
+	_commentRangeMax = 0;
+}
 
-	if (_colorRangeMin < _colorRangeMax) {
-		const int increment = (_languageDefinition.mTokenize == nullptr) ? 10 : 10000;
+void TextEditor::ColorizeInternal() {
+	if (_lines.empty() || !_colorizerEnabled)
+		return;
+
+	ColorizeComments();
+
+	if (_colorRangeMin >= _colorRangeMax) {
+		return;
+	}
+
+	// the visible lines first - they don't count into the budget
+	const int visibleMin = core_max(_colorRangeMin, _visibleLineMin);
+	const int visibleMax = core_min(_colorRangeMax, _visibleLineMax + 1);
+	if (visibleMin < visibleMax) {
+		ColorizeRange(visibleMin, visibleMax);
+		if (visibleMin == _colorRangeMin) {
+			_colorRangeMin = visibleMax;
+		} else if (visibleMax == _colorRangeMax) {
+			_colorRangeMax = visibleMin;
+		}
+	}
+
+	// the rest of the lines in chunks until the time budget of this frame is used up
+	const int increment = (_languageDefinition.mTokenize == nullptr) ? 10 : 1000;
+	const uint64_t start = SDL_GetPerformanceCounter();
+	const double millisPerTick = 1000.0 / (double)SDL_GetPerformanceFrequency();
+	while (_colorRangeMin < _colorRangeMax) {
 		const int to = core_min(_colorRangeMin + increment, _colorRangeMax);
 		ColorizeRange(_colorRangeMin, to);
 		_colorRangeMin = to;
-
-		if (_colorRangeMax == _colorRangeMin) {
-			_colorRangeMin = std::numeric_limits<int>::max();
-			_colorRangeMax = 0;
+		if ((double)(SDL_GetPerformanceCounter() - start) * millisPerTick > ColorizeBudgetMillis) {
+			break;
 		}
-		return;
+	}
+
+	if (_colorRangeMin >= _colorRangeMax) {
+		_colorRangeMin = std::numeric_limits<int>::max();
+		_colorRangeMax = 0;
 	}
 }
 
 float TextEditor::TextDistanceToLineStart(const Coordinates &aFrom) const {
 	auto &line = _lines[aFrom.mLine];
 	float distance = 0.0f;
-	float spaceSize = ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(), FLT_MAX, -1.0f, " ", nullptr, nullptr).x;
+	const float spaceSize =
+		_spaceSize > 0.0f
+			? _spaceSize
+			: ImGui::GetFont()->CalcTextSizeA(ImGui::GetFontSize(), FLT_MAX, -1.0f, " ", nullptr, nullptr).x;
 	int colIndex = GetCharacterIndex(aFrom);
 	for (size_t it = 0u; it < line.size() && it < (size_t)colIndex;) {
 		if (line[it].mChar == '\t') {
@@ -2179,6 +2269,33 @@ static bool TokenizeCStyleString(const char *in_begin, const char *in_end, const
 	return false;
 }
 
+static bool TokenizeLuaString(const char *in_begin, const char *in_end, const char *&out_begin,
+							  const char *&out_end) {
+	const char *p = in_begin;
+	const char quote = *p;
+
+	if (quote == '"' || quote == '\'') {
+		p++;
+
+		while (p < in_end) {
+			// handle end of string
+			if (*p == quote) {
+				out_begin = in_begin;
+				out_end = p + 1;
+				return true;
+			}
+
+			// handle escape characters
+			if (*p == '\\' && p + 1 < in_end)
+				p++;
+
+			p++;
+		}
+	}
+
+	return false;
+}
+
 static bool TokenizeCStyleCharacterLiteral(const char *in_begin, const char *in_end, const char *&out_begin,
 										   const char *&out_end) {
 	const char *p = in_begin;
@@ -2738,20 +2855,29 @@ const TextEditor::LanguageDefinition &TextEditor::LanguageDefinition::Lua() {
 			langDef.mIdentifiers.put(core::String(k), id);
 		}
 
-		langDef.mTokenRegexStrings.push_back(
-			std::make_pair<core::String, PaletteIndex>("L?\\\"(\\\\.|[^\\\"])*\\\"", PaletteIndex::String));
-		langDef.mTokenRegexStrings.push_back(
-			std::make_pair<core::String, PaletteIndex>("\\\'[^\\\']*\\\'", PaletteIndex::String));
-		langDef.mTokenRegexStrings.push_back(
-			std::make_pair<core::String, PaletteIndex>("0[xX][0-9a-fA-F]+[uU]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.mTokenRegexStrings.push_back(std::make_pair<core::String, PaletteIndex>(
-			"[+-]?([0-9]+([.][0-9]*)?|[.][0-9]+)([eE][+-]?[0-9]+)?[fF]?", PaletteIndex::Number));
-		langDef.mTokenRegexStrings.push_back(
-			std::make_pair<core::String, PaletteIndex>("[+-]?[0-9]+[Uu]?[lL]?[lL]?", PaletteIndex::Number));
-		langDef.mTokenRegexStrings.push_back(
-			std::make_pair<core::String, PaletteIndex>("[a-zA-Z_][a-zA-Z0-9_]*", PaletteIndex::Identifier));
-		langDef.mTokenRegexStrings.push_back(std::make_pair<core::String, PaletteIndex>(
-			"[\\[\\]\\{\\}\\!\\%\\^\\&\\*\\(\\)\\-\\+\\=\\~\\|\\<\\>\\?\\/\\;\\,\\.]", PaletteIndex::Punctuation));
+		// a hand written tokenizer is much faster than the regular expressions for big scripts
+		langDef.mTokenize = [](const char *in_begin, const char *in_end, const char *&out_begin, const char *&out_end,
+							   PaletteIndex &paletteIndex) -> bool {
+			paletteIndex = PaletteIndex::Max;
+
+			while (in_begin < in_end && isascii(*in_begin) && isblank(*in_begin))
+				in_begin++;
+
+			if (in_begin == in_end) {
+				out_begin = in_end;
+				out_end = in_end;
+				paletteIndex = PaletteIndex::Default;
+			} else if (TokenizeLuaString(in_begin, in_end, out_begin, out_end))
+				paletteIndex = PaletteIndex::String;
+			else if (TokenizeCStyleIdentifier(in_begin, in_end, out_begin, out_end))
+				paletteIndex = PaletteIndex::Identifier;
+			else if (TokenizeCStyleNumber(in_begin, in_end, out_begin, out_end))
+				paletteIndex = PaletteIndex::Number;
+			else if (TokenizeCStylePunctuation(in_begin, in_end, out_begin, out_end))
+				paletteIndex = PaletteIndex::Punctuation;
+
+			return paletteIndex != PaletteIndex::Max;
+		};
 
 		langDef.mCommentStart = "--[[";
 		langDef.mCommentEnd = "]]";
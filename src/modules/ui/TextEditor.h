@@ -328,10 +328,35 @@ private:
 
 	typedef core::DynamicArray<UndoRecord> UndoBuffer;
 
+	/**
+	 * @brief The state of the comment scanner at the start of a line - the scan of an edit stops at the first line
+	 * after the changed lines that starts with the same state as before
+	 */
+	struct LineState {
+		bool mValid = false;
+		bool mWithinString = false;
+		bool mWithinMultiLineComment = false;
+		bool mWithinSingleLineComment = false;
+		bool mWithinPreproc = false;
+		bool mFirstChar = true;
+		bool mConcatenate = false;
+
+		bool operator==(const LineState &o) const {
+			return mValid == o.mValid && mWithinString == o.mWithinString &&
+				   mWithinMultiLineComment == o.mWithinMultiLineComment &&
+				   mWithinSingleLineComment == o.mWithinSingleLineComment && mWithinPreproc == o.mWithinPreproc &&
+				   mFirstChar == o.mFirstChar && mConcatenate == o.mConcatenate;
+		}
+	};
+	typedef core::DynamicArray<LineState> LineStates;
+	/** the max time in milliseconds that is spent per frame to colorize lines that are not visible */
+	static constexpr double ColorizeBudgetMillis = 2.0;
+
 	void ProcessInputs();
 	void Colorize(int aFromLine = 0, int aCount = -1);
 	void ColorizeRange(int aFromLine = 0, int aToLine = 0);
 	void ColorizeInternal();
+	void ColorizeComments();
 	float TextDistanceToLineStart(const Coordinates &aFrom) const;
 	void EnsureCursorVisible();
 	int GetPageSize() const;
@@ -367,6 +392,8 @@ private:
 
 	float _lineSpacing = 1.0f;
 	Lines _lines;
+	/** the comment scanner state at the start of each line - in sync with @c _lines */
+	LineStates _lineStates;
 	EditorState _state;
 	UndoBuffer _undoBuffer;
 	int _undoIndex = 0;
@@ -378,6 +405,14 @@ private:
 	int _leftMargin = 10;
 	int _colorRangeMin = 0;
 	int _colorRangeMax = 0;
+	/** the lines that must be scanned for comments again */
+	int _commentRangeMin = 0;
+	int _commentRangeMax = 0;
+	/** the lines that were visible in the last frame - they are colorized first */
+	int _visibleLineMin = 0;
+	int _visibleLineMax = 0;
+	/** the width of a space character of the current font - updated once per frame */
+	float _spaceSize = 0.0f;
 	SelectionMode _selectionMode = SelectionMode::Normal;
 
 	bool _overwrite = false;
@@ -391,7 +426,6 @@ private:
 	bool _handleMouseInputs = true;
 	bool _ignoreImGuiChild = false;
 	bool _showWhitespaces = true;
-	bool _checkComments = true;
 	bool _cursorPositionChanged = false;
 
 	Palette _paletteBase;
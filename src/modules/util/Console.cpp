@@ -14,6 +14,8 @@
 #include "core/collection/Set.h"
 #include "core/Common.h"
 #include "core/Color.h"
+#include "core/GameConfig.h"
+#include "core/StringUtil.h"
 #include "core/Tokenizer.h"
 #include "command/CommandHandler.h"
 #include "VarUtil.h"
@@ -78,6 +80,13 @@ void Console::construct() {
 	command::Command::registerCommand("toggleconsole", [&] (const command::CmdArgs& args) { toggle(); }).setHelp("Toggle the built-in console");
 	command::Command::registerCommand("clear", [&] (const command::CmdArgs& args) { clear(); }).setHelp("Clear the text from the built-in console");
 	command::Command::registerCommand("history", [&] (const command::CmdArgs& args) { printHistory(); }).setHelp("Print the command history");
+	command::Command::registerCommand("consolefilter", [&] (const command::CmdArgs& args) {
+		setFilter(args.empty() ? "" : args[0]);
+	}).setHelp("Only show the console lines that contain the given string - no argument shows all lines");
+	_consoleLines = core::Var::get(cfg::CoreConsoleLines, "4096", "The amount of log lines the built-in console keeps",
+								   core::Var::minMaxValidator<16, 1000000>);
+	_messages.setCapacity(_consoleLines->intVal());
+	_consoleLines->markClean();
 }
 
 bool Console::init() {
@@ -108,6 +117,7 @@ void Console::shutdown() {
 	command::Command::unregisterCommand("toggleconsole");
 	command::Command::unregisterCommand("clear");
 	command::Command::unregisterCommand("history");
+	command::Command::unregisterCommand("consolefilter");
 	SDL_LogSetOutputFunction((SDL_LogOutputFunction)_logFunction, _logUserData);
 }
 
@@ -117,6 +127,62 @@ void Console::printHistory() {
 	}
 }
 
+void Console::addMessage(core::String &&message) {
+	const bool matches = !_filter.empty() && core::string::icontains(message, _filter);
+	const uint64_t sequence = _messages.push(core::move(message));
+	if (matches) {
+		_filtered.push_back(sequence);
+	}
+	pruneFiltered();
+}
+
+void Console::pruneFiltered() {
+	while (_filteredStart < _filtered.size() && !_messages.contains(_filtered[_filteredStart])) {
+		++_filteredStart;
+	}
+	// compact the index once the dropped entries take more than half of it
+	if (_filteredStart > 0u && _filteredStart * 2u >= _filtered.size()) {
+		_filtered.erase(0, _filteredStart);
+		_filteredStart = 0u;
+	}
+}
+
+void Console::rebuildFiltered() {
+	_filtered.clear();
+	_filteredStart = 0u;
+	if (_filter.empty()) {
+		return;
+	}
+	for (size_t i = 0u; i < _messages.size(); ++i) {
+		if (core::string::icontains(_messages[i], _filter)) {
+			_filtered.push_back(_messages.first() + i);
+		}
+	}
+}
+
+void Console::setFilter(const core::String &filter) {
+	if (_filter == filter) {
+		return;
+	}
+	_filter = filter;
+	_scrollPos = 0;
+	rebuildFiltered();
+}
+
+int Console::visibleMessages() const {
+	if (_filter.empty()) {
+		return (int)_messages.size();
+	}
+	return (int)(_filtered.size() - _filteredStart);
+}
+
+const core::String &Console::visibleMessage(int idx) const {
+	if (_filter.empty()) {
+		return _messages[_messages.size() - 1 - idx];
+	}
+	return _messages.bySequence(_filtered[_filtered.size() - 1 - idx]);
+}
+
 bool Console::onKeyPress(int32_t key, int16_t modifier) {
 	if (!_consoleActive) {
 		return false;
@@ -141,7 +207,7 @@ bool Console::onKeyPress(int32_t key, int16_t modifier) {
 		} else if (key == SDLK_e) {
 			_cursorPos = (int)_commandLine.size();
 		} else if (key == SDLK_c) {
-			_messages.push_back(_consolePrompt + _commandLine);
+			addMessage(_consolePrompt + _commandLine);
 			clearCommandLine();
 		} else if (key == SDLK_l) {
 			clear();
@@ -163,7 +229,7 @@ bool Console::onKeyPress(int32_t key, int16_t modifier) {
 
 	if (modifier & KMOD_SHIFT) {
 		if (key == SDLK_HOME) {
-			_scrollPos = (int)_messages.size() - _maxLines + 1;
+			_scrollPos = core_max(visibleMessages() - _maxLines + 1, 0);
 		} else if (key == SDLK_END) {
 			_scrollPos = 0;
 		} else if (key == SDLK_PAGEUP) {
@@ -224,7 +290,7 @@ bool Console::onKeyPress(int32_t key, int16_t modifier) {
 }
 
 void Console::executeCommandLine() {
-	_messages.push_back(_consolePrompt + _commandLine);
+	addMessage(_consolePrompt + _commandLine);
 	_scrollPos = 0;
 	if (_commandLine.empty()) {
 		return;
@@ -359,7 +425,7 @@ void Console::cursorDown() {
 }
 
 void Console::scrollUp(const int lines) {
-	const int scrollableLines = (int)_messages.size() - _maxLines;
+	const int scrollableLines = visibleMessages() - _maxLines;
 	if (scrollableLines <= 0) {
 		return;
 	}
@@ -451,7 +517,7 @@ void Console::autoComplete() {
 			_commandLine.insert(cmdEraseIndex, matches.front().c_str());
 		}
 	} else {
-		_messages.push_back(_consolePrompt + _commandLine);
+		addMessage(_consolePrompt + _commandLine);
 		int pos = 0;
 		const core::String first = matches.front();
 		for (char c : first) {
@@ -556,11 +622,11 @@ void Console::addLogLine(int category, int priority, const char *message) {
 	const core::String& cleaned = removeAnsiColors(message);
 	const bool hasColor = isColor(cleaned.c_str());
 	if (hasColor) {
-		_messages.emplace_back(cleaned);
+		addMessage(core::String(cleaned));
 		skipColor(&message);
 	} else {
 		const core::String& color = getColor(priorityColors[priority]);
-		_messages.emplace_back(color + cleaned);
+		addMessage(color + cleaned);
 	}
 	if (_useOriginalLogFunction) {
 		((SDL_LogOutputFunction)_logFunction)(_logUserData, category, (SDL_LogPriority)priority, message);
@@ -574,8 +640,15 @@ bool Console::toggle() {
 
 void Console::update(double /*deltaFrameSeconds*/) {
 	core_assert(_mainThread == SDL_ThreadID());
-	LogLine msg;
-	while (_messageQueue.pop(msg)) {
+	if (_consoleLines && _consoleLines->isDirty()) {
+		_messages.setCapacity(_consoleLines->intVal());
+		pruneFiltered();
+		_consoleLines->markClean();
+	}
+	// take the lines of all threads with one lock
+	core::DynamicArray<LogLine> messages;
+	_messageQueue.popAll(messages);
+	for (const LogLine &msg : messages) {
 		core_assert(msg.message);
 		addLogLine(msg.category, msg.priority, msg.message);
 	}
@@ -584,6 +657,8 @@ void Console::update(double /*deltaFrameSeconds*/) {
 void Console::clear() {
 	clearCommandLine();
 	_messages.clear();
+	_filtered.clear();
+	_filteredStart = 0u;
 	_scrollPos = 0;
 }
 
@@ -627,24 +702,18 @@ void Console::render(const math::Rect<int> &rect, double deltaFrameSeconds) {
 		afterRender(rect);
 		return;
 	}
-	const int maxY = (int)_messages.size() * lineH;
+	const int lines = visibleMessages();
+	_scrollPos = core_max(core_min(_scrollPos, lines - 1), 0);
+	const int maxY = lines * lineH;
 	const glm::ivec2& commandLineSize = stringSize(_commandLine.c_str(), (int)_commandLine.size());
 	const int startY = core_min(rect.getMinZ() + rect.getMaxZ() - commandLineSize.y - 4, maxY);
-	if (!_messages.empty()) {
-		auto i = _messages.end();
-		--i;
-		core::prev(i, _scrollPos);
-		for (int y = startY; ; --i) {
-			if (y < rect.getMinZ()) {
-				break;
-			}
-			const glm::ivec2& size = stringSize(i->c_str(), (int)i->size());
-			y -= size.y;
-			drawString(_consoleMarginLeft, y, *i, (int)i->size());
-			if (i == _messages.begin()) {
-				break;
-			}
-		}
+	// only the lines that fit into the rect are measured and drawn - starting with the newest one
+	int y = startY;
+	for (int i = _scrollPos; i < lines && y >= rect.getMinZ(); ++i) {
+		const core::String &line = visibleMessage(i);
+		const glm::ivec2& size = stringSize(line.c_str(), (int)line.size());
+		y -= size.y;
+		drawString(_consoleMarginLeft, y, line, (int)line.size());
 	}
 
 	drawString(_consoleMarginLeft, startY, _consolePrompt, (int)_consolePrompt.size());
@@ -7,8 +7,10 @@
 #include "core/String.h"
 #include "math/Rect.h"
 #include "core/IComponent.h"
+#include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/ConcurrentQueue.h"
+#include "util/MessageRing.h"
 
 namespace util {
 
@@ -21,7 +23,21 @@ extern core::String getColor(ConsoleColor color);
 class Console : public core::IComponent {
 protected:
 	typedef core::DynamicArray<core::String> Messages;
-	Messages _messages;
+	/**
+	 * @brief The latest log lines - the amount is limited by @c cfg::CoreConsoleLines
+	 */
+	MessageRing _messages;
+	core::VarPtr _consoleLines;
+	/**
+	 * @brief Only the lines that contain this string are shown - see @c setFilter()
+	 */
+	core::String _filter;
+	/**
+	 * @brief The sequence numbers of the lines that match the filter - entries before @c _filteredStart belong to
+	 * lines that were already dropped from @c _messages
+	 */
+	core::DynamicArray<uint64_t> _filtered;
+	size_t _filteredStart = 0u;
 
 	int _consoleMarginLeft = 5;
 	int _consoleMarginLeftBehindPrompt = 13;
@@ -48,6 +64,21 @@ protected:
 
 	void printHistory();
 
+	void addMessage(core::String &&message);
+	/**
+	 * @brief Drops the entries of the filter index whose lines are no longer part of @c _messages
+	 */
+	void pruneFiltered();
+	void rebuildFiltered();
+	/**
+	 * @return The amount of lines that match the filter
+	 */
+	int visibleMessages() const;
+	/**
+	 * @param idx @c 0 is the newest line that matches the filter
+	 */
+	const core::String &visibleMessage(int idx) const;
+
 	/**
 	 * @brief Data structure to store a log entry call from a different thread.
 	 */
@@ -156,6 +187,11 @@ public:
 	virtual void update(double deltaFrameSeconds);
 	void clear();
 	void clearCommandLine();
+	/**
+	 * @brief Only show the lines that contain the given string (case insensitive) - an empty string shows all lines
+	 */
+	void setFilter(const core::String &filter);
+	const core::String &filter() const;
 	void render(const math::Rect<int> &rect, double deltaFrameSeconds);
 	bool isActive() const;
 	bool onTextInput(const core::String& text);
@@ -172,6 +208,10 @@ inline bool Console::isActive() const {
 	return _consoleActive;
 }
 
+inline const core::String& Console::filter() const {
+	return _filter;
+}
+
 inline const core::String& Console::commandLine() const {
 	return _commandLine;
 }
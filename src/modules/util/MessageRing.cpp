@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+
+#include "MessageRing.h"
+#include "core/Common.h"
+
+namespace util {
+
+MessageRing::MessageRing(size_t capacity) {
+	_lines.resize(core_max(capacity, (size_t)1u));
+}
+
+void MessageRing::setCapacity(size_t capacity) {
+	capacity = core_max(capacity, (size_t)1u);
+	if (capacity == _lines.size()) {
+		return;
+	}
+	const size_t keep = core_min(_size, capacity);
+	core::DynamicArray<core::String> lines;
+	lines.resize(capacity);
+	for (size_t i = 0u; i < keep; ++i) {
+		lines[i] = core::move(_lines[(_start + _size - keep + i) % _lines.size()]);
+	}
+	_lines = core::move(lines);
+	_first += _size - keep;
+	_start = 0u;
+	_size = keep;
+}
+
+uint64_t MessageRing::push(core::String &&line) {
+	const uint64_t sequence = next();
+	if (_size < _lines.size()) {
+		_lines[(_start + _size) % _lines.size()] = core::move(line);
+		++_size;
+	} else {
+		// replace the oldest line
+		_lines[_start] = core::move(line);
+		_start = (_start + 1u) % _lines.size();
+		++_first;
+	}
+	return sequence;
+}
+
+uint64_t MessageRing::push(const core::String &line) {
+	return push(core::String(line));
+}
+
+void MessageRing::clear() {
+	for (core::String &line : _lines) {
+		line.clear();
+	}
+	_first += _size;
+	_start = 0u;
+	_size = 0u;
+}
+
+} // namespace util
@@ -0,0 +1,103 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include <stdint.h>
+
+namespace util {
+
+/**
+ * @brief A ring of the latest text lines - once the capacity is reached, a new line replaces the oldest one
+ *
+ * The slots are allocated once and the lines are moved into them - the memory is bounded by the capacity no matter how
+ * many lines were added. Every line gets a sequence number that keeps increasing, this allows to keep references to
+ * lines (e.g. of a filter) that can be validated with @c contains() after older lines were dropped.
+ */
+class MessageRing {
+private:
+	core::DynamicArray<core::String> _lines;
+	/** the slot of the oldest line */
+	size_t _start = 0u;
+	size_t _size = 0u;
+	/** the sequence number of the oldest line */
+	uint64_t _first = 0u;
+
+public:
+	MessageRing(size_t capacity = 1024u);
+
+	/**
+	 * @brief Changes the amount of lines that are kept - the newest lines are kept if the capacity shrinks
+	 */
+	void setCapacity(size_t capacity);
+	size_t capacity() const;
+
+	/**
+	 * @return The sequence number of the added line
+	 */
+	uint64_t push(core::String &&line);
+	uint64_t push(const core::String &line);
+	void clear();
+
+	size_t size() const;
+	bool empty() const;
+
+	/**
+	 * @param idx @c 0 is the oldest line
+	 */
+	const core::String &operator[](size_t idx) const;
+
+	/**
+	 * @return The sequence number of the oldest line
+	 */
+	uint64_t first() const;
+	/**
+	 * @return The sequence number the next line will get
+	 */
+	uint64_t next() const;
+	/**
+	 * @return @c true if the line of the given sequence number wasn't dropped yet
+	 */
+	bool contains(uint64_t sequence) const;
+	/**
+	 * @note The sequence number must be valid - see @c contains()
+	 */
+	const core::String &bySequence(uint64_t sequence) const;
+};
+
+inline size_t MessageRing::capacity() const {
+	return _lines.size();
+}
+
+inline size_t MessageRing::size() const {
+	return _size;
+}
+
+inline bool MessageRing::empty() const {
+	return _size == 0u;
+}
+
+inline const core::String &MessageRing::operator[](size_t idx) const {
+	return _lines[(_start + idx) % _lines.size()];
+}
+
+inline uint64_t MessageRing::first() const {
+	return _first;
+}
+
+inline uint64_t MessageRing::next() const {
+	return _first + _size;
+}
+
+inline bool MessageRing::contains(uint64_t sequence) const {
+	return sequence >= _first && sequence < next();
+}
+
+inline const core::String &MessageRing::bySequence(uint64_t sequence) const {
+	return (*this)[(size_t)(sequence - _first)];
+}
+
+} // namespace util
@@ -18,6 +18,16 @@ protected:
 	int lineHeight() override { return 0; };
 	glm::ivec2 stringSize(const char *c, int length) override { return glm::ivec2(0); }
 	void drawString(int x, int y, const int color[4], int colorIndex, const char* str, int len) override {}
+public:
+	using util::Console::addLogLine;
+	using util::Console::visibleMessages;
+	using util::Console::visibleMessage;
+	void setCapacity(size_t lines) {
+		_messages.setCapacity(lines);
+	}
+	TestConsole() {
+		_useOriginalLogFunction = false;
+	}
 };
 
 TEST_F(ConsoleTest, testAutoCompleteCvar) {
@@ -50,4 +60,32 @@ TEST_F(ConsoleTest, testAutoCompleteCommand) {
 	ASSERT_EQ(cmdComplete + " ", c.commandLine());
 }
 
+TEST_F(ConsoleTest, testMaxLines) {
+	TestConsole c;
+	c.setCapacity(2);
+	c.addLogLine(0, SDL_LOG_PRIORITY_INFO, "first");
+	c.addLogLine(0, SDL_LOG_PRIORITY_INFO, "second");
+	c.addLogLine(0, SDL_LOG_PRIORITY_INFO, "third");
+	ASSERT_EQ(2, c.visibleMessages());
+	EXPECT_TRUE(c.visibleMessage(0).contains("third"));
+	EXPECT_TRUE(c.visibleMessage(1).contains("second"));
+}
+
+TEST_F(ConsoleTest, testFilter) {
+	TestConsole c;
+	c.setCapacity(3);
+	c.addLogLine(0, SDL_LOG_PRIORITY_INFO, "foo 1");
+	c.addLogLine(0, SDL_LOG_PRIORITY_INFO, "bar");
+	c.setFilter("FOO");
+	ASSERT_EQ(1, c.visibleMessages());
+	c.addLogLine(0, SDL_LOG_PRIORITY_INFO, "foo 2");
+	c.addLogLine(0, SDL_LOG_PRIORITY_INFO, "baz");
+	c.addLogLine(0, SDL_LOG_PRIORITY_INFO, "baz");
+	// foo 1 was dropped from the history
+	ASSERT_EQ(1, c.visibleMessages());
+	EXPECT_TRUE(c.visibleMessage(0).contains("foo 2"));
+	c.setFilter("");
+	EXPECT_EQ(3, c.visibleMessages());
+}
+
 }
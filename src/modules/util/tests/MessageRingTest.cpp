@@ -0,0 +1,63 @@
+/**
+ * @file
+ */
+
+#include "util/MessageRing.h"
+#include <gtest/gtest.h>
+
+namespace util {
+
+TEST(MessageRingTest, testPush) {
+	MessageRing ring(3);
+	EXPECT_TRUE(ring.empty());
+	EXPECT_EQ(0u, ring.push("a"));
+	EXPECT_EQ(1u, ring.push("b"));
+	ASSERT_EQ(2u, ring.size());
+	EXPECT_EQ("a", ring[0]);
+	EXPECT_EQ("b", ring[1]);
+}
+
+TEST(MessageRingTest, testDropOldest) {
+	MessageRing ring(3);
+	for (int i = 0; i < 5; ++i) {
+		ring.push(core::String::format("%i", i));
+	}
+	ASSERT_EQ(3u, ring.size());
+	EXPECT_EQ(2u, ring.first());
+	EXPECT_EQ(5u, ring.next());
+	EXPECT_EQ("2", ring[0]);
+	EXPECT_EQ("4", ring[2]);
+	EXPECT_FALSE(ring.contains(1u));
+	ASSERT_TRUE(ring.contains(3u));
+	EXPECT_EQ("3", ring.bySequence(3u));
+}
+
+TEST(MessageRingTest, testSetCapacity) {
+	MessageRing ring(4);
+	for (int i = 0; i < 6; ++i) {
+		ring.push(core::String::format("%i", i));
+	}
+	ring.setCapacity(2);
+	ASSERT_EQ(2u, ring.size());
+	EXPECT_EQ("4", ring[0]);
+	EXPECT_EQ("5", ring[1]);
+	EXPECT_EQ(4u, ring.first());
+	ring.setCapacity(8);
+	ring.push("6");
+	ASSERT_EQ(3u, ring.size());
+	EXPECT_EQ("4", ring[0]);
+	EXPECT_EQ("6", ring[2]);
+}
+
+TEST(MessageRingTest, testClear) {
+	MessageRing ring(2);
+	ring.push("a");
+	ring.push("b");
+	ring.clear();
+	EXPECT_TRUE(ring.empty());
+	EXPECT_FALSE(ring.contains(1u));
+	EXPECT_EQ(2u, ring.push("c"));
+	EXPECT_EQ("c", ring[0]);
+}
+
+} // namespace util
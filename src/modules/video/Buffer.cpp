@@ -194,6 +194,71 @@ bool Buffer::update(int32_t idx, const void* data, size_t size, bool orphaning)
 	return true;
 }
 
+bool Buffer::updateRange(int32_t idx, size_t offset, const void* data, size_t size) {
+	if (!isValid(idx)) {
+		return false;
+	}
+	if (offset + size > _size[idx]) {
+		return false;
+	}
+	if (size == 0u) {
+		return true;
+	}
+	core_assert(video::boundVertexArray() == InvalidId);
+#if VIDEO_BUFFER_HASH_COMPARE
+	_hash[idx] = 0u;
+#endif
+	video::bufferSubData(_handles[idx], _targets[idx], (intptr_t)offset, data, size);
+	return true;
+}
+
+bool Buffer::reserve(int32_t idx, size_t size) {
+	if (!isValid(idx)) {
+		return false;
+	}
+	core_assert(video::boundVertexArray() == InvalidId);
+#if VIDEO_BUFFER_HASH_COMPARE
+	_hash[idx] = 0u;
+#endif
+	_size[idx] = size;
+	video::bufferData(_handles[idx], _targets[idx], _modes[idx], nullptr, size);
+	return true;
+}
+
+bool Buffer::copyRange(int32_t idx, size_t offset, const Buffer& source, int32_t sourceIdx, size_t sourceOffset, size_t size) {
+	if (!isValid(idx) || !source.isValid(sourceIdx)) {
+		return false;
+	}
+	if (offset + size > _size[idx] || sourceOffset + size > source._size[sourceIdx]) {
+		return false;
+	}
+	if (size == 0u) {
+		return true;
+	}
+#if VIDEO_BUFFER_HASH_COMPARE
+	_hash[idx] = 0u;
+#endif
+	video::copyBufferSubData(source._handles[sourceIdx], _handles[idx], (intptr_t)sourceOffset, (intptr_t)offset, size);
+	return true;
+}
+
+bool Buffer::copyRange(int32_t idx, size_t offset, Id sourceHandle, size_t sourceOffset, size_t size) {
+	if (!isValid(idx) || sourceHandle == InvalidId) {
+		return false;
+	}
+	if (offset + size > _size[idx]) {
+		return false;
+	}
+	if (size == 0u) {
+		return true;
+	}
+#if VIDEO_BUFFER_HASH_COMPARE
+	_hash[idx] = 0u;
+#endif
+	video::copyBufferSubData(sourceHandle, _handles[idx], (intptr_t)sourceOffset, (intptr_t)offset, size);
+	return true;
+}
+
 int32_t Buffer::create(const void* data, size_t size, BufferType target) {
 	if (_handleIdx >= MAX_HANDLES) {
 		return -1;
@@ -63,6 +63,25 @@ public:
 	 */
 	void destroyVertexArray();
 	bool update(int32_t idx, const void* data, size_t size, bool orphaning = false);
+	/**
+	 * @brief Updates a part of an already allocated buffer without changing its size
+	 * @return @c false if the given range doesn't fit into the current buffer size
+	 */
+	bool updateRange(int32_t idx, size_t offset, const void* data, size_t size);
+	/**
+	 * @brief Allocates the given amount of bytes without initializing them
+	 */
+	bool reserve(int32_t idx, size_t size);
+	/**
+	 * @brief Copies a range of another buffer into this buffer on the gpu
+	 * @return @c false if one of the ranges doesn't fit into the buffers
+	 */
+	bool copyRange(int32_t idx, size_t offset, const Buffer& source, int32_t sourceIdx, size_t sourceOffset, size_t size);
+	/**
+	 * @brief Copies a range of the given native buffer into this buffer on the gpu
+	 * @sa StreamBuffer
+	 */
+	bool copyRange(int32_t idx, size_t offset, Id sourceHandle, size_t sourceOffset, size_t size);
 
 	/**
 	 * @return -1 on error - otherwise the index [0,n) of the created buffer (not the Id)
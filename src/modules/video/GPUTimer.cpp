@@ -0,0 +1,124 @@
+/**
+ * @file
+ */
+
+#include "GPUTimer.h"
+#include "Renderer.h"
+#include "core/Log.h"
+
+namespace video {
+
+bool GPUTimer::init() {
+	_frame = 0;
+	_depth = 0;
+	return true;
+}
+
+void GPUTimer::shutdown() {
+	for (int i = 0; i < Frames; ++i) {
+		release(_frames[i]);
+	}
+	_results.clear();
+	_enabled = false;
+}
+
+void GPUTimer::release(Frame &frame) {
+	for (Scope &scope : frame.scopes) {
+		deleteTimestampQuery(scope.begin);
+		deleteTimestampQuery(scope.end);
+	}
+	frame.scopes.clear();
+	frame.used = 0;
+}
+
+void GPUTimer::setEnabled(bool enabled) {
+	if (_enabled == enabled) {
+		return;
+	}
+	_enabled = enabled;
+	if (!enabled) {
+		for (int i = 0; i < Frames; ++i) {
+			_frames[i].used = 0;
+		}
+		_results.clear();
+	}
+	_depth = 0;
+}
+
+int GPUTimer::begin(const char *name) {
+	if (!_enabled) {
+		return -1;
+	}
+	Frame &frame = _frames[_frame];
+	if (frame.used >= (int)frame.scopes.size()) {
+		Scope scope;
+		scope.begin = genTimestampQuery();
+		scope.end = genTimestampQuery();
+		if (scope.begin == InvalidId || scope.end == InvalidId) {
+			deleteTimestampQuery(scope.begin);
+			deleteTimestampQuery(scope.end);
+			Log::warn("Timestamp queries are not supported - disable the gpu timer");
+			setEnabled(false);
+			return -1;
+		}
+		frame.scopes.push_back(scope);
+	}
+	const int idx = frame.used++;
+	Scope &scope = frame.scopes[idx];
+	scope.name = name;
+	scope.depth = _depth++;
+	queryTimestamp(scope.begin);
+	return idx;
+}
+
+void GPUTimer::end(int scope) {
+	if (scope < 0 || !_enabled) {
+		return;
+	}
+	Frame &frame = _frames[_frame];
+	if (scope >= frame.used) {
+		return;
+	}
+	queryTimestamp(frame.scopes[scope].end);
+	--_depth;
+}
+
+void GPUTimer::resolve(Frame &frame) {
+	if (frame.used <= 0) {
+		return;
+	}
+	// don't stall the pipeline - keep the previous results if the gpu didn't finish the frame yet
+	for (int i = 0; i < frame.used; ++i) {
+		if (timestampQueryResult(frame.scopes[i].end) < 0) {
+			return;
+		}
+	}
+	_results.clear();
+	_results.reserve(frame.used);
+	for (int i = 0; i < frame.used; ++i) {
+		const Scope &scope = frame.scopes[i];
+		const int64_t begin = timestampQueryResult(scope.begin, true);
+		const int64_t end = timestampQueryResult(scope.end, true);
+		Result result;
+		result.name = scope.name;
+		result.depth = scope.depth;
+		if (begin >= 0 && end >= begin) {
+			result.millis = (double)(end - begin) / 1000000.0;
+		}
+		_results.push_back(result);
+	}
+}
+
+void GPUTimer::frameEnd() {
+	if (!_enabled) {
+		return;
+	}
+	_frame = (_frame + 1) % Frames;
+	// the oldest frame is recorded again - collect its results before
+	Frame &frame = _frames[_frame];
+	resolve(frame);
+	frame.used = 0;
+	_depth = 0;
+}
+
+} // namespace video
@@ -0,0 +1,106 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Types.h"
+#include "core/IComponent.h"
+#include "core/Singleton.h"
+#include "core/collection/DynamicArray.h"
+
+namespace video {
+
+/**
+ * @brief Measures the gpu time of render passes with timestamp queries
+ *
+ * The results are fetched a few frames later to not stall the pipeline - so they lag behind the rendered frame.
+ * Nothing is recorded as long as the timer is not enabled.
+ *
+ * @sa video_gpu_scoped()
+ */
+class GPUTimer : public core::IComponent {
+public:
+	struct Result {
+		/** must be a string literal or have static storage */
+		const char *name = nullptr;
+		/** the nesting level of the scope */
+		int depth = 0;
+		double millis = 0.0;
+	};
+
+private:
+	static constexpr int Frames = 3;
+	struct Scope {
+		const char *name = nullptr;
+		int depth = 0;
+		Id begin = InvalidId;
+		Id end = InvalidId;
+	};
+	struct Frame {
+		core::DynamicArray<Scope> scopes;
+		int used = 0;
+	};
+	Frame _frames[Frames];
+	int _frame = 0;
+	int _depth = 0;
+	bool _enabled = false;
+	core::DynamicArray<Result> _results;
+
+	void release(Frame &frame);
+	void resolve(Frame &frame);
+
+public:
+	bool init() override;
+	void shutdown() override;
+
+	void setEnabled(bool enabled);
+	bool enabled() const;
+
+	/**
+	 * @return The scope index that must be given to end() - or @c -1 if nothing is recorded
+	 */
+	int begin(const char *name);
+	void end(int scope);
+
+	/**
+	 * @brief Collects the results of the oldest recorded frame and starts recording the next one
+	 */
+	void frameEnd();
+
+	/**
+	 * @return The gpu times of the scopes of the last resolved frame in the order they were started
+	 */
+	const core::DynamicArray<Result> &results() const;
+};
+
+inline bool GPUTimer::enabled() const {
+	return _enabled;
+}
+
+inline const core::DynamicArray<GPUTimer::Result> &GPUTimer::results() const {
+	return _results;
+}
+
+class ScopedGPUTimer {
+private:
+	int _scope;
+
+public:
+	ScopedGPUTimer(const char *name) : _scope(core::Singleton<GPUTimer>::getInstance().begin(name)) {
+	}
+	~ScopedGPUTimer() {
+		end();
+	}
+	/**
+	 * @brief Ends the scope before the object is destroyed
+	 */
+	void end() {
+		core::Singleton<GPUTimer>::getInstance().end(_scope);
+		_scope = -1;
+	}
+};
+
+#define video_gpu_scoped(name) video::ScopedGPUTimer __gpu_scoped_##name(#name)
+
+} // namespace video
@@ -20,12 +20,15 @@ static const char *featuresArray[] = {
 	"r_instancedarrays",		"r_debugoutput",
 	"r_directstateaccess",		"r_bufferstorage",
 	"r_multidrawindirect",		"r_computeshaders",
-	"r_transformfeedback",		"r_shaderstoragebufferobject"
+	"r_transformfeedback",		"r_shaderstoragebufferobject",
+	"r_programbinary"
 };
 static_assert(core::enumVal(Feature::Max) == (int)SDL_arraysize(featuresArray), "Array sizes don't match with Feature enum");
 static core::VarPtr featureVars[core::enumVal(Feature::Max)];
 
 static RenderState s;
+static RenderStats stats;
+static RenderStats lastStats;
 
 void construct() {
 	for (int i = 0; i < core::enumVal(Feature::Max); ++i) {
@@ -138,4 +141,17 @@ RenderState& renderState() {
 	return s;
 }
 
+RenderStats& renderStats() {
+	return stats;
+}
+
+const RenderStats& lastFrameRenderStats() {
+	return lastStats;
+}
+
+void endRenderStatsFrame() {
+	lastStats = stats;
+	stats = RenderStats();
+}
+
 }
@@ -115,6 +115,30 @@ struct RenderState {
 
 RenderState &renderState();
 
+/**
+ * @brief Counters of the render calls that were issued by the renderer backend
+ */
+struct RenderStats {
+	uint32_t drawCalls = 0u;
+	uint64_t triangles = 0u;
+	uint32_t bufferUploads = 0u;
+	uint64_t bufferUploadBytes = 0u;
+	uint32_t textureUploads = 0u;
+};
+
+/**
+ * @return The counters of the current frame
+ */
+RenderStats &renderStats();
+/**
+ * @return The counters of the last finished frame
+ */
+const RenderStats &lastFrameRenderStats();
+/**
+ * @brief Finishes the counters of the current frame and resets them for the next one
+ */
+void endRenderStatsFrame();
+
 void construct();
 
 template <class IndexType> inline void drawElements(Primitive mode, size_t numIndices, void *offset = nullptr) {
@@ -125,6 +149,18 @@ inline void drawElements(Primitive mode, size_t numIndices, size_t indexSize, vo
 	drawElements(mode, numIndices, mapIndexTypeBySize(indexSize), offset);
 }
 
+template <class IndexType> inline void drawElementsInstanced(Primitive mode, size_t numIndices, int instances, void *offset = nullptr) {
+	drawElementsInstanced(mode, numIndices, mapType<IndexType>(), instances, offset);
+}
+
+inline void drawElementsInstanced(Primitive mode, size_t numIndices, size_t indexSize, int instances, void *offset = nullptr) {
+	drawElementsInstanced(mode, numIndices, mapIndexTypeBySize(indexSize), instances, offset);
+}
+
+template <class IndexType> inline void multiDrawElementsIndirect(Primitive mode, int drawCount, intptr_t offset = 0) {
+	multiDrawElementsIndirect(mode, mapType<IndexType>(), drawCount, offset);
+}
+
 inline bool hasFeature(Feature feature) {
 	return renderState().supports(feature);
 }
@@ -7,6 +7,7 @@
 #include "RenderBuffer.h"
 #include "ShaderTypes.h"
 #include "core/SharedPtr.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/List.h"
 #include "core/collection/Set.h"
 #include <glm/vec2.hpp>
@@ -88,6 +89,12 @@ bool depthFunc(CompareFunc func);
 CompareFunc getDepthFunc();
 void getBlendState(bool &enabled, BlendMode &src, BlendMode &dest, BlendEquation &func);
 bool blendFunc(BlendMode src, BlendMode dest);
+/**
+ * @brief Sets different blend functions for the color and the alpha channel
+ * @note The blend state that getBlendState() returns is unknown until the next blendFunc() call - so
+ * use a ScopedBlendMode around this to restore the previous state
+ */
+bool blendFuncSeparate(BlendMode srcRGB, BlendMode destRGB, BlendMode srcAlpha, BlendMode destAlpha);
 bool blendEquation(BlendEquation func);
 PolygonMode polygonMode(Face face, PolygonMode mode);
 bool polygonOffset(const glm::vec2 &offset);
@@ -98,11 +105,23 @@ bool bindTexture(TextureUnit unit, TextureType type, Id handle);
  * @note The returned buffer should get freed with SDL_free
  */
 bool readTexture(TextureUnit unit, TextureType type, TextureFormat format, Id handle, int w, int h, uint8_t **pixels);
+/**
+ * @brief Starts to read the texture into the given pixel pack buffer without waiting for the gpu
+ *
+ * The buffer must be big enough for the pixels of the texture. Map the buffer with mapBuffer() to access the pixels
+ * - guard it with a fence (genFence()) to not block while the gpu is still busy.
+ * @sa TextureReadback
+ */
+bool readTextureAsync(TextureUnit unit, TextureType type, TextureFormat format, Id handle, Id pixelBuffer);
 bool useProgram(Id handle);
 Id getProgram();
 bool bindVertexArray(Id handle);
 Id boundVertexArray();
 Id boundBuffer(BufferType type);
+/**
+ * @return The memory of the buffer or @c nullptr on failure - call unmapBuffer() when you are done
+ */
+void *mapBuffer(Id handle, BufferType type, AccessMode mode);
 void unmapBuffer(Id handle, BufferType type);
 bool bindBuffer(BufferType type, Id handle);
 bool unbindBuffer(BufferType type);
@@ -128,6 +147,34 @@ void deleteFramebuffers(uint8_t amount, Id *ids);
 bool readFramebuffer(int x, int y, int w, int h, TextureFormat format, uint8_t **pixels);
 void genRenderbuffers(uint8_t amount, Id *ids);
 void deleteRenderbuffers(uint8_t amount, Id *ids);
+/**
+ * @brief Occlusion queries count the samples that pass the depth test between beginOcclusionQuery() and
+ * endOcclusionQuery()
+ */
+Id genOcclusionQuery();
+void deleteOcclusionQuery(Id &id);
+bool beginOcclusionQuery(Id id);
+bool endOcclusionQuery(Id id);
+/**
+ * @return @c true if the result of the query can be fetched without stalling the pipeline
+ */
+bool isOcclusionQueryAvailable(Id id);
+/**
+ * @param wait If this is @c false and the result is not yet available, @c -1 is returned
+ * @return The amount of samples that passed the depth test
+ */
+int occlusionQueryResult(Id id, bool wait = false);
+/**
+ * @brief Timestamp queries record the gpu time after all previously issued commands are finished
+ */
+Id genTimestampQuery();
+void deleteTimestampQuery(Id &id);
+bool queryTimestamp(Id id);
+/**
+ * @param wait If this is @c false and the result is not yet available, @c -1 is returned
+ * @return The gpu time in nanoseconds
+ */
+int64_t timestampQueryResult(Id id, bool wait = false);
 void configureAttribute(const Attribute &a);
 /**
  * Binds a new frame buffer
@@ -141,6 +188,26 @@ bool setupRenderBuffer(TextureFormat format, int w, int h, int samples);
 Id bindRenderbuffer(Id handle);
 void bufferData(Id handle, BufferType type, BufferMode mode, const void *data, size_t size);
 void bufferSubData(Id handle, BufferType type, intptr_t offset, const void *data, size_t size);
+/**
+ * @brief Copies a range of one buffer into another buffer on the gpu
+ */
+void copyBufferSubData(Id readHandle, Id writeHandle, intptr_t readOffset, intptr_t writeOffset, size_t size);
+/**
+ * @brief Allocates immutable storage for the given buffer and maps it persistently and coherently for writing
+ * @return The mapped memory - it stays valid until the buffer is deleted - or @c nullptr on failure
+ * @note Check for Feature::BufferStorage
+ */
+void *mapPersistentBuffer(Id handle, BufferType type, size_t size);
+/**
+ * @brief Inserts a fence into the command stream that is signaled once all previous commands are finished
+ */
+IdPtr genFence();
+void deleteFence(IdPtr &id);
+/**
+ * @param timeout The max time to wait in nanoseconds - @c 0 only checks the state of the fence
+ * @return @c true if the fence is signaled
+ */
+bool waitFence(IdPtr id, uint64_t timeout);
 const glm::vec4 &framebufferUV();
 bool bindFrameBufferAttachment(Id texture, FrameBufferAttachment attachment, int layerIndex, bool clear);
 bool setupFramebuffer(const TexturePtr (&colorTextures)[core::enumVal(FrameBufferAttachment::Max)],
@@ -149,11 +216,41 @@ void setupTexture(const TextureConfig &config);
 void uploadTexture(video::TextureType type, video::TextureFormat format, int width, int height, const uint8_t *data,
 				   int index, int samples);
 void drawElements(Primitive mode, size_t numIndices, DataType type, void *offset = nullptr);
-void drawArrays(Primitive mode, size_t count);
+/**
+ * @brief Draws the given amount of instances of the indexed geometry - see @c gl_InstanceID
+ * @note Check for Feature::InstancedArrays
+ */
+void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, int instances, void *offset = nullptr);
+/**
+ * @brief Executes @c drawCount DrawElementsIndirectCommand entries of the bound BufferType::IndirectBuffer
+ * @param offset The byte offset into the indirect buffer
+ * @note Check for Feature::MultiDrawIndirect
+ */
+void multiDrawElementsIndirect(Primitive mode, DataType type, int drawCount, intptr_t offset = 0);
+/**
+ * @param first The first vertex - this is also included in @c gl_VertexID
+ */
+void drawArrays(Primitive mode, size_t count, size_t first = 0);
 void enableDebug(DebugSeverity severity);
 bool compileShader(Id id, ShaderType shaderType, const core::String &source, const core::String &name = "unknown-shader");
 bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String &name = "unknown-shader");
 bool linkComputeShader(Id program, Id comp, const core::String &name = "unknown-shader");
+/**
+ * @brief Identifies the driver - program binaries are only valid for the driver that created them
+ * @sa programBinary()
+ */
+const core::String &driverIdentifier();
+/**
+ * @brief Fetches the binary of a linked program to be able to skip the compilation on the next start
+ * @note Check for Feature::ProgramBinary
+ */
+bool programBinary(Id program, uint32_t &format, core::DynamicArray<uint8_t> &binary);
+/**
+ * @brief Loads a binary that was fetched by programBinary() into the given program
+ * @return @c false if the driver refused the binary (e.g. after a driver update) - the program has to be linked
+ * from the sources in this case
+ */
+bool loadProgramBinary(Id program, uint32_t format, const uint8_t *binary, size_t size);
 bool bindImage(Id handle, AccessMode mode, ImageFormat format);
 /**
  * @brief Execute a compute shader
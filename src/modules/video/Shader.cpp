@@ -8,6 +8,10 @@
 #include "core/Common.h"
 #include "core/Log.h"
 #include "core/Hash.h"
+#include "core/FourCC.h"
+#include "core/GameConfig.h"
+#include "core/MD5.h"
+#include "core/StandardLib.h"
 #include "core/GLM.h"
 #include "io/Filesystem.h"
 #include "Version.h"
@@ -161,6 +165,9 @@ void Shader::shutdown() {
 	for (auto& shader : _shader) {
 		video::deleteShader(shader);
 	}
+	for (auto& source : _sources) {
+		source.clear();
+	}
 	_uniformStateMap.clear();
 	video::deleteProgram(_program);
 	_initialized = false;
@@ -184,22 +191,8 @@ bool Shader::load(const core::String& name, const core::String& buffer, ShaderTy
 		return false;
 	}
 	_name = name;
-	const core::String& source = getSource(shaderType, buffer);
-
-	Id id = getShader(shaderType);
-	if (id == InvalidId) {
-		id = video::genShader(shaderType);
-		if (id == InvalidId) {
-			Log::error("Failed to generate shader handle for %s\n", name.c_str());
-			return false;
-		}
-		_shader[(int)shaderType] = id;
-	}
-	if (!video::compileShader(id, shaderType, source, _name)) {
-		_shader[(int)shaderType] = InvalidId;
-		Log::error("Failed to compile shader for %s\n", name.c_str());
-		return false;
-	}
+	// the compilation is deferred to createProgramFromShaders() - it's not needed for a cached program binary
+	_sources[(int)shaderType] = getSource(shaderType, buffer);
 	return true;
 }
 
@@ -496,11 +489,32 @@ core::String Shader::getSource(ShaderType shaderType, const core::String& buffer
 	return src;
 }
 
-bool Shader::createProgramFromShaders() {
-	if (_program == InvalidId) {
-		_program = video::genProgram();
+bool Shader::compileShaders() {
+	for (int i = 0; i < (int)ShaderType::Max; ++i) {
+		const core::String& source = _sources[i];
+		if (source.empty()) {
+			continue;
+		}
+		const ShaderType shaderType = (ShaderType)i;
+		Id id = getShader(shaderType);
+		if (id == InvalidId) {
+			id = video::genShader(shaderType);
+			if (id == InvalidId) {
+				Log::error("Failed to generate shader handle for %s", _name.c_str());
+				return false;
+			}
+			_shader[i] = id;
+		}
+		if (!video::compileShader(id, shaderType, source, _name)) {
+			_shader[i] = InvalidId;
+			Log::error("Failed to compile shader for %s", _name.c_str());
+			return false;
+		}
 	}
+	return true;
+}
 
+bool Shader::linkProgram() {
 	const Id comp = getShader(ShaderType::Compute);
 	if (comp != InvalidId) {
 		return video::linkComputeShader(_program, comp, _name);
@@ -513,9 +527,104 @@ bool Shader::createProgramFromShaders() {
 	return video::linkShader(_program, vert, frag, geom, _name);
 }
 
+core::String Shader::programBinaryCacheFile() const {
+	if (!video::hasFeature(Feature::ProgramBinary)) {
+		return "";
+	}
+	const core::VarPtr& cache = core::Var::get(cfg::ClientShaderCache);
+	if (!cache || !cache->boolVal()) {
+		return "";
+	}
+	const core::String& driver = video::driverIdentifier();
+	if (driver.empty()) {
+		return "";
+	}
+	// a driver update or any change in the sources (e.g. the defines) invalidates the binary
+	core::String key = driver;
+	key += _name;
+	for (int i = 0; i < (int)ShaderType::Max; ++i) {
+		key += core::string::toString(i);
+		key += _sources[i];
+	}
+	const core::String& md5 = core::md5sum((const uint8_t*)key.c_str(), (uint32_t)key.size());
+	return core::string::format("shadercache/%s.bin", md5.c_str());
+}
+
+bool Shader::loadProgramBinary(const core::String& cacheFile) {
+	const io::FilePtr& file = io::filesystem()->open(cacheFile);
+	if (!file->exists()) {
+		return false;
+	}
+	uint8_t *buf = nullptr;
+	const int size = file->read((void**)&buf);
+	bool success = false;
+	if (size > (int)(2 * sizeof(uint32_t))) {
+		uint32_t magic;
+		uint32_t format;
+		core_memcpy(&magic, buf, sizeof(magic));
+		core_memcpy(&format, buf + sizeof(magic), sizeof(format));
+		if (magic == FourCC('V', 'P', 'B', '1')) {
+			const size_t headerSize = sizeof(magic) + sizeof(format);
+			success = video::loadProgramBinary(_program, format, buf + headerSize, (size_t)size - headerSize);
+		}
+	}
+	delete[] buf;
+	if (!success) {
+		Log::debug("Program binary cache %s of %s is outdated", cacheFile.c_str(), _name.c_str());
+	}
+	return success;
+}
+
+void Shader::writeProgramBinary(const core::String& cacheFile) const {
+	uint32_t format = 0u;
+	core::DynamicArray<uint8_t> binary;
+	if (!video::programBinary(_program, format, binary)) {
+		return;
+	}
+	const uint32_t magic = FourCC('V', 'P', 'B', '1');
+	const size_t headerSize = sizeof(magic) + sizeof(format);
+	core::DynamicArray<uint8_t> content;
+	content.resize(headerSize + binary.size());
+	core_memcpy(content.data(), &magic, sizeof(magic));
+	core_memcpy(content.data() + sizeof(magic), &format, sizeof(format));
+	core_memcpy(content.data() + headerSize, binary.data(), binary.size());
+	if (!io::filesystem()->write(cacheFile, content.data(), content.size())) {
+		Log::warn("Failed to write the program binary cache %s for %s", cacheFile.c_str(), _name.c_str());
+	}
+}
+
+bool Shader::createProgramFromShaders() {
+	if (_program == InvalidId) {
+		_program = video::genProgram();
+		if (_program == InvalidId) {
+			Log::error("Failed to generate program handle for %s", _name.c_str());
+			return false;
+		}
+	}
+
+	const core::String& cacheFile = programBinaryCacheFile();
+	if (!cacheFile.empty() && loadProgramBinary(cacheFile)) {
+		Log::debug("Loaded %s from the program binary cache", _name.c_str());
+		return true;
+	}
+
+	if (!compileShaders()) {
+		video::deleteProgram(_program);
+		return false;
+	}
+	if (!linkProgram()) {
+		// the renderer already deleted the program object
+		_program = InvalidId;
+		return false;
+	}
+	if (!cacheFile.empty()) {
+		writeProgramBinary(cacheFile);
+	}
+	return true;
+}
+
 bool Shader::run(const glm::uvec3& workGroups, bool wait) {
-	const Id comp = getShader(ShaderType::Compute);
-	if (comp == InvalidId) {
+	if (_sources[(int)ShaderType::Compute].empty()) {
 		return false;
 	}
 	return video::runShader(_program, workGroups, wait);
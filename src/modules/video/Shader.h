@@ -45,6 +45,9 @@ class Shader : public core::NonCopyable {
 protected:
 	typedef core::Array<Id, (int)ShaderType::Max> ShaderArray;
 	ShaderArray _shader;
+	// the sources are only compiled if there is no cached program binary
+	typedef core::Array<core::String, (int)ShaderType::Max> SourceArray;
+	SourceArray _sources;
 
 	typedef core::Map<int, uint32_t, 8> UniformStateMap;
 	mutable UniformStateMap _uniformStateMap{128};
@@ -82,6 +85,19 @@ protected:
 
 	int fetchAttributes();
 
+	bool compileShaders();
+	bool linkProgram();
+	/**
+	 * @return The path of the program binary cache file or an empty string if the cache can't be used
+	 */
+	core::String programBinaryCacheFile() const;
+	bool loadProgramBinary(const core::String& cacheFile);
+	void writeProgramBinary(const core::String& cacheFile) const;
+
+	/**
+	 * @brief Loads the program from the binary cache - or compiles and links the sources on a cache miss
+	 * @sa cfg::ClientShaderCache
+	 */
 	bool createProgramFromShaders();
 
 	/**
@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+
+#include "StreamBuffer.h"
+#include "Buffer.h"
+#include "Renderer.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+
+namespace video {
+
+StreamBuffer::~StreamBuffer() {
+	core_assert_msg(_handle == InvalidId, "Stream buffer was not properly shut down");
+	shutdown();
+}
+
+bool StreamBuffer::init(size_t size) {
+	shutdown();
+	if (size == 0u || !video::hasFeature(video::Feature::BufferStorage)) {
+		return false;
+	}
+	video::genBuffers(1, &_handle);
+	if (_handle == InvalidId) {
+		Log::error("Failed to create the stream buffer");
+		return false;
+	}
+	_data = (uint8_t *)video::mapPersistentBuffer(_handle, BufferType::ArrayBuffer, size);
+	if (_data == nullptr) {
+		Log::warn("Failed to map the stream buffer");
+		shutdown();
+		return false;
+	}
+	_size = size;
+	_head = 0u;
+	return true;
+}
+
+void StreamBuffer::shutdown() {
+	while (!_fences.empty()) {
+		video::deleteFence(_fences.front().id);
+		_fences.pop();
+	}
+	_pending = Fence();
+	if (_handle != InvalidId) {
+		// deleting the buffer also unmaps it
+		video::deleteBuffers(1, &_handle);
+	}
+	_data = nullptr;
+	_size = 0u;
+	_head = 0u;
+}
+
+void StreamBuffer::fencePending() {
+	if (_pending.size == 0u) {
+		return;
+	}
+	if (_fences.size() == _fences.capacity()) {
+		waitFront();
+	}
+	_pending.id = video::genFence();
+	_fences.push_back(_pending);
+	_pending = Fence();
+}
+
+void StreamBuffer::waitFront() {
+	Fence &fence = _fences.front();
+	if (!video::waitFence(fence.id, 0u)) {
+		core_trace_scoped(StreamBufferStall);
+		// one second - the copies are in the command stream already
+		if (!video::waitFence(fence.id, 1000000000u)) {
+			Log::warn("Timeout while waiting for the stream buffer");
+		}
+	}
+	video::deleteFence(fence.id);
+	_fences.pop();
+}
+
+uint8_t *StreamBuffer::allocate(size_t bytes, size_t &offset) {
+	if (_data == nullptr || bytes == 0u || bytes > _size) {
+		return nullptr;
+	}
+	size_t start = (_head + Alignment - 1u) & ~(Alignment - 1u);
+	if (start + bytes > _size) {
+		start = 0u;
+	}
+	const size_t end = start + bytes;
+	fencePending();
+	// the oldest allocations are the ones that follow the head of the ring
+	while (!_fences.empty()) {
+		const Fence &fence = _fences.front();
+		if (fence.offset >= end || fence.offset + fence.size <= start) {
+			break;
+		}
+		waitFront();
+	}
+	_pending.offset = start;
+	_pending.size = bytes;
+	_head = end;
+	offset = start;
+	return _data + start;
+}
+
+bool StreamBuffer::copy(size_t offset, Buffer &target, int32_t targetIdx, size_t targetOffset, size_t bytes) const {
+	if (_data == nullptr || offset + bytes > _size) {
+		return false;
+	}
+	return target.copyRange(targetIdx, targetOffset, _handle, offset, bytes);
+}
+
+}
@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Types.h"
+#include "core/NonCopyable.h"
+#include "core/collection/RingBuffer.h"
+
+namespace video {
+
+class Buffer;
+
+/**
+ * @brief Persistently mapped ring buffer to stream data into other buffers
+ *
+ * The data is written directly into the mapped memory and copied on the gpu into the target buffer. This
+ * avoids the temporary copies and the implicit synchronization of the buffer updates. Every allocation is
+ * guarded by a fence - the memory of an allocation is only handed out again after the gpu finished the
+ * copies out of it.
+ *
+ * @note Check for Feature::BufferStorage - init() fails without it and the callers should fall back to
+ * Buffer::update()
+ * @ingroup Video
+ */
+class StreamBuffer : public core::NonCopyable {
+public:
+	static constexpr size_t Alignment = 16u;
+private:
+	struct Fence {
+		IdPtr id = InvalidIdPtr;
+		size_t offset = 0u;
+		size_t size = 0u;
+	};
+	static constexpr size_t MaxFences = 256u;
+	core::RingBuffer<Fence, MaxFences> _fences;
+	/**
+	 * @brief The last allocation - it is fenced once the next allocation is done to include the copies
+	 * out of it
+	 */
+	Fence _pending;
+	Id _handle = InvalidId;
+	uint8_t *_data = nullptr;
+	size_t _size = 0u;
+	size_t _head = 0u;
+
+	void fencePending();
+	void waitFront();
+public:
+	~StreamBuffer();
+
+	/**
+	 * @param size The size of the ring in bytes - the max size of one allocation
+	 */
+	bool init(size_t size);
+	void shutdown();
+	bool isValid() const;
+	size_t size() const;
+	/**
+	 * @brief Reserves the given amount of bytes in the ring. Waits for the gpu if the memory is still in use.
+	 * @note The returned memory may be written by any thread - but the allocation and the copy out of the
+	 * ring must be done on the thread of the graphics context.
+	 * @param[out] offset The offset of the reserved range in the stream buffer
+	 * @return The mapped memory of the reserved range - @c nullptr if @c bytes doesn't fit into the ring
+	 */
+	uint8_t *allocate(size_t bytes, size_t &offset);
+	/**
+	 * @brief Copies a range of the ring into the given buffer on the gpu
+	 * @sa Buffer::copyRange()
+	 */
+	bool copy(size_t offset, Buffer &target, int32_t targetIdx, size_t targetOffset, size_t bytes) const;
+};
+
+inline bool StreamBuffer::isValid() const {
+	return _data != nullptr;
+}
+
+inline size_t StreamBuffer::size() const {
+	return _size;
+}
+
+}
@@ -3,11 +3,77 @@
  */
 
 #include "TexturePool.h"
+#include "app/App.h"
+#include "core/FourCC.h"
+#include "core/GameConfig.h"
+#include "core/Log.h"
+#include "core/MD5.h"
+#include "core/StandardLib.h"
 #include "core/StringUtil.h"
+#include "core/Var.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
 #include "image/Image.h"
+#include "io/FileStream.h"
+#include <inttypes.h>
 
 namespace video {
 
+static constexpr uint32_t TextureCacheMagic = FourCC('V', 'T', 'C', '1');
+
+/**
+ * @return The file in the texture cache for the decoded pixels or an empty string if the image can't be cached
+ */
+static core::String textureCacheFile(const core::String &name) {
+	const core::VarPtr &cache = core::Var::get(cfg::ClientTextureCache);
+	if (!cache || !cache->boolVal()) {
+		return "";
+	}
+	// relative paths are resolved by the search paths - we can't detect whether they were modified
+	if (io::Filesystem::isRelativePath(name)) {
+		return "";
+	}
+	io::FilesystemEntry entry;
+	if (!io::Filesystem::stat(name, entry) || !entry.isFile()) {
+		return "";
+	}
+	// a modified image gets a new cache entry
+	const core::String &key = core::string::format("%s %" PRIu64 " %" PRIu64, name.c_str(), entry.mtime, entry.size);
+	const core::String &md5 = core::md5sum((const uint8_t *)key.c_str(), (uint32_t)key.size());
+	return core::string::format("texturecache/%s.rgba", md5.c_str());
+}
+
+static bool loadCachedImage(const core::String &cacheFile, image::Image &image) {
+	const io::FilePtr &file = io::filesystem()->open(cacheFile);
+	if (!file->exists()) {
+		return false;
+	}
+	io::FileStream stream(file);
+	uint32_t magic;
+	uint32_t width;
+	uint32_t height;
+	if (stream.readUInt32(magic) != 0 || magic != TextureCacheMagic || stream.readUInt32(width) != 0 ||
+		stream.readUInt32(height) != 0) {
+		return false;
+	}
+	if (width == 0u || height == 0u || stream.remaining() != (int64_t)width * height * 4) {
+		return false;
+	}
+	return image.loadRGBA(stream, (int)width, (int)height);
+}
+
+static void writeCachedImage(const core::String &cacheFile, const image::Image &image) {
+	const uint32_t header[] = {TextureCacheMagic, (uint32_t)image.width(), (uint32_t)image.height()};
+	const size_t pixelSize = (size_t)image.width() * image.height() * image.depth();
+	core::DynamicArray<uint8_t> content;
+	content.resize(sizeof(header) + pixelSize);
+	core_memcpy(content.data(), header, sizeof(header));
+	core_memcpy(content.data() + sizeof(header), image.data(), pixelSize);
+	if (!io::filesystem()->write(cacheFile, content.data(), content.size())) {
+		Log::warn("Failed to write the texture cache %s for %s", cacheFile.c_str(), image.name().c_str());
+	}
+}
+
 video::TexturePtr TexturePool::load(const core::String &name, bool emptyAsFallback) {
 	auto i = _cache.find(name);
 	if (i != _cache.end()) {
@@ -26,6 +92,36 @@ video::TexturePtr TexturePool::load(const core::String &name, bool emptyAsFallba
 	return texture;
 }
 
+video::TexturePtr TexturePool::loadAsync(const core::String &name) {
+	auto i = _cache.find(name);
+	if (i != _cache.end()) {
+		return i->value;
+	}
+
+	// the texture must be created while the image is still loading to get the placeholder
+	const image::ImagePtr &image = image::createEmptyImage(name);
+	const TexturePtr &texture = createTextureFromImage(image);
+	_images.put(name, image);
+	_cache.put(name, texture);
+
+	app::App::getInstance()->threadPool().schedule([image]() {
+		const core::String &cacheFile = textureCacheFile(image->name());
+		if (!cacheFile.empty() && loadCachedImage(cacheFile, *image.get())) {
+			Log::debug("Loaded %s from the texture cache", image->name().c_str());
+			return;
+		}
+		const io::FilePtr &file = io::filesystem()->open(image->name());
+		if (!image->load(file)) {
+			Log::warn("Failed to load image %s", image->name().c_str());
+			return;
+		}
+		if (!cacheFile.empty()) {
+			writeCachedImage(cacheFile, *image.get());
+		}
+	});
+	return texture;
+}
+
 image::ImagePtr TexturePool::loadImage(const core::String &name) {
 	auto i = _images.find(name);
 	if (i != _images.end()) {
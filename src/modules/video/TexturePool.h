@@ -24,6 +24,14 @@ private:
 	TexturePtr _empty;
 public:
 	video::TexturePtr load(const core::String& name, bool emptyAsFallback = true);
+	/**
+	 * @brief Returns a placeholder texture right away - the image is decoded on the thread pool and the texture is
+	 * uploaded on first use after the decoding finished.
+	 *
+	 * The decoded pixels of absolute paths are cached in the home path to skip the decoding on the next load.
+	 * @sa cfg::ClientTextureCache
+	 */
+	video::TexturePtr loadAsync(const core::String& name);
 	image::ImagePtr loadImage(const core::String& name);
 
 	const core::StringMap<TexturePtr> &cache() {
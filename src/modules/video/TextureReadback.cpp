@@ -0,0 +1,111 @@
+/**
+ * @file
+ */
+
+#include "TextureReadback.h"
+#include "Renderer.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+
+namespace video {
+
+TextureReadback::~TextureReadback() {
+	core_assert_msg(!_initialized, "Texture readback was not properly shut down");
+	shutdown();
+}
+
+bool TextureReadback::init() {
+	shutdown();
+	for (int i = 0; i < MaxPending; ++i) {
+		video::genBuffers(1, &_slots[i].handle);
+		if (_slots[i].handle == InvalidId) {
+			Log::error("Failed to create the pixel pack buffers");
+			shutdown();
+			return false;
+		}
+	}
+	_initialized = true;
+	return true;
+}
+
+void TextureReadback::shutdown() {
+	for (int i = 0; i < MaxPending; ++i) {
+		Slot &slot = _slots[i];
+		video::deleteFence(slot.fence);
+		if (slot.handle != InvalidId) {
+			video::deleteBuffers(1, &slot.handle);
+		}
+		slot = Slot();
+	}
+	_tail = 0;
+	_pending = 0;
+	_initialized = false;
+}
+
+bool TextureReadback::read(const TexturePtr &texture, const core::String &name) {
+	if (!_initialized || full() || !texture) {
+		return false;
+	}
+	if (texture->format() != TextureFormat::RGBA) {
+		Log::error("Only rgba textures can be read back");
+		return false;
+	}
+	core_trace_scoped(TextureReadbackRead);
+	Slot &slot = _slots[(_tail + _pending) % MaxPending];
+	const int w = texture->width();
+	const int h = texture->height();
+	const size_t size = (size_t)w * (size_t)h * 4u;
+	if (slot.size != size) {
+		video::bufferData(slot.handle, BufferType::PixelPackBuffer, BufferMode::Stream, nullptr, size);
+		slot.size = size;
+	}
+	if (!video::readTextureAsync(TextureUnit::Upload, texture->type(), texture->format(), texture->handle(),
+								 slot.handle)) {
+		Log::error("Failed to read the texture");
+		return false;
+	}
+	slot.fence = video::genFence();
+	slot.width = w;
+	slot.height = h;
+	slot.name = name;
+	++_pending;
+	return true;
+}
+
+image::ImagePtr TextureReadback::resolve(Slot &slot) {
+	image::ImagePtr image;
+	const uint8_t *pixels = (const uint8_t *)video::mapBuffer(slot.handle, BufferType::PixelPackBuffer, AccessMode::Read);
+	if (pixels == nullptr) {
+		Log::error("Failed to map the pixel pack buffer");
+		return image;
+	}
+	image = image::createEmptyImage(slot.name);
+	if (image->loadRGBA(pixels, slot.width, slot.height)) {
+		image->flipVertical();
+	}
+	video::unmapBuffer(slot.handle, BufferType::PixelPackBuffer);
+	return image;
+}
+
+image::ImagePtr TextureReadback::pop(bool wait) {
+	if (_pending == 0) {
+		return image::ImagePtr();
+	}
+	Slot &slot = _slots[_tail];
+	if (!video::waitFence(slot.fence, 0u)) {
+		if (!wait) {
+			return image::ImagePtr();
+		}
+		core_trace_scoped(TextureReadbackStall);
+		// one second - the copy is in the command stream already
+		if (!video::waitFence(slot.fence, 1000000000u)) {
+			Log::warn("Timeout while waiting for the texture readback");
+		}
+	}
+	video::deleteFence(slot.fence);
+	_tail = (_tail + 1) % MaxPending;
+	--_pending;
+	return resolve(slot);
+}
+
+}
@@ -0,0 +1,79 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Types.h"
+#include "Texture.h"
+#include "core/NonCopyable.h"
+#include "core/String.h"
+#include "image/Image.h"
+
+namespace video {
+
+/**
+ * @brief Ring of pixel pack buffers to read back textures without stalling the gpu pipeline
+ *
+ * The pixels of a texture are copied into a buffer on the gpu and guarded by a fence. The buffer is only mapped once
+ * the gpu finished the copy - usually one or two frames later. This is meant for continuous reads like the frames of
+ * a video recording - for a single read FrameBuffer::image() is just as fast.
+ *
+ * @note Only rgba textures are supported
+ * @ingroup Video
+ */
+class TextureReadback : public core::NonCopyable {
+public:
+	static constexpr int MaxPending = 3;
+private:
+	struct Slot {
+		Id handle = InvalidId;
+		IdPtr fence = InvalidIdPtr;
+		size_t size = 0u;
+		int width = 0;
+		int height = 0;
+		core::String name;
+	};
+	Slot _slots[MaxPending];
+	/** the oldest slot that is in flight */
+	int _tail = 0;
+	int _pending = 0;
+	bool _initialized = false;
+
+	image::ImagePtr resolve(Slot &slot);
+public:
+	~TextureReadback();
+
+	bool init();
+	void shutdown();
+	bool isValid() const;
+
+	/**
+	 * @brief Starts to read the pixels of the given texture
+	 * @return @c false if the read couldn't get started or all slots are in flight - see full()
+	 */
+	bool read(const TexturePtr &texture, const core::String &name);
+	/**
+	 * @brief Returns the image of the oldest read - the images are returned in the order of the read() calls
+	 * @param wait Block until the gpu has finished the copy - otherwise an empty pointer is returned if the read
+	 * is still in flight
+	 */
+	image::ImagePtr pop(bool wait = false);
+
+	int pending() const;
+	bool full() const;
+};
+
+inline bool TextureReadback::isValid() const {
+	return _initialized;
+}
+
+inline int TextureReadback::pending() const {
+	return _pending;
+}
+
+inline bool TextureReadback::full() const {
+	return _pending == MaxPending;
+}
+
+}
@@ -221,6 +221,8 @@ enum class BufferType {
 	PixelBuffer,
 	ShaderStorageBuffer,
 	IndirectBuffer,
+	/** the target of the pixel reads - see readTextureAsync() */
+	PixelPackBuffer,
 
 	Max
 };
@@ -423,6 +425,7 @@ enum class Feature {
 	ComputeShaders,
 	TransformFeedback,
 	ShaderStorageBufferObject,
+	ProgramBinary,
 
 	Max
 };
@@ -460,6 +463,18 @@ struct Uniform {
 	int32_t size = -1;
 };
 
+/**
+ * @brief The layout of one draw command in a BufferType::IndirectBuffer
+ * @sa multiDrawElementsIndirect()
+ */
+struct DrawElementsIndirectCommand {
+	uint32_t count = 0u;
+	uint32_t instanceCount = 0u;
+	uint32_t firstIndex = 0u;
+	int32_t baseVertex = 0;
+	uint32_t baseInstance = 0u;
+};
+
 /**
  * Vertex buffer shader attributes
  */
@@ -3,6 +3,7 @@
  */
 
 #include "WindowedApp.h"
+#include "GPUTimer.h"
 #include "Renderer.h"
 #include "Shader.h"
 #include "ShaderManager.h"
@@ -18,6 +19,7 @@
 #include "video/Trace.h"
 #include "core/TimeProvider.h"
 #include "core/Var.h"
+#include "core/concurrent/ThreadPool.h"
 #include "gl/GLVersion.h"
 #include "io/FormatDescription.h"
 #include "io/Filesystem.h"
@@ -47,6 +49,11 @@ inline void checkSDLError(const char *file, unsigned int line, const char *funct
 	}
 }
 #define sdlCheckError() checkSDLError(__FILE__, __LINE__, SDL_FUNCTION)
+
+/**
+ * The amount of frames that are rendered after an event or a redraw request
+ */
+constexpr int RedrawFrames = 3;
 }
 
 WindowedApp::WindowedApp(const io::FilesystemPtr& filesystem, const core::TimeProviderPtr& timeProvider, size_t threadPoolSize) :
@@ -67,6 +74,8 @@ WindowedApp::~WindowedApp() {
 void WindowedApp::onAfterRunning() {
 	core_trace_scoped(WindowedAppAfterRunning);
 	video::endFrame(_window);
+	core::Singleton<GPUTimer>::getInstance().frameEnd();
+	video::endRenderStatsFrame();
 }
 
 bool WindowedApp::handleSDLEvent(SDL_Event& event) {
@@ -106,6 +115,17 @@ bool WindowedApp::handleSDLEvent(SDL_Event& event) {
 	return false;
 }
 
+void WindowedApp::requestRedraw() {
+	if (_redrawFrames.exchange(RedrawFrames) != 0) {
+		return;
+	}
+	// the main thread might wait for events - wake it up
+	SDL_Event event;
+	SDL_zero(event);
+	event.type = SDL_USEREVENT;
+	SDL_PushEvent(&event);
+}
+
 app::AppState WindowedApp::onRunning() {
 	video_trace_scoped(Frame);
 	core_trace_scoped(WindowedAppOnRunning);
@@ -133,8 +153,24 @@ app::AppState WindowedApp::onRunning() {
 			}
 		}
 	}
+	if (_eventDrivenRendering && _showWindow && _redrawFrames <= 0 && !threadPool().busy()) {
+		// nothing changed since the last frames - don't render the same frame again until something happens. The
+		// timeout still renders a few frames per second for the widgets that are animated without input.
+		const int timeout = _idleTimeout->intVal();
+		if (timeout > 0) {
+			core_trace_scoped(WindowedAppWaitEvent);
+			if (SDL_WaitEventTimeout(&event, timeout) == 1) {
+				quit |= handleSDLEvent(event);
+				_redrawFrames = RedrawFrames;
+			}
+		}
+	}
 	while (SDL_PollEvent(&event)) {
 		quit |= handleSDLEvent(event);
+		_redrawFrames = RedrawFrames;
+	}
+	if (_redrawFrames > 0) {
+		--_redrawFrames;
 	}
 
 	if (quit) {
@@ -389,6 +425,7 @@ app::AppState WindowedApp::onInit() {
 	video::viewport(0, 0, _frameBufferDimension.x, _frameBufferDimension.y);
 
 	video_trace_init();
+	core::Singleton<GPUTimer>::getInstance().init();
 
 	return state;
 }
@@ -408,7 +445,10 @@ app::AppState WindowedApp::onConstruct() {
 	core::Var::get(cfg::ClientOpenGLVersion, "3.3", core::CV_READONLY);
 	core::Var::get(cfg::ClientMouseRotationSpeed, "0.01");
 	core::Var::get(cfg::RenderOutline, "false", core::CV_SHADER, "Render voxel outline", core::Var::boolValidator);
+	core::Var::get(cfg::ClientShaderCache, "true", "Cache the linked shader programs to speed up the next start", core::Var::boolValidator);
+	core::Var::get(cfg::ClientTextureCache, "true", "Cache the decoded images of the asynchronously loaded textures", core::Var::boolValidator);
 	core::Var::get(cfg::ClientVSync, "true", "Limit the framerate to the monitor refresh rate", core::Var::boolValidator);
+	_idleTimeout = core::Var::get(cfg::ClientIdleTimeout, "250", "The max milliseconds to wait for input before rendering the next frame if nothing changed - 0 renders continuously");
 	core::Var::get(cfg::ClientDebugSeverity, "0", 0u, "0 disables it, 1 only highest severity, 2 medium severity, 3 everything");
 	core::Var::get(cfg::ClientCameraZoomSpeed, "0.1");
 
@@ -434,6 +474,7 @@ app::AppState WindowedApp::onConstruct() {
 
 app::AppState WindowedApp::onCleanup() {
 	core::Singleton<io::EventHandler>::getInstance().removeObserver(this);
+	core::Singleton<GPUTimer>::getInstance().shutdown();
 	video::destroyContext(_rendererContext);
 	if (_window != nullptr) {
 		SDL_DestroyWindow(_window);
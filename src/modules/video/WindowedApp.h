@@ -5,6 +5,8 @@
 #pragma once
 
 #include "app/App.h"
+#include "core/Var.h"
+#include "core/concurrent/Atomic.h"
 #include "video/IEventObserver.h"
 #include "util/KeybindingHandler.h"
 #include "video/Types.h"
@@ -51,6 +53,18 @@ protected:
 	 * Will block the event queue if the window is minimized of hidden
 	 */
 	bool _powerSaveMode = true;
+	/**
+	 * Only render a new frame if there was input, a redraw was requested or the thread pool is busy - otherwise
+	 * wait for events
+	 * @sa requestRedraw()
+	 * @sa cfg::ClientIdleTimeout
+	 */
+	bool _eventDrivenRendering = false;
+	core::VarPtr _idleTimeout;
+	/**
+	 * The amount of frames that are still rendered without new events - ui widgets need a few frames to settle
+	 */
+	core::AtomicInt _redrawFrames { 0 };
 
 	/**
 	 * Bump this if commands have changed that would make old keybindings invalid
@@ -94,6 +108,12 @@ public:
 
 	void *windowHandle();
 
+	/**
+	 * @brief Render the next frames even if there is no input - e.g. for animations or if a background job finished
+	 * @note Can be called from any thread
+	 */
+	void requestRedraw();
+
 	bool isDarkMode() const;
 
 	/**
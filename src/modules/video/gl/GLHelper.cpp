@@ -242,7 +242,8 @@ void setupFeatures() {
 		{"GL_ARB_multi_draw_indirect"},
 		{"GL_ARB_compute_shader"},
 		{"GL_ARB_transform_feedback2"},
-		{"GL_ARB_shader_storage_buffer_object"}
+		{"GL_ARB_shader_storage_buffer_object"},
+		{"GL_ARB_get_program_binary"}
 	};
 	static_assert(core::enumVal(Feature::Max) == (int)SDL_arraysize(extensionArray), "Array sizes don't match for Feature enum");
 
@@ -275,6 +276,13 @@ void setupFeatures() {
 		}
 	}
 
+	if (renderState().features[core::enumVal(Feature::ProgramBinary)]) {
+		// the extension is also exposed by drivers that don't support any binary format
+		GLint numFormats = 0;
+		glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+		renderState().features[core::enumVal(Feature::ProgramBinary)] = numFormats > 0;
+	}
+
 #ifdef GL_CLIP_ORIGIN
 	GLenum clipOrigin = 0; glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&clipOrigin); // Support for GL 4.5's glClipControl(GL_UPPER_LEFT)
 	if (clipOrigin == GL_UPPER_LEFT) {
@@ -132,7 +132,8 @@ static const GLenum BufferTypes[] {
 	GL_TRANSFORM_FEEDBACK_BUFFER,
 	GL_PIXEL_UNPACK_BUFFER,
 	GL_SHADER_STORAGE_BUFFER,
-	GL_DRAW_INDIRECT_BUFFER
+	GL_DRAW_INDIRECT_BUFFER,
+	GL_PIXEL_PACK_BUFFER
 };
 static_assert(core::enumVal(BufferType::Max) == lengthof(BufferTypes), "Array sizes don't match Max");
 
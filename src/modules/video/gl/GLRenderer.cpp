@@ -445,6 +445,17 @@ bool blendFunc(BlendMode src, BlendMode dest) {
 	return true;
 }
 
+bool blendFuncSeparate(BlendMode srcRGB, BlendMode destRGB, BlendMode srcAlpha, BlendMode destAlpha) {
+	// the cached state can't express separate functions - the next blendFunc() call must be executed
+	glstate().blendSrc = BlendMode::Max;
+	glstate().blendDest = BlendMode::Max;
+	core_assert(glBlendFuncSeparate != nullptr);
+	glBlendFuncSeparate(_priv::BlendModes[core::enumVal(srcRGB)], _priv::BlendModes[core::enumVal(destRGB)],
+						_priv::BlendModes[core::enumVal(srcAlpha)], _priv::BlendModes[core::enumVal(destAlpha)]);
+	checkError();
+	return true;
+}
+
 PolygonMode polygonMode(Face face, PolygonMode mode) {
 	if (glstate().polygonModeFace == face && glstate().polygonMode == mode) {
 		return glstate().polygonMode;
@@ -534,6 +545,27 @@ bool readTexture(TextureUnit unit, TextureType type, TextureFormat format, Id ha
 	return true;
 }
 
+bool readTextureAsync(TextureUnit unit, TextureType type, TextureFormat format, Id handle, Id pixelBuffer) {
+	video_trace_scoped(ReadTextureAsync);
+	bindTexture(unit, type, handle);
+	const _priv::Formats& f = _priv::textureFormats[core::enumVal(format)];
+	const Id oldBuffer = boundBuffer(BufferType::PixelPackBuffer);
+	bindBuffer(BufferType::PixelPackBuffer, pixelBuffer);
+	core_assert(glPixelStorei != nullptr);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	core_assert(glGetTexImage != nullptr);
+	// with a bound pixel pack buffer the pointer is the offset into the buffer
+	glGetTexImage(_priv::TextureTypes[core::enumVal(type)], 0, f.dataFormat, f.dataType, nullptr);
+	const bool error = checkError();
+	// a bound pixel pack buffer would change the behaviour of readTexture()
+	if (oldBuffer == InvalidId) {
+		unbindBuffer(BufferType::PixelPackBuffer);
+	} else {
+		bindBuffer(BufferType::PixelPackBuffer, oldBuffer);
+	}
+	return !error;
+}
+
 bool useProgram(Id handle) {
 	if (glstate().programHandle == handle) {
 		return false;
@@ -591,6 +623,23 @@ void* mapBuffer(Id handle, BufferType type, AccessMode mode) {
 	return data;
 }
 
+void unmapBuffer(Id handle, BufferType type) {
+	video_trace_scoped(UnmapBuffer);
+	if (useFeature(Feature::DirectStateAccess)) {
+		core_assert(glUnmapNamedBuffer != nullptr);
+		glUnmapNamedBuffer(handle);
+		checkError();
+		return;
+	}
+	bindBuffer(type, handle);
+	const int typeIndex = core::enumVal(type);
+	const GLenum glType = _priv::BufferTypes[typeIndex];
+	core_assert(glUnmapBuffer != nullptr);
+	glUnmapBuffer(glType);
+	checkError();
+	unbindBuffer(type);
+}
+
 bool bindBuffer(BufferType type, Id handle) {
 	video_trace_scoped(BindBuffer);
 	const int typeIndex = core::enumVal(type);
@@ -718,8 +767,10 @@ void deleteProgram(Id& id) {
 }
 
 Id genProgram() {
+	if (glCreateProgram == nullptr) {
+		return InvalidId;
+	}
 	checkError();
-	core_assert(glCreateProgram != nullptr);
 	Id id = (Id)glCreateProgram();
 	checkError();
 	return id;
@@ -852,6 +903,107 @@ void deleteFramebuffers(uint8_t amount, Id* ids) {
 	}
 }
 
+Id genOcclusionQuery() {
+	static_assert(sizeof(Id) == sizeof(GLuint), "Unexpected sizes");
+	core_assert(glGenQueries != nullptr);
+	GLuint id = 0u;
+	glGenQueries(1, &id);
+	checkError();
+	return (Id)id;
+}
+
+void deleteOcclusionQuery(Id& id) {
+	if (id == InvalidId) {
+		return;
+	}
+	core_assert(glDeleteQueries != nullptr);
+	const GLuint lid = (GLuint)id;
+	glDeleteQueries(1, &lid);
+	checkError();
+	id = InvalidId;
+}
+
+bool beginOcclusionQuery(Id id) {
+	if (id == InvalidId) {
+		return false;
+	}
+	core_assert(glBeginQuery != nullptr);
+	glBeginQuery(GL_SAMPLES_PASSED, (GLuint)id);
+	return !checkError();
+}
+
+bool endOcclusionQuery(Id id) {
+	if (id == InvalidId) {
+		return false;
+	}
+	core_assert(glEndQuery != nullptr);
+	glEndQuery(GL_SAMPLES_PASSED);
+	return !checkError();
+}
+
+bool isOcclusionQueryAvailable(Id id) {
+	if (id == InvalidId) {
+		return false;
+	}
+	core_assert(glGetQueryObjectiv != nullptr);
+	GLint available = 0;
+	glGetQueryObjectiv((GLuint)id, GL_QUERY_RESULT_AVAILABLE, &available);
+	checkError();
+	return available != 0;
+}
+
+int occlusionQueryResult(Id id, bool wait) {
+	if (id == InvalidId) {
+		return -1;
+	}
+	if (!wait && !isOcclusionQueryAvailable(id)) {
+		return -1;
+	}
+	core_assert(glGetQueryObjectuiv != nullptr);
+	GLuint samples = 0u;
+	glGetQueryObjectuiv((GLuint)id, GL_QUERY_RESULT, &samples);
+	checkError();
+	return (int)samples;
+}
+
+Id genTimestampQuery() {
+	if (glQueryCounter == nullptr) {
+		return InvalidId;
+	}
+	core_assert(glGenQueries != nullptr);
+	GLuint id = 0u;
+	glGenQueries(1, &id);
+	checkError();
+	return (Id)id;
+}
+
+void deleteTimestampQuery(Id& id) {
+	deleteOcclusionQuery(id);
+}
+
+bool queryTimestamp(Id id) {
+	if (id == InvalidId) {
+		return false;
+	}
+	core_assert(glQueryCounter != nullptr);
+	glQueryCounter((GLuint)id, GL_TIMESTAMP);
+	return !checkError();
+}
+
+int64_t timestampQueryResult(Id id, bool wait) {
+	if (id == InvalidId) {
+		return -1;
+	}
+	if (!wait && !isOcclusionQueryAvailable(id)) {
+		return -1;
+	}
+	core_assert(glGetQueryObjectui64v != nullptr);
+	GLuint64 time = 0u;
+	glGetQueryObjectui64v((GLuint)id, GL_QUERY_RESULT, &time);
+	checkError();
+	return (int64_t)time;
+}
+
 void genRenderbuffers(uint8_t amount, Id* ids) {
 	static_assert(sizeof(Id) == sizeof(GLuint), "Unexpected sizes");
 	if (useFeature(Feature::DirectStateAccess)) {
@@ -1000,6 +1152,9 @@ void bufferData(Id handle, BufferType type, BufferMode mode, const void* data, s
 	if (size <= 0) {
 		return;
 	}
+	RenderStats &stats = renderStats();
+	++stats.bufferUploads;
+	stats.bufferUploadBytes += size;
 	core_assert_msg(type != BufferType::UniformBuffer || limit(Limit::MaxUniformBufferSize) <= 0 || (int)size <= limit(Limit::MaxUniformBufferSize),
 			"Given size %i exceeds the max allowed of %i", (int)size, limit(Limit::MaxUniformBufferSize));
 	const GLuint lid = (GLuint)handle;
@@ -1031,11 +1186,100 @@ void bufferData(Id handle, BufferType type, BufferMode mode, const void* data, s
 	checkError();
 }
 
+void copyBufferSubData(Id readHandle, Id writeHandle, intptr_t readOffset, intptr_t writeOffset, size_t size) {
+	video_trace_scoped(CopyBufferSubData);
+	if (size == 0) {
+		return;
+	}
+	if (useFeature(Feature::DirectStateAccess)) {
+		core_assert(glCopyNamedBufferSubData != nullptr);
+		glCopyNamedBufferSubData((GLuint)readHandle, (GLuint)writeHandle, (GLintptr)readOffset, (GLintptr)writeOffset, (GLsizeiptr)size);
+		checkError();
+		return;
+	}
+	// the copy targets are not part of the cached state - they don't affect any other binding
+	core_assert(glCopyBufferSubData != nullptr);
+	glBindBuffer(GL_COPY_READ_BUFFER, (GLuint)readHandle);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, (GLuint)writeHandle);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, (GLintptr)readOffset, (GLintptr)writeOffset, (GLsizeiptr)size);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+	checkError();
+}
+
+void *mapPersistentBuffer(Id handle, BufferType type, size_t size) {
+	video_trace_scoped(MapPersistentBuffer);
+	if (size == 0 || !hasFeature(Feature::BufferStorage)) {
+		return nullptr;
+	}
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLuint lid = (GLuint)handle;
+	void *data;
+	if (useFeature(Feature::DirectStateAccess)) {
+		core_assert(glNamedBufferStorage != nullptr);
+		glNamedBufferStorage(lid, (GLsizeiptr)size, nullptr, flags);
+		checkError();
+		core_assert(glMapNamedBufferRange != nullptr);
+		data = glMapNamedBufferRange(lid, 0, (GLsizeiptr)size, flags);
+		checkError();
+		return data;
+	}
+	const GLenum glType = _priv::BufferTypes[core::enumVal(type)];
+	const Id oldBuffer = boundBuffer(type);
+	const bool changed = bindBuffer(type, handle);
+	core_assert(glBufferStorage != nullptr);
+	glBufferStorage(glType, (GLsizeiptr)size, nullptr, flags);
+	checkError();
+	core_assert(glMapBufferRange != nullptr);
+	data = glMapBufferRange(glType, 0, (GLsizeiptr)size, flags);
+	checkError();
+	if (changed) {
+		if (oldBuffer == InvalidId) {
+			unbindBuffer(type);
+		} else {
+			bindBuffer(type, oldBuffer);
+		}
+	}
+	return data;
+}
+
+IdPtr genFence() {
+	static_assert(sizeof(IdPtr) >= sizeof(GLsync), "Unexpected sizes");
+	core_assert(glFenceSync != nullptr);
+	const GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	checkError();
+	return (IdPtr)sync;
+}
+
+void deleteFence(IdPtr &id) {
+	if (id == InvalidIdPtr) {
+		return;
+	}
+	core_assert(glDeleteSync != nullptr);
+	glDeleteSync((GLsync)id);
+	checkError();
+	id = InvalidIdPtr;
+}
+
+bool waitFence(IdPtr id, uint64_t timeout) {
+	if (id == InvalidIdPtr) {
+		return true;
+	}
+	video_trace_scoped(WaitFence);
+	core_assert(glClientWaitSync != nullptr);
+	const GLenum state = glClientWaitSync((GLsync)id, GL_SYNC_FLUSH_COMMANDS_BIT, (GLuint64)timeout);
+	checkError();
+	return state == GL_ALREADY_SIGNALED || state == GL_CONDITION_SATISFIED;
+}
+
 void bufferSubData(Id handle, BufferType type, intptr_t offset, const void* data, size_t size) {
 	video_trace_scoped(BufferSubData);
 	if (size == 0) {
 		return;
 	}
+	RenderStats &stats = renderStats();
+	++stats.bufferUploads;
+	stats.bufferUploadBytes += size;
 	const int typeIndex = core::enumVal(type);
 	if (useFeature(Feature::DirectStateAccess)) {
 		const GLuint lid = (GLuint)handle;
@@ -1244,6 +1488,7 @@ void setupTexture(const TextureConfig& config) {
 
 void uploadTexture(TextureType type, TextureFormat format, int width, int height, const uint8_t* data, int index, int samples) {
 	video_trace_scoped(UploadTexture);
+	++renderStats().textureUploads;
 	const _priv::Formats& f = _priv::textureFormats[core::enumVal(format)];
 	const GLenum glType = _priv::TextureTypes[core::enumVal(type)];
 	core_assert(type != TextureType::Max);
@@ -1271,6 +1516,32 @@ void uploadTexture(TextureType type, TextureFormat format, int width, int height
 	}
 }
 
+static inline void countDrawCall(Primitive mode, size_t numIndices, size_t instances = 1u) {
+	RenderStats &stats = renderStats();
+	++stats.drawCalls;
+	if (mode == Primitive::Triangles) {
+		stats.triangles += numIndices / 3u * instances;
+	} else if (mode == Primitive::TriangleStrip && numIndices >= 3u) {
+		stats.triangles += (numIndices - 2u) * instances;
+	}
+}
+
+void multiDrawElementsIndirect(Primitive mode, DataType type, int drawCount, intptr_t offset) {
+	video_trace_scoped(MultiDrawElementsIndirect);
+	if (drawCount <= 0) {
+		return;
+	}
+	core_assert_msg(glstate().vertexArrayHandle != InvalidId, "No vertex buffer is bound for this draw call");
+	const GLenum glMode = _priv::Primitives[core::enumVal(mode)];
+	const GLenum glType = _priv::DataTypes[core::enumVal(type)];
+	video::validate(glstate().programHandle);
+	core_assert(glMultiDrawElementsIndirect != nullptr);
+	glMultiDrawElementsIndirect(glMode, glType, (const GLvoid*)offset, (GLsizei)drawCount, 0);
+	checkError();
+	// the index counts are only known to the gpu
+	renderStats().drawCalls += (uint32_t)drawCount;
+}
+
 void drawElements(Primitive mode, size_t numIndices, DataType type, void* offset) {
 	video_trace_scoped(DrawElements);
 	if (numIndices <= 0) {
@@ -1283,15 +1554,32 @@ void drawElements(Primitive mode, size_t numIndices, DataType type, void* offset
 	core_assert(glDrawElements != nullptr);
 	glDrawElements(glMode, (GLsizei)numIndices, glType, (GLvoid*)offset);
 	checkError();
+	countDrawCall(mode, numIndices);
 }
 
-void drawArrays(Primitive mode, size_t count) {
+void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, int instances, void* offset) {
+	video_trace_scoped(DrawElementsInstanced);
+	if (numIndices <= 0 || instances <= 0) {
+		return;
+	}
+	core_assert_msg(glstate().vertexArrayHandle != InvalidId, "No vertex buffer is bound for this draw call");
+	const GLenum glMode = _priv::Primitives[core::enumVal(mode)];
+	const GLenum glType = _priv::DataTypes[core::enumVal(type)];
+	video::validate(glstate().programHandle);
+	core_assert(glDrawElementsInstanced != nullptr);
+	glDrawElementsInstanced(glMode, (GLsizei)numIndices, glType, (GLvoid*)offset, (GLsizei)instances);
+	checkError();
+	countDrawCall(mode, numIndices, (size_t)instances);
+}
+
+void drawArrays(Primitive mode, size_t count, size_t first) {
 	video_trace_scoped(DrawArrays);
 	const GLenum glMode = _priv::Primitives[core::enumVal(mode)];
 	video::validate(glstate().programHandle);
 	core_assert(glDrawArrays != nullptr);
-	glDrawArrays(glMode, (GLint)0, (GLsizei)count);
+	glDrawArrays(glMode, (GLint)first, (GLsizei)count);
 	checkError();
+	countDrawCall(mode, count);
 }
 
 void enableDebug(DebugSeverity severity) {
@@ -1401,6 +1689,11 @@ bool linkComputeShader(Id program, Id comp, const core::String& name) {
 	core_assert(glAttachShader != nullptr);
 	glAttachShader(lid, comp);
 	video::checkError();
+	if (hasFeature(Feature::ProgramBinary)) {
+		core_assert(glProgramParameteri != nullptr);
+		glProgramParameteri(lid, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		checkError();
+	}
 	core_assert(glLinkProgram != nullptr);
 	glLinkProgram(lid);
 	GLint status = 0;
@@ -1478,7 +1771,7 @@ bool runShader(Id program, const glm::uvec3& workGroups, bool wait) {
 		glMemoryBarrier(GL_ALL_BARRIER_BITS);
 		video::checkError();
 	}
-	return false;
+	return true;
 }
 
 bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String& name) {
@@ -1494,6 +1787,11 @@ bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String& name)
 		checkError();
 	}
 
+	if (hasFeature(Feature::ProgramBinary)) {
+		core_assert(glProgramParameteri != nullptr);
+		glProgramParameteri(lid, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		checkError();
+	}
 	core_assert(glLinkProgram != nullptr);
 	glLinkProgram(lid);
 	checkError();
@@ -1537,6 +1835,53 @@ bool linkShader(Id program, Id vert, Id frag, Id geom, const core::String& name)
 	return true;
 }
 
+const core::String &driverIdentifier() {
+	return glstate().driver;
+}
+
+bool programBinary(Id program, uint32_t &format, core::DynamicArray<uint8_t> &binary) {
+	if (program == InvalidId || !hasFeature(Feature::ProgramBinary)) {
+		return false;
+	}
+	video_trace_scoped(ProgramBinary);
+	const GLuint lid = (GLuint)program;
+	GLint length = 0;
+	core_assert(glGetProgramiv != nullptr);
+	glGetProgramiv(lid, GL_PROGRAM_BINARY_LENGTH, &length);
+	checkError();
+	if (length <= 0) {
+		return false;
+	}
+	binary.resize(length);
+	GLenum binaryFormat = 0;
+	GLsizei written = 0;
+	core_assert(glGetProgramBinary != nullptr);
+	glGetProgramBinary(lid, length, &written, &binaryFormat, binary.data());
+	if (checkError() || written <= 0) {
+		binary.clear();
+		return false;
+	}
+	binary.resize(written);
+	format = (uint32_t)binaryFormat;
+	return true;
+}
+
+bool loadProgramBinary(Id program, uint32_t format, const uint8_t *binary, size_t size) {
+	if (program == InvalidId || !hasFeature(Feature::ProgramBinary) || binary == nullptr || size == 0u) {
+		return false;
+	}
+	video_trace_scoped(LoadProgramBinary);
+	const GLuint lid = (GLuint)program;
+	core_assert(glProgramBinary != nullptr);
+	glProgramBinary(lid, (GLenum)format, binary, (GLsizei)size);
+	// an outdated binary is no error - the status just tells us that we have to link the sources
+	checkError(false);
+	GLint status = 0;
+	glGetProgramiv(lid, GL_LINK_STATUS, &status);
+	checkError();
+	return status == GL_TRUE;
+}
+
 int fetchUniforms(Id program, ShaderUniforms& uniforms, const core::String& name) {
 	video_trace_scoped(FetchUniforms);
 	int uniformsCnt = _priv::fillUniforms(program, uniforms, name, false);
@@ -1690,6 +2035,8 @@ bool init(int windowWidth, int windowHeight, float scaleFactor) {
 	Log::debug("GL_VENDOR: %s", glvendor);
 	Log::debug("GL_RENDERER: %s", glrenderer);
 	Log::debug("GL_VERSION: %s", glversion);
+	glstate().driver = core::string::format("%s %s %s", glvendor != nullptr ? glvendor : "",
+		glrenderer != nullptr ? glrenderer : "", glversion != nullptr ? glversion : "");
 	if (glvendor != nullptr) {
 		const core::String vendor(glvendor);
 		for (int i = 0; i < core::enumVal(Vendor::Max); ++i) {
@@ -82,6 +82,8 @@ struct GLState {
 	glm::vec2 aliasedLineWidth = glm::vec2(-1.0f);
 	float lineWidth = 1.0f;
 	core::BitSet vendor{core::enumVal(Vendor::Max)};
+	// vendor, renderer and version string of the driver
+	core::String driver;
 };
 
 }
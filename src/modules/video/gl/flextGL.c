@@ -62,6 +62,10 @@ int flextInit(void)
         FLEXT_ARB_shader_storage_buffer_object = GL_TRUE;
     }
 
+    if (SDL_GL_ExtensionSupported("GL_ARB_get_program_binary")) {
+        FLEXT_ARB_get_program_binary = GL_TRUE;
+    }
+
 
     return 0;
 }
@@ -186,6 +190,12 @@ void flextLoadOpenGLFunctions(void)
     glpfVertexArrayVertexBuffer = (PFNGLVERTEXARRAYVERTEXBUFFER_PROC*)SDL_GL_GetProcAddress("glVertexArrayVertexBuffer");
     glpfVertexArrayVertexBuffers = (PFNGLVERTEXARRAYVERTEXBUFFERS_PROC*)SDL_GL_GetProcAddress("glVertexArrayVertexBuffers");
 
+    /* GL_ARB_get_program_binary */
+
+    glpfGetProgramBinary = (PFNGLGETPROGRAMBINARY_PROC*)SDL_GL_GetProcAddress("glGetProgramBinary");
+    glpfProgramBinary = (PFNGLPROGRAMBINARY_PROC*)SDL_GL_GetProcAddress("glProgramBinary");
+    glpfProgramParameteri = (PFNGLPROGRAMPARAMETERI_PROC*)SDL_GL_GetProcAddress("glProgramParameteri");
+
     /* GL_ARB_draw_indirect */
 
     glpfDrawArraysIndirect = (PFNGLDRAWARRAYSINDIRECT_PROC*)SDL_GL_GetProcAddress("glDrawArraysIndirect");
@@ -612,6 +622,7 @@ int FLEXT_ARB_compute_shader = GL_FALSE;
 int FLEXT_ARB_shader_image_load_store = GL_FALSE;
 int FLEXT_ARB_transform_feedback2 = GL_FALSE;
 int FLEXT_ARB_shader_storage_buffer_object = GL_FALSE;
+int FLEXT_ARB_get_program_binary = GL_FALSE;
 
 /* ---------------------- Function pointer definitions --------------------- */
 
@@ -731,6 +742,12 @@ PFNGLVERTEXARRAYELEMENTBUFFER_PROC* glpfVertexArrayElementBuffer = NULL;
 PFNGLVERTEXARRAYVERTEXBUFFER_PROC* glpfVertexArrayVertexBuffer = NULL;
 PFNGLVERTEXARRAYVERTEXBUFFERS_PROC* glpfVertexArrayVertexBuffers = NULL;
 
+/* GL_ARB_get_program_binary */
+
+PFNGLGETPROGRAMBINARY_PROC* glpfGetProgramBinary = NULL;
+PFNGLPROGRAMBINARY_PROC* glpfProgramBinary = NULL;
+PFNGLPROGRAMPARAMETERI_PROC* glpfProgramParameteri = NULL;
+
 /* GL_ARB_draw_indirect */
 
 PFNGLDRAWARRAYSINDIRECT_PROC* glpfDrawArraysIndirect = NULL;
@@ -1001,6 +1001,13 @@ typedef void (APIENTRY *GLDEBUGPROCARB)(GLenum source,GLenum type,GLuint id,GLen
 #define GL_BUFFER_IMMUTABLE_STORAGE 0x821F
 #define GL_BUFFER_STORAGE_FLAGS 0x8220
 
+/* GL_ARB_get_program_binary */
+
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#define GL_PROGRAM_BINARY_FORMATS 0x87FF
+
 /* GL_ARB_draw_indirect */
 
 #define GL_DRAW_INDIRECT_BUFFER 0x8F3F
@@ -1464,6 +1471,21 @@ GLAPI PFNGLVERTEXARRAYVERTEXBUFFERS_PROC* glpfVertexArrayVertexBuffers;
 #define glVertexArrayVertexBuffers glpfVertexArrayVertexBuffers
 
 
+/* GL_ARB_get_program_binary */
+
+typedef void (APIENTRY PFNGLGETPROGRAMBINARY_PROC (GLuint program, GLsizei bufSize, GLsizei * length, GLenum * binaryFormat, void * binary));
+typedef void (APIENTRY PFNGLPROGRAMBINARY_PROC (GLuint program, GLenum binaryFormat, const void * binary, GLsizei length));
+typedef void (APIENTRY PFNGLPROGRAMPARAMETERI_PROC (GLuint program, GLenum pname, GLint value));
+
+GLAPI PFNGLGETPROGRAMBINARY_PROC* glpfGetProgramBinary;
+GLAPI PFNGLPROGRAMBINARY_PROC* glpfProgramBinary;
+GLAPI PFNGLPROGRAMPARAMETERI_PROC* glpfProgramParameteri;
+
+#define glGetProgramBinary glpfGetProgramBinary
+#define glProgramBinary glpfProgramBinary
+#define glProgramParameteri glpfProgramParameteri
+
+
 /* GL_ARB_draw_indirect */
 
 typedef void (APIENTRY PFNGLDRAWARRAYSINDIRECT_PROC (GLenum mode, const void * indirect));
@@ -2656,6 +2678,7 @@ GLAPI PFNGLVERTEXATTRIBP4UIV_PROC* glpfVertexAttribP4uiv;
 #define GL_ARB_debug_output
 #define GL_ARB_direct_state_access
 #define GL_ARB_draw_indirect
+#define GL_ARB_get_program_binary
 #define GL_ARB_instanced_arrays
 #define GL_ARB_multi_draw_indirect
 #define GL_ARB_shader_image_load_store
@@ -2687,6 +2710,7 @@ extern int FLEXT_ARB_compute_shader;
 extern int FLEXT_ARB_shader_image_load_store;
 extern int FLEXT_ARB_transform_feedback2;
 extern int FLEXT_ARB_shader_storage_buffer_object;
+extern int FLEXT_ARB_get_program_binary;
 
 int flextInit(void);
 
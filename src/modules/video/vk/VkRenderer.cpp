@@ -5,6 +5,11 @@
  */
 
 #include "VkRenderer.h"
+#include "VkState.h"
+#include "app/App.h"
+#include "core/ArrayLength.h"
+#include "core/Assert.h"
+#include "core/concurrent/ThreadPool.h"
 #include "core/Log.h"
 #include "core/StandardLib.h"
 #include "core/Var.h"
@@ -17,93 +22,130 @@
 
 namespace video {
 
+static inline _priv::VkState &vkstate() {
+	static _priv::VkState s;
+	return s;
+}
+
+static bool vkCheck(VkResult result, const char *what) {
+	if (result == VK_SUCCESS) {
+		return true;
+	}
+	Log::error("%s failed with vulkan error %i", what, (int)result);
+	return false;
+}
+
+/**
+ * @brief Picks the first queue family that supports graphics and is able to present to the surface
+ */
+static bool findQueueFamily(VkPhysicalDevice physicalDevice, VkSurfaceKHR surface, uint32_t &queueFamily) {
+	uint32_t count = 0u;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, nullptr);
+	core::DynamicArray<VkQueueFamilyProperties> properties;
+	properties.resize(count);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &count, properties.data());
+	for (uint32_t i = 0u; i < count; ++i) {
+		if ((properties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0) {
+			continue;
+		}
+		VkBool32 present = VK_FALSE;
+		if (surface != VK_NULL_HANDLE) {
+			vkGetPhysicalDeviceSurfaceSupportKHR(physicalDevice, i, surface, &present);
+		}
+		if (present == VK_TRUE) {
+			queueFamily = i;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool createCommandPool(VkCommandPool &commandPool) {
+	VkCommandPoolCreateInfo commandPoolCreateInfo;
+	core_memset(&commandPoolCreateInfo, 0, sizeof(commandPoolCreateInfo));
+	commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	commandPoolCreateInfo.queueFamilyIndex = vkstate().queueFamily;
+	return vkCheck(vkCreateCommandPool(vkstate().device, &commandPoolCreateInfo, nullptr, &commandPool),
+				   "vkCreateCommandPool");
+}
+
 void setup() {
 }
 
 bool init(int windowWidth, int windowHeight, float scaleFactor) {
-	if (flextVkInit() == -1) {
-		Log::error("Could not initialize opengl: %s", SDL_GetError());
+	_priv::VkState &state = vkstate();
+	if (state.instance == VK_NULL_HANDLE) {
+		Log::error("No vulkan instance - createContext() must be called before init()");
 		return false;
 	}
 
-	SDL_Window *window = nullptr;
-
-	VkInstance instance;
-	{
-		unsigned int count;
-		SDL_Vulkan_GetInstanceExtensions(window, &count, nullptr);
-		const char **names = (const char **)core_malloc(sizeof(const char *) * count);
-		SDL_Vulkan_GetInstanceExtensions(window, &count, names);
-
-		VkInstanceCreateInfo createInfo;
-		createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
-		createInfo.pNext = nullptr;
-		createInfo.flags = 0;
-		createInfo.pApplicationInfo = nullptr;
-		createInfo.enabledLayerCount = 0;
-		createInfo.ppEnabledLayerNames = nullptr;
-		createInfo.enabledExtensionCount = count;
-		createInfo.ppEnabledExtensionNames = names;
-
-		vkCreateInstance(&createInfo, nullptr, &instance);
-		core_free(names);
+	uint32_t physicalDeviceCount = 0u;
+	if (!vkCheck(vkEnumeratePhysicalDevices(state.instance, &physicalDeviceCount, nullptr),
+				 "vkEnumeratePhysicalDevices")) {
+		return false;
 	}
-
-	uint32_t physicalDeviceCount;
-	vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, nullptr);
-	VkPhysicalDevice *physicalDevices = (VkPhysicalDevice *)core_malloc(sizeof(VkPhysicalDevice) * physicalDeviceCount);
-	vkEnumeratePhysicalDevices(instance, &physicalDeviceCount, physicalDevices);
+	core::DynamicArray<VkPhysicalDevice> physicalDevices;
+	physicalDevices.resize(physicalDeviceCount);
+	vkEnumeratePhysicalDevices(state.instance, &physicalDeviceCount, physicalDevices.data());
+	for (VkPhysicalDevice physicalDevice : physicalDevices) {
+		if (findQueueFamily(physicalDevice, state.surface, state.queueFamily)) {
+			state.physicalDevice = physicalDevice;
+			break;
+		}
+	}
+	if (state.physicalDevice == VK_NULL_HANDLE) {
+		Log::error("No vulkan device with graphics and present support found");
+		return false;
+	}
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(state.physicalDevice, &properties);
+	Log::debug("Vulkan device: %s", properties.deviceName);
 
 	VkDeviceQueueCreateInfo queueCreateInfo;
+	core_memset(&queueCreateInfo, 0, sizeof(queueCreateInfo));
 	queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-	queueCreateInfo.pNext = nullptr;
-	queueCreateInfo.flags = 0;
-	queueCreateInfo.queueFamilyIndex = 0;
+	queueCreateInfo.queueFamilyIndex = state.queueFamily;
 	queueCreateInfo.queueCount = 1;
 	const float queuePriority = 1.0f;
 	queueCreateInfo.pQueuePriorities = &queuePriority;
 
+	const char *deviceExtensions[] = {VK_KHR_SWAPCHAIN_EXTENSION_NAME};
 	VkDeviceCreateInfo deviceCreateInfo;
+	core_memset(&deviceCreateInfo, 0, sizeof(deviceCreateInfo));
 	deviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
-	deviceCreateInfo.pNext = nullptr;
-	deviceCreateInfo.flags = 0;
 	deviceCreateInfo.queueCreateInfoCount = 1;
 	deviceCreateInfo.pQueueCreateInfos = &queueCreateInfo;
-	deviceCreateInfo.enabledLayerCount = 0;
-	deviceCreateInfo.ppEnabledLayerNames = nullptr;
-	deviceCreateInfo.enabledExtensionCount = 0;
-	deviceCreateInfo.ppEnabledExtensionNames = nullptr;
-	deviceCreateInfo.pEnabledFeatures = nullptr;
-
-	VkDevice device;
-	vkCreateDevice(physicalDevices[0], &deviceCreateInfo, nullptr, &device);
-
-	core_free(physicalDevices);
-
-	VkQueue queue;
-	vkGetDeviceQueue(device, 0, 0, &queue);
-
-	VkCommandPoolCreateInfo commandPoolCreateInfo;
-	commandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-	commandPoolCreateInfo.pNext = nullptr;
-	commandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-	commandPoolCreateInfo.queueFamilyIndex = 0;
+	deviceCreateInfo.enabledExtensionCount = lengthof(deviceExtensions);
+	deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions;
+	if (!vkCheck(vkCreateDevice(state.physicalDevice, &deviceCreateInfo, nullptr, &state.device), "vkCreateDevice")) {
+		return false;
+	}
+	vkGetDeviceQueue(state.device, state.queueFamily, 0, &state.queue);
 
-	VkCommandPool commandPool;
-	vkCreateCommandPool(device, &commandPoolCreateInfo, nullptr, &commandPool);
+	if (!createCommandPool(state.commandPool)) {
+		return false;
+	}
 
 	VkCommandBufferAllocateInfo allocateInfo;
+	core_memset(&allocateInfo, 0, sizeof(allocateInfo));
 	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-	allocateInfo.pNext = nullptr;
-	allocateInfo.commandPool = commandPool;
+	allocateInfo.commandPool = state.commandPool;
 	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
 	allocateInfo.commandBufferCount = 1;
+	if (!vkCheck(vkAllocateCommandBuffers(state.device, &allocateInfo, &state.commandBuffer),
+				 "vkAllocateCommandBuffers")) {
+		return false;
+	}
 
-	VkCommandBuffer commandBuffer;
-	vkAllocateCommandBuffers(device, &allocateInfo, &commandBuffer);
-
-	VkSurfaceKHR surface;
-	SDL_Vulkan_CreateSurface(window, instance, &surface);
+	const size_t threads = app::App::getInstance()->threadPool().size();
+	state.threadCommandPools.resize(threads);
+	for (size_t i = 0; i < threads; ++i) {
+		state.threadCommandPools[i] = VK_NULL_HANDLE;
+		if (!createCommandPool(state.threadCommandPools[i])) {
+			return false;
+		}
+	}
 
 	if (useFeature(Feature::DirectStateAccess)) {
 		Log::debug("Use direct state access");
@@ -134,10 +176,72 @@ glm::ivec2 getWindowSize() {
 }
 
 void destroyContext(RendererContext &context) {
+	_priv::VkState &state = vkstate();
+	if (state.device != VK_NULL_HANDLE) {
+		vkDeviceWaitIdle(state.device);
+		for (VkCommandPool commandPool : state.threadCommandPools) {
+			if (commandPool != VK_NULL_HANDLE) {
+				vkDestroyCommandPool(state.device, commandPool, nullptr);
+			}
+		}
+		if (state.commandPool != VK_NULL_HANDLE) {
+			// this also frees the command buffers of the pool
+			vkDestroyCommandPool(state.device, state.commandPool, nullptr);
+		}
+		vkDestroyDevice(state.device, nullptr);
+	}
+	if (state.surface != VK_NULL_HANDLE) {
+		vkDestroySurfaceKHR(state.instance, state.surface, nullptr);
+	}
+	if (state.instance != VK_NULL_HANDLE) {
+		vkDestroyInstance(state.instance, nullptr);
+	}
+	state = _priv::VkState();
+	context = nullptr;
 }
 
 RendererContext createContext(SDL_Window *window) {
-	return nullptr;
+	core_assert(window != nullptr);
+	if (flextVkInit() == -1) {
+		Log::error("Could not initialize vulkan: %s", SDL_GetError());
+		return nullptr;
+	}
+	_priv::VkState &state = vkstate();
+	state.window = window;
+
+	unsigned int count = 0u;
+	if (!SDL_Vulkan_GetInstanceExtensions(window, &count, nullptr)) {
+		Log::error("Could not get the vulkan instance extensions: %s", SDL_GetError());
+		return nullptr;
+	}
+	core::DynamicArray<const char *> names;
+	names.resize(count);
+	SDL_Vulkan_GetInstanceExtensions(window, &count, names.data());
+
+	VkApplicationInfo applicationInfo;
+	core_memset(&applicationInfo, 0, sizeof(applicationInfo));
+	applicationInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	applicationInfo.pEngineName = "vengi";
+	applicationInfo.apiVersion = VK_API_VERSION_1_0;
+
+	VkInstanceCreateInfo createInfo;
+	core_memset(&createInfo, 0, sizeof(createInfo));
+	createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	createInfo.pApplicationInfo = &applicationInfo;
+	createInfo.enabledExtensionCount = count;
+	createInfo.ppEnabledExtensionNames = names.data();
+	if (!vkCheck(vkCreateInstance(&createInfo, nullptr, &state.instance), "vkCreateInstance")) {
+		state.instance = VK_NULL_HANDLE;
+		return nullptr;
+	}
+	// the instance and device level functions are resolved by the instance
+	flextVkInitInstance(state.instance);
+
+	if (!SDL_Vulkan_CreateSurface(window, state.instance, &state.surface)) {
+		Log::error("Could not create the vulkan surface: %s", SDL_GetError());
+		state.surface = VK_NULL_HANDLE;
+	}
+	return (RendererContext)&state;
 }
 
 void activateContext(SDL_Window *window, RendererContext &context) {
@@ -220,6 +324,10 @@ bool blendFunc(BlendMode src, BlendMode dest) {
 	return false;
 }
 
+bool blendFuncSeparate(BlendMode srcRGB, BlendMode destRGB, BlendMode srcAlpha, BlendMode destAlpha) {
+	return false;
+}
+
 bool blendEquation(BlendEquation func) {
 	return false;
 }
@@ -248,6 +356,10 @@ bool readTexture(TextureUnit unit, TextureType type, TextureFormat format, Id ha
 	return false;
 }
 
+bool readTextureAsync(TextureUnit unit, TextureType type, TextureFormat format, Id handle, Id pixelBuffer) {
+	return false;
+}
+
 bool useProgram(Id handle) {
 	return false;
 }
@@ -268,6 +380,13 @@ Id boundBuffer(BufferType type) {
 	return InvalidId;
 }
 
+void *mapBuffer(Id handle, BufferType type, AccessMode mode) {
+	return nullptr;
+}
+
+void unmapBuffer(Id handle, BufferType type) {
+}
+
 bool bindBuffer(BufferType type, Id handle) {
 	return false;
 }
@@ -340,6 +459,44 @@ void genRenderbuffers(uint8_t amount, Id *ids) {
 void deleteRenderbuffers(uint8_t amount, Id *ids) {
 }
 
+Id genOcclusionQuery() {
+	return InvalidId;
+}
+
+void deleteOcclusionQuery(Id &id) {
+}
+
+bool beginOcclusionQuery(Id id) {
+	return false;
+}
+
+bool endOcclusionQuery(Id id) {
+	return false;
+}
+
+bool isOcclusionQueryAvailable(Id id) {
+	return false;
+}
+
+int occlusionQueryResult(Id id, bool wait) {
+	return -1;
+}
+
+Id genTimestampQuery() {
+	return InvalidId;
+}
+
+void deleteTimestampQuery(Id &id) {
+}
+
+bool queryTimestamp(Id id) {
+	return false;
+}
+
+int64_t timestampQueryResult(Id id, bool wait) {
+	return -1;
+}
+
 void configureAttribute(const Attribute &a) {
 }
 
@@ -364,6 +521,24 @@ void bufferData(Id handle, BufferType type, BufferMode mode, const void *data, s
 void bufferSubData(Id handle, BufferType type, intptr_t offset, const void *data, size_t size) {
 }
 
+void copyBufferSubData(Id readHandle, Id writeHandle, intptr_t readOffset, intptr_t writeOffset, size_t size) {
+}
+
+void *mapPersistentBuffer(Id handle, BufferType type, size_t size) {
+	return nullptr;
+}
+
+IdPtr genFence() {
+	return InvalidIdPtr;
+}
+
+void deleteFence(IdPtr &id) {
+}
+
+bool waitFence(IdPtr id, uint64_t timeout) {
+	return true;
+}
+
 const glm::vec4 &framebufferUV() {
 	static glm::vec4 todo;
 	return todo;
@@ -386,7 +561,13 @@ void uploadTexture(video::TextureType type, video::TextureFormat format, int wid
 void drawElements(Primitive mode, size_t numIndices, DataType type, void *offset) {
 }
 
-void drawArrays(Primitive mode, size_t count) {
+void drawElementsInstanced(Primitive mode, size_t numIndices, DataType type, int instances, void *offset) {
+}
+
+void multiDrawElementsIndirect(Primitive mode, DataType type, int drawCount, intptr_t offset) {
+}
+
+void drawArrays(Primitive mode, size_t count, size_t first) {
 }
 
 void enableDebug(DebugSeverity severity) {
@@ -404,6 +585,19 @@ bool linkComputeShader(Id program, Id comp, const core::String &name) {
 	return false;
 }
 
+const core::String &driverIdentifier() {
+	static const core::String empty;
+	return empty;
+}
+
+bool programBinary(Id program, uint32_t &format, core::DynamicArray<uint8_t> &binary) {
+	return false;
+}
+
+bool loadProgramBinary(Id program, uint32_t format, const uint8_t *binary, size_t size) {
+	return false;
+}
+
 bool bindImage(Id handle, AccessMode mode, ImageFormat format) {
 	return false;
 }
@@ -0,0 +1,37 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include "flextVk.h"
+
+struct SDL_Window;
+
+namespace video {
+
+namespace _priv {
+
+/**
+ * The handles of the vulkan device that the renderer is using
+ */
+struct VkState {
+	SDL_Window *window = nullptr;
+	VkInstance instance = VK_NULL_HANDLE;
+	VkSurfaceKHR surface = VK_NULL_HANDLE;
+	VkPhysicalDevice physicalDevice = VK_NULL_HANDLE;
+	// the queue family that supports graphics and presenting to the surface
+	uint32_t queueFamily = 0u;
+	VkDevice device = VK_NULL_HANDLE;
+	VkQueue queue = VK_NULL_HANDLE;
+	VkCommandPool commandPool = VK_NULL_HANDLE;
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	// command pools are not thread safe - every worker of the thread pool records its secondary
+	// command buffers into its own pool
+	core::DynamicArray<VkCommandPool> threadCommandPools;
+};
+
+} // namespace _priv
+
+} // namespace video
@@ -39,6 +39,20 @@ struct ChunkMesh {
 			mesh[i].removeUnusedVertices();
 		}
 	}
+	void optimize(int primitiveIndices = 3) {
+		for (int i = 0; i < Meshes; ++i) {
+			mesh[i].optimize(primitiveIndices);
+		}
+	}
+	/**
+	 * @param ratio The amount of triangles that are kept - see Mesh::simplify()
+	 */
+	void simplify(float ratio, float maxError = -1.0f) {
+		for (int i = 0; i < Meshes; ++i) {
+			const size_t triangles = mesh[i].getNoOfIndices() / 3u;
+			mesh[i].simplify((size_t)((float)triangles * ratio), maxError);
+		}
+	}
 	void compressIndices() {
 		for (int i = 0; i < Meshes; ++i) {
 			mesh[i].compressedIndices();
@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#include "CubicFaceExtractor.h"
+#include "RawVolume.h"
+#include "Region.h"
+#include "Voxel.h"
+#include "core/Memory.h"
+#include "core/Trace.h"
+
+namespace voxel {
+
+// see the corner table in the voxelpulling shader
+static const glm::ivec3 FaceCorners[core::enumVal(FaceNames::Max)][4] = {
+	{glm::ivec3(1, 0, 0), glm::ivec3(1, 1, 0), glm::ivec3(1, 1, 1), glm::ivec3(1, 0, 1)}, // PositiveX
+	{glm::ivec3(0, 1, 0), glm::ivec3(0, 1, 1), glm::ivec3(1, 1, 1), glm::ivec3(1, 1, 0)}, // PositiveY
+	{glm::ivec3(0, 0, 1), glm::ivec3(1, 0, 1), glm::ivec3(1, 1, 1), glm::ivec3(0, 1, 1)}, // PositiveZ
+	{glm::ivec3(0, 0, 0), glm::ivec3(0, 0, 1), glm::ivec3(0, 1, 1), glm::ivec3(0, 1, 0)}, // NegativeX
+	{glm::ivec3(0, 0, 0), glm::ivec3(1, 0, 0), glm::ivec3(1, 0, 1), glm::ivec3(0, 0, 1)}, // NegativeY
+	{glm::ivec3(0, 0, 0), glm::ivec3(0, 1, 0), glm::ivec3(1, 1, 0), glm::ivec3(1, 0, 0)}  // NegativeZ
+};
+
+const glm::ivec3 &faceCorner(FaceNames face, int corner) {
+	return FaceCorners[core::enumVal(face)][corner];
+}
+
+static inline bool isOccluding(const RawVolume *volData, const glm::ivec3 &pos) {
+	const VoxelType material = volData->voxel(pos).getMaterial();
+	return !isAir(material) && !isTransparent(material);
+}
+
+/**
+ * @brief The same ambient occlusion values the CubicSurfaceExtractor assigns to the vertices
+ */
+static uint8_t faceAmbientOcclusion(const RawVolume *volData, const glm::ivec3 &pos, FaceNames face) {
+	const int axis = core::enumVal(face) % 3;
+	const int axisU = (axis + 1) % 3;
+	const int axisW = (axis + 2) % 3;
+	// the voxel in front of the face
+	glm::ivec3 front = pos;
+	front[axis] += core::enumVal(face) < 3 ? 1 : -1;
+	uint8_t ambientOcclusion = 0u;
+	for (int corner = 0; corner < 4; ++corner) {
+		const glm::ivec3 &offset = faceCorner(face, corner);
+		glm::ivec3 side1 = front;
+		side1[axisU] += offset[axisU] != 0 ? 1 : -1;
+		glm::ivec3 side2 = front;
+		side2[axisW] += offset[axisW] != 0 ? 1 : -1;
+		glm::ivec3 diagonal = side1;
+		diagonal[axisW] = side2[axisW];
+		const bool occludedSide1 = isOccluding(volData, side1);
+		const bool occludedSide2 = isOccluding(volData, side2);
+		uint8_t value = 0u;
+		if (!occludedSide1 || !occludedSide2) {
+			value = 3 - (occludedSide1 + occludedSide2 + isOccluding(volData, diagonal));
+		}
+		ambientOcclusion |= (uint8_t)(value << (corner * 2));
+	}
+	return ambientOcclusion;
+}
+
+void extractCubicFaces(const voxel::RawVolume *volData, const Region &region, ChunkFaces *result) {
+	core_trace_scoped(ExtractCubicFaces);
+	core_memory_scope(Mesh);
+	static const glm::ivec3 normals[core::enumVal(FaceNames::Max)] = {
+		glm::ivec3(1, 0, 0), glm::ivec3(0, 1, 0), glm::ivec3(0, 0, 1),
+		glm::ivec3(-1, 0, 0), glm::ivec3(0, -1, 0), glm::ivec3(0, 0, -1)
+	};
+	const glm::ivec3 &lower = region.getLowerCorner();
+	const glm::ivec3 &upper = region.getUpperCorner();
+	for (int32_t z = lower.z; z <= upper.z; ++z) {
+		for (int32_t y = lower.y; y <= upper.y; ++y) {
+			for (int32_t x = lower.x; x <= upper.x; ++x) {
+				const glm::ivec3 pos(x, y, z);
+				const Voxel &voxel = volData->voxel(pos);
+				const VoxelType material = voxel.getMaterial();
+				if (isAir(material)) {
+					continue;
+				}
+				const bool transparent = isTransparent(material);
+				for (int face = 0; face < core::enumVal(FaceNames::Max); ++face) {
+					const VoxelType neighbour = volData->voxel(pos + normals[face]).getMaterial();
+					// same rules as for the quads of the CubicSurfaceExtractor - opaque faces are hidden by
+					// opaque neighbours, transparent faces by transparent neighbours
+					if (!isAir(neighbour) && isTransparent(neighbour) == transparent) {
+						continue;
+					}
+					VoxelFace voxelFace;
+					voxelFace.x = (int16_t)x;
+					voxelFace.y = (int16_t)y;
+					voxelFace.z = (int16_t)z;
+					voxelFace.colorIndex = voxel.getColor();
+					voxelFace.face = (uint8_t)face;
+					voxelFace.flags = voxel.getFlags();
+					voxelFace.ambientOcclusion = faceAmbientOcclusion(volData, pos, (FaceNames)face);
+					voxelFace.padding[0] = voxelFace.padding[1] = 0u;
+					result->faces[transparent ? 1 : 0].push_back(voxelFace);
+				}
+			}
+		}
+	}
+}
+
+}
@@ -0,0 +1,73 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include "voxel/Face.h"
+#include <glm/vec3.hpp>
+#include <stdint.h>
+
+namespace voxel {
+
+class RawVolume;
+class Region;
+
+/**
+ * @brief A visible face of a voxel - the quad is built on the gpu by vertex pulling
+ *
+ * @note The layout must match the face decoding in the voxelpulling shader
+ * @sa faceCorner()
+ */
+struct VoxelFace {
+	int16_t x;
+	int16_t y;
+	int16_t z;
+	uint8_t colorIndex;
+	/** @sa FaceNames - @c InvalidFace for an unused slot in the face buffer */
+	uint8_t face;
+	/** this should match the @c Voxel::_flags member */
+	uint8_t flags;
+	/** 2 bits for each corner - 0 is the darkest, 3 is no occlusion at all */
+	uint8_t ambientOcclusion;
+	uint8_t padding[2];
+
+	static constexpr uint8_t InvalidFace = 0xFF;
+
+	inline uint8_t cornerAmbientOcclusion(int corner) const {
+		return (ambientOcclusion >> (corner * 2)) & 3u;
+	}
+};
+static_assert(sizeof(VoxelFace) == 12, "Unexpected size of the face struct");
+
+using FaceArray = core::DynamicArray<VoxelFace>;
+
+/**
+ * @brief The opaque and the transparent faces of a chunk
+ */
+struct ChunkFaces {
+	static constexpr int Lists = 2;
+	FaceArray faces[Lists];
+
+	inline bool isEmpty() const {
+		return faces[0].empty() && faces[1].empty();
+	}
+};
+
+/**
+ * @return The offset of the given corner of the face relative to the voxel position. The corners are in
+ * counter clockwise order when looking at the visible side of the face.
+ */
+const glm::ivec3 &faceCorner(FaceNames face, int corner);
+
+/**
+ * @brief Collects the visible faces of the voxels in the given region without building a mesh
+ *
+ * Other than the CubicSurfaceExtractor every face is owned by the solid voxel it belongs to. Thus the
+ * region is not extended by one voxel - but the volume must contain the neighbours of the region for
+ * the visibility and the ambient occlusion.
+ */
+void extractCubicFaces(const voxel::RawVolume *volData, const Region &region, ChunkFaces *result);
+
+}
@@ -9,14 +9,18 @@
 #include "VoxelVertex.h"
 #include "core/Common.h"
 #include "core/Assert.h"
+#include "core/Bits.h"
 #include "core/Enum.h"
 #include "core/StandardLib.h"
+#include "core/collection/SmallVector.h"
 #include "core/NonCopyable.h"
 #include "Region.h"
+#include "core/Memory.h"
 #include "core/Trace.h"
 #include "Face.h"
+#include "PagedVolume.h"
+#include "RawVolume.h"
 #include <glm/vec3.hpp>
-#include <list>
 #include <vector>
 
 namespace voxel {
@@ -85,9 +89,69 @@ public:
 };
 
 /**
- * @brief Should be a list because random inserts which we need in @c performQuadMerging are O(1)
+ * @brief Bit masks of the opaque and transparent voxels of one z-slice of the extraction region.
+ *
+ * Each column (x) stores one bit per y position. This allows us to find the voxels that might need
+ * a quad with a few bitwise operations on 64 voxels at once - instead of sampling all the neighbours
+ * of every single voxel.
  */
-typedef std::list<Quad> QuadList;
+class OccupancySlice : public core::NonCopyable {
+private:
+	int _columns;
+	int _words;
+	uint64_t* _opaque;
+	uint64_t* _transparent;
+public:
+	OccupancySlice(int columns, int words) : _columns(columns), _words(words) {
+		_opaque = (uint64_t*)core_malloc(columns * words * sizeof(uint64_t));
+		_transparent = (uint64_t*)core_malloc(columns * words * sizeof(uint64_t));
+	}
+
+	~OccupancySlice() {
+		core_free(_opaque);
+		core_free(_transparent);
+	}
+
+	inline const uint64_t* opaque(int column) const {
+		return _opaque + column * _words;
+	}
+
+	inline const uint64_t* transparent(int column) const {
+		return _transparent + column * _words;
+	}
+
+	template<class SAMPLER>
+	void fill(SAMPLER& sampler, int32_t x, int32_t y, int32_t z, int height) {
+		core_trace_scoped(OccupancySliceFill);
+		core_memset(_opaque, 0, _columns * _words * sizeof(uint64_t));
+		core_memset(_transparent, 0, _columns * _words * sizeof(uint64_t));
+		for (int c = 0; c < _columns; ++c) {
+			uint64_t* opaque = _opaque + c * _words;
+			uint64_t* transparent = _transparent + c * _words;
+			sampler.setPosition(x + c, y, z);
+			for (int i = 0; i < height; ++i) {
+				const VoxelType material = sampler.voxel().getMaterial();
+				if (isTransparent(material)) {
+					transparent[i >> 6] |= 1ull << (i & 63);
+				} else if (!isAir(material)) {
+					opaque[i >> 6] |= 1ull << (i & 63);
+				}
+				sampler.movePositiveY();
+			}
+		}
+	}
+
+	void swap(OccupancySlice& other) {
+		core::exchange(_opaque, other._opaque);
+		core::exchange(_transparent, other._transparent);
+	}
+};
+
+/**
+ * @brief Most of the slices only produce a few quads - they don't need any heap allocation. The erase in
+ * @c performQuadMerging keeps the order of the quads to get the same merge results.
+ */
+typedef core::SmallVector<Quad, 16> QuadList;
 typedef std::vector<QuadList> QuadListVector;
 
 /**
@@ -305,8 +369,8 @@ static IndexType addVertex(bool reuseVertices, uint32_t x, uint32_t y, uint32_t
 	return 0; //Should never happen.
 }
 
-void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion) {
-	core_trace_scoped(ExtractCubicMesh);
+template<class VOLUME>
+static void extractCubicMeshImpl(const VOLUME* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion) {
 
 	result->clear();
 	const glm::ivec3& offset = region.getLowerCorner();
@@ -345,16 +409,63 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 	vecQuadsT[core::enumVal(FaceNames::NegativeZ)].resize(zSize);
 	vecQuadsT[core::enumVal(FaceNames::PositiveZ)].resize(zSize);
 
-	voxel::RawVolume::Sampler volumeSampler(volData);
+	VolumeSampler<VOLUME> volumeSampler(volData);
+
+	// the occupancy masks also contain the column left of and the voxel below the region
+	const int maskColumns = upper.x - offset.x + 2;
+	const int maskHeight = upper.y - offset.y + 2;
+	const int maskWords = (maskHeight + 63) / 64;
+	const uint64_t lastWordMask = (maskHeight & 63) == 0 ? ~0ull : ((1ull << (maskHeight & 63)) - 1ull);
+	OccupancySlice previousOccupancy(maskColumns, maskWords);
+	OccupancySlice currentOccupancy(maskColumns, maskWords);
+	uint64_t *needsQuad = (uint64_t *)core_malloc(maskWords * sizeof(uint64_t));
+	previousOccupancy.fill(volumeSampler, offset.x - 1, offset.y - 1, offset.z - 1, maskHeight);
 
 	{
 	core_trace_scoped(QuadGeneration);
 	for (int32_t z = offset.z; z <= upper.z; ++z) {
 		const uint32_t regZ = z - offset.z;
+		currentOccupancy.fill(volumeSampler, offset.x - 1, offset.y - 1, z, maskHeight);
 		for (int32_t x = offset.x; x <= upper.x; ++x) {
 			const uint32_t regX = x - offset.x;
-			volumeSampler.setPosition(x, offset.y, z);
+			const int column = (int)regX + 1;
+			// a quad can only be needed between voxels of different types - so we only have to visit
+			// those voxels whose left, below or before neighbour is of a different type
+			const uint64_t *opaque = currentOccupancy.opaque(column);
+			const uint64_t *transparent = currentOccupancy.transparent(column);
+			const uint64_t *opaqueLeft = currentOccupancy.opaque(column - 1);
+			const uint64_t *transparentLeft = currentOccupancy.transparent(column - 1);
+			const uint64_t *opaqueBefore = previousOccupancy.opaque(column);
+			const uint64_t *transparentBefore = previousOccupancy.transparent(column);
+			uint64_t carryOpaque = 0u;
+			uint64_t carryTransparent = 0u;
+			for (int w = 0; w < maskWords; ++w) {
+				const uint64_t opaqueBelow = (opaque[w] << 1) | carryOpaque;
+				const uint64_t transparentBelow = (transparent[w] << 1) | carryTransparent;
+				carryOpaque = opaque[w] >> 63;
+				carryTransparent = transparent[w] >> 63;
+				needsQuad[w] = (opaque[w] ^ opaqueLeft[w]) | (transparent[w] ^ transparentLeft[w]) |
+							   (opaque[w] ^ opaqueBefore[w]) | (transparent[w] ^ transparentBefore[w]) |
+							   (opaque[w] ^ opaqueBelow) | (transparent[w] ^ transparentBelow);
+			}
+			// the voxel below the region is not part of the extraction
+			needsQuad[0] &= ~1ull;
+			needsQuad[maskWords - 1] &= lastWordMask;
+
 			for (int32_t y = offset.y; y <= upper.y; ++y) {
+				const int bit = y - offset.y + 1;
+				const uint64_t pending = needsQuad[bit >> 6] >> (bit & 63);
+				if (pending == 0u) {
+					// nothing to do for the rest of this word
+					y += 63 - (bit & 63);
+					continue;
+				}
+				if ((pending & 1u) == 0u) {
+					// jump to the next voxel that needs a quad
+					y += core::countTrailingZeros(pending) - 1;
+					continue;
+				}
+				volumeSampler.setPosition(x, y, z);
 				const uint32_t regY = y - offset.y;
 
 				/**
@@ -619,9 +730,6 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 					vecQuadsT[core::enumVal(FaceNames::PositiveZ)][regZ].emplace_back(v_0_4, v_3_3, v_2_7, v_1_8);
 				}
 
-				if (core_likely(y != upper.y)) {
-					volumeSampler.movePositiveY();
-				}
 			}
 		}
 
@@ -629,8 +737,10 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 		previousSliceVerticesT.swap(currentSliceVerticesT);
 		currentSliceVertices.clear();
 		currentSliceVerticesT.clear();
+		previousOccupancy.swap(currentOccupancy);
 	}
 	}
+	core_free(needsQuad);
 
 	{
 		core_trace_scoped(GenerateMesh);
@@ -646,4 +756,16 @@ void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, Chu
 	result->compressIndices();
 }
 
+void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion) {
+	core_trace_scoped(ExtractCubicMesh);
+	core_memory_scope(Mesh);
+	extractCubicMeshImpl(volData, region, result, translate, mergeQuads, reuseVertices, ambientOcclusion);
+}
+
+void extractCubicMesh(const voxel::PagedVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads, bool reuseVertices, bool ambientOcclusion) {
+	core_trace_scoped(ExtractCubicMeshPaged);
+	core_memory_scope(Mesh);
+	extractCubicMeshImpl(volData, region, result, translate, mergeQuads, reuseVertices, ambientOcclusion);
+}
+
 }
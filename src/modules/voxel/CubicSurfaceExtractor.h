@@ -9,6 +9,7 @@
 namespace voxel {
 
 class RawVolume;
+class PagedVolume;
 class Region;
 struct ChunkMesh;
 class Palette;
@@ -101,6 +102,11 @@ class Palette;
  */
 void extractCubicMesh(const voxel::RawVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true);
 
+/**
+ * @brief Same as above - but for the sparse brick based volume
+ */
+void extractCubicMesh(const voxel::PagedVolume* volData, const Region& region, ChunkMesh* result, const glm::ivec3& translate, bool mergeQuads = true, bool reuseVertices = true, bool ambientOcclusion = true);
+
 }
 
 #undef BUFFERED_SAMPLER
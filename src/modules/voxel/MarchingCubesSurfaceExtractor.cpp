@@ -4,7 +4,11 @@
 
 #include "MarchingCubesSurfaceExtractor.h"
 #include "core/Color.h"
+#include "core/GLM.h"
+#include "core/Memory.h"
 #include "core/collection/Array2DView.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/MarchingCubesTables.h"
 #include "voxel/ChunkMesh.h"
 #include "voxel/Palette.h"
@@ -21,6 +25,8 @@ namespace voxel {
 
 static const float MarchingCubeMaxDensity = 255.0f;
 
+typedef core::Map<glm::vec3, IndexType, 1031, glm::hash<glm::vec3>> SeamMap;
+
 static inline float convertToDensity(const Voxel &voxel) {
 	return isAir(voxel.getMaterial()) ? 0.0f : MarchingCubeMaxDensity;
 }
@@ -40,7 +46,7 @@ static inline Voxel blendMaterials(const Palette &palette, const Voxel &v1, cons
 }
 
 // Gradient estimation
-static glm::vec3 computeCentralDifferenceGradient(const RawVolume::Sampler &volIter) {
+static glm::vec3 computeCentralDifferenceGradient(const RawVolume::DirectSampler &volIter) {
 	const float voxel1nx = convertToDensity(volIter.peekVoxel1nx0py0pz());
 	const float voxel1px = convertToDensity(volIter.peekVoxel1px0py0pz());
 
@@ -53,10 +59,11 @@ static glm::vec3 computeCentralDifferenceGradient(const RawVolume::Sampler &volI
 	return glm::vec3(voxel1nx - voxel1px, voxel1ny - voxel1py, voxel1nz - voxel1pz);
 }
 
-void extractMarchingCubesMesh(const RawVolume *volume, const Palette &palette, const Region &region, ChunkMesh *result) {
-	core_assert_msg(volume != nullptr, "Provided volume cannot be null");
-	core_assert_msg(result != nullptr, "Provided mesh cannot be null");
-
+/**
+ * @brief Generates the vertices and triangles for the given region - the vertex positions are relative to the lower
+ * corner of the region. The mesh is not compressed and might contain unused vertices.
+ */
+static void extractMarchingCubesMeshImpl(const RawVolume *volume, const Palette &palette, const Region &region, ChunkMesh *result) {
 	result->clear();
 
 	// Store some commonly used values for performance and convienience
@@ -82,13 +89,13 @@ void extractMarchingCubesMesh(const RawVolume *volume, const Palette &palette, c
 
 	// A sampler pointing at the beginning of the region, which gets incremented to always point at the beginning of a
 	// slice.
-	RawVolume::Sampler startOfSlice(volume);
+	RawVolume::DirectSampler startOfSlice(volume);
 	startOfSlice.setPosition(region.getLowerCorner());
 
 	for (int32_t z = 0; z < d; z++) {
 		// A sampler pointing at the beginning of the slice, which gets incremented to always point at the beginning of
 		// a row.
-		RawVolume::Sampler startOfRow = startOfSlice;
+		RawVolume::DirectSampler startOfRow = startOfSlice;
 
 		core::Array2DView<glm::ivec3> indicesView(indicesBuf.data(), w, h);
 		core::Array2DView<glm::ivec3> previousIndicesView(previousIndicesBuf.data(), w, h);
@@ -96,7 +103,7 @@ void extractMarchingCubesMesh(const RawVolume *volume, const Palette &palette, c
 		for (int32_t y = 0; y < h; y++) {
 			// Copying a sampler which is already pointing at the correct location seems (slightly) faster than
 			// calling setPosition(). Therefore we make use of 'startOfRow' and 'startOfSlice' to reset the sampler.
-			RawVolume::Sampler sampler = startOfRow;
+			RawVolume::DirectSampler sampler = startOfRow;
 
 			for (int32_t x = 0; x < w; x++) {
 				// Note: In many cases the provided region will be (mostly) empty which means mesh vertices/indices
@@ -334,6 +341,97 @@ void extractMarchingCubesMesh(const RawVolume *volume, const Palette &palette, c
 
 		core::exchange(indicesBuf, previousIndicesBuf);
 	}
+}
+
+void extractMarchingCubesMesh(const RawVolume *volume, const Palette &palette, const Region &region, ChunkMesh *result) {
+	core_memory_scope(Mesh);
+	core_assert_msg(volume != nullptr, "Provided volume cannot be null");
+	core_assert_msg(result != nullptr, "Provided mesh cannot be null");
+
+	extractMarchingCubesMeshImpl(volume, palette, region, result);
+
+	result->setOffset(region.getLowerCorner());
+	result->removeUnusedVertices();
+	result->compressIndices();
+}
+
+void extractMarchingCubesMeshParallel(core::ThreadPool &threadPool, const RawVolume *volume, const Palette &palette,
+									  const Region &region, ChunkMesh *result, int sliceDepth) {
+	core_memory_scope(Mesh);
+	core_assert_msg(volume != nullptr, "Provided volume cannot be null");
+	core_assert_msg(result != nullptr, "Provided mesh cannot be null");
+	core_assert_msg(sliceDepth > 0, "Slice depth must be greater than zero");
+
+	const int32_t lowerZ = region.getLowerZ();
+	const int32_t upperZ = region.getUpperZ();
+	if (upperZ - lowerZ < sliceDepth) {
+		extractMarchingCubesMesh(volume, palette, region, result);
+		return;
+	}
+
+	// the region is split into slabs along the z axis. Each slab but the first one starts with the last voxel slice
+	// of the previous slab. The cells are only generated for z > 0 - so every cell is generated exactly once, but the
+	// vertices of the shared slice exist in both slabs and are merged below.
+	core::DynamicArray<Region> slabs;
+	for (int32_t z = lowerZ; z <= upperZ; z += sliceDepth) {
+		Region slab = region;
+		slab.setLowerZ(z == lowerZ ? z : z - 1);
+		slab.setUpperZ(glm::min(z + sliceDepth - 1, upperZ));
+		slabs.push_back(slab);
+	}
+
+	const size_t n = slabs.size();
+	core::DynamicArray<ChunkMesh> slabMeshes;
+	slabMeshes.resize(n);
+	core::DynamicArray<std::future<void>> futures;
+	futures.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		futures.emplace_back(threadPool.enqueue([volume, &palette, &slabs, &slabMeshes, i]() {
+			extractMarchingCubesMeshImpl(volume, palette, slabs[i], &slabMeshes[i]);
+		}));
+	}
+	for (std::future<void> &f : futures) {
+		f.get();
+	}
+
+	result->clear();
+	Mesh &target = result->mesh[0];
+	// the vertices on the upper slice of the previous and the current slab - used to stitch the seams
+	SeamMap seams[2];
+	core::DynamicArray<IndexType> remap;
+	for (size_t i = 0; i < n; ++i) {
+		const Mesh &slabMesh = slabMeshes[i].mesh[0];
+		const float offsetZ = (float)(slabs[i].getLowerZ() - lowerZ);
+		const float seamZ = offsetZ;
+		const float nextSeamZ = (float)(slabs[i].getUpperZ() - lowerZ);
+		const VertexArray &vertices = slabMesh.getVertexVector();
+		const NormalArray &normals = slabMesh.getNormalVector();
+		remap.resize(vertices.size());
+		const SeamMap &previousSeam = seams[(i + 1) & 1];
+		SeamMap &currentSeam = seams[i & 1];
+		currentSeam.clear();
+		for (size_t v = 0; v < vertices.size(); ++v) {
+			VoxelVertex vertex = vertices[v];
+			vertex.position.z += offsetZ;
+			IndexType idx;
+			if (i > 0 && vertex.position.z == seamZ && previousSeam.get(vertex.position, idx)) {
+				remap[v] = idx;
+				continue;
+			}
+			idx = target.addVertex(vertex);
+			if (v < normals.size()) {
+				target.setNormal(idx, normals[v]);
+			}
+			remap[v] = idx;
+			if (vertex.position.z == nextSeamZ) {
+				currentSeam.put(vertex.position, idx);
+			}
+		}
+		const IndexArray &indices = slabMesh.getIndexVector();
+		for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+			target.addTriangle(remap[indices[t + 0]], remap[indices[t + 1]], remap[indices[t + 2]]);
+		}
+	}
 
 	result->setOffset(region.getLowerCorner());
 	result->removeUnusedVertices();
@@ -4,6 +4,10 @@
 
 #pragma once
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxel {
 
 class RawVolume;
@@ -14,4 +18,13 @@ class Palette;
 // Also known as: "3D Contouring", "Marching Cubes", "Surface Reconstruction"
 void extractMarchingCubesMesh(const RawVolume *volume, const Palette &palette, const Region &region, ChunkMesh *result);
 
+/**
+ * @brief Splits the region into slabs of @c sliceDepth voxels along the z axis and extracts them on the given thread
+ * pool. The vertices on the slab seams are merged - the result is the same surface that
+ * @c extractMarchingCubesMesh() would produce.
+ * @note Don't call this from a task of the same thread pool - it blocks until all slabs are extracted.
+ */
+void extractMarchingCubesMeshParallel(core::ThreadPool &threadPool, const RawVolume *volume, const Palette &palette,
+									  const Region &region, ChunkMesh *result, int sliceDepth = 32);
+
 } // namespace voxel
@@ -8,9 +8,15 @@
 #include "core/Trace.h"
 #include "core/Assert.h"
 #include "core/collection/DynamicArray.h"
+#include "core/Algorithm.h"
 #include "util/BufferUtil.h"
 #include <glm/vector_relational.hpp>
 #include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtx/norm.hpp>
+#include <algorithm>
+#include <float.h>
+#include <vector>
 
 namespace voxel {
 
@@ -230,23 +236,483 @@ void Mesh::compressIndices() {
 	util::indexCompress(&_vecIndices.front(), maxSize, _compressedIndexSize, _compressedIndices, maxSize);
 }
 
+void Mesh::optimize(int primitiveIndices, int cacheSize) {
+	core_trace_scoped(MeshOptimize);
+	const size_t indices = _vecIndices.size();
+	const size_t vertices = _vecVertices.size();
+	if (primitiveIndices <= 0 || indices == 0u || indices % primitiveIndices != 0) {
+		return;
+	}
+	const int primitives = (int)(indices / primitiveIndices);
+
+	// the primitives every vertex is used in
+	core::DynamicArray<int> live(vertices);
+	live.fill(0);
+	for (size_t i = 0u; i < indices; ++i) {
+		++live[_vecIndices[i]];
+	}
+	core::DynamicArray<int> adjacencyOffset(vertices + 1);
+	adjacencyOffset[0] = 0;
+	for (size_t v = 0u; v < vertices; ++v) {
+		adjacencyOffset[v + 1] = adjacencyOffset[v] + live[v];
+	}
+	core::DynamicArray<int> adjacency(indices);
+	core::DynamicArray<int> fill(vertices);
+	fill.fill(0);
+	for (size_t i = 0u; i < indices; ++i) {
+		const IndexType v = _vecIndices[i];
+		adjacency[adjacencyOffset[v] + fill[v]++] = (int)(i / primitiveIndices);
+	}
+
+	core::DynamicArray<int> cacheTime(vertices);
+	cacheTime.fill(0);
+	core::DynamicArray<bool> emitted(primitives);
+	emitted.fill(false);
+	core::DynamicArray<IndexType> deadEnd;
+	deadEnd.reserve(indices);
+	core::DynamicArray<IndexType> candidates;
+	IndexArray output;
+	output.reserve(indices);
+
+	int timeStamp = cacheSize + 1;
+	size_t cursor = 0u;
+	int fanning = (int)_vecIndices[0];
+	while (fanning >= 0) {
+		candidates.clear();
+		for (int a = adjacencyOffset[fanning]; a < adjacencyOffset[fanning + 1]; ++a) {
+			const int p = adjacency[a];
+			if (emitted[p]) {
+				continue;
+			}
+			emitted[p] = true;
+			for (int j = 0; j < primitiveIndices; ++j) {
+				const IndexType v = _vecIndices[(size_t)p * primitiveIndices + j];
+				output.push_back(v);
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				--live[v];
+				if (timeStamp - cacheTime[v] > cacheSize) {
+					cacheTime[v] = timeStamp++;
+				}
+			}
+		}
+
+		// pick the candidate that is still in the cache after all of its primitives were emitted
+		fanning = -1;
+		int best = -1;
+		for (IndexType v : candidates) {
+			if (live[v] <= 0) {
+				continue;
+			}
+			int priority = 0;
+			if (timeStamp - cacheTime[v] + 2 * live[v] <= cacheSize) {
+				priority = timeStamp - cacheTime[v];
+			}
+			if (priority > best) {
+				best = priority;
+				fanning = (int)v;
+			}
+		}
+		if (fanning != -1) {
+			continue;
+		}
+		// dead end - take a recently used vertex or the next vertex with primitives left
+		while (!deadEnd.empty()) {
+			const IndexType v = deadEnd.back();
+			deadEnd.pop();
+			if (live[v] > 0) {
+				fanning = (int)v;
+				break;
+			}
+		}
+		while (fanning == -1 && cursor < vertices) {
+			if (live[cursor] > 0) {
+				fanning = (int)cursor;
+			}
+			++cursor;
+		}
+	}
+	core_assert(output.size() == indices);
+
+	// renumber the vertices in the order of their first use
+	IndexArray newPos(vertices);
+	newPos.fill((IndexType)-1);
+	VertexArray newVertices;
+	newVertices.reserve(vertices);
+	NormalArray newNormals;
+	if (!_normals.empty()) {
+		newNormals.reserve(vertices);
+	}
+	for (size_t i = 0u; i < indices; ++i) {
+		const IndexType v = output[i];
+		if (newPos[v] == (IndexType)-1) {
+			newPos[v] = (IndexType)newVertices.size();
+			newVertices.push_back(_vecVertices[v]);
+			if (!_normals.empty()) {
+				newNormals.push_back(_normals[v]);
+			}
+		}
+		output[i] = newPos[v];
+	}
+	_vecIndices = core::move(output);
+	_vecVertices = core::move(newVertices);
+	if (!_normals.empty()) {
+		_normals = core::move(newNormals);
+	}
+}
+
+namespace {
+
+/**
+ * @brief The symmetric 4x4 matrix of the summed squared distances to a set of planes
+ */
+struct Quadric {
+	// xx, xy, xz, xw, yy, yz, yw, zz, zw, ww
+	double m[10]{};
+
+	void addPlane(const glm::vec3 &n, float d, double weight) {
+		const double a = n.x, b = n.y, c = n.z, w = d;
+		m[0] += weight * a * a;
+		m[1] += weight * a * b;
+		m[2] += weight * a * c;
+		m[3] += weight * a * w;
+		m[4] += weight * b * b;
+		m[5] += weight * b * c;
+		m[6] += weight * b * w;
+		m[7] += weight * c * c;
+		m[8] += weight * c * w;
+		m[9] += weight * w * w;
+	}
+
+	Quadric &operator+=(const Quadric &other) {
+		for (int i = 0; i < 10; ++i) {
+			m[i] += other.m[i];
+		}
+		return *this;
+	}
+
+	double error(const glm::vec3 &p) const {
+		const double x = p.x, y = p.y, z = p.z;
+		const double e = m[0] * x * x + 2.0 * m[1] * x * y + 2.0 * m[2] * x * z + 2.0 * m[3] * x + m[4] * y * y +
+						 2.0 * m[5] * y * z + 2.0 * m[6] * y + m[7] * z * z + 2.0 * m[8] * z + m[9];
+		return e > 0.0 ? e : 0.0;
+	}
+};
+
+struct Collapse {
+	double error;
+	IndexType from;
+	IndexType to;
+	uint32_t fromStamp;
+	uint32_t toStamp;
+
+	// the smallest error on top of the heap
+	bool operator<(const Collapse &other) const {
+		return error > other.error;
+	}
+};
+
+struct Edge {
+	uint64_t key;
+	uint32_t triangle;
+
+	bool operator<(const Edge &other) const {
+		return key < other.key;
+	}
+};
+
+// the open edges keep their position by planes that are perpendicular to their triangle
+static constexpr double BoundaryWeight = 100.0;
+
+} // namespace
+
+void Mesh::simplify(size_t targetTriangles, float maxError) {
+	const size_t vertices = _vecVertices.size();
+	const size_t triangles = _vecIndices.size() / 3u;
+	if (triangles <= targetTriangles) {
+		return;
+	}
+	core_trace_scoped(MeshSimplify);
+	const double maxErrorSquared = maxError < 0.0f ? DBL_MAX : (double)maxError * (double)maxError;
+
+	core::DynamicArray<Quadric> quadrics(vertices);
+	core::DynamicArray<core::DynamicArray<uint32_t>> vertexTriangles(vertices);
+	core::DynamicArray<Edge> edges;
+	edges.reserve(triangles * 3u);
+	for (size_t t = 0u; t < triangles; ++t) {
+		const IndexType *tri = &_vecIndices[t * 3u];
+		const glm::vec3 &p0 = _vecVertices[tri[0]].position;
+		const glm::vec3 normal = glm::cross(_vecVertices[tri[1]].position - p0, _vecVertices[tri[2]].position - p0);
+		const float length = glm::length(normal);
+		for (int i = 0; i < 3; ++i) {
+			vertexTriangles[tri[i]].push_back((uint32_t)t);
+			const IndexType a = core_min(tri[i], tri[(i + 1) % 3]);
+			const IndexType b = core_max(tri[i], tri[(i + 1) % 3]);
+			edges.push_back({((uint64_t)a << 32) | (uint64_t)b, (uint32_t)t});
+		}
+		if (length <= FLT_EPSILON) {
+			continue;
+		}
+		const glm::vec3 n = normal / length;
+		const float d = -glm::dot(n, p0);
+		for (int i = 0; i < 3; ++i) {
+			quadrics[tri[i]].addPlane(n, d, 1.0);
+		}
+	}
+
+	// an edge that is only used by one triangle is open
+	core::sort(edges.begin(), edges.end(), core::Less<Edge>());
+	for (size_t i = 0u; i < edges.size();) {
+		size_t j = i + 1u;
+		while (j < edges.size() && edges[j].key == edges[i].key) {
+			++j;
+		}
+		if (j - i == 1u) {
+			const IndexType *tri = &_vecIndices[edges[i].triangle * 3u];
+			const IndexType a = (IndexType)(edges[i].key >> 32);
+			const IndexType b = (IndexType)(edges[i].key & 0xFFFFFFFFu);
+			const glm::vec3 &pa = _vecVertices[a].position;
+			const glm::vec3 edge = _vecVertices[b].position - pa;
+			const glm::vec3 &p0 = _vecVertices[tri[0]].position;
+			const glm::vec3 normal =
+				glm::cross(_vecVertices[tri[1]].position - p0, _vecVertices[tri[2]].position - p0);
+			const glm::vec3 perpendicular = glm::cross(edge, normal);
+			const float length = glm::length(perpendicular);
+			if (length > FLT_EPSILON) {
+				const glm::vec3 n = perpendicular / length;
+				const float d = -glm::dot(n, pa);
+				const double weight = BoundaryWeight * (double)glm::length2(edge);
+				quadrics[a].addPlane(n, d, weight);
+				quadrics[b].addPlane(n, d, weight);
+			}
+		}
+		i = j;
+	}
+
+	core::DynamicArray<uint32_t> stamps(vertices);
+	stamps.fill(0u);
+	core::DynamicArray<bool> removed(vertices);
+	removed.fill(false);
+	core::DynamicArray<bool> deadTriangles(triangles);
+	deadTriangles.fill(false);
+	std::vector<Collapse> heap;
+	heap.reserve(triangles * 3u);
+
+	auto push = [&](IndexType from, IndexType to) {
+		const VoxelVertex &vFrom = _vecVertices[from];
+		const VoxelVertex &vTo = _vecVertices[to];
+		if (vFrom.colorIndex != vTo.colorIndex || vFrom.flags != vTo.flags) {
+			return;
+		}
+		Quadric q = quadrics[from];
+		q += quadrics[to];
+		heap.push_back({q.error(vTo.position), from, to, stamps[from], stamps[to]});
+		std::push_heap(heap.begin(), heap.end());
+	};
+	for (size_t i = 0u; i < _vecIndices.size(); i += 3u) {
+		for (int j = 0; j < 3; ++j) {
+			const IndexType a = _vecIndices[i + j];
+			const IndexType b = _vecIndices[i + (j + 1) % 3];
+			push(a, b);
+			push(b, a);
+		}
+	}
+
+	core::DynamicArray<IndexType> neighbours;
+	auto collectNeighbours = [&](IndexType v, core::DynamicArray<IndexType> &out) {
+		out.clear();
+		for (uint32_t t : vertexTriangles[v]) {
+			if (deadTriangles[t]) {
+				continue;
+			}
+			for (int i = 0; i < 3; ++i) {
+				const IndexType n = _vecIndices[t * 3u + i];
+				if (n != v && core::find(out.begin(), out.end(), n) == out.end()) {
+					out.push_back(n);
+				}
+			}
+		}
+	};
+	core::DynamicArray<IndexType> fromNeighbours;
+	core::DynamicArray<IndexType> toNeighbours;
+
+	// checks whether the collapse keeps the mesh manifold and doesn't flip a triangle
+	auto valid = [&](IndexType from, IndexType to) {
+		const glm::vec3 &target = _vecVertices[to].position;
+		int sharedTriangles = 0;
+		for (uint32_t t : vertexTriangles[from]) {
+			if (deadTriangles[t]) {
+				continue;
+			}
+			const IndexType *tri = &_vecIndices[t * 3u];
+			if (tri[0] == to || tri[1] == to || tri[2] == to) {
+				++sharedTriangles;
+				continue;
+			}
+			glm::vec3 before[3];
+			glm::vec3 after[3];
+			for (int i = 0; i < 3; ++i) {
+				before[i] = _vecVertices[tri[i]].position;
+				after[i] = tri[i] == from ? target : before[i];
+			}
+			const glm::vec3 oldNormal = glm::cross(before[1] - before[0], before[2] - before[0]);
+			const glm::vec3 newNormal = glm::cross(after[1] - after[0], after[2] - after[0]);
+			if (glm::length2(newNormal) <= FLT_EPSILON || glm::dot(oldNormal, newNormal) <= 0.0f) {
+				return false;
+			}
+			// e.g. a tetrahedron would collapse into two triangles with the same vertices
+			IndexType others[2];
+			int otherCnt = 0;
+			for (int i = 0; i < 3; ++i) {
+				if (tri[i] != from) {
+					others[otherCnt++] = tri[i];
+				}
+			}
+			for (uint32_t toTriangle : vertexTriangles[to]) {
+				if (deadTriangles[toTriangle]) {
+					continue;
+				}
+				const IndexType *toTri = &_vecIndices[toTriangle * 3u];
+				int matches = 0;
+				for (int i = 0; i < 3; ++i) {
+					matches += (toTri[i] == others[0] || toTri[i] == others[1]) ? 1 : 0;
+				}
+				if (otherCnt == 2 && matches == 2) {
+					return false;
+				}
+			}
+		}
+		// the link condition - the only common neighbours are the opposite vertices of the shared triangles
+		collectNeighbours(from, fromNeighbours);
+		collectNeighbours(to, toNeighbours);
+		int sharedNeighbours = 0;
+		for (IndexType n : fromNeighbours) {
+			if (core::find(toNeighbours.begin(), toNeighbours.end(), n) != toNeighbours.end()) {
+				++sharedNeighbours;
+			}
+		}
+		return sharedTriangles > 0 && sharedNeighbours == sharedTriangles;
+	};
+
+	size_t liveTriangles = triangles;
+	while (liveTriangles > targetTriangles && !heap.empty()) {
+		std::pop_heap(heap.begin(), heap.end());
+		const Collapse collapse = heap.back();
+		heap.pop_back();
+		const IndexType from = collapse.from;
+		const IndexType to = collapse.to;
+		if (removed[from] || removed[to] || stamps[from] != collapse.fromStamp || stamps[to] != collapse.toStamp) {
+			continue;
+		}
+		if (collapse.error > maxErrorSquared) {
+			break;
+		}
+		if (!valid(from, to)) {
+			continue;
+		}
+		for (uint32_t t : vertexTriangles[from]) {
+			if (deadTriangles[t]) {
+				continue;
+			}
+			IndexType *tri = &_vecIndices[t * 3u];
+			if (tri[0] == to || tri[1] == to || tri[2] == to) {
+				deadTriangles[t] = true;
+				--liveTriangles;
+				continue;
+			}
+			for (int i = 0; i < 3; ++i) {
+				if (tri[i] == from) {
+					tri[i] = to;
+				}
+			}
+			vertexTriangles[to].push_back(t);
+		}
+		vertexTriangles[from].clear();
+		removed[from] = true;
+		quadrics[to] += quadrics[from];
+		++stamps[to];
+
+		collectNeighbours(to, neighbours);
+		for (IndexType n : neighbours) {
+			push(to, n);
+			push(n, to);
+		}
+	}
+
+	size_t n = 0u;
+	for (size_t t = 0u; t < triangles; ++t) {
+		if (deadTriangles[t]) {
+			continue;
+		}
+		if (n != t) {
+			core_memcpy(&_vecIndices[n * 3u], &_vecIndices[t * 3u], 3u * sizeof(IndexType));
+		}
+		++n;
+	}
+	_vecIndices.resize(n * 3u);
+	removeUnusedVertices();
+	if (_compressedIndices != nullptr) {
+		compressIndices();
+	}
+}
+
 bool Mesh::operator<(const Mesh& rhs) const {
 	return glm::all(glm::lessThan(getOffset(), rhs.getOffset()));
 }
 
 bool Mesh::sort(const glm::vec3 &objectSpaceEye) {
-#if 0
-	for (int idx = 0; idx < (int)_vecIndices.size(); idx += 3) {
-		const voxel::IndexType i0 = _vecIndices[idx + 0];
-		const voxel::IndexType i1 = _vecIndices[idx + 1];
-		const voxel::IndexType i2 = _vecIndices[idx + 2];
-		const voxel::VoxelVertex &v0 = _vecVertices[i0];
-		const voxel::VoxelVertex &v1 = _vecVertices[i1];
-		const voxel::VoxelVertex &v2 = _vecVertices[i2];
-		const glm::vec3 center = (v0.position + v1.position + v2.position) / 3.0f;
-	}
-#endif
-	return false;
+	const size_t triangles = _vecIndices.size() / 3u;
+	if (triangles < 2u) {
+		return false;
+	}
+	core_trace_scoped(MeshSort);
+	core::DynamicArray<float> distances(triangles);
+	for (size_t t = 0u; t < triangles; ++t) {
+		const IndexType *tri = &_vecIndices[t * 3u];
+		const glm::vec3 center =
+			(_vecVertices[tri[0]].position + _vecVertices[tri[1]].position + _vecVertices[tri[2]].position) / 3.0f;
+		distances[t] = glm::distance2(center, objectSpaceEye);
+	}
+
+	// the far triangles first
+	size_t moves = 0u;
+	bool sorted = true;
+	for (size_t t = 1u; t < triangles && sorted; ++t) {
+		const float distance = distances[t];
+		if (distances[t - 1u] >= distance) {
+			continue;
+		}
+		const IndexType tri[3]{_vecIndices[t * 3u + 0u], _vecIndices[t * 3u + 1u], _vecIndices[t * 3u + 2u]};
+		size_t j = t;
+		for (; j > 0u && distances[j - 1u] < distance; --j) {
+			if (++moves > triangles) {
+				// the eye moved too far - the previous order doesn't help anymore
+				sorted = false;
+				break;
+			}
+			distances[j] = distances[j - 1u];
+			core_memcpy(&_vecIndices[j * 3u], &_vecIndices[(j - 1u) * 3u], sizeof(tri));
+		}
+		distances[j] = distance;
+		core_memcpy(&_vecIndices[j * 3u], tri, sizeof(tri));
+	}
+	if (sorted) {
+		return moves > 0u;
+	}
+
+	core::DynamicArray<uint32_t> order(triangles);
+	for (size_t t = 0u; t < triangles; ++t) {
+		order[t] = (uint32_t)t;
+	}
+	core::sort(order.begin(), order.end(), [&distances](uint32_t lhs, uint32_t rhs) {
+		return distances[lhs] > distances[rhs];
+	});
+	IndexArray indices(_vecIndices.size());
+	for (size_t t = 0u; t < triangles; ++t) {
+		core_memcpy(&indices[t * 3u], &_vecIndices[order[t] * 3u], 3u * sizeof(IndexType));
+	}
+	_vecIndices = core::move(indices);
+	return true;
 }
 
 }
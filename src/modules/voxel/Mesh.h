@@ -42,8 +42,16 @@ public:
 	VertexArray& getVertexVector();
 	NormalArray& getNormalVector();
 
-	// e.g. for transparency
-	// returns true if sorting was needed
+	/**
+	 * @brief Sorts the triangles back to front for the transparency
+	 *
+	 * The current order is the start of an insertion sort - the order of the last call is usually almost right for
+	 * a slightly moved eye. If the insertion sort has to move more triangles than the mesh has, the triangles are
+	 * sorted from scratch.
+	 *
+	 * @param objectSpaceEye The eye position in the space of the vertices
+	 * @return @c true if the order of the triangles was changed
+	 */
 	bool sort(const glm::vec3 &objectSpaceEye);
 
 	const glm::ivec3& getOffset() const;
@@ -57,6 +65,27 @@ public:
 	bool isEmpty() const;
 	void removeUnusedVertices();
 	void compressIndices();
+	/**
+	 * @brief Reorders the primitives for the post transform vertex cache (Tipsify - Sander, Nehab and Barczak) and
+	 * afterwards the vertices in the order of their first use to improve the vertex fetch locality. Unused vertices
+	 * are removed.
+	 *
+	 * @param primitiveIndices The amount of indices that are kept together - @c 3 for triangles or @c 6 to keep the
+	 * two triangles of a quad in order
+	 * @param cacheSize The amount of vertices in the simulated vertex cache
+	 */
+	void optimize(int primitiveIndices = 3, int cacheSize = 16);
+	/**
+	 * @brief Reduces the triangles by edge collapses that are ordered by their quadric error (Garland and Heckbert).
+	 * A vertex is only collapsed into a neighbour with the same palette color and flags - so the colors of the
+	 * surface are kept. The open edges (e.g. between two colors) can only slide along themselves.
+	 *
+	 * @param targetTriangles Stop if the mesh doesn't have more triangles than this
+	 * @param maxError Stop if the next collapse moves the surface more than this distance - a negative value
+	 * doesn't limit the error
+	 * @note The primitive order is not kept - this should be called before optimize()
+	 */
+	void simplify(size_t targetTriangles, float maxError = -1.0f);
 
 	const uint8_t* compressedIndices() const;
 	size_t compressedIndexSize() const;
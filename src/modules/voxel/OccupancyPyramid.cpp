@@ -0,0 +1,225 @@
+/**
+ * @file
+ */
+
+#include "OccupancyPyramid.h"
+#include "RawVolume.h"
+#include "core/Assert.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+
+namespace voxel {
+
+OccupancyPyramid::OccupancyPyramid(const Region &region) : _region(region) {
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	for (int level = 0; level < Levels; ++level) {
+		const int size = brickSize(level);
+		_dimensions[level] = (dim + size - 1) / size;
+		_counts[level].resize((size_t)_dimensions[level].x * _dimensions[level].y * _dimensions[level].z);
+	}
+	clear();
+}
+
+void OccupancyPyramid::clear() {
+	for (int level = 0; level < Levels; ++level) {
+		core_memset(_counts[level].data(), 0, _counts[level].size() * sizeof(uint32_t));
+	}
+	_voxels = 0u;
+}
+
+void OccupancyPyramid::build(const RawVolume &volume) {
+	core_trace_scoped(OccupancyPyramidBuild);
+	core_assert(volume.region().getDimensionsInVoxels() == _region.getDimensionsInVoxels());
+	clear();
+	const Voxel *data = (const Voxel *)volume.data();
+	const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+	const glm::ivec3 &level0 = _dimensions[0];
+	uint32_t *counts = _counts[0].data();
+	// count the level 0 bricks in one pass over the data and propagate the sums to the coarser levels
+	for (int z = 0; z < dim.z; ++z) {
+		const int bz = z >> brickShift(0);
+		for (int y = 0; y < dim.y; ++y) {
+			const int by = y >> brickShift(0);
+			const Voxel *row = data + (size_t)y * dim.x + (size_t)z * dim.x * dim.y;
+			uint32_t *brickRow = counts + by * level0.x + bz * level0.x * level0.y;
+			for (int x = 0; x < dim.x; ++x) {
+				if (!isAir(row[x].getMaterial())) {
+					++brickRow[x >> brickShift(0)];
+					++_voxels;
+				}
+			}
+		}
+	}
+	for (int level = 1; level < Levels; ++level) {
+		const glm::ivec3 &finer = _dimensions[level - 1];
+		const int shift = brickShift(level) - brickShift(level - 1);
+		for (int z = 0; z < finer.z; ++z) {
+			for (int y = 0; y < finer.y; ++y) {
+				for (int x = 0; x < finer.x; ++x) {
+					const uint32_t n = _counts[level - 1][index(level - 1, glm::ivec3(x, y, z))];
+					if (n != 0u) {
+						_counts[level][index(level, glm::ivec3(x >> shift, y >> shift, z >> shift))] += n;
+					}
+				}
+			}
+		}
+	}
+}
+
+void OccupancyPyramid::update(const glm::ivec3 &pos, bool occupied) {
+	const glm::ivec3 local = pos - _region.getLowerCorner();
+	for (int level = 0; level < Levels; ++level) {
+		uint32_t &n = _counts[level][index(level, local >> brickShift(level))];
+		if (occupied) {
+			++n;
+		} else {
+			core_assert(n > 0u);
+			--n;
+		}
+	}
+	if (occupied) {
+		++_voxels;
+	} else {
+		core_assert(_voxels > 0u);
+		--_voxels;
+	}
+}
+
+void OccupancyPyramid::translate(const glm::ivec3 &t) {
+	_region.shift(t.x, t.y, t.z);
+}
+
+bool OccupancyPyramid::occupied(int level, const glm::ivec3 &pos) const {
+	if (!_region.containsPoint(pos)) {
+		return false;
+	}
+	const glm::ivec3 local = pos - _region.getLowerCorner();
+	return _counts[level][index(level, local >> brickShift(level))] != 0u;
+}
+
+Region OccupancyPyramid::brickRegion(int level, const glm::ivec3 &brick) const {
+	const glm::ivec3 mins = _region.getLowerCorner() + (brick << brickShift(level));
+	const glm::ivec3 maxs = glm::min(mins + brickSize(level) - 1, _region.getUpperCorner());
+	return Region(mins, maxs);
+}
+
+bool OccupancyPyramid::emptyBrick(const RawVolume &volume, int level, const glm::ivec3 &brick,
+								  const Region &region) const {
+	if (_counts[level][index(level, brick)] == 0u) {
+		return true;
+	}
+	Region clipped = brickRegion(level, brick);
+	if (region.containsRegion(clipped)) {
+		return false;
+	}
+	clipped.cropTo(region);
+	if (level > 0) {
+		const glm::ivec3 lower = (clipped.getLowerCorner() - _region.getLowerCorner()) >> brickShift(level - 1);
+		const glm::ivec3 upper = (clipped.getUpperCorner() - _region.getLowerCorner()) >> brickShift(level - 1);
+		for (int z = lower.z; z <= upper.z; ++z) {
+			for (int y = lower.y; y <= upper.y; ++y) {
+				for (int x = lower.x; x <= upper.x; ++x) {
+					if (!emptyBrick(volume, level - 1, glm::ivec3(x, y, z), region)) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+	const Voxel *data = (const Voxel *)volume.data();
+	const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+	const glm::ivec3 lower = clipped.getLowerCorner() - _region.getLowerCorner();
+	const glm::ivec3 upper = clipped.getUpperCorner() - _region.getLowerCorner();
+	for (int z = lower.z; z <= upper.z; ++z) {
+		for (int y = lower.y; y <= upper.y; ++y) {
+			const Voxel *row = data + (size_t)y * dim.x + (size_t)z * dim.x * dim.y;
+			for (int x = lower.x; x <= upper.x; ++x) {
+				if (!isAir(row[x].getMaterial())) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+bool OccupancyPyramid::empty(const RawVolume &volume, const Region &region) const {
+	core_trace_scoped(OccupancyPyramidEmpty);
+	if (_voxels == 0u) {
+		return true;
+	}
+	if (!intersects(_region, region)) {
+		return true;
+	}
+	Region clipped = region;
+	clipped.cropTo(_region);
+	const int level = Levels - 1;
+	const glm::ivec3 lower = (clipped.getLowerCorner() - _region.getLowerCorner()) >> brickShift(level);
+	const glm::ivec3 upper = (clipped.getUpperCorner() - _region.getLowerCorner()) >> brickShift(level);
+	for (int z = lower.z; z <= upper.z; ++z) {
+		for (int y = lower.y; y <= upper.y; ++y) {
+			for (int x = lower.x; x <= upper.x; ++x) {
+				if (!emptyBrick(volume, level, glm::ivec3(x, y, z), clipped)) {
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+Region OccupancyPyramid::solidRegion(const RawVolume &volume) const {
+	core_trace_scoped(OccupancyPyramidSolidRegion);
+	if (_voxels == 0u) {
+		return Region::InvalidRegion;
+	}
+	const glm::ivec3 &level0 = _dimensions[0];
+	glm::ivec3 brickMins(level0);
+	glm::ivec3 brickMaxs(-1);
+	for (int z = 0; z < level0.z; ++z) {
+		for (int y = 0; y < level0.y; ++y) {
+			for (int x = 0; x < level0.x; ++x) {
+				if (_counts[0][index(0, glm::ivec3(x, y, z))] != 0u) {
+					brickMins = glm::min(brickMins, glm::ivec3(x, y, z));
+					brickMaxs = glm::max(brickMaxs, glm::ivec3(x, y, z));
+				}
+			}
+		}
+	}
+
+	// the extreme voxels can only be found in the outer layer of the occupied bricks
+	const Voxel *data = (const Voxel *)volume.data();
+	const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+	glm::ivec3 mins(dim);
+	glm::ivec3 maxs(-1);
+	for (int z = brickMins.z; z <= brickMaxs.z; ++z) {
+		for (int y = brickMins.y; y <= brickMaxs.y; ++y) {
+			for (int x = brickMins.x; x <= brickMaxs.x; ++x) {
+				const glm::ivec3 brick(x, y, z);
+				if (glm::all(glm::greaterThan(brick, brickMins)) && glm::all(glm::lessThan(brick, brickMaxs))) {
+					continue;
+				}
+				if (_counts[0][index(0, brick)] == 0u) {
+					continue;
+				}
+				const glm::ivec3 lower = brick << brickShift(0);
+				const glm::ivec3 upper = glm::min(lower + brickSize(0), dim);
+				for (int vz = lower.z; vz < upper.z; ++vz) {
+					for (int vy = lower.y; vy < upper.y; ++vy) {
+						const Voxel *row = data + (size_t)vy * dim.x + (size_t)vz * dim.x * dim.y;
+						for (int vx = lower.x; vx < upper.x; ++vx) {
+							if (!isAir(row[vx].getMaterial())) {
+								mins = glm::min(mins, glm::ivec3(vx, vy, vz));
+								maxs = glm::max(maxs, glm::ivec3(vx, vy, vz));
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	return Region(_region.getLowerCorner() + mins, _region.getLowerCorner() + maxs);
+}
+
+} // namespace voxel
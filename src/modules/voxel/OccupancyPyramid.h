@@ -0,0 +1,107 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Region.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief Counts the non-air voxels in cubic bricks of 4, 16 and 64 voxels edge length
+ *
+ * This allows raycasts to skip empty space. The counts are updated for every voxel that changes its air state,
+ * so a brick is known to be empty again once the last voxel in it was removed.
+ *
+ * @sa RawVolume::enableOccupancy()
+ */
+class OccupancyPyramid {
+public:
+	static constexpr int Levels = 3;
+
+private:
+	Region _region;
+	glm::ivec3 _dimensions[Levels];
+	core::DynamicArray<uint32_t> _counts[Levels];
+	uint32_t _voxels = 0u;
+
+	inline int index(int level, const glm::ivec3 &brick) const {
+		const glm::ivec3 &dim = _dimensions[level];
+		return brick.x + brick.y * dim.x + brick.z * dim.x * dim.y;
+	}
+
+	/**
+	 * @return The voxel region of the given brick - clipped to the region of the pyramid
+	 */
+	Region brickRegion(int level, const glm::ivec3 &brick) const;
+	bool emptyBrick(const RawVolume &volume, int level, const glm::ivec3 &brick, const Region &region) const;
+
+public:
+	OccupancyPyramid(const Region &region);
+
+	/**
+	 * @return The edge length of a brick in the given level as power of two
+	 */
+	static constexpr int brickShift(int level) {
+		return 2 + level * 2;
+	}
+
+	static constexpr int brickSize(int level) {
+		return 1 << brickShift(level);
+	}
+
+	/**
+	 * @brief Counts the non-air voxels of the given volume
+	 */
+	void build(const RawVolume &volume);
+	void clear();
+
+	/**
+	 * @brief Updates the counts for a voxel whose air state changed
+	 * @param occupied @c true if the voxel at the given position is no longer air
+	 */
+	void update(const glm::ivec3 &pos, bool occupied);
+
+	/**
+	 * @brief Shift the region by the given coordinates - see RawVolume::translate()
+	 */
+	void translate(const glm::ivec3 &t);
+
+	/**
+	 * @return @c true if the brick of the given level that contains the given voxel position holds at least one
+	 * non-air voxel. Positions outside of the region are always empty.
+	 */
+	bool occupied(int level, const glm::ivec3 &pos) const;
+
+	/**
+	 * @return The amount of non-air voxels in the volume
+	 */
+	inline uint32_t voxels() const {
+		return _voxels;
+	}
+
+	/**
+	 * @return @c true if the given region of the volume doesn't contain any non-air voxel. Only the voxels of the
+	 * occupied bricks that are partially covered by the region are checked.
+	 */
+	bool empty(const RawVolume &volume, const Region &region) const;
+
+	/**
+	 * @brief The tight bounding box of the non-air voxels. Only the voxels of the occupied bricks at the border of
+	 * the occupied bricks are checked. Unlike RawVolume::mins() and RawVolume::maxs() this also shrinks when voxels
+	 * are removed.
+	 * @return Region::InvalidRegion if there are no non-air voxels
+	 */
+	Region solidRegion(const RawVolume &volume) const;
+
+	const Region &region() const {
+		return _region;
+	}
+};
+
+} // namespace voxel
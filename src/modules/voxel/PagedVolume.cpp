@@ -0,0 +1,365 @@
+/**
+ * @file
+ */
+
+#include "PagedVolume.h"
+#include "RawVolume.h"
+#include "core/Assert.h"
+#include "core/StandardLib.h"
+#include <new>
+#include <glm/common.hpp>
+#include <limits>
+
+namespace voxel {
+
+/**
+ * All bricks that are not yet allocated are pointing to this brick
+ */
+static const Voxel PagedVolumeAirBrick[PagedVolume::BrickVoxels] {};
+
+static const uint8_t PAGED_SAMPLER_INVALIDX = 1 << 0;
+static const uint8_t PAGED_SAMPLER_INVALIDY = 1 << 1;
+static const uint8_t PAGED_SAMPLER_INVALIDZ = 1 << 2;
+
+PagedVolume::PagedVolume(const Region& region) : _region(region) {
+	init();
+}
+
+PagedVolume::PagedVolume(const Region& region, const PagedVolumeStoragePtr& storage) : _region(region), _storage(storage) {
+	init();
+}
+
+PagedVolume::PagedVolume(const RawVolume& copy) : _region(copy.region()) {
+	init();
+	_borderVoxel = copy.borderValue();
+	RawVolume::DirectSampler sampler(copy);
+	const glm::ivec3& lower = _region.getLowerCorner();
+	const glm::ivec3& upper = _region.getUpperCorner();
+	for (int32_t z = lower.z; z <= upper.z; ++z) {
+		for (int32_t y = lower.y; y <= upper.y; ++y) {
+			sampler.setPosition(lower.x, y, z);
+			for (int32_t x = lower.x; x <= upper.x; ++x) {
+				const Voxel& v = sampler.voxel();
+				if (!isAir(v.getMaterial())) {
+					setVoxel(x, y, z, v);
+				}
+				sampler.movePositiveX();
+			}
+		}
+	}
+}
+
+PagedVolume::PagedVolume(const PagedVolume& copy)
+	: _region(copy._region), _dimensions(copy._dimensions), _storage(copy._storage), _borderVoxel(copy._borderVoxel),
+	  _mins(copy._mins), _maxs(copy._maxs), _boundsValid(copy._boundsValid) {
+	_bricks.resize(copy._bricks.size());
+	for (size_t i = 0; i < copy._bricks.size(); ++i) {
+		Brick *b = copy._bricks[i];
+		if (b != nullptr) {
+			// the brick is duplicated on the first write
+			b->refs.increment(1);
+		}
+		_bricks[i] = b;
+	}
+}
+
+PagedVolume::PagedVolume(PagedVolume&& move) noexcept
+	: _region(move._region), _dimensions(move._dimensions), _bricks(core::move(move._bricks)),
+	  _storage(core::move(move._storage)), _borderVoxel(move._borderVoxel), _mins(move._mins), _maxs(move._maxs), _boundsValid(move._boundsValid) {
+}
+
+PagedVolume::~PagedVolume() {
+	clear();
+}
+
+void PagedVolume::init() {
+	core_assert_msg(width() > 0, "Volume width must be greater than zero.");
+	core_assert_msg(height() > 0, "Volume height must be greater than zero.");
+	core_assert_msg(depth() > 0, "Volume depth must be greater than zero.");
+	_dimensions.x = (width() + BrickMask) >> BrickSizeBits;
+	_dimensions.y = (height() + BrickMask) >> BrickSizeBits;
+	_dimensions.z = (depth() + BrickMask) >> BrickSizeBits;
+	_bricks.resize(_dimensions.x * _dimensions.y * _dimensions.z);
+	for (size_t i = 0; i < _bricks.size(); ++i) {
+		_bricks[i] = nullptr;
+	}
+	_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
+	_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
+	_boundsValid = false;
+}
+
+void PagedVolume::releaseBrick(Brick *brick) {
+	if (brick == nullptr) {
+		return;
+	}
+	// decrement() returns the previous value
+	if (brick->refs.decrement(1) != 1) {
+		return;
+	}
+	if (_storage && _storage->owns(brick)) {
+		brick->~Brick();
+		_storage->free(brick);
+		return;
+	}
+	delete brick;
+}
+
+PagedVolume::Brick* PagedVolume::allocateBrick() {
+	if (_storage) {
+		void *slot = _storage->allocate();
+		if (slot != nullptr) {
+			return new (slot) Brick();
+		}
+	}
+	return new Brick();
+}
+
+PagedVolumeStoragePtr PagedVolume::createStorage(const core::String& directory) {
+	PagedVolumeStoragePtr storage = core::make_shared<PagedVolumeStorage>(sizeof(Brick));
+	if (!storage->init(directory)) {
+		return PagedVolumeStoragePtr();
+	}
+	return storage;
+}
+
+void PagedVolume::clear() {
+	for (size_t i = 0; i < _bricks.size(); ++i) {
+		releaseBrick(_bricks[i]);
+		_bricks[i] = nullptr;
+	}
+	_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
+	_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
+	_boundsValid = false;
+}
+
+int PagedVolume::compact() {
+	int released = 0;
+	for (size_t i = 0; i < _bricks.size(); ++i) {
+		Brick *b = _bricks[i];
+		if (b == nullptr) {
+			continue;
+		}
+		bool onlyAir = true;
+		for (int n = 0; n < BrickVoxels; ++n) {
+			if (!isAir(b->voxels[n].getMaterial())) {
+				onlyAir = false;
+				break;
+			}
+		}
+		if (onlyAir) {
+			releaseBrick(b);
+			_bricks[i] = nullptr;
+			++released;
+		}
+	}
+	return released;
+}
+
+int PagedVolume::allocatedBricks() const {
+	int n = 0;
+	for (const Brick *b : _bricks) {
+		if (b != nullptr) {
+			++n;
+		}
+	}
+	return n;
+}
+
+int PagedVolume::sharedBricks() const {
+	int n = 0;
+	for (const Brick *b : _bricks) {
+		if (b != nullptr && (int)b->refs > 1) {
+			++n;
+		}
+	}
+	return n;
+}
+
+size_t PagedVolume::memoryUsage() const {
+	return (size_t)allocatedBricks() * BrickVoxels * sizeof(Voxel);
+}
+
+const Voxel* PagedVolume::brick(int index) const {
+	const Brick *b = _bricks[index];
+	if (b == nullptr) {
+		return PagedVolumeAirBrick;
+	}
+	return b->voxels;
+}
+
+Voxel* PagedVolume::acquireBrick(int index) {
+	Brick *b = _bricks[index];
+	if (b == nullptr) {
+		b = allocateBrick();
+		_bricks[index] = b;
+	} else if ((int)b->refs > 1) {
+		// another copy still references this brick
+		Brick *copy = allocateBrick();
+		core_memcpy((void *)copy->voxels, (const void *)b->voxels, sizeof(copy->voxels));
+		releaseBrick(b);
+		_bricks[index] = copy;
+		b = copy;
+	}
+	return b->voxels;
+}
+
+const Voxel& PagedVolume::voxel(int32_t x, int32_t y, int32_t z) const {
+	if (!_region.containsPoint(x, y, z)) {
+		return _borderVoxel;
+	}
+	const glm::ivec3& lower = _region.getLowerCorner();
+	const int32_t localX = x - lower.x;
+	const int32_t localY = y - lower.y;
+	const int32_t localZ = z - lower.z;
+	return brick(brickIndex(localX, localY, localZ))[voxelIndex(localX, localY, localZ)];
+}
+
+bool PagedVolume::setVoxel(int32_t x, int32_t y, int32_t z, const Voxel& voxel) {
+	return setVoxel(glm::ivec3(x, y, z), voxel);
+}
+
+bool PagedVolume::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
+	if (!_region.containsPoint(pos)) {
+		return false;
+	}
+	const glm::ivec3& lower = _region.getLowerCorner();
+	const int32_t localX = pos.x - lower.x;
+	const int32_t localY = pos.y - lower.y;
+	const int32_t localZ = pos.z - lower.z;
+	const int bidx = brickIndex(localX, localY, localZ);
+	const int vidx = voxelIndex(localX, localY, localZ);
+	if (brick(bidx)[vidx].isSame(voxel)) {
+		return false;
+	}
+	Voxel *b = acquireBrick(bidx);
+	b[vidx] = voxel;
+	_mins = (glm::min)(_mins, pos);
+	_maxs = (glm::max)(_maxs, pos);
+	_boundsValid = true;
+	return true;
+}
+
+RawVolume* PagedVolume::toRawVolume() const {
+	RawVolume *v = new RawVolume(_region);
+	v->setBorderValue(_borderVoxel);
+	const glm::ivec3& lower = _region.getLowerCorner();
+	for (int bz = 0; bz < _dimensions.z; ++bz) {
+		for (int by = 0; by < _dimensions.y; ++by) {
+			for (int bx = 0; bx < _dimensions.x; ++bx) {
+				const Voxel *b = brick(bx + by * _dimensions.x + bz * _dimensions.x * _dimensions.y);
+				if (b == PagedVolumeAirBrick) {
+					continue;
+				}
+				for (int n = 0; n < BrickVoxels; ++n) {
+					if (isAir(b[n].getMaterial())) {
+						continue;
+					}
+					const int x = lower.x + (bx << BrickSizeBits) + (n & BrickMask);
+					const int y = lower.y + (by << BrickSizeBits) + ((n >> BrickSizeBits) & BrickMask);
+					const int z = lower.z + (bz << BrickSizeBits) + (n >> (BrickSizeBits * 2));
+					v->setVoxel(x, y, z, b[n]);
+				}
+			}
+		}
+	}
+	return v;
+}
+
+PagedVolume::Sampler::Sampler(const PagedVolume* volume) : _volume(const_cast<PagedVolume*>(volume)) {
+}
+
+PagedVolume::Sampler::Sampler(const PagedVolume& volume) : _volume(const_cast<PagedVolume*>(&volume)) {
+}
+
+PagedVolume::Sampler::~Sampler() {
+}
+
+bool PagedVolume::Sampler::setVoxel(const Voxel& voxel) {
+	if (_currentPositionInvalid) {
+		return false;
+	}
+	// the brick might have been the shared air brick - update the pointer
+	_volume->setVoxel(_posInVolume, voxel);
+	setPosition(_posInVolume);
+	return true;
+}
+
+bool PagedVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos) {
+	_posInVolume.x = xPos;
+	_posInVolume.y = yPos;
+	_posInVolume.z = zPos;
+
+	const voxel::Region& region = _volume->_region;
+	_currentPositionInvalid = 0u;
+	if (!region.containsPointInX(xPos)) {
+		_currentPositionInvalid |= PAGED_SAMPLER_INVALIDX;
+	}
+	if (!region.containsPointInY(yPos)) {
+		_currentPositionInvalid |= PAGED_SAMPLER_INVALIDY;
+	}
+	if (!region.containsPointInZ(zPos)) {
+		_currentPositionInvalid |= PAGED_SAMPLER_INVALIDZ;
+	}
+
+	if (currentPositionValid()) {
+		const glm::ivec3& lower = region.getLowerCorner();
+		const int32_t localX = xPos - lower.x;
+		const int32_t localY = yPos - lower.y;
+		const int32_t localZ = zPos - lower.z;
+		_posInBrick.x = localX & BrickMask;
+		_posInBrick.y = localY & BrickMask;
+		_posInBrick.z = localZ & BrickMask;
+		const Voxel *b = _volume->brick(_volume->brickIndex(localX, localY, localZ));
+		_currentVoxel = b + voxelIndex(localX, localY, localZ);
+		return true;
+	}
+	_currentVoxel = nullptr;
+	return false;
+}
+
+void PagedVolume::Sampler::move(int axis, int amount) {
+	static const uint8_t invalidFlags[] = {PAGED_SAMPLER_INVALIDX, PAGED_SAMPLER_INVALIDY, PAGED_SAMPLER_INVALIDZ};
+	static const int strides[] = {1, BrickSize, BrickSize * BrickSize};
+	const bool oldPositionValid = currentPositionValid();
+	_posInVolume[axis] += amount;
+	const int posInBrick = _posInBrick[axis] + amount;
+	if (!oldPositionValid || posInBrick < 0 || posInBrick >= BrickSize) {
+		// we are leaving the brick - resolve the new brick
+		setPosition(_posInVolume);
+		return;
+	}
+	const Region &region = _volume->_region;
+	if (!region.containsPoint(_posInVolume)) {
+		_currentPositionInvalid |= invalidFlags[axis];
+		_currentVoxel = nullptr;
+		return;
+	}
+	_posInBrick[axis] = posInBrick;
+	_currentVoxel += (intptr_t)(amount * strides[axis]);
+}
+
+void PagedVolume::Sampler::movePositiveX(uint32_t offset) {
+	move(0, (int)offset);
+}
+
+void PagedVolume::Sampler::movePositiveY(uint32_t offset) {
+	move(1, (int)offset);
+}
+
+void PagedVolume::Sampler::movePositiveZ(uint32_t offset) {
+	move(2, (int)offset);
+}
+
+void PagedVolume::Sampler::moveNegativeX(uint32_t offset) {
+	move(0, -(int)offset);
+}
+
+void PagedVolume::Sampler::moveNegativeY(uint32_t offset) {
+	move(1, -(int)offset);
+}
+
+void PagedVolume::Sampler::moveNegativeZ(uint32_t offset) {
+	move(2, -(int)offset);
+}
+
+}
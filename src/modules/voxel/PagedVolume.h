@@ -0,0 +1,433 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Voxel.h"
+#include "Region.h"
+#include "PagedVolumeStorage.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
+#include <glm/vec3.hpp>
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief Sparse volume implementation that splits the region into bricks of @c BrickSize^3 voxels.
+ *
+ * Bricks are only allocated once a non-air voxel is written into them. All unallocated bricks share
+ * one static air brick - so a mostly empty scene only pays for the bricks that really contain data.
+ *
+ * Copies of a volume share their bricks - a brick is only duplicated on the first write into one of the
+ * copies (copy on write). So copying a volume costs only the brick lookup table.
+ *
+ * The @c Sampler has the same interface as @c RawVolume::Sampler - so the templated algorithms like
+ * @c voxelutil::visitVolume() or the surface extractors can work on both volume types. Inside of a brick the
+ * neighbours in y and z are only @c BrickSize and @c BrickSize^2 voxels away - independent of the size of the
+ * volume. See the @c ExtractCubicMeshPaged benchmark for a comparison with the linear layout of the RawVolume.
+ *
+ * The bricks can be put into a memory mapped scratch file instead of the heap (see createStorage()) - only the
+ * bricks that are in use are kept in memory then. This allows to edit volumes that don't fit into the memory.
+ */
+class PagedVolume {
+public:
+	static constexpr int BrickSizeBits = 5;
+	static constexpr int BrickSize = 1 << BrickSizeBits;
+	static constexpr int BrickMask = BrickSize - 1;
+	static constexpr int BrickVoxels = BrickSize * BrickSize * BrickSize;
+
+	class Sampler {
+	public:
+		Sampler(const PagedVolume& volume);
+		Sampler(const PagedVolume* volume);
+		virtual ~Sampler();
+
+		const Voxel& voxel() const;
+		virtual const Region region() const;
+
+		bool currentPositionValid() const;
+
+		bool setPosition(const glm::ivec3& pos);
+		bool setPosition(int32_t x, int32_t y, int32_t z);
+		virtual bool setVoxel(const Voxel& voxel);
+		const glm::ivec3& position() const;
+
+		void movePositiveX(uint32_t offset = 1);
+		void movePositiveY(uint32_t offset = 1);
+		void movePositiveZ(uint32_t offset = 1);
+
+		void moveNegativeX(uint32_t offset = 1);
+		void moveNegativeY(uint32_t offset = 1);
+		void moveNegativeZ(uint32_t offset = 1);
+
+		const Voxel& peekVoxel1nx1ny1nz() const;
+		const Voxel& peekVoxel1nx1ny0pz() const;
+		const Voxel& peekVoxel1nx1ny1pz() const;
+		const Voxel& peekVoxel1nx0py1nz() const;
+		const Voxel& peekVoxel1nx0py0pz() const;
+		const Voxel& peekVoxel1nx0py1pz() const;
+		const Voxel& peekVoxel1nx1py1nz() const;
+		const Voxel& peekVoxel1nx1py0pz() const;
+		const Voxel& peekVoxel1nx1py1pz() const;
+
+		const Voxel& peekVoxel0px1ny1nz() const;
+		const Voxel& peekVoxel0px1ny0pz() const;
+		const Voxel& peekVoxel0px1ny1pz() const;
+		const Voxel& peekVoxel0px0py1nz() const;
+		const Voxel& peekVoxel0px0py0pz() const;
+		const Voxel& peekVoxel0px0py1pz() const;
+		const Voxel& peekVoxel0px1py1nz() const;
+		const Voxel& peekVoxel0px1py0pz() const;
+		const Voxel& peekVoxel0px1py1pz() const;
+
+		const Voxel& peekVoxel1px1ny1nz() const;
+		const Voxel& peekVoxel1px1ny0pz() const;
+		const Voxel& peekVoxel1px1ny1pz() const;
+		const Voxel& peekVoxel1px0py1nz() const;
+		const Voxel& peekVoxel1px0py0pz() const;
+		const Voxel& peekVoxel1px0py1pz() const;
+		const Voxel& peekVoxel1px1py1nz() const;
+		const Voxel& peekVoxel1px1py0pz() const;
+		const Voxel& peekVoxel1px1py1pz() const;
+
+	protected:
+		/**
+		 * @brief Looks up the neighbour voxel - if it is inside the same brick as the current voxel, the
+		 * lookup is a simple pointer offset, otherwise we go through the volume.
+		 */
+		const Voxel& peek(int dx, int dy, int dz) const;
+		void move(int axis, int amount);
+
+		PagedVolume* _volume;
+
+		//The current position in the volume
+		glm::ivec3 _posInVolume { 0, 0, 0 };
+		/** The current position relative to the brick the sampler is in */
+		glm::ivec3 _posInBrick { 0, 0, 0 };
+
+		/** Other current position information */
+		const Voxel* _currentVoxel = nullptr;
+
+		/** Whether the current position is inside the volume */
+		uint8_t _currentPositionInvalid = 0u;
+	};
+
+	PagedVolume(const Region& region);
+	/**
+	 * @param storage The bricks are allocated in the given storage - the bricks are put on the heap if the storage
+	 * is full. Copies of this volume are using the same storage.
+	 */
+	PagedVolume(const Region& region, const PagedVolumeStoragePtr& storage);
+	PagedVolume(const RawVolume& copy);
+	PagedVolume(const PagedVolume& copy);
+	PagedVolume(PagedVolume&& move) noexcept;
+	~PagedVolume();
+
+	const Voxel& borderValue() const;
+	void setBorderValue(const Voxel& voxel);
+
+	const Region& region() const;
+	int32_t width() const;
+	int32_t height() const;
+	int32_t depth() const;
+
+	/**
+	 * the vector that describes the mins value of an aabb where a voxel is set in this volume
+	 * deleting a voxel afterwards might lead to invalid results
+	 */
+	glm::ivec3 mins() const;
+	/**
+	 * the vector that describes the maxs value of an aabb where a voxel is set in this volume
+	 * deleting a voxel afterwards might lead to invalid results
+	 */
+	glm::ivec3 maxs() const;
+
+	const Voxel& voxel(int32_t x, int32_t y, int32_t z) const;
+	inline const Voxel& voxel(const glm::ivec3& pos) const;
+
+	/**
+	 * @return @c true if the voxel was placed, @c false if it was already the same voxel or outside the region
+	 * @note Writing air into an unallocated brick doesn't allocate it
+	 */
+	bool setVoxel(int32_t x, int32_t y, int32_t z, const Voxel& voxel);
+	bool setVoxel(const glm::ivec3& pos, const Voxel& voxel);
+
+	/**
+	 * @brief Releases all bricks - the volume is air afterwards
+	 */
+	void clear();
+
+	/**
+	 * @brief Releases all bricks that only contain air voxels
+	 * @return The amount of released bricks
+	 */
+	int compact();
+
+	/**
+	 * @brief Convert into a dense volume. It's the callers responsibility to properly release the memory.
+	 */
+	RawVolume* toRawVolume() const;
+
+	/**
+	 * @brief The amount of bricks that are allocated - e.g. that are not sharing the air brick
+	 */
+	int allocatedBricks() const;
+	/**
+	 * @brief The amount of allocated bricks that are shared with other copies of this volume
+	 */
+	int sharedBricks() const;
+	int bricks() const;
+	/**
+	 * @brief The amount of bytes used for the voxel data (without the brick lookup table)
+	 * @note Bricks that are shared with other copies are included
+	 */
+	size_t memoryUsage() const;
+
+	/**
+	 * @brief Creates a storage for the bricks in a scratch file in the given system directory
+	 * @return An empty pointer if the scratch file could not get created
+	 */
+	static PagedVolumeStoragePtr createStorage(const core::String& directory);
+	const PagedVolumeStoragePtr& storage() const;
+
+private:
+	/**
+	 * @brief Reference counted voxel data - shared between the copies of a volume
+	 */
+	struct Brick {
+		core::AtomicInt refs{1};
+		Voxel voxels[BrickVoxels];
+	};
+
+	int brickIndex(int32_t localX, int32_t localY, int32_t localZ) const;
+	static int voxelIndex(int32_t localX, int32_t localY, int32_t localZ);
+	const Voxel* brick(int index) const;
+	/**
+	 * @brief Returns the writable voxels of the brick - allocates the brick or detaches it from the other copies
+	 */
+	Voxel* acquireBrick(int index);
+	Brick* allocateBrick();
+	void releaseBrick(Brick *brick);
+	void init();
+
+	Region _region;
+	/** The amount of bricks in each direction */
+	glm::ivec3 _dimensions { 0 };
+	/** @c nullptr entries are using the shared air brick */
+	core::DynamicArray<Brick*> _bricks;
+	PagedVolumeStoragePtr _storage;
+	Voxel _borderVoxel;
+	glm::ivec3 _mins;
+	glm::ivec3 _maxs;
+	bool _boundsValid = false;
+};
+
+inline const Region& PagedVolume::region() const {
+	return _region;
+}
+
+inline const Voxel& PagedVolume::borderValue() const {
+	return _borderVoxel;
+}
+
+inline void PagedVolume::setBorderValue(const Voxel& voxel) {
+	_borderVoxel = voxel;
+}
+
+inline int32_t PagedVolume::width() const {
+	return _region.getWidthInVoxels();
+}
+
+inline int32_t PagedVolume::height() const {
+	return _region.getHeightInVoxels();
+}
+
+inline int32_t PagedVolume::depth() const {
+	return _region.getDepthInVoxels();
+}
+
+inline const PagedVolumeStoragePtr& PagedVolume::storage() const {
+	return _storage;
+}
+
+inline int PagedVolume::bricks() const {
+	return (int)_bricks.size();
+}
+
+inline glm::ivec3 PagedVolume::mins() const {
+	if (!_boundsValid) {
+		return _region.getLowerCorner();
+	}
+	return _mins;
+}
+
+inline glm::ivec3 PagedVolume::maxs() const {
+	if (!_boundsValid) {
+		return _region.getUpperCorner();
+	}
+	return _maxs;
+}
+
+inline int PagedVolume::brickIndex(int32_t localX, int32_t localY, int32_t localZ) const {
+	return (localX >> BrickSizeBits) + (localY >> BrickSizeBits) * _dimensions.x +
+		   (localZ >> BrickSizeBits) * _dimensions.x * _dimensions.y;
+}
+
+inline int PagedVolume::voxelIndex(int32_t localX, int32_t localY, int32_t localZ) {
+	return (localX & BrickMask) + ((localY & BrickMask) << BrickSizeBits) +
+		   ((localZ & BrickMask) << (BrickSizeBits * 2));
+}
+
+inline const Voxel& PagedVolume::voxel(const glm::ivec3& pos) const {
+	return voxel(pos.x, pos.y, pos.z);
+}
+
+inline const Region PagedVolume::Sampler::region() const {
+	return _volume->region();
+}
+
+inline const glm::ivec3& PagedVolume::Sampler::position() const {
+	return _posInVolume;
+}
+
+inline bool PagedVolume::Sampler::currentPositionValid() const {
+	return !_currentPositionInvalid;
+}
+
+inline const Voxel& PagedVolume::Sampler::voxel() const {
+	if (this->currentPositionValid()) {
+		return *_currentVoxel;
+	}
+	return _volume->voxel(_posInVolume);
+}
+
+inline bool PagedVolume::Sampler::setPosition(const glm::ivec3& pos) {
+	return setPosition(pos.x, pos.y, pos.z);
+}
+
+inline const Voxel& PagedVolume::Sampler::peek(int dx, int dy, int dz) const {
+	if (this->currentPositionValid()) {
+		const int x = _posInBrick.x + dx;
+		const int y = _posInBrick.y + dy;
+		const int z = _posInBrick.z + dz;
+		// the bricks at the upper border are only partially inside the region - voxels outside of the
+		// region must return the border value
+		if (((x | y | z) & ~BrickMask) == 0 && _volume->_region.containsPoint(_posInVolume.x + dx, _posInVolume.y + dy, _posInVolume.z + dz)) {
+			return *(_currentVoxel + dx + dy * BrickSize + dz * BrickSize * BrickSize);
+		}
+	}
+	return _volume->voxel(_posInVolume.x + dx, _posInVolume.y + dy, _posInVolume.z + dz);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny1nz() const {
+	return peek(-1, -1, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny0pz() const {
+	return peek(-1, -1, 0);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1ny1pz() const {
+	return peek(-1, -1, 1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py1nz() const {
+	return peek(-1, 0, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py0pz() const {
+	return peek(-1, 0, 0);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx0py1pz() const {
+	return peek(-1, 0, 1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py1nz() const {
+	return peek(-1, 1, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py0pz() const {
+	return peek(-1, 1, 0);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1nx1py1pz() const {
+	return peek(-1, 1, 1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny1nz() const {
+	return peek(0, -1, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny0pz() const {
+	return peek(0, -1, 0);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px1ny1pz() const {
+	return peek(0, -1, 1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py1nz() const {
+	return peek(0, 0, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py0pz() const {
+	return voxel();
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px0py1pz() const {
+	return peek(0, 0, 1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py1nz() const {
+	return peek(0, 1, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py0pz() const {
+	return peek(0, 1, 0);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel0px1py1pz() const {
+	return peek(0, 1, 1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny1nz() const {
+	return peek(1, -1, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny0pz() const {
+	return peek(1, -1, 0);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px1ny1pz() const {
+	return peek(1, -1, 1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py1nz() const {
+	return peek(1, 0, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py0pz() const {
+	return peek(1, 0, 0);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px0py1pz() const {
+	return peek(1, 0, 1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py1nz() const {
+	return peek(1, 1, -1);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py0pz() const {
+	return peek(1, 1, 0);
+}
+
+inline const Voxel& PagedVolume::Sampler::peekVoxel1px1py1pz() const {
+	return peek(1, 1, 1);
+}
+
+}
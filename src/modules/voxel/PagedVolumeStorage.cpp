@@ -0,0 +1,73 @@
+/**
+ * @file
+ */
+
+#include "PagedVolumeStorage.h"
+#include "core/Assert.h"
+#include "core/Log.h"
+
+namespace voxel {
+
+// keep the slots on their own cache lines
+static constexpr size_t SlotAlignment = 64u;
+
+PagedVolumeStorage::PagedVolumeStorage(size_t slotSize)
+	: _slotSize((slotSize + SlotAlignment - 1u) / SlotAlignment * SlotAlignment) {
+	core_assert_msg(_slotSize <= SegmentSize, "Slot size %i exceeds the segment size", (int)_slotSize);
+}
+
+bool PagedVolumeStorage::init(const core::String &directory) {
+	core::ScopedLock lock(_lock);
+	if (!_file.open(directory, SegmentSize)) {
+		Log::error("Failed to create the volume scratch file in %s", directory.c_str());
+		return false;
+	}
+	return true;
+}
+
+void *PagedVolumeStorage::allocate() {
+	core::ScopedLock lock(_lock);
+	if (!_freeSlots.empty()) {
+		void *slot = _freeSlots.back();
+		_freeSlots.pop();
+		++_usedSlots;
+		return slot;
+	}
+	if (_segmentPos == nullptr || _segmentPos + _slotSize > _segmentEnd) {
+		core_trace_scoped(PagedVolumeStorageGrow);
+		uint8_t *segment = _file.grow();
+		if (segment == nullptr) {
+			return nullptr;
+		}
+		_segmentPos = segment;
+		_segmentEnd = segment + SegmentSize;
+	}
+	void *slot = _segmentPos;
+	_segmentPos += _slotSize;
+	++_usedSlots;
+	return slot;
+}
+
+void PagedVolumeStorage::free(void *slot) {
+	core::ScopedLock lock(_lock);
+	core_assert_msg(_file.contains(slot), "The slot was not allocated by this storage");
+	_freeSlots.push_back(slot);
+	--_usedSlots;
+}
+
+bool PagedVolumeStorage::owns(const void *slot) const {
+	core::ScopedLock lock(_lock);
+	return _file.contains(slot);
+}
+
+size_t PagedVolumeStorage::usedSlots() const {
+	core::ScopedLock lock(_lock);
+	return _usedSlots;
+}
+
+size_t PagedVolumeStorage::fileSize() const {
+	core::ScopedLock lock(_lock);
+	return _file.segments() * SegmentSize;
+}
+
+} // namespace voxel
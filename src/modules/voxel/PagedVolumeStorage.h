@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/SharedPtr.h"
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Lock.h"
+#include "io/MappedScratchFile.h"
+
+namespace voxel {
+
+/**
+ * @brief Fixed size slots in a memory mapped scratch file - used for the bricks of a PagedVolume
+ *
+ * The operating system only keeps the recently used slots in memory and writes the others into the scratch file.
+ * Volumes that are bigger than the available memory can be edited this way - as long as the working set fits.
+ *
+ * @note The storage must outlive all the slots that were allocated from it - the volumes keep a reference.
+ * @sa PagedVolume::createStorage()
+ */
+class PagedVolumeStorage : public core::NonCopyable {
+public:
+	static constexpr size_t SegmentSize = 64u * 1024u * 1024u;
+
+private:
+	io::MappedScratchFile _file;
+	const size_t _slotSize;
+	core::DynamicArray<void *> _freeSlots;
+	uint8_t *_segmentPos = nullptr;
+	uint8_t *_segmentEnd = nullptr;
+	size_t _usedSlots = 0u;
+	mutable core_trace_mutex(core::Lock, _lock, "PagedVolumeStorage");
+
+public:
+	PagedVolumeStorage(size_t slotSize);
+
+	/**
+	 * @param[in] directory The system directory for the scratch file
+	 */
+	bool init(const core::String &directory);
+
+	/**
+	 * @return The memory of one slot or @c nullptr if the scratch file could not get extended
+	 */
+	void *allocate();
+	void free(void *slot);
+	/**
+	 * @return @c true if the given memory was allocated by this storage
+	 */
+	bool owns(const void *slot) const;
+
+	size_t slotSize() const;
+	size_t usedSlots() const;
+	/**
+	 * @return The size of the scratch file in bytes
+	 */
+	size_t fileSize() const;
+};
+
+using PagedVolumeStoragePtr = core::SharedPtr<PagedVolumeStorage>;
+
+inline size_t PagedVolumeStorage::slotSize() const {
+	return _slotSize;
+}
+
+} // namespace voxel
@@ -45,6 +45,18 @@ void Palette::markDirty() {
 	_dirty = true;
 	_hash._hashColors[0] = core::hash(_colors, sizeof(_colors));
 	_hash._hashColors[1] = core::hash(_glowColors, sizeof(_glowColors));
+	updateHSBCache();
+}
+
+void Palette::updateHSBCache() {
+	for (int i = 0; i < _colorCount; ++i) {
+		if (_hsbCache._hsbColors[i] == _colors[i]) {
+			continue;
+		}
+		_hsbCache._hsbColors[i] = _colors[i];
+		core::Color::getHSB(core::Color::fromRGBA(_colors[i]), _hsbCache._hue[i], _hsbCache._saturation[i],
+							_hsbCache._brightness[i]);
+	}
 }
 
 glm::vec4 Palette::color4(uint8_t i) const {
@@ -224,7 +236,16 @@ int Palette::getClosestMatch(const core::RGBA rgba, float *distance, int skip) c
 		if (_colors[i].a == 0) {
 			continue;
 		}
-		const float val = core::Color::getDistance(_colors[i], hue, saturation, brightness);
+		float val;
+		if (_hsbCache._hsbColors[i] == _colors[i]) {
+			// same weights and evaluation order as core::Color::getDistance() - but without the hsb conversion
+			const float dH = _hsbCache._hue[i] - hue;
+			const float dS = _hsbCache._saturation[i] - saturation;
+			const float dV = _hsbCache._brightness[i] - brightness;
+			val = 0.8f * (dH * dH) + 0.1f * (dV * dV) + 0.1f * (dS * dS);
+		} else {
+			val = core::Color::getDistance(_colors[i], hue, saturation, brightness);
+		}
 		if (val < minDistance) {
 			minDistance = val;
 			minIndex = (int)i;
@@ -34,6 +34,20 @@ private:
 	PaletteColorArray _glowColors {};
 	int _colorCount = 0;
 	PaletteIndicesArray _indices;
+
+	/**
+	 * @brief The hue, saturation and brightness values of the palette colors that are used for getClosestMatch()
+	 *
+	 * The values are updated in markDirty(). @c _hsbColors holds the color the values were computed for - a color
+	 * that was modified without marking the palette dirty doesn't match anymore and is converted on the fly.
+	 */
+	struct HSBCache {
+		core::RGBA _hsbColors[PaletteMaxColors] {};
+		float _hue[PaletteMaxColors] {};
+		float _saturation[PaletteMaxColors] {};
+		float _brightness[PaletteMaxColors] {};
+	} _hsbCache;
+	void updateHSBCache();
 public:
 	Palette();
 
@@ -5,24 +5,65 @@
 #pragma once
 
 #include "core/Color.h"
-#include "core/collection/Map.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/Atomic.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
 
 namespace voxel {
 
+/**
+ * @brief Caches the closest palette index for color values
+ *
+ * The cache is a direct mapped table of atomic entries - so one instance can be shared between threads that convert
+ * colors in parallel. The slot of a color is taken from the upper bits of a bijective hash of the color value, the
+ * remaining bits are stored as tag next to the palette index. A color that maps to an occupied slot evicts the
+ * previous entry.
+ *
+ * @note The palette must not be modified while other threads are looking up colors. Call clear() after
+ * modifying the palette.
+ */
 class PaletteLookup {
 private:
 	voxel::Palette _palette;
-	core::Map<core::RGBA, uint8_t, 521> _paletteMap;
+	core::DynamicArray<core::AtomicInt> _cache;
+	/** the amount of bits of the color hash that are used to select the slot - the others are the tag */
+	int _slotBits = 9;
+
+	/**
+	 * @brief Bijective integer hash - two different colors never produce the same slot and tag combination
+	 */
+	static inline uint32_t hashColor(uint32_t x) {
+		x ^= x >> 16;
+		x *= 0x7feb352du;
+		x ^= x >> 15;
+		x *= 0x846ca68bu;
+		x ^= x >> 16;
+		return x;
+	}
+
+	void init(int maxSize) {
+		// the tag, the palette index and the valid bit must fit into 32 bits
+		_slotBits = 9;
+		while (_slotBits < 24 && (1 << _slotBits) < maxSize) {
+			++_slotBits;
+		}
+		_cache.resize((size_t)1 << _slotBits);
+	}
+
 public:
-	PaletteLookup(const voxel::Palette &palette, int maxSize = 32768) : _palette(palette), _paletteMap(maxSize) {
+	/**
+	 * @param maxSize The max amount of cached color lookups - rounded up to the next power of two
+	 */
+	PaletteLookup(const voxel::Palette &palette, int maxSize = 32768) : _palette(palette) {
 		if (_palette.colorCount() <= 0) {
 			_palette.nippon();
 		}
+		init(maxSize);
 	}
-	PaletteLookup(int maxSize = 32768) : _paletteMap(maxSize) {
+	PaletteLookup(int maxSize = 32768) {
 		_palette.nippon();
+		init(maxSize);
 	}
 
 	inline const voxel::Palette &palette() const {
@@ -33,6 +74,15 @@ public:
 		return _palette;
 	}
 
+	/**
+	 * @brief Removes all cached lookups - needed if the palette was modified after colors were looked up
+	 */
+	void clear() {
+		for (core::AtomicInt &entry : _cache) {
+			entry = 0;
+		}
+	}
+
 	/**
 	 * @brief Find the closed index in the currently in-use palette for the given color
 	 * @param color Normalized color value [0.0-1.0]
@@ -44,16 +94,20 @@ public:
 
 	/**
 	 * @brief Find the closed index in the currently in-use palette for the given color
+	 * @note This is thread safe
 	 * @sa core::Color::getClosestMatch()
 	 */
 	uint8_t findClosestIndex(core::RGBA rgba) {
-		uint8_t paletteIndex = 0;
-		if (!_paletteMap.get(rgba, paletteIndex)) {
-			paletteIndex = _palette.getClosestMatch(rgba);
-			if (_paletteMap.size() < _paletteMap.capacity()) {
-				_paletteMap.put(rgba, paletteIndex);
-			}
+		const uint32_t hash = hashColor(rgba.rgba);
+		const uint32_t slot = hash >> (32 - _slotBits);
+		const uint32_t tag = hash & ((1u << (32 - _slotBits)) - 1u);
+		core::AtomicInt &entry = _cache[slot];
+		const uint32_t value = (uint32_t)(int)entry;
+		if ((value & 1u) != 0u && (value >> 9) == tag) {
+			return (uint8_t)(value >> 1);
 		}
+		const uint8_t paletteIndex = (uint8_t)_palette.getClosestMatch(rgba);
+		entry = (int)((tag << 9) | ((uint32_t)paletteIndex << 1) | 1u);
 		return paletteIndex;
 	}
 };
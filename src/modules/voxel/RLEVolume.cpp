@@ -0,0 +1,183 @@
+/**
+ * @file
+ */
+
+#include "RLEVolume.h"
+#include "RawVolume.h"
+#include "core/Assert.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+
+namespace voxel {
+
+static const Voxel RLEVolumeAir;
+
+static inline bool isSameVoxel(const Voxel &a, const Voxel &b) {
+	return core_memcmp(&a, &b, sizeof(Voxel)) == 0;
+}
+
+RLEVolume::RLEVolume(const Region &region) : _region(region) {
+	core_assert_msg(region.isValid(), "Invalid region for the rle volume");
+	_columns.resize((size_t)region.getWidthInVoxels() * region.getDepthInVoxels());
+}
+
+RLEVolume::RLEVolume(const RawVolume &volume) : RLEVolume(volume, volume.region()) {
+}
+
+RLEVolume::RLEVolume(const RawVolume &volume, const Region &region) : _region(region) {
+	core_trace_scoped(RLEVolumeEncode);
+	_region.cropTo(volume.region());
+	core_assert_msg(_region.isValid(), "Invalid region for the rle volume");
+	_columns.resize((size_t)_region.getWidthInVoxels() * _region.getDepthInVoxels());
+
+	const Voxel *data = (const Voxel *)volume.data();
+	const Region &volumeRegion = volume.region();
+	const int stride = volumeRegion.getWidthInVoxels();
+	const int sliceSize = stride * volumeRegion.getHeightInVoxels();
+	const int height = _region.getHeightInVoxels();
+	const glm::ivec3 lower = _region.getLowerCorner() - volumeRegion.getLowerCorner();
+	for (int z = 0; z < _region.getDepthInVoxels(); ++z) {
+		for (int x = 0; x < _region.getWidthInVoxels(); ++x) {
+			Column &column = _columns[x + z * _region.getWidthInVoxels()];
+			const Voxel *voxels = data + (lower.x + x) + lower.y * stride + (size_t)(lower.z + z) * sliceSize;
+			// don't store the air above the last solid voxel
+			int top = height;
+			while (top > 0 && isSameVoxel(voxels[(top - 1) * stride], RLEVolumeAir)) {
+				--top;
+			}
+			int y = 0;
+			while (y < top) {
+				const Voxel &voxel = voxels[y * stride];
+				int length = 1;
+				while (y + length < top && isSameVoxel(voxels[(y + length) * stride], voxel)) {
+					++length;
+				}
+				appendRun(column, length, voxel);
+				y += length;
+			}
+		}
+	}
+}
+
+int RLEVolume::columnHeight(const Column &column) {
+	int height = 0;
+	for (const Run &run : column) {
+		height += run.length;
+	}
+	return height;
+}
+
+void RLEVolume::appendRun(Column &column, int length, const Voxel &voxel) {
+	while (length > 0) {
+		if (!column.empty()) {
+			Run &last = column.back();
+			if (last.length < MaxRunLength && isSameVoxel(last.voxel, voxel)) {
+				const int n = core_min(length, MaxRunLength - (int)last.length);
+				last.length += n;
+				length -= n;
+				continue;
+			}
+		}
+		const int n = core_min(length, MaxRunLength);
+		column.push_back(Run{(uint16_t)n, voxel});
+		length -= n;
+	}
+}
+
+const Voxel &RLEVolume::voxel(int32_t x, int32_t y, int32_t z) const {
+	if (!_region.containsPoint(x, y, z)) {
+		return RLEVolumeAir;
+	}
+	int offset = y - _region.getLowerY();
+	for (const Run &run : column(x, z)) {
+		if (offset < run.length) {
+			return run.voxel;
+		}
+		offset -= run.length;
+	}
+	return RLEVolumeAir;
+}
+
+bool RLEVolume::addRun(int32_t x, int32_t z, int32_t y, int length, const Voxel &voxel) {
+	if (length <= 0) {
+		return true;
+	}
+	if (!_region.containsPoint(x, y, z) || y + length - 1 > _region.getUpperY()) {
+		return false;
+	}
+	Column &c = _columns[columnIndex(x, z)];
+	const int start = y - _region.getLowerY();
+	const int height = columnHeight(c);
+	if (start < height) {
+		return false;
+	}
+	appendRun(c, start - height, RLEVolumeAir);
+	appendRun(c, length, voxel);
+	return true;
+}
+
+void RLEVolume::clear() {
+	for (Column &column : _columns) {
+		column.clear();
+	}
+}
+
+void RLEVolume::copyTo(RawVolume &volume) const {
+	core_trace_scoped(RLEVolumeCopyTo);
+	Region overlap = _region;
+	if (!intersects(overlap, volume.region())) {
+		return;
+	}
+	overlap.cropTo(volume.region());
+	for (int32_t z = overlap.getLowerZ(); z <= overlap.getUpperZ(); ++z) {
+		for (int32_t x = overlap.getLowerX(); x <= overlap.getUpperX(); ++x) {
+			int32_t y = _region.getLowerY();
+			for (const Run &run : column(x, z)) {
+				const int32_t lowerY = core_max(y, overlap.getLowerY());
+				const int32_t upperY = core_min(y + (int32_t)run.length - 1, overlap.getUpperY());
+				if (lowerY <= upperY) {
+					volume.fill(Region(x, lowerY, z, x, upperY, z), run.voxel);
+				}
+				y += run.length;
+				if (y > overlap.getUpperY()) {
+					break;
+				}
+			}
+			// the voxels above the last run are air
+			if (y <= overlap.getUpperY()) {
+				volume.fill(Region(x, core_max(y, overlap.getLowerY()), z, x, overlap.getUpperY(), z), RLEVolumeAir);
+			}
+		}
+	}
+}
+
+RawVolume *RLEVolume::toRawVolume() const {
+	core_trace_scoped(RLEVolumeToRawVolume);
+	const int width = _region.getWidthInVoxels();
+	const int sliceSize = width * _region.getHeightInVoxels();
+	Voxel *data = (Voxel *)core_malloc((size_t)sliceSize * _region.getDepthInVoxels() * sizeof(Voxel));
+	// air is all bits zero
+	core_memset((void *)data, 0, (size_t)sliceSize * _region.getDepthInVoxels() * sizeof(Voxel));
+	for (int z = 0; z < _region.getDepthInVoxels(); ++z) {
+		for (int x = 0; x < width; ++x) {
+			Voxel *voxels = data + x + (size_t)z * sliceSize;
+			int y = 0;
+			for (const Run &run : _columns[x + z * width]) {
+				for (int i = 0; i < run.length; ++i, ++y) {
+					voxels[y * width] = run.voxel;
+				}
+			}
+		}
+	}
+	return RawVolume::createRaw(data, _region);
+}
+
+size_t RLEVolume::runs() const {
+	size_t n = 0;
+	for (const Column &column : _columns) {
+		n += column.size();
+	}
+	return n;
+}
+
+} // namespace voxel
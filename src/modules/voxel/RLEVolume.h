@@ -0,0 +1,103 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Region.h"
+#include "Voxel.h"
+#include "core/collection/DynamicArray.h"
+
+namespace voxel {
+
+class RawVolume;
+
+/**
+ * @brief Volume that stores the voxels as run length encoded columns along the y axis
+ *
+ * Terrain like data and the column based formats (vxl, kv6, ...) consist of long runs of identical voxels. The runs
+ * of a column start at the lower y corner of the region - the voxels above the last run are air.
+ *
+ * The columns are filled with addRun() from the bottom to the top. This allows the loaders to decode their runs
+ * without expanding them and the savers to read the runs of a column without scanning the voxels.
+ */
+class RLEVolume {
+public:
+	struct Run {
+		uint16_t length;
+		Voxel voxel;
+	};
+	static constexpr int MaxRunLength = 0xFFFF;
+	using Column = core::DynamicArray<Run>;
+
+private:
+	Region _region;
+	core::DynamicArray<Column> _columns;
+
+	inline int columnIndex(int32_t x, int32_t z) const {
+		return (x - _region.getLowerX()) + (z - _region.getLowerZ()) * _region.getWidthInVoxels();
+	}
+
+	/**
+	 * @return The amount of voxels in the column that are covered by runs
+	 */
+	static int columnHeight(const Column &column);
+	static void appendRun(Column &column, int length, const Voxel &voxel);
+
+public:
+	RLEVolume(const Region &region);
+	/**
+	 * @brief Encodes the given region of the volume - the region is cropped to the volume region
+	 */
+	RLEVolume(const RawVolume &volume, const Region &region);
+	RLEVolume(const RawVolume &volume);
+
+	inline const Region &region() const {
+		return _region;
+	}
+
+	/**
+	 * @return The voxel at the given position - air for positions outside of the region
+	 */
+	const Voxel &voxel(int32_t x, int32_t y, int32_t z) const;
+
+	inline const Voxel &voxel(const glm::ivec3 &pos) const {
+		return voxel(pos.x, pos.y, pos.z);
+	}
+
+	/**
+	 * @brief Adds a run to the column at the given x and z coordinate. The gap between the last run of the column
+	 * and the given start position is filled with air.
+	 * @param y The start of the run - must not be below the end of the last run of the column
+	 * @return @c false if the run is not inside the region or below the end of the column
+	 */
+	bool addRun(int32_t x, int32_t z, int32_t y, int length, const Voxel &voxel);
+
+	/**
+	 * @return The runs of the column from the bottom to the top
+	 */
+	inline const Column &column(int32_t x, int32_t z) const {
+		return _columns[columnIndex(x, z)];
+	}
+
+	/**
+	 * @brief Removes all runs - the volume is air afterwards
+	 */
+	void clear();
+
+	/**
+	 * @brief Writes the runs into the overlapping part of the given volume
+	 */
+	void copyTo(RawVolume &volume) const;
+	/**
+	 * @brief Expand into a dense volume. It's the callers responsibility to properly release the memory.
+	 */
+	RawVolume *toRawVolume() const;
+
+	/**
+	 * @return The amount of runs of all columns
+	 */
+	size_t runs() const;
+};
+
+} // namespace voxel
@@ -3,16 +3,39 @@
  */
 
 #include "RawVolume.h"
+#include "OccupancyPyramid.h"
 #include "core/Assert.h"
+#include "core/Hash.h"
+#include "core/Memory.h"
 #include "core/StandardLib.h"
+#include "core/Trace.h"
 #include <glm/common.hpp>
 #include <limits>
 
 namespace voxel {
 
-static const uint8_t SAMPLER_INVALIDX = 1 << 0;
-static const uint8_t SAMPLER_INVALIDY = 1 << 1;
-static const uint8_t SAMPLER_INVALIDZ = 1 << 2;
+struct RawVolume::BrickHashes {
+	glm::ivec3 bricks;
+	core::DynamicArray<uint64_t> hashes;
+	core::DynamicArray<bool> valid;
+
+	BrickHashes(const glm::ivec3& dim) : bricks((dim + RawVolume::BrickSize - 1) / RawVolume::BrickSize) {
+		const size_t n = (size_t)bricks.x * (size_t)bricks.y * (size_t)bricks.z;
+		hashes.resize(n);
+		valid.resize(n);
+		invalidate();
+	}
+
+	inline size_t index(const glm::ivec3& brick) const {
+		return (size_t)brick.x + (size_t)brick.y * bricks.x + (size_t)brick.z * bricks.x * bricks.y;
+	}
+
+	void invalidate() {
+		for (size_t i = 0; i < valid.size(); ++i) {
+			valid[i] = false;
+		}
+	}
+};
 
 RawVolume::RawVolume(const Region& regValid) :
 		_region(regValid), _mins((std::numeric_limits<int>::max)()), _maxs((std::numeric_limits<int>::min)()), _boundsValid(false) {
@@ -24,6 +47,7 @@ RawVolume::RawVolume(const RawVolume* copy) :
 		_region(copy->region()) {
 	setBorderValue(copy->borderValue());
 	const size_t size = width() * height() * depth() * sizeof(Voxel);
+	core_memory_scope(Volume);
 	_data = (Voxel*)core_malloc(size);
 	_mins = copy->_mins;
 	_maxs = copy->_maxs;
@@ -36,6 +60,7 @@ RawVolume::RawVolume(const RawVolume& copy) :
 		_region(copy.region()) {
 	setBorderValue(copy.borderValue());
 	const size_t size = width() * height() * depth() * sizeof(Voxel);
+	core_memory_scope(Volume);
 	_data = (Voxel*)core_malloc(size);
 	_mins = copy._mins;
 	_maxs = copy._maxs;
@@ -56,40 +81,12 @@ static inline voxel::Region accumulate(const core::DynamicArray<Region>& regions
 	return r;
 }
 
-RawVolume::RawVolume(const RawVolume &src, const core::DynamicArray<Region> &regions)
-	: _region(accumulate(regions)) {
+RawVolume::RawVolume(const RawVolume &src, const core::DynamicArray<Region> &regions) {
+	// the voxels between the regions are air
+	initialise(accumulate(regions));
 	setBorderValue(src.borderValue());
-	_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
-	_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
-	_boundsValid = false;
-	const glm::ivec3 &srcMins = src._region.getLowerCorner();
-	const int srcYStride = src._region.getWidthInVoxels();
-	const int srcZStride = src._region.getWidthInVoxels() * src._region.getHeightInVoxels();
-	const size_t size = width() * height() * depth() * sizeof(Voxel);
-	_data = (Voxel *)core_malloc(size);
-
 	for (const voxel::Region &region : regions) {
-		const glm::ivec3 &tgtMins = region.getLowerCorner();
-		const glm::ivec3 &tgtMaxs = region.getUpperCorner();
-		const int tgtYStride = region.getWidthInVoxels();
-		const int tgtZStride = region.getWidthInVoxels() * region.getHeightInVoxels();
-		for (int x = tgtMins.x; x <= tgtMaxs.x; ++x) {
-			const int32_t tgtXPos = x - tgtMins.x;
-			const int32_t srcXPos = x - srcMins.x;
-			for (int y = tgtMins.y; y <= tgtMaxs.y; ++y) {
-				const int32_t tgtYPos = y - tgtMins.y;
-				const int32_t srcYPos = y - srcMins.y;
-				const int tgtStrideLocal = tgtXPos + tgtYPos * tgtYStride;
-				const int srcStrideLocal = srcXPos + srcYPos * srcYStride;
-				for (int z = tgtMins.z; z <= tgtMaxs.z; ++z) {
-					const int32_t tgtZPos = z - tgtMins.z;
-					const int32_t srcZPos = z - srcMins.z;
-					const int tgtindex = tgtStrideLocal + tgtZPos * tgtZStride;
-					const int srcindex = srcStrideLocal + srcZPos * srcZStride;
-					_data[tgtindex] = src._data[srcindex];
-				}
-			}
-		}
+		copyRegion(src, region, region.getLowerCorner());
 	}
 }
 
@@ -99,6 +96,7 @@ RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir)
 		_region.cropTo(src._region);
 	}
 	const size_t size = width() * height() * depth() * sizeof(Voxel);
+	core_memory_scope(Volume);
 	_data = (Voxel *)core_malloc(size);
 	if (src.region() == _region) {
 		_mins = src._mins;
@@ -115,30 +113,23 @@ RawVolume::RawVolume(const RawVolume& src, const Region& region, bool *onlyAir)
 		_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
 		_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
 		_boundsValid = false;
-		const glm::ivec3 &tgtMins = _region.getLowerCorner();
-		const glm::ivec3 &tgtMaxs = _region.getUpperCorner();
-		const glm::ivec3 &srcMins = src._region.getLowerCorner();
-		const int tgtYStride = _region.getWidthInVoxels();
-		const int tgtZStride = _region.getWidthInVoxels() * _region.getHeightInVoxels();
-		const int srcYStride = src._region.getWidthInVoxels();
-		const int srcZStride = src._region.getWidthInVoxels() * src._region.getHeightInVoxels();
-		for (int x = tgtMins.x; x <= tgtMaxs.x; ++x) {
-			const int32_t tgtXPos = x - tgtMins.x;
-			const int32_t srcXPos = x - srcMins.x;
-			for (int y = tgtMins.y; y <= tgtMaxs.y; ++y) {
-				const int32_t tgtYPos = y - tgtMins.y;
-				const int32_t srcYPos = y - srcMins.y;
-				const int tgtStrideLocal = tgtXPos + tgtYPos * tgtYStride;
-				const int srcStrideLocal = srcXPos + srcYPos * srcYStride;
-				for (int z = tgtMins.z; z <= tgtMaxs.z; ++z) {
-					const int32_t tgtZPos = z - tgtMins.z;
-					const int32_t srcZPos = z - srcMins.z;
-					const int tgtindex = tgtStrideLocal + tgtZPos * tgtZStride;
-					const int srcindex = srcStrideLocal + srcZPos * srcZStride;
-					_data[tgtindex] = src._data[srcindex];
-					if (onlyAir && !voxel::isAir(_data[tgtindex].getMaterial())) {
-						*onlyAir = false;
-						onlyAir = nullptr;
+		const glm::ivec3 &srcMins = _region.getLowerCorner() - src._region.getLowerCorner();
+		const glm::ivec3 &dim = _region.getDimensionsInVoxels();
+		const int srcWidth = src.width();
+		const int srcSliceSize = srcWidth * src.height();
+		// copy row by row to not walk the source volume against its memory layout
+		for (int z = 0; z < dim.z; ++z) {
+			for (int y = 0; y < dim.y; ++y) {
+				const Voxel *srcRow = src._data + srcMins.x + (srcMins.y + y) * srcWidth + (srcMins.z + z) * srcSliceSize;
+				Voxel *tgtRow = _data + y * dim.x + z * dim.x * dim.y;
+				core_memcpy((void *)tgtRow, (const void *)srcRow, dim.x * sizeof(Voxel));
+				if (onlyAir) {
+					for (int x = 0; x < dim.x; ++x) {
+						if (!voxel::isAir(tgtRow[x].getMaterial())) {
+							*onlyAir = false;
+							onlyAir = nullptr;
+							break;
+						}
 					}
 				}
 			}
@@ -153,6 +144,10 @@ RawVolume::RawVolume(RawVolume&& move) noexcept {
 	_maxs = move._maxs;
 	_region = move._region;
 	_boundsValid = move._boundsValid;
+	_occupancy = move._occupancy;
+	move._occupancy = nullptr;
+	_brickHashes = move._brickHashes;
+	move._brickHashes = nullptr;
 }
 
 RawVolume::RawVolume(const Voxel* data, const voxel::Region& region) {
@@ -171,12 +166,103 @@ RawVolume::RawVolume(Voxel* data, const voxel::Region& region) :
 }
 
 RawVolume::~RawVolume() {
+	disableOccupancy();
+	delete _brickHashes;
+	_brickHashes = nullptr;
 	core_free(_data);
 	_data = nullptr;
 }
 
+void RawVolume::enableOccupancy() {
+	if (_occupancy != nullptr) {
+		return;
+	}
+	_occupancy = new OccupancyPyramid(_region);
+	_occupancy->build(*this);
+}
+
+void RawVolume::disableOccupancy() {
+	delete _occupancy;
+	_occupancy = nullptr;
+}
+
+void RawVolume::updateOccupancy(const glm::ivec3& pos, const Voxel& oldVoxel, const Voxel& newVoxel) {
+	const bool wasAir = isAir(oldVoxel.getMaterial());
+	const bool air = isAir(newVoxel.getMaterial());
+	if (wasAir != air) {
+		_occupancy->update(pos, !air);
+	}
+}
+
+void RawVolume::invalidateBrickHash(const glm::ivec3& pos) {
+	const glm::ivec3 brick = (pos - _region.getLowerCorner()) / BrickSize;
+	_brickHashes->valid[_brickHashes->index(brick)] = false;
+}
+
+void RawVolume::invalidateBrickHashes(const Region& region) {
+	if (_brickHashes == nullptr) {
+		return;
+	}
+	const glm::ivec3 mins = (region.getLowerCorner() - _region.getLowerCorner()) / BrickSize;
+	const glm::ivec3 maxs = (region.getUpperCorner() - _region.getLowerCorner()) / BrickSize;
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				_brickHashes->valid[_brickHashes->index(glm::ivec3(x, y, z))] = false;
+			}
+		}
+	}
+}
+
+uint64_t RawVolume::hash() const {
+	core_trace_scoped(RawVolumeHash);
+	const glm::ivec3 dim = _region.getDimensionsInVoxels();
+	if (_brickHashes == nullptr) {
+		_brickHashes = new BrickHashes(dim);
+	}
+	const int w = width();
+	const int sliceSize = w * height();
+	const glm::ivec3& bricks = _brickHashes->bricks;
+	core::Hash64 hasher;
+	for (int bz = 0; bz < bricks.z; ++bz) {
+		for (int by = 0; by < bricks.y; ++by) {
+			for (int bx = 0; bx < bricks.x; ++bx) {
+				const size_t idx = _brickHashes->index(glm::ivec3(bx, by, bz));
+				if (_brickHashes->valid[idx]) {
+					continue;
+				}
+				const glm::ivec3 brickMins(bx * BrickSize, by * BrickSize, bz * BrickSize);
+				const glm::ivec3 brickDim = (glm::min)(glm::ivec3(BrickSize), dim - brickMins);
+				hasher.reset();
+				for (int z = 0; z < brickDim.z; ++z) {
+					for (int y = 0; y < brickDim.y; ++y) {
+						const Voxel* row = _data + brickMins.x + (brickMins.y + y) * w + (brickMins.z + z) * sliceSize;
+						hasher.update(row, brickDim.x * sizeof(Voxel));
+					}
+				}
+				_brickHashes->hashes[idx] = hasher.digest();
+				_brickHashes->valid[idx] = true;
+			}
+		}
+	}
+	hasher.reset();
+	hasher.update(&dim, sizeof(dim));
+	hasher.update(_brickHashes->hashes.data(), _brickHashes->hashes.size() * sizeof(uint64_t));
+	return hasher.digest();
+}
+
+void RawVolume::translate(const glm::ivec3& t) {
+	_region.shift(t.x, t.y, t.z);
+	_mins += t;
+	_maxs += t;
+	if (_occupancy != nullptr) {
+		_occupancy->translate(t);
+	}
+}
+
 Voxel* RawVolume::copyVoxels() const {
 	const size_t size = width() * height() * depth() * sizeof(Voxel);
+	core_memory_scope(Volume);
 	Voxel* rawCopy = (Voxel*)core_malloc(size);
 	core_memcpy((void*)rawCopy, (void*)_data, size);
 	return rawCopy;
@@ -244,6 +330,12 @@ bool RawVolume::setVoxel(const glm::ivec3& pos, const Voxel& voxel) {
 	_mins = (glm::min)(_mins, pos);
 	_maxs = (glm::max)(_maxs, pos);
 	_boundsValid = true;
+	if (_occupancy != nullptr) {
+		updateOccupancy(pos, _data[index], voxel);
+	}
+	if (_brickHashes != nullptr) {
+		invalidateBrickHash(pos);
+	}
 	_data[index] = voxel;
 	return true;
 }
@@ -260,6 +352,7 @@ void RawVolume::initialise(const Region& regValidRegion) {
 
 	//Create the data
 	const size_t size = width() * height() * depth() * sizeof(Voxel);
+	core_memory_scope(Volume);
 	_data = (Voxel*)core_malloc(size);
 	core_assert_msg_always(_data != nullptr, "Failed to allocate the memory for a volume with the dimensions %i:%i:%i", width(),  height(), depth());
 
@@ -273,186 +366,113 @@ void RawVolume::clear() {
 	_mins = glm::ivec3((std::numeric_limits<int>::max)() / 2);
 	_maxs = glm::ivec3((std::numeric_limits<int>::min)() / 2);
 	_boundsValid = false;
+	if (_occupancy != nullptr) {
+		_occupancy->clear();
+	}
+	if (_brickHashes != nullptr) {
+		_brickHashes->invalidate();
+	}
 }
 
-RawVolume::Sampler::Sampler(const RawVolume* volume) :
-		_volume(const_cast<RawVolume*>(volume)) {
-}
-
-RawVolume::Sampler::Sampler(const RawVolume& volume) :
-		_volume(const_cast<RawVolume*>(&volume)) {
-}
-
-RawVolume::Sampler::~Sampler() {
+void RawVolume::updateBounds(const Region& region) {
+	_mins = (glm::min)(_mins, region.getLowerCorner());
+	_maxs = (glm::max)(_maxs, region.getUpperCorner());
+	_boundsValid = true;
 }
 
-bool RawVolume::Sampler::setVoxel(const Voxel& voxel) {
-	if (_currentPositionInvalid) {
-		return false;
+Region RawVolume::fill(const Region& region, const Voxel& voxel) {
+	core_trace_scoped(RawVolumeFill);
+	Region filled = region;
+	filled.cropTo(_region);
+	if (!filled.isValid()) {
+		return Region::InvalidRegion;
 	}
-	*_currentVoxel = voxel;
-	_volume->_mins = (glm::min)(_volume->_mins, _posInVolume);
-	_volume->_maxs = (glm::max)(_volume->_maxs, _posInVolume);
-	_volume->_boundsValid = true;
-	return true;
+	const glm::ivec3& mins = filled.getLowerCorner() - _region.getLowerCorner();
+	const glm::ivec3& dim = filled.getDimensionsInVoxels();
+	const int w = width();
+	const int sliceSize = w * height();
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			Voxel* row = _data + mins.x + (mins.y + y) * w + (mins.z + z) * sliceSize;
+			if (_occupancy != nullptr) {
+				const glm::ivec3 pos(filled.getLowerX(), filled.getLowerY() + y, filled.getLowerZ() + z);
+				for (int x = 0; x < dim.x; ++x) {
+					updateOccupancy(glm::ivec3(pos.x + x, pos.y, pos.z), row[x], voxel);
+				}
+			}
+			for (int x = 0; x < dim.x; ++x) {
+				row[x] = voxel;
+			}
+		}
+	}
+	invalidateBrickHashes(filled);
+	updateBounds(filled);
+	return filled;
 }
 
-bool RawVolume::Sampler::setPosition(int32_t xPos, int32_t yPos, int32_t zPos) {
-	_posInVolume.x = xPos;
-	_posInVolume.y = yPos;
-	_posInVolume.z = zPos;
-
-	const voxel::Region& region = this->region();
-	_currentPositionInvalid = 0u;
-	if (!region.containsPointInX(xPos)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDX;
-	}
-	if (!region.containsPointInY(yPos)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDY;
+Region RawVolume::copyRegion(const RawVolume& src, const Region& srcRegion, const glm::ivec3& dstPos, bool skipAir) {
+	core_trace_scoped(RawVolumeCopyRegion);
+	core_assert_msg(&src != this, "Copying regions inside the same volume is not supported");
+	Region srcCropped = srcRegion;
+	srcCropped.cropTo(src._region);
+	if (!srcCropped.isValid()) {
+		return Region::InvalidRegion;
 	}
-	if (!region.containsPointInZ(zPos)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDZ;
+	const glm::ivec3 offset = dstPos - srcRegion.getLowerCorner();
+	Region dstRegion(srcCropped.getLowerCorner() + offset, srcCropped.getUpperCorner() + offset);
+	dstRegion.cropTo(_region);
+	if (!dstRegion.isValid()) {
+		return Region::InvalidRegion;
 	}
-
-	// Then we update the voxel pointer
-	if (currentPositionValid()) {
-		const glm::ivec3& v3dLowerCorner = region.getLowerCorner();
-		const int32_t iLocalXPos = xPos - v3dLowerCorner.x;
-		const int32_t iLocalYPos = yPos - v3dLowerCorner.y;
-		const int32_t iLocalZPos = zPos - v3dLowerCorner.z;
-		const int32_t uVoxelIndex = iLocalXPos + iLocalYPos * _volume->width() + iLocalZPos * _volume->width() * _volume->height();
-
-		_currentVoxel = _volume->_data + uVoxelIndex;
-		return true;
+	const glm::ivec3& srcMins = dstRegion.getLowerCorner() - offset - src._region.getLowerCorner();
+	const glm::ivec3& dstMins = dstRegion.getLowerCorner() - _region.getLowerCorner();
+	const glm::ivec3& dim = dstRegion.getDimensionsInVoxels();
+	const int srcWidth = src.width();
+	const int srcSliceSize = srcWidth * src.height();
+	const int dstWidth = width();
+	const int dstSliceSize = dstWidth * height();
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			const Voxel* srcRow = src._data + srcMins.x + (srcMins.y + y) * srcWidth + (srcMins.z + z) * srcSliceSize;
+			Voxel* dstRow = _data + dstMins.x + (dstMins.y + y) * dstWidth + (dstMins.z + z) * dstSliceSize;
+			if (!skipAir && _occupancy == nullptr) {
+				core_memcpy((void*)dstRow, (const void*)srcRow, dim.x * sizeof(Voxel));
+				continue;
+			}
+			for (int x = 0; x < dim.x; ++x) {
+				if (skipAir && isAir(srcRow[x].getMaterial())) {
+					continue;
+				}
+				if (_occupancy != nullptr) {
+					updateOccupancy(dstRegion.getLowerCorner() + glm::ivec3(x, y, z), dstRow[x], srcRow[x]);
+				}
+				dstRow[x] = srcRow[x];
+			}
+		}
 	}
-	_currentVoxel = nullptr;
-	return false;
+	invalidateBrickHashes(dstRegion);
+	updateBounds(dstRegion);
+	return dstRegion;
 }
 
-void RawVolume::Sampler::movePositiveX(uint32_t offset) {
-	const bool bIsOldPositionValid = currentPositionValid();
-
-	_posInVolume.x += (int)offset;
-
-	if (!region().containsPointInX(_posInVolume.x)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDX;
-	} else {
-		_currentPositionInvalid &= ~SAMPLER_INVALIDX;
-	}
-
-	// Then we update the voxel pointer
-	if (!bIsOldPositionValid) {
-		setPosition(_posInVolume);
-	} else if (currentPositionValid()) {
-		_currentVoxel += (intptr_t)offset;
-	} else {
-		_currentVoxel = nullptr;
-	}
+RawVolume::Sampler::Sampler(const RawVolume* volume) :
+		Super(volume) {
 }
 
-void RawVolume::Sampler::movePositiveY(uint32_t offset) {
-	const bool bIsOldPositionValid = currentPositionValid();
-
-	_posInVolume.y += (int)offset;
-
-	if (!region().containsPointInY(_posInVolume.y)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDY;
-	} else {
-		_currentPositionInvalid &= ~SAMPLER_INVALIDY;
-	}
-
-	// Then we update the voxel pointer
-	if (!bIsOldPositionValid) {
-		setPosition(_posInVolume);
-	} else if (currentPositionValid()) {
-		_currentVoxel += (intptr_t)(_volume->width() * offset);
-	} else {
-		_currentVoxel = nullptr;
-	}
+RawVolume::Sampler::Sampler(const RawVolume& volume) :
+		Super(&volume) {
 }
 
-void RawVolume::Sampler::movePositiveZ(uint32_t offset) {
-	const bool bIsOldPositionValid = currentPositionValid();
-
-	_posInVolume.z += (int)offset;
-
-	if (!region().containsPointInZ(_posInVolume.z)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDZ;
-	} else {
-		_currentPositionInvalid &= ~SAMPLER_INVALIDZ;
-	}
-
-	// Then we update the voxel pointer
-	if (!bIsOldPositionValid) {
-		setPosition(_posInVolume);
-	} else if (currentPositionValid()) {
-		_currentVoxel += (intptr_t)(_volume->width() * _volume->height() * offset);
-	} else {
-		_currentVoxel = nullptr;
-	}
+RawVolume::Sampler::~Sampler() {
 }
 
-void RawVolume::Sampler::moveNegativeX(uint32_t offset) {
-	const bool bIsOldPositionValid = currentPositionValid();
-
-	_posInVolume.x -= (int)offset;
-
-	if (!region().containsPointInX(_posInVolume.x)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDX;
-	} else {
-		_currentPositionInvalid &= ~SAMPLER_INVALIDX;
-	}
-
-	// Then we update the voxel pointer
-	if (!bIsOldPositionValid) {
-		setPosition(_posInVolume);
-	} else if (currentPositionValid()) {
-		_currentVoxel -= (intptr_t)offset;
-	} else {
-		_currentVoxel = nullptr;
-	}
+const Region RawVolume::Sampler::region() const {
+	return _volume->region();
 }
 
-void RawVolume::Sampler::moveNegativeY(uint32_t offset) {
-	const bool bIsOldPositionValid = currentPositionValid();
-
-	_posInVolume.y -= (int)offset;
-
-	if (!region().containsPointInY(_posInVolume.y)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDY;
-	} else {
-		_currentPositionInvalid &= ~SAMPLER_INVALIDY;
-	}
-
-	// Then we update the voxel pointer
-	if (!bIsOldPositionValid) {
-		setPosition(_posInVolume);
-	} else if (currentPositionValid()) {
-		_currentVoxel -= (intptr_t)(_volume->width() * offset);
-	} else {
-		_currentVoxel = nullptr;
-	}
+bool RawVolume::Sampler::setVoxel(const Voxel& voxel) {
+	return Super::storeVoxel(voxel);
 }
 
-void RawVolume::Sampler::moveNegativeZ(uint32_t offset) {
-	const bool bIsOldPositionValid = currentPositionValid();
-
-	_posInVolume.z -= (int)offset;
-
-	if (!region().containsPointInZ(_posInVolume.z)) {
-		_currentPositionInvalid |= SAMPLER_INVALIDZ;
-	} else {
-		_currentPositionInvalid &= ~SAMPLER_INVALIDZ;
-	}
-
-	// Then we update the voxel pointer
-	if (!bIsOldPositionValid) {
-		setPosition(_posInVolume);
-	} else if (currentPositionValid()) {
-		_currentVoxel -= (intptr_t)(_volume->width() * _volume->height() * offset);
-	} else {
-		_currentVoxel = nullptr;
-	}
-}
 
 }
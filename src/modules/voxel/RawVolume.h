@@ -7,29 +7,47 @@
 #include "Voxel.h"
 #include "Region.h"
 #include "core/collection/DynamicArray.h"
+#include <glm/common.hpp>
 #include <glm/vec3.hpp>
 
 namespace voxel {
 
+class OccupancyPyramid;
+
 /**
  * Simple volume implementation which stores data in a single large 3D array.
  */
 class RawVolume {
 public:
-	class Sampler {
-	public:
-		Sampler(const RawVolume& volume);
-		Sampler(const RawVolume* volume);
-		virtual ~Sampler();
+	/**
+	 * @brief The shared implementation of the samplers. The region and the voxel modification are resolved at
+	 * compile time by the @c Derived class.
+	 * @sa Sampler
+	 * @sa DirectSampler
+	 */
+	template<class Derived>
+	class SamplerBase {
+	protected:
+		static constexpr uint8_t InvalidX = 1 << 0;
+		static constexpr uint8_t InvalidY = 1 << 1;
+		static constexpr uint8_t InvalidZ = 1 << 2;
 
+		SamplerBase(const RawVolume* volume) : _volume(const_cast<RawVolume*>(volume)) {
+		}
+
+		inline const Derived& derived() const {
+			return *static_cast<const Derived*>(this);
+		}
+
+		bool storeVoxel(const Voxel& voxel);
+
+	public:
 		const Voxel& voxel() const;
-		virtual const Region region() const;
 
 		bool currentPositionValid() const;
 
 		bool setPosition(const glm::ivec3& pos);
 		bool setPosition(int32_t x, int32_t y, int32_t z);
-		virtual bool setVoxel(const Voxel& voxel);
 		const glm::ivec3& position() const;
 
 		void movePositiveX(uint32_t offset = 1);
@@ -83,6 +101,45 @@ public:
 		uint8_t _currentPositionInvalid = 0u;
 	};
 
+	/**
+	 * @brief The sampler with virtual @c region() and @c setVoxel() - this is extended by the volume wrappers
+	 * @sa RawVolumeWrapper::Sampler
+	 */
+	class Sampler : public SamplerBase<Sampler> {
+	private:
+		using Super = SamplerBase<Sampler>;
+	public:
+		Sampler(const RawVolume& volume);
+		Sampler(const RawVolume* volume);
+		virtual ~Sampler();
+
+		virtual const Region region() const;
+		virtual bool setVoxel(const Voxel& voxel);
+	};
+
+	/**
+	 * @brief Sampler without virtual functions that can get inlined into the loops of the algorithms that know
+	 * that they operate on a plain RawVolume.
+	 * @sa VolumeSampler
+	 */
+	class DirectSampler : public SamplerBase<DirectSampler> {
+	private:
+		using Super = SamplerBase<DirectSampler>;
+	public:
+		DirectSampler(const RawVolume& volume) : Super(&volume) {
+		}
+		DirectSampler(const RawVolume* volume) : Super(volume) {
+		}
+
+		inline const Region& region() const {
+			return _volume->region();
+		}
+
+		inline bool setVoxel(const Voxel& voxel) {
+			return storeVoxel(voxel);
+		}
+	};
+
 	RawVolume(const Voxel* data, const voxel::Region& region);
 	RawVolume(Voxel* data, const voxel::Region& region);
 
@@ -182,21 +239,62 @@ public:
 
 	void clear();
 
+	/**
+	 * @brief Sets all voxels of the given region to the given voxel row by row
+	 * @return The part of the given region that is inside of this volume - this is invalid if the region doesn't
+	 * intersect the volume
+	 */
+	Region fill(const Region& region, const Voxel& voxel);
+	/**
+	 * @brief Copies the voxels of @c srcRegion of the given volume row by row into this volume. The lower corner of
+	 * the source region ends up at @c dstPos.
+	 * @param skipAir Don't copy the air voxels of the source volume - the voxels of this volume are kept at those
+	 * positions
+	 * @return The region of this volume that the voxels were copied into - this is invalid if nothing was copied
+	 * @note The source volume must not be this volume
+	 */
+	Region copyRegion(const RawVolume& src, const Region& srcRegion, const glm::ivec3& dstPos, bool skipAir = false);
+
+	/**
+	 * @brief Maintain an OccupancyPyramid for this volume that is updated with every voxel modification.
+	 * Raycasts can use it to skip the empty parts of the volume.
+	 * @note The occupancy is not copied along with the volume
+	 */
+	void enableOccupancy();
+	void disableOccupancy();
+	/**
+	 * @return The occupancy pyramid or @c nullptr if it's not enabled
+	 * @sa enableOccupancy()
+	 */
+	inline const OccupancyPyramid* occupancy() const {
+		return _occupancy;
+	}
+
 	inline const uint8_t* data() const {
 		return (const uint8_t*)_data;
 	}
 
+	/**
+	 * @brief The edge length of the bricks that the content hash is cached for
+	 */
+	static constexpr int BrickSize = 16;
+	/**
+	 * @brief Content hash of the voxels and the dimensions of the volume - the position of the region is not part of
+	 * the hash. The hashes of the bricks are cached and only the bricks that were modified since the last call are
+	 * hashed again.
+	 * @note Not thread safe - the cache is updated by this call
+	 * @sa core::hash64()
+	 */
+	uint64_t hash() const;
+
 	/**
 	 * @brief Shift the region of the volume by the given coordinates
 	 */
-	void translate(const glm::ivec3& t) {
-		_region.shift(t.x, t.y, t.z);
-		_mins += t;
-		_maxs += t;
-	}
+	void translate(const glm::ivec3& t);
 
 private:
 	void initialise(const Region& region);
+	void updateBounds(const Region& region);
 
 	/** The size of the volume */
 	Region _region;
@@ -210,8 +308,40 @@ private:
 	glm::ivec3 _mins;
 	glm::ivec3 _maxs;
 	bool _boundsValid;
+
+	OccupancyPyramid* _occupancy = nullptr;
+	void updateOccupancy(const glm::ivec3& pos, const Voxel& oldVoxel, const Voxel& newVoxel);
+
+	struct BrickHashes;
+	/** created by the first call to hash() */
+	mutable BrickHashes* _brickHashes = nullptr;
+	void invalidateBrickHash(const glm::ivec3& pos);
+	void invalidateBrickHashes(const Region& region);
+};
+
+template<class Volume>
+struct VolumeSamplerType {
+	using type = typename Volume::Sampler;
 };
 
+template<>
+struct VolumeSamplerType<RawVolume> {
+	using type = RawVolume::DirectSampler;
+};
+
+template<>
+struct VolumeSamplerType<const RawVolume> {
+	using type = RawVolume::DirectSampler;
+};
+
+/**
+ * @brief The sampler the templated algorithms should use for the given volume type. If the volume is known to be a
+ * plain RawVolume at compile time, the sampler without virtual functions is used. The wrappers keep their samplers
+ * to track the modifications.
+ */
+template<class Volume>
+using VolumeSampler = typename VolumeSamplerType<Volume>::type;
+
 inline const Region& RawVolume::region() const {
 	return _region;
 }
@@ -250,6 +380,189 @@ inline const Voxel& RawVolume::voxel(const glm::ivec3& pos) const {
 	return voxel(pos.x, pos.y, pos.z);
 }
 
+template<class Derived>
+inline bool RawVolume::SamplerBase<Derived>::storeVoxel(const Voxel& voxel) {
+	if (_currentPositionInvalid) {
+		return false;
+	}
+	if (_volume->_occupancy != nullptr) {
+		_volume->updateOccupancy(_posInVolume, *_currentVoxel, voxel);
+	}
+	if (_volume->_brickHashes != nullptr) {
+		_volume->invalidateBrickHash(_posInVolume);
+	}
+	*_currentVoxel = voxel;
+	_volume->_mins = (glm::min)(_volume->_mins, _posInVolume);
+	_volume->_maxs = (glm::max)(_volume->_maxs, _posInVolume);
+	_volume->_boundsValid = true;
+	return true;
+}
+
+template<class Derived>
+inline bool RawVolume::SamplerBase<Derived>::setPosition(int32_t xPos, int32_t yPos, int32_t zPos) {
+	_posInVolume.x = xPos;
+	_posInVolume.y = yPos;
+	_posInVolume.z = zPos;
+
+	const voxel::Region& region = derived().region();
+	_currentPositionInvalid = 0u;
+	if (!region.containsPointInX(xPos)) {
+		_currentPositionInvalid |= InvalidX;
+	}
+	if (!region.containsPointInY(yPos)) {
+		_currentPositionInvalid |= InvalidY;
+	}
+	if (!region.containsPointInZ(zPos)) {
+		_currentPositionInvalid |= InvalidZ;
+	}
+
+	// Then we update the voxel pointer
+	if (currentPositionValid()) {
+		const glm::ivec3& v3dLowerCorner = region.getLowerCorner();
+		const int32_t iLocalXPos = xPos - v3dLowerCorner.x;
+		const int32_t iLocalYPos = yPos - v3dLowerCorner.y;
+		const int32_t iLocalZPos = zPos - v3dLowerCorner.z;
+		const int32_t uVoxelIndex = iLocalXPos + iLocalYPos * _volume->width() + iLocalZPos * _volume->width() * _volume->height();
+
+		_currentVoxel = _volume->_data + uVoxelIndex;
+		return true;
+	}
+	_currentVoxel = nullptr;
+	return false;
+}
+
+template<class Derived>
+inline void RawVolume::SamplerBase<Derived>::movePositiveX(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.x += (int)offset;
+
+	if (!derived().region().containsPointInX(_posInVolume.x)) {
+		_currentPositionInvalid |= InvalidX;
+	} else {
+		_currentPositionInvalid &= ~InvalidX;
+	}
+
+	// Then we update the voxel pointer
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_currentVoxel += (intptr_t)offset;
+	} else {
+		_currentVoxel = nullptr;
+	}
+}
+
+template<class Derived>
+inline void RawVolume::SamplerBase<Derived>::movePositiveY(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.y += (int)offset;
+
+	if (!derived().region().containsPointInY(_posInVolume.y)) {
+		_currentPositionInvalid |= InvalidY;
+	} else {
+		_currentPositionInvalid &= ~InvalidY;
+	}
+
+	// Then we update the voxel pointer
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_currentVoxel += (intptr_t)(_volume->width() * offset);
+	} else {
+		_currentVoxel = nullptr;
+	}
+}
+
+template<class Derived>
+inline void RawVolume::SamplerBase<Derived>::movePositiveZ(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.z += (int)offset;
+
+	if (!derived().region().containsPointInZ(_posInVolume.z)) {
+		_currentPositionInvalid |= InvalidZ;
+	} else {
+		_currentPositionInvalid &= ~InvalidZ;
+	}
+
+	// Then we update the voxel pointer
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_currentVoxel += (intptr_t)(_volume->width() * _volume->height() * offset);
+	} else {
+		_currentVoxel = nullptr;
+	}
+}
+
+template<class Derived>
+inline void RawVolume::SamplerBase<Derived>::moveNegativeX(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.x -= (int)offset;
+
+	if (!derived().region().containsPointInX(_posInVolume.x)) {
+		_currentPositionInvalid |= InvalidX;
+	} else {
+		_currentPositionInvalid &= ~InvalidX;
+	}
+
+	// Then we update the voxel pointer
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_currentVoxel -= (intptr_t)offset;
+	} else {
+		_currentVoxel = nullptr;
+	}
+}
+
+template<class Derived>
+inline void RawVolume::SamplerBase<Derived>::moveNegativeY(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.y -= (int)offset;
+
+	if (!derived().region().containsPointInY(_posInVolume.y)) {
+		_currentPositionInvalid |= InvalidY;
+	} else {
+		_currentPositionInvalid &= ~InvalidY;
+	}
+
+	// Then we update the voxel pointer
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_currentVoxel -= (intptr_t)(_volume->width() * offset);
+	} else {
+		_currentVoxel = nullptr;
+	}
+}
+
+template<class Derived>
+inline void RawVolume::SamplerBase<Derived>::moveNegativeZ(uint32_t offset) {
+	const bool bIsOldPositionValid = currentPositionValid();
+
+	_posInVolume.z -= (int)offset;
+
+	if (!derived().region().containsPointInZ(_posInVolume.z)) {
+		_currentPositionInvalid |= InvalidZ;
+	} else {
+		_currentPositionInvalid &= ~InvalidZ;
+	}
+
+	// Then we update the voxel pointer
+	if (!bIsOldPositionValid) {
+		setPosition(_posInVolume);
+	} else if (currentPositionValid()) {
+		_currentVoxel -= (intptr_t)(_volume->width() * _volume->height() * offset);
+	} else {
+		_currentVoxel = nullptr;
+	}
+}
+
 #define CAN_GO_NEG_X(val) ((val) > region.getLowerX())
 #define CAN_GO_POS_X(val) ((val) < region.getUpperX())
 #define CAN_GO_NEG_Y(val) ((val) > region.getLowerY())
@@ -257,238 +570,265 @@ inline const Voxel& RawVolume::voxel(const glm::ivec3& pos) const {
 #define CAN_GO_NEG_Z(val) ((val) > region.getLowerZ())
 #define CAN_GO_POS_Z(val) ((val) < region.getUpperZ())
 
-inline const Region RawVolume::Sampler::region() const {
-	return _volume->region();
-}
-
-inline const glm::ivec3& RawVolume::Sampler::position() const {
+template<class Derived>
+inline const glm::ivec3& RawVolume::SamplerBase<Derived>::position() const {
 	return _posInVolume;
 }
 
-inline const Voxel& RawVolume::Sampler::voxel() const {
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::voxel() const {
 	if (this->currentPositionValid()) {
 		return *_currentVoxel;
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z);
 }
 
-inline bool RawVolume::Sampler::currentPositionValid() const {
+template<class Derived>
+inline bool RawVolume::SamplerBase<Derived>::currentPositionValid() const {
 	return !_currentPositionInvalid;
 }
 
-inline bool RawVolume::Sampler::setPosition(const glm::ivec3& v3dNewPos) {
+template<class Derived>
+inline bool RawVolume::SamplerBase<Derived>::setPosition(const glm::ivec3& v3dNewPos) {
 	return setPosition(v3dNewPos.x, v3dNewPos.y, v3dNewPos.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx1ny1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx1ny1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - 1 - region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx1ny0pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx1ny0pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y)) {
 		return *(_currentVoxel - 1 - region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx1ny1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx1ny1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y) && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - 1 - region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx0py1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx0py1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - 1 - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx0py0pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx0py0pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x)) {
 		return *(_currentVoxel - 1);
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx0py1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx0py1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - 1 + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y, this->_posInVolume.z + 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx1py1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx1py1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - 1 + region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx1py0pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx1py0pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y)) {
 		return *(_currentVoxel - 1 + region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1nx1py1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1nx1py1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y) && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - 1 + region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x - 1, this->_posInVolume.y + 1, this->_posInVolume.z + 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px1ny1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px1ny1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_Y(this->_posInVolume.y) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px1ny0pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px1ny0pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_Y(this->_posInVolume.y)) {
 		return *(_currentVoxel - region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px1ny1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px1ny1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_Y(this->_posInVolume.y) && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px0py1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px0py1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px0py0pz() const {
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px0py0pz() const {
 	if (this->currentPositionValid()) {
 		return *_currentVoxel;
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px0py1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px0py1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y, this->_posInVolume.z + 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px1py1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px1py1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_Y(this->_posInVolume.y) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px1py0pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px1py0pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_Y(this->_posInVolume.y)) {
 		return *(_currentVoxel + region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel0px1py1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel0px1py1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_Y(this->_posInVolume.y) && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x, this->_posInVolume.y + 1, this->_posInVolume.z + 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px1ny1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px1ny1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + 1 - region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px1ny0pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px1ny0pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y)) {
 		return *(_currentVoxel + 1 - region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px1ny1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px1ny1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_NEG_Y(this->_posInVolume.y) && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + 1 - region.getWidthInVoxels() + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y - 1, this->_posInVolume.z + 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px0py1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px0py1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + 1 - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px0py0pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px0py0pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x)) {
 		return *(_currentVoxel + 1);
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px0py1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px0py1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + 1 + region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y, this->_posInVolume.z + 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px1py1nz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px1py1nz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y) && CAN_GO_NEG_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + 1 + region.getWidthInVoxels() - region.stride());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y + 1, this->_posInVolume.z - 1);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px1py0pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px1py0pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y)) {
 		return *(_currentVoxel + 1 + region.getWidthInVoxels());
 	}
 	return this->_volume->voxel(this->_posInVolume.x + 1, this->_posInVolume.y + 1, this->_posInVolume.z);
 }
 
-inline const Voxel& RawVolume::Sampler::peekVoxel1px1py1pz() const {
-	const Region& region = this->region();
+template<class Derived>
+inline const Voxel& RawVolume::SamplerBase<Derived>::peekVoxel1px1py1pz() const {
+	const Region& region = derived().region();
 	if (this->currentPositionValid() && CAN_GO_POS_X(this->_posInVolume.x) && CAN_GO_POS_Y(this->_posInVolume.y) && CAN_GO_POS_Z(this->_posInVolume.z)) {
 		return *(_currentVoxel + 1 + region.getWidthInVoxels() + region.stride());
 	}
@@ -143,6 +143,51 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Fills the given region - cropped to the valid region of the wrapper - and marks it dirty
+	 * @sa RawVolume::fill()
+	 */
+	bool fill(const Region& region, const Voxel& voxel) {
+		Region cropped = region;
+		cropped.cropTo(_region);
+		if (!cropped.isValid()) {
+			return false;
+		}
+		addDirtyRegion(_volume->fill(cropped, voxel));
+		return true;
+	}
+
+	/**
+	 * @brief Copies the given source region into the valid region of the wrapper and marks the target region dirty
+	 * @sa RawVolume::copyRegion()
+	 */
+	bool copyRegion(const RawVolume& src, const Region& srcRegion, const glm::ivec3& dstPos, bool skipAir = false) {
+		Region target(dstPos, dstPos + srcRegion.getDimensionsInVoxels() - 1);
+		target.cropTo(_region);
+		if (!target.isValid()) {
+			return false;
+		}
+		const glm::ivec3& srcMins = srcRegion.getLowerCorner() + target.getLowerCorner() - dstPos;
+		const Region croppedSrc(srcMins, srcMins + target.getDimensionsInVoxels() - 1);
+		const Region& dirty = _volume->copyRegion(src, croppedSrc, target.getLowerCorner(), skipAir);
+		if (!dirty.isValid()) {
+			return false;
+		}
+		addDirtyRegion(dirty);
+		return true;
+	}
+
+	inline void addDirtyRegion(const Region& region) {
+		if (!region.isValid()) {
+			return;
+		}
+		if (_dirtyRegion.isValid()) {
+			_dirtyRegion.accumulate(region);
+		} else {
+			_dirtyRegion = region;
+		}
+	}
+
 	inline bool setVoxels(int x, int z, const Voxel* voxels, int amount) {
 		for (int y = 0; y < amount; ++y) {
 			setVoxel(x, y, z, voxels[y]);
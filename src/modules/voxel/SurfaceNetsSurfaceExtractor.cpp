@@ -0,0 +1,313 @@
+/**
+ * @file
+ */
+
+#include "SurfaceNetsSurfaceExtractor.h"
+#include "core/Assert.h"
+#include "core/Color.h"
+#include "core/GLM.h"
+#include "core/Memory.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+#include "voxel/VoxelVertex.h"
+#include <glm/common.hpp>
+#include <glm/gtx/norm.hpp>
+#include <glm/vec3.hpp>
+#include <stdint.h>
+
+namespace voxel {
+
+typedef core::Map<glm::vec3, IndexType, 1031, glm::hash<glm::vec3>> SeamMap;
+typedef core::Map<uint32_t, uint8_t, 64> BlendCache;
+
+/**
+ * @brief The corners of a cell - bit 0 is the x, bit 1 the y and bit 2 the z offset of the corner
+ */
+static constexpr int CellCorners = 8;
+
+static inline glm::vec3 cornerOffset(int corner) {
+	return glm::vec3((float)(corner & 1), (float)((corner >> 1) & 1), (float)((corner >> 2) & 1));
+}
+
+/**
+ * @brief The color of the vertex is blended from the solid voxels of the cell - see @c extractMarchingCubesMesh()
+ */
+static Voxel blendCorners(const Palette &palette, const Voxel *corners, BlendCache &cache) {
+	const Voxel *first = nullptr;
+	bool sameColor = true;
+	uint32_t r = 0, g = 0, b = 0, a = 0, n = 0;
+	for (int i = 0; i < CellCorners; ++i) {
+		if (isAir(corners[i].getMaterial())) {
+			continue;
+		}
+		if (first == nullptr) {
+			first = &corners[i];
+		} else if (first->getColor() != corners[i].getColor()) {
+			sameColor = false;
+		}
+		const core::RGBA color = palette.color(corners[i].getColor());
+		r += color.r;
+		g += color.g;
+		b += color.b;
+		a += color.a;
+		++n;
+	}
+	core_assert(first != nullptr);
+	if (sameColor) {
+		return *first;
+	}
+	const core::RGBA blended((uint8_t)(r / n), (uint8_t)(g / n), (uint8_t)(b / n), (uint8_t)(a / n));
+	uint8_t palIdx;
+	if (!cache.get(blended.rgba, palIdx)) {
+		palIdx = (uint8_t)palette.getClosestMatch(blended);
+		cache.put(blended.rgba, palIdx);
+	}
+	Voxel voxel = createVoxel(palette, palIdx);
+	voxel.setFlags(first->getFlags());
+	return voxel;
+}
+
+/**
+ * @brief Reads the voxels of one z slice of the cell corners
+ */
+static void readSlice(const RawVolume *volume, const glm::ivec3 &lower, int width, int height,
+					  core::DynamicArray<Voxel> &slice) {
+	RawVolume::DirectSampler sampler(volume);
+	for (int y = 0; y < height; ++y) {
+		sampler.setPosition(lower.x, lower.y + y, lower.z);
+		Voxel *row = &slice[y * width];
+		for (int x = 0; x < width; ++x) {
+			row[x] = sampler.voxel();
+			sampler.movePositiveX();
+		}
+	}
+}
+
+/**
+ * @brief Generates the vertices and quads for the given region - the vertex positions are relative to the given
+ * origin. The cells start one voxel below the region, their corners reach one voxel above it.
+ */
+static void extractSurfaceNetsMeshImpl(const RawVolume *volume, const Palette &palette, const Region &region,
+									   const glm::ivec3 &origin, ChunkMesh *result) {
+	result->clear();
+	Mesh &mesh = result->mesh[0];
+
+	const glm::ivec3 cellsLower = region.getLowerCorner() - 1;
+	const glm::ivec3 cells = region.getDimensionsInVoxels() + 1;
+	const int sliceWidth = cells.x + 1;
+	const int sliceHeight = cells.y + 1;
+	const glm::vec3 cellOrigin(cellsLower - origin);
+
+	// the corner voxels of the lower and upper side of the current cell slice
+	core::DynamicArray<Voxel> slices[2];
+	// the vertex index of every cell of the current and the previous cell slice - or -1 if the cell isn't crossed
+	core::DynamicArray<int32_t> vertexIndices[2];
+	for (int i = 0; i < 2; ++i) {
+		slices[i].resize(sliceWidth * sliceHeight);
+		vertexIndices[i].resize(cells.x * cells.y);
+	}
+	BlendCache blendCache;
+
+	readSlice(volume, cellsLower, sliceWidth, sliceHeight, slices[0]);
+	for (int cz = 0; cz < cells.z; ++cz) {
+		const core::DynamicArray<Voxel> &lowerSlice = slices[cz & 1];
+		core::DynamicArray<Voxel> &upperSlice = slices[(cz + 1) & 1];
+		readSlice(volume, glm::ivec3(cellsLower.x, cellsLower.y, cellsLower.z + cz + 1), sliceWidth, sliceHeight,
+				  upperSlice);
+		core::DynamicArray<int32_t> &currentIndices = vertexIndices[cz & 1];
+		const core::DynamicArray<int32_t> &previousIndices = vertexIndices[(cz + 1) & 1];
+
+		for (int cy = 0; cy < cells.y; ++cy) {
+			for (int cx = 0; cx < cells.x; ++cx) {
+				const int cellIdx = cx + cy * cells.x;
+				Voxel corners[CellCorners];
+				uint8_t mask = 0;
+				for (int i = 0; i < CellCorners; ++i) {
+					const core::DynamicArray<Voxel> &slice = (i & 4) ? upperSlice : lowerSlice;
+					corners[i] = slice[(cx + (i & 1)) + (cy + ((i >> 1) & 1)) * sliceWidth];
+					if (!isAir(corners[i].getMaterial())) {
+						mask |= 1 << i;
+					}
+				}
+				if (mask == 0 || mask == 0xFF) {
+					currentIndices[cellIdx] = -1;
+					continue;
+				}
+
+				// the vertex is the mean of the crossed edge midpoints - the normal points from the solid to the air
+				// corners
+				glm::vec3 position(0.0f);
+				glm::vec3 normal(0.0f);
+				int crossings = 0;
+				for (int i = 0; i < CellCorners; ++i) {
+					const bool solid = mask & (1 << i);
+					const glm::vec3 offset = cornerOffset(i);
+					normal += solid ? (0.5f - offset) : (offset - 0.5f);
+					for (int axis = 1; axis < CellCorners; axis <<= 1) {
+						if ((i & axis) != 0) {
+							continue;
+						}
+						if (solid != ((mask & (1 << (i | axis))) != 0)) {
+							position += (offset + cornerOffset(i | axis)) * 0.5f;
+							++crossings;
+						}
+					}
+				}
+				position /= (float)crossings;
+				const float normLen = glm::length2(normal);
+				if (normLen > 0.000001f) {
+					normal *= glm::inversesqrt(normLen);
+				}
+
+				const Voxel blendedVoxel = blendCorners(palette, corners, blendCache);
+				VoxelVertex surfaceVertex;
+				surfaceVertex.position = cellOrigin + glm::vec3((float)cx, (float)cy, (float)cz) + position;
+				surfaceVertex.colorIndex = blendedVoxel.getColor();
+				surfaceVertex.info = 0;
+				surfaceVertex.flags = blendedVoxel.getFlags();
+				const IndexType vertexIndex = mesh.addVertex(surfaceVertex);
+				mesh.setNormal(vertexIndex, normal);
+				currentIndices[cellIdx] = (int32_t)vertexIndex;
+
+				// the edges that start at the lower corner of the cell - only those inside of the region get a quad
+				if (cx == 0 || cy == 0 || cz == 0) {
+					continue;
+				}
+				const bool solid = mask & 1;
+				// x, y and z edge - the quad connects the four cells around the edge
+				for (int axis = 0; axis < 3; ++axis) {
+					if (solid == ((mask & (1 << axis)) != 0)) {
+						continue;
+					}
+					int32_t quad[4];
+					if (axis == 0) {
+						quad[0] = currentIndices[cellIdx];
+						quad[1] = currentIndices[cellIdx - cells.x];
+						quad[2] = previousIndices[cellIdx - cells.x];
+						quad[3] = previousIndices[cellIdx];
+					} else if (axis == 1) {
+						quad[0] = currentIndices[cellIdx];
+						quad[1] = previousIndices[cellIdx];
+						quad[2] = previousIndices[cellIdx - 1];
+						quad[3] = currentIndices[cellIdx - 1];
+					} else {
+						quad[0] = currentIndices[cellIdx];
+						quad[1] = currentIndices[cellIdx - 1];
+						quad[2] = currentIndices[cellIdx - 1 - cells.x];
+						quad[3] = currentIndices[cellIdx - cells.x];
+					}
+					core_assert(quad[0] != -1 && quad[1] != -1 && quad[2] != -1 && quad[3] != -1);
+					// counter clockwise around the normal - which points to the air voxel
+					if (solid) {
+						mesh.addTriangle(quad[0], quad[1], quad[2]);
+						mesh.addTriangle(quad[0], quad[2], quad[3]);
+					} else {
+						mesh.addTriangle(quad[0], quad[2], quad[1]);
+						mesh.addTriangle(quad[0], quad[3], quad[2]);
+					}
+				}
+			}
+		}
+	}
+}
+
+void extractSurfaceNetsMesh(const RawVolume *volume, const Palette &palette, const Region &region, ChunkMesh *result) {
+	core_memory_scope(Mesh);
+	core_assert_msg(volume != nullptr, "Provided volume cannot be null");
+	core_assert_msg(result != nullptr, "Provided mesh cannot be null");
+
+	extractSurfaceNetsMeshImpl(volume, palette, region, region.getLowerCorner(), result);
+
+	result->setOffset(region.getLowerCorner());
+	result->removeUnusedVertices();
+	result->compressIndices();
+}
+
+void extractSurfaceNetsMeshParallel(core::ThreadPool &threadPool, const RawVolume *volume, const Palette &palette,
+									const Region &region, ChunkMesh *result, int sliceDepth) {
+	core_memory_scope(Mesh);
+	core_assert_msg(volume != nullptr, "Provided volume cannot be null");
+	core_assert_msg(result != nullptr, "Provided mesh cannot be null");
+	core_assert_msg(sliceDepth > 0, "Slice depth must be greater than zero");
+
+	const int32_t lowerZ = region.getLowerZ();
+	const int32_t upperZ = region.getUpperZ();
+	if (upperZ - lowerZ < sliceDepth) {
+		extractSurfaceNetsMesh(volume, palette, region, result);
+		return;
+	}
+
+	// the slabs don't overlap - but the cells between two slabs are generated by both of them. The vertex positions
+	// are relative to the lower corner of the whole region, so the vertices of these cells are equal and merged below.
+	core::DynamicArray<Region> slabs;
+	for (int32_t z = lowerZ; z <= upperZ; z += sliceDepth) {
+		Region slab = region;
+		slab.setLowerZ(z);
+		slab.setUpperZ(glm::min(z + sliceDepth - 1, upperZ));
+		slabs.push_back(slab);
+	}
+
+	const glm::ivec3 &origin = region.getLowerCorner();
+	const size_t n = slabs.size();
+	core::DynamicArray<ChunkMesh> slabMeshes;
+	slabMeshes.resize(n);
+	core::DynamicArray<std::future<void>> futures;
+	futures.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		futures.emplace_back(threadPool.enqueue([volume, &palette, &slabs, &slabMeshes, &origin, i]() {
+			extractSurfaceNetsMeshImpl(volume, palette, slabs[i], origin, &slabMeshes[i]);
+		}));
+	}
+	for (std::future<void> &f : futures) {
+		f.get();
+	}
+
+	result->clear();
+	Mesh &target = result->mesh[0];
+	// the vertices of the upper cell slice of the previous and the current slab - used to stitch the seams
+	SeamMap seams[2];
+	core::DynamicArray<IndexType> remap;
+	for (size_t i = 0; i < n; ++i) {
+		const Mesh &slabMesh = slabMeshes[i].mesh[0];
+		// the cells of the seams are between the last voxel slice of the lower and the first one of the upper slab
+		const float seamZ = (float)(slabs[i].getLowerZ() - lowerZ);
+		const float nextSeamZ = (float)(slabs[i].getUpperZ() - lowerZ);
+		const VertexArray &vertices = slabMesh.getVertexVector();
+		const NormalArray &normals = slabMesh.getNormalVector();
+		remap.resize(vertices.size());
+		const SeamMap &previousSeam = seams[(i + 1) & 1];
+		SeamMap &currentSeam = seams[i & 1];
+		currentSeam.clear();
+		for (size_t v = 0; v < vertices.size(); ++v) {
+			const VoxelVertex &vertex = vertices[v];
+			IndexType idx;
+			if (i > 0 && vertex.position.z < seamZ && previousSeam.get(vertex.position, idx)) {
+				remap[v] = idx;
+				continue;
+			}
+			idx = target.addVertex(vertex);
+			if (v < normals.size()) {
+				target.setNormal(idx, normals[v]);
+			}
+			remap[v] = idx;
+			if (vertex.position.z > nextSeamZ) {
+				currentSeam.put(vertex.position, idx);
+			}
+		}
+		const IndexArray &indices = slabMesh.getIndexVector();
+		for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+			target.addTriangle(remap[indices[t + 0]], remap[indices[t + 1]], remap[indices[t + 2]]);
+		}
+	}
+
+	result->setOffset(region.getLowerCorner());
+	result->removeUnusedVertices();
+	result->compressIndices();
+}
+
+} // namespace voxel
@@ -0,0 +1,40 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxel {
+
+class RawVolume;
+class Region;
+struct ChunkMesh;
+class Palette;
+
+/**
+ * @brief Naive surface nets - one vertex per cell of 2x2x2 voxels that is crossed by the surface and one quad per
+ * voxel edge between a solid and an air voxel
+ *
+ * This produces a smooth surface like @c extractMarchingCubesMesh() - but with far fewer triangles and without any
+ * table lookups. The colors of the vertices are blended from the solid voxels of the cell.
+ *
+ * The quads are generated for the voxel edges that start inside of the given region - the voxels around the region
+ * are sampled, too. To polygonize a whole volume, the lower corner of its region must be moved by @c -1 to also get
+ * the faces to the lower neighbours. The vertex positions are relative to the lower corner of the region.
+ */
+void extractSurfaceNetsMesh(const RawVolume *volume, const Palette &palette, const Region &region, ChunkMesh *result);
+
+/**
+ * @brief Splits the region into slabs of @c sliceDepth voxels along the z axis and extracts them on the given thread
+ * pool. The vertices of the cells on the slab seams are merged - the result is the same surface that
+ * @c extractSurfaceNetsMesh() would produce.
+ * @note Don't call this from a task of the same thread pool - it blocks until all slabs are extracted.
+ */
+void extractSurfaceNetsMeshParallel(core::ThreadPool &threadPool, const RawVolume *volume, const Palette &palette,
+									const Region &region, ChunkMesh *result, int sliceDepth = 32);
+
+} // namespace voxel
@@ -39,6 +39,10 @@ static_assert(lengthof(VoxelTypeStr) == (int)VoxelType::Max, "voxel type string
  */
 extern VoxelType getVoxelType(const char *str);
 
+/**
+ * @brief A voxel is packed into one 16 bit word: 5 bits material, 3 bits flags and the 8 bit palette color index.
+ * The volumes store this layout directly.
+ */
 class Voxel {
 public:
 	constexpr inline Voxel() :
@@ -116,6 +120,7 @@ private:
 	uint8_t _flags:3;
 	uint8_t _colorIndex;
 };
+static_assert(sizeof(Voxel) == 2, "The voxel is expected to fit into 16 bits");
 
 constexpr Voxel createVoxel(VoxelType type, uint8_t colorIndex) {
 	return Voxel(type, colorIndex);
@@ -6,6 +6,7 @@
 
 #include "Voxel.h"
 #include <glm/vec3.hpp>
+#include <stdint.h>
 
 namespace voxel {
 
@@ -28,6 +29,43 @@ struct VoxelVertex {
 };
 static_assert(sizeof(VoxelVertex) == 16, "Unexpected size of the vertex struct");
 
+/**
+ * @brief Compact gpu representation of a VoxelVertex with integral positions - like the ones of the cubic
+ * surface extractor. The vertex fetch converts the position components to float again.
+ * @sa packVertex()
+ */
+struct PackedVoxelVertex {
+	int16_t x;
+	int16_t y;
+	int16_t z;
+	/** @sa VoxelVertex::info */
+	uint8_t info;
+	uint8_t colorIndex;
+};
+static_assert(sizeof(PackedVoxelVertex) == 8, "Unexpected size of the packed vertex struct");
+
+/**
+ * @return @c true if the given vertex position can be stored in a PackedVoxelVertex
+ */
+inline bool fitsPackedVertex(const glm::ivec3 &pos) {
+	return pos.x >= INT16_MIN && pos.x <= INT16_MAX && pos.y >= INT16_MIN && pos.y <= INT16_MAX &&
+		   pos.z >= INT16_MIN && pos.z <= INT16_MAX;
+}
+
+/**
+ * @note The position must be integral and fit into 16 bit
+ * @sa fitsPackedVertex()
+ */
+inline PackedVoxelVertex packVertex(const VoxelVertex &vertex) {
+	PackedVoxelVertex packed;
+	packed.x = (int16_t)vertex.position.x;
+	packed.y = (int16_t)vertex.position.y;
+	packed.z = (int16_t)vertex.position.z;
+	packed.info = vertex.info;
+	packed.colorIndex = vertex.colorIndex;
+	return packed;
+}
+
 // TODO: maybe reduce to uint16_t and use glDrawElementsBaseVertex
 typedef uint32_t IndexType;
 
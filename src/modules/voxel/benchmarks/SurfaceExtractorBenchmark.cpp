@@ -0,0 +1,234 @@
+/**
+ * @file
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/SharedPtr.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/MarchingCubesSurfaceExtractor.h"
+#include "voxel/PagedVolume.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxel/SurfaceNetsSurfaceExtractor.h"
+#include <glm/geometric.hpp>
+#include <glm/gtc/noise.hpp>
+
+enum Dataset { DatasetTerrain, DatasetHollowShell, DatasetCharacter, DatasetMax };
+
+class SurfaceExtractorBenchmark : public app::AbstractBenchmark {
+protected:
+	core::SharedPtr<voxel::RawVolume> _volumes[DatasetMax];
+	/** the same datasets in the brick layout */
+	core::SharedPtr<voxel::PagedVolume> _pagedVolumes[DatasetMax];
+	voxel::Palette _palette;
+
+	static core::SharedPtr<voxel::RawVolume> createTerrain() {
+		const voxel::Region region(glm::ivec3(0), glm::ivec3(127, 63, 127));
+		core::SharedPtr<voxel::RawVolume> v = core::make_shared<voxel::RawVolume>(region);
+		for (int x = 0; x <= region.getUpperX(); ++x) {
+			for (int z = 0; z <= region.getUpperZ(); ++z) {
+				const float n = glm::simplex(glm::vec2(x, z) * 0.02f) * 0.5f + 0.5f;
+				const int h = (int)(n * (float)region.getUpperY());
+				for (int y = 0; y <= h; ++y) {
+					v->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, y % 8));
+				}
+			}
+		}
+		return v;
+	}
+
+	static core::SharedPtr<voxel::RawVolume> createHollowShell() {
+		const voxel::Region region(0, 127);
+		core::SharedPtr<voxel::RawVolume> v = core::make_shared<voxel::RawVolume>(region);
+		const glm::vec3 center(region.getCenter());
+		for (int x = 0; x <= region.getUpperX(); ++x) {
+			for (int y = 0; y <= region.getUpperY(); ++y) {
+				for (int z = 0; z <= region.getUpperZ(); ++z) {
+					const float d = glm::distance(glm::vec3(x, y, z), center);
+					if (d >= 58.0f && d <= 60.0f) {
+						v->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+					}
+				}
+			}
+		}
+		return v;
+	}
+
+	static void fillBox(voxel::RawVolume &v, const glm::ivec3 &mins, const glm::ivec3 &maxs, uint8_t color) {
+		for (int x = mins.x; x <= maxs.x; ++x) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int z = mins.z; z <= maxs.z; ++z) {
+					v.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+
+	/**
+	 * @brief A small blocky figure with the footprint of a typical character model - many small parts with
+	 * different colors instead of large homogeneous areas
+	 */
+	static core::SharedPtr<voxel::RawVolume> createCharacter() {
+		const voxel::Region region(glm::ivec3(-9, 0, -7), glm::ivec3(8, 31, 6));
+		core::SharedPtr<voxel::RawVolume> v = core::make_shared<voxel::RawVolume>(region);
+		// feet and legs
+		fillBox(*v.get(), glm::ivec3(-4, 0, -2), glm::ivec3(-1, 1, 3), 1);
+		fillBox(*v.get(), glm::ivec3(1, 0, -2), glm::ivec3(4, 1, 3), 1);
+		fillBox(*v.get(), glm::ivec3(-4, 2, -2), glm::ivec3(-1, 11, 1), 2);
+		fillBox(*v.get(), glm::ivec3(1, 2, -2), glm::ivec3(4, 11, 1), 2);
+		// torso with a belt
+		fillBox(*v.get(), glm::ivec3(-5, 12, -3), glm::ivec3(5, 13, 2), 3);
+		fillBox(*v.get(), glm::ivec3(-5, 14, -3), glm::ivec3(5, 22, 2), 4);
+		// arms and hands
+		fillBox(*v.get(), glm::ivec3(-8, 13, -2), glm::ivec3(-6, 22, 1), 4);
+		fillBox(*v.get(), glm::ivec3(6, 13, -2), glm::ivec3(8, 22, 1), 4);
+		fillBox(*v.get(), glm::ivec3(-8, 10, -2), glm::ivec3(-6, 12, 1), 5);
+		fillBox(*v.get(), glm::ivec3(6, 10, -2), glm::ivec3(8, 12, 1), 5);
+		// head with eyes and hair
+		fillBox(*v.get(), glm::ivec3(-4, 23, -4), glm::ivec3(4, 30, 4), 5);
+		fillBox(*v.get(), glm::ivec3(-4, 31, -4), glm::ivec3(4, 31, 4), 6);
+		fillBox(*v.get(), glm::ivec3(-4, 24, 5), glm::ivec3(4, 31, 6), 6);
+		v->setVoxel(-2, 27, -4, voxel::createVoxel(voxel::VoxelType::Generic, 7));
+		v->setVoxel(2, 27, -4, voxel::createVoxel(voxel::VoxelType::Generic, 7));
+		// carve a few holes to break up the large faces
+		for (int y = 14; y <= 22; y += 2) {
+			v->setVoxel(0, y, -3, voxel::Voxel());
+		}
+		return v;
+	}
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		_palette.nippon();
+		_volumes[DatasetTerrain] = createTerrain();
+		_volumes[DatasetHollowShell] = createHollowShell();
+		_volumes[DatasetCharacter] = createCharacter();
+		for (int i = 0; i < DatasetMax; ++i) {
+			_pagedVolumes[i] = core::make_shared<voxel::PagedVolume>(*_volumes[i].get());
+		}
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		for (int i = 0; i < DatasetMax; ++i) {
+			_volumes[i] = core::SharedPtr<voxel::RawVolume>();
+			_pagedVolumes[i] = core::SharedPtr<voxel::PagedVolume>();
+		}
+		app::AbstractBenchmark::TearDown(state);
+	}
+
+	static size_t triangles(const voxel::ChunkMesh &mesh) {
+		size_t n = 0;
+		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+			n += mesh.mesh[i].getNoOfIndices() / 3;
+		}
+		return n;
+	}
+
+	static void report(::benchmark::State &state, const voxel::RawVolume &v, size_t triangles) {
+		const voxel::Region &region = v.region();
+		const double voxels = (double)region.getWidthInVoxels() * region.getHeightInVoxels() * region.getDepthInVoxels();
+		state.counters["voxels"] = benchmark::Counter(voxels, benchmark::Counter::kIsIterationInvariantRate);
+		state.counters["triangles"] = (double)triangles;
+	}
+};
+
+/**
+ * range(0): the dataset
+ * range(1): bitmask for merge quads (1), reuse vertices (2) and ambient occlusion (4)
+ */
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractCubicMesh)(benchmark::State &state) {
+	const voxel::RawVolume &v = *_volumes[state.range(0)].get();
+	const bool mergeQuads = (state.range(1) & 1) != 0;
+	const bool reuseVertices = (state.range(1) & 2) != 0;
+	const bool ambientOcclusion = (state.range(1) & 4) != 0;
+	size_t n = 0;
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh(65536, 65536, true);
+		voxel::extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0), mergeQuads, reuseVertices, ambientOcclusion);
+		n = triangles(mesh);
+		benchmark::DoNotOptimize(n);
+	}
+	report(state, v, n);
+}
+
+/**
+ * @brief The same extraction as @c ExtractCubicMesh - but the sampler walks the brick layout of the paged volume
+ */
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractCubicMeshPaged)(benchmark::State &state) {
+	const voxel::PagedVolume &v = *_pagedVolumes[state.range(0)].get();
+	const bool mergeQuads = (state.range(1) & 1) != 0;
+	const bool reuseVertices = (state.range(1) & 2) != 0;
+	const bool ambientOcclusion = (state.range(1) & 4) != 0;
+	size_t n = 0;
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh(65536, 65536, true);
+		voxel::extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0), mergeQuads, reuseVertices, ambientOcclusion);
+		n = triangles(mesh);
+		benchmark::DoNotOptimize(n);
+	}
+	report(state, *_volumes[state.range(0)].get(), n);
+}
+
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractMarchingCubesMesh)(benchmark::State &state) {
+	const voxel::RawVolume &v = *_volumes[state.range(0)].get();
+	size_t n = 0;
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh(65536, 65536, true);
+		voxel::extractMarchingCubesMesh(&v, _palette, v.region(), &mesh);
+		n = triangles(mesh);
+		benchmark::DoNotOptimize(n);
+	}
+	report(state, v, n);
+}
+
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, ExtractSurfaceNetsMesh)(benchmark::State &state) {
+	const voxel::RawVolume &v = *_volumes[state.range(0)].get();
+	voxel::Region region = v.region();
+	region.setLowerCorner(region.getLowerCorner() - 1);
+	size_t n = 0;
+	for (auto _ : state) {
+		voxel::ChunkMesh mesh(65536, 65536, true);
+		voxel::extractSurfaceNetsMesh(&v, _palette, region, &mesh);
+		n = triangles(mesh);
+		benchmark::DoNotOptimize(n);
+	}
+	report(state, v, n);
+}
+
+BENCHMARK_DEFINE_F(SurfaceExtractorBenchmark, CompressIndices)(benchmark::State &state) {
+	const voxel::RawVolume &v = *_volumes[state.range(0)].get();
+	voxel::ChunkMesh source(65536, 65536, true);
+	voxel::extractCubicMesh(&v, v.region(), &source, glm::ivec3(0));
+	for (auto _ : state) {
+		voxel::Mesh mesh(source.mesh[0]);
+		mesh.compressIndices();
+		benchmark::DoNotOptimize(mesh.compressedIndexSize());
+	}
+	report(state, v, triangles(source));
+}
+
+static void cubicMeshArguments(benchmark::internal::Benchmark *b) {
+	for (int dataset = 0; dataset < DatasetMax; ++dataset) {
+		for (int flags : {0, 1, 3, 7}) {
+			b->Args({dataset, flags});
+		}
+	}
+}
+
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractCubicMesh)
+	->Apply(cubicMeshArguments)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractCubicMeshPaged)
+	->Apply(cubicMeshArguments)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractMarchingCubesMesh)
+	->DenseRange(0, DatasetMax - 1)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, ExtractSurfaceNetsMesh)
+	->DenseRange(0, DatasetMax - 1)
+	->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(SurfaceExtractorBenchmark, CompressIndices)->DenseRange(0, DatasetMax - 1);
+
+BENCHMARK_MAIN();
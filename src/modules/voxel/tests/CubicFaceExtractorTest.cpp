@@ -0,0 +1,70 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/CubicFaceExtractor.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class CubicFaceExtractorTest : public AbstractVoxelTest {};
+
+TEST_F(CubicFaceExtractorTest, testSingleVoxel) {
+	RawVolume v(Region(0, 3));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Generic, 42));
+	ChunkFaces faces;
+	extractCubicFaces(&v, v.region(), &faces);
+	ASSERT_EQ(6u, faces.faces[0].size());
+	EXPECT_TRUE(faces.faces[1].empty());
+	for (size_t i = 0; i < faces.faces[0].size(); ++i) {
+		const VoxelFace &face = faces.faces[0][i];
+		EXPECT_EQ(i, face.face);
+		EXPECT_EQ(42, face.colorIndex);
+		EXPECT_EQ(glm::ivec3(1), glm::ivec3(face.x, face.y, face.z));
+		for (int corner = 0; corner < 4; ++corner) {
+			EXPECT_EQ(3, face.cornerAmbientOcclusion(corner));
+		}
+	}
+}
+
+TEST_F(CubicFaceExtractorTest, testSingleTransparentVoxel) {
+	RawVolume v(Region(0, 3));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Transparent, 1));
+	ChunkFaces faces;
+	extractCubicFaces(&v, v.region(), &faces);
+	EXPECT_TRUE(faces.faces[0].empty());
+	EXPECT_EQ(6u, faces.faces[1].size());
+}
+
+TEST_F(CubicFaceExtractorTest, testHiddenFaces) {
+	RawVolume v(Region(0, 3));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(2, 1, 1, voxel::createVoxel(VoxelType::Generic, 1));
+	ChunkFaces faces;
+	extractCubicFaces(&v, v.region(), &faces);
+	EXPECT_EQ(10u, faces.faces[0].size());
+}
+
+TEST_F(CubicFaceExtractorTest, testAmbientOcclusion) {
+	RawVolume v(Region(0, 3));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Generic, 1));
+	// occludes the two upper corners of the positive x side of the voxel below
+	v.setVoxel(2, 2, 1, voxel::createVoxel(VoxelType::Generic, 1));
+	ChunkFaces faces;
+	extractCubicFaces(&v, Region(1, 1), &faces);
+	bool found = false;
+	for (const VoxelFace &face : faces.faces[0]) {
+		if (face.face != core::enumVal(FaceNames::PositiveX)) {
+			continue;
+		}
+		found = true;
+		for (int corner = 0; corner < 4; ++corner) {
+			const glm::ivec3 &offset = faceCorner(FaceNames::PositiveX, corner);
+			EXPECT_EQ(offset.y == 1 ? 2 : 3, face.cornerAmbientOcclusion(corner)) << "corner " << corner;
+		}
+	}
+	EXPECT_TRUE(found);
+}
+
+}
@@ -0,0 +1,81 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class CubicSurfaceExtractorTest : public AbstractVoxelTest {};
+
+TEST_F(CubicSurfaceExtractorTest, testSingleVoxel) {
+	RawVolume v(Region(0, 3));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Generic, 1));
+	ChunkMesh mesh;
+	extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0));
+	EXPECT_EQ(36u, mesh.mesh[0].getNoOfIndices());
+	EXPECT_EQ(8u, mesh.mesh[0].getNoOfVertices());
+	EXPECT_TRUE(mesh.mesh[1].isEmpty());
+}
+
+TEST_F(CubicSurfaceExtractorTest, testSingleTransparentVoxel) {
+	RawVolume v(Region(0, 3));
+	v.setVoxel(1, 1, 1, voxel::createVoxel(VoxelType::Transparent, 1));
+	ChunkMesh mesh;
+	extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0));
+	EXPECT_TRUE(mesh.mesh[0].isEmpty());
+	EXPECT_EQ(36u, mesh.mesh[1].getNoOfIndices());
+}
+
+TEST_F(CubicSurfaceExtractorTest, testPackVertex) {
+	RawVolume v(Region(-5, -2));
+	v.setVoxel(-4, -3, -4, voxel::createVoxel(VoxelType::Generic, 42));
+	ChunkMesh mesh;
+	extractCubicMesh(&v, v.region(), &mesh, v.region().getLowerCorner());
+	ASSERT_FALSE(mesh.mesh[0].isEmpty());
+	for (const VoxelVertex &vertex : mesh.mesh[0].getVertexVector()) {
+		const PackedVoxelVertex &packed = packVertex(vertex);
+		EXPECT_EQ(vertex.position, glm::vec3(packed.x, packed.y, packed.z));
+		EXPECT_EQ(vertex.info, packed.info);
+		EXPECT_EQ(42, packed.colorIndex);
+	}
+}
+
+TEST_F(CubicSurfaceExtractorTest, testFitsPackedVertex) {
+	EXPECT_TRUE(fitsPackedVertex(glm::ivec3(-32768, 0, 32767)));
+	EXPECT_FALSE(fitsPackedVertex(glm::ivec3(32768, 0, 0)));
+	EXPECT_FALSE(fitsPackedVertex(glm::ivec3(0, -32769, 0)));
+	EXPECT_FALSE(fitsPackedVertex(glm::ivec3(0, 0, 40000)));
+}
+
+TEST_F(CubicSurfaceExtractorTest, testTallColumn) {
+	// the column is higher than one occupancy mask word
+	RawVolume v(Region(glm::ivec3(0), glm::ivec3(3, 150, 3)));
+	for (int y = 0; y < 140; ++y) {
+		v.setVoxel(1, y + 5, 1, voxel::createVoxel(VoxelType::Generic, 1));
+	}
+	ChunkMesh mesh;
+	extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0));
+	EXPECT_EQ(36u, mesh.mesh[0].getNoOfIndices());
+	EXPECT_EQ(8u, mesh.mesh[0].getNoOfVertices());
+}
+
+TEST_F(CubicSurfaceExtractorTest, testFullyEnclosedVoxelsProduceNoQuads) {
+	RawVolume v(Region(0, 9));
+	for (int x = 0; x <= 9; ++x) {
+		for (int y = 0; y <= 9; ++y) {
+			for (int z = 0; z <= 9; ++z) {
+				v.setVoxel(x, y, z, voxel::createVoxel(VoxelType::Generic, 1));
+			}
+		}
+	}
+	ChunkMesh mesh;
+	// the extraction region is completely inside the solid volume
+	extractCubicMesh(&v, Region(2, 7), &mesh, glm::ivec3(0));
+	EXPECT_TRUE(mesh.isEmpty());
+}
+
+}
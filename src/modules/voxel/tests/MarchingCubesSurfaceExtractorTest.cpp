@@ -0,0 +1,52 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/MarchingCubesSurfaceExtractor.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include <glm/geometric.hpp>
+
+namespace voxel {
+
+class MarchingCubesSurfaceExtractorTest : public AbstractVoxelTest {};
+
+TEST_F(MarchingCubesSurfaceExtractorTest, testParallelExtractionMatchesSerial) {
+	const Region region(0, 39);
+	RawVolume v(region);
+	const glm::vec3 center(region.getCenter());
+	for (int32_t z = 0; z <= 39; ++z) {
+		for (int32_t y = 0; y <= 39; ++y) {
+			for (int32_t x = 0; x <= 39; ++x) {
+				if (glm::distance(center, glm::vec3(x, y, z)) < 15.0f) {
+					v.setVoxel(x, y, z, createVoxel(VoxelType::Generic, 1));
+				}
+			}
+		}
+	}
+	Palette palette;
+	palette.nippon();
+
+	Region extractRegion = region;
+	extractRegion.shrink(-1);
+
+	ChunkMesh serial;
+	extractMarchingCubesMesh(&v, palette, extractRegion, &serial);
+	ASSERT_FALSE(serial.isEmpty());
+
+	core::ThreadPool threadPool(2, "MarchingCubesTest");
+	threadPool.init();
+	ChunkMesh parallel;
+	// a slice depth that doesn't divide the region evenly
+	extractMarchingCubesMeshParallel(threadPool, &v, palette, extractRegion, &parallel, 7);
+	EXPECT_EQ(serial.mesh[0].getNoOfIndices(), parallel.mesh[0].getNoOfIndices());
+	EXPECT_EQ(serial.mesh[0].getNoOfVertices(), parallel.mesh[0].getNoOfVertices())
+		<< "The vertices on the slab seams should be merged";
+	EXPECT_EQ(serial.mesh[0].getOffset(), parallel.mesh[0].getOffset());
+	threadPool.shutdown();
+}
+
+} // namespace voxel
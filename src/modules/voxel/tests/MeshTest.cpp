@@ -0,0 +1,210 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class MeshTest : public AbstractVoxelTest {
+protected:
+	/**
+	 * @return The amount of vertex cache misses of a fifo cache
+	 */
+	int cacheMisses(const Mesh &mesh, int cacheSize = 16) const {
+		core::DynamicArray<IndexType> cache;
+		int misses = 0;
+		for (IndexType idx : mesh.getIndexVector()) {
+			bool found = false;
+			for (IndexType cached : cache) {
+				if (cached == idx) {
+					found = true;
+					break;
+				}
+			}
+			if (found) {
+				continue;
+			}
+			++misses;
+			cache.push_back(idx);
+			if ((int)cache.size() > cacheSize) {
+				cache.erase(0, 1);
+			}
+		}
+		return misses;
+	}
+
+	void fillVolume(RawVolume &v) const {
+		const Region &region = v.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					// checkerboard - to prevent merged quads
+					if ((x + y + z) % 2 == 0) {
+						v.setVoxel(x, y, z, createVoxel(VoxelType::Generic, (x + z) % 255 + 1));
+					}
+				}
+			}
+		}
+	}
+
+	void expectSameQuads(const Mesh &expected, const Mesh &actual, int primitiveIndices) const {
+		ASSERT_EQ(expected.getNoOfIndices(), actual.getNoOfIndices());
+		const size_t n = expected.getNoOfIndices();
+		// every primitive of the optimized mesh must exist in the source mesh
+		core::DynamicArray<bool> matched(n / primitiveIndices);
+		matched.fill(false);
+		for (size_t i = 0; i < n; i += primitiveIndices) {
+			bool found = false;
+			for (size_t j = 0; j < n && !found; j += primitiveIndices) {
+				if (matched[j / primitiveIndices]) {
+					continue;
+				}
+				bool same = true;
+				for (int k = 0; k < primitiveIndices && same; ++k) {
+					const VoxelVertex &a = actual.getVertex(actual.getIndex((IndexType)(i + k)));
+					const VoxelVertex &b = expected.getVertex(expected.getIndex((IndexType)(j + k)));
+					same = a.position == b.position && a.colorIndex == b.colorIndex;
+				}
+				if (same) {
+					matched[j / primitiveIndices] = true;
+					found = true;
+				}
+			}
+			ASSERT_TRUE(found) << "primitive " << i / primitiveIndices << " not found";
+		}
+	}
+};
+
+TEST_F(MeshTest, testOptimizeTriangles) {
+	RawVolume v(Region(0, 5));
+	fillVolume(v);
+	ChunkMesh mesh;
+	extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0), false, true);
+	const Mesh source = mesh.mesh[0];
+	ASSERT_FALSE(source.isEmpty());
+	mesh.mesh[0].optimize(3);
+	const Mesh &optimized = mesh.mesh[0];
+	EXPECT_LE(optimized.getNoOfVertices(), source.getNoOfVertices());
+	EXPECT_LE(cacheMisses(optimized), cacheMisses(source));
+	expectSameQuads(source, optimized, 3);
+}
+
+TEST_F(MeshTest, testOptimizeQuads) {
+	RawVolume v(Region(0, 5));
+	fillVolume(v);
+	ChunkMesh mesh;
+	extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0), false, true);
+	const Mesh source = mesh.mesh[0];
+	ASSERT_FALSE(source.isEmpty());
+	mesh.mesh[0].optimize(6);
+	const Mesh &optimized = mesh.mesh[0];
+	EXPECT_LE(cacheMisses(optimized), cacheMisses(source));
+	// the two triangles of each quad are still next to each other
+	expectSameQuads(source, optimized, 6);
+}
+
+TEST_F(MeshTest, testOptimizeFirstUseOrder) {
+	RawVolume v(Region(0, 3));
+	v.setVoxel(1, 1, 1, createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(2, 2, 2, createVoxel(VoxelType::Generic, 1));
+	ChunkMesh mesh;
+	extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0));
+	mesh.mesh[0].optimize();
+	// the vertices are numbered in the order of their first use
+	IndexType next = 0;
+	for (IndexType idx : mesh.mesh[0].getIndexVector()) {
+		ASSERT_LE(idx, next);
+		if (idx == next) {
+			++next;
+		}
+	}
+	EXPECT_EQ((size_t)next, mesh.mesh[0].getNoOfVertices());
+}
+
+TEST_F(MeshTest, testSimplify) {
+	// a slab with two colors - without merged quads
+	RawVolume v(Region(glm::ivec3(0), glm::ivec3(15, 1, 15)));
+	const Region &region = v.region();
+	for (int z = 0; z <= region.getUpperZ(); ++z) {
+		for (int y = 0; y <= region.getUpperY(); ++y) {
+			for (int x = 0; x <= region.getUpperX(); ++x) {
+				v.setVoxel(x, y, z, createVoxel(VoxelType::Generic, x < 8 ? 1 : 2));
+			}
+		}
+	}
+	ChunkMesh mesh;
+	Region extractRegion = region;
+	extractRegion.shiftUpperCorner(1, 1, 1);
+	extractCubicMesh(&v, extractRegion, &mesh, glm::ivec3(0), false, true, false);
+	const size_t triangles = mesh.mesh[0].getNoOfIndices() / 3u;
+	ASSERT_GT(triangles, 0u);
+
+	// the flat faces can be simplified without any error
+	mesh.mesh[0].simplify(0u, 0.001f);
+	const Mesh &simplified = mesh.mesh[0];
+	EXPECT_LT(simplified.getNoOfIndices() / 3u, triangles / 10u);
+	bool colors[3]{false, false, false};
+	for (size_t i = 0; i < simplified.getNoOfIndices(); i += 3) {
+		const VoxelVertex &v0 = simplified.getVertex(simplified.getIndex((IndexType)i));
+		for (int j = 0; j < 3; ++j) {
+			const VoxelVertex &vertex = simplified.getVertex(simplified.getIndex((IndexType)(i + j)));
+			// the vertices are not moved out of the slab and the triangles keep their color
+			EXPECT_EQ(v0.colorIndex, vertex.colorIndex);
+			EXPECT_TRUE(vertex.position.y == 0.0f || vertex.position.y == 2.0f) << vertex.position.y;
+			EXPECT_GE(vertex.position.x, 0.0f);
+			EXPECT_LE(vertex.position.x, 16.0f);
+			EXPECT_GE(vertex.position.z, 0.0f);
+			EXPECT_LE(vertex.position.z, 16.0f);
+		}
+		ASSERT_LT(v0.colorIndex, 3);
+		colors[v0.colorIndex] = true;
+	}
+	EXPECT_TRUE(colors[1]);
+	EXPECT_TRUE(colors[2]);
+}
+
+TEST_F(MeshTest, testSimplifyTargetTriangles) {
+	RawVolume v(Region(0, 7));
+	fillVolume(v);
+	ChunkMesh mesh;
+	extractCubicMesh(&v, v.region(), &mesh, glm::ivec3(0), false, true);
+	const size_t triangles = mesh.mesh[0].getNoOfIndices() / 3u;
+	ASSERT_GT(triangles, 0u);
+	// the checkerboard has no faces with the same color that could get collapsed without an error
+	mesh.mesh[0].simplify(triangles / 2u, 0.0f);
+	EXPECT_EQ(triangles, mesh.mesh[0].getNoOfIndices() / 3u);
+	mesh.mesh[0].simplify(0u, 0.0f);
+	EXPECT_EQ(triangles, mesh.mesh[0].getNoOfIndices() / 3u);
+}
+
+TEST_F(MeshTest, testSortBackToFront) {
+	Mesh mesh(12, 12);
+	for (int z : {1, 3, 2, 0}) {
+		VoxelVertex vertex;
+		vertex.position = glm::vec3(0.0f, 0.0f, (float)z);
+		const IndexType i0 = mesh.addVertex(vertex);
+		vertex.position.x = 1.0f;
+		const IndexType i1 = mesh.addVertex(vertex);
+		vertex.position.y = 1.0f;
+		const IndexType i2 = mesh.addVertex(vertex);
+		mesh.addTriangle(i0, i1, i2);
+	}
+	const glm::vec3 eye(0.0f, 0.0f, -10.0f);
+	EXPECT_TRUE(mesh.sort(eye));
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_FLOAT_EQ((float)(3 - i), mesh.getVertex(mesh.getIndex((IndexType)(i * 3))).position.z);
+	}
+	// the order is kept if the eye doesn't move
+	EXPECT_FALSE(mesh.sort(eye));
+	// the other side reverses the order
+	EXPECT_TRUE(mesh.sort(glm::vec3(0.0f, 0.0f, 10.0f)));
+	for (int i = 0; i < 4; ++i) {
+		EXPECT_FLOAT_EQ((float)i, mesh.getVertex(mesh.getIndex((IndexType)(i * 3))).position.z);
+	}
+}
+
+} // namespace voxel
@@ -0,0 +1,72 @@
+/**
+ * @file
+ */
+
+#include "voxel/OccupancyPyramid.h"
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class OccupancyPyramidTest : public app::AbstractTest {
+protected:
+	bool isEmptyBruteForce(const RawVolume &v, const Region &region) const {
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (!isAir(v.voxel(x, y, z).getMaterial())) {
+						return false;
+					}
+				}
+			}
+		}
+		return true;
+	}
+};
+
+TEST_F(OccupancyPyramidTest, testVoxelCount) {
+	RawVolume v(Region(-10, 90));
+	v.setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 1));
+	v.enableOccupancy();
+	ASSERT_NE(nullptr, v.occupancy());
+	EXPECT_EQ(1u, v.occupancy()->voxels());
+	v.fill(Region(10, 19), createVoxel(VoxelType::Generic, 1));
+	EXPECT_EQ(1001u, v.occupancy()->voxels());
+	v.setVoxel(0, 0, 0, Voxel());
+	EXPECT_EQ(1000u, v.occupancy()->voxels());
+	v.clear();
+	EXPECT_EQ(0u, v.occupancy()->voxels());
+}
+
+TEST_F(OccupancyPyramidTest, testEmpty) {
+	RawVolume v(Region(-10, 90));
+	v.enableOccupancy();
+	v.setVoxel(33, 70, -3, createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(-10, -10, -10, createVoxel(VoxelType::Generic, 1));
+	const Region regions[] = {Region(-10, 90),		   Region(0, 90),	Region(33, 70, -3, 33, 70, -3),
+							  Region(34, 70, -3, 40, 80, 0), Region(20, 60, -5, 33, 70, -3),
+							  Region(-20, -11),		   Region(-20, -10), Region(100, 120), Region(-8, 32)};
+	for (const Region &region : regions) {
+		Region clipped = region;
+		clipped.cropTo(v.region());
+		const bool expected = !intersects(v.region(), region) || isEmptyBruteForce(v, clipped);
+		EXPECT_EQ(expected, v.occupancy()->empty(v, region)) << region.toString();
+	}
+}
+
+TEST_F(OccupancyPyramidTest, testSolidRegion) {
+	RawVolume v(Region(-10, 90));
+	v.enableOccupancy();
+	EXPECT_FALSE(v.occupancy()->solidRegion(v).isValid());
+	v.setVoxel(3, 50, 7, createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(20, 5, 60, createVoxel(VoxelType::Generic, 1));
+	v.setVoxel(10, 10, 10, createVoxel(VoxelType::Generic, 1));
+	EXPECT_EQ(Region(3, 5, 7, 20, 50, 60), v.occupancy()->solidRegion(v));
+	// removing a voxel shrinks the bounds again
+	v.setVoxel(20, 5, 60, Voxel());
+	EXPECT_EQ(Region(3, 10, 7, 10, 50, 10), v.occupancy()->solidRegion(v));
+	v.setVoxel(3, 50, 7, Voxel());
+	EXPECT_EQ(Region(10, 10), v.occupancy()->solidRegion(v));
+}
+
+} // namespace voxel
@@ -0,0 +1,167 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/PagedVolume.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class PagedVolumeTest : public AbstractVoxelTest {
+protected:
+	void fill(RawVolume &raw, PagedVolume &paged) {
+		const voxel::Region &region = raw.region();
+		for (int i = 0; i < 500; ++i) {
+			const glm::ivec3 pos = region.getRandomPosition(_random);
+			const voxel::Voxel v = voxel::createVoxel(VoxelType::Generic, i % 255);
+			raw.setVoxel(pos, v);
+			paged.setVoxel(pos, v);
+		}
+	}
+};
+
+TEST_F(PagedVolumeTest, testSetVoxel) {
+	PagedVolume v(Region(-40, 40));
+	EXPECT_EQ(0, v.allocatedBricks());
+	EXPECT_FALSE(v.setVoxel(0, 0, 0, voxel::Voxel())) << "Setting air into an air brick should not change anything";
+	EXPECT_EQ(0, v.allocatedBricks());
+	EXPECT_TRUE(v.setVoxel(0, 0, 0, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_TRUE(v.setVoxel(1, 0, 0, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_EQ(1, v.allocatedBricks());
+	EXPECT_EQ(VoxelType::Generic, v.voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(VoxelType::Air, v.voxel(0, 1, 0).getMaterial());
+	EXPECT_FALSE(v.setVoxel(41, 0, 0, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_EQ(glm::ivec3(0), v.mins());
+	EXPECT_EQ(glm::ivec3(1, 0, 0), v.maxs());
+}
+
+TEST_F(PagedVolumeTest, testCompact) {
+	PagedVolume v(Region(0, 63));
+	EXPECT_EQ(8, v.bricks());
+	EXPECT_TRUE(v.setVoxel(0, 0, 0, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_TRUE(v.setVoxel(63, 63, 63, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_EQ(2, v.allocatedBricks());
+	EXPECT_TRUE(v.setVoxel(0, 0, 0, voxel::Voxel()));
+	EXPECT_EQ(1, v.compact());
+	EXPECT_EQ(1, v.allocatedBricks());
+	EXPECT_EQ((size_t)PagedVolume::BrickVoxels * sizeof(Voxel), v.memoryUsage());
+}
+
+TEST_F(PagedVolumeTest, testCopyOnWrite) {
+	PagedVolume v(Region(0, 63));
+	EXPECT_TRUE(v.setVoxel(0, 0, 0, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_TRUE(v.setVoxel(63, 63, 63, voxel::createVoxel(VoxelType::Generic, 1)));
+	EXPECT_EQ(0, v.sharedBricks());
+	{
+		PagedVolume copy(v);
+		EXPECT_EQ(2, copy.allocatedBricks());
+		EXPECT_EQ(2, copy.sharedBricks());
+		EXPECT_EQ(2, v.sharedBricks());
+
+		EXPECT_TRUE(copy.setVoxel(1, 0, 0, voxel::createVoxel(VoxelType::Generic, 2)));
+		EXPECT_EQ(1, copy.sharedBricks()) << "Only the modified brick should get duplicated";
+		EXPECT_EQ(1, v.sharedBricks());
+		EXPECT_EQ(VoxelType::Air, v.voxel(1, 0, 0).getMaterial());
+		EXPECT_EQ(VoxelType::Generic, copy.voxel(1, 0, 0).getMaterial());
+		EXPECT_EQ(VoxelType::Generic, copy.voxel(0, 0, 0).getMaterial());
+	}
+	EXPECT_EQ(0, v.sharedBricks());
+	EXPECT_EQ(VoxelType::Generic, v.voxel(63, 63, 63).getMaterial());
+}
+
+TEST_F(PagedVolumeTest, testScratchStorage) {
+	const PagedVolumeStoragePtr &storage = PagedVolume::createStorage(_testApp->filesystem()->homePath());
+	if (!storage) {
+		GTEST_SKIP() << "Memory mapped scratch files are not supported";
+	}
+	const voxel::Region region(-5, 70);
+	RawVolume raw(region);
+	PagedVolume paged(region, storage);
+	fill(raw, paged);
+	EXPECT_EQ((size_t)paged.allocatedBricks(), storage->usedSlots());
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_TRUE(raw.voxel(x, y, z).isSame(paged.voxel(x, y, z)));
+			}
+		}
+	}
+	const int bricks = paged.allocatedBricks();
+	{
+		PagedVolume copy(paged);
+		EXPECT_EQ(storage, copy.storage());
+		EXPECT_EQ((size_t)bricks, storage->usedSlots()) << "The bricks should be shared between the copies";
+		EXPECT_TRUE(copy.setVoxel(region.getLowerCorner(), voxel::createVoxel(VoxelType::Generic, 254)));
+		EXPECT_EQ((size_t)bricks + 1u, storage->usedSlots());
+	}
+	EXPECT_EQ((size_t)bricks, storage->usedSlots());
+	paged.clear();
+	EXPECT_EQ(0u, storage->usedSlots());
+}
+
+TEST_F(PagedVolumeTest, testSamplerPeekAcrossBricks) {
+	const voxel::Region region(-5, 70);
+	RawVolume raw(region);
+	PagedVolume paged(region);
+	fill(raw, paged);
+
+	RawVolume::Sampler rawSampler(raw);
+	PagedVolume::Sampler pagedSampler(paged);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			rawSampler.setPosition(region.getLowerX(), y, z);
+			pagedSampler.setPosition(region.getLowerX(), y, z);
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_TRUE(rawSampler.voxel().isSame(pagedSampler.voxel())) << x << ":" << y << ":" << z;
+				ASSERT_TRUE(rawSampler.peekVoxel1nx1ny1nz().isSame(pagedSampler.peekVoxel1nx1ny1nz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1px1py1pz().isSame(pagedSampler.peekVoxel1px1py1pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel1nx0py1pz().isSame(pagedSampler.peekVoxel1nx0py1pz()));
+				ASSERT_TRUE(rawSampler.peekVoxel0px1ny0pz().isSame(pagedSampler.peekVoxel0px1ny0pz()));
+				rawSampler.movePositiveX();
+				pagedSampler.movePositiveX();
+			}
+		}
+	}
+}
+
+TEST_F(PagedVolumeTest, testExtractCubicMesh) {
+	const voxel::Region region(0, 40);
+	RawVolume raw(region);
+	PagedVolume paged(region);
+	fill(raw, paged);
+
+	ChunkMesh rawMesh;
+	ChunkMesh pagedMesh;
+	extractCubicMesh(&raw, region, &rawMesh, glm::ivec3(0));
+	extractCubicMesh(&paged, region, &pagedMesh, glm::ivec3(0));
+	for (int i = 0; i < ChunkMesh::Meshes; ++i) {
+		EXPECT_EQ(rawMesh.mesh[i].getNoOfVertices(), pagedMesh.mesh[i].getNoOfVertices());
+		EXPECT_EQ(rawMesh.mesh[i].getNoOfIndices(), pagedMesh.mesh[i].getNoOfIndices());
+	}
+}
+
+TEST_F(PagedVolumeTest, testToRawVolume) {
+	const voxel::Region region(0, 40);
+	RawVolume raw(region);
+	PagedVolume paged(region);
+	fill(raw, paged);
+	RawVolume *converted = paged.toRawVolume();
+	ASSERT_NE(nullptr, converted);
+	EXPECT_EQ(region, converted->region());
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_TRUE(raw.voxel(x, y, z).isSame(converted->voxel(x, y, z)));
+			}
+		}
+	}
+	delete converted;
+
+	PagedVolume fromRaw(raw);
+	EXPECT_EQ(paged.allocatedBricks(), fromRaw.allocatedBricks());
+}
+
+}
@@ -7,6 +7,8 @@
 #include "app/tests/AbstractTest.h"
 #include "core/GameConfig.h"
 #include "core/Var.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/PaletteLookup.h"
 
@@ -27,6 +29,29 @@ TEST_F(PaletteTest, testPaletteLookup) {
 	EXPECT_EQ(0, pal.findClosestIndex(rgba));
 }
 
+TEST_F(PaletteTest, testPaletteLookupParallel) {
+	// a small cache to force evictions
+	PaletteLookup palLookup(512);
+	const voxel::Palette &palette = palLookup.palette();
+	core::AtomicInt mismatches(0);
+	app::App::getInstance()->threadPool().parallelFor(0, 64, 1, [&](int start, int end) {
+		for (int r = start; r < end; ++r) {
+			for (int g = 0; g < 256; g += 8) {
+				for (int b = 0; b < 256; b += 8) {
+					const core::RGBA rgba(r * 4, g, b, 255);
+					// look up twice to also hit the cached entries
+					for (int i = 0; i < 2; ++i) {
+						if (palLookup.findClosestIndex(rgba) != (uint8_t)palette.getClosestMatch(rgba)) {
+							++mismatches;
+						}
+					}
+				}
+			}
+		}
+	});
+	EXPECT_EQ(0, mismatches);
+}
+
 TEST_F(PaletteTest, testGimpPalette) {
 	Palette pal;
 	pal.nippon();
@@ -102,6 +127,40 @@ TEST_F(PaletteTest, testGetClosestMatch) {
 	}
 }
 
+static int bruteForceClosestMatch(const Palette &pal, core::RGBA rgba, int skip) {
+	float hue, saturation, brightness;
+	core::Color::getHSB(core::Color::fromRGBA(rgba), hue, saturation, brightness);
+	float minDistance = FLT_MAX;
+	int minIndex = -1;
+	for (int i = 0; i < pal.colorCount(); ++i) {
+		if (i == skip || pal.colors()[i].a == 0) {
+			continue;
+		}
+		const float val = core::Color::getDistance(pal.colors()[i], hue, saturation, brightness);
+		if (val < minDistance) {
+			minDistance = val;
+			minIndex = i;
+		}
+	}
+	return minIndex;
+}
+
+TEST_F(PaletteTest, testGetClosestMatchBruteForce) {
+	Palette pal;
+	pal.nippon();
+	// modified without marking the palette dirty
+	pal.color(3) = core::RGBA(10, 200, 30, 255);
+	for (int r = 0; r < 256; r += 15) {
+		for (int g = 0; g < 256; g += 15) {
+			for (int b = 0; b < 256; b += 15) {
+				const core::RGBA rgba(r, g, b, 255);
+				const int expected = bruteForceClosestMatch(pal, rgba, 5);
+				ASSERT_EQ(expected, pal.getClosestMatch(rgba, nullptr, 5)) << r << ":" << g << ":" << b;
+			}
+		}
+	}
+}
+
 TEST_F(PaletteTest, testRGBPalette) {
 	Palette pal;
 	pal.nippon();
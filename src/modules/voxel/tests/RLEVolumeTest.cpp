@@ -0,0 +1,93 @@
+/**
+ * @file
+ */
+
+#include "voxel/RLEVolume.h"
+#include "app/tests/AbstractTest.h"
+#include "core/ScopedPtr.h"
+#include "voxel/RawVolume.h"
+
+namespace voxel {
+
+class RLEVolumeTest : public app::AbstractTest {
+protected:
+	void fillTerrain(RawVolume &v) const {
+		const Region &region = v.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const int h = region.getLowerY() + ((x * 7 + z * 3) & 15);
+				for (int y = region.getLowerY(); y <= h; ++y) {
+					v.setVoxel(x, y, z, createVoxel(VoxelType::Generic, y < h ? 1 : 2));
+				}
+			}
+		}
+	}
+
+	void expectSameVoxels(const RawVolume &expected, const RawVolume &actual) const {
+		ASSERT_EQ(expected.region(), actual.region());
+		const Region &region = expected.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					ASSERT_TRUE(expected.voxel(x, y, z).isSame(actual.voxel(x, y, z))) << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+};
+
+TEST_F(RLEVolumeTest, testEncode) {
+	RawVolume v(Region(-5, 20));
+	fillTerrain(v);
+	const RLEVolume rle(v);
+	EXPECT_EQ(v.region(), rle.region());
+	// one run for the ground and one for the top voxel - or just the top voxel on height 0 columns
+	EXPECT_LE(rle.runs(), (size_t)(26 * 26 * 2));
+	const RLEVolume::Column &column = rle.column(0, 0);
+	ASSERT_EQ(1u, column.size());
+	EXPECT_EQ(1, column[0].length);
+	const Region &region = v.region();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_TRUE(v.voxel(x, y, z).isSame(rle.voxel(x, y, z))) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(RLEVolumeTest, testToRawVolume) {
+	RawVolume v(Region(-5, 20));
+	fillTerrain(v);
+	const RLEVolume rle(v);
+	core::ScopedPtr<RawVolume> decoded(rle.toRawVolume());
+	expectSameVoxels(v, *decoded);
+
+	RawVolume copy(v.region());
+	copy.fill(copy.region(), createVoxel(VoxelType::Generic, 3));
+	rle.copyTo(copy);
+	expectSameVoxels(v, copy);
+}
+
+TEST_F(RLEVolumeTest, testAddRun) {
+	RLEVolume rle(Region(0, 0, 0, 3, 99, 3));
+	EXPECT_TRUE(rle.addRun(1, 2, 10, 5, createVoxel(VoxelType::Generic, 1)));
+	EXPECT_TRUE(rle.addRun(1, 2, 15, 5, createVoxel(VoxelType::Generic, 1)));
+	EXPECT_FALSE(rle.addRun(1, 2, 12, 5, createVoxel(VoxelType::Generic, 2))) << "Runs must be added bottom up";
+	EXPECT_FALSE(rle.addRun(1, 2, 98, 5, createVoxel(VoxelType::Generic, 2))) << "Run exceeds the region";
+	EXPECT_TRUE(rle.addRun(1, 2, 30, 1, createVoxel(VoxelType::Generic, 2)));
+	const RLEVolume::Column &column = rle.column(1, 2);
+	// air, the merged run, air and the last voxel
+	ASSERT_EQ(4u, column.size());
+	EXPECT_EQ(10, column[0].length);
+	EXPECT_EQ(10, column[1].length);
+	EXPECT_EQ(10, column[2].length);
+	EXPECT_EQ(1, column[3].length);
+	EXPECT_TRUE(isAir(rle.voxel(1, 9, 2).getMaterial()));
+	EXPECT_EQ(1, rle.voxel(1, 19, 2).getColor());
+	EXPECT_TRUE(isAir(rle.voxel(1, 20, 2).getMaterial()));
+	EXPECT_EQ(2, rle.voxel(1, 30, 2).getColor());
+	EXPECT_TRUE(isAir(rle.voxel(1, 31, 2).getMaterial()));
+}
+
+} // namespace voxel
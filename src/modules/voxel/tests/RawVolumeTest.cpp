@@ -0,0 +1,64 @@
+/**
+ * @file
+ */
+
+#include "voxel/RawVolume.h"
+#include "app/tests/AbstractTest.h"
+
+namespace voxel {
+
+class RawVolumeTest : public app::AbstractTest {};
+
+TEST_F(RawVolumeTest, testHash) {
+	RawVolume v(Region(0, 39));
+	RawVolume v2(Region(0, 39));
+	const uint64_t emptyHash = v.hash();
+	EXPECT_EQ(emptyHash, v2.hash());
+	EXPECT_NE(emptyHash, RawVolume(Region(0, 38)).hash());
+
+	v.setVoxel(35, 35, 35, createVoxel(VoxelType::Generic, 1));
+	const uint64_t hash = v.hash();
+	EXPECT_NE(emptyHash, hash);
+	v2.setVoxel(35, 35, 35, createVoxel(VoxelType::Generic, 1));
+	EXPECT_EQ(hash, v2.hash());
+
+	v.setVoxel(35, 35, 35, Voxel());
+	EXPECT_EQ(emptyHash, v.hash());
+
+	v.fill(Region(1, 20), createVoxel(VoxelType::Generic, 2));
+	EXPECT_NE(emptyHash, v.hash());
+	v.clear();
+	EXPECT_EQ(emptyHash, v.hash());
+
+	RawVolume::DirectSampler sampler(v);
+	sampler.setPosition(17, 2, 39);
+	sampler.setVoxel(createVoxel(VoxelType::Generic, 3));
+	const uint64_t sampledHash = v.hash();
+	EXPECT_NE(emptyHash, sampledHash);
+	EXPECT_EQ(sampledHash, RawVolume(v).hash()) << "The hash of a fresh copy must match the cached hashes";
+	v.translate(glm::ivec3(5));
+	EXPECT_EQ(sampledHash, v.hash()) << "The position of the volume must not be part of the hash";
+}
+
+TEST_F(RawVolumeTest, testCopyRegions) {
+	RawVolume v(Region(0, 9));
+	v.fill(v.region(), createVoxel(VoxelType::Generic, 1));
+	core::DynamicArray<Region> regions;
+	regions.push_back(Region(1, 2));
+	regions.push_back(Region(glm::ivec3(5, 1, 1), glm::ivec3(6, 2, 2)));
+	const RawVolume copy(v, regions);
+	EXPECT_EQ(Region(glm::ivec3(1), glm::ivec3(6, 2, 2)), copy.region());
+	EXPECT_EQ(1, copy.voxel(1, 1, 1).getColor());
+	EXPECT_EQ(1, copy.voxel(6, 2, 2).getColor());
+	EXPECT_TRUE(isAir(copy.voxel(3, 1, 1).getMaterial())) << "The voxels between the regions must be air";
+
+	RawVolume target(Region(0, 9));
+	target.setVoxel(0, 0, 0, createVoxel(VoxelType::Generic, 2));
+	target.setVoxel(2, 0, 0, createVoxel(VoxelType::Generic, 2));
+	const Region &pasted = target.copyRegion(copy, copy.region(), glm::ivec3(0), true);
+	EXPECT_EQ(Region(glm::ivec3(0), glm::ivec3(5, 1, 1)), pasted);
+	EXPECT_EQ(1, target.voxel(0, 0, 0).getColor());
+	EXPECT_EQ(2, target.voxel(2, 0, 0).getColor()) << "Air must not overwrite the target voxels";
+}
+
+} // namespace voxel
@@ -46,4 +46,42 @@ TEST_F(RawVolumeWrapperTest, testSetMaxBoundary) {
 	EXPECT_FALSE(w.setVoxel(8, 7, 7, voxel::createVoxel(VoxelType::Air, 0)));
 }
 
+TEST_F(RawVolumeWrapperTest, testFill) {
+	RawVolume v(Region(-4, 11));
+	RawVolumeWrapper w(&v, Region(0, 7));
+	const Voxel voxel = voxel::createVoxel(VoxelType::Generic, 1);
+	EXPECT_TRUE(w.fill(Region(-2, 3), voxel));
+	EXPECT_EQ(Region(0, 3), w.dirtyRegion());
+	EXPECT_TRUE(isAir(v.voxel(-1, 0, 0).getMaterial()));
+	EXPECT_EQ(VoxelType::Generic, v.voxel(0, 0, 0).getMaterial());
+	EXPECT_EQ(VoxelType::Generic, v.voxel(3, 3, 3).getMaterial());
+	EXPECT_TRUE(isAir(v.voxel(4, 3, 3).getMaterial()));
+	EXPECT_FALSE(w.fill(Region(8, 11), voxel));
+	EXPECT_EQ(glm::ivec3(0), v.mins());
+	EXPECT_EQ(glm::ivec3(3), v.maxs());
+}
+
+TEST_F(RawVolumeWrapperTest, testCopyRegion) {
+	RawVolume src(Region(0, 7));
+	const Voxel voxel = voxel::createVoxel(VoxelType::Generic, 1);
+	src.setVoxel(1, 2, 3, voxel);
+	src.setVoxel(7, 7, 7, voxel);
+
+	RawVolume v(Region(10, 19));
+	v.setVoxel(12, 12, 12, voxel::createVoxel(VoxelType::Generic, 2));
+	RawVolumeWrapper w(&v);
+	EXPECT_TRUE(w.copyRegion(src, src.region(), glm::ivec3(11), true));
+	EXPECT_EQ(Region(11, 18), w.dirtyRegion());
+	EXPECT_EQ(1, v.voxel(12, 13, 14).getColor());
+	EXPECT_EQ(1, v.voxel(18, 18, 18).getColor());
+	EXPECT_EQ(2, v.voxel(12, 12, 12).getColor()) << "Air voxels of the source must not be copied";
+
+	EXPECT_TRUE(w.copyRegion(src, src.region(), glm::ivec3(12)));
+	EXPECT_EQ(Region(11, 19), w.dirtyRegion());
+	EXPECT_TRUE(isAir(v.voxel(12, 12, 12).getMaterial()));
+	EXPECT_EQ(1, v.voxel(13, 14, 15).getColor());
+	EXPECT_EQ(1, v.voxel(19, 19, 19).getColor());
+	EXPECT_FALSE(w.copyRegion(src, src.region(), glm::ivec3(20)));
+}
+
 }
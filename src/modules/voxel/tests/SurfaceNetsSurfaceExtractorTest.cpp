@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#include "AbstractVoxelTest.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/MarchingCubesSurfaceExtractor.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxel/SurfaceNetsSurfaceExtractor.h"
+#include <glm/geometric.hpp>
+
+namespace voxel {
+
+class SurfaceNetsSurfaceExtractorTest : public AbstractVoxelTest {
+protected:
+	void fillSphere(RawVolume &v) {
+		const Region &region = v.region();
+		const glm::vec3 center(region.getCenter());
+		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					if (glm::distance(center, glm::vec3(x, y, z)) < 15.0f) {
+						v.setVoxel(x, y, z, createVoxel(VoxelType::Generic, 1));
+					}
+				}
+			}
+		}
+	}
+};
+
+TEST_F(SurfaceNetsSurfaceExtractorTest, testSingleVoxel) {
+	const Region region(0, 2);
+	RawVolume v(region);
+	v.setVoxel(1, 1, 1, createVoxel(VoxelType::Generic, 1));
+	Palette palette;
+	palette.nippon();
+
+	ChunkMesh mesh;
+	extractSurfaceNetsMesh(&v, palette, region, &mesh);
+	// one vertex for each of the eight cells around the voxel and one quad for each face
+	EXPECT_EQ(8u, mesh.mesh[0].getNoOfVertices());
+	EXPECT_EQ(6u * 6u, mesh.mesh[0].getNoOfIndices());
+	for (const VoxelVertex &vertex : mesh.mesh[0].getVertexVector()) {
+		EXPECT_EQ(1u, vertex.colorIndex);
+	}
+}
+
+TEST_F(SurfaceNetsSurfaceExtractorTest, testFewerTrianglesThanMarchingCubes) {
+	const Region region(0, 39);
+	RawVolume v(region);
+	fillSphere(v);
+	Palette palette;
+	palette.nippon();
+
+	Region extractRegion = region;
+	extractRegion.shrink(-1);
+
+	ChunkMesh surfaceNets;
+	extractSurfaceNetsMesh(&v, palette, extractRegion, &surfaceNets);
+	ASSERT_FALSE(surfaceNets.isEmpty());
+	ChunkMesh marchingCubes;
+	extractMarchingCubesMesh(&v, palette, extractRegion, &marchingCubes);
+	EXPECT_LT(surfaceNets.mesh[0].getNoOfIndices(), marchingCubes.mesh[0].getNoOfIndices());
+}
+
+TEST_F(SurfaceNetsSurfaceExtractorTest, testParallelExtractionMatchesSerial) {
+	const Region region(0, 39);
+	RawVolume v(region);
+	fillSphere(v);
+	Palette palette;
+	palette.nippon();
+
+	Region extractRegion = region;
+	extractRegion.setLowerCorner(region.getLowerCorner() - 1);
+
+	ChunkMesh serial;
+	extractSurfaceNetsMesh(&v, palette, extractRegion, &serial);
+	ASSERT_FALSE(serial.isEmpty());
+
+	core::ThreadPool threadPool(2, "SurfaceNetsTest");
+	threadPool.init();
+	ChunkMesh parallel;
+	// a slice depth that doesn't divide the region evenly
+	extractSurfaceNetsMeshParallel(threadPool, &v, palette, extractRegion, &parallel, 7);
+	EXPECT_EQ(serial.mesh[0].getNoOfIndices(), parallel.mesh[0].getNoOfIndices());
+	EXPECT_EQ(serial.mesh[0].getNoOfVertices(), parallel.mesh[0].getNoOfVertices())
+		<< "The vertices on the slab seams should be merged";
+	EXPECT_EQ(serial.mesh[0].getOffset(), parallel.mesh[0].getOffset());
+	threadPool.shutdown();
+}
+
+} // namespace voxel
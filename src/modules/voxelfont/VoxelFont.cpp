@@ -7,6 +7,8 @@
 #include "core/Common.h"
 #include "core/Log.h"
 #include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/UTF8.h"
 #include "io/Filesystem.h"
 #include "voxel/RawVolumeWrapper.h"
 
@@ -63,39 +65,80 @@ void VoxelFont::shutdown() {
 	delete[] _ttfBuffer;
 	_ttfBuffer = nullptr;
 
+	_glyphs.clear();
+	_runs.clear();
+
 	_filename = "";
 }
 
-int VoxelFont::renderCharacter(int codepoint, uint8_t size, int thickness, const glm::ivec3 &pos,
-								voxel::RawVolumeWrapper &volume, const voxel::Voxel &voxel) {
+const VoxelFont::Glyph &VoxelFont::glyph(int codepoint, uint8_t size) {
+	const uint64_t key = ((uint64_t)size << 32) | (uint32_t)codepoint;
+	auto iter = _glyphs.find(key);
+	if (iter != _glyphs.end()) {
+		return iter->value;
+	}
+	core_trace_scoped(VoxelFontGlyph);
+	Glyph glyph;
+	glyph.firstRun = _runs.size();
 	const float scale = stbtt_ScaleForPixelHeight(_font, (float)size);
 	int w;
 	int h;
 	unsigned char *bitmap = stbtt_GetCodepointBitmap(_font, 0.0f, scale, codepoint, &w, &h, nullptr, nullptr);
-	thickness = core_max(1, thickness);
-
 	if (bitmap == nullptr) {
 		Log::warn("Could not create voxelfont mesh for character: %i", codepoint);
-		return 0;
-	}
-
-	int ix0, iy0, ix1, iy1;
-	stbtt_GetCodepointBitmapBox(_font, codepoint, 0.0f, scale, &ix0, &iy0, &ix1, &iy1);
-
-	for (int y = 0; y < h; ++y) {
-		for (int x = 0; x < w; ++x) {
-			// antialiasing
-			if (bitmap[y * w + x] >= 25) {
-				glm::ivec3 v(x + ix0, h - y, 0);
-				for (int i = 0; i < thickness; ++i) {
-					v.z = i;
-					volume.setVoxel(pos + v, voxel);
+	} else {
+		int ix0, iy0, ix1, iy1;
+		stbtt_GetCodepointBitmapBox(_font, codepoint, 0.0f, scale, &ix0, &iy0, &ix1, &iy1);
+		for (int y = 0; y < h; ++y) {
+			const unsigned char *row = bitmap + y * w;
+			int x = 0;
+			while (x < w) {
+				// antialiasing
+				if (row[x] < 25) {
+					++x;
+					continue;
 				}
+				const int runStart = x;
+				while (x < w && row[x] >= 25) {
+					++x;
+				}
+				_runs.push_back(GlyphRun{runStart + ix0, x - 1 + ix0, h - y});
 			}
 		}
+		stbtt_FreeBitmap(bitmap, nullptr);
+		glyph.width = w;
+	}
+	glyph.runs = _runs.size() - glyph.firstRun;
+	_glyphs.put(key, glyph);
+	return _glyphs.find(key)->value;
+}
+
+int VoxelFont::renderCharacter(int codepoint, uint8_t size, int thickness, const glm::ivec3 &pos,
+								voxel::RawVolumeWrapper &volume, const voxel::Voxel &voxel) {
+	if (_font == nullptr) {
+		return 0;
+	}
+	const Glyph &g = glyph(codepoint, size);
+	thickness = core_max(1, thickness);
+	for (size_t i = g.firstRun; i < g.firstRun + g.runs; ++i) {
+		const GlyphRun &run = _runs[i];
+		const voxel::Region region(pos.x + run.x1, pos.y + run.y, pos.z, pos.x + run.x2, pos.y + run.y,
+								   pos.z + thickness - 1);
+		volume.fill(region, voxel);
+	}
+	return g.width;
+}
+
+int VoxelFont::renderText(const char *text, uint8_t size, int thickness, int spacing, const glm::ivec3 &pos,
+						  voxel::RawVolumeWrapper &volume, const voxel::Voxel &voxel) {
+	core_trace_scoped(VoxelFontRenderText);
+	const char **str = &text;
+	glm::ivec3 cursor = pos;
+	for (int c = core::utf8::next(str); c != -1; c = core::utf8::next(str)) {
+		cursor.x += renderCharacter(c, size, thickness, cursor, volume, voxel);
+		cursor.x += spacing;
 	}
-	stbtt_FreeBitmap(bitmap, nullptr);
-	return w;
+	return cursor.x - pos.x;
 }
 
 } // namespace voxelfont
@@ -5,6 +5,8 @@
 #pragma once
 
 #include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/DynamicMap.h"
 #include <glm/fwd.hpp>
 #include <stdint.h>
 
@@ -19,6 +21,9 @@ namespace voxelfont {
 
 /**
  * @brief Will take any TTF font and rasterizes into voxels
+ *
+ * The rasterized glyphs are cached per size and codepoint as runs of voxel rows - rendering the same character again
+ * only fills those runs extruded by the thickness into the volume.
  */
 class VoxelFont {
 private:
@@ -26,7 +31,23 @@ private:
 	uint8_t *_ttfBuffer = nullptr;
 	core::String _filename;
 
-	bool renderGlyphs(const char* string);
+	/**
+	 * @brief A horizontal run of voxels relative to the glyph position
+	 */
+	struct GlyphRun {
+		int x1;
+		int x2;
+		int y;
+	};
+	struct Glyph {
+		int width = 0;
+		size_t firstRun = 0u;
+		size_t runs = 0u;
+	};
+	core::DynamicArray<GlyphRun> _runs;
+	core::DynamicMap<uint64_t, Glyph, 256> _glyphs;
+
+	const Glyph &glyph(int codepoint, uint8_t size);
 
 public:
 	~VoxelFont();
@@ -34,7 +55,16 @@ public:
 	bool init(const char* font);
 	void shutdown();
 
+	/**
+	 * @return The width of the character in voxels
+	 */
 	int renderCharacter(int codepoint, uint8_t size, int thickness, const glm::ivec3 &pos, voxel::RawVolumeWrapper &volume, const voxel::Voxel& voxel);
+	/**
+	 * @brief Renders the utf8 string starting at the given position along the x axis
+	 * @param spacing The additional voxels between two characters
+	 * @return The width of the text in voxels
+	 */
+	int renderText(const char *text, uint8_t size, int thickness, int spacing, const glm::ivec3 &pos, voxel::RawVolumeWrapper &volume, const voxel::Voxel& voxel);
 };
 
 }
@@ -3,19 +3,24 @@
  */
 
 #include "AoSVXLFormat.h"
+#include "app/App.h"
 #include "core/Assert.h"
 #include "core/Color.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicMap.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "io/Stream.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
 #include "voxel/PaletteLookup.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
-#include "voxelutil/VolumeVisitor.h"
 #define libvxl_assert core_assert_msg
 #define libvxl_mem_malloc core_malloc
 #define libvxl_mem_realloc core_realloc
@@ -45,27 +50,188 @@ static inline uint8_t vxl_red(uint32_t c) {
 	return (c >> 16) & 0xFF;
 }
 
+using ColorMap = core::DynamicMap<core::RGBA, bool, 11, core::RGBAHasher>;
+
+/**
+ * @brief The solid voxels of a map that is about to be saved - one bit per voxel
+ *
+ * Each column starts at its own word - so the columns can be filled in parallel. The same rules as in libvxl apply:
+ * the columns wrap around at the map borders, above the map is air and below the map is solid.
+ */
+class MapGeometry {
+private:
+	core::DynamicArray<uint64_t> _bits;
+	int _mapSize;
+	int _mapHeight;
+	int _wordsPerColumn;
+
+	inline size_t bit(int x, int y, int z) const {
+		x = (x + _mapSize) % _mapSize;
+		y = (y + _mapSize) % _mapSize;
+		return ((size_t)x + (size_t)y * _mapSize) * _wordsPerColumn * 64u + (size_t)z;
+	}
+
+public:
+	MapGeometry(int mapSize, int mapHeight)
+		: _mapSize(mapSize), _mapHeight(mapHeight), _wordsPerColumn((mapHeight + 63) / 64) {
+		_bits.resize((size_t)mapSize * mapSize * _wordsPerColumn);
+		// a new map is filled with water at the bottom layer - see libvxl_create()
+		for (int y = 0; y < mapSize; ++y) {
+			for (int x = 0; x < mapSize; ++x) {
+				setSolid(x, y, mapHeight - 1);
+			}
+		}
+	}
+
+	inline void setSolid(int x, int y, int z) {
+		const size_t idx = bit(x, y, z);
+		_bits[idx / 64u] |= (uint64_t)1 << (idx % 64u);
+	}
+
+	inline bool isSolid(int x, int y, int z) const {
+		if (z < 0) {
+			return false;
+		}
+		if (z >= _mapHeight) {
+			return true;
+		}
+		const size_t idx = bit(x, y, z);
+		return (_bits[idx / 64u] >> (idx % 64u)) & 1u;
+	}
+
+	/**
+	 * @brief Only the solid voxels with at least one air neighbour get a color in the map
+	 */
+	inline bool isSurface(int x, int y, int z) const {
+		return isSolid(x, y, z) &&
+			   (!isSolid(x, y + 1, z) || !isSolid(x, y - 1, z) || !isSolid(x + 1, y, z) || !isSolid(x - 1, y, z) ||
+				!isSolid(x, y, z + 1) || !isSolid(x, y, z - 1));
+	}
+
+	inline int height() const {
+		return _mapHeight;
+	}
+};
+
+struct SurfaceVoxel {
+	int z;
+	uint32_t color;
+};
+
+/**
+ * @brief The color of the last node that has a voxel at the given volume position - like the nodes would be put into
+ * a libvxl map one after another
+ */
+static uint32_t surfaceColor(const core::DynamicArray<const scenegraph::SceneGraphNode *> &nodes, int x, int y,
+							 int z) {
+	for (int i = (int)nodes.size() - 1; i >= 0; --i) {
+		const scenegraph::SceneGraphNode *node = nodes[i];
+		const voxel::RawVolume *volume = node->volume();
+		if (!volume->region().containsPoint(x, y, z)) {
+			continue;
+		}
+		const voxel::Voxel &voxel = volume->voxel(x, y, z);
+		if (voxel::isAir(voxel.getMaterial())) {
+			continue;
+		}
+		return vxl_color(node->palette().color(voxel.getColor()));
+	}
+	return DEFAULT_COLOR(x, y, z);
+}
+
+/**
+ * @return The z coordinate after the run of successive surface voxels that starts at @c start - or @c start if there
+ * is no surface voxel at @c start
+ */
+static int successiveSurface(const core::DynamicArray<SurfaceVoxel> &surface, size_t idx, int start, size_t &next) {
+	next = idx;
+	if (idx >= surface.size() || surface[idx].z != start) {
+		return start;
+	}
+	int z = start;
+	while (next < surface.size() && surface[next].z == z) {
+		++next;
+		++z;
+	}
+	return z;
+}
+
+static void writeColor(core::DynamicArray<uint8_t> &out, uint32_t color) {
+	out.push_back(vxl_blue(color));
+	out.push_back(vxl_green(color));
+	out.push_back(vxl_red(color));
+	out.push_back(0x7F);
+}
+
+/**
+ * @brief Appends the spans of one column - the same layout that libvxl_stream_read() produces
+ *
+ * @param surface The surface voxels of the column sorted by z
+ */
+static void encodeColumn(const MapGeometry &geometry, const core::DynamicArray<SurfaceVoxel> &surface, int x, int y,
+						 core::DynamicArray<uint8_t> &out) {
+	core_assert_msg(!surface.empty(), "Every column has at least one surface voxel");
+	const int depth = geometry.height();
+	size_t idx = 0;
+	bool firstRun = true;
+	int z = surface[0].z;
+	for (;;) {
+		const int topStart = geometry.isSolid(x, y, z) ? z : surface[idx].z;
+		size_t next;
+		const int topEnd = successiveSurface(surface, idx, topStart, next);
+
+		int bottomStart = depth;
+		if (topEnd == depth || !geometry.isSolid(x, y, topEnd)) {
+			bottomStart = topEnd;
+		} else if (next < surface.size()) {
+			bottomStart = surface[next].z;
+		}
+
+		const size_t span = out.size();
+		out.push_back(0); // length - 0 for the last span of the column
+		out.push_back((uint8_t)topStart);
+		out.push_back((uint8_t)(topEnd - 1));
+		out.push_back((uint8_t)(firstRun ? 0 : z));
+		firstRun = false;
+
+		for (int k = topStart; k < topEnd; ++k) {
+			writeColor(out, surface[idx++].color);
+		}
+
+		if (bottomStart == depth) {
+			break;
+		}
+		const int bottomEnd = successiveSurface(surface, idx, bottomStart, next);
+		if (bottomEnd < depth) {
+			out[span] = (uint8_t)(1 + topEnd - topStart + bottomEnd - bottomStart);
+			for (int k = bottomStart; k < bottomEnd; ++k) {
+				writeColor(out, surface[idx++].color);
+			}
+			z = bottomEnd;
+		} else {
+			out[span] = (uint8_t)(1 + topEnd - topStart);
+			z = bottomStart;
+		}
+	}
+}
+
 bool AoSVXLFormat::loadGroupsRGBA(const core::String& filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const voxel::Palette &palette, const LoadContext &ctx) {
-	const int64_t size = stream.size();
-	uint8_t* data = (uint8_t*)core_malloc(size);
-	if (stream.read(data, size) == -1) {
-		Log::error("Failed to read vxl stream for %s of size %i", filename.c_str(), (int)size);
-		core_free(data);
+	io::StreamData data(stream);
+	if (!data.valid()) {
+		Log::error("Failed to read vxl stream for %s", filename.c_str());
 		return false;
 	}
 
 	size_t mapSize, mapHeight;
-	if (!libvxl_size(&mapSize, &mapHeight, data, size)) {
+	if (!libvxl_size(&mapSize, &mapHeight, data.data(), data.size())) {
 		Log::error("Failed to determine vxl size");
-		core_free(data);
 		return false;
 	}
 
 	struct libvxl_map map;
 
-	if (!libvxl_create(&map, mapSize, mapSize, mapHeight, data, size)) {
+	if (!libvxl_create(&map, mapSize, mapSize, mapHeight, data.data(), data.size())) {
 		Log::error("Failed to create libvxl map");
-		core_free(data);
 		return false;
 	}
 
@@ -78,21 +244,23 @@ bool AoSVXLFormat::loadGroupsRGBA(const core::String& filename, io::SeekableRead
 	node.setVolume(volume, true);
 	voxel::PaletteLookup palLookup(palette);
 
-	for (int x = 0; x < (int)mapSize; x++) {
-		for (int y = 0; y < (int)mapSize; y++) {
-			for (int z = 0; z < (int)mapHeight; z++) {
-				if (!libvxl_map_issolid(&map, x, y, z)) {
-					continue;
+	// the map is only read here and every stripe of columns writes its own voxels
+	app::App::getInstance()->threadPool().parallelFor(0, (int)mapSize, 1, [&](int start, int end) {
+		for (int x = start; x < end; x++) {
+			for (int y = 0; y < (int)mapSize; y++) {
+				for (int z = 0; z < (int)mapHeight; z++) {
+					if (!libvxl_map_issolid(&map, x, y, z)) {
+						continue;
+					}
+					const uint32_t color = libvxl_map_get(&map, x, y, z);
+					const core::RGBA rgba = core::RGBA(vxl_red(color), vxl_green(color), vxl_blue(color));
+					const uint8_t paletteIndex = palLookup.findClosestIndex(rgba);
+					volume->setVoxel(x, (int)mapHeight - 1 - z, y, voxel::createVoxel(palette, paletteIndex));
 				}
-				const uint32_t color = libvxl_map_get(&map, x, y, z);
-				const core::RGBA rgba = core::RGBA(vxl_red(color), vxl_green(color), vxl_blue(color));
-				const uint8_t paletteIndex = palLookup.findClosestIndex(rgba);
-				volume->setVoxel(x, (int)mapHeight - 1 - z, y, voxel::createVoxel(palette, paletteIndex));
 			}
 		}
-	}
+	});
 	libvxl_free(&map);
-	core_free(data);
 
 	node.setName(filename);
 	node.setPalette(palLookup.palette());
@@ -103,18 +271,15 @@ bool AoSVXLFormat::loadGroupsRGBA(const core::String& filename, io::SeekableRead
 }
 
 size_t AoSVXLFormat::loadPalette(const core::String &filename, io::SeekableReadStream& stream, voxel::Palette &palette, const LoadContext &ctx) {
-	const int64_t size = stream.size();
-	uint8_t* data = (uint8_t*)core_malloc(size);
-	if (stream.read(data, size) == -1) {
-		Log::error("Failed to read vxl stream for %s of size %i", filename.c_str(), (int)size);
-		core_free(data);
+	io::StreamData data(stream);
+	if (!data.valid()) {
+		Log::error("Failed to read vxl stream for %s", filename.c_str());
 		return 0;
 	}
 
 	size_t mapSize, mapHeight;
-	if (!libvxl_size(&mapSize, &mapHeight, data, size)) {
+	if (!libvxl_size(&mapSize, &mapHeight, data.data(), data.size())) {
 		Log::error("Failed to determine vxl size");
-		core_free(data);
 		return 0;
 	}
 
@@ -122,27 +287,33 @@ size_t AoSVXLFormat::loadPalette(const core::String &filename, io::SeekableReadS
 
 	struct libvxl_map map;
 
-	if (!libvxl_create(&map, mapSize, mapSize, mapHeight, data, size)) {
+	if (!libvxl_create(&map, mapSize, mapSize, mapHeight, data.data(), data.size())) {
 		Log::error("Failed to create libvxl map");
-		core_free(data);
 		return 0;
 	}
 
-	core::DynamicMap<core::RGBA, bool, 11, core::RGBAHasher> colors;
-	for (int x = 0; x < (int)mapSize; x++) {
-		for (int y = 0; y < (int)mapSize; y++) {
-			for (int z = 0; z < (int)mapHeight; z++) {
-				if (!libvxl_map_issolid(&map, x, y, z)) {
-					continue;
+	ColorMap colors;
+	core_trace_mutex(core::Lock, lock, "AoSVXLPalette");
+	app::App::getInstance()->threadPool().parallelFor(0, (int)mapSize, 1, [&](int start, int end) {
+		ColorMap local;
+		for (int x = start; x < end; x++) {
+			for (int y = 0; y < (int)mapSize; y++) {
+				for (int z = 0; z < (int)mapHeight; z++) {
+					if (!libvxl_map_issolid(&map, x, y, z)) {
+						continue;
+					}
+					const uint32_t color = libvxl_map_get(&map, x, y, z);
+					const core::RGBA rgba = flattenRGB(vxl_red(color), vxl_green(color), vxl_blue(color));
+					local.put(rgba, true);
 				}
-				const uint32_t color = libvxl_map_get(&map, x, y, z);
-				const core::RGBA rgba = flattenRGB(vxl_red(color), vxl_green(color), vxl_blue(color));
-				colors.put(rgba, true);
 			}
 		}
-	}
+		core::ScopedLock scoped(lock);
+		for (const auto &e : local) {
+			colors.put(e->first, true);
+		}
+	});
 	libvxl_free(&map);
-	core_free(data);
 
 	const size_t colorCount = colors.size();
 	core::Buffer<core::RGBA> colorBuffer;
@@ -175,34 +346,60 @@ bool AoSVXLFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const co
 
 	Log::debug("Save vxl of size %i:%i:%i", mapSize, mapHeight, mapSize);
 
-	struct libvxl_map map;
-	if (!libvxl_create(&map, mapSize, mapSize, mapHeight, nullptr, 0)) {
-		Log::error("Failed to create libvxl map");
-		return false;
+	core::DynamicArray<const scenegraph::SceneGraphNode *> nodes;
+	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
+		nodes.push_back(&node);
 	}
 
-	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
-		voxelutil::visitVolume(*node.volume(), [&map, &node, mapHeight](int x, int y, int z, const voxel::Voxel &voxel) {
-			const core::RGBA rgba = node.palette().color(voxel.getColor());
-			const uint32_t color = vxl_color(rgba);
-			libvxl_map_set(&map, x, z, mapHeight - 1 - y, color);
-		});
-	}
-
-	uint8_t buf[4096];
-	struct libvxl_stream s;
-	libvxl_stream(&s, &map, sizeof(buf));
-	size_t read = 0;
-	while ((read = libvxl_stream_read(&s, buf))) {
-		if (stream.write(buf, read) == -1) {
+	MapGeometry geometry(mapSize, mapHeight);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	threadPool.parallelFor(0, mapSize, 1, [&](int start, int end) {
+		for (const scenegraph::SceneGraphNode *node : nodes) {
+			const voxel::RawVolume *volume = node->volume();
+			const voxel::Region &nodeRegion = volume->region();
+			const int minX = core_max(start, nodeRegion.getLowerX());
+			const int maxX = core_min(end - 1, nodeRegion.getUpperX());
+			const int minZ = core_max(0, nodeRegion.getLowerZ());
+			const int maxZ = core_min(mapSize - 1, nodeRegion.getUpperZ());
+			const int minY = core_max(0, nodeRegion.getLowerY());
+			const int maxY = core_min(mapHeight - 1, nodeRegion.getUpperY());
+			for (int x = minX; x <= maxX; ++x) {
+				for (int z = minZ; z <= maxZ; ++z) {
+					for (int y = minY; y <= maxY; ++y) {
+						if (!voxel::isAir(volume->voxel(x, y, z).getMaterial())) {
+							geometry.setSolid(x, z, mapHeight - 1 - y);
+						}
+					}
+				}
+			}
+		}
+	});
+
+	// every row of columns is encoded into its own buffer - they are written in order afterwards
+	core::DynamicArray<core::DynamicArray<uint8_t>> rows;
+	rows.resize(mapSize);
+	threadPool.parallelFor(0, mapSize, 1, [&](int start, int end) {
+		core::DynamicArray<SurfaceVoxel> surface;
+		for (int y = start; y < end; ++y) {
+			core::DynamicArray<uint8_t> &row = rows[y];
+			for (int x = 0; x < mapSize; ++x) {
+				surface.clear();
+				for (int z = 0; z < mapHeight; ++z) {
+					if (geometry.isSurface(x, y, z)) {
+						surface.push_back({z, surfaceColor(nodes, x, mapHeight - 1 - z, y)});
+					}
+				}
+				encodeColumn(geometry, surface, x, y, row);
+			}
+		}
+	});
+
+	for (const core::DynamicArray<uint8_t> &row : rows) {
+		if (stream.write(row.data(), row.size()) == -1) {
 			Log::error("Could not write AoE vxl file to stream");
-			libvxl_stream_free(&s);
-			libvxl_free(&map);
 			return false;
 		}
 	}
-	libvxl_stream_free(&s);
-	libvxl_free(&map);
 	return true;
 }
 
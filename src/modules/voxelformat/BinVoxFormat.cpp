@@ -5,6 +5,7 @@
 #include "BinVoxFormat.h"
 #include "core/Color.h"
 #include "core/ScopedPtr.h"
+#include "io/BufferedReadStream.h"
 #include "io/FileStream.h"
 #include "io/Stream.h"
 #include "core/StringUtil.h"
@@ -27,7 +28,7 @@ namespace voxelformat {
 		return false; \
 	}
 
-bool BinVoxFormat::readData(State& state, const core::String& filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph) {
+bool BinVoxFormat::readData(State& state, const core::String& filename, io::SeekableReadStream& in, scenegraph::SceneGraph& sceneGraph) {
 	const voxel::Region region(0, 0, 0, (int)state._d - 1, (int)state._w - 1, (int)state._h - 1);
 	if (!region.isValid()) {
 		Log::error("Invalid region found in file");
@@ -43,6 +44,7 @@ bool BinVoxFormat::readData(State& state, const core::String& filename, io::Seek
 	uint32_t index = 0;
 	uint32_t endIndex = 0;
 	const voxel::Palette &palette = node.palette();
+	io::BufferedReadStream stream(in);
 	while (endIndex < numVoxels) {
 		uint8_t value;
 		uint8_t count;
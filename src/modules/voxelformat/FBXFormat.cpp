@@ -3,6 +3,7 @@
  */
 
 #include "FBXFormat.h"
+#include "core/ArenaAllocator.h"
 #include "app/App.h"
 #include "core/Color.h"
 #include "core/Log.h"
@@ -10,7 +11,11 @@
 #include "core/String.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
+#include "core/Zip.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/StringSet.h"
 #include "engine-config.h"
+#include "io/BufferedReadWriteStream.h"
 #include "io/StdStreamBuf.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Mesh.h"
@@ -32,40 +37,423 @@ namespace voxelformat {
 bool FBXFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
 						   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
 						   bool quad, bool withColor, bool withTexCoords) {
-	return saveMeshesAscii(meshes, filename, stream, scale, quad, withColor, withTexCoords, sceneGraph);
+	return saveMeshesBinary(meshes, filename, stream, scale, quad, withColor, withTexCoords, sceneGraph);
 }
 
-class FBXScopedHeader {
+/**
+ * @brief A node record of the binary fbx format. The end offset and the size of the property list are patched
+ * when the node is closed - so the properties must be added before the first child node.
+ * https://code.blender.org/2013/08/fbx-binary-file-format-specification/
+ */
+class FBXBinaryNode {
 private:
-	io::SeekableWriteStream& _stream;
+	io::SeekableWriteStream &_stream;
+	int64_t _headerPos;
+	int64_t _propertiesPos;
+	int64_t _propertiesEndPos = -1;
+	uint32_t _properties = 0u;
+	bool _children = false;
+	bool _success = true;
+
+	// the arrays below this size are not worth the zlib header
+	static constexpr size_t CompressThreshold = 128u;
+
+	bool addArray(char type, const io::BufferedReadWriteStream &data, uint32_t length) {
+		++_properties;
+		bool ok = _stream.writeUInt8((uint8_t)type) && _stream.writeUInt32(length);
+		const uint8_t *raw = data.getBuffer();
+		const size_t rawSize = (size_t)data.size();
+		if (rawSize >= CompressThreshold) {
+			const uint32_t bound = core::zip::compressBound((uint32_t)rawSize);
+			core::DynamicArray<uint8_t> compressed(bound);
+			size_t compressedSize = 0u;
+			if (core::zip::compress(raw, rawSize, compressed.data(), bound, &compressedSize) &&
+				compressedSize < rawSize) {
+				ok = ok && _stream.writeUInt32(1u) && _stream.writeUInt32((uint32_t)compressedSize);
+				_success &= ok && _stream.write(compressed.data(), compressedSize) == (int)compressedSize;
+				return _success;
+			}
+		}
+		ok = ok && _stream.writeUInt32(0u) && _stream.writeUInt32((uint32_t)rawSize);
+		_success &= ok && (rawSize == 0u || _stream.write(raw, rawSize) == (int)rawSize);
+		return _success;
+	}
+
+	void finishProperties() {
+		if (_propertiesEndPos == -1) {
+			_propertiesEndPos = _stream.pos();
+		}
+	}
+
+public:
+	FBXBinaryNode(io::SeekableWriteStream &stream, const char *name) : _stream(stream) {
+		_headerPos = stream.pos();
+		// end offset, property count and property list size
+		_success &= stream.writeUInt32(0u) && stream.writeUInt32(0u) && stream.writeUInt32(0u);
+		const size_t nameLen = SDL_strlen(name);
+		_success &= stream.writeUInt8((uint8_t)nameLen) && stream.write(name, nameLen) == (int)nameLen;
+		_propertiesPos = stream.pos();
+	}
+
+	~FBXBinaryNode() {
+		close();
+	}
+
 	/**
-	 * @brief EndOffset is the distance from the beginning of the file to the end of the node record (i.e. the first
-	 * byte of whatever comes next). This can be used to easily skip over unknown or not required records.
+	 * @return @c false if any write of this node failed
 	 */
-	int64_t _endOffsetPos;
+	bool close() {
+		if (_headerPos == -1) {
+			return _success;
+		}
+		finishProperties();
+		if (_children) {
+			// the null record that terminates the list of child nodes
+			const uint8_t nullRecord[13]{};
+			_success &= _stream.write(nullRecord, sizeof(nullRecord)) == (int)sizeof(nullRecord);
+		}
+		const int64_t endPos = _stream.pos();
+		_stream.seek(_headerPos);
+		_success &= _stream.writeUInt32((uint32_t)endPos) && _stream.writeUInt32(_properties) &&
+					_stream.writeUInt32((uint32_t)(_propertiesEndPos - _propertiesPos));
+		_stream.seek(endPos);
+		_headerPos = -1;
+		return _success;
+	}
 
-public:
-	FBXScopedHeader(io::SeekableWriteStream& stream) : _stream(stream) {
-		_endOffsetPos = stream.pos();
-		stream.writeUInt32(0u);
+	/**
+	 * @note The properties of this node must be complete - the child must be closed before the next child is
+	 * created
+	 */
+	FBXBinaryNode child(const char *name) {
+		finishProperties();
+		_children = true;
+		return FBXBinaryNode(_stream, name);
+	}
+
+	FBXBinaryNode &addInt32(int32_t val) {
+		++_properties;
+		_success &= _stream.writeUInt8('I') && _stream.writeInt32(val);
+		return *this;
+	}
+
+	FBXBinaryNode &addInt64(int64_t val) {
+		++_properties;
+		_success &= _stream.writeUInt8('L') && _stream.writeInt64(val);
+		return *this;
+	}
+
+	FBXBinaryNode &addDouble(double val) {
+		++_properties;
+		_success &= _stream.writeUInt8('D') && _stream.writeDouble(val);
+		return *this;
 	}
 
-	~FBXScopedHeader() {
-		const int64_t currentPos = _stream.pos();
-		_stream.seek(_endOffsetPos);
-		_stream.writeUInt32(currentPos);
-		_stream.seek(currentPos);
+	FBXBinaryNode &addString(const char *str, size_t len) {
+		++_properties;
+		_success &= _stream.writeUInt8('S') && _stream.writeUInt32((uint32_t)len) &&
+					(len == 0u || _stream.write(str, len) == (int)len);
+		return *this;
+	}
+
+	FBXBinaryNode &addString(const core::String &str) {
+		return addString(str.c_str(), str.size());
+	}
+
+	FBXBinaryNode &addRaw(const uint8_t *data, size_t len) {
+		++_properties;
+		_success &= _stream.writeUInt8('R') && _stream.writeUInt32((uint32_t)len) &&
+					_stream.write(data, len) == (int)len;
+		return *this;
+	}
+
+	/**
+	 * @brief The object names are the name and the class separated by @c \\x00\\x01
+	 */
+	FBXBinaryNode &addObjectName(const core::String &name, const char *className) {
+		core::String str = name;
+		str.append("\x00\x01", 2);
+		str.append(className);
+		return addString(str);
+	}
+
+	FBXBinaryNode &addDoubleArray(const core::DynamicArray<double> &vals) {
+		io::BufferedReadWriteStream data((int64_t)(vals.size() * sizeof(double)));
+		data.writeDoubleArray(vals.data(), vals.size());
+		addArray('d', data, (uint32_t)vals.size());
+		return *this;
+	}
+
+	FBXBinaryNode &addInt32Array(const core::DynamicArray<int32_t> &vals) {
+		io::BufferedReadWriteStream data((int64_t)(vals.size() * sizeof(int32_t)));
+		data.writeInt32Array(vals.data(), vals.size());
+		addArray('i', data, (uint32_t)vals.size());
+		return *this;
 	}
 };
 
+/**
+ * @brief Adds a property of a @c Properties70 node
+ */
+static void addProperty(FBXBinaryNode &properties, const char *name, const char *type, const char *label,
+						int32_t value) {
+	FBXBinaryNode p = properties.child("P");
+	p.addString(name, SDL_strlen(name)).addString(type, SDL_strlen(type)).addString(label, SDL_strlen(label));
+	p.addString("", 0).addInt32(value);
+}
+
+static void addProperty(FBXBinaryNode &properties, const char *name, const char *type, const char *label,
+						double value) {
+	FBXBinaryNode p = properties.child("P");
+	p.addString(name, SDL_strlen(name)).addString(type, SDL_strlen(type)).addString(label, SDL_strlen(label));
+	p.addString("", 0).addDouble(value);
+}
+
+// the file id, the creation time and the footer id belong together - the values are taken from the blender exporter
+static const uint8_t FBXFileId[16] = {0x28, 0xb3, 0x2a, 0xeb, 0xb6, 0x24, 0xcc, 0xc2,
+									   0xbf, 0xc8, 0xb0, 0x2a, 0xa9, 0x2b, 0xfc, 0xf1};
+static const char *FBXCreationTime = "1970-01-01 10:00:00:000";
+static const uint8_t FBXFooterId[16] = {0xfa, 0xbc, 0xab, 0x09, 0xd0, 0xc8, 0xd4, 0x66,
+										 0xb1, 0x76, 0xfb, 0x83, 0x1c, 0xf7, 0x26, 0x7e};
+static const uint8_t FBXFooterMagic[16] = {0xf8, 0x5a, 0x8c, 0x6a, 0xde, 0xf5, 0xd9, 0x7e,
+										   0xec, 0xe9, 0x0c, 0xe3, 0x75, 0x8f, 0x29, 0x0b};
+static constexpr uint32_t FBXBinaryVersion = 7400u;
+
 bool FBXFormat::saveMeshesBinary(const Meshes &meshes, const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad,
 					bool withColor, bool withTexCoords, const scenegraph::SceneGraph &sceneGraph) {
 	wrapBool(stream.writeString("Kaydara FBX Binary  ", true))
-	stream.writeUInt8(0x1A);  // unknown
-	stream.writeUInt8(0x00);  // unknown
-	stream.writeUInt32(7300); // version
-	// TODO: implement me https://code.blender.org/2013/08/fbx-binary-file-format-specification/
-	return false;
+	wrapBool(stream.writeUInt8(0x1A)) // unknown
+	wrapBool(stream.writeUInt8(0x00)) // unknown
+	wrapBool(stream.writeUInt32(FBXBinaryVersion))
+
+	int meshCount = 0;
+	for (const MeshExt &meshExt : meshes) {
+		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+			if (!meshExt.mesh->mesh[i].isEmpty()) {
+				++meshCount;
+			}
+		}
+	}
+	Log::debug("Exporting %i layers", meshCount);
+
+	const core::String creator = core::string::format("github.com/mgerhardy/vengi %s", PROJECT_VERSION);
+	{
+		FBXBinaryNode headerExtension(stream, "FBXHeaderExtension");
+		headerExtension.child("FBXHeaderVersion").addInt32(1003);
+		headerExtension.child("FBXVersion").addInt32((int32_t)FBXBinaryVersion);
+		headerExtension.child("Creator").addString(creator);
+		wrapBool(headerExtension.close())
+	}
+	FBXBinaryNode(stream, "FileId").addRaw(FBXFileId, sizeof(FBXFileId));
+	FBXBinaryNode(stream, "CreationTime").addString(FBXCreationTime, SDL_strlen(FBXCreationTime));
+	FBXBinaryNode(stream, "Creator").addString(creator);
+	{
+		FBXBinaryNode globalSettings(stream, "GlobalSettings");
+		globalSettings.child("Version").addInt32(1000);
+		FBXBinaryNode properties = globalSettings.child("Properties70");
+		addProperty(properties, "UpAxis", "int", "Integer", 1);
+		addProperty(properties, "UpAxisSign", "int", "Integer", 1);
+		addProperty(properties, "FrontAxis", "int", "Integer", 2);
+		addProperty(properties, "FrontAxisSign", "int", "Integer", 1);
+		addProperty(properties, "CoordAxis", "int", "Integer", 0);
+		addProperty(properties, "CoordAxisSign", "int", "Integer", 1);
+		addProperty(properties, "UnitScaleFactor", "double", "Number", 1.0);
+		properties.close();
+		wrapBool(globalSettings.close())
+	}
+	{
+		FBXBinaryNode definitions(stream, "Definitions");
+		definitions.child("Version").addInt32(100);
+		definitions.child("Count").addInt32(1 + 2 * meshCount);
+		{
+			FBXBinaryNode objectType = definitions.child("ObjectType");
+			objectType.addString("GlobalSettings", 14);
+			objectType.child("Count").addInt32(1);
+		}
+		{
+			FBXBinaryNode objectType = definitions.child("ObjectType");
+			objectType.addString("Model", 5);
+			objectType.child("Count").addInt32(meshCount);
+		}
+		{
+			FBXBinaryNode objectType = definitions.child("ObjectType");
+			objectType.addString("Geometry", 8);
+			objectType.child("Count").addInt32(meshCount);
+		}
+		wrapBool(definitions.close())
+	}
+
+	// the geometry and model ids of the meshes - they are connected in the Connections node
+	core::DynamicArray<int64_t> ids;
+	ids.reserve(meshCount * 2);
+	{
+		FBXBinaryNode objects(stream, "Objects");
+		core::DynamicArray<double> positions;
+		core::DynamicArray<int32_t> polygonVertexIndices;
+		core::DynamicArray<double> layerData;
+		for (const MeshExt &meshExt : meshes) {
+			const scenegraph::SceneGraphNode &graphNode = sceneGraph.node(meshExt.nodeId);
+			const voxel::Palette &palette = graphNode.palette();
+			const scenegraph::KeyFrameIndex keyFrameIdx = 0;
+			const scenegraph::SceneGraphTransform &transform = graphNode.transform(keyFrameIdx);
+			core::String objectName = meshExt.name;
+			if (objectName.empty()) {
+				objectName = "Noname";
+			}
+			for (int m = 0; m < voxel::ChunkMesh::Meshes; ++m) {
+				const voxel::Mesh *mesh = &meshExt.mesh->mesh[m];
+				if (mesh->isEmpty()) {
+					continue;
+				}
+				Log::debug("Exporting layer %s", objectName.c_str());
+				const int nv = (int)mesh->getNoOfVertices();
+				const int ni = (int)mesh->getNoOfIndices();
+				if (ni % 3 != 0) {
+					Log::error("Unexpected indices amount");
+					return false;
+				}
+				const voxel::VoxelVertex *vertices = mesh->getRawVertexData();
+				const voxel::IndexType *indices = mesh->getRawIndexData();
+
+				positions.clear();
+				positions.reserve(nv * 3);
+				for (int i = 0; i < nv; ++i) {
+					glm::vec3 pos;
+					if (meshExt.applyTransform) {
+						pos = transform.apply(vertices[i].position, meshExt.pivot * meshExt.size);
+					} else {
+						pos = vertices[i].position;
+					}
+					pos *= scale;
+					positions.push_back(pos.x);
+					positions.push_back(pos.y);
+					positions.push_back(pos.z);
+				}
+
+				// the last index of a polygon is stored as its bitwise negation
+				polygonVertexIndices.clear();
+				if (quad && ni % 6 == 0) {
+					polygonVertexIndices.reserve(ni / 6 * 4);
+					for (int i = 0; i < ni; i += 6) {
+						polygonVertexIndices.push_back((int32_t)indices[i + 0]);
+						polygonVertexIndices.push_back((int32_t)indices[i + 1]);
+						polygonVertexIndices.push_back((int32_t)indices[i + 2]);
+						polygonVertexIndices.push_back(~(int32_t)indices[i + 5]);
+					}
+				} else {
+					polygonVertexIndices.reserve(ni);
+					for (int i = 0; i < ni; i += 3) {
+						polygonVertexIndices.push_back((int32_t)indices[i + 0]);
+						polygonVertexIndices.push_back((int32_t)indices[i + 1]);
+						polygonVertexIndices.push_back(~(int32_t)indices[i + 2]);
+					}
+				}
+
+				const int64_t geometryId = 1000000 + (int64_t)ids.size();
+				const int64_t modelId = geometryId + 1;
+				ids.push_back(geometryId);
+				ids.push_back(modelId);
+
+				{
+					FBXBinaryNode geometry = objects.child("Geometry");
+					geometry.addInt64(geometryId).addObjectName(objectName, "Geometry").addString("Mesh", 4);
+					geometry.child("Vertices").addDoubleArray(positions);
+					geometry.child("PolygonVertexIndex").addInt32Array(polygonVertexIndices);
+					geometry.child("GeometryVersion").addInt32(124);
+
+					if (withColor) {
+						layerData.clear();
+						layerData.reserve(polygonVertexIndices.size() * 4);
+						for (int32_t idx : polygonVertexIndices) {
+							const voxel::VoxelVertex &v = vertices[idx < 0 ? ~idx : idx];
+							const glm::vec4 &color = core::Color::fromRGBA(palette.color(v.colorIndex));
+							layerData.push_back(color.r);
+							layerData.push_back(color.g);
+							layerData.push_back(color.b);
+							layerData.push_back(color.a);
+						}
+						FBXBinaryNode layerElement = geometry.child("LayerElementColor");
+						layerElement.addInt32(0);
+						layerElement.child("Version").addInt32(101);
+						layerElement.child("Name").addString(objectName + "Colors");
+						layerElement.child("MappingInformationType").addString("ByPolygonVertex", 15);
+						layerElement.child("ReferenceInformationType").addString("Direct", 6);
+						layerElement.child("Colors").addDoubleArray(layerData);
+					}
+					if (withTexCoords) {
+						layerData.clear();
+						layerData.reserve(polygonVertexIndices.size() * 2);
+						for (int32_t idx : polygonVertexIndices) {
+							const voxel::VoxelVertex &v = vertices[idx < 0 ? ~idx : idx];
+							const glm::vec2 &uv = paletteUV(v.colorIndex);
+							layerData.push_back(uv.x);
+							layerData.push_back(uv.y);
+						}
+						FBXBinaryNode layerElement = geometry.child("LayerElementUV");
+						layerElement.addInt32(0);
+						layerElement.child("Version").addInt32(101);
+						layerElement.child("Name").addString(objectName + "UV");
+						layerElement.child("MappingInformationType").addString("ByPolygonVertex", 15);
+						layerElement.child("ReferenceInformationType").addString("Direct", 6);
+						layerElement.child("UV").addDoubleArray(layerData);
+					}
+					if (withColor || withTexCoords) {
+						FBXBinaryNode layer = geometry.child("Layer");
+						layer.addInt32(0);
+						layer.child("Version").addInt32(100);
+						if (withColor) {
+							FBXBinaryNode layerElement = layer.child("LayerElement");
+							layerElement.child("Type").addString("LayerElementColor", 17);
+							layerElement.child("TypedIndex").addInt32(0);
+						}
+						if (withTexCoords) {
+							FBXBinaryNode layerElement = layer.child("LayerElement");
+							layerElement.child("Type").addString("LayerElementUV", 14);
+							layerElement.child("TypedIndex").addInt32(0);
+						}
+					}
+					wrapBool(geometry.close())
+				}
+				{
+					FBXBinaryNode model = objects.child("Model");
+					model.addInt64(modelId).addObjectName(objectName, "Model").addString("Mesh", 4);
+					model.child("Version").addInt32(232);
+					model.child("Culling").addString("CullingOff", 10);
+					wrapBool(model.close())
+				}
+			}
+		}
+		wrapBool(objects.close())
+	}
+	{
+		FBXBinaryNode connections(stream, "Connections");
+		for (size_t i = 0; i < ids.size(); i += 2) {
+			// geometry to model and model to the root node
+			connections.child("C").addString("OO", 2).addInt64(ids[i]).addInt64(ids[i + 1]);
+			connections.child("C").addString("OO", 2).addInt64(ids[i + 1]).addInt64(0);
+		}
+		wrapBool(connections.close())
+	}
+
+	// the null record that terminates the top level nodes and the footer
+	const uint8_t nullRecord[13]{};
+	wrapBool(stream.write(nullRecord, sizeof(nullRecord)) == (int)sizeof(nullRecord))
+	wrapBool(stream.write(FBXFooterId, sizeof(FBXFooterId)) == (int)sizeof(FBXFooterId))
+	wrapBool(stream.writeUInt32(0u))
+	const int64_t pos = stream.pos();
+	int64_t padding = ((pos + 15) & ~15) - pos;
+	if (padding == 0) {
+		padding = 16;
+	}
+	for (int64_t i = 0; i < padding; ++i) {
+		wrapBool(stream.writeUInt8(0u))
+	}
+	wrapBool(stream.writeUInt32(FBXBinaryVersion))
+	for (int i = 0; i < 120; ++i) {
+		wrapBool(stream.writeUInt8(0u))
+	}
+	wrapBool(stream.write(FBXFooterMagic, sizeof(FBXFooterMagic)) == (int)sizeof(FBXFooterMagic))
+	return true;
 }
 
 // https://github.com/blender/blender/blob/00e219d8e97afcf3767a6d2b28a6d05bcc984279/release/io/export_fbx.py
@@ -260,6 +648,18 @@ static void *_ufbx_realloc_fn(void *user, void *old_ptr, size_t old_size, size_t
 	return core_realloc(old_ptr, new_size);
 }
 
+static void *_ufbx_arena_alloc(void *user, size_t size) {
+	return ((core::ArenaAllocator *)user)->alloc(size);
+}
+
+static void _ufbx_arena_free(void *, void *, size_t) {
+	// released at once at the end of the load
+}
+
+static void *_ufbx_arena_realloc_fn(void *user, void *old_ptr, size_t old_size, size_t new_size) {
+	return ((core::ArenaAllocator *)user)->realloc(old_ptr, old_size, new_size);
+}
+
 static size_t _ufbx_read_fn(void *user, void *data, size_t size) {
 	io::SeekableReadStream *stream = (io::SeekableReadStream *)user;
 	const int ret = stream->read(data, size);
@@ -465,13 +865,26 @@ bool FBXFormat::voxelizeGroups(const core::String &filename, io::SeekableReadStr
 	ufbx_load_opts ufbxopts;
 	core_memset(&ufbxopts, 0, sizeof(ufbxopts));
 
-	ufbxopts.temp_allocator.allocator.alloc_fn = priv::_ufbx_alloc;
-	ufbxopts.temp_allocator.allocator.free_fn = priv::_ufbx_free;
-	ufbxopts.temp_allocator.allocator.realloc_fn = priv::_ufbx_realloc_fn;
+	if (ctx.arena != nullptr) {
+		// the ufbx scene is freed before the load returns - so the result doesn't outlive the arena either
+		ufbxopts.temp_allocator.allocator.alloc_fn = priv::_ufbx_arena_alloc;
+		ufbxopts.temp_allocator.allocator.free_fn = priv::_ufbx_arena_free;
+		ufbxopts.temp_allocator.allocator.realloc_fn = priv::_ufbx_arena_realloc_fn;
+		ufbxopts.temp_allocator.allocator.user = ctx.arena;
+
+		ufbxopts.result_allocator.allocator.alloc_fn = priv::_ufbx_arena_alloc;
+		ufbxopts.result_allocator.allocator.free_fn = priv::_ufbx_arena_free;
+		ufbxopts.result_allocator.allocator.realloc_fn = priv::_ufbx_arena_realloc_fn;
+		ufbxopts.result_allocator.allocator.user = ctx.arena;
+	} else {
+		ufbxopts.temp_allocator.allocator.alloc_fn = priv::_ufbx_alloc;
+		ufbxopts.temp_allocator.allocator.free_fn = priv::_ufbx_free;
+		ufbxopts.temp_allocator.allocator.realloc_fn = priv::_ufbx_realloc_fn;
 
-	ufbxopts.result_allocator.allocator.alloc_fn = priv::_ufbx_alloc;
-	ufbxopts.result_allocator.allocator.free_fn = priv::_ufbx_free;
-	ufbxopts.result_allocator.allocator.realloc_fn = priv::_ufbx_realloc_fn;
+		ufbxopts.result_allocator.allocator.alloc_fn = priv::_ufbx_alloc;
+		ufbxopts.result_allocator.allocator.free_fn = priv::_ufbx_free;
+		ufbxopts.result_allocator.allocator.realloc_fn = priv::_ufbx_realloc_fn;
+	}
 
 	ufbxopts.path_separator = '/';
 
@@ -484,7 +897,13 @@ bool FBXFormat::voxelizeGroups(const core::String &filename, io::SeekableReadStr
 
 	ufbx_error ufbxerror;
 
-	ufbx_scene *ufbxscene = ufbx_load_stream(&ufbxstream, &ufbxopts, &ufbxerror);
+	ufbx_scene *ufbxscene;
+	if (stream.data() != nullptr) {
+		// memory backed streams (e.g. mapped files) are parsed in place
+		ufbxscene = ufbx_load_memory(stream.data() + stream.pos(), (size_t)stream.remaining(), &ufbxopts, &ufbxerror);
+	} else {
+		ufbxscene = ufbx_load_stream(&ufbxstream, &ufbxopts, &ufbxerror);
+	}
 	if (!ufbxscene) {
 		Log::error("Failed to load: %s", ufbxerror.description.data);
 		return false;
@@ -496,6 +915,8 @@ bool FBXFormat::voxelizeGroups(const core::String &filename, io::SeekableReadStr
 	}
 
 	core::StringMap<image::ImagePtr> textures;
+	core::DynamicArray<TextureSource> sources;
+	core::StringSet materials;
 	for (size_t i = 0; i < ufbxscene->meshes.count; ++i) {
 		const ufbx_mesh *mesh = ufbxscene->meshes[i];
 		for (size_t pi = 0; pi < mesh->materials.count; pi++) {
@@ -521,23 +942,21 @@ bool FBXFormat::voxelizeGroups(const core::String &filename, io::SeekableReadStr
 			/*if (material->features.ior.enabled) {
 			}*/
 
-			if (textures.hasKey(texname)) {
-				Log::debug("Texture for material '%s' is already loaded", texname.c_str());
+			if (materials.has(texname)) {
+				Log::debug("Texture for material '%s' is already queued", texname.c_str());
 				continue;
 			}
+			materials.insert(texname);
 
 			const core::String &relativeFilename = priv::_ufbx_to_string(texture ? texture->relative_filename : material->name);
-			const core::String &name = lookupTexture(filename, relativeFilename);
-			image::ImagePtr tex = image::loadImage(name);
-			if (tex->isLoaded()) {
-				Log::debug("Use image %s", name.c_str());
-				textures.put(texname, tex);
-			} else {
-				Log::debug("Failed to load image %s", relativeFilename.c_str());
-				textures.put(texname, image::ImagePtr());
-			}
+			TextureSource source;
+			source.name = texname;
+			source.file = lookupTexture(filename, relativeFilename);
+			sources.push_back(source);
 		}
 	}
+	// decode all the textures in parallel before the meshes are voxelized
+	loadTextures(sources, textures);
 
 	const ufbx_node *root = ufbxscene->root_node;
 	for (const ufbx_node *c : root->children) {
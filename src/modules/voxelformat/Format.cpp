@@ -27,6 +27,47 @@
 
 namespace voxelformat {
 
+bool ModelFilter::parseIndices(const core::String &expression) {
+	core::DynamicArray<core::String> tokens;
+	core::string::splitString(expression, tokens, ",");
+	if (tokens.empty()) {
+		return false;
+	}
+	for (const core::String &token : tokens) {
+		const size_t index = token.find("-");
+		if (index != core::String::npos) {
+			const int start = token.toInt();
+			const int end = token.substr(index + 1).toInt();
+			if (end < start) {
+				return false;
+			}
+			for (int modelIndex = start; modelIndex <= end; ++modelIndex) {
+				indices.insert(modelIndex);
+			}
+		} else {
+			indices.insert(token.toInt());
+		}
+	}
+	return true;
+}
+
+bool ModelFilter::empty() const {
+	return indices.empty() && name.empty() && !region.isValid();
+}
+
+bool ModelFilter::accept(int modelIndex, const core::String &modelName, const voxel::Region &modelRegion) const {
+	if (!indices.empty() && !indices.has(modelIndex)) {
+		return false;
+	}
+	if (!name.empty() && !core::string::matches(modelName, name)) {
+		return false;
+	}
+	if (region.isValid() && !voxel::intersects(region, modelRegion)) {
+		return false;
+	}
+	return true;
+}
+
 core::String Format::stringProperty(const scenegraph::SceneGraphNode* node, const core::String &name, const core::String &defaultVal) {
 	if (node == nullptr) {
 		return defaultVal;
@@ -132,6 +173,20 @@ size_t PaletteFormat::loadPalette(const core::String &filename, io::SeekableRead
 	return palette.size();
 }
 
+bool Format::loadMetadata(const core::String &filename, io::SeekableReadStream &stream, FormatMetadata &metadata, const LoadContext &ctx) {
+	scenegraph::SceneGraph sceneGraph;
+	if (!load(filename, stream, sceneGraph, ctx)) {
+		return false;
+	}
+	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
+		metadata.models.push_back({node.name(), node.region()});
+	}
+	if (!sceneGraph.empty()) {
+		metadata.palette = sceneGraph.firstPalette();
+	}
+	return true;
+}
+
 image::ImagePtr Format::loadScreenshot(const core::String &filename, io::SeekableReadStream &, const LoadContext &) {
 	Log::debug("%s doesn't have a supported embedded screenshot", filename.c_str());
 	return image::ImagePtr();
@@ -9,14 +9,20 @@
 #pragma once
 
 #include "io/Stream.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/Set.h"
+#include "voxel/Palette.h"
 #include "voxel/RawVolume.h"
 #include "image/Image.h"
 #include "voxelformat/FormatThumbnail.h"
 #include <glm/fwd.hpp>
 
+namespace core {
+class ArenaAllocator;
+}
+
 namespace voxel {
 class Mesh;
-class Palette;
 }
 
 namespace scenegraph {
@@ -28,14 +34,64 @@ namespace voxelformat {
 
 typedef void (*ProgressMonitor)(const char *name, int cur, int max);
 
+/**
+ * @brief Selects the model nodes of a file that are loaded
+ *
+ * The formats with per-node records check this before the voxels of a model are decoded - the rejected models are
+ * not added to the scene graph at all.
+ * @sa LoadContext::acceptModel()
+ */
+struct ModelFilter {
+	/** the indices of the models in the order they appear in the file - empty means all models */
+	core::Set<int> indices;
+	/** wildcard pattern for the model names - empty means all models */
+	core::String name;
+	/** the region of a model as it is stored in the file must intersect this region - invalid means all models */
+	voxel::Region region = voxel::Region::InvalidRegion;
+	/**
+	 * @brief Set by the formats that support the filter - if this is still @c false after the load, the filter must
+	 * be applied to the loaded scene graph
+	 */
+	bool applied = false;
+
+	/**
+	 * @brief Parses an expression like @c 1-4,6 into the model indices
+	 */
+	bool parseIndices(const core::String &expression);
+	bool empty() const;
+	bool accept(int modelIndex, const core::String &modelName, const voxel::Region &modelRegion) const;
+};
+
 struct LoadContext {
 	ProgressMonitor monitor = nullptr;
+	/**
+	 * If not @c null only the models that are accepted by this filter are loaded
+	 */
+	ModelFilter *modelFilter = nullptr;
+	/**
+	 * Transient memory for the parsers - released at once after the load. Nothing that ends up in the scene graph
+	 * may be allocated from here.
+	 * @sa loadFormat()
+	 */
+	core::ArenaAllocator *arena = nullptr;
 	inline void progress(const char *name, int cur, int max) const  {
 		if (monitor == nullptr) {
 			return;
 		}
 		monitor(name, cur, max);
 	}
+	/**
+	 * @param modelIndex The index of the model in the order the models appear in the file - count the rejected
+	 * models, too
+	 * @return @c false if the voxels of the model should be skipped and the node should not be added
+	 */
+	inline bool acceptModel(int modelIndex, const core::String &name, const voxel::Region &region) const {
+		if (modelFilter == nullptr) {
+			return true;
+		}
+		modelFilter->applied = true;
+		return modelFilter->accept(modelIndex, name, region);
+	}
 };
 struct SaveContext {
 	ProgressMonitor monitor = nullptr;
@@ -52,6 +108,23 @@ struct SaveContext {
 	ThumbnailCreator thumbnailCreator = nullptr;
 };
 
+/**
+ * @brief The name and the size of a model node
+ */
+struct ModelMetadata {
+	core::String name;
+	voxel::Region region;
+};
+
+/**
+ * @brief Everything that can be known about a file without loading the voxel data
+ * @sa Format::loadMetadata()
+ */
+struct FormatMetadata {
+	core::DynamicArray<ModelMetadata> models;
+	voxel::Palette palette;
+};
+
 // the max amount of voxels - [0-255]
 static constexpr int MaxRegionSize = 256;
 
@@ -154,6 +227,12 @@ public:
 	 * @return the amount of colors found in the palette
 	 */
 	virtual size_t loadPalette(const core::String &filename, io::SeekableReadStream& stream, voxel::Palette &palette, const LoadContext &ctx);
+	/**
+	 * @brief Only load the model names, their regions and the palette - but not the voxels
+	 * @note The default implementation goes the expensive route and loads the whole scene graph. Formats that have
+	 * the sizes in their node headers should implement this to skip the voxel data.
+	 */
+	virtual bool loadMetadata(const core::String &filename, io::SeekableReadStream& stream, FormatMetadata &metadata, const LoadContext &ctx);
 	virtual bool load(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const LoadContext &ctx);
 	virtual bool save(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx);
 };
@@ -16,7 +16,7 @@ static bool colorReductionValidator(const core::String& value) {
 
 bool FormatConfig::init() {
 	core::Var::get(cfg::CoreColorReduction,
-				   core::Color::toColorReductionTypeString(core::Color::ColorReductionType::MedianCut),
+				   core::Color::toColorReductionTypeString(core::Color::ColorReductionType::Wu),
 				   "Controls the algorithm that is used to perform the color reduction", colorReductionValidator);
 	core::Var::get(cfg::VoxformatMergequads, "true", core::CV_NOPERSIST, "Merge similar quads to optimize the mesh", core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatMarchingCubes, "false", core::CV_NOPERSIST, "Don't export cubes, but a mesh that is polygonized by the marching cubes algorithm", core::Var::boolValidator);
@@ -33,6 +33,17 @@ bool FormatConfig::init() {
 	core::Var::get(cfg::VoxformatScaleZ, "1.0", core::CV_NOPERSIST, "Scale the vertices on Z axis by the given factor");
 	core::Var::get(cfg::VoxformatQuads, "true", core::CV_NOPERSIST,
 				   "Export as quads. If this false, triangles will be used.", core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatOptimize, "false", core::CV_NOPERSIST,
+				   "Reorder the mesh indices and vertices for the vertex cache of the gpu", core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatSimplify, "1.0", core::CV_NOPERSIST,
+				   "Reduce the mesh to this ratio of its triangles - 1.0 disables the simplification");
+	core::Var::get(cfg::VoxformatSimplifyError, "1.0", core::CV_NOPERSIST,
+				   "The max distance in voxels the mesh simplification may move the surface - negative values don't limit it");
+	core::Var::get(cfg::VoxformatBakeAmbientOcclusion, "false", core::CV_NOPERSIST,
+				   "Trace rays through the volume and darken the exported vertex colors by the ambient occlusion", core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatTextureMaxSize, "0", core::CV_NOPERSIST,
+				   "Scale the textures of imported meshes down to this width and height - 0 keeps the full resolution",
+				   [](const core::String &var) { return var.toInt() >= 0; });
 	core::Var::get(cfg::VoxformatWithcolor, "true", core::CV_NOPERSIST, "Export with vertex colors", core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatWithtexcoords, "true", core::CV_NOPERSIST,
 				   "Export with uv coordinates of the palette image", core::Var::boolValidator);
@@ -49,6 +60,8 @@ bool FormatConfig::init() {
 				"Use palette mode in qubicle qbt export", core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatQBTMergeCompounds, "false", core::CV_NOPERSIST,
 				"Merge compounds on load", core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatMCRBounds, "", core::CV_NOPERSIST,
+				"Only import the blocks of a minecraft region in the given world coordinates. Either 'miny maxy' or 'minx miny minz maxx maxy maxz'");
 	core::Var::get(cfg::VoxelPalette, voxel::Palette::getDefaultPaletteName(),
 				   "This is the NAME part of palette-<NAME>.png or absolute png file to use (1x256)");
 	core::Var::get(cfg::VoxformatMerge, "false", core::CV_NOPERSIST, "Merge all objects into one", core::Var::boolValidator);
@@ -58,6 +71,8 @@ bool FormatConfig::init() {
 				"Merge compounds on load", core::Var::boolValidator);
 	core::Var::get(cfg::VoxformatQBSaveLeftHanded, "true", core::CV_NOPERSIST,
 				"Toggle between left and right handed", core::Var::boolValidator);
+	core::Var::get(cfg::VoxformatGLTFQuantize, "false", core::CV_NOPERSIST,
+				"Store the gltf vertex attributes as integers (KHR_mesh_quantization)", core::Var::boolValidator);
 	core::Var::get(cfg::VoxelCreatePalette, "true", core::CV_NOPERSIST,
 				"Create own palette from textures or colors - not used for palette formats", core::Var::boolValidator);
 
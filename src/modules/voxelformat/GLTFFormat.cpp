@@ -6,10 +6,12 @@
 #include "app/App.h"
 #include "core/Color.h"
 #include "core/FourCC.h"
+#include "core/GameConfig.h"
 #include "core/Log.h"
 #include "core/RGBA.h"
 #include "core/String.h"
 #include "core/StringUtil.h"
+#include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "engine-config.h"
 #include "image/Image.h"
@@ -47,6 +49,38 @@ static int addBuffer(tinygltf::Model &gltfModel, io::BufferedReadWriteStream &st
 	return (int)(gltfModel.buffers.size() - 1);
 }
 
+/**
+ * @brief The key of the image in the texture map
+ */
+static core::String imageName(const tinygltf::Model &gltfModel, int imageIndex) {
+	const tinygltf::Image &gltfImage = gltfModel.images[imageIndex];
+	if (!gltfImage.uri.empty()) {
+		return gltfImage.uri.c_str();
+	}
+	if (!gltfImage.name.empty()) {
+		return gltfImage.name.c_str();
+	}
+	return core::string::format("image%i", imageIndex);
+}
+
+/**
+ * @brief Keeps the encoded images instead of decoding them one after another while the gltf is parsed - they are
+ * decoded in parallel by @c MeshFormat::loadTextures()
+ */
+static bool keepImageData(tinygltf::Image *, const int imageIndex, std::string *, std::string *, int, int,
+						  const unsigned char *bytes, int size, void *userData) {
+	core::DynamicArray<core::DynamicArray<uint8_t>> *encodedImages =
+		(core::DynamicArray<core::DynamicArray<uint8_t>> *)userData;
+	if (imageIndex >= (int)encodedImages->size()) {
+		encodedImages->resize(imageIndex + 1);
+	}
+	// the bytes of external files and data uris are only valid during this call
+	core::DynamicArray<uint8_t> &encoded = (*encodedImages)[imageIndex];
+	encoded.clear();
+	encoded.append(bytes, size);
+	return true;
+}
+
 static image::TextureWrap convertTextureWrap(int wrap) {
 	if (wrap == TINYGLTF_TEXTURE_WRAP_REPEAT) {
 		return image::TextureWrap::Repeat;
@@ -78,6 +112,41 @@ static core::RGBA toColor(const tinygltf::Accessor *gltfAttributeAccessor, const
 	return core::RGBA(0, 0, 0, 255);
 }
 
+/**
+ * @brief Reads a float or a (normalized) integer vector component - see KHR_mesh_quantization
+ */
+static bool toFloat(const tinygltf::Accessor *gltfAttributeAccessor, const uint8_t *buf, int component, float &out) {
+	const bool normalized = gltfAttributeAccessor->normalized;
+	switch (gltfAttributeAccessor->componentType) {
+	case TINYGLTF_COMPONENT_TYPE_FLOAT:
+		out = ((const float *)buf)[component];
+		return true;
+	case TINYGLTF_COMPONENT_TYPE_BYTE: {
+		const float v = (float)((const int8_t *)buf)[component];
+		out = normalized ? glm::max(v / 127.0f, -1.0f) : v;
+		return true;
+	}
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE: {
+		const float v = (float)buf[component];
+		out = normalized ? v / 255.0f : v;
+		return true;
+	}
+	case TINYGLTF_COMPONENT_TYPE_SHORT: {
+		const float v = (float)((const int16_t *)buf)[component];
+		out = normalized ? glm::max(v / 32767.0f, -1.0f) : v;
+		return true;
+	}
+	case TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT: {
+		const float v = (float)((const uint16_t *)buf)[component];
+		out = normalized ? v / 65535.0f : v;
+		return true;
+	}
+	default:
+		break;
+	}
+	return false;
+}
+
 template <typename T>
 void copyGltfIndices(const uint8_t *data, size_t count, size_t stride, core::DynamicArray<uint32_t> &indices,
 					 uint32_t offset) {
@@ -159,17 +228,34 @@ void GLTFFormat::saveGltfNode(core::Map<int, int> &nodeMapping, tinygltf::Model
 	}
 }
 
-bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
+bool GLTFFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph,
 							const Meshes &meshes, const core::String &filename, io::SeekableWriteStream &stream,
 							const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) {
+	MeshQueue queue(sceneGraph, meshes);
+	return saveMeshQueue(sceneGraph, queue, filename, stream, scale, quad, withColor, withTexCoords);
+}
+
+static void collectNodeOrder(const scenegraph::SceneGraph &sceneGraph, int nodeId, core::DynamicArray<int> &nodeIds) {
+	const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	nodeIds.push_back(nodeId);
+	for (int child : node.children()) {
+		collectNodeOrder(sceneGraph, child, nodeIds);
+	}
+}
+
+bool GLTFFormat::saveMeshQueue(const scenegraph::SceneGraph &sceneGraph, MeshQueue &queue,
+							   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
+							   bool quad, bool withColor, bool withTexCoords) {
 	const core::String &ext = core::string::extractExtension(filename);
 	const bool writeBinary = ext == "glb";
+	const bool quantize = core::Var::getSafe(cfg::VoxformatGLTFQuantize)->boolVal();
+	bool usedQuantization = false;
 
 	tinygltf::TinyGLTF gltf;
 	tinygltf::Model gltfModel;
 	tinygltf::Scene gltfScene;
 
-	const size_t modelNodes = meshes.size();
+	const size_t modelNodes = sceneGraph.size();
 	const core::String &appname = app::App::getInstance()->appname();
 	const core::String &generator = core::string::format("%s " PROJECT_VERSION, appname.c_str());
 	// Define the asset. The version is required
@@ -178,6 +264,13 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 	gltfModel.asset.copyright = sceneGraph.root().property("Copyright").c_str();
 	gltfModel.accessors.reserve(modelNodes * 4 + sceneGraph.animations().size() * 4);
 
+	// the nodes are visited in depth first order - the meshes must be extracted in the same order
+	core::DynamicArray<int> nodeOrder;
+	nodeOrder.reserve(sceneGraph.nodeSize());
+	collectNodeOrder(sceneGraph, sceneGraph.root().id(), nodeOrder);
+	queue.setNodeOrder(nodeOrder);
+	const MeshExt *nextMeshExt = queue.next();
+
 	Stack stack;
 	stack.emplace_back(0, -1);
 
@@ -185,6 +278,7 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 
 	core::Map<uint64_t, int> paletteMaterialIndices((int)sceneGraph.size());
 	core::Map<int, int> nodeMapping((int)sceneGraph.nodeSize());
+	core::Map<int, int> meshMapping((int)sceneGraph.size());
 	while (!stack.empty()) {
 		const int nodeId = stack.back().first;
 		const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
@@ -245,15 +339,13 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			}
 		}
 
-		if (meshIdxNodeMap.find(nodeId) == meshIdxNodeMap.end()) {
+		if (nextMeshExt == nullptr || nextMeshExt->nodeId != nodeId) {
 			tinygltf::Node gltfNode;
 			saveGltfNode(nodeMapping, gltfModel, gltfNode, gltfScene, node, stack, sceneGraph, scale, false);
 			continue;
 		}
 
-		int meshExtIdx = 0;
-		meshIdxNodeMap.get(nodeId, meshExtIdx);
-		const MeshExt &meshExt = meshes[meshExtIdx];
+		const MeshExt &meshExt = *nextMeshExt;
 
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
 			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
@@ -292,19 +384,23 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 
 			unsigned int maxIndex = 0;
 			unsigned int minIndex = UINT_MAX;
-
 			for (int i = 0; i < ni; i++) {
-				const int idx = i;
-				os.writeUInt32(indices[idx]);
-
-				if (maxIndex < indices[idx]) {
-					maxIndex = indices[idx];
-				}
+				maxIndex = core_max(maxIndex, (unsigned int)indices[i]);
+				minIndex = core_min(minIndex, (unsigned int)indices[i]);
+			}
 
-				if (indices[idx] < minIndex) {
-					minIndex = indices[idx];
+			const bool shortIndices = quantize && maxIndex < (unsigned int)UINT16_MAX;
+			for (int i = 0; i < ni; i++) {
+				if (shortIndices) {
+					os.writeUInt16(indices[i]);
+				} else {
+					os.writeUInt32(indices[i]);
 				}
 			}
+			// the vertex attributes must be aligned to 4 bytes
+			while (os.size() % 4 != 0) {
+				os.writeUInt8(0);
+			}
 
 			static_assert(sizeof(voxel::IndexType) == 4, "if not 4 bytes - we might need padding here");
 			const unsigned int FLOAT_BUFFER_OFFSET = os.size();
@@ -315,6 +411,28 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			const glm::vec3 &offset = mesh->getOffset();
 
 			const glm::vec3 pivotOffset = offset - meshExt.pivot * meshExt.size;
+			// KHR_mesh_quantization: the cubic meshes are made of integer positions - they fit into shorts
+			bool quantizePositions = quantize;
+			for (int j = 0; quantizePositions && j < nv; j++) {
+				glm::vec3 pos = vertices[j].position;
+				if (meshExt.applyTransform) {
+					pos = pos + pivotOffset;
+				}
+				if (glm::any(glm::notEqual(pos, glm::round(pos))) ||
+					glm::any(glm::lessThan(pos, glm::vec3((float)INT16_MIN))) ||
+					glm::any(glm::greaterThan(pos, glm::vec3((float)INT16_MAX)))) {
+					quantizePositions = false;
+				}
+			}
+			// normalized byte normals are only allowed with the extension
+			if (quantizePositions || (quantize && exportNormals)) {
+				usedQuantization = true;
+			}
+			// the texture coordinates replace the vertex colors
+			core::DynamicArray<float> occlusion;
+			const bool occluded =
+				withColor && !withTexCoords && bakeAmbientOcclusion(sceneGraph, meshExt, *mesh, occlusion);
+
 			for (int j = 0; j < nv; j++) {
 				glm::vec3 pos = vertices[j].position;
 
@@ -323,7 +441,11 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 				}
 
 				for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
-					os.writeFloat(pos[coordIndex]);
+					if (quantizePositions) {
+						os.writeInt16((int16_t)pos[coordIndex]);
+					} else {
+						os.writeFloat(pos[coordIndex]);
+					}
 
 					if (maxVertex[coordIndex] < pos[coordIndex]) {
 						maxVertex[coordIndex] = pos[coordIndex];
@@ -333,43 +455,75 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 						minVertex[coordIndex] = pos[coordIndex];
 					}
 				}
+				if (quantizePositions) {
+					os.writeInt16(0);
+				}
 
 				if (exportNormals) {
 					for (int coordIndex = 0; coordIndex < glm::vec3::length(); coordIndex++) {
-						os.writeFloat(normals[j][coordIndex]);
+						if (quantize) {
+							os.writeInt8((int8_t)glm::round(glm::clamp(normals[j][coordIndex], -1.0f, 1.0f) * 127.0f));
+						} else {
+							os.writeFloat(normals[j][coordIndex]);
+						}
+					}
+					if (quantize) {
+						os.writeInt8(0);
 					}
 				}
 
 				if (withTexCoords) {
 					const glm::vec2 &uv = paletteUV(vertices[j].colorIndex);
-					os.writeFloat(uv.x);
-					os.writeFloat(uv.y);
+					if (quantize) {
+						os.writeUInt16((uint16_t)glm::round(glm::clamp(uv.x, 0.0f, 1.0f) * 65535.0f));
+						os.writeUInt16((uint16_t)glm::round(glm::clamp(uv.y, 0.0f, 1.0f) * 65535.0f));
+					} else {
+						os.writeFloat(uv.x);
+						os.writeFloat(uv.y);
+					}
 				} else if (withColor) {
-					const glm::vec4 &color = core::Color::fromRGBA(palette.color(vertices[j].colorIndex));
-					for (int colorIdx = 0; colorIdx < glm::vec4::length(); colorIdx++) {
-						os.writeFloat(color[colorIdx]);
+					core::RGBA color = palette.color(vertices[j].colorIndex);
+					if (occluded) {
+						color = occludedColor(color, occlusion[j]);
+					}
+					if (quantize) {
+						os.writeUInt8(color.r);
+						os.writeUInt8(color.g);
+						os.writeUInt8(color.b);
+						os.writeUInt8(color.a);
+					} else {
+						const glm::vec4 &colorf = core::Color::fromRGBA(color);
+						for (int colorIdx = 0; colorIdx < glm::vec4::length(); colorIdx++) {
+							os.writeFloat(colorf[colorIdx]);
+						}
 					}
 				}
 			}
 
+			// the byte sizes of the attributes - including the padding for the quantized types
+			const int positionSize = quantizePositions ? 4 * sizeof(int16_t) : sizeof(glm::vec3);
+			const int normalSize = quantize ? 4 * sizeof(int8_t) : sizeof(glm::vec3);
+			const int texCoordSize = quantize ? 2 * sizeof(uint16_t) : sizeof(glm::vec2);
+			const int colorSize = quantize ? 4 * sizeof(uint8_t) : sizeof(glm::vec4);
+
 			tinygltf::BufferView gltfIndicesBufferView;
 			gltfIndicesBufferView.buffer = (int)gltfModel.buffers.size();
 			gltfIndicesBufferView.byteOffset = 0;
-			gltfIndicesBufferView.byteLength = FLOAT_BUFFER_OFFSET;
+			gltfIndicesBufferView.byteLength = (size_t)ni * (shortIndices ? sizeof(uint16_t) : sizeof(uint32_t));
 			gltfIndicesBufferView.target = TINYGLTF_TARGET_ELEMENT_ARRAY_BUFFER;
 
 			tinygltf::BufferView gltfVerticesBufferView;
 			gltfVerticesBufferView.buffer = (int)gltfModel.buffers.size();
 			gltfVerticesBufferView.byteOffset = FLOAT_BUFFER_OFFSET;
 			gltfVerticesBufferView.byteLength = os.size() - FLOAT_BUFFER_OFFSET;
-			gltfVerticesBufferView.byteStride = sizeof(glm::vec3);
+			gltfVerticesBufferView.byteStride = positionSize;
 			if (exportNormals) {
-				gltfVerticesBufferView.byteStride += sizeof(glm::vec3);
+				gltfVerticesBufferView.byteStride += normalSize;
 			}
 			if (withTexCoords) {
-				gltfVerticesBufferView.byteStride += sizeof(glm::vec2);
+				gltfVerticesBufferView.byteStride += texCoordSize;
 			} else if (withColor) {
-				gltfVerticesBufferView.byteStride += sizeof(glm::vec4);
+				gltfVerticesBufferView.byteStride += colorSize;
 			}
 			gltfVerticesBufferView.target = TINYGLTF_TARGET_ARRAY_BUFFER;
 
@@ -377,7 +531,8 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			tinygltf::Accessor gltfIndicesAccessor;
 			gltfIndicesAccessor.bufferView = (int)gltfModel.bufferViews.size();
 			gltfIndicesAccessor.byteOffset = 0;
-			gltfIndicesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
+			gltfIndicesAccessor.componentType =
+				shortIndices ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_UNSIGNED_INT;
 			gltfIndicesAccessor.count = ni;
 			gltfIndicesAccessor.type = TINYGLTF_TYPE_SCALAR;
 			gltfIndicesAccessor.maxValues.push_back(maxIndex);
@@ -387,7 +542,8 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			tinygltf::Accessor gltfVerticesAccessor;
 			gltfVerticesAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
 			gltfVerticesAccessor.byteOffset = 0;
-			gltfVerticesAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+			gltfVerticesAccessor.componentType =
+				quantizePositions ? TINYGLTF_COMPONENT_TYPE_SHORT : TINYGLTF_COMPONENT_TYPE_FLOAT;
 			gltfVerticesAccessor.count = nv;
 			gltfVerticesAccessor.type = TINYGLTF_TYPE_VEC3;
 			gltfVerticesAccessor.maxValues = {maxVertex[0], maxVertex[1], maxVertex[2]};
@@ -396,23 +552,28 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			// Describe the layout of normals - they are followed
 			tinygltf::Accessor gltfNormalAccessor;
 			gltfNormalAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-			gltfNormalAccessor.byteOffset = sizeof(glm::vec3);
-			gltfNormalAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+			gltfNormalAccessor.byteOffset = positionSize;
+			gltfNormalAccessor.componentType = quantize ? TINYGLTF_COMPONENT_TYPE_BYTE : TINYGLTF_COMPONENT_TYPE_FLOAT;
+			gltfNormalAccessor.normalized = quantize;
 			gltfNormalAccessor.count = nv;
 			gltfNormalAccessor.type = TINYGLTF_TYPE_VEC3;
 
 			tinygltf::Accessor gltfColorAccessor;
 			if (withTexCoords) {
 				gltfColorAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-				gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+				gltfColorAccessor.componentType =
+					quantize ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_SHORT : TINYGLTF_COMPONENT_TYPE_FLOAT;
+				gltfColorAccessor.normalized = quantize;
 				gltfColorAccessor.count = nv;
-				gltfColorAccessor.byteOffset = (exportNormals ? 2 : 1) * sizeof(glm::vec3);
+				gltfColorAccessor.byteOffset = positionSize + (exportNormals ? normalSize : 0);
 				gltfColorAccessor.type = TINYGLTF_TYPE_VEC2;
 			} else if (withColor) {
 				gltfColorAccessor.bufferView = (int)gltfModel.bufferViews.size() + 1;
-				gltfColorAccessor.componentType = TINYGLTF_COMPONENT_TYPE_FLOAT;
+				gltfColorAccessor.componentType =
+					quantize ? TINYGLTF_COMPONENT_TYPE_UNSIGNED_BYTE : TINYGLTF_COMPONENT_TYPE_FLOAT;
+				gltfColorAccessor.normalized = quantize;
 				gltfColorAccessor.count = nv;
-				gltfColorAccessor.byteOffset = (exportNormals ? 2 : 1) * sizeof(glm::vec3);
+				gltfColorAccessor.byteOffset = positionSize + (exportNormals ? normalSize : 0);
 				gltfColorAccessor.type = TINYGLTF_TYPE_VEC4;
 			}
 
@@ -441,6 +602,9 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 			{
 				tinygltf::Node gltfNode;
 				gltfNode.mesh = (int)gltfModel.meshes.size();
+				if (!meshMapping.hasKey(nodeId)) {
+					meshMapping.put(nodeId, gltfNode.mesh);
+				}
 				saveGltfNode(nodeMapping, gltfModel, gltfNode, gltfScene, node, stack, sceneGraph, scale,
 							 exportAnimations);
 			}
@@ -466,6 +630,24 @@ bool GLTFFormat::saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const sce
 				gltfModel.accessors.emplace_back(core::move(gltfColorAccessor));
 			}
 		}
+		// this frees the mesh of this node
+		nextMeshExt = queue.next();
+	}
+
+	// model references just use the mesh of the referenced model node
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		int gltfNodeIdx = -1;
+		int gltfMeshIdx = -1;
+		if (!nodeMapping.get(node.id(), gltfNodeIdx) || !meshMapping.get(node.reference(), gltfMeshIdx)) {
+			continue;
+		}
+		gltfModel.nodes[gltfNodeIdx].mesh = gltfMeshIdx;
+	}
+
+	if (usedQuantization) {
+		gltfModel.extensionsUsed.push_back("KHR_mesh_quantization");
+		gltfModel.extensionsRequired.push_back("KHR_mesh_quantization");
 	}
 
 	if (exportAnimations) {
@@ -773,62 +955,13 @@ void GLTFFormat::loadTexture(const core::String &filename, core::StringMap<image
 			materialData.wrapS = _priv::convertTextureWrap(gltfTextureSampler.wrapS);
 			materialData.wrapT = _priv::convertTextureWrap(gltfTextureSampler.wrapT);
 		}
-		const tinygltf::Image &gltfImage = gltfModel.images[gltfTexture.source];
-		Log::debug("Image components: %i, width: %i, height: %i, bits: %i", gltfImage.component, gltfImage.width,
-				   gltfImage.height, gltfImage.bits);
-		if (gltfImage.uri.empty()) {
-			if (gltfImage.bufferView >= 0 && gltfImage.bufferView < (int)gltfModel.bufferViews.size()) {
-				const tinygltf::BufferView &gltfImgBufferView = gltfModel.bufferViews[gltfImage.bufferView];
-				if (gltfImgBufferView.buffer >= 0 && gltfImgBufferView.buffer < (int)gltfModel.buffers.size()) {
-					const tinygltf::Buffer &gltfImgBuffer = gltfModel.buffers[gltfImgBufferView.buffer];
-					const size_t offset = gltfImgBufferView.byteOffset;
-					const uint8_t *buf = gltfImgBuffer.data.data() + offset;
-					image::ImagePtr tex = image::createEmptyImage(gltfImage.name.c_str());
-					if (!tex->load(buf, (int)gltfImgBufferView.byteLength)) {
-						Log::warn("Failed to load embedded image %s", gltfImage.name.c_str());
-					} else {
-						materialData.diffuseTexture = gltfImage.name.c_str();
-						textures.emplace(materialData.diffuseTexture, core::move(tex));
-					}
-				} else {
-					Log::warn("Invalid buffer index for image: %i", gltfImgBufferView.buffer);
-				}
-			} else if (!gltfImage.image.empty()) {
-				if (gltfImage.component == 4) {
-					core::String name = gltfImage.name.c_str();
-					if (name.empty()) {
-						name = core::string::format("image%i", gltfTexture.source);
-					}
-					image::ImagePtr tex = image::createEmptyImage(name);
-					core_assert(gltfImage.image.size() ==
-								(size_t)(gltfImage.width * gltfImage.height * gltfImage.component));
-					tex->loadRGBA(gltfImage.image.data(), gltfImage.width, gltfImage.height);
-					Log::debug("Use image %s", name.c_str());
-					materialData.diffuseTexture = name.c_str();
-					textures.emplace(materialData.diffuseTexture, core::move(tex));
-					texCoordIndex = gltfTextureInfo.texCoord;
-				} else {
-					Log::warn("Failed to load image with %i components", gltfImage.component);
-				}
-			} else {
-				Log::warn("Invalid buffer view index for image: %i", gltfImage.bufferView);
-			}
+		const core::String &name = _priv::imageName(gltfModel, gltfTexture.source);
+		if (textures.hasKey(name)) {
+			Log::debug("Use image %s", name.c_str());
+			materialData.diffuseTexture = name;
+			texCoordIndex = gltfTextureInfo.texCoord;
 		} else {
-			core::String name = gltfImage.uri.c_str();
-			if (!textures.hasKey(name)) {
-				name = lookupTexture(filename, name);
-				image::ImagePtr tex = image::loadImage(name);
-				if (tex->isLoaded()) {
-					Log::debug("Use image %s", name.c_str());
-					materialData.diffuseTexture = gltfImage.uri.c_str();
-					textures.emplace(materialData.diffuseTexture, core::move(tex));
-					texCoordIndex = gltfTextureInfo.texCoord;
-				} else {
-					Log::warn("Failed to load %s", name.c_str());
-				}
-			} else {
-				materialData.diffuseTexture = name;
-			}
+			Log::debug("Image %s isn't loaded", name.c_str());
 		}
 	} else {
 		Log::debug("Invalid image index given %i", gltfTexture.source);
@@ -888,28 +1021,33 @@ bool GLTFFormat::loadAttributes(const core::String &filename, core::StringMap<im
 				   (int)stride);
 		const uint8_t *buf = gltfAttributeBuffer.data.data() + offset;
 		if (attrType == "POSITION") {
-			if (gltfAttributeAccessor->componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
-				Log::debug("Skip non float type for %s", attrType.c_str());
+			float dummy;
+			if (!_priv::toFloat(gltfAttributeAccessor, buf, 0, dummy)) {
+				Log::debug("Skip unknown type (%i) for %s", gltfAttributeAccessor->componentType, attrType.c_str());
 				continue;
 			}
 			foundPosition = true;
 			core_assert(gltfAttributeAccessor->type == TINYGLTF_TYPE_VEC3);
 			for (size_t i = 0; i < gltfAttributeAccessor->count; i++) {
-				const float *posData = (const float *)buf;
-				vertices[verticesOffset + i].pos = glm::vec3(posData[0], posData[1], posData[2]);
+				glm::vec3 &pos = vertices[verticesOffset + i].pos;
+				for (int c = 0; c < glm::vec3::length(); ++c) {
+					_priv::toFloat(gltfAttributeAccessor, buf, c, pos[c]);
+				}
 				vertices[verticesOffset + i].texture = textureData.diffuseTexture;
 				vertices[verticesOffset + i].color = textureData.baseColor;
 				buf += stride;
 			}
 		} else if (attrType == textureData.texCoordAttribute.c_str()) {
-			if (gltfAttributeAccessor->componentType != TINYGLTF_COMPONENT_TYPE_FLOAT) {
-				Log::debug("Skip non float type (%i) for %s", gltfAttributeAccessor->componentType, attrType.c_str());
+			float dummy;
+			if (!_priv::toFloat(gltfAttributeAccessor, buf, 0, dummy)) {
+				Log::debug("Skip unknown type (%i) for %s", gltfAttributeAccessor->componentType, attrType.c_str());
 				continue;
 			}
 			core_assert(gltfAttributeAccessor->type == TINYGLTF_TYPE_VEC2);
 			for (size_t i = 0; i < gltfAttributeAccessor->count; i++) {
-				const float *uvData = (const float *)buf;
-				vertices[verticesOffset + i].uv = glm::vec2(uvData[0], uvData[1]);
+				glm::vec2 &uv = vertices[verticesOffset + i].uv;
+				_priv::toFloat(gltfAttributeAccessor, buf, 0, uv.x);
+				_priv::toFloat(gltfAttributeAccessor, buf, 1, uv.y);
 				vertices[verticesOffset + i].wrapS = textureData.wrapS;
 				vertices[verticesOffset + i].wrapT = textureData.wrapT;
 				buf += stride;
@@ -1210,13 +1348,13 @@ bool GLTFFormat::voxelizeGroups(const core::String &filename, io::SeekableReadSt
 								scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
 	uint32_t magic;
 	stream.peekUInt32(magic);
-	const int64_t size = stream.size();
-	uint8_t *data = (uint8_t *)core_malloc(size);
-	if (stream.read(data, size) == -1) {
-		Log::error("Failed to read gltf stream for %s of size %i", filename.c_str(), (int)size);
-		core_free(data);
+	io::StreamData streamData(stream);
+	if (!streamData.valid()) {
+		Log::error("Failed to read gltf stream for %s of size %i", filename.c_str(), (int)stream.size());
 		return false;
 	}
+	const uint8_t *data = streamData.data();
+	const int64_t size = streamData.size();
 
 	std::string err;
 	bool state;
@@ -1224,6 +1362,8 @@ bool GLTFFormat::voxelizeGroups(const core::String &filename, io::SeekableReadSt
 	const core::String filePath = core::string::extractPath(filename);
 	tinygltf::TinyGLTF gltfLoader;
 	tinygltf::Model gltfModel;
+	core::DynamicArray<core::DynamicArray<uint8_t>> encodedImages;
+	gltfLoader.SetImageLoader(_priv::keepImageData, &encodedImages);
 	if (magic == FourCC('g', 'l', 'T', 'F')) {
 		Log::debug("Detected binary gltf stream");
 		state = gltfLoader.LoadBinaryFromMemory(&gltfModel, &err, nullptr, data, size, filePath.c_str(),
@@ -1239,12 +1379,37 @@ bool GLTFFormat::voxelizeGroups(const core::String &filename, io::SeekableReadSt
 			Log::error("Failed to load ascii gltf file: %s", err.c_str());
 		}
 	}
-	core_free(data);
 	if (!state) {
 		return false;
 	}
 
 	core::StringMap<image::ImagePtr> textures;
+	{
+		// decode the base color images of all materials in parallel before the meshes are voxelized
+		core::DynamicArray<TextureSource> sources;
+		for (const tinygltf::Material &gltfMaterial : gltfModel.materials) {
+			const int textureIndex = gltfMaterial.pbrMetallicRoughness.baseColorTexture.index;
+			if (textureIndex < 0 || textureIndex >= (int)gltfModel.textures.size()) {
+				continue;
+			}
+			const int imageIndex = gltfModel.textures[textureIndex].source;
+			if (imageIndex < 0 || imageIndex >= (int)gltfModel.images.size()) {
+				continue;
+			}
+			const tinygltf::Image &gltfImage = gltfModel.images[imageIndex];
+			TextureSource source;
+			source.name = _priv::imageName(gltfModel, imageIndex);
+			if (imageIndex < (int)encodedImages.size() && !encodedImages[imageIndex].empty()) {
+				source.data = encodedImages[imageIndex].data();
+				source.length = (int)encodedImages[imageIndex].size();
+			} else if (!gltfImage.uri.empty()) {
+				// tinygltf didn't find the file next to the gltf - search it in the texture paths
+				source.file = lookupTexture(filename, gltfImage.uri.c_str());
+			}
+			sources.push_back(source);
+		}
+		loadTextures(sources, textures);
+	}
 
 	Log::debug("Materials: %i", (int)gltfModel.materials.size());
 	Log::debug("Animations: %i", (int)gltfModel.animations.size());
@@ -92,6 +92,13 @@ public:
 	bool saveMeshes(const core::Map<int, int> &meshIdxNodeMap, const scenegraph::SceneGraph &sceneGraph,
 					const Meshes &meshes, const core::String &filename, io::SeekableWriteStream &stream,
 					const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) override;
+	/**
+	 * @brief The meshes are requested in the order of the node tree traversal and are freed as soon as they are
+	 * converted into gltf buffers
+	 */
+	bool saveMeshQueue(const scenegraph::SceneGraph &sceneGraph, MeshQueue &queue, const core::String &filename,
+					   io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad, bool withColor,
+					   bool withTexCoords) override;
 };
 
 } // namespace voxelformat
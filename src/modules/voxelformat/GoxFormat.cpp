@@ -3,10 +3,15 @@
  */
 
 #include "GoxFormat.h"
+#include "app/App.h"
 #include "core/Color.h"
 #include "core/FourCC.h"
+#include "core/Hash.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include "image/Image.h"
 #include "io/MemoryReadStream.h"
 #include "io/Stream.h"
@@ -176,32 +181,116 @@ image::ImagePtr GoxFormat::loadScreenshot(const core::String &filename, io::Seek
 	return image::ImagePtr();
 }
 
-bool GoxFormat::loadChunk_LAYR(State& state, const GoxChunk &c, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const voxel::Palette &palette) {
+GoxFormat::State::~State() {
+	for (GoxBlock &block : blocks) {
+		delete block.volume;
+	}
+}
+
+bool GoxFormat::decodeBlock(GoxBlock &block, voxel::PaletteLookup *palLookup) {
+	block.decoded = true;
+	image::ImagePtr img = image::createEmptyImage("gox-voxeldata");
+	const bool success = img->load(block.png.data(), (int)block.png.size());
+	block.png.release();
+	if (!success) {
+		Log::error("Failed to load png chunk");
+		return false;
+	}
+	if (img->width() != 64 || img->height() != 64 || img->depth() != 4) {
+		Log::error("Invalid image dimensions: %i:%i", img->width(), img->height());
+		return false;
+	}
+	if (palLookup == nullptr) {
+		block.image = img;
+		return true;
+	}
+
+	const voxel::Region blockRegion(0, BlockSize - 1);
+	voxel::Voxel *voxels = (voxel::Voxel *)core_malloc(blockRegion.voxels() * sizeof(voxel::Voxel));
+	const uint8_t *v = img->data();
+	bool empty = true;
+	for (int z1 = 0; z1 < BlockSize; ++z1) {
+		for (int y1 = 0; y1 < BlockSize; ++y1) {
+			for (int x1 = 0; x1 < BlockSize; ++x1) {
+				// x running fastest
+				voxel::VoxelType voxelType = voxel::VoxelType::Generic;
+				uint8_t index;
+				if (v[3] == 0u) {
+					voxelType = voxel::VoxelType::Air;
+					index = 0;
+				} else {
+					const core::RGBA color(v[0], v[1], v[2], v[3]);
+					index = palLookup->findClosestIndex(color);
+					if (v[3] != 255) {
+						voxelType = voxel::VoxelType::Transparent;
+					}
+					empty = false;
+				}
+				// goxel uses z up - the volume index is x + y * width + z * width * height
+				voxels[x1 + z1 * BlockSize + y1 * BlockSize * BlockSize] = voxel::createVoxel(voxelType, index);
+				v += 4;
+			}
+		}
+	}
+	if (empty) {
+		core_free(voxels);
+		return true;
+	}
+	block.volume = voxel::RawVolume::createRaw(voxels, blockRegion);
+	return true;
+}
+
+bool GoxFormat::decodeBlocks(State &state, voxel::PaletteLookup *palLookup,
+							 const core::DynamicArray<GoxLayerBlock> *layerBlocks) {
+	core_trace_scoped(GoxDecodeBlocks);
+	// a block can be referenced more than once - collect every block only once
+	core::DynamicArray<GoxBlock *> pending;
+	if (layerBlocks == nullptr) {
+		for (GoxBlock &block : state.blocks) {
+			if (!block.decoded) {
+				block.decoded = true;
+				pending.push_back(&block);
+			}
+		}
+	} else {
+		for (const GoxLayerBlock &layerBlock : *layerBlocks) {
+			GoxBlock &block = state.blocks[layerBlock.index];
+			if (!block.decoded) {
+				block.decoded = true;
+				pending.push_back(&block);
+			}
+		}
+	}
+	core::AtomicInt failed{0};
+	app::App::getInstance()->threadPool().parallelFor(0, (int)pending.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			if (!decodeBlock(*pending[i], palLookup)) {
+				failed.increment(1);
+			}
+		}
+	});
+	return failed == 0;
+}
+
+bool GoxFormat::loadChunk_LAYR(State& state, const GoxChunk &c, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, voxel::PaletteLookup &palLookup) {
 	const int size = (int)sceneGraph.size();
-	voxel::RawVolume *layerVolume = new voxel::RawVolume(voxel::Region(0, 0, 0, 1, 1, 1));
 	uint32_t blockCount;
 
-	voxel::PaletteLookup palLookup(palette);
 	wrap(stream.readUInt32(blockCount))
 	Log::debug("Found LAYR chunk with %i blocks", blockCount);
+
+	// collect the blocks first to allocate the layer volume only once
+	voxel::Region blocksRegion(0, 0, 0, 1, 1, 1);
+	core::DynamicArray<GoxLayerBlock> layerBlocks;
+	layerBlocks.reserve(blockCount);
 	for (uint32_t i = 0; i < blockCount; ++i) {
 		uint32_t index;
 		wrap(stream.readUInt32(index))
-		if (index > state.images.size()) {
+		if (index >= state.blocks.size()) {
 			Log::error("Index out of bounds: %u", index);
 			return false;
 		}
-		const image::ImagePtr &img = state.images[index];
-		if (!img) {
-			Log::error("Invalid image index: %u", index);
-			return false;
-		}
 		Log::debug("LAYR references BL16 image with index %i", index);
-		const uint8_t *rgba = img->data();
-		int bpp = img->depth();
-		int w = img->width();
-		int h = img->height();
-		core_assert(w == 64 && h == 64 && bpp == 4);
 
 		int32_t x, y, z;
 		wrap(stream.readInt32(x))
@@ -215,50 +304,9 @@ bool GoxFormat::loadChunk_LAYR(State& state, const GoxChunk &c, io::SeekableRead
 		}
 
 		wrap(stream.skip(4))
-		const voxel::Region blockRegion(x, z, y, x + (BlockSize - 1), z + (BlockSize - 1), y + (BlockSize - 1));
-		core_assert(blockRegion.isValid());
-		voxel::RawVolume *blockVolume = new voxel::RawVolume(blockRegion);
-		const uint8_t *v = rgba;
-		bool empty = true;
-		for (int z1 = 0; z1 < BlockSize; ++z1) {
-			for (int y1 = 0; y1 < BlockSize; ++y1) {
-				for (int x1 = 0; x1 < BlockSize; ++x1) {
-					// x running fastest
-					voxel::VoxelType voxelType = voxel::VoxelType::Generic;
-					uint8_t index;
-					if (v[3] == 0u) {
-						voxelType = voxel::VoxelType::Air;
-						index = 0;
-					} else {
-						const core::RGBA color(v[0], v[1], v[2], v[3]);
-						index = palLookup.findClosestIndex(color);
-						if (v[3] != 255) {
-							voxelType = voxel::VoxelType::Transparent;
-						}
-					}
-					const voxel::Voxel voxel = voxel::createVoxel(voxelType, index);
-					blockVolume->setVoxel(x + x1, z + z1, y + y1, voxel);
-					if (!voxel::isAir(voxel.getMaterial())) {
-						empty = false;
-					}
-					v += 4;
-				}
-			}
-		}
-		// this will remove empty blocks and the final volume might have a smaller region.
-		// TODO: we should remove this once we have sparse volumes support
-		if (!empty) {
-			voxel::Region destReg(layerVolume->region());
-			if (!destReg.containsRegion(blockRegion)) {
-				destReg.accumulate(blockRegion);
-				voxel::RawVolume *newVolume = new voxel::RawVolume(destReg);
-				voxelutil::copyIntoRegion(*layerVolume, *newVolume, layerVolume->region());
-				delete layerVolume;
-				layerVolume = newVolume;
-			}
-			voxelutil::mergeVolumes(layerVolume, blockVolume, blockRegion, blockRegion);
-		}
-		delete blockVolume;
+		const glm::ivec3 pos(x, z, y);
+		blocksRegion.accumulate(voxel::Region(pos, pos + (BlockSize - 1)));
+		layerBlocks.push_back(GoxLayerBlock{0, pos, index});
 	}
 	bool visible = true;
 	char dictKey[256];
@@ -300,6 +348,30 @@ bool GoxFormat::loadChunk_LAYR(State& state, const GoxChunk &c, io::SeekableRead
 		}
 	}
 
+	if (state.ctx != nullptr && !state.ctx->acceptModel(state.modelIndex++, node.name(), blocksRegion)) {
+		Log::debug("Skip layer %s", node.name().c_str());
+		return true;
+	}
+
+	// the BL16 chunks are in front of the layers - decode the blocks of this layer at once
+	wrapBool(decodeBlocks(state, &palLookup, &layerBlocks))
+	// this will remove empty blocks and the final volume might have a smaller region.
+	// TODO: we should remove this once we have sparse volumes support
+	voxel::Region layerRegion(0, 0, 0, 1, 1, 1);
+	for (const GoxLayerBlock &block : layerBlocks) {
+		if (state.blocks[block.index].volume != nullptr) {
+			layerRegion.accumulate(voxel::Region(block.pos, block.pos + (BlockSize - 1)));
+		}
+	}
+	voxel::RawVolume *layerVolume = new voxel::RawVolume(layerRegion);
+	for (const GoxLayerBlock &block : layerBlocks) {
+		const voxel::RawVolume *blockVolume = state.blocks[block.index].volume;
+		if (blockVolume == nullptr) {
+			continue;
+		}
+		layerVolume->copyRegion(*blockVolume, blockVolume->region(), block.pos, true);
+	}
+
 	voxel::RawVolume *mirrored = voxelutil::mirrorAxis(layerVolume, math::Axis::X);
 	voxel::RawVolume *cropped = voxelutil::cropVolume(mirrored);
 	const glm::ivec3 mins = cropped->region().getLowerCorner();
@@ -318,21 +390,16 @@ bool GoxFormat::loadChunk_LAYR(State& state, const GoxChunk &c, io::SeekableRead
 }
 
 bool GoxFormat::loadChunk_BL16(State& state, const GoxChunk &c, io::SeekableReadStream &stream) {
-	uint8_t* png = (uint8_t*)core_malloc(c.length);
-	wrapBool(loadChunk_ReadData(stream, (char *)png, c.length))
-	image::ImagePtr img = image::createEmptyImage("gox-voxeldata");
-	bool success = img->load(png, c.length);
-	core_free(png);
-	if (!success) {
-		Log::error("Failed to load png chunk");
-		return false;
-	}
-	if (img->width() != 64 || img->height() != 64 || img->depth() != 4) {
-		Log::error("Invalid image dimensions: %i:%i", img->width(), img->height());
+	if (c.length <= 0) {
+		Log::error("Invalid BL16 chunk length: %i", c.length);
 		return false;
 	}
-	Log::debug("Found BL16 with index %i", (int)state.images.size());
-	state.images.push_back(img);
+	// the png is decoded on the thread pool together with the other blocks - see decodeBlocks()
+	GoxBlock block;
+	block.png.resize(c.length);
+	wrapBool(loadChunk_ReadData(stream, (char *)block.png.data(), c.length))
+	Log::debug("Found BL16 with index %i", (int)state.blocks.size());
+	state.blocks.emplace_back(core::move(block));
 	return true;
 }
 
@@ -438,7 +505,9 @@ size_t GoxFormat::loadPalette(const core::String &filename, io::SeekableReadStre
 		loadChunk_ValidateCRC(stream);
 	}
 
-	for (image::ImagePtr &img : state.images) {
+	wrapBool(decodeBlocks(state, nullptr))
+	for (const GoxBlock &block : state.blocks) {
+		const image::ImagePtr &img = block.image;
 		for (int x = 0; x < img->width(); ++x) {
 			for (int y = 0; y < img->height(); ++y) {
 				const core::RGBA rgba = img->colorAt(x, y);
@@ -464,6 +533,7 @@ bool GoxFormat::loadGroupsRGBA(const core::String &filename, io::SeekableReadStr
 	}
 
 	State state;
+	state.ctx = &ctx;
 	wrap(stream.readInt32(state.version))
 
 	if (state.version > 2) {
@@ -471,12 +541,13 @@ bool GoxFormat::loadGroupsRGBA(const core::String &filename, io::SeekableReadStr
 		return false;
 	}
 
+	voxel::PaletteLookup palLookup(palette);
 	GoxChunk c;
 	while (loadChunk_Header(c, stream)) {
 		if (c.type == FourCC('B', 'L', '1', '6')) {
 			wrapBool(loadChunk_BL16(state, c, stream))
 		} else if (c.type == FourCC('L', 'A', 'Y', 'R')) {
-			wrapBool(loadChunk_LAYR(state, c, stream, sceneGraph, palette))
+			wrapBool(loadChunk_LAYR(state, c, stream, sceneGraph, palLookup))
 		} else if (c.type == FourCC('C', 'A', 'M', 'R')) {
 			wrapBool(loadChunk_CAMR(state, c, stream, sceneGraph))
 		} else if (c.type == FourCC('M', 'A', 'T', 'E')) {
@@ -564,47 +635,27 @@ bool GoxFormat::saveChunk_MATE(io::SeekableWriteStream& stream, const scenegraph
 	return true;
 }
 
-bool GoxFormat::saveChunk_LAYR(io::SeekableWriteStream& stream, const scenegraph::SceneGraph &sceneGraph, int numBlocks) {
-	int blockUid = 0;
+bool GoxFormat::saveChunk_LAYR(io::SeekableWriteStream& stream, const scenegraph::SceneGraph &sceneGraph, const core::DynamicArray<GoxLayerBlock> &layerBlocks) {
 	int layerId = 0;
+	size_t blockIdx = 0;
 	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
-		const voxel::Region &region = node.region();
-		glm::ivec3 mins, maxs;
-		calcMinsMaxs(region, glm::ivec3(BlockSize), mins, maxs);
-
 		GoxScopedChunkWriter scoped(stream, FourCC('L', 'A', 'Y', 'R'));
-		int layerBlocks = 0;
-		voxelutil::visitVolume(*node.volume(), voxel::Region(mins, maxs), BlockSize, BlockSize, BlockSize, [&] (int x, int y, int z, const voxel::Voxel &) {
-			if (isEmptyBlock(node.volume(), glm::ivec3(BlockSize), x, y, z)) {
-				return;
-			}
-			++layerBlocks;
-		}, voxelutil::VisitAll());
-
-		Log::debug("blocks: %i", layerBlocks);
-
-		wrapBool(stream.writeUInt32(layerBlocks))
-
-		for (int y = mins.y; y <= maxs.y; y += BlockSize) {
-			for (int z = mins.z; z <= maxs.z; z += BlockSize) {
-				for (int x = mins.x; x <= maxs.x; x += BlockSize) {
-					if (isEmptyBlock(node.volume(), glm::ivec3(BlockSize), x, y, z)) {
-						continue;
-					}
-					Log::debug("Saved LAYR chunk %i at %i:%i:%i", blockUid, x, y, z);
-					wrapBool(stream.writeUInt32(blockUid++))
-					wrapBool(stream.writeInt32(x))
-					wrapBool(stream.writeInt32(z))
-					wrapBool(stream.writeInt32(y))
-					wrapBool(stream.writeUInt32(0))
-					--layerBlocks;
-					--numBlocks;
-				}
-			}
+		// the blocks are ordered by layer
+		uint32_t layerBlockCount = 0;
+		for (size_t i = blockIdx; i < layerBlocks.size() && layerBlocks[i].layer == layerId; ++i) {
+			++layerBlockCount;
 		}
-		if (layerBlocks != 0) {
-			Log::error("Invalid amount of layer blocks: %i", layerBlocks);
-			return false;
+		Log::debug("blocks: %u", layerBlockCount);
+		wrapBool(stream.writeUInt32(layerBlockCount))
+
+		for (; blockIdx < layerBlocks.size() && layerBlocks[blockIdx].layer == layerId; ++blockIdx) {
+			const GoxLayerBlock &block = layerBlocks[blockIdx];
+			Log::debug("Saved LAYR chunk %u at %i:%i:%i", block.index, block.pos.x, block.pos.y, block.pos.z);
+			wrapBool(stream.writeUInt32(block.index))
+			wrapBool(stream.writeInt32(block.pos.x))
+			wrapBool(stream.writeInt32(block.pos.z))
+			wrapBool(stream.writeInt32(block.pos.y))
+			wrapBool(stream.writeUInt32(0))
 		}
 		wrapBool(saveChunk_DictEntry(stream, "name", node.name().c_str(), node.name().size()))
 		glm::mat4 mat(1.0f);
@@ -620,60 +671,119 @@ bool GoxFormat::saveChunk_LAYR(io::SeekableWriteStream& stream, const scenegraph
 
 		++layerId;
 	}
-	if (numBlocks != 0) {
+	if (blockIdx != layerBlocks.size()) {
 		Log::error("Invalid amount of blocks");
 		return false;
 	}
 	return true;
 }
 
-bool GoxFormat::saveChunk_BL16(io::SeekableWriteStream& stream, const scenegraph::SceneGraph &sceneGraph, int &blocks) {
-	blocks = 0;
+bool GoxFormat::saveChunk_BL16(io::SeekableWriteStream& stream, const scenegraph::SceneGraph &sceneGraph, core::DynamicArray<GoxLayerBlock> &layerBlocks) {
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	const size_t blockDataSize = (size_t)BlockSize * BlockSize * BlockSize * sizeof(uint32_t);
+
+	int maxBlocks = 1;
+	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
+		glm::ivec3 mins, maxs;
+		calcMinsMaxs(node.region(), glm::ivec3(BlockSize), mins, maxs);
+		const glm::ivec3 blocks = (maxs - mins) / BlockSize + 1;
+		maxBlocks += blocks.x * blocks.y * blocks.z;
+	}
+	// the rgba data of the written blocks - identical blocks of all layers are only written once
+	core::DynamicArray<uint32_t *> writtenData;
+	core::Map<uint64_t, uint32_t, 1031> writtenHashes(maxBlocks);
+	bool success = true;
+	int layerId = 0;
 	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
 		const voxel::Region &region = node.region();
 		glm::ivec3 mins, maxs;
 		calcMinsMaxs(region, glm::ivec3(BlockSize), mins, maxs);
 
 		voxel::RawVolume *mirrored = voxelutil::mirrorAxis(node.volume(), math::Axis::X);
+		core::DynamicArray<glm::ivec3> positions;
 		for (int by = mins.y; by <= maxs.y; by += BlockSize) {
 			for (int bz = mins.z; bz <= maxs.z; bz += BlockSize) {
 				for (int bx = mins.x; bx <= maxs.x; bx += BlockSize) {
-					if (isEmptyBlock(mirrored, glm::ivec3(BlockSize), bx, by, bz)) {
-						continue;
-					}
-					GoxScopedChunkWriter scoped(stream, FourCC('B', 'L', '1', '6'));
-					const voxel::Region blockRegion(bx, by, bz, bx + BlockSize - 1, by + BlockSize - 1, bz + BlockSize - 1);
-					const size_t size = (size_t)BlockSize * BlockSize * BlockSize * 4;
-					uint32_t *data = (uint32_t*)core_malloc(size);
-					int offset = 0;
-					const voxel::Palette& palette = node.palette();
-					voxelutil::visitVolume(*mirrored, blockRegion, [&](int, int, int, const voxel::Voxel& voxel) {
-						if (voxel::isAir(voxel.getMaterial())) {
-							data[offset++] = 0;
-						} else {
-							data[offset++] = palette.color(voxel.getColor());
-						}
-					}, voxelutil::VisitAll(), voxelutil::VisitorOrder::YZX);
-
-					int pngSize = 0;
-					uint8_t *png = image::createPng(data, 64, 64, 4, &pngSize);
-					core_free(data);
-
-					if (stream.write(png, pngSize) == -1) {
-						Log::error("Could not write png into gox stream");
-						core_free(png);
-						delete mirrored;
-						return false;
+					if (!isEmptyBlock(mirrored, glm::ivec3(BlockSize), bx, by, bz)) {
+						positions.emplace_back(bx, by, bz);
 					}
-					core_free(png);
-					Log::debug("Saved BL16 chunk %i with a pngsize of %i", blocks, pngSize);
-					++blocks;
 				}
 			}
 		}
+
+		const int n = (int)positions.size();
+		core::DynamicArray<uint32_t *> data;
+		data.resize(n);
+		core::DynamicArray<uint64_t> hashes;
+		hashes.resize(n);
+		const voxel::Palette &palette = node.palette();
+		threadPool.parallelFor(0, n, 1, [&](int start, int end) {
+			for (int i = start; i < end; ++i) {
+				const glm::ivec3 &pos = positions[i];
+				const voxel::Region blockRegion(pos, pos + (BlockSize - 1));
+				uint32_t *rgba = (uint32_t *)core_malloc(blockDataSize);
+				int offset = 0;
+				voxelutil::visitVolume(*mirrored, blockRegion, [&](int, int, int, const voxel::Voxel& voxel) {
+					if (voxel::isAir(voxel.getMaterial())) {
+						rgba[offset++] = 0;
+					} else {
+						rgba[offset++] = palette.color(voxel.getColor());
+					}
+				}, voxelutil::VisitAll(), voxelutil::VisitorOrder::YZX);
+				data[i] = rgba;
+				hashes[i] = core::hash64(rgba, blockDataSize);
+			}
+		});
 		delete mirrored;
+
+		// the blocks that are not yet written - the block index is the position in writtenData
+		core::DynamicArray<uint32_t> newBlocks;
+		for (int i = 0; i < n; ++i) {
+			uint32_t index;
+			if (writtenHashes.get(hashes[i], index) && core_memcmp(writtenData[index], data[i], blockDataSize) == 0) {
+				core_free(data[i]);
+			} else {
+				index = (uint32_t)writtenData.size();
+				writtenData.push_back(data[i]);
+				if (!writtenHashes.hasKey(hashes[i])) {
+					writtenHashes.put(hashes[i], index);
+				}
+				newBlocks.push_back(index);
+			}
+			layerBlocks.push_back(GoxLayerBlock{layerId, positions[i], index});
+		}
+
+		core::DynamicArray<uint8_t *> pngs;
+		pngs.resize(newBlocks.size());
+		core::DynamicArray<int> pngSizes;
+		pngSizes.resize(newBlocks.size());
+		threadPool.parallelFor(0, (int)newBlocks.size(), 1, [&](int start, int end) {
+			for (int i = start; i < end; ++i) {
+				pngs[i] = image::createPng(writtenData[newBlocks[i]], 64, 64, 4, &pngSizes[i]);
+			}
+		});
+		for (size_t i = 0; i < pngs.size(); ++i) {
+			if (success) {
+				GoxScopedChunkWriter scoped(stream, FourCC('B', 'L', '1', '6'));
+				if (pngs[i] == nullptr || stream.write(pngs[i], pngSizes[i]) == -1) {
+					Log::error("Could not write png into gox stream");
+					success = false;
+				} else {
+					Log::debug("Saved BL16 chunk %u with a pngsize of %i", newBlocks[i], pngSizes[i]);
+				}
+			}
+			core_free(pngs[i]);
+		}
+		if (!success) {
+			break;
+		}
+		++layerId;
 	}
-	return true;
+	for (uint32_t *rgba : writtenData) {
+		core_free(rgba);
+	}
+	Log::debug("Saved %i unique blocks of %i blocks", (int)writtenData.size(), (int)layerBlocks.size());
+	return success;
 }
 
 bool GoxFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename, io::SeekableWriteStream &stream, const SaveContext &ctx) {
@@ -682,10 +792,10 @@ bool GoxFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 
 	wrapBool(saveChunk_IMG(sceneGraph, stream, ctx))
 	wrapBool(saveChunk_PREV(stream))
-	int blocks = 0;
-	wrapBool(saveChunk_BL16(stream, sceneGraph, blocks))
+	core::DynamicArray<GoxLayerBlock> layerBlocks;
+	wrapBool(saveChunk_BL16(stream, sceneGraph, layerBlocks))
 	wrapBool(saveChunk_MATE(stream, sceneGraph))
-	wrapBool(saveChunk_LAYR(stream, sceneGraph, blocks))
+	wrapBool(saveChunk_LAYR(stream, sceneGraph, layerBlocks))
 	wrapBool(saveChunk_CAMR(stream, sceneGraph))
 	wrapBool(saveChunk_LIGH(stream))
 
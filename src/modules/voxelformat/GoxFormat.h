@@ -8,6 +8,10 @@
 #include "core/collection/DynamicArray.h"
 #include "io/Stream.h"
 
+namespace voxel {
+class PaletteLookup;
+}
+
 namespace voxelformat {
 /**
  * @brief Taken from gox
@@ -79,16 +83,57 @@ private:
 		int32_t length = 0u;
 	};
 
+	struct GoxBlock {
+		/**
+		 * @brief The png of the BL16 chunk - released once the block is decoded
+		 */
+		core::DynamicArray<uint8_t> png;
+		/**
+		 * @brief The decoded png - only kept if the block isn't converted into voxels
+		 */
+		image::ImagePtr image;
+		/**
+		 * @brief The voxels of the block with the lower corner at the origin - @c nullptr for an empty block
+		 */
+		voxel::RawVolume *volume = nullptr;
+		bool decoded = false;
+	};
+
 	struct State {
 		int32_t version = 0;
-		core::DynamicArray<image::ImagePtr> images;
+		core::DynamicArray<GoxBlock> blocks;
+		const LoadContext *ctx = nullptr;
+		// the index of the next layer - for LoadContext::acceptModel()
+		int modelIndex = 0;
+		~State();
 	};
 
+	/**
+	 * @brief A block that is referenced by a LAYR chunk
+	 */
+	struct GoxLayerBlock {
+		int layer;
+		glm::ivec3 pos;
+		uint32_t index;
+	};
+
+	/**
+	 * @brief Decode the png of the given block and convert it into voxels if a palette lookup is given. This is
+	 * called in parallel for the blocks.
+	 */
+	static bool decodeBlock(GoxBlock &block, voxel::PaletteLookup *palLookup);
+	/**
+	 * @brief Decode the blocks that are not yet decoded on the thread pool
+	 * @param layerBlocks If not @c null only the blocks that are referenced by these layer blocks are decoded
+	 */
+	bool decodeBlocks(State &state, voxel::PaletteLookup *palLookup,
+					  const core::DynamicArray<GoxLayerBlock> *layerBlocks = nullptr);
+
 	bool loadChunk_Header(GoxChunk &c, io::SeekableReadStream &stream);
 	bool loadChunk_ReadData(io::SeekableReadStream &stream, char *buff, int size);
 	void loadChunk_ValidateCRC(io::SeekableReadStream &stream);
 	bool loadChunk_DictEntry(const GoxChunk &c, io::SeekableReadStream &stream, char *key, char *value);
-	bool loadChunk_LAYR(State& state, const GoxChunk &c, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const voxel::Palette &palette);
+	bool loadChunk_LAYR(State& state, const GoxChunk &c, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, voxel::PaletteLookup &palLookup);
 	bool loadChunk_BL16(State& state, const GoxChunk &c, io::SeekableReadStream &stream);
 	bool loadChunk_MATE(State& state, const GoxChunk &c, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph);
 	bool loadChunk_CAMR(State& state, const GoxChunk &c, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph);
@@ -110,12 +155,12 @@ private:
 	// Write all the lights - not used.
 	bool saveChunk_LIGH(io::SeekableWriteStream &stream);
 
-	// Write all the blocks chunks.
-	bool saveChunk_BL16(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph, int &blocks);
+	// Write all the blocks chunks - identical blocks are only written once.
+	bool saveChunk_BL16(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph, core::DynamicArray<GoxLayerBlock> &layerBlocks);
 	// Write all the materials.
 	bool saveChunk_MATE(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph);
 	// Write all the layers.
-	bool saveChunk_LAYR(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph, int numBlocks);
+	bool saveChunk_LAYR(io::SeekableWriteStream &stream, const scenegraph::SceneGraph &sceneGraph, const core::DynamicArray<GoxLayerBlock> &layerBlocks);
 	bool loadGroupsRGBA(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const voxel::Palette &palette, const LoadContext &ctx) override;
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
 					io::SeekableWriteStream &stream, const SaveContext &ctx) override;
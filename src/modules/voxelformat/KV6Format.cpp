@@ -3,6 +3,7 @@
  */
 
 #include "KV6Format.h"
+#include "app/App.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/FourCC.h"
@@ -11,13 +12,14 @@
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
 #include "core/collection/DynamicArray.h"
+#include "io/BufferedReadStream.h"
 #include "io/Stream.h"
 #include "voxel/Face.h"
 #include "voxel/Palette.h"
 #include "voxel/PaletteLookup.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraph.h"
-#include "voxelutil/VolumeVisitor.h"
+#include "voxelutil/SurfaceMask.h"
 #include <glm/common.hpp>
 
 namespace voxelformat {
@@ -34,9 +36,8 @@ enum KV6Visibility {
 	Down = 32
 };
 
-static uint8_t calculateVisibility(const voxel::RawVolume *v, int x, int y, int z) {
+static uint8_t calculateVisibility(voxel::FaceBits visBits) {
 	uint8_t vis = 0;
-	voxel::FaceBits visBits = voxel::visibleFaces(*v, x, y, z);
 	if (visBits == voxel::FaceBits::None) {
 		return vis;
 	}
@@ -211,30 +212,24 @@ bool KV6Format::loadGroupsPalette(const core::String &filename, io::SeekableRead
 
 	core::ScopedPtr<priv::State> state(new priv::State());
 	voxel::PaletteLookup palLookup(palette);
-	for (uint32_t c = 0u; c < numvoxs; ++c) {
-		uint8_t palr, palg, palb, pala;
-		wrap(stream.readUInt8(palb))
-		wrap(stream.readUInt8(palg))
-		wrap(stream.readUInt8(palr))
-		wrap(stream.readUInt8(pala)) // always 128
-		const glm::vec4& color = core::Color::fromRGBA(palr, palg, palb, 255);
-		state->voxdata[c].col = palLookup.findClosestIndex(color);
-		wrap(stream.readUInt8(state->voxdata[c].z_low_h))
-		wrap(stream.readUInt8(state->voxdata[c].z_high))
-		wrap(stream.readUInt8(state->voxdata[c].vis))
-		wrap(stream.readUInt8(state->voxdata[c].dir))
-		Log::debug("voxel %u/%u z-low: %u, z_high: %u, vis: %i. dir: %u, pal: %u",
-				c, numvoxs, state->voxdata[c].z_low_h, state->voxdata[c].z_high, state->voxdata[c].vis, state->voxdata[c].dir, state->voxdata[c].col);
-	}
-	for (uint32_t x = 0u; x < xsiz_w; ++x) {
-		wrap(stream.readInt32(state->xlen[x]))
-		Log::debug("xlen[%u]: %i", x, state->xlen[x]);
-	}
-
-	for (uint32_t x = 0u; x < xsiz_w; ++x) {
-		for (uint32_t y = 0u; y < ysiz_d; ++y) {
-			wrap(stream.readUInt16(state->xyoffset[x][y]))
-			Log::debug("xyoffset[%u][%u]: %u", x, y, state->xyoffset[x][y]);
+	{
+		io::BufferedReadStream reader(stream);
+		for (uint32_t c = 0u; c < numvoxs; ++c) {
+			uint8_t palr, palg, palb, pala;
+			wrap(reader.readUInt8(palb))
+			wrap(reader.readUInt8(palg))
+			wrap(reader.readUInt8(palr))
+			wrap(reader.readUInt8(pala)) // always 128
+			const glm::vec4& color = core::Color::fromRGBA(palr, palg, palb, 255);
+			state->voxdata[c].col = palLookup.findClosestIndex(color);
+			wrap(reader.readUInt8(state->voxdata[c].z_low_h))
+			wrap(reader.readUInt8(state->voxdata[c].z_high))
+			wrap(reader.readUInt8(state->voxdata[c].vis))
+			wrap(reader.readUInt8(state->voxdata[c].dir))
+		}
+		wrap(reader.readInt32Array(state->xlen, xsiz_w))
+		for (uint32_t x = 0u; x < xsiz_w; ++x) {
+			wrap(reader.readUInt16Array(state->xyoffset[x], ysiz_d))
 		}
 	}
 
@@ -311,7 +306,9 @@ bool KV6Format::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core:
 	uint16_t xyoffset[256][256] {}; // our z
 
 	core::DynamicArray<priv::voxtype> voxdata;
-	const uint32_t numvoxs = voxelutil::visitSurfaceVolume(*merged.first, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+	const voxelutil::SurfaceMask surface(app::App::getInstance()->threadPool(), *merged.first);
+	const uint32_t numvoxs = surface.visitSurface([&](int x, int y, int z, voxel::FaceBits faces) {
+		const voxel::Voxel &voxel = merged.first->voxel(x, y, z);
 		priv::voxtype vd;
 		const int x_low_w = x - region.getLowerX();
 		// flip y and z here
@@ -319,12 +316,12 @@ bool KV6Format::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core:
 		vd.z_low_h = region.getHeightInCells() - (y - region.getLowerY());
 		vd.z_high = 0;
 		vd.col = voxel.getColor();
-		vd.vis = priv::calculateVisibility(merged.first, x, y, z);
+		vd.vis = priv::calculateVisibility(faces);
 		vd.dir = priv::calculateDir(merged.first, x, y, z, voxel);
 		voxdata.push_back(vd);
 		++xlen[x_low_w];
 		++xyoffset[x_low_w][y_low_d];
-	}, voxelutil::VisitorOrder::XZY);
+	});
 
 	constexpr uint32_t MAXVOXS = 1048576;
 	if (numvoxs > MAXVOXS) {
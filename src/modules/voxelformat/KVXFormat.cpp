@@ -3,6 +3,7 @@
  */
 
 #include "KVXFormat.h"
+#include "app/App.h"
 #include "io/Stream.h"
 #include "voxel/MaterialColor.h"
 #include "io/FileStream.h"
@@ -12,6 +13,7 @@
 #include "voxel/PaletteLookup.h"
 #include "voxel/Palette.h"
 #include "scenegraph/SceneGraph.h"
+#include "voxelutil/SurfaceMask.h"
 #include <glm/common.hpp>
 
 namespace voxelformat {
@@ -28,9 +30,8 @@ enum KVXVisibility {
 	Down = 32
 };
 
-static uint8_t calculateVisibility(const voxel::RawVolume *v, int x, int y, int z) {
+static uint8_t calculateVisibility(voxel::FaceBits visBits) {
 	uint8_t vis = 0;
-	voxel::FaceBits visBits = voxel::visibleFaces(*v, x, y, z);
 	if (visBits == voxel::FaceBits::None) {
 		return vis;
 	}
@@ -276,7 +277,9 @@ bool KVXFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core:
 	uint16_t xyoffset[256][256] {}; // our z
 
 	core::DynamicArray<priv::slab> voxdata;
-	const uint32_t numvoxs = voxelutil::visitSurfaceVolume(*merged.first, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+	const voxelutil::SurfaceMask surface(app::App::getInstance()->threadPool(), *merged.first);
+	const uint32_t numvoxs = surface.visitSurface([&](int x, int y, int z, voxel::FaceBits faces) {
+		const voxel::Voxel &voxel = merged.first->voxel(x, y, z);
 		priv::slab vd;
 		vd.x_low_w = x - region.getLowerX();
 		// flip y and z here
@@ -284,11 +287,11 @@ bool KVXFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core:
 		vd.col = voxel.getColor();
 		vd.slabzleng = 0; // TODO
 		vd.slabztop = region.getHeightInCells() - (y - region.getLowerY()); // TODO
-		vd.slabbackfacecullinfo = priv::calculateVisibility(merged.first, x, y, z);
+		vd.slabbackfacecullinfo = priv::calculateVisibility(faces);
 		voxdata.push_back(vd);
 		++xlen[x];
 		++xyoffset[vd.x_low_w][vd.y_low_d];
-	}, voxelutil::VisitorOrder::XZY);
+	});
 
 	constexpr uint32_t MAXVOXS = 1048576;
 	if (numvoxs > MAXVOXS) {
@@ -3,12 +3,17 @@
  */
 
 #include "MCRFormat.h"
+#include "app/App.h"
+#include "core/ArrayLength.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include "core/GameConfig.h"
 #include "core/StringUtil.h"
+#include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/StringMap.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/File.h"
 #include "io/MemoryReadStream.h"
 #include "io/ZipReadStream.h"
@@ -23,6 +28,7 @@
 #include "voxelutil/VolumeMerger.h"
 
 #include <glm/common.hpp>
+#include <limits>
 
 namespace voxelformat {
 
@@ -51,6 +57,10 @@ bool MCRFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 		Log::warn("Failed to parse the region chunk boundaries from filename %s (%i.%i.%c)", name.c_str(), chunkX, chunkZ, type);
 	}
 
+	if (!parseBounds(core::Var::getSafe(cfg::VoxformatMCRBounds)->strVal())) {
+		return false;
+	}
+
 	palette.minecraft();
 	switch (type) {
 	case 'r':	// Region file format
@@ -82,7 +92,7 @@ bool MCRFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 			return false;
 		}
 
-		const bool success = loadMinecraftRegion(sceneGraph, stream, palette);
+		const bool success = loadMinecraftRegion(sceneGraph, stream, palette, chunkX, chunkZ);
 		return success;
 	}
 	}
@@ -90,27 +100,110 @@ bool MCRFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 	return false;
 }
 
-bool MCRFormat::loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream, const voxel::Palette &palette) {
+bool MCRFormat::parseBounds(const core::String &bounds) {
+	_bounds = voxel::Region::InvalidRegion;
+	if (bounds.empty()) {
+		return true;
+	}
+	glm::ivec3 mins;
+	glm::ivec3 maxs;
+	if (SDL_sscanf(bounds.c_str(), "%i %i %i %i %i %i", &mins.x, &mins.y, &mins.z, &maxs.x, &maxs.y, &maxs.z) == 6) {
+		_bounds = voxel::Region(mins, maxs);
+	} else if (SDL_sscanf(bounds.c_str(), "%i %i", &mins.y, &maxs.y) == 2) {
+		// only a y range is given
+		const int maxInt = (std::numeric_limits<int>::max)() / 2;
+		_bounds = voxel::Region(-maxInt, mins.y, -maxInt, maxInt, maxs.y, maxInt);
+	}
+	if (!_bounds.isValid()) {
+		Log::error("Invalid bounds given for the minecraft region import: '%s'", bounds.c_str());
+		return false;
+	}
+	Log::debug("Only import the blocks in %s", _bounds.toString().c_str());
+	return true;
+}
+
+bool MCRFormat::skipChunk(int chunkX, int chunkZ) const {
+	if (!_bounds.isValid()) {
+		return false;
+	}
+	const voxel::Region chunkRegion(chunkX * MAX_SIZE, _bounds.getLowerY(), chunkZ * MAX_SIZE,
+									chunkX * MAX_SIZE + MAX_SIZE - 1, _bounds.getUpperY(), chunkZ * MAX_SIZE + MAX_SIZE - 1);
+	return !voxel::intersects(_bounds, chunkRegion);
+}
+
+bool MCRFormat::skipSection(int sectionY) const {
+	if (!_bounds.isValid()) {
+		return false;
+	}
+	const int lowerY = sectionY * MAX_SIZE;
+	const int upperY = lowerY + MAX_SIZE - 1;
+	return upperY < _bounds.getLowerY() || lowerY > _bounds.getUpperY();
+}
+
+bool MCRFormat::loadMinecraftRegion(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream, const voxel::Palette &palette, int regionX, int regionZ) {
+	// the stream is read sequentially - the chunks are decompressed and converted in parallel afterwards
+	core::DynamicArray<CompressedChunk> chunks;
 	for (int i = 0; i < SECTOR_INTS; ++i) {
 		if (_offsets[i].sectorCount == 0u || _offsets[i].offset < sizeof(_offsets)) {
 			continue;
 		}
+		// the chunks are stored in x/z order in the region - this allows us to skip them without decompressing
+		const int chunkX = regionX * 32 + (i & 31);
+		const int chunkZ = regionZ * 32 + (i >> 5);
+		if (skipChunk(chunkX, chunkZ)) {
+			Log::debug("Skip chunk %i:%i", chunkX, chunkZ);
+			continue;
+		}
 		if (_offsets[i].offset + 6 >= (uint32_t)stream.size()) {
 			return false;
 		}
 		if (stream.seek(_offsets[i].offset) == -1) {
 			continue;
 		}
-		if (!readCompressedNBT(sceneGraph, stream, i, palette)) {
+		CompressedChunk chunk;
+		chunk.sector = i;
+		if (!readCompressedChunk(stream, chunk)) {
 			Log::error("Failed to load minecraft chunk section %i for offset %u", i, (int)_offsets[i].offset);
 			return false;
 		}
+		if (chunk.data.empty()) {
+			continue;
+		}
+		chunks.emplace_back(core::move(chunk));
 	}
 
-	return true;
+	app::App::getInstance()->threadPool().parallelFor(0, (int)chunks.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			CompressedChunk &chunk = chunks[i];
+			chunk.success = decodeChunk(chunk, palette);
+			chunk.data.release();
+		}
+	});
+
+	// add the nodes in the order of the chunks in the region file
+	bool success = true;
+	for (CompressedChunk &chunk : chunks) {
+		if (!success || !chunk.success) {
+			if (success) {
+				Log::error("Failed to load minecraft chunk section %i for offset %u", chunk.sector,
+						   (int)_offsets[chunk.sector].offset);
+			}
+			success = false;
+			delete chunk.volume;
+			continue;
+		}
+		if (chunk.volume == nullptr) {
+			continue;
+		}
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(chunk.volume, true);
+		node.setPalette(palette);
+		sceneGraph.emplace(core::move(node));
+	}
+	return success;
 }
 
-bool MCRFormat::readCompressedNBT(scenegraph::SceneGraph &sceneGraph, io::SeekableReadStream &stream, int sector, const voxel::Palette &palette) {
+bool MCRFormat::readCompressedChunk(io::SeekableReadStream &stream, CompressedChunk &chunk) {
 	uint32_t nbtSize;
 	wrap(stream.readUInt32BE(nbtSize));
 	if (nbtSize == 0) {
@@ -133,59 +226,71 @@ bool MCRFormat::readCompressedNBT(scenegraph::SceneGraph &sceneGraph, io::Seekab
 	// the version is included in the length
 	--nbtSize;
 
-	io::ZipReadStream zipStream(stream, (int)nbtSize);
+	chunk.data.resize(nbtSize);
+	if (stream.read(chunk.data.data(), nbtSize) != (int)nbtSize) {
+		Log::error("Failed to read the compressed nbt data of sector %i", chunk.sector);
+		return false;
+	}
+	return true;
+}
+
+bool MCRFormat::decodeChunk(CompressedChunk &chunk, const voxel::Palette &palette) const {
+	io::MemoryReadStream stream(chunk.data.data(), (uint32_t)chunk.data.size());
+	io::ZipReadStream zipStream(stream, (int)chunk.data.size());
 	priv::NamedBinaryTagContext ctx;
 	ctx.stream = &zipStream;
+	ctx.skipTags = &skipTags();
 	const priv::NamedBinaryTag &root = priv::NamedBinaryTag::parse(ctx);
 	if (!root.valid()) {
 		Log::error("Could not parse nbt structure");
 		return false;
 	}
 
-	voxel::RawVolume *volume;
 	// https://minecraft.fandom.com/wiki/Data_version
 	const int32_t dataVersion = root.get("DataVersion").int32();
 	Log::debug("Found data version %i", dataVersion);
 	if (dataVersion >= 2844) {
-		volume = parseSections(dataVersion, root, sector, palette);
-		if (volume == nullptr) {
-			return false;
-		}
+		chunk.volume = parseSections(dataVersion, root, chunk.sector, palette);
 	} else {
-		volume = parseLevelCompound(dataVersion, root, sector, palette);
-		if (volume == nullptr) {
-			return false;
+		chunk.volume = parseLevelCompound(dataVersion, root, chunk.sector, palette);
+	}
+	if (chunk.volume == nullptr) {
+		if (_bounds.isValid()) {
+			// all sections of this chunk might be outside of the bounds
+			Log::debug("No blocks in the given bounds for sector %i", chunk.sector);
+			return true;
 		}
+		return false;
 	}
-	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
-	node.setVolume(volume, true);
-	node.setPalette(palette);
-	sceneGraph.emplace(core::move(node));
 	return true;
 }
 
-int MCRFormat::getVoxel(int dataVersion, const priv::NamedBinaryTag &data, const glm::ivec3 &pos) {
-	const uint32_t i = pos.y * MAX_SIZE * MAX_SIZE + pos.z * MAX_SIZE + pos.x;
-	if (i >= data.byteArray()->size()) {
-		Log::error("Byte array index out of bounds: %u/%i", i, (int)data.byteArray()->size());
-		return -1;
-	}
-	const int val = (int)(uint8_t)(*data.byteArray())[i];
-	if (val < 0) {
-		Log::error("Invalid value: %i", val);
-		return -1;
-	}
-	return val;
+/**
+ * @brief The chunk tags that are not needed to create the volumes - they are skipped while parsing the nbt data
+ */
+const core::StringSet &MCRFormat::skipTags() {
+	static const core::StringSet tags = [] () {
+		const char *names[] = {"Entities", "TileEntities", "block_entities", "TileTicks", "LiquidTicks", "block_ticks",
+							   "fluid_ticks", "BlockLight", "SkyLight", "Heightmaps", "HeightMap", "Biomes", "biomes",
+							   "Structures", "structures", "Lights", "LiquidsToBeTicked", "ToBeTicked", "PostProcessing",
+							   "CarvingMasks", "blending_data", "UpgradeData"};
+		core::StringSet set(64);
+		for (const char *name : names) {
+			set.insert(name);
+		}
+		return set;
+	}();
+	return tags;
 }
 
-voxel::RawVolume *MCRFormat::error(SectionVolumes &volumes) {
+voxel::RawVolume *MCRFormat::error(SectionVolumes &volumes) const {
 	for (voxel::RawVolume *v : volumes) {
 		delete v;
 	}
 	return nullptr;
 }
 
-voxel::RawVolume* MCRFormat::finalize(SectionVolumes& volumes, int xPos, int zPos) {
+voxel::RawVolume* MCRFormat::finalize(SectionVolumes& volumes, int xPos, int zPos) const {
 	if (volumes.empty()) {
 		Log::error("No volumes found at %i:%i", xPos, zPos);
 		return nullptr;
@@ -196,138 +301,190 @@ voxel::RawVolume* MCRFormat::finalize(SectionVolumes& volumes, int xPos, int zPo
 		delete v;
 	}
 	merged->translate(glm::ivec3(xPos * MAX_SIZE, 0, zPos * MAX_SIZE));
-	voxel::RawVolume *cropped = voxelutil::cropVolume(merged);
+	voxel::RawVolume *cropped;
+	if (_bounds.isValid()) {
+		voxel::Region region = merged->region();
+		region.cropTo(_bounds);
+		if (!region.isValid()) {
+			delete merged;
+			return nullptr;
+		}
+		voxel::RawVolume *clipped = voxelutil::cropVolume(merged, region.getLowerCorner(), region.getUpperCorner());
+		delete merged;
+		merged = clipped;
+	}
+	cropped = voxelutil::cropVolume(merged);
 	delete merged;
 	return cropped;
 }
 
-bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette, const priv::NamedBinaryTag &data, SectionVolumes &volumes, int sectionY, const MinecraftSectionPalette &secPal) {
+/**
+ * @brief Unpacks the palette indices of all blocks of a section
+ *
+ * Before data version 2529 the indices are a continuous bit stream and may span over two longs. Since then the
+ * indices don't span - the remaining bits of a long are padding.
+ * @note The bit width is a template parameter for the common widths to let the compiler turn the shifts and masks
+ * into constants.
+ */
+template<bool Spanning>
+static CORE_FORCE_INLINE void unpackBlockStatesBits(const int64_t *states, uint32_t bits, uint16_t *indices) {
+	const uint64_t mask = (1ull << bits) - 1u;
+	if (Spanning) {
+		uint64_t bitPos = 0u;
+		for (int i = 0; i < MCRFormat::SectionBlocks; ++i, bitPos += bits) {
+			const uint64_t l = bitPos >> 6u;
+			const uint64_t offset = bitPos & 63u;
+			uint64_t value = (uint64_t)states[l] >> offset;
+			if (offset + bits > 64u) {
+				value |= (uint64_t)states[l + 1] << (64u - offset);
+			}
+			indices[i] = (uint16_t)(value & mask);
+		}
+		return;
+	}
+	const int perLong = 64 / (int)bits;
+	int i = 0;
+	for (int l = 0; i < MCRFormat::SectionBlocks; ++l) {
+		uint64_t state = (uint64_t)states[l];
+		const int n = core_min(perLong, MCRFormat::SectionBlocks - i);
+		for (int k = 0; k < n; ++k) {
+			indices[i++] = (uint16_t)(state & mask);
+			state >>= bits;
+		}
+	}
+}
+
+template<bool Spanning>
+static void unpackBlockStates(const int64_t *states, uint32_t bits, uint16_t *indices) {
+	switch (bits) {
+	case 4:
+		unpackBlockStatesBits<Spanning>(states, 4, indices);
+		break;
+	case 5:
+		unpackBlockStatesBits<Spanning>(states, 5, indices);
+		break;
+	case 6:
+		unpackBlockStatesBits<Spanning>(states, 6, indices);
+		break;
+	case 7:
+		unpackBlockStatesBits<Spanning>(states, 7, indices);
+		break;
+	case 8:
+		unpackBlockStatesBits<Spanning>(states, 8, indices);
+		break;
+	case 9:
+		unpackBlockStatesBits<Spanning>(states, 9, indices);
+		break;
+	case 10:
+		unpackBlockStatesBits<Spanning>(states, 10, indices);
+		break;
+	case 11:
+		unpackBlockStatesBits<Spanning>(states, 11, indices);
+		break;
+	case 12:
+		unpackBlockStatesBits<Spanning>(states, 12, indices);
+		break;
+	default:
+		unpackBlockStatesBits<Spanning>(states, bits, indices);
+		break;
+	}
+}
+
+bool MCRFormat::unpackBlockStates(int dataVersion, const core::DynamicArray<int64_t> &blockStates, uint32_t numBits,
+								  uint16_t *indices) {
+	if (dataVersion < 2529) {
+		const uint32_t bits = (uint32_t)(blockStates.size() * 64 / SectionBlocks);
+		if (bits == 0u || bits > 16u) {
+			Log::error("Invalid block states size: %i", (int)blockStates.size());
+			return false;
+		}
+		voxelformat::unpackBlockStates<true>(blockStates.data(), bits, indices);
+		return true;
+	}
+	if (numBits == 0u || numBits > 16u) {
+		Log::error("Invalid block state bits: %u", numBits);
+		return false;
+	}
+	const size_t perLong = 64 / numBits;
+	const size_t neededLongs = (SectionBlocks + perLong - 1) / perLong;
+	if (blockStates.size() < neededLongs) {
+		Log::error("Not enough block states: %i/%i", (int)blockStates.size(), (int)neededLongs);
+		return false;
+	}
+	voxelformat::unpackBlockStates<false>(blockStates.data(), numBits, indices);
+	return true;
+}
+
+bool MCRFormat::parseBlockStates(int dataVersion, const voxel::Palette &palette, const priv::NamedBinaryTag &data, SectionVolumes &volumes, int sectionY, const MinecraftSectionPalette &secPal) const {
 	Log::debug("Parse block states");
 	const bool hasData = data.type() == priv::TagType::LONG_ARRAY && !data.longArray()->empty();
 
-	constexpr glm::ivec3 mins(0, 0, 0);
-	constexpr glm::ivec3 maxs(MAX_SIZE - 1, MAX_SIZE - 1, MAX_SIZE - 1);
-	const voxel::Region region(mins, maxs);
-	voxel::RawVolume *v = new voxel::RawVolume(region);
-	voxel::RawVolumeWrapper wrapper(v);
-
+	// the minecraft colors of the blocks
+	uint8_t blocks[SectionBlocks];
 	if (secPal.pal.empty()) {
 		if (data.type() != priv::TagType::BYTE_ARRAY) {
 			Log::error("Unknown block data type: %i for version %i", (int)data.type(), dataVersion);
-			delete v;
 			return false;
 		}
-		glm::ivec3 sPos;
-		for (sPos.y = 0; sPos.y < MAX_SIZE; ++sPos.y) {
-			for (sPos.z = 0; sPos.z < MAX_SIZE; ++sPos.z) {
-				for (sPos.x = 0; sPos.x < MAX_SIZE; ++sPos.x) {
-					const int color = getVoxel(dataVersion, data, sPos);
-					if (color < 0) {
-						Log::error("Failed to load voxel at position %i:%i:%i (dataversion: %i)", sPos.x, sPos.y, sPos.z, dataVersion);
-						delete v;
-						return false;
-					}
-					if (color) {
-						const uint8_t palColIdx = palette.getClosestMatch(secPal.mcpal.color(color));
-						const voxel::Voxel voxel = voxel::createVoxel(palette, palColIdx);
-						wrapper.setVoxel(sPos, voxel);
-					}
-				}
-			}
+		const core::DynamicArray<int8_t> &byteArray = *data.byteArray();
+		if (byteArray.size() < (size_t)SectionBlocks) {
+			Log::error("Byte array index out of bounds: %i/%i", (int)byteArray.size(), SectionBlocks);
+			return false;
 		}
+		core_memcpy(blocks, byteArray.data(), sizeof(blocks));
 	} else if (hasData) {
-		if (data.type() != priv::TagType::LONG_ARRAY) {
-			Log::error("Unknown block data type: %i for version %i", (int)data.type(), dataVersion);
-			delete v;
+		uint16_t indices[SectionBlocks];
+		if (!unpackBlockStates(dataVersion, *data.longArray(), secPal.numBits, indices)) {
 			return false;
 		}
-
-		const core::DynamicArray<int64_t> &blockStates = *data.longArray();
-
-		uint8_t blocks[4096];
-		int bsCnt = 0;
-		size_t bitCnt = 0;
-		if (dataVersion < 2529) {
-			const size_t bitSize = (data.longArray()->size()) * 64 / 4096;
-			const uint32_t bitMask = (1 << bitSize) - 1;
-			for (int i = 0; i < 4096; i++) {
-				if (bitCnt + bitSize <= 64) {
-					const uint64_t blockState = blockStates[bsCnt];
-					const uint64_t blockIndex = (blockState >> bitCnt) & bitMask;
-					if (blockIndex < secPal.pal.size()) {
-						blocks[i] = secPal.pal[blockIndex];
-					} else {
-						blocks[i] = 0;
-					}
-					bitCnt += bitSize;
-					if (bitCnt == 64) {
-						bitCnt = 0;
-						bsCnt++;
-					}
-				} else {
-					const uint64_t blockState1 = blockStates[bsCnt++];
-					const uint64_t blockState2 = blockStates[bsCnt];
-					uint32_t blockIndex = (blockState1 >> bitCnt) & bitMask;
-					bitCnt += bitSize;
-					bitCnt -= 64;
-					blockIndex += (blockState2 << (bitSize - bitCnt)) & bitMask;
-					if (blockIndex < secPal.pal.size()) {
-						blocks[i] = secPal.pal[blockIndex];
-					} else {
-						blocks[i] = 0;
-					}
-				}
-			}
-		} else {
-			const size_t bitSize = secPal.numBits;
-			const uint32_t bitMask = (1 << bitSize) - 1;
-			for (int i = 0; i < 4096; i++) {
-				const uint64_t blockState = blockStates[bsCnt];
-				const uint64_t blockIndex = (blockState >> bitCnt) & bitMask;
-				if (blockIndex < secPal.pal.size()) {
-					blocks[i] = secPal.pal[blockIndex];
-				} else {
-					blocks[i] = 0;
-				}
-				bitCnt += bitSize;
-				if (bitCnt + bitSize > 64) {
-					bsCnt++;
-					bitCnt = 0;
-				}
-			}
+		const size_t palSize = secPal.pal.size();
+		for (int i = 0; i < SectionBlocks; ++i) {
+			blocks[i] = indices[i] < palSize ? secPal.pal[indices[i]] : 0;
 		}
+	} else {
+		return true;
+	}
 
-		glm::ivec3 sPos;
-		for (sPos.y = 0; sPos.y < MAX_SIZE; ++sPos.y) {
-			for (sPos.z = 0; sPos.z < MAX_SIZE; ++sPos.z) {
-				for (sPos.x = 0; sPos.x < MAX_SIZE; ++sPos.x) {
-					const uint16_t i = sPos.y * MAX_SIZE * MAX_SIZE + sPos.z * MAX_SIZE + sPos.x;
-					const uint8_t color = blocks[i];
-					if (color) {
-						const uint8_t palColIdx = palette.getClosestMatch(secPal.mcpal.color(color));
-						const voxel::Voxel voxel = voxel::createVoxel(palette, palColIdx);
-						wrapper.setVoxel(sPos, voxel);
-					}
+	constexpr glm::ivec3 mins(0, 0, 0);
+	constexpr glm::ivec3 maxs(MAX_SIZE - 1, MAX_SIZE - 1, MAX_SIZE - 1);
+	const voxel::Region region(mins, maxs);
+	voxel::RawVolume *v = new voxel::RawVolume(region);
+
+	// the closest match is only computed once per minecraft color of this section
+	int16_t colorMapping[256];
+	for (int i = 0; i < lengthof(colorMapping); ++i) {
+		colorMapping[i] = -1;
+	}
+	bool empty = true;
+	int i = 0;
+	glm::ivec3 sPos;
+	for (sPos.y = 0; sPos.y < MAX_SIZE; ++sPos.y) {
+		for (sPos.z = 0; sPos.z < MAX_SIZE; ++sPos.z) {
+			for (sPos.x = 0; sPos.x < MAX_SIZE; ++sPos.x, ++i) {
+				const uint8_t color = blocks[i];
+				if (color == 0u) {
+					continue;
+				}
+				if (colorMapping[color] == -1) {
+					colorMapping[color] = (int16_t)(uint8_t)palette.getClosestMatch(secPal.mcpal.color(color));
 				}
+				const voxel::Voxel voxel = voxel::createVoxel(palette, (uint8_t)colorMapping[color]);
+				v->setVoxel(sPos, voxel);
+				empty = false;
 			}
 		}
 	}
 
-	if (wrapper.dirtyRegion().isValid()) {
-		glm::ivec3 translate;
-		translate.x = 0;
-		translate.y = sectionY * MAX_SIZE;
-		translate.z = 0;
-
-		v->translate(translate);
-		volumes.push_back(v);
-	} else {
+	if (empty) {
 		delete v;
+		return true;
 	}
+	v->translate(glm::ivec3(0, sectionY * MAX_SIZE, 0));
+	volumes.push_back(v);
 	return true;
 }
 
-voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &pal) {
+voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &pal) const {
 	const priv::NamedBinaryTag &sections = root.get("sections");
 	if (!sections.valid()) {
 		Log::error("Could not find 'sections' tag");
@@ -365,6 +522,9 @@ voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBin
 			Log::debug("Skip empty section compound");
 		}
 		Log::debug("Y level for section compound: %i", (int)sectionY);
+		if (skipSection(sectionY)) {
+			continue;
+		}
 
 		const priv::NamedBinaryTag &palette = blockStates.get("palette");
 		if (!palette.valid()) {
@@ -386,7 +546,7 @@ voxel::RawVolume *MCRFormat::parseSections(int dataVersion, const priv::NamedBin
 	return finalize(volumes, xPos, zPos);
 }
 
-voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &pal) {
+voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &pal) const {
 	const priv::NamedBinaryTag &levels = root.get("Level");
 	if (!levels.valid()) {
 		Log::error("Could not find 'Level' tag");
@@ -441,6 +601,9 @@ voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::Nam
 			Log::debug("Skip empty section compound");
 		}
 		Log::debug("Y level for section compound: %i", (int)sectionY);
+		if (skipSection(sectionY)) {
+			continue;
+		}
 
 		MinecraftSectionPalette secPal;
 		secPal.mcpal.minecraft();
@@ -471,7 +634,7 @@ voxel::RawVolume *MCRFormat::parseLevelCompound(int dataVersion, const priv::Nam
 	return finalize(volumes, xPos, zPos);
 }
 
-bool MCRFormat::parsePaletteList(int dataVersion, const priv::NamedBinaryTag &palette, MinecraftSectionPalette &sectionPal) {
+bool MCRFormat::parsePaletteList(int dataVersion, const priv::NamedBinaryTag &palette, MinecraftSectionPalette &sectionPal) const {
 	if (palette.type() != priv::TagType::LIST) {
 		Log::error("Invalid type for palette: %i", (int)palette.type());
 		return false;
@@ -556,7 +719,7 @@ bool MCRFormat::saveCompressedNBT(const scenegraph::SceneGraph &sceneGraph, io::
 	const int64_t nbtStartOffset = stream.pos();
 	wrapBool(stream.writeUInt8(VERSION_GZIP));
 
-	io::ZipWriteStream zipStream(stream);
+	io::ZipWriteStream zipStream(stream, 6, &app::App::getInstance()->threadPool());
 	priv::NBTCompound root;
 	root.put("DataVersion", 2844);
 	int x = 0; // TODO
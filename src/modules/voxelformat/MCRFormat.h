@@ -8,7 +8,10 @@
 #include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicMap.h"
+#include "core/collection/SmallVector.h"
+#include "core/collection/StringSet.h"
 #include "voxel/Palette.h"
+#include "voxel/Region.h"
 
 namespace io {
 class ZipReadStream;
@@ -20,7 +23,7 @@ namespace voxelformat {
 namespace priv {
 class NamedBinaryTag;
 using NBTCompound = core::DynamicMap<core::String, NamedBinaryTag, 11, core::StringHash>;
-using NBTList = core::DynamicArray<NamedBinaryTag>;
+using NBTList = core::SmallVector<NamedBinaryTag, 4>;
 }
 
 /**
@@ -71,6 +74,17 @@ class MCRFormat : public PaletteFormat {
 public:
 	static constexpr int SECTOR_BYTES = 4096;
 	static constexpr int SECTOR_INTS = SECTOR_BYTES / 4;
+	/** the amount of blocks in a 16x16x16 section */
+	static constexpr int SectionBlocks = 16 * 16 * 16;
+
+	/**
+	 * @brief Unpacks the variable bit width palette indices of all blocks of a section
+	 * @param numBits The bits per index for data version 2529 and later - before that the bits are derived from the
+	 * amount of longs
+	 * @param[out] indices @c SectionBlocks palette indices
+	 */
+	static bool unpackBlockStates(int dataVersion, const core::DynamicArray<int64_t> &blockStates, uint32_t numBits,
+								  uint16_t *indices);
 private:
 	static constexpr int VERSION_GZIP = 1;
 	static constexpr int VERSION_DEFLATE = 2;
@@ -89,23 +103,50 @@ private:
 
 	using SectionVolumes = core::DynamicArray<voxel::RawVolume *>;
 
-	voxel::RawVolume* error(SectionVolumes &volumes);
-	voxel::RawVolume* finalize(SectionVolumes& volumes, int xPos, int zPos);
+	/**
+	 * @brief The world coordinates of the blocks that should get imported. The filter is applied before the
+	 * chunks are decompressed and before the block states of a section are unpacked.
+	 * @sa cfg::VoxformatMCRBounds
+	 */
+	voxel::Region _bounds = voxel::Region::InvalidRegion;
 
-	static int getVoxel(int dataVersion, const priv::NamedBinaryTag &data, const glm::ivec3 &pos);
+	bool parseBounds(const core::String &bounds);
+	bool skipChunk(int chunkX, int chunkZ) const;
+	bool skipSection(int sectionY) const;
+
+	voxel::RawVolume* error(SectionVolumes &volumes) const;
+	voxel::RawVolume* finalize(SectionVolumes& volumes, int xPos, int zPos) const;
+
+	static const core::StringSet &skipTags();
 
 	// shared across versions
-	bool parsePaletteList(int dataVersion, const priv::NamedBinaryTag& palette, MinecraftSectionPalette &sectionPal);
-	bool parseBlockStates(int dataVersion, const voxel::Palette &palette, const priv::NamedBinaryTag &data, SectionVolumes &volumes, int sectionY, const MinecraftSectionPalette &secPal);
+	bool parsePaletteList(int dataVersion, const priv::NamedBinaryTag& palette, MinecraftSectionPalette &sectionPal) const;
+	bool parseBlockStates(int dataVersion, const voxel::Palette &palette, const priv::NamedBinaryTag &data, SectionVolumes &volumes, int sectionY, const MinecraftSectionPalette &secPal) const;
 
 	// new version (>= 2844)
-	voxel::RawVolume* parseSections(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &palette);
+	voxel::RawVolume* parseSections(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &palette) const;
 
 	// old version (< 2844)
-	voxel::RawVolume* parseLevelCompound(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &palette);
-
-	bool readCompressedNBT(scenegraph::SceneGraph& sceneGraph, io::SeekableReadStream &stream, int sector, const voxel::Palette &palette);
-	bool loadMinecraftRegion(scenegraph::SceneGraph& sceneGraph, io::SeekableReadStream &stream, const voxel::Palette &palette);
+	voxel::RawVolume* parseLevelCompound(int dataVersion, const priv::NamedBinaryTag &root, int sector, const voxel::Palette &palette) const;
+
+	/**
+	 * @brief A zlib compressed chunk of the region file and the volume it was converted to
+	 */
+	struct CompressedChunk {
+		core::DynamicArray<uint8_t> data;
+		voxel::RawVolume *volume = nullptr;
+		int sector = 0;
+		bool success = false;
+	};
+	/**
+	 * @brief Reads the compressed chunk data - an empty chunk doesn't have any data
+	 */
+	bool readCompressedChunk(io::SeekableReadStream &stream, CompressedChunk &chunk);
+	/**
+	 * @brief Decompresses the chunk and creates the volume - this is called in parallel for the chunks of a region
+	 */
+	bool decodeChunk(CompressedChunk &chunk, const voxel::Palette &palette) const;
+	bool loadMinecraftRegion(scenegraph::SceneGraph& sceneGraph, io::SeekableReadStream &stream, const voxel::Palette &palette, int regionX, int regionZ);
 
 	bool saveSections(const scenegraph::SceneGraph &sceneGraph, priv::NBTList &sections, int sector);
 	bool saveCompressedNBT(const scenegraph::SceneGraph &sceneGraph, io::SeekableWriteStream& stream, int sector);
@@ -14,6 +14,7 @@
 #include "core/Var.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Map.h"
+#include "core/collection/StringMap.h"
 #include "core/concurrent/Lock.h"
 #include "core/concurrent/ThreadPool.h"
 #include "io/FormatDescription.h"
@@ -28,6 +29,7 @@
 #include "voxel/PaletteLookup.h"
 #include "voxel/Mesh.h"
 #include "voxelformat/private/Tri.h"
+#include "voxelutil/AmbientOcclusion.h"
 #include "voxelutil/VoxelUtil.h"
 #include <SDL_timer.h>
 #include <glm/ext/scalar_constants.hpp>
@@ -53,6 +55,27 @@ MeshFormat::MeshExt* MeshFormat::getParent(const scenegraph::SceneGraph &sceneGr
 	return nullptr;
 }
 
+bool MeshFormat::bakeAmbientOcclusion(const scenegraph::SceneGraph &sceneGraph, const MeshExt &meshExt,
+									  const voxel::Mesh &mesh, core::DynamicArray<float> &occlusion) {
+	if (!core::Var::getSafe(cfg::VoxformatBakeAmbientOcclusion)->boolVal()) {
+		return false;
+	}
+	const scenegraph::SceneGraphNode &node = sceneGraph.node(meshExt.nodeId);
+	const voxel::RawVolume *volume = node.volume();
+	if (volume == nullptr) {
+		return false;
+	}
+	Log::debug("Bake the ambient occlusion of %s", meshExt.name.c_str());
+	voxelutil::bakeAmbientOcclusion(app::App::getInstance()->threadPool(), *volume, mesh, mesh.getOffset(),
+									 occlusion);
+	return true;
+}
+
+core::RGBA MeshFormat::occludedColor(const core::RGBA &color, float occlusion) {
+	return core::RGBA((uint8_t)glm::round((float)color.r * occlusion), (uint8_t)glm::round((float)color.g * occlusion),
+					  (uint8_t)glm::round((float)color.b * occlusion), color.a);
+}
+
 glm::vec3 MeshFormat::getScale() {
 	const float scale = core::Var::getSafe(cfg::VoxformatScale)->floatVal();
 
@@ -85,6 +108,25 @@ void MeshFormat::subdivideTri(const Tri &tri, TriCollection &tinyTris) {
 	tinyTris.push_back(tri);
 }
 
+void MeshFormat::PosSampling::add(float area, core::RGBA color) {
+	int smallest = 0;
+	for (int i = 0; i < (int)entries.size(); ++i) {
+		PosSamplingEntry &pe = entries[i];
+		if (pe.color == color) {
+			pe.area += area;
+			return;
+		}
+		if (pe.area < entries[smallest].area) {
+			smallest = i;
+		}
+	}
+	if ((int)entries.size() < MaxEntries) {
+		entries.emplace_back(area, color);
+	} else if (entries[smallest].area < area) {
+		entries[smallest] = PosSamplingEntry(area, color);
+	}
+}
+
 core::RGBA MeshFormat::PosSampling::avgColor(uint8_t flattenFactor) const {
 	if (entries.size() == 1) {
 		return core::Color::flattenRGB(entries[0].color.r, entries[0].color.g, entries[0].color.b, entries[0].color.a,
@@ -124,6 +166,97 @@ void MeshFormat::transformTris(const TriCollection &subdivided, PosMap &posMap)
 	}
 }
 
+void MeshFormat::rasterizeTri(const Tri &tri, PosMap &posMap, const glm::ivec3 &clipMins, const glm::ivec3 &clipMaxs) {
+	const float area = tri.area();
+	if (area <= 0.0f) {
+		return;
+	}
+	// a voxel that is touched by a triangle gets at most the weight of a full voxel face
+	const float weight = core_min(area, 1.0f);
+	const glm::vec3 halfSize(0.5f);
+	const glm::ivec3 mins = glm::max(clipMins, glm::ivec3(glm::ceil(tri.mins() - halfSize)));
+	const glm::ivec3 maxs = glm::min(clipMaxs, glm::ivec3(glm::floor(tri.maxs() + halfSize)));
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				const glm::ivec3 p(x, y, z);
+				const glm::vec3 center(p);
+				if (!tri.intersectsBox(center, halfSize)) {
+					continue;
+				}
+				const core::RGBA color = tri.colorAtBarycentric(tri.closestBarycentric(center));
+				auto iter = posMap.find(p);
+				if (iter == posMap.end()) {
+					posMap.emplace(p, {weight, color});
+				} else {
+					iter->value.add(weight, color);
+				}
+			}
+		}
+	}
+}
+
+void MeshFormat::rasterizeTris(const TriCollection &tris, PosMap &posMap) const {
+	Log::debug("rasterize %i triangles", (int)tris.size());
+	glm::vec3 trisMins;
+	glm::vec3 trisMaxs;
+	if (!calculateAABB(tris, trisMins, trisMaxs)) {
+		return;
+	}
+	const glm::vec3 halfSize(0.5f);
+	const glm::ivec3 mins(glm::ceil(trisMins - halfSize));
+	const glm::ivec3 maxs(glm::floor(trisMaxs + halfSize));
+	const glm::ivec3 tiles = (maxs - mins) / RasterizeTileSize + 1;
+	const int tilesPerLayer = tiles.x * tiles.y;
+
+	// a triangle is put into the bucket of every tile that its bounds touch
+	core::DynamicArray<core::DynamicArray<int>> buckets;
+	buckets.resize(tilesPerLayer * tiles.z);
+	for (int i = 0; i < (int)tris.size(); ++i) {
+		const Tri &tri = tris[i];
+		const glm::ivec3 triMins = (glm::ivec3(glm::ceil(tri.mins() - halfSize)) - mins) / RasterizeTileSize;
+		const glm::ivec3 triMaxs = (glm::ivec3(glm::floor(tri.maxs() + halfSize)) - mins) / RasterizeTileSize;
+		for (int z = triMins.z; z <= triMaxs.z; ++z) {
+			for (int y = triMins.y; y <= triMaxs.y; ++y) {
+				for (int x = triMins.x; x <= triMaxs.x; ++x) {
+					buckets[x + y * tiles.x + z * tilesPerLayer].push_back(i);
+				}
+			}
+		}
+	}
+	core::DynamicArray<int> usedTiles;
+	for (int i = 0; i < (int)buckets.size(); ++i) {
+		if (!buckets[i].empty()) {
+			usedTiles.push_back(i);
+		}
+	}
+	Log::debug("rasterize %i tiles", (int)usedTiles.size());
+
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	core_trace_mutex(core::Lock, lock, "RasterizeTris");
+	threadPool.parallelFor(0, (int)usedTiles.size(), 1, [&](int start, int end) {
+		for (int t = start; t < end; ++t) {
+			const int tileIdx = usedTiles[t];
+			const glm::ivec3 tile(tileIdx % tiles.x, (tileIdx / tiles.x) % tiles.y, tileIdx / tilesPerLayer);
+			const glm::ivec3 tileMins = mins + tile * RasterizeTileSize;
+			const glm::ivec3 tileMaxs = tileMins + (RasterizeTileSize - 1);
+			const core::DynamicArray<int> &bucket = buckets[tileIdx];
+			PosMap local((int)bucket.size() * 4);
+			for (int i : bucket) {
+				if (stopExecution()) {
+					return;
+				}
+				rasterizeTri(tris[i], local, tileMins, tileMaxs);
+			}
+			// the tiles don't share any voxel
+			core::ScopedLock scoped(lock);
+			for (const auto &entry : local) {
+				posMap.emplace(entry->first, PosSampling(entry->second));
+			}
+		}
+	});
+}
+
 void MeshFormat::transformTrisAxisAligned(const TriCollection &tris, PosMap &posMap) const {
 	Log::debug("%i triangles", (int)tris.size());
 	for (const Tri &tri : tris) {
@@ -218,17 +351,12 @@ int MeshFormat::voxelizeNode(const core::String &name, scenegraph::SceneGraph &s
 		transformTrisAxisAligned(tris, posMap);
 		voxelizeTris(node, posMap, fillHollow);
 	} else {
-		TriCollection subdivided;
-		for (const Tri &tri : tris) {
-			subdivideTri(tri, subdivided);
-		}
-		if (subdivided.empty()) {
-			Log::warn("Empty volume - could not subdivide");
+		PosMap posMap((int)tris.size() * 3);
+		rasterizeTris(tris, posMap);
+		if (posMap.empty()) {
+			Log::warn("Empty volume - no voxel was touched by the triangles");
 			return InvalidNodeId;
 		}
-
-		PosMap posMap((int)subdivided.size() * 3);
-		transformTris(subdivided, posMap);
 		voxelizeTris(node, posMap, fillHollow);
 	}
 
@@ -382,70 +510,291 @@ core::String MeshFormat::lookupTexture(const core::String &meshFilename, const c
 	return fullpath;
 }
 
-bool MeshFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) {
-	const bool mergeQuads = core::Var::getSafe(cfg::VoxformatMergequads)->boolVal();
-	const bool reuseVertices = core::Var::getSafe(cfg::VoxformatReusevertices)->boolVal();
-	const bool ambientOcclusion = core::Var::getSafe(cfg::VoxformatAmbientocclusion)->boolVal();
-	const bool quads = core::Var::getSafe(cfg::VoxformatQuads)->boolVal();
-	const bool withColor = core::Var::getSafe(cfg::VoxformatWithcolor)->boolVal();
-	const bool withTexCoords = core::Var::getSafe(cfg::VoxformatWithtexcoords)->boolVal();
-	const bool applyTransform = core::Var::getSafe(cfg::VoxformatTransform)->boolVal();
-	const bool marchingCubes = core::Var::getSafe(cfg::VoxformatMarchingCubes)->boolVal();
+void MeshFormat::loadTextures(const core::DynamicArray<TextureSource> &sources,
+							  core::StringMap<image::ImagePtr> &textures) {
+	core_trace_scoped(LoadTextures);
+	// the decoded images and the source that is decoded for them
+	core::DynamicArray<image::ImagePtr> images;
+	core::DynamicArray<const TextureSource *> decode;
+	// index into the images for every source
+	core::DynamicArray<int> sourceImage;
+	core::StringMap<int> files;
+	sourceImage.reserve(sources.size());
+	for (const TextureSource &source : sources) {
+		int idx = -1;
+		if (textures.hasKey(source.name)) {
+			sourceImage.push_back(idx);
+			continue;
+		}
+		if (source.data == nullptr) {
+			if (source.file.empty()) {
+				sourceImage.push_back(idx);
+				continue;
+			}
+			if (!files.get(source.file, idx)) {
+				idx = (int)decode.size();
+				files.put(source.file, idx);
+				decode.push_back(&source);
+			}
+		} else {
+			idx = (int)decode.size();
+			decode.push_back(&source);
+		}
+		sourceImage.push_back(idx);
+	}
+	if (decode.empty()) {
+		return;
+	}
 
-	const glm::vec3 &scale = getScale();
-	const size_t models = sceneGraph.size();
-	core::ThreadPool& threadPool = app::App::getInstance()->threadPool();
-	Meshes meshes;
-	core::Map<int, int> meshIdxNodeMap;
-	core_trace_mutex(core::Lock, lock, "MeshFormat");
-	for (const scenegraph::SceneGraphNode& node : sceneGraph) {
-		auto lambda = [&] () {
+	const int maxSize = core::Var::getSafe(cfg::VoxformatTextureMaxSize)->intVal();
+	images.resize(decode.size());
+	app::App::getInstance()->threadPool().parallelFor(0, (int)decode.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const TextureSource *source = decode[i];
+			image::ImagePtr tex;
+			if (source->data == nullptr) {
+				tex = image::loadImage(source->file);
+			} else {
+				tex = image::createEmptyImage(source->name);
+				tex->load(source->data, source->length);
+			}
+			if (!tex->isLoaded()) {
+				continue;
+			}
+			if (maxSize > 0 && (tex->width() > maxSize || tex->height() > maxSize)) {
+				// keep the aspect ratio - the voxelization can't sample more texels than there are voxels anyway
+				const float factor = (float)maxSize / (float)glm::max(tex->width(), tex->height());
+				tex->resize(glm::max(1, (int)((float)tex->width() * factor)),
+							glm::max(1, (int)((float)tex->height() * factor)));
+			}
+			images[i] = tex;
+		}
+	});
+
+	for (size_t i = 0; i < sources.size(); ++i) {
+		const int idx = sourceImage[i];
+		if (idx < 0) {
+			continue;
+		}
+		const TextureSource &source = sources[i];
+		const image::ImagePtr &tex = images[idx];
+		if (!tex) {
+			Log::warn("Failed to load texture %s", source.data == nullptr ? source.file.c_str() : source.name.c_str());
+			continue;
+		}
+		Log::debug("Use image %s for %s", tex->name().c_str(), source.name.c_str());
+		textures.put(source.name, tex);
+	}
+}
+
+MeshFormat::MeshQueue::MeshQueue(const scenegraph::SceneGraph &sceneGraph, bool applyTransform, bool marchingCubes,
+								 bool mergeQuads, bool reuseVertices, bool ambientOcclusion, int optimizeIndices)
+	: _sceneGraph(sceneGraph), _applyTransform(applyTransform), _marchingCubes(marchingCubes), _mergeQuads(mergeQuads),
+	  _reuseVertices(reuseVertices), _ambientOcclusion(ambientOcclusion), _optimizeIndices(optimizeIndices) {
+	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
+		_nodeIds.push_back(node.id());
+	}
+	core::sort(_nodeIds.begin(), _nodeIds.end(), core::Less<int>());
+	_extracted.resize(_nodeIds.size());
+	for (size_t i = 0; i < _extracted.size(); ++i) {
+		_extracted[i] = nullptr;
+	}
+	const size_t threads = app::App::getInstance()->threadPool().size();
+	_maxPending = core_max((size_t)2, threads * 2);
+}
+
+MeshFormat::MeshQueue::MeshQueue(const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes)
+	: _sceneGraph(sceneGraph), _meshes(&meshes), _maxPending(0) {
+	_nodeIds.reserve(meshes.size());
+	for (const MeshExt &meshExt : meshes) {
+		_nodeIds.push_back(meshExt.nodeId);
+	}
+}
+
+MeshFormat::MeshQueue::~MeshQueue() {
+	releaseCurrent();
+	if (_meshes != nullptr) {
+		return;
+	}
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	while (_finished < (int)_scheduled) {
+		if (!threadPool.runPendingTask()) {
+			SDL_Delay(1);
+		}
+	}
+	for (size_t i = _next; i < _scheduled; ++i) {
+		delete _extracted[i];
+	}
+}
+
+void MeshFormat::MeshQueue::setSimplify(float ratio, float maxError) {
+	core_assert(_next == 0u && _scheduled == 0u);
+	_simplifyRatio = glm::clamp(ratio, 0.0f, 1.0f);
+	_simplifyError = maxError;
+}
+
+void MeshFormat::MeshQueue::setNodeOrder(const core::DynamicArray<int> &nodeIds) {
+	core_assert(_next == 0u && _scheduled == 0u);
+	core::DynamicArray<int> ordered;
+	ordered.reserve(nodeIds.size());
+	for (int nodeId : nodeIds) {
+		if (core::find(_nodeIds.begin(), _nodeIds.end(), nodeId) != _nodeIds.end()) {
+			ordered.push_back(nodeId);
+		}
+	}
+	_nodeIds = core::move(ordered);
+	if (_meshes == nullptr) {
+		_extracted.resize(_nodeIds.size());
+		for (size_t i = 0; i < _extracted.size(); ++i) {
+			_extracted[i] = nullptr;
+		}
+	}
+}
+
+void MeshFormat::MeshQueue::schedule() {
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	while (_scheduled < _nodeIds.size() && _scheduled < _next + _maxPending) {
+		const size_t idx = _scheduled++;
+		const scenegraph::SceneGraphNode &node = _sceneGraph.node(_nodeIds[idx]);
+		auto task = [this, idx, &node]() {
 			voxel::ChunkMesh *mesh = new voxel::ChunkMesh();
-			if (marchingCubes) {
+			if (_marchingCubes) {
 				voxel::Region region = node.region();
 				region.shrink(-1);
 				voxel::extractMarchingCubesMesh(node.volume(), node.palette(), region, mesh);
 			} else {
 				voxel::Region region = node.region();
 				region.shiftUpperCorner(1, 1, 1);
-				voxel::extractCubicMesh(node.volume(), region, mesh, glm::ivec3(0), mergeQuads, reuseVertices, ambientOcclusion);
+				voxel::extractCubicMesh(node.volume(), region, mesh, glm::ivec3(0), _mergeQuads, _reuseVertices,
+										_ambientOcclusion);
 			}
-			core::ScopedLock scoped(lock);
-			meshes.emplace_back(mesh, node, applyTransform);
+			if (_simplifyRatio < 1.0f) {
+				mesh->simplify(_simplifyRatio, _simplifyError);
+			}
+			if (_optimizeIndices > 0) {
+				mesh->optimize(_optimizeIndices);
+			}
+			{
+				core::ScopedLock scoped(_lock);
+				_extracted[idx] = mesh;
+			}
+			++_finished;
 		};
-		threadPool.enqueue(lambda);
+		if (!threadPool.schedule(task)) {
+			task();
+		}
 	}
+}
+
+voxel::ChunkMesh *MeshFormat::MeshQueue::wait(size_t idx) {
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
 	for (;;) {
-		lock.lock();
-		const size_t size = meshes.size();
-		lock.unlock();
-		if (size < models) {
-			SDL_Delay(10);
-		} else {
-			break;
+		{
+			core::ScopedLock scoped(_lock);
+			if (_extracted[idx] != nullptr) {
+				return _extracted[idx];
+			}
+		}
+		// help out instead of blocking a worker if we are running inside of the thread pool
+		if (!threadPool.runPendingTask()) {
+			SDL_Delay(1);
 		}
 	}
-	Meshes nonEmptyMeshes;
-	nonEmptyMeshes.reserve(meshes.size());
+}
 
-	// filter out empty meshes
-	for (auto iter = meshes.begin(); iter != meshes.end(); ++iter) {
-		if (iter->mesh->isEmpty()) {
+void MeshFormat::MeshQueue::releaseCurrent() {
+	if (_ownsCurrent) {
+		delete _current.mesh;
+	}
+	_current.mesh = nullptr;
+	_ownsCurrent = false;
+}
+
+bool MeshFormat::MeshQueue::detach() {
+	const bool owned = _ownsCurrent;
+	_ownsCurrent = false;
+	return owned;
+}
+
+const MeshFormat::MeshExt *MeshFormat::MeshQueue::next() {
+	releaseCurrent();
+	if (_meshes != nullptr) {
+		while (_next < _nodeIds.size()) {
+			const int nodeId = _nodeIds[_next++];
+			for (const MeshExt &meshExt : *_meshes) {
+				if (meshExt.nodeId == nodeId && !meshExt.mesh->isEmpty()) {
+					++_meshCount;
+					return &meshExt;
+				}
+			}
+		}
+		return nullptr;
+	}
+	while (_next < _nodeIds.size()) {
+		schedule();
+		const size_t idx = _next++;
+		voxel::ChunkMesh *mesh = wait(idx);
+		if (mesh->isEmpty()) {
+			delete mesh;
 			continue;
 		}
-		nonEmptyMeshes.emplace_back(*iter);
-		meshIdxNodeMap.put(iter->nodeId, (int)nonEmptyMeshes.size() - 1);
+		_current = MeshExt(mesh, _sceneGraph.node(_nodeIds[idx]), _applyTransform);
+		_ownsCurrent = true;
+		++_meshCount;
+		return &_current;
 	}
-	bool state;
-	if (nonEmptyMeshes.empty()) {
-		Log::warn("Empty scene can't get saved as mesh");
-		state = false;
-	} else {
+	return nullptr;
+}
+
+bool MeshFormat::saveMeshQueue(const scenegraph::SceneGraph &sceneGraph, MeshQueue &queue,
+							   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
+							   bool quad, bool withColor, bool withTexCoords) {
+	Meshes meshes;
+	core::DynamicArray<bool> owned;
+	core::Map<int, int> meshIdxNodeMap;
+	while (const MeshExt *meshExt = queue.next()) {
+		meshes.push_back(*meshExt);
+		owned.push_back(queue.detach());
+		meshIdxNodeMap.put(meshExt->nodeId, (int)meshes.size() - 1);
+	}
+	bool state = false;
+	if (!meshes.empty()) {
 		Log::debug("Save meshes");
-		state = saveMeshes(meshIdxNodeMap, sceneGraph, nonEmptyMeshes, filename, stream, scale, marchingCubes ? false : quads, withColor, withTexCoords);
+		state = saveMeshes(meshIdxNodeMap, sceneGraph, meshes, filename, stream, scale, quad, withColor, withTexCoords);
 	}
-	for (MeshExt& meshext : meshes) {
-		delete meshext.mesh;
+	for (size_t i = 0; i < meshes.size(); ++i) {
+		if (owned[i]) {
+			delete meshes[i].mesh;
+		}
+	}
+	return state;
+}
+
+bool MeshFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) {
+	const bool mergeQuads = core::Var::getSafe(cfg::VoxformatMergequads)->boolVal();
+	const bool reuseVertices = core::Var::getSafe(cfg::VoxformatReusevertices)->boolVal();
+	const bool ambientOcclusion = core::Var::getSafe(cfg::VoxformatAmbientocclusion)->boolVal();
+	const bool quads = core::Var::getSafe(cfg::VoxformatQuads)->boolVal();
+	const bool withColor = core::Var::getSafe(cfg::VoxformatWithcolor)->boolVal();
+	const bool withTexCoords = core::Var::getSafe(cfg::VoxformatWithtexcoords)->boolVal();
+	const bool applyTransform = core::Var::getSafe(cfg::VoxformatTransform)->boolVal();
+	const bool marchingCubes = core::Var::getSafe(cfg::VoxformatMarchingCubes)->boolVal();
+	const bool optimize = core::Var::getSafe(cfg::VoxformatOptimize)->boolVal();
+	const float simplifyRatio = core::Var::getSafe(cfg::VoxformatSimplify)->floatVal();
+	const float simplifyError = core::Var::getSafe(cfg::VoxformatSimplifyError)->floatVal();
+	// the simplified meshes are no quads anymore
+	const bool exportQuads = (marchingCubes || simplifyRatio < 1.0f) ? false : quads;
+	// the quads are exported from the two triangles of each 6 indices - they must stay together
+	const int optimizeIndices = optimize ? (exportQuads ? 6 : 3) : 0;
+
+	const glm::vec3 &scale = getScale();
+	MeshQueue queue(sceneGraph, applyTransform, marchingCubes, mergeQuads, reuseVertices, ambientOcclusion,
+					optimizeIndices);
+	queue.setSimplify(simplifyRatio, simplifyError);
+	const bool state = saveMeshQueue(sceneGraph, queue, filename, stream, scale, exportQuads, withColor, withTexCoords);
+	if (queue.meshCount() == 0) {
+		Log::warn("Empty scene can't get saved as mesh");
+		return false;
 	}
 	return state;
 }
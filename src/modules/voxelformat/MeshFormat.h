@@ -6,8 +6,14 @@
 
 #include "Format.h"
 #include "private/Tri.h"
+#include "core/RGBA.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/HashMap.h"
 #include "core/collection/Map.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/Trace.h"
 #include "voxel/ChunkMesh.h"
 
 namespace voxelformat {
@@ -33,8 +39,9 @@ public:
 protected:
 	uint8_t _flattenFactor;
 	struct MeshExt {
+		MeshExt() = default;
 		MeshExt(voxel::ChunkMesh *mesh, const scenegraph::SceneGraphNode &node, bool applyTransform);
-		voxel::ChunkMesh *mesh;
+		voxel::ChunkMesh *mesh = nullptr;
 		core::String name;
 		bool applyTransform = false;
 
@@ -48,8 +55,111 @@ protected:
 							const glm::vec3 &scale = glm::vec3(1.0f), bool quad = false, bool withColor = true,
 							bool withTexCoords = true) = 0;
 
+	/**
+	 * @brief Extracts the meshes of the model nodes on the thread pool and hands them out in node order
+	 *
+	 * Only a few meshes are extracted ahead of the consumer and a mesh is freed as soon as the next one is requested.
+	 * This keeps the memory usage for scenes with a lot of nodes low. Empty meshes are skipped.
+	 */
+	class MeshQueue {
+	private:
+		const scenegraph::SceneGraph &_sceneGraph;
+		/**
+		 * @brief If not @c null the queue hands out the already extracted meshes of this array
+		 */
+		const Meshes *_meshes = nullptr;
+		core::DynamicArray<int> _nodeIds;
+		/**
+		 * @brief The extracted meshes in the order of @c _nodeIds - protected by @c _lock
+		 */
+		core::DynamicArray<voxel::ChunkMesh *> _extracted;
+		core_trace_mutex(core::Lock, _lock, "MeshQueue");
+		core::AtomicInt _finished{0};
+		size_t _scheduled = 0;
+		size_t _next = 0;
+		size_t _maxPending;
+		MeshExt _current;
+		bool _ownsCurrent = false;
+		int _meshCount = 0;
+
+		bool _applyTransform = false;
+		bool _marchingCubes = false;
+		bool _mergeQuads = true;
+		bool _reuseVertices = true;
+		bool _ambientOcclusion = false;
+		int _optimizeIndices = 0;
+		float _simplifyRatio = 1.0f;
+		float _simplifyError = -1.0f;
+
+		void schedule();
+		voxel::ChunkMesh *wait(size_t idx);
+		void releaseCurrent();
+
+	public:
+		/**
+		 * @param optimizeIndices The amount of indices that are kept together if the meshes should get optimized for
+		 * the vertex cache (see voxel::Mesh::optimize()) or @c 0 to keep the extraction order
+		 */
+		MeshQueue(const scenegraph::SceneGraph &sceneGraph, bool applyTransform, bool marchingCubes, bool mergeQuads,
+				  bool reuseVertices, bool ambientOcclusion, int optimizeIndices = 0);
+		/**
+		 * @brief Hands out the given meshes without extracting anything
+		 */
+		MeshQueue(const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes);
+		~MeshQueue();
+
+		/**
+		 * @brief Simplify the extracted meshes on the worker threads - see voxel::Mesh::simplify()
+		 * @param ratio The amount of triangles that are kept - @c 1.0 disables the simplification
+		 * @param maxError The max distance in voxels the surface may get moved - negative values don't limit it
+		 * @note Must be called before the first call to next()
+		 */
+		void setSimplify(float ratio, float maxError);
+		/**
+		 * @brief Change the order in which the meshes are handed out
+		 * @note Must be called before the first call to next(). Model nodes that are not in the list are skipped.
+		 */
+		void setNodeOrder(const core::DynamicArray<int> &nodeIds);
+		/**
+		 * @return The next non-empty mesh or @c nullptr if there are no more meshes. The mesh of the previously
+		 * returned entry is freed.
+		 */
+		const MeshExt *next();
+		/**
+		 * @brief The caller takes the ownership of the mesh that was returned by the last call to next()
+		 * @return @c false if the mesh is not owned by the queue and must not get freed by the caller
+		 */
+		bool detach();
+		/**
+		 * @return The amount of non-empty meshes that were handed out so far
+		 */
+		inline int meshCount() const {
+			return _meshCount;
+		}
+	};
+
+	/**
+	 * @brief Writes the meshes while they are extracted. The default implementation collects all meshes and calls
+	 * saveMeshes()
+	 */
+	virtual bool saveMeshQueue(const scenegraph::SceneGraph &sceneGraph, MeshQueue &queue,
+							   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
+							   bool quad, bool withColor, bool withTexCoords);
+
 	static MeshExt* getParent(const scenegraph::SceneGraph &sceneGraph, Meshes &meshes, int nodeId);
 	static glm::vec3 getScale();
+	/**
+	 * @brief Bakes the ambient occlusion of the given mesh of the model if cfg::VoxformatBakeAmbientOcclusion is
+	 * enabled
+	 * @param[out] occlusion One value per vertex - see voxelutil::bakeAmbientOcclusion()
+	 * @return @c false if nothing was baked
+	 */
+	static bool bakeAmbientOcclusion(const scenegraph::SceneGraph &sceneGraph, const MeshExt &meshExt,
+									 const voxel::Mesh &mesh, core::DynamicArray<float> &occlusion);
+	/**
+	 * @brief Darkens the color by the baked ambient occlusion - the alpha value is kept
+	 */
+	static core::RGBA occludedColor(const core::RGBA &color, float occlusion);
 
 	/**
 	 * @brief Voxelizes the input mesh
@@ -74,19 +184,62 @@ protected:
 	};
 
 	struct PosSampling {
+		/**
+		 * @brief The max amount of colors that are sampled for one voxel
+		 */
+		static constexpr int MaxEntries = 8;
 		core::DynamicArray<PosSamplingEntry> entries;
 		inline PosSampling(float area, core::RGBA color) {
 			entries.emplace_back(area, color);
 		}
+		/**
+		 * @brief Adds the area to an existing entry of the same color or replaces the entry with the smallest area
+		 * if there are already @c MaxEntries entries
+		 */
+		void add(float area, core::RGBA color);
 		core::RGBA avgColor(uint8_t flattenFactor) const;
 	};
 
-	typedef core::Map<glm::ivec3, PosSampling, 64, glm::hash<glm::ivec3>> PosMap;
+	typedef core::HashMap<glm::ivec3, PosSampling, glm::hash<glm::ivec3>> PosMap;
 
 	void voxelizeTris(scenegraph::SceneGraphNode &node, const PosMap &posMap, bool hillHollow) const;
 	void transformTris(const TriCollection &subdivided, PosMap &posMap) const;
+	/**
+	 * @brief The edge length of the spatial tiles of @c rasterizeTris()
+	 */
+	static constexpr int RasterizeTileSize = 64;
+	/**
+	 * @brief Puts every voxel that is touched by a triangle into the map. The triangles are bucketed into spatial
+	 * tiles that are rasterized in parallel - a triangle that touches several tiles is clipped to each of them.
+	 *
+	 * The color of a voxel is the area weighted average of the colors of the triangles at the points that are closest
+	 * to the voxel center.
+	 */
+	void rasterizeTris(const TriCollection &tris, PosMap &posMap) const;
+	/**
+	 * @brief Only the voxels inside the given (inclusive) bounds are put into the map
+	 */
+	static void rasterizeTri(const Tri &tri, PosMap &posMap, const glm::ivec3 &clipMins, const glm::ivec3 &clipMaxs);
 	void transformTrisAxisAligned(const TriCollection &tris, PosMap &posMap) const;
 
+	/**
+	 * @brief A texture of a mesh file that is decoded by @c loadTextures()
+	 */
+	struct TextureSource {
+		/** the key of the texture in the texture map */
+		core::String name;
+		/** the image file - only used if there is no encoded image data */
+		core::String file;
+		const uint8_t *data = nullptr;
+		int length = 0;
+	};
+	/**
+	 * @brief Decodes the textures on the thread pool - a file that is referenced by several textures is only decoded
+	 * once. The textures are scaled down to @c cfg::VoxformatTextureMaxSize. Textures that already are in the map are
+	 * skipped and textures that fail to load are not added.
+	 */
+	static void loadTextures(const core::DynamicArray<TextureSource> &sources, core::StringMap<image::ImagePtr> &textures);
+
 public:
 	static core::String lookupTexture(const core::String &meshFilename, const core::String &in);
 
@@ -17,13 +17,14 @@
 #include "io/File.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
-#include "io/StdStreamBuf.h"
+#include "io/TextCodec.h"
 #include "voxel/ChunkMesh.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Mesh.h"
 #include "voxel/VoxelVertex.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
+#include "voxelformat/private/OBJParser.h"
 
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "external/tiny_obj_loader.h"
@@ -57,11 +58,63 @@ bool OBJFormat::writeMtlFile(io::SeekableWriteStream &stream, const core::String
 bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
 						   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
 						   bool quad, bool withColor, bool withTexCoords) {
-	stream.writeStringFormat(false, "# version " PROJECT_VERSION " github.com/mgerhardy/vengi\n");
-	wrapBool(stream.writeStringFormat(false, "\n"))
-	wrapBool(stream.writeStringFormat(false, "g Model\n"))
+	MeshQueue queue(sceneGraph, meshes);
+	return saveMeshQueue(sceneGraph, queue, filename, stream, scale, quad, withColor, withTexCoords);
+}
+
+static void writeVec3(io::TextWriter &writer, const glm::vec3 &v, int decimals) {
+	writer.writeFloat(v.x, decimals);
+	writer.writeChar(' ');
+	writer.writeFloat(v.y, decimals);
+	writer.writeChar(' ');
+	writer.writeFloat(v.z, decimals);
+}
+
+/**
+ * @brief All vertices of a face share the same texture coordinate
+ */
+static void writeTexCoords(io::TextWriter &writer, const glm::vec2 &uv, int vertices) {
+	for (int i = 0; i < vertices; ++i) {
+		writer.writeString("vt ", 3);
+		writer.writeFloat(uv.x);
+		writer.writeChar(' ');
+		writer.writeFloat(uv.y);
+		writer.writeChar('\n');
+	}
+}
+
+/**
+ * @param[in] texcoordIndex The one based index of the texture coordinate of the first vertex or @c -1
+ * @note the normals have the same indices as the vertices
+ */
+static void writeFace(io::TextWriter &writer, const uint32_t *indices, int vertices, int texcoordIndex,
+					  bool withNormals) {
+	writer.writeChar('f');
+	for (int i = 0; i < vertices; ++i) {
+		writer.writeChar(' ');
+		writer.writeInt(indices[i]);
+		if (texcoordIndex != -1) {
+			writer.writeChar('/');
+			writer.writeInt(texcoordIndex + i);
+			if (withNormals) {
+				writer.writeChar('/');
+				writer.writeInt(indices[i]);
+			}
+		} else if (withNormals) {
+			writer.writeString("//", 2);
+			writer.writeInt(indices[i]);
+		}
+	}
+	writer.writeChar('\n');
+}
 
-	Log::debug("Exporting %i layers", (int)meshes.size());
+bool OBJFormat::saveMeshQueue(const scenegraph::SceneGraph &sceneGraph, MeshQueue &queue, const core::String &filename,
+							  io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad, bool withColor,
+							  bool withTexCoords) {
+	io::TextWriter writer(stream);
+	writer.writeString("# version " PROJECT_VERSION " github.com/mgerhardy/vengi\n");
+	writer.writeString("\n");
+	writer.writeString("g Model\n");
 
 	const core::String &mtlname = core::string::replaceExtension(filename, "mtl");
 	Log::debug("Use mtl file: %s", mtlname.c_str());
@@ -79,7 +132,8 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 
 	int idxOffset = 0;
 	int texcoordOffset = 0;
-	for (const auto &meshExt : meshes) {
+	while (const MeshExt *nextMeshExt = queue.next()) {
+		const MeshExt &meshExt = *nextMeshExt;
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
 			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
 			if (mesh->isEmpty()) {
@@ -107,13 +161,20 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 			if (objectName[0] == '\0') {
 				objectName = "Noname";
 			}
-			stream.writeStringFormat(false, "o %s\n", objectName);
-			stream.writeStringFormat(false, "mtllib %s\n", core::string::extractFilenameWithExtension(mtlname).c_str());
-			if (!stream.writeStringFormat(false, "usemtl %s\n", hashId.c_str())) {
+			writer.writeString("o ");
+			writer.writeString(objectName);
+			writer.writeString("\nmtllib ");
+			writer.writeString(core::string::extractFilenameWithExtension(mtlname));
+			writer.writeString("\nusemtl ");
+			writer.writeString(hashId);
+			writer.writeChar('\n');
+			if (!writer.flush()) {
 				Log::error("Failed to write obj usemtl %s\n", hashId.c_str());
 				return false;
 			}
 
+			core::DynamicArray<float> occlusion;
+			const bool occluded = withColor && bakeAmbientOcclusion(sceneGraph, meshExt, *mesh, occlusion);
 			for (int i = 0; i < nv; ++i) {
 				const voxel::VoxelVertex &v = vertices[i];
 
@@ -124,17 +185,25 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					pos = v.position;
 				}
 				pos *= scale;
-				stream.writeStringFormat(false, "v %.04f %.04f %.04f", pos.x, pos.y, pos.z);
+				writer.writeString("v ", 2);
+				writeVec3(writer, pos, 4);
 				if (withColor) {
-					const glm::vec4& color = core::Color::fromRGBA(palette.color(v.colorIndex));
-					stream.writeStringFormat(false, " %.03f %.03f %.03f", color.r, color.g, color.b);
+					core::RGBA rgba = palette.color(v.colorIndex);
+					if (occluded) {
+						rgba = occludedColor(rgba, occlusion[i]);
+					}
+					const glm::vec4 &color = core::Color::fromRGBA(rgba);
+					writer.writeChar(' ');
+					writeVec3(writer, color, 3);
 				}
-				wrapBool(stream.writeStringFormat(false, "\n"))
+				writer.writeChar('\n');
 			}
 			if (withNormals) {
 				for (int i = 0; i < nv; ++i) {
 					const glm::vec3 &norm = normals[i];
-					stream.writeStringFormat(false, "vn %.04f %.04f %.04f\n", norm.x, norm.y, norm.z);
+					writer.writeString("vn ", 3);
+					writeVec3(writer, norm, 4);
+					writer.writeChar('\n');
 				}
 			}
 
@@ -143,10 +212,7 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					for (int i = 0; i < ni; i += 6) {
 						const voxel::VoxelVertex &v = vertices[indices[i]];
 						const glm::vec2 &uv = paletteUV(v.colorIndex);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+						writeTexCoords(writer, uv, 4);
 					}
 				}
 
@@ -156,21 +222,8 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					const uint32_t two = idxOffset + indices[i + 1] + 1;
 					const uint32_t three = idxOffset + indices[i + 2] + 1;
 					const uint32_t four = idxOffset + indices[i + 5] + 1;
-					if (withTexCoords) {
-						if (withNormals) {
-							stream.writeStringFormat(false, "f %i/%i/%i %i/%i/%i %i/%i/%i %i/%i/%i\n", (int)one, uvi + 1,(int)one,  (int)two, uvi + 2,
-													(int)two, (int)three, uvi + 3, (int)three, (int)four, uvi + 4, (int)four);
-						} else {
-							stream.writeStringFormat(false, "f %i/%i %i/%i %i/%i %i/%i\n", (int)one, uvi + 1, (int)two, uvi + 2,
-													(int)three, uvi + 3, (int)four, uvi + 4);
-						}
-					} else {
-						if (withNormals) {
-							stream.writeStringFormat(false, "f %i//%i %i//%i %i//%i %i//%i\n", (int)one, (int)two, (int)three, (int)four, (int)one, (int)two, (int)three, (int)four);
-						} else {
-							stream.writeStringFormat(false, "f %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
-						}
-					}
+					const uint32_t face[] = {one, two, three, four};
+					writeFace(writer, face, 4, withTexCoords ? uvi + 1 : -1, withNormals);
 				}
 				texcoordOffset += ni / 6 * 4;
 			} else {
@@ -178,9 +231,7 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					for (int i = 0; i < ni; i += 3) {
 						const voxel::VoxelVertex &v = vertices[indices[i]];
 						const glm::vec2 &uv = paletteUV(v.colorIndex);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
-						stream.writeStringFormat(false, "vt %f %f\n", uv.x, uv.y);
+						writeTexCoords(writer, uv, 3);
 					}
 				}
 
@@ -188,21 +239,8 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					const uint32_t one = idxOffset + indices[i + 0] + 1;
 					const uint32_t two = idxOffset + indices[i + 1] + 1;
 					const uint32_t three = idxOffset + indices[i + 2] + 1;
-					if (withTexCoords) {
-						if (withNormals) {
-							stream.writeStringFormat(false, "f %i/%i/%i %i/%i/%i %i/%i/%i\n", (int)one, texcoordOffset + i + 1, (int)one, (int)two,
-													texcoordOffset + i + 2, (int)two, (int)three, texcoordOffset + i + 3, (int)three);
-						} else {
-							stream.writeStringFormat(false, "f %i/%i %i/%i %i/%i\n", (int)one, texcoordOffset + i + 1, (int)two,
-													texcoordOffset + i + 2, (int)three, texcoordOffset + i + 3);
-						}
-					} else {
-						if (withNormals) {
-							stream.writeStringFormat(false, "f %i//%i %i//%i %i//%i\n", (int)one, (int)two, (int)three, (int)one, (int)two, (int)three);
-						} else {
-							stream.writeStringFormat(false, "f %i %i %i\n", (int)one, (int)two, (int)three);
-						}
-					}
+					const uint32_t face[] = {one, two, three};
+					writeFace(writer, face, 3, withTexCoords ? texcoordOffset + i + 1 : -1, withNormals);
 				}
 				texcoordOffset += ni;
 			}
@@ -223,46 +261,77 @@ bool OBJFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 			}
 		}
 	}
+	if (!writer.flush()) {
+		Log::error("Failed to write obj %s", filename.c_str());
+		return false;
+	}
 	return true;
 }
 
 #undef wrapBool
 
-bool OBJFormat::voxelizeGroups(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
-	tinyobj::attrib_t attrib;
-	std::vector<tinyobj::shape_t> shapes;
-	std::vector<tinyobj::material_t> materials;
-	std::string warn;
-	std::string err;
-	const core::String& mtlbasedir = core::string::extractPath(filename);
-	io::StdIStreamBuf stdStreamBuf(stream);
-	std::istream inputStream(&stdStreamBuf);
-	tinyobj::MaterialFileReader matFileReader(mtlbasedir.c_str());
-	Log::debug("Load obj %s", filename.c_str());
-	const bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &inputStream, &matFileReader, true, false);
-	if (!warn.empty()) {
-		core::DynamicArray<core::String> lines;
-		core::string::splitString(warn.c_str(), lines, "\n");
-		for (const core::String& str : lines) {
-			Log::warn("%s", str.c_str());
-		}
+static void logMessages(const std::string &messages, bool error) {
+	if (messages.empty()) {
+		return;
 	}
-	if (!err.empty()) {
-		core::DynamicArray<core::String> lines;
-		core::string::splitString(err.c_str(), lines, "\n");
-		for (const core::String& str : lines) {
+	core::DynamicArray<core::String> lines;
+	core::string::splitString(messages.c_str(), lines, "\n");
+	for (const core::String &str : lines) {
+		if (error) {
 			Log::error("%s", str.c_str());
+		} else {
+			Log::warn("%s", str.c_str());
 		}
 	}
-	if (!ret) {
-		Log::error("Failed to load obj '%s': %s", filename.c_str(), err.c_str());
+}
+
+/**
+ * @brief The material properties that are needed for the triangles - resolved once for all faces
+ */
+struct OBJTriMaterial {
+	const image::Image *texture = nullptr;
+	core::RGBA color{0, 0, 0};
+};
+
+bool OBJFormat::voxelizeGroups(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) {
+	Log::debug("Load obj %s", filename.c_str());
+	// mapped files are parsed without copying them into a temporary buffer
+	io::StreamData streamData(stream);
+	if (!streamData.valid()) {
+		Log::error("Failed to read obj '%s'", filename.c_str());
+		return false;
+	}
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	priv::ObjData obj;
+	if (!priv::parseObj(streamData.data(), (size_t)streamData.size(), obj, &threadPool)) {
+		Log::error("Failed to load obj '%s'", filename.c_str());
 		return false;
 	}
-	if (shapes.size() == 0) {
+	if (obj.shapes.empty()) {
 		Log::error("No shapes found in the model");
 		return false;
 	}
 
+	std::vector<tinyobj::material_t> materials;
+	std::map<std::string, int> materialMap;
+	const core::String &mtlbasedir = core::string::extractPath(filename);
+	tinyobj::MaterialFileReader matFileReader(mtlbasedir.c_str());
+	for (const core::String &library : obj.materialLibraries) {
+		// the first file of the statement that can be loaded is used
+		core::DynamicArray<core::String> files;
+		core::string::splitString(library, files);
+		for (const core::String &file : files) {
+			std::string warn;
+			std::string err;
+			const bool ret = matFileReader(file.c_str(), &materials, &materialMap, &warn, &err);
+			logMessages(warn, false);
+			if (ret) {
+				break;
+			}
+			logMessages(err, true);
+		}
+	}
+
 	core::StringMap<image::ImagePtr> textures;
 	Log::debug("%i materials", (int)materials.size());
 
@@ -298,59 +367,57 @@ bool OBJFormat::voxelizeGroups(const core::String &filename, io::SeekableReadStr
 		}
 	}
 
-	const glm::vec3 &scale = getScale();
-	for (tinyobj::shape_t &shape : shapes) {
-		int indexOffset = 0;
-		// TODO: shape.lines, shape.points
-		const tinyobj::mesh_t &mesh = shape.mesh;
-		for (const tinyobj::tag_t &tag : mesh.tags) {
-			Log::debug("tag: %s", tag.name.c_str());
+	core::DynamicArray<OBJTriMaterial> triMaterials;
+	triMaterials.resize(obj.materials.size());
+	for (size_t i = 0; i < obj.materials.size(); ++i) {
+		auto materialIter = materialMap.find(obj.materials[i].c_str());
+		if (materialIter == materialMap.end()) {
+			Log::warn("Material %s not found", obj.materials[i].c_str());
+			continue;
+		}
+		const tinyobj::material_t &material = materials[materialIter->second];
+		const glm::vec4 diffuseColor(material.diffuse[0], material.diffuse[1], material.diffuse[2], 1.0f);
+		triMaterials[i].color = core::Color::getRGBA(diffuseColor);
+		const core::String diffuseTexture = material.diffuse_texname.c_str();
+		if (diffuseTexture.empty()) {
+			continue;
+		}
+		auto textureIter = textures.find(diffuseTexture);
+		if (textureIter != textures.end()) {
+			triMaterials[i].texture = textureIter->second.get();
+		} else {
+			Log::warn("Failed to look up texture %s", diffuseTexture.c_str());
 		}
+	}
+
+	const glm::vec3 &scale = getScale();
+	const bool vertexColors = !obj.colors.empty();
+	for (const priv::ObjShape &shape : obj.shapes) {
 		TriCollection tris;
-		tris.reserve(mesh.num_face_vertices.size());
-		for (size_t faceNum = 0; faceNum < mesh.num_face_vertices.size(); ++faceNum) {
-			const int faceVertices = mesh.num_face_vertices[faceNum];
-			core_assert_msg(faceVertices == 3, "Unexpected indices for triangulated mesh: %i", faceVertices);
-			Tri tri;
-			for (int i = 0; i < faceVertices; ++i) {
-				const tinyobj::index_t &idx = mesh.indices[indexOffset + i];
-				tri.vertices[i].x = attrib.vertices[3 * idx.vertex_index + 0] * scale.x;
-				tri.vertices[i].y = attrib.vertices[3 * idx.vertex_index + 1] * scale.y;
-				tri.vertices[i].z = attrib.vertices[3 * idx.vertex_index + 2] * scale.z;
-				if (!attrib.colors.empty()) {
-					const float r = attrib.colors[3 * idx.vertex_index + 0];
-					const float g = attrib.colors[3 * idx.vertex_index + 1];
-					const float b = attrib.colors[3 * idx.vertex_index + 2];
-					tri.color[i] = core::Color::getRGBA(glm::vec4(r, g, b, 1.0f));
-				}
-				if (idx.texcoord_index >= 0) {
-					tri.uv[i].x = attrib.texcoords[2 * idx.texcoord_index + 0];
-					tri.uv[i].y = attrib.texcoords[2 * idx.texcoord_index + 1];
-				}
-			}
-			const int materialIndex = mesh.material_ids[faceNum];
-			const tinyobj::material_t *material = materialIndex < 0 ? nullptr : &materials[materialIndex];
-			if (material != nullptr) {
-				const core::String diffuseTexture = material->diffuse_texname.c_str();
-				if (!diffuseTexture.empty()) {
-					auto textureIter = textures.find(diffuseTexture);
-					if (textureIter != textures.end()) {
-						tri.texture = textureIter->second.get();
-					} else {
-						Log::warn("Failed to look up texture %s", diffuseTexture.c_str());
-						textures.put(diffuseTexture, image::ImagePtr());
+		tris.resize(shape.faces.size());
+		threadPool.parallelFor(0, (int)shape.faces.size(), 4096, [&](int start, int end) {
+			for (int faceNum = start; faceNum < end; ++faceNum) {
+				const priv::ObjFace &face = shape.faces[faceNum];
+				Tri &tri = tris[faceNum];
+				for (int i = 0; i < 3; ++i) {
+					tri.vertices[i] = obj.positions[face.vertices[i]] * scale;
+					if (vertexColors) {
+						tri.color[i] = core::Color::getRGBA(glm::vec4(obj.colors[face.vertices[i]], 1.0f));
+					}
+					if (face.texcoords[i] >= 0) {
+						tri.uv[i] = obj.texcoords[face.texcoords[i]];
 					}
 				}
-				if (attrib.colors.empty()) {
-					const glm::vec4 diffuseColor(material->diffuse[0], material->diffuse[1], material->diffuse[2], 1.0f);
-					tri.color[0] = tri.color[1] = tri.color[2] = core::Color::getRGBA(diffuseColor);
+				if (face.material >= 0) {
+					const OBJTriMaterial &material = triMaterials[face.material];
+					tri.texture = material.texture;
+					if (!vertexColors) {
+						tri.color[0] = tri.color[1] = tri.color[2] = material.color;
+					}
 				}
 			}
-			tris.push_back(tri);
-
-			indexOffset += faceVertices;
-		}
-		if (voxelizeNode(shape.name.c_str(), sceneGraph, tris) < 0) {
+		});
+		if (voxelizeNode(shape.name, sceneGraph, tris) < 0) {
 			Log::error("Failed to voxelize shape %s", shape.name.c_str());
 			return false;
 		}
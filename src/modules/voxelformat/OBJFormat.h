@@ -27,5 +27,8 @@ private:
 	bool voxelizeGroups(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const LoadContext &ctx) override;
 public:
 	bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes& meshes, const core::String &filename, io::SeekableWriteStream& stream, const glm::vec3 &scale, bool quad, bool withColor, bool withTexCoords) override;
+	bool saveMeshQueue(const scenegraph::SceneGraph &sceneGraph, MeshQueue &queue, const core::String &filename,
+					   io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad, bool withColor,
+					   bool withTexCoords) override;
 };
 }
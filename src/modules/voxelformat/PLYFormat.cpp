@@ -10,6 +10,7 @@
 #include "engine-config.h"
 #include "io/File.h"
 #include "io/FileStream.h"
+#include "io/TextCodec.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Mesh.h"
 #include "voxel/VoxelVertex.h"
@@ -68,6 +69,8 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 	stream.writeStringFormat(false, "property list uchar uint vertex_indices\n");
 	stream.writeStringFormat(false, "end_header\n");
 
+	io::TextWriter writer(stream);
+
 	for (const auto& meshExt : meshes) {
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
 			const voxel::Mesh &mesh = meshExt.mesh->mesh[i];
@@ -90,16 +93,28 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					pos = v.position;
 				}
 				pos *= scale;
-				stream.writeStringFormat(false, "%f %f %f", pos.x, pos.y, pos.z);
+				writer.writeFloat(pos.x);
+				writer.writeChar(' ');
+				writer.writeFloat(pos.y);
+				writer.writeChar(' ');
+				writer.writeFloat(pos.z);
 				if (withTexCoords) {
 					const glm::vec2 &uv = paletteUV(v.colorIndex);
-					stream.writeStringFormat(false, " %f %f", uv.x, uv.y);
+					writer.writeChar(' ');
+					writer.writeFloat(uv.x);
+					writer.writeChar(' ');
+					writer.writeFloat(uv.y);
 				}
 				if (withColor) {
 					const core::RGBA color = palette.color(v.colorIndex);
-					stream.writeStringFormat(false, " %u %u %u", color.r, color.g, color.b);
+					writer.writeChar(' ');
+					writer.writeInt(color.r);
+					writer.writeChar(' ');
+					writer.writeInt(color.g);
+					writer.writeChar(' ');
+					writer.writeInt(color.b);
 				}
-				stream.writeStringFormat(false, "\n");
+				writer.writeChar('\n');
 			}
 		}
 	}
@@ -124,19 +139,33 @@ bool PLYFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 					const uint32_t two   = idxOffset + indices[i + 1];
 					const uint32_t three = idxOffset + indices[i + 2];
 					const uint32_t four  = idxOffset + indices[i + 5];
-					stream.writeStringFormat(false, "4 %i %i %i %i\n", (int)one, (int)two, (int)three, (int)four);
+					writer.writeChar('4');
+					for (uint32_t idx : {one, two, three, four}) {
+						writer.writeChar(' ');
+						writer.writeInt(idx);
+					}
+					writer.writeChar('\n');
 				}
 			} else {
 				for (int i = 0; i < ni; i += 3) {
 					const uint32_t one   = idxOffset + indices[i + 0];
 					const uint32_t two   = idxOffset + indices[i + 1];
 					const uint32_t three = idxOffset + indices[i + 2];
-					stream.writeStringFormat(false, "3 %i %i %i\n", (int)one, (int)two, (int)three);
+					writer.writeChar('3');
+					for (uint32_t idx : {one, two, three}) {
+						writer.writeChar(' ');
+						writer.writeInt(idx);
+					}
+					writer.writeChar('\n');
 				}
 			}
 			idxOffset += nv;
 		}
 	}
+	if (!writer.flush()) {
+		Log::error("Failed to write ply %s", filename.c_str());
+		return false;
+	}
 	return sceneGraph.firstPalette().save(paletteName.c_str());
 }
 }
@@ -3,6 +3,7 @@
  */
 
 #include "QBCLFormat.h"
+#include "app/App.h"
 #include "core/ArrayLength.h"
 #include "core/Enum.h"
 #include "core/FourCC.h"
@@ -12,6 +13,7 @@
 #include "core/Color.h"
 #include "core/Assert.h"
 #include "core/Log.h"
+#include "core/concurrent/ThreadPool.h"
 #include "image/Image.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/BufferedZipReadStream.h"
@@ -216,7 +218,7 @@ bool QBCLFormat::saveMatrix(io::SeekableWriteStream& outStream, const scenegraph
 		}
 	}
 
-	io::ZipWriteStream zipStream(outStream);
+	io::ZipWriteStream zipStream(outStream, 6, &app::App::getInstance()->threadPool());
 	if (zipStream.write(rleDataStream.getBuffer(), rleDataStream.size()) == -1) {
 		Log::error("Could not write compressed data");
 		return false;
@@ -383,6 +385,10 @@ bool QBCLFormat::readMatrix(const core::String &filename, io::SeekableReadStream
 		Log::error("Invalid region");
 		return false;
 	}
+	if (header.ctx != nullptr && !header.ctx->acceptModel(header.modelIndex++, name, region)) {
+		Log::debug("Skip matrix %s", name.c_str());
+		return stream.skip((int64_t)compressedDataSize) != -1;
+	}
 
 	io::ZipReadStream zipStream(stream, (int)compressedDataSize);
 	core::ScopedPtr<voxel::RawVolume> volume(new voxel::RawVolume(region));
@@ -596,6 +602,7 @@ bool QBCLFormat::readHeader(io::SeekableReadStream& stream, Header &header) {
 
 bool QBCLFormat::loadGroupsRGBA(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const voxel::Palette &palette, const LoadContext &ctx) {
 	Header header;
+	header.ctx = &ctx;
 	wrapBool(readHeader(stream, header))
 
 	voxel::Palette palCopy = palette;
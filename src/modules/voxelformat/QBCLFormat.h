@@ -34,6 +34,10 @@ private:
 		core::String company;
 		core::String website;
 		core::String copyright;
+		// only set if the models are loaded - not for the palette
+		const LoadContext *ctx = nullptr;
+		// the index of the next matrix in the file - for LoadContext::acceptModel()
+		int modelIndex = 0;
 		uint64_t timestamp1;
 		uint64_t timestamp2;
 		bool loadPalette = false;
@@ -10,6 +10,7 @@
 #include "core/ScopedPtr.h"
 #include "core/Var.h"
 #include "core/collection/DynamicMap.h"
+#include "io/BufferedReadStream.h"
 #include "io/FileStream.h"
 #include "io/Stream.h"
 #include "voxel/MaterialColor.h"
@@ -196,7 +197,7 @@ bool QBFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::
 	return true;
 }
 
-voxel::Voxel QBFormat::getVoxel(State& state, io::SeekableReadStream& stream, voxel::PaletteLookup &palLookup) {
+voxel::Voxel QBFormat::getVoxel(State& state, io::BufferedReadStream& stream, voxel::PaletteLookup &palLookup) {
 	core::RGBA color(0);
 	if (!readColor(state, stream, color)) {
 		return voxel::Voxel();
@@ -209,7 +210,7 @@ voxel::Voxel QBFormat::getVoxel(State& state, io::SeekableReadStream& stream, vo
 	return v;
 }
 
-bool QBFormat::readColor(State& state, io::SeekableReadStream& stream, core::RGBA &color) {
+bool QBFormat::readColor(State& state, io::BufferedReadStream& stream, core::RGBA &color) {
 	if (state._colorFormat == ColorFormat::RGBA) {
 		wrap(stream.readUInt8(color.r))
 		wrap(stream.readUInt8(color.g))
@@ -231,7 +232,7 @@ bool QBFormat::readColor(State& state, io::SeekableReadStream& stream, core::RGB
 	return true;
 }
 
-bool QBFormat::readMatrix(State& state, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, voxel::PaletteLookup &palLookup) {
+bool QBFormat::readMatrix(State& state, io::BufferedReadStream& stream, scenegraph::SceneGraph& sceneGraph, voxel::PaletteLookup &palLookup) {
 	core::String name;
 	wrapBool(stream.readPascalStringUInt8(name))
 	Log::debug("Matrix name: %s", name.c_str());
@@ -359,7 +360,7 @@ bool QBFormat::readMatrix(State& state, io::SeekableReadStream& stream, scenegra
 	return true;
 }
 
-bool QBFormat::readPalette(State& state, io::SeekableReadStream& stream, voxel::Palette &palette) {
+bool QBFormat::readPalette(State& state, io::BufferedReadStream& stream, voxel::Palette &palette) {
 	uint8_t nameLength;
 	wrap(stream.readUInt8(nameLength));
 	if (stream.skip(nameLength) == -1) {
@@ -443,7 +444,8 @@ bool QBFormat::readPalette(State& state, io::SeekableReadStream& stream, voxel::
 	return true;
 }
 
-size_t QBFormat::loadPalette(const core::String &filename, io::SeekableReadStream& stream, voxel::Palette &palette, const LoadContext &ctx) {
+size_t QBFormat::loadPalette(const core::String &filename, io::SeekableReadStream& in, voxel::Palette &palette, const LoadContext &ctx) {
+	io::BufferedReadStream stream(in);
 	State state;
 	wrap(stream.readUInt32(state._version))
 	uint32_t colorFormat;
@@ -476,7 +478,9 @@ size_t QBFormat::loadPalette(const core::String &filename, io::SeekableReadStrea
 	return palette.colorCount();
 }
 
-bool QBFormat::loadGroupsRGBA(const core::String& filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const voxel::Palette &palette, const LoadContext &ctx) {
+bool QBFormat::loadGroupsRGBA(const core::String& filename, io::SeekableReadStream& in, scenegraph::SceneGraph& sceneGraph, const voxel::Palette &palette, const LoadContext &ctx) {
+	// the matrices are read value by value - don't go through the virtual read for every voxel
+	io::BufferedReadStream stream(in);
 	State state;
 	wrap(stream.readUInt32(state._version))
 	uint32_t colorFormat;
@@ -10,6 +10,10 @@ namespace voxel {
 class PaletteLookup;
 }
 
+namespace io {
+class BufferedReadStream;
+}
+
 namespace voxelformat {
 
 /**
@@ -63,10 +67,10 @@ private:
 		Back
 	};
 
-	bool readColor(State& state, io::SeekableReadStream& stream, core::RGBA &color);
-	voxel::Voxel getVoxel(State& state, io::SeekableReadStream& stream, voxel::PaletteLookup &palLookup);
-	bool readMatrix(State& state, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, voxel::PaletteLookup &palLookup);
-	bool readPalette(State& state, io::SeekableReadStream& stream, voxel::Palette &palette);
+	bool readColor(State& state, io::BufferedReadStream& stream, core::RGBA &color);
+	voxel::Voxel getVoxel(State& state, io::BufferedReadStream& stream, voxel::PaletteLookup &palLookup);
+	bool readMatrix(State& state, io::BufferedReadStream& stream, scenegraph::SceneGraph& sceneGraph, voxel::PaletteLookup &palLookup);
+	bool readPalette(State& state, io::BufferedReadStream& stream, voxel::Palette &palette);
 	bool loadGroupsRGBA(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const voxel::Palette &palette, const LoadContext &ctx) override;
 	bool saveMatrix(io::SeekableWriteStream& stream, const scenegraph::SceneGraphNode& node, bool leftHanded) const;
 	bool saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) override;
@@ -3,6 +3,7 @@
  */
 
 #include "QBTFormat.h"
+#include "app/App.h"
 #include "core/Assert.h"
 #include "core/Color.h"
 #include "core/Common.h"
@@ -13,8 +14,11 @@
 #include "core/ScopedPtr.h"
 #include "core/Var.h"
 #include "core/Zip.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/BufferedZipReadStream.h"
 #include "io/FileStream.h"
+#include "io/MemoryReadStream.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
 #include "voxel/PaletteLookup.h"
@@ -117,14 +121,6 @@ public:
 		return false; \
 	}
 
-#define wrapSaveFree(write) \
-	if ((write) == false) { \
-		Log::error("Could not save qbt file: " CORE_STRINGIFY(write) " failed"); \
-		delete[] compressedBuf; \
-		delete[] zlibBuffer; \
-		return false; \
-	}
-
 #define wrap(read) \
 	if ((read) != 0) { \
 		Log::error("Could not load qbt file: Not enough data in stream " CORE_STRINGIFY(read) " (line %i)", (int)__LINE__); \
@@ -137,7 +133,7 @@ public:
 		return false; \
 	}
 
-bool QBTFormat::saveMatrix(io::SeekableWriteStream& stream, const scenegraph::SceneGraphNode& node, bool colorMap) const {
+bool QBTFormat::compressMatrix(const scenegraph::SceneGraphNode& node, bool colorMap, CompressedMatrix &matrix) {
 	const voxel::Region& region = node.region();
 	const glm::ivec3& mins = region.getLowerCorner();
 	const glm::ivec3& maxs = region.getUpperCorner();
@@ -147,7 +143,7 @@ bool QBTFormat::saveMatrix(io::SeekableWriteStream& stream, const scenegraph::Sc
 	core_assert(zlibBufSize > 0);
 	uint8_t * const zlibBuffer = new uint8_t[zlibBufSize];
 	const uint32_t compressedBufSize = core::zip::compressBound(zlibBufSize);
-	uint8_t *compressedBuf = new uint8_t[compressedBufSize];
+	matrix.data.resize(compressedBufSize);
 	const voxel::Palette& palette = node.palette();
 
 	uint8_t* zlibBuf = zlibBuffer;
@@ -181,47 +177,87 @@ bool QBTFormat::saveMatrix(io::SeekableWriteStream& stream, const scenegraph::Sc
 	}
 
 	size_t realBufSize = 0;
-	if (!core::zip::compress(zlibBuffer, zlibBufSize, compressedBuf, compressedBufSize, &realBufSize)) {
+	matrix.success = core::zip::compress(zlibBuffer, zlibBufSize, matrix.data.data(), compressedBufSize, &realBufSize);
+	delete[] zlibBuffer;
+	if (!matrix.success) {
 		Log::error("Could not save qbt file: failed to compress the voxel data buffer");
-		delete[] compressedBuf;
-		delete[] zlibBuffer;
+		matrix.data.release();
 		return false;
 	}
+	matrix.data.resize(realBufSize);
+	return true;
+}
 
-	wrapSaveFree(stream.writePascalStringUInt32LE(node.name()));
+bool QBTFormat::compressMatrices(const scenegraph::SceneGraph& sceneGraph, bool colorMap, CompressedMatrices &compressedMatrices) {
+	core::DynamicArray<const scenegraph::SceneGraphNode *> nodes;
+	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
+		nodes.push_back(&node);
+	}
+	core::DynamicArray<CompressedMatrix *> matrices;
+	matrices.reserve(nodes.size());
+	for (const scenegraph::SceneGraphNode *node : nodes) {
+		CompressedMatrix *matrix = new CompressedMatrix();
+		matrices.push_back(matrix);
+		compressedMatrices.put(node->id(), matrix);
+	}
+	core::AtomicInt failed(0);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	threadPool.parallelFor(0, (int)nodes.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			if (!compressMatrix(*nodes[i], colorMap, *matrices[i])) {
+				++failed;
+			}
+		}
+	});
+	return failed == 0;
+}
+
+void QBTFormat::releaseCompressedMatrices(CompressedMatrices &matrices) {
+	for (const auto &entry : matrices) {
+		delete entry->value;
+	}
+	matrices.clear();
+}
+
+bool QBTFormat::saveMatrix(io::SeekableWriteStream& stream, const scenegraph::SceneGraphNode& node, const CompressedMatrices &matrices, bool colorMap) const {
+	CompressedMatrix *matrix = nullptr;
+	if (!matrices.get(node.id(), matrix) || !matrix->success) {
+		Log::error("Could not save qbt file: no compressed voxel data for node %i", node.id());
+		return false;
+	}
+	const glm::ivec3 size = node.region().getDimensionsInVoxels();
+
+	wrapSave(stream.writePascalStringUInt32LE(node.name()));
 	Log::debug("Save matrix with name %s", node.name().c_str());
 
 	const scenegraph::KeyFrameIndex keyFrameIdx = 0;
 	const scenegraph::SceneGraphTransform &transform = node.transform(keyFrameIdx);
 	const glm::ivec3 offset = glm::round(transform.localTranslation());
-	wrapSaveFree(stream.writeInt32(offset.x));
-	wrapSaveFree(stream.writeInt32(offset.y));
-	wrapSaveFree(stream.writeInt32(offset.z));
+	wrapSave(stream.writeInt32(offset.x));
+	wrapSave(stream.writeInt32(offset.y));
+	wrapSave(stream.writeInt32(offset.z));
 
 	const glm::uvec3 localScale { 1 };
-	wrapSaveFree(stream.writeUInt32(localScale.x));
-	wrapSaveFree(stream.writeUInt32(localScale.y));
-	wrapSaveFree(stream.writeUInt32(localScale.z));
+	wrapSave(stream.writeUInt32(localScale.x));
+	wrapSave(stream.writeUInt32(localScale.y));
+	wrapSave(stream.writeUInt32(localScale.z));
 
 	const glm::vec3 &pivot = node.pivot();
-	wrapSaveFree(stream.writeFloat(pivot.x));
-	wrapSaveFree(stream.writeFloat(pivot.y));
-	wrapSaveFree(stream.writeFloat(pivot.z));
+	wrapSave(stream.writeFloat(pivot.x));
+	wrapSave(stream.writeFloat(pivot.y));
+	wrapSave(stream.writeFloat(pivot.z));
 
-	wrapSaveFree(stream.writeUInt32(size.x));
-	wrapSaveFree(stream.writeUInt32(size.y));
-	wrapSaveFree(stream.writeUInt32(size.z));
+	wrapSave(stream.writeUInt32(size.x));
+	wrapSave(stream.writeUInt32(size.y));
+	wrapSave(stream.writeUInt32(size.z));
 
+	const size_t realBufSize = matrix->data.size();
 	Log::debug("save %i compressed bytes", (int)realBufSize);
-	wrapSaveFree(stream.writeUInt32(realBufSize));
-	if (stream.write(compressedBuf, realBufSize) == -1) {
+	wrapSave(stream.writeUInt32(realBufSize));
+	if (stream.write(matrix->data.data(), realBufSize) == -1) {
 		Log::error("Could not save qbt file: failed to write the compressed buffer");
-		delete[] compressedBuf;
-		delete[] zlibBuffer;
 		return false;
 	}
-	delete[] compressedBuf;
-	delete[] zlibBuffer;
 
 	return true;
 }
@@ -239,37 +275,37 @@ bool QBTFormat::saveColorMap(io::SeekableWriteStream& stream, const voxel::Palet
 	return true;
 }
 
-bool QBTFormat::saveCompound(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, bool colorMap) const {
-	wrapSave(saveMatrix(stream, node, colorMap))
+bool QBTFormat::saveCompound(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, const CompressedMatrices &matrices, bool colorMap) const {
+	wrapSave(saveMatrix(stream, node, matrices, colorMap))
 	wrapSave(stream.writeUInt32((int)node.children().size()));
 	for (int nodeId : node.children()) {
 		const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
-		wrapSave(saveNode(stream, sceneGraph, node, colorMap))
+		wrapSave(saveNode(stream, sceneGraph, node, matrices, colorMap))
 	}
 	return true;
 }
 
-bool QBTFormat::saveNode(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, bool colorMap) const {
+bool QBTFormat::saveNode(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, const CompressedMatrices &matrices, bool colorMap) const {
 	const scenegraph::SceneGraphNodeType type = node.type();
 	if (type == scenegraph::SceneGraphNodeType::Model) {
 		if (node.children().empty()) {
 			qbt::ScopedQBTHeader header(stream, node.type());
-			wrapSave(saveMatrix(stream, node, colorMap) && header.success())
+			wrapSave(saveMatrix(stream, node, matrices, colorMap) && header.success())
 		} else {
 			qbt::ScopedQBTHeader scoped(stream, qbt::NODE_TYPE_COMPOUND);
-			wrapSave(saveCompound(stream, sceneGraph, node, colorMap) && scoped.success())
+			wrapSave(saveCompound(stream, sceneGraph, node, matrices, colorMap) && scoped.success())
 		}
 	} else if (type == scenegraph::SceneGraphNodeType::Group || type == scenegraph::SceneGraphNodeType::Root) {
-		wrapSave(saveModel(stream, sceneGraph, node, colorMap))
+		wrapSave(saveModel(stream, sceneGraph, node, matrices, colorMap))
 	}
 	return true;
 }
 
-bool QBTFormat::saveModel(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, bool colorMap) const {
+bool QBTFormat::saveModel(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, const CompressedMatrices &matrices, bool colorMap) const {
 	if (node.children().size() == 1) {
 		for (int nodeId : node.children()) {
 			const scenegraph::SceneGraphNode &cnode = sceneGraph.node(nodeId);
-			wrapSave(saveNode(stream, sceneGraph, cnode, colorMap))
+			wrapSave(saveNode(stream, sceneGraph, cnode, matrices, colorMap))
 		}
 		return true;
 	}
@@ -278,7 +314,7 @@ bool QBTFormat::saveModel(io::SeekableWriteStream& stream, const scenegraph::Sce
 	wrapSave(stream.writeUInt32(children));
 	for (int nodeId : node.children()) {
 		const scenegraph::SceneGraphNode &cnode = sceneGraph.node(nodeId);
-		wrapSave(saveNode(stream, sceneGraph, cnode, colorMap))
+		wrapSave(saveNode(stream, sceneGraph, cnode, matrices, colorMap))
 	}
 	return scoped.success();
 }
@@ -313,7 +349,15 @@ bool QBTFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core:
 	if (!stream.writeString("DATATREE", false)) {
 		return false;
 	}
-	return saveNode(stream, sceneGraph, sceneGraph.root(), colorMap);
+	// the compression of the nodes is independent from each other - only writing them is sequential
+	CompressedMatrices matrices;
+	if (!compressMatrices(sceneGraph, colorMap, matrices)) {
+		releaseCompressedMatrices(matrices);
+		return false;
+	}
+	const bool success = saveNode(stream, sceneGraph, sceneGraph.root(), matrices, colorMap);
+	releaseCompressedMatrices(matrices);
+	return success;
 }
 
 bool QBTFormat::skipNode(io::SeekableReadStream& stream) {
@@ -435,42 +479,26 @@ bool QBTFormat::loadMatrix(io::SeekableReadStream& stream, scenegraph::SceneGrap
 		Log::warn("Size of matrix results in empty space - voxelDataSize: %u", voxelDataSize);
 		return false;
 	}
-	const uint32_t voxelDataSizeDecompressed = size.x * size.y * size.z * sizeof(uint32_t);
-	io::BufferedZipReadStream zipStream(stream, voxelDataSize, voxelDataSizeDecompressed * 2);
-
 	const voxel::Region region(glm::ivec3(0), glm::ivec3(size) - 1);
 	if (!region.isValid()) {
 		Log::error("Invalid region");
 		return false;
 	}
-	core::ScopedPtr<voxel::RawVolume> volume(new voxel::RawVolume(region));
-	for (int32_t x = 0; x < (int)size.x; x++) {
-		for (int32_t z = 0; z < (int)size.z; z++) {
-			for (int32_t y = 0; y < (int)size.y; y++) {
-				uint8_t red;
-				wrap(zipStream.readUInt8(red))
-				uint8_t green;
-				wrap(zipStream.readUInt8(green))
-				uint8_t blue;
-				wrap(zipStream.readUInt8(blue))
-				uint8_t mask;
-				wrap(zipStream.readUInt8(mask))
-				if (mask == 0u) {
-					continue;
-				}
-				if (state.colorFormat == ColorFormat::Palette) {
-					const voxel::Voxel& voxel = voxel::createVoxel(palette, red);
-					volume->setVoxel(x, y, z, voxel);
-				} else {
-					const core::RGBA color = flattenRGB(red, green, blue);
-					uint8_t index = 1;
-					palette.addColorToPalette(color, false, &index);
-					const voxel::Voxel& voxel = voxel::createVoxel(palette, index);
-					volume->setVoxel(x, y, z, voxel);
-				}
-			}
-		}
+	if (state.ctx != nullptr && !state.ctx->acceptModel(state.modelIndex++, name, region)) {
+		Log::debug("Skip matrix %s", name.c_str());
+		return stream.skip(voxelDataSize) != -1;
 	}
+	// the voxel data is decompressed in decodeMatrices() once the whole data tree is loaded
+	PendingMatrix matrix;
+	matrix.size = size;
+	matrix.data.resize(voxelDataSize);
+	if (stream.read(matrix.data.data(), voxelDataSize) != (int)voxelDataSize) {
+		Log::error("Could not load qbt file: Not enough data in stream for the voxel data");
+		return false;
+	}
+	core::ScopedPtr<voxel::RawVolume> volume(new voxel::RawVolume(region));
+	matrix.volume = volume;
+	state.pendingMatrices.push_back(core::move(matrix));
 	scenegraph::SceneGraphNode node;
 	node.setVolume(volume.release(), true);
 	node.setName(name);
@@ -661,8 +689,176 @@ size_t QBTFormat::loadPalette(const core::String &filename, io::SeekableReadStre
 	return 0;
 }
 
+bool QBTFormat::loadMatrixMetadata(io::SeekableReadStream& stream, FormatMetadata &metadata) {
+	ModelMetadata model;
+	wrapBool(stream.readPascalStringUInt32LE(model.name))
+	// position, local scale and pivot
+	if (stream.skip(9 * sizeof(uint32_t)) == -1) {
+		return false;
+	}
+	glm::uvec3 size;
+	wrap(stream.readUInt32(size.x))
+	wrap(stream.readUInt32(size.y))
+	wrap(stream.readUInt32(size.z))
+	uint32_t voxelDataSize;
+	wrap(stream.readUInt32(voxelDataSize))
+	if (glm::any(glm::greaterThan(size, glm::uvec3(2048))) || glm::any(glm::lessThan(size, glm::uvec3(1)))) {
+		Log::warn("Invalid size of matrix %s", model.name.c_str());
+		return false;
+	}
+	if (stream.skip(voxelDataSize) == -1) {
+		Log::error("Could not load qbt file: Not enough data in stream for the voxel data");
+		return false;
+	}
+	model.region = voxel::Region(glm::ivec3(0), glm::ivec3(size) - 1);
+	metadata.models.push_back(model);
+	return true;
+}
+
+bool QBTFormat::loadNodeMetadata(io::SeekableReadStream& stream, FormatMetadata &metadata) {
+	uint32_t nodeTypeID;
+	wrap(stream.readUInt32(nodeTypeID));
+	uint32_t dataSize;
+	wrap(stream.readUInt32(dataSize));
+	switch (nodeTypeID) {
+	case qbt::NODE_TYPE_MATRIX:
+		return loadMatrixMetadata(stream, metadata);
+	case qbt::NODE_TYPE_MODEL:
+	case qbt::NODE_TYPE_COMPOUND: {
+		if (nodeTypeID == qbt::NODE_TYPE_COMPOUND) {
+			wrapBool(loadMatrixMetadata(stream, metadata))
+		}
+		uint32_t childCount;
+		wrap(stream.readUInt32(childCount));
+		if (childCount > 2048u) {
+			Log::error("Max child count exceeded: %i", (int)childCount);
+			return false;
+		}
+		const bool mergeCompounds = nodeTypeID == qbt::NODE_TYPE_COMPOUND &&
+									core::Var::getSafe(cfg::VoxformatQBTMergeCompounds)->boolVal();
+		for (uint32_t i = 0; i < childCount; ++i) {
+			if (mergeCompounds) {
+				wrapBool(skipNode(stream))
+			} else {
+				wrapBool(loadNodeMetadata(stream, metadata))
+			}
+		}
+		return true;
+	}
+	default:
+		stream.skip(dataSize);
+		return true;
+	}
+}
+
+bool QBTFormat::loadMetadata(const core::String &filename, io::SeekableReadStream& stream, FormatMetadata &metadata, const LoadContext &ctx) {
+	Header state;
+	wrapBool(loadHeader(stream, state))
+
+	while (stream.remaining() > 0) {
+		char buf[8];
+		wrapBool(stream.readString(sizeof(buf), buf));
+		if (0 == memcmp(buf, "COLORMAP", 7)) {
+			wrapBool(loadColorMap(stream, metadata.palette))
+		} else if (0 == memcmp(buf, "DATATREE", 8)) {
+			wrapBool(loadNodeMetadata(stream, metadata))
+		} else {
+			Log::error("Unknown section found: %c%c%c%c%c%c%c%c",
+					buf[0], buf[1], buf[2], buf[3], buf[4], buf[5], buf[6], buf[7]);
+			return false;
+		}
+	}
+	if (metadata.palette.colorCount() == 0) {
+		// the colors are stored in the voxels - and the palette is built while loading them
+		voxel::Palette palette;
+		stream.seek(0);
+		scenegraph::SceneGraph sceneGraph;
+		if (loadGroupsPalette(filename, stream, sceneGraph, palette, ctx)) {
+			metadata.palette = palette;
+		}
+	}
+	return true;
+}
+
+bool QBTFormat::uncompressMatrix(PendingMatrix &matrix) {
+	const uint32_t voxelDataSize = (uint32_t)matrix.data.size();
+	const uint32_t voxelDataSizeDecompressed = matrix.size.x * matrix.size.y * matrix.size.z * sizeof(uint32_t);
+	io::MemoryReadStream compressedStream(matrix.data.data(), voxelDataSize);
+	io::BufferedZipReadStream zipStream(compressedStream, voxelDataSize, voxelDataSizeDecompressed * 2);
+	core::DynamicArray<uint8_t> rgbm;
+	rgbm.resize(voxelDataSizeDecompressed);
+	if (zipStream.read(rgbm.data(), voxelDataSizeDecompressed) != (int)voxelDataSizeDecompressed) {
+		Log::error("Could not load qbt file: Not enough data in the voxel data stream");
+		return false;
+	}
+	matrix.data = core::move(rgbm);
+	return true;
+}
+
+void QBTFormat::fillMatrix(const PendingMatrix &matrix, voxel::Palette &palette, ColorFormat colorFormat) const {
+	const glm::uvec3 &size = matrix.size;
+	const uint8_t *rgbm = matrix.data.data();
+	for (int32_t x = 0; x < (int)size.x; x++) {
+		for (int32_t z = 0; z < (int)size.z; z++) {
+			for (int32_t y = 0; y < (int)size.y; y++, rgbm += 4) {
+				const uint8_t red = rgbm[0];
+				const uint8_t green = rgbm[1];
+				const uint8_t blue = rgbm[2];
+				const uint8_t mask = rgbm[3];
+				if (mask == 0u) {
+					continue;
+				}
+				if (colorFormat == ColorFormat::Palette) {
+					const voxel::Voxel& voxel = voxel::createVoxel(palette, red);
+					matrix.volume->setVoxel(x, y, z, voxel);
+				} else {
+					const core::RGBA color = flattenRGB(red, green, blue);
+					uint8_t index = 1;
+					palette.addColorToPalette(color, false, &index);
+					const voxel::Voxel& voxel = voxel::createVoxel(palette, index);
+					matrix.volume->setVoxel(x, y, z, voxel);
+				}
+			}
+		}
+	}
+}
+
+bool QBTFormat::decodeMatrices(voxel::Palette &palette, Header &state) {
+	core::DynamicArray<PendingMatrix> &matrices = state.pendingMatrices;
+	// with a color map the palette is only read - otherwise the palette is built while filling the volumes
+	// and this has to happen in the order of the nodes to get reproducible palettes
+	const bool colorMap = state.colorFormat == ColorFormat::Palette;
+	core::AtomicInt failed(0);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	threadPool.parallelFor(0, (int)matrices.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			PendingMatrix &matrix = matrices[i];
+			if (!uncompressMatrix(matrix)) {
+				++failed;
+				continue;
+			}
+			if (colorMap) {
+				fillMatrix(matrix, palette, state.colorFormat);
+				matrix.data.release();
+			}
+		}
+	});
+	if (failed > 0) {
+		return false;
+	}
+	if (!colorMap) {
+		for (PendingMatrix &matrix : matrices) {
+			fillMatrix(matrix, palette, state.colorFormat);
+			matrix.data.release();
+		}
+	}
+	matrices.clear();
+	return true;
+}
+
 bool QBTFormat::loadGroupsPalette(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const LoadContext &ctx) {
 	Header state;
+	state.ctx = &ctx;
 	wrapBool(loadHeader(stream, state))
 
 	while (stream.remaining() > 0) {
@@ -691,6 +887,10 @@ bool QBTFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 			return false;
 		}
 	}
+	if (!decodeMatrices(palette, state)) {
+		Log::error("Failed to load the voxel data");
+		return false;
+	}
 	for (scenegraph::SceneGraphNode &node : sceneGraph) {
 		node.setPalette(palette);
 	}
@@ -698,7 +898,6 @@ bool QBTFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 }
 
 #undef wrapSave
-#undef wrapSaveFree
 #undef wrap
 #undef wrapBool
 
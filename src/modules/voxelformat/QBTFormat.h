@@ -6,6 +6,8 @@
 
 #include "Format.h"
 #include "voxelformat/BinVoxFormat.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/Map.h"
 
 namespace voxelformat {
 
@@ -27,12 +29,36 @@ private:
 		RGBA,
 		Palette
 	};
+	/**
+	 * @brief The voxel data of a matrix is read sequentially from the stream, but decompressed and
+	 * converted into the volume on the thread pool once the whole data tree is loaded.
+	 */
+	struct PendingMatrix {
+		voxel::RawVolume *volume = nullptr;
+		glm::uvec3 size {0};
+		// the zlib compressed voxel data - replaced by the uncompressed RGBM data after decoding
+		core::DynamicArray<uint8_t> data;
+	};
 	struct Header {
 		uint8_t versionMajor = 0;
 		uint8_t versionMinor = 0;
 		ColorFormat colorFormat = ColorFormat::RGBA;
 		glm::vec3 globalScale {0};
+		core::DynamicArray<PendingMatrix> pendingMatrices;
+		// only set if the models are loaded - not for the palette
+		const LoadContext *ctx = nullptr;
+		// the index of the next matrix in the file - for LoadContext::acceptModel()
+		int modelIndex = 0;
+	};
+	/**
+	 * @brief The zlib compressed voxel data of a model node - the nodes are compressed in parallel before they
+	 * are written sequentially.
+	 */
+	struct CompressedMatrix {
+		core::DynamicArray<uint8_t> data;
+		bool success = false;
 	};
+	using CompressedMatrices = core::Map<int, CompressedMatrix *>;
 
 	bool loadHeader(io::SeekableReadStream& stream, Header &state);
 
@@ -42,16 +68,28 @@ private:
 	bool loadModel(io::SeekableReadStream& stream, scenegraph::SceneGraph &sceneGraph, int parent, voxel::Palette &palette, Header &state);
 	bool loadNode(io::SeekableReadStream& stream, scenegraph::SceneGraph &sceneGraph, int parent, voxel::Palette &palette, Header &state);
 	bool loadColorMap(io::SeekableReadStream& stream, voxel::Palette &palette);
+	bool loadMatrixMetadata(io::SeekableReadStream& stream, FormatMetadata &metadata);
+	bool loadNodeMetadata(io::SeekableReadStream& stream, FormatMetadata &metadata);
+	static bool uncompressMatrix(PendingMatrix &matrix);
+	void fillMatrix(const PendingMatrix &matrix, voxel::Palette &palette, ColorFormat colorFormat) const;
+	bool decodeMatrices(voxel::Palette &palette, Header &state);
 	bool loadGroupsPalette(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const LoadContext &ctx) override;
 
-	bool saveNode(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, bool colorMap) const;
-	bool saveCompound(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, bool colorMap) const;
-	bool saveMatrix(io::SeekableWriteStream& stream, const scenegraph::SceneGraphNode& node, bool colorMap) const;
+	bool saveNode(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, const CompressedMatrices &matrices, bool colorMap) const;
+	bool saveCompound(io::SeekableWriteStream& stream, const scenegraph::SceneGraph& sceneGraph, const scenegraph::SceneGraphNode& node, const CompressedMatrices &matrices, bool colorMap) const;
+	bool saveMatrix(io::SeekableWriteStream& stream, const scenegraph::SceneGraphNode& node, const CompressedMatrices &matrices, bool colorMap) const;
+	static bool compressMatrix(const scenegraph::SceneGraphNode& node, bool colorMap, CompressedMatrix &matrix);
+	static bool compressMatrices(const scenegraph::SceneGraph& sceneGraph, bool colorMap, CompressedMatrices &matrices);
+	static void releaseCompressedMatrices(CompressedMatrices &matrices);
 	bool saveColorMap(io::SeekableWriteStream& stream, const voxel::Palette& palette) const;
-	bool saveModel(io::SeekableWriteStream& stream, const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode& node, bool colorMap) const;
+	bool saveModel(io::SeekableWriteStream& stream, const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode& node, const CompressedMatrices &matrices, bool colorMap) const;
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) override;
 public:
 	size_t loadPalette(const core::String &filename, io::SeekableReadStream& stream, voxel::Palette &palette, const LoadContext &ctx) override;
+	/**
+	 * @brief Reads the node headers and skips the compressed voxel data
+	 */
+	bool loadMetadata(const core::String &filename, io::SeekableReadStream& stream, FormatMetadata &metadata, const LoadContext &ctx) override;
 };
 
 }
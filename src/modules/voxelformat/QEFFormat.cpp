@@ -7,6 +7,8 @@
 #include "core/GLM.h"
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
+#include "core/StringUtil.h"
+#include "io/TextCodec.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Voxel.h"
 #include "scenegraph/SceneGraph.h"
@@ -27,33 +29,63 @@ namespace voxelformat {
 		return false; \
 	}
 
+static bool isLine(const char *begin, const char *end, const char *expected) {
+	const size_t len = SDL_strlen(expected);
+	return (size_t)(end - begin) == len && SDL_memcmp(begin, expected, len) == 0;
+}
+
+/**
+ * @return @c false if the line doesn't contain the given amount of numbers
+ */
+static bool parseNumbers(const char *begin, const char *end, int32_t *values, int n) {
+	for (int i = 0; i < n; ++i) {
+		begin = core::string::parseInt(begin, end, values[i]);
+		if (begin == nullptr) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool parseNumbers(const char *begin, const char *end, float *values, int n) {
+	for (int i = 0; i < n; ++i) {
+		begin = core::string::parseFloat(begin, end, values[i]);
+		if (begin == nullptr) {
+			return false;
+		}
+	}
+	return true;
+}
+
 bool QEFFormat::loadGroupsPalette(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const LoadContext &ctx) {
-	char buf[64];
+	io::TextReader reader(stream);
+	const char *begin;
+	const char *end;
 
-	wrapBool(stream.readLine(sizeof(buf), buf))
-	if (SDL_strcmp(buf, "Qubicle Exchange Format") != 0) {
-		Log::error("Unexpected magic line: '%s'", buf);
+	wrapBool(reader.readLine(begin, end))
+	if (!isLine(begin, end, "Qubicle Exchange Format")) {
+		Log::error("Unexpected magic line: '%s'", core::String(begin, end - begin).c_str());
 		return false;
 	}
-	wrapBool(stream.readLine(sizeof(buf), buf))
-	if (SDL_strcmp(buf, "Version 0.2") != 0) {
-		Log::error("Unexpected version line: '%s'", buf);
+	wrapBool(reader.readLine(begin, end))
+	if (!isLine(begin, end, "Version 0.2")) {
+		Log::error("Unexpected version line: '%s'", core::String(begin, end - begin).c_str());
 		return false;
 	}
-	wrapBool(stream.readLine(sizeof(buf), buf))
-	if (SDL_strcmp(buf, "www.minddesk.com") != 0) {
-		Log::error("Unexpected url line: '%s'", buf);
+	wrapBool(reader.readLine(begin, end))
+	if (!isLine(begin, end, "www.minddesk.com")) {
+		Log::error("Unexpected url line: '%s'", core::String(begin, end - begin).c_str());
 		return false;
 	}
 
-	int width, height, depth;
-	wrapBool(stream.readLine(sizeof(buf), buf))
-	if (SDL_sscanf(buf, "%i %i %i", &width, &depth, &height) != 3) {
+	int32_t dimensions[3];
+	wrapBool(reader.readLine(begin, end))
+	if (!parseNumbers(begin, end, dimensions, 3)) {
 		Log::error("Failed to parse dimensions");
 		return false;
 	}
 
-	const glm::ivec3 size(width, height, depth);
+	const glm::ivec3 size(dimensions[0], dimensions[2], dimensions[1]);
 	if (glm::any(glm::greaterThan(size, glm::ivec3(MaxRegionSize)))) {
 		Log::warn("Size of matrix exceeds the max allowed value");
 		return false;
@@ -69,9 +101,9 @@ bool QEFFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 		return false;
 	}
 
-	int paletteSize;
-	wrapBool(stream.readLine(sizeof(buf), buf))
-	if (SDL_sscanf(buf, "%i", &paletteSize) != 1) {
+	int32_t paletteSize;
+	wrapBool(reader.readLine(begin, end))
+	if (!parseNumbers(begin, end, &paletteSize, 1)) {
 		Log::error("Failed to parse palette size");
 		return false;
 	}
@@ -84,13 +116,13 @@ bool QEFFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 	palette.setSize(paletteSize);
 
 	for (int i = 0; i < paletteSize; ++i) {
-		float r, g, b;
-		wrapBool(stream.readLine(sizeof(buf), buf))
-		if (SDL_sscanf(buf, "%f %f %f", &r, &g, &b) != 3) {
+		float rgb[3];
+		wrapBool(reader.readLine(begin, end))
+		if (!parseNumbers(begin, end, rgb, 3)) {
 			Log::error("Failed to parse palette color");
 			return false;
 		}
-		const glm::vec4 color(r, g, b, 1.0f);
+		const glm::vec4 color(rgb[0], rgb[1], rgb[2], 1.0f);
 		palette.color(i) = core::Color::getRGBA(color);
 	}
 	voxel::RawVolume* volume = new voxel::RawVolume(region);
@@ -100,24 +132,28 @@ bool QEFFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 	node.setPalette(palette);
 	sceneGraph.emplace(core::move(node));
 
-	while (stream.remaining() > 0) {
-		wrapBool(stream.readLine(64, buf))
-		int x, y, z, color, vismask;
-		if (SDL_sscanf(buf, "%i %i %i %i %i", &x, &z, &y, &color, &vismask) != 5) {
+	while (reader.readLine(begin, end)) {
+		if (begin == end) {
+			continue;
+		}
+		// x z y color vismask
+		int32_t values[5];
+		if (!parseNumbers(begin, end, values, 5)) {
 			Log::error("Failed to parse voxel data line");
 			return false;
 		}
-		const voxel::Voxel voxel = voxel::createVoxel(palette, color);
-		volume->setVoxel(x, y, z, voxel);
+		const voxel::Voxel voxel = voxel::createVoxel(palette, values[3]);
+		volume->setVoxel(values[0], values[2], values[1], voxel);
 	}
 
 	return true;
 }
 
 bool QEFFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) {
-	stream.writeString("Qubicle Exchange Format\n", false);
-	stream.writeString("Version 0.2\n", false);
-	stream.writeString("www.minddesk.com\n", false);
+	io::TextWriter writer(stream);
+	writer.writeString("Qubicle Exchange Format\n");
+	writer.writeString("Version 0.2\n");
+	writer.writeString("www.minddesk.com\n");
 
 	const scenegraph::SceneGraph::MergedVolumePalette &merged = sceneGraph.merge();
 	if (merged.first == nullptr) {
@@ -133,13 +169,24 @@ bool QEFFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 	const uint32_t width = region.getWidthInVoxels();
 	const uint32_t height = region.getHeightInVoxels();
 	const uint32_t depth = region.getDepthInVoxels();
-	stream.writeStringFormat(false, "%i %i %i\n", width, depth, height);
+	writer.writeInt(width);
+	writer.writeChar(' ');
+	writer.writeInt(depth);
+	writer.writeChar(' ');
+	writer.writeInt(height);
+	writer.writeChar('\n');
 	const voxel::Palette& palette = merged.second;
-	stream.writeStringFormat(false, "%i\n", palette.colorCount());
+	writer.writeInt(palette.colorCount());
+	writer.writeChar('\n');
 	for (int i = 0; i < palette.colorCount(); ++i) {
 		const core::RGBA c = palette.color(i);
 		const glm::vec4 &cv = core::Color::fromRGBA(c);
-		stream.writeStringFormat(false, "%f %f %f\n", cv.r, cv.g, cv.b);
+		writer.writeFloat(cv.r);
+		writer.writeChar(' ');
+		writer.writeFloat(cv.g);
+		writer.writeChar(' ');
+		writer.writeFloat(cv.b);
+		writer.writeChar('\n');
 	}
 
 	for (uint32_t x = 0u; x < width; ++x) {
@@ -158,11 +205,20 @@ bool QEFFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 				// if (mask && 32 == 32) // front side visible
 				// if (mask && 64 == 64) // back side visible
 				const int vismask = 0x7E; // TODO: this produces voxels where every side is visible, it's up to the importer to fix this atm
-				stream.writeStringFormat(false, "%i %i %i %i %i\n", x, z, y, voxel.getColor(), vismask);
+				writer.writeInt(x);
+				writer.writeChar(' ');
+				writer.writeInt(z);
+				writer.writeChar(' ');
+				writer.writeInt(y);
+				writer.writeChar(' ');
+				writer.writeInt(voxel.getColor());
+				writer.writeChar(' ');
+				writer.writeInt(vismask);
+				writer.writeChar('\n');
 			}
 		}
 	}
-	return true;
+	return writer.flush();
 }
 
 #undef wrap
@@ -3,11 +3,14 @@
  */
 
 #include "SMFormat.h"
+#include "app/App.h"
 #include "core/Bits.h"
 #include "core/FourCC.h"
 #include "core/Log.h"
 #include "core/StringUtil.h"
+#include "core/collection/DynamicArray.h"
 #include "core/collection/Map.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/ZipArchive.h"
 #include "io/ZipReadStream.h"
@@ -117,27 +120,30 @@ bool SMFormat::loadGroupsRGBA(const core::String &filename, io::SeekableReadStre
 		blockPal.put(BLOCKPAL[i].blockId, BLOCKPAL[i].palIdx);
 	}
 	const io::ZipArchiveFiles &files = archive.files();
+	core::DynamicArray<core::String> smd3Files;
+	core::DynamicArray<io::SeekableWriteStream *> modelStreams;
 	for (const io::FilesystemEntry &e : files) {
 		const core::String &extension = core::string::extractExtension(e.name);
-		const bool isSmd3 = extension == "smd3";
-		const bool isSmd2 = extension == "smd2";
-		if (isSmd2 || isSmd3) {
-			io::BufferedReadWriteStream modelStream((int64_t)e.size);
-			if (!archive.load(e.name, modelStream)) {
-				Log::warn("Failed to load zip archive entry %s", e.name.c_str());
-				continue;
-			}
-			if (modelStream.seek(0) == -1) {
-				Log::error("Failed to seek back to the start of the stream for %s", e.name.c_str());
-				continue;
-			}
-			if (isSmd3) {
-				if (!readSmd3(modelStream, sceneGraph, blockPal)) {
-					Log::warn("Failed to load %s from %s", e.name.c_str(), filename.c_str());
-				}
-			}
-			// TODO: read *.smd2
+		if (extension == "smd3") {
+			smd3Files.push_back(e.name);
+			modelStreams.push_back(new io::BufferedReadWriteStream((int64_t)e.size));
 		}
+		// TODO: read *.smd2
+	}
+	// the segment files are decompressed in parallel - but the scene graph is filled in the order of the archive
+	if (!archive.load(smd3Files, modelStreams, &app::App::getInstance()->threadPool())) {
+		Log::warn("Failed to load all zip archive entries of %s", filename.c_str());
+	}
+	for (size_t i = 0; i < smd3Files.size(); ++i) {
+		io::BufferedReadWriteStream *modelStream = (io::BufferedReadWriteStream *)modelStreams[i];
+		if (modelStream->size() == 0) {
+			Log::warn("Failed to load zip archive entry %s", smd3Files[i].c_str());
+		} else if (modelStream->seek(0) == -1) {
+			Log::error("Failed to seek back to the start of the stream for %s", smd3Files[i].c_str());
+		} else if (!readSmd3(*modelStream, sceneGraph, blockPal)) {
+			Log::warn("Failed to load %s from %s", smd3Files[i].c_str(), filename.c_str());
+		}
+		delete modelStream;
 	}
 	return !sceneGraph.empty();
 }
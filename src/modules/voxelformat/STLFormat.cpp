@@ -3,18 +3,26 @@
  */
 
 #include "STLFormat.h"
+#include "app/App.h"
 #include "core/Color.h"
 #include "core/StringUtil.h"
 #include "core/FourCC.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/Mesh.h"
 #include "scenegraph/SceneGraph.h"
+#include <SDL_endian.h>
 #include <SDL_stdinc.h>
 
 namespace voxelformat {
 
 namespace priv {
 static constexpr const size_t BinaryHeaderSize = 80;
+/**
+ * @brief normal, three vertices and the attribute byte count
+ */
+static constexpr const size_t BinaryFaceSize = 12 * sizeof(float) + sizeof(uint16_t);
 }
 
 bool STLFormat::parseAscii(io::SeekableReadStream &stream, TriCollection &tris) {
@@ -80,6 +88,15 @@ bool STLFormat::parseAscii(io::SeekableReadStream &stream, TriCollection &tris)
 		return false; \
 	}
 
+static inline float readFloatLE(const uint8_t *data) {
+	uint32_t value;
+	core_memcpy(&value, data, sizeof(value));
+	value = SDL_SwapLE32(value);
+	float f;
+	core_memcpy(&f, &value, sizeof(f));
+	return f;
+}
+
 bool STLFormat::parseBinary(io::SeekableReadStream &stream, TriCollection &tris) {
 	const glm::vec3 &scale = getScale();
 	if (stream.seek(priv::BinaryHeaderSize) == -1) {
@@ -93,24 +110,33 @@ bool STLFormat::parseBinary(io::SeekableReadStream &stream, TriCollection &tris)
 		Log::error("No faces in stl file");
 		return false;
 	}
+	if (numFaces > (uint32_t)INT32_MAX) {
+		Log::error("Too many faces in stl file: %u", numFaces);
+		return false;
+	}
+	// mapped files are decoded without copying them into a temporary buffer
+	io::StreamData streamData(stream);
+	if (!streamData.valid() || (uint64_t)streamData.size() < (uint64_t)numFaces * priv::BinaryFaceSize) {
+		Log::error("Expected %u faces, but only got %i bytes", numFaces, (int)streamData.size());
+		return false;
+	}
 	tris.resize(numFaces);
-	for (uint32_t fn = 0; fn < numFaces; ++fn) {
-		Tri &tri = tris[fn];
-		glm::vec3 normal;
-		wrap(stream.readFloat(normal.x))
-		wrap(stream.readFloat(normal.y))
-		wrap(stream.readFloat(normal.z))
-		for (int i = 0; i < 3; ++i) {
-			wrap(stream.readFloat(tri.vertices[i].x))
-			wrap(stream.readFloat(tri.vertices[i].y))
-			wrap(stream.readFloat(tri.vertices[i].z))
-			tri.vertices[i] *= scale;
-		}
-		if (stream.skip(2) == -1) {
-			Log::error("Failed to seek while parsing the frames");
-			return false;
+	const uint8_t *faces = streamData.data();
+	// the faces have a fixed size and are decoded in parallel
+	app::App::getInstance()->threadPool().parallelFor(0, (int)numFaces, 4096, [&](int start, int end) {
+		for (int fn = start; fn < end; ++fn) {
+			// skip the normal
+			const uint8_t *face = faces + (size_t)fn * priv::BinaryFaceSize + 3 * sizeof(float);
+			Tri &tri = tris[fn];
+			for (int i = 0; i < 3; ++i) {
+				tri.vertices[i].x = readFloatLE(face + 0 * sizeof(float));
+				tri.vertices[i].y = readFloatLE(face + 1 * sizeof(float));
+				tri.vertices[i].z = readFloatLE(face + 2 * sizeof(float));
+				tri.vertices[i] *= scale;
+				face += 3 * sizeof(float);
+			}
 		}
-	}
+	});
 
 	return true;
 }
@@ -163,6 +189,13 @@ bool STLFormat::writeVertex(io::SeekableWriteStream &stream, const MeshExt &mesh
 bool STLFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &sceneGraph, const Meshes &meshes,
 						   const core::String &filename, io::SeekableWriteStream &stream, const glm::vec3 &scale,
 						   bool quad, bool withColor, bool withTexCoords) {
+	MeshQueue queue(sceneGraph, meshes);
+	return saveMeshQueue(sceneGraph, queue, filename, stream, scale, quad, withColor, withTexCoords);
+}
+
+bool STLFormat::saveMeshQueue(const scenegraph::SceneGraph &sceneGraph, MeshQueue &queue, const core::String &filename,
+							  io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad, bool withColor,
+							  bool withTexCoords) {
 	stream.writeStringFormat(false, "github.com/mgerhardy/vengi");
 	const size_t delta = priv::BinaryHeaderSize - stream.pos();
 	for (size_t i = 0; i < delta; ++i) {
@@ -170,31 +203,24 @@ bool STLFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 	}
 	core_assert(stream.pos() == priv::BinaryHeaderSize);
 
-	int faceCount = 0;
-	for (const auto &meshExt : meshes) {
+	uint32_t faceCount = 0;
+	const int64_t faceCountPos = stream.pos();
+	stream.writeUInt32(faceCount);
+
+	while (const MeshExt *nextMeshExt = queue.next()) {
+		const MeshExt &meshExt = *nextMeshExt;
 		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
 			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
 			if (mesh->isEmpty()) {
 				continue;
 			}
+			Log::debug("Exporting layer %s", meshExt.name.c_str());
 			const int ni = (int)mesh->getNoOfIndices();
 			if (ni % 3 != 0) {
 				Log::error("Unexpected indices amount");
 				return false;
 			}
 			faceCount += ni / 3;
-		}
-	}
-	stream.writeUInt32(faceCount);
-
-	for (const auto &meshExt : meshes) {
-		for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
-			const voxel::Mesh *mesh = &meshExt.mesh->mesh[i];
-			if (mesh->isEmpty()) {
-				continue;
-			}
-			Log::debug("Exporting layer %s", meshExt.name.c_str());
-			const int ni = (int)mesh->getNoOfIndices();
 			const scenegraph::SceneGraphNode &graphNode = sceneGraph.node(meshExt.nodeId);
 			scenegraph::KeyFrameIndex keyFrameIdx = 0;
 			const scenegraph::SceneGraphTransform &transform = graphNode.transform(keyFrameIdx);
@@ -236,7 +262,15 @@ bool STLFormat::saveMeshes(const core::Map<int, int> &, const scenegraph::SceneG
 			}
 		}
 	}
-	return true;
+	const int64_t endPos = stream.pos();
+	if (stream.seek(faceCountPos) == -1) {
+		Log::error("Failed to seek to the face count");
+		return false;
+	}
+	if (!stream.writeUInt32(faceCount)) {
+		return false;
+	}
+	return stream.seek(endPos) != -1;
 }
 
 } // namespace voxel
@@ -46,5 +46,11 @@ public:
 	bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &meshes, const core::String &filename,
 					io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad, bool withColor,
 					bool withTexCoords) override;
+	/**
+	 * @brief The face count in the header is written after all meshes were written
+	 */
+	bool saveMeshQueue(const scenegraph::SceneGraph &sceneGraph, MeshQueue &queue, const core::String &filename,
+					   io::SeekableWriteStream &stream, const glm::vec3 &scale, bool quad, bool withColor,
+					   bool withTexCoords) override;
 };
 } // namespace voxel
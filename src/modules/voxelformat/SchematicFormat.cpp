@@ -3,6 +3,7 @@
  */
 
 #include "SchematicFormat.h"
+#include "app/App.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/Log.h"
@@ -10,6 +11,7 @@
 #include "core/StringUtil.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/StringMap.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/File.h"
 #include "io/MemoryReadStream.h"
@@ -402,7 +404,7 @@ bool SchematicFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const
 	const glm::ivec3 &size = region.getDimensionsInVoxels();
 	const glm::ivec3 &mins = region.getLowerCorner();
 
-	io::ZipWriteStream zipStream(stream);
+	io::ZipWriteStream zipStream(stream, 6, &app::App::getInstance()->threadPool());
 
 	priv::NBTCompound compound;
 	compound.put("Width", (int16_t)size.x);
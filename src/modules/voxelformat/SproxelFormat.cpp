@@ -7,7 +7,7 @@
 #include "core/Log.h"
 #include "core/ScopedPtr.h"
 #include "core/StringUtil.h"
-#include "core/Tokenizer.h"
+#include "io/TextCodec.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/PaletteLookup.h"
 #include "scenegraph/SceneGraph.h"
@@ -28,100 +28,116 @@ namespace voxelformat {
 		return false;                                                                                                  \
 	}
 
-size_t SproxelFormat::loadPalette(const core::String &filename, io::SeekableReadStream& stream, voxel::Palette &palette, const LoadContext &ctx) {
-	char buf[512];
-	wrapBool(stream.readLine(sizeof(buf), buf))
+static inline int hexValue(char c) {
+	if (c >= '0' && c <= '9') {
+		return c - '0';
+	}
+	if (c >= 'A' && c <= 'F') {
+		return 10 + (c - 'A');
+	}
+	if (c >= 'a' && c <= 'f') {
+		return 10 + (c - 'a');
+	}
+	return -1;
+}
 
-	core::Tokenizer tok(buf, ",");
-	if (tok.size() != 3u) {
-		Log::error("Invalid size components found - expected x,y,z");
+/**
+ * @brief Parses a @c #RRGGBBAA color
+ */
+static bool parseColor(const char *begin, const char *end, core::RGBA &color) {
+	if (end - begin < 9 || begin[0] != '#') {
 		return false;
 	}
+	uint8_t rgba[4];
+	for (int i = 0; i < 4; ++i) {
+		const int high = hexValue(begin[1 + i * 2]);
+		const int low = hexValue(begin[2 + i * 2]);
+		if (high == -1 || low == -1) {
+			return false;
+		}
+		rgba[i] = (uint8_t)(high * 16 + low);
+	}
+	color = core::RGBA(rgba[0], rgba[1], rgba[2], rgba[3]);
+	return true;
+}
 
-	const int32_t x = core::string::toInt(tok.tokens()[0]);
-	const int32_t y = core::string::toInt(tok.tokens()[1]);
-	const int32_t z = core::string::toInt(tok.tokens()[2]);
-	glm::ivec3 size(x, y, z);
+static bool readSize(io::TextReader &reader, glm::ivec3 &size) {
+	const char *begin;
+	const char *end;
+	wrapBool(reader.readLine(begin, end))
+	for (int i = 0; i < 3; ++i) {
+		begin = core::string::parseInt(begin, end, size[i]);
+		if (begin == nullptr || (i < 2 && (begin >= end || *begin++ != ','))) {
+			Log::error("Invalid size components found - expected x,y,z");
+			return false;
+		}
+	}
+	return true;
+}
 
+/**
+ * @brief Calls the given function for every voxel color in the order of the file
+ */
+template<class FUNC>
+static bool readColors(io::TextReader &reader, const glm::ivec3 &size, FUNC &&func) {
+	const char *begin;
+	const char *end;
 	for (int y = size.y - 1; y >= 0; y--) {
 		for (int z = 0; z < size.z; z++) {
+			if (!reader.readLine(begin, end)) {
+				Log::error("Could not load sproxel csv color line");
+				return false;
+			}
 			for (int x = 0; x < size.x; x++) {
-				char hex[10];
-				if ((stream.read(hex, 9)) == -1) {
-					Log::error("Could not load sproxel csv color line");
-					return false;
-				}
-				hex[sizeof(hex) - 1] = '\0';
-				uint8_t r, g, b, a;
-				const int n = core::string::parseHex(hex, r, g, b, a);
-				if (n != 4) {
-					Log::error("Failed to parse color %i (%s)", n, hex);
+				core::RGBA color;
+				if (!parseColor(begin, end, color)) {
+					Log::error("Failed to parse color at %i:%i:%i", x, y, z);
 					return false;
 				}
-				if (a != 0) {
-					const core::RGBA color(r, g, b, a);
-					palette.addColorToPalette(color, false);
-				}
+				begin += 9;
 				if (x != size.x - 1) {
-					stream.skip(1);
-				}
-			}
-			stream.skip(1);
-		}
-		stream.skip(1);
-	}
-	return palette.colorCount();
-}
-
-static bool skipNewline(io::SeekableReadStream &stream) {
-	uint8_t chr;
-	if (stream.readUInt8(chr) == -1) {
-		Log::error("Failed to read newline character from stream");
-		return false;
-	}
-	if (chr == '\r') {
-		if (stream.peekUInt8(chr) != -1) {
-			if (chr == '\n') {
-				if (stream.skip(1) == -1) {
-					Log::error("Failed to skip newline character from stream");
-					return false;
+					if (begin >= end || *begin != ',') {
+						Log::error("Got unexpected character, expected ,");
+						return false;
+					}
+					++begin;
 				}
+				func(x, y, z, color);
 			}
 		}
+		// the slices are separated by an empty line
+		reader.readLine(begin, end);
 	}
 	return true;
 }
 
-static bool skipComma(io::SeekableReadStream &stream) {
-	uint8_t chr;
-	if (stream.readUInt8(chr) == -1) {
-		Log::error("Failed to read comma character from stream");
-		return false;
+size_t SproxelFormat::loadPalette(const core::String &filename, io::SeekableReadStream& stream, voxel::Palette &palette, const LoadContext &ctx) {
+	io::TextReader reader(stream);
+	glm::ivec3 size;
+	if (!readSize(reader, size)) {
+		return 0;
 	}
-	if (chr != ',') {
-		Log::error("Got unexpected character, expected , - got %c", chr);
-		return false;
+	const bool success = readColors(reader, size, [&](int, int, int, const core::RGBA &color) {
+		if (color.a != 0) {
+			palette.addColorToPalette(color, false);
+		}
+	});
+	if (!success) {
+		return 0;
 	}
-	return true;
+	return palette.colorCount();
 }
 
 bool SproxelFormat::loadGroupsRGBA(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const voxel::Palette &palette, const LoadContext &ctx) {
-	char buf[512];
-	wrapBool(stream.readLine(sizeof(buf), buf))
-
-	core::Tokenizer tok(buf, ",");
-	if (tok.size() != 3u) {
-		Log::error("Invalid size components found - expected x,y,z");
+	io::TextReader reader(stream);
+	glm::ivec3 size;
+	if (!readSize(reader, size)) {
 		return false;
 	}
 
-	const int32_t sizex = core::string::toInt(tok.tokens()[0]);
-	const int32_t sizey = core::string::toInt(tok.tokens()[1]);
-	const int32_t sizez = core::string::toInt(tok.tokens()[2]);
-
-	const voxel::Region region(0, 0, 0, sizex - 1, sizey - 1, sizez - 1);
+	const voxel::Region region(glm::ivec3(0), size - 1);
 	if (!region.isValid()) {
-		Log::error("Invalid region %i:%i:%i", sizex, sizey, sizez);
+		Log::error("Invalid region %i:%i:%i", size.x, size.y, size.z);
 		return false;
 	}
 
@@ -130,41 +146,16 @@ bool SproxelFormat::loadGroupsRGBA(const core::String &filename, io::SeekableRea
 	node.setVolume(volume, true);
 
 	voxel::PaletteLookup palLookup(palette);
-	for (int y = sizey - 1; y >= 0; y--) {
-		for (int z = 0; z < sizez; z++) {
-			for (int x = 0; x < sizex; x++) {
-				char hex[10];
-				if (stream.read(hex, 9) == -1) {
-					Log::error("Could not load sproxel csv color line");
-					return false;
-				}
-				hex[sizeof(hex) - 1] = '\0';
-				uint8_t r, g, b, a;
-				const int n = core::string::parseHex(hex, r, g, b, a);
-				if (n != 4) {
-					Log::error("Failed to parse color %i (%s)", n, hex);
-					return false;
-				}
-				if (a != 0) {
-					const core::RGBA color = flattenRGB(r, g, b, a);
-					const uint8_t index = palLookup.findClosestIndex(color);
-					const voxel::Voxel voxel = voxel::createVoxel(palette, index);
-					volume->setVoxel(x, y, z, voxel);
-				}
-				if (x != sizex - 1) {
-					if (!skipComma(stream)) {
-						Log::error("Failed to skip 1 byte");
-						return false;
-					}
-				}
-			}
-			if (!skipNewline(stream)) {
-				return false;
-			}
-		}
-		if (!skipNewline(stream)) {
-			return false;
+	const bool success = readColors(reader, size, [&](int x, int y, int z, const core::RGBA &rgba) {
+		if (rgba.a != 0) {
+			const core::RGBA color = flattenRGB(rgba.r, rgba.g, rgba.b, rgba.a);
+			const uint8_t index = palLookup.findClosestIndex(color);
+			const voxel::Voxel voxel = voxel::createVoxel(palette, index);
+			volume->setVoxel(x, y, z, voxel);
 		}
+	});
+	if (!success) {
+		return false;
 	}
 	node.setName(filename);
 	node.setPalette(palLookup.palette());
@@ -186,10 +177,13 @@ bool SproxelFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const c
 	const int width = region.getWidthInVoxels();
 	const int height = region.getHeightInVoxels();
 	const int depth = region.getDepthInVoxels();
-	if (!stream.writeStringFormat(false, "%i,%i,%i\n", width, height, depth)) {
-		Log::error("Could not save sproxel csv file");
-		return false;
-	}
+	io::TextWriter writer(stream);
+	writer.writeInt(width);
+	writer.writeChar(',');
+	writer.writeInt(height);
+	writer.writeChar(',');
+	writer.writeInt(depth);
+	writer.writeChar('\n');
 
 	const voxel::Palette& palette = merged.second;
 	for (int y = height - 1; y >= 0; y--) {
@@ -198,18 +192,26 @@ bool SproxelFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const c
 				core_assert_always(sampler.setPosition(lower.x + x, lower.y + y, lower.z + z));
 				const voxel::Voxel &voxel = sampler.voxel();
 				if (voxel.getMaterial() == voxel::VoxelType::Air) {
-					stream.writeString("#00000000", false);
+					writer.writeString("#00000000", 9);
 				} else {
 					const core::RGBA rgba = palette.color(voxel.getColor());
-					stream.writeStringFormat(false, "#%02X%02X%02X%02X", rgba.r, rgba.g, rgba.b, rgba.a);
+					writer.writeChar('#');
+					writer.writeHex(rgba.r);
+					writer.writeHex(rgba.g);
+					writer.writeHex(rgba.b);
+					writer.writeHex(rgba.a);
 				}
 				if (x != width - 1) {
-					stream.writeString(",", false);
+					writer.writeChar(',');
 				}
 			}
-			stream.writeString("\n", false);
+			writer.writeChar('\n');
 		}
-		stream.writeString("\n", false);
+		writer.writeChar('\n');
+	}
+	if (!writer.flush()) {
+		Log::error("Could not save sproxel csv file");
+		return false;
 	}
 	return true;
 }
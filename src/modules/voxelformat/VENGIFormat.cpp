@@ -3,11 +3,17 @@
  */
 
 #include "VENGIFormat.h"
+#include "app/App.h"
 #include "core/ArrayLength.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
 #include "core/Enum.h"
 #include "core/FourCC.h"
 #include "core/Log.h"
+#include "core/StringUtil.h"
+#include "core/Zip.h"
 #include "glm/gtc/type_ptr.hpp"
+#include "io/BufferedReadWriteStream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
 #include "voxel/Palette.h"
@@ -31,6 +37,12 @@
 
 namespace voxelformat {
 
+/**
+ * @brief Since this version the voxels are stored outside of the node tree
+ */
+static constexpr uint32_t IndexedVersion = 5;
+static constexpr uint32_t CurrentVersion = 5;
+
 static scenegraph::SceneGraphNodeType toNodeType(const core::String &type) {
 	for (int i = 0; i < lengthof(scenegraph::SceneGraphNodeTypeStr); ++i) {
 		if (type == scenegraph::SceneGraphNodeTypeStr[i]) {
@@ -50,7 +62,7 @@ static scenegraph::InterpolationType toInterpolationType(const core::String &typ
 }
 
 bool VENGIFormat::saveNodeProperties(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, io::WriteStream &stream) {
-	const core::StringMap<core::String> &properties = node.properties();
+	const scenegraph::SceneGraphNodeProperties &properties = node.properties();
 	if (properties.empty()) {
 		return true;
 	}
@@ -73,30 +85,159 @@ bool VENGIFormat::saveAnimation(const scenegraph::SceneGraphNode &node, const co
 	return true;
 }
 
-bool VENGIFormat::saveNodeData(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, io::WriteStream &stream) {
+bool VENGIFormat::saveNodeData(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, const CompressedNodeDataMap &nodeData, io::WriteStream &stream) {
 	if (node.type() != scenegraph::SceneGraphNodeType::Model) {
 		return true;
 	}
-	wrapBool(stream.writeUInt32(FourCC('D','A','T','A')))
-	const voxel::RawVolume *v = node.volume();
-	const voxel::Region &region = v->region();
+	CompressedNodeData *data = nullptr;
+	if (!nodeData.get(node.id(), data) || !data->success) {
+		Log::error("No compressed voxel data for node %i", node.id());
+		return false;
+	}
+	wrapBool(stream.writeUInt32(FourCC('D','R','E','F')))
+	const voxel::Region &region = node.volume()->region();
 	wrapBool(stream.writeInt32(region.getLowerX()))
 	wrapBool(stream.writeInt32(region.getLowerY()))
 	wrapBool(stream.writeInt32(region.getLowerZ()))
 	wrapBool(stream.writeInt32(region.getUpperX()))
 	wrapBool(stream.writeInt32(region.getUpperY()))
 	wrapBool(stream.writeInt32(region.getUpperZ()))
-	auto visitor = [&stream] (int, int, int, const voxel::Voxel &voxel) {
+	wrapBool(stream.writeUInt64(data->offset))
+	wrapBool(stream.writeUInt32((uint32_t)data->bytes().size()))
+	return true;
+}
+
+/**
+ * @brief Every voxel is stored as air flag - followed by the palette color index for solid voxels
+ */
+static bool compressVoxels(const voxel::RawVolume &volume, core::DynamicArray<uint8_t> &compressed) {
+	core::DynamicArray<uint8_t> voxels;
+	voxels.reserve((size_t)volume.region().voxels() * 2);
+	auto visitor = [&voxels] (int, int, int, const voxel::Voxel &voxel) {
 		const bool air = isAir(voxel.getMaterial());
-		stream.writeBool(air);
+		voxels.push_back(air ? 1 : 0);
 		if (!air) {
-			stream.writeUInt8(voxel.getColor());
+			voxels.push_back(voxel.getColor());
 		}
 	};
-	voxelutil::visitVolume(*v, visitor, voxelutil::VisitAll(), voxelutil::VisitorOrder::XYZ);
+	voxelutil::visitVolume(volume, visitor, voxelutil::VisitAll(), voxelutil::VisitorOrder::XYZ);
+	const uint32_t compressedBufSize = core::zip::compressBound((uint32_t)voxels.size());
+	compressed.resize(compressedBufSize);
+	size_t realBufSize = 0;
+	if (!core::zip::compress(voxels.data(), voxels.size(), compressed.data(), compressedBufSize, &realBufSize)) {
+		Log::error("Failed to compress the voxel data");
+		return false;
+	}
+	compressed.resize(realBufSize);
+	return true;
+}
+
+static bool uncompressVoxels(const core::DynamicArray<uint8_t> &compressed, voxel::RawVolume &volume, const voxel::Palette &palette) {
+	core::DynamicArray<uint8_t> voxels;
+	voxels.resize((size_t)volume.region().voxels() * 2);
+	size_t realBufSize = 0;
+	if (!core::zip::uncompress(compressed.data(), compressed.size(), voxels.data(), voxels.size(), &realBufSize)) {
+		Log::error("Failed to uncompress the voxel data");
+		return false;
+	}
+	size_t pos = 0;
+	bool truncated = false;
+	auto visitor = [&] (int x, int y, int z, const voxel::Voxel &) {
+		if (pos >= realBufSize) {
+			truncated = true;
+			return;
+		}
+		const bool air = voxels[pos++] != 0;
+		if (air) {
+			return;
+		}
+		if (pos >= realBufSize) {
+			truncated = true;
+			return;
+		}
+		const uint8_t color = voxels[pos++];
+		const voxel::VoxelType type = palette.color(color).a != 255 ? voxel::VoxelType::Transparent : voxel::VoxelType::Generic;
+		volume.setVoxel(x, y, z, voxel::createVoxel(type, color));
+	};
+	voxelutil::visitVolume(volume, visitor, voxelutil::VisitAll(), voxelutil::VisitorOrder::XYZ);
+	if (truncated) {
+		Log::error("The voxel data is truncated");
+		return false;
+	}
 	return true;
 }
 
+bool VENGIFormat::compressNodeData(const scenegraph::SceneGraph &sceneGraph, CompressedNodeDataMap &nodeData) {
+	core::DynamicArray<const scenegraph::SceneGraphNode *> nodes;
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Model); iter != sceneGraph.end(); ++iter) {
+		nodes.push_back(&*iter);
+	}
+	core::DynamicArray<CompressedNodeData *> compressed;
+	compressed.reserve(nodes.size());
+	// only these are compressed - the others are taken from the cache of the previous save
+	core::DynamicArray<int> modified;
+	modified.reserve(nodes.size());
+	for (const scenegraph::SceneGraphNode *node : nodes) {
+		CompressedNodeData *data = new CompressedNodeData();
+		data->volume = node->volume();
+		if (_nodeDataCache != nullptr) {
+			core::SharedPtr<CachedNodeData> cached;
+			if (_nodeDataCache->get(node->id(), cached) && cached->region == data->volume->region()) {
+				data->cached = cached;
+				data->success = true;
+			}
+		}
+		if (!data->cached) {
+			modified.push_back((int)compressed.size());
+		}
+		compressed.push_back(data);
+		nodeData.put(node->id(), data);
+	}
+	Log::debug("Compress the voxels of %i out of %i model nodes", (int)modified.size(), (int)nodes.size());
+	core::AtomicInt failed(0);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	threadPool.parallelFor(0, (int)modified.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			CompressedNodeData *data = compressed[modified[i]];
+			data->success = compressVoxels(*data->volume, data->data);
+			if (!data->success) {
+				++failed;
+			}
+		}
+	});
+	// the data is written in the same order as the nodes were collected
+	uint64_t offset = 0;
+	for (CompressedNodeData *data : compressed) {
+		data->offset = offset;
+		offset += data->bytes().size();
+	}
+	return failed == 0;
+}
+
+void VENGIFormat::updateNodeDataCache(const CompressedNodeDataMap &nodeData) {
+	// removed nodes are dropped from the cache, too
+	NodeDataCache cache;
+	for (const auto &entry : nodeData) {
+		CompressedNodeData *data = entry->value;
+		if (data->cached) {
+			cache.put(entry->key, data->cached);
+			continue;
+		}
+		core::SharedPtr<CachedNodeData> cached = core::make_shared<CachedNodeData>();
+		cached->region = data->volume->region();
+		cached->data = core::move(data->data);
+		cache.put(entry->key, cached);
+	}
+	*_nodeDataCache = core::move(cache);
+}
+
+void VENGIFormat::releaseCompressedNodeData(CompressedNodeDataMap &nodeData) {
+	for (const auto &entry : nodeData) {
+		delete entry->value;
+	}
+	nodeData.clear();
+}
+
 bool VENGIFormat::saveNodeKeyFrame(const scenegraph::SceneGraphKeyFrame &keyframe, io::WriteStream &stream) {
 	wrapBool(stream.writeUInt32(FourCC('K','E','Y','F')))
 	wrapBool(stream.writeUInt32(keyframe.frameIdx))
@@ -134,7 +275,8 @@ bool VENGIFormat::saveNodePaletteIdentifier(const scenegraph::SceneGraph &sceneG
 	return true;
 }
 
-bool VENGIFormat::saveNode(const scenegraph::SceneGraph &sceneGraph, io::WriteStream& stream, const scenegraph::SceneGraphNode& node) {
+bool VENGIFormat::saveNode(const scenegraph::SceneGraph &sceneGraph, io::WriteStream& stream, const scenegraph::SceneGraphNode& node,
+						   const CompressedNodeDataMap &nodeData) {
 	wrapBool(stream.writeUInt32(FourCC('N','O','D','E')))
 	wrapBool(stream.writePascalStringUInt16LE(node.name()))
 	wrapBool(stream.writePascalStringUInt16LE(scenegraph::SceneGraphNodeTypeStr[(int)node.type()]))
@@ -152,12 +294,12 @@ bool VENGIFormat::saveNode(const scenegraph::SceneGraph &sceneGraph, io::WriteSt
 	} else {
 		wrapBool(saveNodePaletteColors(sceneGraph, node, stream))
 	}
-	wrapBool(saveNodeData(sceneGraph, node, stream))
+	wrapBool(saveNodeData(sceneGraph, node, nodeData, stream))
 	for (const core::String &animation : sceneGraph.animations()) {
 		wrapBool(saveAnimation(node, animation, stream))
 	}
 	for (int childId : node.children()) {
-		wrapBool(saveNode(sceneGraph, stream, sceneGraph.node(childId)))
+		wrapBool(saveNode(sceneGraph, stream, sceneGraph.node(childId), nodeData))
 	}
 	wrapBool(stream.writeUInt32(FourCC('E','N','D','N')))
 	return true;
@@ -176,7 +318,7 @@ bool VENGIFormat::loadNodeProperties(scenegraph::SceneGraph &sceneGraph, scenegr
 	return true;
 }
 
-bool VENGIFormat::loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream) {
+static bool readRegion(io::ReadStream &stream, voxel::Region &region) {
 	glm::ivec3 mins, maxs;
 	wrap(stream.readInt32(mins.x))
 	wrap(stream.readInt32(mins.y))
@@ -185,7 +327,31 @@ bool VENGIFormat::loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::S
 	wrap(stream.readInt32(maxs.y))
 	wrap(stream.readInt32(maxs.z))
 	Log::debug("Load region of %i:%i:%i %i:%i:%i", mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z);
-	const voxel::Region region(mins, maxs);
+	region = voxel::Region(mins, maxs);
+	return true;
+}
+
+/**
+ * @brief The voxels in the node tree of the versions before 5 are not prefixed with their size - they have to be
+ * read to get to the next chunk
+ */
+static bool skipVoxels(io::ReadStream &stream, const voxel::Region &region) {
+	const int voxels = region.voxels();
+	for (int i = 0; i < voxels; ++i) {
+		if (!stream.readBool()) {
+			uint8_t colorIdx;
+			wrap(stream.readUInt8(colorIdx))
+		}
+	}
+	return true;
+}
+
+bool VENGIFormat::loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream) {
+	voxel::Region region;
+	wrapBool(readRegion(stream, region))
+	if (skipModel(node, region)) {
+		return skipVoxels(stream, region);
+	}
 	voxel::RawVolume *v = new voxel::RawVolume(region);
 	node.setVolume(v, true);
 	const voxel::Palette &palette = node.palette();
@@ -204,8 +370,105 @@ bool VENGIFormat::loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::S
 	return true;
 }
 
-bool VENGIFormat::loadNodePaletteColors(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream) {
-	voxel::Palette palette;
+bool VENGIFormat::loadNodeDataRef(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream) {
+	voxel::Region region;
+	wrapBool(readRegion(stream, region))
+	NodeDataRef ref;
+	ref.nodeId = node.id();
+	wrap(stream.readUInt64(ref.offset))
+	wrap(stream.readUInt32(ref.size))
+	if (skipModel(node, region)) {
+		return true;
+	}
+	if (_hiddenNodes != nullptr && !node.visible()) {
+		NodeDataLocation location;
+		location.region = region;
+		location.offset = _dataStart + (int64_t)ref.offset;
+		location.size = ref.size;
+		_hiddenNodes->put(node.id(), location);
+		return true;
+	}
+	// the voxels are filled once the whole node tree is loaded
+	node.setVolume(new voxel::RawVolume(region), true);
+	_nodeDataRefs.push_back(ref);
+	return true;
+}
+
+bool VENGIFormat::loadNodeDataRefs(io::SeekableReadStream &stream, int64_t dataStart, scenegraph::SceneGraph &sceneGraph) {
+	const int n = (int)_nodeDataRefs.size();
+	core::DynamicArray<core::DynamicArray<uint8_t>> compressed;
+	compressed.resize(n);
+	for (int i = 0; i < n; ++i) {
+		const NodeDataRef &ref = _nodeDataRefs[i];
+		if (stream.seek(dataStart + (int64_t)ref.offset) == -1) {
+			Log::error("Failed to seek to the voxel data of node %i", ref.nodeId);
+			return false;
+		}
+		compressed[i].resize(ref.size);
+		if (stream.read(compressed[i].data(), ref.size) != (int)ref.size) {
+			Log::error("Failed to read the voxel data of node %i", ref.nodeId);
+			return false;
+		}
+	}
+	core::AtomicInt failed(0);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	threadPool.parallelFor(0, n, 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const scenegraph::SceneGraphNode &node = sceneGraph.node(_nodeDataRefs[i].nodeId);
+			if (!uncompressVoxels(compressed[i], *node.volume(), node.palette())) {
+				++failed;
+			}
+		}
+	});
+	return failed == 0;
+}
+
+bool VENGIFormat::skipModel(const scenegraph::SceneGraphNode &node, const voxel::Region &region) {
+	bool skip = false;
+	if (_modelNames != nullptr) {
+		skip = true;
+		for (const core::String &modelName : *_modelNames) {
+			if (modelName == node.name()) {
+				skip = false;
+				break;
+			}
+		}
+	}
+	if (_loadCtx != nullptr && !_loadCtx->acceptModel(_modelIndex++, node.name(), region)) {
+		skip = true;
+	}
+	if (skip) {
+		Log::debug("Skip model %s", node.name().c_str());
+		_skippedNodes.push_back(node.id());
+	}
+	return skip;
+}
+
+bool VENGIFormat::removeSkippedNodes(scenegraph::SceneGraph &sceneGraph) {
+	if (_skippedNodes.empty()) {
+		return true;
+	}
+	core::DynamicArray<int> remove;
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		for (int nodeId : _skippedNodes) {
+			if (node.reference() == nodeId) {
+				remove.push_back(node.id());
+				break;
+			}
+		}
+	}
+	remove.append(_skippedNodes.data(), _skippedNodes.size());
+	for (int nodeId : remove) {
+		if (!sceneGraph.removeNode(nodeId, false)) {
+			Log::error("Failed to remove node %i", nodeId);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool readPaletteColors(io::ReadStream &stream, voxel::Palette &palette) {
 	uint32_t colorCount;
 	wrap(stream.readUInt32(colorCount))
 	Log::debug("Load node palette with %u color", colorCount);
@@ -222,20 +485,31 @@ bool VENGIFormat::loadNodePaletteColors(scenegraph::SceneGraph &sceneGraph, scen
 	}
 	uint32_t palettePropertyCnt;
 	wrap(stream.readUInt32(palettePropertyCnt)) // TODO: slot for further extensions
-	node.setPalette(palette);
 	return true;
 }
 
-bool VENGIFormat::loadNodePaletteIdentifier(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream) {
+static bool readPaletteIdentifier(io::ReadStream &stream, voxel::Palette &palette) {
 	core::String name;
 	wrapBool(stream.readPascalStringUInt16LE(name))
-	voxel::Palette palette;
 	Log::debug("Load node palette %s", name.c_str());
 	palette.load(name.c_str());
 	if (palette.colorCount() == 0) {
 		Log::error("Failed to load built-in palette %s", name.c_str());
 		return false;
 	}
+	return true;
+}
+
+bool VENGIFormat::loadNodePaletteColors(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream) {
+	voxel::Palette palette;
+	wrapBool(readPaletteColors(stream, palette))
+	node.setPalette(palette);
+	return true;
+}
+
+bool VENGIFormat::loadNodePaletteIdentifier(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream) {
+	voxel::Palette palette;
+	wrapBool(readPaletteIdentifier(stream, palette))
 	node.setPalette(palette);
 	return true;
 }
@@ -351,6 +625,10 @@ bool VENGIFormat::loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint3
 			if (!loadNodeData(sceneGraph, node, version, stream)) {
 				return false;
 			}
+		} else if (chunkMagic == FourCC('D','R','E','F')) {
+			if (!loadNodeDataRef(sceneGraph, node, version, stream)) {
+				return false;
+			}
 		} else if (chunkMagic == FourCC('P','A','L','C')) {
 			if (!loadNodePaletteColors(sceneGraph, node, version, stream)) {
 				return false;
@@ -376,37 +654,271 @@ bool VENGIFormat::loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint3
 	return false;
 }
 
-bool VENGIFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) {
-	wrapBool(stream.writeUInt32(FourCC('V','E','N','G')))
-	io::ZipWriteStream zipStream(stream);
-	wrapBool(zipStream.writeUInt32(3))
-	if (!saveNode(sceneGraph, zipStream, sceneGraph.root())) {
+bool VENGIFormat::loadNodeMetadata(uint32_t version, io::ReadStream &stream, FormatMetadata &metadata) {
+	ModelMetadata model;
+	wrapBool(stream.readPascalStringUInt16LE(model.name))
+	core::String type;
+	wrapBool(stream.readPascalStringUInt16LE(type))
+	bool isModel = toNodeType(type) == scenegraph::SceneGraphNodeType::Model;
+	if (version >= 2) {
+		int32_t fileNodeId;
+		int32_t referenceNodeId;
+		wrap(stream.readInt32(fileNodeId))
+		wrap(stream.readInt32(referenceNodeId))
+	}
+	// visible and locked
+	stream.readBool();
+	stream.readBool();
+	uint32_t color;
+	wrap(stream.readUInt32(color))
+	if (version >= 3) {
+		glm::vec3 pivot;
+		wrap(stream.readFloat(pivot.x))
+		wrap(stream.readFloat(pivot.y))
+		wrap(stream.readFloat(pivot.z))
+	}
+
+	voxel::Palette palette;
+	while (!stream.eos()) {
+		uint32_t chunkMagic;
+		wrap(stream.readUInt32(chunkMagic))
+		if (chunkMagic == FourCC('P','R','O','P')) {
+			uint32_t propertyCount;
+			wrap(stream.readUInt32(propertyCount))
+			for (uint32_t i = 0; i < propertyCount; ++i) {
+				core::String key, value;
+				wrapBool(stream.readPascalStringUInt16LE(key))
+				wrapBool(stream.readPascalStringUInt16LE(value))
+			}
+		} else if (chunkMagic == FourCC('D','A','T','A')) {
+			wrapBool(readRegion(stream, model.region))
+			wrapBool(skipVoxels(stream, model.region))
+		} else if (chunkMagic == FourCC('D','R','E','F')) {
+			wrapBool(readRegion(stream, model.region))
+			uint64_t offset;
+			uint32_t size;
+			wrap(stream.readUInt64(offset))
+			wrap(stream.readUInt32(size))
+		} else if (chunkMagic == FourCC('P','A','L','C')) {
+			wrapBool(readPaletteColors(stream, palette))
+		} else if (chunkMagic == FourCC('P','A','L','I')) {
+			wrapBool(readPaletteIdentifier(stream, palette))
+		} else if (chunkMagic == FourCC('A','N','I','M')) {
+			core::String animation;
+			wrapBool(stream.readPascalStringUInt16LE(animation))
+			for (;;) {
+				wrap(stream.readUInt32(chunkMagic))
+				if (chunkMagic == FourCC('E','N','D','A')) {
+					break;
+				}
+				if (chunkMagic != FourCC('K','E','Y','F')) {
+					continue;
+				}
+				int32_t frameIdx;
+				wrap(stream.readInt32(frameIdx))
+				stream.readBool();
+				core::String interpolationType;
+				wrapBool(stream.readPascalStringUInt16LE(interpolationType))
+				const int floats = version <= 2 ? 16 + 3 : 16;
+				for (int i = 0; i < floats; ++i) {
+					float val;
+					wrap(stream.readFloat(val))
+				}
+			}
+		} else if (chunkMagic == FourCC('N','O','D','E')) {
+			if (isModel) {
+				// keep the order of the nodes
+				metadata.models.push_back(model);
+				if (metadata.models.size() == 1) {
+					metadata.palette = palette;
+				}
+				isModel = false;
+			}
+			if (!loadNodeMetadata(version, stream, metadata)) {
+				return false;
+			}
+		} else if (chunkMagic == FourCC('E','N','D','N')) {
+			if (isModel) {
+				metadata.models.push_back(model);
+				if (metadata.models.size() == 1) {
+					metadata.palette = palette;
+				}
+			}
+			return true;
+		}
+	}
+	Log::error("ENDN magic is missing");
+	return false;
+}
+
+bool VENGIFormat::saveThumbnail(const scenegraph::SceneGraph &sceneGraph, io::WriteStream &stream, const SaveContext &savectx) {
+	ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(128);
+	const image::ImagePtr &image = createThumbnail(sceneGraph, savectx.thumbnailCreator, ctx);
+	if (!image || !image->isLoaded()) {
+		return true;
+	}
+	io::BufferedReadWriteStream png((int64_t)(image->width() * image->height() * 4));
+	if (!image->writePng(png)) {
+		Log::warn("Failed to write the thumbnail");
+		return true;
+	}
+	wrapBool(stream.writeUInt32(FourCC('T','H','M','B')))
+	wrapBool(stream.writeUInt32((uint32_t)png.size()))
+	if (stream.write(png.getBuffer(), (size_t)png.size()) == -1) {
 		return false;
 	}
 	return true;
 }
 
-bool VENGIFormat::loadGroups(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const LoadContext &ctx) {
+bool VENGIFormat::skipThumbnail(io::ReadStream &stream, uint32_t &chunkMagic) {
+	if (chunkMagic != FourCC('T','H','M','B')) {
+		return true;
+	}
+	uint32_t size;
+	wrap(stream.readUInt32(size))
+	uint8_t buf[4096];
+	while (size > 0) {
+		const uint32_t n = core_min(size, (uint32_t)sizeof(buf));
+		if (stream.read(buf, n) != (int)n) {
+			return false;
+		}
+		size -= n;
+	}
+	wrap(stream.readUInt32(chunkMagic))
+	return true;
+}
+
+/**
+ * @brief Reads the magic and - since version 5 - the uncompressed version and the compressed size of the node tree
+ *
+ * @param[out] version @c 0 for the versions before 5 - the version is the first value of the compressed stream then
+ * @param[out] treeSize The compressed size of the node tree or @c -1 if it's unknown
+ * @note The stream is located at the start of the compressed node tree afterwards
+ */
+static bool readHeader(io::SeekableReadStream &stream, uint32_t &version, int &treeSize) {
 	uint32_t magic;
 	wrap(stream.readUInt32(magic))
 	if (magic != FourCC('V','E','N','G')) {
 		Log::error("Invalid magic");
 		return false;
 	}
-	io::ZipReadStream zipStream(stream);
+	wrap(stream.readUInt32(version))
+	if (version < IndexedVersion || version > 0xFF) {
+		// the older versions directly start with the zlib stream
+		version = 0;
+		treeSize = -1;
+		wrap(stream.seek(-4, SEEK_CUR))
+		return true;
+	}
+	uint32_t size;
+	wrap(stream.readUInt32(size))
+	treeSize = (int)size;
+	return true;
+}
+
+image::ImagePtr VENGIFormat::loadScreenshot(const core::String &filename, io::SeekableReadStream &stream, const LoadContext &ctx) {
 	uint32_t version;
-	wrap(zipStream.readUInt32(version))
-	if (version > 3) {
+	int treeSize;
+	if (!readHeader(stream, version, treeSize)) {
+		return image::ImagePtr();
+	}
+	io::ZipReadStream zipStream(stream, treeSize);
+	if (version == 0 && zipStream.readUInt32(version) != 0) {
+		return image::ImagePtr();
+	}
+	uint32_t chunkMagic;
+	if (zipStream.readUInt32(chunkMagic) != 0) {
+		return image::ImagePtr();
+	}
+	uint32_t size;
+	if (version < 4 || chunkMagic != FourCC('T','H','M','B') || zipStream.readUInt32(size) != 0) {
+		Log::debug("No embedded thumbnail found in %s", filename.c_str());
+		return image::ImagePtr();
+	}
+	core::DynamicArray<uint8_t> png;
+	png.resize(size);
+	if (zipStream.read(png.data(), size) != (int)size) {
+		Log::error("Failed to read the thumbnail");
+		return image::ImagePtr();
+	}
+	image::ImagePtr img = image::createEmptyImage(core::string::extractFilename(filename) + ".png");
+	if (!img->load(png.data(), (int)size)) {
+		return image::ImagePtr();
+	}
+	return img;
+}
+
+bool VENGIFormat::saveNodeTree(const scenegraph::SceneGraph &sceneGraph, const CompressedNodeDataMap &nodeData,
+							   io::SeekableWriteStream &stream, const SaveContext &ctx) {
+	io::BufferedReadWriteStream tree;
+	{
+		io::ZipWriteStream zipStream(tree);
+		wrapBool(saveThumbnail(sceneGraph, zipStream, ctx))
+		wrapBool(saveNode(sceneGraph, zipStream, sceneGraph.root(), nodeData))
+		wrapBool(zipStream.flush())
+	}
+	wrapBool(stream.writeUInt32((uint32_t)tree.size()))
+	if (stream.write(tree.getBuffer(), (size_t)tree.size()) == -1) {
+		Log::error("Failed to write the node tree");
+		return false;
+	}
+	// same order as the offsets were assigned in compressNodeData()
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Model); iter != sceneGraph.end(); ++iter) {
+		CompressedNodeData *data = nullptr;
+		if (!nodeData.get((*iter).id(), data)) {
+			return false;
+		}
+		const core::DynamicArray<uint8_t> &bytes = data->bytes();
+		if (stream.write(bytes.data(), bytes.size()) == -1) {
+			Log::error("Failed to write the voxel data of node %i", (*iter).id());
+			return false;
+		}
+	}
+	return true;
+}
+
+bool VENGIFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core::String &filename, io::SeekableWriteStream& stream, const SaveContext &ctx) {
+	wrapBool(stream.writeUInt32(FourCC('V','E','N','G')))
+	wrapBool(stream.writeUInt32(CurrentVersion))
+	CompressedNodeDataMap nodeData;
+	const bool success = compressNodeData(sceneGraph, nodeData) && saveNodeTree(sceneGraph, nodeData, stream, ctx);
+	if (success && _nodeDataCache != nullptr) {
+		updateNodeDataCache(nodeData);
+	}
+	releaseCompressedNodeData(nodeData);
+	return success;
+}
+
+bool VENGIFormat::loadGroups(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, const LoadContext &ctx) {
+	uint32_t version;
+	int treeSize;
+	wrapBool(readHeader(stream, version, treeSize))
+	const int64_t treeStart = stream.pos();
+	io::ZipReadStream zipStream(stream, treeSize);
+	if (version == 0) {
+		wrap(zipStream.readUInt32(version))
+	}
+	if (version > CurrentVersion) {
 		Log::error("Unsupported version %u", version);
 		return false;
 	}
+	_nodeDataRefs.clear();
+	_skippedNodes.clear();
+	_loadCtx = &ctx;
+	_modelIndex = 0;
+	_dataStart = treeStart + treeSize;
 	uint32_t chunkMagic;
 	wrap(zipStream.readUInt32(chunkMagic))
+	wrapBool(skipThumbnail(zipStream, chunkMagic))
 	NodeMapping nodeMapping;
 	if (chunkMagic == FourCC('N','O','D','E')) {
 		if (!loadNode(sceneGraph, sceneGraph.root().id(), version, zipStream, nodeMapping)) {
 			return false;
 		}
+		if (!loadNodeDataRefs(stream, _dataStart, sceneGraph)) {
+			return false;
+		}
 		for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end(); ++iter) {
 			scenegraph::SceneGraphNode &node = *iter;
 			int nodeId;
@@ -417,6 +929,9 @@ bool VENGIFormat::loadGroups(const core::String &filename, io::SeekableReadStrea
 			Log::debug("Update node reference for node %i to: %i", node.id(), nodeId);
 			node.setReference(nodeId);
 		}
+		if (!removeSkippedNodes(sceneGraph)) {
+			return false;
+		}
 		sceneGraph.updateTransforms();
 		return true;
 	}
@@ -424,6 +939,72 @@ bool VENGIFormat::loadGroups(const core::String &filename, io::SeekableReadStrea
 	return false;
 }
 
+bool VENGIFormat::loadModels(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
+							 const core::DynamicArray<core::String> &modelNames, const LoadContext &ctx) {
+	_modelNames = &modelNames;
+	const bool success = loadGroups(filename, stream, sceneGraph, ctx);
+	_modelNames = nullptr;
+	return success;
+}
+
+bool VENGIFormat::saveIncremental(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
+								  io::SeekableWriteStream &stream, NodeDataCache &cache, const SaveContext &ctx) {
+	_nodeDataCache = &cache;
+	const bool success = save(sceneGraph, filename, stream, ctx);
+	_nodeDataCache = nullptr;
+	return success;
+}
+
+bool VENGIFormat::loadVisibleModels(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
+									NodeDataLocations &hiddenNodes, const LoadContext &ctx) {
+	_hiddenNodes = &hiddenNodes;
+	const bool success = loadGroups(filename, stream, sceneGraph, ctx);
+	_hiddenNodes = nullptr;
+	return success;
+}
+
+voxel::RawVolume *VENGIFormat::loadNodeVolume(io::SeekableReadStream &stream, const NodeDataLocation &location,
+											  const voxel::Palette &palette) {
+	if (stream.seek(location.offset) == -1) {
+		Log::error("Failed to seek to the voxel data at %i", (int)location.offset);
+		return nullptr;
+	}
+	core::DynamicArray<uint8_t> compressed;
+	compressed.resize(location.size);
+	if (stream.read(compressed.data(), location.size) != (int)location.size) {
+		Log::error("Failed to read the voxel data at %i", (int)location.offset);
+		return nullptr;
+	}
+	voxel::RawVolume *v = new voxel::RawVolume(location.region);
+	if (!uncompressVoxels(compressed, *v, palette)) {
+		delete v;
+		return nullptr;
+	}
+	return v;
+}
+
+bool VENGIFormat::loadMetadata(const core::String &filename, io::SeekableReadStream &stream, FormatMetadata &metadata, const LoadContext &ctx) {
+	uint32_t version;
+	int treeSize;
+	wrapBool(readHeader(stream, version, treeSize))
+	io::ZipReadStream zipStream(stream, treeSize);
+	if (version == 0) {
+		wrap(zipStream.readUInt32(version))
+	}
+	if (version > CurrentVersion) {
+		Log::error("Unsupported version %u", version);
+		return false;
+	}
+	uint32_t chunkMagic;
+	wrap(zipStream.readUInt32(chunkMagic))
+	wrapBool(skipThumbnail(zipStream, chunkMagic))
+	if (chunkMagic != FourCC('N','O','D','E')) {
+		Log::error("Unknown chunk magic");
+		return false;
+	}
+	return loadNodeMetadata(version, zipStream, metadata);
+}
+
 #undef wrap
 #undef wrapBool
 
@@ -5,6 +5,7 @@
 #pragma once
 
 #include "Format.h"
+#include "core/SharedPtr.h"
 #include "voxel/RawVolume.h"
 #include "scenegraph/SceneGraphNode.h"
 
@@ -15,31 +16,176 @@ namespace voxelformat {
  * with animation and (lua-)script support.
  *
  * It's a RIFF header based format. It stores one palette per model node.
+ *
+ * Since version 5 the voxel data of each model node is compressed on its own and stored behind the compressed
+ * node tree. The node tree only references the data by offset and size - this allows to read the node tree without
+ * decompressing any voxels, to decompress the model nodes in parallel and to only load some of the model nodes.
  */
 class VENGIFormat : public Format {
+public:
+	/**
+	 * @brief The location of the compressed voxels of a model node in the stream (version 5 and later)
+	 */
+	struct NodeDataLocation {
+		voxel::Region region;
+		int64_t offset = 0;
+		uint32_t size = 0;
+	};
+	using NodeDataLocations = core::Map<int, NodeDataLocation>;
+
+	/**
+	 * @brief The compressed voxels of a model node from a previous save
+	 *
+	 * The entry is only reused if the region of the node volume didn't change - the caller must remove the entry
+	 * once the voxels of the node are modified. The entries are not modified after they were created and can be
+	 * shared between threads.
+	 */
+	struct CachedNodeData {
+		voxel::Region region;
+		core::DynamicArray<uint8_t> data;
+	};
+	using NodeDataCache = core::Map<int, core::SharedPtr<CachedNodeData>>;
+
 private:
 	using NodeMapping = core::Map<int, int>;
 
+	/**
+	 * @brief The zlib compressed voxels of one model node
+	 */
+	struct CompressedNodeData {
+		const voxel::RawVolume *volume = nullptr;
+		core::DynamicArray<uint8_t> data;
+		/**
+		 * @brief Set if the data of a previous save is reused
+		 */
+		core::SharedPtr<CachedNodeData> cached;
+		uint64_t offset = 0;
+		bool success = false;
+
+		inline const core::DynamicArray<uint8_t> &bytes() const {
+			return cached ? cached->data : data;
+		}
+	};
+	using CompressedNodeDataMap = core::Map<int, CompressedNodeData *>;
+	/**
+	 * @brief If not @c null the compressed voxels of the unchanged model nodes are taken from here
+	 */
+	NodeDataCache *_nodeDataCache = nullptr;
+
+	/**
+	 * @brief A model node whose voxels are stored outside of the node tree (version 5 and later)
+	 */
+	struct NodeDataRef {
+		int nodeId;
+		uint64_t offset;
+		uint32_t size;
+	};
+	core::DynamicArray<NodeDataRef> _nodeDataRefs;
+	/**
+	 * @brief If not @c null only the model nodes with these names are loaded
+	 */
+	const core::DynamicArray<core::String> *_modelNames = nullptr;
+	/**
+	 * @brief The context of the current load - for LoadContext::acceptModel(). Only valid while loadGroups() runs.
+	 */
+	const LoadContext *_loadCtx = nullptr;
+	/**
+	 * @brief The index of the next model node in the order of the file
+	 */
+	int _modelIndex = 0;
+	/**
+	 * @brief The ids of the model nodes that are removed after the node tree was loaded
+	 */
+	core::DynamicArray<int> _skippedNodes;
+	/**
+	 * @brief If not @c null the hidden model nodes are not loaded - but their locations are put into this map
+	 */
+	NodeDataLocations *_hiddenNodes = nullptr;
+	/**
+	 * @brief The stream position where the compressed voxels of the model nodes start
+	 */
+	int64_t _dataStart = 0;
+
+	bool compressNodeData(const scenegraph::SceneGraph &sceneGraph, CompressedNodeDataMap &nodeData);
+	void updateNodeDataCache(const CompressedNodeDataMap &nodeData);
+	static void releaseCompressedNodeData(CompressedNodeDataMap &nodeData);
+	bool loadNodeDataRefs(io::SeekableReadStream &stream, int64_t dataStart, scenegraph::SceneGraph &sceneGraph);
+	bool removeSkippedNodes(scenegraph::SceneGraph &sceneGraph);
+	/**
+	 * @brief Decides whether the voxels of the given model node are loaded - the skipped nodes are removed once the
+	 * node tree is loaded
+	 * @note Call this exactly once per model node
+	 */
+	bool skipModel(const scenegraph::SceneGraphNode &node, const voxel::Region &region);
+
 	bool saveNodeProperties(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, io::WriteStream &stream);
-	bool saveNodeData(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, io::WriteStream &stream);
+	bool saveNodeData(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, const CompressedNodeDataMap &nodeData, io::WriteStream &stream);
 	bool saveAnimation(const scenegraph::SceneGraphNode &node, const core::String &animation, io::WriteStream &stream);
 	bool saveNodeKeyFrame(const scenegraph::SceneGraphKeyFrame &keyframe, io::WriteStream &stream);
 	bool saveNodePaletteColors(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, io::WriteStream &stream);
 	bool saveNodePaletteIdentifier(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, io::WriteStream &stream);
-	bool saveNode(const scenegraph::SceneGraph &sceneGraph, io::WriteStream &stream, const scenegraph::SceneGraphNode &node);
+	bool saveNode(const scenegraph::SceneGraph &sceneGraph, io::WriteStream &stream, const scenegraph::SceneGraphNode &node,
+				  const CompressedNodeDataMap &nodeData);
+	bool saveThumbnail(const scenegraph::SceneGraph &sceneGraph, io::WriteStream &stream, const SaveContext &ctx);
+	bool skipThumbnail(io::ReadStream &stream, uint32_t &chunkMagic);
+	bool saveNodeTree(const scenegraph::SceneGraph &sceneGraph, const CompressedNodeDataMap &nodeData,
+					  io::SeekableWriteStream &stream, const SaveContext &ctx);
 
 	bool loadNodeProperties(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream);
 	bool loadNodeData(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream);
+	bool loadNodeDataRef(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream);
 	bool loadAnimation(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream);
 	bool loadNodeKeyFrame(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream);
 	bool loadNodePaletteColors(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream);
 	bool loadNodePaletteIdentifier(scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, uint32_t version, io::ReadStream &stream);
 	bool loadNode(scenegraph::SceneGraph &sceneGraph, int parent, uint32_t version, io::ReadStream &stream, NodeMapping &nodeMapping);
+	bool loadNodeMetadata(uint32_t version, io::ReadStream &stream, FormatMetadata &metadata);
 
 protected:
 	bool saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename, io::SeekableWriteStream &stream,
 					const SaveContext &ctx) override;
 	bool loadGroups(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx) override;
+public:
+	/**
+	 * @brief Since version 4 a png thumbnail is stored in front of the node tree
+	 */
+	image::ImagePtr loadScreenshot(const core::String &filename, io::SeekableReadStream &stream, const LoadContext &ctx) override;
+	/**
+	 * @brief Reads the node tree without creating any volumes
+	 * @note Before version 5 the voxel data is not size prefixed and must still be decompressed to find the next chunk
+	 */
+	bool loadMetadata(const core::String &filename, io::SeekableReadStream &stream, FormatMetadata &metadata, const LoadContext &ctx) override;
+	/**
+	 * @brief Loads the node tree, but only the model nodes with the given names
+	 *
+	 * The voxels of the other model nodes are not decompressed (version 5 and later). These nodes are removed from
+	 * the scene graph - their children are attached to their parent. Model references to them are removed, too.
+	 */
+	bool loadModels(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
+					const core::DynamicArray<core::String> &modelNames, const LoadContext &ctx);
+	/**
+	 * @brief Loads the node tree, but doesn't decompress the voxels of the hidden model nodes
+	 *
+	 * The hidden model nodes get an empty placeholder volume - the location of their voxels is returned in
+	 * @c hiddenNodes and can be loaded later with loadNodeVolume(). The model nodes of files before version 5 are
+	 * always loaded.
+	 */
+	bool loadVisibleModels(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph,
+						   NodeDataLocations &hiddenNodes, const LoadContext &ctx);
+	/**
+	 * @brief Saves the scene graph, but only compresses the voxels of the model nodes that are not in the given cache
+	 *
+	 * The cache is keyed by node id. After a successful save it contains the compressed voxels of exactly the saved
+	 * model nodes - so it can be passed to the next save of the same scene graph.
+	 */
+	bool saveIncremental(const scenegraph::SceneGraph &sceneGraph, const core::String &filename,
+						 io::SeekableWriteStream &stream, NodeDataCache &cache, const SaveContext &ctx);
+	/**
+	 * @brief Creates the volume for a model node that was skipped by loadVisibleModels()
+	 * @return @c nullptr on error
+	 */
+	static voxel::RawVolume *loadNodeVolume(io::SeekableReadStream &stream, const NodeDataLocation &location,
+											const voxel::Palette &palette);
 };
 
 } // namespace voxelformat
@@ -482,6 +482,20 @@ bool VXMFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 		} else {
 			core::string::formatBuf(layerName, sizeof(layerName), "Layer %i", layer);
 		}
+		if (!ctx.acceptModel(layer, layerName, region)) {
+			// the rle data has no size - walk it without filling a volume
+			Log::debug("Skip layer %s", layerName);
+			for (;;) {
+				uint8_t length;
+				wrap(stream.readUInt8(length));
+				if (length == 0u) {
+					break;
+				}
+				uint8_t matIdx;
+				wrap(stream.readUInt8(matIdx));
+			}
+			continue;
+		}
 		voxel::RawVolume* volume = new voxel::RawVolume(region);
 		for (;;) {
 			uint8_t length;
@@ -9,6 +9,8 @@
 #include "core/FourCC.h"
 #include "core/GLM.h"
 #include "core/Log.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
 #include "app/App.h"
 #include "VXMFormat.h"
 #include "core/StringUtil.h"
@@ -158,19 +160,47 @@ bool VXRFormat::saveGroups(const scenegraph::SceneGraph& sceneGraph, const core:
 	return true;
 }
 
-bool VXRFormat::loadChildVXM(const core::String& vxmPath, scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, int version, const LoadContext &ctx) {
-	const io::FilePtr& file = io::filesystem()->open(vxmPath);
-	if (!file->validHandle()) {
-		Log::error("Could not open file '%s'", vxmPath.c_str());
-		return false;
+void VXRFormat::loadChildVXMs(const core::DynamicArray<core::String> &vxmPaths, ChildVXMs &childVXMs, const LoadContext &ctx) {
+	core_trace_scoped(LoadChildVXMs);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	core::DynamicArray<std::future<scenegraph::SceneGraph>> futures;
+	for (const core::String &vxmPath : vxmPaths) {
+		int idx;
+		if (childVXMs.indices.get(vxmPath, idx)) {
+			++childVXMs.references[idx];
+			continue;
+		}
+		childVXMs.indices.put(vxmPath, (int)futures.size());
+		childVXMs.references.push_back(1);
+		futures.emplace_back(threadPool.enqueue([vxmPath, &ctx]() {
+			scenegraph::SceneGraph childSceneGraph;
+			const io::FilePtr &file = io::filesystem()->open(vxmPath);
+			if (!file->validHandle()) {
+				Log::error("Could not open file '%s'", vxmPath.c_str());
+				return core::move(childSceneGraph);
+			}
+			io::FileStream stream(file);
+			VXMFormat f;
+			if (!f.load(vxmPath, stream, childSceneGraph, ctx)) {
+				Log::error("Failed to load '%s'", vxmPath.c_str());
+				childSceneGraph.clear();
+			}
+			return core::move(childSceneGraph);
+		}));
 	}
-	io::FileStream stream(file);
-	VXMFormat f;
-	scenegraph::SceneGraph childSceneGraph;
-	if (!f.load(vxmPath, stream, childSceneGraph, ctx)) {
-		Log::error("Failed to load '%s'", vxmPath.c_str());
+	Log::debug("Load %i vxm files for %i references", (int)futures.size(), (int)vxmPaths.size());
+	childVXMs.sceneGraphs = core::DynamicArray<scenegraph::SceneGraph>(futures.size());
+	for (size_t i = 0; i < futures.size(); ++i) {
+		childVXMs.sceneGraphs[i] = futures[i].get();
+	}
+}
+
+bool VXRFormat::attachChildVXM(ChildVXMs &childVXMs, const core::String &vxmPath, scenegraph::SceneGraphNode &node, int version) {
+	int idx;
+	if (!childVXMs.indices.get(vxmPath, idx)) {
 		return false;
 	}
+	scenegraph::SceneGraph &childSceneGraph = childVXMs.sceneGraphs[idx];
 	const int modelCount = (int)childSceneGraph.size(scenegraph::SceneGraphNodeType::Model);
 	if (modelCount < 1) {
 		Log::error("No models found in vxm file: %i", modelCount);
@@ -180,11 +210,16 @@ bool VXRFormat::loadChildVXM(const core::String& vxmPath, scenegraph::SceneGraph
 
 	scenegraph::SceneGraphNode* childModelNode = childSceneGraph[0];
 	core_assert_always(childModelNode != nullptr);
-	childModelNode->releaseOwnership();
 
 	const core::String nodeName = node.name();
 	scenegraph::copyNode(*childModelNode, node, false, version >= 3);
-	node.setVolume(childModelNode->volume(), true);
+	if (--childVXMs.references[idx] == 0) {
+		// the last node that references the vxm file takes over the volume
+		childModelNode->releaseOwnership();
+		node.setVolume(childModelNode->volume(), true);
+	} else {
+		node.setVolume(new voxel::RawVolume(childModelNode->volume()), true);
+	}
 	// restore old name
 	node.setName(nodeName);
 
@@ -300,20 +335,16 @@ bool VXRFormat::importChildVersion3AndEarlier(const core::String &filename, io::
 }
 
 // the positions that were part of the previous vxr versions are now in vxa
-bool VXRFormat::importChild(const core::String& vxmPath, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, int version, int parent, const LoadContext &ctx) {
-	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+bool VXRFormat::importChild(const core::String& vxmPath, io::SeekableReadStream& stream, core::DynamicArray<ChildNode>& childNodes, int version, int parent, const LoadContext &ctx) {
+	ChildNode child;
+	child.parent = parent;
+	scenegraph::SceneGraphNode &node = child.node;
 	char id[1024];
 	wrapBool(stream.readString(sizeof(id), id, true))
 	char filename[1024];
 	wrapBool(stream.readString(sizeof(filename), filename, true))
 	if (filename[0] != '\0') {
-		const core::String modelPath = core::string::path(core::string::extractPath(vxmPath), filename);
-		if (!loadChildVXM(modelPath, sceneGraph, node, version, ctx)) {
-			Log::warn("Failed to attach model for id '%s' with filename %s (%s)", id, filename, modelPath.c_str());
-		}
-	}
-	if (node.volume() == nullptr) {
-		node = scenegraph::SceneGraphNode(scenegraph::SceneGraphNodeType::Group);
+		child.vxmPath = core::string::path(core::string::extractPath(vxmPath), filename);
 	}
 	node.setName(id);
 	node.setProperty("id", id);
@@ -370,12 +401,13 @@ bool VXRFormat::importChild(const core::String& vxmPath, io::SeekableReadStream&
 			stream.readBool(); /* z clock wise allowed */
 		}
 	}
-	const int nodeId = sceneGraph.emplace(core::move(node), parent);
+	const int childIdx = (int)childNodes.size();
+	childNodes.emplace_back(core::move(child));
 	if (version >= 4) {
 		int32_t children = 0;
 		wrap(stream.readInt32(children))
 		for (int32_t i = 0; i < children; ++i) {
-			wrapBool(importChild(vxmPath, stream, sceneGraph, version, nodeId != -1 ? nodeId : parent, ctx))
+			wrapBool(importChild(vxmPath, stream, childNodes, version, childIdx, ctx))
 		}
 	}
 	return true;
@@ -397,6 +429,8 @@ bool VXRFormat::loadGroupsVersion3AndEarlier(const core::String &filename, io::S
 	}
 	int32_t modelCount;
 	wrap(stream.readInt32(modelCount))
+	core::DynamicArray<int> modelNodeIds;
+	core::DynamicArray<core::String> vxmPaths;
 	for (int32_t i = 0; i < modelCount; ++i) {
 		char nodeId[1024];
 		wrapBool(stream.readString(sizeof(nodeId), nodeId, true))
@@ -408,10 +442,17 @@ bool VXRFormat::loadGroupsVersion3AndEarlier(const core::String &filename, io::S
 		char vxmFilename[1024];
 		wrapBool(stream.readString(sizeof(vxmFilename), vxmFilename, true))
 		if (vxmFilename[0] != '\0') {
-			const core::String modelPath = core::string::path(core::string::extractPath(filename), vxmFilename);
-			if (!loadChildVXM(modelPath, sceneGraph, *node, version, ctx)) {
-				Log::warn("Failed to attach model for %s with filename %s", nodeId, modelPath.c_str());
-			}
+			modelNodeIds.push_back(node->id());
+			vxmPaths.push_back(core::string::path(core::string::extractPath(filename), vxmFilename));
+		}
+	}
+
+	ChildVXMs childVXMs;
+	loadChildVXMs(vxmPaths, childVXMs, ctx);
+	for (size_t i = 0; i < vxmPaths.size(); ++i) {
+		scenegraph::SceneGraphNode &node = sceneGraph.node(modelNodeIds[i]);
+		if (!attachChildVXM(childVXMs, vxmPaths[i], node, version)) {
+			Log::warn("Failed to attach model for %s with filename %s", node.name().c_str(), vxmPaths[i].c_str());
 		}
 	}
 
@@ -476,8 +517,41 @@ bool VXRFormat::loadGroupsVersion4AndLater(const core::String &filename, io::See
 	}
 
 	Log::debug("Found %i children", children);
+	core::DynamicArray<ChildNode> childNodes;
 	for (int32_t i = 0; i < children; ++i) {
-		wrapBool(importChild(filename, stream, sceneGraph, version, rootNodeId, ctx))
+		wrapBool(importChild(filename, stream, childNodes, version, -1, ctx))
+	}
+
+	core::DynamicArray<core::String> vxmPaths;
+	for (const ChildNode &child : childNodes) {
+		if (!child.vxmPath.empty()) {
+			vxmPaths.push_back(child.vxmPath);
+		}
+	}
+	ChildVXMs childVXMs;
+	loadChildVXMs(vxmPaths, childVXMs, ctx);
+
+	// the children are stored in depth first order - the parents are added before their children
+	core::DynamicArray<int> nodeIds(childNodes.size());
+	for (size_t i = 0; i < childNodes.size(); ++i) {
+		ChildNode &child = childNodes[i];
+		const int parent = child.parent == -1 ? rootNodeId : nodeIds[child.parent];
+		if (!child.vxmPath.empty()) {
+			scenegraph::SceneGraphNode model(scenegraph::SceneGraphNodeType::Model);
+			if (attachChildVXM(childVXMs, child.vxmPath, model, version)) {
+				model.setName(child.node.name());
+				model.addProperties(child.node.properties());
+				if (version >= 6) {
+					model.setColor(child.node.color());
+				}
+				child.node = core::move(model);
+			} else {
+				Log::warn("Failed to attach model for id '%s' with filename %s", child.node.name().c_str(),
+						  child.vxmPath.c_str());
+			}
+		}
+		const int nodeId = sceneGraph.emplace(core::move(child.node), parent);
+		nodeIds[i] = nodeId != -1 ? nodeId : parent;
 	}
 
 	const core::String& basePath = core::string::extractPath(filename);
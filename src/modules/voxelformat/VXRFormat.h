@@ -5,6 +5,10 @@
 #pragma once
 
 #include "Format.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
 
 namespace voxelformat {
 
@@ -19,11 +23,36 @@ namespace voxelformat {
  */
 class VXRFormat : public PaletteFormat {
 private:
+	/**
+	 * @brief The scene graphs of the vxm files that are referenced by the vxr file
+	 */
+	struct ChildVXMs {
+		/** index into the scene graphs for each vxm path */
+		core::StringMap<int> indices;
+		core::DynamicArray<scenegraph::SceneGraph> sceneGraphs;
+		/** the amount of nodes that still have to get the model of the vxm file */
+		core::DynamicArray<int> references;
+	};
+
+	/**
+	 * @brief A node of the vxr file - the nodes are only added to the scene graph after the vxm files were loaded
+	 */
+	struct ChildNode {
+		scenegraph::SceneGraphNode node{scenegraph::SceneGraphNodeType::Group};
+		core::String vxmPath;
+		/** the index of the parent in the child nodes or @c -1 for the root node */
+		int parent = -1;
+	};
+
 	bool onlyOnePalette() override { return false; }
-	bool loadChildVXM(const core::String& vxmPath, scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, int version, const LoadContext &ctx);
+	/**
+	 * @brief Loads the given vxm files in parallel - files that are referenced several times are only loaded once
+	 */
+	void loadChildVXMs(const core::DynamicArray<core::String> &vxmPaths, ChildVXMs &childVXMs, const LoadContext &ctx);
+	bool attachChildVXM(ChildVXMs &childVXMs, const core::String &vxmPath, scenegraph::SceneGraphNode &node, int version);
 
 	bool handleVersion8AndLater(io::SeekableReadStream& stream, scenegraph::SceneGraphNode &node, const LoadContext &ctx);
-	bool importChild(const core::String& vxmPath, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, int version, int parent, const LoadContext &ctx);
+	bool importChild(const core::String& vxmPath, io::SeekableReadStream& stream, core::DynamicArray<ChildNode>& childNodes, int version, int parent, const LoadContext &ctx);
 
 	bool loadGroupsVersion4AndLater(const core::String &filename, io::SeekableReadStream& stream, scenegraph::SceneGraph& sceneGraph, int version, const LoadContext &ctx);
 
@@ -3,10 +3,13 @@
  */
 
 #include "VolumeFormat.h"
+#include "core/ArenaAllocator.h"
 #include "app/App.h"
 #include "core/ArrayLength.h"
 #include "core/FourCC.h"
 #include "core/Log.h"
+#include "core/Memory.h"
+#include "core/Metrics.h"
 #include "core/SharedPtr.h"
 #include "core/StringUtil.h"
 #include "core/Trace.h"
@@ -70,7 +73,7 @@ io::FormatDescription qubicleBinaryTree() {
 }
 
 io::FormatDescription vengi() {
-	return {"Vengi", {"vengi"}, [] (uint32_t magic) {return magic == FourCC('V','E', 'N','G');}, VOX_FORMAT_FLAG_PALETTE_EMBEDDED};
+	return {"Vengi", {"vengi"}, [] (uint32_t magic) {return magic == FourCC('V','E', 'N','G');}, VOX_FORMAT_FLAG_PALETTE_EMBEDDED | VOX_FORMAT_FLAG_SCREENSHOT_EMBEDDED};
 }
 
 const io::FormatDescription* voxelLoad() {
@@ -148,7 +151,7 @@ const io::FormatDescription* voxelSave() {
 		//{"Minecraft schematic", {"schematic", "schem", "nbt"}, nullptr, 0u},
 		{"Wavefront Object", {"obj"}, nullptr, VOX_FORMAT_FLAG_MESH},
 		{"Polygon File Format", {"ply"}, nullptr, VOX_FORMAT_FLAG_MESH},
-		{"FBX Ascii", {"fbx"}, nullptr, VOX_FORMAT_FLAG_MESH},
+		{"FBX", {"fbx"}, nullptr, VOX_FORMAT_FLAG_MESH},
 		{"Standard Triangle Language", {"stl"}, nullptr, VOX_FORMAT_FLAG_MESH},
 		{"GLTF Binary", {"glb"}, nullptr, VOX_FORMAT_FLAG_MESH},
 		{"GLTF Text", {"gltf"}, nullptr, VOX_FORMAT_FLAG_MESH},
@@ -157,6 +160,13 @@ const io::FormatDescription* voxelSave() {
 	return desc;
 }
 
+/**
+ * @return The name of the metric with the format as label - e.g. voxformat_load_seconds{format="Magicavoxel"}
+ */
+static core::String formatMetric(const char *name, const io::FormatDescription &desc) {
+	return core::string::format("%s{format=\"%s\"}", name, desc.name.c_str());
+}
+
 static uint32_t loadMagic(io::SeekableReadStream &stream) {
 	uint32_t magicWord = 0u;
 	stream.peekUInt32(magicWord);
@@ -345,8 +355,30 @@ size_t loadPalette(const core::String &filename, io::SeekableReadStream &stream,
 	return 0;
 }
 
+bool loadMetadata(const core::String &filename, io::SeekableReadStream &stream, FormatMetadata &metadata, const LoadContext &ctx) {
+	core_trace_scoped(LoadVolumeMetadata);
+	const uint32_t magic = loadMagic(stream);
+	const io::FormatDescription *desc = getDescription(filename, magic);
+	if (desc == nullptr) {
+		return false;
+	}
+	const core::SharedPtr<Format> &f = getFormat(*desc, magic, true);
+	if (!f) {
+		Log::error("Failed to load model metadata from file %s - unsupported file format", filename.c_str());
+		return false;
+	}
+	stream.seek(0);
+	if (!f->loadMetadata(filename, stream, metadata, ctx)) {
+		Log::error("Error while loading the metadata of %s", filename.c_str());
+		return false;
+	}
+	metadata.palette.markDirty();
+	return true;
+}
+
 bool loadFormat(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &newSceneGraph, const LoadContext &ctx) {
 	core_trace_scoped(LoadVolumeFormat);
+	core_memory_scope(Format);
 	const uint32_t magic = loadMagic(stream);
 	const io::FormatDescription *desc = getDescription(filename, magic);
 	if (desc == nullptr) {
@@ -354,7 +386,22 @@ bool loadFormat(const core::String &filename, io::SeekableReadStream &stream, sc
 	}
 	const core::SharedPtr<Format> &f = getFormat(*desc, magic, true);
 	if (f) {
-		if (!f->load(filename, stream, newSceneGraph, ctx)) {
+		// the transient allocations of the parsers are released at once at the end of the load
+		core::ArenaAllocator arena;
+		LoadContext loadCtx = ctx;
+		if (loadCtx.arena == nullptr) {
+			loadCtx.arena = &arena;
+		}
+		bool loaded;
+		{
+			core::MetricTimer timer(core::metrics::histogram(formatMetric("voxformat_load_seconds", *desc),
+															 "The time to load a scene per format"));
+			loaded = f->load(filename, stream, newSceneGraph, loadCtx);
+		}
+		if (arena.peak() > 0u) {
+			Log::debug("Used %i bytes of transient memory to load %s", (int)arena.peak(), filename.c_str());
+		}
+		if (!loaded) {
 			Log::error("Error while loading %s", filename.c_str());
 			newSceneGraph.clear();
 		}
@@ -364,6 +411,7 @@ bool loadFormat(const core::String &filename, io::SeekableReadStream &stream, sc
 	}
 	if (newSceneGraph.empty()) {
 		Log::error("Failed to load model file %s. Scene graph doesn't contain models.", filename.c_str());
+		core::metrics::counter(formatMetric("voxformat_load_errors_total", *desc), "The failed loads per format").inc();
 		return false;
 	}
 	// newSceneGraph.node(newSceneGraph.root().id()).setProperty("Type", desc->name);
@@ -397,7 +445,22 @@ bool isModelFormat(const core::String &filename) {
 	return false;
 }
 
+static bool saveFormat(Format &format, const io::FormatDescription &desc, scenegraph::SceneGraph &sceneGraph,
+					   const core::String &filename, io::SeekableWriteStream &stream, const SaveContext &ctx) {
+	core::MetricTimer timer(
+		core::metrics::histogram(formatMetric("voxformat_save_seconds", desc), "The time to save a scene per format"));
+	if (format.save(sceneGraph, filename, stream, ctx)) {
+		Log::debug("Saved file for format '%s' (ext: '%s')", desc.name.c_str(),
+				   core::string::extractExtension(filename).c_str());
+		return true;
+	}
+	Log::error("Failed to save %s file", desc.name.c_str());
+	core::metrics::counter(formatMetric("voxformat_save_errors_total", desc), "The failed saves per format").inc();
+	return false;
+}
+
 bool saveFormat(scenegraph::SceneGraph &sceneGraph, const core::String &filename, const io::FormatDescription *desc, io::SeekableWriteStream &stream, const SaveContext &ctx) {
+	core_memory_scope(Format);
 	if (sceneGraph.empty()) {
 		Log::error("Failed to save model file %s - no volumes given", filename.c_str());
 		return false;
@@ -415,24 +478,14 @@ bool saveFormat(scenegraph::SceneGraph &sceneGraph, const core::String &filename
 	if (desc != nullptr) {
 		core::SharedPtr<Format> f = getFormat(*desc, 0u, false);
 		if (f) {
-			if (f->save(sceneGraph, filename, stream, ctx)) {
-				Log::debug("Saved file for format '%s' (ext: '%s')", desc->name.c_str(), ext.c_str());
-				return true;
-			}
-			Log::error("Failed to save %s file", desc->name.c_str());
-			return false;
+			return saveFormat(*f.get(), *desc, sceneGraph, filename, stream, ctx);
 		}
 	}
 	for (desc = voxelformat::voxelSave(); desc->valid(); ++desc) {
 		if (desc->matchesExtension(ext) /*&& (type.empty() || type == desc->name)*/) {
 			core::SharedPtr<Format> f = getFormat(*desc, 0u, false);
 			if (f) {
-				if (f->save(sceneGraph, filename, stream, ctx)) {
-					Log::debug("Saved file for format '%s' (ext: '%s')", desc->name.c_str(), ext.c_str());
-					return true;
-				}
-				Log::error("Failed to save %s file", desc->name.c_str());
-				return false;
+				return saveFormat(*f.get(), *desc, sceneGraph, filename, stream, ctx);
 			}
 		}
 	}
@@ -35,6 +35,11 @@ bool importPalette(const core::String &filename, voxel::Palette &palette);
  * @brief Tries to load the embedded palette from the given file. If the format doesn't have a palette embedded, this returns @c 0
  */
 size_t loadPalette(const core::String &filename, io::SeekableReadStream &stream, voxel::Palette &palette, const LoadContext &ctx);
+/**
+ * @brief Loads the names and regions of the models and the palette without the voxel data - if the format supports it
+ * @sa Format::loadMetadata()
+ */
+bool loadMetadata(const core::String &filename, io::SeekableReadStream &stream, FormatMetadata &metadata, const LoadContext &ctx);
 image::ImagePtr loadScreenshot(const core::String &filename, io::SeekableReadStream &stream, const LoadContext &ctx);
 bool loadFormat(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, const LoadContext &ctx);
 
@@ -3,24 +3,29 @@
  */
 
 #include "VoxFormat.h"
+#include "app/App.h"
+#include "core/ArenaAllocator.h"
 #include "core/ArrayLength.h"
 #include "core/Assert.h"
 #include "core/Color.h"
 #include "core/Common.h"
 #include "core/FourCC.h"
 #include "core/GameConfig.h"
+#include "core/Hash.h"
 #include "core/Log.h"
 #include "core/StandardLib.h"
 #include "core/StringUtil.h"
+#include "core/Trace.h"
 #include "core/Var.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/ThreadPool.h"
 #include "math/Math.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Voxel.h"
 #include "scenegraph/SceneGraph.h"
 #include "scenegraph/SceneGraphNode.h"
-#include "voxelutil/VolumeVisitor.h"
 #include <SDL_endian.h>
 #define OGT_VOX_BIGENDIAN_SWAP32  SDL_SwapLE32
 #define OGT_VOX_IMPLEMENTATION
@@ -42,17 +47,48 @@ struct ogt_SceneContext {
 	int transformKeyFrameIdx = 0;
 	core::Array<ogt_vox_keyframe_transform, 4096> keyframeTransforms;
 	core::Buffer<ogt_vox_cam> cameras;
-	bool paletteErrorPrinted = false;
+	/** the node of each entry in @c models */
+	core::Buffer<const scenegraph::SceneGraphNode *> modelNodes;
 };
 
+/**
+ * The allocator of ogt_vox is global - the arena of the load context is made available to the callbacks of the
+ * loading thread
+ */
+static thread_local core::ArenaAllocator *_ogtArena = nullptr;
+
 static void *_ogt_alloc(size_t size) {
+	if (_ogtArena != nullptr) {
+		return _ogtArena->alloc(size);
+	}
 	return core_malloc(size);
 }
 
 static void _ogt_free(void *mem) {
+	if (_ogtArena != nullptr) {
+		// released at once at the end of the load
+		return;
+	}
 	core_free(mem);
 }
 
+/**
+ * @brief Lets ogt_vox allocate from the arena of the load context while this is in scope
+ * @note Everything that ogt_vox allocates in this scope must also be destroyed in this scope
+ */
+class ScopedOgtArena {
+private:
+	core::ArenaAllocator *_prev;
+
+public:
+	ScopedOgtArena(const LoadContext &ctx) : _prev(_ogtArena) {
+		_ogtArena = ctx.arena;
+	}
+	~ScopedOgtArena() {
+		_ogtArena = _prev;
+	}
+};
+
 static const ogt_vox_transform ogt_identity_transform {
 	1.0f, 0.0f, 0.0f, 0.0f,
 	0.0f, 1.0f, 0.0f, 0.0f,
@@ -102,15 +138,18 @@ VoxFormat::VoxFormat() {
 	ogt_vox_set_memory_allocator(_ogt_alloc, _ogt_free);
 }
 
-size_t VoxFormat::loadPalette(const core::String &filename, io::SeekableReadStream &stream, voxel::Palette &palette, const LoadContext &ctx) {
-	const size_t size = stream.size();
-	uint8_t *buffer = (uint8_t *)core_malloc(size);
-	if (stream.read(buffer, size) == -1) {
-		core_free(buffer);
-		return 0;
+static const ogt_vox_scene *readScene(io::SeekableReadStream &stream, uint32_t flags) {
+	// mapped files are parsed without copying them into a temporary buffer
+	io::StreamData streamData(stream);
+	if (!streamData.valid()) {
+		return nullptr;
 	}
-	const ogt_vox_scene *scene = ogt_vox_read_scene_with_flags(buffer, size, 0);
-	core_free(buffer);
+	return ogt_vox_read_scene_with_flags(streamData.data(), (uint32_t)streamData.size(), flags);
+}
+
+size_t VoxFormat::loadPalette(const core::String &filename, io::SeekableReadStream &stream, voxel::Palette &palette, const LoadContext &ctx) {
+	ScopedOgtArena scopedArena(ctx);
+	const ogt_vox_scene *scene = readScene(stream, 0);
 	if (scene == nullptr) {
 		Log::error("Could not load scene %s", filename.c_str());
 		return 0;
@@ -134,6 +173,151 @@ size_t VoxFormat::loadPalette(const core::String &filename, io::SeekableReadStre
 	return palette.size();
 }
 
+/**
+ * @brief Reads a vox dictionary and returns the value of the given key - or an empty string if the key wasn't found
+ */
+static bool readDictValue(io::SeekableReadStream &stream, const char *key, core::String &value) {
+	uint32_t entries;
+	if (stream.readUInt32(entries) != 0) {
+		return false;
+	}
+	for (uint32_t i = 0; i < entries; ++i) {
+		core::String k;
+		core::String v;
+		if (!stream.readPascalStringUInt32LE(k) || !stream.readPascalStringUInt32LE(v)) {
+			return false;
+		}
+		if (k == key) {
+			value = v;
+		}
+	}
+	return true;
+}
+
+bool VoxFormat::loadMetadata(const core::String &filename, io::SeekableReadStream &stream, FormatMetadata &metadata, const LoadContext &ctx) {
+	uint32_t magic;
+	uint32_t version;
+	if (stream.readUInt32(magic) != 0 || magic != FourCC('V', 'O', 'X', ' ') || stream.readUInt32(version) != 0) {
+		Log::error("Could not load vox file %s: Invalid header", filename.c_str());
+		return false;
+	}
+	struct Transform {
+		core::String name;
+		int32_t child = -1;
+		uint8_t rotation = 4;
+	};
+	core::DynamicArray<glm::ivec3> sizes;
+	core::DynamicArray<Transform> transforms;
+	core::Map<int32_t, int32_t> shapeModels;
+	bool paletteFound = false;
+
+	while (stream.remaining() >= 12) {
+		uint32_t chunkId;
+		uint32_t contentSize;
+		uint32_t childSize;
+		if (stream.readUInt32(chunkId) != 0 || stream.readUInt32(contentSize) != 0 || stream.readUInt32(childSize) != 0) {
+			return false;
+		}
+		if (chunkId == FourCC('M', 'A', 'I', 'N')) {
+			// the children are following directly
+			continue;
+		}
+		const int64_t contentEnd = stream.pos() + contentSize;
+		if (chunkId == FourCC('S', 'I', 'Z', 'E')) {
+			glm::ivec3 size;
+			if (stream.readInt32(size.x) != 0 || stream.readInt32(size.y) != 0 || stream.readInt32(size.z) != 0) {
+				return false;
+			}
+			sizes.push_back(size);
+		} else if (chunkId == FourCC('n', 'T', 'R', 'N')) {
+			Transform transform;
+			int32_t nodeId;
+			int32_t reserved;
+			int32_t layerId;
+			uint32_t frames;
+			if (stream.readInt32(nodeId) != 0 || !readDictValue(stream, "_name", transform.name) ||
+				stream.readInt32(transform.child) != 0 || stream.readInt32(reserved) != 0 ||
+				stream.readInt32(layerId) != 0 || stream.readUInt32(frames) != 0) {
+				return false;
+			}
+			if (frames > 0) {
+				core::String rotation;
+				if (!readDictValue(stream, "_r", rotation)) {
+					return false;
+				}
+				if (!rotation.empty()) {
+					transform.rotation = (uint8_t)rotation.toInt();
+				}
+			}
+			transforms.push_back(transform);
+		} else if (chunkId == FourCC('n', 'S', 'H', 'P')) {
+			int32_t nodeId;
+			core::String unused;
+			uint32_t models;
+			if (stream.readInt32(nodeId) != 0 || !readDictValue(stream, "", unused) || stream.readUInt32(models) != 0) {
+				return false;
+			}
+			int32_t modelId;
+			if (models > 0 && stream.readInt32(modelId) == 0) {
+				shapeModels.put(nodeId, modelId);
+			}
+		} else if (chunkId == FourCC('R', 'G', 'B', 'A')) {
+			voxel::Palette &palette = metadata.palette;
+			palette.setSize(0);
+			for (int i = 0; i < voxel::PaletteMaxColors - 1; ++i) {
+				core::RGBA color;
+				if (stream.readUInt32(color.rgba) != 0) {
+					return false;
+				}
+				palette.color(i) = color;
+				if (color.a != 0) {
+					palette.setSize(i + 1);
+				}
+			}
+			paletteFound = true;
+		}
+		if (stream.seek(contentEnd) == -1) {
+			return false;
+		}
+	}
+
+	// the rotation is stored as the indices of the non-zero entries in the first two rows
+	auto addModel = [&](const core::String &name, int32_t modelId, uint8_t rotation) {
+		if (modelId < 0 || modelId >= (int)sizes.size()) {
+			return;
+		}
+		const glm::ivec3 &size = sizes[modelId];
+		const int idx0 = rotation & 3;
+		const int idx1 = (rotation >> 2) & 3;
+		const int idx2 = 3 - idx0 - idx1;
+		if (idx0 > 2 || idx1 > 2 || idx2 < 0 || idx2 > 2) {
+			return;
+		}
+		// convert into our coordinate system - z is pointing upwards in magicavoxel
+		const glm::ivec3 rotated(size[idx0], size[idx2], size[idx1]);
+		metadata.models.push_back({name, voxel::Region(glm::ivec3(0), rotated - 1)});
+	};
+	if (transforms.empty()) {
+		for (int i = 0; i < (int)sizes.size(); ++i) {
+			addModel("", i, 4);
+		}
+	} else {
+		for (const Transform &transform : transforms) {
+			int32_t modelId;
+			if (shapeModels.get(transform.child, modelId)) {
+				addModel(transform.name, modelId, transform.rotation);
+			}
+		}
+	}
+
+	if (!paletteFound) {
+		// files without a RGBA chunk are using the default palette
+		stream.seek(0);
+		loadPalette(filename, stream, metadata.palette, ctx);
+	}
+	return true;
+}
+
 bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceIdx, scenegraph::SceneGraph &sceneGraph, int parent, const glm::mat4 &zUpMat, const voxel::Palette &palette, bool groupHidden) {
 	const ogt_vox_instance& ogtInstance = scene->instances[ogt_instanceIdx];
 	const glm::mat4 ogtMat = ogtTransformToMat(ogtInstance.transform);
@@ -149,6 +333,27 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 	voxel::Region region(glm::min(zUpMins, zUpMaxs), glm::max(zUpMins, zUpMaxs));
 	const glm::ivec3 shift = region.getLowerCorner();
 	region.shift(-shift);
+
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	const char *name = ogtInstance.name;
+	if (name == nullptr) {
+		const ogt_vox_layer &layer = scene->layers[ogtInstance.layer_index];
+		name = layer.name;
+		core::RGBA col;
+		col.r = layer.color.r;
+		col.g = layer.color.g;
+		col.b = layer.color.b;
+		col.a = layer.color.a;
+		node.setColor(col);
+		if (name == nullptr) {
+			name = "";
+		}
+	}
+	if (_loadCtx != nullptr && !_loadCtx->acceptModel(_modelIndex++, name, region)) {
+		Log::debug("Skip instance %s", name);
+		return true;
+	}
+
 	voxel::RawVolume *v = new voxel::RawVolume(region);
 	scenegraph::SceneGraphTransform transform;
 	transform.setWorldTranslation(shift);
@@ -168,21 +373,6 @@ bool VoxFormat::loadInstance(const ogt_vox_scene *scene, uint32_t ogt_instanceId
 		}
 	}
 
-	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
-	const char *name = ogtInstance.name;
-	if (name == nullptr) {
-		const ogt_vox_layer &layer = scene->layers[ogtInstance.layer_index];
-		name = layer.name;
-		core::RGBA col;
-		col.r = layer.color.r;
-		col.g = layer.color.g;
-		col.b = layer.color.b;
-		col.a = layer.color.a;
-		node.setColor(col);
-		if (name == nullptr) {
-			name = "";
-		}
-	}
 	loadKeyFrames(sceneGraph, node, ogtInstance.transform_anim.keyframes, ogtInstance.transform_anim.num_keyframes);
 	// TODO: we are overriding the keyframe data here
 	const scenegraph::KeyFrameIndex keyFrameIdx = 0;
@@ -251,15 +441,9 @@ bool VoxFormat::loadGroup(const ogt_vox_scene *scene, uint32_t ogt_groupIdx, sce
 }
 
 bool VoxFormat::loadGroupsPalette(const core::String &filename, io::SeekableReadStream &stream, scenegraph::SceneGraph &sceneGraph, voxel::Palette &palette, const LoadContext &ctx) {
-	const size_t size = stream.size();
-	uint8_t *buffer = (uint8_t *)core_malloc(size);
-	if (stream.read(buffer, size) == -1) {
-		core_free(buffer);
-		return false;
-	}
 	const uint32_t ogt_vox_flags = k_read_scene_flags_keyframes | k_read_scene_flags_keep_empty_models_instances | k_read_scene_flags_keep_duplicate_models;
-	const ogt_vox_scene *scene = ogt_vox_read_scene_with_flags(buffer, size, ogt_vox_flags);
-	core_free(buffer);
+	ScopedOgtArena scopedArena(ctx);
+	const ogt_vox_scene *scene = readScene(stream, ogt_vox_flags);
 	if (scene == nullptr) {
 		Log::error("Could not load scene %s", filename.c_str());
 		return false;
@@ -290,6 +474,8 @@ bool VoxFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 	// glm::rotate(glm::rotate(glm::mat4(1.0f), glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f)), glm::radians(180.0f), glm::vec3(0.0f, 0.0f, 1.0f));
 
 	core::Set<uint32_t> addedInstances;
+	_loadCtx = &ctx;
+	_modelIndex = 0;
 
 	for (uint32_t i = 0; i < scene->num_groups; ++i) {
 		const ogt_vox_group &group = scene->groups[i];
@@ -300,6 +486,7 @@ bool VoxFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 		Log::debug("Add root group %u/%u", i, scene->num_groups);
 		if (!loadGroup(scene, i, sceneGraph, -1, zUpMat, addedInstances, palette)) {
 			ogt_vox_destroy_scene(scene);
+			_loadCtx = nullptr;
 			return false;
 		}
 		break;
@@ -311,9 +498,11 @@ bool VoxFormat::loadGroupsPalette(const core::String &filename, io::SeekableRead
 		// TODO: the parent is wrong
 		if (!loadInstance(scene, n, sceneGraph, sceneGraph.root().id(), zUpMat, palette)) {
 			ogt_vox_destroy_scene(scene);
+			_loadCtx = nullptr;
 			return false;
 		}
 	}
+	_loadCtx = nullptr;
 
 	for (uint32_t n = 0; n < scene->num_cameras; ++n) {
 		const ogt_vox_cam& c = scene->cameras[n];
@@ -426,7 +615,6 @@ void VoxFormat::saveNode(const scenegraph::SceneGraph &sceneGraph, scenegraph::S
 	} else if (node.type() == scenegraph::SceneGraphNodeType::Model) {
 		Log::debug("Add model node");
 		const voxel::Region region = node.region();
-		const voxel::Palette &nodePalette = node.palette();
 		{
 			ogt_vox_model ogt_model;
 			core_memset(&ogt_model, 0, sizeof(ogt_model));
@@ -434,25 +622,9 @@ void VoxFormat::saveNode(const scenegraph::SceneGraph &sceneGraph, scenegraph::S
 			ogt_model.size_x = region.getWidthInVoxels();
 			ogt_model.size_y = region.getDepthInVoxels();
 			ogt_model.size_z = region.getHeightInVoxels();
-			const int voxelSize = (int)(ogt_model.size_x * ogt_model.size_y * ogt_model.size_z);
-			uint8_t *dataptr = (uint8_t*)core_malloc(voxelSize);
-			ogt_model.voxel_data = dataptr;
-			voxelutil::visitVolume(*node.volume(), [&] (int, int, int, const voxel::Voxel& voxel) {
-				const core::RGBA rgba = nodePalette.color(voxel.getColor());
-				if (rgba.a == 0 || isAir(voxel.getMaterial())) {
-					*dataptr++ = 0;
-				} else {
-					const uint8_t palIndex = palette.getClosestMatch(rgba, nullptr, 0);
-					if (palIndex == 0u && !ctx.paletteErrorPrinted) {
-						Log::debug("palette index %u: %s mapped to %s", voxel.getColor(), core::Color::print(rgba).c_str(), core::Color::print(palette.color(0)).c_str());
-						Log::error("Could not find a valid color for %u", voxel.getColor());
-						ctx.paletteErrorPrinted = true;
-					}
-					*dataptr++ = palIndex;
-				}
-			}, voxelutil::VisitAll(), voxelutil::VisitorOrder::YZmX);
-
+			// the voxel data is filled in fillModels()
 			ctx.models.push_back(ogt_model);
+			ctx.modelNodes.push_back(&node);
 		}
 		{
 			const scenegraph::SceneGraphKeyFrames &keyFrames = node.keyFrames(sceneGraph.activeAnimation());
@@ -501,6 +673,122 @@ glm::ivec3 VoxFormat::maxSize() const {
 	return maxSize;
 }
 
+/**
+ * @brief Converts the volumes of the model nodes into the ogt voxel data - in parallel
+ *
+ * The palette index of each node color is only looked up once per model.
+ */
+static void fillModels(ogt_SceneContext &ctx, const voxel::Palette &palette) {
+	core_trace_scoped(FillModels);
+	const int n = (int)ctx.models.size();
+	core::DynamicArray<int> unmatchedColors;
+	unmatchedColors.resize(n);
+	app::App::getInstance()->threadPool().parallelFor(0, n, 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			ogt_vox_model &ogt_model = ctx.models[i];
+			const scenegraph::SceneGraphNode *node = ctx.modelNodes[i];
+			const voxel::Palette &nodePalette = node->palette();
+			const voxel::RawVolume *volume = node->volume();
+			const voxel::Region &region = volume->region();
+			const glm::ivec3 &dim = region.getDimensionsInVoxels();
+
+			int16_t paletteIndices[voxel::PaletteMaxColors];
+			for (int c = 0; c < voxel::PaletteMaxColors; ++c) {
+				paletteIndices[c] = -1;
+			}
+			unmatchedColors[i] = -1;
+
+			uint8_t *dataptr = (uint8_t *)core_malloc((size_t)dim.x * dim.y * dim.z);
+			ogt_model.voxel_data = dataptr;
+			// same order as VisitorOrder::YZmX - the y and z axis are flipped and x is mirrored
+			const voxel::Voxel *data = (const voxel::Voxel *)volume->data();
+			for (int y = 0; y < dim.y; ++y) {
+				for (int z = 0; z < dim.z; ++z) {
+					const voxel::Voxel *row = data + (size_t)y * dim.x + (size_t)z * dim.x * dim.y;
+					for (int x = dim.x - 1; x >= 0; --x) {
+						const voxel::Voxel &voxel = row[x];
+						if (voxel::isAir(voxel.getMaterial())) {
+							*dataptr++ = 0;
+							continue;
+						}
+						const uint8_t color = voxel.getColor();
+						if (paletteIndices[color] == -1) {
+							const core::RGBA rgba = nodePalette.color(color);
+							if (rgba.a == 0) {
+								paletteIndices[color] = 0;
+							} else {
+								const uint8_t palIndex = palette.getClosestMatch(rgba, nullptr, 0);
+								if (palIndex == 0u && unmatchedColors[i] == -1) {
+									unmatchedColors[i] = color;
+								}
+								paletteIndices[color] = palIndex;
+							}
+						}
+						*dataptr++ = (uint8_t)paletteIndices[color];
+					}
+				}
+			}
+		}
+	});
+	for (int i = 0; i < n; ++i) {
+		if (unmatchedColors[i] != -1) {
+			const core::RGBA rgba = ctx.modelNodes[i]->palette().color(unmatchedColors[i]);
+			Log::debug("palette index %u: %s mapped to %s", unmatchedColors[i], core::Color::print(rgba).c_str(),
+					   core::Color::print(palette.color(0)).c_str());
+			Log::error("Could not find a valid color for %u", unmatchedColors[i]);
+			break;
+		}
+	}
+}
+
+/**
+ * @brief Models with the same size and voxels are only written once - the instances share them
+ */
+static void removeDuplicateModels(ogt_SceneContext &ctx) {
+	core_trace_scoped(RemoveDuplicateModels);
+	const int n = (int)ctx.models.size();
+	core::DynamicArray<uint64_t> hashes;
+	hashes.resize(n);
+	app::App::getInstance()->threadPool().parallelFor(0, n, 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const ogt_vox_model &m = ctx.models[i];
+			const size_t size = (size_t)m.size_x * m.size_y * m.size_z;
+			const uint64_t sizeHash = core::hash64(&m.size_x, sizeof(m.size_x) * 3);
+			hashes[i] = core::hash64(m.voxel_data, size, sizeHash);
+		}
+	});
+
+	core::Buffer<ogt_vox_model> models;
+	models.reserve(n);
+	core::DynamicArray<uint32_t> modelIndices;
+	modelIndices.resize(n);
+	core::Map<uint64_t, uint32_t, 1031> uniqueModels(n);
+	for (int i = 0; i < n; ++i) {
+		const ogt_vox_model &m = ctx.models[i];
+		uint32_t index;
+		if (uniqueModels.get(hashes[i], index)) {
+			const ogt_vox_model &unique = models[index];
+			if (unique.size_x == m.size_x && unique.size_y == m.size_y && unique.size_z == m.size_z &&
+				core_memcmp(unique.voxel_data, m.voxel_data, (size_t)m.size_x * m.size_y * m.size_z) == 0) {
+				core_free((void *)m.voxel_data);
+				modelIndices[i] = index;
+				continue;
+			}
+		}
+		index = (uint32_t)models.size();
+		models.push_back(m);
+		if (!uniqueModels.hasKey(hashes[i])) {
+			uniqueModels.put(hashes[i], index);
+		}
+		modelIndices[i] = index;
+	}
+	Log::debug("Save %i unique models of %i models", (int)models.size(), n);
+	for (ogt_vox_instance &instance : ctx.instances) {
+		instance.model_index = modelIndices[instance.model_index];
+	}
+	ctx.models = core::move(models);
+}
+
 bool VoxFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core::String &filename, io::SeekableWriteStream &stream, const SaveContext &savectx) {
 	voxel::Palette palette = sceneGraph.mergePalettes(true, 0);
 	if (palette.colorCount() <= 0) {
@@ -515,6 +803,8 @@ bool VoxFormat::saveGroups(const scenegraph::SceneGraph &sceneGraph, const core:
 	ogt_SceneContext ctx;
 	const scenegraph::SceneGraphNode &root = sceneGraph.root();
 	saveNode(sceneGraph, sceneGraph.node(root.id()), ctx, k_invalid_group_index, 0, palette, palReplacement);
+	fillModels(ctx, palette);
+	removeDuplicateModels(ctx);
 
 	core::Buffer<const ogt_vox_model *> modelPtr;
 	modelPtr.reserve(ctx.models.size());
@@ -26,6 +26,15 @@ struct ogt_SceneContext;
  */
 class VoxFormat : public PaletteFormat {
 private:
+	/**
+	 * @brief The context of the current load - for LoadContext::acceptModel()
+	 */
+	const LoadContext *_loadCtx = nullptr;
+	/**
+	 * @brief The index of the next instance in the order they are added to the scene graph
+	 */
+	int _modelIndex = 0;
+
 	glm::ivec3 maxSize() const override;
 
 	int findClosestPaletteIndex(const voxel::Palette &palette);
@@ -38,6 +47,10 @@ private:
 public:
 	VoxFormat();
 	size_t loadPalette(const core::String &filename, io::SeekableReadStream& stream, voxel::Palette &palette, const LoadContext &ctx) override;
+	/**
+	 * @brief Walks the chunks and only reads the model sizes, the transform node names and the palette
+	 */
+	bool loadMetadata(const core::String &filename, io::SeekableReadStream& stream, FormatMetadata &metadata, const LoadContext &ctx) override;
 };
 
 }
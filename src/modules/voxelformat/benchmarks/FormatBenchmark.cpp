@@ -0,0 +1,165 @@
+/**
+ * @file
+ *
+ * Load and save throughput of all formats that have an exporter. Use @c --benchmark_format=json or
+ * @c --benchmark_out=<file> to get the results as json for comparisons between builds.
+ */
+
+#include "app/benchmark/AbstractBenchmark.h"
+#include "core/Memory.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/MemoryReadStream.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/MaterialColor.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/FormatConfig.h"
+#include "voxelformat/VolumeFormat.h"
+#include "voxelutil/VoxelUtil.h"
+
+enum Scene { SceneSingleLarge, SceneManySmall, SceneSparse, SceneMax };
+
+class FormatBenchmark : public app::AbstractBenchmark {
+protected:
+	scenegraph::SceneGraph _sceneGraph;
+	int64_t _voxels = 0;
+
+	void addNode(voxel::RawVolume *v) {
+		scenegraph::SceneGraphNode node;
+		node.setVolume(v, true);
+		_sceneGraph.emplace(core::move(node));
+	}
+
+	voxel::RawVolume *createTerrain(const voxel::Region &region) {
+		voxel::RawVolume *v = new voxel::RawVolume(region);
+		_voxels += voxelutil::fillTerrain(*v, 0.02f);
+		return v;
+	}
+
+	void createScene(Scene scene) {
+		switch (scene) {
+		case SceneSingleLarge:
+			addNode(createTerrain(voxel::Region(0, 255)));
+			break;
+		case SceneManySmall:
+			for (int i = 0; i < 1000; ++i) {
+				const glm::ivec3 mins((i % 10) * 16, ((i / 10) % 10) * 16, (i / 100) * 16);
+				addNode(createTerrain(voxel::Region(mins, mins + 15)));
+			}
+			break;
+		case SceneSparse:
+			// a dense 1024^3 volume doesn't fit into memory - the few filled areas are spread over the extent instead
+			for (int i = 0; i < 64; ++i) {
+				const glm::ivec3 mins((i % 4) * 320, ((i / 4) % 4) * 320, (i / 16) * 320);
+				addNode(createTerrain(voxel::Region(mins, mins + 31)));
+			}
+			break;
+		default:
+			break;
+		}
+	}
+
+	static bool saveScene(scenegraph::SceneGraph &sceneGraph, const io::FormatDescription *desc,
+						  io::BufferedReadWriteStream &stream) {
+		const core::String filename = "benchmark." + desc->exts[0];
+		voxelformat::SaveContext savectx;
+		return voxelformat::saveFormat(sceneGraph, filename, desc, stream, savectx);
+	}
+
+	void report(benchmark::State &state, const io::FormatDescription *desc, int64_t bytes, int64_t memoryBefore) {
+		state.SetLabel(desc->name.c_str());
+		state.SetBytesProcessed(state.iterations() * bytes);
+		state.SetItemsProcessed(state.iterations() * _voxels);
+		state.counters["size"] = (double)bytes;
+		if (core::memory::enabled()) {
+			state.counters["peakmemory"] = (double)(core::memory::totalStats().peak - memoryBefore);
+		}
+	}
+
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		voxelformat::FormatConfig::init();
+		voxel::getPalette().nippon();
+		_voxels = 0;
+		createScene((Scene)state.range(1));
+	}
+
+	void TearDown(::benchmark::State &state) override {
+		_sceneGraph.clear();
+		app::AbstractBenchmark::TearDown(state);
+	}
+};
+
+/**
+ * range(0): the index of the format in @c voxelformat::voxelSave()
+ * range(1): the scene
+ */
+BENCHMARK_DEFINE_F(FormatBenchmark, Save)(benchmark::State &state) {
+	const io::FormatDescription *desc = &voxelformat::voxelSave()[state.range(0)];
+	io::BufferedReadWriteStream stream(10 * 1024 * 1024);
+	const int64_t memoryBefore = core::memory::totalStats().live;
+	core::memory::resetPeak();
+	for (auto _ : state) {
+		stream.seek(0);
+		if (!saveScene(_sceneGraph, desc, stream)) {
+			state.SkipWithError("Failed to save the scene");
+			return;
+		}
+	}
+	report(state, desc, stream.size(), memoryBefore);
+}
+
+BENCHMARK_DEFINE_F(FormatBenchmark, Load)(benchmark::State &state) {
+	const io::FormatDescription *desc = &voxelformat::voxelSave()[state.range(0)];
+	io::BufferedReadWriteStream stream(10 * 1024 * 1024);
+	if (!saveScene(_sceneGraph, desc, stream)) {
+		state.SkipWithError("Failed to save the scene");
+		return;
+	}
+	const core::String filename = "benchmark." + desc->exts[0];
+	const int64_t memoryBefore = core::memory::totalStats().live;
+	core::memory::resetPeak();
+	for (auto _ : state) {
+		io::MemoryReadStream in(stream.getBuffer(), (uint32_t)stream.size());
+		scenegraph::SceneGraph sceneGraph;
+		voxelformat::LoadContext loadctx;
+		if (!voxelformat::loadFormat(filename, in, sceneGraph, loadctx)) {
+			state.SkipWithError("Failed to load the scene");
+			return;
+		}
+		benchmark::DoNotOptimize(sceneGraph.size());
+	}
+	report(state, desc, stream.size(), memoryBefore);
+}
+
+/**
+ * @brief All voxel formats that can be saved and loaded again - the mesh formats are voxelized on load and would
+ * only measure the voxelization
+ */
+static void formatArguments(benchmark::internal::Benchmark *b) {
+	int idx = 0;
+	for (const io::FormatDescription *desc = voxelformat::voxelSave(); desc->valid(); ++desc, ++idx) {
+		if (voxelformat::isMeshFormat(*desc)) {
+			continue;
+		}
+		bool loadable = false;
+		for (const io::FormatDescription *load = voxelformat::voxelLoad(); load->valid(); ++load) {
+			if (*load == *desc) {
+				loadable = true;
+				break;
+			}
+		}
+		if (!loadable) {
+			continue;
+		}
+		for (int scene = 0; scene < SceneMax; ++scene) {
+			b->Args({idx, scene});
+		}
+	}
+}
+
+BENCHMARK_REGISTER_F(FormatBenchmark, Save)->Apply(formatArguments)->Unit(benchmark::kMillisecond);
+BENCHMARK_REGISTER_F(FormatBenchmark, Load)->Apply(formatArguments)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -7,6 +7,7 @@
 #include "core/ArrayLength.h"
 #include "io/BufferedReadWriteStream.h"
 #include "io/MemoryReadStream.h"
+#include <SDL_endian.h>
 
 namespace voxelformat {
 
@@ -316,6 +317,115 @@ NamedBinaryTag NamedBinaryTag::parse(NamedBinaryTagContext &ctx) {
 	return parseType(type, ctx, 0);
 }
 
+/**
+ * @brief Reads the length prefixed array with one read call instead of one call per element
+ * @note The int and long array elements are stored in little endian - this matches the previous per element reads
+ */
+template<typename T>
+bool NamedBinaryTag::readArray(io::ReadStream &stream, core::DynamicArray<T> &array) {
+	uint32_t length;
+	if (stream.readUInt32BE(length) != 0) {
+		return false;
+	}
+	array.resize(length);
+	if (length == 0u) {
+		return true;
+	}
+	const size_t bytes = (size_t)length * sizeof(T);
+	if (stream.read(array.data(), bytes) != (int)bytes) {
+		return false;
+	}
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+	for (T &val : array) {
+		if (sizeof(T) == 4) {
+			val = (T)SDL_SwapLE32((uint32_t)val);
+		} else if (sizeof(T) == 8) {
+			val = (T)SDL_SwapLE64((uint64_t)val);
+		}
+	}
+#endif
+	return true;
+}
+
+bool NamedBinaryTag::skipBytes(io::ReadStream &stream, uint64_t bytes) {
+	uint8_t buf[4096];
+	while (bytes > 0u) {
+		const uint64_t chunk = core_min(bytes, (uint64_t)sizeof(buf));
+		if (stream.read(buf, (size_t)chunk) != (int)chunk) {
+			return false;
+		}
+		bytes -= chunk;
+	}
+	return true;
+}
+
+bool NamedBinaryTag::skipType(TagType type, NamedBinaryTagContext &ctx, int level) {
+	io::ReadStream &stream = *ctx.stream;
+	switch (type) {
+	case TagType::COMPOUND: {
+		TagType entryType;
+		while (readType(stream, entryType) && entryType != TagType::END) {
+			uint16_t nameLength;
+			if (stream.readUInt16BE(nameLength) != 0 || !skipBytes(stream, nameLength)) {
+				return false;
+			}
+			if (!skipType(entryType, ctx, level + 1)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	case TagType::BYTE:
+		return skipBytes(stream, 1);
+	case TagType::SHORT:
+		return skipBytes(stream, 2);
+	case TagType::INT:
+	case TagType::FLOAT:
+		return skipBytes(stream, 4);
+	case TagType::LONG:
+	case TagType::DOUBLE:
+		return skipBytes(stream, 8);
+	case TagType::BYTE_ARRAY:
+	case TagType::INT_ARRAY:
+	case TagType::LONG_ARRAY: {
+		uint32_t length;
+		if (stream.readUInt32BE(length) != 0) {
+			return false;
+		}
+		const uint64_t elementSize = type == TagType::BYTE_ARRAY ? 1u : (type == TagType::INT_ARRAY ? 4u : 8u);
+		return skipBytes(stream, (uint64_t)length * elementSize);
+	}
+	case TagType::STRING: {
+		uint16_t length;
+		if (stream.readUInt16BE(length) != 0) {
+			return false;
+		}
+		return skipBytes(stream, length);
+	}
+	case TagType::LIST: {
+		TagType contentType;
+		if (!readType(stream, contentType)) {
+			return false;
+		}
+		uint32_t length;
+		if (stream.readUInt32BE(length) != 0) {
+			return false;
+		}
+		if (contentType <= TagType::END || contentType >= TagType::MAX) {
+			return true;
+		}
+		for (uint32_t i = 0; i < length; i++) {
+			if (!skipType(contentType, ctx, level + 1)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	default:
+		return false;
+	}
+}
+
 NamedBinaryTag NamedBinaryTag::parseType(TagType type, NamedBinaryTagContext &ctx, int level) {
 	switch (type) {
 	case TagType::COMPOUND: {
@@ -326,6 +436,13 @@ NamedBinaryTag NamedBinaryTag::parseType(TagType type, NamedBinaryTagContext &ct
 			if (!ctx.stream->readPascalStringUInt16BE(name)) {
 				return NamedBinaryTag{};
 			}
+			if (ctx.skipTags != nullptr && ctx.skipTags->has(name)) {
+				Log::trace("%*sSkip %s of type %i", level * 3, " ", name.c_str(), (int)type);
+				if (!skipType(type, ctx, level + 1)) {
+					return NamedBinaryTag{};
+				}
+				continue;
+			}
 			Log::trace("%*sFound %s of type %i", level * 3, " ", name.c_str(), (int)type);
 			compound.emplace(name, parseType(type, ctx, level + 1));
 		}
@@ -377,57 +494,24 @@ NamedBinaryTag NamedBinaryTag::parseType(TagType type, NamedBinaryTagContext &ct
 		return NamedBinaryTag{val};
 	}
 	case TagType::BYTE_ARRAY: {
-		uint32_t length;
-		if (ctx.stream->readUInt32BE(length) != 0) {
-			return NamedBinaryTag{};
-		}
 		core::DynamicArray<int8_t> array;
-		array.reserve(length);
-		bool error = false;
-		array.append(length, [&ctx, &error] (int i) {
-			int8_t val;
-			if (ctx.stream->readInt8(val) != 0) {
-				error = true;
-			}
-			return val;
-		});
-		if (error) {
+		if (!readArray(*ctx.stream, array)) {
 			return NamedBinaryTag{};
 		}
 		return NamedBinaryTag{core::move(array)};
 	}
 	case TagType::INT_ARRAY: {
-		uint32_t length;
-		if (ctx.stream->readUInt32BE(length) != 0) {
+		core::DynamicArray<int32_t> array;
+		if (!readArray(*ctx.stream, array)) {
 			return NamedBinaryTag{};
 		}
-		core::DynamicArray<int32_t> array;
-		array.reserve(length);
-		bool error = false;
-		array.append(length, [&ctx, &error] (int i) {
-			int32_t val;
-			if (ctx.stream->readInt32(val) != 0) {
-				error = true;
-			}
-			return val;
-		});
 		return NamedBinaryTag{core::move(array)};
 	}
 	case TagType::LONG_ARRAY: {
-		uint32_t length;
-		if (ctx.stream->readUInt32BE(length) != 0) {
+		core::DynamicArray<int64_t> array;
+		if (!readArray(*ctx.stream, array)) {
 			return NamedBinaryTag{};
 		}
-		core::DynamicArray<int64_t> array;
-		array.reserve(length);
-		bool error = false;
-		array.append(length, [&ctx, &error] (int i) {
-			int64_t val;
-			if (ctx.stream->readInt64(val) != 0) {
-				error = true;
-			}
-			return val;
-		});
 		return NamedBinaryTag{core::move(array)};
 	}
 	case TagType::LIST: {
@@ -8,6 +8,8 @@
 #include "core/String.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/DynamicMap.h"
+#include "core/collection/SmallVector.h"
+#include "core/collection/StringSet.h"
 #include "core/concurrent/ThreadPool.h"
 #include "io/Stream.h"
 #include <stdint.h>
@@ -36,7 +38,10 @@ enum class TagType : uint8_t {
 	MAX
 };
 
-using NBTList = core::DynamicArray<NamedBinaryTag>;
+/**
+ * most of the lists are small (e.g. the three coordinates of a position) - they don't need an extra allocation
+ */
+using NBTList = core::SmallVector<NamedBinaryTag, 4>;
 using NBTCompound = core::DynamicMap<core::String, NamedBinaryTag, 11, core::StringHash>;
 
 union TagData {
@@ -96,6 +101,11 @@ union TagData {
 
 struct NamedBinaryTagContext {
 	io::ReadStream *stream;
+	/**
+	 * @brief Optional names of compound entries that are not needed by the caller - they are consumed from the
+	 * stream without building the tags (e.g. entities or light arrays)
+	 */
+	const core::StringSet *skipTags = nullptr;
 };
 
 /**
@@ -111,6 +121,10 @@ private:
 	static bool writeType(io::WriteStream &stream, const NamedBinaryTag &tag);
 
 	static NamedBinaryTag parseType(TagType type, NamedBinaryTagContext &ctx, int level);
+	static bool skipType(TagType type, NamedBinaryTagContext &ctx, int level);
+	static bool skipBytes(io::ReadStream &stream, uint64_t bytes);
+	template<typename T>
+	static bool readArray(io::ReadStream &stream, core::DynamicArray<T> &array);
 
 	static bool readType(io::ReadStream &stream, TagType &type) {
 		return stream.read(&type, sizeof(type)) == sizeof(type);
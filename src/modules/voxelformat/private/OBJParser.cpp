@@ -0,0 +1,444 @@
+/**
+ * @file
+ */
+
+#include "OBJParser.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/collection/StringMap.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
+#include <string.h>
+
+namespace voxelformat {
+
+namespace priv {
+
+namespace {
+
+/**
+ * @brief The chunks are not made smaller than this to keep the merge costs low
+ */
+static constexpr size_t MinChunkSize = 1024 * 1024;
+
+/**
+ * @brief A face of a chunk - the relative (negative) indices are stored relative to the first vertex of the chunk
+ * and are resolved once the vertex counts of the previous chunks are known
+ */
+struct ChunkFace {
+	ObjFace face;
+	/** bit 0-2 for the vertices and bit 3-5 for the texture coordinates */
+	uint8_t relative = 0u;
+};
+
+struct ChunkGroup {
+	core::String name;
+	/** the first face of the chunk that belongs to this group */
+	size_t firstFace;
+};
+
+struct ObjChunk {
+	core::DynamicArray<glm::vec3> positions;
+	core::DynamicArray<glm::vec3> colors;
+	core::DynamicArray<glm::vec2> texcoords;
+	/** the material of the faces is an index into @c materials or @c -1 to continue the material of the previous chunk */
+	core::DynamicArray<ChunkFace> faces;
+	core::DynamicArray<core::String> materials;
+	core::DynamicArray<core::String> materialLibraries;
+	core::DynamicArray<ChunkGroup> groups;
+	/** the material that is active at the end of the chunk - @c -1 if there is no @c usemtl statement */
+	int32_t lastMaterial = -1;
+	bool allColors = true;
+	bool valid = true;
+};
+
+inline bool isBlank(char c) {
+	return c == ' ' || c == '\t' || c == '\r';
+}
+
+inline bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+inline const char *skipBlanks(const char *p, const char *end) {
+	while (p < end && isBlank(*p)) {
+		++p;
+	}
+	return p;
+}
+
+/**
+ * @brief Converts the one based or relative obj index into a zero based index
+ * @param[in] count The amount of elements of the chunk that were parsed before the index
+ * @return @c false for the invalid index @c 0
+ */
+inline bool toIndex(int32_t objIndex, int32_t count, int32_t &index, bool &relative) {
+	if (objIndex > 0) {
+		index = objIndex - 1;
+		relative = false;
+		return true;
+	}
+	if (objIndex < 0) {
+		// might point into a previous chunk - this is fine once the chunk offset is added
+		index = count + objIndex;
+		relative = true;
+		return true;
+	}
+	return false;
+}
+
+inline core::String restOfLine(const char *p, const char *end) {
+	p = skipBlanks(p, end);
+	while (end > p && isBlank(end[-1])) {
+		--end;
+	}
+	return core::String(p, end - p);
+}
+
+struct FaceVertex {
+	int32_t vertex;
+	int32_t texcoord;
+	bool relativeVertex;
+	bool relativeTexcoord;
+};
+
+static bool parseFace(const char *p, const char *end, ObjChunk &chunk, int32_t material,
+					  core::DynamicArray<FaceVertex> &polygon) {
+	polygon.clear();
+	const int32_t positions = (int32_t)chunk.positions.size();
+	const int32_t texcoords = (int32_t)chunk.texcoords.size();
+	for (;;) {
+		p = skipBlanks(p, end);
+		if (p >= end) {
+			break;
+		}
+		FaceVertex v{-1, -1, false, false};
+		int32_t objIndex;
+		p = core::string::parseInt(p, end, objIndex);
+		if (p == nullptr || !toIndex(objIndex, positions, v.vertex, v.relativeVertex)) {
+			return false;
+		}
+		if (p < end && *p == '/') {
+			++p;
+			if (p < end && *p != '/' && !isBlank(*p)) {
+				p = core::string::parseInt(p, end, objIndex);
+				if (p == nullptr || !toIndex(objIndex, texcoords, v.texcoord, v.relativeTexcoord)) {
+					return false;
+				}
+			}
+			if (p < end && *p == '/') {
+				// the normal is not needed
+				++p;
+				while (p < end && !isBlank(*p)) {
+					++p;
+				}
+			}
+		}
+		if (p < end && !isBlank(*p)) {
+			return false;
+		}
+		polygon.push_back(v);
+	}
+	if (polygon.size() < 3) {
+		return false;
+	}
+	for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+		const FaceVertex *triangle[3] = {&polygon[0], &polygon[i], &polygon[i + 1]};
+		ChunkFace chunkFace;
+		chunkFace.face.material = material;
+		for (int j = 0; j < 3; ++j) {
+			chunkFace.face.vertices[j] = triangle[j]->vertex;
+			chunkFace.face.texcoords[j] = triangle[j]->texcoord;
+			if (triangle[j]->relativeVertex) {
+				chunkFace.relative |= 1u << j;
+			}
+			if (triangle[j]->relativeTexcoord) {
+				chunkFace.relative |= 1u << (3 + j);
+			}
+		}
+		chunk.faces.push_back(chunkFace);
+	}
+	return true;
+}
+
+inline bool isStatement(const char *p, const char *end, const char *statement, size_t len) {
+	if ((size_t)(end - p) < len || core_memcmp(p, statement, len) != 0) {
+		return false;
+	}
+	return p + len == end || isBlank(p[len]);
+}
+
+static void parseChunk(const char *p, const char *end, ObjChunk &chunk) {
+	core::DynamicArray<FaceVertex> polygon;
+	while (p < end) {
+		const char *lineEnd = (const char *)memchr(p, '\n', end - p);
+		if (lineEnd == nullptr) {
+			lineEnd = end;
+		}
+		const char *s = skipBlanks(p, lineEnd);
+		p = lineEnd + 1;
+		if (s >= lineEnd) {
+			continue;
+		}
+		switch (*s) {
+		case 'v':
+			if (isStatement(s, lineEnd, "v", 1)) {
+				glm::vec3 pos(0.0f);
+				const char *c = s + 1;
+				for (int i = 0; i < 3 && c != nullptr; ++i) {
+					c = core::string::parseFloat(skipBlanks(c, lineEnd), lineEnd, pos[i]);
+				}
+				if (c == nullptr) {
+					chunk.valid = false;
+					return;
+				}
+				chunk.positions.push_back(pos);
+				glm::vec3 color(1.0f);
+				for (int i = 0; i < 3 && c != nullptr; ++i) {
+					c = core::string::parseFloat(skipBlanks(c, lineEnd), lineEnd, color[i]);
+				}
+				if (c == nullptr) {
+					chunk.allColors = false;
+				}
+				if (chunk.allColors) {
+					chunk.colors.push_back(color);
+				}
+			} else if (isStatement(s, lineEnd, "vt", 2)) {
+				glm::vec2 uv(0.0f);
+				const char *c = core::string::parseFloat(skipBlanks(s + 2, lineEnd), lineEnd, uv.x);
+				if (c != nullptr) {
+					// the v coordinate is optional
+					core::string::parseFloat(skipBlanks(c, lineEnd), lineEnd, uv.y);
+				}
+				chunk.texcoords.push_back(uv);
+			}
+			break;
+		case 'f':
+			if (isStatement(s, lineEnd, "f", 1)) {
+				if (!parseFace(s + 1, lineEnd, chunk, chunk.lastMaterial, polygon)) {
+					Log::error("Invalid face: %s", core::String(s, lineEnd - s).c_str());
+					chunk.valid = false;
+					return;
+				}
+			}
+			break;
+		case 'o':
+		case 'g':
+			if (isStatement(s, lineEnd, "o", 1) || isStatement(s, lineEnd, "g", 1)) {
+				chunk.groups.push_back(ChunkGroup{restOfLine(s + 1, lineEnd), chunk.faces.size()});
+			}
+			break;
+		case 'u':
+			if (isStatement(s, lineEnd, "usemtl", 6)) {
+				chunk.lastMaterial = (int32_t)chunk.materials.size();
+				chunk.materials.push_back(restOfLine(s + 6, lineEnd));
+			}
+			break;
+		case 'm':
+			if (isStatement(s, lineEnd, "mtllib", 6)) {
+				chunk.materialLibraries.push_back(restOfLine(s + 6, lineEnd));
+			}
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+/**
+ * @brief A range of faces of a chunk that belongs to one shape
+ */
+struct ShapeSpan {
+	int chunk;
+	size_t begin;
+	size_t end;
+	int shape;
+	/** the index of the first face in the faces of the shape */
+	size_t offset;
+};
+
+} // namespace
+
+bool parseObj(const uint8_t *data, size_t size, ObjData &out, core::ThreadPool *threadPool) {
+	core_trace_scoped(ParseObj);
+	const char *text = (const char *)data;
+	const size_t threads = threadPool != nullptr ? core_max(threadPool->size(), (size_t)1) : (size_t)1;
+	const size_t chunkCount = core_max((size_t)1, core_min(size / MinChunkSize, threads * 4));
+
+	// split at the line boundaries
+	core::DynamicArray<size_t> chunkStarts;
+	chunkStarts.reserve(chunkCount + 1);
+	chunkStarts.push_back(0u);
+	for (size_t i = 1; i < chunkCount; ++i) {
+		size_t start = core_max(size * i / chunkCount, chunkStarts.back());
+		const char *lineEnd = start < size ? (const char *)memchr(text + start, '\n', size - start) : nullptr;
+		start = lineEnd == nullptr ? size : (size_t)(lineEnd - text) + 1;
+		chunkStarts.push_back(start);
+	}
+	chunkStarts.push_back(size);
+
+	core::DynamicArray<ObjChunk> chunks;
+	chunks.resize(chunkCount);
+	auto parse = [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			parseChunk(text + chunkStarts[i], text + chunkStarts[i + 1], chunks[i]);
+		}
+	};
+	if (threadPool != nullptr) {
+		threadPool->parallelFor(0, (int)chunkCount, 1, parse);
+	} else {
+		parse(0, (int)chunkCount);
+	}
+
+	// the offsets of the chunks and the material and shape assignments have to be resolved in order
+	core::DynamicArray<int32_t> positionOffsets;
+	core::DynamicArray<int32_t> texcoordOffsets;
+	core::DynamicArray<core::DynamicArray<int32_t>> materialIds;
+	core::DynamicArray<int32_t> inheritedMaterials;
+	positionOffsets.reserve(chunkCount);
+	texcoordOffsets.reserve(chunkCount);
+	materialIds.resize(chunkCount);
+	inheritedMaterials.reserve(chunkCount);
+	core::StringMap<int32_t> materialMap;
+	core::DynamicArray<ShapeSpan> spans;
+	core::DynamicArray<size_t> shapeSizes;
+	bool allColors = true;
+	int64_t positionCount = 0;
+	int64_t texcoordCount = 0;
+	int32_t material = -1;
+	core::String shapeName;
+	int currentShape = -1;
+	for (size_t i = 0; i < chunkCount; ++i) {
+		const ObjChunk &chunk = chunks[i];
+		if (!chunk.valid) {
+			return false;
+		}
+		positionOffsets.push_back((int32_t)positionCount);
+		texcoordOffsets.push_back((int32_t)texcoordCount);
+		positionCount += (int64_t)chunk.positions.size();
+		texcoordCount += (int64_t)chunk.texcoords.size();
+		if (positionCount > INT32_MAX || texcoordCount > INT32_MAX) {
+			Log::error("Too many vertices in the obj");
+			return false;
+		}
+		allColors &= chunk.allColors;
+
+		inheritedMaterials.push_back(material);
+		for (const core::String &name : chunk.materials) {
+			int32_t id;
+			if (!materialMap.get(name, id)) {
+				id = (int32_t)out.materials.size();
+				out.materials.push_back(name);
+				materialMap.put(name, id);
+			}
+			materialIds[i].push_back(id);
+		}
+		if (chunk.lastMaterial != -1) {
+			material = materialIds[i][chunk.lastMaterial];
+		}
+		for (const core::String &library : chunk.materialLibraries) {
+			out.materialLibraries.push_back(library);
+		}
+
+		size_t begin = 0u;
+		for (size_t g = 0; g <= chunk.groups.size(); ++g) {
+			const size_t end = g < chunk.groups.size() ? chunk.groups[g].firstFace : chunk.faces.size();
+			if (end > begin) {
+				if (currentShape == -1) {
+					ObjShape shape;
+					shape.name = shapeName;
+					out.shapes.push_back(shape);
+					shapeSizes.push_back(0u);
+					currentShape = (int)out.shapes.size() - 1;
+				}
+				spans.push_back(ShapeSpan{(int)i, begin, end, currentShape, shapeSizes[currentShape]});
+				shapeSizes[currentShape] += end - begin;
+			}
+			if (g < chunk.groups.size()) {
+				// a new shape is started for every o or g statement with faces
+				shapeName = chunk.groups[g].name;
+				currentShape = -1;
+				begin = end;
+			}
+		}
+	}
+
+	if (allColors && positionCount > 0) {
+		out.colors.resize((size_t)positionCount);
+	}
+	out.positions.resize((size_t)positionCount);
+	out.texcoords.resize((size_t)texcoordCount);
+	for (size_t i = 0; i < out.shapes.size(); ++i) {
+		out.shapes[i].faces.resize(shapeSizes[i]);
+	}
+
+	core::AtomicInt invalid(0);
+	auto merge = [&](int start, int end) {
+		for (int s = start; s < end; ++s) {
+			const ShapeSpan &span = spans[s];
+			const ObjChunk &chunk = chunks[span.chunk];
+			const int32_t positionOffset = positionOffsets[span.chunk];
+			const int32_t texcoordOffset = texcoordOffsets[span.chunk];
+			ObjFace *faces = out.shapes[span.shape].faces.data() + span.offset;
+			for (size_t f = span.begin; f < span.end; ++f) {
+				const ChunkFace &chunkFace = chunk.faces[f];
+				ObjFace face = chunkFace.face;
+				for (int j = 0; j < 3; ++j) {
+					if (chunkFace.relative & (1u << j)) {
+						face.vertices[j] += positionOffset;
+					}
+					int32_t minTexcoord = -1;
+					if (chunkFace.relative & (1u << (3 + j))) {
+						face.texcoords[j] += texcoordOffset;
+						minTexcoord = 0;
+					}
+					if (face.vertices[j] < 0 || face.vertices[j] >= (int32_t)positionCount ||
+						face.texcoords[j] < minTexcoord || face.texcoords[j] >= (int32_t)texcoordCount) {
+						++invalid;
+						face.vertices[j] = 0;
+						face.texcoords[j] = -1;
+					}
+				}
+				face.material = face.material == -1 ? inheritedMaterials[span.chunk]
+													: materialIds[span.chunk][face.material];
+				faces[f - span.begin] = face;
+			}
+		}
+	};
+	auto copyVertices = [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const ObjChunk &chunk = chunks[i];
+			if (!chunk.positions.empty()) {
+				core_memcpy(&out.positions[positionOffsets[i]], chunk.positions.data(),
+							chunk.positions.size() * sizeof(glm::vec3));
+			}
+			if (!out.colors.empty() && !chunk.colors.empty()) {
+				core_memcpy(&out.colors[positionOffsets[i]], chunk.colors.data(),
+							chunk.colors.size() * sizeof(glm::vec3));
+			}
+			if (!chunk.texcoords.empty()) {
+				core_memcpy(&out.texcoords[texcoordOffsets[i]], chunk.texcoords.data(),
+							chunk.texcoords.size() * sizeof(glm::vec2));
+			}
+		}
+	};
+	if (threadPool != nullptr) {
+		threadPool->parallelFor(0, (int)spans.size(), 1, merge);
+		threadPool->parallelFor(0, (int)chunkCount, 1, copyVertices);
+	} else {
+		merge(0, (int)spans.size());
+		copyVertices(0, (int)chunkCount);
+	}
+	if (invalid > 0) {
+		Log::error("Found %i invalid vertex indices in the obj", (int)invalid);
+		return false;
+	}
+	return true;
+}
+
+} // namespace priv
+
+} // namespace voxelformat
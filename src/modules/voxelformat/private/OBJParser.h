@@ -0,0 +1,65 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include <glm/vec2.hpp>
+#include <glm/vec3.hpp>
+#include <stdint.h>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxelformat {
+
+namespace priv {
+
+/**
+ * @brief A triangle of a wavefront object - polygons are triangulated as fan
+ */
+struct ObjFace {
+	/** indices into @c ObjData::positions */
+	int32_t vertices[3]{-1, -1, -1};
+	/** indices into @c ObjData::texcoords or @c -1 */
+	int32_t texcoords[3]{-1, -1, -1};
+	/** index into @c ObjData::materials or @c -1 */
+	int32_t material = -1;
+};
+
+struct ObjShape {
+	/** the name of the last @c o or @c g statement - empty for the faces before the first one */
+	core::String name;
+	core::DynamicArray<ObjFace> faces;
+};
+
+struct ObjData {
+	core::DynamicArray<glm::vec3> positions;
+	/** the vertex colors - only filled if every vertex has a color */
+	core::DynamicArray<glm::vec3> colors;
+	core::DynamicArray<glm::vec2> texcoords;
+	/** the names of the @c usemtl statements */
+	core::DynamicArray<core::String> materials;
+	/** the files of the @c mtllib statements */
+	core::DynamicArray<core::String> materialLibraries;
+	/** only shapes with faces are added */
+	core::DynamicArray<ObjShape> shapes;
+};
+
+/**
+ * @brief Parses the geometry of a wavefront object
+ *
+ * The data is split into chunks at line boundaries that are parsed in parallel - the chunks are merged afterwards
+ * and the relative (negative) indices are resolved. Normals, lines and points are skipped.
+ *
+ * @param[in] threadPool The chunks are parsed on the calling thread if this is @c null
+ * @return @c false if the data contains invalid faces
+ */
+bool parseObj(const uint8_t *data, size_t size, ObjData &out, core::ThreadPool *threadPool = nullptr);
+
+} // namespace priv
+
+} // namespace voxelformat
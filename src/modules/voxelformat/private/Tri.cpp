@@ -54,6 +54,111 @@ core::RGBA Tri::colorAt(const glm::vec2 &uv) const {
 	return core::RGBA::mix(core::RGBA::mix(color[0], color[1]), color[2]);
 }
 
+core::RGBA Tri::colorAtBarycentric(const glm::vec3 &barycentric) const {
+	if (texture) {
+		const glm::vec2 &texUV = uv[0] * barycentric.x + uv[1] * barycentric.y + uv[2] * barycentric.z;
+		return texture->colorAt(texUV, wrapS, wrapT);
+	}
+	const glm::vec4 &c = glm::vec4(color[0].r, color[0].g, color[0].b, color[0].a) * barycentric.x +
+						 glm::vec4(color[1].r, color[1].g, color[1].b, color[1].a) * barycentric.y +
+						 glm::vec4(color[2].r, color[2].g, color[2].b, color[2].a) * barycentric.z;
+	const glm::u8vec4 &rounded = glm::clamp(glm::round(c), 0.0f, 255.0f);
+	return core::RGBA(rounded.r, rounded.g, rounded.b, rounded.a);
+}
+
+// Christer Ericson - Real-Time Collision Detection (5.1.5)
+glm::vec3 Tri::closestBarycentric(const glm::vec3 &pos) const {
+	const glm::vec3 &a = vertices[0];
+	const glm::vec3 &b = vertices[1];
+	const glm::vec3 &c = vertices[2];
+	const glm::vec3 ab = b - a;
+	const glm::vec3 ac = c - a;
+	const glm::vec3 ap = pos - a;
+	const float d1 = glm::dot(ab, ap);
+	const float d2 = glm::dot(ac, ap);
+	if (d1 <= 0.0f && d2 <= 0.0f) {
+		return {1.0f, 0.0f, 0.0f};
+	}
+	const glm::vec3 bp = pos - b;
+	const float d3 = glm::dot(ab, bp);
+	const float d4 = glm::dot(ac, bp);
+	if (d3 >= 0.0f && d4 <= d3) {
+		return {0.0f, 1.0f, 0.0f};
+	}
+	const float vc = d1 * d4 - d3 * d2;
+	if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f && d1 - d3 > 0.0f) {
+		const float v = d1 / (d1 - d3);
+		return {1.0f - v, v, 0.0f};
+	}
+	const glm::vec3 cp = pos - c;
+	const float d5 = glm::dot(ab, cp);
+	const float d6 = glm::dot(ac, cp);
+	if (d6 >= 0.0f && d5 <= d6) {
+		return {0.0f, 0.0f, 1.0f};
+	}
+	const float vb = d5 * d2 - d1 * d6;
+	if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f && d2 - d6 > 0.0f) {
+		const float w = d2 / (d2 - d6);
+		return {1.0f - w, 0.0f, w};
+	}
+	const float va = d3 * d6 - d5 * d4;
+	if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f && (d4 - d3) + (d5 - d6) > 0.0f) {
+		const float w = (d4 - d3) / ((d4 - d3) + (d5 - d6));
+		return {0.0f, 1.0f - w, w};
+	}
+	const float sum = va + vb + vc;
+	if (sum <= 0.0f) {
+		// degenerated triangle
+		return {1.0f, 0.0f, 0.0f};
+	}
+	const float v = vb / sum;
+	const float w = vc / sum;
+	return {1.0f - v - w, v, w};
+}
+
+static inline bool axisOverlap(const glm::vec3 &axis, const glm::vec3 &v0, const glm::vec3 &v1, const glm::vec3 &v2,
+							   const glm::vec3 &boxHalfSize) {
+	const float p0 = glm::dot(v0, axis);
+	const float p1 = glm::dot(v1, axis);
+	const float p2 = glm::dot(v2, axis);
+	const float r = glm::dot(boxHalfSize, glm::abs(axis));
+	return glm::max(p0, glm::max(p1, p2)) >= -r && glm::min(p0, glm::min(p1, p2)) <= r;
+}
+
+bool Tri::intersectsBox(const glm::vec3 &boxCenter, const glm::vec3 &boxHalfSize) const {
+	// move the box to the origin
+	const glm::vec3 v0 = vertices[0] - boxCenter;
+	const glm::vec3 v1 = vertices[1] - boxCenter;
+	const glm::vec3 v2 = vertices[2] - boxCenter;
+
+	// the box face normals
+	const glm::vec3 &triMins = glm::min(v0, glm::min(v1, v2));
+	const glm::vec3 &triMaxs = glm::max(v0, glm::max(v1, v2));
+	if (glm::any(glm::greaterThan(triMins, boxHalfSize)) || glm::any(glm::lessThan(triMaxs, -boxHalfSize))) {
+		return false;
+	}
+
+	// the triangle normal
+	const glm::vec3 e0 = v1 - v0;
+	const glm::vec3 e1 = v2 - v1;
+	const glm::vec3 e2 = v0 - v2;
+	const glm::vec3 n = glm::cross(e0, e1);
+	if (glm::abs(glm::dot(n, v0)) > glm::dot(boxHalfSize, glm::abs(n))) {
+		return false;
+	}
+
+	// the cross products of the triangle edges and the box axes
+	const glm::vec3 edges[]{e0, e1, e2};
+	for (const glm::vec3 &e : edges) {
+		if (!axisOverlap(glm::vec3(0.0f, -e.z, e.y), v0, v1, v2, boxHalfSize) ||
+			!axisOverlap(glm::vec3(e.z, 0.0f, -e.x), v0, v1, v2, boxHalfSize) ||
+			!axisOverlap(glm::vec3(-e.y, e.x, 0.0f), v0, v1, v2, boxHalfSize)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 // Sierpinski gasket with keeping the middle
 void Tri::subdivide(Tri out[4]) const {
 	const glm::vec3 midv[]{glm::mix(vertices[0], vertices[1], 0.5f), glm::mix(vertices[1], vertices[2], 0.5f),
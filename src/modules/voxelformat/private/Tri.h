@@ -37,6 +37,18 @@ struct Tri {
 	glm::ivec3 roundedMins() const;
 	glm::ivec3 roundedMaxs() const;
 	core::RGBA colorAt(const glm::vec2 &uv) const;
+	/**
+	 * @brief The texture color or the interpolated vertex color at the given barycentric coordinates
+	 */
+	core::RGBA colorAtBarycentric(const glm::vec3 &barycentric) const;
+	/**
+	 * @return The barycentric coordinates of the point on the triangle that is closest to the given position
+	 */
+	glm::vec3 closestBarycentric(const glm::vec3 &pos) const;
+	/**
+	 * @brief Triangle/box overlap test using the separating axis theorem (Tomas Akenine-Möller)
+	 */
+	bool intersectsBox(const glm::vec3 &boxCenter, const glm::vec3 &boxHalfSize) const;
 
 	// Sierpinski gasket with keeping the middle
 	void subdivide(Tri out[4]) const;
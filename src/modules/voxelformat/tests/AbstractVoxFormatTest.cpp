@@ -190,6 +190,46 @@ void AbstractVoxFormatTest::testLoadScreenshot(const core::String &filename, int
 									<< image::print(image);
 }
 
+void AbstractVoxFormatTest::testLoadMetadata(const core::String &filename, io::SeekableReadStream &stream) {
+	FormatMetadata metadata;
+	ASSERT_TRUE(voxelformat::loadMetadata(filename, stream, metadata, testLoadCtx));
+	stream.seek(0);
+	scenegraph::SceneGraph sceneGraph;
+	ASSERT_TRUE(voxelformat::loadFormat(filename, stream, sceneGraph, testLoadCtx));
+	ASSERT_EQ(sceneGraph.size(), metadata.models.size());
+	// the order of the nodes might differ from the order in the file
+	core::DynamicArray<core::String> expected;
+	core::DynamicArray<core::String> loaded;
+	for (const scenegraph::SceneGraphNode &node : sceneGraph) {
+		const glm::ivec3 &dim = node.region().getDimensionsInVoxels();
+		expected.push_back(core::string::format("%i:%i:%i", dim.x, dim.y, dim.z));
+	}
+	for (const ModelMetadata &model : metadata.models) {
+		const glm::ivec3 &dim = model.region.getDimensionsInVoxels();
+		loaded.push_back(core::string::format("%i:%i:%i", dim.x, dim.y, dim.z));
+		if (model.name.empty()) {
+			continue;
+		}
+		EXPECT_NE(nullptr, sceneGraph.findNodeByName(model.name)) << model.name;
+	}
+	expected.sort(core::Less<core::String>());
+	loaded.sort(core::Less<core::String>());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		EXPECT_EQ(expected[i], loaded[i]);
+	}
+	const voxel::Palette &palette = sceneGraph.firstPalette();
+	ASSERT_EQ(palette.colorCount(), metadata.palette.colorCount());
+	for (int c = 0; c < palette.colorCount(); ++c) {
+		EXPECT_EQ(palette.color(c), metadata.palette.color(c)) << "color " << c;
+	}
+}
+
+void AbstractVoxFormatTest::testLoadMetadata(const core::String &filename) {
+	io::FileStream stream(open(filename));
+	ASSERT_TRUE(stream.valid());
+	testLoadMetadata(filename, stream);
+}
+
 void AbstractVoxFormatTest::testRGBSmallSaveLoad(const core::String &filename, const core::String &saveFilename) {
 	scenegraph::SceneGraph sceneGraph;
 	{
@@ -43,6 +43,9 @@ protected:
 	// save as the same format
 	void testRGBSmallSaveLoad(const core::String &filename);
 	void testLoadScreenshot(const core::String &filename, int width, int height, const core::RGBA expectedColor, int expectedX, int expectedY);
+	// compare the metadata with the fully loaded scene graph
+	void testLoadMetadata(const core::String &filename, io::SeekableReadStream &stream);
+	void testLoadMetadata(const core::String &filename);
 	// save as any other format
 	void testRGBSmallSaveLoad(const core::String &filename, const core::String &saveFilename);
 
@@ -6,6 +6,7 @@
 #include "io/BufferedReadWriteStream.h"
 #include "voxelformat/AoSVXLFormat.h"
 #include "io/FileStream.h"
+#include "core/ScopedPtr.h"
 #include "core/Var.h"
 #include "voxelformat/tests/TestHelper.h"
 
@@ -64,4 +65,40 @@ TEST_F(AoSVXLFormatTest, testSave) {
 	EXPECT_EQ(sceneGraphLoad.size(), 4);
 }
 
+TEST_F(AoSVXLFormatTest, testSaveOverhang) {
+	AoSVXLFormat f;
+	voxel::Region region(glm::ivec3(0), glm::ivec3(31, 63, 31));
+	voxel::RawVolume layer1(region);
+	const char *filename = "tests-aos-overhang.vxl";
+	for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+		for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+			EXPECT_TRUE(layer1.setVoxel(x, 0, z, voxel::createVoxel(voxel::VoxelType::Generic, 1)));
+			for (int y = 10; y <= 12; ++y) {
+				EXPECT_TRUE(layer1.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 2)));
+			}
+		}
+	}
+	scenegraph::SceneGraph sceneGraph;
+	scenegraph::SceneGraphNode node1;
+	node1.setVolume(&layer1, false);
+	sceneGraph.emplace(core::move(node1));
+	io::BufferedReadWriteStream bufferedStream((int64_t)(10 * 1024 * 1024));
+
+	ASSERT_TRUE(f.save(sceneGraph, filename, bufferedStream, testSaveCtx));
+	bufferedStream.seek(0);
+	scenegraph::SceneGraph::MergedVolumePalette merged = load(filename, bufferedStream, f);
+	core::ScopedPtr<voxel::RawVolume> loaded(merged.first);
+	ASSERT_NE(nullptr, loaded);
+	for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+		for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+			EXPECT_FALSE(voxel::isAir(loaded->voxel(x, 0, z).getMaterial())) << x << ":" << z;
+			EXPECT_TRUE(voxel::isAir(loaded->voxel(x, 5, z).getMaterial())) << x << ":" << z;
+			for (int y = 10; y <= 12; ++y) {
+				EXPECT_FALSE(voxel::isAir(loaded->voxel(x, y, z).getMaterial())) << x << ":" << y << ":" << z;
+			}
+			EXPECT_TRUE(voxel::isAir(loaded->voxel(x, 13, z).getMaterial())) << x << ":" << z;
+		}
+	}
+}
+
 }
@@ -0,0 +1,40 @@
+/**
+ * @file
+ */
+
+#include "voxelformat/FBXFormat.h"
+#include "AbstractVoxFormatTest.h"
+#include "io/File.h"
+#include "voxelformat/QBFormat.h"
+#include "io/FileStream.h"
+
+namespace voxelformat {
+
+class FBXFormatTest : public AbstractVoxFormatTest {};
+
+TEST_F(FBXFormatTest, testExportMesh) {
+	scenegraph::SceneGraph sceneGraph;
+	{
+		QBFormat sourceFormat;
+		const core::String filename = "rgb.qb";
+		const io::FilePtr &file = open(filename);
+		io::FileStream stream(file);
+		EXPECT_TRUE(sourceFormat.load(filename, stream, sceneGraph, testLoadCtx));
+	}
+	ASSERT_TRUE(sceneGraph.size() > 0);
+	FBXFormat f;
+	const core::String outFilename = "exportrgb.fbx";
+	{
+		const io::FilePtr &outFile = open(outFilename, io::FileMode::SysWrite);
+		io::FileStream outStream(outFile);
+		ASSERT_TRUE(f.saveGroups(sceneGraph, outFilename, outStream, testSaveCtx));
+	}
+	// the binary export must be readable by the fbx loader again
+	const io::FilePtr &file = open(outFilename);
+	io::FileStream stream(file);
+	scenegraph::SceneGraph loadedSceneGraph;
+	EXPECT_TRUE(f.loadGroups(outFilename, stream, loadedSceneGraph, testLoadCtx));
+	EXPECT_TRUE(loadedSceneGraph.size() > 0);
+}
+
+} // namespace voxelformat
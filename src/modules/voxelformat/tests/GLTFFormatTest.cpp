@@ -7,6 +7,10 @@
 #include "io/File.h"
 #include "voxelformat/QBFormat.h"
 #include "io/FileStream.h"
+#include "io/BufferedReadWriteStream.h"
+#include "core/GameConfig.h"
+#include "core/Var.h"
+#include "voxelutil/VolumeVisitor.h"
 
 namespace voxelformat {
 
@@ -29,6 +33,52 @@ TEST_F(GLTFFormatTest, testExportMesh) {
 	EXPECT_TRUE(f.saveGroups(sceneGraph, outFilename, outStream, testSaveCtx));
 }
 
+TEST_F(GLTFFormatTest, testExportQuantizedMesh) {
+	scenegraph::SceneGraph sceneGraph;
+	{
+		QBFormat sourceFormat;
+		const core::String filename = "rgb.qb";
+		const io::FilePtr &file = open(filename);
+		io::FileStream stream(file);
+		ASSERT_TRUE(sourceFormat.load(filename, stream, sceneGraph, testLoadCtx));
+	}
+	ASSERT_TRUE(sceneGraph.size() > 0);
+	const core::VarPtr &quantize = core::Var::getSafe(cfg::VoxformatGLTFQuantize);
+	const core::String outFilename = "exportrgb.glb";
+
+	io::BufferedReadWriteStream floatStream;
+	{
+		GLTFFormat f;
+		quantize->setVal(false);
+		ASSERT_TRUE(f.saveGroups(sceneGraph, outFilename, floatStream, testSaveCtx));
+	}
+	io::BufferedReadWriteStream quantizedStream;
+	{
+		GLTFFormat f;
+		quantize->setVal(true);
+		ASSERT_TRUE(f.saveGroups(sceneGraph, outFilename, quantizedStream, testSaveCtx));
+		quantize->setVal(false);
+	}
+	EXPECT_LT(quantizedStream.size(), floatStream.size());
+
+	// both exports must voxelize to the same result
+	floatStream.seek(0);
+	quantizedStream.seek(0);
+	GLTFFormat f;
+	scenegraph::SceneGraph floatSceneGraph;
+	scenegraph::SceneGraph quantizedSceneGraph;
+	ASSERT_TRUE(f.loadGroups(outFilename, floatStream, floatSceneGraph, testLoadCtx));
+	ASSERT_TRUE(f.loadGroups(outFilename, quantizedStream, quantizedSceneGraph, testLoadCtx));
+	ASSERT_EQ(floatSceneGraph.size(), quantizedSceneGraph.size());
+	const voxel::RawVolume *floatVolume = (*floatSceneGraph.begin()).volume();
+	const voxel::RawVolume *quantizedVolume = (*quantizedSceneGraph.begin()).volume();
+	ASSERT_NE(nullptr, floatVolume);
+	ASSERT_NE(nullptr, quantizedVolume);
+	EXPECT_EQ(floatVolume->region(), quantizedVolume->region());
+	auto func = [](int, int, int, const voxel::Voxel &) {};
+	EXPECT_EQ(voxelutil::visitVolume(*floatVolume, func), voxelutil::visitVolume(*quantizedVolume, func));
+}
+
 TEST_F(GLTFFormatTest, testImportAnimation) {
 	GLTFFormat f;
 	const core::String filename = "glTF/BoxAnimated.glb";
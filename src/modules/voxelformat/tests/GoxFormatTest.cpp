@@ -19,6 +19,15 @@ TEST_F(GoxFormatTest, testSaveSmallVoxel) {
 	testSaveLoadVoxel("goxel-smallvolumesavetest.gox", &f, -16, 15, voxel::ValidateFlags::None);
 }
 
+TEST_F(GoxFormatTest, testSaveIdenticalBlocks) {
+	// the first two blocks are identical and only written once
+	voxel::RawVolume v(voxel::Region(0, 0, 0, 47, 15, 15));
+	v.fill(v.region(), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	v.setVoxel(40, 8, 8, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	GoxFormat f;
+	testSaveLoadVolume("goxel-identicalblocks.gox", v, &f, voxel::ValidateFlags::None);
+}
+
 TEST_F(GoxFormatTest, testLoadRGB) {
 	testRGB("rgb.gox");
 }
@@ -3,9 +3,14 @@
  */
 
 #include "AbstractVoxFormatTest.h"
+#include "core/GameConfig.h"
+#include "core/StringUtil.h"
+#include "core/Var.h"
+#include "io/FileStream.h"
 #include "voxel/RawVolume.h"
 #include "voxelformat/MCRFormat.h"
 #include "voxelformat/QBFormat.h"
+#include "voxelformat/VolumeFormat.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxelformat/tests/TestHelper.h"
 #include "voxelutil/VolumeVisitor.h"
@@ -15,6 +20,48 @@ namespace voxelformat {
 class MCRFormatTest: public AbstractVoxFormatTest {
 };
 
+TEST_F(MCRFormatTest, testUnpackBlockStates) {
+	for (uint32_t bits = 4; bits <= 13; ++bits) {
+		core::DynamicArray<uint16_t> expected;
+		for (int i = 0; i < MCRFormat::SectionBlocks; ++i) {
+			expected.push_back((uint16_t)((i * 7 + 3) & ((1 << bits) - 1)));
+		}
+
+		// since data version 2529 the indices don't span over two longs
+		core::DynamicArray<int64_t> padded;
+		const int perLong = 64 / (int)bits;
+		for (int i = 0; i < MCRFormat::SectionBlocks; i += perLong) {
+			uint64_t state = 0u;
+			for (int k = 0; k < perLong && i + k < MCRFormat::SectionBlocks; ++k) {
+				state |= (uint64_t)expected[i + k] << (k * bits);
+			}
+			padded.push_back((int64_t)state);
+		}
+		uint16_t indices[MCRFormat::SectionBlocks];
+		ASSERT_TRUE(MCRFormat::unpackBlockStates(2529, padded, bits, indices)) << "bits: " << bits;
+		for (int i = 0; i < MCRFormat::SectionBlocks; ++i) {
+			ASSERT_EQ(expected[i], indices[i]) << "bits: " << bits << " index: " << i;
+		}
+
+		// before data version 2529 the indices are a continuous bit stream
+		core::DynamicArray<int64_t> stream;
+		stream.resize(MCRFormat::SectionBlocks * bits / 64);
+		stream.fill(0);
+		for (int i = 0; i < MCRFormat::SectionBlocks; ++i) {
+			const uint64_t bitPos = (uint64_t)i * bits;
+			const uint64_t offset = bitPos & 63u;
+			stream[bitPos >> 6] = (int64_t)((uint64_t)stream[bitPos >> 6] | ((uint64_t)expected[i] << offset));
+			if (offset + bits > 64u) {
+				stream[(bitPos >> 6) + 1] = (int64_t)((uint64_t)expected[i] >> (64u - offset));
+			}
+		}
+		ASSERT_TRUE(MCRFormat::unpackBlockStates(2528, stream, 0u, indices)) << "bits: " << bits;
+		for (int i = 0; i < MCRFormat::SectionBlocks; ++i) {
+			ASSERT_EQ(expected[i], indices[i]) << "bits: " << bits << " index: " << i;
+		}
+	}
+}
+
 TEST_F(MCRFormatTest, testLoad117) {
 	scenegraph::SceneGraph sceneGraph;
 	canLoad(sceneGraph, "r.0.-2.mca", 128);
@@ -45,4 +92,26 @@ TEST_F(MCRFormatTest, testLoad113) {
 	EXPECT_EQ(17920, cnt);
 }
 
+TEST_F(MCRFormatTest, testLoadBounds) {
+	scenegraph::SceneGraph sceneGraph;
+	canLoad(sceneGraph, "r.0.-2.mca", 128);
+	const scenegraph::SceneGraphNode &node = *sceneGraph.begin(scenegraph::SceneGraphNodeType::Model);
+	voxel::Region bounds = node.region();
+	bounds.setUpperY(bounds.getLowerY() + 2);
+
+	const core::VarPtr &var = core::Var::getSafe(cfg::VoxformatMCRBounds);
+	var->setVal(core::string::format("%i %i %i %i %i %i", bounds.getLowerX(), bounds.getLowerY(), bounds.getLowerZ(),
+									 bounds.getUpperX(), bounds.getUpperY(), bounds.getUpperZ()));
+	scenegraph::SceneGraph filtered;
+	const io::FilePtr &file = open("r.0.-2.mca");
+	io::FileStream stream(file);
+	const bool success = voxelformat::loadFormat("r.0.-2.mca", stream, filtered, testLoadCtx);
+	var->setVal("");
+	ASSERT_TRUE(success);
+	ASSERT_EQ(1u, filtered.size());
+	for (const scenegraph::SceneGraphNode &n : filtered) {
+		EXPECT_TRUE(bounds.containsRegion(n.region())) << n.region().toString();
+	}
+}
+
 }
@@ -151,4 +151,94 @@ TEST_F(MeshFormatTest, testVoxelizeColor) {
 	EXPECT_COLOR_NEAR(nipponGreen, paletteColors[v->voxel(size, size, size).getColor()], 0.00065f);
 }
 
+TEST_F(MeshFormatTest, testVoxelizeTiles) {
+	class TestMesh : public MeshFormat {
+	public:
+		bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &, const core::String &,
+						io::SeekableWriteStream &, const glm::vec3 &, bool, bool, bool) override {
+			return false;
+		}
+		void voxelize(scenegraph::SceneGraph &sceneGraph, const MeshFormat::TriCollection &tris) {
+			voxelizeNode("test", sceneGraph, tris);
+		}
+	};
+
+	// a slope that covers several rasterization tiles
+	const float size = 150.0f;
+	const glm::vec3 corners[4]{{0.0f, 0.0f, 0.0f}, {size, size / 3.0f, 0.0f}, {size, size / 3.0f, size}, {0.0f, 0.0f, size}};
+	MeshFormat::TriCollection tris;
+	Tri tri1;
+	tri1.vertices[0] = corners[0];
+	tri1.vertices[1] = corners[1];
+	tri1.vertices[2] = corners[2];
+	tris.push_back(tri1);
+	Tri tri2;
+	tri2.vertices[0] = corners[0];
+	tri2.vertices[1] = corners[2];
+	tri2.vertices[2] = corners[3];
+	tris.push_back(tri2);
+
+	TestMesh mesh;
+	scenegraph::SceneGraph sceneGraph;
+	mesh.voxelize(sceneGraph, tris);
+	scenegraph::SceneGraphNode *node = sceneGraph.findNodeByName("test");
+	ASSERT_NE(nullptr, node);
+	const voxel::RawVolume *v = node->volume();
+	const voxel::Region &region = v->region();
+	// every column below the slope must be hit - also at the tile borders
+	for (int x = 0; x < (int)size; ++x) {
+		for (int z = 0; z < (int)size; ++z) {
+			bool found = false;
+			for (int y = region.getLowerY(); y <= region.getUpperY() && !found; ++y) {
+				found = !voxel::isAir(v->voxel(x, y, z).getMaterial());
+			}
+			EXPECT_TRUE(found) << x << ":" << z;
+		}
+	}
+}
+
+TEST_F(MeshFormatTest, testMeshQueue) {
+	class TestMesh : public MeshFormat {
+	public:
+		bool saveMeshes(const core::Map<int, int> &, const scenegraph::SceneGraph &, const Meshes &, const core::String &,
+						io::SeekableWriteStream &, const glm::vec3 &, bool, bool, bool) override {
+			return false;
+		}
+		void extract(const scenegraph::SceneGraph &sceneGraph, core::DynamicArray<int> &nodeIds) {
+			MeshQueue queue(sceneGraph, false, false, true, true, false);
+			while (const MeshExt *meshExt = queue.next()) {
+				ASSERT_NE(nullptr, meshExt->mesh);
+				EXPECT_FALSE(meshExt->mesh->isEmpty());
+				nodeIds.push_back(meshExt->nodeId);
+			}
+			EXPECT_EQ((int)nodeIds.size(), queue.meshCount());
+		}
+	};
+
+	scenegraph::SceneGraph sceneGraph;
+	core::DynamicArray<int> expected;
+	for (int i = 0; i < 20; ++i) {
+		voxel::RawVolume *v = new voxel::RawVolume(voxel::Region(0, 3));
+		// every third model node is empty and must be skipped
+		if (i % 3 != 0) {
+			v->setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		}
+		scenegraph::SceneGraphNode node;
+		node.setVolume(v, true);
+		const int nodeId = sceneGraph.emplace(core::move(node));
+		ASSERT_NE(InvalidNodeId, nodeId);
+		if (i % 3 != 0) {
+			expected.push_back(nodeId);
+		}
+	}
+
+	TestMesh mesh;
+	core::DynamicArray<int> nodeIds;
+	mesh.extract(sceneGraph, nodeIds);
+	ASSERT_EQ(expected.size(), nodeIds.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		EXPECT_EQ(expected[i], nodeIds[i]);
+	}
+}
+
 } // namespace voxelformat
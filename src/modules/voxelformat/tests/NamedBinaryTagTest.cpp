@@ -4,6 +4,7 @@
 
 #include "voxelformat/private/NamedBinaryTag.h"
 #include "app/tests/AbstractTest.h"
+#include "core/collection/StringSet.h"
 #include "io/BufferedReadWriteStream.h"
 
 namespace voxelformat {
@@ -29,4 +30,47 @@ TEST_F(NamedBinaryTagTest, testWriteRead) {
 	}
 }
 
+TEST_F(NamedBinaryTagTest, testSkipTags) {
+	io::BufferedReadWriteStream stream;
+	{
+		priv::NBTCompound compound;
+		core::DynamicArray<int64_t> blocks;
+		for (int64_t i = 0; i < 1024; ++i) {
+			blocks.push_back(i * 0x100000001ll);
+		}
+		compound.put("Blocks", priv::NamedBinaryTag(core::move(blocks)));
+		priv::NBTList entities;
+		for (int i = 0; i < 4; ++i) {
+			priv::NBTCompound entity;
+			entity.put("id", priv::NamedBinaryTag(core::String("pig")));
+			entity.put("Health", priv::NamedBinaryTag(10.0f));
+			entities.emplace_back(core::move(entity));
+		}
+		compound.put("Entities", priv::NamedBinaryTag(core::move(entities)));
+		compound.put("Name", priv::NamedBinaryTag(core::String("chunk")));
+		priv::NamedBinaryTag root(core::move(compound));
+		ASSERT_TRUE(priv::NamedBinaryTag::write(root, "rootTagName", stream));
+	}
+	stream.seek(0);
+	{
+		core::StringSet skipTags;
+		skipTags.insert("Entities");
+		priv::NamedBinaryTagContext ctx;
+		ctx.stream = &stream;
+		ctx.skipTags = &skipTags;
+		const priv::NamedBinaryTag &root = priv::NamedBinaryTag::parse(ctx);
+		ASSERT_TRUE(root.valid());
+		EXPECT_FALSE(root.get("Entities").valid());
+		const core::String *name = root.get("Name").string();
+		ASSERT_NE(nullptr, name);
+		EXPECT_EQ("chunk", *name);
+		const core::DynamicArray<int64_t> *blocks = root.get("Blocks").longArray();
+		ASSERT_NE(nullptr, blocks);
+		ASSERT_EQ(1024u, blocks->size());
+		for (int64_t i = 0; i < 1024; ++i) {
+			EXPECT_EQ(i * 0x100000001ll, (*blocks)[i]);
+		}
+	}
+}
+
 } // namespace voxelformat
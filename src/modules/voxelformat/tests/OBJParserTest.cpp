@@ -0,0 +1,99 @@
+/**
+ * @file
+ */
+
+#include "voxelformat/private/OBJParser.h"
+#include "app/App.h"
+#include "app/tests/AbstractTest.h"
+#include "core/StringUtil.h"
+
+namespace voxelformat {
+
+class OBJParserTest : public app::AbstractTest {
+protected:
+	bool parse(const core::String &obj, priv::ObjData &data, bool threaded = false) {
+		core::ThreadPool *threadPool = threaded ? &app::App::getInstance()->threadPool() : nullptr;
+		return priv::parseObj((const uint8_t *)obj.c_str(), obj.size(), data, threadPool);
+	}
+};
+
+TEST_F(OBJParserTest, testParse) {
+	const core::String obj = "mtllib test.mtl\n"
+							 "# comment\n"
+							 "v 1.0 2.5 -3e1 0.5 0.25 1\n"
+							 "v -1 0 0 1 1 1\r\n"
+							 "v 0 1 0 0 0 0\n"
+							 "v 0 0 1 1 0 0\n"
+							 "vt 0.5 0.25\n"
+							 "vn 0 1 0\n"
+							 "o first\n"
+							 "usemtl red\n"
+							 "f 1/1/1 2//1 3\n"
+							 "g second\n"
+							 "f -4 -3 -2 -1\n";
+	priv::ObjData data;
+	ASSERT_TRUE(parse(obj, data));
+	ASSERT_EQ(4u, data.positions.size());
+	EXPECT_FLOAT_EQ(1.0f, data.positions[0].x);
+	EXPECT_FLOAT_EQ(2.5f, data.positions[0].y);
+	EXPECT_FLOAT_EQ(-30.0f, data.positions[0].z);
+	ASSERT_EQ(4u, data.colors.size());
+	EXPECT_FLOAT_EQ(0.25f, data.colors[0].y);
+	ASSERT_EQ(1u, data.texcoords.size());
+	ASSERT_EQ(1u, data.materialLibraries.size());
+	EXPECT_EQ("test.mtl", data.materialLibraries[0]);
+	ASSERT_EQ(1u, data.materials.size());
+	EXPECT_EQ("red", data.materials[0]);
+
+	ASSERT_EQ(2u, data.shapes.size());
+	EXPECT_EQ("first", data.shapes[0].name);
+	ASSERT_EQ(1u, data.shapes[0].faces.size());
+	const priv::ObjFace &face = data.shapes[0].faces[0];
+	EXPECT_EQ(0, face.vertices[0]);
+	EXPECT_EQ(2, face.vertices[2]);
+	EXPECT_EQ(0, face.texcoords[0]);
+	EXPECT_EQ(-1, face.texcoords[1]);
+	EXPECT_EQ(0, face.material);
+
+	// the quad is triangulated and keeps the material
+	EXPECT_EQ("second", data.shapes[1].name);
+	ASSERT_EQ(2u, data.shapes[1].faces.size());
+	EXPECT_EQ(0, data.shapes[1].faces[1].vertices[0]);
+	EXPECT_EQ(2, data.shapes[1].faces[1].vertices[1]);
+	EXPECT_EQ(3, data.shapes[1].faces[1].vertices[2]);
+	EXPECT_EQ(0, data.shapes[1].faces[1].material);
+}
+
+TEST_F(OBJParserTest, testInvalidIndex) {
+	priv::ObjData data;
+	EXPECT_FALSE(parse("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", data));
+	EXPECT_FALSE(parse("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n", data));
+}
+
+TEST_F(OBJParserTest, testChunks) {
+	// big enough to get split into several chunks - relative indices point into the previous chunks
+	core::String obj;
+	const int triangles = 100000;
+	for (int i = 0; i < triangles; ++i) {
+		obj += core::string::format("v %i 0 0\nv 0 %i 0\nv 0 0 %i\n", i, i, i);
+		if (i == triangles / 2) {
+			obj += "usemtl half\n";
+		}
+		obj += (i % 2) == 0 ? "f -3 -2 -1\n" : core::string::format("f %i %i %i\n", i * 3 + 1, i * 3 + 2, i * 3 + 3);
+	}
+	priv::ObjData data;
+	ASSERT_TRUE(parse(obj, data, true));
+	EXPECT_EQ((size_t)triangles * 3, data.positions.size());
+	EXPECT_TRUE(data.colors.empty());
+	ASSERT_EQ(1u, data.shapes.size());
+	ASSERT_EQ((size_t)triangles, data.shapes[0].faces.size());
+	for (int i = 0; i < triangles; ++i) {
+		const priv::ObjFace &face = data.shapes[0].faces[i];
+		ASSERT_EQ(i * 3, face.vertices[0]) << "triangle " << i;
+		ASSERT_EQ(i * 3 + 2, face.vertices[2]) << "triangle " << i;
+		ASSERT_EQ(i >= triangles / 2 ? 0 : -1, face.material) << "triangle " << i;
+		ASSERT_FLOAT_EQ((float)i, data.positions[face.vertices[0]].x);
+	}
+}
+
+} // namespace voxelformat
@@ -16,6 +16,11 @@ TEST_F(QBTFormatTest, testLoad) {
 	canLoad("qubicle.qbt", 17);
 }
 
+TEST_F(QBTFormatTest, testLoadMetadata) {
+	testLoadMetadata("qubicle.qbt");
+	testLoadMetadata("rgb_small.qbt");
+}
+
 TEST_F(QBTFormatTest, testLoadRGBSmall) {
 	testRGBSmall("rgb_small.qbt");
 }
@@ -4,6 +4,7 @@
 
 #include "voxelformat/STLFormat.h"
 #include "AbstractVoxFormatTest.h"
+#include "io/BufferedReadWriteStream.h"
 #include "io/File.h"
 #include "io/FileStream.h"
 
@@ -31,4 +32,22 @@ TEST_F(STLFormatTest, testVoxelizeCube) {
 	EXPECT_TRUE(sceneGraph.size() > 0);
 }
 
+TEST_F(STLFormatTest, testVoxelizeTruncatedBinary) {
+	io::BufferedReadWriteStream stream;
+	for (int i = 0; i < 80; ++i) {
+		stream.writeUInt8(0);
+	}
+	// the header announces more faces than the file contains
+	stream.writeUInt32(2);
+	const float face[12] = {0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 10.0f, 0.0f, 0.0f, 0.0f, 10.0f, 0.0f};
+	for (float f : face) {
+		stream.writeFloat(f);
+	}
+	stream.writeUInt16(0);
+	stream.seek(0);
+	STLFormat f;
+	scenegraph::SceneGraph sceneGraph;
+	EXPECT_FALSE(f.loadGroups("truncated.stl", stream, sceneGraph, testLoadCtx));
+}
+
 } // namespace voxel
@@ -90,4 +90,46 @@ TEST_F(TriTest, testColorAt4x4) {
 	}
 }
 
+TEST_F(TriTest, testIntersectsBox) {
+	Tri tri;
+	tri.vertices[0] = glm::vec3(0, 0, 0);
+	tri.vertices[1] = glm::vec3(10, 0, 0);
+	tri.vertices[2] = glm::vec3(0, 10, 10);
+	const glm::vec3 halfSize(0.5f);
+	EXPECT_TRUE(tri.intersectsBox(glm::vec3(0, 0, 0), halfSize));
+	EXPECT_TRUE(tri.intersectsBox(glm::vec3(2, 3, 3), halfSize));
+	// same aabb but away from the triangle plane
+	EXPECT_FALSE(tri.intersectsBox(glm::vec3(2, 3, 6), halfSize));
+	// inside the aabb and on the plane - but outside of the triangle
+	EXPECT_FALSE(tri.intersectsBox(glm::vec3(8, 8, 8), halfSize));
+	EXPECT_FALSE(tri.intersectsBox(glm::vec3(-2, 0, 0), halfSize));
+}
+
+TEST_F(TriTest, testClosestBarycentric) {
+	Tri tri;
+	tri.vertices[0] = glm::vec3(0, 0, 0);
+	tri.vertices[1] = glm::vec3(10, 0, 0);
+	tri.vertices[2] = glm::vec3(0, 10, 0);
+	tri.color[0] = core::RGBA(255, 0, 0);
+	tri.color[1] = core::RGBA(0, 255, 0);
+	tri.color[2] = core::RGBA(0, 0, 255);
+
+	glm::vec3 b = tri.closestBarycentric(glm::vec3(-5, -5, 3));
+	EXPECT_FLOAT_EQ(1.0f, b.x);
+	EXPECT_EQ(tri.color[0], tri.colorAtBarycentric(b));
+
+	b = tri.closestBarycentric(glm::vec3(20, 0, 0));
+	EXPECT_FLOAT_EQ(1.0f, b.y);
+	EXPECT_EQ(tri.color[1], tri.colorAtBarycentric(b));
+
+	b = tri.closestBarycentric(glm::vec3(5, -3, 0));
+	EXPECT_FLOAT_EQ(0.5f, b.x);
+	EXPECT_FLOAT_EQ(0.5f, b.y);
+
+	b = tri.closestBarycentric(glm::vec3(2, 3, 1));
+	EXPECT_NEAR(0.5f, b.x, 0.0001f);
+	EXPECT_NEAR(0.2f, b.y, 0.0001f);
+	EXPECT_NEAR(0.3f, b.z, 0.0001f);
+}
+
 } // namespace voxelformat
@@ -3,11 +3,27 @@
  */
 
 #include "AbstractVoxFormatTest.h"
+#include "core/ScopedPtr.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/FileStream.h"
 #include "voxelformat/VENGIFormat.h"
+#include "voxelformat/VolumeFormat.h"
 
 namespace voxelformat {
 
-class VENGIFormatTest : public AbstractVoxFormatTest {};
+class VENGIFormatTest : public AbstractVoxFormatTest {
+protected:
+	static image::ImagePtr redThumbnail(const scenegraph::SceneGraph &, const ThumbnailContext &ctx) {
+		image::ImagePtr image = image::createEmptyImage("thumbnail");
+		core::DynamicArray<core::RGBA> pixels;
+		pixels.resize(ctx.outputSize.x * ctx.outputSize.y);
+		for (core::RGBA &pixel : pixels) {
+			pixel = core::RGBA(255, 0, 0, 255);
+		}
+		image->loadRGBA((const uint8_t *)pixels.data(), ctx.outputSize.x, ctx.outputSize.y);
+		return image;
+	}
+};
 
 TEST_F(VENGIFormatTest, testSaveSmallVolume) {
 	VENGIFormat f;
@@ -19,4 +35,136 @@ TEST_F(VENGIFormatTest, testSaveLoadVoxel) {
 	testSaveLoadVoxel("testSaveLoadVoxel.vengi", &f);
 }
 
+TEST_F(VENGIFormatTest, testLoadMetadata) {
+	scenegraph::SceneGraph sceneGraph;
+	canLoad(sceneGraph, "vox_character.vox", 16);
+	io::BufferedReadWriteStream stream((int64_t)(10 * 1024 * 1024));
+	ASSERT_TRUE(voxelformat::saveFormat(sceneGraph, "metadata.vengi", nullptr, stream, testSaveCtx));
+	stream.seek(0);
+	testLoadMetadata("metadata.vengi", stream);
+}
+
+TEST_F(VENGIFormatTest, testLoadModels) {
+	scenegraph::SceneGraph sceneGraph;
+	canLoad(sceneGraph, "vox_character.vox", 16);
+	const scenegraph::SceneGraphNode &expected = *sceneGraph.begin(scenegraph::SceneGraphNodeType::Model);
+	int expectedModels = 0;
+	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Model); iter != sceneGraph.end(); ++iter) {
+		if ((*iter).name() == expected.name()) {
+			++expectedModels;
+		}
+	}
+	io::BufferedReadWriteStream stream((int64_t)(10 * 1024 * 1024));
+	ASSERT_TRUE(voxelformat::saveFormat(sceneGraph, "models.vengi", nullptr, stream, testSaveCtx));
+	stream.seek(0);
+
+	VENGIFormat f;
+	scenegraph::SceneGraph partial;
+	core::DynamicArray<core::String> names;
+	names.push_back(expected.name());
+	ASSERT_TRUE(f.loadModels("models.vengi", stream, partial, names, testLoadCtx));
+	ASSERT_EQ((size_t)expectedModels, partial.size(scenegraph::SceneGraphNodeType::Model));
+	const scenegraph::SceneGraphNode &loaded = *partial.begin(scenegraph::SceneGraphNodeType::Model);
+	EXPECT_EQ(expected.name(), loaded.name());
+	voxel::volumeComparator(*expected.volume(), expected.palette(), *loaded.volume(), loaded.palette(), voxel::ValidateFlags::Color);
+}
+
+TEST_F(VENGIFormatTest, testLoadModelFilter) {
+	scenegraph::SceneGraph sceneGraph;
+	canLoad(sceneGraph, "vox_character.vox", 16);
+	const scenegraph::SceneGraphNode &expected = *sceneGraph[2];
+	io::BufferedReadWriteStream stream((int64_t)(10 * 1024 * 1024));
+	ASSERT_TRUE(voxelformat::saveFormat(sceneGraph, "filter.vengi", nullptr, stream, testSaveCtx));
+	stream.seek(0);
+
+	VENGIFormat f;
+	scenegraph::SceneGraph filtered;
+	ModelFilter filter;
+	ASSERT_TRUE(filter.parseIndices("2"));
+	LoadContext ctx = testLoadCtx;
+	ctx.modelFilter = &filter;
+	ASSERT_TRUE(f.load("filter.vengi", stream, filtered, ctx));
+	EXPECT_TRUE(filter.applied);
+	ASSERT_EQ(1u, filtered.size(scenegraph::SceneGraphNodeType::Model));
+	const scenegraph::SceneGraphNode &loaded = *filtered.begin(scenegraph::SceneGraphNodeType::Model);
+	EXPECT_EQ(expected.name(), loaded.name());
+	voxel::volumeComparator(*expected.volume(), expected.palette(), *loaded.volume(), loaded.palette(), voxel::ValidateFlags::Color);
+}
+
+TEST_F(VENGIFormatTest, testLoadVisibleModels) {
+	scenegraph::SceneGraph sceneGraph;
+	canLoad(sceneGraph, "vox_character.vox", 16);
+	scenegraph::SceneGraphNode &hidden = *sceneGraph.begin(scenegraph::SceneGraphNodeType::Model);
+	hidden.setVisible(false);
+	io::BufferedReadWriteStream stream((int64_t)(10 * 1024 * 1024));
+	ASSERT_TRUE(voxelformat::saveFormat(sceneGraph, "lazy.vengi", nullptr, stream, testSaveCtx));
+	stream.seek(0);
+
+	VENGIFormat f;
+	scenegraph::SceneGraph lazy;
+	VENGIFormat::NodeDataLocations hiddenNodes;
+	ASSERT_TRUE(f.loadVisibleModels("lazy.vengi", stream, lazy, hiddenNodes, testLoadCtx));
+	ASSERT_EQ(16u, lazy.size(scenegraph::SceneGraphNodeType::Model));
+	ASSERT_EQ(1u, hiddenNodes.size());
+	const int nodeId = hiddenNodes.begin()->key;
+	const VENGIFormat::NodeDataLocation &location = hiddenNodes.begin()->value;
+	EXPECT_FALSE(lazy.node(nodeId).visible());
+	EXPECT_EQ(hidden.region(), location.region);
+
+	core::ScopedPtr<voxel::RawVolume> v(VENGIFormat::loadNodeVolume(stream, location, lazy.node(nodeId).palette()));
+	ASSERT_TRUE(v);
+	voxel::volumeComparator(*hidden.volume(), hidden.palette(), *v, lazy.node(nodeId).palette(), voxel::ValidateFlags::Color);
+}
+
+TEST_F(VENGIFormatTest, testSaveIncremental) {
+	scenegraph::SceneGraph sceneGraph;
+	canLoad(sceneGraph, "vox_character.vox", 16);
+	VENGIFormat f;
+	VENGIFormat::NodeDataCache cache;
+	{
+		io::BufferedReadWriteStream stream((int64_t)(10 * 1024 * 1024));
+		ASSERT_TRUE(f.saveIncremental(sceneGraph, "incremental.vengi", stream, cache, testSaveCtx));
+	}
+	ASSERT_EQ(16u, cache.size());
+
+	scenegraph::SceneGraphNode &modified = *sceneGraph.begin(scenegraph::SceneGraphNodeType::Model);
+	modified.volume()->setVoxel(modified.region().getLowerCorner(), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	cache.remove(modified.id());
+	auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Model);
+	++iter;
+	const scenegraph::SceneGraphNode &unchanged = *iter;
+	core::SharedPtr<VENGIFormat::CachedNodeData> unchangedData;
+	ASSERT_TRUE(cache.get(unchanged.id(), unchangedData));
+
+	io::BufferedReadWriteStream stream((int64_t)(10 * 1024 * 1024));
+	ASSERT_TRUE(f.saveIncremental(sceneGraph, "incremental.vengi", stream, cache, testSaveCtx));
+	ASSERT_EQ(16u, cache.size());
+	core::SharedPtr<VENGIFormat::CachedNodeData> reusedData;
+	ASSERT_TRUE(cache.get(unchanged.id(), reusedData));
+	EXPECT_EQ(unchangedData.get(), reusedData.get());
+	EXPECT_TRUE(cache.hasKey(modified.id()));
+
+	stream.seek(0);
+	scenegraph::SceneGraph loaded;
+	ASSERT_TRUE(f.load("incremental.vengi", stream, loaded, testLoadCtx));
+	voxel::sceneGraphComparator(sceneGraph, loaded, voxel::ValidateFlags::All);
+}
+
+TEST_F(VENGIFormatTest, testSaveLoadScreenshot) {
+	scenegraph::SceneGraph sceneGraph;
+	canLoad(sceneGraph, "rgb_small.vox");
+	io::BufferedReadWriteStream stream((int64_t)(10 * 1024 * 1024));
+	SaveContext saveCtx;
+	saveCtx.thumbnailCreator = redThumbnail;
+	ASSERT_TRUE(voxelformat::saveFormat(sceneGraph, "screenshot.vengi", nullptr, stream, saveCtx));
+	stream.seek(0);
+	const image::ImagePtr &image = voxelformat::loadScreenshot("screenshot.vengi", stream, testLoadCtx);
+	ASSERT_TRUE(image && image->isLoaded());
+	EXPECT_EQ(128, image->width());
+	EXPECT_EQ(core::RGBA(255, 0, 0, 255), image->colorAt(10, 10));
+	// the thumbnail must not break loading the scene graph
+	stream.seek(0);
+	testLoadMetadata("screenshot.vengi", stream);
+}
+
 } // namespace voxelformat
@@ -26,6 +26,12 @@ TEST_F(VoxFormatTest, testLoad) {
 	canLoad("magicavoxel.vox");
 }
 
+TEST_F(VoxFormatTest, testLoadMetadata) {
+	testLoadMetadata("magicavoxel.vox");
+	testLoadMetadata("vox_character.vox");
+	testLoadMetadata("8ontop.vox");
+}
+
 TEST_F(VoxFormatTest, testLoadCharacter) {
 	VoxFormat f;
 	const io::FilePtr &file = open("vox_character.vox");
@@ -161,6 +167,30 @@ TEST_F(VoxFormatTest, testSaveBigVolume) {
 	EXPECT_EQ(3, (int)sceneGraph.size());
 }
 
+TEST_F(VoxFormatTest, testSaveSharedModels) {
+	VoxFormat f;
+	const voxel::Region region(glm::ivec3(0), glm::ivec3(767, 0, 0));
+	auto saveSize = [&](uint8_t color1, uint8_t color2) {
+		voxel::RawVolume bigVolume(region);
+		bigVolume.setVoxel(0, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, color1));
+		bigVolume.setVoxel(256, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, color2));
+		bigVolume.setVoxel(512, 0, 0, voxel::createVoxel(voxel::VoxelType::Generic, color1));
+		scenegraph::SceneGraph sceneGraphsave(2);
+		scenegraph::SceneGraphNode node;
+		node.setVolume(&bigVolume, false);
+		sceneGraphsave.emplace(core::move(node));
+		io::BufferedReadWriteStream stream(10 * 1024 * 1024);
+		EXPECT_TRUE(f.save(sceneGraphsave, "sharedmodels.vox", stream, testSaveCtx));
+		stream.seek(0);
+		scenegraph::SceneGraph sceneGraph;
+		EXPECT_TRUE(f.load("sharedmodels.vox", stream, sceneGraph, testLoadCtx));
+		EXPECT_EQ(3, (int)sceneGraph.size());
+		return stream.size();
+	};
+	// the identical pieces are only written once
+	EXPECT_LT(saveSize(1, 1), saveSize(1, 2));
+}
+
 TEST_F(VoxFormatTest, testSave) {
 	VoxFormat f;
 	testLoadSaveAndLoad("magicavoxel.vox", f, "magicavoxel-save.vox", f, voxel::ValidateFlags::All);
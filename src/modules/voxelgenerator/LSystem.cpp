@@ -5,6 +5,7 @@
 #include "LSystem.h"
 #include "core/Tokenizer.h"
 #include "core/Log.h"
+#include "core/StandardLib.h"
 
 namespace voxelgenerator {
 namespace lsystem {
@@ -47,5 +48,52 @@ bool parseRules(const core::String& rulesStr, core::DynamicArray<Rule>& rules) {
 	return true;
 }
 
+SentenceStream::SentenceStream(const core::String &axiom, const core::DynamicArray<Rule> &rules, uint8_t iterations)
+	: _axiom(axiom), _iterations(iterations) {
+	for (int i = 0; i < 256; ++i) {
+		_rules[i] = nullptr;
+	}
+	// the first rule for a character wins
+	for (const Rule &rule : rules) {
+		const uint8_t idx = (uint8_t)rule.a;
+		if (_rules[idx] == nullptr) {
+			_rules[idx] = &rule;
+		}
+	}
+	_frames.reserve(iterations + 1);
+	_frames.push_back(Frame{_axiom.c_str(), _axiom.size(), 0u, 0});
+}
+
+bool SentenceStream::next(char &c) {
+	while (!_frames.empty()) {
+		Frame &frame = _frames.back();
+		if (frame.pos >= frame.len) {
+			_frames.pop();
+			continue;
+		}
+		const char current = frame.str[frame.pos++];
+		const int depth = frame.depth;
+		if (depth < _iterations) {
+			const Rule *rule = _rules[(uint8_t)current];
+			if (rule != nullptr) {
+				_frames.push_back(Frame{rule->b.c_str(), rule->b.size(), 0u, depth + 1});
+				continue;
+			}
+		}
+		// characters without a rule are not modified by the remaining iterations
+		c = current;
+		return true;
+	}
+	return false;
+}
+
+void VoxelMask::reset(const glm::ivec3 &mins, const glm::ivec3 &maxs) {
+	_mins = mins;
+	_dim = maxs - mins + 1;
+	const size_t size = (size_t)_dim.x * (size_t)_dim.y * (size_t)_dim.z;
+	_mask.resize(size);
+	core_memset(_mask.data(), 0, size);
+}
+
 }
 }
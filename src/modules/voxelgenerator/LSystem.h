@@ -9,7 +9,7 @@
 #include "core/StringUtil.h"
 #include "math/Random.h"
 #include "core/collection/DynamicArray.h"
-#include "core/collection/Stack.h"
+#include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/rotate_vector.hpp>
@@ -39,6 +39,87 @@ struct Rule {
 
 extern bool parseRules(const core::String& rulesStr, core::DynamicArray<Rule>& rules);
 
+/**
+ * @brief Rewrites the axiom with the given rules without keeping the expanded sentence in memory
+ *
+ * The symbols of the last iteration are returned one by one - the memory usage only depends on the amount of
+ * iterations, not on the length of the sentence.
+ *
+ * @note The rules must outlive the stream
+ */
+class SentenceStream {
+private:
+	struct Frame {
+		const char *str;
+		size_t len;
+		size_t pos;
+		int depth;
+	};
+	const core::String _axiom;
+	core::DynamicArray<Frame> _frames;
+	const Rule *_rules[256];
+	const int _iterations;
+
+public:
+	SentenceStream(const core::String &axiom, const core::DynamicArray<Rule> &rules, uint8_t iterations);
+
+	/**
+	 * @return @c false if the end of the sentence was reached
+	 */
+	bool next(char &c);
+};
+
+/**
+ * @brief Dense mask for the voxels of one turtle command
+ *
+ * The positions are collected first and written row by row afterwards - this way every voxel is only written once.
+ */
+class VoxelMask {
+private:
+	glm::ivec3 _mins{0};
+	glm::ivec3 _dim{0};
+	core::DynamicArray<uint8_t> _mask;
+
+public:
+	/**
+	 * @brief Clears the mask and sets the inclusive bounds of the positions that can be set
+	 */
+	void reset(const glm::ivec3 &mins, const glm::ivec3 &maxs);
+
+	inline void set(const glm::ivec3 &pos) {
+		const glm::ivec3 p = pos - _mins;
+		core_assert(glm::all(glm::greaterThanEqual(p, glm::ivec3(0))) && glm::all(glm::lessThan(p, _dim)));
+		_mask[p.x + p.y * _dim.x + p.z * _dim.x * _dim.y] = 1u;
+	}
+
+	/**
+	 * @brief Fills the runs of set positions - translated by the given offset - in the volume
+	 */
+	template<class Volume>
+	void write(Volume &volume, const glm::ivec3 &offset, const voxel::Voxel &voxel) const {
+		const uint8_t *mask = _mask.data();
+		for (int z = 0; z < _dim.z; ++z) {
+			for (int y = 0; y < _dim.y; ++y) {
+				const uint8_t *row = mask + y * _dim.x + z * _dim.x * _dim.y;
+				int x = 0;
+				while (x < _dim.x) {
+					if (row[x] == 0u) {
+						++x;
+						continue;
+					}
+					const int runStart = x;
+					while (x < _dim.x && row[x] != 0u) {
+						++x;
+					}
+					const glm::ivec3 mins = offset + _mins + glm::ivec3(runStart, y, z);
+					const glm::ivec3 maxs = offset + _mins + glm::ivec3(x - 1, y, z);
+					volume.fill(voxel::Region(mins, maxs), voxel);
+				}
+			}
+		}
+	}
+};
+
 /**
  * @brief Generate voxels according to the given L-System rules
  *
@@ -54,72 +135,71 @@ extern bool parseRules(const core::String& rulesStr, core::DynamicArray<Rule>& r
  * @li @c ! Decrement width
  * @li @c [ Push
  * @li @c ] Pop
+ *
+ * The sentence is expanded while it is interpreted (see SentenceStream) - and the voxels of each line segment and
+ * leaf are written row by row with the @c fill() method of the volume.
  */
 template<class Volume>
-void generate(Volume& volume, const glm::ivec3& position, const core::String &axiom, const core::DynamicArray<Rule> &rules, float angle, float length, float width,
-				 float widthIncrement, uint8_t iterations, math::Random& random, float leafRadius = 8.0f) {
+void generate(Volume& volume, const glm::ivec3& position, const core::String &axiom, const core::DynamicArray<Rule> &rules, float angle, float length,
+				 float width, float widthIncrement, uint8_t iterations, math::Random& random, float leafRadius = 8.0f) {
 	const float leafDistance = glm::round(2.0f * leafRadius);
 	// apply a factor to close potential holes
 	const int leavesVoxelCnt = (int)(glm::pow(leafDistance, 3) * 2.0);
 
 	angle = glm::radians(angle);
-	core::String sentence = axiom;
-	for (int i = 0; i < iterations; i++) {
-		core::String nextSentence = "";
-
-		for (size_t j = 0; j < sentence.size(); ++j) {
-			const char current = sentence[j];
-			bool found = false;
-			for (const auto &rule : rules) {
-				if (rule.a == current) {
-					found = true;
-					nextSentence += rule.b;
-					break;
-				}
-			}
-			if (!found) {
-				nextSentence += current;
-			}
-		}
+	SentenceStream sentence(axiom, rules, iterations);
 
-		sentence = nextSentence;
-	}
-
-	core::Stack<TurtleStep, 512> stack;
+	// the nesting depth grows with the iterations
+	core::DynamicArray<TurtleStep> stack;
 
 	TurtleStep step;
 	step.width = width;
 	step.voxel = voxel::createVoxel(voxel::VoxelType::Generic, 0);
 
-	for (size_t i = 0u; i < sentence.size(); ++i) {
-		const char c = sentence[i];
+	VoxelMask mask;
+	core::DynamicArray<glm::vec3> linePositions;
+	char c;
+	while (sentence.next(c)) {
 		switch (c) {
 		case 'F': {
 			// Draw line forwards
-			for (int j = 0; j < (int)length; j++) {
-				float r = step.width / 2.0f;
+			const int steps = (int)length;
+			if (steps <= 0) {
+				break;
+			}
+			const float r = step.width / 2.0f;
+			linePositions.clear();
+			glm::vec3 mins = step.pos;
+			glm::vec3 maxs = step.pos;
+			for (int j = 0; j < steps; j++) {
+				linePositions.push_back(step.pos);
+				mins = glm::min(mins, step.pos);
+				maxs = glm::max(maxs, step.pos);
+				step.pos += 1.0f * step.rotation;
+			}
+			if (r <= 0.0f) {
+				break;
+			}
+			mask.reset(glm::ivec3(glm::floor(mins - r)) - 1, glm::ivec3(glm::ceil(maxs + r)) + 1);
+			for (const glm::vec3 &pos : linePositions) {
 				for (float x = -r; x < r; x++) {
 					for (float y = -r; y < r; y++) {
 						for (float z = -r; z < r; z++) {
-							const glm::ivec3 dest(glm::round(step.pos + glm::vec3(x, y, z)));
-							volume.setVoxel(position + dest, step.voxel);
+							mask.set(glm::ivec3(glm::round(pos + glm::vec3(x, y, z))));
 						}
 					}
 				}
-				step.pos += 1.0f * step.rotation;
 			}
+			mask.write(volume, position, step.voxel);
 			break;
 		}
 		case '(': {
-			// Set voxel type
-			++i;
-			int begin = i;
-			size_t length = 0u;
-			while (sentence[i] >= '0' && sentence[i] <= '9') {
-				++length;
-				++i;
+			// Set voxel type - the character after the digits is skipped
+			core::String voxelString;
+			char digit;
+			while (sentence.next(digit) && digit >= '0' && digit <= '9') {
+				voxelString += digit;
 			}
-			core::String voxelString(sentence.c_str() + begin, length);
 			const int colorIndex = core::string::toInt(voxelString);
 			if (colorIndex == 0) {
 				step.voxel = voxel::Voxel();
@@ -138,11 +218,12 @@ void generate(Volume& volume, const glm::ivec3& position, const core::String &ax
 
 		case 'L': {
 			// Leaf
+			mask.reset(glm::ivec3(glm::floor(step.pos - leafRadius)) - 1, glm::ivec3(glm::ceil(step.pos + leafRadius)) + 1);
 			for (int i = 0; i < leavesVoxelCnt; i++) {
 				const glm::vec3& r = glm::ballRand(leafRadius);
-				const glm::ivec3 p = position + glm::ivec3(glm::round(step.pos + r));
-				volume.setVoxel(p, step.voxel);
+				mask.set(glm::ivec3(glm::round(step.pos + r)));
 			}
+			mask.write(volume, position, step.voxel);
 			break;
 		}
 
@@ -179,13 +260,15 @@ void generate(Volume& volume, const glm::ivec3& position, const core::String &ax
 
 		case '[':
 			// Push
-			stack.push(step);
+			stack.push_back(step);
 			break;
 
 		case ']':
 			// Pop
-			step = stack.top();
-			stack.pop();
+			if (!stack.empty()) {
+				step = stack.back();
+				stack.pop();
+			}
 			break;
 		}
 	}
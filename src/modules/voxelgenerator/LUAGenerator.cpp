@@ -20,9 +20,12 @@
 #include "voxel/Voxel.h"
 #include "voxel/Palette.h"
 #include "core/Color.h"
+#include "core/Hash.h"
 #include "io/Filesystem.h"
 #include "noise/Simplex.h"
+#include "noise/SimplexBatch.h"
 #include "app/App.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxelfont/VoxelFont.h"
 #include "scenegraph/SceneGraphUtil.h"
 #include "voxelutil/ImageUtils.h"
@@ -77,6 +80,30 @@ static const char *luaVoxel_globaldirtyregion() {
 	return "__global_region";
 }
 
+static const char *luaVoxel_globalfont() {
+	return "__global_font";
+}
+
+static const char *luaVoxel_globalprogress() {
+	return "__global_progress";
+}
+
+struct LuaProgress {
+	const LUAProgressCallback *callback;
+	uint64_t instructions = 0u;
+};
+
+static void luaVoxel_progresshook(lua_State *s, lua_Debug *) {
+	LuaProgress *progress = lua::LUA::globalData<LuaProgress>(s, luaVoxel_globalprogress());
+	if (progress == nullptr) {
+		return;
+	}
+	progress->instructions += LUAGenerator::ProgressInstructions;
+	if (!(*progress->callback)(progress->instructions)) {
+		luaL_error(s, "Script execution was cancelled");
+	}
+}
+
 static const char *luaVoxel_metascenegraphnode() {
 	return "__meta_scenegraphnode";
 }
@@ -168,6 +195,8 @@ static int luaVoxel_volumewrapper_translate(lua_State* s) {
 	const int y = (int)luaL_optinteger(s, 3, 0);
 	const int z = (int)luaL_optinteger(s, 4, 0);
 	volume->volume()->translate(glm::ivec3(x, y, z));
+	// the volume is moved in place - the scene graph must not keep the cached regions
+	volume->node()->markDirty();
 	return 0;
 }
 
@@ -225,6 +254,14 @@ static int luaVoxel_volumewrapper_fillhollow(lua_State *s) {
 	return 0;
 }
 
+static int luaVoxel_volumewrapper_hollow(lua_State *s) {
+	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	const int shellThickness = (int)luaL_optinteger(s, 2, 1);
+	const int removed = voxelutil::hollow(app::App::getInstance()->threadPool(), *volume, shellThickness);
+	lua_pushinteger(s, removed);
+	return 1;
+}
+
 static int luaVoxel_volumewrapper_importheightmap(lua_State *s) {
 	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
 	const core::String imageName = lua_tostring(s, 2);
@@ -275,18 +312,17 @@ static int luaVoxel_volumewrapper_text(lua_State *s) {
 	const int size = (int)luaL_optinteger(s, 7, 16);
 	const int thickness = (int)luaL_optinteger(s, 8, 1);
 	const int spacing = (int)luaL_optinteger(s, 9, 0);
-	voxelfont::VoxelFont font;
-	if (!font.init(ttffont)) {
+	// the font of the state keeps the rasterized glyphs between the calls
+	voxelfont::VoxelFont *font = lua::LUA::globalData<voxelfont::VoxelFont>(s, luaVoxel_globalfont());
+	voxelfont::VoxelFont localFont;
+	if (font == nullptr) {
+		font = &localFont;
+	}
+	if (!font->init(ttffont)) {
 		clua_error(s, "Could not initialize font %s", ttffont);
 	}
-	const char **str = &text;
-	glm::ivec3 pos(x, y, z);
 	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 0);
-	for (int c = core::utf8::next(str); c != -1; c = core::utf8::next(str)) {
-		pos.x += font.renderCharacter(c, size, thickness, pos, *volume, voxel);
-		pos.x += spacing;
-	}
-	font.shutdown();
+	font->renderText(text, size, thickness, spacing, glm::ivec3(x, y, z), *volume, voxel);
 	return 0;
 }
 
@@ -301,6 +337,96 @@ static int luaVoxel_volumewrapper_setvoxel(lua_State* s) {
 	return 1;
 }
 
+/**
+ * @brief Reads either a region or a mins and maxs ivec3 pair from the stack
+ * @return The stack index of the next argument
+ */
+static int luaVoxel_toRegionArg(lua_State *s, int n, voxel::Region &region) {
+	if (luaL_testudata(s, n, luaVoxel_metaregion()) != nullptr) {
+		region = *luaVoxel_toRegion(s, n);
+		return n + 1;
+	}
+	const glm::ivec3 &mins = clua_tovec<glm::ivec3>(s, n);
+	const glm::ivec3 &maxs = clua_tovec<glm::ivec3>(s, n + 1);
+	region = voxel::Region(mins, maxs);
+	return n + 2;
+}
+
+/**
+ * @brief The index of a voxel in the flat tables of the bulk functions - x runs fastest, then y, then z. Lua tables
+ * start at @c 1.
+ */
+static inline lua_Integer luaVoxel_bufferIndex(const voxel::Region &region, int x, int y, int z) {
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	return 1 + (x - mins.x) + (lua_Integer)dim.x * ((y - mins.y) + (lua_Integer)dim.y * (z - mins.z));
+}
+
+static int luaVoxel_volumewrapper_fillregion(lua_State *s) {
+	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	voxel::Region region;
+	const int n = luaVoxel_toRegionArg(s, 2, region);
+	if (!region.isValid()) {
+		return clua_error(s, "Invalid region given");
+	}
+	const voxel::Voxel voxel = luaVoxel_getVoxel(s, n);
+	lua_pushboolean(s, volume->fill(region, voxel) ? 1 : 0);
+	return 1;
+}
+
+static int luaVoxel_volumewrapper_getvoxels(lua_State *s) {
+	const LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	voxel::Region region = volume->region();
+	if (lua_gettop(s) >= 2) {
+		luaVoxel_toRegionArg(s, 2, region);
+	}
+	if (!region.isValid()) {
+		return clua_error(s, "Invalid region given");
+	}
+	const voxel::RawVolume *v = volume->volume();
+	lua_createtable(s, region.voxels(), 0);
+	lua_Integer idx = 1;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				// positions outside of the volume return the border voxel
+				const voxel::Voxel &voxel = v->voxel(x, y, z);
+				lua_pushinteger(s, voxel::isAir(voxel.getMaterial()) ? -1 : voxel.getColor());
+				lua_rawseti(s, -2, idx++);
+			}
+		}
+	}
+	return 1;
+}
+
+static int luaVoxel_volumewrapper_setvoxels(lua_State *s) {
+	LuaRawVolumeWrapper *volume = luaVoxel_tovolumewrapper(s, 1);
+	voxel::Region region;
+	const int n = luaVoxel_toRegionArg(s, 2, region);
+	if (!region.isValid()) {
+		return clua_error(s, "Invalid region given");
+	}
+	luaL_checktype(s, n, LUA_TTABLE);
+	const voxel::Voxel air = voxel::createVoxel(voxel::VoxelType::Air, 0);
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			lua_Integer idx = luaVoxel_bufferIndex(region, region.getLowerX(), y, z);
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x, ++idx) {
+				int isNumber = 0;
+				lua_rawgeti(s, n, idx);
+				const lua_Integer color = lua_tointegerx(s, -1, &isNumber);
+				lua_pop(s, 1);
+				// nil entries keep the existing voxel
+				if (!isNumber) {
+					continue;
+				}
+				volume->setVoxel(x, y, z, color < 0 ? air : voxel::createVoxel(voxel::VoxelType::Generic, (uint8_t)color));
+			}
+		}
+	}
+	return 0;
+}
+
 static int luaVoxel_volumewrapper_gc(lua_State *s) {
 	LuaRawVolumeWrapper* volume = luaVoxel_tovolumewrapper(s, 1);
 	if (volume->dirtyRegion().isValid()) {
@@ -618,6 +744,35 @@ static int luaVoxel_noise_worley3(lua_State* s) {
 	return 1;
 }
 
+/**
+ * @brief Evaluates the simplex noise for all voxels of a region - the values are returned as flat table in the order
+ * of luaVoxel_bufferIndex()
+ */
+static int luaVoxel_noise_simplex3region(lua_State* s) {
+	voxel::Region region;
+	const int n = luaVoxel_toRegionArg(s, 1, region);
+	if (!region.isValid()) {
+		return clua_error(s, "Invalid region given");
+	}
+	const float frequency = (float)luaL_optnumber(s, n, 1.0);
+	const float amplitude = (float)luaL_optnumber(s, n + 1, 1.0);
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	core::DynamicArray<float> values;
+	values.resize(region.voxels());
+	// the noise evaluation doesn't touch the lua state and the rows are distributed over the thread pool
+	noise::noiseGrid(values.data(), mins, dim, frequency, &app::App::getInstance()->threadPool());
+	for (float &value : values) {
+		value *= amplitude;
+	}
+	lua_createtable(s, (int)values.size(), 0);
+	for (size_t i = 0; i < values.size(); ++i) {
+		lua_pushnumber(s, values[i]);
+		lua_rawseti(s, -2, (lua_Integer)i + 1);
+	}
+	return 1;
+}
+
 static int luaVoxel_scenegraph_new_node(lua_State* s) {
 	const char *name = lua_tostring(s, 1);
 	const voxel::Region* region = voxelgenerator::luaVoxel_toRegion(s, 2);
@@ -628,6 +783,9 @@ static int luaVoxel_scenegraph_new_node(lua_State* s) {
 	node.setName(name);
 	node.setVisible(visible);
 	scenegraph::SceneGraph* sceneGraph = lua::LUA::globalData<scenegraph::SceneGraph>(s, luaVoxel_globalscenegraph());
+	if (sceneGraph == nullptr) {
+		return clua_error(s, "The scene graph is not available in main_tile()");
+	}
 	int* currentNodeId = lua::LUA::globalData<int>(s, luaVoxel_globalnodeid());
 	const int nodeId = scenegraph::addNodeToSceneGraph(*sceneGraph, node, *currentNodeId);
 	if (nodeId == -1) {
@@ -640,6 +798,9 @@ static int luaVoxel_scenegraph_new_node(lua_State* s) {
 static int luaVoxel_scenegraph_get_node(lua_State* s) {
 	int nodeId = (int)luaL_optinteger(s, 1, -1);
 	scenegraph::SceneGraph* sceneGraph = lua::LUA::globalData<scenegraph::SceneGraph>(s, luaVoxel_globalscenegraph());
+	if (sceneGraph == nullptr) {
+		return clua_error(s, "The scene graph is not available in main_tile()");
+	}
 	if (nodeId == -1) {
 		nodeId = sceneGraph->activeNode();
 	}
@@ -699,11 +860,15 @@ static void prepareState(lua_State* s) {
 		{"crop", luaVoxel_volumewrapper_crop},
 		{"text", luaVoxel_volumewrapper_text},
 		{"fillHollow", luaVoxel_volumewrapper_fillhollow},
+		{"hollow", luaVoxel_volumewrapper_hollow},
 		{"importHeightmap", luaVoxel_volumewrapper_importheightmap},
 		{"importColoredHeightmap", luaVoxel_volumewrapper_importcoloredheightmap},
 		{"mirrorAxis", luaVoxel_volumewrapper_mirroraxis},
 		{"rotateAxis", luaVoxel_volumewrapper_rotateaxis},
 		{"setVoxel", luaVoxel_volumewrapper_setvoxel},
+		{"fillRegion", luaVoxel_volumewrapper_fillregion},
+		{"voxels", luaVoxel_volumewrapper_getvoxels},
+		{"setVoxels", luaVoxel_volumewrapper_setvoxels},
 		{"__gc", luaVoxel_volumewrapper_gc},
 		{nullptr, nullptr}
 	};
@@ -757,6 +922,7 @@ static void prepareState(lua_State* s) {
 	static const luaL_Reg noiseFuncs[] = {
 		{"noise2", luaVoxel_noise_simplex2},
 		{"noise3", luaVoxel_noise_simplex3},
+		{"noise3Region", luaVoxel_noise_simplex3region},
 		{"noise4", luaVoxel_noise_simplex4},
 		{"fBm2", luaVoxel_noise_fBm2},
 		{"fBm3", luaVoxel_noise_fBm3},
@@ -784,14 +950,71 @@ bool LUAGenerator::init() {
 
 void LUAGenerator::shutdown() {
 	_noise.shutdown();
+	core::ScopedLock lock(_compiledScriptsLock);
+	_compiledScripts.clear();
 }
 
-bool LUAGenerator::argumentInfo(const core::String& luaScript, core::DynamicArray<LUAParameterDescription>& params) {
+static int luaVoxel_dumpwriter(lua_State *, const void *p, size_t sz, void *userData) {
+	core::DynamicArray<uint8_t> *bytecode = (core::DynamicArray<uint8_t> *)userData;
+	bytecode->append((const uint8_t *)p, sz);
+	return 0;
+}
+
+/**
+ * @brief Loads the compiled chunk of a script and runs it once to initialize its global variables
+ */
+static bool luaVoxel_runchunk(lua_State *s, const core::DynamicArray<uint8_t> &bytecode) {
+	if (luaL_loadbufferx(s, (const char *)bytecode.data(), bytecode.size(), "script", "b") != LUA_OK ||
+		lua_pcall(s, 0, LUA_MULTRET, 0) != LUA_OK) {
+		Log::error("%s", lua_tostring(s, -1));
+		return false;
+	}
+	return true;
+}
+
+LUAGenerator::CompiledScriptPtr LUAGenerator::compile(const core::String &luaScript) {
+	const uint64_t key = core::hash64(luaScript.c_str(), luaScript.size());
+	{
+		core::ScopedLock lock(_compiledScriptsLock);
+		CompiledScriptPtr compiled;
+		if (_compiledScripts.get(key, compiled) && compiled->source == luaScript) {
+			return compiled;
+		}
+	}
+
+	core_trace_scoped(LUAGeneratorCompile);
+	lua::LUA lua;
+	if (luaL_loadstring(lua, luaScript.c_str()) != LUA_OK) {
+		Log::error("%s", lua_tostring(lua, -1));
+		return CompiledScriptPtr();
+	}
+	CompiledScriptPtr compiled = core::make_shared<CompiledScript>();
+	compiled->source = luaScript;
+	// the debug information is kept for the line numbers in the error messages
+#if LUA_VERSION_NUM >= 503
+	const int error = lua_dump(lua, luaVoxel_dumpwriter, &compiled->bytecode, 0);
+#else
+	const int error = lua_dump(lua, luaVoxel_dumpwriter, &compiled->bytecode);
+#endif
+	if (error != 0) {
+		Log::error("Failed to dump the compiled script");
+		return CompiledScriptPtr();
+	}
+
+	core::ScopedLock lock(_compiledScriptsLock);
+	if ((int)_compiledScripts.size() >= MaxCompiledScripts) {
+		_compiledScripts.clear();
+	}
+	_compiledScripts.put(key, compiled);
+	return compiled;
+}
+
+static bool luaVoxel_parsearguments(const core::DynamicArray<uint8_t> &bytecode,
+									core::DynamicArray<LUAParameterDescription> &params) {
 	lua::LUA lua;
 
 	// load and run once to initialize the global variables
-	if (luaL_dostring(lua, luaScript.c_str())) {
-		Log::error("%s", lua_tostring(lua, -1));
+	if (!luaVoxel_runchunk(lua, bytecode)) {
 		return false;
 	}
 
@@ -902,6 +1125,28 @@ bool LUAGenerator::argumentInfo(const core::String& luaScript, core::DynamicArra
 	return true;
 }
 
+bool LUAGenerator::argumentInfo(const core::String& luaScript, core::DynamicArray<LUAParameterDescription>& params) {
+	const CompiledScriptPtr &compiled = compile(luaScript);
+	if (!compiled) {
+		return false;
+	}
+	{
+		core::ScopedLock lock(_compiledScriptsLock);
+		if (compiled->parametersParsed) {
+			params.append(compiled->parameters.data(), compiled->parameters.size());
+			return compiled->parametersValid;
+		}
+	}
+	core::DynamicArray<LUAParameterDescription> parsed;
+	const bool valid = luaVoxel_parsearguments(compiled->bytecode, parsed);
+	params.append(parsed.data(), parsed.size());
+	core::ScopedLock lock(_compiledScriptsLock);
+	compiled->parameters = core::move(parsed);
+	compiled->parametersParsed = true;
+	compiled->parametersValid = valid;
+	return valid;
+}
+
 static bool luaVoxel_pushargs(lua_State* s, const core::DynamicArray<core::String>& args, const core::DynamicArray<LUAParameterDescription>& argsInfo) {
 	for (size_t i = 0u; i < argsInfo.size(); ++i) {
 		const LUAParameterDescription &d = argsInfo[i];
@@ -968,47 +1213,42 @@ core::DynamicArray<LUAScript> LUAGenerator::listScripts() const {
 	return scripts;
 }
 
-bool LUAGenerator::exec(const core::String &luaScript, scenegraph::SceneGraph &sceneGraph, int nodeId,
-						const voxel::Region &region, const voxel::Voxel &voxel, voxel::Region &dirtyRegion,
-						const core::DynamicArray<core::String> &args) {
-	core::DynamicArray<LUAParameterDescription> argsInfo;
-	if (!argumentInfo(luaScript, argsInfo)) {
-		Log::error("Failed to get argument details");
-		return false;
+/**
+ * @brief Registers the globals and the bindings and runs the script once to initialize its global variables
+ * @param sceneGraph If @c null the scene graph functions are not available (tiled execution)
+ */
+static bool luaVoxel_initState(lua::LUA &lua, const core::DynamicArray<uint8_t> &bytecode, scenegraph::SceneGraph *sceneGraph,
+							   voxel::Region *dirtyRegion, int *nodeId, noise::Noise *noise, voxelfont::VoxelFont *font,
+							   LuaProgress *progress) {
+	if (sceneGraph != nullptr) {
+		lua.newGlobalData<scenegraph::SceneGraph>(luaVoxel_globalscenegraph(), sceneGraph);
 	}
+	lua.newGlobalData<voxel::Region>(luaVoxel_globaldirtyregion(), dirtyRegion);
+	lua.newGlobalData<int>(luaVoxel_globalnodeid(), nodeId);
+	lua.newGlobalData<noise::Noise>(luaVoxel_globalnoise(), noise);
+	lua.newGlobalData<voxelfont::VoxelFont>(luaVoxel_globalfont(), font);
+	prepareState(lua);
 
-	if (!args.empty() && args[0] == "help") {
-		Log::info("Parameter description");
-		for (const auto& e : argsInfo) {
-			Log::info(" %s: %s (default: '%s')", e.name.c_str(), e.description.c_str(), e.defaultValue.c_str());
-		}
-		return true;
+	// replaces the debug hook of the lua state - the script can be cancelled from within the hook
+	if (*progress->callback) {
+		lua.newGlobalData<LuaProgress>(luaVoxel_globalprogress(), progress);
+		lua_sethook(lua, luaVoxel_progresshook, LUA_MASKCOUNT, LUAGenerator::ProgressInstructions);
 	}
 
-	scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
-	voxel::RawVolume *v = node.volume();
-	if (v == nullptr) {
-		Log::error("Node %i has no volume", nodeId);
-		return false;
-	}
-
-	lua::LUA lua;
-	lua.newGlobalData<scenegraph::SceneGraph>(luaVoxel_globalscenegraph(), &sceneGraph);
-	lua.newGlobalData<voxel::Region>(luaVoxel_globaldirtyregion(), &dirtyRegion);
-	lua.newGlobalData<int>(luaVoxel_globalnodeid(), &nodeId);
-	lua.newGlobalData<noise::Noise>(luaVoxel_globalnoise(), &_noise);
-	prepareState(lua);
-
 	// load and run once to initialize the global variables
-	if (luaL_dostring(lua, luaScript.c_str())) {
-		Log::error("%s", lua_tostring(lua, -1));
-		return false;
-	}
+	return luaVoxel_runchunk(lua, bytecode);
+}
 
-	// get main(node, region, color) method
-	lua_getglobal(lua, "main");
+/**
+ * @brief Calls the given entry point of the script with the node, the region, the color and the script arguments
+ */
+static bool luaVoxel_callmain(lua::LUA &lua, const char *function, scenegraph::SceneGraphNode &node,
+							  const voxel::Region &region, const voxel::Voxel &voxel,
+							  const core::DynamicArray<core::String> &args,
+							  const core::DynamicArray<LUAParameterDescription> &argsInfo) {
+	lua_getglobal(lua, function);
 	if (!lua_isfunction(lua, -1)) {
-		Log::error("LUA generator: no main(node, region, color) function found in '%s'", luaScript.c_str());
+		Log::error("LUA generator: no %s(node, region, color) function found", function);
 		return false;
 	}
 
@@ -1047,7 +1287,7 @@ bool LUAGenerator::exec(const core::String &luaScript, scenegraph::SceneGraph &s
 #endif
 
 	if (!luaVoxel_pushargs(lua, args, argsInfo)) {
-		Log::error("Failed to execute main() function with the given number of arguments. Try calling with 'help' as parameter");
+		Log::error("Failed to execute %s() function with the given number of arguments. Try calling with 'help' as parameter", function);
 		return false;
 	}
 
@@ -1056,10 +1296,130 @@ bool LUAGenerator::exec(const core::String &luaScript, scenegraph::SceneGraph &s
 		Log::error("LUA generate script: %s", lua_isstring(lua, -1) ? lua_tostring(lua, -1) : "Unknown Error");
 		return false;
 	}
-
 	return true;
 }
 
+bool LUAGenerator::execTiles(const core::DynamicArray<uint8_t> &bytecode, scenegraph::SceneGraphNode &node,
+							 const voxel::Region &region, const voxel::Voxel &voxel, voxel::Region &dirtyRegion,
+							 const core::DynamicArray<core::String> &args,
+							 const core::DynamicArray<LUAParameterDescription> &argsInfo,
+							 const LUAProgressCallback &progress) {
+	core_trace_scoped(LUAGeneratorExecTiles);
+	voxel::RawVolume *v = node.volume();
+	voxel::Region target = region;
+	target.cropTo(v->region());
+	if (!target.isValid()) {
+		Log::error("The region doesn't intersect the volume");
+		return false;
+	}
+
+	// columns over the full height of the region - most generators work on the xz plane
+	core::DynamicArray<voxel::Region> tiles;
+	for (int z = target.getLowerZ(); z <= target.getUpperZ(); z += TileSize) {
+		for (int x = target.getLowerX(); x <= target.getUpperX(); x += TileSize) {
+			const glm::ivec3 mins(x, target.getLowerY(), z);
+			const glm::ivec3 maxs(core_min(x + TileSize - 1, target.getUpperX()), target.getUpperY(),
+								  core_min(z + TileSize - 1, target.getUpperZ()));
+			tiles.emplace_back(mins, maxs);
+		}
+	}
+
+	struct TileResult {
+		voxel::RawVolume *volume = nullptr;
+		voxel::Region dirtyRegion = voxel::Region::InvalidRegion;
+		bool success = false;
+	};
+	core::DynamicArray<TileResult> results;
+	results.resize(tiles.size());
+
+	// the palette is created lazily - so don't access it from the workers
+	const voxel::Palette &palette = node.palette();
+	app::App::getInstance()->threadPool().parallelFor(0, (int)tiles.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const voxel::Region &tile = tiles[i];
+			TileResult &result = results[i];
+			// every tile is written into its own copy - the merge happens after all tiles are done
+			result.volume = new voxel::RawVolume(*v, tile);
+			scenegraph::SceneGraphNode tileNode(scenegraph::SceneGraphNodeType::Model);
+			tileNode.setVolume(result.volume, false);
+			tileNode.setName(node.name());
+			tileNode.setPalette(palette);
+			int tileNodeId = node.id();
+			LuaProgress luaProgress{&progress};
+			voxelfont::VoxelFont font;
+			lua::LUA lua;
+			if (!luaVoxel_initState(lua, bytecode, nullptr, &result.dirtyRegion, &tileNodeId, &_noise, &font,
+									&luaProgress)) {
+				continue;
+			}
+			result.success = luaVoxel_callmain(lua, "main_tile", tileNode, tile, voxel, args, argsInfo);
+		}
+	});
+
+	bool success = true;
+	for (TileResult &result : results) {
+		success &= result.success;
+		if (result.success && result.dirtyRegion.isValid()) {
+			// only the voxels of the tile are merged - a script that replaces the tile volume (e.g. resize) has no effect
+			const voxel::Region &copied = v->copyRegion(*result.volume, result.dirtyRegion, result.dirtyRegion.getLowerCorner());
+			if (copied.isValid()) {
+				if (dirtyRegion.isValid()) {
+					dirtyRegion.accumulate(copied);
+				} else {
+					dirtyRegion = copied;
+				}
+			}
+		}
+		delete result.volume;
+	}
+	return success;
+}
+
+bool LUAGenerator::exec(const core::String &luaScript, scenegraph::SceneGraph &sceneGraph, int nodeId,
+						const voxel::Region &region, const voxel::Voxel &voxel, voxel::Region &dirtyRegion,
+						const core::DynamicArray<core::String> &args, const LUAProgressCallback &progress) {
+	const CompiledScriptPtr &compiled = compile(luaScript);
+	if (!compiled) {
+		return false;
+	}
+	core::DynamicArray<LUAParameterDescription> argsInfo;
+	if (!argumentInfo(luaScript, argsInfo)) {
+		Log::error("Failed to get argument details");
+		return false;
+	}
+
+	if (!args.empty() && args[0] == "help") {
+		Log::info("Parameter description");
+		for (const auto& e : argsInfo) {
+			Log::info(" %s: %s (default: '%s')", e.name.c_str(), e.description.c_str(), e.defaultValue.c_str());
+		}
+		return true;
+	}
+
+	scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	voxel::RawVolume *v = node.volume();
+	if (v == nullptr) {
+		Log::error("Node %i has no volume", nodeId);
+		return false;
+	}
+
+	voxelfont::VoxelFont font;
+	lua::LUA lua;
+	LuaProgress luaProgress{&progress};
+	if (!luaVoxel_initState(lua, compiled->bytecode, &sceneGraph, &dirtyRegion, &nodeId, &_noise, &font, &luaProgress)) {
+		return false;
+	}
+
+	lua_getglobal(lua, "main_tile");
+	const bool tiled = lua_isfunction(lua, -1);
+	lua_pop(lua, 1);
+	if (tiled) {
+		return execTiles(compiled->bytecode, node, region, voxel, dirtyRegion, args, argsInfo, progress);
+	}
+
+	return luaVoxel_callmain(lua, "main", node, region, voxel, args, argsInfo);
+}
+
 }
 
 #undef GENERATOR_LUA_SANTITY
@@ -5,15 +5,21 @@
 #pragma once
 
 #include "core/IComponent.h"
+#include "core/SharedPtr.h"
 #include "core/String.h"
+#include "core/Trace.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/Lock.h"
 #include "command/CommandCompleter.h"
 #include "noise/Noise.h"
+#include <functional>
 
 struct lua_State;
 
 namespace scenegraph {
 class SceneGraph;
+class SceneGraphNode;
 }
 
 namespace voxel {
@@ -64,18 +70,80 @@ struct LUAScript {
 	}
 };
 
+/**
+ * @brief Is called from a lua hook every @c LUAGenerator::ProgressInstructions instructions of a running script
+ * @param[in] instructions The amount of lua instructions that were executed so far
+ * @return @c false to cancel the script execution
+ */
+using LUAProgressCallback = std::function<bool(uint64_t instructions)>;
+
 class LUAGenerator : public core::IComponent {
+public:
+	/**
+	 * @brief The amount of compiled scripts that are kept - the cache is cleared once more scripts were compiled
+	 */
+	static constexpr int MaxCompiledScripts = 32;
+
 private:
+	/**
+	 * @brief The compiled chunk of a script and its parsed arguments
+	 */
+	struct CompiledScript {
+		core::String source;
+		core::DynamicArray<uint8_t> bytecode;
+		core::DynamicArray<LUAParameterDescription> parameters;
+		bool parametersParsed = false;
+		bool parametersValid = false;
+	};
+	using CompiledScriptPtr = core::SharedPtr<CompiledScript>;
+	/**
+	 * @brief The compiled scripts by the hash of their source - the scripts are only compiled once for
+	 * argumentInfo() and the executions
+	 */
+	core::Map<uint64_t, CompiledScriptPtr, 11> _compiledScripts;
+	core_trace_mutex(core::Lock, _compiledScriptsLock, "LUAGeneratorCompiledScripts");
 	noise::Noise _noise;
+
+	/**
+	 * @return The cached chunk of the given script - or an empty pointer if the script doesn't compile
+	 */
+	CompiledScriptPtr compile(const core::String &luaScript);
+	bool execTiles(const core::DynamicArray<uint8_t> &bytecode, scenegraph::SceneGraphNode &node, const voxel::Region &region,
+				   const voxel::Voxel &voxel, voxel::Region &dirtyRegion, const core::DynamicArray<core::String> &args,
+				   const core::DynamicArray<LUAParameterDescription> &argsInfo, const LUAProgressCallback &progress);
 public:
+	/**
+	 * @brief The amount of lua instructions between two calls of the LUAProgressCallback
+	 */
+	static constexpr int ProgressInstructions = 100000;
+	/**
+	 * @brief The size of the columns a script with a @c main_tile() function is executed for in parallel
+	 */
+	static constexpr int TileSize = 32;
+
 	virtual ~LUAGenerator() {}
 	bool init() override;
 	void shutdown() override;
 
 	core::String load(const core::String& scriptName) const;
 	core::DynamicArray<LUAScript> listScripts() const;
+	/**
+	 * @note The parsed arguments are cached by the script source
+	 */
 	bool argumentInfo(const core::String& luaScript, core::DynamicArray<LUAParameterDescription>& params);
-	bool exec(const core::String& luaScript, scenegraph::SceneGraph &sceneGraph, int nodeId, const voxel::Region& region, const voxel::Voxel& voxel, voxel::Region &dirtyRegion, const core::DynamicArray<core::String>& args = {});
+	/**
+	 * @brief Executes the main() function of the given script for the given node
+	 * @param[in] progress Optional callback that is called periodically while the script is running - it can be used
+	 * to cancel a script. This allows to run the script on a worker thread.
+	 *
+	 * If the script has a @c main_tile() function instead of @c main(), the region is split into columns of
+	 * @c TileSize voxels that are executed in parallel - each by its own lua state. Each tile gets a copy of its part
+	 * of the volume and only sees this part. The modifications are merged into the node volume after all tiles are
+	 * done. Such a script can't access the scene graph and its palette changes are discarded.
+	 * @note The progress callback is called from several threads for a tiled script
+	 * @note Only one script per generator instance may run at a time
+	 */
+	bool exec(const core::String& luaScript, scenegraph::SceneGraph &sceneGraph, int nodeId, const voxel::Region& region, const voxel::Voxel& voxel, voxel::Region &dirtyRegion, const core::DynamicArray<core::String>& args = {}, const LUAProgressCallback &progress = {});
 };
 
 inline auto scriptCompleter(const io::FilesystemPtr& filesystem) {
@@ -6,6 +6,7 @@
 
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Vector.h"
+#include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "core/Assert.h"
 #include "core/Common.h"
@@ -21,6 +22,42 @@ namespace shape {
 
 constexpr int MAX_HEIGHT = 255;
 
+namespace priv {
+
+/**
+ * @brief Determines the samples @c first to @c last of a row that are inside of a shape
+ *
+ * The samples are at @c start + k for @c k in @c [0, @c n]. The interval @c [lo, hi] is the analytic solution for the
+ * row - the ends are verified with the exact @c inside(k) test of the shape to get the same results as testing every
+ * single sample.
+ *
+ * @return @c false if no sample of the row is inside
+ */
+template<class F>
+bool rowSpan(double lo, double hi, double start, int n, F&& inside, int& first, int& last) {
+	first = core_max(0, (int)glm::ceil(lo - start));
+	last = core_min(n, (int)glm::floor(hi - start));
+	if (first > last) {
+		// the interval might be smaller than the distance of two samples
+		first = last = glm::clamp((int)glm::round((lo + hi) * 0.5 - start), 0, n);
+	}
+	while (first > 0 && inside(first - 1)) {
+		--first;
+	}
+	while (last < n && inside(last + 1)) {
+		++last;
+	}
+	while (first <= last && !inside(first)) {
+		++first;
+	}
+	while (last >= first && !inside(last)) {
+		--last;
+	}
+	return first <= last;
+}
+
+}
+
 /**
  * @brief Creates a filled circle
  * @param[in,out] volume The volume (RawVolume) to place the voxels into
@@ -29,29 +66,44 @@ constexpr int MAX_HEIGHT = 255;
  * @param[in] depth The height (z-axis) of the object
  * @param[in] radius The radius that defines the circle
  * @param[in] voxel The Voxel to build the object with
+ * @note The circle is filled row by row with the @c fill() method of the volume
  */
 template<class Volume>
 void createCirclePlane(Volume& volume, const glm::ivec3& center, int width, int depth, double radius, const voxel::Voxel& voxel, math::Axis axis = math::Axis::Y) {
+	if (radius < 0.0 || width < 0 || depth < 0) {
+		return;
+	}
 	const double xRadius = width / 2.0;
 	const double zRadius = depth / 2.0;
+	const double radiusSquared = radius * radius;
 
 	for (double z = -zRadius; z <= zRadius; ++z) {
 		const double distanceZ = glm::pow(z, 2.0);
-		for (double x = -xRadius; x <= xRadius; ++x) {
-			const double distance = glm::sqrt(glm::pow(x, 2.0) + distanceZ);
-			if (distance > radius) {
-				continue;
-			}
-			glm::ivec3 pos;
-			if (axis == math::Axis::X) {
-				pos = glm::ivec3(center.x, center.y + x, center.z + z);
-			} else if (axis == math::Axis::Y) {
-				pos = glm::ivec3(center.x + x, center.y, center.z + z);
-			} else {
-				pos = glm::ivec3(center.x + x, center.y + z, center.z);
-			}
-			volume.setVoxel(pos, voxel);
+		const auto inside = [&] (int k) {
+			const double x = -xRadius + k;
+			return glm::sqrt(glm::pow(x, 2.0) + distanceZ) <= radius;
+		};
+		const double halfSpan = glm::sqrt(core_max(0.0, radiusSquared - distanceZ));
+		int first;
+		int last;
+		if (!priv::rowSpan(-halfSpan, halfSpan, -xRadius, width, inside, first, last)) {
+			continue;
+		}
+		// the same rounding as for the single voxel positions
+		const double x1 = -xRadius + first;
+		const double x2 = -xRadius + last;
+		voxel::Region row;
+		if (axis == math::Axis::X) {
+			const int zPos = (int)(center.z + z);
+			row = voxel::Region(center.x, (int)(center.y + x1), zPos, center.x, (int)(center.y + x2), zPos);
+		} else if (axis == math::Axis::Y) {
+			const int zPos = (int)(center.z + z);
+			row = voxel::Region((int)(center.x + x1), center.y, zPos, (int)(center.x + x2), center.y, zPos);
+		} else {
+			const int yPos = (int)(center.y + z);
+			row = voxel::Region((int)(center.x + x1), yPos, center.z, (int)(center.x + x2), yPos, center.z);
 		}
+		volume.fill(row, voxel);
 	}
 }
 
@@ -388,6 +440,11 @@ void createBezierFunc(Volume& volume, const glm::ivec3& start, const glm::ivec3&
 	}
 }
 
+/**
+ * @brief Creates a torus around the z-axis
+ * @note The x-extents of each (y, z) row are computed analytically - the rows are filled with the @c fill() method of
+ * the volume
+ */
 template<class Volume>
 void createTorus(Volume& volume, const glm::ivec3& center, double minorRadius, double majorRadius, const voxel::Voxel& voxel) {
 	glm::dvec3 mins(-majorRadius - minorRadius, -majorRadius - minorRadius, -majorRadius - minorRadius);
@@ -397,22 +454,58 @@ void createTorus(Volume& volume, const glm::ivec3& center, double minorRadius, d
 	mins += 0.5;
 	maxs += 0.5;
 
+	core::DynamicArray<double> samples;
+	for (double x = mins.x; x <= maxs.x; ++x) {
+		samples.push_back(x);
+	}
+	if (samples.empty()) {
+		return;
+	}
+	const int n = (int)samples.size() - 1;
+
 	const double aPow = glm::pow((double)majorRadius, 2);
 	const double bPow = glm::pow((double)minorRadius, 2);
-	for (double x = mins.x; x <= maxs.x; ++x) {
-		const double xPow = glm::pow(x, 2);
+	for (double z = mins.z; z <= maxs.z; ++z) {
+		const double zPow = glm::pow(z, 2);
+		if (zPow > bPow) {
+			continue;
+		}
+		// the distance to the z-axis of the points inside the torus is in [majorRadius - s, majorRadius + s]
+		const double s = glm::sqrt(bPow - zPow);
+		const double rhoMin = (double)majorRadius - s;
+		const double rhoMax = (double)majorRadius + s;
 		for (double y = mins.y; y <= maxs.y; ++y) {
 			const double yPow = glm::pow(y, 2);
-			for (double z = mins.z; z <= maxs.z; ++z) {
-				// This term is smaller than zero if the point is inside the torus
-				const double zPow = glm::pow(z, 2);
+			const auto inside = [&] (int k) {
+				const double xPow = glm::pow(samples[k], 2);
 				// https://stackoverflow.com/questions/13460711/given-origin-and-radii-how-to-find-out-if-px-y-z-is-inside-torus
 				// (x^2+y^2+z^2+a^2-b^2)^2-4a^2(x^2+y^2)
-				if (glm::pow(xPow + yPow + zPow + aPow - bPow, 2) - 4.0 * aPow * (xPow + yPow) > 0.0) {
-					continue;
+				return glm::pow(xPow + yPow + zPow + aPow - bPow, 2) - 4.0 * aPow * (xPow + yPow) <= 0.0;
+			};
+			const double outerPow = rhoMax * rhoMax - yPow;
+			if (outerPow < 0.0) {
+				continue;
+			}
+			const double outer = glm::sqrt(outerPow);
+			const double innerPow = rhoMin > 0.0 ? rhoMin * rhoMin - yPow : -1.0;
+			const int yPos = center.y + (int)y;
+			const int zPos = center.z + (int)z;
+			const auto fillSpan = [&] (double lo, double hi) {
+				int first;
+				int last;
+				if (!priv::rowSpan(lo, hi, samples[0], n, inside, first, last)) {
+					return;
 				}
-
-				volume.setVoxel(center.x + (int)x, center.y + (int)y, center.z + (int)z, voxel);
+				const voxel::Region row(center.x + (int)samples[first], yPos, zPos, center.x + (int)samples[last], yPos, zPos);
+				volume.fill(row, voxel);
+			};
+			if (innerPow <= 0.0) {
+				// the row doesn't cross the hole of the torus
+				fillSpan(-outer, outer);
+			} else {
+				const double inner = glm::sqrt(innerPow);
+				fillSpan(-outer, -inner);
+				fillSpan(inner, outer);
 			}
 		}
 	}
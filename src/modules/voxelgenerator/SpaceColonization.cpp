@@ -5,6 +5,8 @@
 #include "SpaceColonization.h"
 #include "core/Common.h"
 #include "core/Log.h"
+#include "core/concurrent/ThreadPool.h"
+#include <float.h>
 
 namespace voxelgenerator {
 namespace tree {
@@ -25,6 +27,92 @@ void Branch::reset() {
 	_growDirection = _originalGrowDirection;
 }
 
+BranchGrid::BranchGrid(int maxCells) : _cells(maxCells) {
+}
+
+void BranchGrid::init(float cellSize) {
+	clear();
+	_cellSize = core_max(1.0f, cellSize);
+}
+
+void BranchGrid::clear() {
+	_cells.clear();
+	_size = 0u;
+}
+
+glm::ivec3 BranchGrid::cell(const glm::vec3& position) const {
+	return glm::ivec3(glm::floor(position / _cellSize));
+}
+
+void BranchGrid::add(Branch* branch) {
+	const glm::ivec3& c = cell(branch->_position);
+	auto i = _cells.find(c);
+	if (i == _cells.end()) {
+		_cells.put(c, Cell());
+		i = _cells.find(c);
+	}
+	i->value.push_back(branch);
+	if (_size == 0u) {
+		_mins = _maxs = c;
+	} else {
+		_mins = glm::min(_mins, c);
+		_maxs = glm::max(_maxs, c);
+	}
+	++_size;
+}
+
+void BranchGrid::visit(const glm::ivec3& c, const glm::vec3& position, float& bestDistance2, Branch*& best) const {
+	auto i = _cells.find(c);
+	if (i == _cells.end()) {
+		return;
+	}
+	for (Branch* branch : i->value) {
+		const float distance2 = glm::distance2(branch->_position, position);
+		if (distance2 < bestDistance2) {
+			bestDistance2 = distance2;
+			best = branch;
+		}
+	}
+}
+
+Branch* BranchGrid::closest(const glm::vec3& position) const {
+	if (empty()) {
+		return nullptr;
+	}
+	const glm::ivec3& center = cell(position);
+	Branch* best = nullptr;
+	float bestDistance2 = FLT_MAX;
+	// visit the shells of cells around the position until no cell of the next shell can contain a closer branch
+	for (int r = 0;; ++r) {
+		if (best != nullptr && r >= 2) {
+			const float minDistance = (float)(r - 1) * _cellSize;
+			if (minDistance * minDistance >= bestDistance2) {
+				break;
+			}
+		}
+		const glm::ivec3 mins = glm::max(center - r, _mins);
+		const glm::ivec3 maxs = glm::min(center + r, _maxs);
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			const bool zShell = glm::abs(z - center.z) == r;
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				const bool yzShell = zShell || glm::abs(y - center.y) == r;
+				// inside the shell only the first and the last cell of the row are part of it
+				const int step = yzShell ? 1 : 2 * r;
+				for (int x = center.x - r; x <= center.x + r; x += step) {
+					if (x < mins.x || x > maxs.x) {
+						continue;
+					}
+					visit(glm::ivec3(x, y, z), position, bestDistance2, best);
+				}
+			}
+		}
+		if (glm::all(glm::lessThanEqual(center - r, _mins)) && glm::all(glm::greaterThanEqual(center + r, _maxs))) {
+			break;
+		}
+	}
+	return best;
+}
+
 SpaceColonization::SpaceColonization(const glm::ivec3& position, int branchLength,
 	int attractionPointWidth, int attractionPointHeight, int attractionPointDepth, float branchSize,
 	unsigned int seed, int minDistance, int maxDistance, int attractionPointCount) :
@@ -43,6 +131,7 @@ SpaceColonization::~SpaceColonization() {
 		delete e->value;
 	}
 	_root = nullptr;
+	_grid.clear();
 	_branches.clear();
 	_attractionPoints.clear();
 }
@@ -71,16 +160,16 @@ void SpaceColonization::fillAttractionPoints() {
 	}
 }
 
-void SpaceColonization::grow() {
+void SpaceColonization::grow(core::ThreadPool* threadPool) {
 	int n = 100;
-	while (step() && --n > 0) {
+	while (step(threadPool) && --n > 0) {
 	}
 	if (n <= 0) {
 		Log::warn("Could not finish space colonization growing");
 	}
 }
 
-bool SpaceColonization::step() {
+bool SpaceColonization::step(core::ThreadPool* threadPool) {
 	if (_doneGrowing) {
 		return false;
 	}
@@ -91,49 +180,60 @@ bool SpaceColonization::step() {
 		return false;
 	}
 
-	// process the attraction points
-	for (auto pi = _attractionPoints.begin(); pi != _attractionPoints.end();) {
-		bool attractionPointRemoved = false;
-		AttractionPoint& attractionPoint = *pi;
-
-		attractionPoint._closestBranch = nullptr;
-
-		// Find the nearest branch for this attraction point
-		for (auto bi = _branches.begin(); bi != _branches.end(); ++bi) {
-			Branch* branch = bi->second;
-			const float length2 = (float) glm::round(glm::distance2(branch->_position, attractionPoint._position));
+	if (_grid.empty()) {
+		_grid.init(glm::sqrt((float)_maxDistance2));
+		for (auto e : _branches) {
+			_grid.add(e->value);
+		}
+	}
 
-			// Min attraction point distance reached, we remove it
+	// Find the nearest branch for each attraction point
+	const int n = (int)_attractionPoints.size();
+	core::DynamicArray<uint8_t> reached;
+	reached.resize(n);
+	auto findClosest = [this, &reached] (int start, int end) {
+		for (int i = start; i < end; ++i) {
+			AttractionPoint& attractionPoint = _attractionPoints[i];
+			attractionPoint._closestBranch = _grid.closest(attractionPoint._position);
+			reached[i] = 0u;
 			if (attractionPoint._closestBranch == nullptr) {
-				attractionPoint._closestBranch = branch;
-			} else if (length2 <= _minDistance2) {
-				pi = _attractionPoints.erase(pi);
-				attractionPointRemoved = true;
-				break;
-			} else if (length2 <= _maxDistance2) {
-				// branch in range, determine if it is the nearest
-				if (glm::distance2(attractionPoint._closestBranch->_position, attractionPoint._position) > length2) {
-					attractionPoint._closestBranch = branch;
-				}
+				continue;
+			}
+			const float length2 = (float) glm::round(glm::distance2(attractionPoint._closestBranch->_position, attractionPoint._position));
+			if (length2 <= _minDistance2) {
+				reached[i] = 1u;
 			}
 		}
+	};
+	if (threadPool != nullptr && threadPool->size() > 1) {
+		threadPool->parallelFor(0, n, 64, findClosest);
+	} else {
+		findClosest(0, n);
+	}
 
-		// if the attraction point was removed, skip
-		if (attractionPointRemoved) {
+	// process the attraction points in their order to get the same results for every thread count
+	size_t remaining = 0;
+	for (int i = 0; i < n; ++i) {
+		// Min attraction point distance reached, we remove it
+		if (reached[i]) {
 			continue;
 		}
+		if (remaining != (size_t)i) {
+			_attractionPoints[remaining] = _attractionPoints[i];
+		}
+		const AttractionPoint& attractionPoint = _attractionPoints[remaining++];
 
-		++pi;
-
-		// Set the grow parameters on all the closest branches that are in range
-		if (attractionPoint._closestBranch == nullptr) {
+		// Set the grow parameters on the closest branch - even if it is farther away than the max distance
+		Branch* closestBranch = attractionPoint._closestBranch;
+		if (closestBranch == nullptr) {
 			continue;
 		}
-		const glm::vec3& dir = glm::normalize(attractionPoint._position - attractionPoint._closestBranch->_position);
+		const glm::vec3& dir = glm::normalize(attractionPoint._position - closestBranch->_position);
 		// add to grow direction of branch
-		attractionPoint._closestBranch->_growDirection += dir;
-		++attractionPoint._closestBranch->_attractionPointInfluence;
+		closestBranch->_growDirection += dir;
+		++closestBranch->_attractionPointInfluence;
 	}
+	_attractionPoints.erase(_attractionPoints.begin() + remaining, _attractionPoints.end());
 
 	// Generate the new branches
 	core::DynamicArray<Branch*> newBranches;
@@ -175,6 +275,7 @@ bool SpaceColonization::step() {
 			continue;
 		}
 		_branches.put(branch->_position, branch);
+		_grid.add(branch);
 		branchAdded = true;
 	}
 	newBranches.clear();
@@ -12,6 +12,10 @@
 #include "core/collection/DynamicArray.h"
 #include <glm/gtc/epsilon.hpp>
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxelgenerator {
 namespace tree {
 
@@ -38,6 +42,50 @@ struct Branch {
 	void reset();
 };
 
+/**
+ * @brief Uniform grid over the branch positions to find the closest branch for an attraction point
+ *
+ * The grid is sparse - only the cells that contain branches are allocated. New branches can be added at any time.
+ */
+class BranchGrid {
+private:
+	using Cell = core::DynamicArray<Branch*>;
+	using Cells = core::Map<glm::ivec3, Cell, 256, glm::hash<glm::ivec3>>;
+	Cells _cells;
+	float _cellSize = 1.0f;
+	// the cell bounds of all branches
+	glm::ivec3 _mins{0};
+	glm::ivec3 _maxs{0};
+	size_t _size = 0u;
+
+	glm::ivec3 cell(const glm::vec3& position) const;
+	void visit(const glm::ivec3& cell, const glm::vec3& position, float& bestDistance2, Branch*& best) const;
+
+public:
+	BranchGrid(int maxCells = 4096);
+
+	/**
+	 * @brief Removes all branches and sets the edge length of the cells
+	 */
+	void init(float cellSize);
+	void add(Branch* branch);
+	void clear();
+
+	inline size_t size() const {
+		return _size;
+	}
+
+	inline bool empty() const {
+		return _size == 0u;
+	}
+
+	/**
+	 * @return The closest branch to the given position or @c nullptr if there are no branches
+	 * @note This is safe to call from several threads as long as no branches are added
+	 */
+	Branch* closest(const glm::vec3& position) const;
+};
+
 /**
  * @brief Space colonization algorithm
  *
@@ -70,6 +118,10 @@ protected:
 
 	using Branches = core::Map<glm::vec3, Branch*, 64, glm::hash<glm::vec3>, EqualCompare>;
 	Branches _branches;
+	/**
+	 * The branches of @c _branches - build on the first step() to pick up the modifications of sub classes
+	 */
+	BranchGrid _grid;
 	math::Random _random;
 
 	/**
@@ -98,9 +150,16 @@ public:
 		int minDistance = 6, int maxDistance = 10, int attractionPointCount = 400);
 	~SpaceColonization();
 
-	bool step();
+	/**
+	 * @param threadPool if given, the closest branches of the attraction points are searched on the threads of the pool
+	 * @return @c false if the tree is done growing
+	 */
+	bool step(core::ThreadPool* threadPool = nullptr);
 
-	void grow();
+	/**
+	 * @sa step()
+	 */
+	void grow(core::ThreadPool* threadPool = nullptr);
 
 	template<class Volume>
 	void generateAttractionPoints(Volume& volume, const voxel::Voxel& voxel) const {
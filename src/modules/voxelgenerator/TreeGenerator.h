@@ -4,6 +4,7 @@
 
 #pragma once
 
+#include "app/App.h"
 #include "math/Random.h"
 #include "TreeContext.h"
 #include "Spiral.h"
@@ -303,7 +304,7 @@ template<class Volume>
 void createSpaceColonizationTree(Volume& volume, const voxelgenerator::TreeSpaceColonization& ctx, math::Random& random, const voxel::Voxel &trunkVoxel, const voxel::Voxel &leavesVoxel) {
 	Tree tree(ctx.pos, ctx.trunkHeight, ctx.branchSize, ctx.leavesWidth, ctx.leavesHeight,
 			ctx.leavesDepth, (float)ctx.trunkStrength, ctx.seed, ctx.trunkFactor);
-	tree.grow();
+	tree.grow(&app::App::getInstance()->threadPool());
 	tree.generate(volume, trunkVoxel);
 	const int leafSize = core_max(core_max(ctx.leavesWidth, ctx.leavesHeight), ctx.leavesDepth);
 	SpaceColonization::RandomSize rndSize(random, leafSize);
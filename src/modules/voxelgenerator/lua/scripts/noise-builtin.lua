@@ -32,11 +32,17 @@ local function noise2d(volume, region, color, freq, amplitude, type)
 end
 
 local function noise3d(volume, region, color, freq, amplitude, threshold, type)
-	local visitorSimplex = function (volume, x, y, z)
-		local val = amplitude * noise.noise3(x * freq, y * freq, z * freq)
-		if (val > threshold) then
-			volume:setVoxel(x, y, z, color)
+	if (type == 'simplex') then
+		-- evaluate the noise for the whole region at once and write the voxels with one call
+		local values = noise.noise3Region(region, freq, amplitude)
+		local voxels = {}
+		for i = 1, #values do
+			if (values[i] > threshold) then
+				voxels[i] = color
+			end
 		end
+		volume:setVoxels(region, voxels)
+		return
 	end
 
 	local visitorWorley = function (volume, x, y, z)
@@ -45,14 +51,11 @@ local function noise3d(volume, region, color, freq, amplitude, threshold, type)
 			volume:setVoxel(x, y, z, color)
 		end
 	end
-	local visitor = visitorSimplex
-	if (type == 'worley') then
-		visitor = visitorWorley
-	end
-	vol.visitYXZ(volume, region, visitor)
+	vol.visitYXZ(volume, region, visitorWorley)
 end
 
-function main(volume, region, color, freq, amplitude, dimensions, threshold, type)
+function main(node, region, color, freq, amplitude, dimensions, threshold, type)
+	local volume = node:volume()
 	if (dimensions == 2) then
 		noise2d(volume, region, color, freq, amplitude, type)
 	else
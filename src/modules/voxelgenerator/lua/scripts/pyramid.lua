@@ -14,11 +14,11 @@ function main(node, region, color, n)
 	local maxs = region:maxs()
 	local subtract = 0
 	for y = mins.y, maxs.y do
-		for x = mins.x + subtract, maxs.x - subtract do
-			for z = mins.z + subtract, maxs.z - subtract do
-				volume:setVoxel(x, y, z, color)
-			end
+		if mins.x + subtract > maxs.x - subtract or mins.z + subtract > maxs.z - subtract then
+			break
 		end
+		-- one call per layer instead of one per voxel
+		volume:fillRegion(ivec3.new(mins.x + subtract, y, mins.z + subtract), ivec3.new(maxs.x - subtract, y, maxs.z - subtract), color)
 		if y % n == 0 then
 			subtract = subtract + 1
 		end
@@ -4,6 +4,9 @@
 
 #include "app/tests/AbstractTest.h"
 #include "voxelgenerator/LSystem.h"
+#include "voxel/RawVolume.h"
+#include "voxel/RawVolumeWrapper.h"
+#include "voxelutil/VolumeVisitor.h"
 
 namespace voxelgenerator {
 namespace lsystem {
@@ -24,5 +27,89 @@ TEST(LSystemTests, testParse) {
 	ASSERT_EQ(2u, rules.size());
 }
 
+static core::String expand(const core::String &axiom, const core::DynamicArray<Rule> &rules, int iterations) {
+	core::String sentence = axiom;
+	for (int i = 0; i < iterations; i++) {
+		core::String nextSentence;
+		for (size_t j = 0; j < sentence.size(); ++j) {
+			bool found = false;
+			for (const auto &rule : rules) {
+				if (rule.a == sentence[j]) {
+					found = true;
+					nextSentence += rule.b;
+					break;
+				}
+			}
+			if (!found) {
+				nextSentence += sentence[j];
+			}
+		}
+		sentence = nextSentence;
+	}
+	return sentence;
+}
+
+TEST(LSystemTests, testSentenceStream) {
+	core::DynamicArray<Rule> rules;
+	ASSERT_TRUE(parseRules("{ F F+[!+F-L]B } { B (2)FB } { F ignored }", rules));
+	for (int iterations = 0; iterations < 5; ++iterations) {
+		const core::String &expected = expand("FB", rules, iterations);
+		SentenceStream stream("FB", rules, iterations);
+		core::String sentence;
+		char c;
+		while (stream.next(c)) {
+			sentence += c;
+		}
+		EXPECT_EQ(expected, sentence) << "iterations: " << iterations;
+	}
+}
+
+TEST(LSystemTests, testSentenceStreamManyIterations) {
+	core::DynamicArray<Rule> rules;
+	ASSERT_TRUE(parseRules("{ F FF }", rules));
+	SentenceStream stream("F", rules, 20);
+	int count = 0;
+	char c;
+	while (stream.next(c)) {
+		ASSERT_EQ('F', c);
+		++count;
+	}
+	EXPECT_EQ(1 << 20, count);
+}
+
+TEST(LSystemTests, testGenerateLine) {
+	const voxel::Region region(-10, 10);
+	voxel::RawVolume volume(region);
+	voxel::RawVolumeWrapper wrapper(&volume);
+	core::DynamicArray<Rule> rules;
+	math::Random random;
+	const glm::ivec3 position(1, 0, 0);
+	const float length = 5.0f;
+	const float width = 3.0f;
+	generate(wrapper, position, "(3)F", rules, 25.0f, length, width, 1.0f, 0, random);
+
+	// the per voxel reference implementation
+	voxel::RawVolume expected(region);
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 3);
+	glm::vec3 pos(0.0f);
+	const float r = width / 2.0f;
+	for (int j = 0; j < (int)length; j++) {
+		for (float x = -r; x < r; x++) {
+			for (float y = -r; y < r; y++) {
+				for (float z = -r; z < r; z++) {
+					expected.setVoxel(position + glm::ivec3(glm::round(pos + glm::vec3(x, y, z))), voxel);
+				}
+			}
+		}
+		pos += glm::up;
+	}
+	int count = 0;
+	voxelutil::visitVolume(expected, [&](int x, int y, int z, const voxel::Voxel &v) {
+		EXPECT_EQ(v, volume.voxel(x, y, z)) << "at " << x << ":" << y << ":" << z;
+		++count;
+	});
+	EXPECT_EQ(count, voxelutil::visitVolume(volume, [](int, int, int, const voxel::Voxel &) {}));
+}
+
 }
 }
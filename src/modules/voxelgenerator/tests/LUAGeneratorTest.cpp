@@ -95,6 +95,105 @@ TEST_F(LUAGeneratorTest, testExecute) {
 	EXPECT_NE(0u, volume->voxel(1, 0, 0).getColor());
 }
 
+TEST_F(LUAGeneratorTest, testCancel) {
+	const core::String script = R"(
+		function main(node, region, color)
+			while true do
+				node:volume():setVoxel(0, 0, 0, color)
+			end
+		end
+	)";
+
+	scenegraph::SceneGraph sceneGraph;
+	const voxel::Region region(0, 7);
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(new voxel::RawVolume(region), true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(nodeId, -1);
+
+	LUAGenerator g;
+	ASSERT_TRUE(g.init());
+	int calls = 0;
+	uint64_t lastInstructions = 0u;
+	voxel::Region dirtyRegion = voxel::Region::InvalidRegion;
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	EXPECT_FALSE(g.exec(script, sceneGraph, nodeId, region, voxel, dirtyRegion, {}, [&](uint64_t instructions) {
+		EXPECT_GT(instructions, lastInstructions);
+		lastInstructions = instructions;
+		return ++calls < 3;
+	}));
+	EXPECT_EQ(3, calls);
+	EXPECT_TRUE(dirtyRegion.isValid());
+	g.shutdown();
+}
+
+TEST_F(LUAGeneratorTest, testTranslateRegion) {
+	const core::String script = R"(
+		function main(node, region, color)
+			node:volume():translate(10, 0, 0)
+		end
+	)";
+
+	scenegraph::SceneGraph sceneGraph;
+	const voxel::Region region(0, 7);
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(new voxel::RawVolume(region), true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(nodeId, -1);
+	// fill the region caches of the scene graph
+	EXPECT_EQ(region, sceneGraph.region());
+	EXPECT_EQ(region, sceneGraph.groupRegion());
+
+	LUAGenerator g;
+	ASSERT_TRUE(g.init());
+	voxel::Region dirtyRegion = voxel::Region::InvalidRegion;
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	EXPECT_TRUE(g.exec(script, sceneGraph, nodeId, region, voxel, dirtyRegion));
+	g.shutdown();
+
+	const voxel::Region translated(glm::ivec3(10, 0, 0), glm::ivec3(17, 7, 7));
+	EXPECT_EQ(translated, sceneGraph.region());
+	EXPECT_EQ(translated, sceneGraph.groupRegion());
+}
+
+TEST_F(LUAGeneratorTest, testExecuteTiles) {
+	const core::String script = R"(
+		function main_tile(node, region, color)
+			local volume = node:volume()
+			local mins = region:mins()
+			local maxs = region:maxs()
+			volume:fillRegion(region, color)
+			-- the tile only sees its own voxels
+			if volume:setVoxel(maxs.x + 1, mins.y, mins.z, color) then
+				error("voxel outside of the tile was set")
+			end
+		end
+	)";
+
+	scenegraph::SceneGraph sceneGraph;
+	const voxel::Region region(0, 0, 0, 70, 3, 40);
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(new voxel::RawVolume(region), true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(nodeId, -1);
+
+	LUAGenerator g;
+	ASSERT_TRUE(g.init());
+	voxel::Region dirtyRegion = voxel::Region::InvalidRegion;
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 3);
+	EXPECT_TRUE(g.exec(script, sceneGraph, nodeId, region, voxel, dirtyRegion));
+	EXPECT_EQ(region, dirtyRegion);
+	const voxel::RawVolume *volume = sceneGraph.node(nodeId).volume();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				ASSERT_EQ(3u, volume->voxel(x, y, z).getColor()) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+	g.shutdown();
+}
+
 TEST_F(LUAGeneratorTest, testArgumentInfo) {
 	const core::String script = R"(
 		function arguments()
@@ -120,6 +219,31 @@ TEST_F(LUAGeneratorTest, testArgumentInfo) {
 	g.shutdown();
 }
 
+TEST_F(LUAGeneratorTest, testArgumentInfoCached) {
+	const core::String script = R"(
+		function arguments()
+			return {
+					{ name = 'name', desc = 'desc', type = 'int' }
+				}
+		end
+	)";
+	const core::String invalidScript = "function arguments(";
+
+	LUAGenerator g;
+	ASSERT_TRUE(g.init());
+
+	for (int i = 0; i < 2; ++i) {
+		core::DynamicArray<LUAParameterDescription> params;
+		EXPECT_TRUE(g.argumentInfo(script, params)) << "Run " << i;
+		ASSERT_EQ(1u, params.size()) << "Run " << i;
+		EXPECT_STREQ("name", params[0].name.c_str());
+		EXPECT_EQ(LUAParameterType::Integer, params[0].type);
+		EXPECT_FALSE(g.argumentInfo(invalidScript, params)) << "Run " << i;
+		EXPECT_EQ(1u, params.size()) << "Run " << i;
+	}
+	g.shutdown();
+}
+
 TEST_F(LUAGeneratorTest, testArguments) {
 	const core::String script = R"(
 		function arguments()
@@ -158,6 +282,82 @@ TEST_F(LUAGeneratorTest, testSceneGraph) {
 	run(sceneGraph, script);
 }
 
+TEST_F(LUAGeneratorTest, testBulkVoxels) {
+	const core::String script = R"(
+		function main(node, region, color)
+			local volume = node:volume()
+			volume:fillRegion(ivec3.new(4, 4, 4), ivec3.new(7, 7, 7), color)
+			local buffer = volume:voxels(region)
+			if #buffer ~= 512 then
+				error("unexpected buffer size " .. #buffer)
+			end
+			-- x runs fastest, then y, then z
+			if buffer[1] ~= color or buffer[2] ~= -1 or buffer[1 + 2 * 64] ~= -1 then
+				error("unexpected buffer content")
+			end
+			local values = noise.noise3Region(region, 0.1)
+			if #values ~= 512 then
+				error("unexpected noise buffer size " .. #values)
+			end
+			local out = {}
+			for i = 1, #values do
+				if values[i] > 0.5 then
+					out[i] = color
+				end
+			end
+			out[2] = -1
+			volume:setVoxels(region, out)
+		end
+	)";
+	scenegraph::SceneGraph sceneGraph;
+	run(sceneGraph, script, {}, true);
+	const voxel::RawVolume *volume = sceneGraph.node(sceneGraph.activeNode()).volume();
+	EXPECT_EQ(42u, volume->voxel(4, 4, 4).getColor());
+	EXPECT_EQ(42u, volume->voxel(7, 7, 7).getColor());
+	EXPECT_FALSE(voxel::isAir(volume->voxel(0, 0, 0).getMaterial())) << "nil entries must keep the voxel";
+	EXPECT_TRUE(voxel::isAir(volume->voxel(1, 0, 0).getMaterial()));
+}
+
+TEST_F(LUAGeneratorTest, testText) {
+	const core::String script = R"(
+		function main(node, region, color)
+			local volume = node:volume()
+			volume:text("font.ttf", "Ab", 0, 2, 0, 16, 1)
+			-- the second call uses the cached glyphs
+			volume:text("font.ttf", "Ab", 0, 2, 4, 16, 2)
+		end
+	)";
+
+	scenegraph::SceneGraph sceneGraph;
+	const voxel::Region region(0, 0, 0, 63, 31, 7);
+	scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+	node.setVolume(new voxel::RawVolume(region), true);
+	const int nodeId = sceneGraph.emplace(core::move(node));
+	ASSERT_NE(nodeId, -1);
+
+	LUAGenerator g;
+	ASSERT_TRUE(g.init());
+	voxel::Region dirtyRegion = voxel::Region::InvalidRegion;
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 3);
+	EXPECT_TRUE(g.exec(script, sceneGraph, nodeId, region, voxel, dirtyRegion));
+	EXPECT_TRUE(dirtyRegion.isValid());
+	const voxel::RawVolume *volume = sceneGraph.node(nodeId).volume();
+	int count = 0;
+	for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+		for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+			const bool solid = !voxel::isAir(volume->voxel(x, y, 0).getMaterial());
+			if (solid) {
+				++count;
+			}
+			ASSERT_EQ(solid, !voxel::isAir(volume->voxel(x, y, 4).getMaterial())) << x << ":" << y;
+			ASSERT_EQ(solid, !voxel::isAir(volume->voxel(x, y, 5).getMaterial())) << x << ":" << y;
+			ASSERT_TRUE(voxel::isAir(volume->voxel(x, y, 1).getMaterial())) << x << ":" << y;
+		}
+	}
+	EXPECT_GT(count, 0);
+	g.shutdown();
+}
+
 TEST_F(LUAGeneratorTest, testScriptCover) {
 	scenegraph::SceneGraph sceneGraph;
 	runFile(sceneGraph, "cover.lua");
@@ -183,6 +383,11 @@ TEST_F(LUAGeneratorTest, testScriptPyramid) {
 	runFile(sceneGraph, "pyramid.lua", {}, true);
 }
 
+TEST_F(LUAGeneratorTest, testScriptNoiseBuiltin) {
+	scenegraph::SceneGraph sceneGraph;
+	runFile(sceneGraph, "noise-builtin.lua", {"0.3", "1.0", "3", "0.15"}, true);
+}
+
 TEST_F(LUAGeneratorTest, testScriptPlanet) {
 	scenegraph::SceneGraph sceneGraph;
 	runFile(sceneGraph, "planet.lua", {}, true);
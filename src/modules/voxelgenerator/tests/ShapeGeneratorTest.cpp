@@ -144,4 +144,69 @@ TEST_F(ShapeGeneratorTest, testCreateCylinder) {
 	verify("cylinder.qb");
 }
 
+TEST_F(ShapeGeneratorTest, testCreateCirclePlaneRows) {
+	const voxel::Region region(-20, 20);
+	for (math::Axis axis : {math::Axis::X, math::Axis::Y, math::Axis::Z}) {
+		for (int size = 1; size <= 13; size += 3) {
+			voxel::RawVolume volume(region);
+			voxel::RawVolume expected(region);
+			const glm::ivec3 center(-1, 2, 0);
+			const double radius = size / 2.0 - 0.3;
+			voxel::RawVolumeWrapper wrapper(&volume);
+			shape::createCirclePlane(wrapper, center, size, size + 2, radius, _voxel, axis);
+			// the per voxel reference implementation
+			for (double z = -(size + 2) / 2.0; z <= (size + 2) / 2.0; ++z) {
+				for (double x = -size / 2.0; x <= size / 2.0; ++x) {
+					if (glm::sqrt(glm::pow(x, 2.0) + glm::pow(z, 2.0)) > radius) {
+						continue;
+					}
+					glm::ivec3 pos;
+					if (axis == math::Axis::X) {
+						pos = glm::ivec3(center.x, center.y + x, center.z + z);
+					} else if (axis == math::Axis::Y) {
+						pos = glm::ivec3(center.x + x, center.y, center.z + z);
+					} else {
+						pos = glm::ivec3(center.x + x, center.y + z, center.z);
+					}
+					expected.setVoxel(pos, _voxel);
+				}
+			}
+			volumeComparator(expected, voxel::getPalette(), volume, voxel::getPalette());
+		}
+	}
+}
+
+TEST_F(ShapeGeneratorTest, testCreateTorus) {
+	const voxel::Region region(-20, 20);
+	voxel::RawVolume volume(region);
+	voxel::RawVolume expected(region);
+	const glm::ivec3 center(1, -2, 0);
+	const double minorRadius = 3.3;
+	const double majorRadius = 9.1;
+	voxel::RawVolumeWrapper wrapper(&volume);
+	shape::createTorus(wrapper, center, minorRadius, majorRadius, _voxel);
+	// the per voxel reference implementation
+	const double mins = -majorRadius - minorRadius + 0.5;
+	const double maxs = majorRadius + minorRadius + 0.5;
+	const double aPow = glm::pow(majorRadius, 2);
+	const double bPow = glm::pow(minorRadius, 2);
+	int count = 0;
+	for (double x = mins; x <= maxs; ++x) {
+		const double xPow = glm::pow(x, 2);
+		for (double y = mins; y <= maxs; ++y) {
+			const double yPow = glm::pow(y, 2);
+			for (double z = mins; z <= maxs; ++z) {
+				const double zPow = glm::pow(z, 2);
+				if (glm::pow(xPow + yPow + zPow + aPow - bPow, 2) - 4.0 * aPow * (xPow + yPow) > 0.0) {
+					continue;
+				}
+				expected.setVoxel(center.x + (int)x, center.y + (int)y, center.z + (int)z, _voxel);
+				++count;
+			}
+		}
+	}
+	ASSERT_GT(count, 0);
+	volumeComparator(expected, voxel::getPalette(), volume, voxel::getPalette());
+}
+
 }
@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "core/concurrent/ThreadPool.h"
+#include "math/Random.h"
+#include "voxelgenerator/SpaceColonization.h"
+#include <float.h>
+
+namespace voxelgenerator {
+namespace tree {
+
+class SpaceColonizationTest : public app::AbstractTest {
+protected:
+	class TestSpaceColonization : public SpaceColonization {
+	public:
+		using SpaceColonization::SpaceColonization;
+
+		core::DynamicArray<glm::vec3> branchPositions() const {
+			core::DynamicArray<glm::vec3> positions;
+			for (const auto &e : _branches) {
+				positions.push_back(e->value->_position);
+			}
+			positions.sort([](const glm::vec3 &a, const glm::vec3 &b) {
+				if (a.x != b.x) {
+					return a.x > b.x;
+				}
+				if (a.y != b.y) {
+					return a.y > b.y;
+				}
+				return a.z > b.z;
+			});
+			return positions;
+		}
+
+		size_t attractionPoints() const {
+			return _attractionPoints.size();
+		}
+	};
+};
+
+TEST_F(SpaceColonizationTest, testBranchGridClosest) {
+	math::Random random(42);
+	core::DynamicArray<Branch *> branches;
+	BranchGrid grid;
+	grid.init(10.0f);
+	for (int i = 0; i < 200; ++i) {
+		const glm::vec3 pos(random.randomf(-50.0f, 50.0f), random.randomf(0.0f, 80.0f), random.randomf(-50.0f, 50.0f));
+		Branch *branch = new Branch(nullptr, pos, glm::up, 1.0f);
+		branches.push_back(branch);
+		grid.add(branch);
+	}
+	ASSERT_EQ(branches.size(), grid.size());
+	for (int i = 0; i < 500; ++i) {
+		// also test positions outside of the cells that contain branches
+		const glm::vec3 pos(random.randomf(-150.0f, 150.0f), random.randomf(-50.0f, 200.0f),
+							random.randomf(-150.0f, 150.0f));
+		float expected = FLT_MAX;
+		for (Branch *b : branches) {
+			expected = core_min(expected, glm::distance2(b->_position, pos));
+		}
+		const Branch *closest = grid.closest(pos);
+		ASSERT_NE(nullptr, closest);
+		EXPECT_FLOAT_EQ(expected, glm::distance2(closest->_position, pos));
+	}
+	for (Branch *b : branches) {
+		delete b;
+	}
+}
+
+TEST_F(SpaceColonizationTest, testGrowParallel) {
+	const glm::ivec3 position(0, 0, 0);
+	TestSpaceColonization serial(position, 4, 40, 40, 40, 4.0f, 1337U);
+	serial.grow();
+	const core::DynamicArray<glm::vec3> &expected = serial.branchPositions();
+	ASSERT_GT(expected.size(), 1u);
+	EXPECT_LT(serial.attractionPoints(), 400u);
+
+	core::ThreadPool pool(4);
+	pool.init();
+	TestSpaceColonization parallel(position, 4, 40, 40, 40, 4.0f, 1337U);
+	parallel.grow(&pool);
+	pool.shutdown();
+	const core::DynamicArray<glm::vec3> &positions = parallel.branchPositions();
+	ASSERT_EQ(expected.size(), positions.size());
+	for (size_t i = 0; i < expected.size(); ++i) {
+		EXPECT_EQ(expected[i], positions[i]) << "Branch " << i << " differs";
+	}
+	EXPECT_EQ(serial.attractionPoints(), parallel.attractionPoints());
+}
+
+} // namespace tree
+} // namespace voxelgenerator
@@ -0,0 +1,206 @@
+/**
+ * @file
+ */
+
+#include "BrickMap.h"
+#include "app/App.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelrender {
+
+static inline uint32_t encodeVoxel(const voxel::Voxel &voxel) {
+	return (uint32_t)voxel.getMaterial() | ((uint32_t)voxel.getFlags() << 5u) | ((uint32_t)voxel.getColor() << 8u);
+}
+
+bool BrickMap::encodeBrick(const voxel::RawVolume &volume, const glm::ivec3 &brick, uint32_t *words) const {
+	core_memset(words, 0, BrickWords * sizeof(uint32_t));
+	const glm::ivec3 mins = _region.getLowerCorner() + brick * BrickSize;
+	const glm::ivec3 maxs = glm::min(mins + (BrickSize - 1), _region.getUpperCorner());
+	bool empty = true;
+	for (int z = mins.z; z <= maxs.z; ++z) {
+		for (int y = mins.y; y <= maxs.y; ++y) {
+			for (int x = mins.x; x <= maxs.x; ++x) {
+				const voxel::Voxel &voxel = volume.voxel(x, y, z);
+				if (voxel::isAir(voxel.getMaterial())) {
+					continue;
+				}
+				const int idx = (x - mins.x) + (y - mins.y) * BrickSize + (z - mins.z) * BrickSize * BrickSize;
+				words[idx >> 1] |= encodeVoxel(voxel) << ((idx & 1) * 16);
+				empty = false;
+			}
+		}
+	}
+	return !empty;
+}
+
+uint32_t BrickMap::allocateSlot() {
+	if (!_freeSlots.empty()) {
+		const uint32_t slot = _freeSlots.back();
+		_freeSlots.pop();
+		return slot;
+	}
+	const uint32_t slot = slots();
+	_bricks.resize(_bricks.size() + BrickWords);
+	return slot;
+}
+
+void BrickMap::markGridDirty(size_t gridIndex) {
+	if (_dirtyGridStart == _dirtyGridEnd) {
+		_dirtyGridStart = gridIndex;
+		_dirtyGridEnd = gridIndex + 1u;
+		return;
+	}
+	_dirtyGridStart = core_min(_dirtyGridStart, gridIndex);
+	_dirtyGridEnd = core_max(_dirtyGridEnd, gridIndex + 1u);
+}
+
+void BrickMap::setBrick(size_t gridIndex, const uint32_t *words) {
+	uint32_t &entry = _grid[gridIndex];
+	if (words == nullptr) {
+		if (entry != EmptyBrick) {
+			_freeSlots.push_back(entry - 1u);
+			entry = EmptyBrick;
+			markGridDirty(gridIndex);
+		}
+		return;
+	}
+	if (entry == EmptyBrick) {
+		entry = allocateSlot() + 1u;
+		markGridDirty(gridIndex);
+	}
+	const uint32_t slot = entry - 1u;
+	core_memcpy(&_bricks[(size_t)slot * BrickWords], words, BrickWords * sizeof(uint32_t));
+	_dirtySlots.push_back(slot);
+}
+
+void BrickMap::build(const voxel::RawVolume &volume) {
+	core_trace_scoped(BrickMapBuild);
+	clear();
+	_region = volume.region();
+	if (!_region.isValid()) {
+		return;
+	}
+	_gridSize = (_region.getDimensionsInVoxels() + (BrickSize - 1)) / BrickSize;
+	_grid.resize((size_t)_gridSize.x * _gridSize.y * _gridSize.z);
+
+	// every layer of bricks is encoded on its own - the slots are assigned in the order of the layers afterwards
+	struct Layer {
+		core::DynamicArray<uint32_t> gridIndices;
+		core::DynamicArray<uint32_t> words;
+	};
+	core::DynamicArray<Layer> layers;
+	layers.resize(_gridSize.z);
+	app::App::getInstance()->threadPool().parallelFor(0, _gridSize.z, 1, [&](int start, int end) {
+		uint32_t words[BrickWords];
+		for (int z = start; z < end; ++z) {
+			Layer &layer = layers[z];
+			for (int y = 0; y < _gridSize.y; ++y) {
+				for (int x = 0; x < _gridSize.x; ++x) {
+					const glm::ivec3 brick(x, y, z);
+					if (!encodeBrick(volume, brick, words)) {
+						continue;
+					}
+					layer.gridIndices.push_back((uint32_t)gridIndex(brick));
+					layer.words.append(words, BrickWords);
+				}
+			}
+		}
+	});
+
+	size_t bricks = 0u;
+	for (const Layer &layer : layers) {
+		bricks += layer.gridIndices.size();
+	}
+	_bricks.reserve(bricks * BrickWords);
+	for (const Layer &layer : layers) {
+		for (size_t i = 0; i < layer.gridIndices.size(); ++i) {
+			_grid[layer.gridIndices[i]] = slots() + 1u;
+			_bricks.append(&layer.words[i * BrickWords], BrickWords);
+		}
+	}
+	// everything has to be uploaded
+	_dirtySlots.clear();
+	_rebuilt = true;
+	_dirtyGridStart = 0u;
+	_dirtyGridEnd = _grid.size();
+}
+
+void BrickMap::update(const voxel::RawVolume &volume, const voxel::Region &region) {
+	if (volume.region() != _region) {
+		build(volume);
+		return;
+	}
+	voxel::Region cropped = region;
+	cropped.cropTo(_region);
+	if (!cropped.isValid()) {
+		return;
+	}
+	core_trace_scoped(BrickMapUpdate);
+	const glm::ivec3 brickMins = (cropped.getLowerCorner() - _region.getLowerCorner()) / BrickSize;
+	const glm::ivec3 brickMaxs = (cropped.getUpperCorner() - _region.getLowerCorner()) / BrickSize;
+	uint32_t words[BrickWords];
+	for (int z = brickMins.z; z <= brickMaxs.z; ++z) {
+		for (int y = brickMins.y; y <= brickMaxs.y; ++y) {
+			for (int x = brickMins.x; x <= brickMaxs.x; ++x) {
+				const glm::ivec3 brick(x, y, z);
+				if (encodeBrick(volume, brick, words)) {
+					setBrick(gridIndex(brick), words);
+				} else {
+					setBrick(gridIndex(brick), nullptr);
+				}
+			}
+		}
+	}
+}
+
+void BrickMap::clear() {
+	_region = voxel::Region::InvalidRegion;
+	_gridSize = glm::ivec3(0);
+	_grid.clear();
+	_bricks.clear();
+	_freeSlots.clear();
+	markClean();
+}
+
+uint32_t BrickMap::brick(const glm::ivec3 &brick) const {
+	if (glm::any(glm::lessThan(brick, glm::ivec3(0))) || glm::any(glm::greaterThanEqual(brick, _gridSize))) {
+		return EmptyBrick;
+	}
+	return _grid[gridIndex(brick)];
+}
+
+voxel::Voxel BrickMap::voxel(const glm::ivec3 &pos) const {
+	if (!_region.containsPoint(pos)) {
+		return voxel::Voxel();
+	}
+	const glm::ivec3 local = pos - _region.getLowerCorner();
+	const uint32_t entry = brick(local / BrickSize);
+	if (entry == EmptyBrick) {
+		return voxel::Voxel();
+	}
+	const glm::ivec3 inner = local % BrickSize;
+	const int idx = inner.x + inner.y * BrickSize + inner.z * BrickSize * BrickSize;
+	const uint32_t value = (_bricks[(size_t)(entry - 1u) * BrickWords + (idx >> 1)] >> ((idx & 1) * 16)) & 0xFFFFu;
+	return voxel::Voxel((voxel::VoxelType)(value & 0x1Fu), (uint8_t)(value >> 8u), (uint8_t)((value >> 5u) & 0x7u));
+}
+
+bool BrickMap::dirtyGridRange(size_t &start, size_t &count) const {
+	if (_dirtyGridStart == _dirtyGridEnd) {
+		return false;
+	}
+	start = _dirtyGridStart;
+	count = _dirtyGridEnd - _dirtyGridStart;
+	return true;
+}
+
+void BrickMap::markClean() {
+	_dirtySlots.clear();
+	_rebuilt = false;
+	_dirtyGridStart = 0u;
+	_dirtyGridEnd = 0u;
+}
+
+} // namespace voxelrender
@@ -0,0 +1,153 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief A sparse two level representation of a volume for the ray marching renderer
+ *
+ * The region of the volume is split into bricks of BrickSize^3 voxels. The grid holds one entry per brick
+ * that is either EmptyBrick or the slot of the brick in the brick pool plus one. Only the bricks that
+ * contain at least one voxel that is not air get a slot - the ray can skip the empty bricks as a whole.
+ *
+ * The voxels of a brick are stored as 16 bit values - two voxels per uint in the order
+ * x + y * BrickSize + z * BrickSize * BrickSize. The lower byte is the material and the flags like in
+ * voxel::Voxel, the upper byte is the color index.
+ *
+ * The grid entries and brick slots that were changed since the last markClean() call are tracked - this
+ * allows to only upload the modified parts after an edit.
+ *
+ * @sa BrickMapRenderer
+ */
+class BrickMap {
+public:
+	static constexpr int BrickSize = 8;
+	static constexpr int BrickVoxels = BrickSize * BrickSize * BrickSize;
+	/**
+	 * @brief The amount of uints per brick - two voxels per uint
+	 */
+	static constexpr int BrickWords = BrickVoxels / 2;
+	static constexpr uint32_t EmptyBrick = 0u;
+
+private:
+	voxel::Region _region = voxel::Region::InvalidRegion;
+	glm::ivec3 _gridSize{0};
+	core::DynamicArray<uint32_t> _grid;
+	core::DynamicArray<uint32_t> _bricks;
+	/**
+	 * @brief The slots of the bricks that got empty - they are reused before the pool grows
+	 */
+	core::DynamicArray<uint32_t> _freeSlots;
+	core::DynamicArray<uint32_t> _dirtySlots;
+	size_t _dirtyGridStart = 0u;
+	size_t _dirtyGridEnd = 0u;
+	bool _rebuilt = false;
+
+	/**
+	 * @return @c false if the brick only contains air
+	 */
+	bool encodeBrick(const voxel::RawVolume &volume, const glm::ivec3 &brick, uint32_t *words) const;
+	uint32_t allocateSlot();
+	void setBrick(size_t gridIndex, const uint32_t *words);
+	void markGridDirty(size_t gridIndex);
+
+	inline size_t gridIndex(const glm::ivec3 &brick) const {
+		return (size_t)brick.x + (size_t)brick.y * _gridSize.x + (size_t)brick.z * _gridSize.x * _gridSize.y;
+	}
+
+public:
+	/**
+	 * @brief Encodes all bricks of the given volume - the bricks are encoded in parallel
+	 */
+	void build(const voxel::RawVolume &volume);
+	/**
+	 * @brief Encodes the bricks that intersect the given region again - the whole map is built again if the
+	 * region of the volume changed
+	 */
+	void update(const voxel::RawVolume &volume, const voxel::Region &region);
+	void clear();
+
+	const voxel::Region &region() const;
+	const glm::ivec3 &gridSize() const;
+	/**
+	 * @return The grid entry of the brick at the given brick coordinates
+	 */
+	uint32_t brick(const glm::ivec3 &brick) const;
+	/**
+	 * @return The voxel at the given position in volume space - air for positions outside the region
+	 */
+	voxel::Voxel voxel(const glm::ivec3 &pos) const;
+	/**
+	 * @return The amount of slots in the brick pool - including the free ones
+	 */
+	uint32_t slots() const;
+	/**
+	 * @return The amount of bricks that contain voxels
+	 */
+	uint32_t usedBricks() const;
+
+	const core::DynamicArray<uint32_t> &grid() const;
+	const core::DynamicArray<uint32_t> &bricks() const;
+
+	/**
+	 * @brief The range of the grid entries that were changed since the last markClean() call
+	 * @return @c false if no grid entry was changed
+	 */
+	bool dirtyGridRange(size_t &start, size_t &count) const;
+	/**
+	 * @brief The brick slots whose voxels were changed since the last markClean() call
+	 */
+	const core::DynamicArray<uint32_t> &dirtySlots() const;
+	/**
+	 * @return @c true if the whole map was built again since the last markClean() call - all bricks have to be
+	 * uploaded then
+	 */
+	bool rebuilt() const;
+	void markClean();
+};
+
+inline const voxel::Region &BrickMap::region() const {
+	return _region;
+}
+
+inline const glm::ivec3 &BrickMap::gridSize() const {
+	return _gridSize;
+}
+
+inline uint32_t BrickMap::slots() const {
+	return (uint32_t)(_bricks.size() / BrickWords);
+}
+
+inline uint32_t BrickMap::usedBricks() const {
+	return slots() - (uint32_t)_freeSlots.size();
+}
+
+inline const core::DynamicArray<uint32_t> &BrickMap::grid() const {
+	return _grid;
+}
+
+inline const core::DynamicArray<uint32_t> &BrickMap::bricks() const {
+	return _bricks;
+}
+
+inline const core::DynamicArray<uint32_t> &BrickMap::dirtySlots() const {
+	return _dirtySlots;
+}
+
+inline bool BrickMap::rebuilt() const {
+	return _rebuilt;
+}
+
+} // namespace voxelrender
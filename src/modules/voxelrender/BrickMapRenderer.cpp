@@ -0,0 +1,202 @@
+/**
+ * @file
+ */
+
+#include "BrickMapRenderer.h"
+#include "VoxelbrickmapShaderConstants.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "video/Camera.h"
+#include "video/Renderer.h"
+#include "video/ScopedPolygonMode.h"
+#include "video/ScopedState.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include <glm/matrix.hpp>
+
+namespace voxelrender {
+
+BrickMapRenderer::BrickMapRenderer() : _brickMapShader(shader::VoxelbrickmapShader::getInstance()) {
+}
+
+bool BrickMapRenderer::init() {
+	static_assert(BrickMap::BrickSize == shader::VoxelbrickmapShaderConstants::getBrickSize(),
+				  "The brick size doesn't match the shader");
+	if (!video::hasFeature(video::Feature::ShaderStorageBufferObject)) {
+		Log::debug("No shader storage buffer support - the volumes can't be ray marched");
+		return false;
+	}
+	if (!_brickMapShader.setup()) {
+		Log::error("Failed to setup the brick map shader");
+		return false;
+	}
+	if (!_brickMapData.create(_fragData)) {
+		Log::error("Failed to create the brick map uniform buffer");
+		shutdown();
+		return false;
+	}
+	const int32_t quadIndex = _quad.createFullscreenQuad();
+	if (quadIndex == -1 || !_quad.addAttribute(_brickMapShader.getPosAttribute(quadIndex, &glm::vec2::x))) {
+		Log::error("Failed to create the brick map quad");
+		shutdown();
+		return false;
+	}
+	_paletteHash = 0u;
+	return true;
+}
+
+void BrickMapRenderer::shutdown() {
+	clear();
+	_brickMapShader.shutdown();
+	_brickMapData.shutdown();
+	_quad.shutdown();
+}
+
+void BrickMapRenderer::update(int idx, const voxel::RawVolume &volume, const voxel::Region &region) {
+	Volume &v = _volumes[idx];
+	v.brickMap.update(volume, region);
+}
+
+void BrickMapRenderer::remove(int idx) {
+	auto iter = _volumes.find(idx);
+	if (iter == _volumes.end()) {
+		return;
+	}
+	iter->second.buffer.shutdown();
+	_volumes.erase(iter);
+}
+
+void BrickMapRenderer::clear() {
+	for (auto &iter : _volumes) {
+		iter.second.buffer.shutdown();
+	}
+	_volumes.clear();
+}
+
+const BrickMap *BrickMapRenderer::brickMap(int idx) const {
+	auto iter = _volumes.find(idx);
+	if (iter == _volumes.end()) {
+		return nullptr;
+	}
+	return &iter->second.brickMap;
+}
+
+bool BrickMapRenderer::hasData(int idx) const {
+	const BrickMap *map = brickMap(idx);
+	return map != nullptr && map->usedBricks() > 0u;
+}
+
+void BrickMapRenderer::setLighting(const glm::vec3 &lightDir, const glm::vec3 &diffuseColor,
+								   const glm::vec3 &ambientColor) {
+	_fragData.lightdir = lightDir;
+	_fragData.diffuseColor = diffuseColor;
+	_fragData.ambientColor = ambientColor;
+}
+
+bool BrickMapRenderer::upload(Volume &volume) {
+	BrickMap &brickMap = volume.brickMap;
+	if (volume.gridIndex == -1) {
+		volume.gridIndex = volume.buffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+		volume.brickIndex = volume.buffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+		if (volume.gridIndex == -1 || volume.brickIndex == -1) {
+			Log::error("Failed to create the brick map buffers");
+			return false;
+		}
+		volume.buffer.setMode(volume.gridIndex, video::BufferMode::Dynamic);
+		volume.buffer.setMode(volume.brickIndex, video::BufferMode::Dynamic);
+	}
+	core_trace_scoped(BrickMapUpload);
+	const core::DynamicArray<uint32_t> &grid = brickMap.grid();
+	size_t start;
+	size_t count;
+	if (volume.gridSize != grid.size()) {
+		if (!volume.buffer.update(volume.gridIndex, grid.data(), grid.size() * sizeof(uint32_t))) {
+			return false;
+		}
+		volume.gridSize = grid.size();
+	} else if (brickMap.dirtyGridRange(start, count)) {
+		if (!volume.buffer.updateRange(volume.gridIndex, start * sizeof(uint32_t), &grid[start],
+									   count * sizeof(uint32_t))) {
+			return false;
+		}
+	}
+
+	const core::DynamicArray<uint32_t> &bricks = brickMap.bricks();
+	const size_t brickBytes = BrickMap::BrickWords * sizeof(uint32_t);
+	const uint32_t slots = brickMap.slots();
+	if (slots > volume.brickCapacity || brickMap.rebuilt()) {
+		// reserve some slots for the bricks that are added by the next edits
+		const uint32_t capacity = slots + slots / 4u + 64u;
+		if (!volume.buffer.reserve(volume.brickIndex, capacity * brickBytes)) {
+			return false;
+		}
+		volume.brickCapacity = capacity;
+		if (slots > 0u && !volume.buffer.updateRange(volume.brickIndex, 0, bricks.data(), slots * brickBytes)) {
+			return false;
+		}
+	} else {
+		for (uint32_t slot : brickMap.dirtySlots()) {
+			if (!volume.buffer.updateRange(volume.brickIndex, slot * brickBytes,
+										   &bricks[(size_t)slot * BrickMap::BrickWords], brickBytes)) {
+				return false;
+			}
+		}
+	}
+	brickMap.markClean();
+	return true;
+}
+
+void BrickMapRenderer::render(int idx, const video::Camera &camera, const glm::mat4 &model,
+							  const voxel::Palette &palette, bool gray) {
+	auto iter = _volumes.find(idx);
+	if (iter == _volumes.end()) {
+		return;
+	}
+	Volume &volume = iter->second;
+	if (volume.brickMap.usedBricks() == 0u) {
+		return;
+	}
+	core_trace_scoped(BrickMapRender);
+	if (!upload(volume)) {
+		Log::error("Failed to upload the brick map of volume %i", idx);
+		return;
+	}
+	if (palette.hash() != _paletteHash) {
+		_paletteHash = palette.hash();
+		core::DynamicArray<glm::vec4> materialColors;
+		palette.toVec4f(materialColors);
+		core::DynamicArray<glm::vec4> glowColors;
+		palette.glowToVec4f(glowColors);
+		for (int i = 0; i < voxel::PaletteMaxColors; ++i) {
+			_fragData.materialcolor[i] = materialColors[i];
+			_fragData.glowcolor[i] = glowColors[i];
+		}
+	}
+	const BrickMap &brickMap = volume.brickMap;
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	_fragData.viewprojection = viewProjection;
+	_fragData.inverseviewprojection = glm::inverse(viewProjection);
+	_fragData.model = model;
+	_fragData.inversemodel = glm::inverse(model);
+	_fragData.mins = glm::ivec4(brickMap.region().getLowerCorner(), 0);
+	_fragData.dim = glm::ivec4(brickMap.region().getDimensionsInVoxels(), 0);
+	_fragData.gridsize = glm::ivec4(brickMap.gridSize(), 0);
+	_fragData.gray = gray;
+
+	video::ScopedShader scoped(_brickMapShader);
+	if (!_brickMapData.update(_fragData) || !_brickMapShader.setFrag(_brickMapData.getFragUniformBuffer())) {
+		Log::error("Failed to update the brick map uniform buffer");
+		return;
+	}
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, volume.buffer.bufferHandle(volume.gridIndex),
+						  _brickMapShader.getBindingGriddata());
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, volume.buffer.bufferHandle(volume.brickIndex),
+						  _brickMapShader.getBindingBrickdata());
+	// the quad covers the whole screen - the depth of the hit voxels is written by the shader
+	video::ScopedState scopedCullFace(video::State::CullFace, false);
+	video::ScopedPolygonMode polygonMode(video::PolygonMode::Solid);
+	video::ScopedBuffer scopedBuf(_quad);
+	video::drawArrays(video::Primitive::Triangles, 6);
+}
+
+} // namespace voxelrender
@@ -0,0 +1,94 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "BrickMap.h"
+#include "VoxelbrickmapData.h"
+#include "VoxelbrickmapShader.h"
+#include "core/IComponent.h"
+#include "video/Buffer.h"
+#include <unordered_map>
+
+namespace video {
+class Camera;
+}
+
+namespace voxel {
+class Palette;
+class RawVolume;
+} // namespace voxel
+
+namespace voxelrender {
+
+/**
+ * @brief Renders volumes by ray marching a sparse brick map instead of extracting meshes
+ *
+ * This is meant for the preview of huge volumes where the meshes would not fit into the memory. Every volume
+ * is rendered as a fullscreen pass that writes the depth of the hit voxels. Only the bricks that were modified
+ * are uploaded again after an edit.
+ *
+ * There is no ambient occlusion, no shadow and no transparency - the transparent voxels are rendered opaque.
+ *
+ * @note Needs a renderer context with video::Feature::ShaderStorageBufferObject support
+ * @sa BrickMap
+ * @sa cfg::VoxelRayMarching
+ */
+class BrickMapRenderer : public core::IComponent {
+private:
+	struct Volume {
+		BrickMap brickMap;
+		video::Buffer buffer;
+		int32_t gridIndex = -1;
+		int32_t brickIndex = -1;
+		/**
+		 * @brief The amount of brick slots the gpu buffer can hold - the buffer grows with some headroom
+		 */
+		uint32_t brickCapacity = 0u;
+		size_t gridSize = 0u;
+	};
+	std::unordered_map<int, Volume> _volumes;
+
+	shader::VoxelbrickmapShader &_brickMapShader;
+	alignas(16) shader::VoxelbrickmapData::FragData _fragData{};
+	shader::VoxelbrickmapData _brickMapData;
+	video::Buffer _quad;
+	uint64_t _paletteHash = 0u;
+
+	/**
+	 * @brief Uploads the grid entries and bricks that were changed since the last upload
+	 */
+	bool upload(Volume &volume);
+
+public:
+	BrickMapRenderer();
+
+	bool init() override;
+	void shutdown() override;
+
+	/**
+	 * @brief Encodes the given region of the volume into the brick map of the given slot - the brick map is
+	 * created if it doesn't exist yet
+	 */
+	void update(int idx, const voxel::RawVolume &volume, const voxel::Region &region);
+	void remove(int idx);
+	void clear();
+	/**
+	 * @return The brick map of the given slot or @c nullptr if there is none
+	 */
+	const BrickMap *brickMap(int idx) const;
+	/**
+	 * @return @c true if the given slot has a brick map with at least one voxel
+	 */
+	bool hasData(int idx) const;
+
+	void setLighting(const glm::vec3 &lightDir, const glm::vec3 &diffuseColor, const glm::vec3 &ambientColor);
+	/**
+	 * @param[in] model The transform from volume space to world space - including the pivot
+	 */
+	void render(int idx, const video::Camera &camera, const glm::mat4 &model, const voxel::Palette &palette,
+				bool gray);
+};
+
+} // namespace voxelrender
@@ -0,0 +1,193 @@
+/**
+ * @file
+ */
+
+#include "FaceCompute.h"
+#include "VoxelfacesShaderConstants.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "video/Renderer.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelrender {
+
+/**
+ * @brief The amount of faces the lists can hold initially
+ */
+static constexpr uint32_t MinCapacity = 16u * 1024u;
+
+FaceCompute::FaceCompute() : _facesShader(shader::VoxelfacesShader::getInstance()) {
+}
+
+bool FaceCompute::init() {
+	static_assert(sizeof(voxel::VoxelFace) == shader::VoxelfacesShaderConstants::getFaceSize() * sizeof(uint32_t),
+				  "The face size doesn't match the compute shader");
+	if (!video::hasFeature(video::Feature::ComputeShaders) ||
+		!video::hasFeature(video::Feature::ShaderStorageBufferObject)) {
+		Log::debug("No compute shader support - the faces have to be extracted on the cpu");
+		return false;
+	}
+	if (!_facesShader.setup()) {
+		Log::error("Failed to setup the faces compute shader");
+		return false;
+	}
+	if (!_facesData.create(_paramsData)) {
+		Log::error("Failed to create the faces compute uniform buffer");
+		shutdown();
+		return false;
+	}
+	_voxelsIndex = _buffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+	_counterIndex = _buffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+	for (int i = 0; i < voxel::ChunkFaces::Lists; ++i) {
+		_faceIndex[i] = _buffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+	}
+	if (_voxelsIndex == -1 || _counterIndex == -1 || _faceIndex[0] == -1 || _faceIndex[1] == -1) {
+		Log::error("Failed to create the faces compute buffers");
+		shutdown();
+		return false;
+	}
+	_buffer.setMode(_voxelsIndex, video::BufferMode::Dynamic);
+	_buffer.setMode(_counterIndex, video::BufferMode::Dynamic);
+	_maxBufferSize = SIZE_MAX;
+	const int limit = video::limit(video::Limit::MaxShaderStorageBufferSize);
+	if (limit > 0) {
+		_maxBufferSize = (size_t)limit;
+	}
+	_capacity = 0u;
+	return true;
+}
+
+void FaceCompute::shutdown() {
+	_facesShader.shutdown();
+	_facesData.shutdown();
+	_buffer.shutdown();
+	_voxelsIndex = -1;
+	_counterIndex = -1;
+	for (int i = 0; i < voxel::ChunkFaces::Lists; ++i) {
+		_faceIndex[i] = -1;
+	}
+	_capacity = 0u;
+}
+
+bool FaceCompute::run(const voxel::Region &region, uint32_t counts[voxel::ChunkFaces::Lists]) {
+	alignas(16) const uint32_t zero[4]{0u, 0u, 0u, 0u};
+	if (!_buffer.update(_counterIndex, zero, sizeof(zero))) {
+		return false;
+	}
+	_paramsData.capacity = (int)_capacity;
+	if (!_facesData.update(_paramsData) || !_facesShader.setParams(_facesData.getParamsUniformBuffer())) {
+		Log::error("Failed to update the faces compute parameters");
+		return false;
+	}
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	const int localSizeX = _facesShader.getLocalSizeX();
+	const int localSizeY = _facesShader.getLocalSizeY();
+	const int localSizeZ = _facesShader.getLocalSizeZ();
+	const glm::uvec3 workGroups((dim.x + localSizeX - 1) / localSizeX, (dim.y + localSizeY - 1) / localSizeY,
+								(dim.z + localSizeZ - 1) / localSizeZ);
+	if (!_facesShader.run(workGroups, true)) {
+		Log::error("Failed to run the faces compute shader");
+		return false;
+	}
+	const video::Id counterHandle = _buffer.bufferHandle(_counterIndex);
+	const uint32_t *mapped =
+		(const uint32_t *)video::mapBuffer(counterHandle, video::BufferType::ShaderStorageBuffer, video::AccessMode::Read);
+	if (mapped == nullptr) {
+		Log::error("Failed to map the faces counter buffer");
+		return false;
+	}
+	for (int i = 0; i < voxel::ChunkFaces::Lists; ++i) {
+		counts[i] = mapped[i];
+	}
+	video::unmapBuffer(counterHandle, video::BufferType::ShaderStorageBuffer);
+	return true;
+}
+
+bool FaceCompute::extract(const voxel::RawVolume &volume, const voxel::Region &region, voxel::ChunkFaces &faces) {
+	if (_voxelsIndex == -1 || !region.isValid()) {
+		return false;
+	}
+	const voxel::Region &volumeRegion = volume.region();
+	const glm::ivec3 border(1);
+	if (!volumeRegion.containsPoint(region.getLowerCorner() - border) ||
+		!volumeRegion.containsPoint(region.getUpperCorner() + border)) {
+		Log::error("The volume doesn't contain the neighbours of the region");
+		return false;
+	}
+	core_trace_scoped(FaceComputeExtract);
+	// two voxels per uint in the shader
+	const size_t voxelsSize = (size_t)volumeRegion.voxels() * sizeof(voxel::Voxel);
+	const size_t alignedVoxelsSize = (voxelsSize + 3u) & ~(size_t)3u;
+	if (alignedVoxelsSize > _maxBufferSize) {
+		return false;
+	}
+	if (!_buffer.reserve(_voxelsIndex, alignedVoxelsSize) ||
+		!_buffer.updateRange(_voxelsIndex, 0, volume.data(), voxelsSize)) {
+		return false;
+	}
+	const size_t maxCapacity = _maxBufferSize / sizeof(voxel::VoxelFace);
+	const uint32_t capacity = (uint32_t)core_min((size_t)core_max(MinCapacity, (uint32_t)region.voxels()), maxCapacity);
+	if (capacity > _capacity) {
+		_capacity = capacity;
+		for (int i = 0; i < voxel::ChunkFaces::Lists; ++i) {
+			_buffer.reserve(_faceIndex[i], (size_t)_capacity * sizeof(voxel::VoxelFace));
+		}
+	}
+
+	video::ScopedShader scoped(_facesShader);
+	_paramsData.mins = glm::ivec4(region.getLowerCorner(), 0);
+	_paramsData.dim = glm::ivec4(region.getDimensionsInVoxels(), 0);
+	_paramsData.offset = glm::ivec4(region.getLowerCorner() - volumeRegion.getLowerCorner(), 0);
+	_paramsData.voxeldim = glm::ivec4(volumeRegion.getDimensionsInVoxels(), 0);
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, _buffer.bufferHandle(_voxelsIndex),
+						  _facesShader.getBindingVoxeldata());
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, _buffer.bufferHandle(_counterIndex),
+						  _facesShader.getBindingCounterdata());
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, _buffer.bufferHandle(_faceIndex[0]),
+						  _facesShader.getBindingOpaquedata());
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, _buffer.bufferHandle(_faceIndex[1]),
+						  _facesShader.getBindingTransparentdata());
+
+	uint32_t counts[voxel::ChunkFaces::Lists];
+	if (!run(region, counts)) {
+		return false;
+	}
+	const uint32_t needed = core_max(counts[0], counts[1]);
+	if (needed > _capacity) {
+		// the lists were too small - the counters tell the amount of faces
+		if (needed > maxCapacity) {
+			return false;
+		}
+		_capacity = needed;
+		for (int i = 0; i < voxel::ChunkFaces::Lists; ++i) {
+			_buffer.reserve(_faceIndex[i], (size_t)_capacity * sizeof(voxel::VoxelFace));
+			video::bindBufferBase(video::BufferType::ShaderStorageBuffer, _buffer.bufferHandle(_faceIndex[i]),
+								  i == 0 ? _facesShader.getBindingOpaquedata() : _facesShader.getBindingTransparentdata());
+		}
+		if (!run(region, counts)) {
+			return false;
+		}
+	}
+
+	for (int i = 0; i < voxel::ChunkFaces::Lists; ++i) {
+		voxel::FaceArray &list = faces.faces[i];
+		list.clear();
+		if (counts[i] == 0u) {
+			continue;
+		}
+		const video::Id handle = _buffer.bufferHandle(_faceIndex[i]);
+		const void *mapped = video::mapBuffer(handle, video::BufferType::ShaderStorageBuffer, video::AccessMode::Read);
+		if (mapped == nullptr) {
+			Log::error("Failed to map the face buffer");
+			return false;
+		}
+		list.resize(counts[i]);
+		core_memcpy(list.data(), mapped, counts[i] * sizeof(voxel::VoxelFace));
+		video::unmapBuffer(handle, video::BufferType::ShaderStorageBuffer);
+	}
+	return true;
+}
+
+} // namespace voxelrender
@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "VoxelfacesData.h"
+#include "VoxelfacesShader.h"
+#include "core/IComponent.h"
+#include "video/Buffer.h"
+#include "voxel/CubicFaceExtractor.h"
+
+namespace voxel {
+class RawVolume;
+class Region;
+} // namespace voxel
+
+namespace voxelrender {
+
+/**
+ * @brief Collects the visible faces of the vertex pulling path with a compute shader
+ *
+ * This is the gpu version of voxel::extractCubicFaces() - the faces are the same, but their order in the lists
+ * differs. The voxels are uploaded as they are stored in the volume and every voxel appends its faces to the
+ * opaque or the transparent face list. Only the visible faces are read back.
+ *
+ * @note Needs a renderer context with video::Feature::ComputeShaders and video::Feature::ShaderStorageBufferObject
+ * support - init() fails if they are not available and the callers should fall back to the cpu version.
+ */
+class FaceCompute : public core::IComponent {
+private:
+	shader::VoxelfacesShader &_facesShader;
+	alignas(16) shader::VoxelfacesData::ParamsData _paramsData{};
+	shader::VoxelfacesData _facesData;
+	video::Buffer _buffer;
+	int32_t _voxelsIndex = -1;
+	int32_t _counterIndex = -1;
+	int32_t _faceIndex[voxel::ChunkFaces::Lists]{-1, -1};
+	/**
+	 * @brief The amount of faces the face lists can hold - they grow with the largest result
+	 */
+	uint32_t _capacity = 0u;
+	size_t _maxBufferSize = 0u;
+
+	bool run(const voxel::Region &region, uint32_t counts[voxel::ChunkFaces::Lists]);
+
+public:
+	FaceCompute();
+
+	bool init() override;
+	void shutdown() override;
+
+	/**
+	 * @brief Collects the visible faces of the voxels in the given region
+	 * @param[in] volume The volume must contain the neighbours of the region, too
+	 * @sa voxel::extractCubicFaces()
+	 */
+	bool extract(const voxel::RawVolume &volume, const voxel::Region &region, voxel::ChunkFaces &faces);
+};
+
+} // namespace voxelrender
@@ -7,119 +7,79 @@
 #include "core/Color.h"
 #include "core/StringUtil.h"
 #include "core/Log.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
 #include "image/Image.h"
 #include "io/File.h"
 #include "io/FileStream.h"
 #include "io/Stream.h"
-#include "video/Camera.h"
-#include "video/FrameBuffer.h"
-#include "video/Renderer.h"
-#include "video/Texture.h"
 #include "voxelformat/Format.h"
 #include "voxelformat/VolumeFormat.h"
-#include "voxelrender/SceneGraphRenderer.h"
+#include "voxelrender/SoftwareRenderer.h"
+#include "voxelrender/ThumbnailRenderer.h"
+#include "glm/gtc/constants.hpp"
 
 namespace voxelrender {
 
-static image::ImagePtr volumeThumbnail(RenderContext &renderContext, voxelrender::SceneGraphRenderer &volumeRenderer, const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx) {
-	video::clearColor(ctx.clearColor);
-	video::enable(video::State::DepthTest);
-	video::depthFunc(video::CompareFunc::LessEqual);
-	video::enable(video::State::CullFace);
-	video::enable(video::State::DepthMask);
-	video::enable(video::State::Blend);
-	video::blendFunc(video::BlendMode::SourceAlpha, video::BlendMode::OneMinusSourceAlpha);
-
-	video::TextureConfig textureCfg;
-	textureCfg.wrap(video::TextureWrap::ClampToEdge);
-	textureCfg.format(video::TextureFormat::RGBA);
-
-	core_trace_scoped(EditorSceneRenderFramebuffer);
-	volumeRenderer.prepare(const_cast<scenegraph::SceneGraph&>(sceneGraph));
-
-	{
-		const voxel::Region &region = sceneGraph.region();
-		const glm::vec3 center(region.getCenter());
-		const glm::vec3 dim(region.getDimensionsInVoxels());
-		const int height = region.getHeightInCells();
-		const float distance = ctx.distance <= 0.01f ? glm::length(dim) : ctx.distance;
-		video::Camera camera;
-		camera.setSize(ctx.outputSize);
-		camera.setMode(video::CameraMode::Perspective);
-		camera.setType(video::CameraType::Free);
-		camera.setRotationType(video::CameraRotationType::Target);
-		camera.setAngles(ctx.pitch, ctx.yaw, ctx.roll);
-		camera.setFarPlane(5000.0f);
-		camera.setTarget(center);
-		camera.setTargetDistance(distance * 2.0f);
-		camera.setWorldPosition(glm::vec3(-distance, (float)height + distance, -distance));
-		camera.setOmega(ctx.omega);
-		camera.update(ctx.deltaFrameSeconds);
-		renderContext.frameBuffer.bind(true);
-		volumeRenderer.render(renderContext, camera, true, true);
-		renderContext.frameBuffer.unbind();
-	}
-
-	return renderContext.frameBuffer.image("thumbnail", video::FrameBufferAttachment::Color0);
-}
-
 image::ImagePtr volumeThumbnail(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx) {
-	voxelrender::SceneGraphRenderer volumeRenderer;
-	volumeRenderer.construct();
-	RenderContext renderContext;
-	renderContext.init(ctx.outputSize);
-	if (!volumeRenderer.init()) {
-		Log::error("Failed to initialize the renderer");
-		return image::ImagePtr();
-	}
-
-	volumeRenderer.setSceneMode(true);
-	const image::ImagePtr &image = volumeThumbnail(renderContext, volumeRenderer, sceneGraph, ctx);
-	volumeRenderer.shutdown();
-	renderContext.shutdown();
+	ThumbnailRenderer renderer;
+	const image::ImagePtr &image = renderer.render(sceneGraph, ctx);
+	renderer.shutdown();
 	return image;
 }
 
-bool volumeTurntable(const scenegraph::SceneGraph &sceneGraph, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops) {
-	voxelrender::SceneGraphRenderer volumeRenderer;
-	RenderContext renderContext;
-	renderContext.init(ctx.outputSize);
-	volumeRenderer.construct();
-	if (!volumeRenderer.init()) {
-		Log::error("Failed to initialize the renderer");
-		return image::ImagePtr();
-	}
+image::ImagePtr volumeThumbnailSoftware(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx) {
+	SoftwareRenderer renderer;
+	return renderer.render(sceneGraph, ctx);
+}
 
-	volumeRenderer.setSceneMode(true);
+bool volumeTurntable(const scenegraph::SceneGraph &sceneGraph, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops, bool software) {
+	ThumbnailRenderer renderer;
+	SoftwareRenderer softwareRenderer;
+	if (!software && !renderer.init(ctx.outputSize)) {
+		return false;
+	}
 
 	const core::String ext = core::string::extractExtension(imageFile);
 	const core::String baseFilePath = core::string::stripExtension(imageFile);
+	// the png compression of the frames runs on the thread pool while the next frames are rendered
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	const size_t maxPending = core_max((size_t)1u, threadPool.size()) * 2u;
+	core::DynamicArray<std::future<bool>> pending;
+	bool success = true;
 	for (int i = 0; i < loops; ++i) {
+		const image::ImagePtr &image = software ? softwareRenderer.render(sceneGraph, ctx, true) : renderer.render(sceneGraph, ctx, true);
+		if (!image) {
+			Log::error("Failed to create thumbnail for %s", imageFile.c_str());
+			success = false;
+			break;
+		}
 		const core::String &filepath = core::string::format("%s_%i.%s", baseFilePath.c_str(), i, ext.c_str());
-		const io::FilePtr &outfile = io::filesystem()->open(filepath, io::FileMode::SysWrite);
-		io::FileStream outStream(outfile);
-		const image::ImagePtr &image = volumeThumbnail(renderContext, volumeRenderer, sceneGraph, ctx);
-		if (image) {
+		// bound the memory of the frames that wait for the compression
+		while (pending.size() >= maxPending) {
+			success &= pending.front().get();
+			pending.erase(0);
+		}
+		pending.emplace_back(threadPool.enqueue([image, filepath]() {
+			const io::FilePtr &outfile = io::filesystem()->open(filepath, io::FileMode::SysWrite);
+			io::FileStream outStream(outfile);
 			if (!image::Image::writePng(outStream, image->data(), image->width(), image->height(), image->depth())) {
 				Log::error("Failed to write image %s", filepath.c_str());
-				volumeRenderer.shutdown();
-				renderContext.shutdown();
 				return false;
-			} else {
-				Log::info("Write image %s", filepath.c_str());
 			}
-		} else {
-			Log::error("Failed to create thumbnail for %s", imageFile.c_str());
-			volumeRenderer.shutdown();
-			renderContext.shutdown();
-			return false;
-		}
+			Log::info("Write image %s", filepath.c_str());
+			return true;
+		}));
 		ctx.omega = glm::vec3(0.0f, glm::two_pi<float>() / (float)loops, 0.0f);
 		ctx.deltaFrameSeconds += 1000.0 / (double)loops;
 	}
-	volumeRenderer.shutdown();
-	renderContext.shutdown();
-	return true;
+	for (std::future<bool> &future : pending) {
+		success &= future.get();
+	}
+	softwareRenderer.clear();
+	renderer.clear();
+	renderer.shutdown();
+	return success;
 }
 
 } // namespace voxelrender
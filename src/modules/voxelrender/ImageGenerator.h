@@ -15,7 +15,15 @@ class SceneGraph;
 namespace voxelrender {
 
 image::ImagePtr volumeThumbnail(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx);
-bool volumeTurntable(const scenegraph::SceneGraph &sceneGraph, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops);
+/**
+ * @brief Same as @c volumeThumbnail() but rendered on the cpu - no renderer context is needed
+ * @sa SoftwareRenderer
+ */
+image::ImagePtr volumeThumbnailSoftware(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx);
+/**
+ * @param[in] software Render the frames on the cpu - see SoftwareRenderer
+ */
+bool volumeTurntable(const scenegraph::SceneGraph &sceneGraph, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops, bool software = false);
 
 
 } // namespace voxelrender
@@ -0,0 +1,159 @@
+/**
+ * @file
+ */
+
+#include "MeshCache.h"
+#include "app/App.h"
+#include "core/FourCC.h"
+#include "core/Hash.h"
+#include "core/Log.h"
+#include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include "voxel/RawVolume.h"
+#include <inttypes.h>
+
+namespace voxelrender {
+
+static constexpr uint32_t MeshCacheMagic = FourCC('V', 'M', 'S', 'H');
+/**
+ * @brief Increase this whenever the mesher output or the layout of the entries changes
+ */
+static constexpr uint32_t MeshCacheVersion = 1u;
+/**
+ * @brief Sanity limit for the element counts of a corrupted entry
+ */
+static constexpr uint32_t MaxElements = 64u * 1024u * 1024u;
+
+uint64_t MeshCache::key(const voxel::RawVolume &volume, const glm::ivec3 &mins, const MeshCacheSettings &settings) {
+	core::Hash64 hash(MeshCacheVersion);
+	const uint64_t contentHash = volume.hash();
+	hash.update(&contentHash, sizeof(contentHash));
+	// the content hash doesn't include the position - but the vertices are in volume space
+	const glm::ivec3 &lowerCorner = volume.region().getLowerCorner();
+	hash.update(&lowerCorner, sizeof(lowerCorner));
+	hash.update(&mins, sizeof(mins));
+	const uint8_t flags[] = {(uint8_t)settings.meshMode, settings.mergeQuads, settings.reuseVertices,
+							 settings.ambientOcclusion, settings.optimize};
+	hash.update(flags, sizeof(flags));
+	if (settings.meshMode != MeshMode::Cubes) {
+		hash.update(&settings.paletteHash, sizeof(settings.paletteHash));
+		hash.update(&settings.lowerVolumeBorder, sizeof(settings.lowerVolumeBorder));
+	}
+	return hash.digest();
+}
+
+core::String MeshCache::cacheFile(uint64_t key) {
+	return core::string::format("meshcache/%016" PRIx64 ".mesh", key);
+}
+
+bool MeshCache::write(io::WriteStream &stream, const voxel::ChunkMesh &mesh) {
+	if (!stream.writeUInt32(MeshCacheMagic) || !stream.writeUInt32(MeshCacheVersion)) {
+		return false;
+	}
+	for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+		const voxel::Mesh &m = mesh.mesh[i];
+		const voxel::VertexArray &vertices = m.getVertexVector();
+		const voxel::IndexArray &indices = m.getIndexVector();
+		const voxel::NormalArray &normals = m.getNormalVector();
+		const glm::ivec3 &offset = m.getOffset();
+		if (!stream.writeInt32(offset.x) || !stream.writeInt32(offset.y) || !stream.writeInt32(offset.z)) {
+			return false;
+		}
+		if (!stream.writeUInt32((uint32_t)vertices.size()) || !stream.writeUInt32((uint32_t)indices.size()) ||
+			!stream.writeUInt32((uint32_t)normals.size())) {
+			return false;
+		}
+		if (!vertices.empty() && stream.write(vertices.data(), vertices.size() * sizeof(voxel::VoxelVertex)) == -1) {
+			return false;
+		}
+		if (!indices.empty() && stream.write(indices.data(), indices.size() * sizeof(voxel::IndexType)) == -1) {
+			return false;
+		}
+		if (!normals.empty() && stream.write(normals.data(), normals.size() * sizeof(glm::vec3)) == -1) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template<class ARRAY>
+static bool readArray(io::ReadStream &stream, ARRAY &array, uint32_t size) {
+	array.resize(size);
+	if (size == 0u) {
+		return true;
+	}
+	const size_t bytes = (size_t)size * sizeof(typename ARRAY::value_type);
+	return stream.read(array.data(), bytes) == (int)bytes;
+}
+
+bool MeshCache::read(io::ReadStream &stream, voxel::ChunkMesh &mesh) {
+	uint32_t magic;
+	uint32_t version;
+	if (stream.readUInt32(magic) != 0 || magic != MeshCacheMagic) {
+		return false;
+	}
+	if (stream.readUInt32(version) != 0 || version != MeshCacheVersion) {
+		return false;
+	}
+	for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+		voxel::Mesh &m = mesh.mesh[i];
+		glm::ivec3 offset;
+		if (stream.readInt32(offset.x) != 0 || stream.readInt32(offset.y) != 0 || stream.readInt32(offset.z) != 0) {
+			return false;
+		}
+		uint32_t vertexCount;
+		uint32_t indexCount;
+		uint32_t normalCount;
+		if (stream.readUInt32(vertexCount) != 0 || stream.readUInt32(indexCount) != 0 ||
+			stream.readUInt32(normalCount) != 0) {
+			return false;
+		}
+		if (vertexCount > MaxElements || indexCount > MaxElements || normalCount > MaxElements) {
+			return false;
+		}
+		m.setOffset(offset);
+		if (!readArray(stream, m.getVertexVector(), vertexCount) || !readArray(stream, m.getIndexVector(), indexCount) ||
+			!readArray(stream, m.getNormalVector(), normalCount)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool MeshCache::load(uint64_t key, voxel::ChunkMesh &mesh) {
+	const core::String &file = cacheFile(key);
+	const io::FilePtr &filePtr = io::filesystem()->open(file);
+	if (!filePtr->exists()) {
+		return false;
+	}
+	core_trace_scoped(MeshCacheLoad);
+	io::FileStream stream(filePtr);
+	if (!stream.valid()) {
+		return false;
+	}
+	if (!read(stream, mesh)) {
+		Log::warn("Invalid mesh cache entry %s", file.c_str());
+		mesh.clear();
+		return false;
+	}
+	return true;
+}
+
+bool MeshCache::save(uint64_t key, const voxel::ChunkMesh &mesh) {
+	core_trace_scoped(MeshCacheSave);
+	io::BufferedReadWriteStream stream;
+	if (!write(stream, mesh)) {
+		return false;
+	}
+	const core::String &file = cacheFile(key);
+	if (!io::filesystem()->write(file, stream.getBuffer(), (size_t)stream.size())) {
+		Log::warn("Failed to write the mesh cache entry %s", file.c_str());
+		return false;
+	}
+	return true;
+}
+
+} // namespace voxelrender
@@ -0,0 +1,89 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include "core/String.h"
+#include "voxel/ChunkMesh.h"
+
+namespace io {
+class ReadStream;
+class WriteStream;
+} // namespace io
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief The surface extractor of the chunk meshes
+ * @sa cfg::VoxelMeshMode
+ */
+enum class MeshMode : uint8_t {
+	Cubes,
+	MarchingCubes,
+	/** smooth like the marching cubes - but with far fewer triangles */
+	SurfaceNets,
+
+	Max
+};
+
+/**
+ * @brief The settings of the surface extraction that influence the chunk meshes - they are part of the cache key
+ */
+struct MeshCacheSettings {
+	MeshMode meshMode = MeshMode::Cubes;
+	bool mergeQuads = true;
+	bool reuseVertices = true;
+	bool ambientOcclusion = true;
+	bool optimize = false;
+	/**
+	 * @brief The smooth meshers blend the palette colors - the palette is not used by the cubic mesher
+	 */
+	uint64_t paletteHash = 0u;
+	/**
+	 * @brief Bit @c i is set if the chunk is at the lower border of the volume on axis @c i - the surface nets chunks at
+	 * the border also get the faces to the voxels outside of the volume
+	 */
+	uint8_t lowerVolumeBorder = 0u;
+};
+
+/**
+ * @brief On-disk cache of the extracted chunk meshes to speed up reopening large scenes
+ *
+ * The entries are stored in the @c meshcache directory of the home path and are keyed by the content hash of the
+ * chunk voxels (including the border that the mesher looks at), the position of the chunk and the mesher settings.
+ * Edited chunks just get a new entry - the directory is never cleaned up automatically and can be deleted at any time.
+ *
+ * The vertices are stored in the memory layout of the machine - the cache is not meant to be shared.
+ *
+ * @note All functions are thread safe - they are called from the extractor tasks
+ * @sa cfg::VoxelMeshCache
+ */
+class MeshCache {
+public:
+	/**
+	 * @param[in] volume The copy of the chunk voxels the mesh is extracted from
+	 * @param[in] mins The lower corner of the chunk in volume space
+	 */
+	static uint64_t key(const voxel::RawVolume &volume, const glm::ivec3 &mins, const MeshCacheSettings &settings);
+	/**
+	 * @return The path of the cache entry relative to the home path
+	 */
+	static core::String cacheFile(uint64_t key);
+
+	/**
+	 * @return @c false if there is no valid entry for the given key
+	 */
+	static bool load(uint64_t key, voxel::ChunkMesh &mesh);
+	static bool save(uint64_t key, const voxel::ChunkMesh &mesh);
+
+	static bool read(io::ReadStream &stream, voxel::ChunkMesh &mesh);
+	static bool write(io::WriteStream &stream, const voxel::ChunkMesh &mesh);
+};
+
+} // namespace voxelrender
@@ -0,0 +1,202 @@
+/**
+ * @file
+ */
+
+#include "NoiseCompute.h"
+#include "app/App.h"
+#include "core/ArrayLength.h"
+#include "core/Common.h"
+#include "core/Log.h"
+#include "core/StandardLib.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
+#include "noise/Simplex.h"
+#include "video/Renderer.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelrender {
+
+/**
+ * @brief The maximum size of the shader storage buffer for the values - bigger regions are split into slabs
+ */
+static constexpr size_t MaxSlabSize = 64u * 1024u * 1024u;
+
+NoiseCompute::NoiseCompute() : _noiseShader(shader::NoiseShader::getInstance()) {
+}
+
+bool NoiseCompute::init() {
+	if (!video::hasFeature(video::Feature::ComputeShaders) ||
+		!video::hasFeature(video::Feature::ShaderStorageBufferObject)) {
+		Log::debug("No compute shader support - the noise has to be evaluated on the cpu");
+		return false;
+	}
+	if (!_noiseShader.setup()) {
+		Log::error("Failed to setup the noise compute shader");
+		return false;
+	}
+	if (!_noiseData.create(_paramsData)) {
+		Log::error("Failed to create the noise compute uniform buffer");
+		shutdown();
+		return false;
+	}
+	_valuesIndex = _buffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+	_permIndex = _buffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+	if (_valuesIndex == -1 || _permIndex == -1) {
+		Log::error("Failed to create the noise compute buffers");
+		shutdown();
+		return false;
+	}
+	// the shader uses the same permutation table as the cpu version
+	alignas(16) uint32_t perm[512];
+	for (int i = 0; i < lengthof(perm); ++i) {
+		perm[i] = noise::details::perm[i];
+	}
+	if (!_buffer.update(_permIndex, perm, sizeof(perm))) {
+		Log::error("Failed to upload the noise permutation table");
+		shutdown();
+		return false;
+	}
+	_maxBufferSize = MaxSlabSize;
+	const int limit = video::limit(video::Limit::MaxShaderStorageBufferSize);
+	if (limit > 0) {
+		_maxBufferSize = core_min(_maxBufferSize, (size_t)limit);
+	}
+	return true;
+}
+
+void NoiseCompute::shutdown() {
+	_noiseShader.shutdown();
+	_noiseData.shutdown();
+	_buffer.shutdown();
+	_valuesIndex = -1;
+	_permIndex = -1;
+}
+
+bool NoiseCompute::run(const voxel::Region &region, float frequency, int octaves, float lacunarity, float gain,
+					   float amplitude, core::DynamicArray<float> &values) {
+	if (_valuesIndex == -1 || !region.isValid()) {
+		return false;
+	}
+	core_trace_scoped(NoiseComputeRun);
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	const size_t sliceSize = (size_t)dim.x * (size_t)dim.y * sizeof(float);
+	if (sliceSize > _maxBufferSize) {
+		Log::error("One slice of the region exceeds the max shader storage buffer size");
+		return false;
+	}
+	const int slabDepth = core_min(dim.z, (int)(_maxBufferSize / sliceSize));
+	if (!_buffer.reserve(_valuesIndex, sliceSize * (size_t)slabDepth)) {
+		return false;
+	}
+	values.resize(region.voxels());
+
+	const video::Id valuesHandle = _buffer.bufferHandle(_valuesIndex);
+	_noiseShader.activate();
+	_paramsData.frequency = frequency;
+	_paramsData.octaves = octaves;
+	_paramsData.lacunarity = lacunarity;
+	_paramsData.gain = gain;
+	_paramsData.amplitude = amplitude;
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, valuesHandle, _noiseShader.getBindingNoisedata());
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, _buffer.bufferHandle(_permIndex),
+						  _noiseShader.getBindingPermdata());
+
+	const int localSizeX = _noiseShader.getLocalSizeX();
+	const int localSizeY = _noiseShader.getLocalSizeY();
+	const int localSizeZ = _noiseShader.getLocalSizeZ();
+	bool success = true;
+	for (int z = 0; z < dim.z; z += slabDepth) {
+		const int depth = core_min(slabDepth, dim.z - z);
+		_paramsData.mins = glm::ivec4(region.getLowerCorner() + glm::ivec3(0, 0, z), 0);
+		_paramsData.dim = glm::ivec4(dim.x, dim.y, depth, 0);
+		if (!_noiseData.update(_paramsData) || !_noiseShader.setParams(_noiseData.getParamsUniformBuffer())) {
+			Log::error("Failed to update the noise compute parameters");
+			success = false;
+			break;
+		}
+		const glm::uvec3 workGroups((dim.x + localSizeX - 1) / localSizeX, (dim.y + localSizeY - 1) / localSizeY,
+									(depth + localSizeZ - 1) / localSizeZ);
+		if (!_noiseShader.run(workGroups, true)) {
+			Log::error("Failed to run the noise compute shader");
+			success = false;
+			break;
+		}
+		const void *mapped = video::mapBuffer(valuesHandle, video::BufferType::ShaderStorageBuffer,
+											  video::AccessMode::Read);
+		if (mapped == nullptr) {
+			Log::error("Failed to map the noise compute buffer");
+			success = false;
+			break;
+		}
+		core_memcpy(values.data() + (size_t)z * dim.x * dim.y, mapped, sliceSize * (size_t)depth);
+		video::unmapBuffer(valuesHandle, video::BufferType::ShaderStorageBuffer);
+	}
+	_noiseShader.deactivate();
+	return success;
+}
+
+bool NoiseCompute::noise(const voxel::Region &region, float frequency, core::DynamicArray<float> &values) {
+	return run(region, frequency, 1, 1.0f, 1.0f, 1.0f, values);
+}
+
+bool NoiseCompute::fBm(const voxel::Region &region, float frequency, uint8_t octaves, float lacunarity, float gain,
+					   core::DynamicArray<float> &values) {
+	// the first octave has the amplitude 0.5 - see noise::fBm()
+	return run(region, frequency, octaves, lacunarity, gain, 0.5f, values);
+}
+
+voxel::Region NoiseCompute::fillVolume(voxel::RawVolume &volume, const voxel::Region &region,
+									   const voxel::Voxel &voxel, float threshold, float frequency, uint8_t octaves,
+									   float lacunarity, float gain) {
+	if (!voxel::intersects(region, volume.region())) {
+		return voxel::Region::InvalidRegion;
+	}
+	voxel::Region target = region;
+	target.cropTo(volume.region());
+	core::DynamicArray<float> values;
+	if (!fBm(target, frequency, octaves, lacunarity, gain, values)) {
+		return voxel::Region::InvalidRegion;
+	}
+	core_trace_scoped(NoiseComputeFillVolume);
+	const glm::ivec3 &dim = target.getDimensionsInVoxels();
+	const glm::ivec3 &mins = target.getLowerCorner();
+	core::DynamicArray<uint8_t> solid;
+	solid.resize(values.size());
+	app::App::getInstance()->threadPool().parallelFor(0, dim.z, 1, [&](int start, int end) {
+		const size_t sliceSize = (size_t)dim.x * dim.y;
+		for (size_t i = (size_t)start * sliceSize; i < (size_t)end * sliceSize; ++i) {
+			solid[i] = values[i] > threshold ? 1u : 0u;
+		}
+	});
+
+	// the volume is not thread safe - place the runs of solid voxels row by row
+	voxel::Region dirty = voxel::Region::InvalidRegion;
+	const uint8_t *solidData = solid.data();
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			const uint8_t *row = solidData + (size_t)y * dim.x + (size_t)z * dim.x * dim.y;
+			int x = 0;
+			while (x < dim.x) {
+				if (row[x] == 0u) {
+					++x;
+					continue;
+				}
+				const int runStart = x;
+				while (x < dim.x && row[x] != 0u) {
+					++x;
+				}
+				const voxel::Region run(mins.x + runStart, mins.y + y, mins.z + z, mins.x + x - 1, mins.y + y,
+										mins.z + z);
+				volume.fill(run, voxel);
+				if (dirty.isValid()) {
+					dirty.accumulate(run);
+				} else {
+					dirty = run;
+				}
+			}
+		}
+	}
+	return dirty;
+}
+
+} // namespace voxelrender
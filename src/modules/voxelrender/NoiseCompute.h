@@ -0,0 +1,75 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "NoiseData.h"
+#include "NoiseShader.h"
+#include "core/IComponent.h"
+#include "core/collection/DynamicArray.h"
+#include "video/Buffer.h"
+#include "voxel/Region.h"
+#include "voxel/Voxel.h"
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief Evaluates the 3d simplex noise and its fractal brownian motion sum for a region with a compute shader
+ *
+ * The values are the same as the ones of noise::noiseGrid() and noise::fBmGrid() of the noise module - up to float
+ * rounding. Big regions are split into slabs along the z axis that fit into one shader storage buffer.
+ *
+ * @note Needs a renderer context with video::Feature::ComputeShaders and video::Feature::ShaderStorageBufferObject
+ * support - init() fails if they are not available and the callers should fall back to the cpu version.
+ */
+class NoiseCompute : public core::IComponent {
+private:
+	shader::NoiseShader &_noiseShader;
+	alignas(16) shader::NoiseData::ParamsData _paramsData{};
+	shader::NoiseData _noiseData;
+	video::Buffer _buffer;
+	int32_t _valuesIndex = -1;
+	int32_t _permIndex = -1;
+	size_t _maxBufferSize = 0u;
+
+	bool run(const voxel::Region &region, float frequency, int octaves, float lacunarity, float gain,
+			 float amplitude, core::DynamicArray<float> &values);
+
+public:
+	NoiseCompute();
+
+	bool init() override;
+	void shutdown() override;
+
+	/**
+	 * @brief Fills the values with the noise of all voxels of the given region
+	 * @param[out] values in the order x + y * width + z * width * height
+	 * @sa noise::noiseGrid()
+	 */
+	bool noise(const voxel::Region &region, float frequency, core::DynamicArray<float> &values);
+
+	/**
+	 * @brief Fills the values with the fractal brownian motion sum of the noise for all voxels of the given region
+	 * @param[out] values in the order x + y * width + z * width * height
+	 * @sa noise::fBmGrid()
+	 */
+	bool fBm(const voxel::Region &region, float frequency, uint8_t octaves, float lacunarity, float gain,
+			 core::DynamicArray<float> &values);
+
+	/**
+	 * @brief Places the given voxel at every position of the volume region where the fBm value is above the threshold
+	 *
+	 * The gpu values are evaluated into a solid mask on the thread pool - the voxels are placed row by row afterwards.
+	 * @return The region that was modified - this is invalid if nothing was placed or the evaluation failed
+	 */
+	voxel::Region fillVolume(voxel::RawVolume &volume, const voxel::Region &region, const voxel::Voxel &voxel,
+							 float threshold, float frequency, uint8_t octaves = 4, float lacunarity = 2.0f,
+							 float gain = 0.5f);
+};
+
+} // namespace voxelrender
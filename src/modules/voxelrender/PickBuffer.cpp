@@ -0,0 +1,118 @@
+/**
+ * @file
+ */
+
+#include "PickBuffer.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "video/FrameBufferConfig.h"
+#include "video/Renderer.h"
+#include "video/TextureConfig.h"
+
+namespace voxelrender {
+
+bool PickBuffer::init() {
+	if (!video::hasFeature(video::Feature::TextureFloat)) {
+		Log::debug("No float texture support - the voxels can't be picked on the gpu");
+		return false;
+	}
+	video::TextureConfig tcfg = video::createDefaultTextureConfig();
+	tcfg.format(video::TextureFormat::RGBA32F);
+	tcfg.filter(video::TextureFilter::Nearest);
+	video::FrameBufferConfig cfg;
+	cfg.dimension(glm::ivec2(1));
+	cfg.addTextureAttachment(tcfg, video::FrameBufferAttachment::Color0);
+	cfg.depthBuffer(true);
+	if (!_frameBuffer.init(cfg)) {
+		Log::warn("Failed to initialize the pick framebuffer");
+		shutdown();
+		return false;
+	}
+	for (int i = 0; i < MaxPending; ++i) {
+		video::genBuffers(1, &_slots[i].handle);
+		if (_slots[i].handle == video::InvalidId) {
+			Log::error("Failed to create the pick pixel pack buffers");
+			shutdown();
+			return false;
+		}
+		video::bufferData(_slots[i].handle, video::BufferType::PixelPackBuffer, video::BufferMode::Stream, nullptr,
+						  sizeof(glm::vec4));
+	}
+	return true;
+}
+
+void PickBuffer::shutdown() {
+	for (int i = 0; i < MaxPending; ++i) {
+		Slot &slot = _slots[i];
+		video::deleteFence(slot.fence);
+		if (slot.handle != video::InvalidId) {
+			video::deleteBuffers(1, &slot.handle);
+		}
+		slot = Slot();
+	}
+	_tail = 0;
+	_pending = 0;
+	_frameBuffer.shutdown();
+}
+
+bool PickBuffer::read(const glm::ivec2 &pixel) {
+	if (full()) {
+		return false;
+	}
+	const video::TexturePtr &texture = _frameBuffer.texture(video::FrameBufferAttachment::Color0);
+	if (!texture) {
+		return false;
+	}
+	core_trace_scoped(PickBufferRead);
+	Slot &slot = _slots[(_tail + _pending) % MaxPending];
+	if (!video::readTextureAsync(video::TextureUnit::Upload, texture->type(), texture->format(), texture->handle(),
+								 slot.handle)) {
+		Log::error("Failed to read the pick texture");
+		return false;
+	}
+	slot.fence = video::genFence();
+	slot.pixel = pixel;
+	++_pending;
+	return true;
+}
+
+bool PickBuffer::pop(PickResult &result) {
+	if (_pending == 0) {
+		return false;
+	}
+	Slot &slot = _slots[_tail];
+	if (!video::waitFence(slot.fence, 0u)) {
+		return false;
+	}
+	video::deleteFence(slot.fence);
+	_tail = (_tail + 1) % MaxPending;
+	--_pending;
+	const glm::vec4 *value =
+		(const glm::vec4 *)video::mapBuffer(slot.handle, video::BufferType::PixelPackBuffer, video::AccessMode::Read);
+	if (value == nullptr) {
+		Log::error("Failed to map the pick pixel pack buffer");
+		return false;
+	}
+	result = decode(*value, slot.pixel);
+	video::unmapBuffer(slot.handle, video::BufferType::PixelPackBuffer);
+	return true;
+}
+
+PickResult PickBuffer::decode(const glm::vec4 &value, const glm::ivec2 &pixel) {
+	PickResult result;
+	result.pixel = pixel;
+	const int code = (int)value.r;
+	if (code <= 0) {
+		return result;
+	}
+	const int face = code % 8;
+	if (face >= (int)voxel::FaceNames::Max) {
+		return result;
+	}
+	result.idx = code / 8 - 1;
+	result.face = (voxel::FaceNames)face;
+	result.voxel = glm::ivec3(glm::floor(glm::vec3(value.g, value.b, value.a) + 0.5f));
+	return result;
+}
+
+} // namespace voxelrender
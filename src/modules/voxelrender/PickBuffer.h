@@ -0,0 +1,98 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include "core/IComponent.h"
+#include "video/FrameBuffer.h"
+#include "video/Types.h"
+#include "voxel/Face.h"
+
+namespace voxelrender {
+
+/**
+ * @brief The voxel that was rendered at a pixel of the pick pass
+ */
+struct PickResult {
+	/**
+	 * @brief The mouse position the pick was done for - in the same coordinates as for video::Camera::mouseRay()
+	 */
+	glm::ivec2 pixel{0};
+	/**
+	 * @brief The volume index of the hit voxel - @c -1 if no voxel was hit
+	 */
+	int idx = -1;
+	glm::ivec3 voxel{0};
+	/**
+	 * @brief The face of the voxel the ray entered - like voxel::raycastFaceDetection()
+	 */
+	voxel::FaceNames face = voxel::FaceNames::Max;
+
+	inline bool didHit() const {
+		return idx != -1;
+	}
+};
+
+/**
+ * @brief The one pixel render target of the pick pass and the asynchronous readback of its value
+ *
+ * The value is copied into a pixel pack buffer that is guarded by a fence - it is only mapped once the gpu finished
+ * the pass. This way the result is usually available one frame later without stalling the pipeline.
+ *
+ * The voxelpick shader writes the volume index plus one multiplied by 8 plus the face into the red channel and the
+ * voxel position into the other channels. The float channels hold these integers exactly.
+ *
+ * @sa video::TextureReadback
+ */
+class PickBuffer : public core::IComponent {
+public:
+	static constexpr int MaxPending = 3;
+
+private:
+	struct Slot {
+		video::Id handle = video::InvalidId;
+		video::IdPtr fence = video::InvalidIdPtr;
+		glm::ivec2 pixel{0};
+	};
+	video::FrameBuffer _frameBuffer;
+	Slot _slots[MaxPending];
+	/** the oldest slot that is in flight */
+	int _tail = 0;
+	int _pending = 0;
+
+public:
+	bool init() override;
+	void shutdown() override;
+
+	video::FrameBuffer &frameBuffer();
+
+	/**
+	 * @brief Starts to read back the value that the pick pass wrote for the given mouse position
+	 * @return @c false if all slots are in flight - see full()
+	 */
+	bool read(const glm::ivec2 &pixel);
+	/**
+	 * @brief Returns the result of the oldest read - without waiting for the gpu
+	 * @return @c false if there is no read or the oldest one is still in flight
+	 */
+	bool pop(PickResult &result);
+
+	bool full() const;
+
+	/**
+	 * @brief Converts the value of the pick pass into the result
+	 */
+	static PickResult decode(const glm::vec4 &value, const glm::ivec2 &pixel);
+};
+
+inline video::FrameBuffer &PickBuffer::frameBuffer() {
+	return _frameBuffer;
+}
+
+inline bool PickBuffer::full() const {
+	return _pending == MaxPending;
+}
+
+} // namespace voxelrender
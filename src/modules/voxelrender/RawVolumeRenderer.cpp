@@ -4,25 +4,41 @@
 
 #include "RawVolumeRenderer.h"
 #include "core/Common.h"
+#include "core/Memory.h"
+#include "core/Hash.h"
+#include "core/TimeProvider.h"
 #include "core/Trace.h"
+#include <glm/ext/matrix_projection.hpp>
+#include <glm/ext/matrix_transform.hpp>
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/gtc/epsilon.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/trigonometric.hpp>
 #include "video/FrameBufferConfig.h"
+#include "video/GPUTimer.h"
 #include "video/ScopedFrameBuffer.h"
 #include "video/Texture.h"
 #include "video/TextureConfig.h"
 #include "voxel/ChunkMesh.h"
+#include "voxel/CubicFaceExtractor.h"
 #include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/MarchingCubesSurfaceExtractor.h"
+#include "voxel/SurfaceNetsSurfaceExtractor.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxelutil/VolumeMerger.h"
+#include "voxelutil/VolumeRescaler.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
 #include "video/ScopedLineWidth.h"
 #include "video/ScopedPolygonMode.h"
+#include "video/ScopedBlendMode.h"
+#include "MeshCache.h"
 #include "ShaderAttribute.h"
+#include "math/Ray.h"
 #include "video/Camera.h"
 #include "video/Types.h"
 #include "video/Renderer.h"
+#include "video/StreamBuffer.h"
 #include "video/ScopedState.h"
 #include "video/Shader.h"
 #include "core/Color.h"
@@ -34,6 +50,9 @@
 #include "core/Algorithm.h"
 #include "core/StandardLib.h"
 #include "VoxelShaderConstants.h"
+#include "VoxelindirectShaderConstants.h"
+#include "VoxelinstancedShaderConstants.h"
+#include "VoxelpullingShaderConstants.h"
 #include <SDL_timer.h>
 
 namespace voxelrender {
@@ -50,11 +69,22 @@ bool RenderContext::init(const glm::ivec2 &size) {
 		return false;
 	}
 
+	initOIT(size);
+
 	// we have to do an y-flip here due to the framebuffer handling
 	if (!bloomRenderer.init(true, size.x, size.y)) {
 		Log::error("Failed to initialize the bloom renderer");
 		return false;
 	}
+
+	voxelrender::ShadowParameters shadowParams;
+	shadowParams.maxDepthBuffers = shader::VoxelShaderConstants::getMaxDepthBuffers();
+	if (!shadow.init(shadowParams)) {
+		Log::error("Failed to initialize the shadow object");
+		return false;
+	}
+	shadowStateHash = 0u;
+	shadowRevision = 0u;
 	return true;
 }
 
@@ -73,6 +103,9 @@ bool RenderContext::resize(const glm::ivec2 &size) {
 		return false;
 	}
 
+	oitFrameBuffer.shutdown();
+	initOIT(size);
+
 	// we have to do an y-flip here due to the framebuffer handling
 	if (!bloomRenderer.resize(size.x, size.y)) {
 		Log::error("Failed to initialize the bloom renderer");
@@ -81,24 +114,82 @@ bool RenderContext::resize(const glm::ivec2 &size) {
 	return true;
 }
 
+void RenderContext::initOIT(const glm::ivec2 &size) {
+	if (!video::hasFeature(video::Feature::TextureHalfFloat)) {
+		return;
+	}
+	video::TextureConfig tcfg = video::createDefaultTextureConfig();
+	tcfg.format(video::TextureFormat::RGBA16F);
+	tcfg.filter(video::TextureFilter::Nearest);
+	video::FrameBufferConfig cfg;
+	cfg.dimension(size);
+	cfg.addTextureAttachment(tcfg, video::FrameBufferAttachment::Color0); // accumulated color
+	cfg.addTextureAttachment(tcfg, video::FrameBufferAttachment::Color1); // accumulated weight and coverage
+	cfg.depthBuffer(true);
+	if (!oitFrameBuffer.init(cfg)) {
+		Log::warn("Failed to initialize the order independent transparency framebuffer");
+		oitFrameBuffer.shutdown();
+	}
+}
+
 void RenderContext::shutdown() {
 	frameBuffer.shutdown();
+	oitFrameBuffer.shutdown();
 	bloomRenderer.shutdown();
+	shadow.shutdown();
 }
 
 RawVolumeRenderer::RawVolumeRenderer() :
 		_voxelShader(shader::VoxelShader::getInstance()),
+		_voxelIndirectShader(shader::VoxelindirectShader::getInstance()),
+		_voxelInstancedShader(shader::VoxelinstancedShader::getInstance()),
+		_voxelPullingShader(shader::VoxelpullingShader::getInstance()),
+		_voxelOITShader(shader::VoxeloitShader::getInstance()),
+		_voxelOITCompositeShader(shader::VoxeloitcompositeShader::getInstance()),
+		_voxelPickShader(shader::VoxelpickShader::getInstance()),
 		_shadowMapShader(shader::ShadowmapShader::getInstance()) {
 }
 
 void RawVolumeRenderer::construct() {
 	core::Var::get(cfg::VoxelMeshSize, "64", core::CV_READONLY);
+	core::Var::get(cfg::VoxelMeshMode, "0", "The surface extractor of the volumes - 0 cubes, 1 marching cubes, 2 surface nets", core::Var::minMaxValidator<0, (int)MeshMode::Max - 1>);
+	core::Var::get(cfg::VoxelOcclusionCulling, "false", "Skip the chunks that were hidden behind other geometry in the previous frame", core::Var::boolValidator);
+	core::Var::get(cfg::VoxelMultiDrawIndirect, "false", "Render all volumes with one multi draw indirect call per pass", core::Var::boolValidator);
+	core::Var::get(cfg::VoxelVertexPulling, "false", "Experimental: build the quads of the cubic volumes in the vertex shader - without shadows", core::Var::boolValidator);
+	core::Var::get(cfg::VoxelComputeFaces, "false", "Experimental: collect the visible faces of the vertex pulling path with a compute shader", core::Var::boolValidator);
+	core::Var::get(cfg::VoxelRayMarching, "false", "Experimental: ray march the volumes instead of extracting meshes - without shadows and transparency", core::Var::boolValidator);
+	core::Var::get(cfg::VoxelOrderIndependentTransparency, "false", "Blend the transparent voxels without sorting them - they don't glow", core::Var::boolValidator);
+	core::Var::get(cfg::VoxelLODThreshold, "0", "Switch a chunk to a downsampled mesh if its voxels would not cover more than this amount of pixels - 0 disables it");
+	core::Var::get(cfg::VoxelOptimizeMesh, "false", "Reorder the chunk meshes for the vertex cache of the gpu before they are uploaded", core::Var::boolValidator);
+	core::Var::get(cfg::VoxelExtractionBudget, "4", "Milliseconds per frame to hand the dirty chunks to the extractor tasks - 0 disables the budget");
+	core::Var::get(cfg::VoxelUploadBudget, "8192", "Kilobytes of chunk meshes that are uploaded per frame - 0 uploads all finished meshes");
+	core::Var::get(cfg::VoxelMeshCache, "false", "Cache the chunk meshes on disk to speed up reopening large scenes", core::Var::boolValidator);
+	core::Var::get(cfg::VoxelSortAngle, "5", "Degrees the view direction to a chunk may change before its transparent voxels are sorted again");
+	core::Var::get(cfg::VoxelSortBudget, "65536", "Transparent triangles that are sorted per frame - 0 disables the budget");
 }
 
 bool RawVolumeRenderer::init() {
 	_shadowMap = core::Var::getSafe(cfg::ClientShadowMap);
 	_bloom = core::Var::getSafe(cfg::ClientBloom);
 	_meshSize = core::Var::getSafe(cfg::VoxelMeshSize);
+	_meshMode = core::Var::getSafe(cfg::VoxelMeshMode);
+	_meshMode->markClean();
+	_lodThreshold = core::Var::getSafe(cfg::VoxelLODThreshold);
+	_lodThreshold->markClean();
+	_lodsEnabled = _lodThreshold->floatVal() > 0.0f;
+	_optimizeMesh = core::Var::getSafe(cfg::VoxelOptimizeMesh);
+	_occlusionCulling = core::Var::getSafe(cfg::VoxelOcclusionCulling);
+	_multiDrawIndirect = core::Var::getSafe(cfg::VoxelMultiDrawIndirect);
+	_multiDrawIndirect->markClean();
+	_vertexPulling = core::Var::getSafe(cfg::VoxelVertexPulling);
+	_computeFaces = core::Var::getSafe(cfg::VoxelComputeFaces);
+	_rayMarching = core::Var::getSafe(cfg::VoxelRayMarching);
+	_orderIndependentTransparency = core::Var::getSafe(cfg::VoxelOrderIndependentTransparency);
+	_extractionBudget = core::Var::getSafe(cfg::VoxelExtractionBudget);
+	_uploadBudget = core::Var::getSafe(cfg::VoxelUploadBudget);
+	_meshCache = core::Var::getSafe(cfg::VoxelMeshCache);
+	_sortAngle = core::Var::getSafe(cfg::VoxelSortAngle);
+	_sortBudget = core::Var::getSafe(cfg::VoxelSortBudget);
 
 	_threadPool.init();
 	Log::debug("Threadpool size: %i", (int)_threadPool.size());
@@ -114,6 +205,70 @@ bool RawVolumeRenderer::init() {
 	alignas(16) shader::ShadowmapData::BlockData var;
 	_shadowMapUniformBlock.create(var);
 
+	if (video::hasFeature(video::Feature::InstancedArrays)) {
+		if (!_voxelInstancedShader.setup()) {
+			Log::warn("Failed to initialize the voxel instanced shader - references are rendered one by one");
+		} else {
+			// the instances are rendered with the vertex buffers that were set up for the voxel shader
+			_instancingSupported = _voxelInstancedShader.getLocationPos() == _voxelShader.getLocationPos() &&
+								   _voxelInstancedShader.getLocationInfo() == _voxelShader.getLocationInfo();
+			_voxelInstancedData.create(_voxelInstancedVertData);
+			_voxelInstancedData.create(_voxelInstancedInstancesData);
+		}
+	}
+
+	_multiDrawIndirectSupported = video::hasFeature(video::Feature::MultiDrawIndirect) &&
+								  video::hasFeature(video::Feature::ShaderStorageBufferObject);
+	if (_multiDrawIndirectSupported) {
+		if (!_voxelIndirectShader.setup()) {
+			Log::warn("Failed to initialize the voxel indirect shader - multi draw indirect is not available");
+			_multiDrawIndirectSupported = false;
+		} else if (!initArena()) {
+			return false;
+		}
+		_voxelIndirectData.create(_voxelIndirectVertData);
+	}
+
+	_vertexPullingSupported = video::hasFeature(video::Feature::ShaderStorageBufferObject);
+	if (_vertexPullingSupported && !_voxelPullingShader.setup()) {
+		Log::warn("Failed to initialize the voxel pulling shader - vertex pulling is not available");
+		_vertexPullingSupported = false;
+	}
+	_faceComputeSupported = _vertexPullingSupported && _faceCompute.init();
+	_rayMarchingSupported = _brickMapRenderer.init();
+
+	if (!_voxelOITShader.setup() || !_voxelOITCompositeShader.setup()) {
+		Log::warn("Failed to initialize the order independent transparency shaders");
+	} else {
+		// the transparent chunks are rendered with the vertex buffers that were set up for the voxel shader
+		_oitSupported = _voxelOITShader.getLocationPos() == _voxelShader.getLocationPos() &&
+						_voxelOITShader.getLocationInfo() == _voxelShader.getLocationInfo();
+		const int32_t quadIndex = _oitQuad.createFullscreenQuad();
+		core_assert_always(_oitQuad.addAttribute(_voxelOITCompositeShader.getPosAttribute(quadIndex, &glm::vec2::x)));
+	}
+
+	if (!_voxelPickShader.setup()) {
+		Log::warn("Failed to initialize the voxel pick shader - the voxels are picked on the cpu");
+	} else {
+		// the chunks are rendered with the vertex buffers that were set up for the voxel shader
+		_pickSupported = _voxelPickShader.getLocationPos() == _voxelShader.getLocationPos() &&
+						 _voxelPickShader.getLocationInfo() == _voxelShader.getLocationInfo() && _pickBuffer.init();
+	}
+
+	_occlusionBoxVertexIndex = _occlusionBoxBuffer.create();
+	_occlusionBoxIndexIndex = _occlusionBoxBuffer.create(nullptr, 0, video::BufferType::IndexBuffer);
+	if (_occlusionBoxVertexIndex == -1 || _occlusionBoxIndexIndex == -1) {
+		Log::error("Could not create the buffers for the occlusion boxes");
+		return false;
+	}
+	_occlusionBoxBuffer.setMode(_occlusionBoxVertexIndex, video::BufferMode::Dynamic);
+	_occlusionBoxBuffer.setMode(_occlusionBoxIndexIndex, video::BufferMode::Dynamic);
+	// always the full vertex format - the boxes don't depend on the mesh mode
+	_occlusionBoxBuffer.addAttribute(getPositionVertexAttribute(_occlusionBoxVertexIndex, _voxelShader.getLocationPos(),
+																_voxelShader.getComponentsPos()));
+	_occlusionBoxBuffer.addAttribute(getInfoVertexAttribute(_occlusionBoxVertexIndex, _voxelShader.getLocationInfo(),
+															_voxelShader.getComponentsInfo()));
+
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
 		State& state = _state[idx];
 		state._model = glm::mat4(1.0f);
@@ -129,6 +284,17 @@ bool RawVolumeRenderer::init() {
 				Log::error("Could not create the vertex buffer object for the indices");
 				return false;
 			}
+			// the chunk meshes are updated in place
+			state._vertexBuffer[i].setMode(state._vertexBufferIndex[i], video::BufferMode::Dynamic);
+			state._vertexBuffer[i].setMode(state._indexBufferIndex[i], video::BufferMode::Dynamic);
+			if (_vertexPullingSupported) {
+				state._faceBufferIndex[i] = state._faceBuffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+				if (state._faceBufferIndex[i] == -1) {
+					Log::error("Could not create the face buffer");
+					return false;
+				}
+				state._faceBuffer.setMode(state._faceBufferIndex[i], video::BufferMode::Dynamic);
+			}
 		}
 	}
 
@@ -139,35 +305,366 @@ bool RawVolumeRenderer::init() {
 		return false;
 	}
 
+	if (!_streamBuffer.init(StreamBufferSize)) {
+		Log::debug("No stream buffer available - the buffers are updated directly");
+	}
+
+	_packedVertices = usePackedVertices();
+	setupVertexAttributes();
+	_vertexPullingActive = useVertexPulling();
+	_rayMarchingActive = useRayMarching();
+
+	_voxelShaderFragData.diffuseColor = glm::vec3(0.0f, 0.0f, 0.0f);
+	_voxelShaderFragData.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
+
+	_voxelData.create(_voxelShaderFragData);
+	_voxelData.create(_voxelShaderVertData);
+
+	return true;
+}
+
+void RawVolumeRenderer::addVertexAttributes(video::Buffer &buffer, int32_t bufferIndex, int posLocation,
+											int posComponents, int infoLocation, int infoComponents) const {
+	if (_packedVertices) {
+		buffer.addAttribute(getPackedPositionVertexAttribute(bufferIndex, posLocation, posComponents));
+		buffer.addAttribute(getPackedInfoVertexAttribute(bufferIndex, infoLocation, infoComponents));
+	} else {
+		buffer.addAttribute(getPositionVertexAttribute(bufferIndex, posLocation, posComponents));
+		buffer.addAttribute(getInfoVertexAttribute(bufferIndex, infoLocation, infoComponents));
+	}
+}
+
+void RawVolumeRenderer::setupVertexAttributes() {
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
 		State& state = _state[idx];
 		for (int i = 0; i < MeshType_Max; ++i) {
-			const video::Attribute& attributePos = getPositionVertexAttribute(
-					state._vertexBufferIndex[i], _voxelShader.getLocationPos(),
-					_voxelShader.getComponentsPos());
-			state._vertexBuffer[i].addAttribute(attributePos);
+			state._vertexBuffer[i].clearAttributes();
+			addVertexAttributes(state._vertexBuffer[i], state._vertexBufferIndex[i], _voxelShader.getLocationPos(),
+								_voxelShader.getComponentsPos(), _voxelShader.getLocationInfo(),
+								_voxelShader.getComponentsInfo());
+		}
+	}
+	if (!_multiDrawIndirectSupported) {
+		return;
+	}
+	for (int i = 0; i < MeshType_Max; ++i) {
+		Arena &arena = _arena[i];
+		arena.buffer.clearAttributes();
+		addVertexAttributes(arena.buffer, arena.vertexIndex, _voxelIndirectShader.getLocationPos(),
+							_voxelIndirectShader.getComponentsPos(), _voxelIndirectShader.getLocationInfo(),
+							_voxelIndirectShader.getComponentsInfo());
+		video::Attribute attributeDraw;
+		attributeDraw.bufferIndex = arena.drawIdIndex;
+		attributeDraw.location = _voxelIndirectShader.getLocationDraw();
+		attributeDraw.stride = sizeof(uint32_t);
+		attributeDraw.size = _voxelIndirectShader.getComponentsDraw();
+		attributeDraw.type = video::mapType<uint32_t>();
+		attributeDraw.typeIsInt = true;
+		// the base instance of the draw command selects the draw slot
+		attributeDraw.divisor = 1;
+		arena.buffer.addAttribute(attributeDraw);
+	}
+}
+
+size_t RawVolumeRenderer::vertexSize() const {
+	return _packedVertices ? sizeof(voxel::PackedVoxelVertex) : sizeof(voxel::VoxelVertex);
+}
+
+/**
+ * @brief Writes the vertices in the gpu vertex format into the given memory
+ */
+static void copyVertices(uint8_t *dst, const voxel::VertexArray &vertices, bool packed) {
+	if (!packed) {
+		core_memcpy(dst, vertices.data(), vertices.size() * sizeof(voxel::VoxelVertex));
+		return;
+	}
+	voxel::PackedVoxelVertex *packedDst = (voxel::PackedVoxelVertex *)dst;
+	for (const voxel::VoxelVertex &vertex : vertices) {
+		*packedDst++ = voxel::packVertex(vertex);
+	}
+}
 
-			const video::Attribute& attributeInfo = getInfoVertexAttribute(
-					state._vertexBufferIndex[i], _voxelShader.getLocationInfo(),
-					_voxelShader.getComponentsInfo());
-			state._vertexBuffer[i].addAttribute(attributeInfo);
+/**
+ * @brief Copies the chunk indices moved by the vertex offset of the chunk range in the given index size
+ */
+static void copyIndices(uint8_t *dst, size_t indexSize, const voxel::IndexType *indices, size_t n,
+						uint32_t vertexOffset) {
+	if (indexSize == sizeof(uint16_t)) {
+		uint16_t *indices16 = (uint16_t *)dst;
+		for (size_t i = 0; i < n; ++i) {
+			indices16[i] = (uint16_t)(indices[i] + vertexOffset);
 		}
+		return;
+	}
+	voxel::IndexType *indices32 = (voxel::IndexType *)dst;
+	for (size_t i = 0; i < n; ++i) {
+		indices32[i] = indices[i] + vertexOffset;
 	}
+}
 
-	voxelrender::ShadowParameters shadowParams;
-	shadowParams.maxDepthBuffers = shader::VoxelShaderConstants::getMaxDepthBuffers();
-	if (!_shadow.init(shadowParams)) {
-		Log::error("Failed to initialize the shadow object");
+template<class FUNC>
+bool RawVolumeRenderer::uploadBuffer(video::Buffer &buffer, int32_t bufferIndex, size_t offset, size_t size, bool resize, FUNC &&fill) {
+	size_t streamOffset = 0u;
+	uint8_t *mapped = _streamBuffer.allocate(size, streamOffset);
+	if (mapped != nullptr) {
+		fill(mapped);
+		if (resize && !buffer.reserve(bufferIndex, size)) {
+			return false;
+		}
+		return _streamBuffer.copy(streamOffset, buffer, bufferIndex, offset, size);
+	}
+	uint8_t *data = (uint8_t *)core_malloc(size);
+	fill(data);
+	const bool success = resize ? buffer.update(bufferIndex, data, size) : buffer.updateRange(bufferIndex, offset, data, size);
+	core_free(data);
+	return success;
+}
+
+bool RawVolumeRenderer::initArena() {
+	core::DynamicArray<uint32_t> drawIds;
+	drawIds.reserve(MAX_VOLUMES);
+	for (uint32_t i = 0; i < (uint32_t)MAX_VOLUMES; ++i) {
+		drawIds.push_back(i);
+	}
+	for (int i = 0; i < MeshType_Max; ++i) {
+		Arena &arena = _arena[i];
+		arena.vertexIndex = arena.buffer.create();
+		arena.indexIndex = arena.buffer.create(nullptr, 0, video::BufferType::IndexBuffer);
+		arena.drawIdIndex = arena.buffer.create(drawIds.data(), drawIds.size() * sizeof(uint32_t));
+		arena.commandIndex = arena.buffer.create(nullptr, 0, video::BufferType::IndirectBuffer);
+		if (arena.vertexIndex == -1 || arena.indexIndex == -1 || arena.drawIdIndex == -1 || arena.commandIndex == -1) {
+			Log::error("Could not create the arena buffers");
+			return false;
+		}
+		arena.buffer.setMode(arena.commandIndex, video::BufferMode::Dynamic);
+		arena.dirty = true;
+	}
+
+	_drawDataIndex = _drawDataBuffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+	_paletteDataIndex = _drawDataBuffer.create(nullptr, 0, video::BufferType::ShaderStorageBuffer);
+	if (_drawDataIndex == -1 || _paletteDataIndex == -1) {
+		Log::error("Could not create the draw data buffers");
 		return false;
 	}
+	_drawDataBuffer.setMode(_drawDataIndex, video::BufferMode::Dynamic);
+	_paletteData.clear();
+	_paletteSlotHashes.clear();
+	return true;
+}
 
-	_voxelShaderFragData.diffuseColor = glm::vec3(0.0f, 0.0f, 0.0f);
-	_voxelShaderFragData.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
+/**
+ * @brief Creates the downsampled meshes for the given chunk. Every level is produced by halving the
+ * resolution of the previous level.
+ *
+ * @param[in] copy The chunk volume with a border of at least @code 2^(MaxLODs-1) @endcode voxels
+ * @param[out] lods The meshes of the levels 1 to MaxLODs-1 - the vertices are in full resolution volume space
+ */
+static void extractLODMeshes(const voxel::RawVolume &copy, const voxel::Palette &palette, const voxel::Region &finalRegion, voxel::Mesh *lods) {
+	core_trace_scoped(RawVolumeRendererExtractLODs);
+	const voxel::RawVolume *source = &copy;
+	voxel::Region sourceRegion = copy.region();
+	for (int lod = 1; lod < RawVolumeRenderer::MaxLODs; ++lod) {
+		const voxel::Region lodRegion(sourceRegion.getLowerCorner() >> 1, ((sourceRegion.getUpperCorner() + 1) >> 1) - 1);
+		voxel::RawVolume *lodVolume = new voxel::RawVolume(lodRegion);
+		voxelutil::rescaleVolume(*source, palette, sourceRegion, *lodVolume, lodRegion);
+		if (source != &copy) {
+			delete source;
+		}
 
-	_voxelData.create(_voxelShaderFragData);
-	_voxelData.create(_voxelShaderVertData);
+		const glm::ivec3 translate = finalRegion.getLowerCorner() >> lod;
+		voxel::Region extractRegion(translate, ((finalRegion.getUpperCorner() + 1) >> lod) - 1);
+		extractRegion.shiftUpperCorner(1, 1, 1);
+		voxel::ChunkMesh mesh(16384, 16384, true);
+		voxel::extractCubicMesh(lodVolume, extractRegion, &mesh, translate);
+		const float scale = (float)(1 << lod);
+		for (voxel::VoxelVertex &vertex : mesh.mesh[0].getVertexVector()) {
+			vertex.position *= scale;
+		}
+		lods[lod - 1] = core::move(mesh.mesh[0]);
 
-	return true;
+		source = lodVolume;
+		sourceRegion = lodRegion;
+	}
+	if (source != &copy) {
+		delete source;
+	}
+}
+
+void RawVolumeRenderer::prioritizeExtractions() {
+	if (_extractRegionsSorted || !_hasPriorityCamera) {
+		return;
+	}
+	_extractRegionsSorted = true;
+	if (_extractRegions.size() < 2) {
+		return;
+	}
+	core_trace_scoped(RawVolumeRendererPrioritizeExtractions);
+	// the regions of one volume are queued next to each other
+	int lastIdx = -1;
+	math::Frustum frustum;
+	glm::vec3 eye(0.0f);
+	const float halfMeshSize = (float)_meshSize->intVal() * 0.5f;
+	for (ExtractRegion &extractRegion : _extractRegions) {
+		const int idx = extractRegion.idx;
+		if (idx < 0) {
+			continue;
+		}
+		if (idx != lastIdx) {
+			lastIdx = idx;
+			frustum = volumeFrustum(idx, _priorityViewProjection);
+			const State &state = _state[idx];
+			const glm::mat4 &model = glm::translate(state._model, -state._pivot);
+			eye = glm::vec3(glm::inverse(model) * glm::vec4(_priorityEye, 1.0f));
+		}
+		const glm::ivec3 &mins = extractRegion.region.getLowerCorner();
+		extractRegion.visible = isChunkVisible(frustum, mins);
+		const glm::vec3 delta = glm::vec3(mins) + halfMeshSize - eye;
+		extractRegion.distance = glm::dot(delta, delta);
+	}
+	core::sort(_extractRegions.begin(), _extractRegions.end(), [](const ExtractRegion &lhs, const ExtractRegion &rhs) {
+		if (lhs.visible != rhs.visible) {
+			return lhs.visible;
+		}
+		return lhs.distance < rhs.distance;
+	});
+}
+
+void RawVolumeRenderer::scheduleExtraction(const ExtractRegion &entry) {
+	const int idx = entry.idx;
+	const voxel::RawVolume *v = volume(idx);
+	if (v == nullptr) {
+		return;
+	}
+	const voxel::Region& finalRegion = entry.region;
+	bool onlyAir = true;
+	const MeshMode meshMode = (MeshMode)_meshMode->intVal();
+	const bool smoothMesh = meshMode != MeshMode::Cubes;
+	const bool optimize = _optimizeMesh->boolVal();
+	const bool lods = _lodsEnabled && !smoothMesh && !_vertexPullingActive;
+	// the downsampled levels need a larger border to still have the neighbours of the chunk voxels
+	const int border = lods ? 4 : 2;
+	voxel::RawVolume copy(v, voxel::Region(finalRegion.getLowerCorner() - border, finalRegion.getUpperCorner() + border), &onlyAir);
+	const glm::ivec3& mins = finalRegion.getLowerCorner();
+	// the tasks only work on the copy - the version orders the results of the same chunk
+	const uint32_t version = ++_chunkVersion;
+	const bool meshCache = _meshCache->boolVal();
+	MeshCacheSettings cacheSettings;
+	cacheSettings.meshMode = meshMode;
+	cacheSettings.optimize = optimize;
+	if (!onlyAir && smoothMesh) {
+		const voxel::Palette &palette = volumePalette(idx);
+		cacheSettings.paletteHash = palette.hash();
+		if (meshMode == MeshMode::SurfaceNets) {
+			const glm::ivec3 &volumeMins = v->region().getLowerCorner();
+			for (int i = 0; i < 3; ++i) {
+				if (mins[i] == volumeMins[i]) {
+					cacheSettings.lowerVolumeBorder |= 1 << i;
+				}
+			}
+		}
+		_threadPool.enqueue([movedCopy = core::move(copy), palette, mins, idx, version, finalRegion, optimize, meshCache, cacheSettings, this] () {
+			++_runningExtractorTasks;
+			voxel::ChunkMesh mesh(65536, 65536, true);
+			const uint64_t cacheKey = meshCache ? MeshCache::key(movedCopy, mins, cacheSettings) : 0u;
+			if (meshCache && MeshCache::load(cacheKey, mesh)) {
+				_pendingQueue.emplace(mins, idx, version, core::move(mesh));
+				Log::debug("Enqueue cached smooth mesh for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
+				--_runningExtractorTasks;
+				return;
+			}
+			voxel::Region extractRegion = finalRegion;
+			if (cacheSettings.meshMode == MeshMode::SurfaceNets) {
+				// the chunk owns the quads of the voxel edges that start in it - only the chunks at the lower volume
+				// border also need the quads to the voxels below the volume
+				const uint8_t border = cacheSettings.lowerVolumeBorder;
+				extractRegion.shiftLowerCorner(-(border & 1), -((border >> 1) & 1), -((border >> 2) & 1));
+				voxel::extractSurfaceNetsMesh(&movedCopy, palette, extractRegion, &mesh);
+			} else {
+				// the cells between this chunk and the lower neighbours belong to this chunk
+				extractRegion.shiftLowerCorner(-1, -1, -1);
+				voxel::extractMarchingCubesMesh(&movedCopy, palette, extractRegion, &mesh);
+			}
+			// the vertices are relative to the extraction region - but the chunk meshes are rendered in volume space
+			const glm::vec3 offset(extractRegion.getLowerCorner());
+			for (voxel::VoxelVertex &vertex : mesh.mesh[0].getVertexVector()) {
+				vertex.position += offset;
+			}
+			if (optimize) {
+				mesh.optimize();
+			}
+			if (meshCache) {
+				MeshCache::save(cacheKey, mesh);
+			}
+			_pendingQueue.emplace(mins, idx, version, core::move(mesh));
+			Log::debug("Enqueue smooth mesh for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
+			--_runningExtractorTasks;
+		});
+	} else if (!onlyAir && _vertexPullingActive) {
+		voxel::ChunkFaces gpuFaces;
+		if (useFaceCompute() && _faceCompute.extract(copy, finalRegion, gpuFaces)) {
+			// the compute shader runs on the main thread - the result is handled like the ones of the tasks
+			_pendingQueue.emplace(mins, idx, version, core::move(gpuFaces));
+		} else {
+			_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, version, finalRegion, this] () {
+				++_runningExtractorTasks;
+				// every face belongs to the voxel in front of it - no need to extend the region
+				voxel::ChunkFaces faces;
+				voxel::extractCubicFaces(&movedCopy, finalRegion, &faces);
+				_pendingQueue.emplace(mins, idx, version, core::move(faces));
+				Log::debug("Enqueue faces for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
+				--_runningExtractorTasks;
+			});
+		}
+	} else if (!onlyAir && lods) {
+		const voxel::Palette &palette = volumePalette(idx);
+		_threadPool.enqueue([movedCopy = core::move(copy), palette, mins, idx, version, finalRegion, optimize, this] () {
+			++_runningExtractorTasks;
+			voxel::ChunkMesh mesh(65536, 65536, true);
+			voxel::Region extractRegion = finalRegion;
+			extractRegion.shiftUpperCorner(1, 1, 1);
+			voxel::extractCubicMesh(&movedCopy, extractRegion, &mesh, mins);
+			voxel::Mesh lodMeshes[MaxLODs - 1];
+			extractLODMeshes(movedCopy, palette, finalRegion, lodMeshes);
+			if (optimize) {
+				mesh.optimize();
+				for (voxel::Mesh &lodMesh : lodMeshes) {
+					lodMesh.optimize();
+				}
+			}
+			_pendingQueue.emplace(mins, idx, version, core::move(mesh), lodMeshes);
+			Log::debug("Enqueue mesh with lods for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
+			--_runningExtractorTasks;
+		});
+	} else if (!onlyAir) {
+		_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, version, finalRegion, optimize, meshCache, cacheSettings, this] () {
+			++_runningExtractorTasks;
+			voxel::ChunkMesh mesh(65536, 65536, true);
+			const uint64_t cacheKey = meshCache ? MeshCache::key(movedCopy, mins, cacheSettings) : 0u;
+			if (meshCache && MeshCache::load(cacheKey, mesh)) {
+				_pendingQueue.emplace(mins, idx, version, core::move(mesh));
+				Log::debug("Enqueue cached mesh for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
+				--_runningExtractorTasks;
+				return;
+			}
+			voxel::Region extractRegion = finalRegion;
+			extractRegion.shiftUpperCorner(1, 1, 1);
+			voxel::extractCubicMesh(&movedCopy, extractRegion, &mesh, mins, cacheSettings.mergeQuads,
+									cacheSettings.reuseVertices, cacheSettings.ambientOcclusion);
+			if (optimize) {
+				mesh.optimize();
+			}
+			if (meshCache) {
+				MeshCache::save(cacheKey, mesh);
+			}
+			_pendingQueue.emplace(mins, idx, version, core::move(mesh));
+			Log::debug("Enqueue mesh for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
+			--_runningExtractorTasks;
+		});
+	} else if (_vertexPullingActive) {
+		_pendingQueue.emplace(mins, idx, version, voxel::ChunkFaces());
+	} else {
+		_pendingQueue.emplace(mins, idx, version, core::move(voxel::ChunkMesh(0, 0)));
+	}
 }
 
 bool RawVolumeRenderer::scheduleExtractions(size_t maxExtraction) {
@@ -178,52 +675,180 @@ bool RawVolumeRenderer::scheduleExtractions(size_t maxExtraction) {
 	if (maxExtraction == 0) {
 		return true;
 	}
+	prioritizeExtractions();
+	size_t i;
+	for (i = 0; i < n && i < maxExtraction; ++i) {
+		scheduleExtraction(_extractRegions[i]);
+	}
+	_extractRegions.erase(0, i);
+
+	return true;
+}
+
+void RawVolumeRenderer::scheduleBudgetedExtractions() {
+	const size_t n = _extractRegions.size();
+	if (n == 0) {
+		return;
+	}
+	core_trace_scoped(RawVolumeRendererScheduleExtractions);
+	prioritizeExtractions();
+	const uint64_t start = core::TimeProvider::highResTime();
+	const uint64_t budget = (uint64_t)(glm::max(0.0f, _extractionBudget->floatVal()) *
+									   (float)core::TimeProvider::highResTimeResolution() / 1000.0f);
+	// enough tasks to keep all workers busy - the regions that are not yet handed out can still be sorted by the
+	// camera of the next frame
+	const int maxTasks = (int)_threadPool.size() * 2;
 	size_t i;
 	for (i = 0; i < n; ++i) {
-		const int idx = _extractRegions[i].idx;
-		const voxel::RawVolume *v = volume(idx);
-		if (v == nullptr) {
-			continue;
-		}
-		const voxel::Region& finalRegion = _extractRegions[i].region;
-		bool onlyAir = true;
-		voxel::RawVolume copy(v, voxel::Region(finalRegion.getLowerCorner() - 2, finalRegion.getUpperCorner() + 2), &onlyAir);
-		const glm::ivec3& mins = finalRegion.getLowerCorner();
-		if (!onlyAir) {
-			_threadPool.enqueue([movedCopy = core::move(copy), mins, idx, finalRegion, this] () {
-				++_runningExtractorTasks;
-				voxel::ChunkMesh mesh(65536, 65536, true);
-				voxel::Region extractRegion = finalRegion;
-				extractRegion.shiftUpperCorner(1, 1, 1);
-				voxel::extractCubicMesh(&movedCopy, extractRegion, &mesh, mins);
-				_pendingQueue.emplace(mins, idx, core::move(mesh));
-				Log::debug("Enqueue mesh for idx: %i (%i:%i:%i)", idx, mins.x, mins.y, mins.z);
-				--_runningExtractorTasks;
-			});
-		} else {
-			_pendingQueue.emplace(mins, idx, core::move(voxel::ChunkMesh(0, 0)));
+		if (_threadPool.pendingTasks() + _runningExtractorTasks >= maxTasks) {
+			break;
 		}
-		--maxExtraction;
-		if (maxExtraction == 0) {
+		if (i > 0 && budget > 0u && core::TimeProvider::highResTime() - start >= budget) {
 			break;
 		}
+		scheduleExtraction(_extractRegions[i]);
 	}
-	_extractRegions.erase(0, i + 1);
+	_extractRegions.erase(0, i);
+}
 
-	return true;
+size_t RawVolumeRenderer::uploadSize(const ExtractionCtx &result) const {
+	if (result.faceList) {
+		size_t faces = 0u;
+		for (int i = 0; i < voxel::ChunkFaces::Lists; ++i) {
+			faces += result.faces.faces[i].size();
+		}
+		return faces * sizeof(voxel::VoxelFace);
+	}
+	size_t bytes = 0u;
+	for (int i = 0; i < MeshType_Max; ++i) {
+		const voxel::Mesh &mesh = result.mesh.mesh[i];
+		bytes += mesh.getNoOfVertices() * vertexSize() + mesh.getNoOfIndices() * sizeof(voxel::IndexType);
+	}
+	return bytes;
+}
+
+void RawVolumeRenderer::extractAllVolumes() {
+	_threadPool.abort();
+	_extractRegions.clear();
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		invalidateChunks(idx);
+		const voxel::RawVolume *v = volume(idx);
+		if (v != nullptr) {
+			extractRegion(idx, v->region());
+		}
+	}
 }
 
 void RawVolumeRenderer::update() {
-	scheduleExtractions();
+	// the mesh mode or a volume region that doesn't fit into 16 bit may change the vertex format
+	const bool packedVertices = usePackedVertices();
+	if (packedVertices != _packedVertices) {
+		_packedVertices = packedVertices;
+		setupVertexAttributes();
+		// convert the buffers of the current meshes until the new meshes are extracted
+		for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+			updateBufferForVolume(idx);
+		}
+	}
+	if (_meshMode->isDirty()) {
+		_meshMode->markClean();
+		// the surface extractor was changed - polygonize all volumes again
+		extractAllVolumes();
+	}
+	const bool rayMarching = useRayMarching();
+	if (rayMarching != _rayMarchingActive) {
+		_rayMarchingActive = rayMarching;
+		// only one representation of the volumes is kept
+		if (rayMarching) {
+			for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+				deleteVolumeMeshes(idx);
+				deleteVolumeFaces(idx);
+			}
+		} else {
+			_brickMapRenderer.clear();
+		}
+		extractAllVolumes();
+	}
+	const bool vertexPulling = useVertexPulling();
+	if (vertexPulling != _vertexPullingActive) {
+		_vertexPullingActive = vertexPulling;
+		// only one representation of the chunks is kept
+		for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+			if (vertexPulling) {
+				deleteVolumeMeshes(idx);
+			} else {
+				deleteVolumeFaces(idx);
+			}
+		}
+		extractAllVolumes();
+	}
+	if (_lodThreshold->isDirty()) {
+		_lodThreshold->markClean();
+		const bool lodsEnabled = _lodThreshold->floatVal() > 0.0f;
+		if (lodsEnabled != _lodsEnabled) {
+			_lodsEnabled = lodsEnabled;
+			// the downsampled meshes are created along with the full resolution meshes
+			extractAllVolumes();
+		}
+	}
+	scheduleBudgetedExtractions();
 	ExtractionCtx result;
 	int cnt = 0;
-	while (_pendingQueue.pop(result)) {
+	int dropped = 0;
+	// the remaining results are uploaded in the next frames - the first one is always taken to make progress
+	const size_t uploadBudget = (size_t)glm::max(0, _uploadBudget->intVal()) * 1024u;
+	size_t uploaded = 0u;
+	while ((uploadBudget == 0u || uploaded < uploadBudget) && _pendingQueue.pop(result)) {
+		State &resultState = _state[result.idx];
+		if (result.version < resultState._minChunkVersion) {
+			++dropped;
+			continue;
+		}
+		// the tasks don't finish in the order they were scheduled - don't replace a mesh of a newer snapshot
+		uint32_t &chunkVersion = resultState._chunkVersions[result.mins];
+		if (result.version < chunkVersion) {
+			++dropped;
+			continue;
+		}
+		chunkVersion = result.version;
+		if (result.faceList) {
+			uploaded += uploadSize(result);
+			State& state = _state[result.idx];
+			if (result.faces.isEmpty()) {
+				state._chunkFaces.erase(result.mins);
+			} else {
+				state._chunkFaces[result.mins] = core::move(result.faces);
+			}
+			for (int i = 0; i < MeshType_Max; ++i) {
+				const MeshType type = (MeshType)i;
+				if (!updateFaceBufferForChunk(result.idx, type, result.mins) && !updateFaceBufferForVolume(result.idx, type)) {
+					Log::error("Failed to update the faces at index %i", result.idx);
+				}
+			}
+			++cnt;
+			continue;
+		}
+		uploaded += uploadSize(result);
 		Meshes& meshes = _meshes[MeshType_Opaque][result.mins];
 		if (meshes[result.idx] != nullptr) {
 			delete meshes[result.idx];
 		}
 		meshes[result.idx] = new voxel::Mesh(core::move(result.mesh.mesh[MeshType_Opaque]));
-		if (!updateBufferForVolume(result.idx, MeshType_Opaque)) {
+		for (int i = 0; i < MaxLODs - 1; ++i) {
+			// only create the map entries for the chunks that have a mesh for this level
+			if (result.lods[i].getNoOfIndices() > 0) {
+				Meshes &lodMeshes = _lodMeshes[i][result.mins];
+				delete lodMeshes[result.idx];
+				lodMeshes[result.idx] = new voxel::Mesh(core::move(result.lods[i]));
+				continue;
+			}
+			auto lodIter = _lodMeshes[i].find(result.mins);
+			if (lodIter != _lodMeshes[i].end()) {
+				delete lodIter->second[result.idx];
+				lodIter->second[result.idx] = nullptr;
+			}
+		}
+		if (!updateBufferForChunk(result.idx, MeshType_Opaque, result.mins) && !updateBufferForVolume(result.idx, MeshType_Opaque)) {
 			Log::error("Failed to update the mesh at index %i", result.idx);
 		}
 
@@ -232,7 +857,9 @@ void RawVolumeRenderer::update() {
 			delete meshesT[result.idx];
 		}
 		meshesT[result.idx] = new voxel::Mesh(core::move(result.mesh.mesh[MeshType_Transparency]));
-		if (!updateBufferForVolume(result.idx, MeshType_Transparency)) {
+		// the order of the previous mesh doesn't belong to the new triangles
+		resultState._transparencySort.erase(result.mins);
+		if (!updateBufferForChunk(result.idx, MeshType_Transparency, result.mins) && !updateBufferForVolume(result.idx, MeshType_Transparency)) {
 			Log::error("Failed to update the mesh at index %i", result.idx);
 		}
 		++cnt;
@@ -240,218 +867,1528 @@ void RawVolumeRenderer::update() {
 	if (cnt > 0) {
 		Log::debug("Perform %i mesh updates in this frame", cnt);
 	}
+	if (dropped > 0) {
+		Log::debug("Dropped %i outdated mesh updates in this frame", dropped);
+	}
+}
+
+/**
+ * @brief Reserve some more space for each chunk to be able to update the chunk later without
+ * re-uploading the whole buffer
+ */
+static inline uint32_t chunkCapacity(size_t n) {
+	const uint32_t capacity = (uint32_t)(n + n / 4u + 48u);
+	// keep the triangles aligned
+	return capacity - capacity % 3u;
+}
+
+const voxel::Mesh *RawVolumeRenderer::chunkMesh(int idx, MeshType type, const glm::ivec3 &mins) const {
+	auto meshIter = _meshes[type].find(mins);
+	if (meshIter == _meshes[type].end()) {
+		return nullptr;
+	}
+	const voxel::Mesh *mesh = meshIter->second[idx];
+	if (type != MeshType_Opaque) {
+		return mesh;
+	}
+	const State& state = _state[idx];
+	auto lodIter = state._chunkLods.find(mins);
+	if (lodIter == state._chunkLods.end() || lodIter->second <= 0) {
+		return mesh;
+	}
+	const MeshesMap &lodMeshes = _lodMeshes[lodIter->second - 1];
+	auto lodMeshIter = lodMeshes.find(mins);
+	if (lodMeshIter == lodMeshes.end() || lodMeshIter->second[idx] == nullptr) {
+		return mesh;
+	}
+	return lodMeshIter->second[idx];
+}
+
+void RawVolumeRenderer::deleteChunkMeshes(int idx, const glm::ivec3 &mins) {
+	for (int i = 0; i < MeshType_Max; ++i) {
+		auto iter = _meshes[i].find(mins);
+		if (iter != _meshes[i].end()) {
+			delete iter->second[idx];
+			iter->second[idx] = nullptr;
+		}
+	}
+	for (int i = 0; i < MaxLODs - 1; ++i) {
+		auto iter = _lodMeshes[i].find(mins);
+		if (iter != _lodMeshes[i].end()) {
+			delete iter->second[idx];
+			iter->second[idx] = nullptr;
+		}
+	}
+	State& state = _state[idx];
+	state._chunkLods.erase(mins);
+	state._transparencySort.erase(mins);
+	if (state._chunkFaces.erase(mins) > 0u) {
+		for (int i = 0; i < MeshType_Max; ++i) {
+			updateFaceBufferForVolume(idx, (MeshType)i);
+		}
+	}
+}
+
+void RawVolumeRenderer::deleteVolumeMeshes(int idx) {
+	for (int i = 0; i < MeshType_Max; ++i) {
+		for (auto& iter : _meshes[i]) {
+			delete iter.second[idx];
+			iter.second[idx] = nullptr;
+		}
+		clearBuffer(idx, (MeshType)i);
+	}
+	for (int i = 0; i < MaxLODs - 1; ++i) {
+		for (auto& iter : _lodMeshes[i]) {
+			delete iter.second[idx];
+			iter.second[idx] = nullptr;
+		}
+	}
+	_state[idx]._chunkLods.clear();
+	_state[idx]._transparencySort.clear();
+}
+
+void RawVolumeRenderer::deleteVolumeFaces(int idx) {
+	State& state = _state[idx];
+	state._chunkFaces.clear();
+	for (int i = 0; i < MeshType_Max; ++i) {
+		state._faceRanges[i].clear();
+		if (state._faceBufferIndex[i] != -1) {
+			state._faceBuffer.update(state._faceBufferIndex[i], nullptr, 0);
+		}
+	}
+}
+
+void RawVolumeRenderer::clearBuffer(int idx, MeshType type) {
+	State& state = _state[idx];
+	state._vertexBuffer[type].update(state._vertexBufferIndex[type], nullptr, 0);
+	state._vertexBuffer[type].update(state._indexBufferIndex[type], nullptr, 0);
+	state._chunkRanges[type].clear();
+	_arena[type].dirty = true;
+	if (type == MeshType_Opaque) {
+		markShadowsDirty();
+	}
+}
+
+bool RawVolumeRenderer::updateBufferForChunk(int idx, MeshType type, const glm::ivec3 &mins, bool vertices) {
+	core_memory_scope(Render);
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return false;
+	}
+	State& state = _state[idx];
+	auto rangeIter = state._chunkRanges[type].find(mins);
+	if (rangeIter == state._chunkRanges[type].end()) {
+		return false;
+	}
+	const ChunkRange& range = rangeIter->second;
+	const voxel::Mesh* mesh = chunkMesh(idx, type, mins);
+	const size_t vertCount = mesh == nullptr ? 0u : mesh->getNoOfVertices();
+	const size_t indCount = mesh == nullptr ? 0u : mesh->getNoOfIndices();
+	if (vertCount > range.vertexCapacity || indCount > range.indexCapacity) {
+		return false;
+	}
+	core_trace_scoped(RawVolumeRendererUpdateChunk);
+
+	if (vertices && vertCount > 0u) {
+		const bool vertexSuccess = uploadBuffer(state._vertexBuffer[type], state._vertexBufferIndex[type],
+				range.vertexOffset * vertexSize(), vertCount * vertexSize(), false, [&] (uint8_t *dst) {
+			copyVertices(dst, mesh->getVertexVector(), _packedVertices);
+		});
+		if (!vertexSuccess) {
+			return false;
+		}
+	}
+
+	const size_t indexSize = state._indexSize[type];
+	const bool success = uploadBuffer(state._vertexBuffer[type], state._indexBufferIndex[type],
+			range.indexOffset * indexSize, range.indexCapacity * indexSize, false, [&] (uint8_t *dst) {
+		const voxel::IndexType* indices = indCount > 0u ? mesh->getRawIndexData() : nullptr;
+		copyIndices(dst, indexSize, indices, indCount, range.vertexOffset);
+		// degenerated triangles for the unused part of the range
+		core_memset(dst + indCount * indexSize, 0, (range.indexCapacity - indCount) * indexSize);
+	});
+	if (success) {
+		updateArenaForChunk(idx, type, range);
+		if (type == MeshType_Opaque) {
+			markShadowDirty(idx, mins);
+		}
+	}
+	return success;
+}
+
+void RawVolumeRenderer::sortTransparentChunks(const video::Camera &camera) {
+	core_trace_scoped(RawVolumeRendererSortTransparency);
+	const float minCos = glm::cos(glm::radians(glm::clamp(_sortAngle->floatVal(), 0.0f, 180.0f)));
+	const size_t budget = (size_t)glm::max(0, _sortBudget->intVal());
+	const float halfMeshSize = (float)_meshSize->intVal() * 0.5f;
+	glm::vec3 eyes[MAX_VOLUMES];
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const State &state = _state[idx];
+		if (state._hidden) {
+			continue;
+		}
+		// the vertices are in volume space - see the voxel shader
+		const glm::mat4 &model = glm::translate(state._model, -state._pivot);
+		eyes[idx] = glm::vec3(glm::inverse(model) * glm::vec4(camera.eye(), 1.0f));
+	}
+	size_t scheduled = 0u;
+	for (auto &i : _meshes[MeshType_Transparency]) {
+		const glm::ivec3 &mins = i.first;
+		for (int idx = 0; idx < (int)i.second.size(); ++idx) {
+			State &state = _state[idx];
+			const voxel::Mesh *mesh = i.second[idx];
+			if (state._hidden || mesh == nullptr || mesh->getNoOfIndices() < 6u) {
+				continue;
+			}
+			const glm::vec3 &eye = eyes[idx];
+			const glm::vec3 delta = glm::vec3(mins) + halfMeshSize - eye;
+			const float length = glm::length(delta);
+			const glm::vec3 direction = length > 0.0f ? delta / length : glm::vec3(0.0f);
+			TransparencySort &sort = state._transparencySort[mins];
+			if (sort.pending || (sort.sorted && glm::dot(direction, sort.direction) >= minCos)) {
+				continue;
+			}
+			const size_t triangles = mesh->getNoOfIndices() / 3u;
+			if (budget > 0u && scheduled > 0u && scheduled + triangles > budget) {
+				// picked up again in the next frames - the direction wasn't updated
+				continue;
+			}
+			scheduled += triangles;
+			if (sort.generation == 0u) {
+				sort.generation = ++_sortGeneration;
+			}
+			sort.direction = direction;
+			sort.sorted = true;
+			sort.pending = true;
+			const uint32_t generation = sort.generation;
+			_threadPool.enqueue([copy = *mesh, eye, mins, idx, generation, this] () mutable {
+				SortResult result;
+				result.mins = mins;
+				result.idx = idx;
+				result.generation = generation;
+				result.changed = copy.sort(eye);
+				if (result.changed) {
+					result.indices = core::move(copy.getIndexVector());
+				}
+				_sortQueue.push(core::move(result));
+			});
+		}
+	}
+}
+
+void RawVolumeRenderer::applySortResults() {
+	SortResult result;
+	while (_sortQueue.pop(result)) {
+		State &state = _state[result.idx];
+		auto sortIter = state._transparencySort.find(result.mins);
+		if (sortIter == state._transparencySort.end() || sortIter->second.generation != result.generation) {
+			// the mesh was replaced while it was sorted
+			continue;
+		}
+		sortIter->second.pending = false;
+		if (!result.changed) {
+			continue;
+		}
+		auto meshIter = _meshes[MeshType_Transparency].find(result.mins);
+		if (meshIter == _meshes[MeshType_Transparency].end()) {
+			continue;
+		}
+		voxel::Mesh *mesh = meshIter->second[result.idx];
+		if (mesh == nullptr || mesh->getNoOfIndices() != result.indices.size()) {
+			continue;
+		}
+		mesh->getIndexVector() = core::move(result.indices);
+		if (!updateBufferForChunk(result.idx, MeshType_Transparency, result.mins, false) &&
+			!updateBufferForVolume(result.idx, MeshType_Transparency)) {
+			Log::error("Failed to upload the sorted mesh at index %i", result.idx);
+		}
+	}
+}
+
+bool RawVolumeRenderer::updateBufferForVolume(int idx, MeshType type) {
+	core_memory_scope(Render);
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return false;
+	}
+	core_trace_scoped(RawVolumeRendererUpdate);
+
+	State& state = _state[idx];
+	ChunkRanges& ranges = state._chunkRanges[type];
+	ranges.clear();
+	// the size of the volume buffers changes - the offsets of all volumes in the arena are invalid
+	_arena[type].dirty = true;
+	if (type == MeshType_Opaque) {
+		markShadowsDirty();
+	}
+
+	size_t vertCount = 0u;
+	size_t indCount = 0u;
+	for (auto& i : _meshes[type]) {
+		const Meshes& meshes = i.second;
+		const voxel::Mesh* mesh = meshes[idx];
+		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
+			continue;
+		}
+		// reserve enough space for every detail level to switch between them with chunk updates
+		size_t maxVertices = mesh->getNoOfVertices();
+		size_t maxIndices = mesh->getNoOfIndices();
+		if (type == MeshType_Opaque) {
+			for (int lod = 0; lod < MaxLODs - 1; ++lod) {
+				auto lodIter = _lodMeshes[lod].find(i.first);
+				if (lodIter == _lodMeshes[lod].end() || lodIter->second[idx] == nullptr) {
+					continue;
+				}
+				maxVertices = core_max(maxVertices, lodIter->second[idx]->getNoOfVertices());
+				maxIndices = core_max(maxIndices, lodIter->second[idx]->getNoOfIndices());
+			}
+		}
+		ChunkRange range;
+		range.vertexOffset = (uint32_t)vertCount;
+		range.vertexCapacity = chunkCapacity(maxVertices);
+		range.indexOffset = (uint32_t)indCount;
+		range.indexCapacity = chunkCapacity(maxIndices);
+		vertCount += range.vertexCapacity;
+		indCount += range.indexCapacity;
+		ranges.insert(std::make_pair(i.first, range));
+	}
+
+	if (indCount == 0u || vertCount == 0u) {
+		clearBuffer(idx, type);
+		return true;
+	}
+
+	// the vertices are copied out of the stream buffer before the indices are written - see StreamBuffer::allocate()
+	const bool vertexSuccess = uploadBuffer(state._vertexBuffer[type], state._vertexBufferIndex[type], 0u,
+			vertCount * vertexSize(), true, [&] (uint8_t *dst) {
+		core_memset(dst, 0, vertCount * vertexSize());
+		for (auto& i : _meshes[type]) {
+			const Meshes& meshes = i.second;
+			if (meshes[idx] == nullptr || meshes[idx]->getNoOfIndices() <= 0) {
+				continue;
+			}
+			const voxel::Mesh* mesh = chunkMesh(idx, type, i.first);
+			copyVertices(dst + ranges[i.first].vertexOffset * vertexSize(), mesh->getVertexVector(), _packedVertices);
+		}
+	});
+	if (!vertexSuccess) {
+		Log::error("Failed to update the vertex buffer");
+		ranges.clear();
+		return false;
+	}
+
+	// the chunk indices are moved by the vertex offsets of the chunk ranges - the highest index is below vertCount
+	const size_t indexSize = indexSizeFor(vertCount);
+	state._indexSize[type] = (uint32_t)indexSize;
+	const bool indexSuccess = uploadBuffer(state._vertexBuffer[type], state._indexBufferIndex[type], 0u,
+			indCount * indexSize, true, [&] (uint8_t *dst) {
+		// the unused parts of the chunk ranges are degenerated triangles
+		core_memset(dst, 0, indCount * indexSize);
+		for (auto& i : _meshes[type]) {
+			const Meshes& meshes = i.second;
+			if (meshes[idx] == nullptr || meshes[idx]->getNoOfIndices() <= 0) {
+				continue;
+			}
+			const voxel::Mesh* mesh = chunkMesh(idx, type, i.first);
+			const ChunkRange& range = ranges[i.first];
+			copyIndices(dst + range.indexOffset * indexSize, indexSize, mesh->getRawIndexData(),
+					mesh->getNoOfIndices(), range.vertexOffset);
+		}
+	});
+	if (!indexSuccess) {
+		Log::error("Failed to update the index buffer");
+		ranges.clear();
+		return false;
+	}
+	return true;
+}
+
+void RawVolumeRenderer::setAmbientColor(const glm::vec3& color) {
+	_voxelShaderFragData.ambientColor = color;
+}
+
+void RawVolumeRenderer::setDiffuseColor(const glm::vec3& color) {
+	_voxelShaderFragData.diffuseColor = color;
+}
+
+bool RawVolumeRenderer::empty(int idx) const {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return true;
+	}
+	for (int i = 0; i < MeshType_Max; ++i) {
+		for (auto& i : _meshes[i]) {
+			const Meshes& meshes = i.second;
+			if (meshes[idx] != nullptr && meshes[idx]->getNoOfIndices() > 0) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+voxel::Region RawVolumeRenderer::calculateExtractRegion(int x, int y, int z, const glm::ivec3& meshSize) const {
+	const glm::ivec3 mins(x * meshSize.x, y * meshSize.y, z * meshSize.z);
+	const glm::ivec3 maxs = mins + meshSize - 1;
+	return voxel::Region{mins, maxs};
+}
+
+bool RawVolumeRenderer::extractRegion(int idx, const voxel::Region& region) {
+	core_trace_scoped(RawVolumeRendererExtract);
+	voxel::RawVolume* v = volume(idx);
+	if (v == nullptr) {
+		return false;
+	}
+
+	if (_rayMarchingActive) {
+		// the modified bricks are encoded right away - there are no meshes to extract
+		_brickMapRenderer.update(idx, *v, region);
+		return true;
+	}
+
+	const int s = _meshSize->intVal();
+	const glm::ivec3 meshSize(s);
+	const glm::ivec3 meshSizeMinusOne(s - 1);
+	const voxel::Region& completeRegion = v->region();
+
+	// convert to step coordinates that are needed to extract
+	// the given region mesh size ranges
+	// the boundaries are special - that's why we take care of this with
+	// the offset of 1 - see the cubic surface extractor docs
+	const glm::ivec3& l = (region.getLowerCorner() - meshSizeMinusOne) / meshSize;
+	const glm::ivec3& u = (region.getUpperCorner() + 1) / meshSize;
+
+	Log::debug("modified region: %s", region.toString().c_str());
+	for (int x = l.x; x <= u.x; ++x) {
+		for (int y = l.y; y <= u.y; ++y) {
+			for (int z = l.z; z <= u.z; ++z) {
+				const voxel::Region& finalRegion = calculateExtractRegion(x, y, z, meshSize);
+				const glm::ivec3& mins = finalRegion.getLowerCorner();
+
+				if (!voxel::intersects(completeRegion, finalRegion)) {
+					for (int i = 0; i < MeshType_Max; ++i) {
+						if (_meshes[i].find(mins) != _meshes[i].end()) {
+							clearBuffer(idx, (MeshType)i);
+						}
+					}
+					deleteChunkMeshes(idx, mins);
+					// don't let a running extraction bring the chunk back
+					_state[idx]._chunkVersions[mins] = _chunkVersion + 1u;
+					continue;
+				}
+
+				Log::debug("extract region: %s", finalRegion.toString().c_str());
+				_extractRegions.emplace_back(finalRegion, idx);
+				_extractRegionsSorted = false;
+			}
+		}
+	}
+	return true;
+}
+
+void RawVolumeRenderer::invalidateChunks(int idx) {
+	State &state = _state[idx];
+	state._minChunkVersion = _chunkVersion + 1u;
+	state._chunkVersions.clear();
+}
+
+void RawVolumeRenderer::waitForPendingExtractions() {
+	while (_runningExtractorTasks > 0) {
+		SDL_Delay(1);
+	}
+}
+
+void RawVolumeRenderer::clearPendingExtractions() {
+	Log::debug("Clear pending extractions");
+	_threadPool.abort();
+	while (_runningExtractorTasks > 0) {
+		SDL_Delay(1);
+	}
+	_pendingQueue.clear();
+}
+
+bool RawVolumeRenderer::hidden(int idx) const {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return true;
+	}
+	return _state[idx]._hidden;
+}
+
+void RawVolumeRenderer::hide(int idx, bool hide) {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return;
+	}
+	_state[idx]._hidden = hide;
+}
+
+bool RawVolumeRenderer::grayed(int idx) const {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return true;
+	}
+	return _state[idx]._gray;
+}
+
+void RawVolumeRenderer::gray(int idx, bool gray) {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return;
+	}
+	_state[idx]._gray = gray;
+}
+
+void RawVolumeRenderer::setPickable(int idx, bool pickable) {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return;
+	}
+	_state[idx]._pickable = pickable;
+}
+
+const voxel::Palette &RawVolumeRenderer::volumePalette(int idx) const {
+	const State& state = _state[idx]._reference != -1 ? _state[_state[idx]._reference] : _state[idx];
+	if (state._palette.hasValue()) {
+		return *state._palette.value();
+	}
+	return voxel::getPalette();
+}
+
+void RawVolumeRenderer::updatePalette(int idx) {
+	const voxel::Palette *palette = &volumePalette(idx);
+
+	if (palette->hash() != _paletteHash) {
+		_paletteHash = palette->hash();
+		core::DynamicArray<glm::vec4> materialColors;
+		palette->toVec4f(materialColors);
+		core::DynamicArray<glm::vec4> glowColors;
+		palette->glowToVec4f(glowColors);
+		for (int i = 0; i < voxel::PaletteMaxColors; ++i) {
+			_voxelShaderVertData.materialcolor[i] = materialColors[i];
+			_voxelShaderVertData.glowcolor[i] = glowColors[i];
+		}
+	}
+}
+
+math::Frustum RawVolumeRenderer::volumeFrustum(int idx, const glm::mat4 &viewProjection) const {
+	const State& state = _state[idx];
+	// the vertices are in volume space - see the voxel shader
+	const glm::mat4 &model = glm::translate(state._model, -state._pivot);
+	math::Frustum frustum;
+	frustum.updatePlanes(model, viewProjection);
+	return frustum;
+}
+
+bool RawVolumeRenderer::isChunkVisible(const math::Frustum &frustum, const glm::ivec3 &mins) const {
+	// the marching cubes and the downsampled meshes might slightly exceed the chunk region
+	const glm::vec3 chunkMins = glm::vec3(mins) - 1.0f;
+	const glm::vec3 chunkMaxs = glm::vec3(mins + _meshSize->intVal()) + 1.0f;
+	return frustum.isVisible(chunkMins, chunkMaxs);
+}
+
+void RawVolumeRenderer::markShadowDirty(int idx, const glm::ivec3 &mins) {
+	if (_shadowChunks.size() >= MaxShadowChunks) {
+		// too many changes to test them one by one
+		markShadowsDirty();
+		return;
+	}
+	++_shadowRevision;
+	_shadowChunks.push_back(ShadowChunk{_shadowRevision, idx, mins});
+}
+
+void RawVolumeRenderer::markShadowsDirty() {
+	++_shadowRevision;
+	_shadowFullRevision = _shadowRevision;
+	_shadowChunks.clear();
+}
+
+uint64_t RawVolumeRenderer::shadowStateHash() const {
+	core::Hash64 hash;
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const State &state = _state[idx];
+		if (state._rawVolume == nullptr && state._reference == -1) {
+			continue;
+		}
+		hash.update(&idx, sizeof(idx));
+		hash.update(glm::value_ptr(state._model), sizeof(state._model));
+		hash.update(glm::value_ptr(state._pivot), sizeof(state._pivot));
+		hash.update(&state._hidden, sizeof(state._hidden));
+		hash.update(&state._reference, sizeof(state._reference));
+	}
+	return hash.digest();
+}
+
+void RawVolumeRenderer::updateShadowDirty(RenderContext &renderContext) {
+	Shadow &shadow = renderContext.shadow;
+	if (_hasLightView && shadow.lightView() != _lightView) {
+		shadow.setLightViewMatrix(_lightView);
+	}
+	const uint64_t stateHash = shadowStateHash();
+	if (renderContext.shadowStateHash != stateHash || renderContext.shadowRevision < _shadowFullRevision) {
+		renderContext.shadowStateHash = stateHash;
+		renderContext.shadowRevision = _shadowRevision;
+		shadow.markDirty();
+		return;
+	}
+	const int cascades = shadow.parameters().maxDepthBuffers;
+	for (const ShadowChunk &chunk : _shadowChunks) {
+		if (chunk.revision <= renderContext.shadowRevision) {
+			continue;
+		}
+		for (int i = 0; i < cascades; ++i) {
+			if (shadow.dirty(i)) {
+				continue;
+			}
+			const glm::mat4 &lightViewProjection = shadow.cascades()[i];
+			for (int instance = 0; instance < MAX_VOLUMES; ++instance) {
+				if (instance != chunk.idx && _state[instance]._reference != chunk.idx) {
+					continue;
+				}
+				if (isChunkVisible(volumeFrustum(instance, lightViewProjection), chunk.mins)) {
+					shadow.markDirty(i);
+					break;
+				}
+			}
+		}
+	}
+	renderContext.shadowRevision = _shadowRevision;
+}
+
+static inline void drawChunkRange(uint32_t indexOffset, uint32_t indices, size_t indexSize) {
+	video::drawElements(video::Primitive::Triangles, indices, indexSize, (void *)(intptr_t)(indexOffset * indexSize));
+}
+
+int RawVolumeRenderer::drawChunks(int idx, MeshType type, const math::Frustum &frustum, bool occlusionQueries) {
+	State& instance = _state[idx];
+	const State& state = instance._reference != -1 ? _state[instance._reference] : instance;
+	const size_t indexSize = state._indexSize[type];
+	_visibleRanges.clear();
+	int drawn = 0;
+	for (const auto &entry : state._chunkRanges[type]) {
+		if (!isChunkVisible(frustum, entry.first)) {
+			continue;
+		}
+		if (!occlusionQueries) {
+			_visibleRanges.push_back(entry.second);
+			continue;
+		}
+		ChunkOcclusion &occlusion = instance._occlusion[entry.first];
+		if (occlusion.pending) {
+			const int samples = video::occlusionQueryResult(occlusion.query);
+			if (samples >= 0) {
+				occlusion.visible = samples > 0;
+				occlusion.pending = false;
+			}
+		}
+		if (!occlusion.visible) {
+			if (!occlusion.pending) {
+				_occlusionProxies.emplace_back(idx, entry.first);
+			}
+			continue;
+		}
+		if (occlusion.query == video::InvalidId) {
+			occlusion.query = video::genOcclusionQuery();
+		}
+		if (!occlusion.pending && video::beginOcclusionQuery(occlusion.query)) {
+			drawChunkRange(entry.second.indexOffset, entry.second.indexCapacity, indexSize);
+			video::endOcclusionQuery(occlusion.query);
+			occlusion.pending = true;
+		} else {
+			drawChunkRange(entry.second.indexOffset, entry.second.indexCapacity, indexSize);
+		}
+		++drawn;
+	}
+	if (_visibleRanges.empty()) {
+		return drawn;
+	}
+
+	// merge the ranges that are next to each other in the index buffer
+	_visibleRanges.sort([] (const ChunkRange &lhs, const ChunkRange &rhs) {
+		return lhs.indexOffset > rhs.indexOffset;
+	});
+	uint32_t offset = _visibleRanges[0].indexOffset;
+	uint32_t indices = _visibleRanges[0].indexCapacity;
+	for (size_t i = 1; i < _visibleRanges.size(); ++i) {
+		const ChunkRange &range = _visibleRanges[i];
+		if (offset + indices == range.indexOffset) {
+			indices += range.indexCapacity;
+			continue;
+		}
+		drawChunkRange(offset, indices, indexSize);
+		offset = range.indexOffset;
+		indices = range.indexCapacity;
+	}
+	drawChunkRange(offset, indices, indexSize);
+	return drawn + (int)_visibleRanges.size();
+}
+
+void RawVolumeRenderer::updateVoxelShaderVertData(int idx, const video::Camera &camera) {
+	updatePalette(idx);
+	_voxelShaderVertData.viewprojection = camera.viewProjectionMatrix();
+	_voxelShaderVertData.model = _state[idx]._model;
+	_voxelShaderVertData.pivot = _state[idx]._pivot;
+	_voxelShaderVertData.gray = _state[idx]._gray;
+	core_assert_always(_voxelData.update(_voxelShaderVertData));
+	core_assert_always(_voxelShader.setFrag(_voxelData.getFragUniformBuffer()));
+	core_assert_always(_voxelShader.setVert(_voxelData.getVertUniformBuffer()));
+	if (_shadowMap->boolVal()) {
+		_voxelShader.setShadowmap(video::TextureUnit::One);
+	}
+}
+
+void RawVolumeRenderer::renderOcclusionProxies(const video::Camera &camera) {
+	if (_occlusionProxies.empty()) {
+		return;
+	}
+	core_trace_scoped(RawVolumeRendererOcclusionProxies);
+
+	// the bounding boxes of all proxies are uploaded at once - the box of a chunk is slightly larger than the chunk
+	// region like in isChunkVisible()
+	static const uint32_t boxIndices[36] = {0, 1, 3, 0, 3, 2, 4, 6, 7, 4, 7, 5, 0, 4, 5, 0, 5, 1,
+											2, 3, 7, 2, 7, 6, 0, 2, 6, 0, 6, 4, 1, 5, 7, 1, 7, 3};
+	const int meshSize = _meshSize->intVal();
+	_occlusionBoxVertices.clear();
+	_occlusionBoxIndices.clear();
+	_occlusionBoxVertices.reserve(_occlusionProxies.size() * 8);
+	_occlusionBoxIndices.reserve(_occlusionProxies.size() * lengthof(boxIndices));
+	for (const OcclusionProxy &proxy : _occlusionProxies) {
+		const glm::vec3 mins = glm::vec3(proxy.mins) - 1.0f;
+		const glm::vec3 maxs = glm::vec3(proxy.mins + meshSize) + 1.0f;
+		const uint32_t base = (uint32_t)_occlusionBoxVertices.size();
+		for (int corner = 0; corner < 8; ++corner) {
+			voxel::VoxelVertex vertex;
+			vertex.position.x = (corner & 4) ? maxs.x : mins.x;
+			vertex.position.y = (corner & 2) ? maxs.y : mins.y;
+			vertex.position.z = (corner & 1) ? maxs.z : mins.z;
+			vertex.info = 0;
+			vertex.colorIndex = 0;
+			_occlusionBoxVertices.push_back(vertex);
+		}
+		for (uint32_t index : boxIndices) {
+			_occlusionBoxIndices.push_back(base + index);
+		}
+	}
+	_occlusionBoxBuffer.update(_occlusionBoxVertexIndex, _occlusionBoxVertices.data(),
+							   _occlusionBoxVertices.size() * sizeof(voxel::VoxelVertex));
+	_occlusionBoxBuffer.update(_occlusionBoxIndexIndex, _occlusionBoxIndices.data(),
+							   _occlusionBoxIndices.size() * sizeof(uint32_t));
+
+	video::colorMask(false, false, false, false);
+	video::ScopedState scopedDepthMask(video::State::DepthMask, false);
+	// the camera might be inside of a box
+	video::ScopedState scopedCullFace(video::State::CullFace, false);
+	video::ScopedBuffer scopedBuf(_occlusionBoxBuffer);
+	size_t i = 0;
+	while (i < _occlusionProxies.size()) {
+		const int idx = _occlusionProxies[i].idx;
+		State& instance = _state[idx];
+		updateVoxelShaderVertData(idx, camera);
+		// the proxies are collected volume by volume
+		for (; i < _occlusionProxies.size() && _occlusionProxies[i].idx == idx; ++i) {
+			ChunkOcclusion &occlusion = instance._occlusion[_occlusionProxies[i].mins];
+			if (occlusion.query == video::InvalidId) {
+				occlusion.query = video::genOcclusionQuery();
+			}
+			if (!video::beginOcclusionQuery(occlusion.query)) {
+				// without query support the chunks are always visible
+				occlusion.visible = true;
+				continue;
+			}
+			drawChunkRange((uint32_t)(i * lengthof(boxIndices)), (uint32_t)lengthof(boxIndices), sizeof(uint32_t));
+			video::endOcclusionQuery(occlusion.query);
+			occlusion.pending = true;
+		}
+	}
+	video::colorMask(true, true, true, true);
+	_occlusionProxies.clear();
+}
+
+void RawVolumeRenderer::resetOcclusion() {
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		State& state = _state[idx];
+		for (auto &entry : state._occlusion) {
+			video::deleteOcclusionQuery(entry.second.query);
+		}
+		state._occlusion.clear();
+	}
+	_occlusionProxies.clear();
+}
+
+void RawVolumeRenderer::updateInstances() {
+	core_trace_scoped(RawVolumeRendererUpdateInstances);
+	// counting sort of the instances by the volume they render
+	_instanceOffsets.fill(0);
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const int owner = _state[idx]._reference != -1 ? _state[idx]._reference : idx;
+		const State& state = _state[owner];
+		if (state._hidden || !state.hasData()) {
+			continue;
+		}
+		++_instanceOffsets[owner + 1];
+	}
+	for (int i = 0; i < MAX_VOLUMES; ++i) {
+		_instanceOffsets[i + 1] += _instanceOffsets[i];
+	}
+	core::Array<int, MAX_VOLUMES> cursor;
+	for (int i = 0; i < MAX_VOLUMES; ++i) {
+		cursor[i] = _instanceOffsets[i];
+	}
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const int owner = _state[idx]._reference != -1 ? _state[idx]._reference : idx;
+		const State& state = _state[owner];
+		if (state._hidden || !state.hasData()) {
+			continue;
+		}
+		_instances[cursor[owner]++] = idx;
+	}
+}
+
+bool RawVolumeRenderer::isInstanced(int idx) const {
+	if (!_instancing) {
+		return false;
+	}
+	const int owner = _state[idx]._reference != -1 ? _state[idx]._reference : idx;
+	return _instanceOffsets[owner + 1] - _instanceOffsets[owner] > 1;
+}
+
+void RawVolumeRenderer::renderInstances(MeshType type, const video::Camera &camera, video::PolygonMode mode) {
+	if (!_instancing) {
+		return;
+	}
+	core_trace_scoped(RawVolumeRendererInstances);
+	const int maxInstances = shader::VoxelinstancedShaderConstants::getMaxInstances();
+	const int instanceDataSize = shader::VoxelinstancedShaderConstants::getInstanceDataSize();
+	static_assert(lengthof(_voxelInstancedInstancesData.instancedata) ==
+					  shader::VoxelinstancedShaderConstants::getMaxInstances() *
+						  shader::VoxelinstancedShaderConstants::getInstanceDataSize(),
+				  "Unexpected instance data size");
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	video::ScopedShader scoped(_voxelInstancedShader);
+	bool shaderSetup = false;
+	for (int owner = 0; owner < MAX_VOLUMES; ++owner) {
+		const int begin = _instanceOffsets[owner];
+		const int end = _instanceOffsets[owner + 1];
+		if (end - begin <= 1) {
+			continue;
+		}
+		const State& state = _state[owner];
+		const uint32_t indices = state.indices(type);
+		if (indices == 0u) {
+			continue;
+		}
+		if (!shaderSetup) {
+			// the fragment shader is shared with the voxel shader
+			core_assert_always(_voxelInstancedShader.setFrag(_voxelData.getFragUniformBuffer()));
+			core_assert_always(_voxelInstancedShader.setVert(_voxelInstancedData.getVertUniformBuffer()));
+			core_assert_always(_voxelInstancedShader.setInstances(_voxelInstancedData.getInstancesUniformBuffer()));
+			if (_shadowMap->boolVal()) {
+				_voxelInstancedShader.setShadowmap(video::TextureUnit::One);
+			}
+			shaderSetup = true;
+		}
+		updatePalette(owner);
+		core_memcpy(_voxelInstancedVertData.materialcolor, _voxelShaderVertData.materialcolor, sizeof(_voxelInstancedVertData.materialcolor));
+		core_memcpy(_voxelInstancedVertData.glowcolor, _voxelShaderVertData.glowcolor, sizeof(_voxelInstancedVertData.glowcolor));
+		_voxelInstancedVertData.viewprojection = viewProjection;
+		core_assert_always(_voxelInstancedData.update(_voxelInstancedVertData));
+
+		// the marching cubes and the downsampled meshes might slightly exceed the volume region
+		glm::vec3 mins(-1.0f);
+		glm::vec3 maxs(1.0f);
+		if (state._rawVolume != nullptr) {
+			const voxel::Region &region = state._rawVolume->region();
+			mins += glm::vec3(region.getLowerCorner());
+			maxs += glm::vec3(region.getUpperCorner() + 1);
+		}
+
+		video::ScopedPolygonMode polygonMode(mode);
+		video::ScopedBuffer scopedBuf(state._vertexBuffer[type]);
+		int n = 0;
+		for (int i = begin; i < end; ++i) {
+			const int idx = _instances[i];
+			const State& instance = _state[idx];
+			if (state._rawVolume != nullptr && !volumeFrustum(idx, viewProjection).isVisible(mins, maxs)) {
+				continue;
+			}
+			glm::vec4 *data = &_voxelInstancedInstancesData.instancedata[n * instanceDataSize];
+			for (int c = 0; c < 4; ++c) {
+				data[c] = instance._model[c];
+			}
+			data[4] = glm::vec4(instance._pivot, instance._gray ? 1.0f : 0.0f);
+			if (++n < maxInstances && i + 1 < end) {
+				continue;
+			}
+			core_assert_always(_voxelInstancedData.update(_voxelInstancedInstancesData));
+			video::drawElementsInstanced(video::Primitive::Triangles, indices, state._indexSize[type], n);
+			n = 0;
+		}
+		if (n > 0) {
+			core_assert_always(_voxelInstancedData.update(_voxelInstancedInstancesData));
+			video::drawElementsInstanced(video::Primitive::Triangles, indices, state._indexSize[type], n);
+		}
+	}
+}
+
+bool RawVolumeRenderer::useMultiDrawIndirect() const {
+	return _multiDrawIndirectSupported && _multiDrawIndirect->boolVal();
+}
+
+size_t RawVolumeRenderer::indexSizeFor(size_t vertices) const {
+	if (useMultiDrawIndirect() || vertices > (size_t)UINT16_MAX) {
+		return sizeof(voxel::IndexType);
+	}
+	return sizeof(uint16_t);
+}
+
+bool RawVolumeRenderer::rebuildArena(MeshType type) {
+	core_trace_scoped(RawVolumeRendererRebuildArena);
+	Arena &arena = _arena[type];
+	size_t vertexBytes = 0u;
+	size_t indexSize = 0u;
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		State& state = _state[idx];
+		state._arenaVertexOffset[type] = (uint32_t)(vertexBytes / vertexSize());
+		state._arenaIndexOffset[type] = (uint32_t)(indexSize / sizeof(voxel::IndexType));
+		vertexBytes += state._vertexBuffer[type].size(state._vertexBufferIndex[type]);
+		indexSize += state._vertexBuffer[type].size(state._indexBufferIndex[type]);
+	}
+	if (!arena.buffer.reserve(arena.vertexIndex, vertexBytes) || !arena.buffer.reserve(arena.indexIndex, indexSize)) {
+		Log::error("Failed to allocate the arena buffers");
+		return false;
+	}
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const State& state = _state[idx];
+		core_assert_msg(state._indexSize[type] == sizeof(voxel::IndexType) || state.indices(type) == 0u,
+				"The arena needs the same index type for all volumes");
+		const video::Buffer &source = state._vertexBuffer[type];
+		if (!arena.buffer.copyRange(arena.vertexIndex, state._arenaVertexOffset[type] * vertexSize(),
+				source, state._vertexBufferIndex[type], 0u, source.size(state._vertexBufferIndex[type]))) {
+			Log::error("Failed to copy the vertices of volume %i into the arena", idx);
+			return false;
+		}
+		if (!arena.buffer.copyRange(arena.indexIndex, state._arenaIndexOffset[type] * sizeof(voxel::IndexType),
+				source, state._indexBufferIndex[type], 0u, source.size(state._indexBufferIndex[type]))) {
+			Log::error("Failed to copy the indices of volume %i into the arena", idx);
+			return false;
+		}
+	}
+	arena.dirty = false;
+	return true;
+}
+
+void RawVolumeRenderer::updateArenaForChunk(int idx, MeshType type, const ChunkRange &range) {
+	core_memory_scope(Render);
+	Arena &arena = _arena[type];
+	if (arena.dirty) {
+		return;
+	}
+	if (!useMultiDrawIndirect()) {
+		// don't keep the arena in sync if it isn't used
+		arena.dirty = true;
+		return;
+	}
+	const State& state = _state[idx];
+	const video::Buffer &source = state._vertexBuffer[type];
+	const size_t vertexOffset = (state._arenaVertexOffset[type] + range.vertexOffset) * vertexSize();
+	const size_t indexOffset = (state._arenaIndexOffset[type] + range.indexOffset) * sizeof(voxel::IndexType);
+	if (!arena.buffer.copyRange(arena.vertexIndex, vertexOffset, source, state._vertexBufferIndex[type],
+			range.vertexOffset * vertexSize(), range.vertexCapacity * vertexSize())) {
+		arena.dirty = true;
+		return;
+	}
+	if (!arena.buffer.copyRange(arena.indexIndex, indexOffset, source, state._indexBufferIndex[type],
+			range.indexOffset * sizeof(voxel::IndexType), range.indexCapacity * sizeof(voxel::IndexType))) {
+		arena.dirty = true;
+	}
+}
+
+int RawVolumeRenderer::drawPaletteSlot(uint64_t hash) const {
+	for (size_t slot = 0u; slot < _paletteSlotHashes.size(); ++slot) {
+		if (_paletteSlotHashes[slot] == hash) {
+			return (int)slot;
+		}
+	}
+	return -1;
+}
+
+void RawVolumeRenderer::updateDrawPalettes() {
+	core_trace_scoped(RawVolumeRendererUpdateDrawPalettes);
+	_drawPalettes.clear();
+	_drawPalettes.resize(_paletteSlotHashes.size());
+	// the palettes that are not yet in any slot - many volumes usually share the same palette
+	core::DynamicArray<const voxel::Palette *> added;
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const State& instance = _state[idx];
+		const State& state = instance._reference != -1 ? _state[instance._reference] : instance;
+		if (state._hidden || !state.hasData()) {
+			continue;
+		}
+		const voxel::Palette &palette = volumePalette(idx);
+		const int slot = drawPaletteSlot(palette.hash());
+		if (slot != -1) {
+			_drawPalettes[slot] = &palette;
+			continue;
+		}
+		bool known = false;
+		for (const voxel::Palette *p : added) {
+			if (p->hash() == palette.hash()) {
+				known = true;
+				break;
+			}
+		}
+		if (!known) {
+			added.push_back(&palette);
+		}
+	}
+	if (added.empty()) {
+		return;
+	}
+
+	const size_t paletteSize = 2u * voxel::PaletteMaxColors;
+	const size_t uploadedSlots = _paletteSlotHashes.size();
+	core::DynamicArray<glm::vec4> colors;
+	colors.reserve(paletteSize);
+	bool grown = false;
+	for (const voxel::Palette *palette : added) {
+		// reuse the slot of a palette that is no longer visible - e.g. the palette before the last edit
+		size_t slot = 0u;
+		for (; slot < _drawPalettes.size(); ++slot) {
+			if (_drawPalettes[slot] == nullptr) {
+				break;
+			}
+		}
+		if (slot == _drawPalettes.size()) {
+			_drawPalettes.push_back(nullptr);
+			_paletteSlotHashes.push_back(0u);
+			_paletteData.resize(_paletteSlotHashes.size() * paletteSize);
+		}
+		_drawPalettes[slot] = palette;
+		_paletteSlotHashes[slot] = palette->hash();
+		colors.clear();
+		palette->toVec4f(colors);
+		palette->glowToVec4f(colors);
+		core_memcpy(&_paletteData[slot * paletteSize], colors.data(), paletteSize * sizeof(glm::vec4));
+		if (slot >= uploadedSlots) {
+			grown = true;
+		} else {
+			core_assert_always(_drawDataBuffer.updateRange(_paletteDataIndex, slot * paletteSize * sizeof(glm::vec4),
+														   colors.data(), paletteSize * sizeof(glm::vec4)));
+		}
+	}
+	if (grown) {
+		core_assert_always(_drawDataBuffer.update(_paletteDataIndex, _paletteData.data(), _paletteData.size() * sizeof(glm::vec4)));
+	}
+}
+
+int RawVolumeRenderer::updateDrawData() {
+	core_trace_scoped(RawVolumeRendererUpdateDrawData);
+	updateDrawPalettes();
+	_drawData.clear();
+	int drawSlots = 0;
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		State& instance = _state[idx];
+		instance._drawSlot = -1;
+		const State& state = instance._reference != -1 ? _state[instance._reference] : instance;
+		if (state._hidden || !state.hasData()) {
+			continue;
+		}
+		const int paletteSlot = drawPaletteSlot(volumePalette(idx).hash());
+		core_assert(paletteSlot != -1);
+		instance._drawSlot = drawSlots++;
+		// see DRAWDATASIZE in the voxelindirect shader
+		for (int i = 0; i < 4; ++i) {
+			_drawData.push_back(instance._model[i]);
+		}
+		_drawData.emplace_back(instance._pivot, 0.0f);
+		const float paletteOffset = (float)(paletteSlot * 2 * voxel::PaletteMaxColors);
+		_drawData.emplace_back(paletteOffset, instance._gray ? 1.0f : 0.0f, 0.0f, 0.0f);
+	}
+	if (drawSlots == 0) {
+		return 0;
+	}
+	static_assert(shader::VoxelindirectShaderConstants::getDrawDataSize() == 6, "Unexpected draw data size");
+	core_assert_always(_drawDataBuffer.update(_drawDataIndex, _drawData.data(), _drawData.size() * sizeof(glm::vec4)));
+	return drawSlots;
+}
+
+void RawVolumeRenderer::drawArena(MeshType type, const glm::mat4 &viewProjection) {
+	Arena &arena = _arena[type];
+	if (arena.dirty && !rebuildArena(type)) {
+		return;
+	}
+	_drawCommands.clear();
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const State& instance = _state[idx];
+		if (instance._drawSlot == -1) {
+			continue;
+		}
+		const State& state = instance._reference != -1 ? _state[instance._reference] : instance;
+		if (state.indices(type) == 0u) {
+			continue;
+		}
+		const math::Frustum &frustum = volumeFrustum(idx, viewProjection);
+		for (const auto &entry : state._chunkRanges[type]) {
+			if (!isChunkVisible(frustum, entry.first)) {
+				continue;
+			}
+			video::DrawElementsIndirectCommand command;
+			command.count = entry.second.indexCapacity;
+			command.instanceCount = 1u;
+			command.firstIndex = state._arenaIndexOffset[type] + entry.second.indexOffset;
+			command.baseVertex = (int32_t)state._arenaVertexOffset[type];
+			command.baseInstance = (uint32_t)instance._drawSlot;
+			_drawCommands.push_back(command);
+		}
+	}
+	if (_drawCommands.empty()) {
+		return;
+	}
+	if (!arena.buffer.update(arena.commandIndex, _drawCommands.data(), _drawCommands.size() * sizeof(video::DrawElementsIndirectCommand))) {
+		Log::error("Failed to upload the draw commands");
+		return;
+	}
+	video::ScopedBuffer scopedBuf(arena.buffer);
+	video::bindBuffer(video::BufferType::IndirectBuffer, arena.buffer.bufferHandle(arena.commandIndex));
+	video::multiDrawElementsIndirect<voxel::IndexType>(video::Primitive::Triangles, (int)_drawCommands.size());
+}
+
+void RawVolumeRenderer::renderMultiDrawIndirect(const video::Camera &camera, video::PolygonMode mode) {
+	core_trace_scoped(RawVolumeRendererMultiDrawIndirect);
+	if (updateDrawData() == 0) {
+		return;
+	}
+	video::ScopedShader scoped(_voxelIndirectShader);
+	_voxelIndirectVertData.viewprojection = camera.viewProjectionMatrix();
+	core_assert_always(_voxelIndirectData.update(_voxelIndirectVertData));
+	core_assert_always(_voxelIndirectShader.setVert(_voxelIndirectData.getVertUniformBuffer()));
+	// the fragment shader is shared with the voxel shader
+	core_assert_always(_voxelIndirectShader.setFrag(_voxelData.getFragUniformBuffer()));
+	if (_shadowMap->boolVal()) {
+		_voxelIndirectShader.setShadowmap(video::TextureUnit::One);
+	}
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, _drawDataBuffer.bufferHandle(_drawDataIndex),
+						  _voxelIndirectShader.getBindingDrawdata());
+	video::bindBufferBase(video::BufferType::ShaderStorageBuffer, _drawDataBuffer.bufferHandle(_paletteDataIndex),
+						  _voxelIndirectShader.getBindingPalettedata());
+
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	video::ScopedPolygonMode polygonMode(mode);
+	drawArena(MeshType_Opaque, viewProjection);
+	video::ScopedState scopedBlend(video::State::Blend, true);
+	drawArena(MeshType_Transparency, viewProjection);
+}
+
+bool RawVolumeRenderer::useSmoothMesh() const {
+	return _meshMode->intVal() != (int)MeshMode::Cubes;
+}
+
+bool RawVolumeRenderer::usePackedVertices() const {
+	// the vertices of the smooth meshes are not integral - they need the full vertex format
+	if (useSmoothMesh()) {
+		return false;
+	}
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const voxel::RawVolume *v = volume(idx);
+		if (v == nullptr) {
+			continue;
+		}
+		const voxel::Region &region = v->region();
+		// the vertices are placed on the voxel corners - up to one above the upper corner
+		if (!voxel::fitsPackedVertex(region.getLowerCorner()) || !voxel::fitsPackedVertex(region.getUpperCorner() + 1)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool RawVolumeRenderer::useVertexPulling() const {
+	// the smooth meshes can't be described by voxel faces
+	return _vertexPullingSupported && _vertexPulling->boolVal() && !useSmoothMesh();
+}
+
+bool RawVolumeRenderer::useRayMarching() const {
+	return _rayMarchingSupported && _rayMarching->boolVal();
+}
+
+void RawVolumeRenderer::renderRayMarching(const video::Camera &camera) {
+	core_trace_scoped(RawVolumeRendererRayMarching);
+	_brickMapRenderer.setLighting(_voxelShaderFragData.lightdir, _voxelShaderFragData.diffuseColor,
+								  _voxelShaderFragData.ambientColor);
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		const int brickMapIdx = _state[idx]._reference != -1 ? _state[idx]._reference : idx;
+		if (_state[brickMapIdx]._hidden) {
+			continue;
+		}
+		// the brick map is in volume space - see volumeFrustum()
+		const glm::mat4 &model = glm::translate(_state[idx]._model, -_state[idx]._pivot);
+		_brickMapRenderer.render(brickMapIdx, camera, model, volumePalette(idx), _state[idx]._gray);
+	}
+}
+
+bool RawVolumeRenderer::useFaceCompute() const {
+	return _faceComputeSupported && _computeFaces->boolVal();
+}
+
+/**
+ * @brief Reserve some more face slots for each chunk to be able to update the chunk later without
+ * re-uploading the whole face buffer
+ */
+static inline uint32_t faceCapacity(size_t n) {
+	return (uint32_t)(n + n / 4u + 16u);
+}
+
+static void fillUnusedFaces(voxel::VoxelFace *faces, size_t n) {
+	core_memset(faces, 0, n * sizeof(voxel::VoxelFace));
+	for (size_t i = 0; i < n; ++i) {
+		faces[i].face = voxel::VoxelFace::InvalidFace;
+	}
+}
+
+bool RawVolumeRenderer::updateFaceBufferForChunk(int idx, MeshType type, const glm::ivec3 &mins) {
+	if (idx < 0 || idx >= MAX_VOLUMES) {
+		return false;
+	}
+	State& state = _state[idx];
+	auto rangeIter = state._faceRanges[type].find(mins);
+	if (rangeIter == state._faceRanges[type].end()) {
+		return false;
+	}
+	const FaceRange& range = rangeIter->second;
+	auto facesIter = state._chunkFaces.find(mins);
+	const voxel::FaceArray *faces = facesIter == state._chunkFaces.end() ? nullptr : &facesIter->second.faces[type];
+	const size_t n = faces == nullptr ? 0u : faces->size();
+	if (n > range.capacity) {
+		return false;
+	}
+	core_trace_scoped(RawVolumeRendererUpdateChunkFaces);
+	return uploadBuffer(state._faceBuffer, state._faceBufferIndex[type], range.offset * sizeof(voxel::VoxelFace),
+			range.capacity * sizeof(voxel::VoxelFace), false, [&] (uint8_t *dst) {
+		voxel::VoxelFace *buf = (voxel::VoxelFace *)dst;
+		if (n > 0u) {
+			core_memcpy(buf, faces->data(), n * sizeof(voxel::VoxelFace));
+		}
+		fillUnusedFaces(buf + n, range.capacity - n);
+	});
 }
 
-bool RawVolumeRenderer::updateBufferForVolume(int idx, MeshType type) {
+bool RawVolumeRenderer::updateFaceBufferForVolume(int idx, MeshType type) {
 	if (idx < 0 || idx >= MAX_VOLUMES) {
 		return false;
 	}
-	core_trace_scoped(RawVolumeRendererUpdate);
-
-	size_t vertCount = 0u;
-	size_t indCount = 0u;
-	for (auto& i : _meshes[type]) {
-		const Meshes& meshes = i.second;
-		const voxel::Mesh* mesh = meshes[idx];
-		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
-			continue;
-		}
-		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
-		const voxel::IndexArray& indexVector = mesh->getIndexVector();
-		vertCount += vertexVector.size();
-		indCount += indexVector.size();
-	}
-
 	State& state = _state[idx];
-	if (indCount == 0u || vertCount == 0u) {
-		state._vertexBuffer[type].update(state._vertexBufferIndex[type], nullptr, 0);
-		state._vertexBuffer[type].update(state._indexBufferIndex[type], nullptr, 0);
-		return true;
+	if (state._faceBufferIndex[type] == -1) {
+		return false;
 	}
-
-	const size_t verticesBufSize = vertCount * sizeof(voxel::VoxelVertex);
-	voxel::VoxelVertex* verticesBuf = (voxel::VoxelVertex*)core_malloc(verticesBufSize);
-	const size_t indicesBufSize = indCount * sizeof(voxel::IndexType);
-	voxel::IndexType* indicesBuf = (voxel::IndexType*)core_malloc(indicesBufSize);
-
-	voxel::VoxelVertex* verticesPos = verticesBuf;
-	voxel::IndexType* indicesPos = indicesBuf;
-
-	voxel::IndexType offset = (voxel::IndexType)0;
-	for (auto& i : _meshes[type]) {
-		const Meshes& meshes = i.second;
-		const voxel::Mesh* mesh = meshes[idx];
-		if (mesh == nullptr || mesh->getNoOfIndices() <= 0) {
+	core_trace_scoped(RawVolumeRendererUpdateFaces);
+	FaceRanges& ranges = state._faceRanges[type];
+	ranges.clear();
+	size_t faceCount = 0u;
+	for (const auto& entry : state._chunkFaces) {
+		const size_t n = entry.second.faces[type].size();
+		if (n == 0u) {
 			continue;
 		}
-		const voxel::VertexArray& vertexVector = mesh->getVertexVector();
-		const voxel::IndexArray& indexVector = mesh->getIndexVector();
-		core_memcpy(verticesPos, &vertexVector[0], vertexVector.size() * sizeof(voxel::VoxelVertex));
-		core_memcpy(indicesPos, &indexVector[0], indexVector.size() * sizeof(voxel::IndexType));
-
-		for (size_t i = 0; i < indexVector.size(); ++i) {
-			*indicesPos++ += offset;
-		}
-
-		verticesPos += vertexVector.size();
-		offset += vertexVector.size();
+		FaceRange range;
+		range.offset = (uint32_t)faceCount;
+		range.capacity = faceCapacity(n);
+		faceCount += range.capacity;
+		ranges.insert(std::make_pair(entry.first, range));
 	}
-
-	if (!state._vertexBuffer[type].update(state._vertexBufferIndex[type], verticesBuf, verticesBufSize)) {
-		Log::error("Failed to update the vertex buffer");
-		core_free(indicesBuf);
-		core_free(verticesBuf);
-		return false;
+	if (faceCount == 0u) {
+		state._faceBuffer.update(state._faceBufferIndex[type], nullptr, 0);
+		return true;
 	}
-	core_free(verticesBuf);
 
-	if (!state._vertexBuffer[type].update(state._indexBufferIndex[type], indicesBuf, indicesBufSize)) {
-		Log::error("Failed to update the index buffer");
-		core_free(indicesBuf);
+	const bool success = uploadBuffer(state._faceBuffer, state._faceBufferIndex[type], 0u,
+			faceCount * sizeof(voxel::VoxelFace), true, [&] (uint8_t *dst) {
+		voxel::VoxelFace *buf = (voxel::VoxelFace *)dst;
+		for (const auto& entry : ranges) {
+			const voxel::FaceArray &faces = state._chunkFaces[entry.first].faces[type];
+			const FaceRange& range = entry.second;
+			core_memcpy(buf + range.offset, faces.data(), faces.size() * sizeof(voxel::VoxelFace));
+			fillUnusedFaces(buf + range.offset + faces.size(), range.capacity - faces.size());
+		}
+	});
+	if (!success) {
+		Log::error("Failed to update the face buffer");
+		ranges.clear();
 		return false;
 	}
-	core_free(indicesBuf);
 	return true;
 }
 
-void RawVolumeRenderer::setAmbientColor(const glm::vec3& color) {
-	_voxelShaderFragData.ambientColor = color;
-}
-
-void RawVolumeRenderer::setDiffuseColor(const glm::vec3& color) {
-	_voxelShaderFragData.diffuseColor = color;
+void RawVolumeRenderer::drawFaces(int idx, MeshType type, const math::Frustum &frustum) {
+	const State& instance = _state[idx];
+	const State& state = instance._reference != -1 ? _state[instance._reference] : instance;
+	_visibleFaceRanges.clear();
+	for (const auto &entry : state._faceRanges[type]) {
+		if (isChunkVisible(frustum, entry.first)) {
+			_visibleFaceRanges.push_back(entry.second);
+		}
+	}
+	if (_visibleFaceRanges.empty()) {
+		return;
+	}
+	const int verticesPerFace = shader::VoxelpullingShaderConstants::getVerticesPerFace();
+	// merge the ranges that are next to each other in the face buffer
+	_visibleFaceRanges.sort([] (const FaceRange &lhs, const FaceRange &rhs) {
+		return lhs.offset > rhs.offset;
+	});
+	uint32_t offset = _visibleFaceRanges[0].offset;
+	uint32_t faces = _visibleFaceRanges[0].capacity;
+	for (size_t i = 1; i < _visibleFaceRanges.size(); ++i) {
+		const FaceRange &range = _visibleFaceRanges[i];
+		if (offset + faces == range.offset) {
+			faces += range.capacity;
+			continue;
+		}
+		video::drawArrays(video::Primitive::Triangles, faces * verticesPerFace, offset * verticesPerFace);
+		offset = range.offset;
+		faces = range.capacity;
+	}
+	video::drawArrays(video::Primitive::Triangles, faces * verticesPerFace, offset * verticesPerFace);
 }
 
-bool RawVolumeRenderer::empty(int idx) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return true;
+void RawVolumeRenderer::renderVertexPulling(const video::Camera &camera, video::PolygonMode mode) {
+	core_trace_scoped(RawVolumeRendererVertexPulling);
+	static_assert(sizeof(voxel::VoxelFace) == shader::VoxelpullingShaderConstants::getFaceSize() * sizeof(uint32_t),
+				  "The face size doesn't match the shader");
+	video::ScopedShader scoped(_voxelPullingShader);
+	// the uniform buffers are shared with the voxel shader
+	core_assert_always(_voxelPullingShader.setFrag(_voxelData.getFragUniformBuffer()));
+	if (_shadowMap->boolVal()) {
+		_voxelPullingShader.setShadowmap(video::TextureUnit::One);
 	}
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	video::ScopedPolygonMode polygonMode(mode);
 	for (int i = 0; i < MeshType_Max; ++i) {
-		for (auto& i : _meshes[i]) {
-			const Meshes& meshes = i.second;
-			if (meshes[idx] != nullptr && meshes[idx]->getNoOfIndices() > 0) {
-				return false;
+		const MeshType type = (MeshType)i;
+		video::ScopedState scopedBlend(video::State::Blend, type == MeshType_Transparency);
+		for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+			const State& state = _state[idx]._reference != -1 ? _state[_state[idx]._reference] : _state[idx];
+			if (state._hidden || state.faces(type) == 0u) {
+				continue;
 			}
+			updatePalette(idx);
+			_voxelShaderVertData.viewprojection = viewProjection;
+			_voxelShaderVertData.model = _state[idx]._model;
+			_voxelShaderVertData.pivot = _state[idx]._pivot;
+			_voxelShaderVertData.gray = _state[idx]._gray;
+			core_assert_always(_voxelData.update(_voxelShaderVertData));
+			core_assert_always(_voxelPullingShader.setVert(_voxelData.getVertUniformBuffer()));
+			// there are no vertex attributes - but a vertex array object must be bound for the draw calls
+			video::ScopedBuffer scopedBuf(state._faceBuffer);
+			video::bindBufferBase(video::BufferType::ShaderStorageBuffer, state._faceBuffer.bufferHandle(state._faceBufferIndex[type]),
+								  _voxelPullingShader.getBindingFacedata());
+			drawFaces(idx, type, volumeFrustum(idx, viewProjection));
 		}
 	}
-	return true;
 }
 
-voxel::Region RawVolumeRenderer::calculateExtractRegion(int x, int y, int z, const glm::ivec3& meshSize) const {
-	const glm::ivec3 mins(x * meshSize.x, y * meshSize.y, z * meshSize.z);
-	const glm::ivec3 maxs = mins + meshSize - 1;
-	return voxel::Region{mins, maxs};
+int RawVolumeRenderer::lodForVoxelSize(float pixelsPerVoxel, float threshold) {
+	if (threshold <= 0.0f) {
+		return 0;
+	}
+	int lod = 0;
+	while (lod < MaxLODs - 1 && pixelsPerVoxel * (float)(1 << (lod + 1)) <= threshold) {
+		++lod;
+	}
+	return lod;
 }
 
-bool RawVolumeRenderer::extractRegion(int idx, const voxel::Region& region) {
-	core_trace_scoped(RawVolumeRendererExtract);
-	voxel::RawVolume* v = volume(idx);
-	if (v == nullptr) {
+bool RawVolumeRenderer::useOIT(const RenderContext &renderContext) const {
+	if (!_oitSupported || !_orderIndependentTransparency->boolVal()) {
 		return false;
 	}
-
-	const int s = _meshSize->intVal();
-	const glm::ivec3 meshSize(s);
-	const glm::ivec3 meshSizeMinusOne(s - 1);
-	const voxel::Region& completeRegion = v->region();
-
-	// convert to step coordinates that are needed to extract
-	// the given region mesh size ranges
-	// the boundaries are special - that's why we take care of this with
-	// the offset of 1 - see the cubic surface extractor docs
-	const glm::ivec3& l = (region.getLowerCorner() - meshSizeMinusOne) / meshSize;
-	const glm::ivec3& u = (region.getUpperCorner() + 1) / meshSize;
-
-	Log::debug("modified region: %s", region.toString().c_str());
-	for (int x = l.x; x <= u.x; ++x) {
-		for (int y = l.y; y <= u.y; ++y) {
-			for (int z = l.z; z <= u.z; ++z) {
-				const voxel::Region& finalRegion = calculateExtractRegion(x, y, z, meshSize);
-				const glm::ivec3& mins = finalRegion.getLowerCorner();
-
-				if (!voxel::intersects(completeRegion, finalRegion)) {
-					for (int i = 0; i < MeshType_Max; ++i) {
-						auto iter = _meshes[i].find(mins);
-						if (iter != _meshes[i].end()) {
-							delete iter->second[idx];
-							iter->second[idx] = nullptr;
-							State& state = _state[idx];
-							state._vertexBuffer[i].update(state._vertexBufferIndex[i], nullptr, 0);
-							state._vertexBuffer[i].update(state._indexBufferIndex[i], nullptr, 0);
-						}
-					}
-					continue;
-				}
-
-				Log::debug("extract region: %s", finalRegion.toString().c_str());
-				_extractRegions.emplace_back(finalRegion, idx);
-			}
-		}
+	// the multi draw indirect and the vertex pulling paths don't come with their own transparency pass
+	if (_vertexPullingActive || useMultiDrawIndirect()) {
+		return false;
 	}
-	return true;
+	const video::FrameBuffer &oit = renderContext.oitFrameBuffer;
+	if (oit.handle() == video::InvalidId || oit.dimension() != renderContext.frameBuffer.dimension()) {
+		return false;
+	}
+	// we need the depth buffer of the opaque pass
+	return video::currentFramebuffer() == renderContext.frameBuffer.handle();
 }
 
-void RawVolumeRenderer::waitForPendingExtractions() {
-	while (_runningExtractorTasks > 0) {
-		SDL_Delay(1);
+void RawVolumeRenderer::renderTransparencyOIT(RenderContext &renderContext, const video::Camera &camera, video::PolygonMode mode) {
+	core_trace_scoped(RawVolumeRendererOIT);
+	video::FrameBuffer &oit = renderContext.oitFrameBuffer;
+	const glm::ivec2 &dim = oit.dimension();
+	oit.bind(false);
+	// the transparent voxels are depth tested against the opaque scene
+	video::blitFramebuffer(renderContext.frameBuffer.handle(), oit.handle(), video::ClearFlag::Depth, dim.x, dim.y);
+	const glm::vec4 clearColor = video::currentClearColor();
+	video::clearColor(glm::vec4(0.0f));
+	video::clear(video::ClearFlag::Color);
+	video::clearColor(clearColor);
+
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	{
+		video::ScopedShader scoped(_voxelOITShader);
+		video::ScopedState scopedDepthMask(video::State::DepthMask, false);
+		video::ScopedBlendMode scopedBlendMode(video::BlendMode::One, video::BlendMode::One, video::BlendEquation::Add);
+		// sum up the weighted colors and the weights - the alpha channel accumulates the coverage
+		video::blendFuncSeparate(video::BlendMode::One, video::BlendMode::One, video::BlendMode::One,
+								 video::BlendMode::OneMinusSourceAlpha);
+		video::ScopedPolygonMode polygonMode(mode);
+		if (_shadowMap->boolVal()) {
+			_voxelOITShader.setShadowmap(video::TextureUnit::One);
+		}
+		for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+			const State& state = _state[idx]._reference != -1 ? _state[_state[idx]._reference] : _state[idx];
+			if (state._hidden) {
+				continue;
+			}
+			if (state.indices(MeshType_Transparency) == 0u) {
+				continue;
+			}
+			updatePalette(idx);
+			_voxelShaderVertData.viewprojection = viewProjection;
+			_voxelShaderVertData.model = _state[idx]._model;
+			_voxelShaderVertData.pivot = _state[idx]._pivot;
+			_voxelShaderVertData.gray = _state[idx]._gray;
+			core_assert_always(_voxelData.update(_voxelShaderVertData));
+			core_assert_always(_voxelOITShader.setFrag(_voxelData.getFragUniformBuffer()));
+			core_assert_always(_voxelOITShader.setVert(_voxelData.getVertUniformBuffer()));
+			video::ScopedBuffer scopedBuf(state._vertexBuffer[MeshType_Transparency]);
+			drawChunks(idx, MeshType_Transparency, volumeFrustum(idx, viewProjection));
+		}
 	}
+	oit.unbind();
+
+	video::ScopedShader scoped(_voxelOITCompositeShader);
+	video::ScopedState scopedDepthTest(video::State::DepthTest, false);
+	video::ScopedState scopedCullFace(video::State::CullFace, false);
+	video::ScopedPolygonMode polygonMode(video::PolygonMode::Solid);
+	video::ScopedBlendMode scopedBlendMode(video::BlendMode::SourceAlpha, video::BlendMode::OneMinusSourceAlpha, video::BlendEquation::Add);
+	core_assert_always(video::bindTexture(video::TextureUnit::Zero, oit, video::FrameBufferAttachment::Color0));
+	core_assert_always(video::bindTexture(video::TextureUnit::Two, oit, video::FrameBufferAttachment::Color1));
+	_voxelOITCompositeShader.setAccum(video::TextureUnit::Zero);
+	_voxelOITCompositeShader.setWeight(video::TextureUnit::Two);
+	video::ScopedBuffer scopedBuf(_oitQuad);
+	video::drawArrays(video::Primitive::Triangles, 6);
 }
 
-void RawVolumeRenderer::clearPendingExtractions() {
-	Log::debug("Clear pending extractions");
-	_threadPool.abort();
-	while (_runningExtractorTasks > 0) {
-		SDL_Delay(1);
-	}
-	_pendingQueue.clear();
+bool RawVolumeRenderer::usePicking() const {
+	// the face of the hit voxel is taken from the axis aligned quads of the full resolution cubic meshes
+	return _pickSupported && !useSmoothMesh() && !_lodsEnabled && !_vertexPullingActive &&
+		   !_rayMarchingActive;
 }
 
-bool RawVolumeRenderer::hidden(int idx) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return true;
+bool RawVolumeRenderer::pick(const glm::ivec2 &pixel) {
+	if (!usePicking()) {
+		return false;
 	}
-	return _state[idx]._hidden;
+	_pickPixel = pixel;
+	_pickRequested = true;
+	return true;
 }
 
-void RawVolumeRenderer::hide(int idx, bool hide) {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return;
+bool RawVolumeRenderer::pickResult(PickResult &result) {
+	updatePickResults();
+	if (!_hasPickResult) {
+		return false;
 	}
-	_state[idx]._hidden = hide;
+	result = _pickResult;
+	return true;
 }
 
-bool RawVolumeRenderer::grayed(int idx) const {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
-		return true;
+void RawVolumeRenderer::updatePickResults() {
+	PickResult result;
+	while (_pickBuffer.pop(result)) {
+		_pickResult = result;
+		_hasPickResult = true;
 	}
-	return _state[idx]._gray;
 }
 
-void RawVolumeRenderer::gray(int idx, bool gray) {
-	if (idx < 0 || idx >= MAX_VOLUMES) {
+void RawVolumeRenderer::renderPick(const video::Camera &camera) {
+	if (_pickBuffer.full()) {
+		// the gpu didn't finish the previous pick passes yet
 		return;
 	}
-	_state[idx]._gray = gray;
-}
-
-void RawVolumeRenderer::updatePalette(int idx) {
-	const voxel::Palette *palette;
-	const State& state = _state[idx]._reference != -1 ? _state[_state[idx]._reference] : _state[idx];
-	if (state._palette.hasValue()) {
-		palette = state._palette.value();
-	} else {
-		palette = &voxel::getPalette();
+	core_trace_scoped(RawVolumeRendererPick);
+	// only the pixel below the mouse cursor ends up in the one pixel target
+	const glm::ivec2 &size = camera.size();
+	const glm::mat4 &pickMatrix = glm::pickMatrix(glm::vec2(_pickPixel.x, size.y - _pickPixel.y), glm::vec2(1.0f),
+												  glm::ivec4(0, 0, size.x, size.y));
+	const glm::mat4 &viewProjection = pickMatrix * camera.viewProjectionMatrix();
+	const glm::vec3 &rayDirection = camera.mouseRay(_pickPixel).direction;
+
+	video::FrameBuffer &frameBuffer = _pickBuffer.frameBuffer();
+	frameBuffer.bind(false);
+	const glm::vec4 clearColor = video::currentClearColor();
+	video::clearColor(glm::vec4(0.0f));
+	video::clear(video::ClearFlag::Color | video::ClearFlag::Depth);
+	video::clearColor(clearColor);
+	{
+		video::ScopedState scopedDepth(video::State::DepthTest);
+		video::depthFunc(video::CompareFunc::LessEqual);
+		video::ScopedState scopedCullFace(video::State::CullFace);
+		video::ScopedState scopedScissor(video::State::Scissor, false);
+		video::ScopedState scopedBlend(video::State::Blend, false);
+		video::ScopedState scopedDepthMask(video::State::DepthMask);
+		video::ScopedPolygonMode polygonMode(video::PolygonMode::Solid);
+		video::ScopedShader scoped(_voxelPickShader);
+		for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+			const State& state = _state[idx]._reference != -1 ? _state[_state[idx]._reference] : _state[idx];
+			if (state._hidden || !_state[idx]._pickable) {
+				continue;
+			}
+			_voxelShaderVertData.viewprojection = viewProjection;
+			_voxelShaderVertData.model = _state[idx]._model;
+			_voxelShaderVertData.pivot = _state[idx]._pivot;
+			core_assert_always(_voxelData.update(_voxelShaderVertData));
+			core_assert_always(_voxelPickShader.setVert(_voxelData.getVertUniformBuffer()));
+			_voxelPickShader.setPickid(idx + 1);
+			// the mouse ray in volume space - the shader needs it to find the side of the face the ray hit
+			_voxelPickShader.setRaydir(glm::inverse(glm::mat3(_state[idx]._model)) * rayDirection);
+			const math::Frustum &frustum = volumeFrustum(idx, viewProjection);
+			// the transparent voxels can be picked, too
+			for (int i = 0; i < MeshType_Max; ++i) {
+				if (state.indices((MeshType)i) == 0u) {
+					continue;
+				}
+				video::ScopedBuffer scopedBuf(state._vertexBuffer[i]);
+				drawChunks(idx, (MeshType)i, frustum);
+			}
+		}
 	}
+	frameBuffer.unbind();
+	_pickBuffer.read(_pickPixel);
+}
 
-	if (palette->hash() != _paletteHash) {
-		_paletteHash = palette->hash();
-		core::DynamicArray<glm::vec4> materialColors;
-		palette->toVec4f(materialColors);
-		core::DynamicArray<glm::vec4> glowColors;
-		palette->glowToVec4f(glowColors);
-		for (int i = 0; i < voxel::PaletteMaxColors; ++i) {
-			_voxelShaderVertData.materialcolor[i] = materialColors[i];
-			_voxelShaderVertData.glowcolor[i] = glowColors[i];
+void RawVolumeRenderer::updateLODs(const video::Camera &camera) {
+	core_trace_scoped(RawVolumeRendererUpdateLODs);
+	const float threshold = _lodThreshold->floatVal();
+	const float halfScreenHeight = (float)camera.size().y * 0.5f;
+	const glm::vec3 halfMeshSize((float)_meshSize->intVal() * 0.5f);
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	const glm::vec3 up = camera.up();
+	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+		State& state = _state[idx];
+		if (state._hidden || state._rawVolume == nullptr) {
+			continue;
+		}
+		// the size of one voxel in world space
+		const float voxelSize = glm::length(glm::vec3(state._model[1]));
+		bool updateVolume = false;
+		for (const auto &entry : state._chunkRanges[MeshType_Opaque]) {
+			const glm::ivec3 &mins = entry.first;
+			const glm::vec3 center = state._model * glm::vec4(glm::vec3(mins) + halfMeshSize - state._pivot, 1.0f);
+			const glm::vec4 p0 = viewProjection * glm::vec4(center, 1.0f);
+			const glm::vec4 p1 = viewProjection * glm::vec4(center + up * voxelSize, 1.0f);
+			int lod = 0;
+			if (p0.w > 0.0f && p1.w > 0.0f) {
+				const float pixelsPerVoxel = glm::abs(p1.y / p1.w - p0.y / p0.w) * halfScreenHeight;
+				lod = lodForVoxelSize(pixelsPerVoxel, threshold);
+			}
+			auto lodIter = state._chunkLods.find(mins);
+			const int currentLod = lodIter == state._chunkLods.end() ? 0 : lodIter->second;
+			if (currentLod == lod) {
+				continue;
+			}
+			state._chunkLods[mins] = lod;
+			if (!updateVolume && !updateBufferForChunk(idx, MeshType_Opaque, mins)) {
+				updateVolume = true;
+			}
+		}
+		if (updateVolume && !updateBufferForVolume(idx, MeshType_Opaque)) {
+			Log::error("Failed to update the mesh at index %i", idx);
 		}
 	}
 }
@@ -459,32 +2396,45 @@ void RawVolumeRenderer::updatePalette(int idx) {
 void RawVolumeRenderer::render(RenderContext &renderContext, const video::Camera& camera, bool shadow) {
 	core_trace_scoped(RawVolumeRendererRender);
 
+	const glm::mat4 &viewProjection = camera.viewProjectionMatrix();
+	if (!_hasPriorityCamera || _priorityViewProjection != viewProjection) {
+		// the queued chunks are sorted again for this camera
+		_priorityViewProjection = viewProjection;
+		_priorityEye = camera.eye();
+		_hasPriorityCamera = true;
+		_extractRegionsSorted = false;
+	}
+
 	bool visible = false;
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
 		const State& state = _state[idx];
 		if (state._hidden) {
 			continue;
 		}
-		if (!state.hasData()) {
+		if (!state.hasData() && !_brickMapRenderer.hasData(idx)) {
 			continue;
 		}
 		visible = true;
 	}
+	if (_pickSupported) {
+		updatePickResults();
+	}
+	if (_pickRequested) {
+		_pickRequested = false;
+		// a pick pass without visible volumes reads back a miss
+		renderPick(camera);
+	}
 	if (!visible) {
 		return;
 	}
-	for (auto& i : _meshes[MeshType_Transparency]) {
-		for (int idx = 0; idx < (int)i.second.size(); ++idx) {
-			const State& state = _state[idx];
-			if (state._hidden) {
-				continue;
-			}
-			// TODO: transform - vertices are in object space - eye in world space
-			// inverse of state._model - but take pivot into account
-			if (i.second[idx]->sort(camera.eye())) {
-				updateBufferForVolume(idx, MeshType_Transparency);
-			}
-		}
+	if (_lodsEnabled) {
+		updateLODs(camera);
+	}
+	applySortResults();
+	const bool oit = useOIT(renderContext);
+	if (!oit) {
+		// the blending of the order independent transparency doesn't depend on the order of the triangles
+		sortTransparentChunks(camera);
 	}
 
 	video::ScopedState scopedDepth(video::State::DepthTest);
@@ -493,11 +2443,19 @@ void RawVolumeRenderer::render(RenderContext &renderContext, const video::Camera
 	video::ScopedState scopedScissor(video::State::Scissor, false);
 	video::ScopedState scopedBlend(video::State::Blend, false);
 	video::ScopedState scopedDepthMask(video::State::DepthMask);
+	Shadow &shadowMap = renderContext.shadow;
 	if (_shadowMap->boolVal()) {
-		_shadow.update(camera, true);
+		shadowMap.update(camera, true);
+		updateShadowDirty(renderContext);
 		if (shadow) {
+			video_gpu_scoped(Shadow);
 			video::ScopedShader scoped(_shadowMapShader);
-			_shadow.render([this] (int i, const glm::mat4& lightViewProjection) {
+			shadowMap.render([this] (int i, const glm::mat4& lightViewProjection) {
+				static const char *CascadeNames[] = {"ShadowCascade0", "ShadowCascade1", "ShadowCascade2",
+													 "ShadowCascade3"};
+				static_assert(lengthof(CascadeNames) == shader::VoxelShaderConstants::getMaxDepthBuffers(),
+							  "Array size doesn't match the max depth buffers");
+				video::ScopedGPUTimer gpuTimer(CascadeNames[i]);
 				alignas(16) shader::ShadowmapData::BlockData var;
 				var.lightviewprojection = lightViewProjection;
 
@@ -515,30 +2473,33 @@ void RawVolumeRenderer::render(RenderContext &renderContext, const video::Camera
 					var.pivot = _state[idx]._pivot;
 					_shadowMapUniformBlock.update(var);
 					_shadowMapShader.setBlock(_shadowMapUniformBlock.getBlockUniformBuffer());
-					static_assert(sizeof(voxel::IndexType) == sizeof(uint32_t), "Index type doesn't match");
-					video::drawElements<voxel::IndexType>(video::Primitive::Triangles, indices);
+					// only the chunks inside the frustum of this cascade can cast a shadow into it
+					drawChunks(idx, MeshType_Opaque, volumeFrustum(idx, lightViewProjection));
 				}
 				return true;
 			}, true);
 		} else {
-			_shadow.render([] (int i, const glm::mat4& lightViewProjection) {
+			// the cleared depth maps don't match the scene - render them again once the shadows are enabled
+			shadowMap.markDirty();
+			shadowMap.render([] (int i, const glm::mat4& lightViewProjection) {
 				video::clear(video::ClearFlag::Depth);
 				return true;
 			});
+			shadowMap.markDirty();
 		}
 	}
 
-	_voxelShaderFragData.depthsize = _shadow.dimension();
+	_voxelShaderFragData.depthsize = shadowMap.dimension();
 	for (int i = 0; i < shader::VoxelShaderConstants::getMaxDepthBuffers(); ++i) {
-		_voxelShaderFragData.cascades[i] = _shadow.cascades()[i];
-		_voxelShaderFragData.distances[i] = _shadow.distances()[i];
+		_voxelShaderFragData.cascades[i] = shadowMap.cascades()[i];
+		_voxelShaderFragData.distances[i] = shadowMap.distances()[i];
 	}
-	_voxelShaderFragData.lightdir = _shadow.sunDirection();
+	_voxelShaderFragData.lightdir = shadowMap.sunDirection();
 	core_assert_always(_voxelData.update(_voxelShaderFragData));
 
 	video::ScopedShader scoped(_voxelShader);
 	if (_shadowMap->boolVal()) {
-		core_assert_always(_shadow.bind(video::TextureUnit::One));
+		core_assert_always(shadowMap.bind(video::TextureUnit::One));
 	}
 
 	const video::PolygonMode mode = camera.polygonMode();
@@ -550,61 +2511,94 @@ void RawVolumeRenderer::render(RenderContext &renderContext, const video::Camera
 		video::enable(video::State::PolygonOffsetFill);
 	}
 
-	_paletteHash = 0;
-	// --- opaque pass
-	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
-		const State& state = _state[idx]._reference != -1 ? _state[_state[idx]._reference] : _state[idx];
-		if (state._hidden) {
-			continue;
-		}
-		const uint32_t indices = state.indices(MeshType_Opaque);
-		if (indices == 0u) {
-			continue;
-		}
-
-		updatePalette(idx);
-		_voxelShaderVertData.viewprojection = camera.viewProjectionMatrix();
-		_voxelShaderVertData.model = _state[idx]._model;
-		_voxelShaderVertData.pivot = _state[idx]._pivot;
-		_voxelShaderVertData.gray = _state[idx]._gray;
-		core_assert_always(_voxelData.update(_voxelShaderVertData));
+	if (_occlusionCulling->isDirty()) {
+		_occlusionCulling->markClean();
+		resetOcclusion();
+	}
+	const bool occlusionQueries = _occlusionCulling->boolVal();
 
-		video::ScopedPolygonMode polygonMode(mode);
-		video::ScopedBuffer scopedBuf(state._vertexBuffer[MeshType_Opaque]);
-		core_assert_always(_voxelShader.setFrag(_voxelData.getFragUniformBuffer()));
-		core_assert_always(_voxelShader.setVert(_voxelData.getVertUniformBuffer()));
-		if (_shadowMap->boolVal()) {
-			_voxelShader.setShadowmap(video::TextureUnit::One);
+	if (_multiDrawIndirect->isDirty()) {
+		_multiDrawIndirect->markClean();
+		for (int i = 0; i < MeshType_Max; ++i) {
+			_arena[i].dirty = true;
+		}
+		// the arena needs 32 bit indices for all volumes - the 16 bit ones are only used again after the next upload
+		if (useMultiDrawIndirect()) {
+			for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+				for (int i = 0; i < MeshType_Max; ++i) {
+					if (_state[idx]._indexSize[i] != sizeof(voxel::IndexType) && _state[idx].indices((MeshType)i) > 0u) {
+						updateBufferForVolume(idx, (MeshType)i);
+					}
+				}
+			}
 		}
-		video::drawElements<voxel::IndexType>(video::Primitive::Triangles, indices);
 	}
-
-	// --- transparency pass
-	{
-		video::ScopedState scopedBlend(video::State::Blend, true);
+	if (_rayMarchingActive) {
+		video_gpu_scoped(RayMarching);
+		renderRayMarching(camera);
+	} else if (_vertexPullingActive) {
+		video_gpu_scoped(VertexPulling);
+		renderVertexPulling(camera, mode);
+	} else if (useMultiDrawIndirect()) {
+		video_gpu_scoped(MultiDrawIndirect);
+		// the shadow pass and the occlusion queries still use the per volume buffers
+		renderMultiDrawIndirect(camera, mode);
+	} else {
+		// the occlusion queries are done for every instance on its own
+		_instancing = _instancingSupported && !occlusionQueries;
+		if (_instancing) {
+			updateInstances();
+		}
+		// --- opaque pass
+		video::ScopedGPUTimer opaqueTimer("Opaque");
 		for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
 			const State& state = _state[idx]._reference != -1 ? _state[_state[idx]._reference] : _state[idx];
-			const uint32_t indices = state.indices(MeshType_Transparency);
+			if (state._hidden) {
+				continue;
+			}
+			const uint32_t indices = state.indices(MeshType_Opaque);
 			if (indices == 0u) {
 				continue;
 			}
+			if (isInstanced(idx)) {
+				continue;
+			}
 
-			updatePalette(idx);
-			_voxelShaderVertData.viewprojection = camera.viewProjectionMatrix();
-			_voxelShaderVertData.model = _state[idx]._model;
-			_voxelShaderVertData.pivot = _state[idx]._pivot;
-			_voxelShaderVertData.gray = _state[idx]._gray;
-			core_assert_always(_voxelData.update(_voxelShaderVertData));
-
-			// TODO: alpha support - sort according to eye pos
+			updateVoxelShaderVertData(idx, camera);
 			video::ScopedPolygonMode polygonMode(mode);
-			video::ScopedBuffer scopedBuf(state._vertexBuffer[MeshType_Transparency]);
-			core_assert_always(_voxelShader.setFrag(_voxelData.getFragUniformBuffer()));
-			core_assert_always(_voxelShader.setVert(_voxelData.getVertUniformBuffer()));
-			if (_shadowMap->boolVal()) {
-				_voxelShader.setShadowmap(video::TextureUnit::One);
+			video::ScopedBuffer scopedBuf(state._vertexBuffer[MeshType_Opaque]);
+			drawChunks(idx, MeshType_Opaque, volumeFrustum(idx, viewProjection), occlusionQueries);
+		}
+		renderInstances(MeshType_Opaque, camera, mode);
+		if (occlusionQueries) {
+			video::ScopedPolygonMode polygonMode(mode);
+			renderOcclusionProxies(camera);
+		}
+		opaqueTimer.end();
+
+		// --- transparency pass
+		video_gpu_scoped(Transparent);
+		if (oit) {
+			renderTransparencyOIT(renderContext, camera, mode);
+		} else {
+			video::ScopedState scopedBlend(video::State::Blend, true);
+			for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
+				const State& state = _state[idx]._reference != -1 ? _state[_state[idx]._reference] : _state[idx];
+				const uint32_t indices = state.indices(MeshType_Transparency);
+				if (indices == 0u) {
+					continue;
+				}
+				if (isInstanced(idx)) {
+					continue;
+				}
+
+				updateVoxelShaderVertData(idx, camera);
+				// TODO: alpha support - sort according to eye pos
+				video::ScopedPolygonMode polygonMode(mode);
+				video::ScopedBuffer scopedBuf(state._vertexBuffer[MeshType_Transparency]);
+				drawChunks(idx, MeshType_Transparency, volumeFrustum(idx, viewProjection));
 			}
-			video::drawElements<voxel::IndexType>(video::Primitive::Triangles, indices);
+			renderInstances(MeshType_Transparency, camera, mode);
 		}
 	}
 
@@ -619,6 +2613,7 @@ void RawVolumeRenderer::render(RenderContext &renderContext, const video::Camera
 		video::FrameBuffer &frameBuffer = renderContext.frameBuffer;
 		const video::TexturePtr& color0 = frameBuffer.texture(video::FrameBufferAttachment::Color0);
 		const video::TexturePtr& color1 = frameBuffer.texture(video::FrameBufferAttachment::Color1);
+		video_gpu_scoped(Bloom);
 		renderContext.bloomRenderer.render(color0, color1);
 	}
 }
@@ -633,6 +2628,7 @@ bool RawVolumeRenderer::setModelMatrix(int idx, const glm::mat4& model, const gl
 		Log::error("No volume found at: %i", idx);
 		return false;
 	}
+	// the shadow maps are rendered again if the shadow state hash changes
 	state._model = model;
 	state._pivot = pivot;
 	return true;
@@ -688,15 +2684,11 @@ voxel::RawVolume* RawVolumeRenderer::setVolume(int idx, voxel::RawVolume* volume
 	core_trace_scoped(RawVolumeRendererSetVolume);
 	state._rawVolume = volume;
 	if (deleteMesh) {
-		for (int i = 0; i < MeshType_Max; ++i) {
-			for (auto& iter : _meshes[i]) {
-				delete iter.second[idx];
-				iter.second[idx] = nullptr;
-				State& state = _state[idx];
-				state._vertexBuffer[i].update(state._vertexBufferIndex[i], nullptr, 0);
-				state._vertexBuffer[i].update(state._indexBufferIndex[i], nullptr, 0);
-			}
-		}
+		deleteVolumeMeshes(idx);
+		deleteVolumeFaces(idx);
+		_brickMapRenderer.remove(idx);
+		// drop the results of the extractions of the old volume
+		invalidateChunks(idx);
 	}
 	const size_t n = _extractRegions.size();
 	for (size_t i = 0; i < n; ++i) {
@@ -709,14 +2701,49 @@ voxel::RawVolume* RawVolumeRenderer::setVolume(int idx, voxel::RawVolume* volume
 }
 
 void RawVolumeRenderer::setSunPosition(const glm::vec3& eye, const glm::vec3& center, const glm::vec3& up) {
-	_shadow.setPosition(eye, center, up);
+	// applied to the shadows of the render contexts with the next render call
+	_lightView = glm::lookAt(eye, center, up);
+	_hasLightView = true;
 }
 
 core::DynamicArray<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 	_threadPool.shutdown();
+	_sortQueue.clear();
+	resetOcclusion();
 	_voxelShader.shutdown();
+	_voxelIndirectShader.shutdown();
+	_voxelInstancedShader.shutdown();
+	_voxelInstancedData.shutdown();
+	_instancingSupported = false;
+	_voxelPullingShader.shutdown();
+	_voxelOITShader.shutdown();
+	_voxelOITCompositeShader.shutdown();
+	_oitQuad.shutdown();
+	_oitSupported = false;
+	_occlusionBoxBuffer.shutdown();
+	_occlusionBoxVertexIndex = -1;
+	_occlusionBoxIndexIndex = -1;
+	_voxelPickShader.shutdown();
+	_pickBuffer.shutdown();
+	_pickSupported = false;
+	_pickRequested = false;
+	_hasPickResult = false;
+	_vertexPullingSupported = false;
+	_faceCompute.shutdown();
+	_faceComputeSupported = false;
+	_brickMapRenderer.shutdown();
+	_rayMarchingSupported = false;
 	_shadowMapShader.shutdown();
 	_voxelData.shutdown();
+	_voxelIndirectData.shutdown();
+	for (int i = 0; i < MeshType_Max; ++i) {
+		_arena[i].buffer.shutdown();
+		_arena[i].dirty = true;
+	}
+	_drawDataBuffer.shutdown();
+	_paletteData.clear();
+	_paletteSlotHashes.clear();
+	_streamBuffer.shutdown();
 	_shadowMapUniformBlock.shutdown();
 	for (int i = 0; i < MeshType_Max; ++i) {
 		for (auto& iter : _meshes[i]) {
@@ -726,6 +2753,14 @@ core::DynamicArray<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 		}
 		_meshes[i].clear();
 	}
+	for (int i = 0; i < MaxLODs - 1; ++i) {
+		for (auto& iter : _lodMeshes[i]) {
+			for (auto& mesh : iter.second) {
+				delete mesh;
+			}
+		}
+		_lodMeshes[i].clear();
+	}
 	core::DynamicArray<voxel::RawVolume*> old(MAX_VOLUMES);
 	for (int idx = 0; idx < MAX_VOLUMES; ++idx) {
 		State& state = _state[idx];
@@ -733,12 +2768,18 @@ core::DynamicArray<voxel::RawVolume*> RawVolumeRenderer::shutdown() {
 			state._vertexBuffer[i].shutdown();
 			state._vertexBufferIndex[i] = -1;
 			state._indexBufferIndex[i] = -1;
+			state._faceBufferIndex[i] = -1;
+			state._faceRanges[i].clear();
 		}
+		state._faceBuffer.shutdown();
+		state._chunkFaces.clear();
+		state._transparencySort.clear();
 		// hand over the ownership to the caller
 		old.push_back(state._rawVolume);
 		state._rawVolume = nullptr;
 	}
-	_shadow.shutdown();
+	_shadowChunks.clear();
+	markShadowsDirty();
 	return old;
 }
 
@@ -8,17 +8,31 @@
 #include "core/NonCopyable.h"
 #include "core/Optional.h"
 #include "core/collection/ConcurrentPriorityQueue.h"
+#include "core/collection/ConcurrentQueue.h"
 #include "core/concurrent/Atomic.h"
 #include "core/concurrent/Concurrency.h"
 #include "core/concurrent/ThreadPool.h"
 #include "render/BloomRenderer.h"
 #include "voxel/ChunkMesh.h"
+#include "voxel/CubicFaceExtractor.h"
 #include "voxel/Palette.h"
 #include "voxel/RawVolume.h"
 #include "voxel/Region.h"
 #include "video/Buffer.h"
 #include "video/FrameBuffer.h"
+#include "video/StreamBuffer.h"
 #include "VoxelShader.h"
+#include "VoxelindirectShader.h"
+#include "VoxelindirectData.h"
+#include "VoxelinstancedShader.h"
+#include "VoxelinstancedData.h"
+#include "VoxelpullingShader.h"
+#include "FaceCompute.h"
+#include "BrickMapRenderer.h"
+#include "VoxeloitShader.h"
+#include "VoxeloitcompositeShader.h"
+#include "VoxelpickShader.h"
+#include "PickBuffer.h"
 #include "ShadowmapShader.h"
 #include "VoxelShaderConstants.h"
 #include "voxel/Mesh.h"
@@ -26,6 +40,8 @@
 #include "core/GLM.h"
 #include "core/Var.h"
 #include "core/collection/Array.h"
+#include "core/collection/DynamicArray.h"
+#include "math/Frustum.h"
 #include <unordered_map>
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/hash.hpp>
@@ -45,12 +61,34 @@ namespace voxelrender {
 
 struct RenderContext : public core::NonCopyable {
 	video::FrameBuffer frameBuffer;
+	/**
+	 * @brief The accumulation targets for the order independent transparency - not initialized if the
+	 * float textures are not supported
+	 * @sa cfg::VoxelOrderIndependentTransparency
+	 */
+	video::FrameBuffer oitFrameBuffer;
 	render::BloomRenderer bloomRenderer;
+	/**
+	 * @brief The cascaded shadow maps of this view - they are kept as long as the camera and the shadow casting
+	 * parts of the scene don't change, even if other views are rendered in between
+	 */
+	Shadow shadow;
+	/**
+	 * @brief The shadow casting state of the scene the depth maps were rendered for
+	 * @sa RawVolumeRenderer::shadowStateHash()
+	 */
+	uint64_t shadowStateHash = 0u;
+	/**
+	 * @brief The mesh changes of the renderer that were already applied to the depth maps
+	 */
+	uint32_t shadowRevision = 0u;
 	bool sceneMode = false;
 
 	bool init(const glm::ivec2 &size);
 	void shutdown();
 	bool resize(const glm::ivec2 &size);
+private:
+	void initOIT(const glm::ivec2 &size);
 };
 
 /**
@@ -61,50 +99,311 @@ struct RenderContext : public core::NonCopyable {
 class RawVolumeRenderer : public core::NonCopyable {
 public:
 	static constexpr int MAX_VOLUMES = 2048;
+	/**
+	 * @brief The amount of detail levels per chunk - the full resolution mesh included. Each level halves the
+	 * resolution of the previous one.
+	 */
+	static constexpr int MaxLODs = 3;
 protected:
 	enum MeshType {
 		MeshType_Opaque,
 		MeshType_Transparency,
 		MeshType_Max
 	};
+	/**
+	 * @brief The part of the vertex and index buffer of a volume that belongs to one extracted chunk mesh
+	 *
+	 * The capacity is a bit larger than the mesh size at the time the buffer was created. This allows us
+	 * to re-upload a single chunk mesh after a modification instead of the whole buffer of the volume.
+	 * Unused index slots are filled with degenerated triangles.
+	 */
+	struct ChunkRange {
+		uint32_t vertexOffset = 0u;
+		uint32_t vertexCapacity = 0u;
+		uint32_t indexOffset = 0u;
+		uint32_t indexCapacity = 0u;
+	};
+	typedef std::unordered_map<glm::ivec3, ChunkRange> ChunkRanges;
+	/**
+	 * @brief The part of the face buffer of a volume that belongs to one chunk - the unused slots are marked
+	 * with voxel::VoxelFace::InvalidFace
+	 */
+	struct FaceRange {
+		uint32_t offset = 0u;
+		uint32_t capacity = 0u;
+	};
+	typedef std::unordered_map<glm::ivec3, FaceRange> FaceRanges;
+	/**
+	 * @brief The hardware occlusion query of a chunk. The result is fetched in one of the next frames to
+	 * not stall the pipeline.
+	 */
+	struct ChunkOcclusion {
+		video::Id query = video::InvalidId;
+		bool visible = true;
+		bool pending = false;
+	};
+	/**
+	 * @brief The triangle order of the transparent mesh of a chunk - it is only sorted again if the direction
+	 * from the camera to the chunk changed by more than cfg::VoxelSortAngle
+	 */
+	struct TransparencySort {
+		/**
+		 * @brief The direction from the eye to the chunk center the current order was sorted for
+		 */
+		glm::vec3 direction{0.0f};
+		/**
+		 * @brief Identifies the mesh the order belongs to - the results for a replaced mesh are dropped
+		 */
+		uint32_t generation = 0u;
+		bool sorted = false;
+		/**
+		 * @brief A sorting task for this chunk is running
+		 */
+		bool pending = false;
+	};
 	struct State {
 		bool _hidden = false;
 		bool _gray = false;
+		/**
+		 * @brief Volumes that are not part of the scene - like previews - are skipped by the pick pass
+		 */
+		bool _pickable = true;
 		int32_t _vertexBufferIndex[MeshType_Max] {-1, -1};
 		int32_t _indexBufferIndex[MeshType_Max] {-1, -1};
+		/**
+		 * @brief The bytes per index in the index buffers - volumes with less than 65536 vertices use 16 bit indices
+		 * @sa indexSizeFor()
+		 */
+		uint32_t _indexSize[MeshType_Max] {sizeof(voxel::IndexType), sizeof(voxel::IndexType)};
+		/**
+		 * @brief The first vertex and index of the buffers of this volume in the arena buffers
+		 */
+		uint32_t _arenaVertexOffset[MeshType_Max] {0u, 0u};
+		uint32_t _arenaIndexOffset[MeshType_Max] {0u, 0u};
+		/**
+		 * @brief The index of the per draw data of this instance in the current frame - @c -1 if not rendered
+		 */
+		int _drawSlot = -1;
 		glm::mat4 _model;
 		glm::vec3 _pivot;
 		video::Buffer _vertexBuffer[MeshType_Max];
 		int _reference = -1;
 		voxel::RawVolume* _rawVolume = nullptr;
 		core::Optional<voxel::Palette> _palette;
+		ChunkRanges _chunkRanges[MeshType_Max];
+		/**
+		 * @brief The detail level of the opaque chunk meshes that is currently uploaded into the buffer
+		 */
+		std::unordered_map<glm::ivec3, int> _chunkLods;
+		/**
+		 * @brief The occlusion state of the chunks of this instance - also for referenced volumes
+		 */
+		std::unordered_map<glm::ivec3, ChunkOcclusion> _occlusion;
+		/**
+		 * @brief The visible faces of the chunks if the quads are built in the vertex shader
+		 * @sa cfg::VoxelVertexPulling
+		 */
+		std::unordered_map<glm::ivec3, voxel::ChunkFaces> _chunkFaces;
+		/**
+		 * @brief The snapshot version of the chunk meshes that are currently used - the results of older
+		 * snapshots that finish later are dropped
+		 */
+		std::unordered_map<glm::ivec3, uint32_t> _chunkVersions;
+		std::unordered_map<glm::ivec3, TransparencySort> _transparencySort;
+		/**
+		 * @brief The results of snapshots that were taken before this version are dropped
+		 * @sa invalidateChunks()
+		 */
+		uint32_t _minChunkVersion = 0u;
+		video::Buffer _faceBuffer;
+		int32_t _faceBufferIndex[MeshType_Max] {-1, -1};
+		FaceRanges _faceRanges[MeshType_Max];
 
 		uint32_t indices(MeshType type) const {
-			return _vertexBuffer[type].elements(_indexBufferIndex[type], 1, sizeof(voxel::IndexType));
+			return _vertexBuffer[type].elements(_indexBufferIndex[type], 1, _indexSize[type]);
+		}
+
+		/**
+		 * @return The amount of face slots in the face buffer - including the unused ones
+		 */
+		uint32_t faces(MeshType type) const {
+			if (_faceBufferIndex[type] == -1) {
+				return 0u;
+			}
+			return _faceBuffer.elements(_faceBufferIndex[type], 1, sizeof(voxel::VoxelFace));
 		}
 
 		bool hasData() const {
-			return indices(MeshType_Opaque) > 0 || indices(MeshType_Transparency) > 0;
+			return indices(MeshType_Opaque) > 0 || indices(MeshType_Transparency) > 0 ||
+				   faces(MeshType_Opaque) > 0 || faces(MeshType_Transparency) > 0;
 		}
 	};
 	core::Array<State, MAX_VOLUMES> _state {};
 	typedef core::Array<voxel::Mesh*, MAX_VOLUMES> Meshes;
 	typedef std::unordered_map<glm::ivec3, Meshes> MeshesMap;
 	MeshesMap _meshes[MeshType_Max];
+	/**
+	 * @brief The downsampled opaque meshes - index 0 is the first level below the full resolution mesh
+	 */
+	MeshesMap _lodMeshes[MaxLODs - 1];
+	bool _lodsEnabled = false;
+	/**
+	 * @brief Upload the vertices as voxel::PackedVoxelVertex - only possible for the integral positions
+	 * of the cubic surface extractor
+	 */
+	bool _packedVertices = false;
+
+	/**
+	 * @brief The buffers of all volumes of one mesh type - to render them with one multi draw indirect call
+	 *
+	 * The vertex and index buffers of the volumes are copied on the gpu into the arena buffers. The draw
+	 * commands are built every frame for the visible chunks.
+	 */
+	struct Arena {
+		video::Buffer buffer;
+		int32_t vertexIndex = -1;
+		int32_t indexIndex = -1;
+		/**
+		 * @brief The draw slots for the instanced attribute - the base instance of a command selects the slot
+		 */
+		int32_t drawIdIndex = -1;
+		int32_t commandIndex = -1;
+		/**
+		 * @brief The arena buffers must be filled again with the buffers of all volumes
+		 */
+		bool dirty = true;
+	};
+	Arena _arena[MeshType_Max];
+	/**
+	 * @brief The shader storage buffers for the per draw data and the palettes of the multi draw indirect path
+	 */
+	video::Buffer _drawDataBuffer;
+	int32_t _drawDataIndex = -1;
+	int32_t _paletteDataIndex = -1;
+	bool _multiDrawIndirectSupported = false;
+	core::DynamicArray<video::DrawElementsIndirectCommand> _drawCommands;
+	core::DynamicArray<glm::vec4> _drawData;
+	/**
+	 * @brief The copy of the palette shader storage buffer - the material and glow colors of every palette slot
+	 */
+	core::DynamicArray<glm::vec4> _paletteData;
+	/**
+	 * @brief The content hash of the palette that was uploaded into the slot - the slots are kept across frames
+	 * and a slot is only overwritten if its palette is no longer used by any volume
+	 */
+	core::DynamicArray<uint64_t> _paletteSlotHashes;
+	/**
+	 * @brief The palettes of the current frame by slot - @c nullptr for the slots that are not used
+	 */
+	core::DynamicArray<const voxel::Palette *> _drawPalettes;
 
 	uint64_t _paletteHash = 0;
 
+	/**
+	 * @brief The size of the ring the vertex, index and face data is streamed through - larger uploads are
+	 * done directly
+	 */
+	static constexpr size_t StreamBufferSize = 32u * 1024u * 1024u;
+	video::StreamBuffer _streamBuffer;
+
 	shader::VoxelData _voxelData;
 
 	alignas(16) shader::VoxelData::FragData _voxelShaderFragData;
 	alignas(16) shader::VoxelData::VertData _voxelShaderVertData;
 
 	shader::VoxelShader& _voxelShader;
+	shader::VoxelindirectData _voxelIndirectData;
+	alignas(16) shader::VoxelindirectData::VertData _voxelIndirectVertData;
+	shader::VoxelindirectShader& _voxelIndirectShader;
+	shader::VoxelinstancedData _voxelInstancedData;
+	alignas(16) shader::VoxelinstancedData::VertData _voxelInstancedVertData;
+	alignas(16) shader::VoxelinstancedData::InstancesData _voxelInstancedInstancesData;
+	shader::VoxelinstancedShader& _voxelInstancedShader;
+	shader::VoxelpullingShader& _voxelPullingShader;
+	shader::VoxeloitShader& _voxelOITShader;
+	shader::VoxeloitcompositeShader& _voxelOITCompositeShader;
+	video::Buffer _oitQuad;
+	bool _oitSupported = false;
+	shader::VoxelpickShader& _voxelPickShader;
+	/**
+	 * @brief The target and the readback of the pass that renders the voxel below the mouse cursor
+	 */
+	PickBuffer _pickBuffer;
+	bool _pickSupported = false;
+	/**
+	 * @brief The mouse position of the next pick pass - see pick()
+	 */
+	glm::ivec2 _pickPixel{0};
+	bool _pickRequested = false;
+	PickResult _pickResult;
+	bool _hasPickResult = false;
+	bool _vertexPullingSupported = false;
+	/**
+	 * @brief Collects the faces of the vertex pulling path on the gpu
+	 * @sa cfg::VoxelComputeFaces
+	 */
+	FaceCompute _faceCompute;
+	bool _faceComputeSupported = false;
+	/**
+	 * @brief Ray marches the volumes instead of rendering the chunk meshes
+	 * @sa cfg::VoxelRayMarching
+	 */
+	BrickMapRenderer _brickMapRenderer;
+	bool _rayMarchingSupported = false;
+	/**
+	 * @brief The volumes are kept as brick maps - no meshes or face lists are extracted
+	 */
+	bool _rayMarchingActive = false;
+	/**
+	 * @brief The chunks are extracted as face lists instead of meshes
+	 */
+	bool _vertexPullingActive = false;
+	bool _instancingSupported = false;
+	/**
+	 * @brief Render the volumes with references with instanced draw calls in this frame
+	 */
+	bool _instancing = false;
+	/**
+	 * @brief The visible instances grouped by the volume they render - the instances of volume @c i are
+	 * in the range [_instanceOffsets[i], _instanceOffsets[i + 1]) of @c _instances
+	 */
+	core::Array<int, MAX_VOLUMES + 1> _instanceOffsets {};
+	core::Array<int, MAX_VOLUMES> _instances {};
 	shader::ShadowmapData _shadowMapUniformBlock;
 	shader::ShadowmapShader& _shadowMapShader;
-	voxelrender::Shadow _shadow;
+	/**
+	 * @brief Counts the mesh changes that invalidate the shadow maps of the render contexts - see
+	 * RenderContext::shadowRevision
+	 */
+	uint32_t _shadowRevision = 1u;
+	/**
+	 * @brief The revision of the last change that invalidated all cascades
+	 */
+	uint32_t _shadowFullRevision = 1u;
+	struct ShadowChunk {
+		uint32_t revision;
+		int idx;
+		glm::ivec3 mins;
+	};
+	/**
+	 * @brief The chunks that were updated since the last full invalidation - every render context only renders the
+	 * cascades again that these chunks cast a shadow into
+	 */
+	core::DynamicArray<ShadowChunk> _shadowChunks;
+	static constexpr size_t MaxShadowChunks = 1024u;
+	glm::mat4 _lightView{1.0f};
+	bool _hasLightView = false;
 
 	core::VarPtr _meshSize;
+	core::VarPtr _meshMode;
+	core::VarPtr _lodThreshold;
+	core::VarPtr _optimizeMesh;
+	core::VarPtr _occlusionCulling;
+	core::VarPtr _multiDrawIndirect;
+	core::VarPtr _vertexPulling;
+	core::VarPtr _computeFaces;
+	core::VarPtr _rayMarching;
+	core::VarPtr _orderIndependentTransparency;
 	core::VarPtr _shadowMap;
 	core::VarPtr _bloom;
 
@@ -113,18 +412,85 @@ protected:
 		}
 		voxel::Region region;
 		int idx;
+		/**
+		 * @brief The priority of the chunk - see prioritizeExtractions()
+		 */
+		bool visible = true;
+		float distance = 0.0f;
 	};
 	using RegionQueue = core::DynamicArray<ExtractRegion>;
 	RegionQueue _extractRegions;
+	/**
+	 * @brief @c false if regions were added or the camera changed since the last prioritizeExtractions() call
+	 */
+	bool _extractRegionsSorted = true;
+	/**
+	 * @brief The camera of the last render() call - the chunks in front of it are extracted first
+	 */
+	glm::mat4 _priorityViewProjection{1.0f};
+	glm::vec3 _priorityEye{0.0f};
+	bool _hasPriorityCamera = false;
+	core::VarPtr _extractionBudget;
+	core::VarPtr _uploadBudget;
+	core::VarPtr _meshCache;
+	core::VarPtr _sortAngle;
+	core::VarPtr _sortBudget;
+
+	/**
+	 * @brief The sorted indices of a transparent chunk mesh - the sorting tasks work on a copy of the mesh, the
+	 * currently uploaded order is rendered until the result is swapped in on the main thread
+	 */
+	struct SortResult {
+		glm::ivec3 mins{0};
+		int idx = -1;
+		uint32_t generation = 0u;
+		/**
+		 * @brief @c false if the order didn't change - the indices are empty then
+		 */
+		bool changed = false;
+		voxel::IndexArray indices;
+	};
+	core::ConcurrentQueue<SortResult> _sortQueue;
+	uint32_t _sortGeneration = 0u;
+	/**
+	 * @brief Hands the transparent chunk meshes that are seen from a different direction than their current order
+	 * was sorted for to the sorting tasks - up to cfg::VoxelSortBudget triangles per frame
+	 */
+	void sortTransparentChunks(const video::Camera &camera);
+	/**
+	 * @brief Uploads the indices of the finished sorting tasks
+	 */
+	void applySortResults();
 
 	struct ExtractionCtx {
 		ExtractionCtx() {}
-		ExtractionCtx(const glm::ivec3& _mins, int _idx, voxel::ChunkMesh&& _mesh) :
-				mins(_mins), idx(_idx), mesh(_mesh) {
+		ExtractionCtx(const glm::ivec3& _mins, int _idx, uint32_t _version, voxel::ChunkMesh&& _mesh, voxel::Mesh *_lods = nullptr) :
+				mins(_mins), idx(_idx), version(_version), mesh(_mesh) {
+			if (_lods != nullptr) {
+				for (int i = 0; i < MaxLODs - 1; ++i) {
+					lods[i] = core::move(_lods[i]);
+				}
+			}
+		}
+		ExtractionCtx(const glm::ivec3& _mins, int _idx, uint32_t _version, voxel::ChunkFaces&& _faces) :
+				mins(_mins), idx(_idx), version(_version), mesh(0, 0), faces(core::move(_faces)), faceList(true) {
 		}
 		glm::ivec3 mins {};
 		int idx = -1;
+		/**
+		 * @brief The chunk version of the volume snapshot this result was extracted from
+		 */
+		uint32_t version = 0u;
 		voxel::ChunkMesh mesh;
+		/**
+		 * @brief The downsampled opaque meshes - empty if the level of detail is disabled
+		 */
+		voxel::Mesh lods[MaxLODs - 1];
+		/**
+		 * @brief The visible faces of the chunk - only filled if @c faceList is @c true
+		 */
+		voxel::ChunkFaces faces;
+		bool faceList = false;
 
 		inline bool operator<(const ExtractionCtx &rhs) const {
 			return idx < rhs.idx;
@@ -133,20 +499,280 @@ protected:
 	core::ThreadPool _threadPool { core::halfcpus(), "VolumeRndr" };
 	core::AtomicInt _runningExtractorTasks { 0 };
 	core::ConcurrentPriorityQueue<ExtractionCtx> _pendingQueue;
+	/**
+	 * @brief Version of the last volume snapshot that was handed to an extractor task - only touched on the main thread
+	 */
+	uint32_t _chunkVersion = 0u;
+	/**
+	 * @brief Drops the results of all extractions of the given volume that are still running - without waiting for them
+	 */
+	void invalidateChunks(int idx);
 	voxel::Region calculateExtractRegion(int x, int y, int z, const glm::ivec3& meshSize) const;
+	/**
+	 * @brief Sorts the queued regions - the visible chunks first, ordered by their distance to the camera of the
+	 * last render() call
+	 */
+	void prioritizeExtractions();
+	/**
+	 * @brief Copies the region of the volume and hands it to an extractor task
+	 */
+	void scheduleExtraction(const ExtractRegion &entry);
+	/**
+	 * @brief Schedules the queued regions with the highest priority - only as many as are needed to keep the
+	 * workers busy and only as long as the main thread time budget of this frame is not used up
+	 * @sa cfg::VoxelExtractionBudget
+	 */
+	void scheduleBudgetedExtractions();
+	/**
+	 * @return The amount of bytes of the chunk meshes or faces of the given result that are uploaded
+	 */
+	size_t uploadSize(const ExtractionCtx &result) const;
 	void updatePalette(int idx);
+	const voxel::Palette &volumePalette(int idx) const;
+	/**
+	 * @return The mesh of the given chunk in the detail level that was selected for the chunk
+	 */
+	const voxel::Mesh *chunkMesh(int idx, MeshType type, const glm::ivec3 &mins) const;
+	void deleteChunkMeshes(int idx, const glm::ivec3 &mins);
+	/**
+	 * @brief Delete the meshes of all chunks of the given volume and clear its vertex buffers
+	 */
+	void deleteVolumeMeshes(int idx);
+	/**
+	 * @brief Delete the face lists of all chunks of the given volume and clear its face buffers
+	 */
+	void deleteVolumeFaces(int idx);
+	/**
+	 * @brief Selects the detail level of every opaque chunk by its projected screen size and updates the buffer
+	 * ranges of the chunks whose level changed
+	 */
+	void updateLODs(const video::Camera &camera);
+	/**
+	 * @brief Schedule the extraction of all volumes - e.g. after the extraction settings were changed
+	 */
+	void extractAllVolumes();
+
+	/**
+	 * @return The frustum of the given view projection matrix in the volume space of the given instance
+	 */
+	math::Frustum volumeFrustum(int idx, const glm::mat4 &viewProjection) const;
+	bool isChunkVisible(const math::Frustum &frustum, const glm::ivec3 &mins) const;
+	/**
+	 * @brief Remembers the updated chunk for the shadow maps of the render contexts
+	 * @sa updateShadowDirty()
+	 */
+	void markShadowDirty(int idx, const glm::ivec3 &mins);
+	/**
+	 * @brief Invalidates all shadow cascades of all render contexts
+	 */
+	void markShadowsDirty();
+	/**
+	 * @brief A hash over the transforms, visibility and references of all volumes - the shadow maps of a render
+	 * context are rendered again if this changes
+	 */
+	uint64_t shadowStateHash() const;
+	/**
+	 * @brief Marks the cascades of the given shadow dirty that the changes since its last render call cast a shadow
+	 * into - the given chunk of the volume or any instance that references it
+	 */
+	void updateShadowDirty(RenderContext &renderContext);
+	/**
+	 * @brief Issue the draw calls for all chunks of the given instance that are inside the frustum. The
+	 * adjacent chunk ranges are merged into one draw call.
+	 * @note The vertex buffer must already be bound.
+	 * @param occlusionQueries Draw every chunk on its own with an occlusion query. The chunks that were
+	 * occluded are only collected to render their occlusion proxies after the opaque pass.
+	 * @return The amount of chunks that were drawn
+	 */
+	int drawChunks(int idx, MeshType type, const math::Frustum &frustum, bool occlusionQueries = false);
+	/**
+	 * @brief Render the occluded chunks without color and depth writes to find out whether they got visible again
+	 */
+	void renderOcclusionProxies(const video::Camera &camera);
+	void resetOcclusion();
+	void updateVoxelShaderVertData(int idx, const video::Camera &camera);
+
+	/**
+	 * @brief Group the visible instances by the volume they render
+	 */
+	void updateInstances();
+	/**
+	 * @return @c true if the given instance is rendered by renderInstances()
+	 */
+	bool isInstanced(int idx) const;
+	/**
+	 * @brief Render all volumes that are referenced by other instances with instanced draw calls
+	 */
+	void renderInstances(MeshType type, const video::Camera &camera, video::PolygonMode mode);
+
+	void addVertexAttributes(video::Buffer &buffer, int32_t bufferIndex, int posLocation, int posComponents,
+							 int infoLocation, int infoComponents) const;
+	/**
+	 * @brief Configure the vertex attributes of all buffers for the current vertex format
+	 */
+	void setupVertexAttributes();
+	/**
+	 * @return The size of one vertex in the gpu buffers
+	 */
+	size_t vertexSize() const;
+
+	bool initArena();
+	/**
+	 * @brief Copy the buffers of all volumes into the arena buffers of the given mesh type
+	 */
+	bool rebuildArena(MeshType type);
+	/**
+	 * @brief Copy the updated range of a chunk into the arena - or mark the arena as dirty if this isn't possible
+	 */
+	void updateArenaForChunk(int idx, MeshType type, const ChunkRange &range);
+	/**
+	 * @return The palette slot that holds the palette with the given content hash or @c -1
+	 */
+	int drawPaletteSlot(uint64_t hash) const;
+	/**
+	 * @brief Assign a palette slot to every palette of the visible instances. Only the palettes that are not yet
+	 * uploaded are converted and only their slots are updated in the gpu buffer.
+	 */
+	void updateDrawPalettes();
+	/**
+	 * @brief Assign the draw slots for the visible instances and upload their model data
+	 * @return The amount of draw slots
+	 */
+	int updateDrawData();
+	/**
+	 * @brief Issue one multi draw indirect call for the visible chunks of all volumes of the given type
+	 */
+	void drawArena(MeshType type, const glm::mat4 &viewProjection);
+	void renderMultiDrawIndirect(const video::Camera &camera, video::PolygonMode mode);
+	bool useMultiDrawIndirect() const;
+	/**
+	 * @brief The bytes per index for a volume buffer with the given amount of vertices - the arena of the multi draw
+	 * indirect path needs the same index type for all volumes and always uses 32 bit indices
+	 */
+	size_t indexSizeFor(size_t vertices) const;
+
+	/**
+	 * @return @c true if the volumes are polygonized by one of the smooth surface extractors - their vertices are not
+	 * integral and they don't have axis aligned voxel faces
+	 */
+	bool useSmoothMesh() const;
+	/**
+	 * @return @c true if the vertices can be uploaded as voxel::PackedVoxelVertex - they must be integral and all
+	 * volume regions must fit into the 16 bit position components. Otherwise the full vertex format is used for all
+	 * volumes, as the vertex attributes are shared.
+	 */
+	bool usePackedVertices() const;
+	/**
+	 * @return @c true if the cubic volumes are extracted as face lists and rendered by vertex pulling
+	 */
+	bool useVertexPulling() const;
+	/**
+	 * @return @c true if the faces of the vertex pulling path are collected by a compute shader on the main thread
+	 */
+	bool useFaceCompute() const;
+	bool updateFaceBufferForVolume(int idx, MeshType type);
+	/**
+	 * @return @c true if the volumes are ray marched instead of extracting meshes for them
+	 */
+	bool useRayMarching() const;
+	void renderRayMarching(const video::Camera &camera);
+	/**
+	 * @brief Only upload the faces of the given chunk into the already existing face buffer of the volume
+	 * @return @c false if the faces don't fit into the reserved range - a full buffer update is needed then
+	 */
+	bool updateFaceBufferForChunk(int idx, MeshType type, const glm::ivec3 &mins);
+	/**
+	 * @brief Issue the draw calls for the faces of all chunks of the given instance that are inside the frustum
+	 * @note The face buffer must already be bound.
+	 */
+	void drawFaces(int idx, MeshType type, const math::Frustum &frustum);
+	void renderVertexPulling(const video::Camera &camera, video::PolygonMode mode);
+
+	/**
+	 * @return @c true if the transparent meshes are blended without sorting them in this frame
+	 */
+	bool useOIT(const RenderContext &renderContext) const;
+	/**
+	 * @brief Accumulate the transparent chunks in the order independent transparency targets and blend
+	 * the result over the opaque scene
+	 */
+	void renderTransparencyOIT(RenderContext &renderContext, const video::Camera &camera, video::PolygonMode mode);
+
+	/**
+	 * @return @c true if the hovered voxel can be picked on the gpu - the pick pass needs the cubic meshes of the
+	 * per volume buffers
+	 */
+	bool usePicking() const;
+	/**
+	 * @brief Renders the pixel below the mouse cursor into the pick buffer and starts the readback
+	 */
+	void renderPick(const video::Camera &camera);
+	/**
+	 * @brief Fetches the readbacks of the pick buffer that the gpu finished
+	 */
+	void updatePickResults();
+
+	struct OcclusionProxy {
+		OcclusionProxy(int _idx, const glm::ivec3 &_mins) : idx(_idx), mins(_mins) {
+		}
+		int idx;
+		glm::ivec3 mins;
+	};
+	core::DynamicArray<OcclusionProxy> _occlusionProxies;
+	/**
+	 * @brief The bounding boxes of the chunks that are rendered for the occlusion queries of the proxies - a query
+	 * doesn't need the chunk mesh, 36 indices per chunk are enough
+	 */
+	video::Buffer _occlusionBoxBuffer;
+	int32_t _occlusionBoxVertexIndex = -1;
+	int32_t _occlusionBoxIndexIndex = -1;
+	core::DynamicArray<voxel::VoxelVertex> _occlusionBoxVertices;
+	core::DynamicArray<uint32_t> _occlusionBoxIndices;
+	core::DynamicArray<ChunkRange> _visibleRanges;
+	core::DynamicArray<FaceRange> _visibleFaceRanges;
 	bool updateBufferForVolume(int idx, MeshType type);
+	/**
+	 * @brief Uploads the data that the given function writes - through the stream buffer if it is available
+	 * @param resize Allocate the buffer with the given size - otherwise only the range at @c offset is updated
+	 */
+	template<class FUNC>
+	bool uploadBuffer(video::Buffer &buffer, int32_t bufferIndex, size_t offset, size_t size, bool resize, FUNC &&fill);
+	/**
+	 * @brief Only upload the mesh of the given chunk into the already existing buffer of the volume
+	 * @param vertices @c false if only the order of the triangles changed
+	 * @return @c false if the mesh doesn't fit into the reserved range - a full buffer update is needed then
+	 */
+	bool updateBufferForChunk(int idx, MeshType type, const glm::ivec3 &mins, bool vertices = true);
+	void clearBuffer(int idx, MeshType type);
 
 public:
 	RawVolumeRenderer();
 
 	void render(RenderContext &renderContext, const video::Camera& camera, bool shadow = true);
+	/**
+	 * @brief Requests to render the voxel at the given mouse position into the pick buffer with the next render() call
+	 * @param[in] pixel The mouse position in the same coordinates as for video::Camera::mouseRay()
+	 * @return @c false if the voxels can't be picked on the gpu with the current settings - do a cpu raycast then
+	 * @sa pickResult()
+	 */
+	bool pick(const glm::ivec2 &pixel);
+	/**
+	 * @brief The newest result of the pick passes - the results lag behind the requests by about one frame
+	 * @return @c false if no pick pass was finished yet
+	 * @sa pick()
+	 */
+	bool pickResult(PickResult &result);
 	void hide(int idx, bool hide);
 	bool hidden(int idx) const;
 	void gray(int idx, bool gray);
 	bool grayed(int idx) const;
+	void setPickable(int idx, bool pickable);
 
 	int pendingExtractions() const;
+	/**
+	 * @return @c true if regions are waiting for the extraction or extracted meshes are not yet uploaded
+	 */
+	bool hasPendingWork() const;
 	void clearPendingExtractions();
 	void waitForPendingExtractions();
 
@@ -174,6 +800,15 @@ public:
 
 	bool extractRegion(int idx, const voxel::Region& region);
 
+	/**
+	 * @brief Picks the coarsest detail level whose voxels don't cover more than the given amount of pixels
+	 * @param[in] pixelsPerVoxel The projected size of a full resolution voxel on the screen
+	 * @param[in] threshold The max allowed projected size of a downsampled voxel - @c 0 disables the
+	 * level of detail - see @c cfg::VoxelLODThreshold
+	 * @return The detail level in the range [0, MaxLODs)
+	 */
+	static int lodForVoxelSize(float pixelsPerVoxel, float threshold);
+
 	/**
 	 * @param[in,out] volume The RawVolume pointer
 	 * @return The old volume that was managed by the class, @c nullptr if there was none
@@ -212,7 +847,16 @@ public:
 	 */
 	bool init();
 
+	/**
+	 * @brief Hands the given amount of queued regions to the extractor tasks - without any budget
+	 * @return @c false if there are no queued regions left
+	 */
 	bool scheduleExtractions(size_t maxExtraction = 1);
+	/**
+	 * @brief Schedules the extractions and uploads the finished meshes - both within the budgets of a frame
+	 * @sa cfg::VoxelExtractionBudget
+	 * @sa cfg::VoxelUploadBudget
+	 */
 	void update();
 
 	/**
@@ -228,6 +872,10 @@ inline int RawVolumeRenderer::pendingExtractions() const {
 	return (int)_extractRegions.size();
 }
 
+inline bool RawVolumeRenderer::hasPendingWork() const {
+	return !_extractRegions.empty() || _runningExtractorTasks > 0 || !_pendingQueue.empty();
+}
+
 inline voxel::RawVolume* RawVolumeRenderer::volume(int idx) {
 	if (idx < 0 || idx >= MAX_VOLUMES) {
 		return nullptr;
@@ -63,6 +63,31 @@ static inline int getNodeId(int volumeIdx) {
 	return volumeIdx;
 }
 
+bool SceneGraphRenderer::pickResult(PickResult &result) {
+	if (!_renderer.pickResult(result)) {
+		return false;
+	}
+	if (result.didHit()) {
+		result.idx = getNodeId(result.idx);
+	}
+	return true;
+}
+
+void SceneGraphRenderer::setPreviewVolume(voxel::RawVolume *volume, voxel::Palette *palette) {
+	if (volume == nullptr) {
+		if (_renderer.setVolume(PreviewVolume, nullptr, nullptr, true) != nullptr) {
+			_renderer.updateBufferForVolume(PreviewVolume);
+		}
+		return;
+	}
+	_renderer.setVolume(PreviewVolume, volume, palette, true);
+	_renderer.setModelMatrix(PreviewVolume, glm::mat4(1.0f), glm::vec3(0.0f));
+	_renderer.setPickable(PreviewVolume, false);
+	_renderer.hide(PreviewVolume, _sceneMode);
+	_renderer.gray(PreviewVolume, false);
+	_renderer.extractRegion(PreviewVolume, volume->region());
+}
+
 bool SceneGraphRenderer::empty(scenegraph::SceneGraphNode &node) {
 	return _renderer.empty(getVolumeId(node));
 }
@@ -85,6 +110,7 @@ void SceneGraphRenderer::shutdown() {
 }
 
 void SceneGraphRenderer::clear() {
+	_prepareState.valid = false;
 	_renderer.clearPendingExtractions();
 	for (int i = 0; i < RawVolumeRenderer::MAX_VOLUMES; ++i) {
 		const int nodeId = getNodeId(i);
@@ -143,39 +169,94 @@ video::Camera toCamera(const glm::ivec2 &size, const scenegraph::SceneGraphNodeC
 	return camera;
 }
 
+bool SceneGraphRenderer::nodeChanged(const scenegraph::SceneGraphNode &node, bool full) {
+	const int id = node.id();
+	if (id >= (int)_nodeRevisions.size()) {
+		_nodeRevisions.resize(id + 1);
+		full = true;
+	}
+	const uint32_t revision = node.revision();
+	if (!full && _nodeRevisions[id] == revision) {
+		return false;
+	}
+	_nodeRevisions[id] = revision;
+	return true;
+}
+
 void SceneGraphRenderer::prepare(const scenegraph::SceneGraph &sceneGraph, scenegraph::FrameIndex frame, bool hideInactive,
 								 bool grayInactive) {
-	// remove those volumes that are no longer part of the scene graph
-	for (int i = 0; i < RawVolumeRenderer::MAX_VOLUMES; ++i) {
-		const int nodeId = getNodeId(i);
-		if (!sceneGraph.hasNode(nodeId)) {
-			if (_renderer.setVolume(nodeId, nullptr, nullptr, true) != nullptr) {
-				Log::debug("%i is no longer part of the scene graph - remove from renderer", nodeId);
+	core_trace_scoped(SceneGraphRendererPrepare);
+	const int activeNode = sceneGraph.activeNode();
+	// only nodes that changed since the last call are touched - unless the structure of the scene graph or one
+	// of the parameters changed
+	const bool full = !_prepareState.valid || _prepareState.sceneGraphRevision != sceneGraph.revision() ||
+					  _prepareState.frame != frame || _prepareState.activeNode != activeNode ||
+					  _prepareState.hideInactive != hideInactive || _prepareState.grayInactive != grayInactive;
+	// the viewports in scene mode and edit mode share the volumes - switching between them only changes the
+	// transforms and the references
+	const bool modeChanged = full || _prepareState.sceneMode != _sceneMode;
+	_prepareState.sceneMode = _sceneMode;
+	if (full) {
+		_prepareState.valid = true;
+		_prepareState.sceneGraphRevision = sceneGraph.revision();
+		_prepareState.frame = frame;
+		_prepareState.activeNode = activeNode;
+		_prepareState.hideInactive = hideInactive;
+		_prepareState.grayInactive = grayInactive;
+
+		// remove those volumes that are no longer part of the scene graph
+		for (int i = 0; i < PreviewVolume; ++i) {
+			const int nodeId = getNodeId(i);
+			if (!sceneGraph.hasNode(nodeId)) {
+				if (_renderer.setVolume(nodeId, nullptr, nullptr, true) != nullptr) {
+					Log::debug("%i is no longer part of the scene graph - remove from renderer", nodeId);
+				}
 			}
 		}
 	}
-	_cameras.clear();
+	if (modeChanged) {
+		// the references are only rendered in scene mode - they are set up again below
+		_renderer.resetReferences();
+		if (_renderer.volume(PreviewVolume) != nullptr) {
+			_renderer.hide(PreviewVolume, _sceneMode);
+		}
+	}
+
+	bool camerasChanged = full;
 	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Camera); iter != sceneGraph.end(); ++iter) {
-		const scenegraph::SceneGraphNodeCamera &cameraNode = scenegraph::toCameraNode(*iter);
-		if (!cameraNode.visible()) {
-			continue;
+		camerasChanged |= nodeChanged(*iter, full);
+	}
+	if (camerasChanged) {
+		_cameras.clear();
+		for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Camera); iter != sceneGraph.end(); ++iter) {
+			const scenegraph::SceneGraphNodeCamera &cameraNode = scenegraph::toCameraNode(*iter);
+			if (!cameraNode.visible()) {
+				continue;
+			}
+			const glm::ivec2 size(cameraNode.width(), cameraNode.height());
+			video::Camera camera = toCamera(size, cameraNode);
+			_cameras.push_back(camera);
 		}
-		const glm::ivec2 size(cameraNode.width(), cameraNode.height());
-		video::Camera camera = toCamera(size, cameraNode);
-		_cameras.push_back(camera);
 	}
 
-	const int activeNode = sceneGraph.activeNode();
 	for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::Model); iter != sceneGraph.end(); ++iter) {
 		scenegraph::SceneGraphNode &node = *iter;
 		const int id = getVolumeId(node);
-		if (id >= RawVolumeRenderer::MAX_VOLUMES) {
+		if (id >= PreviewVolume) {
 			continue;
 		}
-		voxel::RawVolume *v = _renderer.volume(id);
-		_renderer.setVolume(id, node, true);
-		if (v != node.volume()) {
-			_renderer.extractRegion(id, node.region());
+		const bool changed = nodeChanged(node, full);
+		if (!changed && !modeChanged) {
+			continue;
+		}
+		if (changed) {
+			voxel::RawVolume *v = _renderer.volume(id);
+			_renderer.setVolume(id, node, true);
+			// the node might have been a model reference before
+			_renderer.setVolumeReference(id, -1);
+			if (v != node.volume()) {
+				_renderer.extractRegion(id, node.region());
+			}
 		}
 		if (_sceneMode) {
 			const scenegraph::SceneGraphTransform &transform = node.transformForFrame(frame);
@@ -184,6 +265,9 @@ void SceneGraphRenderer::prepare(const scenegraph::SceneGraph &sceneGraph, scene
 		} else {
 			_renderer.setModelMatrix(id, glm::mat4(1.0f), glm::vec3(0.0f));
 		}
+		if (!changed) {
+			continue;
+		}
 		if (hideInactive) {
 			_renderer.hide(id, id != activeNode);
 		} else {
@@ -197,11 +281,13 @@ void SceneGraphRenderer::prepare(const scenegraph::SceneGraph &sceneGraph, scene
 	}
 
 	if (_sceneMode) {
-		_renderer.resetReferences();
 		for (auto iter = sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != sceneGraph.end(); ++iter) {
 			const scenegraph::SceneGraphNode &node = *iter;
 			const int id = getVolumeId(node);
-			if (id >= RawVolumeRenderer::MAX_VOLUMES) {
+			if (id >= PreviewVolume) {
+				continue;
+			}
+			if (!nodeChanged(node, full) && !modeChanged) {
 				continue;
 			}
 			const int referencedId = getVolumeId(node.reference());
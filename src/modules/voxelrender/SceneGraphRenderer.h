@@ -25,12 +25,38 @@ scenegraph::SceneGraphNodeCamera toCameraNode(const video::Camera& camera);
  * @brief Rendering of a voxel::SceneGraph
  */
 class SceneGraphRenderer : public core::NonCopyable {
+public:
+	/**
+	 * @brief The renderer slot of the preview volume - the nodes with higher ids are not rendered
+	 * @sa setPreviewVolume()
+	 */
+	static constexpr int PreviewVolume = RawVolumeRenderer::MAX_VOLUMES - 1;
+
 protected:
 	RawVolumeRenderer _renderer;
 	render::CameraFrustum _cameraRenderer;
 	core::DynamicArray<video::Camera> _cameras;
 	bool _sceneMode = true;
 
+	/**
+	 * @brief The state of the last @c prepare() call - nodes whose @c SceneGraphNode::revision() didn't change
+	 * since then are skipped as long as the scene graph structure and the prepare parameters are the same.
+	 */
+	struct PrepareState {
+		bool valid = false;
+		uint32_t sceneGraphRevision = 0u;
+		scenegraph::FrameIndex frame = 0;
+		int activeNode = -1;
+		bool hideInactive = false;
+		bool grayInactive = false;
+		bool sceneMode = true;
+	};
+	PrepareState _prepareState;
+	/** node revisions of the last prepare() call - indexed by node id */
+	core::DynamicArray<uint32_t> _nodeRevisions;
+
+	bool nodeChanged(const scenegraph::SceneGraphNode &node, bool full);
+
 public:
 	void construct();
 	bool init();
@@ -49,9 +75,42 @@ public:
 	 * @param waitPending Wait for pending extractions and update the buffers before doing the rendering. If this is false, you have to call @c update() manually!
 	 */
 	void render(RenderContext &renderContext, const video::Camera& camera, bool shadow = true, bool waitPending = false);
+	/**
+	 * @brief Requests to pick the voxel at the given mouse position on the gpu with the next render() call
+	 * @return @c false if the voxels can't be picked on the gpu
+	 * @sa RawVolumeRenderer::pick()
+	 */
+	bool pick(const glm::ivec2 &pixel);
+	/**
+	 * @param[out] result The newest pick result - the index is the node id of the hit node
+	 * @sa RawVolumeRenderer::pickResult()
+	 */
+	bool pickResult(PickResult &result);
+	/**
+	 * @brief Renders the given volume in edit mode on top of the nodes - e.g. the shape of a modifier before it is
+	 * executed. The preview is not pickable and is hidden in scene mode.
+	 * @param volume The volume is not owned by the renderer and must stay valid until it is replaced. Use
+	 * @c nullptr to remove the preview.
+	 * @param palette Must stay valid as long as the volume is set
+	 */
+	void setPreviewVolume(voxel::RawVolume *volume, voxel::Palette *palette);
 	void clear();
+	int pendingExtractions() const;
+	bool hasPendingWork() const;
 };
 
+inline int SceneGraphRenderer::pendingExtractions() const {
+	return _renderer.pendingExtractions();
+}
+
+inline bool SceneGraphRenderer::hasPendingWork() const {
+	return _renderer.hasPendingWork();
+}
+
+inline bool SceneGraphRenderer::pick(const glm::ivec2 &pixel) {
+	return _renderer.pick(pixel);
+}
+
 inline void SceneGraphRenderer::setSceneMode(bool sceneMode) {
 	_sceneMode = sceneMode;
 }
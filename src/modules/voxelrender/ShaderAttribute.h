@@ -41,6 +41,34 @@ inline video::Attribute getInfoVertexAttribute(uint32_t bufferIndex, uint32_t at
 	return attrib;
 }
 
+/**
+ * @brief The position attribute for voxel::PackedVoxelVertex - the integer components are converted to float
+ */
+inline video::Attribute getPackedPositionVertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation, int components) {
+	video::Attribute attrib;
+	attrib.bufferIndex = (int32_t)bufferIndex;
+	attrib.location = (int32_t)attributeLocation;
+	attrib.stride = sizeof(voxel::PackedVoxelVertex);
+	attrib.size = components;
+	attrib.type = video::mapType<decltype(voxel::PackedVoxelVertex::x)>();
+	attrib.normalized = false;
+	attrib.offset = offsetof(voxel::PackedVoxelVertex, x);
+	return attrib;
+}
+
+inline video::Attribute getPackedInfoVertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation, int components) {
+	static_assert(offsetof(voxel::PackedVoxelVertex, info) + 1 == offsetof(voxel::PackedVoxelVertex, colorIndex), "Layout change of PackedVoxelVertex without change in upload");
+	video::Attribute attrib;
+	attrib.bufferIndex = (int32_t)bufferIndex;
+	attrib.location = (int32_t)attributeLocation;
+	attrib.stride = sizeof(voxel::PackedVoxelVertex);
+	attrib.size = components;
+	attrib.type = video::mapType<decltype(voxel::PackedVoxelVertex::info)>();
+	attrib.typeIsInt = true;
+	attrib.offset = offsetof(voxel::PackedVoxelVertex, info);
+	return attrib;
+}
+
 inline video::Attribute getOffsetVertexAttribute(uint32_t bufferIndex, uint32_t attributeLocation, int components) {
 	video::Attribute voxelAttributeOffsets;
 	voxelAttributeOffsets.bufferIndex = (int32_t)bufferIndex;
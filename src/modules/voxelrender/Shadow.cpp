@@ -23,6 +23,8 @@
 
 namespace voxelrender {
 
+static_assert(shader::VoxelShaderConstants::getMaxDepthBuffers() <= 32, "The dirty cascades are tracked in a 32 bit mask");
+
 Shadow::~Shadow() {
 	core_assert_msg(_parameters.maxDepthBuffers == -1, "Shadow::shutdown() wasn't called");
 }
@@ -44,6 +46,7 @@ bool Shadow::init(const ShadowParameters& parameters) {
 		Log::error("Failed to init the depthbuffer");
 		return false;
 	}
+	markDirty();
 
 	return true;
 }
@@ -164,10 +167,15 @@ void Shadow::render(const funcRender& renderCallback, bool clearDepthBuffer) {
 	video::colorMask(false, false, false, false);
 	_depthBuffer.bind(false);
 	for (int i = 0; i < _parameters.maxDepthBuffers; ++i) {
+		if (_parameters.cacheCascades && !dirty(i) && _renderedCascades[i] == _cascades[i]) {
+			continue;
+		}
 		_depthBuffer.bindTextureAttachment(video::FrameBufferAttachment::Depth, i, clearDepthBuffer);
 		if (!renderCallback(i, _cascades[i])) {
 			break;
 		}
+		_renderedCascades[i] = _cascades[i];
+		_dirtyCascades &= ~(1u << (uint32_t)i);
 	}
 	_depthBuffer.unbind();
 	video::colorMask(true, true, true, true);
@@ -187,6 +195,7 @@ void Shadow::setPosition(const glm::vec3& eye, const glm::vec3& center, const gl
 
 void Shadow::setLightViewMatrix(const glm::mat4& lightView) {
 	_lightView = lightView;
+	markDirty();
 	//_sunDirection = normalize(center - sunPos);
 	_sunDirection = glm::vec3(glm::column(glm::inverse(_lightView), 2));
 }
@@ -36,6 +36,11 @@ struct ShadowParameters {
 	float shadowBias = 0.09f;
 	/** Used to slice the camera frustum */
 	float sliceWeight = -0.3f;
+	/**
+	 * Only render a cascade again if its matrix changed or it was marked dirty - the depth maps of the other cascades
+	 * are kept from the previous frames
+	 */
+	bool cacheCascades = true;
 };
 
 /**
@@ -50,6 +55,10 @@ private:
 	glm::vec3 _sunDirection;
 	glm::mat4 _lightView;
 	Cascades _cascades;
+	/** the matrices the depth maps of the cascades were rendered with */
+	Cascades _renderedCascades;
+	/** one bit per cascade that has to be rendered again */
+	uint32_t _dirtyCascades = 0u;
 	Distances _distances;
 	video::FrameBuffer _depthBuffer;
 	ShadowParameters _parameters;
@@ -69,8 +78,22 @@ public:
 
 	bool bind(video::TextureUnit unit);
 
+	/**
+	 * @brief Renders the depth maps of the cascades that are dirty or whose matrix changed since they were rendered
+	 * @note If @c ShadowParameters::cacheCascades is disabled, all cascades are rendered
+	 */
 	void render(const funcRender& renderCallback, bool clearDepthBuffer = true);
 
+	/**
+	 * @brief Forces all cascades to get rendered again in the next render() call
+	 */
+	void markDirty();
+	/**
+	 * @brief Forces the given cascade to get rendered again in the next render() call
+	 */
+	void markDirty(int cascade);
+	bool dirty(int cascade) const;
+
 	void setPosition(const glm::vec3& eye, const glm::vec3& center, const glm::vec3& up);
 	void setLightViewMatrix(const glm::mat4& lightView);
 
@@ -81,6 +104,7 @@ public:
 	const Cascades& cascades() const;
 	const Distances& distances() const;
 	const glm::vec3& sunDirection() const;
+	const glm::mat4& lightView() const;
 	const glm::ivec2& dimension() const;
 	glm::vec3 sunPosition() const;
 };
@@ -101,6 +125,22 @@ inline const glm::vec3& Shadow::sunDirection() const {
 	return _sunDirection;
 }
 
+inline const glm::mat4& Shadow::lightView() const {
+	return _lightView;
+}
+
+inline void Shadow::markDirty() {
+	_dirtyCascades = ~0u;
+}
+
+inline void Shadow::markDirty(int cascade) {
+	_dirtyCascades |= 1u << (uint32_t)cascade;
+}
+
+inline bool Shadow::dirty(int cascade) const {
+	return (_dirtyCascades & (1u << (uint32_t)cascade)) != 0u;
+}
+
 inline ShadowParameters& Shadow::parameters() {
 	return _parameters;
 }
@@ -0,0 +1,270 @@
+/**
+ * @file
+ */
+
+#include "SoftwareRenderer.h"
+#include "ThumbnailRenderer.h"
+#include "app/App.h"
+#include "core/Log.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
+#include "scenegraph/SceneGraph.h"
+#include "video/Camera.h"
+#include "voxel/RawVolume.h"
+#include <glm/geometric.hpp>
+#include <glm/matrix.hpp>
+#include <limits>
+
+namespace voxelrender {
+
+static constexpr float Infinity = (std::numeric_limits<float>::max)();
+
+SoftwareRenderer::~SoftwareRenderer() {
+	clear();
+}
+
+void SoftwareRenderer::clear() {
+	delete _volume;
+	_volume = nullptr;
+	_sceneGraph = nullptr;
+	_occupied.clear();
+	_bricks = glm::ivec3(0);
+}
+
+void SoftwareRenderer::prepare(const scenegraph::SceneGraph &sceneGraph) {
+	if (_sceneGraph == &sceneGraph && _volume != nullptr) {
+		return;
+	}
+	clear();
+	core_trace_scoped(SoftwareRendererPrepare);
+	const scenegraph::SceneGraph::MergedVolumePalette &merged = sceneGraph.merge(true);
+	if (merged.first == nullptr) {
+		return;
+	}
+	_sceneGraph = &sceneGraph;
+	_volume = merged.first;
+	_palette = merged.second;
+
+	const voxel::Region &region = _volume->region();
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	_bricks = (dim + BrickSize - 1) / BrickSize;
+	_occupied.resize((size_t)_bricks.x * _bricks.y * _bricks.z);
+	const voxel::Voxel *voxels = (const voxel::Voxel *)_volume->data();
+	app::App::getInstance()->threadPool().parallelFor(0, _bricks.z, 1, [&](int start, int end) {
+		for (int bz = start; bz < end; ++bz) {
+			for (int by = 0; by < _bricks.y; ++by) {
+				for (int bx = 0; bx < _bricks.x; ++bx) {
+					const glm::ivec3 mins = glm::ivec3(bx, by, bz) * BrickSize;
+					const glm::ivec3 maxs = glm::min(mins + BrickSize, dim);
+					uint8_t occupied = 0u;
+					for (int z = mins.z; z < maxs.z && !occupied; ++z) {
+						for (int y = mins.y; y < maxs.y && !occupied; ++y) {
+							const voxel::Voxel *row = voxels + (size_t)z * dim.x * dim.y + (size_t)y * dim.x;
+							for (int x = mins.x; x < maxs.x; ++x) {
+								if (!voxel::isAir(row[x].getMaterial())) {
+									occupied = 1u;
+									break;
+								}
+							}
+						}
+					}
+					_occupied[(size_t)bx + (size_t)by * _bricks.x + (size_t)bz * _bricks.x * _bricks.y] = occupied;
+				}
+			}
+		}
+	});
+}
+
+uint32_t SoftwareRenderer::shade(uint8_t colorIndex, int axis, const glm::vec3 &dir) const {
+	// a fixed light from the upper front left of the default thumbnail camera
+	static const glm::vec3 lightDir = glm::normalize(glm::vec3(-0.4f, 1.0f, -0.6f));
+	glm::vec3 normal(0.0f);
+	normal[axis] = dir[axis] > 0.0f ? -1.0f : 1.0f;
+	const float brightness = 0.55f + 0.45f * glm::max(0.0f, glm::dot(normal, lightDir));
+	const core::RGBA color = _palette.color(colorIndex);
+	return core::RGBA((uint8_t)((float)color.r * brightness), (uint8_t)((float)color.g * brightness),
+					  (uint8_t)((float)color.b * brightness), 255u);
+}
+
+/**
+ * @brief The step direction and the ray parameters of the next cell borders for a grid with the given cell size
+ */
+static inline void setupTraversal(const glm::vec3 &origin, const glm::vec3 &dir, const glm::ivec3 &cell, float size,
+								  glm::ivec3 &step, glm::vec3 &tMax, glm::vec3 &tDelta) {
+	for (int a = 0; a < 3; ++a) {
+		if (dir[a] > 0.0f) {
+			step[a] = 1;
+			tMax[a] = ((float)(cell[a] + 1) * size - origin[a]) / dir[a];
+			tDelta[a] = size / dir[a];
+		} else if (dir[a] < 0.0f) {
+			step[a] = -1;
+			tMax[a] = ((float)cell[a] * size - origin[a]) / dir[a];
+			tDelta[a] = -size / dir[a];
+		} else {
+			step[a] = 0;
+			tMax[a] = Infinity;
+			tDelta[a] = Infinity;
+		}
+	}
+}
+
+static inline int minAxis(const glm::vec3 &tMax) {
+	if (tMax.x < tMax.y) {
+		return tMax.x < tMax.z ? 0 : 2;
+	}
+	return tMax.y < tMax.z ? 1 : 2;
+}
+
+bool SoftwareRenderer::traceBrick(const glm::vec3 &origin, const glm::vec3 &dir, const glm::ivec3 &brick, float t,
+								  float tEnd, int &axis, uint32_t &rgba) const {
+	const glm::ivec3 &dim = _volume->region().getDimensionsInVoxels();
+	const glm::ivec3 mins = brick * BrickSize;
+	const glm::ivec3 maxs = glm::min(mins + BrickSize, dim) - 1;
+	glm::ivec3 voxel = glm::clamp(glm::ivec3(glm::floor(origin + dir * t)), mins, maxs);
+	glm::ivec3 step;
+	glm::vec3 tMax;
+	glm::vec3 tDelta;
+	setupTraversal(origin, dir, voxel, 1.0f, step, tMax, tDelta);
+	const voxel::Voxel *voxels = (const voxel::Voxel *)_volume->data();
+	for (;;) {
+		const voxel::Voxel &v = voxels[(size_t)voxel.x + (size_t)voxel.y * dim.x + (size_t)voxel.z * dim.x * dim.y];
+		if (!voxel::isAir(v.getMaterial())) {
+			rgba = shade(v.getColor(), axis, dir);
+			return true;
+		}
+		const int a = minAxis(tMax);
+		if (tMax[a] > tEnd) {
+			return false;
+		}
+		voxel[a] += step[a];
+		if (voxel[a] < mins[a] || voxel[a] > maxs[a]) {
+			return false;
+		}
+		tMax[a] += tDelta[a];
+		axis = a;
+	}
+}
+
+uint32_t SoftwareRenderer::trace(const glm::vec3 &origin, const glm::vec3 &dir, uint32_t clearColor) const {
+	const glm::vec3 dim(_volume->region().getDimensionsInVoxels());
+	// clip the ray against the volume - the origin is relative to the lower corner of the volume
+	float tMin = 0.0f;
+	float tEnd = Infinity;
+	int axis = 0;
+	for (int a = 0; a < 3; ++a) {
+		if (dir[a] == 0.0f) {
+			if (origin[a] < 0.0f || origin[a] > dim[a]) {
+				return clearColor;
+			}
+			continue;
+		}
+		const float tLower = -origin[a] / dir[a];
+		const float tUpper = (dim[a] - origin[a]) / dir[a];
+		const float t0 = core_min(tLower, tUpper);
+		const float t1 = core_max(tLower, tUpper);
+		if (t0 > tMin) {
+			tMin = t0;
+			axis = a;
+		}
+		tEnd = core_min(tEnd, t1);
+	}
+	if (tMin > tEnd) {
+		return clearColor;
+	}
+	if (tMin == 0.0f) {
+		// the camera is inside the volume
+		const glm::vec3 absDir = glm::abs(dir);
+		axis = minAxis(-absDir);
+	}
+
+	glm::ivec3 brick = glm::clamp(glm::ivec3(glm::floor((origin + dir * tMin) / (float)BrickSize)), glm::ivec3(0),
+								  _bricks - 1);
+	glm::ivec3 step;
+	glm::vec3 tMax;
+	glm::vec3 tDelta;
+	setupTraversal(origin, dir, brick, (float)BrickSize, step, tMax, tDelta);
+	float t = tMin;
+	uint32_t rgba = clearColor;
+	for (;;) {
+		const size_t idx = (size_t)brick.x + (size_t)brick.y * _bricks.x + (size_t)brick.z * _bricks.x * _bricks.y;
+		const int a = minAxis(tMax);
+		if (_occupied[idx] && traceBrick(origin, dir, brick, t, core_min(tMax[a], tEnd), axis, rgba)) {
+			return rgba;
+		}
+		if (tMax[a] > tEnd) {
+			break;
+		}
+		brick[a] += step[a];
+		if (brick[a] < 0 || brick[a] >= _bricks[a]) {
+			break;
+		}
+		t = tMax[a];
+		tMax[a] += tDelta[a];
+		axis = a;
+	}
+	return clearColor;
+}
+
+void SoftwareRenderer::render(const video::Camera &camera, const glm::vec4 &clearColor, uint8_t *rgba) const {
+	core_trace_scoped(SoftwareRendererRender);
+	const glm::ivec2 &size = camera.size();
+	const glm::vec4 clear = glm::clamp(clearColor, 0.0f, 1.0f) * 255.0f + 0.5f;
+	const uint32_t clearRGBA = core::RGBA((uint8_t)clear.r, (uint8_t)clear.g, (uint8_t)clear.b, (uint8_t)clear.a);
+	uint32_t *pixels = (uint32_t *)rgba;
+	if (_volume == nullptr) {
+		for (int i = 0; i < size.x * size.y; ++i) {
+			pixels[i] = clearRGBA;
+		}
+		return;
+	}
+	const glm::mat4 &inverseViewProjection = glm::inverse(camera.viewProjectionMatrix());
+	const glm::vec3 lowerCorner(_volume->region().getLowerCorner());
+	const int tilesX = (size.x + TileSize - 1) / TileSize;
+	const int tilesY = (size.y + TileSize - 1) / TileSize;
+	app::App::getInstance()->threadPool().parallelFor(0, tilesX * tilesY, 1, [&](int start, int end) {
+		for (int tile = start; tile < end; ++tile) {
+			const int tileX = (tile % tilesX) * TileSize;
+			const int tileY = (tile / tilesX) * TileSize;
+			const int maxX = core_min(tileX + TileSize, size.x);
+			const int maxY = core_min(tileY + TileSize, size.y);
+			for (int y = tileY; y < maxY; ++y) {
+				// the first row is the top of the image - like the framebuffer image of the ThumbnailRenderer
+				const float ndcY = 1.0f - 2.0f * ((float)y + 0.5f) / (float)size.y;
+				for (int x = tileX; x < maxX; ++x) {
+					const float ndcX = 2.0f * ((float)x + 0.5f) / (float)size.x - 1.0f;
+					const glm::vec4 &nearPos = inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+					const glm::vec4 &farPos = inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+					const glm::vec3 origin = glm::vec3(nearPos) / nearPos.w;
+					const glm::vec3 dir = glm::normalize(glm::vec3(farPos) / farPos.w - origin);
+					pixels[(size_t)y * size.x + x] = trace(origin - lowerCorner, dir, clearRGBA);
+				}
+			}
+		}
+	});
+}
+
+image::ImagePtr SoftwareRenderer::render(const scenegraph::SceneGraph &sceneGraph,
+										 const voxelformat::ThumbnailContext &ctx, bool keep) {
+	if (ctx.outputSize.x <= 0 || ctx.outputSize.y <= 0) {
+		Log::error("Invalid thumbnail size %i:%i", ctx.outputSize.x, ctx.outputSize.y);
+		return image::ImagePtr();
+	}
+	core_trace_scoped(SoftwareRendererThumbnail);
+	prepare(sceneGraph);
+	video::Camera camera;
+	ThumbnailRenderer::setupCamera(camera, sceneGraph.region(), ctx);
+	core::DynamicArray<uint8_t> rgba((size_t)ctx.outputSize.x * ctx.outputSize.y * 4);
+	render(camera, ctx.clearColor, rgba.data());
+	if (!keep) {
+		clear();
+	}
+	const image::ImagePtr &image = image::createEmptyImage("thumbnail");
+	if (!image->loadRGBA(rgba.data(), ctx.outputSize.x, ctx.outputSize.y)) {
+		Log::error("Failed to create the thumbnail image");
+		return image::ImagePtr();
+	}
+	return image;
+}
+
+} // namespace voxelrender
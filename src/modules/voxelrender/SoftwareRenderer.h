@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/GLM.h"
+#include "core/NonCopyable.h"
+#include "core/collection/DynamicArray.h"
+#include "image/Image.h"
+#include "voxel/Palette.h"
+#include "voxelformat/FormatThumbnail.h"
+
+namespace scenegraph {
+class SceneGraph;
+}
+
+namespace video {
+class Camera;
+}
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief Renders thumbnails of scene graphs on the cpu - no renderer context is needed
+ *
+ * This is the fallback for machines without a gpu (e.g. conversion workers in containers). The nodes are merged into
+ * one volume and a ray is cast through the volume for every pixel. The rays skip the empty bricks of the volume and
+ * the image is rendered in tiles on the thread pool. The camera is the same as for the ThumbnailRenderer.
+ *
+ * The voxels are shaded with a fixed directional light - there is no ambient occlusion, no shadow, no glow and no
+ * transparency.
+ */
+class SoftwareRenderer : public core::NonCopyable {
+public:
+	static constexpr int BrickSize = 8;
+	static constexpr int TileSize = 16;
+
+private:
+	const scenegraph::SceneGraph *_sceneGraph = nullptr;
+	voxel::RawVolume *_volume = nullptr;
+	voxel::Palette _palette;
+	glm::ivec3 _bricks{0};
+	/**
+	 * @brief One entry per brick of BrickSize^3 voxels - @c 0 if the brick only contains air
+	 */
+	core::DynamicArray<uint8_t> _occupied;
+
+	void prepare(const scenegraph::SceneGraph &sceneGraph);
+	/**
+	 * @return The rgba color for the given ray
+	 */
+	uint32_t trace(const glm::vec3 &origin, const glm::vec3 &dir, uint32_t clearColor) const;
+	/**
+	 * @brief Walks the voxels of the given brick along the ray between the given ray parameters
+	 * @param[in,out] axis The axis of the face the ray entered the current voxel through
+	 * @return @c true if a solid voxel was hit - the color is stored in @c rgba then
+	 */
+	bool traceBrick(const glm::vec3 &origin, const glm::vec3 &dir, const glm::ivec3 &brick, float t, float tEnd,
+					int &axis, uint32_t &rgba) const;
+	uint32_t shade(uint8_t colorIndex, int axis, const glm::vec3 &dir) const;
+
+public:
+	~SoftwareRenderer();
+
+	/**
+	 * @param[in] keep Keep the merged volume of the scene graph to render the same scene graph again (e.g. from
+	 * different angles). If this is @c false - the default - the volume is freed after the image was rendered.
+	 */
+	image::ImagePtr render(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx,
+						   bool keep = false);
+	/**
+	 * @brief Renders the prepared volume with the given camera into the rgba buffer of the camera size
+	 */
+	void render(const video::Camera &camera, const glm::vec4 &clearColor, uint8_t *rgba) const;
+	void clear();
+};
+
+} // namespace voxelrender
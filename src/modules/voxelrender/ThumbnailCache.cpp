@@ -0,0 +1,202 @@
+/**
+ * @file
+ */
+
+#include "ThumbnailCache.h"
+#include "app/App.h"
+#include "core/Log.h"
+#include "core/MD5.h"
+#include "core/StringUtil.h"
+#include "core/Trace.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "image/Image.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include "scenegraph/SceneGraph.h"
+#include "voxelformat/VolumeFormat.h"
+#include <inttypes.h>
+
+namespace voxelrender {
+
+using SceneGraphPtr = core::SharedPtr<scenegraph::SceneGraph>;
+
+static constexpr size_t MaxThumbnails = 1024;
+
+/**
+ * @brief A scene graph that was loaded on the thread pool and waits for being rendered
+ */
+struct ThumbnailRenderJob {
+	image::ImagePtr image;
+	core::String cacheFile;
+	SceneGraphPtr sceneGraph;
+};
+
+struct ThumbnailQueue {
+	core_trace_mutex(core::Lock, lock, "ThumbnailQueue");
+	core::DynamicArray<ThumbnailRenderJob> jobs;
+	/**
+	 * @brief The amount of previews that are currently created on the thread pool
+	 */
+	core::AtomicInt running{0};
+};
+
+/**
+ * @return The png in the thumbnail cache for the given file or an empty string if the file can't be cached
+ */
+static core::String thumbnailCacheFile(const core::String &file, int size) {
+	io::FilesystemEntry entry;
+	if (!io::Filesystem::stat(file, entry) || !entry.isFile()) {
+		return "";
+	}
+	// a modified file gets a new cache entry
+	const core::String &key =
+		core::string::format("%s %" PRIu64 " %" PRIu64 " %i", file.c_str(), entry.mtime, entry.size, size);
+	const core::String &md5 = core::md5sum((const uint8_t *)key.c_str(), (uint32_t)key.size());
+	return core::string::format("thumbnailcache/%s.png", md5.c_str());
+}
+
+static void writeThumbnailCache(const core::String &cacheFile, const image::Image &image) {
+	io::BufferedReadWriteStream stream((int64_t)image.width() * image.height() * image.depth());
+	if (!image.writePng(stream)) {
+		Log::warn("Failed to encode the thumbnail for %s", image.name().c_str());
+		return;
+	}
+	if (!io::filesystem()->write(cacheFile, stream.getBuffer(), (size_t)stream.size())) {
+		Log::warn("Failed to write the thumbnail cache %s for %s", cacheFile.c_str(), image.name().c_str());
+	}
+}
+
+/**
+ * @brief Copies the pixels into the placeholder image - the texture is uploaded on its next use
+ */
+static bool fillPlaceholder(const image::ImagePtr &placeholder, const image::Image &image) {
+	if (!image.isLoaded() || image.depth() != 4) {
+		return false;
+	}
+	return placeholder->loadRGBA(image.data(), image.width(), image.height());
+}
+
+static void createThumbnail(ThumbnailQueue &queue, const image::ImagePtr &placeholder, int size) {
+	const core::String &file = placeholder->name();
+	const core::String &cacheFile = thumbnailCacheFile(file, size);
+	if (cacheFile.empty()) {
+		return;
+	}
+	const io::FilePtr &cached = io::filesystem()->open(cacheFile);
+	if (cached->exists()) {
+		// load into a temporary image - a failure must not be visible in the placeholder
+		image::Image image(file);
+		if (image.load(cached) && fillPlaceholder(placeholder, image)) {
+			Log::debug("Loaded the thumbnail of %s from the cache", file.c_str());
+			return;
+		}
+	}
+
+	io::FileStream stream(io::filesystem()->open(file, io::FileMode::SysRead));
+	if (!stream.valid()) {
+		return;
+	}
+	voxelformat::LoadContext loadctx;
+	const image::ImagePtr &screenshot = voxelformat::loadScreenshot(file, stream, loadctx);
+	if (screenshot && fillPlaceholder(placeholder, *screenshot.get())) {
+		writeThumbnailCache(cacheFile, *screenshot.get());
+		return;
+	}
+
+	stream.seek(0);
+	const SceneGraphPtr &sceneGraph = core::make_shared<scenegraph::SceneGraph>();
+	if (!voxelformat::loadFormat(file, stream, *sceneGraph.get(), loadctx)) {
+		Log::debug("Failed to load %s for the thumbnail", file.c_str());
+		return;
+	}
+	core::ScopedLock lock(queue.lock);
+	queue.jobs.push_back(ThumbnailRenderJob{placeholder, cacheFile, sceneGraph});
+}
+
+ThumbnailCache::ThumbnailCache(int size, int rendersPerFrame) : _size(size), _rendersPerFrame(rendersPerFrame) {
+}
+
+bool ThumbnailCache::init() {
+	_queue = core::make_shared<ThumbnailQueue>();
+	return true;
+}
+
+void ThumbnailCache::shutdown() {
+	// the running jobs still hold a reference to the queue - the loaded scene graphs are released with it
+	if (_queue) {
+		core::ScopedLock lock(_queue->lock);
+		_queue->jobs.clear();
+	}
+	_queue = core::SharedPtr<ThumbnailQueue>();
+	_requests.clear();
+	_textures.clear();
+	_renderer.shutdown();
+}
+
+video::TexturePtr ThumbnailCache::thumbnail(const core::String &file) {
+	auto i = _textures.find(file);
+	if (i != _textures.end()) {
+		return i->value;
+	}
+	if (_textures.size() >= MaxThumbnails) {
+		// keep the gpu memory bounded in big directories - dropped previews are loaded from the disk cache again
+		_textures.clear();
+		_requests.clear();
+	}
+	const image::ImagePtr &image = image::createEmptyImage(file);
+	const video::TexturePtr &texture = video::createTextureFromImage(image);
+	_textures.put(file, texture);
+	_requests.push_back(image);
+	return texture;
+}
+
+void ThumbnailCache::update() {
+	if (!_queue) {
+		return;
+	}
+	core_trace_scoped(ThumbnailCacheUpdate);
+	for (int i = 0; i < _rendersPerFrame; ++i) {
+		ThumbnailRenderJob job;
+		{
+			core::ScopedLock lock(_queue->lock);
+			if (_queue->jobs.empty()) {
+				break;
+			}
+			job = _queue->jobs.back();
+			_queue->jobs.pop();
+		}
+		voxelformat::ThumbnailContext ctx;
+		ctx.outputSize = glm::ivec2(_size);
+		ctx.clearColor = glm::vec4(0.0f);
+		const image::ImagePtr &image = _renderer.render(*job.sceneGraph.get(), ctx);
+		if (!image || !fillPlaceholder(job.image, *image.get())) {
+			Log::debug("Failed to render the thumbnail of %s", job.image->name().c_str());
+			continue;
+		}
+		// the png encoding is too slow for the main thread
+		const core::String cacheFile = job.cacheFile;
+		const image::ImagePtr thumbnail = job.image;
+		app::App::getInstance()->threadPool().schedule(
+			[cacheFile, thumbnail]() { writeThumbnailCache(cacheFile, *thumbnail.get()); });
+	}
+
+	// don't flood the thread pool - the rows that were scrolled out of view in the meantime are scheduled last
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	const int maxRunning = (int)threadPool.size();
+	while (!_requests.empty() && _queue->running < maxRunning) {
+		const image::ImagePtr image = _requests.back();
+		_requests.pop();
+		_queue->running.increment(1);
+		const core::SharedPtr<ThumbnailQueue> queue = _queue;
+		const int size = _size;
+		threadPool.schedule([queue, image, size]() {
+			createThumbnail(*queue.get(), image, size);
+			queue->running.decrement(1);
+		});
+	}
+}
+
+} // namespace voxelrender
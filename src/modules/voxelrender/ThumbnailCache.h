@@ -0,0 +1,66 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/IComponent.h"
+#include "core/SharedPtr.h"
+#include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/StringMap.h"
+#include "video/Texture.h"
+#include "voxelrender/ThumbnailRenderer.h"
+
+namespace voxelrender {
+
+struct ThumbnailQueue;
+
+/**
+ * @brief Previews of model files for the file browsers of the ui
+ *
+ * @c thumbnail() returns a placeholder texture right away. The preview is created on the thread pool - either from
+ * the disk cache in the home path (keyed by the path, the modification time and the size of the file) or from the
+ * screenshot that some formats embed. All other files are loaded on the thread pool, too, but the loaded scene
+ * graphs are rendered in small batches on the main thread in @c update() to keep the frame time low. The
+ * placeholder texture is filled once the preview is done and stays empty if the file can't be loaded.
+ *
+ * @note @c update() and @c thumbnail() must be called from the thread that owns the gl context
+ */
+class ThumbnailCache : public core::IComponent {
+private:
+	core::StringMap<video::TexturePtr> _textures;
+	/**
+	 * @brief The placeholder images of the requested previews that are not yet scheduled - the last request is
+	 * scheduled first as it's most likely still visible
+	 */
+	core::DynamicArray<image::ImagePtr> _requests;
+	/**
+	 * @brief Shared with the jobs on the thread pool to outlive the cache
+	 */
+	core::SharedPtr<ThumbnailQueue> _queue;
+	ThumbnailRenderer _renderer;
+	const int _size;
+	const int _rendersPerFrame;
+
+public:
+	/**
+	 * @param[in] size The width and height of the previews
+	 * @param[in] rendersPerFrame The amount of scene graphs that are rendered in one @c update() call
+	 */
+	ThumbnailCache(int size = 128, int rendersPerFrame = 2);
+
+	/**
+	 * @return The texture that gets filled with the preview of the given file once it's done
+	 */
+	video::TexturePtr thumbnail(const core::String &file);
+	/**
+	 * @brief Schedules the requested previews and renders the scene graphs that were loaded since the last call
+	 */
+	void update();
+
+	bool init() override;
+	void shutdown() override;
+};
+
+} // namespace voxelrender
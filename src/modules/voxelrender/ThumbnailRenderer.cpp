@@ -0,0 +1,107 @@
+/**
+ * @file
+ */
+
+#include "ThumbnailRenderer.h"
+#include "core/Assert.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "image/Image.h"
+#include "scenegraph/SceneGraph.h"
+#include "video/Camera.h"
+#include "video/FrameBuffer.h"
+#include "video/Renderer.h"
+
+namespace voxelrender {
+
+ThumbnailRenderer::~ThumbnailRenderer() {
+	core_assert_msg(!_initialized, "ThumbnailRenderer::shutdown() wasn't called");
+}
+
+bool ThumbnailRenderer::init(const glm::ivec2 &size) {
+	if (_initialized) {
+		return _renderContext.resize(size);
+	}
+	_volumeRenderer.construct();
+	if (!_renderContext.init(size)) {
+		Log::error("Failed to initialize the render context");
+		return false;
+	}
+	if (!_volumeRenderer.init()) {
+		Log::error("Failed to initialize the renderer");
+		_renderContext.shutdown();
+		return false;
+	}
+	_volumeRenderer.setSceneMode(true);
+	_initialized = true;
+	return true;
+}
+
+void ThumbnailRenderer::shutdown() {
+	if (!_initialized) {
+		return;
+	}
+	_volumeRenderer.shutdown();
+	_renderContext.shutdown();
+	_initialized = false;
+}
+
+void ThumbnailRenderer::clear() {
+	if (!_initialized) {
+		return;
+	}
+	_volumeRenderer.clear();
+}
+
+void ThumbnailRenderer::setupCamera(video::Camera &camera, const voxel::Region &region,
+									const voxelformat::ThumbnailContext &ctx) {
+	const glm::vec3 center(region.getCenter());
+	const glm::vec3 dim(region.getDimensionsInVoxels());
+	const int height = region.getHeightInCells();
+	const float distance = ctx.distance <= 0.01f ? glm::length(dim) : ctx.distance;
+	camera.setSize(ctx.outputSize);
+	camera.setMode(video::CameraMode::Perspective);
+	camera.setType(video::CameraType::Free);
+	camera.setRotationType(video::CameraRotationType::Target);
+	camera.setAngles(ctx.pitch, ctx.yaw, ctx.roll);
+	camera.setFarPlane(5000.0f);
+	camera.setTarget(center);
+	camera.setTargetDistance(distance * 2.0f);
+	camera.setWorldPosition(glm::vec3(-distance, (float)height + distance, -distance));
+	camera.setOmega(ctx.omega);
+	camera.update(ctx.deltaFrameSeconds);
+}
+
+image::ImagePtr ThumbnailRenderer::render(const scenegraph::SceneGraph &sceneGraph,
+										  const voxelformat::ThumbnailContext &ctx, bool keep) {
+	if (!init(ctx.outputSize)) {
+		return image::ImagePtr();
+	}
+	video::clearColor(ctx.clearColor);
+	video::enable(video::State::DepthTest);
+	video::depthFunc(video::CompareFunc::LessEqual);
+	video::enable(video::State::CullFace);
+	video::enable(video::State::DepthMask);
+	video::enable(video::State::Blend);
+	video::blendFunc(video::BlendMode::SourceAlpha, video::BlendMode::OneMinusSourceAlpha);
+
+	core_trace_scoped(EditorSceneRenderFramebuffer);
+	_volumeRenderer.prepare(const_cast<scenegraph::SceneGraph &>(sceneGraph));
+
+	{
+		video::Camera camera;
+		setupCamera(camera, sceneGraph.region(), ctx);
+		_renderContext.frameBuffer.bind(true);
+		_volumeRenderer.render(_renderContext, camera, true, true);
+		_renderContext.frameBuffer.unbind();
+	}
+
+	const image::ImagePtr &image = _renderContext.frameBuffer.image("thumbnail", video::FrameBufferAttachment::Color0);
+	if (!keep) {
+		// the volumes are owned by the scene graph - don't keep references to them
+		_volumeRenderer.clear();
+	}
+	return image;
+}
+
+} // namespace voxelrender
@@ -0,0 +1,57 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "voxelformat/FormatThumbnail.h"
+#include "voxelrender/SceneGraphRenderer.h"
+
+namespace scenegraph {
+class SceneGraph;
+}
+
+namespace video {
+class Camera;
+}
+
+namespace voxel {
+class Region;
+}
+
+namespace voxelrender {
+
+/**
+ * @brief Renders thumbnails for several scene graphs with the same shaders, buffers and framebuffer
+ *
+ * Use this instead of @c volumeThumbnail() if a lot of thumbnails should get rendered - the renderer and the render
+ * context are only initialized once and the framebuffer is only re-created if the output size changes.
+ */
+class ThumbnailRenderer : public core::NonCopyable {
+private:
+	SceneGraphRenderer _volumeRenderer;
+	RenderContext _renderContext;
+	bool _initialized = false;
+
+public:
+	~ThumbnailRenderer();
+
+	bool init(const glm::ivec2 &size);
+	void shutdown();
+	/**
+	 * @param[in] keep Keep the references to the volumes of the scene graph (e.g. to render the same scene graph
+	 * from different angles). If this is @c false - the default - the renderer is cleared after the image was
+	 * rendered. Otherwise clear() must be called before the scene graph is destroyed.
+	 */
+	image::ImagePtr render(const scenegraph::SceneGraph &sceneGraph, const voxelformat::ThumbnailContext &ctx,
+						   bool keep = false);
+	void clear();
+
+	/**
+	 * @brief Puts the camera at the position the thumbnail of the given scene region is rendered from
+	 */
+	static void setupCamera(video::Camera &camera, const voxel::Region &region, const voxelformat::ThumbnailContext &ctx);
+};
+
+} // namespace voxelrender
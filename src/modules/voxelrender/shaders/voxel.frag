@@ -142,9 +142,16 @@ void main(void) {
 		o_color = calcColor();
 	}
 	o_color.rgb = pow(o_color.rgb, vec3(1.0 / cl_gamma));
+#ifdef VOXEL_OIT
+	// weighted blended order independent transparency - the closer fragments get the higher weights
+	float weight = o_color.a * clamp(3e3 * pow(1.0 - gl_FragCoord.z, 3.0), 1e-2, 3e3);
+	o_glow = vec4(o_color.a * weight, 0.0, 0.0, o_color.a);
+	o_color = vec4(o_color.rgb * o_color.a * weight, o_color.a);
+#else
 	if ((v_flags & FLAGBLOOM) != 0u) {
 		o_glow = o_color;
 	} else {
 		o_glow = v_glow;
 	}
+#endif
 }
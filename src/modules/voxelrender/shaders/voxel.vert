@@ -25,6 +25,10 @@ $out vec3 v_lightspacepos;
 $out float v_viewz;
 #endif
 
+#ifdef VOXEL_PICK
+$out vec3 v_volumepos;
+#endif
+
 const float aovalues[] = float[](0.15, 0.6, 0.8, 1.0);
 
 void main(void) {
@@ -58,5 +62,9 @@ void main(void) {
 	v_viewz = (u_viewprojection * vec4(v_lightspacepos, 1.0)).w;
 #endif // cl_shadowmap
 
+#ifdef VOXEL_PICK
+	v_volumepos = a_pos;
+#endif
+
 	gl_Position = u_viewprojection * v_pos;
 }
@@ -0,0 +1,183 @@
+/**
+ * @brief Ray marches the voxels of a volume that are given as a sparse brick map - see voxelrender::BrickMap
+ *
+ * Rendered as a fullscreen quad for every volume. The ray of the fragment is transformed into the space of the
+ * volume region and skips the empty bricks as a whole. Inside a non-empty brick the voxels are traversed one
+ * by one until a voxel that is not air is hit. The depth of the hit is written to combine the result with the
+ * rest of the scene.
+ */
+
+$in vec2 v_ndc;
+
+#include "_shared.glsl"
+
+#define MATERIALCOLORS 256
+layout(std140) uniform u_frag {
+	vec4 u_materialcolor[MATERIALCOLORS];
+	vec4 u_glowcolor[MATERIALCOLORS];
+	mat4 u_viewprojection;
+	mat4 u_inverseviewprojection;
+	// volume space to world space - including the pivot
+	mat4 u_model;
+	mat4 u_inversemodel;
+	// the lower corner of the volume region
+	ivec4 u_mins;
+	// the size of the volume region
+	ivec4 u_dim;
+	// the amount of bricks per axis
+	ivec4 u_gridsize;
+	vec3 u_lightdir;
+	int u_gray;
+	vec3 u_diffuse_color;
+	int u_padding0;
+	vec3 u_ambient_color;
+	int u_padding1;
+};
+
+#define BRICKSIZE 8
+$constant BrickSize BRICKSIZE
+// two voxels per uint
+#define BRICKWORDS (BRICKSIZE * BRICKSIZE * BRICKSIZE / 2)
+
+// 0 for an empty brick - otherwise the slot of the brick plus one
+layout(std430, binding = 0) buffer u_griddata {
+	uint u_grid[];
+};
+
+layout(std430, binding = 1) buffer u_brickdata {
+	uint u_bricks[];
+};
+
+layout(location = 0) $out vec4 o_color;
+layout(location = 1) $out vec4 o_glow;
+
+#ifndef cl_gamma
+#define cl_gamma 1.0
+#endif
+
+uint brickAt(ivec3 brick) {
+	return u_grid[brick.x + brick.y * u_gridsize.x + brick.z * u_gridsize.x * u_gridsize.y];
+}
+
+uint voxelAt(uint slot, ivec3 local) {
+	int idx = local.x + local.y * BRICKSIZE + local.z * BRICKSIZE * BRICKSIZE;
+	uint word = u_bricks[(slot - 1u) * uint(BRICKWORDS) + uint(idx >> 1)];
+	return (idx & 1) != 0 ? (word >> 16u) : (word & 0xFFFFu);
+}
+
+// the distance along the ray to the exit of the given box
+float exitDistance(vec3 origin, vec3 invDir, vec3 boxMins, vec3 boxMaxs, out int axis) {
+	vec3 exits = max((boxMins - origin) * invDir, (boxMaxs - origin) * invDir);
+	if (exits.x <= exits.y && exits.x <= exits.z) {
+		axis = 0;
+		return exits.x;
+	}
+	if (exits.y <= exits.z) {
+		axis = 1;
+		return exits.y;
+	}
+	axis = 2;
+	return exits.z;
+}
+
+void main(void) {
+	vec4 nearPos = u_inverseviewprojection * vec4(v_ndc, -1.0, 1.0);
+	vec4 farPos = u_inverseviewprojection * vec4(v_ndc, 1.0, 1.0);
+	// the ray in the space of the region - the lower corner of the region is the origin
+	vec3 mins = vec3(u_mins.xyz);
+	vec3 origin = (u_inversemodel * vec4(nearPos.xyz / nearPos.w, 1.0)).xyz - mins;
+	vec3 dir = normalize((u_inversemodel * vec4(farPos.xyz / farPos.w, 1.0)).xyz - mins - origin);
+	// avoid the division by zero for the axis aligned rays
+	dir = mix(dir, vec3(1e-6), lessThan(abs(dir), vec3(1e-6)));
+	vec3 invDir = 1.0 / dir;
+
+	vec3 size = vec3(u_dim.xyz);
+	vec3 t0 = (vec3(0.0) - origin) * invDir;
+	vec3 t1 = (size - origin) * invDir;
+	vec3 tmin = min(t0, t1);
+	vec3 tmax = max(t0, t1);
+	float tenter = max(max(tmin.x, tmin.y), tmin.z);
+	float texit = min(min(tmax.x, tmax.y), tmax.z);
+	if (texit < max(tenter, 0.0)) {
+		discard;
+	}
+	int axis = tmin.x >= tmin.y && tmin.x >= tmin.z ? 0 : (tmin.y >= tmin.z ? 1 : 2);
+	float t = max(tenter, 0.0);
+	ivec3 stepDir = ivec3(sign(dir));
+	vec3 deltaDist = abs(invDir);
+	ivec3 dim = u_dim.xyz;
+	// a ray can't cross more voxels than this
+	int maxSteps = 2 * (dim.x + dim.y + dim.z) + 8;
+	uint hit = 0u;
+	ivec3 voxel = ivec3(0);
+	for (int steps = 0; steps < maxSteps && t < texit && hit == 0u; ++steps) {
+		vec3 p = origin + dir * (t + 1e-4);
+		voxel = clamp(ivec3(floor(p)), ivec3(0), dim - 1);
+		ivec3 brick = voxel / BRICKSIZE;
+		ivec3 brickMins = brick * BRICKSIZE;
+		uint slot = brickAt(brick);
+		if (slot == 0u) {
+			// skip the whole brick
+			t = exitDistance(origin, invDir, vec3(brickMins), vec3(brickMins + BRICKSIZE), axis);
+			continue;
+		}
+		ivec3 brickMaxs = min(brickMins + BRICKSIZE, dim);
+		vec3 sideDist = (vec3(voxel) + max(vec3(stepDir), vec3(0.0)) - origin) * invDir;
+		while (all(greaterThanEqual(voxel, brickMins)) && all(lessThan(voxel, brickMaxs)) && steps < maxSteps) {
+			uint value = voxelAt(slot, voxel - brickMins);
+			if ((value & 0x1Fu) != 0u) {
+				hit = value;
+				break;
+			}
+			if (sideDist.x < sideDist.y && sideDist.x < sideDist.z) {
+				t = sideDist.x;
+				sideDist.x += deltaDist.x;
+				voxel.x += stepDir.x;
+				axis = 0;
+			} else if (sideDist.y < sideDist.z) {
+				t = sideDist.y;
+				sideDist.y += deltaDist.y;
+				voxel.y += stepDir.y;
+				axis = 1;
+			} else {
+				t = sideDist.z;
+				sideDist.z += deltaDist.z;
+				voxel.z += stepDir.z;
+				axis = 2;
+			}
+			++steps;
+		}
+		if (hit == 0u && (any(lessThan(voxel, ivec3(0))) || any(greaterThanEqual(voxel, dim)))) {
+			// left the volume
+			break;
+		}
+	}
+	if (hit == 0u) {
+		discard;
+	}
+
+	vec3 normal = vec3(0.0);
+	normal[axis] = -float(stepDir[axis]);
+	vec3 worldNormal = normalize(mat3(u_model) * normal);
+	vec4 worldPos = u_model * vec4(origin + dir * t + mins, 1.0);
+	vec4 clipPos = u_viewprojection * worldPos;
+	gl_FragDepth = (clipPos.z / clipPos.w) * 0.5 + 0.5;
+
+	uint colorIndex = (hit >> 8u) & 0xFFu;
+	uint flags = (hit >> 5u) & 0x7u;
+	vec4 materialColor = u_materialcolor[colorIndex];
+	if (u_gray != 0) {
+		float gray = (0.21 * materialColor.r + 0.72 * materialColor.g + 0.07 * materialColor.b) / 3.0;
+		materialColor = vec4(gray, gray, gray, materialColor.a);
+	}
+	// the same lighting as in the voxel shader - without shadows and ambient occlusion
+	float ndotl = abs(dot(worldNormal, u_lightdir));
+	vec3 diffuse = u_diffuse_color * ndotl;
+	o_color = vec4(clamp(materialColor.rgb * (u_ambient_color + diffuse), 0.0, 1.0), 1.0);
+	o_color.rgb = pow(o_color.rgb, vec3(1.0 / cl_gamma));
+	if ((flags & FLAGBLOOM) != 0u) {
+		o_glow = o_color;
+	} else {
+		o_glow = u_glowcolor[colorIndex];
+	}
+}
@@ -0,0 +1,9 @@
+// attributes from the VAOs
+$in vec2 a_pos;
+
+$out vec2 v_ndc;
+
+void main(void) {
+	v_ndc = a_pos;
+	gl_Position = vec4(a_pos.x, a_pos.y, 0.0, 1.0);
+}
@@ -0,0 +1,84 @@
+/**
+ * @brief Voxel shader for rendering all volumes with one multi draw indirect call
+ *
+ * The per draw data is fetched from shader storage buffers. The draw index is the base
+ * instance of the draw command - given to the shader by the instanced attribute a_draw.
+ */
+
+// attributes from the VAOs
+$in vec3 a_pos;
+$in uvec2 a_info;
+$in uint a_draw;
+
+layout(std140) uniform u_vert {
+	mat4 u_viewprojection;
+};
+
+// DRAWDATASIZE vec4 per draw: the model matrix columns, the pivot and the palette offset and gray flag
+#define DRAWDATASIZE 6
+$constant DrawDataSize DRAWDATASIZE
+layout(std430, binding = 0) buffer u_drawdata {
+	vec4 u_draws[];
+};
+
+// the material colors of a palette followed by its glow colors
+#define MATERIALCOLORS 256
+layout(std430, binding = 1) buffer u_palettedata {
+	vec4 u_palettes[];
+};
+
+$out vec4 v_pos;
+$out vec4 v_color;
+$out vec4 v_glow;
+$out float v_ambientocclusion;
+flat $out uint v_flags;
+
+#include "_shared.glsl"
+
+#if cl_shadowmap == 1
+$out vec3 v_lightspacepos;
+$out float v_viewz;
+#endif
+
+const float aovalues[] = float[](0.15, 0.6, 0.8, 1.0);
+
+void main(void) {
+	uint a_ao = (a_info[0] & 3u);
+	uint a_flags = ((a_info[0] & ~3u) >> 2u);
+	uint a_colorindex = a_info[1];
+
+	int drawOffset = int(a_draw) * DRAWDATASIZE;
+	mat4 model = mat4(u_draws[drawOffset + 0], u_draws[drawOffset + 1], u_draws[drawOffset + 2], u_draws[drawOffset + 3]);
+	vec3 pivot = u_draws[drawOffset + 4].xyz;
+	vec4 params = u_draws[drawOffset + 5];
+	int paletteOffset = int(params.x);
+	bool gray = params.y != 0.0;
+	v_pos = model * vec4(a_pos - pivot, 1.0);
+
+	int materialColorIndex = int(a_colorindex);
+	vec4 materialColor = u_palettes[paletteOffset + materialColorIndex];
+	vec4 glowColor = u_palettes[paletteOffset + MATERIALCOLORS + materialColorIndex];
+	v_flags = 0u;
+#if r_renderoutline == 0
+	if ((a_flags & FLAGOUTLINE) != 0u)
+#endif
+		v_flags |= FLAGOUTLINE;
+	if ((a_flags & FLAGBLOOM) != 0u)
+		v_flags |= FLAGBLOOM;
+
+	if (gray) {
+		float grayValue = (0.21 * materialColor.r + 0.72 * materialColor.g + 0.07 * materialColor.b) / 3.0;
+		v_color = vec4(grayValue, grayValue, grayValue, materialColor.a);
+	} else {
+		v_color = materialColor;
+	}
+	v_glow = glowColor;
+	v_ambientocclusion = aovalues[a_ao];
+
+#if cl_shadowmap == 1
+	v_lightspacepos = v_pos.xyz;
+	v_viewz = (u_viewprojection * vec4(v_lightspacepos, 1.0)).w;
+#endif // cl_shadowmap
+
+	gl_Position = u_viewprojection * v_pos;
+}
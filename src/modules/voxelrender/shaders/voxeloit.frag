@@ -0,0 +1,8 @@
+/**
+ * @brief Accumulates the transparent voxels for the weighted blended order independent transparency
+ *
+ * The first target gets the weighted and premultiplied colors, the second one the sum of the weights in
+ * the red channel and the coverage in the alpha channel. See the voxeloitcomposite shader.
+ */
+#define VOXEL_OIT 1
+#include "voxel.frag"
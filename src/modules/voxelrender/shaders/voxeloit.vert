@@ -0,0 +1,2 @@
+// the transparent voxels are transformed like in the voxel shader - only the fragment output differs
+#include "voxel.vert"
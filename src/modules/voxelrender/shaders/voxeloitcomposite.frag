@@ -0,0 +1,21 @@
+/**
+ * @brief Blends the accumulated transparent voxels over the opaque scene - see the voxeloit shader
+ */
+uniform sampler2D u_accum;
+uniform sampler2D u_weight;
+
+layout(location = 0) $out vec4 o_color;
+layout(location = 1) $out vec4 o_glow;
+
+void main(void) {
+	ivec2 texel = ivec2(gl_FragCoord.xy);
+	vec4 weight = texelFetch(u_weight, texel, 0);
+	float coverage = weight.a;
+	if (coverage <= 0.0) {
+		discard;
+	}
+	vec4 accum = texelFetch(u_accum, texel, 0);
+	o_color = vec4(accum.rgb / max(weight.r, 1e-5), coverage);
+	// leave the glow of the scene untouched
+	o_glow = vec4(0.0);
+}
@@ -0,0 +1,6 @@
+// attributes from the VAOs
+$in vec2 a_pos;
+
+void main(void) {
+	gl_Position = vec4(a_pos.x, a_pos.y, 0.0, 1.0);
+}
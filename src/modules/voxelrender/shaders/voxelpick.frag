@@ -0,0 +1,30 @@
+/**
+ * @brief Writes the volume, the face and the position of the voxel below the mouse cursor - see voxelrender::PickBuffer
+ */
+$in vec3 v_volumepos;
+
+// the volume index plus one - 0 is used for the cleared pixels
+uniform int u_pickid;
+// the direction of the mouse ray in volume space
+uniform vec3 u_raydir;
+
+layout(location = 0) $out vec4 o_color;
+
+void main(void) {
+	// the axis of the face normal - the position only changes along the other two axes
+	vec3 n = abs(cross(dFdx(v_volumepos), dFdy(v_volumepos)));
+	int axis = 0;
+	if (n.y > n.x && n.y >= n.z) {
+		axis = 1;
+	} else if (n.z > n.x && n.z > n.y) {
+		axis = 2;
+	}
+	// the visible face points against the ray
+	float normal = u_raydir[axis] > 0.0 ? -1.0 : 1.0;
+	vec3 offset = vec3(0.0);
+	offset[axis] = normal * 0.5;
+	vec3 voxel = floor(v_volumepos - offset);
+	// voxel::FaceNames - the negative faces follow the positive ones
+	int face = normal > 0.0 ? axis : axis + 3;
+	o_color = vec4(float(u_pickid * 8 + face), voxel);
+}
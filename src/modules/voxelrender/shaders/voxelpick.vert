@@ -0,0 +1,3 @@
+// the voxels are transformed like in the voxel shader - the position in volume space is forwarded for the pick id
+#define VOXEL_PICK 1
+#include "voxel.vert"
@@ -0,0 +1,2 @@
+// the lighting is the same as for the voxel shader - only the vertex input differs
+#include "voxel.frag"
@@ -0,0 +1,123 @@
+/**
+ * @brief Voxel shader that builds the quads of the visible voxel faces without any vertex buffer
+ *
+ * Every face is expanded into two triangles - the face index is derived from gl_VertexID. The
+ * faces are given as a list of packed voxel::VoxelFace structs in a shader storage buffer.
+ */
+
+#define MATERIALCOLORS 256
+// the same layout as in the voxel shader to share the uniform buffer
+layout(std140) uniform u_vert {
+	vec4 u_materialcolor[MATERIALCOLORS];
+	vec4 u_glowcolor[MATERIALCOLORS];
+	mat4 u_viewprojection;
+	mat4 u_model;
+	vec3 u_pivot;
+	int u_gray;
+};
+
+// FACESIZE uints per face - see voxel::VoxelFace
+#define FACESIZE 3
+$constant FaceSize FACESIZE
+#define VERTICESPERFACE 6
+$constant VerticesPerFace VERTICESPERFACE
+layout(std430, binding = 0) buffer u_facedata {
+	uint u_faces[];
+};
+
+$out vec4 v_pos;
+$out vec4 v_color;
+$out vec4 v_glow;
+$out float v_ambientocclusion;
+flat $out uint v_flags;
+
+#include "_shared.glsl"
+
+#if cl_shadowmap == 1
+$out vec3 v_lightspacepos;
+$out float v_viewz;
+#endif
+
+const float aovalues[] = float[](0.15, 0.6, 0.8, 1.0);
+
+// the corners of the faces in the order of voxel::FaceNames - see voxel::faceCorner()
+const vec3 corners[] = vec3[](
+	vec3(1.0, 0.0, 0.0), vec3(1.0, 1.0, 0.0), vec3(1.0, 1.0, 1.0), vec3(1.0, 0.0, 1.0),
+	vec3(0.0, 1.0, 0.0), vec3(0.0, 1.0, 1.0), vec3(1.0, 1.0, 1.0), vec3(1.0, 1.0, 0.0),
+	vec3(0.0, 0.0, 1.0), vec3(1.0, 0.0, 1.0), vec3(1.0, 1.0, 1.0), vec3(0.0, 1.0, 1.0),
+	vec3(0.0, 0.0, 0.0), vec3(0.0, 0.0, 1.0), vec3(0.0, 1.0, 1.0), vec3(0.0, 1.0, 0.0),
+	vec3(0.0, 0.0, 0.0), vec3(1.0, 0.0, 0.0), vec3(1.0, 0.0, 1.0), vec3(0.0, 0.0, 1.0),
+	vec3(0.0, 0.0, 0.0), vec3(0.0, 1.0, 0.0), vec3(1.0, 1.0, 0.0), vec3(1.0, 0.0, 0.0)
+);
+
+// the two triangles of a quad - the flipped variant splits the quad along the other diagonal
+const int quadcorners[] = int[](0, 1, 2, 0, 2, 3);
+const int flippedquadcorners[] = int[](1, 2, 3, 1, 3, 0);
+
+void main(void) {
+	int faceOffset = (gl_VertexID / VERTICESPERFACE) * FACESIZE;
+	int quadVertex = gl_VertexID % VERTICESPERFACE;
+	uint w0 = u_faces[faceOffset + 0];
+	uint w1 = u_faces[faceOffset + 1];
+	uint w2 = u_faces[faceOffset + 2];
+	uint face = w1 >> 24u;
+	if (face > 5u) {
+		// unused slot of the chunk range - degenerated triangle
+		v_pos = vec4(0.0);
+		v_color = vec4(0.0);
+		v_glow = vec4(0.0);
+		v_ambientocclusion = 1.0;
+		v_flags = 0u;
+#if cl_shadowmap == 1
+		v_lightspacepos = vec3(0.0);
+		v_viewz = 0.0;
+#endif // cl_shadowmap
+		gl_Position = vec4(0.0);
+		return;
+	}
+	// sign extend the 16 bit position components
+	vec3 voxelPos = vec3(float(int(w0 << 16u) >> 16), float(int(w0) >> 16), float(int(w1 << 16u) >> 16));
+	uint colorIndex = (w1 >> 16u) & 0xFFu;
+	uint voxelFlags = w2 & 0xFFu;
+	uint ao = (w2 >> 8u) & 0xFFu;
+
+	uint aoQuad0 = ao & 3u;
+	uint aoQuad1 = (ao >> 2u) & 3u;
+	uint aoQuad2 = (ao >> 4u) & 3u;
+	uint aoQuad3 = (ao >> 6u) & 3u;
+	int corner;
+	if (aoQuad1 + aoQuad3 > aoQuad0 + aoQuad2) {
+		corner = flippedquadcorners[quadVertex];
+	} else {
+		corner = quadcorners[quadVertex];
+	}
+	vec3 pos = voxelPos + corners[int(face) * 4 + corner];
+	v_pos = u_model * vec4(pos - u_pivot, 1.0);
+
+	int materialColorIndex = int(colorIndex);
+	vec4 materialColor = u_materialcolor[materialColorIndex];
+	vec4 glowColor = u_glowcolor[materialColorIndex];
+	v_flags = 0u;
+#if r_renderoutline == 0
+	if ((voxelFlags & FLAGOUTLINE) != 0u)
+#endif
+		v_flags |= FLAGOUTLINE;
+	if ((voxelFlags & FLAGBLOOM) != 0u)
+		v_flags |= FLAGBLOOM;
+
+	if (u_gray != 0) {
+		float gray = (0.21 * materialColor.r + 0.72 * materialColor.g + 0.07 * materialColor.b) / 3.0;
+		v_color = vec4(gray, gray, gray, materialColor.a);
+	} else {
+		v_color = materialColor;
+	}
+	v_glow = glowColor;
+	v_ambientocclusion = aovalues[(ao >> (uint(corner) * 2u)) & 3u];
+
+#if cl_shadowmap == 1
+	v_lightspacepos = v_pos.xyz;
+	v_viewz = (u_viewprojection * vec4(v_lightspacepos, 1.0)).w;
+#endif // cl_shadowmap
+
+	gl_Position = u_viewprojection * v_pos;
+}
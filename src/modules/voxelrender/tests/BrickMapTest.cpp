@@ -0,0 +1,77 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/BrickMap.h"
+#include "app/tests/AbstractTest.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelrender {
+
+class BrickMapTest : public app::AbstractTest {};
+
+TEST_F(BrickMapTest, testBuild) {
+	// the region is not a multiple of the brick size
+	voxel::RawVolume volume(voxel::Region(-3, 2, -5, 17, 12, 9));
+	const voxel::Voxel voxel1 = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const voxel::Voxel voxel2 = voxel::createVoxel(voxel::VoxelType::Transparent, 200);
+	volume.setVoxel(-3, 2, -5, voxel1);
+	volume.setVoxel(17, 12, 9, voxel2);
+	volume.setVoxel(6, 5, 0, voxel1);
+
+	BrickMap brickMap;
+	brickMap.build(volume);
+	EXPECT_EQ(glm::ivec3(3, 2, 2), brickMap.gridSize());
+	EXPECT_EQ(3u, brickMap.usedBricks());
+	EXPECT_TRUE(brickMap.rebuilt());
+	EXPECT_EQ(BrickMap::EmptyBrick, brickMap.brick(glm::ivec3(1, 1, 0)));
+	EXPECT_NE(BrickMap::EmptyBrick, brickMap.brick(glm::ivec3(0, 0, 0)));
+
+	const voxel::Region &region = volume.region();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const voxel::Voxel &expected = volume.voxel(x, y, z);
+				const voxel::Voxel &actual = brickMap.voxel(glm::ivec3(x, y, z));
+				ASSERT_EQ(expected.getMaterial(), actual.getMaterial()) << x << ":" << y << ":" << z;
+				ASSERT_EQ(expected.getColor(), actual.getColor()) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(BrickMapTest, testUpdate) {
+	voxel::RawVolume volume(voxel::Region(0, 31));
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	volume.setVoxel(1, 1, 1, voxel);
+	BrickMap brickMap;
+	brickMap.build(volume);
+	brickMap.markClean();
+	ASSERT_EQ(1u, brickMap.usedBricks());
+
+	// a new brick gets a slot
+	volume.setVoxel(20, 20, 20, voxel);
+	brickMap.update(volume, voxel::Region(20, 20));
+	EXPECT_EQ(2u, brickMap.usedBricks());
+	EXPECT_FALSE(brickMap.rebuilt());
+	size_t start = 0u;
+	size_t count = 0u;
+	ASSERT_TRUE(brickMap.dirtyGridRange(start, count));
+	EXPECT_EQ(1u, count);
+	ASSERT_EQ(1u, brickMap.dirtySlots().size());
+	EXPECT_EQ(voxel.getColor(), brickMap.voxel(glm::ivec3(20)).getColor());
+	brickMap.markClean();
+
+	// the empty brick releases its slot - and the slot is reused
+	volume.setVoxel(1, 1, 1, voxel::Voxel());
+	brickMap.update(volume, voxel::Region(1, 1));
+	EXPECT_EQ(1u, brickMap.usedBricks());
+	EXPECT_EQ(BrickMap::EmptyBrick, brickMap.brick(glm::ivec3(0)));
+	volume.setVoxel(9, 1, 1, voxel);
+	brickMap.update(volume, voxel::Region(9, 1, 1, 9, 1, 1));
+	EXPECT_EQ(2u, brickMap.usedBricks());
+	EXPECT_EQ(2u, brickMap.slots());
+	EXPECT_TRUE(voxel::isBlocked(brickMap.voxel(glm::ivec3(9, 1, 1)).getMaterial()));
+}
+
+} // namespace voxelrender
@@ -0,0 +1,89 @@
+/**
+ * @file
+ */
+
+#include "video/tests/AbstractGLTest.h"
+#include "core/Algorithm.h"
+#include "voxel/RawVolume.h"
+#include "voxelrender/FaceCompute.h"
+
+namespace voxelrender {
+
+class FaceComputeTest : public video::AbstractGLTest {
+protected:
+	static bool less(const voxel::VoxelFace &a, const voxel::VoxelFace &b) {
+		if (a.x != b.x) {
+			return a.x < b.x;
+		}
+		if (a.y != b.y) {
+			return a.y < b.y;
+		}
+		if (a.z != b.z) {
+			return a.z < b.z;
+		}
+		return a.face < b.face;
+	}
+
+	// the order of the gpu faces depends on the scheduling of the invocations
+	static void sortFaces(voxel::FaceArray &faces) {
+		core::sort(faces.begin(), faces.end(), less);
+	}
+};
+
+TEST_F(FaceComputeTest, testMatchesCpuExtraction) {
+	FaceCompute compute;
+	if (!compute.init()) {
+		GTEST_SKIP() << "No compute shader support";
+	}
+	const voxel::Region volumeRegion(-4, -2, -3, 20, 13, 18);
+	voxel::RawVolume volume(volumeRegion);
+	for (int z = -3; z <= 18; ++z) {
+		for (int y = -2; y <= 13; ++y) {
+			for (int x = -4; x <= 20; ++x) {
+				const int h = (x * 7 + y * 13 + z * 5) % 11;
+				if (h < 4) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (uint8_t)(h + 1)));
+				} else if (h == 5) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Transparent, 42));
+				}
+			}
+		}
+	}
+	const voxel::Region region(-3, -1, -2, 19, 12, 17);
+	voxel::ChunkFaces expected;
+	voxel::extractCubicFaces(&volume, region, &expected);
+	voxel::ChunkFaces faces;
+	ASSERT_TRUE(compute.extract(volume, region, faces));
+	for (int i = 0; i < voxel::ChunkFaces::Lists; ++i) {
+		ASSERT_EQ(expected.faces[i].size(), faces.faces[i].size()) << "list " << i;
+		ASSERT_FALSE(faces.faces[i].empty()) << "list " << i;
+		sortFaces(expected.faces[i]);
+		sortFaces(faces.faces[i]);
+		for (size_t f = 0; f < faces.faces[i].size(); ++f) {
+			const voxel::VoxelFace &e = expected.faces[i][f];
+			const voxel::VoxelFace &g = faces.faces[i][f];
+			ASSERT_EQ(e.x, g.x) << "list " << i << " face " << f;
+			ASSERT_EQ(e.y, g.y) << "list " << i << " face " << f;
+			ASSERT_EQ(e.z, g.z) << "list " << i << " face " << f;
+			ASSERT_EQ(e.face, g.face) << "list " << i << " face " << f;
+			ASSERT_EQ(e.colorIndex, g.colorIndex) << "list " << i << " face " << f;
+			ASSERT_EQ(e.flags, g.flags) << "list " << i << " face " << f;
+			ASSERT_EQ(e.ambientOcclusion, g.ambientOcclusion) << "list " << i << " face " << f;
+		}
+	}
+	compute.shutdown();
+}
+
+TEST_F(FaceComputeTest, testMissingNeighbours) {
+	FaceCompute compute;
+	if (!compute.init()) {
+		GTEST_SKIP() << "No compute shader support";
+	}
+	const voxel::Region region(0, 7);
+	voxel::RawVolume volume(region);
+	voxel::ChunkFaces faces;
+	EXPECT_FALSE(compute.extract(volume, region, faces));
+	compute.shutdown();
+}
+
+} // namespace voxelrender
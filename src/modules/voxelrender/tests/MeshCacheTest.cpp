@@ -0,0 +1,83 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/MeshCache.h"
+#include "app/tests/AbstractTest.h"
+#include "io/BufferedReadWriteStream.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelrender {
+
+class MeshCacheTest : public app::AbstractTest {};
+
+TEST_F(MeshCacheTest, testWriteRead) {
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	volume.setVoxel(2, 1, 1, voxel::createVoxel(voxel::VoxelType::Transparent, 2));
+	voxel::ChunkMesh mesh;
+	voxel::extractCubicMesh(&volume, volume.region(), &mesh, glm::ivec3(0));
+	mesh.mesh[1].setOffset(glm::ivec3(1, 2, 3));
+	ASSERT_FALSE(mesh.mesh[0].isEmpty());
+	ASSERT_FALSE(mesh.mesh[1].isEmpty());
+
+	io::BufferedReadWriteStream stream;
+	ASSERT_TRUE(MeshCache::write(stream, mesh));
+	stream.seek(0);
+	voxel::ChunkMesh loaded;
+	ASSERT_TRUE(MeshCache::read(stream, loaded));
+	for (int i = 0; i < voxel::ChunkMesh::Meshes; ++i) {
+		const voxel::Mesh &expected = mesh.mesh[i];
+		const voxel::Mesh &actual = loaded.mesh[i];
+		EXPECT_EQ(expected.getOffset(), actual.getOffset());
+		ASSERT_EQ(expected.getNoOfVertices(), actual.getNoOfVertices());
+		ASSERT_EQ(expected.getNoOfIndices(), actual.getNoOfIndices());
+		for (size_t v = 0; v < expected.getNoOfVertices(); ++v) {
+			EXPECT_EQ(expected.getVertex((voxel::IndexType)v).position, actual.getVertex((voxel::IndexType)v).position);
+			EXPECT_EQ(expected.getVertex((voxel::IndexType)v).info, actual.getVertex((voxel::IndexType)v).info);
+			EXPECT_EQ(expected.getVertex((voxel::IndexType)v).colorIndex, actual.getVertex((voxel::IndexType)v).colorIndex);
+		}
+		for (size_t n = 0; n < expected.getNoOfIndices(); ++n) {
+			EXPECT_EQ(expected.getIndex((voxel::IndexType)n), actual.getIndex((voxel::IndexType)n));
+		}
+	}
+}
+
+TEST_F(MeshCacheTest, testReadInvalid) {
+	io::BufferedReadWriteStream stream;
+	stream.writeUInt32(42u);
+	stream.seek(0);
+	voxel::ChunkMesh mesh;
+	EXPECT_FALSE(MeshCache::read(stream, mesh));
+}
+
+TEST_F(MeshCacheTest, testKey) {
+	voxel::RawVolume volume(voxel::Region(0, 7));
+	MeshCacheSettings settings;
+	const uint64_t key = MeshCache::key(volume, glm::ivec3(2), settings);
+	EXPECT_EQ(key, MeshCache::key(volume, glm::ivec3(2), settings));
+	EXPECT_NE(key, MeshCache::key(volume, glm::ivec3(3), settings));
+
+	MeshCacheSettings noMerge = settings;
+	noMerge.mergeQuads = false;
+	EXPECT_NE(key, MeshCache::key(volume, glm::ivec3(2), noMerge));
+
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	EXPECT_NE(key, MeshCache::key(volume, glm::ivec3(2), settings));
+}
+
+TEST_F(MeshCacheTest, testSaveLoad) {
+	voxel::RawVolume volume(voxel::Region(0, 3));
+	volume.setVoxel(1, 1, 1, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	voxel::ChunkMesh mesh;
+	voxel::extractCubicMesh(&volume, volume.region(), &mesh, glm::ivec3(0));
+	const uint64_t key = MeshCache::key(volume, glm::ivec3(0), MeshCacheSettings());
+	ASSERT_TRUE(MeshCache::save(key, mesh));
+	voxel::ChunkMesh loaded;
+	ASSERT_TRUE(MeshCache::load(key, loaded));
+	EXPECT_EQ(mesh.mesh[0].getNoOfIndices(), loaded.mesh[0].getNoOfIndices());
+	EXPECT_FALSE(MeshCache::load(key + 1u, loaded));
+}
+
+} // namespace voxelrender
@@ -0,0 +1,48 @@
+/**
+ * @file
+ */
+
+#include "video/tests/AbstractGLTest.h"
+#include "noise/SimplexBatch.h"
+#include "voxel/RawVolume.h"
+#include "voxelrender/NoiseCompute.h"
+
+namespace voxelrender {
+
+class NoiseComputeTest : public video::AbstractGLTest {};
+
+TEST_F(NoiseComputeTest, testFBm) {
+	NoiseCompute compute;
+	if (!compute.init()) {
+		GTEST_SKIP() << "No compute shader support";
+	}
+	const voxel::Region region(-5, 3, -9, 28, 20, 7);
+	const float frequency = 0.07f;
+	core::DynamicArray<float> values;
+	ASSERT_TRUE(compute.fBm(region, frequency, 3, 2.0f, 0.5f, values));
+	core::DynamicArray<float> expected;
+	expected.resize(region.voxels());
+	noise::fBmGrid(expected.data(), region.getLowerCorner(), region.getDimensionsInVoxels(), frequency, 3, 2.0f, 0.5f);
+	ASSERT_EQ(expected.size(), values.size());
+	for (size_t i = 0; i < values.size(); ++i) {
+		// the cell boundaries can differ - see noise/SimplexBatch.h
+		ASSERT_NEAR(expected[i], values[i], 0.01f) << "index " << i;
+	}
+	compute.shutdown();
+}
+
+TEST_F(NoiseComputeTest, testFillVolume) {
+	NoiseCompute compute;
+	if (!compute.init()) {
+		GTEST_SKIP() << "No compute shader support";
+	}
+	const voxel::Region region(0, 0, 0, 31, 15, 31);
+	voxel::RawVolume volume(region);
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	const voxel::Region &dirty = compute.fillVolume(volume, region, voxel, 0.0f, 0.05f);
+	ASSERT_TRUE(dirty.isValid());
+	EXPECT_TRUE(region.containsRegion(dirty));
+	compute.shutdown();
+}
+
+} // namespace voxelrender
@@ -0,0 +1,43 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/PickBuffer.h"
+#include "app/tests/AbstractTest.h"
+
+namespace voxelrender {
+
+class PickBufferTest : public app::AbstractTest {};
+
+TEST_F(PickBufferTest, testDecodeMiss) {
+	const PickResult result = PickBuffer::decode(glm::vec4(0.0f), glm::ivec2(10, 20));
+	EXPECT_FALSE(result.didHit());
+	EXPECT_EQ(glm::ivec2(10, 20), result.pixel);
+	EXPECT_EQ(voxel::FaceNames::Max, result.face);
+}
+
+TEST_F(PickBufferTest, testDecodeHit) {
+	// volume index 3 and the negative y face - see the voxelpick shader
+	const float code = (float)((3 + 1) * 8 + (int)voxel::FaceNames::NegativeY);
+	const PickResult result = PickBuffer::decode(glm::vec4(code, -5.0f, 12.0f, 1023.0f), glm::ivec2(1, 2));
+	ASSERT_TRUE(result.didHit());
+	EXPECT_EQ(3, result.idx);
+	EXPECT_EQ(voxel::FaceNames::NegativeY, result.face);
+	EXPECT_EQ(glm::ivec3(-5, 12, 1023), result.voxel);
+	EXPECT_EQ(glm::ivec2(1, 2), result.pixel);
+}
+
+TEST_F(PickBufferTest, testDecodeFirstVolume) {
+	const float code = (float)(1 * 8 + (int)voxel::FaceNames::PositiveX);
+	const PickResult result = PickBuffer::decode(glm::vec4(code, 0.0f, 0.0f, 0.0f), glm::ivec2(0));
+	ASSERT_TRUE(result.didHit());
+	EXPECT_EQ(0, result.idx);
+	EXPECT_EQ(voxel::FaceNames::PositiveX, result.face);
+}
+
+TEST_F(PickBufferTest, testDecodeInvalidFace) {
+	const PickResult result = PickBuffer::decode(glm::vec4(8.0f + 7.0f, 1.0f, 2.0f, 3.0f), glm::ivec2(0));
+	EXPECT_FALSE(result.didHit());
+}
+
+} // namespace voxelrender
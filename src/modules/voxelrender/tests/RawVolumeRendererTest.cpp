@@ -68,4 +68,12 @@ TEST_F(RawVolumeRendererTest, testExtractRegionBoundary) {
 	renderer.shutdown();
 }
 
+TEST_F(RawVolumeRendererTest, testLODForVoxelSize) {
+	EXPECT_EQ(0, RawVolumeRenderer::lodForVoxelSize(0.5f, 0.0f)) << "A threshold of 0 disables the level of detail";
+	EXPECT_EQ(0, RawVolumeRenderer::lodForVoxelSize(2.0f, 2.0f));
+	EXPECT_EQ(1, RawVolumeRenderer::lodForVoxelSize(1.0f, 2.0f));
+	EXPECT_EQ(2, RawVolumeRenderer::lodForVoxelSize(0.5f, 2.0f));
+	EXPECT_EQ(RawVolumeRenderer::MaxLODs - 1, RawVolumeRenderer::lodForVoxelSize(0.01f, 2.0f));
+}
+
 } // namespace voxelrender
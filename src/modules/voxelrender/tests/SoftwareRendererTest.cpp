@@ -0,0 +1,61 @@
+/**
+ * @file
+ */
+
+#include "voxelrender/SoftwareRenderer.h"
+#include "app/tests/AbstractTest.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelrender {
+
+class SoftwareRendererTest : public app::AbstractTest {
+protected:
+	void createCube(scenegraph::SceneGraph &sceneGraph) {
+		const voxel::Region region(0, 0, 0, 15, 15, 15);
+		voxel::RawVolume *volume = new voxel::RawVolume(region);
+		volume->fill(region, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
+		node.setVolume(volume, true);
+		sceneGraph.emplace(core::move(node));
+	}
+};
+
+TEST_F(SoftwareRendererTest, testRenderCube) {
+	scenegraph::SceneGraph sceneGraph;
+	createCube(sceneGraph);
+	voxelformat::ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(64, 48);
+	ctx.clearColor = glm::vec4(1.0f, 0.0f, 1.0f, 1.0f);
+	const core::RGBA clearColor(255, 0, 255, 255);
+
+	SoftwareRenderer renderer;
+	const image::ImagePtr &image = renderer.render(sceneGraph, ctx, true);
+	ASSERT_TRUE(image);
+	ASSERT_EQ(64, image->width());
+	ASSERT_EQ(48, image->height());
+	EXPECT_EQ(clearColor, image->colorAt(0, 0)) << "Expected the corner to show the clear color";
+	EXPECT_EQ(clearColor, image->colorAt(63, 47)) << "Expected the corner to show the clear color";
+	const core::RGBA center = image->colorAt(32, 24);
+	EXPECT_NE(clearColor, center) << "Expected the cube in the center of the thumbnail";
+	EXPECT_EQ(255, center.a);
+
+	// the merged volume is kept - the same scene graph is rendered again
+	const image::ImagePtr &again = renderer.render(sceneGraph, ctx);
+	ASSERT_TRUE(again);
+	EXPECT_EQ(center, again->colorAt(32, 24));
+}
+
+TEST_F(SoftwareRendererTest, testRenderEmpty) {
+	scenegraph::SceneGraph sceneGraph;
+	voxelformat::ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(16, 16);
+	ctx.clearColor = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+	SoftwareRenderer renderer;
+	const image::ImagePtr &image = renderer.render(sceneGraph, ctx);
+	ASSERT_TRUE(image);
+	EXPECT_EQ(core::RGBA(0, 0, 255, 255), image->colorAt(8, 8));
+}
+
+} // namespace voxelrender
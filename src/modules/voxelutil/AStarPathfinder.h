@@ -83,6 +83,13 @@ public:
 	/// end node. This progress value is guaranteed to never decrease, but it may stop increasing
 	/// for short periods of time. It may even stop increasing altogether if a path cannot be found.
 	std::function<void(float)> progressCallback;
+
+	/// Use a jump point search instead of expanding every neighbour. This only works for uniform cost grids with
+	/// TwentySixConnected connectivity - for the other connectivities the regular search is used. Only the
+	/// neighbours that can't be reached by a path of the same cost through other voxels are expanded, and the
+	/// straight moves jump over the voxels until a voxel with a forced neighbour is found - this keeps the open
+	/// list small in areas that would otherwise be flooded. The search is limited to the region of the volume.
+	bool jumpPointSearch = false;
 };
 
 /**
@@ -107,6 +114,9 @@ public:
  * found then this is stored in the list which was set as the 'result' field of
  * the AStarPathfinderParams.
  *
+ * To spread the work over several frames call init() once and then step() with
+ * an iteration budget until it doesn't return PathfinderState::Searching anymore.
+ *
  * @sa AStarPathfinderParams
  */
 template<typename VolumeType>
@@ -116,8 +126,31 @@ public:
 
 	bool execute();
 
+	/**
+	 * @brief Resets the search - call step() afterwards
+	 */
+	void init();
+	/**
+	 * @brief Continues the search that was started with init()
+	 * @param maxIterations The amount of nodes that are expanded at most before this returns
+	 */
+	PathfinderState step(uint32_t maxIterations);
+
+	inline PathfinderState state() const {
+		return _state;
+	}
+
 private:
+	void expandNeighbours();
+	void expandJumpPoints();
 	void processNeighbour(const glm::ivec3& neighbourPos, float neighbourGVal);
+	void updateProgress();
+	void buildResult();
+
+	bool isValidJumpPoint(const glm::ivec3& pos) const;
+	uint32_t blockedNeighbours(const glm::ivec3& pos) const;
+	uint32_t forcedNeighbours(int direction, uint32_t blocked) const;
+	bool jump(const glm::ivec3& pos, const glm::ivec3& direction, glm::ivec3& jumpPoint) const;
 
 	float SixConnectedCost(const glm::ivec3& a, const glm::ivec3& b);
 	float EighteenConnectedCost(const glm::ivec3& a, const glm::ivec3& b);
@@ -128,12 +161,15 @@ private:
 	// Node containers
 	AllNodesContainer _allNodes;
 	OpenNodesContainer _openNodes;
-	ClosedNodesContainer _closedNodes;
 
-	// The current node
-	AllNodesContainer::iterator _current;
+	// The index of the current node
+	int _current = Node::InvalidIndex;
+	int _endNode = Node::InvalidIndex;
+	bool _jumpPointSearch = false;
+	PathfinderState _state = PathfinderState::Failed;
 
 	float _progress = 0.0f;
+	float _distStartToEnd = 0.0f;
 
 	AStarPathfinderParams<VolumeType> _params;
 };
@@ -148,38 +184,122 @@ AStarPathfinder<VolumeType>::AStarPathfinder(const AStarPathfinderParams<VolumeT
 
 template<typename VolumeType>
 bool AStarPathfinder<VolumeType>::execute() {
+	init();
+	return step(UINT32_MAX) == PathfinderState::Found;
+}
+
+template<typename VolumeType>
+void AStarPathfinder<VolumeType>::init() {
 	//Clear any existing nodes
 	_allNodes.clear();
-	_openNodes.clear();
-	_closedNodes.clear();
+	_openNodes.init(&_allNodes);
 
 	//Clear the result
 	_params.result->clear();
 
-	//Iterators to start and end node.
-	AllNodesContainer::iterator startNode = _allNodes.insert(Node(_params.start.x, _params.start.y, _params.start.z)).first;
-	AllNodesContainer::iterator endNode = _allNodes.insert(Node(_params.end.x, _params.end.y, _params.end.z)).first;
+	_jumpPointSearch = _params.jumpPointSearch && _params.connectivity == TwentySixConnected;
+	if (_params.jumpPointSearch && !_jumpPointSearch) {
+		Log::debug("Jump point search is only supported for 26-connected grids");
+	}
 
-	//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-	//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-	//and changing the object directly can break the sorting. However, in our case we have provided a
-	//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-	//modify other properties of the object while it is in the set.
-	Node* tempStart = const_cast<Node*>(&(*startNode));
-	tempStart->gVal = 0;
-	tempStart->hVal = computeH(startNode->position, endNode->position);
+	bool inserted;
+	const int startNode = _allNodes.insert(_params.start, inserted);
+	_endNode = _allNodes.insert(_params.end, inserted);
 
-	Node* tempEnd = const_cast<Node*>(&(*endNode));
-	tempEnd->hVal = 0.0f;
+	Node &start = _allNodes[startNode];
+	start.gVal = 0;
+	start.hVal = computeH(_params.start, _params.end);
+	_allNodes[_endNode].hVal = 0.0f;
 
 	_openNodes.insert(startNode);
+	_current = Node::InvalidIndex;
+	_state = PathfinderState::Searching;
 
-	float fDistStartToEnd = glm::length(glm::vec3(endNode->position) - glm::vec3(startNode->position));
+	_distStartToEnd = glm::length(glm::vec3(_params.end) - glm::vec3(_params.start));
 	_progress = 0.0f;
 	if (_params.progressCallback) {
 		_params.progressCallback(_progress);
 	}
+}
+
+template<typename VolumeType>
+PathfinderState AStarPathfinder<VolumeType>::step(uint32_t maxIterations) {
+	if (_state != PathfinderState::Searching) {
+		return _state;
+	}
+	for (uint32_t i = 0; i < maxIterations; ++i) {
+		if (_openNodes.empty()) {
+			Log::debug("We've failed to find a valid path.");
+			_state = PathfinderState::Failed;
+			return _state;
+		}
+		if (_openNodes.getFirst() == _endNode) {
+			buildResult();
+			_state = PathfinderState::Found;
+			return _state;
+		}
+
+		//Move the first node from open to closed.
+		_current = _openNodes.getFirst();
+		_openNodes.removeFirst();
+		_allNodes[_current].closed = true;
+
+		updateProgress();
+
+		if (_jumpPointSearch) {
+			expandJumpPoints();
+		} else {
+			expandNeighbours();
+		}
+
+		if (_allNodes.size() > _params.maxNumberOfNodes) {
+			Log::warn("We've reached the specified maximum number of nodes. Just give up on the search.");
+			_state = PathfinderState::Failed;
+			return _state;
+		}
+	}
+	return _state;
+}
+
+template<typename VolumeType>
+void AStarPathfinder<VolumeType>::updateProgress() {
+	//Update the user on our progress
+	if (!_params.progressCallback) {
+		return;
+	}
+	const float fMinProgresIncreament = 0.001f;
+	float fDistCurrentToEnd = glm::length(glm::vec3(_params.end) - glm::vec3(_allNodes[_current].position));
+	float fDistNormalised = fDistCurrentToEnd / _distStartToEnd;
+	float fProgress = 1.0f - fDistNormalised;
+	if (fProgress >= _progress + fMinProgresIncreament) {
+		_progress = fProgress;
+		_params.progressCallback(_progress);
+	}
+}
 
+template<typename VolumeType>
+void AStarPathfinder<VolumeType>::buildResult() {
+	// the nodes of a jump point search are no direct neighbours - fill the straight lines between them
+	int n = _endNode;
+	glm::ivec3 pos = _allNodes[n].position;
+	_params.result->insert_front(pos);
+	while (_allNodes[n].parent != Node::InvalidIndex) {
+		n = _allNodes[n].parent;
+		const glm::ivec3 &parentPos = _allNodes[n].position;
+		const glm::ivec3 dir = glm::sign(parentPos - pos);
+		while (pos != parentPos) {
+			pos += dir;
+			_params.result->insert_front(pos);
+		}
+	}
+
+	if (_params.progressCallback) {
+		_params.progressCallback(1.0f);
+	}
+}
+
+template<typename VolumeType>
+void AStarPathfinder<VolumeType>::expandNeighbours() {
 	static const glm::ivec3 arrayPathfinderFaces[6] = {
 			glm::ivec3(0, 0, -1),
 			glm::ivec3(0, 0, +1),
@@ -212,145 +332,175 @@ bool AStarPathfinder<VolumeType>::execute() {
 			glm::ivec3(+1, +1, -1),
 			glm::ivec3(+1, +1, +1) };
 
-	while (!_openNodes.empty() && _openNodes.getFirst() != endNode) {
-		//Move the first node from open to closed.
-		_current = _openNodes.getFirst();
-		_openNodes.removeFirst();
-		_closedNodes.insert(_current);
-
-		//Update the user on our progress
-		if (_params.progressCallback) {
-			const float fMinProgresIncreament = 0.001f;
-			float fDistCurrentToEnd = glm::length(glm::vec3(endNode->position) - glm::vec3(_current->position));
-			float fDistNormalised = fDistCurrentToEnd / fDistStartToEnd;
-			float fProgress = 1.0f - fDistNormalised;
-			if (fProgress >= _progress + fMinProgresIncreament) {
-				_progress = fProgress;
-				_params.progressCallback(_progress);
+	//The distance from one cell to another connected by face, edge, or corner.
+	const float fFaceCost = 1.0f;
+	const float fEdgeCost = glm::root_two<float>();
+	const float fCornerCost = glm::root_three<float>();
+
+	// the node array might grow while the neighbours are processed - don't keep a reference
+	const glm::ivec3 position = _allNodes[_current].position;
+	const float gVal = _allNodes[_current].gVal;
+
+	//Process the neighbours. Note the deliberate lack of 'break'
+	//statements, larger connectivities include smaller ones.
+	switch (_params.connectivity) {
+	case TwentySixConnected:
+		for (int i = 0; i < 8; ++i) {
+			const glm::ivec3 neighbourPos = position + arrayPathfinderCorners[i];
+			if (_params.isVoxelValidForPath(_params.volume, neighbourPos)) {
+				processNeighbour(neighbourPos, gVal + fCornerCost);
 			}
 		}
+		/* fallthrough */
 
-		//The distance from one cell to another connected by face, edge, or corner.
-		const float fFaceCost = 1.0f;
-		const float fEdgeCost = glm::root_two<float>();
-		const float fCornerCost = glm::root_three<float>();
-
-		//Process the neighbours. Note the deliberate lack of 'break'
-		//statements, larger connectivities include smaller ones.
-		switch (_params.connectivity) {
-		case TwentySixConnected:
-			processNeighbour(_current->position + arrayPathfinderCorners[0], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[1], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[2], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[3], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[4], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[5], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[6], _current->gVal + fCornerCost);
-			processNeighbour(_current->position + arrayPathfinderCorners[7], _current->gVal + fCornerCost);
-			/* fallthrough */
-
-		case EighteenConnected:
-			processNeighbour(_current->position + arrayPathfinderEdges[0], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[1], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[2], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[3], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[4], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[5], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[6], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[7], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[8], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[9], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[10], _current->gVal + fEdgeCost);
-			processNeighbour(_current->position + arrayPathfinderEdges[11], _current->gVal + fEdgeCost);
-			/* fallthrough */
-
-		case SixConnected:
-			processNeighbour(_current->position + arrayPathfinderFaces[0], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[1], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[2], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[3], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[4], _current->gVal + fFaceCost);
-			processNeighbour(_current->position + arrayPathfinderFaces[5], _current->gVal + fFaceCost);
-			break;
+	case EighteenConnected:
+		for (int i = 0; i < 12; ++i) {
+			const glm::ivec3 neighbourPos = position + arrayPathfinderEdges[i];
+			if (_params.isVoxelValidForPath(_params.volume, neighbourPos)) {
+				processNeighbour(neighbourPos, gVal + fEdgeCost);
+			}
 		}
+		/* fallthrough */
 
-		if (_allNodes.size() > _params.maxNumberOfNodes) {
-			Log::warn("We've reached the specified maximum number of nodes. Just give up on the search.");
-			break;
+	case SixConnected:
+		for (int i = 0; i < 6; ++i) {
+			const glm::ivec3 neighbourPos = position + arrayPathfinderFaces[i];
+			if (_params.isVoxelValidForPath(_params.volume, neighbourPos)) {
+				processNeighbour(neighbourPos, gVal + fFaceCost);
+			}
 		}
+		break;
 	}
+}
 
-	if (_openNodes.empty() || _openNodes.getFirst() != endNode) {
-		Log::debug("We've failed to find a valid path.");
+template<typename VolumeType>
+bool AStarPathfinder<VolumeType>::isValidJumpPoint(const glm::ivec3& pos) const {
+	// without the region a jump through free space would never end
+	if (!_params.volume->region().containsPoint(pos)) {
 		return false;
 	}
-	//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-	//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-	//and changing the object directly can break the sorting. However, in our case we have provided a
-	//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-	//modify other properties of the object while it is in the set.
-	Node* n = const_cast<Node*>(&(*endNode));
-	while (n != 0) {
-		_params.result->insert_front(n->position);
-		n = n->parent;
-	}
+	return _params.isVoxelValidForPath(_params.volume, pos);
+}
 
-	if (_params.progressCallback) {
-		_params.progressCallback(1.0f);
+template<typename VolumeType>
+uint32_t AStarPathfinder<VolumeType>::blockedNeighbours(const glm::ivec3& pos) const {
+	uint32_t blocked = 0u;
+	for (int z = -1; z <= 1; ++z) {
+		for (int y = -1; y <= 1; ++y) {
+			for (int x = -1; x <= 1; ++x) {
+				const glm::ivec3 offset(x, y, z);
+				const int idx = jumpPointIndex(offset);
+				if (idx != JumpPointCenter && !isValidJumpPoint(pos + offset)) {
+					blocked |= 1u << idx;
+				}
+			}
+		}
 	}
-
-	return true;
+	return blocked;
 }
 
 template<typename VolumeType>
-void AStarPathfinder<VolumeType>::processNeighbour(const glm::ivec3& neighbourPos, float neighbourGVal) {
-	bool bIsVoxelValidForPath = _params.isVoxelValidForPath(_params.volume, neighbourPos);
-	if (!bIsVoxelValidForPath) {
-		return;
+uint32_t AStarPathfinder<VolumeType>::forcedNeighbours(int direction, uint32_t blocked) const {
+	if (blocked == 0u) {
+		return 0u;
 	}
+	uint32_t forcedMask = 0u;
+	const JumpPointRule &rule = jumpPointRule(direction);
+	for (const JumpPointRule::Candidate &candidate : rule.candidates) {
+		if (blocked & (1u << candidate.neighbour)) {
+			continue;
+		}
+		bool forced = true;
+		for (uint32_t alternative : candidate.alternatives) {
+			if ((alternative & blocked) == 0u) {
+				forced = false;
+				break;
+			}
+		}
+		if (forced) {
+			forcedMask |= 1u << candidate.neighbour;
+		}
+	}
+	return forcedMask;
+}
 
-	float cost = neighbourGVal;
-
-	std::pair<AllNodesContainer::iterator, bool> insertResult = _allNodes.insert(Node(neighbourPos.x, neighbourPos.y, neighbourPos.z));
-	AllNodesContainer::iterator neighbour = insertResult.first;
+template<typename VolumeType>
+bool AStarPathfinder<VolumeType>::jump(const glm::ivec3& pos, const glm::ivec3& direction, glm::ivec3& jumpPoint) const {
+	const int directionIdx = jumpPointIndex(direction);
+	const bool diagonal = glm::abs(direction.x) + glm::abs(direction.y) + glm::abs(direction.z) > 1;
+	glm::ivec3 current = pos;
+	for (;;) {
+		current += direction;
+		if (!isValidJumpPoint(current)) {
+			return false;
+		}
+		// diagonal moves only advance one voxel - jumping them would also mean to scan all the straight moves they
+		// are made of for every voxel, which is more expensive in 3d than to just put the voxel into the open list
+		if (diagonal || current == _params.end || forcedNeighbours(directionIdx, blockedNeighbours(current)) != 0u) {
+			jumpPoint = current;
+			return true;
+		}
+	}
+}
 
-	if (insertResult.second) {
-		//New node, compute h.
-		Node* tempNeighbour = const_cast<Node*>(&(*neighbour));
-		tempNeighbour->hVal = computeH(neighbour->position, _params.end);
+template<typename VolumeType>
+void AStarPathfinder<VolumeType>::expandJumpPoints() {
+	const Node &current = _allNodes[_current];
+	const glm::ivec3 position = current.position;
+	const float gVal = current.gVal;
+
+	uint32_t directions;
+	if (current.parent == Node::InvalidIndex) {
+		directions = ~(1u << JumpPointCenter) & ((1u << 27) - 1u);
+	} else {
+		const glm::ivec3 dir = glm::sign(position - _allNodes[current.parent].position);
+		const int directionIdx = jumpPointIndex(dir);
+		directions = jumpPointRule(directionIdx).natural | forcedNeighbours(directionIdx, blockedNeighbours(position));
 	}
 
-	OpenNodesContainer::iterator openIter = _openNodes.find(neighbour);
-	if (openIter != _openNodes.end()) {
-		if (cost < neighbour->gVal) {
-			_openNodes.remove(openIter);
-			openIter = _openNodes.end();
+	for (int i = 0; i < 27; ++i) {
+		if ((directions & (1u << i)) == 0u) {
+			continue;
+		}
+		const glm::ivec3 dir(i % 3 - 1, (i / 3) % 3 - 1, i / 9 - 1);
+		glm::ivec3 jumpPoint;
+		if (!jump(position, dir, jumpPoint)) {
+			continue;
 		}
+		const glm::ivec3 delta = glm::abs(jumpPoint - position);
+		const int steps = core_max(delta.x, core_max(delta.y, delta.z));
+		processNeighbour(jumpPoint, gVal + (float)steps * glm::length(glm::vec3(dir)));
 	}
+}
+
+template<typename VolumeType>
+void AStarPathfinder<VolumeType>::processNeighbour(const glm::ivec3& neighbourPos, float neighbourGVal) {
+	float cost = neighbourGVal;
+
+	bool inserted;
+	const int neighbour = _allNodes.insert(neighbourPos, inserted);
+	Node &node = _allNodes[neighbour];
 
-	//TODO - Nodes could keep track of if they are in open or closed? And a pointer to where they are?
-	ClosedNodesContainer::iterator closedIter = _closedNodes.find(neighbour);
-	if (closedIter != _closedNodes.end()) {
-		if (cost < neighbour->gVal) {
-			//Probably shouldn't happen?
-			_closedNodes.remove(closedIter);
-			closedIter = _closedNodes.end();
+	if (inserted) {
+		//New node, compute h.
+		node.hVal = computeH(neighbourPos, _params.end);
+	} else if (!(cost < node.gVal)) {
+		// the node is already open or closed with a cheaper path
+		if (node.heapIndex != Node::InvalidIndex || node.closed) {
+			return;
 		}
 	}
 
-	if (openIter == _openNodes.end() && closedIter == _closedNodes.end()) {
-		//Regarding the const_cast - normally you should not modify an object which is in an std::set.
-		//The reason is that objects in a set are stored sorted in a tree so they can be accessed quickly,
-		//and changing the object directly can break the sorting. However, in our case we have provided a
-		//custom sort operator for the set which we know only uses the position to sort. Hence we can safely
-		//modify other properties of the object while it is in the set.
-		Node* temp = const_cast<Node*>(&(*neighbour));
-		temp->gVal = cost;
-		_openNodes.insert(neighbour);
-		temp->parent = const_cast<Node*>(&(*_current));
+	node.gVal = cost;
+	node.parent = _current;
+	if (node.heapIndex != Node::InvalidIndex) {
+		_openNodes.decreased(neighbour);
+		return;
 	}
+	// a closed node that was reached with a cheaper path is opened again
+	node.closed = false;
+	_openNodes.insert(neighbour);
 }
-
 template<typename VolumeType>
 float AStarPathfinder<VolumeType>::SixConnectedCost(const glm::ivec3& a, const glm::ivec3& b) {
 	//This is the only heuristic I'm sure of - just use the manhatten distance for the 6-connected case.
@@ -376,10 +526,16 @@ float AStarPathfinder<VolumeType>::TwentySixConnectedCost(const glm::ivec3& a, c
 	array[1] = glm::abs(a.y - b.y);
 	array[2] = glm::abs(a.z - b.z);
 
-	//Maybe this is better implemented directly
-	//using three compares and two swaps... but not
-	//until the profiler says so.
-	std::sort(&array[0], &array[3]);
+	//Sort the three values with three compares and swaps
+	if (array[0] > array[1]) {
+		core::exchange(array[0], array[1]);
+	}
+	if (array[1] > array[2]) {
+		core::exchange(array[1], array[2]);
+	}
+	if (array[0] > array[1]) {
+		core::exchange(array[0], array[1]);
+	}
 
 	const uint32_t cornerSteps = array[0];
 	const uint32_t edgeSteps = array[1] - array[0];
@@ -428,11 +584,7 @@ float AStarPathfinder<VolumeType>::computeH(const glm::ivec3& a, const glm::ivec
 	//length, and so far fewer nodes must be expanded to find the shortest path.
 	//See http://theory.stanford.edu/~amitp/GameProgramming/Heuristics.html#S12
 
-	//Note that if the hash is zero we can have differences between the Linux vs. Windows
-	//(or perhaps GCC vs. VS) versions of the code. This is probably because of the way
-	//sorting inside the std::set works (i.e. one system swaps values which are identical
-	//while the other one doesn't - both approaches are valid). For the same reason we want
-	//to make sure that position (x,y,z) has a different hash from e.g. position (x,z,y).
+	//We want to make sure that position (x,y,z) has a different hash from e.g. position (x,z,y).
 	const uint32_t aX = (a.x << 16) & 0x00FF0000;
 	const uint32_t aY = (a.y << 8) & 0x0000FF00;
 	const uint32_t aZ = (a.z) & 0x000000FF;
@@ -0,0 +1,123 @@
+/**
+ * @file
+ */
+
+#include "AStarPathfinderImpl.h"
+#include "core/Assert.h"
+#include <glm/gtc/constants.hpp>
+
+namespace voxelutil {
+
+static inline glm::ivec3 jumpPointOffset(int idx) {
+	return glm::ivec3(idx % 3 - 1, (idx / 3) % 3 - 1, idx / 9 - 1);
+}
+
+static inline float moveCost(const glm::ivec3 &d) {
+	const int n = glm::abs(d.x) + glm::abs(d.y) + glm::abs(d.z);
+	if (n == 1) {
+		return 1.0f;
+	}
+	if (n == 2) {
+		return glm::root_two<float>();
+	}
+	return glm::root_three<float>();
+}
+
+static inline bool isNatural(const glm::ivec3 &d, const glm::ivec3 &e) {
+	// a natural successor only uses the components of the direction of movement
+	for (int i = 0; i < 3; ++i) {
+		if (e[i] != 0 && e[i] != d[i]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Collects the intermediate cells of all paths from @c from to @c target inside the neighbourhood that don't
+ * touch the center cell and don't exceed the given cost
+ */
+static void collectAlternatives(const glm::ivec3 &from, const glm::ivec3 &target, float cost, uint32_t mask,
+								int depth, JumpPointRule::Candidate &candidate) {
+	if (from == target) {
+		for (uint32_t alternative : candidate.alternatives) {
+			if (alternative == mask) {
+				return;
+			}
+		}
+		candidate.alternatives.push_back(mask);
+		return;
+	}
+	// with a cost of at most 2*sqrt(3) the paths can't have more than three moves
+	if (depth >= 3) {
+		return;
+	}
+	for (int i = 0; i < 27; ++i) {
+		if (i == JumpPointCenter) {
+			continue;
+		}
+		const glm::ivec3 &d = jumpPointOffset(i);
+		const glm::ivec3 next = from + d;
+		if (glm::any(glm::greaterThan(glm::abs(next), glm::ivec3(1)))) {
+			continue;
+		}
+		const int nextIdx = jumpPointIndex(next);
+		if (nextIdx == JumpPointCenter) {
+			continue;
+		}
+		const float remaining = cost - moveCost(d);
+		if (remaining < -0.0001f) {
+			continue;
+		}
+		const uint32_t nextMask = next == target ? mask : (mask | (1u << nextIdx));
+		collectAlternatives(next, target, remaining, nextMask, depth + 1, candidate);
+	}
+}
+
+static void buildJumpPointRule(int direction, JumpPointRule &rule) {
+	const glm::ivec3 &d = jumpPointOffset(direction);
+	// the voxel we are coming from
+	const glm::ivec3 parent = -d;
+	for (int i = 0; i < 27; ++i) {
+		if (i == JumpPointCenter) {
+			continue;
+		}
+		const glm::ivec3 &e = jumpPointOffset(i);
+		if (isNatural(d, e)) {
+			rule.natural |= 1u << i;
+			continue;
+		}
+		JumpPointRule::Candidate candidate;
+		candidate.neighbour = i;
+		collectAlternatives(parent, e, moveCost(d) + moveCost(e), 0u, 0, candidate);
+		core_assert_msg(!candidate.alternatives.empty(), "No alternative path for a pruned neighbour");
+		bool alwaysPruned = false;
+		for (uint32_t alternative : candidate.alternatives) {
+			// a path without intermediate cells can't get blocked
+			if (alternative == 0u) {
+				alwaysPruned = true;
+				break;
+			}
+		}
+		if (!alwaysPruned) {
+			rule.candidates.push_back(core::move(candidate));
+		}
+	}
+}
+
+const JumpPointRule &jumpPointRule(int direction) {
+	core_assert(direction >= 0 && direction < 27 && direction != JumpPointCenter);
+	static const struct Rules {
+		JumpPointRule rules[27];
+		Rules() {
+			for (int i = 0; i < 27; ++i) {
+				if (i != JumpPointCenter) {
+					buildJumpPointRule(i, rules[i]);
+				}
+			}
+		}
+	} s_rules;
+	return s_rules.rules[direction];
+}
+
+} // namespace voxelutil
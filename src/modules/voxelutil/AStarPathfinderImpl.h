@@ -5,17 +5,14 @@
 #pragma once
 
 #include "core/Common.h"
-#include <glm/vec3.hpp>
-#include <algorithm>
+#include "core/GLM.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/HashMap.h"
+#include <glm/gtx/hash.hpp>
 #include <limits> //For numeric_limits
-#include <set>
-#include <vector>
 
 namespace voxelutil {
 
-class OpenNodesContainer;
-class ClosedNodesContainer;
-
 /// The Connectivity of a voxel determines how many neighbours it has.
 enum Connectivity {
 	/// Each voxel has six neighbours, which are those sharing a face.
@@ -26,10 +23,22 @@ enum Connectivity {
 	TwentySixConnected
 };
 
+/// The state of an AStarPathfinder search that is executed in steps
+enum class PathfinderState {
+	/// The search has not finished yet - call AStarPathfinder::step() again
+	Searching,
+	/// A path was found and stored in the result list
+	Found,
+	/// There is no path or the maximum number of nodes was reached
+	Failed
+};
+
 struct Node {
+	static constexpr int InvalidIndex = -1;
+
 	Node(int x, int y, int z) :
 			// Initialise with NaNs so that we will know if we forget to set these properly.
-			gVal(std::numeric_limits<float>::quiet_NaN()), hVal(std::numeric_limits<float>::quiet_NaN()), parent(nullptr) {
+			gVal(std::numeric_limits<float>::quiet_NaN()), hVal(std::numeric_limits<float>::quiet_NaN()) {
 		position = {x, y, z};
 	}
 
@@ -37,126 +46,194 @@ struct Node {
 		return position == rhs.position;
 	}
 
-	bool operator<(const Node& rhs) const {
-		if (position.x < rhs.position.x)
-			return true;
-		if (rhs.position.x < position.x)
-			return false;
-
-		if (position.y < rhs.position.y)
-			return true;
-		if (rhs.position.y < position.y)
-			return false;
-
-		if (position.z < rhs.position.z)
-			return true;
-		if (rhs.position.z < position.z)
-			return false;
-
-		return false;
-	}
-
 	glm::ivec3 position;
 	float gVal;
 	float hVal;
-	Node* parent;
+	/// Index of the parent node in the AllNodesContainer
+	int parent = InvalidIndex;
+	/// Index of the node in the binary heap of the OpenNodesContainer
+	int heapIndex = InvalidIndex;
+	bool closed = false;
 
 	inline float f() const {
 		return gVal + hVal;
 	}
 };
 
-typedef std::set<Node> AllNodesContainer;
-
-class AllNodesContainerIteratorComparator {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return (&(*lhs)) < (&(*rhs));
-	}
-};
-
-class NodeSort {
-public:
-	bool operator()(const AllNodesContainer::iterator& lhs, const AllNodesContainer::iterator& rhs) const {
-		return lhs->f() > rhs->f();
-	}
-};
-
-class OpenNodesContainer {
-public:
-	typedef std::vector<AllNodesContainer::iterator>::iterator iterator;
+/**
+ * @brief Stores all nodes of a search in one flat array - the nodes are referenced by their index
+ *
+ * The position to index lookup is done by a hash map. The index of a node stays valid until clear() is called.
+ */
+class AllNodesContainer {
+private:
+	core::DynamicArray<Node> _nodes;
+	core::HashMap<glm::ivec3, int, glm::hash<glm::ivec3>> _indices;
 
 public:
 	inline void clear() {
-		open.clear();
+		_nodes.clear();
+		_indices.clear();
 	}
 
-	inline bool empty() const {
-		return open.empty();
+	inline size_t size() const {
+		return _nodes.size();
 	}
 
-	void insert(AllNodesContainer::iterator node) {
-		open.push_back(node);
-		push_heap(open.begin(), open.end(), NodeSort());
+	/**
+	 * @return The index of the node at the given position - @c inserted is @c true if the node was created
+	 */
+	int insert(const glm::ivec3 &pos, bool &inserted) {
+		auto iter = _indices.find(pos);
+		if (iter != _indices.end()) {
+			inserted = false;
+			return iter->value;
+		}
+		const int idx = (int)_nodes.size();
+		_nodes.emplace_back(pos.x, pos.y, pos.z);
+		_indices.put(pos, idx);
+		inserted = true;
+		return idx;
 	}
 
-	inline AllNodesContainer::iterator getFirst() {
-		return open[0];
+	inline Node &operator[](int idx) {
+		return _nodes[idx];
 	}
 
-	void removeFirst() {
-		pop_heap(open.begin(), open.end(), NodeSort());
-		open.pop_back();
+	inline const Node &operator[](int idx) const {
+		return _nodes[idx];
 	}
+};
 
-	void remove(iterator iterToRemove) {
-		open.erase(iterToRemove);
-		make_heap(open.begin(), open.end(), NodeSort());
-	}
+/**
+ * @brief The cell offsets of the 3x3x3 neighbourhood of a voxel are indexed by (x+1) + (y+1)*3 + (z+1)*9 - the
+ * center is @c JumpPointCenter
+ */
+static constexpr int JumpPointCenter = 13;
 
-	inline iterator begin() {
-		return open.begin();
-	}
+inline int jumpPointIndex(const glm::ivec3 &offset) {
+	return (offset.x + 1) + (offset.y + 1) * 3 + (offset.z + 1) * 9;
+}
 
-	inline iterator end() {
-		return open.end();
-	}
+/**
+ * @brief The pruning rules of the jump point search for one direction of movement
+ *
+ * A neighbour of a voxel that was entered with the direction of this rule is either natural (always a successor),
+ * pruned (there is a path with the same or lower cost from the previous voxel that doesn't touch the current voxel)
+ * or forced. A neighbour is forced if all of the alternative paths are blocked.
+ */
+struct JumpPointRule {
+	struct Candidate {
+		/// The index of the neighbour offset
+		int neighbour;
+		/// The bit masks of the intermediate cells of the alternative paths (bits are jumpPointIndex())
+		core::DynamicArray<uint32_t> alternatives;
+	};
+	/// The directions that are always successors - bits are jumpPointIndex()
+	uint32_t natural = 0u;
+	core::DynamicArray<Candidate> candidates;
+};
 
-	iterator find(AllNodesContainer::iterator node) {
-		return std::find(open.begin(), open.end(), node);
-	}
+/**
+ * @brief The jump point search rules for 26-connected uniform cost grids
+ * @param direction The jumpPointIndex() of the movement direction
+ */
+const JumpPointRule &jumpPointRule(int direction);
 
+/**
+ * @brief Binary min heap over the f() values of the open nodes
+ *
+ * Each node knows its position in the heap - this makes the lookup if a node is open and the update of the cost of
+ * an open node cheap.
+ */
+class OpenNodesContainer {
 private:
-	std::vector<AllNodesContainer::iterator> open;
-};
-
-class ClosedNodesContainer {
-public:
-	typedef std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator>::iterator iterator;
+	core::DynamicArray<int> _heap;
+	AllNodesContainer *_nodes = nullptr;
+
+	inline bool less(int a, int b) const {
+		return (*_nodes)[_heap[a]].f() < (*_nodes)[_heap[b]].f();
+	}
+
+	inline void swap(int a, int b) {
+		const int tmp = _heap[a];
+		_heap[a] = _heap[b];
+		_heap[b] = tmp;
+		(*_nodes)[_heap[a]].heapIndex = a;
+		(*_nodes)[_heap[b]].heapIndex = b;
+	}
+
+	void siftUp(int i) {
+		while (i > 0) {
+			const int parent = (i - 1) / 2;
+			if (!less(i, parent)) {
+				break;
+			}
+			swap(i, parent);
+			i = parent;
+		}
+	}
+
+	void siftDown(int i) {
+		const int n = (int)_heap.size();
+		for (;;) {
+			const int left = i * 2 + 1;
+			if (left >= n) {
+				break;
+			}
+			int smallest = left;
+			const int right = left + 1;
+			if (right < n && less(right, left)) {
+				smallest = right;
+			}
+			if (!less(smallest, i)) {
+				break;
+			}
+			swap(i, smallest);
+			i = smallest;
+		}
+	}
 
 public:
-	inline void clear() {
-		closed.clear();
+	inline void init(AllNodesContainer *nodes) {
+		_nodes = nodes;
+		_heap.clear();
 	}
 
-	inline void insert(AllNodesContainer::iterator node) {
-		closed.insert(node);
+	inline bool empty() const {
+		return _heap.empty();
 	}
 
-	inline void remove(iterator iterToRemove) {
-		closed.erase(iterToRemove);
+	void insert(int node) {
+		const int i = (int)_heap.size();
+		_heap.push_back(node);
+		(*_nodes)[node].heapIndex = i;
+		siftUp(i);
 	}
 
-	inline iterator end() {
-		return closed.end();
+	inline int getFirst() const {
+		return _heap[0];
 	}
 
-	inline iterator find(AllNodesContainer::iterator node) {
-		return closed.find(node);
+	void removeFirst() {
+		(*_nodes)[_heap[0]].heapIndex = Node::InvalidIndex;
+		const int last = (int)_heap.size() - 1;
+		if (last > 0) {
+			_heap[0] = _heap[last];
+			(*_nodes)[_heap[0]].heapIndex = 0;
+		}
+		_heap.pop();
+		if (!_heap.empty()) {
+			siftDown(0);
+		}
+	}
+
+	/**
+	 * @brief Restores the heap order after the cost of the given open node was decreased
+	 */
+	inline void decreased(int node) {
+		siftUp((*_nodes)[node].heapIndex);
 	}
-
-private:
-	std::set<AllNodesContainer::iterator, AllNodesContainerIteratorComparator> closed;
 };
 
 }
@@ -0,0 +1,177 @@
+/**
+ * @file
+ */
+
+#include "AmbientOcclusion.h"
+#include "RaycastBatch.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/Mesh.h"
+#include "voxel/OccupancyPyramid.h"
+#include "voxel/RawVolume.h"
+#include <glm/common.hpp>
+#include <glm/geometric.hpp>
+#include <glm/ext/scalar_constants.hpp>
+#include <glm/trigonometric.hpp>
+
+namespace voxelutil {
+
+/**
+ * @brief The amount of vertices whose rays are traced by one task
+ */
+static constexpr int VertexBatchSize = 256;
+/**
+ * @brief The distance the ray origins are moved away from the surface to not hit the voxels of the vertex itself
+ */
+static constexpr float SurfaceOffset = 0.05f;
+
+/**
+ * @brief Cosine weighted directions on the hemisphere around the positive z axis - a fibonacci spiral gives an even
+ * distribution without random numbers, so the bake is deterministic
+ */
+static void hemisphereDirections(int n, core::DynamicArray<glm::vec3> &directions) {
+	directions.reserve(n);
+	const float goldenAngle = glm::pi<float>() * (3.0f - glm::sqrt(5.0f));
+	for (int i = 0; i < n; ++i) {
+		const float u = ((float)i + 0.5f) / (float)n;
+		const float r = glm::sqrt(u);
+		const float phi = (float)i * goldenAngle;
+		directions.push_back(glm::vec3(r * glm::cos(phi), r * glm::sin(phi), glm::sqrt(1.0f - u)));
+	}
+}
+
+/**
+ * @return The index of the axis if the normal is axis aligned - otherwise @c -1
+ */
+static int alignedAxis(const glm::vec3 &normal) {
+	for (int a = 0; a < 3; ++a) {
+		if (glm::abs(normal[a]) > 0.999f) {
+			return a;
+		}
+	}
+	return -1;
+}
+
+void bakeAmbientOcclusion(core::ThreadPool &threadPool, const voxel::RawVolume &volume, const voxel::Mesh &mesh,
+						  const glm::vec3 &offset, core::DynamicArray<float> &occlusion,
+						  const AmbientOcclusionConfig &config) {
+	core_trace_scoped(BakeAmbientOcclusion);
+	const voxel::VertexArray &vertices = mesh.getVertexVector();
+	const voxel::IndexArray &indices = mesh.getIndexVector();
+	const int vertexCount = (int)vertices.size();
+	occlusion.resize(vertexCount);
+	occlusion.fill(1.0f);
+	if (vertexCount == 0 || config.rays <= 0 || config.distance <= 0.0f) {
+		return;
+	}
+
+	// the normals and the direction into the faces of every vertex
+	core::DynamicArray<glm::vec3> normals;
+	normals.resize(vertexCount);
+	normals.fill(glm::vec3(0.0f));
+	core::DynamicArray<glm::vec3> inward;
+	inward.resize(vertexCount);
+	inward.fill(glm::vec3(0.0f));
+	for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+		const voxel::IndexType i0 = indices[i + 0];
+		const voxel::IndexType i1 = indices[i + 1];
+		const voxel::IndexType i2 = indices[i + 2];
+		const glm::vec3 &p0 = vertices[i0].position;
+		const glm::vec3 &p1 = vertices[i1].position;
+		const glm::vec3 &p2 = vertices[i2].position;
+		// not normalized - the length is the doubled area of the triangle
+		const glm::vec3 &faceNormal = glm::cross(p1 - p0, p2 - p0);
+		const glm::vec3 &center = (p0 + p1 + p2) / 3.0f;
+		normals[i0] += faceNormal;
+		normals[i1] += faceNormal;
+		normals[i2] += faceNormal;
+		inward[i0] += center - p0;
+		inward[i1] += center - p1;
+		inward[i2] += center - p2;
+	}
+	const voxel::NormalArray &meshNormals = mesh.getNormalVector();
+	const bool hasNormals = meshNormals.size() >= vertices.size();
+
+	// use the occupancy of the volume if it's maintained anyway
+	const voxel::OccupancyPyramid *occupancy = volume.occupancy();
+	voxel::OccupancyPyramid localOccupancy(volume.region());
+	if (occupancy == nullptr) {
+		localOccupancy.build(volume);
+		occupancy = &localOccupancy;
+	}
+
+	core::DynamicArray<glm::vec3> directions;
+	hemisphereDirections(config.rays, directions);
+	const int rays = config.rays;
+	const float distance = config.distance;
+	const float strength = config.strength;
+
+	threadPool.parallelFor(0, vertexCount, VertexBatchSize, [&](int start, int end) {
+		core::DynamicArray<BatchRay> batchRays;
+		batchRays.reserve((size_t)(end - start) * rays);
+		core::DynamicArray<int> traced;
+		traced.reserve(end - start);
+		for (int v = start; v < end; ++v) {
+			glm::vec3 normal = hasNormals ? meshNormals[v] : normals[v];
+			const float length = glm::length(normal);
+			if (length < glm::epsilon<float>()) {
+				continue;
+			}
+			normal /= length;
+			glm::vec3 origin = vertices[v].position + offset + normal * SurfaceOffset;
+			const float inwardLength = glm::length(inward[v]);
+			if (inwardLength > glm::epsilon<float>()) {
+				// move the origin off the voxel corner into the faces of the vertex
+				origin += inward[v] / inwardLength * SurfaceOffset;
+			}
+			const int axis = alignedAxis(normal);
+			if (axis != -1) {
+				glm::ivec3 lower = glm::floor(origin - distance);
+				glm::ivec3 upper = glm::floor(origin + distance);
+				const int plane = (int)glm::floor(origin[axis]);
+				if (normal[axis] > 0.0f) {
+					lower[axis] = plane;
+				} else {
+					upper[axis] = plane;
+				}
+				if (occupancy->empty(volume, voxel::Region(lower, upper))) {
+					continue;
+				}
+			}
+			// orthonormal basis around the normal
+			const glm::vec3 &helper = glm::abs(normal.x) > 0.9f ? glm::vec3(0.0f, 1.0f, 0.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+			const glm::vec3 &tangent = glm::normalize(glm::cross(helper, normal));
+			const glm::vec3 &bitangent = glm::cross(normal, tangent);
+			for (const glm::vec3 &dir : directions) {
+				BatchRay ray;
+				ray.origin = origin;
+				ray.directionAndLength = (tangent * dir.x + bitangent * dir.y + normal * dir.z) * distance;
+				batchRays.push_back(ray);
+			}
+			traced.push_back(v);
+		}
+		if (traced.empty()) {
+			return;
+		}
+		core::DynamicArray<BatchHit> hits;
+		hits.resize(batchRays.size());
+		raycastBatch(&volume, batchRays.data(), (int)batchRays.size(), hits.data());
+		for (size_t t = 0; t < traced.size(); ++t) {
+			float occluded = 0.0f;
+			for (int r = 0; r < rays; ++r) {
+				const size_t rayIdx = t * rays + r;
+				const BatchHit &hit = hits[rayIdx];
+				if (!hit.didHit) {
+					continue;
+				}
+				// near voxels occlude more than the ones at the end of the ray
+				const float hitDistance = glm::length(glm::vec3(hit.hitVoxel) + 0.5f - batchRays[rayIdx].origin);
+				occluded += 1.0f - glm::clamp(hitDistance / distance, 0.0f, 1.0f);
+			}
+			occlusion[traced[t]] = glm::clamp(1.0f - strength * occluded / (float)rays, 0.0f, 1.0f);
+		}
+	});
+}
+
+} // namespace voxelutil
@@ -0,0 +1,55 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include <glm/vec3.hpp>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxel {
+class Mesh;
+class RawVolume;
+} // namespace voxel
+
+namespace voxelutil {
+
+struct AmbientOcclusionConfig {
+	/**
+	 * @brief The amount of rays per vertex - they are distributed over the hemisphere around the vertex normal
+	 */
+	int rays = 32;
+	/**
+	 * @brief The length of the rays in voxels - voxels that are further away don't occlude the vertex
+	 */
+	float distance = 8.0f;
+	/**
+	 * @brief 1.0 darkens a vertex whose rays all hit a voxel right in front of it to black
+	 */
+	float strength = 1.0f;
+};
+
+/**
+ * @brief Bakes the ambient occlusion of the given mesh by tracing short rays from every vertex through the volume
+ *
+ * Unlike the per vertex ambient occlusion of the cubic surface extractor - that only looks at the three voxels that
+ * touch the vertex corner - this takes all voxels in the given distance into account and produces smooth values.
+ * The vertex normals are the area weighted normals of the triangles the vertex belongs to.
+ *
+ * The vertices are handed to the thread pool in batches and the rays of a batch are traced with raycastBatch(). The
+ * rays of vertices with axis aligned normals are skipped if the occupancy pyramid says that there is no voxel in
+ * reach.
+ *
+ * @param[in] offset The translation from the mesh vertices to the volume coordinates - for the cubic surface
+ * extractor this is the lower corner of the extracted region minus the given translation
+ * @param[out] occlusion One value per vertex in the range [0,1] - @c 1 means that the vertex is not occluded
+ */
+void bakeAmbientOcclusion(core::ThreadPool &threadPool, const voxel::RawVolume &volume, const voxel::Mesh &mesh,
+						  const glm::vec3 &offset, core::DynamicArray<float> &occlusion,
+						  const AmbientOcclusionConfig &config = AmbientOcclusionConfig());
+
+} // namespace voxelutil
@@ -3,6 +3,7 @@
  */
 
 #include "ImageUtils.h"
+#include "app/App.h"
 #include "core/StringUtil.h"
 #include "io/FileStream.h"
 #include "io/FormatDescription.h"
@@ -14,6 +15,9 @@
 #include "core/Assert.h"
 #include "core/Color.h"
 #include "core/Log.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
 #include "core/GLM.h"
 #include "voxelformat/VolumeFormat.h"
 #include "voxel/PaletteLookup.h"
@@ -21,27 +25,44 @@
 
 namespace voxelutil {
 
+/**
+ * @brief The image pixel that is sampled for each voxel column along one axis of the volume
+ */
+static void samplePositions(int imageSize, int volumeSize, core::DynamicArray<int> &positions) {
+	positions.resize(volumeSize);
+	const float stepWidth = (float)imageSize / (float)volumeSize;
+	float imagePos = 0.0f;
+	for (int i = 0; i < volumeSize; ++i, imagePos += stepWidth) {
+		positions[i] = (int)imagePos;
+	}
+}
+
 int importHeightMaxHeight(const image::ImagePtr &image, bool alpha) {
 	const int w = image->width();
 	const int h = image->height();
-	int maxHeight = 0;
-	int minHeight = 255;
-	if (alpha) {
-		for (int x = 0; x < w; ++x) {
-			for (int y = 0; y < h; ++y) {
-				const uint8_t alphaVal = image->colorAt(x, y).a;
-				maxHeight = core_max(maxHeight, alphaVal);
-				minHeight = core_min(minHeight, alphaVal);
-			}
-		}
-	} else {
-		for (int x = 0; x < w; ++x) {
-			for (int y = 0; y < h; ++y) {
-				const uint8_t redVal = image->colorAt(x, y).r;
-				maxHeight = core_max(maxHeight, redVal);
-				minHeight = core_min(minHeight, redVal);
+	core::DynamicArray<uint8_t> rowMax;
+	core::DynamicArray<uint8_t> rowMin;
+	rowMax.resize(h);
+	rowMin.resize(h);
+	app::App::getInstance()->threadPool().parallelFor(0, h, 1, [&](int start, int end) {
+		for (int y = start; y < end; ++y) {
+			uint8_t maxVal = 0;
+			uint8_t minVal = 255;
+			for (int x = 0; x < w; ++x) {
+				const core::RGBA color = image->colorAt(x, y);
+				const uint8_t val = alpha ? color.a : color.r;
+				maxVal = core_max(maxVal, val);
+				minVal = core_min(minVal, val);
 			}
+			rowMax[y] = maxVal;
+			rowMin[y] = minVal;
 		}
+	});
+	int maxHeight = 0;
+	int minHeight = 255;
+	for (int y = 0; y < h; ++y) {
+		maxHeight = core_max(maxHeight, (int)rowMax[y]);
+		minHeight = core_min(minHeight, (int)rowMin[y]);
 	}
 	if (maxHeight == minHeight) {
 		return 1;
@@ -50,95 +71,96 @@ int importHeightMaxHeight(const image::ImagePtr &image, bool alpha) {
 }
 
 void importColoredHeightmap(voxel::RawVolumeWrapper& volume, voxel::PaletteLookup &palLookup, const image::ImagePtr& image, const voxel::Voxel &underground) {
-	const int imageWidth = image->width();
-	const int imageHeight = image->height();
+	core_trace_scoped(ImportColoredHeightmap);
 	const voxel::Region& region = volume.region();
 	const int volumeHeight = region.getHeightInVoxels();
 	const int volumeWidth = region.getWidthInVoxels();
 	const int volumeDepth = region.getDepthInVoxels();
 	const glm::ivec3& mins = region.getLowerCorner();
-	const float stepWidthY = (float)imageHeight / (float)volumeDepth;
-	const float stepWidthX = (float)imageWidth / (float)volumeWidth;
 	const float scaleHeight = (float)volumeHeight / (float)255.0f;
-	float imageY = 0.0f;
-	for (int z = 0; z < volumeDepth; ++z, imageY += stepWidthY) {
-		float imageX = 0.0f;
-		for (int x = 0; x < volumeWidth; ++x, imageX += stepWidthX) {
-			const core::RGBA heightmapPixel = image->colorAt((int)imageX, (int)imageY);
-			const uint8_t heightValue = (uint8_t)(glm::round((float)(heightmapPixel.a) * scaleHeight));
+	core::DynamicArray<int> imageXs;
+	core::DynamicArray<int> imageYs;
+	samplePositions(image->width(), volumeWidth, imageXs);
+	samplePositions(image->height(), volumeDepth, imageYs);
 
-			if (voxel::isAir(underground.getMaterial())) {
-				const glm::ivec3 pos(x, heightValue - 1, z);
-				const glm::ivec3 regionPos = mins + pos;
-				if (!region.containsPoint(regionPos)) {
-					continue;
-				}
+	// the columns are sampled in parallel - the lookup caches the palette index of the colors
+	const size_t columns = (size_t)volumeWidth * (size_t)volumeDepth;
+	core::DynamicArray<uint8_t> heights;
+	heights.resize(columns);
+	core::DynamicArray<voxel::Voxel> surfaces;
+	surfaces.resize(columns);
+	app::App::getInstance()->threadPool().parallelFor(0, volumeDepth, 1, [&](int start, int end) {
+		for (int z = start; z < end; ++z) {
+			for (int x = 0; x < volumeWidth; ++x) {
+				const size_t column = (size_t)z * volumeWidth + x;
+				const core::RGBA heightmapPixel = image->colorAt(imageXs[x], imageYs[z]);
+				heights[column] = (uint8_t)(glm::round((float)(heightmapPixel.a) * scaleHeight));
 				const uint8_t palidx = palLookup.findClosestIndex(core::RGBA(heightmapPixel.r, heightmapPixel.g, heightmapPixel.b));
-				const voxel::Voxel voxel = voxel::createVoxel(palLookup.palette(), palidx);
-				volume.setVoxel(regionPos, voxel);
-			} else {
-				for (int y = 0; y < heightValue; ++y) {
-					const glm::ivec3 pos(x, y, z);
-					const glm::ivec3 regionPos = mins + pos;
-					if (!region.containsPoint(regionPos)) {
-						continue;
-					}
-					voxel::Voxel voxel;
-					if (y < heightValue - 1) {
-						voxel = underground;
-					} else {
-						const uint8_t palidx = palLookup.findClosestIndex(core::RGBA(heightmapPixel.r, heightmapPixel.g, heightmapPixel.b));
-						voxel = voxel::createVoxel(palLookup.palette(), palidx);
-					}
-					volume.setVoxel(regionPos, voxel);
-				}
+				surfaces[column] = voxel::createVoxel(palLookup.palette(), palidx);
+			}
+		}
+	});
+
+	const bool surfaceOnly = voxel::isAir(underground.getMaterial());
+	for (int z = 0; z < volumeDepth; ++z) {
+		for (int x = 0; x < volumeWidth; ++x) {
+			const size_t column = (size_t)z * volumeWidth + x;
+			const int heightValue = heights[column];
+			if (heightValue <= 0) {
+				continue;
+			}
+			const glm::ivec3 surfacePos = mins + glm::ivec3(x, heightValue - 1, z);
+			if (!surfaceOnly && heightValue > 1) {
+				volume.fill(voxel::Region(mins + glm::ivec3(x, 0, z), surfacePos - glm::ivec3(0, 1, 0)), underground);
+			}
+			if (region.containsPoint(surfacePos)) {
+				volume.setVoxel(surfacePos, surfaces[column]);
 			}
 		}
 	}
 }
 
 void importHeightmap(voxel::RawVolumeWrapper& volume, const image::ImagePtr& image, const voxel::Voxel &underground, const voxel::Voxel &surface) {
-	const int imageWidth = image->width();
-	const int imageHeight = image->height();
+	core_trace_scoped(ImportHeightmap);
 	const voxel::Region& region = volume.region();
 	const int volumeHeight = region.getHeightInVoxels();
 	const int volumeWidth = region.getWidthInVoxels();
 	const int volumeDepth = region.getDepthInVoxels();
 	const glm::ivec3& mins = region.getLowerCorner();
-	const float stepWidthY = (float)imageHeight / (float)volumeDepth;
-	const float stepWidthX = (float)imageWidth / (float)volumeWidth;
 	const int maxImageHeight = importHeightMaxHeight(image, true);
 	const float scaleHeight = (float)volumeHeight / (float)maxImageHeight;
-	float imageY = 0.0f;
-	for (int z = 0; z < volumeDepth; ++z, imageY += stepWidthY) {
-		float imageX = 0.0f;
-		for (int x = 0; x < volumeWidth; ++x, imageX += stepWidthX) {
-			const core::RGBA heightmapPixel = image->colorAt((int)imageX, (int)imageY);
-			const uint8_t heightValue = (uint8_t)(glm::round((float)(heightmapPixel.r) * scaleHeight));
+	core::DynamicArray<int> imageXs;
+	core::DynamicArray<int> imageYs;
+	samplePositions(image->width(), volumeWidth, imageXs);
+	samplePositions(image->height(), volumeDepth, imageYs);
 
-			if (voxel::isAir(underground.getMaterial())) {
-				const glm::ivec3 pos(x, heightValue - 1, z);
-				const glm::ivec3 regionPos = mins + pos;
-				if (!region.containsPoint(regionPos)) {
-					continue;
-				}
-				volume.setVoxel(regionPos, surface);
-			} else {
-				for (int y = 0; y < heightValue; ++y) {
-					const glm::ivec3 pos(x, y, z);
-					const glm::ivec3 regionPos = mins + pos;
-					if (!region.containsPoint(regionPos)) {
-						continue;
-					}
-					voxel::Voxel voxel;
-					if (y < heightValue) {
-						voxel = underground;
-					} else if (y == heightValue) {
-						voxel = surface;
-					}
-					volume.setVoxel(regionPos, voxel);
+	core::DynamicArray<uint8_t> heights;
+	heights.resize((size_t)volumeWidth * (size_t)volumeDepth);
+	app::App::getInstance()->threadPool().parallelFor(0, volumeDepth, 1, [&](int start, int end) {
+		for (int z = start; z < end; ++z) {
+			for (int x = 0; x < volumeWidth; ++x) {
+				const core::RGBA heightmapPixel = image->colorAt(imageXs[x], imageYs[z]);
+				heights[(size_t)z * volumeWidth + x] = (uint8_t)(glm::round((float)(heightmapPixel.r) * scaleHeight));
+			}
+		}
+	});
+
+	const bool surfaceOnly = voxel::isAir(underground.getMaterial());
+	for (int z = 0; z < volumeDepth; ++z) {
+		for (int x = 0; x < volumeWidth; ++x) {
+			const int heightValue = heights[(size_t)z * volumeWidth + x];
+			if (heightValue <= 0) {
+				continue;
+			}
+			const glm::ivec3 surfacePos = mins + glm::ivec3(x, heightValue - 1, z);
+			if (surfaceOnly) {
+				if (region.containsPoint(surfacePos)) {
+					volume.setVoxel(surfacePos, surface);
 				}
+				continue;
 			}
+			// the whole column up to the height is filled at once
+			volume.fill(voxel::Region(mins + glm::ivec3(x, 0, z), surfacePos), underground);
 		}
 	}
 }
@@ -163,20 +185,39 @@ voxel::RawVolume* importAsPlane(const image::ImagePtr& image, uint8_t thickness)
 		return nullptr;
 	}
 	Log::info("Import image as plane: w(%i), h(%i), d(%i)", imageWidth, imageHeight, thickness);
+	core_trace_scoped(ImportAsPlane);
 	const voxel::Region region(0, 0, 0, imageWidth - 1, imageHeight - 1, thickness - 1);
-	const voxel::Palette &palette = voxel::getPalette();
+	voxel::PaletteLookup palLookup(voxel::getPalette());
+	core::DynamicArray<voxel::Voxel> voxels;
+	voxels.resize((size_t)imageWidth * (size_t)imageHeight);
+	app::App::getInstance()->threadPool().parallelFor(0, imageHeight, 1, [&](int start, int end) {
+		for (int y = start; y < end; ++y) {
+			for (int x = 0; x < imageWidth; ++x) {
+				const core::RGBA data = image->colorAt(x, y);
+				if (data.a == 0) {
+					continue;
+				}
+				const uint8_t index = palLookup.findClosestIndex(data);
+				voxels[(size_t)y * imageWidth + x] = voxel::createVoxel(palLookup.palette(), index);
+			}
+		}
+	});
+
 	voxel::RawVolume* volume = new voxel::RawVolume(region);
-	for (int x = 0; x < imageWidth; ++x) {
-		for (int y = 0; y < imageHeight; ++y) {
-			const core::RGBA data = image->colorAt(x, y);
-			if (data.a == 0) {
-				continue;
+	for (int y = 0; y < imageHeight; ++y) {
+		const voxel::Voxel *row = &voxels[(size_t)y * imageWidth];
+		const int volumeY = (imageHeight - 1) - y;
+		// the runs of the same color are filled through all layers at once
+		for (int x = 0; x < imageWidth;) {
+			const voxel::Voxel &voxel = row[x];
+			int runEnd = x + 1;
+			while (runEnd < imageWidth && row[runEnd].isSame(voxel)) {
+				++runEnd;
 			}
-			const uint8_t index = palette.getClosestMatch(data);
-			const voxel::Voxel voxel = voxel::createVoxel(palette, index);
-			for (int z = 0; z < thickness; ++z) {
-				volume->setVoxel(x, (imageHeight - 1) - y, z, voxel);
+			if (!voxel::isAir(voxel.getMaterial())) {
+				volume->fill(voxel::Region(x, volumeY, 0, runEnd - 1, volumeY, thickness - 1), voxel);
 			}
+			x = runEnd;
 		}
 	}
 	return volume;
@@ -216,36 +257,53 @@ voxel::RawVolume* importAsVolume(const image::ImagePtr& image, uint8_t maxDepth,
 		return nullptr;
 	}
 	Log::info("Import image as volume: w(%i), h(%i), d(%i)", imageWidth, imageHeight, volumeDepth);
+	core_trace_scoped(ImportAsVolume);
 	const voxel::Region region(0, 0, 0, imageWidth - 1, imageHeight - 1, volumeDepth - 1);
 	voxel::PaletteLookup palLookup(voxel::getPalette());
-	voxel::RawVolume* volume = new voxel::RawVolume(region);
-	for (int x = 0; x < imageWidth; ++x) {
-		for (int y = 0; y < imageHeight; ++y) {
-			const core::RGBA data = image->colorAt(x, y);
-			if (data.a == 0) {
-				continue;
-			}
-			const glm::vec4& color = core::Color::fromRGBA(data);
-			const uint8_t index = palLookup.findClosestIndex(color);
-			const voxel::Voxel voxel = voxel::createVoxel(palLookup.palette(), index);
-			const core::RGBA heightdata = heightmap->colorAt(x, y);
-			const float thickness = (float)heightdata.rgba;
-			const float maxthickness = maxDepth;
-			const float height = thickness * maxthickness / 255.0f;
-			if (bothSides) {
-				const int heighti = (int)glm::ceil(height/ 2.0f);
-				const int minZ = maxDepth - heighti;
-				const int maxZ = maxDepth + heighti;
-				for (int z = minZ; z <= maxZ; ++z) {
-					volume->setVoxel(x, (imageHeight - 1) - y, z, voxel);
+	const size_t pixels = (size_t)imageWidth * (size_t)imageHeight;
+	core::DynamicArray<voxel::Voxel> voxels;
+	voxels.resize(pixels);
+	// the z span of the voxels of each pixel
+	core::DynamicArray<glm::ivec2> spans;
+	spans.resize(pixels);
+	app::App::getInstance()->threadPool().parallelFor(0, imageHeight, 1, [&](int start, int end) {
+		for (int y = start; y < end; ++y) {
+			for (int x = 0; x < imageWidth; ++x) {
+				const size_t pixel = (size_t)y * imageWidth + x;
+				const core::RGBA data = image->colorAt(x, y);
+				if (data.a == 0) {
+					continue;
 				}
-			} else {
-				const int heighti = (int)glm::ceil(height);
-				for (int z = 0; z < heighti; ++z) {
-					volume->setVoxel(x, (imageHeight - 1) - y, z, voxel);
+				const glm::vec4& color = core::Color::fromRGBA(data);
+				const uint8_t index = palLookup.findClosestIndex(color);
+				voxels[pixel] = voxel::createVoxel(palLookup.palette(), index);
+				const core::RGBA heightdata = heightmap->colorAt(x, y);
+				const float thickness = (float)heightdata.rgba;
+				const float maxthickness = maxDepth;
+				const float height = thickness * maxthickness / 255.0f;
+				if (bothSides) {
+					const int heighti = (int)glm::ceil(height / 2.0f);
+					spans[pixel] = glm::ivec2(maxDepth - heighti, maxDepth + heighti);
+				} else {
+					const int heighti = (int)glm::ceil(height);
+					spans[pixel] = glm::ivec2(0, heighti - 1);
 				}
 			}
 		}
+	});
+
+	voxel::RawVolume* volume = new voxel::RawVolume(region);
+	for (int y = 0; y < imageHeight; ++y) {
+		for (int x = 0; x < imageWidth; ++x) {
+			const size_t pixel = (size_t)y * imageWidth + x;
+			const voxel::Voxel &voxel = voxels[pixel];
+			const glm::ivec2 &span = spans[pixel];
+			if (voxel::isAir(voxel.getMaterial()) || span.y < span.x) {
+				continue;
+			}
+			const int volumeY = (imageHeight - 1) - y;
+			volume->fill(voxel::Region(x, volumeY, span.x, x, volumeY, span.y), voxel);
+		}
 	}
 	return volume;
 }
@@ -86,4 +86,21 @@ PickResult pickVoxel(const VolumeType* volData, const glm::vec3& v3dStart, const
 	return functor._result;
 }
 
+/**
+ * @brief Pick the first solid voxel along a vector - this is using the voxel::OccupancyPyramid of the volume
+ * to skip empty space if it's enabled
+ * @note If the occupancy is used, the previous position is only valid if a voxel was hit
+ * @sa raycastWithDirectionSkipEmpty()
+ */
+inline PickResult pickVoxel(const voxel::RawVolume* volData, const glm::vec3& v3dStart, const glm::vec3& v3dDirectionAndLength, const voxel::Voxel& emptyVoxelExample) {
+	core_trace_scoped(pickVoxel);
+	RaycastPickingFunctor<voxel::RawVolume> functor(emptyVoxelExample);
+	if (volData->occupancy() != nullptr && voxel::isAir(emptyVoxelExample.getMaterial())) {
+		raycastWithDirectionSkipEmpty(volData, v3dStart, v3dDirectionAndLength, functor);
+	} else {
+		raycastWithDirection(volData, v3dStart, v3dDirectionAndLength, functor);
+	}
+	return functor._result;
+}
+
 }
@@ -5,10 +5,12 @@
 #pragma once
 
 #include "core/Trace.h"
+#include "voxel/OccupancyPyramid.h"
 #include "voxel/RawVolume.h"
 #include "core/Common.h"
 #include <glm/ext/scalar_constants.hpp>
 #include <glm/common.hpp>
+#include <glm/geometric.hpp>
 
 namespace voxelutil {
 namespace RaycastResults {
@@ -227,4 +229,92 @@ RaycastResult raycastWithDirection(Volume* volData, const glm::vec3& v3dStart, c
 	return raycastWithEndpoints<Callback, Volume>(volData, v3dStart, v3dEnd, core::forward<Callback>(callback));
 }
 
+/**
+ * Cast a ray through a volume like @c raycastWithDirection() - but skip the empty bricks of the
+ * voxel::OccupancyPyramid of the volume.
+ *
+ * @note The @a callback is only called for the voxels of bricks that contain at least one non-air voxel - and
+ * never for positions outside of the volume. Callbacks that track the empty positions along the ray (like the
+ * previous position of a pick) get only the positions that are close to solid voxels.
+ * @note Falls back to @c raycastWithDirection() if the occupancy is not enabled for the volume.
+ * @sa voxel::RawVolume::enableOccupancy()
+ */
+template<typename Callback>
+RaycastResult raycastWithDirectionSkipEmpty(const voxel::RawVolume* volData, const glm::vec3& v3dStart, const glm::vec3& v3dDirectionAndLength, Callback&& callback) {
+	const voxel::OccupancyPyramid *occupancy = volData->occupancy();
+	if (occupancy == nullptr) {
+		return raycastWithDirection(volData, v3dStart, v3dDirectionAndLength, core::forward<Callback>(callback));
+	}
+	core_trace_scoped(raycastWithDirectionSkipEmpty);
+	const voxel::Region &region = occupancy->region();
+	const glm::vec3 &mins = region.getLowerCornerf();
+	const glm::vec3 maxs = region.getUpperCornerf() + 1.0f;
+	const float length = glm::length(v3dDirectionAndLength);
+	if (length < glm::epsilon<float>()) {
+		return RaycastResults::Completed;
+	}
+
+	// clip the ray against the volume - the parameter is in the range [0,1] of the given direction vector
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+	for (int i = 0; i < 3; ++i) {
+		const float d = v3dDirectionAndLength[i];
+		if (glm::abs(d) < glm::epsilon<float>()) {
+			if (v3dStart[i] < mins[i] || v3dStart[i] >= maxs[i]) {
+				return RaycastResults::Completed;
+			}
+			continue;
+		}
+		float t1 = (mins[i] - v3dStart[i]) / d;
+		float t2 = (maxs[i] - v3dStart[i]) / d;
+		if (t1 > t2) {
+			core::exchange(t1, t2);
+		}
+		tMin = core_max(tMin, t1);
+		tMax = core_min(tMax, t2);
+		if (tMin > tMax) {
+			return RaycastResults::Completed;
+		}
+	}
+
+	// step a tiny bit into the brick to not end up on the border of the previous one
+	const float epsilon = 0.001f / length;
+	float t = tMin;
+	while (t < tMax) {
+		const glm::vec3 &p = v3dStart + v3dDirectionAndLength * (t + epsilon);
+		const glm::ivec3 pos(glm::floor(p));
+		// find the biggest empty brick the position is in
+		int emptyLevel = -1;
+		for (int level = voxel::OccupancyPyramid::Levels - 1; level >= 0; --level) {
+			if (!occupancy->occupied(level, pos)) {
+				emptyLevel = level;
+				break;
+			}
+		}
+		const int brickLevel = emptyLevel >= 0 ? emptyLevel : 0;
+		const int shift = voxel::OccupancyPyramid::brickShift(brickLevel);
+		const glm::ivec3 &lower = region.getLowerCorner();
+		const glm::vec3 brickMins(lower + (((pos - lower) >> shift) << shift));
+		const glm::vec3 brickMaxs = brickMins + (float)(1 << shift);
+		float exitT = tMax;
+		for (int i = 0; i < 3; ++i) {
+			const float d = v3dDirectionAndLength[i];
+			if (d > 0.0f) {
+				exitT = core_min(exitT, (brickMaxs[i] - v3dStart[i]) / d);
+			} else if (d < 0.0f) {
+				exitT = core_min(exitT, (brickMins[i] - v3dStart[i]) / d);
+			}
+		}
+		if (emptyLevel < 0) {
+			const float endT = core_max(t + epsilon, exitT - epsilon);
+			const glm::vec3 &end = v3dStart + v3dDirectionAndLength * endT;
+			if (raycastWithEndpoints(volData, p, end, callback) == RaycastResults::Interupted) {
+				return RaycastResults::Interupted;
+			}
+		}
+		t = core_max(exitT, t + epsilon);
+	}
+	return RaycastResults::Completed;
+}
+
 }
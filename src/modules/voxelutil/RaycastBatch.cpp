@@ -0,0 +1,183 @@
+/**
+ * @file
+ */
+
+#include "RaycastBatch.h"
+#include "core/Common.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/RawVolume.h"
+#include <glm/common.hpp>
+#include <glm/ext/scalar_constants.hpp>
+#include <float.h>
+
+namespace voxelutil {
+
+namespace {
+
+/**
+ * @brief The state of the voxel traversal of @c RaycastPacketSize rays in structure of arrays layout
+ *
+ * This is the same traversal as in raycastWithEndpoints() - but the rays are clipped against the volume first and
+ * axis parallel rays are not stepping along the axes they don't move on.
+ */
+struct RayPacket {
+	int pos[3][RaycastPacketSize];
+	int end[3][RaycastPacketSize];
+	int step[3][RaycastPacketSize];
+	float t[3][RaycastPacketSize];
+	float delta[3][RaycastPacketSize];
+	voxel::FaceNames face[RaycastPacketSize];
+	bool active[RaycastPacketSize];
+};
+
+static constexpr voxel::FaceNames NegativeFaces[3] = {voxel::FaceNames::NegativeX, voxel::FaceNames::NegativeY,
+													  voxel::FaceNames::NegativeZ};
+static constexpr voxel::FaceNames PositiveFaces[3] = {voxel::FaceNames::PositiveX, voxel::FaceNames::PositiveY,
+													  voxel::FaceNames::PositiveZ};
+
+/**
+ * @return @c false if the ray doesn't touch the region
+ */
+static bool setupLane(RayPacket &packet, int lane, const voxel::Region &region, const BatchRay &ray) {
+	const glm::vec3 &mins = region.getLowerCornerf();
+	const glm::vec3 maxs = region.getUpperCornerf() + 1.0f;
+	const glm::vec3 &origin = ray.origin;
+	const glm::vec3 &dir = ray.directionAndLength;
+
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+	int entryAxis = -1;
+	for (int a = 0; a < 3; ++a) {
+		if (glm::abs(dir[a]) < glm::epsilon<float>()) {
+			if (origin[a] < mins[a] || origin[a] >= maxs[a]) {
+				return false;
+			}
+			continue;
+		}
+		float t1 = (mins[a] - origin[a]) / dir[a];
+		float t2 = (maxs[a] - origin[a]) / dir[a];
+		if (t1 > t2) {
+			core::exchange(t1, t2);
+		}
+		if (t1 > tMin) {
+			tMin = t1;
+			entryAxis = a;
+		}
+		tMax = core_min(tMax, t2);
+		if (tMin > tMax) {
+			return false;
+		}
+	}
+
+	const glm::vec3 &start = origin + dir * tMin;
+	const glm::vec3 &end = origin + dir * tMax;
+	const glm::ivec3 &lower = region.getLowerCorner();
+	const glm::ivec3 &upper = region.getUpperCorner();
+	for (int a = 0; a < 3; ++a) {
+		const int p = glm::clamp((int)glm::floor(start[a]), lower[a], upper[a]);
+		packet.pos[a][lane] = p;
+		packet.end[a][lane] = glm::clamp((int)glm::floor(end[a]), lower[a], upper[a]);
+		const float dist = glm::abs(end[a] - start[a]);
+		if (dist < glm::epsilon<float>()) {
+			packet.step[a][lane] = 0;
+			packet.delta[a][lane] = 0.0f;
+			packet.t[a][lane] = FLT_MAX;
+			continue;
+		}
+		const float delta = 1.0f / dist;
+		const float minv = (float)p;
+		if (dir[a] > 0.0f) {
+			packet.step[a][lane] = 1;
+			packet.t[a][lane] = (minv + 1.0f - start[a]) * delta;
+		} else {
+			packet.step[a][lane] = -1;
+			packet.t[a][lane] = (start[a] - minv) * delta;
+		}
+		packet.delta[a][lane] = delta;
+	}
+	if (entryAxis == -1) {
+		packet.face[lane] = voxel::FaceNames::Max;
+	} else {
+		packet.face[lane] = dir[entryAxis] > 0.0f ? NegativeFaces[entryAxis] : PositiveFaces[entryAxis];
+	}
+	return true;
+}
+
+static void tracePacket(const voxel::RawVolume *volume, const BatchRay *rays, int n, BatchHit *hits) {
+	const voxel::Region &region = volume->region();
+	const glm::ivec3 &lower = region.getLowerCorner();
+	const int width = region.getWidthInVoxels();
+	const int sliceSize = width * region.getHeightInVoxels();
+	const voxel::Voxel *data = (const voxel::Voxel *)volume->data();
+
+	RayPacket packet;
+	int active = 0;
+	for (int lane = 0; lane < RaycastPacketSize; ++lane) {
+		packet.active[lane] = false;
+		if (lane >= n) {
+			continue;
+		}
+		hits[lane].didHit = false;
+		packet.active[lane] = setupLane(packet, lane, region, rays[lane]);
+		if (packet.active[lane]) {
+			++active;
+		}
+	}
+
+	while (active > 0) {
+		for (int lane = 0; lane < RaycastPacketSize; ++lane) {
+			if (!packet.active[lane]) {
+				continue;
+			}
+			const int x = packet.pos[0][lane];
+			const int y = packet.pos[1][lane];
+			const int z = packet.pos[2][lane];
+			const int index = (x - lower.x) + (y - lower.y) * width + (z - lower.z) * sliceSize;
+			if (!voxel::isAir(data[index].getMaterial())) {
+				BatchHit &hit = hits[lane];
+				hit.didHit = true;
+				hit.hitVoxel = glm::ivec3(x, y, z);
+				hit.hitFace = packet.face[lane];
+				packet.active[lane] = false;
+				--active;
+				continue;
+			}
+			int axis = 0;
+			if (packet.t[1][lane] < packet.t[axis][lane]) {
+				axis = 1;
+			}
+			if (packet.t[2][lane] < packet.t[axis][lane]) {
+				axis = 2;
+			}
+			if (packet.step[axis][lane] == 0 || packet.pos[axis][lane] == packet.end[axis][lane]) {
+				packet.active[lane] = false;
+				--active;
+				continue;
+			}
+			packet.t[axis][lane] += packet.delta[axis][lane];
+			packet.pos[axis][lane] += packet.step[axis][lane];
+			packet.face[lane] = packet.step[axis][lane] > 0 ? NegativeFaces[axis] : PositiveFaces[axis];
+		}
+	}
+}
+
+} // namespace
+
+void raycastBatch(const voxel::RawVolume *volume, const BatchRay *rays, int n, BatchHit *hits) {
+	core_trace_scoped(RaycastBatch);
+	for (int i = 0; i < n; i += RaycastPacketSize) {
+		tracePacket(volume, rays + i, core_min(RaycastPacketSize, n - i), hits + i);
+	}
+}
+
+void raycastBatch(core::ThreadPool &threadPool, const voxel::RawVolume *volume, const BatchRay *rays, int n,
+				  BatchHit *hits, int grain) {
+	// keep the packets intact
+	grain = core_max(RaycastPacketSize, grain / RaycastPacketSize * RaycastPacketSize);
+	threadPool.parallelFor(0, n, grain, [volume, rays, hits](int start, int end) {
+		raycastBatch(volume, rays + start, end - start, hits + start);
+	});
+}
+
+} // namespace voxelutil
@@ -0,0 +1,58 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "voxel/Face.h"
+#include <glm/vec3.hpp>
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxel {
+class RawVolume;
+}
+
+namespace voxelutil {
+
+struct BatchRay {
+	glm::vec3 origin{0.0f};
+	/** the length of the vector is the length of the ray - see raycastWithDirection() */
+	glm::vec3 directionAndLength{0.0f};
+};
+
+struct BatchHit {
+	/** The location of the first non-air voxel along the ray */
+	glm::ivec3 hitVoxel{0};
+	/**
+	 * The face of the hit voxel the ray entered through - FaceNames::Max if the ray started inside of the hit
+	 * voxel
+	 */
+	voxel::FaceNames hitFace = voxel::FaceNames::Max;
+	bool didHit = false;
+};
+
+/**
+ * @brief The amount of rays that are traced in lock step
+ */
+static constexpr int RaycastPacketSize = 4;
+
+/**
+ * @brief Traces the given rays through the volume and stores the first non-air voxel of each ray in @c hits
+ *
+ * Other than the callback based raycasts, this is reading the voxel data directly and traces packets of
+ * @c RaycastPacketSize rays at once. The rays are clipped against the volume region before they are traced.
+ *
+ * @param[out] hits Must be able to hold @c n entries - the hit for @c rays[i] is stored in @c hits[i]
+ */
+void raycastBatch(const voxel::RawVolume *volume, const BatchRay *rays, int n, BatchHit *hits);
+/**
+ * @brief Distributes the rays in chunks of @c grain rays over the given thread pool. Blocks until all rays are
+ * traced.
+ */
+void raycastBatch(core::ThreadPool &threadPool, const voxel::RawVolume *volume, const BatchRay *rays, int n,
+				  BatchHit *hits, int grain = 1024);
+
+} // namespace voxelutil
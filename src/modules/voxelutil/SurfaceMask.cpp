@@ -0,0 +1,86 @@
+/**
+ * @file
+ */
+
+#include "SurfaceMask.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
+
+namespace voxelutil {
+
+SurfaceMask::SurfaceMask(core::ThreadPool &threadPool, const voxel::RawVolume &volume) : _region(volume.region()) {
+	core_trace_scoped(SurfaceMask);
+	_width = _region.getWidthInVoxels();
+	_depth = _region.getDepthInVoxels();
+	const int height = _region.getHeightInVoxels();
+	_words = (height + 63) / 64;
+	const size_t columnWords = (size_t)_width * _depth * _words;
+	const glm::ivec3 &mins = _region.getLowerCorner();
+
+	// the solid voxels of every y column
+	core::DynamicArray<uint64_t> occupancy;
+	occupancy.resize(columnWords);
+	threadPool.parallelFor(0, _width, 1, [&](int start, int end) {
+		for (int x = start; x < end; ++x) {
+			voxel::RawVolume::Sampler sampler(volume);
+			for (int z = 0; z < _depth; ++z) {
+				uint64_t *col = &occupancy[((size_t)x * _depth + z) * _words];
+				for (int w = 0; w < _words; ++w) {
+					col[w] = 0u;
+				}
+				sampler.setPosition(mins.x + x, mins.y, mins.z + z);
+				for (int y = 0; y < height; ++y) {
+					if (!voxel::isAir(sampler.voxel().getMaterial())) {
+						col[y / 64] |= (uint64_t)1u << (y % 64);
+					}
+					sampler.movePositiveY();
+				}
+			}
+		}
+	});
+
+	_faces.resize(columnWords * 6);
+	threadPool.parallelFor(0, _width, 1, [&](int start, int end) {
+		for (int x = start; x < end; ++x) {
+			for (int z = 0; z < _depth; ++z) {
+				const uint64_t *col = &occupancy[((size_t)x * _depth + z) * _words];
+				// the neighbour columns outside of the region are air
+				const uint64_t *colPosX = x + 1 < _width ? &occupancy[((size_t)(x + 1) * _depth + z) * _words] : nullptr;
+				const uint64_t *colNegX = x > 0 ? &occupancy[((size_t)(x - 1) * _depth + z) * _words] : nullptr;
+				const uint64_t *colPosZ = z + 1 < _depth ? &occupancy[((size_t)x * _depth + z + 1) * _words] : nullptr;
+				const uint64_t *colNegZ = z > 0 ? &occupancy[((size_t)x * _depth + z - 1) * _words] : nullptr;
+				uint64_t *faces = &_faces[((size_t)x * _depth + z) * 6 * _words];
+				for (int w = 0; w < _words; ++w) {
+					const uint64_t solid = col[w];
+					// the voxel above is the next bit - the carry comes from the lowest bit of the next word
+					const uint64_t above = (solid >> 1) | (w + 1 < _words ? col[w + 1] << 63 : 0u);
+					const uint64_t below = (solid << 1) | (w > 0 ? col[w - 1] >> 63 : 0u);
+					faces[0 * _words + w] = solid & ~(colPosX != nullptr ? colPosX[w] : 0u);
+					faces[1 * _words + w] = solid & ~(colNegX != nullptr ? colNegX[w] : 0u);
+					faces[2 * _words + w] = solid & ~above;
+					faces[3 * _words + w] = solid & ~below;
+					faces[4 * _words + w] = solid & ~(colPosZ != nullptr ? colPosZ[w] : 0u);
+					faces[5 * _words + w] = solid & ~(colNegZ != nullptr ? colNegZ[w] : 0u);
+				}
+			}
+		}
+	});
+}
+
+voxel::FaceBits SurfaceMask::visibleFaces(int x, int y, int z) const {
+	if (!_region.containsPoint(x, y, z)) {
+		return voxel::FaceBits::None;
+	}
+	x -= _region.getLowerX();
+	y -= _region.getLowerY();
+	z -= _region.getLowerZ();
+	const int w = y / 64;
+	const int bit = y % 64;
+	uint8_t faces = 0u;
+	for (int face = 0; face < 6; ++face) {
+		faces |= (uint8_t)(((column(face, x, z)[w] >> bit) & 1u) << face);
+	}
+	return (voxel::FaceBits)faces;
+}
+
+} // namespace voxelutil
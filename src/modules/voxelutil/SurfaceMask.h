@@ -0,0 +1,100 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/Bits.h"
+#include "core/collection/DynamicArray.h"
+#include "voxel/Face.h"
+#include "voxel/RawVolume.h"
+#include "voxel/Region.h"
+
+namespace core {
+class ThreadPool;
+}
+
+namespace voxelutil {
+
+/**
+ * @brief The visible faces of all voxels of a volume - computed in bulk for the formats that only store the surface
+ * voxels
+ *
+ * The solid voxels of every y column are put into a bitmap first. The faces of a whole column are then computed with
+ * bit operations against the bitmaps of the neighbouring columns instead of six neighbour lookups per voxel. Both
+ * passes run in parallel over slabs of the x axis.
+ *
+ * The result is the same as calling @c voxel::visibleFaces() for every voxel: the voxels outside of the region count
+ * as air.
+ */
+class SurfaceMask {
+private:
+	voxel::Region _region;
+	int _width = 0;
+	int _depth = 0;
+	/**
+	 * @brief The amount of 64 bit words of one y column
+	 */
+	int _words = 0;
+	/**
+	 * @brief One bitmap per face and column - the column of x, z starts at ((x * depth + z) * 6 + face) * words. The
+	 * face index is the bit of @c voxel::FaceBits
+	 */
+	core::DynamicArray<uint64_t> _faces;
+
+	inline const uint64_t *column(int face, int x, int z) const {
+		return &_faces[(((size_t)x * _depth + z) * 6 + face) * _words];
+	}
+
+public:
+	SurfaceMask(core::ThreadPool &threadPool, const voxel::RawVolume &volume);
+
+	const voxel::Region &region() const;
+
+	/**
+	 * @return @c voxel::FaceBits::None for air and for voxels that are completely hidden by their neighbours
+	 */
+	voxel::FaceBits visibleFaces(int x, int y, int z) const;
+
+	/**
+	 * @brief Visits the surface voxels in the order of @c voxelutil::VisitorOrder::XZY
+	 * @param visitor Called with @c (x, y, z, faces) for every voxel with at least one visible face
+	 * @return The amount of surface voxels
+	 */
+	template<class Visitor>
+	int visitSurface(Visitor &&visitor) const;
+};
+
+inline const voxel::Region &SurfaceMask::region() const {
+	return _region;
+}
+
+template<class Visitor>
+int SurfaceMask::visitSurface(Visitor &&visitor) const {
+	int cnt = 0;
+	const glm::ivec3 &mins = _region.getLowerCorner();
+	for (int x = 0; x < _width; ++x) {
+		for (int z = 0; z < _depth; ++z) {
+			for (int w = 0; w < _words; ++w) {
+				uint64_t surface = 0u;
+				for (int face = 0; face < 6; ++face) {
+					surface |= column(face, x, z)[w];
+				}
+				while (surface != 0u) {
+					const int bit = core::countTrailingZeros(surface);
+					surface &= surface - 1u;
+					// the face index is the bit of voxel::FaceBits
+					uint8_t faces = 0u;
+					for (int face = 0; face < 6; ++face) {
+						faces |= (uint8_t)(((column(face, x, z)[w] >> bit) & 1u) << face);
+					}
+					visitor(mins.x + x, mins.y + w * 64 + bit, mins.z + z, (voxel::FaceBits)faces);
+					++cnt;
+				}
+			}
+		}
+	}
+	return cnt;
+}
+
+} // namespace voxelutil
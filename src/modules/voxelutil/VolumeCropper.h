@@ -4,9 +4,11 @@
 
 #pragma once
 
+#include "voxel/OccupancyPyramid.h"
 #include "voxel/RawVolume.h"
 #include "VolumeMerger.h"
 #include "core/Common.h"
+#include <type_traits>
 
 namespace voxelutil {
 
@@ -40,11 +42,19 @@ voxel::RawVolume* cropVolume(const voxel::RawVolume* volume, const glm::ivec3& m
 template<class CropSkipCondition = CropSkipEmpty>
 voxel::RawVolume* cropVolume(const voxel::RawVolume* volume, CropSkipCondition condition = CropSkipCondition()) {
 	core_trace_scoped(CropRawVolume);
+	if (std::is_same<CropSkipCondition, CropSkipEmpty>::value && volume->occupancy() != nullptr) {
+		// the occupancy knows the tight bounds of the non-air voxels
+		const voxel::Region &solidRegion = volume->occupancy()->solidRegion(*volume);
+		if (!solidRegion.isValid()) {
+			return nullptr;
+		}
+		return cropVolume(volume, solidRegion.getLowerCorner(), solidRegion.getUpperCorner(), condition);
+	}
 	const glm::ivec3& mins = volume->mins();
 	const glm::ivec3& maxs = volume->maxs();
 	glm::ivec3 newMins((std::numeric_limits<int>::max)() / 2);
 	glm::ivec3 newMaxs((std::numeric_limits<int>::min)() / 2);
-	voxel::RawVolume::Sampler volumeSampler(volume);
+	voxel::RawVolume::DirectSampler volumeSampler(volume);
 	for (int32_t z = mins.z; z <= maxs.z; ++z) {
 		for (int32_t y = mins.y; y <= maxs.y; ++y) {
 			volumeSampler.setPosition(mins.x, y, z);
@@ -29,8 +29,8 @@ template<typename MergeCondition = MergeSkipEmpty, class Volume1, class Volume2>
 int mergeVolumes(Volume1* destination, const Volume2* source, const voxel::Region& destReg, const voxel::Region& sourceReg, MergeCondition mergeCondition = MergeCondition()) {
 	core_trace_scoped(MergeRawVolumes);
 	int cnt = 0;
-	typename Volume2::Sampler sourceSampler(source);
-	typename Volume1::Sampler destSampler(destination);
+	voxel::VolumeSampler<Volume2> sourceSampler(source);
+	voxel::VolumeSampler<Volume1> destSampler(destination);
 	const int relX = destReg.getLowerX();
 	for (int32_t z = sourceReg.getLowerZ(); z <= sourceReg.getUpperZ(); ++z) {
 		const int destZ = destReg.getLowerZ() + z - sourceReg.getLowerZ();
@@ -0,0 +1,76 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/Region.h"
+#include "voxelutil/VolumeVisitor.h"
+#include <glm/common.hpp>
+
+namespace voxelutil {
+
+/**
+ * @brief Splits the region into sub regions of @c grain voxels per axis and calls @c func(const voxel::Region&) for
+ * each of them on the given thread pool. Blocks until all sub regions are processed.
+ * @note The sub regions don't overlap.
+ */
+template<class FUNC>
+void parallelFor(core::ThreadPool &threadPool, const voxel::Region &region, int grain, FUNC &&func) {
+	if (!region.isValid()) {
+		return;
+	}
+	if (grain <= 0) {
+		grain = 1;
+	}
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	const glm::ivec3 cells = (region.getDimensionsInVoxels() + grain - 1) / grain;
+	const int n = cells.x * cells.y * cells.z;
+	threadPool.parallelFor(0, n, 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const glm::ivec3 cell(i % cells.x, (i / cells.x) % cells.y, i / (cells.x * cells.y));
+			const glm::ivec3 lower = mins + cell * grain;
+			const glm::ivec3 upper = glm::min(lower + grain - 1, maxs);
+			func(voxel::Region(lower, upper));
+		}
+	});
+}
+
+/**
+ * @brief Visits the voxels of the region in z slabs on the given thread pool
+ *
+ * The visitor is called concurrently from several threads - it must be thread-safe. The voxels of one slab are
+ * visited in ZYX order, but there is no order between the slabs.
+ *
+ * @return The amount of visited voxels
+ * @sa visitVolume()
+ */
+template<class Volume, class Visitor, typename Condition = SkipEmpty>
+int visitVolumeParallel(core::ThreadPool &threadPool, const Volume &volume, const voxel::Region &region,
+						Visitor &&visitor, Condition condition = Condition()) {
+	core_trace_scoped(VisitVolumeParallel);
+	if (!region.isValid()) {
+		return 0;
+	}
+	core::AtomicInt cnt(0);
+	// a few slabs per thread to balance the load of unevenly filled volumes
+	const int slabs = (int)threadPool.size() * 4;
+	const int grain = core_max(1, region.getDepthInVoxels() / core_max(1, slabs));
+	threadPool.parallelFor(region.getLowerZ(), region.getUpperZ() + 1, grain, [&](int start, int end) {
+		const voxel::Region slab(region.getLowerX(), region.getLowerY(), start, region.getUpperX(), region.getUpperY(),
+								 end - 1);
+		cnt.increment(visitVolume(volume, slab, 1, 1, 1, visitor, condition, VisitorOrder::ZYX));
+	});
+	return cnt;
+}
+
+template<class Volume, class Visitor, typename Condition = SkipEmpty>
+int visitVolumeParallel(core::ThreadPool &threadPool, const Volume &volume, Visitor &&visitor,
+						Condition condition = Condition()) {
+	return visitVolumeParallel(threadPool, volume, volume.region(), visitor, condition);
+}
+
+} // namespace voxelutil
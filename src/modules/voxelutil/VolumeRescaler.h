@@ -3,9 +3,12 @@
  */
 #pragma once
 
+#include "app/App.h"
 #include "core/Common.h"
 #include "core/Trace.h"
 #include "core/Color.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
 #include "voxel/Voxel.h"
@@ -37,6 +40,10 @@ static bool isHidden(Sampler &srcSampler) {
 
 /**
  * @brief Rescales a volume by sampling two voxels to produce one output voxel.
+ *
+ * The slices of the destination region are computed in parallel on the app thread pool. The results are collected
+ * in a buffer and written into the destination volume at the end.
+ *
  * @param[in] sourceVolume The source volume to resample
  * @param[in] destVolume The destination volume to resample into
  * @param[in] sourceRegion The region of the source volume to resample
@@ -46,75 +53,78 @@ static bool isHidden(Sampler &srcSampler) {
 template<typename SourceVolume, typename DestVolume>
 void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Palette &palette, const voxel::Region& sourceRegion, DestVolume& destVolume, const voxel::Region& destRegion) {
 	core_trace_scoped(RescaleVolume);
-	typename SourceVolume::Sampler srcSampler(sourceVolume);
 
 	core::DynamicArray<glm::vec4> materialColors;
 	palette.toVec4f(materialColors);
+	// the colors of the palette entries - indexed by the color index of the voxels
+	glm::vec4 colors[voxel::PaletteMaxColors];
+	for (int i = 0; i < voxel::PaletteMaxColors; ++i) {
+		colors[i] = core::Color::fromRGBA(palette.color(i));
+	}
 
 	const int32_t depth = destRegion.getDepthInVoxels();
 	const int32_t height = destRegion.getHeightInVoxels();
 	const int32_t width = destRegion.getWidthInVoxels();
+	const size_t sliceSize = (size_t)width * (size_t)height;
+	core::DynamicArray<voxel::Voxel> scaled;
+	scaled.resize(sliceSize * (size_t)depth);
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+
 	// First of all we iterate over all destination voxels and compute their color as the
 	// avg of the colors of the eight corresponding voxels in the higher resolution version.
-	for (int32_t z = 0; z < depth; ++z) {
-		for (int32_t y = 0; y < height; ++y) {
-			for (int32_t x = 0; x < width; ++x) {
-				const glm::ivec3 curPos(x, y, z);
-				const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
-				const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
-
-				float colorContributors = 0.0f;
-				float solidVoxels = 0.0f;
-				float avgColorRed = 0.0f;
-				float avgColorGreen = 0.0f;
-				float avgColorBlue = 0.0f;
-				voxel::Voxel colorGuardVoxel;
-				for (int32_t childZ = 0; childZ < 2; ++childZ) {
-					for (int32_t childY = 0; childY < 2; ++childY) {
-						for (int32_t childX = 0; childX < 2; ++childX) {
-							srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
-							if (!srcSampler.currentPositionValid()) {
-								continue;
-							}
-							const voxel::Voxel& child = srcSampler.voxel();
-
-							if (isBlocked(child.getMaterial())) {
-								++solidVoxels;
-								if (isHidden(srcSampler)) {
-									colorGuardVoxel = child;
+	threadPool.parallelFor(0, depth, 1, [&](int start, int end) {
+		voxel::VolumeSampler<SourceVolume> srcSampler(sourceVolume);
+		for (int32_t z = start; z < end; ++z) {
+			for (int32_t y = 0; y < height; ++y) {
+				voxel::Voxel *row = &scaled[(size_t)z * sliceSize + (size_t)y * width];
+				for (int32_t x = 0; x < width; ++x) {
+					const glm::ivec3 curPos(x, y, z);
+					const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
+
+					float colorContributors = 0.0f;
+					float solidVoxels = 0.0f;
+					glm::vec4 avgColor(0.0f);
+					voxel::Voxel colorGuardVoxel;
+					for (int32_t childZ = 0; childZ < 2; ++childZ) {
+						for (int32_t childY = 0; childY < 2; ++childY) {
+							for (int32_t childX = 0; childX < 2; ++childX) {
+								srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
+								if (!srcSampler.currentPositionValid()) {
 									continue;
 								}
-								const glm::vec4& color = core::Color::fromRGBA(palette.color(child.getColor()));
-								avgColorRed += color.r;
-								avgColorGreen += color.g;
-								avgColorBlue += color.b;
-								++colorContributors;
+								const voxel::Voxel& child = srcSampler.voxel();
+
+								if (isBlocked(child.getMaterial())) {
+									++solidVoxels;
+									if (isHidden(srcSampler)) {
+										colorGuardVoxel = child;
+										continue;
+									}
+									avgColor += colors[child.getColor()];
+									++colorContributors;
+								}
 							}
 						}
 					}
-				}
 
-				// We only make a voxel solid if the eight corresponding voxels are also all solid. This
-				// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
-				if (solidVoxels >= 7.0f) {
-					if (colorContributors <= 0.0f) {
-						const glm::vec4 &color = core::Color::fromRGBA(palette.color(colorGuardVoxel.getColor()));
-						avgColorRed += color.r;
-						avgColorGreen += color.g;
-						avgColorBlue += color.b;
-						++colorContributors;
+					// We only make a voxel solid if the eight corresponding voxels are also all solid. This
+					// means that higher LOD meshes actually shrink away which ensures cracks aren't visible.
+					if (solidVoxels >= 7.0f) {
+						if (colorContributors <= 0.0f) {
+							avgColor += colors[colorGuardVoxel.getColor()];
+							++colorContributors;
+						}
+						avgColor /= colorContributors;
+						avgColor.a = 1.0f;
+						const int index = core::Color::getClosestMatch(avgColor, materialColors);
+						row[x] = voxel::createVoxel(palette, index);
+					} else {
+						row[x] = voxel::Voxel();
 					}
-					const glm::vec4 avgColor(avgColorRed / colorContributors, avgColorGreen / colorContributors, avgColorBlue / colorContributors, 1.0f);
-					const int index = core::Color::getClosestMatch(avgColor, materialColors);
-					voxel::Voxel voxel = voxel::createVoxel(palette, index);
-					destVolume.setVoxel(dstPos, voxel);
-				} else {
-					const voxel::Voxel voxelAir;
-					destVolume.setVoxel(dstPos, voxelAir);
 				}
 			}
 		}
-	}
+	});
 
 	// At this point the results are usable, but we have a problem with thin structures disappearing.
 	// For example, if we have a solid blue sphere with a one voxel thick layer of red voxels on it,
@@ -122,84 +132,96 @@ void rescaleVolume(const SourceVolume& sourceVolume, const voxel::Palette &palet
 	// color changes, as this is very noticable. Our solution is to process again only those voxels
 	// which lie on a material-air boundary, and to recompute their color using a larger naighbourhood
 	// while also accounting for how visible the child voxels are.
-	typename DestVolume::Sampler dstSampler(destVolume);
-	for (int32_t z = 0; z < destRegion.getDepthInVoxels(); ++z) {
-		for (int32_t y = 0; y < destRegion.getHeightInVoxels(); ++y) {
-			for (int32_t x = 0; x < destRegion.getWidthInVoxels(); ++x) {
-				const glm::ivec3 curPos(x, y, z);
-				const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
+	// The recolored voxels go into a copy - the material of the neighbours is still read from the first pass.
+	core::DynamicArray<voxel::Voxel> recolored = scaled;
+	auto isDestAir = [&](const glm::ivec3 &pos) {
+		const glm::ivec3 local = pos - destRegion.getLowerCorner();
+		if (local.x < 0 || local.y < 0 || local.z < 0 || local.x >= width || local.y >= height || local.z >= depth) {
+			return destVolume.voxel(pos).getMaterial() == voxel::VoxelType::Air;
+		}
+		return scaled[(size_t)local.z * sliceSize + (size_t)local.y * width + local.x].getMaterial() == voxel::VoxelType::Air;
+	};
+	threadPool.parallelFor(0, depth, 1, [&](int start, int end) {
+		voxel::VolumeSampler<SourceVolume> srcSampler(sourceVolume);
+		for (int32_t z = start; z < end; ++z) {
+			for (int32_t y = 0; y < height; ++y) {
+				const size_t rowIdx = (size_t)z * sliceSize + (size_t)y * width;
+				for (int32_t x = 0; x < width; ++x) {
+					// Skip empty voxels
+					if (scaled[rowIdx + x].getMaterial() == voxel::VoxelType::Air) {
+						continue;
+					}
+					const glm::ivec3 curPos(x, y, z);
+					const glm::ivec3 dstPos = destRegion.getLowerCorner() + curPos;
+					// Only process voxels on a material-air boundary.
+					if (!isDestAir(dstPos + glm::ivec3(0, 0, -1)) && !isDestAir(dstPos + glm::ivec3(0, 0, 1))
+							&& !isDestAir(dstPos + glm::ivec3(0, -1, 0)) && !isDestAir(dstPos + glm::ivec3(0, 1, 0))
+							&& !isDestAir(dstPos + glm::ivec3(-1, 0, 0)) && !isDestAir(dstPos + glm::ivec3(1, 0, 0))) {
+						continue;
+					}
+					const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
 
-				dstSampler.setPosition(dstPos);
+					glm::vec4 total(0.0f);
+					float totalExposedFaces = 0.0f;
 
-				// Skip empty voxels
-				if (dstSampler.voxel().getMaterial() == voxel::VoxelType::Air) {
-					continue;
-				}
-				// Only process voxels on a material-air boundary.
-				if (dstSampler.peekVoxel0px0py1nz().getMaterial() != voxel::VoxelType::Air && dstSampler.peekVoxel0px0py1pz().getMaterial() != voxel::VoxelType::Air
-						&& dstSampler.peekVoxel0px1ny0pz().getMaterial() != voxel::VoxelType::Air && dstSampler.peekVoxel0px1py0pz().getMaterial() != voxel::VoxelType::Air
-						&& dstSampler.peekVoxel1nx0py0pz().getMaterial() != voxel::VoxelType::Air && dstSampler.peekVoxel1px0py0pz().getMaterial() != voxel::VoxelType::Air) {
-					continue;
-				}
-				const glm::ivec3 srcPos = sourceRegion.getLowerCorner() + curPos * 2;
-
-				float totalRed = 0.0f;
-				float totalGreen = 0.0f;
-				float totalBlue = 0.0f;
-				float totalExposedFaces = 0.0f;
-
-				// Look at the 64 (4x4x4) children
-				for (int32_t childZ = -1; childZ < 3; childZ++) {
-					for (int32_t childY = -1; childY < 3; childY++) {
-						for (int32_t childX = -1; childX < 3; childX++) {
-							srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
-
-							const voxel::Voxel& child = srcSampler.voxel();
-							if (child.getMaterial() == voxel::VoxelType::Air) {
-								continue;
-							}
+					// Look at the 64 (4x4x4) children
+					for (int32_t childZ = -1; childZ < 3; childZ++) {
+						for (int32_t childY = -1; childY < 3; childY++) {
+							for (int32_t childX = -1; childX < 3; childX++) {
+								srcSampler.setPosition(srcPos + glm::ivec3(childX, childY, childZ));
 
-							// For each small voxel, count the exposed faces and use this
-							// to determine the importance of the color contribution.
-							float exposedFaces = 0.0f;
-							if (srcSampler.peekVoxel0px0py1nz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px0py1pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px1ny0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel0px1py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel1nx0py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
-							if (srcSampler.peekVoxel1px0py0pz().getMaterial() == voxel::VoxelType::Air) {
-								++exposedFaces;
-							}
+								const voxel::Voxel& child = srcSampler.voxel();
+								if (child.getMaterial() == voxel::VoxelType::Air) {
+									continue;
+								}
 
-							const glm::vec4& color = core::Color::fromRGBA(palette.color(child.getColor()));
-							totalRed += color.r * exposedFaces;
-							totalGreen += color.g * exposedFaces;
-							totalBlue += color.b * exposedFaces;
+								// For each small voxel, count the exposed faces and use this
+								// to determine the importance of the color contribution.
+								float exposedFaces = 0.0f;
+								if (srcSampler.peekVoxel0px0py1nz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px0py1pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px1ny0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel0px1py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel1nx0py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
+								if (srcSampler.peekVoxel1px0py0pz().getMaterial() == voxel::VoxelType::Air) {
+									++exposedFaces;
+								}
 
-							totalExposedFaces += exposedFaces;
+								total += colors[child.getColor()] * exposedFaces;
+								totalExposedFaces += exposedFaces;
+							}
 						}
 					}
-				}
 
-				// Avoid divide by zero if there were no exposed faces.
-				if (totalExposedFaces <= 0.01f) {
-					++totalExposedFaces;
+					// Avoid divide by zero if there were no exposed faces.
+					if (totalExposedFaces <= 0.01f) {
+						++totalExposedFaces;
+					}
+
+					glm::vec4 avgColor = total / totalExposedFaces;
+					avgColor.a = 1.0f;
+					const int index = core::Color::getClosestMatch(avgColor, materialColors);
+					recolored[rowIdx + x] = voxel::createVoxel(palette, index);
 				}
+			}
+		}
+	});
 
-				const glm::vec4 avgColor(totalRed / totalExposedFaces, totalGreen / totalExposedFaces, totalBlue / totalExposedFaces, 1.0f);
-				const int index = core::Color::getClosestMatch(avgColor, materialColors);
-				const voxel::Voxel voxel = voxel::createVoxel(palette, index);
-				destVolume.setVoxel(dstPos, voxel);
+	for (int32_t z = 0; z < depth; ++z) {
+		for (int32_t y = 0; y < height; ++y) {
+			const size_t rowIdx = (size_t)z * sliceSize + (size_t)y * width;
+			for (int32_t x = 0; x < width; ++x) {
+				destVolume.setVoxel(destRegion.getLowerCorner() + glm::ivec3(x, y, z), recolored[rowIdx + x]);
 			}
 		}
 	}
@@ -3,8 +3,11 @@
  */
 
 #include "VolumeRotator.h"
+#include "app/App.h"
 #include "core/Assert.h"
 #include "core/GLM.h"
+#include "core/StandardLib.h"
+#include "core/concurrent/ThreadPool.h"
 #include "math/AABB.h"
 #include "math/Axis.h"
 #include "voxel/RawVolume.h"
@@ -21,6 +24,147 @@ static inline glm::vec3 transform(const glm::mat4x4 &mat, const glm::ivec3 &pos,
 	return glm::floor(mat * (glm::vec4((float)pos.x + 0.5f, (float)pos.y + 0.5f, (float)pos.z + 0.5f, 1.0f) - pivot));
 }
 
+/**
+ * @brief The destination index of a source voxel is a linear function of its local source coordinates for all axis
+ * aligned rotations and mirrors: @c offset + x * @c stride.x + y * @c stride.y + z * @c stride.z
+ */
+struct AxisMapping {
+	int64_t offset = 0;
+	glm::i64vec3 stride{0};
+};
+
+/**
+ * @brief Edge length of the cubes that are copied at once - the source and the destination voxels of one cube are
+ * kept in the cache even if the destination index jumps by whole slices of the volume for every source voxel.
+ */
+static constexpr int AxisTileSize = 16;
+
+static voxel::RawVolume *transformAxisAligned(const voxel::RawVolume *source, const voxel::Region &destRegion,
+											  const AxisMapping &mapping) {
+	const voxel::Region &srcRegion = source->region();
+	const glm::ivec3 &dim = srcRegion.getDimensionsInVoxels();
+	const voxel::Voxel *src = (const voxel::Voxel *)source->data();
+	const size_t size = (size_t)dim.x * (size_t)dim.y * (size_t)dim.z;
+	voxel::Voxel *dest = (voxel::Voxel *)core_malloc(size * sizeof(voxel::Voxel));
+	const int64_t srcYStride = dim.x;
+	const int64_t srcZStride = (int64_t)dim.x * dim.y;
+	const int slabs = (dim.z + AxisTileSize - 1) / AxisTileSize;
+
+	app::App::getInstance()->threadPool().parallelFor(0, slabs, 1, [&](int start, int end) {
+		for (int slab = start; slab < end; ++slab) {
+			const int z0 = slab * AxisTileSize;
+			const int z1 = core_min(z0 + AxisTileSize, dim.z);
+			for (int y0 = 0; y0 < dim.y; y0 += AxisTileSize) {
+				const int y1 = core_min(y0 + AxisTileSize, dim.y);
+				for (int x0 = 0; x0 < dim.x; x0 += AxisTileSize) {
+					const int x1 = core_min(x0 + AxisTileSize, dim.x);
+					for (int z = z0; z < z1; ++z) {
+						for (int y = y0; y < y1; ++y) {
+							const voxel::Voxel *srcRow = src + z * srcZStride + y * srcYStride;
+							const int64_t destRow = mapping.offset + y * mapping.stride.y + z * mapping.stride.z;
+							for (int x = x0; x < x1; ++x) {
+								dest[destRow + x * mapping.stride.x] = srcRow[x];
+							}
+						}
+					}
+				}
+			}
+		}
+	});
+	voxel::RawVolume *destination = voxel::RawVolume::createRaw(dest, destRegion);
+	destination->setBorderValue(source->borderValue());
+	return destination;
+}
+
+/**
+ * @brief Signed permutation matrix of an axis aligned rotation - the columns are the source axes
+ */
+struct AxisRotation {
+	int m[3][3];
+
+	static AxisRotation identity() {
+		AxisRotation r;
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 3; ++j) {
+				r.m[i][j] = i == j ? 1 : 0;
+			}
+		}
+		return r;
+	}
+
+	/**
+	 * @brief The rotation by +90 degree around the given axis - the same direction as glm::eulerAngleXYZ()
+	 */
+	static AxisRotation quarterTurn(int axisIdx) {
+		AxisRotation r = identity();
+		const int a = (axisIdx + 1) % 3;
+		const int b = (axisIdx + 2) % 3;
+		r.m[a][a] = 0;
+		r.m[a][b] = -1;
+		r.m[b][b] = 0;
+		r.m[b][a] = 1;
+		return r;
+	}
+
+	AxisRotation operator*(const AxisRotation &rhs) const {
+		AxisRotation r;
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 3; ++j) {
+				r.m[i][j] = m[i][0] * rhs.m[0][j] + m[i][1] * rhs.m[1][j] + m[i][2] * rhs.m[2][j];
+			}
+		}
+		return r;
+	}
+};
+
+/**
+ * @return The amount of quarter turns or @c -1 if the angle is no multiple of 90 degree
+ */
+static int quarterTurns(float angle) {
+	float a = glm::mod(angle, 360.0f);
+	if (a < 0.0f) {
+		a += 360.0f;
+	}
+	const float turns = glm::round(a / 90.0f);
+	if (glm::abs(turns * 90.0f - a) > 0.001f) {
+		return -1;
+	}
+	return (int)turns % 4;
+}
+
+/**
+ * @brief Rotates around the center of the volume without any resampling - the dimensions of the volume are swapped
+ * according to the rotation
+ */
+static voxel::RawVolume *rotateAxisAligned(const voxel::RawVolume *source, const AxisRotation &rot) {
+	const voxel::Region &srcRegion = source->region();
+	const glm::ivec3 &dim = srcRegion.getDimensionsInVoxels();
+	glm::ivec3 destDim(0);
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			destDim[i] += glm::abs(rot.m[i][j]) * dim[j];
+		}
+	}
+	const glm::i64vec3 destStride(1, destDim.x, (int64_t)destDim.x * destDim.y);
+	// the local destination coordinate i is (dim[j] - 1) - l[j] for a negative entry and l[j] for a positive one
+	AxisMapping mapping;
+	for (int i = 0; i < 3; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			if (rot.m[i][j] == 0) {
+				continue;
+			}
+			mapping.stride[j] = rot.m[i][j] * destStride[i];
+			if (rot.m[i][j] < 0) {
+				mapping.offset += (int64_t)(dim[j] - 1) * destStride[i];
+			}
+		}
+	}
+	// keep the center of the volume where it was
+	const glm::ivec3 &mins = srcRegion.getCenter() - (destDim - 1) / 2;
+	const voxel::Region destRegion(mins, mins + destDim - 1);
+	return transformAxisAligned(source, destRegion, mapping);
+}
+
 /**
  * @param[in] source The RawVolume to rotate
  * @param[in] angles The angles for the x, y and z axis given in degrees
@@ -29,6 +173,18 @@ static inline glm::vec3 transform(const glm::mat4x4 &mat, const glm::ivec3 &pos,
  */
 voxel::RawVolume *rotateVolume(const voxel::RawVolume *source, const glm::vec3 &angles,
 							   const glm::vec3 &normalizedPivot) {
+	const glm::ivec3 turns(quarterTurns(angles.x), quarterTurns(angles.y), quarterTurns(angles.z));
+	if (turns.x >= 0 && turns.y >= 0 && turns.z >= 0) {
+		// same order as glm::eulerAngleXYZ()
+		AxisRotation rot = AxisRotation::identity();
+		for (int axisIdx = 0; axisIdx < 3; ++axisIdx) {
+			const AxisRotation &quarterTurn = AxisRotation::quarterTurn(axisIdx);
+			for (int i = 0; i < turns[axisIdx]; ++i) {
+				rot = rot * quarterTurn;
+			}
+		}
+		return rotateAxisAligned(source, rot);
+	}
 	const float pitch = glm::radians(angles.x);
 	const float yaw = glm::radians(angles.y);
 	const float roll = glm::radians(angles.z);
@@ -38,8 +194,8 @@ voxel::RawVolume *rotateVolume(const voxel::RawVolume *source, const glm::vec3 &
 	const glm::vec4 pivot(srcRegion.getLowerCornerf() + normalizedPivot * glm::vec3(srcRegion.getDimensionsInVoxels()), 0.0f);
 	const voxel::Region &region = srcRegion.rotate(mat, pivot);
 	voxel::RawVolume *destination = new voxel::RawVolume(region);
-	voxel::RawVolume::Sampler destSampler(destination);
-	voxel::RawVolume::Sampler srcSampler(source);
+	voxel::RawVolume::DirectSampler destSampler(destination);
+	voxel::RawVolume::DirectSampler srcSampler(source);
 
 	for (int32_t z = srcRegion.getLowerZ(); z <= srcRegion.getUpperZ(); ++z) {
 		for (int32_t y = srcRegion.getLowerY(); y <= srcRegion.getUpperY(); ++y) {
@@ -66,58 +222,36 @@ voxel::RawVolume *rotateVolume(const voxel::RawVolume *source, const glm::vec3 &
 }
 
 voxel::RawVolume *rotateAxis(const voxel::RawVolume *source, math::Axis axis) {
-	glm::vec3 rotVec{0.0f};
-	rotVec[math::getIndexForAxis(axis)] = 90.0f;
-	return rotateVolume(source, rotVec, glm::vec3(0.5f));
+	if (axis != math::Axis::X && axis != math::Axis::Y && axis != math::Axis::Z) {
+		return nullptr;
+	}
+	return rotateAxisAligned(source, AxisRotation::quarterTurn(math::getIndexForAxis(axis)));
 }
 
 voxel::RawVolume *mirrorAxis(const voxel::RawVolume *source, math::Axis axis) {
 	const voxel::Region &srcRegion = source->region();
-	voxel::RawVolume *destination = new voxel::RawVolume(source);
-	voxel::RawVolume::Sampler destSampler(destination);
-	voxel::RawVolume::Sampler srcSampler(source);
-
-	const glm::ivec3 &mins = srcRegion.getLowerCorner();
-	const glm::ivec3 &maxs = srcRegion.getUpperCorner();
-
-	if (axis == math::Axis::X) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t y = mins.y; y <= maxs.y; ++y) {
-				srcSampler.setPosition(mins.x, y, z);
-				destSampler.setPosition(maxs.x, y, z);
-				for (int32_t x = mins.x; x <= maxs.x; ++x) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveX();
-					destSampler.moveNegativeX();
-				}
-			}
-		}
-	} else if (axis == math::Axis::Y) {
-		for (int32_t z = mins.z; z <= maxs.z; ++z) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, mins.y, z);
-				destSampler.setPosition(x, maxs.y, z);
-				for (int32_t y = mins.y; y <= maxs.y; ++y) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveY();
-					destSampler.moveNegativeY();
-				}
-			}
-		}
-	} else if (axis == math::Axis::Z) {
-		for (int32_t y = mins.y; y <= maxs.y; ++y) {
-			for (int32_t x = mins.x; x <= maxs.x; ++x) {
-				srcSampler.setPosition(x, y, mins.z);
-				destSampler.setPosition(x, y, maxs.z);
-				for (int32_t z = mins.z; z <= maxs.z; ++z) {
-					destSampler.setVoxel(srcSampler.voxel());
-					srcSampler.movePositiveZ();
-					destSampler.moveNegativeZ();
-				}
-			}
-		}
+	const glm::ivec3 &dim = srcRegion.getDimensionsInVoxels();
+	const int64_t yStride = dim.x;
+	const int64_t zStride = (int64_t)dim.x * dim.y;
+	AxisMapping mapping;
+	mapping.stride = glm::i64vec3(1, yStride, zStride);
+	switch (axis) {
+	case math::Axis::X:
+		mapping.stride.x = -1;
+		mapping.offset = dim.x - 1;
+		break;
+	case math::Axis::Y:
+		mapping.stride.y = -yStride;
+		mapping.offset = (int64_t)(dim.y - 1) * yStride;
+		break;
+	case math::Axis::Z:
+		mapping.stride.z = -zStride;
+		mapping.offset = (int64_t)(dim.z - 1) * zStride;
+		break;
+	default:
+		return new voxel::RawVolume(source);
 	}
-	return destination;
+	return transformAxisAligned(source, srcRegion, mapping);
 }
 
 } // namespace voxelutil
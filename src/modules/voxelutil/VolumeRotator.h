@@ -15,12 +15,14 @@ class Voxel;
 namespace voxelutil {
 /**
  * @brief Rotate the given volume by the given angles in degree
+ * @note If all angles are multiples of 90 degree the voxels are just moved to their new positions around the center
+ * of the volume (see rotateAxis()) without any resampling
  */
 extern voxel::RawVolume *rotateVolume(const voxel::RawVolume *source, const glm::vec3 &angles,
 									  const glm::vec3 &normalizedPivot);
 /**
  * @brief Rotate the given volume on the given axis by 90 degree. This method does not lose any voxels
- * @note The volume size might differ
+ * @note The volume size might differ - the dimensions are swapped, the center of the volume stays where it was
  */
 extern voxel::RawVolume *rotateAxis(const voxel::RawVolume *source, math::Axis axis);
 /**
@@ -3,39 +3,88 @@
  */
 
 #include "VolumeSplitter.h"
+#include "app/App.h"
 #include "core/Common.h"
 #include "core/Log.h"
-#include "voxelutil/VoxelUtil.h"
+#include "core/Trace.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/RawVolume.h"
 
 namespace voxelutil {
 
 void splitVolume(const voxel::RawVolume *volume, const glm::ivec3 &maxSize,
 				 core::DynamicArray<voxel::RawVolume *> &rawVolumes) {
+	core_trace_scoped(SplitVolume);
 	const voxel::Region &region = volume->region();
 	const glm::ivec3 &mins = region.getLowerCorner();
-	const glm::ivec3 &maxs = region.getUpperCorner();
-
-	const glm::ivec3 step = glm::min(region.getDimensionsInVoxels(), maxSize);
-	Log::debug("split region: %s", region.toString().c_str());
-	for (int y = mins.y; y <= maxs.y; y += step.y) {
-		for (int z = mins.z; z <= maxs.z; z += step.z) {
-			for (int x = mins.x; x <= maxs.x; x += step.x) {
-				const glm::ivec3 innerMins(x, y, z);
-				const glm::ivec3 innerMaxs = glm::min(maxs, innerMins + maxSize - 1);
-				const voxel::Region innerRegion(innerMins, innerMaxs);
-				voxel::RawVolume *copy = new voxel::RawVolume(innerRegion);
-				if (!voxelutil::copy(*volume, innerRegion, *copy, innerRegion)) {
-					Log::debug("- skip empty %s", innerRegion.toString().c_str());
-					delete copy;
-					continue;
-				} else {
-					Log::debug("- split %s", innerRegion.toString().c_str());
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+
+	const glm::ivec3 step = glm::min(dim, maxSize);
+	if (glm::any(glm::lessThanEqual(step, glm::ivec3(0)))) {
+		Log::error("Invalid split size %i:%i:%i", maxSize.x, maxSize.y, maxSize.z);
+		return;
+	}
+	const glm::ivec3 pieces = (dim + step - 1) / step;
+	const int piecesPerLayer = pieces.x * pieces.z;
+	Log::debug("split region: %s into %i:%i:%i pieces", region.toString().c_str(), pieces.x, pieces.y, pieces.z);
+
+	// the occupancy summary of the pieces - one pass over the voxels instead of one visit per piece. The pieces
+	// are ordered like the loops of the split (y, z, x) to keep the order of the created volumes.
+	const int pieceCount = piecesPerLayer * pieces.y;
+	core::DynamicArray<uint8_t> occupied;
+	occupied.resize(pieceCount);
+	occupied.fill(0u);
+	const voxel::Voxel *data = (const voxel::Voxel *)volume->data();
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	// each task only touches the pieces of its own z slabs
+	threadPool.parallelFor(0, pieces.z, 1, [&](int start, int end) {
+		for (int pz = start; pz < end; ++pz) {
+			const int zEnd = core_min(dim.z, (pz + 1) * step.z);
+			for (int z = pz * step.z; z < zEnd; ++z) {
+				for (int y = 0; y < dim.y; ++y) {
+					const voxel::Voxel *row = data + (size_t)y * dim.x + (size_t)z * dim.x * dim.y;
+					uint8_t *layer = &occupied[(y / step.y) * piecesPerLayer + pz * pieces.x];
+					for (int px = 0; px < pieces.x; ++px) {
+						if (layer[px]) {
+							continue;
+						}
+						const int xEnd = core_min(dim.x, (px + 1) * step.x);
+						for (int x = px * step.x; x < xEnd; ++x) {
+							if (!voxel::isAir(row[x].getMaterial())) {
+								layer[px] = 1u;
+								break;
+							}
+						}
+					}
 				}
-				rawVolumes.push_back(copy);
 			}
 		}
+	});
+
+	core::DynamicArray<int> copyPieces;
+	copyPieces.reserve(pieceCount);
+	for (int i = 0; i < pieceCount; ++i) {
+		if (occupied[i]) {
+			copyPieces.push_back(i);
+		} else {
+			Log::debug("- skip empty piece %i", i);
+		}
 	}
+
+	const size_t offset = rawVolumes.size();
+	rawVolumes.resize(offset + copyPieces.size());
+	threadPool.parallelFor(0, (int)copyPieces.size(), 1, [&](int start, int end) {
+		for (int i = start; i < end; ++i) {
+			const int piece = copyPieces[i];
+			const int py = piece / piecesPerLayer;
+			const int pz = (piece % piecesPerLayer) / pieces.x;
+			const int px = piece % pieces.x;
+			const glm::ivec3 innerMins = mins + glm::ivec3(px, py, pz) * step;
+			const glm::ivec3 innerMaxs = glm::min(region.getUpperCorner(), innerMins + maxSize - 1);
+			const voxel::Region innerRegion(innerMins, innerMaxs);
+			rawVolumes[offset + i] = new voxel::RawVolume(*volume, innerRegion);
+		}
+	});
 }
 
 } // namespace voxelutil
@@ -13,6 +13,12 @@ class RawVolume;
 
 namespace voxelutil {
 
+/**
+ * @brief Cuts the volume into pieces of the given max size - empty pieces are skipped
+ *
+ * The occupied pieces are found in one pass over the voxels and copied in parallel. The new volumes are appended to
+ * the given list in x, z, y order - the caller takes the ownership.
+ */
 void splitVolume(const voxel::RawVolume *volume, const glm::ivec3 &maxSize,
 				 core::DynamicArray<voxel::RawVolume *> &rawVolumes);
 
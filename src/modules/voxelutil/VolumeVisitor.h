@@ -5,9 +5,11 @@
 #pragma once
 
 #include "core/Common.h"
+#include "core/StandardLib.h"
 #include "core/Trace.h"
 #include "voxel/Face.h"
 #include "voxel/RawVolume.h"
+#include <type_traits>
 
 namespace voxelutil {
 
@@ -45,21 +47,94 @@ struct VisitAll {
 	}
 };
 
+/**
+ * @return The bits of the material in the memory of a voxel for all four voxels of a 64 bit word
+ */
+inline uint64_t voxelMaterialMask() {
+	static_assert(sizeof(voxel::Voxel) == sizeof(uint16_t), "Unexpected voxel size");
+	static const uint64_t mask = []() {
+		const voxel::Voxel voxel((voxel::VoxelType)0x1F, 0u, 0u);
+		uint16_t bits;
+		core_memcpy(&bits, &voxel, sizeof(bits));
+		return (uint64_t)bits * 0x0001000100010001ull;
+	}();
+	return mask;
+}
+
+/**
+ * @brief Skips the air voxels at the beginning of the given row
+ *
+ * The materials of 16 voxels are tested at once by or-ing four 64 bit words - air is material @c 0.
+ *
+ * @return The index of the first non-air voxel - or @c n if all voxels are air
+ */
+inline int skipAirVoxels(const voxel::Voxel *row, int n) {
+	const uint64_t mask = voxelMaterialMask();
+	int i = 0;
+	for (; i + 16 <= n; i += 16) {
+		uint64_t words[4];
+		core_memcpy(words, row + i, sizeof(words));
+		if (((words[0] | words[1] | words[2] | words[3]) & mask) != 0u) {
+			break;
+		}
+	}
+	for (; i < n; ++i) {
+		if (!isAir(row[i].getMaterial())) {
+			return i;
+		}
+	}
+	return n;
+}
+
+/**
+ * @brief Visits the non-air voxels of the given region in ZYX order by skipping the air runs of the rows
+ * @note The region must be inside of the volume
+ */
+template <class Visitor>
+int visitSolidRows(const voxel::RawVolume &volume, const voxel::Region &region, int yOff, int zOff, Visitor &&visitor) {
+	core_trace_scoped(VisitSolidRows);
+	int cnt = 0;
+	const voxel::Voxel *data = (const voxel::Voxel *)volume.data();
+	const voxel::Region &volumeRegion = volume.region();
+	const int width = volumeRegion.getWidthInVoxels();
+	const int sliceSize = width * volumeRegion.getHeightInVoxels();
+	const int n = region.getWidthInVoxels();
+	const glm::ivec3 &lower = region.getLowerCorner() - volumeRegion.getLowerCorner();
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
+			const int localY = lower.y + (y - region.getLowerY());
+			const int localZ = lower.z + (z - region.getLowerZ());
+			const voxel::Voxel *row = data + lower.x + localY * width + localZ * sliceSize;
+			for (int i = skipAirVoxels(row, n); i < n; i += 1 + skipAirVoxels(row + i + 1, n - i - 1)) {
+				visitor(region.getLowerX() + i, y, z, row[i]);
+				++cnt;
+			}
+		}
+	}
+	return cnt;
+}
+
 template <class Volume, class Visitor, typename Condition = SkipEmpty>
 int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int yOff, int zOff, Visitor &&visitor,
 				Condition condition = Condition(), VisitorOrder order = VisitorOrder::ZYX) {
 	core_trace_scoped(VisitVolume);
+	if constexpr (std::is_same<typename std::remove_const<Volume>::type, voxel::RawVolume>::value &&
+				  std::is_same<Condition, SkipEmpty>::value) {
+		if (order == VisitorOrder::ZYX && xOff == 1 && volume.region().containsRegion(region)) {
+			return visitSolidRows(volume, region, yOff, zOff, visitor);
+		}
+	}
 	int cnt = 0;
 
-	typename Volume::Sampler sampler(volume);
+	voxel::VolumeSampler<Volume> sampler(volume);
 
 	switch (order) {
 	case VisitorOrder::XYZ:
 		sampler.setPosition(region.getLowerCorner());
 		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveZ(zOff);
@@ -77,9 +152,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::ZYX:
 		sampler.setPosition(region.getLowerCorner());
 		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveX(xOff);
@@ -97,9 +172,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::ZXY:
 		sampler.setPosition(region.getLowerCorner());
 		for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveY(yOff);
@@ -117,9 +192,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::XZY:
 		sampler.setPosition(region.getLowerCorner());
 		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveY(yOff);
@@ -137,9 +212,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::XZmY:
 		sampler.setPosition(region.getLowerX(), region.getUpperY(), region.getLowerZ());
 		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getUpperY(); y >= region.getLowerY(); y -= yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.moveNegativeY(yOff);
@@ -157,9 +232,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::mXmZY:
 		sampler.setPosition(region.getUpperX(), region.getLowerY(), region.getUpperZ());
 		for (int32_t x = region.getUpperX(); x >= region.getLowerX(); x -= xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getUpperZ(); z >= region.getLowerZ(); z -= zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveY(yOff);
@@ -177,9 +252,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::mXZY:
 		sampler.setPosition(region.getUpperX(), region.getLowerY(), region.getLowerZ());
 		for (int32_t x = region.getUpperX(); x >= region.getLowerX(); x -= xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveY(yOff);
@@ -197,9 +272,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::XmZY:
 		sampler.setPosition(region.getLowerX(), region.getLowerY(), region.getUpperZ());
 		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getUpperZ(); z >= region.getLowerZ(); z -= zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveY(yOff);
@@ -217,9 +292,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::XmZmY:
 		sampler.setPosition(region.getLowerX(), region.getUpperY(), region.getUpperZ());
 		for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getUpperZ(); z >= region.getLowerZ(); z -= zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getUpperY(); y >= region.getLowerY(); y -= yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.moveNegativeY(yOff);
@@ -237,9 +312,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::mXmZmY:
 		sampler.setPosition(region.getUpperX(), region.getUpperY(), region.getUpperZ());
 		for (int32_t x = region.getUpperX(); x >= region.getLowerX(); x -= xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getUpperZ(); z >= region.getLowerZ(); z -= zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getUpperY(); y >= region.getLowerY(); y -= yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.moveNegativeY(yOff);
@@ -257,9 +332,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::mXZmY:
 		sampler.setPosition(region.getUpperX(), region.getUpperY(), region.getLowerZ());
 		for (int32_t x = region.getUpperX(); x >= region.getLowerX(); x -= xOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t y = region.getUpperY(); y >= region.getLowerY(); y -= yOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.moveNegativeY(yOff);
@@ -277,9 +352,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::YXZ:
 		sampler.setPosition(region.getLowerCorner());
 		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveZ(zOff);
@@ -297,9 +372,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::YZX:
 		sampler.setPosition(region.getLowerCorner());
 		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveX(xOff);
@@ -317,9 +392,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::YZmX:
 		sampler.setPosition(region.getUpperX(), region.getLowerY(), region.getLowerZ());
 		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += yOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t x = region.getUpperX(); x >= region.getLowerX(); x -= xOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.moveNegativeX(xOff);
@@ -337,9 +412,9 @@ int visitVolume(const Volume &volume, const voxel::Region &region, int xOff, int
 	case VisitorOrder::mYZX:
 		sampler.setPosition(region.getLowerX(), region.getUpperY(), region.getLowerZ());
 		for (int32_t y = region.getUpperY(); y >= region.getLowerY(); y -= yOff) {
-			typename Volume::Sampler sampler2 = sampler;
+			voxel::VolumeSampler<Volume> sampler2 = sampler;
 			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += zOff) {
-				typename Volume::Sampler sampler3 = sampler2;
+				voxel::VolumeSampler<Volume> sampler3 = sampler2;
 				for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += xOff) {
 					const voxel::Voxel &voxel = sampler3.voxel();
 					sampler3.movePositiveX(xOff);
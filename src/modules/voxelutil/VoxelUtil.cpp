@@ -6,15 +6,20 @@
 #include "core/ArrayLength.h"
 #include "core/GLM.h"
 #include "core/collection/Array3DView.h"
+#include "core/collection/BitSet.h"
 #include "core/collection/Buffer.h"
 #include "core/collection/DynamicArray.h"
-#include "core/collection/Set.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/Trace.h"
 #include "voxel/Face.h"
+#include "voxel/OccupancyPyramid.h"
 #include "voxel/PaletteLookup.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "voxelutil/VolumeVisitor.h"
+#include <glm/gtc/noise.hpp>
 
 namespace voxelutil {
 
@@ -44,7 +49,7 @@ void fillInterpolated(voxel::RawVolume *v, const voxel::Palette &palette) {
 	const voxel::Region &region = v->region();
 	const glm::ivec3 &mins = region.getLowerCorner();
 	const glm::ivec3 &maxs = region.getUpperCorner();
-	voxel::RawVolume::Sampler sampler(v);
+	voxel::RawVolume::DirectSampler sampler(v);
 	for (int x = mins.x; x <= maxs.x; ++x) {
 		for (int y = mins.y; y <= maxs.y; ++y) {
 			for (int z = mins.z; z <= maxs.z; ++z) {
@@ -99,15 +104,18 @@ void fillInterpolated(voxel::RawVolume *v, const voxel::Palette &palette) {
 }
 
 bool isEmpty(const voxel::RawVolume &v, const voxel::Region &region) {
-	voxel::RawVolume::Sampler sampler(v);
-	for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += 1) {
+	if (const voxel::OccupancyPyramid *occupancy = v.occupancy()) {
+		return occupancy->empty(v, region);
+	}
+	voxel::RawVolume::DirectSampler sampler(v);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += 1) {
 		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); y += 1) {
-			sampler.setPosition(x, y, region.getLowerZ());
-			for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); z += 1) {
+			sampler.setPosition(region.getLowerX(), y, z);
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); x += 1) {
 				if (voxel::isBlocked(sampler.voxel().getMaterial())) {
 					return false;
 				}
-				sampler.movePositiveZ();
+				sampler.movePositiveX();
 			}
 		}
 	}
@@ -116,22 +124,10 @@ bool isEmpty(const voxel::RawVolume &v, const voxel::Region &region) {
 
 bool copy(const voxel::RawVolume &in, const voxel::Region &inRegion, voxel::RawVolume &out,
 		  const voxel::Region &outRegion) {
-	int32_t xIn, yIn, zIn;
-	int32_t xOut, yOut, zOut;
-	voxel::RawVolumeWrapper wrapper(&out);
-	const glm::ivec3 &inmins = inRegion.getLowerCorner();
-	const glm::ivec3 &inmaxs = inRegion.getUpperCorner();
-	const glm::ivec3 &outmins = outRegion.getLowerCorner();
-	const glm::ivec3 &outmaxs = outRegion.getUpperCorner();
-	for (zIn = inmins.z, zOut = outmins.z; zIn <= inmaxs.z && zOut <= outmaxs.z; ++zIn, ++zOut) {
-		for (yIn = inmins.y, yOut = outmins.y; yIn <= inmaxs.y && yOut <= outmaxs.y; ++yIn, ++yOut) {
-			for (xIn = inmins.x, xOut = outmins.x; xIn <= inmaxs.x && xOut <= outmaxs.x; ++xIn, ++xOut) {
-				const voxel::Voxel &voxel = in.voxel(xIn, yIn, zIn);
-				wrapper.setVoxel(xOut, yOut, zOut, voxel);
-			}
-		}
-	}
-	return wrapper.dirtyRegion().isValid();
+	voxel::RawVolumeWrapper wrapper(&out, outRegion);
+	const glm::ivec3 &dim = glm::min(inRegion.getDimensionsInVoxels(), outRegion.getDimensionsInVoxels());
+	const voxel::Region srcRegion(inRegion.getLowerCorner(), inRegion.getLowerCorner() + dim - 1);
+	return wrapper.copyRegion(in, srcRegion, outRegion.getLowerCorner());
 }
 
 bool copyIntoRegion(const voxel::RawVolume &in, voxel::RawVolume &out, const voxel::Region &targetRegion) {
@@ -252,59 +248,257 @@ void fillHollow(voxel::RawVolumeWrapper &in, const voxel::Voxel &voxel) {
 	fillRegion(in, voxel);
 }
 
-using IVec3Set = core::Set<glm::ivec3, 11, glm::hash<glm::ivec3>>;
+/**
+ * @brief The classification of the voxels for @c hollow()
+ */
+enum HollowState : uint8_t { HollowAir, HollowSeeThrough, HollowSolid };
 
-static int walkPlane_r(IVec3Set &visited, voxel::RawVolumeWrapper &in, const voxel::Region &region,
-					   const WalkCheckCallback &check, const WalkExecCallback &exec, const glm::ivec3 &position,
-					   const glm::ivec3 &checkOffset, voxel::FaceNames face) {
-	const glm::ivec3 checkPosition = position + checkOffset;
-	if (visited.has(checkPosition)) {
-		return 0;
-	}
-	visited.insert(checkPosition);
-	if (!region.containsPoint(position)) {
-		return 0;
-	}
-	if (!check(in, checkPosition)) {
-		return 0;
-	}
-	if (!exec(in, position)) {
+int hollow(core::ThreadPool &threadPool, voxel::RawVolumeWrapper &in, int shellThickness) {
+	core_trace_scoped(Hollow);
+	const voxel::Region &region = in.region();
+	if (!region.isValid()) {
 		return 0;
 	}
-	int n = 1;
-	if (region.containsPoint(position.x + 1, position.y, position.z)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x + 1, position.y, position.z),
-						 checkOffset, face);
+	shellThickness = glm::clamp(shellThickness, 1, 255);
+	const int width = region.getWidthInVoxels();
+	const int height = region.getHeightInVoxels();
+	const int depth = region.getDepthInVoxels();
+	const int sliceSize = width * height;
+	const int size = sliceSize * depth;
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const voxel::RawVolume &volume = *in.volume();
+
+	// zero initialized - which is HollowAir
+	core::Buffer<uint8_t> state(size);
+	threadPool.parallelFor(0, depth, 1, [&](int start, int end) {
+		for (int z = start; z < end; ++z) {
+			for (int y = 0; y < height; ++y) {
+				for (int x = 0; x < width; ++x) {
+					const voxel::VoxelType material = volume.voxel(mins.x + x, mins.y + y, mins.z + z).getMaterial();
+					if (voxel::isAir(material)) {
+						continue;
+					}
+					state[x + y * width + z * sliceSize] = voxel::isTransparent(material) ? HollowSeeThrough : HollowSolid;
+				}
+			}
+		}
+	});
+
+	// flood fill the voxels that are visible from outside - starting at the see-through voxels of the border
+	core::BitSet exterior(size);
+	core::DynamicArray<int> positions;
+	auto visit = [&](int idx) {
+		if (state[idx] != HollowSolid && !exterior[idx]) {
+			exterior.set(idx, true);
+			positions.push_back(idx);
+		}
+	};
+	for (int z = 0; z < depth; ++z) {
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				if (x == 0 || y == 0 || z == 0 || x == width - 1 || y == height - 1 || z == depth - 1) {
+					visit(x + y * width + z * sliceSize);
+				} else {
+					// only the first and the last voxel of the inner rows are on the border
+					x = width - 2;
+				}
+			}
+		}
 	}
-	if (region.containsPoint(position.x - 1, position.y, position.z)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x - 1, position.y, position.z),
-						 checkOffset, face);
+	while (!positions.empty()) {
+		const int idx = positions.back();
+		positions.pop();
+		const int x = idx % width;
+		const int y = (idx / width) % height;
+		const int z = idx / sliceSize;
+		if (x > 0) {
+			visit(idx - 1);
+		}
+		if (x < width - 1) {
+			visit(idx + 1);
+		}
+		if (y > 0) {
+			visit(idx - width);
+		}
+		if (y < height - 1) {
+			visit(idx + width);
+		}
+		if (z > 0) {
+			visit(idx - sliceSize);
+		}
+		if (z < depth - 1) {
+			visit(idx + sliceSize);
+		}
 	}
-	if (region.containsPoint(position.x, position.y + 1, position.z)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x, position.y + 1, position.z),
-						 checkOffset, face);
+
+	// the shell depth of the voxels that are kept - 0 means the voxel is removed
+	core::Buffer<uint8_t> shell(size);
+	auto neighbour = [&](const core::Buffer<uint8_t> &levels, int x, int y, int z, int idx, uint8_t level) {
+		return (x > 0 && levels[idx - 1] == level) || (x < width - 1 && levels[idx + 1] == level) ||
+			   (y > 0 && levels[idx - width] == level) || (y < height - 1 && levels[idx + width] == level) ||
+			   (z > 0 && levels[idx - sliceSize] == level) || (z < depth - 1 && levels[idx + sliceSize] == level);
+	};
+	threadPool.parallelFor(0, depth, 1, [&](int start, int end) {
+		for (int z = start; z < end; ++z) {
+			for (int y = 0; y < height; ++y) {
+				for (int x = 0; x < width; ++x) {
+					const int idx = x + y * width + z * sliceSize;
+					if (state[idx] == HollowAir || exterior[idx]) {
+						continue;
+					}
+					const bool border = x == 0 || y == 0 || z == 0 || x == width - 1 || y == height - 1 || z == depth - 1;
+					if (border || (x > 0 && exterior[idx - 1]) || (x < width - 1 && exterior[idx + 1]) ||
+						(y > 0 && exterior[idx - width]) || (y < height - 1 && exterior[idx + width]) ||
+						(z > 0 && exterior[idx - sliceSize]) || (z < depth - 1 && exterior[idx + sliceSize])) {
+						shell[idx] = 1;
+					}
+				}
+			}
+		}
+	});
+	if (shellThickness > 1) {
+		// every layer reads the previous layers and writes into its own buffer - the slabs don't race then
+		core::Buffer<uint8_t> layer(size);
+		for (int level = 2; level <= shellThickness; ++level) {
+			threadPool.parallelFor(0, depth, 1, [&](int start, int end) {
+				for (int z = start; z < end; ++z) {
+					for (int y = 0; y < height; ++y) {
+						for (int x = 0; x < width; ++x) {
+							const int idx = x + y * width + z * sliceSize;
+							const bool inner = state[idx] != HollowAir && !exterior[idx] && shell[idx] == 0;
+							layer[idx] = inner && neighbour(shell, x, y, z, idx, (uint8_t)(level - 1)) ? (uint8_t)level : 0;
+						}
+					}
+				}
+			});
+			for (int idx = 0; idx < size; ++idx) {
+				if (layer[idx] != 0) {
+					shell[idx] = layer[idx];
+				}
+			}
+		}
 	}
-	if (region.containsPoint(position.x, position.y - 1, position.z)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x, position.y - 1, position.z),
-						 checkOffset, face);
+
+	// the volume bookkeeping of setVoxel() isn't thread-safe
+	int removed = 0;
+	const voxel::Voxel air;
+	for (int z = 0; z < depth; ++z) {
+		for (int y = 0; y < height; ++y) {
+			for (int x = 0; x < width; ++x) {
+				const int idx = x + y * width + z * sliceSize;
+				if (state[idx] == HollowAir || exterior[idx] || shell[idx] != 0) {
+					continue;
+				}
+				in.setVoxel(mins.x + x, mins.y + y, mins.z + z, air);
+				++removed;
+			}
+		}
 	}
-	if (region.containsPoint(position.x, position.y, position.z + 1)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x, position.y, position.z + 1),
-						 checkOffset, face);
+	return removed;
+}
+
+/**
+ * @brief A run of voxels in one row of the walked plane that passed the check and were executed already
+ */
+struct WalkSpan {
+	int from;
+	int to;
+	int row;
+};
+
+/**
+ * @brief Span based flood fill over the plane given by @c region (one of the dimensions must be 1)
+ *
+ * Every voxel of the plane is tested only once - the visited voxels are tracked in a dense bitset. The @c check
+ * callback is executed for the position with the @c checkOffset applied, the @c exec callback for the position
+ * itself. The fill only continues from voxels where both callbacks succeeded.
+ *
+ * @param uAxis The axis the rows of the plane are walked along
+ * @param vAxis The axis the rows are stacked along
+ * @return The amount of voxels that were executed
+ */
+template<class CheckCallback, class ExecCallback>
+static int walkPlaneSpans(voxel::RawVolumeWrapper &in, const voxel::Region &region, const glm::ivec3 &position,
+						  const glm::ivec3 &checkOffset, int uAxis, int vAxis, CheckCallback &&check,
+						  ExecCallback &&exec) {
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	const int minU = mins[uAxis];
+	const int maxU = maxs[uAxis];
+	const int minV = mins[vAxis];
+	const int maxV = maxs[vAxis];
+	const int width = dim[uAxis];
+	core::BitSet visited(dim.x * dim.y * dim.z);
+
+	glm::ivec3 pos = position;
+	// tests the voxel only once - returns true if the voxel was executed
+	auto test = [&](int u, int v) {
+		const int idx = (u - minU) + (v - minV) * width;
+		if (visited[idx]) {
+			return false;
+		}
+		visited.set(idx, true);
+		pos[uAxis] = u;
+		pos[vAxis] = v;
+		if (!check(in, pos + checkOffset)) {
+			return false;
+		}
+		return (bool)exec(in, pos);
+	};
+
+	if (!test(position[uAxis], position[vAxis])) {
+		return 0;
 	}
-	if (region.containsPoint(position.x, position.y, position.z - 1)) {
-		n += walkPlane_r(visited, in, region, check, exec, glm::ivec3(position.x, position.y, position.z - 1),
-						 checkOffset, face);
+	int n = 1;
+	core::DynamicArray<WalkSpan> stack;
+	stack.reserve(64);
+	stack.push_back({position[uAxis], position[uAxis], position[vAxis]});
+	while (!stack.empty()) {
+		WalkSpan span = stack.back();
+		stack.pop();
+		while (span.from > minU && test(span.from - 1, span.row)) {
+			--span.from;
+			++n;
+		}
+		while (span.to < maxU && test(span.to + 1, span.row)) {
+			++span.to;
+			++n;
+		}
+		for (int row = span.row - 1; row <= span.row + 1; row += 2) {
+			if (row < minV || row > maxV) {
+				continue;
+			}
+			// every run of executed voxels in the neighbouring row becomes a new span
+			int runStart = -1;
+			for (int u = span.from; u <= span.to; ++u) {
+				if (test(u, row)) {
+					++n;
+					if (runStart == -1) {
+						runStart = u;
+					}
+				} else if (runStart != -1) {
+					stack.push_back({runStart, u - 1, row});
+					runStart = -1;
+				}
+			}
+			if (runStart != -1) {
+				stack.push_back({runStart, span.to, row});
+			}
+		}
 	}
 	return n;
 }
 
+template<class CheckCallback, class ExecCallback>
 static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, voxel::FaceNames face, int checkOffset,
-					 const WalkCheckCallback &check, const WalkExecCallback &exec) {
+					 CheckCallback &&check, ExecCallback &&exec) {
 	const voxel::Region &region = in.region();
 	glm::ivec3 mins = region.getLowerCorner();
 	glm::ivec3 maxs = region.getUpperCorner();
 	glm::ivec3 checkOffsetV(0);
+	int uAxis = 0;
+	int vAxis = 1;
 	switch (face) {
 	case voxel::FaceNames::PositiveX:
 		mins.x = position.x;
@@ -312,6 +506,8 @@ static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, vo
 		if (!region.isOnBorderX(position.x)) {
 			checkOffsetV.x = checkOffset;
 		}
+		uAxis = 1;
+		vAxis = 2;
 		break;
 	case voxel::FaceNames::NegativeX:
 		mins.x = position.x;
@@ -319,6 +515,8 @@ static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, vo
 		if (!region.isOnBorderX(position.x)) {
 			checkOffsetV.x = -checkOffset;
 		}
+		uAxis = 1;
+		vAxis = 2;
 		break;
 	case voxel::FaceNames::PositiveY:
 		mins.y = position.y;
@@ -326,6 +524,8 @@ static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, vo
 		if (!region.isOnBorderY(position.y)) {
 			checkOffsetV.y = checkOffset;
 		}
+		uAxis = 0;
+		vAxis = 2;
 		break;
 	case voxel::FaceNames::NegativeY:
 		mins.y = position.y;
@@ -333,6 +533,8 @@ static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, vo
 		if (!region.isOnBorderY(position.y)) {
 			checkOffsetV.y = -checkOffset;
 		}
+		uAxis = 0;
+		vAxis = 2;
 		break;
 	case voxel::FaceNames::PositiveZ:
 		mins.z = position.z;
@@ -340,6 +542,8 @@ static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, vo
 		if (!region.isOnBorderZ(position.z)) {
 			checkOffsetV.z = checkOffset;
 		}
+		uAxis = 0;
+		vAxis = 1;
 		break;
 	case voxel::FaceNames::NegativeZ:
 		mins.z = position.z;
@@ -347,6 +551,8 @@ static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, vo
 		if (!region.isOnBorderZ(position.z)) {
 			checkOffsetV.z = -checkOffset;
 		}
+		uAxis = 0;
+		vAxis = 1;
 		break;
 	case voxel::FaceNames::Max:
 		return -1;
@@ -355,11 +561,10 @@ static int walkPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &position, vo
 	if (!walkRegion.isValid()) {
 		return 0;
 	}
-	const glm::ivec3 &dim = walkRegion.getDimensionsInVoxels();
-	const int maxSize = dim.x * dim.y * dim.z;
-	core_assert_msg(maxSize > 0, "max size is 0 even though the region was valid");
-	IVec3Set visited(maxSize);
-	return walkPlane_r(visited, in, walkRegion, check, exec, position, checkOffsetV, face);
+	if (!walkRegion.containsPoint(position)) {
+		return 0;
+	}
+	return walkPlaneSpans(in, walkRegion, position, checkOffsetV, uAxis, vAxis, check, exec);
 }
 
 static glm::vec2 calcUV(const glm::ivec3 &pos, const voxel::Region &region, voxel::FaceNames face) {
@@ -435,4 +640,23 @@ int fillPlane(voxel::RawVolumeWrapper &in, const image::ImagePtr &image, const v
 	return walkPlane(in, position, face, 0, check, exec);
 }
 
+int64_t fillTerrain(voxel::RawVolume &volume, float frequency) {
+	const voxel::Region &region = volume.region();
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const int height = region.getHeightInVoxels();
+	int64_t voxels = 0;
+	for (int x = 0; x < region.getWidthInVoxels(); ++x) {
+		for (int z = 0; z < region.getDepthInVoxels(); ++z) {
+			const float n = glm::simplex(glm::vec2(mins.x + x, mins.z + z) * frequency) * 0.5f + 0.5f;
+			const int h = (int)(n * (float)(height - 1));
+			for (int y = 0; y <= h; ++y) {
+				volume.setVoxel(mins.x + x, mins.y + y, mins.z + z,
+								voxel::createVoxel(voxel::VoxelType::Generic, 1 + (y + x / 16) % 32));
+			}
+			voxels += h + 1;
+		}
+	}
+	return voxels;
+}
+
 } // namespace voxelutil
@@ -9,6 +9,10 @@
 #include <functional>
 #include <glm/fwd.hpp>
 
+namespace core {
+class ThreadPool;
+}
+
 namespace voxel {
 class RawVolume;
 class Region;
@@ -23,6 +27,11 @@ bool copyIntoRegion(const voxel::RawVolume &in, voxel::RawVolume &out, const vox
 
 void fillInterpolated(voxel::RawVolume *v, const voxel::Palette &palette);
 
+/**
+ * @brief Copies the voxels of @c inRegion row by row into @c outRegion - the smaller dimensions of both regions are used
+ * @return @c false if nothing was copied because the regions are not inside of the volumes
+ * @sa voxel::RawVolume::copyRegion()
+ */
 bool copy(const voxel::RawVolume &in, const voxel::Region &inRegion, voxel::RawVolume &out,
 		  const voxel::Region &outRegion);
 /**
@@ -58,4 +67,25 @@ int paintPlane(voxel::RawVolumeWrapper &in, const glm::ivec3 &pos, voxel::FaceNa
 
 void fillHollow(voxel::RawVolumeWrapper &in, const voxel::Voxel &voxel);
 
+/**
+ * @brief Removes the voxels that can't be seen from outside of the volume
+ *
+ * The air and transparent voxels that are connected to the border of the region are flood filled - every other
+ * voxel that is more than @c shellThickness voxels away from them is removed. The voxels on the border of the region
+ * are always kept. This is the counterpart of @c fillHollow() and shrinks the solid inside of voxelized meshes or
+ * terrain before they are exported.
+ *
+ * @param shellThickness The amount of voxels of the shell that are kept below the visible surface [1-255]
+ * @return The amount of removed voxels
+ */
+int hollow(core::ThreadPool &threadPool, voxel::RawVolumeWrapper &in, int shellThickness = 1);
+
+/**
+ * @brief Fills the region of the volume with a noise based height map with a few colors - roughly half of the region is
+ * filled. The result only depends on the region and the frequency - e.g. to get reproducible data for the benchmarks.
+ * @param frequency The scale of the noise - smaller values produce smoother hills
+ * @return The amount of voxels that were set
+ */
+int64_t fillTerrain(voxel::RawVolume &volume, float frequency);
+
 } // namespace voxelutil
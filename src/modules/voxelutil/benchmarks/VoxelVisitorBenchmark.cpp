@@ -3,6 +3,10 @@
  */
 
 #include "app/benchmark/AbstractBenchmark.h"
+#include "app/App.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxelutil/VolumeParallel.h"
 #include "voxelutil/VolumeVisitor.h"
 
 class VoxelVisitorBenchmark : public app::AbstractBenchmark {
@@ -39,4 +43,53 @@ BENCHMARK_DEFINE_F(VoxelVisitorBenchmark, Visit)(benchmark::State &state) {
 
 BENCHMARK_REGISTER_F(VoxelVisitorBenchmark, Visit)->DenseRange(0, (int)(voxelutil::VisitorOrder::Max)-1);
 
+/**
+ * @brief A sparse terrain like volume - a solid ground layer and some scattered voxels above it
+ */
+class VoxelVisitorLargeBenchmark : public app::AbstractBenchmark {
+protected:
+	voxel::RawVolume v{voxel::Region{0, 255}};
+public:
+	void SetUp(::benchmark::State &state) override {
+		app::AbstractBenchmark::SetUp(state);
+		const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+		v.fill(voxel::Region(0, 0, 0, 255, 15, 255), voxel);
+		for (int i = 0; i < 4096; ++i) {
+			v.setVoxel((i * 37) & 255, 16 + ((i * 11) % 240), (i * 101) & 255, voxel);
+		}
+	}
+};
+
+BENCHMARK_DEFINE_F(VoxelVisitorLargeBenchmark, VisitAll)(benchmark::State &state) {
+	for (auto _ : state) {
+		int n = 0;
+		voxelutil::visitVolume(v, [&](int, int, int, const voxel::Voxel &voxel) {
+			if (voxel::isBlocked(voxel.getMaterial())) {
+				++n;
+			}
+		}, voxelutil::VisitAll());
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelVisitorLargeBenchmark, SkipEmpty)(benchmark::State &state) {
+	for (auto _ : state) {
+		const int n = voxelutil::visitVolume(v, [&](int, int, int, const voxel::Voxel &) {});
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+BENCHMARK_DEFINE_F(VoxelVisitorLargeBenchmark, Parallel)(benchmark::State &state) {
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	for (auto _ : state) {
+		core::AtomicInt cnt;
+		const int n = voxelutil::visitVolumeParallel(threadPool, v, [&](int, int, int, const voxel::Voxel &) { ++cnt; });
+		benchmark::DoNotOptimize(n);
+	}
+}
+
+BENCHMARK_REGISTER_F(VoxelVisitorLargeBenchmark, VisitAll);
+BENCHMARK_REGISTER_F(VoxelVisitorLargeBenchmark, SkipEmpty);
+BENCHMARK_REGISTER_F(VoxelVisitorLargeBenchmark, Parallel);
+
 BENCHMARK_MAIN();
@@ -5,10 +5,87 @@
 #include "voxelutil/AStarPathfinder.h"
 #include "app/tests/AbstractTest.h"
 #include "voxel/RawVolume.h"
+#include <random>
 
 namespace voxelutil {
 
-class AStarPathfinderTest : public app::AbstractTest {};
+class AStarPathfinderTest : public app::AbstractTest {
+protected:
+	static bool isFree(const voxel::RawVolume *v, const glm::ivec3 &pos) {
+		return !voxel::isBlocked(v->voxel(pos).getMaterial());
+	}
+
+	static bool isValidForPath(const voxel::RawVolume *v, const glm::ivec3 &pos) {
+		return v->region().containsPoint(pos) && isFree(v, pos);
+	}
+
+	static float pathCost(const core::List<glm::ivec3> &path) {
+		float cost = 0.0f;
+		const glm::ivec3 *prev = nullptr;
+		for (const glm::ivec3 &p : path) {
+			if (prev != nullptr) {
+				const glm::ivec3 delta = glm::abs(p - *prev);
+				EXPECT_LE(delta.x + delta.y + delta.z, 3) << "path is not connected";
+				EXPECT_NE(delta.x + delta.y + delta.z, 0) << "path contains duplicates";
+				cost += glm::length(glm::vec3(delta));
+			}
+			prev = &p;
+		}
+		return cost;
+	}
+
+	/**
+	 * @brief Dijkstra over the whole region with the 26-connected move costs
+	 */
+	static float shortestPathCost(const voxel::RawVolume &volume, const glm::ivec3 &start, const glm::ivec3 &end) {
+		const voxel::Region &region = volume.region();
+		const glm::ivec3 &dim = region.getDimensionsInVoxels();
+		const int n = dim.x * dim.y * dim.z;
+		core::DynamicArray<float> dist;
+		dist.resize(n);
+		dist.fill(FLT_MAX);
+		core::DynamicArray<bool> done;
+		done.resize(n);
+		done.fill(false);
+		auto index = [&](const glm::ivec3 &p) {
+			const glm::ivec3 l = p - region.getLowerCorner();
+			return l.x + l.y * dim.x + l.z * dim.x * dim.y;
+		};
+		dist[index(start)] = 0.0f;
+		for (;;) {
+			int best = -1;
+			for (int i = 0; i < n; ++i) {
+				if (!done[i] && dist[i] < FLT_MAX && (best == -1 || dist[i] < dist[best])) {
+					best = i;
+				}
+			}
+			if (best == -1) {
+				return FLT_MAX;
+			}
+			done[best] = true;
+			const glm::ivec3 pos = region.getLowerCorner() +
+								   glm::ivec3(best % dim.x, (best / dim.x) % dim.y, best / (dim.x * dim.y));
+			if (pos == end) {
+				return dist[best];
+			}
+			for (int z = -1; z <= 1; ++z) {
+				for (int y = -1; y <= 1; ++y) {
+					for (int x = -1; x <= 1; ++x) {
+						const glm::ivec3 next = pos + glm::ivec3(x, y, z);
+						if (next == pos || !isValidForPath(&volume, next)) {
+							continue;
+						}
+						const int idx = index(next);
+						const float d = dist[best] + glm::length(glm::vec3(x, y, z));
+						if (d < dist[idx]) {
+							dist[idx] = d;
+						}
+					}
+				}
+			}
+		}
+	}
+};
 
 TEST_F(AStarPathfinderTest, test) {
 	voxel::RawVolume volume(voxel::Region(0, 20));
@@ -31,4 +108,75 @@ TEST_F(AStarPathfinderTest, test) {
 	EXPECT_EQ(20u, listResult.size());
 }
 
+TEST_F(AStarPathfinderTest, testStep) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	const glm::ivec3 start(0, 0, 0);
+	const glm::ivec3 end(15, 15, 15);
+	core::List<glm::ivec3> listResult;
+	AStarPathfinderParams<voxel::RawVolume> params(&volume, start, end, &listResult, isValidForPath);
+	AStarPathfinder pathfinder(params);
+	pathfinder.init();
+	int steps = 0;
+	while (pathfinder.step(4) == PathfinderState::Searching) {
+		++steps;
+	}
+	EXPECT_GT(steps, 1);
+	EXPECT_EQ(PathfinderState::Found, pathfinder.state());
+	EXPECT_EQ(16u, listResult.size());
+}
+
+TEST_F(AStarPathfinderTest, testJumpPointSearchOpen) {
+	voxel::RawVolume volume(voxel::Region(0, 63));
+	const glm::ivec3 start(0, 3, 60);
+	const glm::ivec3 end(63, 40, 2);
+	core::List<glm::ivec3> listResult;
+	AStarPathfinderParams<voxel::RawVolume> params(&volume, start, end, &listResult, isFree);
+	params.jumpPointSearch = true;
+	AStarPathfinder pathfinder(params);
+	ASSERT_TRUE(pathfinder.execute());
+	EXPECT_EQ(start, *listResult.begin());
+	// without obstacles the shortest path uses as many diagonal moves as possible
+	const float expected = 37.0f * glm::root_three<float>() + 21.0f * glm::root_two<float>() + 5.0f;
+	EXPECT_NEAR(expected, pathCost(listResult), 0.01f);
+}
+
+TEST_F(AStarPathfinderTest, testJumpPointSearchObstacles) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	const voxel::Voxel solid = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	std::mt19937 rng(42);
+	std::uniform_int_distribution<int> dist(0, 99);
+	for (int i = 0; i < 4; ++i) {
+		volume.clear();
+		for (int z = 0; z < 16; ++z) {
+			for (int y = 0; y < 16; ++y) {
+				for (int x = 0; x < 16; ++x) {
+					if (dist(rng) < 25) {
+						volume.setVoxel(x, y, z, solid);
+					}
+				}
+			}
+		}
+		const glm::ivec3 start(0, 0, 0);
+		const glm::ivec3 end(15, 12, 14);
+		volume.setVoxel(start, voxel::Voxel());
+		volume.setVoxel(end, voxel::Voxel());
+		const float expected = shortestPathCost(volume, start, end);
+		if (expected == FLT_MAX) {
+			continue;
+		}
+
+		core::List<glm::ivec3> listResult;
+		AStarPathfinderParams<voxel::RawVolume> params(&volume, start, end, &listResult, isValidForPath, 1.0f,
+													   100000);
+		params.jumpPointSearch = true;
+		AStarPathfinder pathfinder(params);
+		ASSERT_TRUE(pathfinder.execute());
+		for (const glm::ivec3 &p : listResult) {
+			EXPECT_TRUE(isValidForPath(&volume, p));
+		}
+		// the tie breaking of the heuristic might lead to paths that are a tiny bit longer
+		EXPECT_NEAR(expected, pathCost(listResult), 0.1f) << "iteration " << i;
+	}
+}
+
 } // namespace voxelutil
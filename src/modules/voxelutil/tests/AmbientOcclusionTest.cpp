@@ -0,0 +1,91 @@
+/**
+ * @file
+ */
+
+#include "voxelutil/AmbientOcclusion.h"
+#include "app/tests/AbstractTest.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/ChunkMesh.h"
+#include "voxel/CubicSurfaceExtractor.h"
+#include "voxel/RawVolume.h"
+
+namespace voxelutil {
+
+class AmbientOcclusionTest : public app::AbstractTest {
+protected:
+	core::ThreadPool _threadPool{2, "AmbientOcclusionTest"};
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		_threadPool.init();
+	}
+
+	void TearDown() override {
+		_threadPool.shutdown();
+		app::AbstractTest::TearDown();
+	}
+
+	void extract(const voxel::RawVolume &volume, voxel::ChunkMesh &mesh) {
+		voxel::Region region = volume.region();
+		region.shiftUpperCorner(1, 1, 1);
+		voxel::extractCubicMesh(&volume, region, &mesh, glm::ivec3(0), false, true, false);
+	}
+};
+
+TEST_F(AmbientOcclusionTest, testSingleVoxel) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	volume.setVoxel(8, 8, 8, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	voxel::ChunkMesh mesh;
+	extract(volume, mesh);
+	const voxel::Mesh &opaque = mesh.mesh[0];
+	ASSERT_FALSE(opaque.isEmpty());
+	core::DynamicArray<float> occlusion;
+	bakeAmbientOcclusion(_threadPool, volume, opaque, opaque.getOffset(), occlusion);
+	ASSERT_EQ(opaque.getNoOfVertices(), occlusion.size());
+	// the rays of the faces must not hit the voxel itself
+	for (size_t i = 0; i < occlusion.size(); ++i) {
+		EXPECT_FLOAT_EQ(1.0f, occlusion[i]) << "vertex " << i;
+	}
+}
+
+TEST_F(AmbientOcclusionTest, testWall) {
+	voxel::RawVolume volume(voxel::Region(0, 15));
+	const voxel::Voxel voxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	for (int z = 0; z < 16; ++z) {
+		for (int x = 0; x < 16; ++x) {
+			volume.setVoxel(x, 0, z, voxel);
+		}
+		for (int y = 1; y < 5; ++y) {
+			volume.setVoxel(8, y, z, voxel);
+		}
+	}
+	voxel::ChunkMesh mesh;
+	extract(volume, mesh);
+	const voxel::Mesh &opaque = mesh.mesh[0];
+	AmbientOcclusionConfig config;
+	config.distance = 3.0f;
+	core::DynamicArray<float> occlusion;
+	bakeAmbientOcclusion(_threadPool, volume, opaque, opaque.getOffset(), occlusion, config);
+	ASSERT_EQ(opaque.getNoOfVertices(), occlusion.size());
+
+	int nearWall = 0;
+	int open = 0;
+	for (size_t i = 0; i < occlusion.size(); ++i) {
+		const glm::vec3 pos = opaque.getVertex((voxel::IndexType)i).position + glm::vec3(opaque.getOffset());
+		if (pos.y != 1.0f || pos.z < 4.0f || pos.z > 12.0f) {
+			continue;
+		}
+		if (pos.x == 8.0f) {
+			// the floor right in front of the wall
+			EXPECT_LT(occlusion[i], 1.0f) << pos.x << ":" << pos.y << ":" << pos.z;
+			++nearWall;
+		} else if (pos.x <= 3.0f) {
+			EXPECT_FLOAT_EQ(1.0f, occlusion[i]) << pos.x << ":" << pos.y << ":" << pos.z;
+			++open;
+		}
+	}
+	EXPECT_GT(nearWall, 0);
+	EXPECT_GT(open, 0);
+}
+
+} // namespace voxelutil
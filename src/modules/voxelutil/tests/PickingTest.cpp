@@ -3,6 +3,7 @@
  */
 
 #include "app/tests/AbstractTest.h"
+#include "voxel/OccupancyPyramid.h"
 #include "voxel/RawVolume.h"
 #include "voxelutil/Picking.h"
 #include "core/GLM.h"
@@ -21,4 +22,38 @@ TEST_F(PickingTest, testPicking) {
 	ASSERT_EQ(glm::ivec3(0, 1, 0), result.previousPosition);
 }
 
+TEST_F(PickingTest, testPickingSkipEmpty) {
+	voxel::RawVolume v(voxel::Region(glm::ivec3(0), glm::ivec3(127)));
+	v.enableOccupancy();
+	ASSERT_NE(nullptr, v.occupancy());
+	const voxel::Voxel solid = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	v.setVoxel(glm::ivec3(100, 5, 100), solid);
+	v.setVoxel(glm::ivec3(70, 70, 3), solid);
+	EXPECT_TRUE(v.occupancy()->occupied(0, glm::ivec3(101, 6, 102)));
+	EXPECT_FALSE(v.occupancy()->occupied(0, glm::ivec3(96, 5, 100)));
+	EXPECT_TRUE(v.occupancy()->occupied(2, glm::ivec3(64, 0, 64)));
+
+	const glm::vec3 start(-10.0f, 200.0f, -10.0f);
+	const glm::vec3 targets[] = {glm::vec3(100.5f, 5.5f, 100.5f), glm::vec3(70.2f, 70.7f, 3.5f), glm::vec3(50.0f, 0.0f, 50.0f)};
+	int hits = 0;
+	for (const glm::vec3 &target : targets) {
+		const glm::vec3 &dir = (target - start) * 2.0f;
+		const PickResult &expected = pickVoxel<voxel::RawVolume>(&v, start, dir, voxel::Voxel());
+		const PickResult &result = pickVoxel(&v, start, dir, voxel::Voxel());
+		ASSERT_EQ(expected.didHit, result.didHit);
+		if (expected.didHit) {
+			++hits;
+			EXPECT_EQ(expected.hitVoxel, result.hitVoxel);
+			EXPECT_EQ(expected.previousPosition, result.previousPosition);
+		}
+	}
+	EXPECT_EQ(2, hits);
+
+	// the brick is empty again after the voxel was removed
+	v.setVoxel(glm::ivec3(100, 5, 100), voxel::Voxel());
+	EXPECT_FALSE(v.occupancy()->occupied(2, glm::ivec3(100, 5, 100)));
+	const PickResult &result = pickVoxel(&v, start, (targets[0] - start) * 2.0f, voxel::Voxel());
+	EXPECT_FALSE(result.didHit);
+}
+
 }
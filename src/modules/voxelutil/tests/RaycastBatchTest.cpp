@@ -0,0 +1,105 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/Picking.h"
+#include "voxelutil/RaycastBatch.h"
+
+namespace voxelutil {
+
+class RaycastBatchTest : public app::AbstractTest {
+protected:
+	void fillVolume(voxel::RawVolume &v) {
+		const voxel::Region &region = v.region();
+		const voxel::Voxel solid = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); z += 3) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); x += 5) {
+				const int y = region.getLowerY() + (x - region.getLowerX() + z) % region.getHeightInVoxels();
+				v.setVoxel(glm::ivec3(x, y, z), solid);
+			}
+		}
+	}
+
+	void createRays(const voxel::Region &region, core::DynamicArray<BatchRay> &rays) {
+		const glm::vec3 start = region.getLowerCornerf() - glm::vec3(5.3f, -40.1f, 3.7f);
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const glm::vec3 target((float)x + 0.37f, (float)region.getLowerY() + 0.21f, (float)z + 0.43f);
+				BatchRay ray;
+				ray.origin = start;
+				ray.directionAndLength = (target - start) * 1.5f;
+				rays.push_back(ray);
+			}
+		}
+	}
+
+	void verify(voxel::RawVolume &v, const core::DynamicArray<BatchRay> &rays,
+				const core::DynamicArray<BatchHit> &hits) {
+		int hitCount = 0;
+		for (size_t i = 0; i < rays.size(); ++i) {
+			const PickResult &expected =
+				pickVoxel<voxel::RawVolume>(&v, rays[i].origin, rays[i].directionAndLength, voxel::Voxel());
+			ASSERT_EQ(expected.didHit, hits[i].didHit) << "ray " << i;
+			if (expected.didHit) {
+				++hitCount;
+				EXPECT_EQ(expected.hitVoxel, hits[i].hitVoxel) << "ray " << i;
+			}
+		}
+		EXPECT_GT(hitCount, 0);
+	}
+};
+
+TEST_F(RaycastBatchTest, testRaycastBatch) {
+	voxel::RawVolume v(voxel::Region(glm::ivec3(-4, 0, 2), glm::ivec3(27, 15, 33)));
+	fillVolume(v);
+	core::DynamicArray<BatchRay> rays;
+	createRays(v.region(), rays);
+	// one incomplete packet at the end
+	rays.push_back(BatchRay{glm::vec3(-100.0f), glm::vec3(-1.0f)});
+	core::DynamicArray<BatchHit> hits;
+	hits.resize(rays.size());
+	raycastBatch(&v, rays.data(), (int)rays.size(), hits.data());
+	verify(v, rays, hits);
+	EXPECT_FALSE(hits.back().didHit);
+}
+
+TEST_F(RaycastBatchTest, testHitFace) {
+	voxel::RawVolume v(voxel::Region(glm::ivec3(0), glm::ivec3(9)));
+	v.setVoxel(glm::ivec3(5, 0, 5), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	v.setVoxel(glm::ivec3(2, 2, 2), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	const BatchRay rays[] = {
+		{glm::vec3(5.5f, 20.0f, 5.5f), glm::vec3(0.0f, -40.0f, 0.0f)},
+		{glm::vec3(-3.0f, 2.5f, 2.5f), glm::vec3(20.0f, 0.0f, 0.0f)},
+		{glm::vec3(2.5f, 2.5f, 2.5f), glm::vec3(1.0f, 0.0f, 0.0f)},
+	};
+	BatchHit hits[lengthof(rays)];
+	raycastBatch(&v, rays, lengthof(rays), hits);
+	ASSERT_TRUE(hits[0].didHit);
+	EXPECT_EQ(glm::ivec3(5, 0, 5), hits[0].hitVoxel);
+	EXPECT_EQ(voxel::FaceNames::PositiveY, hits[0].hitFace);
+	ASSERT_TRUE(hits[1].didHit);
+	EXPECT_EQ(glm::ivec3(2, 2, 2), hits[1].hitVoxel);
+	EXPECT_EQ(voxel::FaceNames::NegativeX, hits[1].hitFace);
+	ASSERT_TRUE(hits[2].didHit);
+	EXPECT_EQ(voxel::FaceNames::Max, hits[2].hitFace) << "The ray started inside of the voxel";
+}
+
+TEST_F(RaycastBatchTest, testRaycastBatchThreadPool) {
+	voxel::RawVolume v(voxel::Region(glm::ivec3(0), glm::ivec3(31)));
+	fillVolume(v);
+	core::DynamicArray<BatchRay> rays;
+	createRays(v.region(), rays);
+	core::DynamicArray<BatchHit> hits;
+	hits.resize(rays.size());
+	core::ThreadPool threadPool(2, "RaycastBatchTest");
+	threadPool.init();
+	raycastBatch(threadPool, &v, rays.data(), (int)rays.size(), hits.data(), 64);
+	threadPool.shutdown();
+	verify(v, rays, hits);
+}
+
+} // namespace voxelutil
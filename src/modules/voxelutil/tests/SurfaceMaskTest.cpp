@@ -0,0 +1,73 @@
+/**
+ * @file
+ */
+
+#include "voxelutil/SurfaceMask.h"
+#include "app/tests/AbstractTest.h"
+#include "core/concurrent/ThreadPool.h"
+#include "voxelutil/VolumeVisitor.h"
+
+namespace voxelutil {
+
+class SurfaceMaskTest : public app::AbstractTest {
+protected:
+	// taller than 64 voxels to cross the word boundary of the y columns
+	const voxel::Region _region{-3, -70, -2, 20, 80, 15};
+
+	void fill(voxel::RawVolume &volume) {
+		for (int32_t z = _region.getLowerZ(); z <= _region.getUpperZ(); ++z) {
+			for (int32_t y = _region.getLowerY(); y <= _region.getUpperY(); ++y) {
+				for (int32_t x = _region.getLowerX(); x <= _region.getUpperX(); ++x) {
+					if ((x * 7 + y * 3 + z * 5 + 1000) % 4 != 0) {
+						volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+					} else if (x % 3 == 0) {
+						// air with a color - must still be treated as air
+						volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Air, 2));
+					}
+				}
+			}
+		}
+	}
+};
+
+TEST_F(SurfaceMaskTest, testVisibleFaces) {
+	voxel::RawVolume volume(_region);
+	fill(volume);
+	core::ThreadPool threadPool(2, "SurfaceMaskTest");
+	threadPool.init();
+	const SurfaceMask mask(threadPool, volume);
+	for (int32_t z = _region.getLowerZ() - 1; z <= _region.getUpperZ() + 1; ++z) {
+		for (int32_t y = _region.getLowerY() - 1; y <= _region.getUpperY() + 1; ++y) {
+			for (int32_t x = _region.getLowerX() - 1; x <= _region.getUpperX() + 1; ++x) {
+				ASSERT_EQ(voxel::visibleFaces(volume, x, y, z), mask.visibleFaces(x, y, z))
+					<< x << ":" << y << ":" << z;
+			}
+		}
+	}
+	threadPool.shutdown();
+}
+
+TEST_F(SurfaceMaskTest, testVisitSurface) {
+	voxel::RawVolume volume(_region);
+	fill(volume);
+	core::ThreadPool threadPool(2, "SurfaceMaskTest");
+	threadPool.init();
+	const SurfaceMask mask(threadPool, volume);
+	core::DynamicArray<glm::ivec3> expected;
+	const int expectedCnt = visitSurfaceVolume(
+		volume, [&](int x, int y, int z, const voxel::Voxel &) { expected.emplace_back(x, y, z); },
+		VisitorOrder::XZY);
+	size_t i = 0;
+	const int cnt = mask.visitSurface([&](int x, int y, int z, voxel::FaceBits faces) {
+		ASSERT_LT(i, expected.size());
+		// same order as visitSurfaceVolume()
+		EXPECT_EQ(expected[i], glm::ivec3(x, y, z));
+		EXPECT_EQ(voxel::visibleFaces(volume, x, y, z), faces);
+		++i;
+	});
+	EXPECT_EQ(expectedCnt, cnt);
+	EXPECT_EQ(expected.size(), i);
+	threadPool.shutdown();
+}
+
+} // namespace voxelutil
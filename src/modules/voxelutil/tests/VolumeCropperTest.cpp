@@ -51,4 +51,20 @@ TEST_F(VolumeCropperTest, testCropBiggerMultiple) {
 	delete croppedVolume;
 }
 
+TEST_F(VolumeCropperTest, testCropOccupancy) {
+	voxel::Region region = voxel::Region(0, 100);
+	voxel::RawVolume smallVolume(region);
+	smallVolume.enableOccupancy();
+	smallVolume.setVoxel(region.getCenter(), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	smallVolume.setVoxel(region.getUpperCorner(), voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	// the bounds of the volume don't shrink - but the occupancy knows about the removed voxel
+	smallVolume.setVoxel(region.getUpperCorner(), voxel::Voxel());
+	voxel::RawVolume *croppedVolume = voxelutil::cropVolume(&smallVolume);
+	ASSERT_NE(nullptr, croppedVolume) << "Expected to get the cropped raw volume";
+	const voxel::Region& croppedRegion = croppedVolume->region();
+	EXPECT_EQ(croppedRegion.getUpperCorner(), region.getCenter()) << croppedRegion.toString();
+	EXPECT_EQ(croppedRegion.getLowerCorner(), region.getCenter()) << croppedRegion.toString();
+	delete croppedVolume;
+}
+
 }
@@ -0,0 +1,78 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "core/collection/DynamicArray.h"
+#include "voxelutil/VolumeParallel.h"
+
+namespace voxelutil {
+
+class VolumeParallelTest : public app::AbstractTest {};
+
+TEST_F(VolumeParallelTest, testParallelFor) {
+	const voxel::Region region(-3, 36);
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	core::DynamicArray<int> visits;
+	visits.resize(dim.x * dim.y * dim.z);
+	core::ThreadPool threadPool(2, "VolumeParallelTest");
+	threadPool.init();
+	core::AtomicInt regions;
+	parallelFor(threadPool, region, 16, [&](const voxel::Region &subRegion) {
+		EXPECT_TRUE(region.containsRegion(subRegion));
+		++regions;
+		for (int32_t z = subRegion.getLowerZ(); z <= subRegion.getUpperZ(); ++z) {
+			for (int32_t y = subRegion.getLowerY(); y <= subRegion.getUpperY(); ++y) {
+				for (int32_t x = subRegion.getLowerX(); x <= subRegion.getUpperX(); ++x) {
+					const glm::ivec3 p = glm::ivec3(x, y, z) - region.getLowerCorner();
+					++visits[p.x + p.y * dim.x + p.z * dim.x * dim.y];
+				}
+			}
+		}
+	});
+	EXPECT_EQ(27, regions);
+	for (size_t i = 0; i < visits.size(); ++i) {
+		// the sub regions don't overlap and cover the whole region
+		ASSERT_EQ(1, visits[i]) << "voxel at index " << i;
+	}
+	threadPool.shutdown();
+}
+
+TEST_F(VolumeParallelTest, testVisitVolumeParallel) {
+	const voxel::Region region(-3, 36);
+	voxel::RawVolume volume(region);
+	for (int32_t z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int32_t y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int32_t x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				if ((x * 7 + y * 3 + z + 1000) % 5 == 0) {
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+				} else if (x % 3 == 0) {
+					// air with a color - must still be skipped
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Air, 2));
+				}
+			}
+		}
+	}
+	const int all = visitVolume(volume, [](int, int, int, const voxel::Voxel &) {}, VisitAll());
+	EXPECT_EQ(region.voxels(), all);
+	int solid = 0;
+	visitVolume(volume, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+		EXPECT_EQ(0, (x * 7 + y * 3 + z + 1000) % 5) << x << ":" << y << ":" << z;
+		EXPECT_TRUE(voxel::isBlocked(voxel.getMaterial()));
+		++solid;
+	});
+	EXPECT_EQ(region.voxels() / 5, solid);
+
+	core::ThreadPool threadPool(2, "VolumeParallelTest");
+	threadPool.init();
+	core::AtomicInt visited;
+	const int n = visitVolumeParallel(threadPool, volume, [&](int x, int y, int z, const voxel::Voxel &voxel) {
+		EXPECT_TRUE(voxel::isBlocked(voxel.getMaterial())) << x << ":" << y << ":" << z;
+		++visited;
+	});
+	EXPECT_EQ(solid, n);
+	EXPECT_EQ(solid, visited);
+	threadPool.shutdown();
+}
+
+} // namespace voxelutil
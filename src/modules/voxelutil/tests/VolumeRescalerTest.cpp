@@ -0,0 +1,69 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxelutil/VolumeRescaler.h"
+
+namespace voxelutil {
+
+class VolumeRescalerTest : public app::AbstractTest {
+protected:
+	voxel::Palette _palette;
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		ASSERT_TRUE(_palette.nippon());
+	}
+};
+
+TEST_F(VolumeRescalerTest, testRescaleSolid) {
+	const uint8_t colorIndex = 42;
+	voxel::RawVolume source(voxel::Region(0, 15));
+	const voxel::Region &region = source.region();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				source.setVoxel(x, y, z, voxel::createVoxel(_palette, colorIndex));
+			}
+		}
+	}
+	voxel::RawVolume dest(voxel::Region(0, 7));
+	rescaleVolume(source, _palette, dest);
+	const voxel::Region &destRegion = dest.region();
+	for (int z = destRegion.getLowerZ(); z <= destRegion.getUpperZ(); ++z) {
+		for (int y = destRegion.getLowerY(); y <= destRegion.getUpperY(); ++y) {
+			for (int x = destRegion.getLowerX(); x <= destRegion.getUpperX(); ++x) {
+				const voxel::Voxel &voxel = dest.voxel(x, y, z);
+				ASSERT_TRUE(voxel::isBlocked(voxel.getMaterial())) << x << ":" << y << ":" << z;
+				ASSERT_EQ(_palette.color(colorIndex), _palette.color(voxel.getColor())) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+TEST_F(VolumeRescalerTest, testRescaleHalfFilled) {
+	voxel::RawVolume source(voxel::Region(0, 15));
+	const voxel::Region &region = source.region();
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y < 8; ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				source.setVoxel(x, y, z, voxel::createVoxel(_palette, (uint8_t)(x + z)));
+			}
+		}
+	}
+	voxel::RawVolume dest(voxel::Region(0, 7));
+	rescaleVolume(source, _palette, dest);
+	const voxel::Region &destRegion = dest.region();
+	for (int z = destRegion.getLowerZ(); z <= destRegion.getUpperZ(); ++z) {
+		for (int y = destRegion.getLowerY(); y <= destRegion.getUpperY(); ++y) {
+			for (int x = destRegion.getLowerX(); x <= destRegion.getUpperX(); ++x) {
+				EXPECT_EQ(y < 4, voxel::isBlocked(dest.voxel(x, y, z).getMaterial())) << x << ":" << y << ":" << z;
+			}
+		}
+	}
+}
+
+} // namespace voxelutil
@@ -15,6 +15,48 @@ protected:
 	inline core::String str(const voxel::Region& region) const {
 		return region.toString();
 	}
+
+	void fillPattern(voxel::RawVolume &volume) const {
+		const voxel::Region &region = volume.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					const uint8_t color = (uint8_t)((x * 7 + y * 13 + z * 31) & 0xff);
+					volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, color));
+				}
+			}
+		}
+	}
+
+	void expectSameVoxels(const voxel::RawVolume &expected, const voxel::RawVolume &actual) const {
+		ASSERT_EQ(expected.region(), actual.region());
+		const voxel::Region &region = expected.region();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+					ASSERT_TRUE(expected.voxel(x, y, z).isSame(actual.voxel(x, y, z))) << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+
+	void testRotateFourTimes(math::Axis axis) {
+		// not a cube and bigger than one tile to test the dimension swap and the tile borders
+		voxel::RawVolume volume(voxel::Region(glm::ivec3(-3, 2, 5), glm::ivec3(30, 20, 12)));
+		fillPattern(volume);
+		core::ScopedPtr<voxel::RawVolume> rotated(voxelutil::rotateAxis(&volume, axis));
+		ASSERT_NE(nullptr, rotated);
+		const glm::ivec3 &dim = volume.region().getDimensionsInVoxels();
+		const glm::ivec3 &rotatedDim = rotated->region().getDimensionsInVoxels();
+		const int axisIdx = math::getIndexForAxis(axis);
+		EXPECT_EQ(dim[axisIdx], rotatedDim[axisIdx]);
+		EXPECT_EQ(dim.x * dim.y * dim.z, rotatedDim.x * rotatedDim.y * rotatedDim.z);
+		for (int i = 0; i < 3; ++i) {
+			rotated = voxelutil::rotateAxis(rotated, axis);
+			ASSERT_NE(nullptr, rotated);
+		}
+		expectSameVoxels(volume, *rotated);
+	}
 };
 
 TEST_F(VolumeRotatorTest, DISABLED_testRotateAxisZ) {
@@ -43,6 +85,54 @@ TEST_F(VolumeRotatorTest, testRotateAxisY) {
 	ASSERT_EQ(voxel::VoxelType::Generic, rotated->voxel(0, 0, -1).getMaterial()) << smallVolume << "rotated: " << *rotated;
 }
 
+TEST_F(VolumeRotatorTest, testRotateAxisFourTimesX) {
+	testRotateFourTimes(math::Axis::X);
+}
+
+TEST_F(VolumeRotatorTest, testRotateAxisFourTimesY) {
+	testRotateFourTimes(math::Axis::Y);
+}
+
+TEST_F(VolumeRotatorTest, testRotateAxisFourTimesZ) {
+	testRotateFourTimes(math::Axis::Z);
+}
+
+TEST_F(VolumeRotatorTest, testRotateVolumeQuarterTurns) {
+	voxel::RawVolume volume(voxel::Region(glm::ivec3(-3, 2, 5), glm::ivec3(30, 20, 12)));
+	fillPattern(volume);
+	core::ScopedPtr<voxel::RawVolume> rotatedX(voxelutil::rotateAxis(&volume, math::Axis::X));
+	core::ScopedPtr<voxel::RawVolume> rotated(voxelutil::rotateVolume(&volume, glm::vec3(90.0f, 0.0f, 0.0f), glm::vec3(0.5f)));
+	expectSameVoxels(*rotatedX, *rotated);
+
+	core::ScopedPtr<voxel::RawVolume> rotatedZ(voxelutil::rotateAxis(&volume, math::Axis::Z));
+	rotatedZ = voxelutil::rotateAxis(rotatedZ, math::Axis::Z);
+	rotated = voxelutil::rotateVolume(&volume, glm::vec3(0.0f, 0.0f, -180.0f), glm::vec3(0.5f));
+	expectSameVoxels(*rotatedZ, *rotated);
+}
+
+TEST_F(VolumeRotatorTest, testMirrorAxis) {
+	const voxel::Region region(glm::ivec3(-3, 2, 5), glm::ivec3(30, 20, 12));
+	voxel::RawVolume volume(region);
+	fillPattern(volume);
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	for (int axisIdx = 0; axisIdx < 3; ++axisIdx) {
+		const math::Axis axis = axisIdx == 0 ? math::Axis::X : (axisIdx == 1 ? math::Axis::Y : math::Axis::Z);
+		core::ScopedPtr<voxel::RawVolume> mirrored(voxelutil::mirrorAxis(&volume, axis));
+		ASSERT_NE(nullptr, mirrored);
+		ASSERT_EQ(region, mirrored->region());
+		for (int z = mins.z; z <= maxs.z; ++z) {
+			for (int y = mins.y; y <= maxs.y; ++y) {
+				for (int x = mins.x; x <= maxs.x; ++x) {
+					glm::ivec3 pos(x, y, z);
+					pos[axisIdx] = maxs[axisIdx] - (pos[axisIdx] - mins[axisIdx]);
+					ASSERT_TRUE(volume.voxel(x, y, z).isSame(mirrored->voxel(pos))) << x << ":" << y << ":" << z;
+				}
+			}
+		}
+	}
+}
+
 TEST_F(VolumeRotatorTest, testRotateAxisY45) {
 	const voxel::Region region(-1, 1);
 	voxel::RawVolume smallVolume(region);
@@ -60,4 +60,45 @@ TEST_F(VolumeSplitterTest, testSplit) {
 	delete merged;
 }
 
+TEST_F(VolumeSplitterTest, testSplitSkipEmpty) {
+	voxel::RawVolume volume(voxel::Region(0, 31));
+	volume.setVoxel(20, 3, 5, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	volume.setVoxel(2, 30, 17, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+
+	core::DynamicArray<voxel::RawVolume *> rawVolumes;
+	voxelutil::splitVolume(&volume, glm::ivec3(16), rawVolumes);
+	ASSERT_EQ(2u, rawVolumes.size());
+	EXPECT_EQ(voxel::Region(16, 0, 0, 31, 15, 15), rawVolumes[0]->region());
+	EXPECT_EQ(voxel::Region(0, 16, 16, 15, 31, 31), rawVolumes[1]->region());
+	EXPECT_TRUE(voxel::isBlocked(rawVolumes[0]->voxel(20, 3, 5).getMaterial()));
+	EXPECT_TRUE(voxel::isBlocked(rawVolumes[1]->voxel(2, 30, 17).getMaterial()));
+	for (voxel::RawVolume *v : rawVolumes) {
+		delete v;
+	}
+}
+
+TEST_F(VolumeSplitterTest, testSplitRemainder) {
+	const voxel::Region region(-4, 35);
+	voxel::RawVolume volume(region);
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				volume.setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+			}
+		}
+	}
+
+	core::DynamicArray<voxel::RawVolume *> rawVolumes;
+	voxelutil::splitVolume(&volume, glm::ivec3(16), rawVolumes);
+	ASSERT_EQ(27u, rawVolumes.size());
+	EXPECT_EQ(voxel::Region(-4, 11), rawVolumes[0]->region());
+	EXPECT_EQ(voxel::Region(28, 35), rawVolumes[26]->region());
+	int voxels = 0;
+	for (voxel::RawVolume *v : rawVolumes) {
+		voxels += countVoxels(*v, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+		delete v;
+	}
+	EXPECT_EQ(40 * 40 * 40, voxels);
+}
+
 }
@@ -4,6 +4,7 @@
 
 #include "voxelutil/VoxelUtil.h"
 #include "app/tests/AbstractTest.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/Face.h"
 #include "voxel/Palette.h"
 #include "voxel/PaletteLookup.h"
@@ -64,6 +65,45 @@ TEST_F(VoxelUtilTest, testFillHollowLeak) {
 	EXPECT_EQ(0, v.voxel(region.getCenter()).getColor());
 }
 
+TEST_F(VoxelUtilTest, testHollow) {
+	core::ThreadPool threadPool(2, "VoxelUtilTest");
+	threadPool.init();
+	const voxel::Region region(0, 6);
+	const voxel::Voxel solidVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	for (int shellThickness = 1; shellThickness <= 3; ++shellThickness) {
+		voxel::RawVolume v(region);
+		voxelutil::visitVolume(
+			v, [&](int x, int y, int z, const voxel::Voxel &) { v.setVoxel(x, y, z, solidVoxel); }, VisitAll());
+		voxel::RawVolumeWrapper wrapper(&v);
+		const int inner = 7 - 2 * shellThickness;
+		EXPECT_EQ(inner * inner * inner, voxelutil::hollow(threadPool, wrapper, shellThickness));
+		EXPECT_TRUE(voxel::isAir(v.voxel(region.getCenter()).getMaterial()));
+		EXPECT_TRUE(voxel::isBlocked(v.voxel(shellThickness - 1, 3, 3).getMaterial()));
+	}
+	threadPool.shutdown();
+}
+
+TEST_F(VoxelUtilTest, testHollowOpening) {
+	core::ThreadPool threadPool(2, "VoxelUtilTest");
+	threadPool.init();
+	const voxel::Region region(0, 6);
+	voxel::RawVolume v(region);
+	const voxel::Voxel solidVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 1);
+	voxelutil::visitVolume(
+		v, [&](int x, int y, int z, const voxel::Voxel &) { v.setVoxel(x, y, z, solidVoxel); }, VisitAll());
+	// a tunnel into the center makes the voxels around it visible from outside
+	for (int z = 0; z <= 3; ++z) {
+		v.setVoxel(3, 3, z, voxel::Voxel());
+	}
+	voxel::RawVolumeWrapper wrapper(&v);
+	// the inner 5x5x5 without the 3 tunnel voxels, their 4 side neighbours and the voxel at the end of the tunnel
+	EXPECT_EQ(125 - 3 - 3 * 4 - 1, voxelutil::hollow(threadPool, wrapper, 1));
+	EXPECT_TRUE(voxel::isBlocked(v.voxel(2, 3, 2).getMaterial()));
+	EXPECT_TRUE(voxel::isBlocked(v.voxel(3, 3, 4).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(v.voxel(1, 1, 1).getMaterial()));
+	threadPool.shutdown();
+}
+
 TEST_F(VoxelUtilTest, testExtrudePlanePositiveY) {
 	voxel::Region region(0, 2);
 	voxel::RawVolume v(region);
@@ -111,6 +151,44 @@ TEST_F(VoxelUtilTest, testErasePlanePositiveY) {
 	EXPECT_EQ(2, voxelutil::visitVolume(v, [&](int, int, int, const voxel::Voxel &) {}));
 }
 
+TEST_F(VoxelUtilTest, testExtrudePlaneLarge) {
+	voxel::Region region(glm::ivec3(0), glm::ivec3(511, 2, 511));
+	voxel::RawVolume v(region);
+	const voxel::Voxel groundVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	const voxel::Voxel newPlaneVoxel = voxel::createVoxel(voxel::VoxelType::Generic, 3);
+	v.fill(voxel::Region(glm::ivec3(0), glm::ivec3(511, 0, 511)), groundVoxel);
+	voxel::RawVolumeWrapper wrapper(&v);
+	EXPECT_EQ(512 * 512, voxelutil::extrudePlane(wrapper, glm::ivec3(256, 1, 256), voxel::FaceNames::PositiveY,
+												 groundVoxel, newPlaneVoxel));
+}
+
+TEST_F(VoxelUtilTest, testPaintPlaneSerpentine) {
+	voxel::Region region(glm::ivec3(0), glm::ivec3(15, 0, 15));
+	voxel::RawVolume v(region);
+	const voxel::Voxel fillVoxel1 = voxel::createVoxel(voxel::VoxelType::Generic, 2);
+	const voxel::Voxel fillVoxel2 = voxel::createVoxel(voxel::VoxelType::Generic, 3);
+	v.fill(region, fillVoxel1);
+	// walls in every odd column with the gap alternating between both ends - the spans have to turn around
+	for (int x = 1; x < 16; x += 2) {
+		const int gap = (x % 4) == 1 ? 15 : 0;
+		for (int z = 0; z < 16; ++z) {
+			if (z != gap) {
+				v.setVoxel(x, 0, z, fillVoxel2);
+			}
+		}
+	}
+	voxel::RawVolumeWrapper wrapper(&v);
+	EXPECT_EQ(16 * 16 - 8 * 15,
+			  voxelutil::paintPlane(wrapper, glm::ivec3(0, 0, 0), voxel::FaceNames::PositiveY, fillVoxel1, fillVoxel2));
+	int voxel2counter = 0;
+	voxelutil::visitVolume(v, [&](int, int, int, const voxel::Voxel &voxel) {
+		if (voxel.getColor() == fillVoxel2.getColor()) {
+			voxel2counter++;
+		}
+	});
+	EXPECT_EQ(16 * 16, voxel2counter);
+}
+
 TEST_F(VoxelUtilTest, testFillEmptyPlaneNegativeX) {
 	voxel::Region region(-2, 0);
 	voxel::RawVolume v(region);
@@ -138,6 +216,19 @@ TEST_F(VoxelUtilTest, testFillEmptyPlanePositiveZ) {
 	EXPECT_EQ(9, voxelutil::visitVolume(v, [&](int, int, int, const voxel::Voxel &) {}));
 }
 
+TEST_F(VoxelUtilTest, testFillTerrain) {
+	const voxel::Region region(glm::ivec3(-16, 0, 8), glm::ivec3(15, 31, 39));
+	voxel::RawVolume v1(region);
+	voxel::RawVolume v2(region);
+	const int64_t voxels = fillTerrain(v1, 0.05f);
+	EXPECT_EQ(voxels, fillTerrain(v2, 0.05f)) << "The terrain must be reproducible";
+	EXPECT_GT(voxels, 0);
+	EXPECT_LT(voxels, (int64_t)region.voxels());
+	// every column has at least the ground voxel
+	EXPECT_TRUE(voxel::isBlocked(v1.voxel(-16, 0, 8).getMaterial()));
+	EXPECT_TRUE(voxel::isBlocked(v1.voxel(15, 0, 39).getMaterial()));
+}
+
 TEST_F(VoxelUtilTest, testFillPlaneWithImage) {
 	voxel::PaletteLookup palLookup;
 
@@ -73,23 +73,11 @@ void TestBloom::onRenderUI() {
 	ImGui::Text("glow");
 	ImGui::Image(_glowTexture->handle(), glm::ivec2(_glowTexture->width(), _glowTexture->height()));
 
-	for (int i = 0; i < render::BloomRenderer::passes(); ++i) {
+	for (int i = 0; i < _bloomRenderer.levels(); ++i) {
 		ImGui::Separator();
-		{
-			const video::TexturePtr &tex = _bloomRenderer.texture0(i);
-			ImGui::Text("texture0[%i] %i:%i", i, tex->width(), tex->height());
-			ImGui::Image(tex->handle(), glm::ivec2(tex->width(), tex->height()));
-		}
-		{
-			const video::TexturePtr &tex = _bloomRenderer.texture1(i);
-			ImGui::Text("texture1[%i] %i:%i", i, tex->width(), tex->height());
-			ImGui::Image(tex->handle(), glm::ivec2(tex->width(), tex->height()));
-		}
-		{
-			const video::TexturePtr &tex = _bloomRenderer.texture2(i);
-			ImGui::Text("texture2[%i] %i:%i", i, tex->width(), tex->height());
-			ImGui::Image(tex->handle(), glm::ivec2(tex->width(), tex->height()));
-		}
+		const video::TexturePtr &tex = _bloomRenderer.texture(i);
+		ImGui::Text("level[%i] %i:%i", i, tex->width(), tex->height());
+		ImGui::Image(tex->handle(), glm::ivec2(tex->width(), tex->height()));
 	}
 }
 
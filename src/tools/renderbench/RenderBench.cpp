@@ -0,0 +1,362 @@
+/**
+ * @file
+ */
+
+#include "RenderBench.h"
+#include "core/Algorithm.h"
+#include "core/Common.h"
+#include "core/GameConfig.h"
+#include "core/Log.h"
+#include "core/Singleton.h"
+#include "core/StringUtil.h"
+#include "core/TimeProvider.h"
+#include "core/Var.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "video/Camera.h"
+#include "video/GPUTimer.h"
+#include "video/Renderer.h"
+#include "voxel/Palette.h"
+#include "voxel/RawVolume.h"
+#include "voxelformat/FormatConfig.h"
+#include "voxelformat/VolumeFormat.h"
+#include "voxelrender/ThumbnailRenderer.h"
+#include "voxelutil/VoxelUtil.h"
+#include <SDL_hints.h>
+#include <SDL_stdinc.h>
+#include <glm/gtc/constants.hpp>
+#include <inttypes.h>
+
+// the gpu timer results of the first frames are not available yet
+static constexpr int WarmupFrames = 4;
+
+static const char *GeneratedScenes[] = {"smallnodes", "hugevolume", "transparent"};
+
+RenderBench::RenderBench(const io::FilesystemPtr &filesystem, const core::TimeProviderPtr &timeProvider)
+	: Super(filesystem, timeProvider) {
+	init(ORGANISATION, "renderbench");
+	_showWindow = false;
+	_additionalUsage = "[--scene <name>] [--input <file>]";
+}
+
+app::AppState RenderBench::onConstruct() {
+	app::AppState state = Super::onConstruct();
+
+	voxelformat::FormatConfig::init();
+
+	registerArg("--scene").setShort("-s").setDescription("Render the given generated scene (smallnodes, hugevolume or transparent) - all of them are rendered if neither --scene nor --input is given");
+	registerArg("--input").setShort("-i").setDescription("Render the given voxel file");
+	registerArg("--frames").setShort("-f").setDescription("The amount of measured frames per scene").setDefaultValue("300");
+	registerArg("--width").setDescription("The width of the framebuffer").setDefaultValue("1280");
+	registerArg("--height").setDescription("The height of the framebuffer").setDefaultValue("720");
+	registerArg("--csv").setDescription("Write the measurements of every frame into the given csv file");
+	registerArg("--headless").setDescription("Use the offscreen video driver - this allows to render without a display server");
+
+	return state;
+}
+
+app::AppState RenderBench::onInit() {
+	if (hasArg("--headless")) {
+#ifdef SDL_HINT_VIDEODRIVER
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+#else
+		SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+#endif
+	}
+	// the frame times should not be limited by the refresh rate
+	core::Var::get(cfg::ClientVSync, "false")->setVal(false);
+
+	const app::AppState state = Super::onInit();
+	if (state != app::AppState::Running) {
+		return state;
+	}
+
+	_frames = core_max(1, core::string::toInt(getArgVal("--frames")));
+	_size.x = core_max(1, core::string::toInt(getArgVal("--width")));
+	_size.y = core_max(1, core::string::toInt(getArgVal("--height")));
+
+	int argn = 0;
+	for (;;) {
+		const core::String &name = getArgVal("--scene", "", &argn);
+		if (name.empty()) {
+			break;
+		}
+		_scenes.push_back({name, ""});
+	}
+	argn = 0;
+	for (;;) {
+		core::String file = getArgVal("--input", "", &argn);
+		if (file.empty()) {
+			break;
+		}
+		io::normalizePath(file);
+		_scenes.push_back({core::string::extractFilename(file), file});
+	}
+	if (_scenes.empty()) {
+		for (const char *name : GeneratedScenes) {
+			_scenes.push_back({name, ""});
+		}
+	}
+
+	_renderer.construct();
+	if (!_renderContext.init(_size)) {
+		Log::error("Failed to initialize the render context");
+		return app::AppState::InitFailure;
+	}
+	if (!_renderer.init()) {
+		Log::error("Failed to initialize the renderer");
+		_renderContext.shutdown();
+		return app::AppState::InitFailure;
+	}
+	_renderer.setSceneMode(true);
+	_rendererInitialized = true;
+
+	core::Singleton<video::GPUTimer>::getInstance().setEnabled(true);
+	if (hasArg("--csv")) {
+		_csv = "scene,frame,update_ms,render_ms,gpu_ms,drawcalls,triangles,uploads,upload_bytes\n";
+	}
+
+	return state;
+}
+
+static voxel::RawVolume *createTerrain(const voxel::Region &region, float frequency) {
+	voxel::RawVolume *v = new voxel::RawVolume(region);
+	voxelutil::fillTerrain(*v, frequency);
+	return v;
+}
+
+static void addNode(scenegraph::SceneGraph &sceneGraph, voxel::RawVolume *v, const voxel::Palette *palette = nullptr) {
+	scenegraph::SceneGraphNode node;
+	node.setVolume(v, true);
+	if (palette != nullptr) {
+		node.setPalette(*palette);
+	}
+	sceneGraph.emplace(core::move(node));
+}
+
+bool RenderBench::createScene(const core::String &name) {
+	if (name == "smallnodes") {
+		// a lot of nodes with a few draw calls each
+		for (int i = 0; i < 1000; ++i) {
+			const glm::ivec3 mins((i % 10) * 20, ((i / 10) % 10) * 20, (i / 100) * 20);
+			addNode(_sceneGraph, createTerrain(voxel::Region(mins, mins + 15), 0.05f));
+		}
+		return true;
+	}
+	if (name == "hugevolume") {
+		// one node with a lot of chunks
+		addNode(_sceneGraph, createTerrain(voxel::Region(glm::ivec3(0), glm::ivec3(511, 127, 511)), 0.01f));
+		return true;
+	}
+	if (name == "transparent") {
+		// the transparent voxels are sorted and blended - half of the colors are translucent
+		voxel::Palette palette;
+		palette.nippon();
+		for (int i = 1; i <= 32; i += 2) {
+			palette.color(i).a = 128;
+		}
+		for (int i = 0; i < 16; ++i) {
+			const glm::ivec3 mins((i % 4) * 72, 0, (i / 4) * 72);
+			addNode(_sceneGraph, createTerrain(voxel::Region(mins, mins + 63), 0.03f), &palette);
+		}
+		return true;
+	}
+	Log::error("Unknown scene '%s'", name.c_str());
+	return false;
+}
+
+bool RenderBench::loadScene(const Scene &scene) {
+	_renderer.clear();
+	_sceneGraph.clear();
+	_samples.clear();
+	_frame = 0;
+
+	if (scene.file.empty()) {
+		if (!createScene(scene.name)) {
+			return false;
+		}
+	} else {
+		io::FileStream stream(filesystem()->open(scene.file, io::FileMode::SysRead));
+		voxelformat::LoadContext loadctx;
+		if (!voxelformat::loadFormat(scene.file, stream, _sceneGraph, loadctx)) {
+			Log::error("Failed to load %s", scene.file.c_str());
+			return false;
+		}
+	}
+
+	const uint64_t start = core::TimeProvider::highResTime();
+	renderFrame(false);
+	const uint64_t end = core::TimeProvider::highResTime();
+	_firstFrameMillis = (double)(end - start) * 1000.0 / (double)core::TimeProvider::highResTimeResolution();
+	return true;
+}
+
+void RenderBench::renderFrame(bool record) {
+	// a full orbit around the scene - the camera goes up and down a little bit to change the visible chunks
+	voxelformat::ThumbnailContext ctx;
+	ctx.outputSize = _size;
+	const float progress = (float)_frame / (float)(_frames + WarmupFrames);
+	ctx.yaw = glm::two_pi<float>() * progress;
+	ctx.pitch = 0.2f * glm::sin(glm::two_pi<float>() * progress * 2.0f);
+	video::Camera camera;
+	voxelrender::ThumbnailRenderer::setupCamera(camera, _sceneGraph.region(), ctx);
+
+	video::clearColor(ctx.clearColor);
+	video::enable(video::State::DepthTest);
+	video::depthFunc(video::CompareFunc::LessEqual);
+	video::enable(video::State::CullFace);
+	video::enable(video::State::DepthMask);
+	video::enable(video::State::Blend);
+	video::blendFunc(video::BlendMode::SourceAlpha, video::BlendMode::OneMinusSourceAlpha);
+
+	const uint64_t resolution = core::TimeProvider::highResTimeResolution();
+	const uint64_t start = core::TimeProvider::highResTime();
+	// the first frame waits for all extractions - the others only upload what is finished
+	const bool waitPending = _frame == 0;
+	_renderer.prepare(_sceneGraph);
+	if (!waitPending) {
+		_renderer.update();
+	}
+	const uint64_t updated = core::TimeProvider::highResTime();
+	_renderContext.frameBuffer.bind(true);
+	_renderer.render(_renderContext, camera, true, waitPending);
+	_renderContext.frameBuffer.unbind();
+	const uint64_t rendered = core::TimeProvider::highResTime();
+	++_frame;
+
+	if (record) {
+		Sample sample;
+		sample.updateMillis = (double)(updated - start) * 1000.0 / (double)resolution;
+		sample.renderMillis = (double)(rendered - updated) * 1000.0 / (double)resolution;
+		_samples.push_back(sample);
+	}
+}
+
+void RenderBench::collectSample(Sample &sample) const {
+	// the counters of the last frame are finished in onAfterRunning()
+	const video::RenderStats &stats = video::lastFrameRenderStats();
+	sample.drawCalls = stats.drawCalls;
+	sample.triangles = stats.triangles;
+	sample.bufferUploads = stats.bufferUploads;
+	sample.bufferUploadBytes = stats.bufferUploadBytes;
+	for (const video::GPUTimer::Result &result : core::Singleton<video::GPUTimer>::getInstance().results()) {
+		if (result.depth == 0) {
+			sample.gpuMillis += result.millis;
+		}
+	}
+}
+
+/**
+ * @brief Nearest rank percentile of the sorted values
+ */
+static double percentile(const core::DynamicArray<double> &sorted, double p) {
+	if (sorted.empty()) {
+		return 0.0;
+	}
+	const size_t rank = (size_t)glm::ceil(p * (double)sorted.size());
+	return sorted[core_max(rank, (size_t)1) - 1];
+}
+
+static void logDistribution(const char *name, core::DynamicArray<double> &values) {
+	core::sort(values.begin(), values.end(), core::Less<double>());
+	double sum = 0.0;
+	for (double v : values) {
+		sum += v;
+	}
+	const double mean = values.empty() ? 0.0 : sum / (double)values.size();
+	Log::info("  %-10s mean %8.3f p50 %8.3f p95 %8.3f p99 %8.3f max %8.3f", name, mean, percentile(values, 0.5),
+			  percentile(values, 0.95), percentile(values, 0.99), values.empty() ? 0.0 : values.back());
+}
+
+void RenderBench::report() const {
+	const Scene &scene = _scenes[_scene];
+	core::DynamicArray<double> update;
+	core::DynamicArray<double> render;
+	core::DynamicArray<double> cpu;
+	core::DynamicArray<double> gpu;
+	uint64_t drawCalls = 0u;
+	uint64_t triangles = 0u;
+	uint64_t uploadBytes = 0u;
+	uint32_t maxDrawCalls = 0u;
+	for (const Sample &sample : _samples) {
+		update.push_back(sample.updateMillis);
+		render.push_back(sample.renderMillis);
+		cpu.push_back(sample.updateMillis + sample.renderMillis);
+		gpu.push_back(sample.gpuMillis);
+		drawCalls += sample.drawCalls;
+		triangles += sample.triangles;
+		uploadBytes += sample.bufferUploadBytes;
+		maxDrawCalls = core_max(maxDrawCalls, sample.drawCalls);
+	}
+	const uint64_t frames = core_max((uint64_t)_samples.size(), (uint64_t)1);
+	Log::info("%s: %i nodes, %i frames at %ix%i", scene.name.c_str(), (int)_sceneGraph.size(), (int)_samples.size(),
+			  _size.x, _size.y);
+	Log::info("  first frame (with all extractions) %.3f ms", _firstFrameMillis);
+	logDistribution("cpu", cpu);
+	logDistribution("update", update);
+	logDistribution("render", render);
+	logDistribution("gpu", gpu);
+	Log::info("  drawcalls  mean %8" PRIu64 " max %8u", drawCalls / frames, maxDrawCalls);
+	Log::info("  triangles  mean %8" PRIu64, triangles / frames);
+	Log::info("  uploads    total %" PRIu64 " bytes", uploadBytes);
+}
+
+app::AppState RenderBench::onRunning() {
+	app::AppState state = Super::onRunning();
+	if (state != app::AppState::Running) {
+		return state;
+	}
+
+	// the counters of the frame that was rendered in the last call are available now
+	if (_scene >= 0 && _frame > WarmupFrames && !_samples.empty()) {
+		Sample &sample = _samples.back();
+		collectSample(sample);
+		if (!_csv.empty()) {
+			_csv.append(core::string::format("%s,%i,%f,%f,%f,%u,%" PRIu64 ",%u,%" PRIu64 "\n",
+											 _scenes[_scene].name.c_str(), (int)_samples.size() - 1,
+											 sample.updateMillis, sample.renderMillis, sample.gpuMillis,
+											 sample.drawCalls, sample.triangles, sample.bufferUploads,
+											 sample.bufferUploadBytes));
+		}
+	}
+
+	if (_scene < 0 || _frame >= _frames + WarmupFrames) {
+		if (_scene >= 0) {
+			report();
+		}
+		++_scene;
+		if (_scene >= (int)_scenes.size()) {
+			if (!_csv.empty() && !filesystem()->write(getArgVal("--csv"), _csv)) {
+				Log::error("Failed to write %s", getArgVal("--csv").c_str());
+			}
+			requestQuit();
+			return state;
+		}
+		if (!loadScene(_scenes[_scene])) {
+			requestQuit();
+			return state;
+		}
+		return state;
+	}
+
+	renderFrame(_frame >= WarmupFrames);
+	return state;
+}
+
+app::AppState RenderBench::onCleanup() {
+	if (_rendererInitialized) {
+		_renderer.shutdown();
+		_renderContext.shutdown();
+		_rendererInitialized = false;
+	}
+	_sceneGraph.clear();
+	return Super::onCleanup();
+}
+
+int main(int argc, char *argv[]) {
+	const io::FilesystemPtr &filesystem = core::make_shared<io::Filesystem>();
+	const core::TimeProviderPtr &timeProvider = core::make_shared<core::TimeProvider>();
+	RenderBench app(filesystem, timeProvider);
+	return app.startMainLoop(argc, argv);
+}
@@ -0,0 +1,71 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/collection/DynamicArray.h"
+#include "scenegraph/SceneGraph.h"
+#include "video/WindowedApp.h"
+#include "voxelrender/SceneGraphRenderer.h"
+
+/**
+ * @brief Renders a scripted camera flythrough around generated or loaded scenes and reports the frame time
+ * distribution
+ *
+ * Every frame is split into the update part (mesh extraction results and buffer uploads) and the render part on the
+ * cpu side. The gpu time, the draw calls and the buffer uploads are taken from the counters of the video layer.
+ *
+ * @ingroup Tools
+ */
+class RenderBench : public video::WindowedApp {
+private:
+	using Super = video::WindowedApp;
+
+	struct Sample {
+		double updateMillis = 0.0;
+		double renderMillis = 0.0;
+		/** the gpu timer results lag a few frames behind the rendered frame */
+		double gpuMillis = 0.0;
+		uint32_t drawCalls = 0u;
+		uint64_t triangles = 0u;
+		uint32_t bufferUploads = 0u;
+		uint64_t bufferUploadBytes = 0u;
+	};
+
+	struct Scene {
+		core::String name;
+		/** empty for the generated scenes */
+		core::String file;
+	};
+
+	core::DynamicArray<Scene> _scenes;
+	core::DynamicArray<Sample> _samples;
+	/** one line per frame of all scenes - only filled if --csv was given */
+	core::String _csv;
+	scenegraph::SceneGraph _sceneGraph;
+	voxelrender::SceneGraphRenderer _renderer;
+	voxelrender::RenderContext _renderContext;
+	glm::ivec2 _size{1280, 720};
+	int _scene = -1;
+	/** the rendered frames of the current scene - including the warmup frames */
+	int _frame = 0;
+	int _frames = 0;
+	/** the time until the first complete frame of the scene was rendered - this includes all mesh extractions */
+	double _firstFrameMillis = 0.0;
+	bool _rendererInitialized = false;
+
+	bool createScene(const core::String &name);
+	bool loadScene(const Scene &scene);
+	void renderFrame(bool record);
+	void collectSample(Sample &sample) const;
+	void report() const;
+
+public:
+	RenderBench(const io::FilesystemPtr &filesystem, const core::TimeProviderPtr &timeProvider);
+
+	app::AppState onConstruct() override;
+	app::AppState onInit() override;
+	app::AppState onRunning() override;
+	app::AppState onCleanup() override;
+};
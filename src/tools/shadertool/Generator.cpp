@@ -161,6 +161,36 @@ bool generateSrc(const core::String& templateHeader, const core::String& templat
 		methods += ";\n";
 		methods += "}\n";
 	}
+	if (shaderStruct.in.layout.localSize.x != -1) {
+		prototypes += "\n\tint getLocalSizeX() const;\n";
+		methods += "\nint ";
+		methods += filename;
+		methods += "::getLocalSizeX() const {\n";
+		methods += "\treturn ";
+		methods += core::string::toString(shaderStruct.in.layout.localSize.x);
+		methods += ";\n";
+		methods += "}\n";
+	}
+	if (shaderStruct.in.layout.localSize.y != -1) {
+		prototypes += "\n\tint getLocalSizeY() const;\n";
+		methods += "\nint ";
+		methods += filename;
+		methods += "::getLocalSizeY() const {\n";
+		methods += "\treturn ";
+		methods += core::string::toString(shaderStruct.in.layout.localSize.y);
+		methods += ";\n";
+		methods += "}\n";
+	}
+	if (shaderStruct.in.layout.localSize.z != -1) {
+		prototypes += "\n\tint getLocalSizeZ() const;\n";
+		methods += "\nint ";
+		methods += filename;
+		methods += "::getLocalSizeZ() const {\n";
+		methods += "\treturn ";
+		methods += core::string::toString(shaderStruct.in.layout.localSize.z);
+		methods += ";\n";
+		methods += "}\n";
+	}
 	int n = 0;
 	for (const Variable& v : shaderStruct.uniforms) {
 		const bool isInteger = v.isSingleInteger();
@@ -282,28 +312,6 @@ bool generateSrc(const core::String& templateHeader, const core::String& templat
 				methods += ";\n}\n";
 			}
 		}
-		if (layout.localSize.x != -1) {
-			prototypes += "\n\tint getLocalSizeX() const;\n";
-			methods += "\nint getLocalSizeX() const {\n";
-			methods += "\treturn ";
-			methods += core::string::toString(layout.localSize.x);
-			methods += ";\n\t}\n";
-		}
-		if (layout.localSize.y != -1) {
-			prototypes += "\n\tint getLocalSizeY() const;\n";
-			methods += "\nint getLocalSizeY() const {\n";
-			methods += "\treturn ";
-			methods += core::string::toString(layout.localSize.y);
-			methods += ";\n\t}\n";
-		}
-		if (layout.localSize.z != -1) {
-			prototypes += "\n\tint getLocalSizeY() const;\n";
-			methods += "\nint getLocalSizeZ() const {\n";
-			methods += "\treturn ";
-			methods += core::string::toString(layout.localSize.z);
-			methods += ";\n\t}\n";
-		}
-
 		if (v.arraySize > 0) {
 			prototypes += "\n\tbool set";
 			prototypes += uniformName;
@@ -65,8 +65,7 @@ static bool parseLayout(TokenIterator& tok, Layout& layout) {
 		if (token == "std140") {
 			layout.blockLayout = BlockLayout::std140;
 		} else if (token == "std430") {
-			Log::error("Unsupported alignment");
-			return false;
+			layout.blockLayout = BlockLayout::std430;
 		} else if (token == "location") {
 			if (!tok.hasNext() || tok.next() != "=") {
 				Log::error("Expected = for location");
@@ -29,4 +29,9 @@ TEST_F(ShaderToolTest, testParse) {
 	ASSERT_EQ(2u, shaderStruct.layouts.size());
 	ASSERT_EQ(1u, shaderStruct.uniformBlocks.size());
 	ASSERT_EQ("u_materialblock", shaderStruct.uniformBlocks.begin()->value.name);
+	ASSERT_EQ(1u, shaderStruct.bufferBlocks.size());
+	const BufferBlock &bufferBlock = shaderStruct.bufferBlocks.begin()->value;
+	EXPECT_EQ("u_drawdata", bufferBlock.name);
+	EXPECT_EQ(BlockLayout::std430, bufferBlock.layout.blockLayout);
+	EXPECT_EQ(2, bufferBlock.layout.binding);
 }
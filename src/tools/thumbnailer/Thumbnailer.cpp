@@ -7,6 +7,7 @@
 #include "command/Command.h"
 #include "core/StringUtil.h"
 #include "glm/gtc/constants.hpp"
+#include "image/Image.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
 #include "core/TimeProvider.h"
@@ -15,14 +16,19 @@
 #include "voxelformat/FormatConfig.h"
 #include "voxelformat/VolumeFormat.h"
 #include "voxelrender/ImageGenerator.h"
+#include "voxelrender/ThumbnailRenderer.h"
 #include "core/Log.h"
+#include "core/Metrics.h"
+#include <SDL_hints.h>
+#include <SDL_stdinc.h>
+#include <inttypes.h>
 
 Thumbnailer::Thumbnailer(const io::FilesystemPtr& filesystem, const core::TimeProviderPtr& timeProvider) :
 		Super(filesystem, timeProvider) {
 	init(ORGANISATION, "thumbnailer");
 	_showWindow = false;
 	_initialLogLevel = SDL_LOG_PRIORITY_ERROR;
-	_additionalUsage = "<infile> <outfile>";
+	_additionalUsage = "<infile> <outfile> | --input <infile> [--input <infile>] --output <dir>";
 }
 
 app::AppState Thumbnailer::onConstruct() {
@@ -32,40 +38,86 @@ app::AppState Thumbnailer::onConstruct() {
 
 	registerArg("--size").setShort("-s").setDescription("Size of the thumbnail in pixels").setDefaultValue("128").setMandatory();
 	registerArg("--turntable").setShort("-t").setDescription("Render in different angles");
+	registerArg("--cache").setShort("-c").setDescription("Directory to cache the thumbnails in - the cache key is the content of the input file");
+	registerArg("--input").setShort("-i").setDescription("Render a thumbnail for each given input file - needs --output");
+	registerArg("--output").setShort("-o").setDescription("The directory to write the thumbnails for the --input files to");
+	registerArg("--headless").setDescription("Use the offscreen video driver - this allows to render without a display server");
+	registerArg("--software").setDescription("Render on the cpu - no gpu, renderer context or display server is needed");
+	registerArg("--png-level").setDescription("Use the fast png encoder with the given deflate level (0 is no compression, 9 the best compression)");
 
 	return state;
 }
 
 app::AppState Thumbnailer::onInit() {
-	const app::AppState state = Super::onInit();
+	_software = hasArg("--software");
+	if (hasArg("--headless")) {
+#ifdef SDL_HINT_VIDEODRIVER
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+#else
+		SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+#endif
+	}
+	// the cpu renderer doesn't need a window or a renderer context
+	const app::AppState state = _software ? app::App::onInit() : Super::onInit();
 	if (state != app::AppState::Running) {
 		return state;
 	}
 
-	if (_argc < 2) {
+	if (hasArg("--png-level")) {
+		image::PngCompression compression;
+		compression.fast = true;
+		compression.level = core::string::toInt(getArgVal("--png-level"));
+		image::setPngCompression(compression);
+	}
+
+	if (hasArg("--input")) {
+		const core::String outputDir = getArgVal("--output");
+		if (outputDir.empty()) {
+			Log::error("No --output directory given for the --input files");
+			usage();
+			return app::AppState::InitFailure;
+		}
+		if (!filesystem()->createDir(outputDir)) {
+			Log::error("Failed to create the output directory '%s'", outputDir.c_str());
+			return app::AppState::InitFailure;
+		}
+		int argn = 0;
+		for (;;) {
+			core::String infile = getArgVal("--input", "", &argn);
+			if (infile.empty()) {
+				break;
+			}
+			io::normalizePath(infile);
+			const core::String &name = core::string::extractFilename(infile);
+			_jobs.push_back({infile, core::string::path(outputDir, name + ".png")});
+		}
+	} else if (_argc >= 3) {
+		_jobs.push_back({_argv[_argc - 2], _argv[_argc - 1]});
+	}
+
+	if (_jobs.empty()) {
 		_logLevelVar->setVal(SDL_LOG_PRIORITY_INFO);
 		Log::init();
 		usage();
 		return app::AppState::InitFailure;
 	}
 
-	const core::String infile = _argv[_argc - 2];
-	_outfile = _argv[_argc - 1];
-
-	Log::debug("infile: %s", infile.c_str());
-	Log::debug("outfile: %s", _outfile.c_str());
-
-	_infile = filesystem()->open(infile, io::FileMode::SysRead);
-	if (!_infile->exists()) {
-		Log::error("Given input file '%s' does not exist", infile.c_str());
-		usage();
-		return app::AppState::InitFailure;
+	for (const Job &job : _jobs) {
+		Log::debug("infile: %s, outfile: %s", job.infile.c_str(), job.outfile.c_str());
+		if (!filesystem()->open(job.infile, io::FileMode::SysRead)->exists()) {
+			Log::error("Given input file '%s' does not exist", job.infile.c_str());
+			usage();
+			return app::AppState::InitFailure;
+		}
 	}
 
 	return state;
 }
 
-static image::ImagePtr volumeThumbnail(const core::String &fileName, io::SeekableReadStream &stream, const voxelformat::ThumbnailContext &ctx) {
+/**
+ * @param renderer The renderer for the gpu - or @c nullptr to render on the cpu
+ */
+static image::ImagePtr volumeThumbnail(voxelrender::ThumbnailRenderer *renderer, const core::String &fileName, io::SeekableReadStream &stream, const voxelformat::ThumbnailContext &ctx) {
 	voxelformat::LoadContext loadctx;
 	image::ImagePtr image = voxelformat::loadScreenshot(fileName, stream, loadctx);
 	if (image && image->isLoaded()) {
@@ -78,10 +130,13 @@ static image::ImagePtr volumeThumbnail(const core::String &fileName, io::Seekabl
 		Log::error("Failed to load given input file: %s", fileName.c_str());
 		return image::ImagePtr();
 	}
-	return voxelrender::volumeThumbnail(sceneGraph, ctx);
+	if (renderer == nullptr) {
+		return voxelrender::volumeThumbnailSoftware(sceneGraph, ctx);
+	}
+	return renderer->render(sceneGraph, ctx);
 }
 
-static bool volumeTurntable(const core::String &modelFile, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops) {
+static bool volumeTurntable(const core::String &modelFile, const core::String &imageFile, voxelformat::ThumbnailContext ctx, int loops, bool software) {
 	scenegraph::SceneGraph sceneGraph;
 	io::FileStream stream(io::filesystem()->open(modelFile, io::FileMode::SysRead));
 	stream.seek(0);
@@ -91,41 +146,114 @@ static bool volumeTurntable(const core::String &modelFile, const core::String &i
 		return false;
 	}
 
-	return voxelrender::volumeTurntable(sceneGraph, imageFile, ctx, loops);
+	return voxelrender::volumeTurntable(sceneGraph, imageFile, ctx, loops, software);
 }
 
 
+bool Thumbnailer::thumbnail(voxelrender::ThumbnailRenderer &renderer, const Job &job, int outputSize) {
+	_infile = filesystem()->open(job.infile, io::FileMode::SysRead);
+	_outfile = job.outfile;
+	_cacheFile = "";
+	if (hasArg("--cache")) {
+		_cacheFile = cacheFile(getArgVal("--cache"), outputSize);
+	}
+	if (loadFromCache()) {
+		return true;
+	}
+	voxelformat::ThumbnailContext ctx;
+	ctx.outputSize = glm::ivec2(outputSize);
+	io::FileStream stream(_infile);
+	const image::ImagePtr &image = volumeThumbnail(_software ? nullptr : &renderer, _infile->name(), stream, ctx);
+	return saveImage(image);
+}
+
 app::AppState Thumbnailer::onRunning() {
-	app::AppState state = Super::onRunning();
+	app::AppState state = _software ? app::App::onRunning() : Super::onRunning();
 	if (state != app::AppState::Running) {
 		return state;
 	}
 
 	const int outputSize = core::string::toInt(getArgVal("--size"));
 
-	voxelformat::ThumbnailContext ctx;
-	ctx.outputSize = glm::ivec2(outputSize);
+	core::Histogram &jobSeconds = core::metrics::histogram("thumbnailer_job_seconds", "The duration of the thumbnail jobs");
+	core::Counter &jobs = core::metrics::counter("thumbnailer_jobs_total", "The executed thumbnail jobs");
 	const bool renderTurntable = hasArg("--turntable");
 	if (renderTurntable) {
-		volumeTurntable(_infile->name(), _outfile, ctx, 16);
+		voxelformat::ThumbnailContext ctx;
+		ctx.outputSize = glm::ivec2(outputSize);
+		for (const Job &job : _jobs) {
+			{
+				core::MetricTimer timer(jobSeconds);
+				volumeTurntable(job.infile, job.outfile, ctx, 16, _software);
+			}
+			jobs.inc();
+			writeMetrics();
+		}
 	} else {
-		io::FileStream stream(_infile);
-		const image::ImagePtr &image = volumeThumbnail(_infile->name(), stream, ctx);
-		saveImage(image);
+		voxelrender::ThumbnailRenderer renderer;
+		for (const Job &job : _jobs) {
+			{
+				core::MetricTimer timer(jobSeconds);
+				thumbnail(renderer, job, outputSize);
+			}
+			jobs.inc();
+			writeMetrics();
+		}
+		renderer.shutdown();
 	}
 
 	requestQuit();
 	return state;
 }
 
+core::String Thumbnailer::cacheFile(const core::String &cacheDir, int outputSize) const {
+	if (cacheDir.empty() || !filesystem()->createDir(cacheDir)) {
+		Log::warn("Could not use the thumbnail cache directory '%s'", cacheDir.c_str());
+		return "";
+	}
+	io::FileStream stream(_infile);
+	// the stream shares the file handle with the stream that the thumbnail is created from
+	io::ScopedStreamPos scopedPos(stream);
+	uint64_t hash = 0u;
+	if (stream.size() <= 0 || !io::hash64(stream, hash)) {
+		return "";
+	}
+	return core::string::path(cacheDir, core::string::format("%016" PRIx64 "-%i.png", hash, outputSize));
+}
+
+bool Thumbnailer::loadFromCache() const {
+	if (_cacheFile.empty()) {
+		return false;
+	}
+	const io::FilePtr &cached = filesystem()->open(_cacheFile, io::FileMode::SysRead);
+	if (!cached->exists()) {
+		return false;
+	}
+	io::FileStream cachedStream(cached);
+	const io::FilePtr &outfile = filesystem()->open(_outfile, io::FileMode::SysWrite);
+	if (outfile->write(cachedStream) <= 0) {
+		Log::warn("Failed to copy the cached thumbnail %s", _cacheFile.c_str());
+		return false;
+	}
+	Log::info("Write cached image %s", _outfile.c_str());
+	return true;
+}
+
+bool Thumbnailer::writeImage(const core::String &filename, const image::ImagePtr &image) const {
+	const io::FilePtr& outfile = filesystem()->open(filename, io::FileMode::SysWrite);
+	io::FileStream outStream(outfile);
+	if (!image::Image::writePng(outStream, image->data(), image->width(), image->height(), image->depth())) {
+		Log::error("Failed to write image %s", filename.c_str());
+		return false;
+	}
+	Log::info("Write image %s", filename.c_str());
+	return true;
+}
+
 bool Thumbnailer::saveImage(const image::ImagePtr &image) {
 	if (image) {
-		const io::FilePtr& outfile = io::filesystem()->open(_outfile, io::FileMode::SysWrite);
-		io::FileStream outStream(outfile);
-		if (!image::Image::writePng(outStream, image->data(), image->width(), image->height(), image->depth())) {
-			Log::error("Failed to write image %s", _outfile.c_str());
-		} else {
-			Log::info("Write image %s", _outfile.c_str());
+		if (writeImage(_outfile, image) && !_cacheFile.empty()) {
+			writeImage(_cacheFile, image);
 		}
 		return true;
 	}
@@ -134,6 +262,9 @@ bool Thumbnailer::saveImage(const image::ImagePtr &image) {
 }
 
 app::AppState Thumbnailer::onCleanup() {
+	if (_software) {
+		return app::App::onCleanup();
+	}
 	return Super::onCleanup();
 }
 
@@ -4,10 +4,15 @@
 
 #pragma once
 
+#include "core/collection/DynamicArray.h"
 #include "image/Image.h"
 #include "video/WindowedApp.h"
 #include "io/File.h"
 
+namespace voxelrender {
+class ThumbnailRenderer;
+}
+
 /**
  * @brief This tool is able to generate thumbnails for all supported voxel formats
  *
@@ -17,8 +22,32 @@ class Thumbnailer: public video::WindowedApp {
 private:
 	using Super = video::WindowedApp;
 
+	struct Job {
+		core::String infile;
+		core::String outfile;
+	};
+	/**
+	 * all jobs are rendered with the same renderer - either one positional <infile> <outfile> or several --input
+	 * files that are written into the --output directory
+	 */
+	core::DynamicArray<Job> _jobs;
+
 	io::FilePtr _infile;
 	core::String _outfile;
+	/**
+	 * the thumbnail file in the cache directory - the name is the content hash of the input file and the
+	 * requested size
+	 */
+	core::String _cacheFile;
+	/**
+	 * render on the cpu - the window and the renderer context are not created then
+	 */
+	bool _software = false;
+
+	core::String cacheFile(const core::String &cacheDir, int outputSize) const;
+	bool loadFromCache() const;
+	bool writeImage(const core::String &filename, const image::ImagePtr &image) const;
+	bool thumbnail(voxelrender::ThumbnailRenderer &renderer, const Job &job, int outputSize);
 
 protected:
 	virtual bool saveImage(const image::ImagePtr &image);
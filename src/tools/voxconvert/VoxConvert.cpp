@@ -4,23 +4,32 @@
 
 #include "VoxConvert.h"
 #include "core/Color.h"
+#include "core/Common.h"
 #include "core/Enum.h"
 #include "core/GameConfig.h"
 #include "core/Log.h"
+#include "core/Metrics.h"
 #include "core/StringUtil.h"
 #include "core/Var.h"
 #include "command/Command.h"
 #include "core/collection/DynamicArray.h"
 #include "core/collection/Set.h"
+#include "core/collection/StringSet.h"
 #include "core/concurrent/Concurrency.h"
+#include "core/concurrent/ConditionVariable.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
 #include "image/Image.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
 #include "core/TimeProvider.h"
+#include "core/Tokenizer.h"
 #include "io/FormatDescription.h"
+#include "io/PrefetchReadStream.h"
 #include "voxel/MaterialColor.h"
 #include "voxel/Palette.h"
 #include "voxel/PaletteLookup.h"
+#include "voxel/OccupancyPyramid.h"
 #include "voxel/RawVolume.h"
 #include "voxel/RawVolumeWrapper.h"
 #include "voxel/Region.h"
@@ -38,9 +47,11 @@
 #include "voxelutil/VolumeRotator.h"
 #include "voxelutil/VolumeSplitter.h"
 #include "voxelutil/VolumeVisitor.h"
+#include "voxelutil/VoxelUtil.h"
 
 #include <glm/gtc/quaternion.hpp>
 #include <glm/trigonometric.hpp>
+#include <stdio.h>
 
 #define MaxHeightmapWidth 4096
 #define MaxHeightmapHeight 4096
@@ -54,9 +65,14 @@ app::AppState VoxConvert::onConstruct() {
 	const app::AppState state = Super::onConstruct();
 	registerArg("--crop").setDescription("Reduce the volumes to their real voxel sizes");
 	registerArg("--dump").setDescription("Dump the scene graph of the input file");
+	registerArg("--dump-meta").setDescription("Dump the model names, sizes and the palette of the input files without loading the voxels");
 	registerArg("--export-layers").setDescription("Export all the layers of a scene into single files");
+	registerArg("--export-layers-memory").setDefaultValue("1024").setDescription("The megabytes of layer volumes that are exported at the same time");
 	registerArg("--export-palette").setDescription("Export the used palette data into an image");
 	registerArg("--filter").setDescription("Layer filter. For example '1-4,6'");
+	registerArg("--filter-name").setDescription("Only load the layers whose names match the given wildcard pattern");
+	registerArg("--filter-region").setDescription("Only load the layers that intersect the region <x1:y1:z1:x2:y2:z2>");
+	registerArg("--hollow").setDescription("Remove the voxels that are not visible from outside and keep a shell of the given thickness");
 	registerArg("--force").setShort("-f").setDescription("Overwrite existing files");
 	registerArg("--image-as-plane").setDescription("Import given input images as planes");
 	registerArg("--image-as-volume").setDescription("Import given input image as volume");
@@ -65,14 +81,17 @@ app::AppState VoxConvert::onConstruct() {
 	registerArg("--image-as-heightmap").setDescription("Import given input images as heightmaps");
 	registerArg("--colored-heightmap").setDescription("Use the alpha channel of the heightmap as height and the rgb data as surface color");
 	registerArg("--input").setShort("-i").setDescription("Allow to specify input files");
+	registerArg("--jobs").setShort("-j").setDescription("Convert every input file into its own output file with the given amount of threads - the output file name is given like --output converted/*.vengi");
 	registerArg("--merge").setShort("-m").setDescription("Merge layers into one volume");
 	registerArg("--mirror").setDescription("Mirror by the given axis (x, y or z)");
 	registerArg("--output").setShort("-o").setDescription("Allow to specify the output file");
+	registerArg("--prefetch").setDescription("Read the input files on a background thread while they are decoded - useful for network filesystems");
 	registerArg("--rotate").setDescription("Rotate by 90 degree at the given axis (x, y or z), specify e.g. x:180 to rotate around x by 180 degree.");
 	registerArg("--resize").setDescription("Resize the volume by the given x (right), y (up) and z (back) values");
 	registerArg("--scale").setShort("-s").setDescription("Scale layer to 50% of its original size");
 	registerArg("--script").setDefaultValue("script.lua").setDescription("Apply the given lua script to the output volume");
 	registerArg("--scriptcolor").setDefaultValue("1").setDescription("Set the palette index that is given to the script parameters");
+	registerArg("--serve").setDescription("Keep running and read the conversion jobs line by line from stdin - every line holds the same arguments as the command line");
 	registerArg("--split").setDescription("Slices the volumes into pieces of the given size <x:y:z>");
 	registerArg("--translate").setShort("-t").setDescription("Translate the volumes by x (right), y (up), z (back)");
 
@@ -146,6 +165,79 @@ app::AppState VoxConvert::onInit() {
 		return app::AppState::InitFailure;
 	}
 
+	if (hasArg("--serve")) {
+		return serve();
+	}
+	return convert();
+}
+
+app::AppState VoxConvert::onCleanup() {
+	if (_luaGeneratorInitialized) {
+		_luaGenerator.shutdown();
+		_luaGeneratorInitialized = false;
+	}
+	return Super::onCleanup();
+}
+
+app::AppState VoxConvert::serve() {
+	Log::info("Waiting for conversion jobs on stdin - one command line per line, 'quit' to stop");
+	const int argc = _argc;
+	char **argv = _argv;
+	int jobId = 0;
+	char line[4096];
+	while (fgets(line, sizeof(line), stdin) != nullptr) {
+		const core::String &cmdline = core::string::trim(line);
+		if (cmdline.empty()) {
+			continue;
+		}
+		if (cmdline == "quit") {
+			break;
+		}
+		core::TokenizerConfig cfg;
+		// don't treat the wildcards in e.g. out/*.vengi as comment
+		cfg.skipComments = false;
+		core::Tokenizer tok(cfg, cmdline, " ");
+		core::DynamicArray<char *> jobArgv;
+		jobArgv.reserve(tok.size() + 1);
+		jobArgv.push_back(argv[0]);
+		for (const core::String &token : tok.tokens()) {
+			jobArgv.push_back((char *)token.c_str());
+		}
+		_argc = (int)jobArgv.size();
+		_argv = jobArgv.data();
+		const uint64_t start = core::TimeProvider::systemMillis();
+		const bool success = convert() == app::AppState::Running;
+		const uint64_t millis = core::TimeProvider::systemMillis() - start;
+		_argc = argc;
+		_argv = argv;
+
+		core::String escaped;
+		escaped.reserve(cmdline.size());
+		for (size_t i = 0; i < cmdline.size(); ++i) {
+			const char c = cmdline[i];
+			if (c == '"' || c == '\\') {
+				escaped += '\\';
+			}
+			escaped += c;
+		}
+		fprintf(stdout, "{\"job\":%i,\"status\":\"%s\",\"millis\":%i,\"command\":\"%s\"}\n", ++jobId,
+				success ? "ok" : "error", (int)millis, escaped.c_str());
+		fflush(stdout);
+
+		core::metrics::counter(success ? "voxconvert_jobs_total{status=\"ok\"}" : "voxconvert_jobs_total{status=\"error\"}",
+							   "The conversion jobs of the serve mode")
+			.inc();
+		static core::Histogram &jobSeconds =
+			core::metrics::histogram("voxconvert_job_seconds", "The duration of the conversion jobs of the serve mode");
+		jobSeconds.observe((double)millis / 1000.0);
+		// the main loop doesn't run while we are waiting for the next job
+		writeMetrics();
+	}
+	return app::AppState::Running;
+}
+
+app::AppState VoxConvert::convert() {
+	const app::AppState state = app::AppState::Running;
 	const bool hasScript = hasArg("--script");
 
 	core::String infilesstr;
@@ -186,6 +278,7 @@ app::AppState VoxConvert::onInit() {
 	_exportPalette    = hasArg("--export-palette");
 	_exportLayers     = hasArg("--export-layers");
 	_cropVolumes      = hasArg("--crop");
+	_hollowVolumes    = hasArg("--hollow");
 	_splitVolumes     = hasArg("--split");
 	_dumpSceneGraph   = hasArg("--dump");
 	_resizeVolumes    = hasArg("--resize");
@@ -226,6 +319,10 @@ app::AppState VoxConvert::onInit() {
 		return app::AppState::InitFailure;
 	}
 
+	if (hasArg("--dump-meta")) {
+		return dumpMetadata(infiles);
+	}
+
 	core::String scriptParameters;
 	if (hasScript) {
 		scriptParameters = getArgVal("--script");
@@ -238,6 +335,7 @@ app::AppState VoxConvert::onInit() {
 	Log::info("* merge volumes:     - %s", (_mergeVolumes     ? "true" : "false"));
 	Log::info("* scale volumes:     - %s", (_scaleVolumes     ? "true" : "false"));
 	Log::info("* crop volumes:      - %s", (_cropVolumes      ? "true" : "false"));
+	Log::info("* hollow volumes:    - %s", (_hollowVolumes    ? "true" : "false"));
 	Log::info("* split volumes:     - %s", (_splitVolumes     ? "true" : "false"));
 	Log::info("* mirror volumes:    - %s", (_mirrorVolumes    ? "true" : "false"));
 	Log::info("* translate volumes: - %s", (_translateVolumes ? "true" : "false"));
@@ -246,6 +344,14 @@ app::AppState VoxConvert::onInit() {
 	Log::info("* export layers:     - %s", (_exportLayers     ? "true" : "false"));
 	Log::info("* resize volumes:    - %s", (_resizeVolumes    ? "true" : "false"));
 
+	if (hasArg("--jobs")) {
+		if (hasScript || _exportLayers || _exportPalette || _dumpSceneGraph) {
+			Log::error("Scripts, dumps and the layer or palette export are not supported with --jobs");
+			return app::AppState::InitFailure;
+		}
+		return convertBatch(infiles, outfile, core_max(1, getArgVal("--jobs").toInt()));
+	}
+
 	voxel::Palette palette = voxel::getPalette();
 
 	io::FilePtr outputFile;
@@ -307,13 +413,9 @@ app::AppState VoxConvert::onInit() {
 		return app::AppState::InitFailure;
 	}
 
-	const bool applyFilter = hasArg("--filter");
-	if (applyFilter) {
-		if (infiles.size() == 1u) {
-			filterVolumes(sceneGraph);
-		} else {
-			Log::warn("Don't apply layer filters for multiple input files");
-		}
+	const bool applyFilter = hasArg("--filter") || hasArg("--filter-name") || hasArg("--filter-region");
+	if (applyFilter && infiles.size() > 1u) {
+		Log::warn("Don't apply layer filters for multiple input files");
 	}
 
 	if (_exportLayers) {
@@ -323,18 +425,35 @@ app::AppState VoxConvert::onInit() {
 		exportLayersIntoSingleObjects(sceneGraph, infiles[0]);
 	}
 
+	if (!applyOperations(sceneGraph, infilesstr, scriptParameters)) {
+		return app::AppState::InitFailure;
+	}
+
+	if (outputFile) {
+		Log::debug("Save %i volumes", (int)sceneGraph.size());
+		voxelformat::SaveContext saveCtx;
+		if (!voxelformat::saveFormat(outputFile, nullptr, sceneGraph, saveCtx)) {
+			Log::error("Failed to write to output file '%s'", outfile.c_str());
+			return app::AppState::InitFailure;
+		}
+		Log::info("Wrote output file %s", outputFile->name().c_str());
+	}
+	return state;
+}
+
+bool VoxConvert::applyOperations(scenegraph::SceneGraph &sceneGraph, const core::String &name, const core::String &scriptParameters) {
 	if (_mergeVolumes) {
 		Log::info("Merge layers");
 		const scenegraph::SceneGraph::MergedVolumePalette &merged = sceneGraph.merge();
 		if (merged.first == nullptr) {
 			Log::error("Failed to merge volumes");
-			return app::AppState::InitFailure;
+			return false;
 		}
 		sceneGraph.clear();
 		scenegraph::SceneGraphNode node;
 		node.setPalette(merged.second);
 		node.setVolume(merged.first, true);
-		node.setName(infilesstr);
+		node.setName(name);
 		sceneGraph.emplace(core::move(node));
 	}
 
@@ -363,6 +482,10 @@ app::AppState VoxConvert::onInit() {
 		script(scriptParameters, sceneGraph, color.toInt());
 	}
 
+	if (_hollowVolumes) {
+		hollow(getArgVal("--hollow").toInt(), sceneGraph);
+	}
+
 	if (_cropVolumes) {
 		crop(sceneGraph);
 	}
@@ -370,17 +493,137 @@ app::AppState VoxConvert::onInit() {
 	if (_splitVolumes) {
 		split(getArgIvec3("--split"), sceneGraph);
 	}
+	return true;
+}
 
-	if (outputFile) {
-		Log::debug("Save %i volumes", (int)sceneGraph.size());
-		voxelformat::SaveContext saveCtx;
-		if (!voxelformat::saveFormat(outputFile, nullptr, sceneGraph, saveCtx)) {
-			Log::error("Failed to write to output file '%s'", outfile.c_str());
-			return app::AppState::InitFailure;
+void VoxConvert::collectInputFiles(const core::DynamicArray<core::String> &inputs, core::DynamicArray<core::String> &infiles) {
+	for (const core::String &input : inputs) {
+		core::String dir;
+		core::String filter;
+		if (filesystem()->isReadableDir(input)) {
+			dir = input;
+		} else if (input.contains("*") || input.contains("?")) {
+			dir = core::string::extractPath(input);
+			filter = core::string::extractFilenameWithExtension(input);
+		} else {
+			infiles.push_back(input);
+			continue;
+		}
+		if (dir.empty()) {
+			dir = ".";
+		}
+		core::DynamicArray<io::FilesystemEntry> entities;
+		filesystem()->list(filesystem()->absolutePath(dir), entities, filter);
+		Log::info("Found %i entries in %s", (int)entities.size(), input.c_str());
+		for (const io::FilesystemEntry &entry : entities) {
+			if (entry.type == io::FilesystemEntry::Type::file) {
+				infiles.push_back(core::string::path(dir, entry.name));
+			}
 		}
-		Log::info("Wrote output file %s", outputFile->name().c_str());
 	}
-	return state;
+}
+
+bool VoxConvert::convertFile(const core::String &infile, const core::String &outfile) {
+	scenegraph::SceneGraph sceneGraph;
+	if (!handleInputFile(infile, sceneGraph, false)) {
+		return false;
+	}
+	if (sceneGraph.empty()) {
+		Log::error("No valid input found in %s", infile.c_str());
+		return false;
+	}
+	if (!applyOperations(sceneGraph, core::string::extractFilename(infile), "")) {
+		return false;
+	}
+	const io::FilePtr &outputFile = filesystem()->open(outfile, io::FileMode::SysWrite);
+	if (!outputFile->validHandle()) {
+		Log::error("Could not open target file: %s", outfile.c_str());
+		return false;
+	}
+	voxelformat::SaveContext saveCtx;
+	if (!voxelformat::saveFormat(outputFile, nullptr, sceneGraph, saveCtx)) {
+		Log::error("Failed to write to output file '%s'", outfile.c_str());
+		return false;
+	}
+	return true;
+}
+
+app::AppState VoxConvert::convertBatch(const core::DynamicArray<core::String> &inputs, const core::String &outfile, int jobs) {
+	core::DynamicArray<core::String> infiles;
+	collectInputFiles(inputs, infiles);
+	if (infiles.empty()) {
+		Log::error("No input files found");
+		return app::AppState::InitFailure;
+	}
+	const core::String &outputDir = core::string::extractPath(outfile);
+	const core::String &outputExt = core::string::extractExtension(outfile);
+	if (outputExt.empty()) {
+		Log::error("The output file needs an extension to specify the target format - e.g. converted/*.vengi");
+		return app::AppState::InitFailure;
+	}
+	if (!outputDir.empty() && !filesystem()->createDir(outputDir)) {
+		Log::error("Failed to create the output directory %s", outputDir.c_str());
+		return app::AppState::InitFailure;
+	}
+
+	struct BatchEntry {
+		core::String infile;
+		core::String outfile;
+		uint64_t millis = 0u;
+		bool success = false;
+	};
+	core::DynamicArray<BatchEntry> entries;
+	entries.resize(infiles.size());
+	core::StringSet outfiles(infiles.size() + 1);
+	const bool force = hasArg("--force");
+	core::DynamicArray<int> todo;
+	todo.reserve(infiles.size());
+	for (size_t i = 0; i < infiles.size(); ++i) {
+		BatchEntry &entry = entries[i];
+		entry.infile = infiles[i];
+		const core::String &dir = outputDir.empty() ? core::string::extractPath(entry.infile) : outputDir;
+		entry.outfile = core::string::path(dir, core::string::extractFilename(entry.infile) + "." + outputExt);
+		if (!outfiles.insert(entry.outfile)) {
+			Log::error("Skip %s - another input is already written to %s", entry.infile.c_str(), entry.outfile.c_str());
+			continue;
+		}
+		if (!force && filesystem()->exists(entry.outfile)) {
+			Log::error("Skip %s - the output file %s already exists", entry.infile.c_str(), entry.outfile.c_str());
+			continue;
+		}
+		todo.push_back((int)i);
+	}
+
+	Log::info("Convert %i files with %i jobs", (int)todo.size(), jobs);
+	const uint64_t start = core::TimeProvider::systemMillis();
+	core::ThreadPool threadPool(jobs, "VoxConvert");
+	threadPool.init();
+	threadPool.parallelFor(0, (int)todo.size(), 1, [&](int rangeStart, int rangeEnd) {
+		for (int i = rangeStart; i < rangeEnd; ++i) {
+			BatchEntry &entry = entries[todo[i]];
+			const uint64_t fileStart = core::TimeProvider::systemMillis();
+			entry.success = convertFile(entry.infile, entry.outfile);
+			entry.millis = core::TimeProvider::systemMillis() - fileStart;
+		}
+	});
+	threadPool.shutdown();
+	const uint64_t duration = core::TimeProvider::systemMillis() - start;
+
+	int failed = 0;
+	Log::info("Summary");
+	for (const BatchEntry &entry : entries) {
+		if (entry.success) {
+			Log::info("* %s => %s (%i ms)", entry.infile.c_str(), entry.outfile.c_str(), (int)entry.millis);
+		} else {
+			Log::error("* %s failed", entry.infile.c_str());
+			++failed;
+		}
+	}
+	Log::info("Converted %i of %i files in %i ms", (int)entries.size() - failed, (int)entries.size(), (int)duration);
+	if (failed > 0) {
+		return app::AppState::InitFailure;
+	}
+	return app::AppState::Running;
 }
 
 core::String VoxConvert::getFilenameForLayerName(const core::String &inputfile, const core::String &layerName, int id) {
@@ -472,9 +715,23 @@ bool VoxConvert::handleInputFile(const core::String &infile, scenegraph::SceneGr
 		scenegraph::SceneGraph newSceneGraph;
 		voxelformat::LoadContext loadCtx;
 		loadCtx.monitor = printProgress;
-		if (!voxelformat::loadFormat(inputFile->name(), inputFileStream, newSceneGraph, loadCtx)) {
+		// the formats with per-node records skip the voxels of the filtered layers while loading
+		voxelformat::ModelFilter modelFilter;
+		if (!multipleInputs && parseModelFilter(modelFilter)) {
+			loadCtx.modelFilter = &modelFilter;
+		}
+		if (hasArg("--prefetch")) {
+			// the memory mapped pages are touched by the prefetch thread - at the cost of copying them
+			io::PrefetchReadStream prefetchStream(inputFileStream);
+			if (!voxelformat::loadFormat(inputFile->name(), prefetchStream, newSceneGraph, loadCtx)) {
+				return false;
+			}
+		} else if (!voxelformat::loadFormat(inputFile->name(), inputFileStream, newSceneGraph, loadCtx)) {
 			return false;
 		}
+		if (loadCtx.modelFilter != nullptr && !modelFilter.applied) {
+			filterVolumes(newSceneGraph, modelFilter);
+		}
 
 		int parent = sceneGraph.root().id();
 		if (multipleInputs) {
@@ -498,20 +755,66 @@ bool VoxConvert::handleInputFile(const core::String &infile, scenegraph::SceneGr
 
 void VoxConvert::exportLayersIntoSingleObjects(scenegraph::SceneGraph& sceneGraph, const core::String &inputfile) {
 	Log::info("Export layers into single objects");
+	struct LayerExport {
+		const scenegraph::SceneGraphNode *node;
+		core::String filename;
+		// the estimated memory the savers need for the layer
+		size_t cost;
+	};
+	core::DynamicArray<LayerExport> layers;
+	layers.reserve(sceneGraph.size());
+	core::StringSet filenames(sceneGraph.size() + 1);
 	int n = 0;
-	voxelformat::SaveContext saveCtx;
-	for (scenegraph::SceneGraphNode& node : sceneGraph) {
-		scenegraph::SceneGraph newSceneGraph;
-		scenegraph::SceneGraphNode newNode;
-		scenegraph::copyNode(node, newNode, false);
-		newSceneGraph.emplace(core::move(newNode));
-		const core::String& filename = getFilenameForLayerName(inputfile, node.name(), n);
-		if (voxelformat::saveFormat(filesystem()->open(filename, io::FileMode::SysWrite), nullptr, newSceneGraph, saveCtx)) {
-			Log::info(" .. %s", filename.c_str());
-		} else {
-			Log::error(" .. %s", filename.c_str());
+	for (const scenegraph::SceneGraphNode& node : sceneGraph) {
+		core::String filename = getFilenameForLayerName(inputfile, node.name(), n);
+		if (!filenames.insert(filename)) {
+			// the layers are written concurrently - two layers with the same name must not share the file
+			filename = getFilenameForLayerName(inputfile, core::string::format("%s-%i", node.name().c_str(), n), n);
+			filenames.insert(filename);
 		}
+		const size_t cost = (size_t)node.region().voxels() * sizeof(voxel::Voxel);
+		layers.push_back(LayerExport{&node, filename, cost});
+		++n;
 	}
+
+	// the layers share the volumes of the source scene graph - the budget only limits the memory of the savers
+	const size_t budget = (size_t)core_max(1, getArgVal("--export-layers-memory").toInt()) * 1024u * 1024u;
+	core::ThreadPool threadPool(core::cpus(), "ExportLayers");
+	threadPool.init();
+	core::Lock lock;
+	core::ConditionVariable condition;
+	size_t inFlight = 0u;
+	core::DynamicArray<std::future<void>> futures;
+	futures.reserve(layers.size());
+	for (const LayerExport &layer : layers) {
+		{
+			core::ScopedLock scopedLock(lock);
+			// a layer that exceeds the budget on its own is exported alone
+			condition.wait(lock, [&] { return inFlight == 0u || inFlight + layer.cost <= budget; });
+			inFlight += layer.cost;
+		}
+		futures.emplace_back(threadPool.enqueue([this, &layer, &lock, &condition, &inFlight]() {
+			scenegraph::SceneGraph newSceneGraph;
+			scenegraph::SceneGraphNode newNode;
+			scenegraph::copyNode(*layer.node, newNode, false);
+			newSceneGraph.emplace(core::move(newNode));
+			voxelformat::SaveContext saveCtx;
+			if (voxelformat::saveFormat(filesystem()->open(layer.filename, io::FileMode::SysWrite), nullptr, newSceneGraph, saveCtx)) {
+				Log::info(" .. %s", layer.filename.c_str());
+			} else {
+				Log::error(" .. %s", layer.filename.c_str());
+			}
+			{
+				core::ScopedLock scopedLock(lock);
+				inFlight -= layer.cost;
+			}
+			condition.notify_all();
+		}));
+	}
+	for (std::future<void> &future : futures) {
+		future.wait();
+	}
+	threadPool.shutdown();
 }
 
 glm::ivec3 VoxConvert::getArgIvec3(const core::String &name) {
@@ -525,9 +828,18 @@ void VoxConvert::split(const glm::ivec3 &size, scenegraph::SceneGraph& sceneGrap
 	Log::info("split volumes at %i:%i:%i", size.x, size.y, size.z);
 	const scenegraph::SceneGraph::MergedVolumePalette &merged = sceneGraph.merge();
 	sceneGraph.clear();
+	if (merged.first == nullptr) {
+		return;
+	}
 	core::DynamicArray<voxel::RawVolume *> rawVolumes;
-	voxelutil::splitVolume(merged.first, size, rawVolumes);
-	delete merged.first;
+	if (glm::all(glm::lessThanEqual(merged.first->region().getDimensionsInVoxels(), size))) {
+		// nothing to split - hand the merged volume over to the node
+		rawVolumes.push_back(merged.first);
+	} else {
+		voxelutil::splitVolume(merged.first, size, rawVolumes);
+		delete merged.first;
+	}
+	sceneGraph.reserve(rawVolumes.size());
 	for (voxel::RawVolume *v : rawVolumes) {
 		scenegraph::SceneGraphNode node;
 		node.setVolume(v, true);
@@ -550,7 +862,9 @@ int VoxConvert::dumpNode_r(const scenegraph::SceneGraph& sceneGraph, int nodeId,
 	if (type == scenegraph::SceneGraphNodeType::Model) {
 		voxel::RawVolume *v = node.volume();
 		Log::info("%*s  |- volume: %s", indent, " ", v != nullptr ? v->region().toString().c_str() : "no volume");
-		if (v) {
+		if (v && v->occupancy()) {
+			voxels = (int)v->occupancy()->voxels();
+		} else if (v) {
 			voxelutil::visitVolume(*v, [&](int, int, int, const voxel::Voxel &) { ++voxels; });
 		}
 		Log::info("%*s  |- voxels: %i", indent, " ", voxels);
@@ -599,6 +913,37 @@ void VoxConvert::dump(const scenegraph::SceneGraph& sceneGraph) {
 	Log::info("Voxel count: %i", voxels);
 }
 
+app::AppState VoxConvert::dumpMetadata(const core::DynamicArray<core::String> &inputs) {
+	core::DynamicArray<core::String> infiles;
+	collectInputFiles(inputs, infiles);
+	int failed = 0;
+	for (const core::String &infile : infiles) {
+		const io::FilePtr &inputFile = filesystem()->open(infile, io::FileMode::SysRead);
+		if (!inputFile->exists()) {
+			Log::error("Given input file '%s' does not exist", infile.c_str());
+			++failed;
+			continue;
+		}
+		io::FileStream inputFileStream(inputFile);
+		voxelformat::FormatMetadata metadata;
+		voxelformat::LoadContext loadCtx;
+		if (!voxelformat::loadMetadata(inputFile->name(), inputFileStream, metadata, loadCtx)) {
+			Log::error("Failed to load the metadata of %s", infile.c_str());
+			++failed;
+			continue;
+		}
+		Log::info("%s: %i models, %i colors", infile.c_str(), (int)metadata.models.size(), metadata.palette.colorCount());
+		for (const voxelformat::ModelMetadata &model : metadata.models) {
+			const glm::ivec3 &dim = model.region.getDimensionsInVoxels();
+			Log::info("  |- %s: %i:%i:%i", model.name.c_str(), dim.x, dim.y, dim.z);
+		}
+	}
+	if (failed > 0) {
+		return app::AppState::InitFailure;
+	}
+	return app::AppState::Running;
+}
+
 void VoxConvert::crop(scenegraph::SceneGraph& sceneGraph) {
 	Log::info("Crop volumes");
 	for (scenegraph::SceneGraphNode& node : sceneGraph) {
@@ -606,11 +951,21 @@ void VoxConvert::crop(scenegraph::SceneGraph& sceneGraph) {
 	}
 }
 
+void VoxConvert::hollow(int shellThickness, scenegraph::SceneGraph& sceneGraph) {
+	Log::info("Hollow volumes with a shell thickness of %i", shellThickness);
+	for (scenegraph::SceneGraphNode& node : sceneGraph) {
+		voxel::RawVolumeWrapper wrapper(node.volume());
+		const int removed = voxelutil::hollow(threadPool(), wrapper, shellThickness);
+		Log::info("Removed %i voxels from %s", removed, node.name().c_str());
+	}
+}
+
 void VoxConvert::script(const core::String &scriptParameters, scenegraph::SceneGraph& sceneGraph, uint8_t color) {
-	voxelgenerator::LUAGenerator script;
-	if (!script.init()) {
+	voxelgenerator::LUAGenerator &script = _luaGenerator;
+	if (!_luaGeneratorInitialized && !script.init()) {
 		Log::warn("Failed to initialize the script bindings");
 	} else {
+		_luaGeneratorInitialized = true;
 		core::DynamicArray<core::String> tokens;
 		core::string::splitString(scriptParameters, tokens);
 		const core::String &luaScript = script.load(tokens[0]);
@@ -633,8 +988,6 @@ void VoxConvert::script(const core::String &scriptParameters, scenegraph::SceneG
 			}
 		}
 	}
-
-	script.shutdown();
 }
 
 void VoxConvert::scale(scenegraph::SceneGraph& sceneGraph) {
@@ -658,37 +1011,53 @@ void VoxConvert::resize(const glm::ivec3 &size, scenegraph::SceneGraph& sceneGra
 	}
 }
 
-void VoxConvert::filterVolumes(scenegraph::SceneGraph& sceneGraph) {
-	const core::String &filter = getArgVal("--filter");
-	if (filter.empty()) {
-		Log::warn("No filter specified");
-		return;
+bool VoxConvert::parseModelFilter(voxelformat::ModelFilter &filter) {
+	bool hasFilter = false;
+	if (hasArg("--filter")) {
+		const core::String &indices = getArgVal("--filter");
+		if (indices.empty() || !filter.parseIndices(indices)) {
+			Log::warn("Invalid layer filter '%s'", indices.c_str());
+		} else {
+			hasFilter = true;
+		}
 	}
-
-	core::Set<int> layers;
-	core::DynamicArray<core::String> tokens;
-	core::string::splitString(filter, tokens, ",");
-	for (const core::String& token : tokens) {
-		if (token.contains("-")) {
-			const int start = token.toInt();
-			const size_t index = token.find("-");
-			const core::String &endString = token.substr(index + 1);
-			const int end = endString.toInt();
-			for (int layer = start; layer <= end; ++layer) {
-				layers.insert(layer);
-			}
+	if (hasArg("--filter-name")) {
+		filter.name = getArgVal("--filter-name");
+		hasFilter |= !filter.name.empty();
+	}
+	if (hasArg("--filter-region")) {
+		const core::String &regionStr = getArgVal("--filter-region");
+		glm::ivec3 mins;
+		glm::ivec3 maxs;
+		if (SDL_sscanf(regionStr.c_str(), "%i:%i:%i:%i:%i:%i", &mins.x, &mins.y, &mins.z, &maxs.x, &maxs.y, &maxs.z) != 6) {
+			Log::warn("Invalid region filter '%s'", regionStr.c_str());
 		} else {
-			const int layer = token.toInt();
-			layers.insert(layer);
+			filter.region = voxel::Region(mins, maxs);
+			hasFilter |= filter.region.isValid();
 		}
 	}
-	for (int i = 0; i < (int)sceneGraph.size(); ++i) {
-		if (!layers.has(i)) {
-			sceneGraph[i]->release();
-			Log::debug("Remove layer %i - not part of the filter expression", i);
+	if (!hasFilter) {
+		return false;
+	}
+	Log::info("Filter layers: %i indices, name '%s', region %s", (int)filter.indices.size(), filter.name.c_str(),
+			  filter.region.isValid() ? filter.region.toString().c_str() : "none");
+	return true;
+}
+
+void VoxConvert::filterVolumes(scenegraph::SceneGraph& sceneGraph, const voxelformat::ModelFilter &filter) {
+	core::DynamicArray<int> remove;
+	int modelIndex = 0;
+	for (scenegraph::SceneGraphNode &node : sceneGraph) {
+		if (!filter.accept(modelIndex, node.name(), node.region())) {
+			Log::debug("Remove layer %i - not part of the filter expression", modelIndex);
+			remove.push_back(node.id());
 		}
+		++modelIndex;
+	}
+	for (int nodeId : remove) {
+		sceneGraph.removeNode(nodeId, false);
 	}
-	Log::info("Filtered layers: %i", (int)layers.size());
+	Log::info("Filtered layers: %i", (int)sceneGraph.size());
 }
 
 void VoxConvert::mirror(const core::String& axisStr, scenegraph::SceneGraph& sceneGraph) {
@@ -728,6 +1097,7 @@ void VoxConvert::translate(const glm::ivec3& pos, scenegraph::SceneGraph& sceneG
 	for (scenegraph::SceneGraphNode &node : sceneGraph) {
 		if (voxel::RawVolume *v = node.volume()) {
 			v->translate(pos);
+			node.markDirty();
 		}
 	}
 }
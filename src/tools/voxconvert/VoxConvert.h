@@ -6,6 +6,8 @@
 
 #include "app/CommandlineApp.h"
 #include "scenegraph/SceneGraph.h"
+#include "voxelformat/Format.h"
+#include "voxelgenerator/LUAGenerator.h"
 
 /**
  * @brief This tool is able to convert voxel volumes between different formats
@@ -34,14 +36,45 @@ private:
 	bool _exportPalette = false;
 	bool _exportLayers = false;
 	bool _cropVolumes = false;
+	bool _hollowVolumes = false;
 	bool _splitVolumes = false;
 	bool _dumpSceneGraph = false;
 	bool _resizeVolumes = false;
+	/**
+	 * @brief Kept for all the conversions of a @c --serve session - the compiled scripts are reused
+	 */
+	voxelgenerator::LUAGenerator _luaGenerator;
+	bool _luaGeneratorInitialized = false;
 
 protected:
 	glm::ivec3 getArgIvec3(const core::String &name);
 	core::String getFilenameForLayerName(const core::String& inputfile, const core::String &layerName, int id);
 	bool handleInputFile(const core::String &infile, scenegraph::SceneGraph &sceneGraph, bool multipleInputs);
+	/**
+	 * @brief Applies the scene graph operations that were given on the command line
+	 * @param name The name of the node if the volumes are merged
+	 */
+	bool applyOperations(scenegraph::SceneGraph &sceneGraph, const core::String &name, const core::String &scriptParameters);
+
+	/**
+	 * @brief Resolves directories and wildcards in the file names of the given inputs
+	 */
+	void collectInputFiles(const core::DynamicArray<core::String> &inputs, core::DynamicArray<core::String> &infiles);
+	/**
+	 * @brief Converts every input into its own output file on a pool of @c jobs worker threads. The output files are
+	 * put into the directory of @c outfile and get its extension - the file name of @c outfile is ignored.
+	 */
+	app::AppState convertBatch(const core::DynamicArray<core::String> &inputs, const core::String &outfile, int jobs);
+	bool convertFile(const core::String &infile, const core::String &outfile);
+	/**
+	 * @brief Runs the conversion with the current command line arguments
+	 */
+	app::AppState convert();
+	/**
+	 * @brief Keeps the app alive and executes one conversion per line that is read from @c stdin. The result of each
+	 * job is written as json line to @c stdout.
+	 */
+	app::AppState serve();
 
 	void usage() const override;
 	void mirror(const core::String& axisStr, scenegraph::SceneGraph& sceneGraph);
@@ -51,9 +84,23 @@ protected:
 	void script(const core::String &scriptParameters, scenegraph::SceneGraph& sceneGraph, uint8_t color);
 	void translate(const glm::ivec3& pos, scenegraph::SceneGraph& sceneGraph);
 	void crop(scenegraph::SceneGraph& sceneGraph);
+	void hollow(int shellThickness, scenegraph::SceneGraph& sceneGraph);
 	int dumpNode_r(const scenegraph::SceneGraph& sceneGraph, int nodeId, int indent);
 	void dump(const scenegraph::SceneGraph& sceneGraph);
-	void filterVolumes(scenegraph::SceneGraph& sceneGraph);
+	/**
+	 * @brief Prints the model names, sizes and the palette of each input file without loading the voxels
+	 */
+	app::AppState dumpMetadata(const core::DynamicArray<core::String> &inputs);
+	/**
+	 * @brief Fills the model filter from the @c --filter, @c --filter-name and @c --filter-region arguments
+	 * @return @c false if no filter is given
+	 */
+	bool parseModelFilter(voxelformat::ModelFilter &filter);
+	/**
+	 * @brief Removes the model nodes that are rejected by the filter - for the formats that don't apply the filter
+	 * while loading
+	 */
+	void filterVolumes(scenegraph::SceneGraph& sceneGraph, const voxelformat::ModelFilter &filter);
 	void exportLayersIntoSingleObjects(scenegraph::SceneGraph& sceneGraph, const core::String &inputfile);
 	void split(const glm::ivec3 &size, scenegraph::SceneGraph& sceneGraph);
 public:
@@ -61,4 +108,5 @@ public:
 
 	app::AppState onConstruct() override;
 	app::AppState onInit() override;
+	app::AppState onCleanup() override;
 };
@@ -28,6 +28,8 @@
 #include "voxelformat/FormatConfig.h"
 #include "voxelformat/VolumeFormat.h"
 #include "core/StandardLib.h"
+#include <SDL_hints.h>
+#include <SDL_stdinc.h>
 
 VoxEdit::VoxEdit(const io::FilesystemPtr& filesystem, const core::TimeProviderPtr& timeProvider) :
 		Super(filesystem, timeProvider, core::halfcpus()) {
@@ -36,6 +38,7 @@ VoxEdit::VoxEdit(const io::FilesystemPtr& filesystem, const core::TimeProviderPt
 	core::registerBindingContext("model", core::BindingContext::Context2);
 	core::registerBindingContext("editing", core::BindingContext::Context1 + core::BindingContext::Context2);
 	_allowRelativeMouseMode = false;
+	_eventDrivenRendering = true;
 	_iniVersion = 1;
 	_keybindingsVersion = 1;
 
@@ -96,6 +99,9 @@ app::AppState VoxEdit::onConstruct() {
 	const app::AppState state = Super::onConstruct();
 	_framesPerSecondsCap->setVal(60.0f);
 
+	registerArg("--replay").setDescription("Execute the actions of the given recording on the loaded scene, log the time they took and quit");
+	registerArg("--headless").setDescription("Use the offscreen video driver - this allows to replay without a display server");
+
 	core::Var::get(cfg::VoxEditColorWheel, "false", "Use the color wheel in the palette color editing", core::Var::boolValidator);
 	core::Var::get(cfg::VoxEditShowColorPicker, "false", "Always show the color picker below the palette", core::Var::boolValidator);
 	core::Var::get(cfg::VoxEditModificationDismissMillis, "1500", "Milliseconds that a region should get highlighted in a few situations");
@@ -122,6 +128,8 @@ app::AppState VoxEdit::onConstruct() {
 	core::Var::get(cfg::VoxEditLastPalette, voxel::Palette::builtIn[0]);
 	core::Var::get(cfg::VoxEditViewports, "2", "The amount of viewports (not in simple ui mode)", core::Var::minMaxValidator<2, cfg::MaxViewports>);
 	core::Var::get(cfg::VoxEditSimplifiedView, "false", "Hide some panels to simplify the ui - restart on change", core::Var::boolValidator);
+	core::Var::get(cfg::VoxEditRenderStats, "false", "Show the gpu times and render statistics overlay", core::Var::boolValidator);
+	core::Var::get(cfg::VoxEditViewportInactiveFps, "15", "The frame rate of the viewports that are neither hovered nor focused - 0 renders them every frame", core::Var::minMaxValidator<0, 240>);
 
 	voxelformat::FormatConfig::init();
 
@@ -417,6 +425,13 @@ void VoxEdit::loadKeymap(int keymap) {
 }
 
 app::AppState VoxEdit::onInit() {
+	if (hasArg("--headless")) {
+#ifdef SDL_HINT_VIDEODRIVER
+		SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+#else
+		SDL_setenv("SDL_VIDEODRIVER", "offscreen", 1);
+#endif
+	}
 	const app::AppState state = Super::onInit();
 	if (state != app::AppState::Running) {
 		return state;
@@ -455,10 +470,11 @@ app::AppState VoxEdit::onInit() {
 
 	core::setBindingContext(core::BindingContext::UI);
 
+	_replayFile = getArgVal("--replay");
 	if (_argc >= 2) {
 		const char *file = _argv[_argc - 1];
 		const io::FilePtr& filePtr = filesystem()->open(file);
-		if (filePtr->exists()) {
+		if (filePtr->exists() && _replayFile != file) {
 			const core::String &filePath = filesystem()->absolutePath(filePtr->name());
 			_mainWindow->load(filePath, nullptr);
 		}
@@ -468,6 +484,10 @@ app::AppState VoxEdit::onInit() {
 }
 
 bool VoxEdit::allowedToQuit() {
+	if (!_replayFile.empty()) {
+		// the replayed actions are not saved
+		return true;
+	}
 	voxedit::QuitDisallowReason reason = _mainWindow->allowToQuit();
 	if (reason == voxedit::QuitDisallowReason::UnsavedChanges) {
 		_showFileDialog = false;
@@ -489,6 +509,17 @@ app::AppState VoxEdit::onRunning() {
 		return state;
 	}
 
+	if (!_replayFile.empty() && !voxedit::sceneMgr().isLoading()) {
+		voxedit::sceneMgr().replayActions(_replayFile);
+		requestQuit();
+		return state;
+	}
+
+	const voxedit::SceneManager &sceneMgr = voxedit::sceneMgr();
+	if (sceneMgr.animateActive() || sceneMgr.sceneRenderer().hasPendingWork()) {
+		requestRedraw();
+	}
+
 	const voxedit::Viewport *scene = _mainWindow->hoveredScene();
 	if (scene) {
 		if (scene->isSceneMode()) {
@@ -25,6 +25,10 @@ private:
 	using Super = ui::IMGUIApp;
 	voxedit::MainWindow* _mainWindow = nullptr;
 	core::DynamicArray<io::FormatDescription> _paletteFormats;
+	/**
+	 * @brief The action recording that is replayed once the scene is loaded - voxedit quits afterwards
+	 */
+	core::String _replayFile;
 
 	core::String getSuggestedFilename(const char *extension = nullptr) const;
 
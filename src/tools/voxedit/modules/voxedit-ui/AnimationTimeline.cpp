@@ -59,14 +59,19 @@ void AnimationTimeline::sequencer(scenegraph::FrameIndex &currentFrame) {
 		core::Buffer<scenegraph::FrameIndex> selectedFrames;
 		const scenegraph::SceneGraph &sceneGraph = sceneMgr().sceneGraph();
 		for (auto iter = sceneGraph.beginAllModels(); iter != sceneGraph.end(); ++iter) {
-			const scenegraph::SceneGraphNode &modelNode = *iter;
+			scenegraph::SceneGraphNode &modelNode = *iter;
 			const core::String &label = core::String::format("%s###node-%i", modelNode.name().c_str(), modelNode.id());
 			if (ImGui::BeginNeoTimelineEx(label.c_str(), nullptr, ImGuiNeoTimelineFlags_AllowFrameChanging)) {
-				for (scenegraph::SceneGraphKeyFrame &kf : modelNode.keyFrames()) {
+				const scenegraph::SceneGraphKeyFrames &kfs = ((const scenegraph::SceneGraphNode &)modelNode).keyFrames();
+				for (scenegraph::SceneGraphKeyFrame &kf : kfs) {
+					const scenegraph::FrameIndex frameIdx = kf.frameIdx;
 					ImGui::NeoKeyframe(&kf.frameIdx);
 					if (kf.frameIdx < 0) {
 						kf.frameIdx = 0;
 					}
+					if (kf.frameIdx != frameIdx) {
+						modelNode.markKeyFramesDirty();
+					}
 
 					if (ImGui::IsNeoKeyframeHovered()) {
 						ImGui::BeginTooltip();
@@ -155,6 +160,8 @@ bool AnimationTimeline::update(const char *sequencerTitle, double deltaFrameSeco
 		if (maxFrame <= 0) {
 			_play = false;
 		} else {
+			// only the nodes with modified key frames are baked again
+			sceneGraph.bakeAnimation();
 			// TODO: anim fps
 			currentFrame = (currentFrame + 1) % maxFrame;
 			sceneMgr().setCurrentFrame(currentFrame);
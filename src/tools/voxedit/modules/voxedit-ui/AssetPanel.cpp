@@ -5,6 +5,7 @@
 #include "AssetPanel.h"
 #include "DragAndDropPayload.h"
 #include "Util.h"
+#include "app/App.h"
 #include "core/StringUtil.h"
 #include "image/Image.h"
 #include "io/File.h"
@@ -18,39 +19,59 @@
 #include "video/gl/GLTypes.h"
 #include "voxedit-util/SceneManager.h"
 #include "voxelformat/VolumeFormat.h"
+#include "voxelrender/ThumbnailCache.h"
 #include "voxelutil/VoxelUtil.h"
 
 namespace voxedit {
 
-AssetPanel::AssetPanel(const io::FilesystemPtr &filesystem) : _filesystem(filesystem) {
+AssetPanel::AssetPanel(const io::FilesystemPtr &filesystem, voxelrender::ThumbnailCache &thumbnailCache)
+	: _filesystem(filesystem), _thumbnailCache(thumbnailCache) {
 	loadTextures(filesystem->specialDir(io::FilesystemDirectories::FS_Dir_Pictures));
 	loadModels(filesystem->specialDir(io::FilesystemDirectories::FS_Dir_Documents));
 }
 
 void AssetPanel::loadModels(const core::String &dir) {
-	core::DynamicArray<io::FilesystemEntry> entities;
-	_filesystem->list(dir, entities);
 	_models.clear();
-	for (const auto &e : entities) {
-		const core::String &fullName = core::string::path(dir, e.name);
-		if (voxelformat::isModelFormat(fullName)) {
-			_models.push_back(fullName);
-		}
-	}
+	_modelListing = _filesystem->listAsync(dir, app::App::getInstance()->threadPool());
+	_modelListingOffset = 0u;
 }
 
 void AssetPanel::loadTextures(const core::String &dir) {
-	core::DynamicArray<io::FilesystemEntry> entities;
-	_filesystem->list(dir, entities);
-	for (const auto &e : entities) {
-		const core::String &fullName = core::string::path(dir, e.name);
-		if (io::isImage(fullName)) {
-			_texturePool.load(fullName, false);
+	_textureListing = _filesystem->listAsync(dir, app::App::getInstance()->threadPool());
+	_textureListingOffset = 0u;
+}
+
+void AssetPanel::updateListings() {
+	if (_modelListing) {
+		core::DynamicArray<io::FilesystemEntry> entities;
+		_modelListingOffset = _modelListing->fetch(entities, _modelListingOffset);
+		for (const auto &e : entities) {
+			const core::String &fullName = core::string::path(_modelListing->directory(), e.name);
+			if (voxelformat::isModelFormat(fullName)) {
+				_models.push_back(fullName);
+			}
+		}
+		if (_modelListing->complete()) {
+			_modelListing = io::DirectoryListingPtr();
+		}
+	}
+	if (_textureListing) {
+		core::DynamicArray<io::FilesystemEntry> entities;
+		_textureListingOffset = _textureListing->fetch(entities, _textureListingOffset);
+		for (const auto &e : entities) {
+			const core::String &fullName = core::string::path(_textureListing->directory(), e.name);
+			if (io::isImage(fullName)) {
+				_texturePool.loadAsync(fullName);
+			}
+		}
+		if (_textureListing->complete()) {
+			_textureListing = io::DirectoryListingPtr();
 		}
 	}
 }
 
 void AssetPanel::update(const char *title, bool sceneMode, command::CommandExecutionListener &listener) {
+	updateListings();
 	if (ImGui::Begin(title, nullptr, ImGuiWindowFlags_NoFocusOnAppearing)) {
 		core_trace_scoped(AssetPanel);
 
@@ -61,23 +82,40 @@ void AssetPanel::update(const char *title, bool sceneMode, command::CommandExecu
 			}
 
 			if (ImGui::BeginListBox("##assetmodels", ImVec2(-FLT_MIN, 5 * ImGui::GetTextLineHeightWithSpacing()))) {
-				int n = 0;
-				for (const core::String &model : _models) {
-					const core::String &fileName = core::string::extractFilenameWithExtension(model);
-					const core::String &label = core::String::format("%s##asset", fileName.c_str());
-					const bool isSelected = (_currentSelectedModel == n);
-					ImGui::Selectable(label.c_str(), isSelected);
-					if (isSelected) {
-						ImGui::SetItemDefaultFocus();
+				// only the visible rows are submitted - and only their previews are requested
+				ImGuiListClipper clipper;
+				clipper.Begin((int)_models.size());
+				while (clipper.Step()) {
+					for (int n = clipper.DisplayStart; n < clipper.DisplayEnd; ++n) {
+						const core::String &model = _models[n];
+						const core::String &fileName = core::string::extractFilenameWithExtension(model);
+						const core::String &label = core::String::format("%s##asset", fileName.c_str());
+						const bool isSelected = (_currentSelectedModel == n);
+						const video::TexturePtr &thumbnail = _thumbnailCache.thumbnail(model);
+						// uploads the preview once it was created
+						const video::Id handle = thumbnail ? thumbnail->handle() : video::InvalidId;
+						if (thumbnail && thumbnail->isLoaded()) {
+							const float size = ImGui::GetTextLineHeight();
+							ImGui::Image(handle, ImVec2(size, size));
+							if (ImGui::IsItemHovered()) {
+								ImGui::BeginTooltip();
+								ImGui::Image(handle, ImVec2((float)thumbnail->width(), (float)thumbnail->height()));
+								ImGui::EndTooltip();
+							}
+							ImGui::SameLine();
+						}
+						ImGui::Selectable(label.c_str(), isSelected);
+						if (isSelected) {
+							ImGui::SetItemDefaultFocus();
+						}
+						// TODO: load file - check for unsaved changes
+						if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
+							ImGui::TextUnformatted(model.c_str());
+							ImGui::SetDragDropPayload(dragdrop::ModelPayload, &model, sizeof(core::String),
+													  ImGuiCond_Always);
+							ImGui::EndDragDropSource();
+						}
 					}
-					// TODO: load file - check for unsaved changes
-					if (ImGui::BeginDragDropSource(ImGuiDragDropFlags_SourceAllowNullID)) {
-						ImGui::TextUnformatted(model.c_str());
-						ImGui::SetDragDropPayload(dragdrop::ModelPayload, &model, sizeof(core::String),
-												  ImGuiCond_Always);
-						ImGui::EndDragDropSource();
-					}
-					++n;
 				}
 				ImGui::EndListBox();
 			}
@@ -91,10 +129,14 @@ void AssetPanel::update(const char *title, bool sceneMode, command::CommandExecu
 			ImGuiStyle &style = ImGui::GetStyle();
 			const int maxImages = core_max(1, ImGui::GetWindowSize().x / (50 + style.ItemSpacing.x) - 1);
 			for (const auto &e : _texturePool.cache()) {
-				if (!e->second || !e->second->isLoaded()) {
+				if (!e->second) {
 					continue;
 				}
+				// uploads the decoded image - the state is only updated here
 				const video::Id handle = e->second->handle();
+				if (!e->second->isLoaded()) {
+					continue;
+				}
 				const image::ImagePtr &image = _texturePool.loadImage(e->first);
 				ImGui::ImageButton(handle, ImVec2(50, 50));
 				ImGui::TooltipText("%s: %i:%i", image->name().c_str(), image->width(), image->height());
@@ -12,18 +12,31 @@
 #include "video/Texture.h"
 #include "video/TexturePool.h"
 
+namespace voxelrender {
+class ThumbnailCache;
+}
+
 namespace voxedit {
 
 class AssetPanel {
 private:
 	void loadTextures(const core::String &dir);
 	void loadModels(const core::String &dir);
+	/**
+	 * @brief Picks up the entries of the directories that are listed in the background
+	 */
+	void updateListings();
 	video::TexturePool _texturePool;
 	core::DynamicArray<core::String> _models;
+	io::DirectoryListingPtr _modelListing;
+	size_t _modelListingOffset = 0u;
+	io::DirectoryListingPtr _textureListing;
+	size_t _textureListingOffset = 0u;
 	io::FilesystemPtr _filesystem;
+	voxelrender::ThumbnailCache &_thumbnailCache;
 	int _currentSelectedModel = 0;
 public:
-	AssetPanel(const io::FilesystemPtr &filesystem);
+	AssetPanel(const io::FilesystemPtr &filesystem, voxelrender::ThumbnailCache &thumbnailCache);
 	void update(const char *title, bool sceneMode, command::CommandExecutionListener &listener);
 };
 
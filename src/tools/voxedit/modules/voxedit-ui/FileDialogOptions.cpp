@@ -29,7 +29,11 @@ void fileDialogOptions(video::OpenFileMode mode, const io::FormatDescription *de
 			ImGui::CheckboxVar("Marching cubes", cfg::VoxformatMarchingCubes);
 			ImGui::CheckboxVar("Merge quads", cfg::VoxformatMergequads);
 			ImGui::CheckboxVar("Reuse vertices", cfg::VoxformatReusevertices);
+			ImGui::CheckboxVar("Optimize for the gpu", cfg::VoxformatOptimize);
+			ImGui::InputVarFloat("Simplify ratio", cfg::VoxformatSimplify);
+			ImGui::InputVarFloat("Simplify max error", cfg::VoxformatSimplifyError);
 			ImGui::CheckboxVar("Ambient occlusion", cfg::VoxformatAmbientocclusion);
+			ImGui::CheckboxVar("Bake ambient occlusion", cfg::VoxformatBakeAmbientOcclusion);
 			ImGui::CheckboxVar("Apply transformations", cfg::VoxformatTransform);
 			ImGui::CheckboxVar("Exports quads", cfg::VoxformatQuads);
 			ImGui::CheckboxVar("Vertex colors", cfg::VoxformatWithcolor);
@@ -54,6 +58,9 @@ void fileDialogOptions(video::OpenFileMode mode, const io::FormatDescription *de
 		if (forceApplyOptions || *desc == voxelformat::qubicleBinary()) {
 			ImGui::CheckboxVar("Left handed", cfg::VoxformatQBSaveLeftHanded);
 		}
+		if (forceApplyOptions || desc->matchesExtension("gltf") || desc->matchesExtension("glb")) {
+			ImGui::CheckboxVar("Quantize", cfg::VoxformatGLTFQuantize);
+		}
 		if (forceApplyOptions || *desc == voxelformat::tiberianSun()) {
 			const char *normalTypes[] = {nullptr, nullptr, "Tiberian Sun", nullptr, "Red Alert"};
 			const core::VarPtr &normalTypeVar = core::Var::getSafe(cfg::VoxformatVXLNormalType);
@@ -37,6 +37,7 @@
 #define TITLE_LSYSTEMPANEL ICON_FA_LEAF " L-System##title"
 #define TITLE_ANIMATION_SETTINGS ICON_FA_ARROWS_SPIN " Animation##animationsettings"
 #define TITLE_SCRIPT_EDITOR ICON_FK_CODE " Script Editor##scripteditor"
+#define TITLE_RENDERSTATS ICON_FA_GAUGE " Render statistics##renderstats"
 
 #define POPUP_TITLE_UNSAVED "Unsaved Modifications##popuptitle"
 #define POPUP_TITLE_NEW_SCENE "New scene##popuptitle"
@@ -47,7 +48,7 @@
 
 namespace voxedit {
 
-MainWindow::MainWindow(ui::IMGUIApp *app) : _app(app), _assetPanel(app->filesystem()) {
+MainWindow::MainWindow(ui::IMGUIApp *app) : _app(app), _assetPanel(app->filesystem(), _thumbnailCache) {
 }
 
 MainWindow::~MainWindow() {
@@ -119,6 +120,7 @@ bool MainWindow::initScenes() {
 bool MainWindow::init() {
 	_simplifiedView = core::Var::getSafe(cfg::VoxEditSimplifiedView);
 	_numViewports = core::Var::getSafe(cfg::VoxEditViewports);
+	_renderStats = core::Var::getSafe(cfg::VoxEditRenderStats);
 
 	if (!initScenes()) {
 		return false;
@@ -127,6 +129,13 @@ bool MainWindow::init() {
 	_sceneGraphPanel.init();
 	_lsystemPanel.init();
 	_treePanel.init();
+	_thumbnailCache.init();
+	_app->setFileDialogThumbnails([this](const core::String &file) {
+		if (!voxelformat::isModelFormat(file)) {
+			return video::TexturePtr();
+		}
+		return _thumbnailCache.thumbnail(file);
+	});
 
 	_lastOpenedFile = core::Var::getSafe(cfg::VoxEditLastFile);
 	_lastOpenedFiles = core::Var::getSafe(cfg::VoxEditLastFiles);
@@ -151,6 +160,8 @@ void MainWindow::shutdown() {
 	}
 	_lsystemPanel.shutdown();
 	_treePanel.shutdown();
+	_app->setFileDialogThumbnails({});
+	_thumbnailCache.shutdown();
 }
 
 bool MainWindow::save(const core::String &file, const io::FormatDescription *desc) {
@@ -518,6 +529,7 @@ QuitDisallowReason MainWindow::allowToQuit() {
 
 void MainWindow::update() {
 	core_trace_scoped(MainWindow);
+	_thumbnailCache.update();
 	if (_simplifiedView->isDirty() || _numViewports->isDirty()) {
 		if (!initScenes()) {
 			Log::error("Failed to update scenes");
@@ -588,6 +600,13 @@ void MainWindow::update() {
 
 	_statusBar.update(TITLE_STATUSBAR, statusBarHeight, _lastExecutedCommand.command);
 
+	if (_renderStats->boolVal()) {
+		_renderStatsPanel.update(TITLE_RENDERSTATS, _app->deltaFrameSeconds());
+	} else if (_renderStats->isDirty()) {
+		_renderStatsPanel.hide();
+	}
+	_renderStats->markClean();
+
 	if (!existingLayout && viewport->WorkSize.x > 0.0f) {
 		ImGui::DockBuilderAddNode(dockIdMain, ImGuiDockNodeFlags_DockSpace);
 		ImGui::DockBuilderSetNodeSize(dockIdMain, viewport->WorkSize);
@@ -16,6 +16,7 @@
 #include "voxedit-ui/AssetPanel.h"
 #include "voxedit-ui/MementoPanel.h"
 #include "voxedit-ui/PositionsPanel.h"
+#include "voxedit-ui/RenderStatsPanel.h"
 #include "voxedit-ui/LSystemPanel.h"
 #include "voxedit-ui/QuitDisallowReason.h"
 #include "voxedit-ui/SceneGraphPanel.h"
@@ -28,6 +29,7 @@
 #include "voxedit-ui/TreePanel.h"
 #include "voxedit-util/ModelNodeSettings.h"
 #include "voxedit-util/modifier/ModifierType.h"
+#include "voxelrender/ThumbnailCache.h"
 
 namespace voxedit {
 
@@ -46,6 +48,7 @@ private:
 	core::VarPtr _lastOpenedFiles;
 	core::VarPtr _simplifiedView;
 	core::VarPtr _numViewports;
+	core::VarPtr _renderStats;
 
 	core::DynamicArray<Viewport*> _scenes;
 	Viewport* _lastHoveredScene = nullptr;
@@ -69,11 +72,14 @@ private:
 	SceneGraphPanel _sceneGraphPanel;
 	AnimationPanel _animationPanel;
 	ToolsPanel _toolsPanel;
+	// shared by the file dialog and the asset panel
+	voxelrender::ThumbnailCache _thumbnailCache;
 	AssetPanel _assetPanel;
 	MementoPanel _mementoPanel;
 	PositionsPanel _positionsPanel;
 	ModifierPanel _modifierPanel;
 	PalettePanel _palettePanel;
+	RenderStatsPanel _renderStatsPanel;
 	MenuBar _menuBar;
 	StatusBar _statusBar;
 	AnimationTimeline _animationTimeline;
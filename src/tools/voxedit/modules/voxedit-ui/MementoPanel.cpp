@@ -4,6 +4,7 @@
 
 #include "MementoPanel.h"
 #include "command/CommandHandler.h"
+#include "core/StringUtil.h"
 #include "ui/IMGUIEx.h"
 #include "voxedit-util/MementoHandler.h"
 #include "voxedit-util/SceneManager.h"
@@ -18,7 +19,8 @@ void MementoPanel::update(const char *title, command::CommandExecutionListener &
 	if (ImGui::Begin(title, nullptr, ImGuiWindowFlags_NoFocusOnAppearing)) {
 		const MementoHandler &mementoHandler = sceneMgr().mementoHandler();
 		const int currentStatePos = mementoHandler.statePosition();
-		ImGui::Text("pos: %i/%i", currentStatePos, (int)mementoHandler.stateSize());
+		ImGui::Text("pos: %i/%i (memory: %s)", currentStatePos, (int)mementoHandler.stateSize(),
+					core::string::humanSize(mementoHandler.memoryUsage()).c_str());
 		if (ImGui::BeginListBox("##history-actions", ImVec2(-FLT_MIN, -FLT_MIN))) {
 			int n = 0;
 			int newStatePos = -1;
@@ -144,6 +144,7 @@ bool MenuBar::update(ui::IMGUIApp *app, command::CommandExecutionListener &liste
 				ImGui::CheckboxVar("Color picker", cfg::VoxEditShowColorPicker);
 				ImGui::CheckboxVar("Color wheel", cfg::VoxEditColorWheel);
 				ImGui::CheckboxVar("Simplified UI", cfg::VoxEditSimplifiedView);
+				ImGui::CheckboxVar("Render statistics", cfg::VoxEditRenderStats);
 				ImGui::InputVarInt("Model animation speed", cfg::VoxEditAnimationSpeed);
 				ImGui::InputVarInt("Viewports", cfg::VoxEditViewports, 1, 1);
 				ImGui::SliderVarFloat("Zoom speed", cfg::ClientCameraZoomSpeed, 0.1f, 200.0f);
@@ -0,0 +1,141 @@
+/**
+ * @file
+ */
+
+#include "RenderStatsPanel.h"
+#include "core/Log.h"
+#include "core/Memory.h"
+#include "core/Singleton.h"
+#include "core/StringUtil.h"
+#include "core/Var.h"
+#include "io/FormatDescription.h"
+#include "ui/IMGUIApp.h"
+#include "ui/IMGUIEx.h"
+#include "video/GPUTimer.h"
+#include "voxedit-util/Config.h"
+#include "voxedit-util/MementoHandler.h"
+#include "voxedit-util/SceneManager.h"
+#include <SDL_stdinc.h>
+#include <inttypes.h>
+
+namespace voxedit {
+
+static const io::FormatDescription *csv() {
+	static io::FormatDescription desc[] = {{"CSV", {"csv"}, nullptr, 0u}, {"", {}, nullptr, 0u}};
+	return desc;
+}
+
+void RenderStatsPanel::addSample(double deltaFrameSeconds) {
+	const SceneManager &mgr = sceneMgr();
+	Sample sample;
+	sample.frameMillis = deltaFrameSeconds * 1000.0;
+	sample.stats = video::lastFrameRenderStats();
+	sample.pendingExtractions = mgr.sceneRenderer().pendingExtractions();
+	sample.mementoMemory = mgr.mementoHandler().memoryUsage();
+	// the passes are rendered once per viewport - sum them up
+	for (const video::GPUTimer::Result &result : core::Singleton<video::GPUTimer>::getInstance().results()) {
+		for (int i = 0; i < PassCount; ++i) {
+			if (SDL_strcmp(result.name, Passes[i]) == 0) {
+				sample.passMillis[i] += result.millis;
+				break;
+			}
+		}
+	}
+	_history.push_back(sample);
+}
+
+core::String RenderStatsPanel::toCSV() const {
+	core::String csv = "frame,frame_ms,draw_calls,triangles,buffer_uploads,buffer_upload_bytes,texture_uploads,"
+					   "pending_extractions,memento_bytes";
+	for (int i = 0; i < PassCount; ++i) {
+		csv.append(",gpu_");
+		csv.append(Passes[i]);
+		csv.append("_ms");
+	}
+	csv.append("\n");
+	int frame = 0;
+	for (const Sample &sample : _history) {
+		csv.append(core::string::format("%i,%f,%u,%" PRIu64 ",%u,%" PRIu64 ",%u,%i,%" PRIu64, frame,
+										sample.frameMillis, sample.stats.drawCalls, sample.stats.triangles,
+										sample.stats.bufferUploads, sample.stats.bufferUploadBytes,
+										sample.stats.textureUploads, sample.pendingExtractions,
+										(uint64_t)sample.mementoMemory));
+		for (int i = 0; i < PassCount; ++i) {
+			csv.append(core::string::format(",%f", sample.passMillis[i]));
+		}
+		csv.append("\n");
+		++frame;
+	}
+	return csv;
+}
+
+void RenderStatsPanel::hide() {
+	core::Singleton<video::GPUTimer>::getInstance().setEnabled(false);
+	_history.clear();
+}
+
+void RenderStatsPanel::update(const char *title, double deltaFrameSeconds) {
+	core_trace_scoped(RenderStatsPanel);
+	core::Singleton<video::GPUTimer>::getInstance().setEnabled(true);
+	addSample(deltaFrameSeconds);
+
+	const ImGuiWindowFlags flags = ImGuiWindowFlags_NoDocking | ImGuiWindowFlags_AlwaysAutoResize |
+								   ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav;
+	ImGui::SetNextWindowBgAlpha(0.75f);
+	bool open = true;
+	if (ImGui::Begin(title, &open, flags)) {
+		const Sample &sample = _history.back();
+		ImGui::Text("Frame: %.2f ms", sample.frameMillis);
+		ImGui::PlotLines(
+			"##frametimes",
+			[](void *data, int idx) {
+				const RenderStatsPanel *panel = (const RenderStatsPanel *)data;
+				return (float)panel->_history[idx].frameMillis;
+			},
+			this, (int)_history.size(), 0, nullptr, 0.0f, FLT_MAX, ImVec2(0.0f, 40.0f));
+		ImGui::Separator();
+		ImGui::Text("Draw calls: %u", sample.stats.drawCalls);
+		ImGui::Text("Triangles: %" PRIu64, sample.stats.triangles);
+		ImGui::Text("Buffer uploads: %u (%s)", sample.stats.bufferUploads,
+					core::string::humanSize(sample.stats.bufferUploadBytes).c_str());
+		ImGui::Text("Texture uploads: %u", sample.stats.textureUploads);
+		ImGui::Text("Pending extractions: %i", sample.pendingExtractions);
+		ImGui::Text("Undo memory: %s", core::string::humanSize(sample.mementoMemory).c_str());
+		ImGui::Separator();
+		const core::DynamicArray<video::GPUTimer::Result> &results =
+			core::Singleton<video::GPUTimer>::getInstance().results();
+		if (results.empty()) {
+			ImGui::TextUnformatted("No gpu timings available");
+		}
+		const float indentSpacing = ImGui::GetStyle().IndentSpacing;
+		for (const video::GPUTimer::Result &result : results) {
+			if (result.depth > 0) {
+				ImGui::Indent((float)result.depth * indentSpacing);
+			}
+			ImGui::Text("%s: %.3f ms", result.name, result.millis);
+			if (result.depth > 0) {
+				ImGui::Unindent((float)result.depth * indentSpacing);
+			}
+		}
+		ImGui::Separator();
+		if (ImGui::Button("Export CSV")) {
+			const core::String &data = toCSV();
+			imguiApp()->saveDialog(
+				[data](const core::String &file, const io::FormatDescription *desc) {
+					if (io::filesystem()->write(file, data)) {
+						Log::info("Saved the render statistics to %s", file.c_str());
+					} else {
+						Log::warn("Failed to save the render statistics to %s", file.c_str());
+					}
+				},
+				{}, csv(), "renderstats.csv");
+		}
+		ImGui::TooltipText("Export the last %i frames", (int)_history.size());
+	}
+	ImGui::End();
+	if (!open) {
+		core::Var::getSafe(cfg::VoxEditRenderStats)->setVal(false);
+	}
+}
+
+} // namespace voxedit
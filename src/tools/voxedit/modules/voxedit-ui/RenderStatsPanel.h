@@ -0,0 +1,51 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/String.h"
+#include "core/collection/RingBuffer.h"
+#include "video/Renderer.h"
+
+namespace voxedit {
+
+/**
+ * @brief Overlay with the gpu times of the render passes and the render counters of the last frames
+ *
+ * The history can get exported as csv to compare the numbers of different scenes.
+ */
+class RenderStatsPanel {
+public:
+	/**
+	 * @brief The render passes that are measured by the @c video::GPUTimer
+	 */
+	static constexpr const char *Passes[] = {"Shadow",		  "ShadowCascade0", "ShadowCascade1",
+											 "ShadowCascade2", "ShadowCascade3", "Opaque",
+											 "Transparent",	  "VertexPulling",	"MultiDrawIndirect",
+											 "Bloom",		  "ImGui"};
+	static constexpr int PassCount = sizeof(Passes) / sizeof(Passes[0]);
+
+private:
+	struct Sample {
+		double frameMillis = 0.0;
+		video::RenderStats stats;
+		int pendingExtractions = 0;
+		size_t mementoMemory = 0u;
+		double passMillis[PassCount]{};
+	};
+	static constexpr size_t HistorySize = 512u;
+	core::RingBuffer<Sample, HistorySize> _history;
+
+	void addSample(double deltaFrameSeconds);
+	core::String toCSV() const;
+
+public:
+	void update(const char *title, double deltaFrameSeconds);
+	/**
+	 * @brief Stops measuring the gpu times
+	 */
+	void hide();
+};
+
+} // namespace voxedit
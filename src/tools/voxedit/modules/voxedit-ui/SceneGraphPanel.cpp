@@ -131,7 +131,11 @@ static void commandNodeMenu(const char *title, const char *command, const sceneg
 	ImGui::CommandMenuItem(title, cmd.c_str(), enabled, listener);
 }
 
-static void contextMenu(video::Camera& camera, const scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, command::CommandExecutionListener &listener) {
+/**
+ * @return @c true if the node was renamed
+ */
+static bool contextMenu(video::Camera& camera, const scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node, command::CommandExecutionListener &listener) {
+	bool renamed = false;
 	const core::String &contextMenuId = core::string::format("Edit##context-node-%i", node.id());
 	if (ImGui::BeginPopupContextItem(contextMenuId.c_str())) {
 		const int validModels = (int)sceneGraph.size();
@@ -179,16 +183,50 @@ static void contextMenu(video::Camera& camera, const scenegraph::SceneGraph &sce
 		// only on pressing enter to prevent a memento state flood
 		if (ImGui::InputText("Name" SCENEGRAPHPOPUP, &node.name(), ImGuiInputTextFlags_EnterReturnsTrue)) {
 			sceneMgr().nodeRename(node.id(), node.name());
+			renamed = true;
 		}
 		ImGui::EndPopup();
 	}
+	return renamed;
+}
+
+bool SceneGraphPanel::addRows_r(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node,
+								int depth) {
+	const size_t rowCount = _rows.size();
+	_rows.push_back(NodeRow{node.id(), depth});
+	const bool matches = _filter.empty() || core::string::icontains(node.name(), _filter);
+	// the matching children of collapsed nodes are shown while filtering
+	if (!_filter.empty() || !_collapsedNodes.has(node.id())) {
+		bool childMatches = false;
+		for (int nodeIdx : node.children()) {
+			childMatches |= addRows_r(sceneGraph, sceneGraph.node(nodeIdx), depth + 1);
+		}
+		if (childMatches) {
+			return true;
+		}
+	}
+	if (!matches) {
+		_rows.erase(rowCount, _rows.size() - rowCount);
+		return false;
+	}
+	return true;
+}
+
+void SceneGraphPanel::updateRows(const scenegraph::SceneGraph &sceneGraph) {
+	if (!_rowsDirty && _rowsRevision == sceneGraph.revision()) {
+		return;
+	}
+	core_trace_scoped(SceneGraphPanelRows);
+	_rows.clear();
+	addRows_r(sceneGraph, sceneGraph.root(), 0);
+	_rowsRevision = sceneGraph.revision();
+	_rowsDirty = false;
 }
 
-void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph::SceneGraph &sceneGraph,
-							  scenegraph::SceneGraphNode &node, command::CommandExecutionListener &listener,
-							  int depth, int referencedNodeId) const {
+void SceneGraphPanel::addNodeRow(video::Camera &camera, const scenegraph::SceneGraph &sceneGraph,
+								 scenegraph::SceneGraphNode &node, command::CommandExecutionListener &listener,
+								 int depth, int referencedNodeId) {
 	const int nodeId = node.id();
-	bool open = false;
 	const bool referenceNode = node.reference() == sceneGraph.activeNode();
 	const bool referencedNode = referencedNodeId == nodeId;
 	const bool referenceHighlight = referenceNode || referencedNode;
@@ -259,11 +297,12 @@ void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph:
 		}
 		name.append(core::string::format(" %s##%i", node.name().c_str(), nodeId));
 		const bool selected = nodeId == sceneGraph.activeNode();
-		ImGuiTreeNodeFlags treeFlags = ImGuiTreeNodeFlags_SpanFullWidth;
+		// the children are separate rows - the open state is tracked in the collapsed nodes instead of the tree stack
+		ImGuiTreeNodeFlags treeFlags = ImGuiTreeNodeFlags_SpanFullWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen;
 		if (node.isLeaf()) {
-			treeFlags |= ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen;
+			treeFlags |= ImGuiTreeNodeFlags_Leaf;
 		} else {
-			treeFlags |= ImGuiTreeNodeFlags_DefaultOpen | ImGuiTreeNodeFlags_OpenOnDoubleClick;
+			treeFlags |= ImGuiTreeNodeFlags_OpenOnDoubleClick;
 		}
 		if (selected) {
 			treeFlags |= ImGuiTreeNodeFlags_Selected;
@@ -274,7 +313,17 @@ void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph:
 		if (node.isLeaf()) {
 			ImGui::TreeNodeEx(name.c_str(), treeFlags);
 		} else {
-			open = ImGui::TreeNodeEx(name.c_str(), treeFlags);
+			const bool collapsed = _collapsedNodes.has(nodeId);
+			ImGui::SetNextItemOpen(!collapsed);
+			const bool open = ImGui::TreeNodeEx(name.c_str(), treeFlags);
+			if (open == collapsed) {
+				if (open) {
+					_collapsedNodes.remove(nodeId);
+				} else {
+					_collapsedNodes.insert(nodeId);
+				}
+				_rowsDirty = true;
+			}
 		}
 		ImGui::Unindent(indent);
 
@@ -298,16 +347,15 @@ void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph:
 							Log::error("Failed to move node");
 						}
 						ImGui::EndDragDropTarget();
-						if (open) {
-							ImGui::TreePop();
-						}
 						return;
 					}
 				}
 			}
 			ImGui::EndDragDropTarget();
 		}
-		contextMenu(camera, sceneGraph, node, listener);
+		if (contextMenu(camera, sceneGraph, node, listener) && !_filter.empty()) {
+			_rowsDirty = true;
+		}
 		if (ImGui::IsItemActivated()) {
 			sceneMgr().nodeActivate(nodeId);
 		}
@@ -326,13 +374,6 @@ void SceneGraphPanel::recursiveAddNodes(video::Camera &camera, const scenegraph:
 		}
 		ImGui::TooltipText("Delete this model");
 	}
-
-	if (open) {
-		for (int nodeIdx : node.children()) {
-			recursiveAddNodes(camera, sceneGraph, sceneGraph.node(nodeIdx), listener, depth + 1, referencedNodeId);
-		}
-		ImGui::TreePop();
-	}
 }
 
 bool SceneGraphPanel::init() {
@@ -406,6 +447,9 @@ void SceneGraphPanel::update(video::Camera& camera, const char *title, ModelNode
 			toolbar.button(ICON_FA_EYE, "layershowall");
 			toolbar.button(ICON_FA_EYE_SLASH, "layerhideall");
 			toolbar.end();
+			if (ImGui::InputTextWithHint("##scenegraphfilter", ICON_FA_MAGNIFYING_GLASS " Filter", &_filter)) {
+				_rowsDirty = true;
+			}
 			static const uint32_t tableFlags = ImGuiTableFlags_Reorderable | ImGuiTableFlags_Resizable |
 												ImGuiTableFlags_ScrollX | ImGuiTableFlags_ScrollY |
 												ImGuiTableFlags_BordersInner | ImGuiTableFlags_RowBg |
@@ -422,7 +466,6 @@ void SceneGraphPanel::update(video::Camera& camera, const char *title, ModelNode
 				ImGui::TableSetupColumn("Name##node", ImGuiTableColumnFlags_WidthStretch);
 				ImGui::TableSetupColumn("##nodedelete", colFlags);
 				ImGui::TableHeadersRow();
-				// TODO: filter by name and type
 
 				int referencedNode = InvalidNodeId;
 				const scenegraph::SceneGraphNode& activeNode = sceneGraph.node(sceneGraph.activeNode());
@@ -430,7 +473,20 @@ void SceneGraphPanel::update(video::Camera& camera, const char *title, ModelNode
 					referencedNode = activeNode.reference();
 				}
 
-				recursiveAddNodes(camera, sceneGraph, sceneGraph.node(sceneGraph.root().id()), listener, 0, referencedNode);
+				updateRows(sceneGraph);
+				ImGuiListClipper clipper;
+				clipper.Begin((int)_rows.size());
+				while (clipper.Step()) {
+					for (int i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+						const NodeRow &row = _rows[i];
+						// a node might have been removed by a previous row in this frame
+						if (!sceneGraph.hasNode(row.nodeId)) {
+							ImGui::TableNextRow();
+							continue;
+						}
+						addNodeRow(camera, sceneGraph, sceneGraph.node(row.nodeId), listener, row.depth, referencedNode);
+					}
+				}
 				ImGui::EndTable();
 			}
 		}
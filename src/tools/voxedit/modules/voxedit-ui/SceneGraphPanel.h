@@ -6,6 +6,8 @@
 
 #include "command/CommandHandler.h"
 #include "core/Var.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/Set.h"
 
 namespace video {
 class Camera;
@@ -29,10 +31,35 @@ private:
 	core::String _propertyKey;
 	core::String _propertyValue;
 
+	struct NodeRow {
+		int nodeId;
+		int depth;
+	};
+	/**
+	 * @brief The flattened tree of the visible (not collapsed and not filtered) nodes - only the rows in the
+	 * visible area of the panel are rendered
+	 */
+	core::DynamicArray<NodeRow> _rows;
+	/**
+	 * @brief The structural revision of the scene graph the rows were built for
+	 * @sa scenegraph::SceneGraph::revision()
+	 */
+	uint32_t _rowsRevision = 0u;
+	bool _rowsDirty = true;
+	core::Set<int> _collapsedNodes;
+	core::String _filter;
+
 	void detailView(scenegraph::SceneGraphNode &node);
-	void recursiveAddNodes(video::Camera &camera, const scenegraph::SceneGraph &sceneGraph,
-							  scenegraph::SceneGraphNode &node, command::CommandExecutionListener &listener,
-							  int depth, int referencedNodeId) const;
+	/**
+	 * @brief Rebuilds the rows if the scene graph structure, the filter or the collapsed nodes changed
+	 */
+	void updateRows(const scenegraph::SceneGraph &sceneGraph);
+	/**
+	 * @return @c true if the node or any of its children matches the filter and rows were added
+	 */
+	bool addRows_r(const scenegraph::SceneGraph &sceneGraph, const scenegraph::SceneGraphNode &node, int depth);
+	void addNodeRow(video::Camera &camera, const scenegraph::SceneGraph &sceneGraph, scenegraph::SceneGraphNode &node,
+					command::CommandExecutionListener &listener, int depth, int referencedNodeId);
 	/**
 	 * @return @c true if the property was handled with a special ui input widget - @c false if it should just be a
 	 * normal text input field
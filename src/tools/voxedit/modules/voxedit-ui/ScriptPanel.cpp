@@ -139,10 +139,19 @@ void ScriptPanel::update(const char *title) {
 		}
 		const bool validScriptIndex = _currentScript >= 0 && _currentScript < (int)_scripts.size();
 		const bool validScript = validScriptIndex && _scripts[_currentScript].valid;
-		if (ImGui::DisabledButton("Execute##scriptpanel", !validScript)) {
-			sceneMgr().runScript(_activeScript, _scriptParameters);
+		if (sceneMgr().isScriptRunning()) {
+			if (ImGui::Button("Cancel##scriptpanel")) {
+				sceneMgr().cancelScript();
+			}
+			ImGui::TooltipText("Abort the running script - its changes are discarded");
+			ImGui::SameLine();
+			ImGui::Text("Running (%.1fM instructions)", (double)sceneMgr().scriptInstructions() / 1000000.0);
+		} else {
+			if (ImGui::DisabledButton("Execute##scriptpanel", !validScript)) {
+				sceneMgr().runScript(_activeScript, _scriptParameters);
+			}
+			ImGui::TooltipText("Execute the selected script for the currently loaded voxel volumes");
 		}
-		ImGui::TooltipText("Execute the selected script for the currently loaded voxel volumes");
 		ImGui::SameLine();
 		if (ImGui::Button("New##scriptpanel")) {
 			_scriptEditor = true;
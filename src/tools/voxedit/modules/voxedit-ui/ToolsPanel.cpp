@@ -29,6 +29,7 @@ void ToolsPanel::updateEditMode(command::CommandExecutionListener &listener) {
 		toolbar.button(ICON_FA_OBJECT_UNGROUP, "colortolayer");
 		toolbar.button(ICON_FA_COMPRESS, "scale");
 		toolbar.button(ICON_FA_FILL_DRIP, "fillhollow");
+		toolbar.button(ICON_FA_BOX_OPEN, "hollow");
 	}
 
 	const float buttonWidth = (float)imguiApp()->fontSize() * 4;
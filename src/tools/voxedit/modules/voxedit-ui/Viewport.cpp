@@ -62,9 +62,13 @@ bool Viewport::init() {
 	_modelGizmo = core::Var::getSafe(cfg::VoxEditModelGizmo);
 	_viewDistance = core::Var::getSafe(cfg::VoxEditViewdistance);
 	_simplifiedView = core::Var::getSafe(cfg::VoxEditSimplifiedView);
+	_inactiveFps = core::Var::getSafe(cfg::VoxEditViewportInactiveFps);
 	if (!_renderContext.init(video::getWindowSize())) {
 		return false;
 	}
+	if (!_readback.init()) {
+		Log::warn("Failed to init the texture readback - the video frames are read synchronously");
+	}
 
 	resetCamera();
 
@@ -232,9 +236,12 @@ void Viewport::renderViewport() {
 	glm::ivec2 contentSize = ImGui::GetContentRegionAvail();
 	const float headerSize = ImGui::GetCursorPosY();
 	if (setupFrameBuffer(contentSize)) {
+		const bool cameraChanged = _camera.dirty();
 		_camera.update(imguiApp()->deltaFrameSeconds());
 
-		renderToFrameBuffer();
+		if (needsRender(cameraChanged)) {
+			renderToFrameBuffer();
+		}
 		renderViewportImage(contentSize);
 		const bool modifiedRegion = renderGizmo(camera(), headerSize, contentSize);
 
@@ -346,6 +353,7 @@ void Viewport::toggleVideoRecording() {
 			{}, nullptr, "video.avi");
 	} else {
 		Log::debug("Stop recording");
+		enqueueRecordedFrames(true);
 		_avi.stopRecording();
 	}
 }
@@ -413,24 +421,58 @@ void Viewport::update(command::CommandExecutionListener *listener) {
 	ImGui::End();
 
 	if (_avi.isRecording()) {
-		_avi.enqueueFrame(renderToImage("**video**"));
+		recordFrame();
 	} else if (_avi.hasFinished()) {
 		_avi.flush();
 	}
 }
 
 void Viewport::shutdown() {
+	_readback.shutdown();
 	_renderContext.shutdown();
 	_avi.abort();
 }
 
-image::ImagePtr Viewport::renderToImage(const char *imageName) {
+void Viewport::renderScene() {
 	_renderContext.frameBuffer.bind(true);
 	sceneMgr().render(_renderContext, camera(), SceneManager::RenderScene);
 	_renderContext.frameBuffer.unbind();
+}
+
+image::ImagePtr Viewport::renderToImage(const char *imageName) {
+	renderScene();
 	return _renderContext.frameBuffer.image(imageName, video::FrameBufferAttachment::Color0);
 }
 
+void Viewport::recordFrame() {
+	if (!_readback.isValid()) {
+		_avi.enqueueFrame(renderToImage("**video**"));
+		return;
+	}
+	renderScene();
+	if (_readback.full()) {
+		enqueueRecordedFrames(false);
+		if (_readback.full()) {
+			// the gpu is more than MaxPending frames behind - wait for the oldest frame to keep the order
+			_avi.enqueueFrame(_readback.pop(true));
+		}
+	}
+	if (!_readback.read(_renderContext.frameBuffer.texture(video::FrameBufferAttachment::Color0), "**video**")) {
+		Log::warn("Failed to read the video frame");
+	}
+	enqueueRecordedFrames(false);
+}
+
+void Viewport::enqueueRecordedFrames(bool wait) {
+	while (_readback.pending() > 0) {
+		image::ImagePtr image = _readback.pop(wait);
+		if (!image) {
+			break;
+		}
+		_avi.enqueueFrame(core::move(image));
+	}
+}
+
 bool Viewport::saveImage(const char *filename) {
 	const image::ImagePtr &image = renderToImage(filename);
 	if (!image) {
@@ -656,6 +698,21 @@ bool Viewport::renderGizmo(video::Camera &camera, float headerSize, const ImVec2
 	return modified;
 }
 
+bool Viewport::needsRender(bool cameraChanged) {
+	const double nowSeconds = imguiApp()->nowSeconds();
+	const int inactiveFps = _inactiveFps->intVal();
+	if (inactiveFps > 0 && !cameraChanged && !_avi.isRecording()) {
+		if (!ImGui::IsWindowHovered() && !ImGui::IsWindowFocused()) {
+			// the other viewports still show the edits - just with a lower frame rate
+			if (nowSeconds - _lastRenderSeconds < 1.0 / (double)inactiveFps) {
+				return false;
+			}
+		}
+	}
+	_lastRenderSeconds = nowSeconds;
+	return true;
+}
+
 void Viewport::renderToFrameBuffer() {
 	core_trace_scoped(EditorSceneRenderFramebuffer);
 	video::clearColor(core::Color::Clear);
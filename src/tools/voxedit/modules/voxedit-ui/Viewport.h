@@ -8,6 +8,7 @@
 #include "image/AVIRecorder.h"
 #include "video/gl/GLTypes.h"
 #include "video/Camera.h"
+#include "video/TextureReadback.h"
 #include "voxel/Region.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxelrender/RawVolumeRenderer.h"
@@ -31,6 +32,10 @@ private:
 	bool _hovered = false;
 	SceneCameraMode _camMode = SceneCameraMode::Free;
 	image::AVIRecorder _avi;
+	/**
+	 * the frames of the video recording are read back asynchronously to not stall the rendering
+	 */
+	video::TextureReadback _readback;
 
 	/**
 	 * while we are still modifying the transform or shifting the volume we don't want to
@@ -83,7 +88,15 @@ private:
 	core::VarPtr _simplifiedView;
 	core::VarPtr _rotationSpeed;
 	core::VarPtr _cursorDetails;
+	core::VarPtr _inactiveFps;
+	double _lastRenderSeconds = 0.0;
 
+	/**
+	 * @brief Viewports that are neither hovered nor focused are only rendered with the frame rate of
+	 * @c cfg::VoxEditViewportInactiveFps - the framebuffer keeps the last frame in between
+	 * @param cameraChanged A camera change or a resize is always rendered
+	 */
+	bool needsRender(bool cameraChanged);
 	void renderToFrameBuffer();
 	bool setupFrameBuffer(const glm::ivec2& frameBufferSize);
 	void handleGizmo(const scenegraph::SceneGraphNode &node, scenegraph::KeyFrameIndex keyFrameIdx, const glm::mat4 &localMatrix);
@@ -114,6 +127,13 @@ private:
 	void resize(const glm::ivec2& frameBufferSize);
 	void move(bool pan, bool rotate, int x, int y);
 	image::ImagePtr renderToImage(const char *imageName);
+	void renderScene();
+	void recordFrame();
+	/**
+	 * @brief Hands the frames that were read back to the video recorder
+	 * @param wait Block until all pending reads are done
+	 */
+	void enqueueRecordedFrames(bool wait);
 public:
 	Viewport(int id, bool sceneMode, bool detailedTitle = true);
 	~Viewport();
@@ -0,0 +1,287 @@
+/**
+ * @file
+ */
+
+#include "ActionRecorder.h"
+#include "app/App.h"
+#include "core/FourCC.h"
+#include "core/Log.h"
+#include "core/Trace.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+
+namespace voxedit {
+
+#define wrap(read)                                                                                                     \
+	if ((read) != 0) {                                                                                                 \
+		Log::debug("Could not load action: Not enough data in stream " CORE_STRINGIFY(read));                         \
+		return false;                                                                                                  \
+	}
+
+#define wrapBool(read)                                                                                                 \
+	if ((read) != true) {                                                                                              \
+		Log::debug("Could not load action: Not enough data in stream " CORE_STRINGIFY(read));                         \
+		return false;                                                                                                  \
+	}
+
+static constexpr uint32_t RecordingMagic = FourCC('V', 'A', 'C', 'T');
+static constexpr uint32_t RecordingVersion = 1u;
+
+ActionRecorder::~ActionRecorder() {
+	stop();
+}
+
+bool ActionRecorder::start(const core::String &file) {
+	stop();
+	io::FilePtr filePtr = io::filesystem()->open(file, io::FileMode::SysWrite);
+	io::BufferedReadWriteStream stream(8);
+	stream.writeUInt32(RecordingMagic);
+	stream.writeUInt32(RecordingVersion);
+	if (!filePtr->validHandle() || filePtr->write(stream.getBuffer(), stream.size()) != (long)stream.size()) {
+		Log::warn("Failed to start the action recording %s", file.c_str());
+		filePtr->close();
+		return false;
+	}
+	_file = filePtr;
+	_path = file;
+	Log::info("Started the action recording %s", file.c_str());
+	return true;
+}
+
+void ActionRecorder::stop() {
+	if (!_file) {
+		return;
+	}
+	_file->close();
+	_file = {};
+	Log::info("Stopped the action recording %s", _path.c_str());
+	_path.clear();
+}
+
+static bool writeVoxel(const voxel::Voxel &voxel, io::WriteStream &stream) {
+	wrapBool(stream.writeUInt8((uint8_t)voxel.getMaterial()))
+	wrapBool(stream.writeUInt8(voxel.getColor()))
+	wrapBool(stream.writeUInt8(voxel.getFlags()))
+	return true;
+}
+
+static bool readVoxel(io::ReadStream &stream, voxel::Voxel &voxel) {
+	uint8_t material;
+	uint8_t color;
+	uint8_t flags;
+	wrap(stream.readUInt8(material))
+	wrap(stream.readUInt8(color))
+	wrap(stream.readUInt8(flags))
+	voxel = voxel::createVoxel((voxel::VoxelType)material, color);
+	voxel.setFlags(flags);
+	return true;
+}
+
+static bool writeIVec3(const glm::ivec3 &v, io::WriteStream &stream) {
+	for (int i = 0; i < 3; ++i) {
+		wrapBool(stream.writeInt32(v[i]))
+	}
+	return true;
+}
+
+static bool readIVec3(io::ReadStream &stream, glm::ivec3 &v) {
+	for (int i = 0; i < 3; ++i) {
+		wrap(stream.readInt32(v[i]))
+	}
+	return true;
+}
+
+bool ActionRecorder::writeAction(const Action &action, io::WriteStream &stream) {
+	wrapBool(stream.writeUInt8((uint8_t)action.type))
+	wrapBool(stream.writeInt32(action.nodeId))
+	switch (action.type) {
+	case ActionType::Modifier:
+	case ActionType::Script: {
+		const ModifierState &state = action.modifier;
+		wrapBool(stream.writeUInt32((uint32_t)state.modifierType))
+		wrapBool(stream.writeUInt8((uint8_t)state.shapeType))
+		if (!writeVoxel(state.cursorVoxel, stream) || !writeVoxel(state.hitCursorVoxel, stream)) {
+			return false;
+		}
+		if (!writeIVec3(state.aabbFirstPos, stream) || !writeIVec3(state.aabbSecondPos, stream) ||
+			!writeIVec3(state.cursorPosition, stream) || !writeIVec3(state.referencePosition, stream) ||
+			!writeIVec3(state.mirrorPosition, stream)) {
+			return false;
+		}
+		wrapBool(stream.writeUInt8((uint8_t)state.aabbSecondActionDirection))
+		wrapBool(stream.writeUInt8((uint8_t)state.mirrorAxis))
+		wrapBool(stream.writeUInt8((uint8_t)state.face))
+		wrapBool(stream.writeInt32(state.gridResolution))
+		wrapBool(stream.writeBool(state.aabbMode))
+		wrapBool(stream.writeBool(state.secondPosValid))
+		wrapBool(stream.writeBool(state.center))
+		if (action.type == ActionType::Script) {
+			wrapBool(stream.writePascalStringUInt32LE(action.str))
+			wrapBool(stream.writeUInt16((uint16_t)action.args.size()))
+			for (const core::String &arg : action.args) {
+				wrapBool(stream.writePascalStringUInt16LE(arg))
+			}
+		}
+		break;
+	}
+	case ActionType::Undo:
+	case ActionType::Redo:
+		wrapBool(stream.writeInt32(action.steps))
+		break;
+	case ActionType::Palette: {
+		if (!action.palette.hasValue()) {
+			return false;
+		}
+		const voxel::Palette &palette = *action.palette.value();
+		wrapBool(stream.writeUInt32(palette.colorCount()))
+		for (int i = 0; i < palette.colorCount(); ++i) {
+			wrapBool(stream.writeUInt32(palette.color(i).rgba))
+		}
+		for (int i = 0; i < palette.colorCount(); ++i) {
+			wrapBool(stream.writeUInt32(palette.glowColor(i).rgba))
+		}
+		break;
+	}
+	case ActionType::Select:
+		wrapBool(stream.writePascalStringUInt16LE(action.str))
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+bool ActionRecorder::readAction(io::ReadStream &stream, Action &action) {
+	uint8_t type;
+	wrap(stream.readUInt8(type))
+	if (type >= (uint8_t)ActionType::Max) {
+		return false;
+	}
+	action.type = (ActionType)type;
+	wrap(stream.readInt32(action.nodeId))
+	switch (action.type) {
+	case ActionType::Modifier:
+	case ActionType::Script: {
+		ModifierState &state = action.modifier;
+		uint32_t modifierType;
+		wrap(stream.readUInt32(modifierType))
+		state.modifierType = (ModifierType)modifierType;
+		uint8_t shapeType;
+		wrap(stream.readUInt8(shapeType))
+		if (shapeType >= (uint8_t)ShapeType::Max) {
+			return false;
+		}
+		state.shapeType = (ShapeType)shapeType;
+		if (!readVoxel(stream, state.cursorVoxel) || !readVoxel(stream, state.hitCursorVoxel)) {
+			return false;
+		}
+		if (!readIVec3(stream, state.aabbFirstPos) || !readIVec3(stream, state.aabbSecondPos) ||
+			!readIVec3(stream, state.cursorPosition) || !readIVec3(stream, state.referencePosition) ||
+			!readIVec3(stream, state.mirrorPosition)) {
+			return false;
+		}
+		uint8_t axis;
+		wrap(stream.readUInt8(axis))
+		state.aabbSecondActionDirection = (math::Axis)axis;
+		wrap(stream.readUInt8(axis))
+		state.mirrorAxis = (math::Axis)axis;
+		uint8_t face;
+		wrap(stream.readUInt8(face))
+		state.face = (voxel::FaceNames)face;
+		wrap(stream.readInt32(state.gridResolution))
+		state.aabbMode = stream.readBool();
+		state.secondPosValid = stream.readBool();
+		state.center = stream.readBool();
+		if (action.type == ActionType::Script) {
+			wrapBool(stream.readPascalStringUInt32LE(action.str))
+			uint16_t argc;
+			wrap(stream.readUInt16(argc))
+			for (uint16_t i = 0; i < argc; ++i) {
+				core::String arg;
+				wrapBool(stream.readPascalStringUInt16LE(arg))
+				action.args.push_back(arg);
+			}
+		}
+		break;
+	}
+	case ActionType::Undo:
+	case ActionType::Redo:
+		wrap(stream.readInt32(action.steps))
+		break;
+	case ActionType::Palette: {
+		voxel::Palette palette;
+		uint32_t colorCount;
+		wrap(stream.readUInt32(colorCount))
+		if (colorCount > voxel::PaletteMaxColors) {
+			return false;
+		}
+		palette.setSize((int)colorCount);
+		for (uint32_t i = 0; i < colorCount; ++i) {
+			wrap(stream.readUInt32(palette.color(i).rgba))
+		}
+		for (uint32_t i = 0; i < colorCount; ++i) {
+			wrap(stream.readUInt32(palette.glowColor(i).rgba))
+		}
+		palette.markDirty();
+		action.palette.setValue(palette);
+		break;
+	}
+	case ActionType::Select:
+		wrapBool(stream.readPascalStringUInt16LE(action.str))
+		break;
+	default:
+		return false;
+	}
+	return true;
+}
+
+bool ActionRecorder::record(const Action &action) {
+	if (!_file) {
+		return false;
+	}
+	core_trace_scoped(ActionRecorderRecord);
+	io::BufferedReadWriteStream stream(256);
+	if (!writeAction(action, stream)) {
+		Log::warn("Failed to serialize the action %s", ActionTypeStr[(int)action.type]);
+		return false;
+	}
+	if (_file->write(stream.getBuffer(), stream.size()) != (long)stream.size()) {
+		Log::warn("Failed to write the action recording %s", _path.c_str());
+		stop();
+		return false;
+	}
+	return true;
+}
+
+bool ActionRecorder::load(const core::String &file, core::DynamicArray<Action> &actions) {
+	const io::FilePtr &filePtr = io::filesystem()->open(file, io::FileMode::SysRead);
+	if (!filePtr->exists()) {
+		Log::error("The action recording %s doesn't exist", file.c_str());
+		return false;
+	}
+	core_trace_scoped(ActionRecorderLoad);
+	io::FileStream stream(filePtr);
+	uint32_t magic;
+	uint32_t version;
+	if (!stream.valid() || stream.readUInt32(magic) != 0 || magic != RecordingMagic ||
+		stream.readUInt32(version) != 0 || version != RecordingVersion) {
+		Log::error("Invalid action recording %s", file.c_str());
+		return false;
+	}
+	while (!stream.eos()) {
+		Action action;
+		if (!readAction(stream, action)) {
+			// the editor might have crashed while the last action was written
+			Log::warn("Skip the truncated action %i of %s", (int)actions.size(), file.c_str());
+			break;
+		}
+		actions.push_back(action);
+	}
+	return true;
+}
+
+#undef wrap
+#undef wrapBool
+
+} // namespace voxedit
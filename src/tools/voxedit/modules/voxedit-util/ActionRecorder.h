@@ -0,0 +1,107 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/NonCopyable.h"
+#include "core/Optional.h"
+#include "core/String.h"
+#include "core/collection/DynamicArray.h"
+#include "io/File.h"
+#include "modifier/Modifier.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/Palette.h"
+
+namespace io {
+class ReadStream;
+class WriteStream;
+}
+
+namespace voxedit {
+
+enum class ActionType : uint8_t {
+	/** the modifier was executed for the active node and its group */
+	Modifier,
+	Undo,
+	Redo,
+	/** the palette of the active node was replaced */
+	Palette,
+	/** a lua script was executed for the active node */
+	Script,
+	/** the select command - the argument is all, none or invert */
+	Select,
+
+	Max
+};
+
+static constexpr const char *ActionTypeStr[(int)ActionType::Max] = {"modifier", "undo", "redo", "palette", "script",
+																   "select"};
+
+/**
+ * @brief A user level action of the editor that can be executed again
+ */
+struct Action {
+	ActionType type = ActionType::Max;
+	/** the active node when the action was executed */
+	int nodeId = InvalidNodeId;
+	/** the modifier of ActionType::Modifier - and the cursor voxel of ActionType::Script */
+	ModifierState modifier;
+	/**
+	 * @brief The steps of ActionType::Undo and ActionType::Redo - for ActionType::Palette @c 1 if the voxels were
+	 * remapped to the closest colors of the new palette
+	 */
+	int steps = 0;
+	core::Optional<voxel::Palette> palette;
+	/** the script source of ActionType::Script or the argument of ActionType::Select */
+	core::String str;
+	core::DynamicArray<core::String> args;
+};
+
+/**
+ * @brief The time the replay of an action took
+ * @sa SceneManager::replayActions()
+ */
+struct ActionTiming {
+	ActionType type = ActionType::Max;
+	double millis = 0.0;
+};
+
+/**
+ * @brief Records the user level actions of the editor into a file - the actions can be executed again with
+ * @c SceneManager::replayActions() to turn a slow editing session into a reproducible benchmark.
+ *
+ * The nodes are referenced by their ids - a recording must be replayed on the scene it was started with (e.g. by
+ * loading the same scene file).
+ */
+class ActionRecorder : public core::NonCopyable {
+private:
+	io::FilePtr _file;
+	core::String _path;
+
+	static bool writeAction(const Action &action, io::WriteStream &stream);
+	static bool readAction(io::ReadStream &stream, Action &action);
+
+public:
+	~ActionRecorder();
+
+	/**
+	 * @brief Replaces the given file with an empty recording
+	 */
+	bool start(const core::String &file);
+	void stop();
+	bool active() const;
+
+	/**
+	 * @brief Appends the given action to the recording - the recording is stopped if the write fails
+	 */
+	bool record(const Action &action);
+
+	static bool load(const core::String &file, core::DynamicArray<Action> &actions);
+};
+
+inline bool ActionRecorder::active() const {
+	return _file;
+}
+
+} // namespace voxedit
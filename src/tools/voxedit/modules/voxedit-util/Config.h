@@ -36,5 +36,14 @@ constexpr const char *VoxEditViewdistance = "ve_viewdistance";
 constexpr const char *VoxEditShowlockedaxis = "ve_showlockedaxis";
 constexpr const char *VoxEditRendershadow = "ve_rendershadow";
 constexpr const char *VoxEditAnimationSpeed = "ve_animspeed";
+constexpr const char *VoxEditUndoMemory = "ve_undomemory";
+constexpr const char *VoxEditUndoCompression = "ve_undocompression";
+constexpr const char *VoxEditLazyLoad = "ve_lazyload";
+constexpr const char *VoxEditLazyLoadCache = "ve_lazyloadcache";
+constexpr const char *VoxEditCompressCold = "ve_compresscold";
+constexpr const char *VoxEditJournal = "ve_journal";
+constexpr const char *VoxEditRenderStats = "ve_renderstats";
+constexpr const char *VoxEditGpuPicking = "ve_gpupicking";
+constexpr const char *VoxEditViewportInactiveFps = "ve_viewportinactivefps";
 
 }
@@ -3,11 +3,17 @@
  */
 
 #include "MementoHandler.h"
+#include "Config.h"
+#include "MementoJournal.h"
 
+#include "app/App.h"
 #include "core/ArrayLength.h"
+#include "core/Memory.h"
 #include "core/Optional.h"
 #include "core/ScopedPtr.h"
+#include "core/StringUtil.h"
 #include "io/BufferedReadWriteStream.h"
+#include "io/Filesystem.h"
 #include "io/MemoryReadStream.h"
 #include "io/ZipReadStream.h"
 #include "io/ZipWriteStream.h"
@@ -18,14 +24,40 @@
 #include "command/Command.h"
 #include "core/Assert.h"
 #include "core/StandardLib.h"
+#include "core/Trace.h"
 #include "core/Log.h"
 #include "core/Zip.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxelutil/VoxelUtil.h"
+#include <SDL.h>
 #include <inttypes.h>
 
 namespace voxedit {
 
+/**
+ * @brief Copy of the voxels of a volume
+ */
+struct MementoSnapshot {
+	voxel::Voxel *voxels;
+	size_t size;
+
+	MementoSnapshot(voxel::Voxel *_voxels, size_t _size) : voxels(_voxels), size(_size) {
+	}
+
+	MementoSnapshot(const voxel::RawVolume *volume) : size(volume->region().voxels() * sizeof(voxel::Voxel)) {
+		voxels = (voxel::Voxel *)core_malloc(size);
+		core_memcpy(voxels, volume->data(), size);
+	}
+
+	~MementoSnapshot() {
+		core_free(voxels);
+	}
+};
+
+struct MementoJob {
+	std::future<MementoData> future;
+};
+
 static const MementoState InvalidMementoState{MementoType::Max,
 											  MementoData(),
 											  InvalidNodeId,
@@ -38,6 +70,9 @@ static const MementoState InvalidMementoState{MementoType::Max,
 											  glm::mat4(1.0f),
 											  0};
 
+MementoData::MementoData() {
+}
+
 MementoData::MementoData(uint8_t *buf, size_t bufSize, const voxel::Region &_region)
 	: _compressedSize(bufSize), _region(_region) {
 	if (buf != nullptr) {
@@ -63,9 +98,16 @@ MementoData::MementoData(const uint8_t* buf, size_t bufSize,
 MementoData::MementoData(MementoData&& o) noexcept :
 		_compressedSize(o._compressedSize),
 		_buffer(o._buffer),
-		_region(o._region) {
+		_region(o._region),
+		_deltaDepth(o._deltaDepth),
+		_uncompressed(o._uncompressed),
+		_spillOffset(o._spillOffset),
+		_job(core::move(o._job)) {
 	o._compressedSize = 0;
 	o._buffer = nullptr;
+	o._deltaDepth = 0;
+	o._uncompressed = false;
+	o._spillOffset = -1;
 }
 
 MementoData::~MementoData() {
@@ -77,13 +119,17 @@ MementoData::~MementoData() {
 
 MementoData::MementoData(const MementoData& o) :
 		_compressedSize(o._compressedSize),
-		_region(o._region) {
+		_region(o._region),
+		_deltaDepth(o._deltaDepth),
+		_uncompressed(o._uncompressed),
+		_spillOffset(o._spillOffset),
+		_job(o._job) {
 	if (o._buffer != nullptr) {
 		core_assert(_compressedSize > 0);
 		_buffer = (uint8_t*)core_malloc(_compressedSize);
 		core_memcpy(_buffer, o._buffer, _compressedSize);
 	} else {
-		core_assert(_compressedSize == 0);
+		core_assert(_compressedSize == 0 || o.spilled());
 	}
 }
 
@@ -97,11 +143,19 @@ MementoData& MementoData::operator=(MementoData &&o) noexcept {
 		_buffer = o._buffer;
 		o._buffer = nullptr;
 		_region = o._region;
+		_deltaDepth = o._deltaDepth;
+		o._deltaDepth = 0;
+		_uncompressed = o._uncompressed;
+		o._uncompressed = false;
+		_spillOffset = o._spillOffset;
+		o._spillOffset = -1;
+		_job = core::move(o._job);
 	}
 	return *this;
 }
 
-MementoData MementoData::fromVolume(const voxel::RawVolume* volume, const voxel::Region &region) {
+MementoData MementoData::fromVolume(const voxel::RawVolume* volume, const voxel::Region &region, int compressionLevel) {
+	core_memory_scope(Memento);
 	if (volume == nullptr) {
 		return MementoData();
 	}
@@ -111,22 +165,149 @@ MementoData MementoData::fromVolume(const voxel::RawVolume* volume, const voxel:
 		mementoRegion = volume->region();
 	}
 
-	const int allVoxels = volume->region().voxels();
-	const uint32_t compressedBufferSize = core::zip::compressBound(allVoxels * sizeof(voxel::Voxel));
-	io::BufferedReadWriteStream outStream(compressedBufferSize);
-	io::ZipWriteStream stream(outStream);
 	if (partialMemento) {
 		voxel::RawVolume v(volume, region);
-		stream.write(v.data(), allVoxels * sizeof(voxel::Voxel));
-	} else {
-		stream.write(volume->data(), allVoxels * sizeof(voxel::Voxel));
+		return compressVoxels(v.data(), v.region().voxels() * sizeof(voxel::Voxel), mementoRegion, compressionLevel);
 	}
+	return compressVoxels(volume->data(), volume->region().voxels() * sizeof(voxel::Voxel), mementoRegion, compressionLevel);
+}
+
+MementoData MementoData::compressVoxels(const uint8_t *voxels, size_t size, const voxel::Region &region, int compressionLevel) {
+	const uint32_t compressedBufferSize = core::zip::compressBound(size);
+	io::BufferedReadWriteStream outStream(compressedBufferSize);
+	io::ZipWriteStream stream(outStream, compressionLevel);
+	stream.write(voxels, size);
 	stream.flush();
-	const size_t size = (size_t)outStream.size();
-	return {outStream.release(), size, mementoRegion};
+	const size_t compressedSize = (size_t)outStream.size();
+	return {outStream.release(), compressedSize, region};
+}
+
+static bool uncompressVoxels(const uint8_t *buf, size_t size, uint8_t *voxels, size_t voxelsSize) {
+	io::MemoryReadStream dataStream(buf, size);
+	io::ZipReadStream stream(dataStream, (int)dataStream.size());
+	return stream.read(voxels, voxelsSize) != -1;
+}
+
+/**
+ * The delta is a sequence of runs: the amount of unchanged voxels, the amount of changed voxels and the
+ * changed voxels xor'ed with the base voxels. Applying the delta to either side gives the other one.
+ *
+ * @return @c false if the delta would get bigger than @c maxSize
+ */
+static bool encodeDelta(const voxel::Voxel *base, const voxel::Voxel *voxels, int voxelCount, io::WriteStream &stream,
+						int64_t &size, int64_t maxSize) {
+	int i = 0;
+	do {
+		const int unchangedStart = i;
+		while (i < voxelCount && core_memcmp(&base[i], &voxels[i], sizeof(voxel::Voxel)) == 0) {
+			++i;
+		}
+		const int changedStart = i;
+		while (i < voxelCount && core_memcmp(&base[i], &voxels[i], sizeof(voxel::Voxel)) != 0) {
+			++i;
+		}
+		stream.writeUInt32(changedStart - unchangedStart);
+		stream.writeUInt32(i - changedStart);
+		size += 2 * sizeof(uint32_t);
+		for (int j = changedStart; j < i; ++j) {
+			const uint8_t *a = (const uint8_t *)&base[j];
+			const uint8_t *b = (const uint8_t *)&voxels[j];
+			uint8_t delta[sizeof(voxel::Voxel)];
+			for (size_t n = 0; n < sizeof(delta); ++n) {
+				delta[n] = a[n] ^ b[n];
+			}
+			stream.write(delta, sizeof(delta));
+		}
+		size += (int64_t)(i - changedStart) * (int64_t)sizeof(voxel::Voxel);
+		if (size > maxSize) {
+			return false;
+		}
+	} while (i < voxelCount);
+	return true;
+}
+
+static bool applyDelta(const uint8_t *buf, size_t size, voxel::Voxel *voxels, int voxelCount) {
+	io::MemoryReadStream stream(buf, size);
+	int pos = 0;
+	while (!stream.eos()) {
+		uint32_t unchanged;
+		uint32_t changed;
+		if (stream.readUInt32(unchanged) == -1 || stream.readUInt32(changed) == -1) {
+			Log::error("Failed to read the memento delta");
+			return false;
+		}
+		pos += (int)unchanged;
+		if (pos + (int)changed > voxelCount) {
+			Log::error("Memento delta exceeds the volume");
+			return false;
+		}
+		for (uint32_t j = 0; j < changed; ++j, ++pos) {
+			uint8_t delta[sizeof(voxel::Voxel)];
+			if (stream.read(delta, sizeof(delta)) == -1) {
+				Log::error("Failed to read the memento delta voxels");
+				return false;
+			}
+			uint8_t *v = (uint8_t *)&voxels[pos];
+			for (size_t n = 0; n < sizeof(delta); ++n) {
+				v[n] ^= delta[n];
+			}
+		}
+	}
+	return true;
 }
 
-bool MementoData::toVolume(voxel::RawVolume* volume, const MementoData& mementoData) {
+/**
+ * @brief Writes only the voxels that differ from the given voxels of the same region into the volume
+ * @return The bounding box of the changed voxels
+ */
+static voxel::Region applyChangedVoxels(voxel::RawVolume *volume, const voxel::Voxel *voxels) {
+	const voxel::Region &region = volume->region();
+	const voxel::Voxel *current = (const voxel::Voxel *)volume->data();
+	const glm::ivec3 &lower = region.getLowerCorner();
+	const glm::ivec3 &dim = region.getDimensionsInVoxels();
+	voxel::Region modifiedRegion = voxel::Region::InvalidRegion;
+	for (int z = 0; z < dim.z; ++z) {
+		for (int y = 0; y < dim.y; ++y) {
+			const size_t row = ((size_t)z * dim.y + y) * dim.x;
+			if (core_memcmp(&current[row], &voxels[row], dim.x * sizeof(voxel::Voxel)) == 0) {
+				continue;
+			}
+			for (int x = 0; x < dim.x; ++x) {
+				if (core_memcmp(&current[row + x], &voxels[row + x], sizeof(voxel::Voxel)) == 0) {
+					continue;
+				}
+				const glm::ivec3 pos = lower + glm::ivec3(x, y, z);
+				volume->setVoxel(pos, voxels[row + x]);
+				if (modifiedRegion.isValid()) {
+					modifiedRegion.accumulate(pos);
+				} else {
+					modifiedRegion = voxel::Region(pos, pos);
+				}
+			}
+		}
+	}
+	return modifiedRegion;
+}
+
+MementoData MementoData::resolveDelta(const MementoData &delta, const voxel::RawVolume &volume) {
+	const voxel::Region &region = delta.region();
+	if (!delta.isDelta() || delta._buffer == nullptr || volume.region() != region) {
+		Log::error("The memento delta doesn't match the volume");
+		return MementoData();
+	}
+	const size_t voxelsSize = region.voxels() * sizeof(voxel::Voxel);
+	voxel::Voxel *voxels = (voxel::Voxel *)core_malloc(voxelsSize);
+	core_memcpy(voxels, volume.data(), voxelsSize);
+	if (!applyDelta(delta._buffer, delta._compressedSize, voxels, region.voxels())) {
+		core_free(voxels);
+		return MementoData();
+	}
+	MementoData resolved((uint8_t *)voxels, voxelsSize, region);
+	resolved._uncompressed = true;
+	return resolved;
+}
+
+bool MementoData::toVolume(voxel::RawVolume* volume, const MementoData& mementoData, voxel::Region* modifiedRegion) {
 	if (mementoData._buffer == nullptr) {
 		return false;
 	}
@@ -134,31 +315,55 @@ bool MementoData::toVolume(voxel::RawVolume* volume, const MementoData& mementoD
 	if (volume == nullptr) {
 		return false;
 	}
-	const size_t uncompressedBufferSize = mementoData.region().voxels() * sizeof(voxel::Voxel);
-	io::MemoryReadStream dataStream(mementoData._buffer, mementoData._compressedSize);
-	io::ZipReadStream stream(dataStream, (int)dataStream.size());
-	uint8_t *uncompressedBuf = (uint8_t*)core_malloc(uncompressedBufferSize);
-	if (stream.read(uncompressedBuf, uncompressedBufferSize) == -1) {
-		core_free(uncompressedBuf);
+	if (mementoData.isDelta() || mementoData.pending()) {
+		Log::error("The memento data must get resolved by the memento handler");
 		return false;
 	}
-	core::ScopedPtr<voxel::RawVolume> v(voxel::RawVolume::createRaw((voxel::Voxel*)uncompressedBuf, mementoData.region()));
-	voxelutil::copyIntoRegion(*v, *volume, mementoData.region());
+	const voxel::Region &region = mementoData.region();
+	uint8_t *uncompressedBuf = nullptr;
+	if (!mementoData._uncompressed) {
+		const size_t uncompressedBufferSize = region.voxels() * sizeof(voxel::Voxel);
+		uncompressedBuf = (uint8_t*)core_malloc(uncompressedBufferSize);
+		if (!uncompressVoxels(mementoData._buffer, mementoData._compressedSize, uncompressedBuf, uncompressedBufferSize)) {
+			core_free(uncompressedBuf);
+			return false;
+		}
+	}
+	voxel::Region changed = region;
+	if (volume->region() == region) {
+		// only the changed voxels are written - the caller only has to re-extract their region
+		const voxel::Voxel *voxels = (const voxel::Voxel *)(uncompressedBuf != nullptr ? uncompressedBuf : mementoData._buffer);
+		changed = applyChangedVoxels(volume, voxels);
+		core_free(uncompressedBuf);
+	} else if (uncompressedBuf != nullptr) {
+		core::ScopedPtr<voxel::RawVolume> v(voxel::RawVolume::createRaw((voxel::Voxel*)uncompressedBuf, region));
+		voxelutil::copyIntoRegion(*v, *volume, region);
+	} else {
+		core::ScopedPtr<voxel::RawVolume> v(voxel::RawVolume::createRaw((const voxel::Voxel*)mementoData._buffer, region));
+		voxelutil::copyIntoRegion(*v, *volume, region);
+	}
+	if (modifiedRegion != nullptr) {
+		*modifiedRegion = changed;
+	}
 	return true;
 }
 
-MementoHandler::MementoHandler() {
+MementoHandler::MementoHandler() : _threadPool(1, "Memento") {
 }
 
 MementoHandler::~MementoHandler() {
 }
 
 bool MementoHandler::init() {
+	_maxMemory = core::Var::get(cfg::VoxEditUndoMemory, "512", "The memory in MB the undo states may occupy before they are moved into a temporary file - 0 disables the limit");
+	_compressionLevel = core::Var::get(cfg::VoxEditUndoCompression, "1", "The compression level (1-9) of the undo states - 1 is the fastest");
+	_threadPool.init();
 	return true;
 }
 
 void MementoHandler::shutdown() {
 	clearStates();
+	_threadPool.shutdown(true);
 }
 
 void MementoHandler::lock() {
@@ -193,14 +398,25 @@ void MementoHandler::printState(const MementoState &state) const {
 	if (state.palette.hasValue()) {
 		palHash = core::string::toString(state.palette.value()->hash());
 	}
+	const char *volumeInfo = "empty";
+	if (state.data.pending()) {
+		volumeInfo = "pending";
+	} else if (state.data.spilled()) {
+		volumeInfo = "spilled";
+	} else if (state.data.isDelta()) {
+		volumeInfo = "delta";
+	} else if (state.data._buffer != nullptr) {
+		volumeInfo = "volume";
+	}
 	Log::info("%s: node id: %i (parent: %i) (frame %i) - %s (%s) [mins(%i:%i:%i)/maxs(%i:%i:%i)] (size: %ib) (palette: %s [hash: %s])",
-			typeToString(state.type), state.nodeId, state.parentId, state.keyFrameIdx, state.name.c_str(), state.data._buffer == nullptr ? "empty" : "volume",
+			typeToString(state.type), state.nodeId, state.parentId, state.keyFrameIdx, state.name.c_str(), volumeInfo,
 					mins.x, mins.y, mins.z, maxs.x, maxs.y, maxs.z, (int)state.data.size(), state.palette.hasValue() ? "true" : "false", palHash.c_str());
 
 }
 
 void MementoHandler::print() const {
 	Log::info("Current memento state index: %i", _statePosition);
+	Log::info("Memory usage: %s (spilled: %s)", core::string::humanSize(memoryUsage()).c_str(), core::string::humanSize(_spillFileSize).c_str());
 
 	for (const MementoState& state : _states) {
 		printState(state);
@@ -214,8 +430,322 @@ void MementoHandler::construct() {
 }
 
 void MementoHandler::clearStates() {
+	// the ring buffer doesn't destroy the elements
+	for (MementoState &state : _states) {
+		state = MementoState();
+	}
 	_states.clear();
 	_statePosition = 0u;
+	_journalPosition = 0;
+	resetCache();
+	closeSpillFile();
+}
+
+size_t MementoHandler::memoryUsage() const {
+	size_t memory = _cache ? _cache->size : 0u;
+	for (const MementoState &state : _states) {
+		if (state.data._buffer != nullptr) {
+			memory += state.data.size();
+		}
+	}
+	return memory;
+}
+
+void MementoHandler::resetCache() {
+	_cache = nullptr;
+	_cacheIndex = -1;
+}
+
+void MementoHandler::updateCache(MementoType type, const core::SharedPtr<MementoSnapshot> &snapshot) {
+	if (!snapshot || (type != MementoType::Modification && type != MementoType::SceneNodeAdded)) {
+		return;
+	}
+	_cache = snapshot;
+	_cacheIndex = _statePosition;
+}
+
+void MementoHandler::finishPending(MementoData &data, bool wait) {
+	if (!data.pending()) {
+		return;
+	}
+	std::future<MementoData> &future = data._job->future;
+	if (!wait && future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+		return;
+	}
+	core_trace_scoped(MementoFinishPending);
+	data = future.get();
+}
+
+void MementoHandler::finishPendingStates(bool wait) {
+	for (MementoState &state : _states) {
+		finishPending(state.data, wait);
+	}
+}
+
+void MementoHandler::waitForPendingStates() {
+	finishPendingStates(true);
+	enforceMemoryBudget();
+}
+
+void MementoHandler::setJournal(MementoJournal *journal) {
+	_journal = journal;
+	_journalPosition = (int)_states.size();
+}
+
+void MementoHandler::updateJournal(bool wait) {
+	journalStates(wait);
+}
+
+void MementoHandler::journalStates(bool wait) {
+	if (_journal == nullptr) {
+		return;
+	}
+	if (!_journal->active()) {
+		_journalPosition = (int)_states.size();
+		return;
+	}
+	core_trace_scoped(MementoJournalStates);
+	for (; _journalPosition < (int)_states.size(); ++_journalPosition) {
+		MementoState &s = _states[_journalPosition];
+		finishPending(s.data, wait);
+		if (s.data.pending()) {
+			break;
+		}
+		// the journal can't read the spill file - but deltas are resolved on replay
+		const bool appended = s.data.spilled() ? _journal->append(resolvedState(_journalPosition)) : _journal->append(s);
+		if (!appended) {
+			_journalPosition = (int)_states.size();
+			break;
+		}
+	}
+}
+
+void MementoHandler::closeSpillFile() {
+	if (_spillFile != nullptr) {
+		SDL_RWclose(_spillFile);
+		_spillFile = nullptr;
+		io::filesystem()->removeFile(_spillFilePath);
+	}
+	_spillFilePath = "";
+	_spillFileSize = 0;
+}
+
+bool MementoHandler::spillData(MementoData &data) {
+	if (_spillFile == nullptr) {
+		if (!_spillFilePath.empty()) {
+			// we already failed to open the file
+			return false;
+		}
+		_spillFilePath = io::filesystem()->writePath(
+			core::string::format("memento-%" PRIu64 ".tmp", (uint64_t)SDL_GetPerformanceCounter()).c_str());
+		_spillFile = SDL_RWFromFile(_spillFilePath.c_str(), "w+b");
+		if (_spillFile == nullptr) {
+			Log::warn("Failed to open the undo spill file %s: %s", _spillFilePath.c_str(), SDL_GetError());
+			return false;
+		}
+		_spillFileSize = 0;
+	}
+	if (SDL_RWseek(_spillFile, _spillFileSize, RW_SEEK_SET) == -1 ||
+		SDL_RWwrite(_spillFile, data._buffer, data._compressedSize, 1) != 1) {
+		Log::warn("Failed to write into the undo spill file %s: %s", _spillFilePath.c_str(), SDL_GetError());
+		return false;
+	}
+	data._spillOffset = _spillFileSize;
+	_spillFileSize += (int64_t)data._compressedSize;
+	core_free(data._buffer);
+	data._buffer = nullptr;
+	return true;
+}
+
+bool MementoHandler::loadSpilledData(const MementoData &data, uint8_t *buf) {
+	core_assert(data.spilled());
+	if (_spillFile == nullptr) {
+		return false;
+	}
+	if (SDL_RWseek(_spillFile, data._spillOffset, RW_SEEK_SET) == -1 ||
+		SDL_RWread(_spillFile, buf, data._compressedSize, 1) != 1) {
+		Log::error("Failed to read from the undo spill file %s: %s", _spillFilePath.c_str(), SDL_GetError());
+		return false;
+	}
+	return true;
+}
+
+int MementoHandler::baseStateIndex(int nodeId, int idx) const {
+	for (int i = idx - 1; i >= 0; --i) {
+		const MementoState &prevS = _states[i];
+		if ((prevS.type == MementoType::Modification || prevS.type == MementoType::SceneNodeAdded) &&
+			prevS.nodeId == nodeId && prevS.hasVolumeData()) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+voxel::Voxel *MementoHandler::decodeVoxels(int idx) {
+	MementoState &s = _states[idx];
+	const int voxelCount = s.data.region().voxels();
+	const size_t voxelsSize = voxelCount * sizeof(voxel::Voxel);
+	voxel::Voxel *voxels;
+	if (idx == _cacheIndex && _cache && voxelsSize == _cache->size) {
+		voxels = (voxel::Voxel *)core_malloc(voxelsSize);
+		core_memcpy(voxels, _cache->voxels, voxelsSize);
+		return voxels;
+	}
+	finishPending(s.data);
+	const MementoData &data = s.data;
+	if (data.isDelta()) {
+		const int baseIdx = baseStateIndex(s.nodeId, idx);
+		if (baseIdx == -1) {
+			Log::error("Could not find the base state for the memento delta of node %i", s.nodeId);
+			return nullptr;
+		}
+		voxels = decodeVoxels(baseIdx);
+		if (voxels == nullptr) {
+			return nullptr;
+		}
+	} else {
+		voxels = (voxel::Voxel *)core_malloc(voxelsSize);
+	}
+
+	const uint8_t *buf = data._buffer;
+	uint8_t *spilledBuf = nullptr;
+	if (data.spilled()) {
+		spilledBuf = (uint8_t *)core_malloc(data._compressedSize);
+		if (!loadSpilledData(data, spilledBuf)) {
+			core_free(spilledBuf);
+			core_free(voxels);
+			return nullptr;
+		}
+		buf = spilledBuf;
+	}
+	bool success;
+	if (data.isDelta()) {
+		success = applyDelta(buf, data._compressedSize, voxels, voxelCount);
+	} else {
+		success = uncompressVoxels(buf, data._compressedSize, (uint8_t *)voxels, voxelsSize);
+	}
+	core_free(spilledBuf);
+	if (!success) {
+		core_free(voxels);
+		return nullptr;
+	}
+	return voxels;
+}
+
+MementoData MementoHandler::resolvedData(int idx) {
+	finishPending(_states[idx].data);
+	const MementoData &data = _states[idx].data;
+	if (!data.isDelta() && !data.spilled()) {
+		return data;
+	}
+	if (!data.isDelta()) {
+		uint8_t *buf = (uint8_t *)core_malloc(data._compressedSize);
+		if (!loadSpilledData(data, buf)) {
+			core_free(buf);
+			return MementoData();
+		}
+		return MementoData(buf, data._compressedSize, data.region());
+	}
+	voxel::Voxel *voxels = decodeVoxels(idx);
+	if (voxels == nullptr) {
+		return MementoData();
+	}
+	// the resolved data is only applied to the volume - compressing it again would only cost time
+	MementoData resolved((uint8_t *)voxels, data.region().voxels() * sizeof(voxel::Voxel), data.region());
+	resolved._uncompressed = true;
+	return resolved;
+}
+
+MementoState MementoHandler::resolvedState(int idx) {
+	// only wait for the compression of this state
+	finishPending(_states[idx].data);
+	MementoState state = _states[idx];
+	if (state.data.isDelta() || state.data.spilled()) {
+		state.data = resolvedData(idx);
+	}
+	return state;
+}
+
+void MementoHandler::eraseFront(size_t n) {
+	journalStates(true);
+	for (size_t i = 0; i < n && !_states.empty(); ++i) {
+		const MementoState &front = _states[0];
+		// the next delta of this node would lose its base - store it as full state
+		for (int j = 1; j < (int)_states.size(); ++j) {
+			MementoState &s = _states[j];
+			if (s.nodeId != front.nodeId || baseStateIndex(s.nodeId, j) != 0) {
+				continue;
+			}
+			if (s.data.isDelta()) {
+				const MementoData &resolved = resolvedData(j);
+				if (resolved._buffer != nullptr) {
+					s.data = MementoData::compressVoxels(resolved._buffer, resolved.size(), resolved.region(),
+														 _compressionLevel->intVal());
+				} else {
+					s.data = MementoData();
+				}
+			}
+			break;
+		}
+		_states[0] = MementoState();
+		_states.erase_front(1);
+		if (_statePosition > 0u) {
+			--_statePosition;
+		}
+		if (_cacheIndex != -1) {
+			--_cacheIndex;
+		}
+		if (_journalPosition > 0) {
+			--_journalPosition;
+		}
+	}
+	if (_cacheIndex < 0) {
+		resetCache();
+	}
+}
+
+void MementoHandler::eraseBack(size_t n) {
+	if (n == 0u) {
+		return;
+	}
+	const size_t remaining = _states.size() - n;
+	for (size_t i = remaining; i < _states.size(); ++i) {
+		_states[i] = MementoState();
+	}
+	_states.erase_back(n);
+	if (_cacheIndex >= (int)remaining) {
+		resetCache();
+	}
+	if (_journalPosition > (int)remaining) {
+		_journalPosition = (int)remaining;
+	}
+}
+
+void MementoHandler::enforceMemoryBudget() {
+	const size_t maxMemory = (size_t)core_max(0, _maxMemory->intVal()) * 1024u * 1024u;
+	if (maxMemory == 0u) {
+		return;
+	}
+	finishPendingStates(false);
+	size_t memory = memoryUsage();
+	// the current state stays in memory
+	for (int i = 0; memory > maxMemory && i < (int)_states.size() - 1; ++i) {
+		MementoData &data = _states[i].data;
+		if (data._buffer == nullptr || data.pending()) {
+			continue;
+		}
+		const size_t size = data.size();
+		if (!spillData(data)) {
+			break;
+		}
+		memory -= size;
+	}
+	// drop the oldest states if they could not get spilled
+	while (memory > maxMemory && _states.size() > 1 && _states[0].data._buffer != nullptr) {
+		Log::debug("Drop the oldest undo state - memory budget exceeded");
+		eraseFront(1);
+		memory = memoryUsage();
+	}
 }
 
 MementoState MementoHandler::undoModification(const MementoState &s) {
@@ -230,12 +760,12 @@ MementoState MementoHandler::undoModification(const MementoState &s) {
 			voxel::logRegion("Undo current data", s.data.region());
 			voxel::logRegion("Undo previous data", prevS.data.region());
 			// use the region from the current state - but the volume from the previous state of this node
-			return MementoState{s.type,		prevS.data, s.parentId, s.nodeId,	   s.referenceId, s.name,
+			return MementoState{s.type,		resolvedData(i), s.parentId, s.nodeId,	   s.referenceId, s.name,
 								s.nodeType, s.region,	s.pivot,	s.worldMatrix, s.keyFrameIdx};
 		}
 	}
 	core_assert(_states[0].type == MementoType::Modification);
-	return _states[0];
+	return resolvedState(0);
 }
 
 MementoState MementoHandler::undoTransform(const MementoState &s) {
@@ -248,7 +778,7 @@ MementoState MementoHandler::undoTransform(const MementoState &s) {
 								s.nodeType, s.region, s.pivot,	  prevS.worldMatrix, s.keyFrameIdx, s.palette};
 		}
 	}
-	return _states[0];
+	return resolvedState(0);
 }
 
 MementoState MementoHandler::undoPaletteChange(const MementoState &s) {
@@ -259,7 +789,7 @@ MementoState MementoHandler::undoPaletteChange(const MementoState &s) {
 								s.nodeType, s.region, s.pivot,	  s.worldMatrix, s.keyFrameIdx, prevS.palette};
 		}
 	}
-	return _states[0];
+	return resolvedState(0);
 }
 
 MementoState MementoHandler::undoNodeProperties(const MementoState &s) {
@@ -270,7 +800,7 @@ MementoState MementoHandler::undoNodeProperties(const MementoState &s) {
 								s.nodeType, s.region, s.pivot,	  s.keyFrames, s.palette,	  prevS.properties};
 		}
 	}
-	return _states[0];
+	return resolvedState(0);
 }
 
 MementoState MementoHandler::undoKeyFrames(const MementoState &s) {
@@ -281,7 +811,7 @@ MementoState MementoHandler::undoKeyFrames(const MementoState &s) {
 								s.nodeType, s.region, s.pivot,	  prevS.keyFrames, s.palette};
 		}
 	}
-	return _states[0];
+	return resolvedState(0);
 }
 
 MementoState MementoHandler::undoRename(const MementoState &s) {
@@ -292,15 +822,17 @@ MementoState MementoHandler::undoRename(const MementoState &s) {
 								s.nodeType, s.region, s.pivot,	  s.worldMatrix, s.keyFrameIdx, s.palette};
 		}
 	}
-	return _states[0];
+	return resolvedState(0);
 }
 
 MementoState MementoHandler::undo() {
 	if (!canUndo()) {
 		return InvalidMementoState;
 	}
+	// the journal must contain the states in the order they were applied
+	journalStates(true);
 	Log::debug("Available states: %i, current index: %i", (int)_states.size(), _statePosition);
-	const MementoState& s = state();
+	const MementoState s = resolvedState(_statePosition);
 	--_statePosition;
 	if (s.type == MementoType::Modification) {
 		return undoModification(s);
@@ -322,9 +854,10 @@ MementoState MementoHandler::redo() {
 	if (!canRedo()) {
 		return InvalidMementoState;
 	}
+	journalStates(true);
 	++_statePosition;
 	Log::debug("Available states: %i, current index: %i", (int)_states.size(), _statePosition);
-	return state();
+	return resolvedState(_statePosition);
 }
 
 void MementoHandler::updateNodeId(int nodeId, int newNodeId) {
@@ -471,11 +1004,67 @@ bool MementoHandler::markUndoPreamble(int nodeId) {
 		// every other state that follows the new one (everything after
 		// the current state position)
 		const size_t n = _states.size() - (_statePosition + 1);
-		_states.erase_back(n);
+		eraseBack(n);
+	}
+	if (_states.size() == _states.capacity()) {
+		// the ring buffer would overwrite the oldest state
+		eraseFront(1);
 	}
 	return true;
 }
 
+MementoData MementoHandler::createData(int nodeId, const voxel::RawVolume *volume, MementoType type,
+										core::SharedPtr<MementoSnapshot> &snapshot) {
+	if (volume == nullptr) {
+		return MementoData();
+	}
+	core_trace_scoped(MementoCreateData);
+	const int compressionLevel = glm::clamp(_compressionLevel->intVal(), 1, 9);
+	const voxel::Region &region = volume->region();
+	snapshot = core::make_shared<MementoSnapshot>(volume);
+
+	core::SharedPtr<MementoSnapshot> base;
+	uint8_t deltaDepth = 0;
+	const int baseIdx = type == MementoType::Modification ? baseStateIndex(nodeId, (int)_states.size()) : -1;
+	if (baseIdx != -1) {
+		const MementoData &baseData = _states[baseIdx].data;
+		if (baseData._deltaDepth < MaxDeltaDepth && baseData.region() == region) {
+			if (baseIdx == _cacheIndex && _cache) {
+				base = _cache;
+			} else if (voxel::Voxel *voxels = decodeVoxels(baseIdx)) {
+				base = core::make_shared<MementoSnapshot>(voxels, snapshot->size);
+			}
+			if (base) {
+				deltaDepth = baseData._deltaDepth + 1;
+			}
+		}
+	}
+
+	// the delta depth is updated once the job is done - the full volume might be smaller than the delta
+	MementoData data;
+	data._region = region;
+	data._deltaDepth = deltaDepth;
+	data._job = core::make_shared<MementoJob>();
+	data._job->future = _threadPool.enqueue([snapshot, base, region, deltaDepth, compressionLevel]() {
+		core_trace_scoped(MementoCompress);
+		const uint8_t *voxels = (const uint8_t *)snapshot->voxels;
+		if (base) {
+			const int voxelCount = region.voxels();
+			// if a lot of voxels were changed, the compressed full volume is smaller
+			const int64_t maxSize = (int64_t)snapshot->size / 8;
+			io::BufferedReadWriteStream outStream;
+			int64_t size = 0;
+			if (encodeDelta(base->voxels, snapshot->voxels, voxelCount, outStream, size, maxSize)) {
+				MementoData delta(outStream.release(), (size_t)size, region);
+				delta._deltaDepth = deltaDepth;
+				return delta;
+			}
+		}
+		return MementoData::compressVoxels(voxels, snapshot->size, region, compressionLevel);
+	});
+	return data;
+}
+
 void MementoHandler::markUndo(int parentId, int nodeId, int referenceId, const core::String &name, scenegraph::SceneGraphNodeType nodeType, const voxel::RawVolume *volume,
 							  MementoType type, const voxel::Region &region, const glm::vec3 &pivot, const glm::mat4 &worldMatrix,
 							  scenegraph::KeyFrameIndex keyFrameIdx, const core::Optional<voxel::Palette> &palette) {
@@ -484,9 +1073,13 @@ void MementoHandler::markUndo(int parentId, int nodeId, int referenceId, const c
 	}
 	Log::debug("New undo state for node %i with name %s (memento state index: %i)", nodeId, name.c_str(), (int)_states.size());
 	voxel::logRegion("MarkUndo", region);
-	const MementoData& data = MementoData::fromVolume(volume, region);
-	MementoState state(type, data, parentId, nodeId, referenceId, name, nodeType, region, pivot, worldMatrix, keyFrameIdx, palette);
+	core::SharedPtr<MementoSnapshot> snapshot;
+	MementoData data = createData(nodeId, volume, type, snapshot);
+	MementoState state(type, core::move(data), parentId, nodeId, referenceId, core::String(name), nodeType,
+					   voxel::Region(region), glm::vec3(pivot), glm::mat4(worldMatrix), keyFrameIdx,
+					   core::Optional<voxel::Palette>(palette));
 	addState(core::move(state));
+	updateCache(type, snapshot);
 }
 
 void MementoHandler::markUndoKeyFrames(int parentId, int nodeId, int referenceId, const core::String &name, scenegraph::SceneGraphNodeType nodeType,
@@ -499,16 +1092,22 @@ void MementoHandler::markUndoKeyFrames(int parentId, int nodeId, int referenceId
 	}
 	Log::debug("New undo state for node %i with name %s (memento state index: %i)", nodeId, name.c_str(), (int)_states.size());
 	voxel::logRegion("MarkUndo", region);
-	const MementoData& data = MementoData::fromVolume(volume, region);
+	core::SharedPtr<MementoSnapshot> snapshot;
+	MementoData data = createData(nodeId, volume, type, snapshot);
 	core::Optional<scenegraph::SceneGraphKeyFramesMap> kf;
 	kf.setValue(keyFrames);
-	MementoState state(type, data, parentId, nodeId, referenceId, name, nodeType, region, pivot, kf, palette, properties);
+	MementoState state(type, core::move(data), parentId, nodeId, referenceId, core::String(name), nodeType,
+					   voxel::Region(region), glm::vec3(pivot), core::move(kf), core::Optional<voxel::Palette>(palette),
+					   core::Optional<scenegraph::SceneGraphNodeProperties>(properties));
 	addState(core::move(state));
+	updateCache(type, snapshot);
 }
 
 void MementoHandler::addState(MementoState &&state) {
-	_states.emplace_back(state);
+	core_memory_scope(Memento);
+	_states.emplace_back(core::move(state));
 	_statePosition = stateSize() - 1;
+	enforceMemoryBudget();
 }
 
 }
@@ -5,21 +5,30 @@
 #pragma once
 
 #include "core/IComponent.h"
+#include "core/Var.h"
 #include "voxel/Palette.h"
 #include "voxel/Region.h"
 #include "voxel/Voxel.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "core/collection/RingBuffer.h"
+#include "core/concurrent/ThreadPool.h"
+#include "core/SharedPtr.h"
 #include "core/String.h"
 #include <stdint.h>
 #include <stddef.h>
 
+struct SDL_RWops;
+
 namespace voxel {
 class RawVolume;
 }
 
 namespace voxedit {
 
+struct MementoJob;
+struct MementoSnapshot;
+class MementoJournal;
+
 enum class MementoType {
 	/**
 	 * voxel volume modifications
@@ -42,11 +51,13 @@ enum class MementoType {
 /**
  * @brief Holds the data of a memento state
  *
- * The given buffer is owned by this class and represents a compressed volume
+ * The given buffer is owned by this class and represents a compressed volume - or the changed voxels
+ * against the previous state of the same node (see @c MementoHandler).
  */
 class MementoData {
 	friend struct MementoState;
 	friend class MementoHandler;
+	friend class MementoJournal;
 private:
 	/**
 	 * @brief How big is the buffer with the compressed volume data
@@ -60,16 +71,38 @@ private:
 	 * The region the given volume data is for
 	 */
 	voxel::Region _region {};
+	/**
+	 * @brief If this is not @c 0 the buffer is a delta against the previous volume state of the same node.
+	 * The value is the amount of deltas that must be applied to the next full state.
+	 */
+	uint8_t _deltaDepth = 0;
+	/**
+	 * @brief The buffer holds the plain voxels - this is only the case for the resolved states that are returned by
+	 * @c MementoHandler::undo() and @c MementoHandler::redo()
+	 */
+	bool _uncompressed = false;
+	/**
+	 * @brief The offset of the buffer in the spill file of the @c MementoHandler - the buffer isn't held
+	 * in memory if this is not @c -1
+	 */
+	int64_t _spillOffset = -1;
+	/**
+	 * @brief The compression of the volume data is still running on the thread pool of the @c MementoHandler
+	 */
+	core::SharedPtr<MementoJob> _job;
 
 	MementoData(const uint8_t* buf, size_t bufSize, const voxel::Region& _region);
 	MementoData(uint8_t* buf, size_t bufSize, const voxel::Region& _region);
 public:
-	constexpr MementoData() {}
+	MementoData();
 	MementoData(MementoData&& o) noexcept;
 	MementoData(const MementoData& o);
 	~MementoData();
 
 	inline size_t size() const { return _compressedSize; }
+	inline bool isDelta() const { return _deltaDepth > 0; }
+	inline bool spilled() const { return _spillOffset != -1; }
+	inline bool pending() const { return (bool)_job; }
 
 	MementoData& operator=(MementoData &&o) noexcept;
 
@@ -79,16 +112,32 @@ public:
 
 	/**
 	 * @brief Converts the given @c mementoData back into a voxels
-	 * @note Inserts the voxels from the memento data into the given volume at the given region.
+	 * @note Inserts the voxels from the memento data into the given volume at the given region. If the volume
+	 * has the region of the memento data, only the voxels that differ are written.
+	 * @note Delta encoded or spilled data must get resolved by the @c MementoHandler first - the states
+	 * that are returned by @c MementoHandler::undo() and @c MementoHandler::redo() are resolved already.
+	 * @param[out] modifiedRegion The bounding box of the voxels that were changed - this is invalid if the volume
+	 * already had the voxels of the memento data
 	 */
-	static bool toVolume(voxel::RawVolume* volume, const MementoData& mementoData);
+	static bool toVolume(voxel::RawVolume* volume, const MementoData& mementoData,
+						 voxel::Region* modifiedRegion = nullptr);
 	/**
 	 * @brief Converts the given volume into a @c MementoData structure (and perform the compression)
 	 * @param[in] volume The volume to create the memento state for. This might be @c null.
 	 * @param[in] region The region of the volume to create the memento data for - if this is not a valid region,
 	 * the whole volume is going to added to the memento data.
+	 * @param[in] compressionLevel The zlib compression level - @c 1 is the fastest
 	 */
-	static MementoData fromVolume(const voxel::RawVolume* volume, const voxel::Region &region);
+	static MementoData fromVolume(const voxel::RawVolume* volume, const voxel::Region &region, int compressionLevel = 6);
+	/**
+	 * @brief Compress the given voxel buffer of the given region
+	 */
+	static MementoData compressVoxels(const uint8_t *voxels, size_t size, const voxel::Region &region, int compressionLevel);
+	/**
+	 * @brief Applies the given delta to the voxels of the given volume - the volume must have the region of the delta
+	 * @return The plain voxels of the new state (see @c toVolume()) - or empty data on error
+	 */
+	static MementoData resolveDelta(const MementoData &delta, const voxel::RawVolume &volume);
 };
 
 struct MementoState {
@@ -128,7 +177,7 @@ struct MementoState {
 				 core::String &&_name, scenegraph::SceneGraphNodeType _nodeType, voxel::Region &&_region,
 				 glm::vec3 &&_pivot, glm::mat4x4 &&_worldMatrix, scenegraph::KeyFrameIndex _keyFrameIdx,
 				 core::Optional<voxel::Palette> &&_palette)
-		: type(_type), data(_data), parentId(_parentId), nodeId(_nodeId), referenceId(_referenceId),
+		: type(_type), data(core::move(_data)), parentId(_parentId), nodeId(_nodeId), referenceId(_referenceId),
 		  nodeType(_nodeType), keyFrameIdx(_keyFrameIdx), name(_name), worldMatrix(_worldMatrix), region(_region), pivot(_pivot),
 		  palette(_palette) {
 	}
@@ -148,7 +197,7 @@ struct MementoState {
 				 glm::vec3 &&_pivot, core::Optional<scenegraph::SceneGraphKeyFramesMap> &&_keyFrames,
 				 core::Optional<voxel::Palette> &&_palette,
 				 core::Optional<scenegraph::SceneGraphNodeProperties> &&_properties)
-		: type(_type), data(_data), parentId(_parentId), nodeId(_nodeId), referenceId(_referenceId),
+		: type(_type), data(core::move(_data)), parentId(_parentId), nodeId(_nodeId), referenceId(_referenceId),
 		  nodeType(_nodeType), keyFrames(_keyFrames), properties(_properties), name(_name), region(_region), pivot(_pivot),
 		  palette(_palette) {
 	}
@@ -161,7 +210,7 @@ struct MementoState {
 	 * Some types (@c MementoType) don't have a volume attached.
 	 */
 	inline bool hasVolumeData() const {
-		return data._buffer != nullptr;
+		return data._buffer != nullptr || data.spilled() || data.pending();
 	}
 
 	inline const voxel::Region& dataRegion() const {
@@ -172,15 +221,86 @@ struct MementoState {
 using MementoStates = core::RingBuffer<MementoState, 64u>;
 /**
  * @brief Class that manages the undo and redo steps for the scene
+ *
+ * The volume modifications are stored as delta against the previous volume state of the same node - only
+ * the changed voxels are kept. If the states need more memory than configured in @c cfg::VoxEditUndoMemory,
+ * the oldest states are moved into a temporary file.
+ *
+ * The volume data is compressed on a worker thread - only a copy of the voxels is made when a state is added.
  */
 class MementoHandler : public core::IComponent {
 private:
+	/**
+	 * @brief After this amount of deltas for a node a full state is stored again
+	 */
+	static constexpr uint8_t MaxDeltaDepth = 16u;
+
 	MementoStates _states;
 	uint8_t _statePosition = 0u;
 	int _locked = 0;
+	core::VarPtr _maxMemory;
+	core::VarPtr _compressionLevel;
+	/**
+	 * @brief The uncompressed voxels of the state at @c _cacheIndex - the base for the delta of the next
+	 * modification of this node
+	 */
+	core::SharedPtr<MementoSnapshot> _cache;
+	int _cacheIndex = -1;
+	core::ThreadPool _threadPool;
+	SDL_RWops *_spillFile = nullptr;
+	core::String _spillFilePath;
+	int64_t _spillFileSize = 0;
+	/**
+	 * @brief If not @c null the states are appended to this journal once their compression is finished
+	 */
+	MementoJournal *_journal = nullptr;
+	/**
+	 * @brief The states before this index are in the journal already
+	 */
+	int _journalPosition = 0;
 
 	void addState(MementoState &&state);
 	bool markUndoPreamble(int nodeId);
+	/**
+	 * @brief Copies the voxels of the given volume and compresses them on the thread pool
+	 * @param[out] snapshot The copy of the voxels
+	 */
+	MementoData createData(int nodeId, const voxel::RawVolume *volume, MementoType type,
+						   core::SharedPtr<MementoSnapshot> &snapshot);
+	/**
+	 * @brief Waits for the compression of the given data if it's still pending
+	 * @param wait If this is @c false, the data is only updated if the compression is finished already
+	 */
+	void finishPending(MementoData &data, bool wait = true);
+	void finishPendingStates(bool wait);
+
+	/**
+	 * @return The index of the state before @c idx that holds the volume of the given node or @c -1
+	 */
+	int baseStateIndex(int nodeId, int idx) const;
+	/**
+	 * @brief Decompress the voxels of the given state - resolves the delta chain and loads spilled data
+	 * @return The voxel buffer that is owned by the caller or @c nullptr on error
+	 */
+	voxel::Voxel *decodeVoxels(int idx);
+	/**
+	 * @return A copy of the given state with full and in-memory volume data
+	 */
+	MementoState resolvedState(int idx);
+	MementoData resolvedData(int idx);
+	bool loadSpilledData(const MementoData &data, uint8_t *buf);
+	bool spillData(MementoData &data);
+	void closeSpillFile();
+	void resetCache();
+	void updateCache(MementoType type, const core::SharedPtr<MementoSnapshot> &snapshot);
+	void eraseFront(size_t n);
+	void eraseBack(size_t n);
+	void enforceMemoryBudget();
+	/**
+	 * @brief Appends the states that are not yet in the journal
+	 * @param wait If this is @c false, the states are only appended up to the first state that is still compressed
+	 */
+	void journalStates(bool wait);
 
 	MementoState undoRename(const MementoState &s);
 	MementoState undoPaletteChange(const MementoState &s);
@@ -268,6 +388,26 @@ public:
 
 	size_t stateSize() const;
 	uint8_t statePosition() const;
+
+	/**
+	 * @return The bytes that the states (and the cache) are occupying in memory - spilled states are not included
+	 */
+	size_t memoryUsage() const;
+	/**
+	 * @brief Block until all states are compressed
+	 */
+	void waitForPendingStates();
+
+	/**
+	 * @brief The states that are added from now on are appended to the given journal - @c null stops this
+	 * @note The states that were applied by undo() or redo() must be appended by the caller
+	 */
+	void setJournal(MementoJournal *journal);
+	/**
+	 * @brief Appends the states to the journal whose compression is finished
+	 * @param wait Wait for the compression of the remaining states and append them, too
+	 */
+	void updateJournal(bool wait = false);
 };
 
 /**
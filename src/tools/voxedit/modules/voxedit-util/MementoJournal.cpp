@@ -0,0 +1,450 @@
+/**
+ * @file
+ */
+
+#include "MementoJournal.h"
+#include "MementoHandler.h"
+#include "app/App.h"
+#include "core/FourCC.h"
+#include "core/Log.h"
+#include "io/BufferedReadWriteStream.h"
+#include "io/FileStream.h"
+#include "io/Filesystem.h"
+#include "io/FilesystemEntry.h"
+#include "io/MemoryReadStream.h"
+#include "scenegraph/SceneGraph.h"
+#include <glm/gtc/type_ptr.hpp>
+
+namespace voxedit {
+
+#define wrap(read)                                                                                                     \
+	if ((read) != 0) {                                                                                                 \
+		Log::debug("Could not load journal entry: Not enough data in stream " CORE_STRINGIFY(read));                  \
+		return false;                                                                                                  \
+	}
+
+#define wrapBool(read)                                                                                                 \
+	if ((read) != true) {                                                                                              \
+		Log::debug("Could not load journal entry: Not enough data in stream " CORE_STRINGIFY(read));                  \
+		return false;                                                                                                  \
+	}
+
+static constexpr uint32_t JournalMagic = FourCC('V', 'J', 'N', 'L');
+static constexpr uint32_t JournalEntryMagic = FourCC('E', 'N', 'T', 'R');
+static constexpr uint32_t JournalVersion = 1u;
+
+enum class JournalData : uint8_t { None, Volume, Delta };
+
+static void collectNodes(const scenegraph::SceneGraph &sceneGraph, int nodeId,
+						 core::DynamicArray<const scenegraph::SceneGraphNode *> &nodes) {
+	const scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	nodes.push_back(&node);
+	for (int childId : node.children()) {
+		collectNodes(sceneGraph, childId, nodes);
+	}
+}
+
+static void collectNodes(const scenegraph::SceneGraph &sceneGraph,
+						 core::DynamicArray<const scenegraph::SceneGraphNode *> &nodes) {
+	nodes.reserve(sceneGraph.nodeSize());
+	collectNodes(sceneGraph, sceneGraph.root().id(), nodes);
+}
+
+MementoJournal::MementoJournal() : _threadPool(1, "MementoJournal") {
+}
+
+bool MementoJournal::init() {
+	_threadPool.init();
+	return true;
+}
+
+void MementoJournal::shutdown() {
+	waitForPendingWrites();
+	_threadPool.shutdown(true);
+	_file = {};
+}
+
+core::String MementoJournal::journalPath(const core::String &sceneFile) {
+	return sceneFile + ".journal";
+}
+
+bool MementoJournal::start(const core::String &sceneFile, const scenegraph::SceneGraph &sceneGraph) {
+	stop();
+	core_trace_scoped(MementoJournalStart);
+	io::FilesystemEntry entry;
+	if (!io::Filesystem::stat(sceneFile, entry)) {
+		Log::warn("Can't start the journal - failed to stat %s", sceneFile.c_str());
+		return false;
+	}
+	core::DynamicArray<const scenegraph::SceneGraphNode *> nodes;
+	collectNodes(sceneGraph, nodes);
+
+	io::BufferedReadWriteStream stream(64 + nodes.size());
+	stream.writeUInt32(JournalMagic);
+	stream.writeUInt32(JournalVersion);
+	stream.writeUInt64(entry.size);
+	stream.writeUInt64(entry.mtime);
+	stream.writeUInt32((uint32_t)nodes.size());
+	for (size_t i = 0; i < nodes.size(); ++i) {
+		stream.writeUInt8((uint8_t)nodes[i]->type());
+		_nodeIndices.put(nodes[i]->id(), (uint32_t)i);
+	}
+
+	const core::String &path = journalPath(sceneFile);
+	io::FilePtr file = io::filesystem()->open(path, io::FileMode::SysWrite);
+	if (!file->validHandle() || file->write(stream.getBuffer(), stream.size()) != (long)stream.size() || !file->sync()) {
+		Log::warn("Failed to write the journal %s", path.c_str());
+		_nodeIndices.clear();
+		file->close();
+		io::filesystem()->removeFile(path);
+		return false;
+	}
+	_file = file;
+	_path = path;
+	Log::debug("Started the journal %s", path.c_str());
+	return true;
+}
+
+void MementoJournal::stop() {
+	waitForPendingWrites();
+	_nodeIndices.clear();
+	_writeFailed = false;
+	if (!_file) {
+		return;
+	}
+	_file->close();
+	_file = {};
+	io::filesystem()->removeFile(_path);
+	Log::debug("Removed the journal %s", _path.c_str());
+	_path.clear();
+}
+
+bool MementoJournal::writeState(const MementoState &state, uint32_t nodeIndex, io::WriteStream &stream) const {
+	wrapBool(stream.writeUInt8((uint8_t)state.type))
+	wrapBool(stream.writeUInt32(nodeIndex))
+	wrapBool(stream.writePascalStringUInt16LE(state.name))
+
+	const MementoData &data = state.data;
+	MementoData compressed;
+	const MementoData *volumeData = &data;
+	if (data._buffer != nullptr && data._uncompressed) {
+		// the resolved states of undo() and redo() hold the plain voxels
+		compressed = MementoData::compressVoxels(data._buffer, data.size(), data.region(), 1);
+		volumeData = &compressed;
+	}
+	if (volumeData->_buffer == nullptr) {
+		wrapBool(stream.writeUInt8((uint8_t)JournalData::None))
+	} else {
+		wrapBool(stream.writeUInt8((uint8_t)(volumeData->isDelta() ? JournalData::Delta : JournalData::Volume)))
+		const voxel::Region &region = volumeData->region();
+		const glm::ivec3 &mins = region.getLowerCorner();
+		const glm::ivec3 &maxs = region.getUpperCorner();
+		for (int i = 0; i < 3; ++i) {
+			wrapBool(stream.writeInt32(mins[i]))
+		}
+		for (int i = 0; i < 3; ++i) {
+			wrapBool(stream.writeInt32(maxs[i]))
+		}
+		wrapBool(stream.writeUInt32((uint32_t)volumeData->size()))
+		if (stream.write(volumeData->_buffer, volumeData->size()) != (int)volumeData->size()) {
+			return false;
+		}
+	}
+
+	wrapBool(stream.writeBool(state.region.isValid()))
+	if (state.region.isValid()) {
+		const glm::ivec3 &mins = state.region.getLowerCorner();
+		const glm::ivec3 &maxs = state.region.getUpperCorner();
+		for (int i = 0; i < 3; ++i) {
+			wrapBool(stream.writeInt32(mins[i]))
+		}
+		for (int i = 0; i < 3; ++i) {
+			wrapBool(stream.writeInt32(maxs[i]))
+		}
+	}
+
+	wrapBool(stream.writeBool(state.palette.hasValue()))
+	if (state.palette.hasValue()) {
+		const voxel::Palette &palette = *state.palette.value();
+		wrapBool(stream.writeUInt32(palette.colorCount()))
+		for (int i = 0; i < palette.colorCount(); ++i) {
+			wrapBool(stream.writeUInt32(palette.color(i).rgba))
+		}
+		for (int i = 0; i < palette.colorCount(); ++i) {
+			wrapBool(stream.writeUInt32(palette.glowColor(i).rgba))
+		}
+	}
+
+	wrapBool(stream.writeInt32(state.keyFrameIdx))
+	const float *worldMatrix = glm::value_ptr(state.worldMatrix);
+	for (int i = 0; i < 16; ++i) {
+		wrapBool(stream.writeFloat(worldMatrix[i]))
+	}
+	for (int i = 0; i < 3; ++i) {
+		wrapBool(stream.writeFloat(state.pivot[i]))
+	}
+
+	wrapBool(stream.writeBool(state.properties.hasValue()))
+	if (state.properties.hasValue()) {
+		const scenegraph::SceneGraphNodeProperties &properties = *state.properties.value();
+		wrapBool(stream.writeUInt32(properties.size()))
+		for (const auto &e : properties) {
+			wrapBool(stream.writePascalStringUInt16LE(e->key))
+			wrapBool(stream.writePascalStringUInt16LE(e->value))
+		}
+	}
+	return true;
+}
+
+static bool readRegion(io::ReadStream &stream, voxel::Region &region) {
+	glm::ivec3 mins;
+	glm::ivec3 maxs;
+	for (int i = 0; i < 3; ++i) {
+		wrap(stream.readInt32(mins[i]))
+	}
+	for (int i = 0; i < 3; ++i) {
+		wrap(stream.readInt32(maxs[i]))
+	}
+	region = voxel::Region(mins, maxs);
+	return true;
+}
+
+bool MementoJournal::readState(io::ReadStream &stream, MementoState &state, uint32_t &nodeIndex) {
+	uint8_t type;
+	wrap(stream.readUInt8(type))
+	if (type >= (uint8_t)MementoType::Max) {
+		return false;
+	}
+	state.type = (MementoType)type;
+	wrap(stream.readUInt32(nodeIndex))
+	wrapBool(stream.readPascalStringUInt16LE(state.name))
+
+	uint8_t dataType;
+	wrap(stream.readUInt8(dataType))
+	if (dataType != (uint8_t)JournalData::None) {
+		voxel::Region region;
+		if (!readRegion(stream, region) || !region.isValid()) {
+			return false;
+		}
+		uint32_t size;
+		wrap(stream.readUInt32(size))
+		if (size == 0u) {
+			return false;
+		}
+		uint8_t *buf = (uint8_t *)core_malloc(size);
+		if (stream.read(buf, size) != (int)size) {
+			core_free(buf);
+			return false;
+		}
+		state.data = MementoData(buf, size, region);
+		if (dataType == (uint8_t)JournalData::Delta) {
+			state.data._deltaDepth = 1;
+		}
+	}
+
+	uint8_t hasRegion;
+	wrap(stream.readUInt8(hasRegion))
+	if (hasRegion && !readRegion(stream, state.region)) {
+		return false;
+	}
+
+	uint8_t hasPalette;
+	wrap(stream.readUInt8(hasPalette))
+	if (hasPalette) {
+		voxel::Palette palette;
+		uint32_t colorCount;
+		wrap(stream.readUInt32(colorCount))
+		if (colorCount > voxel::PaletteMaxColors) {
+			return false;
+		}
+		palette.setSize((int)colorCount);
+		for (uint32_t i = 0; i < colorCount; ++i) {
+			wrap(stream.readUInt32(palette.color(i).rgba))
+		}
+		for (uint32_t i = 0; i < colorCount; ++i) {
+			wrap(stream.readUInt32(palette.glowColor(i).rgba))
+		}
+		palette.markDirty();
+		state.palette.setValue(palette);
+	}
+
+	wrap(stream.readInt32(state.keyFrameIdx))
+	float *worldMatrix = glm::value_ptr(state.worldMatrix);
+	for (int i = 0; i < 16; ++i) {
+		wrap(stream.readFloat(worldMatrix[i]))
+	}
+	for (int i = 0; i < 3; ++i) {
+		wrap(stream.readFloat(state.pivot[i]))
+	}
+
+	uint8_t hasProperties;
+	wrap(stream.readUInt8(hasProperties))
+	if (hasProperties) {
+		scenegraph::SceneGraphNodeProperties properties;
+		uint32_t propertyCount;
+		wrap(stream.readUInt32(propertyCount))
+		for (uint32_t i = 0; i < propertyCount; ++i) {
+			core::String key, value;
+			wrapBool(stream.readPascalStringUInt16LE(key))
+			wrapBool(stream.readPascalStringUInt16LE(value))
+			properties.put(key, value);
+		}
+		state.properties.setValue(properties);
+	}
+	return true;
+}
+
+bool MementoJournal::append(const MementoState &state) {
+	if (!_file) {
+		return false;
+	}
+	core_trace_scoped(MementoJournalAppend);
+	if (state.data.pending() || state.data.spilled()) {
+		Log::error("The volume data of the journal state must be available");
+		stop();
+		return false;
+	}
+	switch (state.type) {
+	case MementoType::Modification:
+	case MementoType::SceneNodePaletteChanged:
+	case MementoType::SceneNodeRenamed:
+	case MementoType::SceneNodeTransform:
+	case MementoType::SceneNodeProperties:
+		break;
+	default:
+		Log::debug("The journal doesn't support the state type %i - stop it until the next save", (int)state.type);
+		stop();
+		return false;
+	}
+	uint32_t nodeIndex;
+	if (!_nodeIndices.get(state.nodeId, nodeIndex)) {
+		Log::debug("The node %i isn't part of the journal - stop it until the next save", state.nodeId);
+		stop();
+		return false;
+	}
+
+	io::BufferedReadWriteStream payload((int64_t)state.data.size() + 256);
+	if (!writeState(state, nodeIndex, payload)) {
+		Log::warn("Failed to serialize the journal state");
+		stop();
+		return false;
+	}
+	io::BufferedReadWriteStream entry(payload.size() + 8);
+	entry.writeUInt32(JournalEntryMagic);
+	entry.writeUInt32((uint32_t)payload.size());
+	entry.write(payload.getBuffer(), payload.size());
+
+	core::ScopedLock lock(_lock);
+	_pending.append(entry.getBuffer(), entry.size());
+	if (!_writeScheduled) {
+		_writeScheduled = true;
+		_writeFuture = _threadPool.enqueue([this]() { writePending(); });
+	}
+	return true;
+}
+
+void MementoJournal::writePending() {
+	core_trace_scoped(MementoJournalWrite);
+	core::DynamicArray<uint8_t> buffer;
+	for (;;) {
+		{
+			core::ScopedLock lock(_lock);
+			if (_pending.empty()) {
+				_writeScheduled = false;
+				return;
+			}
+			buffer = core::move(_pending);
+		}
+		if (_file->write(buffer.data(), buffer.size()) != (long)buffer.size() || !_file->sync()) {
+			Log::warn("Failed to write the journal %s", _path.c_str());
+			_writeFailed = true;
+		}
+		buffer.clear();
+	}
+}
+
+bool MementoJournal::waitForPendingWrites() {
+	if (_writeFuture.valid()) {
+		_writeFuture.wait();
+	}
+	return !_writeFailed;
+}
+
+bool MementoJournal::load(const core::String &sceneFile, const scenegraph::SceneGraph &sceneGraph,
+						  core::DynamicArray<MementoState> &states) {
+	const core::String &path = journalPath(sceneFile);
+	const io::FilePtr &file = io::filesystem()->open(path, io::FileMode::SysRead);
+	if (!file->exists()) {
+		return false;
+	}
+	core_trace_scoped(MementoJournalLoad);
+	io::FileStream stream(file);
+	if (!stream.valid()) {
+		return false;
+	}
+	uint32_t magic;
+	uint32_t version;
+	uint64_t size;
+	uint64_t mtime;
+	uint32_t nodeCount;
+	if (stream.readUInt32(magic) != 0 || magic != JournalMagic || stream.readUInt32(version) != 0 ||
+		version != JournalVersion || stream.readUInt64(size) != 0 || stream.readUInt64(mtime) != 0 ||
+		stream.readUInt32(nodeCount) != 0) {
+		Log::warn("Invalid journal %s", path.c_str());
+		return false;
+	}
+	io::FilesystemEntry entry;
+	if (!io::Filesystem::stat(sceneFile, entry) || entry.size != size || entry.mtime != mtime) {
+		Log::warn("The journal %s doesn't match the scene file", path.c_str());
+		return false;
+	}
+	core::DynamicArray<const scenegraph::SceneGraphNode *> nodes;
+	collectNodes(sceneGraph, nodes);
+	if (nodes.size() != nodeCount) {
+		Log::warn("The journal %s doesn't match the scene graph", path.c_str());
+		return false;
+	}
+	for (uint32_t i = 0; i < nodeCount; ++i) {
+		uint8_t type;
+		if (stream.readUInt8(type) != 0 || type != (uint8_t)nodes[i]->type()) {
+			Log::warn("The journal %s doesn't match the scene graph", path.c_str());
+			return false;
+		}
+	}
+
+	core::DynamicArray<uint8_t> payload;
+	while (!stream.eos()) {
+		uint32_t entryMagic;
+		uint32_t entrySize;
+		// a crash while writing an entry leaves a truncated or zero filled tail
+		if (stream.readUInt32(entryMagic) != 0 || entryMagic != JournalEntryMagic ||
+			stream.readUInt32(entrySize) != 0 || (int64_t)entrySize > stream.remaining()) {
+			Log::warn("Skip the truncated tail of the journal %s", path.c_str());
+			break;
+		}
+		payload.resize(entrySize);
+		if (stream.read(payload.data(), entrySize) != (int)entrySize) {
+			break;
+		}
+		io::MemoryReadStream entryStream(payload.data(), entrySize);
+		MementoState state;
+		uint32_t nodeIndex;
+		if (!readState(entryStream, state, nodeIndex) || nodeIndex >= nodeCount) {
+			Log::warn("Skip the invalid tail of the journal %s", path.c_str());
+			break;
+		}
+		const scenegraph::SceneGraphNode *node = nodes[nodeIndex];
+		state.nodeId = node->id();
+		state.parentId = node->parent();
+		state.referenceId = node->reference();
+		state.nodeType = node->type();
+		states.emplace_back(core::move(state));
+	}
+	Log::info("Loaded %i states from the journal %s", (int)states.size(), path.c_str());
+	return true;
+}
+
+#undef wrap
+#undef wrapBool
+
+} // namespace voxedit
@@ -0,0 +1,125 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "core/IComponent.h"
+#include "core/String.h"
+#include "core/Trace.h"
+#include "core/collection/DynamicArray.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/Atomic.h"
+#include "core/concurrent/Lock.h"
+#include "core/concurrent/ThreadPool.h"
+#include "io/File.h"
+#include <future>
+
+namespace scenegraph {
+class SceneGraph;
+}
+
+namespace io {
+class ReadStream;
+class WriteStream;
+}
+
+namespace voxedit {
+
+struct MementoState;
+
+/**
+ * @brief Append-only crash recovery journal of the memento states that were applied since the last save
+ *
+ * The journal is a file next to the scene file (see @c journalPath()). The states are appended in the order they
+ * were applied to the scene - the file is written and synced on a worker thread. If voxedit wasn't shut down
+ * cleanly, the journal still exists the next time the scene file is loaded and is replayed on top of it.
+ *
+ * Only states that modify existing nodes can be journaled: the voxels, the palette, the name, the transform and
+ * the properties. The nodes are referenced by their position in the depth first order of the scene graph - the
+ * ids of the nodes differ after the scene file was loaded again. Any other state (e.g. adding or removing nodes)
+ * stops the journal and removes the file. It's started again with the next save.
+ */
+class MementoJournal : public core::IComponent {
+private:
+	io::FilePtr _file;
+	core::String _path;
+	/**
+	 * @brief The position of the nodes in the depth first order of the scene graph the journal was started for
+	 */
+	core::Map<int, uint32_t, 223> _nodeIndices;
+	core::ThreadPool _threadPool;
+	core_trace_mutex(core::Lock, _lock, "MementoJournal");
+	/**
+	 * @brief The serialized states that weren't written yet - guarded by @c _lock
+	 */
+	core::DynamicArray<uint8_t> _pending;
+	/**
+	 * @brief A write job is queued or running - guarded by @c _lock
+	 */
+	bool _writeScheduled = false;
+	std::future<void> _writeFuture;
+	core::AtomicBool _writeFailed{false};
+
+	void writePending();
+	bool writeState(const MementoState &state, uint32_t nodeIndex, io::WriteStream &stream) const;
+	static bool readState(io::ReadStream &stream, MementoState &state, uint32_t &nodeIndex);
+
+public:
+	MementoJournal();
+
+	bool init() override;
+	void shutdown() override;
+
+	/**
+	 * @return The path of the journal of the given scene file
+	 */
+	static core::String journalPath(const core::String &sceneFile);
+
+	/**
+	 * @brief Replaces the journal of the given scene file with an empty one
+	 * @note The scene file must have been written already - the journal is only replayed on top of this version
+	 * of the file
+	 */
+	bool start(const core::String &sceneFile, const scenegraph::SceneGraph &sceneGraph);
+	/**
+	 * @brief Waits for the pending writes and removes the journal file
+	 */
+	void stop();
+	bool active() const;
+
+	/**
+	 * @brief Queues the given state for writing
+	 *
+	 * The volume data of the state must not be pending - but it can be a delta against the previous volume state
+	 * of the node.
+	 * @return @c false if the state can't be journaled - the journal is stopped in this case
+	 */
+	bool append(const MementoState &state);
+	/**
+	 * @brief Blocks until the queued states are written and synced
+	 * @return @c false if any of the writes failed
+	 */
+	bool waitForPendingWrites();
+
+	/**
+	 * @brief Reads the journal of the given scene file
+	 *
+	 * The journal is only accepted if the scene file wasn't modified after the journal was started and if the
+	 * node structure of the given (loaded) scene graph matches. A truncated last state (e.g. after a crash while
+	 * writing it) is skipped.
+	 *
+	 * @param[out] states The states in the order they must get applied. The node ids are those of the given scene
+	 * graph. The volume data is either the compressed full volume or a delta against the current voxels of the node
+	 * (see @c MementoData::resolveDelta()).
+	 * @return @c false if there is no valid journal for the scene file
+	 */
+	static bool load(const core::String &sceneFile, const scenegraph::SceneGraph &sceneGraph,
+					 core::DynamicArray<MementoState> &states);
+};
+
+inline bool MementoJournal::active() const {
+	return _file;
+}
+
+} // namespace voxedit
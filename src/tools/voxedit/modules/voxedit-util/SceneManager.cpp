@@ -7,15 +7,18 @@
 #include "app/App.h"
 #include "command/Command.h"
 #include "command/CommandCompleter.h"
+#include "command/CommandHandler.h"
 #include "core/ArrayLength.h"
 #include "core/Color.h"
 #include "core/GLM.h"
+#include "core/SharedPtr.h"
 #include "core/Log.h"
 #include "core/String.h"
 #include "core/StringUtil.h"
 #include "core/TimeProvider.h"
 #include "core/UTF8.h"
 #include "core/collection/DynamicArray.h"
+#include "core/concurrent/ThreadPool.h"
 #include "io/File.h"
 #include "io/FileStream.h"
 #include "io/Filesystem.h"
@@ -206,8 +209,108 @@ bool SceneManager::importColoredHeightmap(const core::String& file) {
 	return true;
 }
 
+bool SceneManager::isAutoSaving() const {
+	return _autoSaveFuture.valid();
+}
+
+void SceneManager::finishAutoSave(bool wait) {
+	if (!_autoSaveFuture.valid()) {
+		return;
+	}
+	if (!wait) {
+		using namespace std::chrono_literals;
+		if (_autoSaveFuture.wait_for(0ms) != std::future_status::ready) {
+			return;
+		}
+	}
+	const AutoSaveResult &result = _autoSaveFuture.get();
+	_autoSaveFuture = std::future<AutoSaveResult>();
+	if (_autoSaveCancel) {
+		Log::debug("Autosave of %s was cancelled", result.filename.c_str());
+		return;
+	}
+	if (result.saved) {
+		Log::info("Autosave file %s", result.filename.c_str());
+		core::Var::get(cfg::VoxEditLastFile)->setVal(result.filename);
+	} else {
+		Log::warn("Failed to autosave");
+		// try again with the next autosave interval
+		_needAutoSave = true;
+	}
+}
+
+/**
+ * @brief Saves the scene graph - vengi files reuse the compressed voxels of the unchanged model nodes
+ */
+static bool saveScene(const io::FilePtr &filePtr, const io::FileDescription &file, scenegraph::SceneGraph &sceneGraph,
+					  voxelformat::VENGIFormat::NodeDataCache &nodeDataCache, const voxelformat::SaveContext &saveCtx) {
+	if (core::string::extractExtension(filePtr->name()) != "vengi") {
+		return voxelformat::saveFormat(filePtr, &file.desc, sceneGraph, saveCtx);
+	}
+	io::FileStream stream(filePtr);
+	voxelformat::VENGIFormat format;
+	return format.saveIncremental(sceneGraph, filePtr->name(), stream, nodeDataCache, saveCtx);
+}
+
+static bool saveSnapshot(scenegraph::SceneGraph &sceneGraph, const io::FileDescription &file,
+						 voxelformat::VENGIFormat::NodeDataCache &nodeDataCache, const core::AtomicBool &cancel) {
+	// write into a temp file to never leave a half written autosave file behind
+	const core::String &tmpName = core::string::format("%s.tmp.%s", core::string::stripExtension(file.name).c_str(),
+														core::string::extractExtension(file.name).c_str());
+	const io::FilePtr &tmpFile = io::filesystem()->open(tmpName, io::FileMode::SysWrite);
+	if (!tmpFile->validHandle()) {
+		Log::warn("Failed to open the autosave file '%s' for writing", tmpName.c_str());
+		return false;
+	}
+	// the thumbnail can't be rendered outside of the main thread
+	const voxelformat::SaveContext saveCtx;
+	const bool saved = saveScene(tmpFile, file, sceneGraph, nodeDataCache, saveCtx);
+	tmpFile->close();
+	if (!saved || cancel) {
+		io::filesystem()->removeFile(tmpName);
+		return false;
+	}
+	return io::filesystem()->rename(tmpName, file.name);
+}
+
+bool SceneManager::startAutoSave(const io::FileDescription& file) {
+	if (_sceneGraph.empty()) {
+		return false;
+	}
+	// the copy is much cheaper than the serialization - and the scene can be modified while the copy is saved
+	const core::DynamicArray<int> &lazyLoaded = loadLazyVolumes();
+	core::SharedPtr<scenegraph::SceneGraph> snapshot = core::make_shared<scenegraph::SceneGraph>();
+	core::Map<int, int> nodeMapping;
+	scenegraph::copySceneGraph(*snapshot.get(), _sceneGraph, snapshot->root().id(), &nodeMapping);
+	// the cache entries are shared with the snapshot - but the copied nodes have other ids
+	core::SharedPtr<voxelformat::VENGIFormat::NodeDataCache> nodeDataCache =
+		core::make_shared<voxelformat::VENGIFormat::NodeDataCache>();
+	for (const auto &entry : _nodeDataCache) {
+		int snapshotNodeId;
+		if (nodeMapping.get(entry->key, snapshotNodeId)) {
+			nodeDataCache->put(snapshotNodeId, entry->value);
+		}
+	}
+	for (int nodeId : lazyLoaded) {
+		if (!lazyVolumeNeeded(_sceneGraph.node(nodeId))) {
+			unloadLazyVolume(nodeId);
+		}
+	}
+	_autoSaveCancel = false;
+	const core::AtomicBool *cancel = &_autoSaveCancel;
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	_autoSaveFuture = threadPool.enqueue([snapshot, nodeDataCache, file, cancel]() {
+		AutoSaveResult result;
+		result.filename = file.name;
+		result.saved = saveSnapshot(*snapshot.get(), file, *nodeDataCache.get(), *cancel);
+		return result;
+	});
+	return _autoSaveFuture.valid();
+}
+
 void SceneManager::autosave() {
-	if (!_needAutoSave) {
+	finishAutoSave(false);
+	if (!_needAutoSave || isAutoSaving()) {
 		return;
 	}
 	const core::TimeProviderPtr& timeProvider = app::App::getInstance()->timeProvider();
@@ -230,8 +333,8 @@ void SceneManager::autosave() {
 					p.c_str(), f.c_str(), e.c_str()), &_lastFilename.desc);
 		}
 	}
-	if (save(autoSaveFilename, true)) {
-		Log::info("Autosave file %s", autoSaveFilename.c_str());
+	if (startAutoSave(autoSaveFilename)) {
+		_needAutoSave = false;
 	} else {
 		Log::warn("Failed to autosave");
 	}
@@ -253,6 +356,9 @@ bool SceneManager::saveNode(int nodeId, const core::String& file) {
 		Log::warn("Given node is no model node");
 		return false;
 	}
+	if (!loadLazyVolume(nodeId)) {
+		return false;
+	}
 	scenegraph::SceneGraph newSceneGraph;
 	scenegraph::SceneGraphNode newNode;
 	scenegraph::copyNode(*node, newNode, false);
@@ -283,6 +389,26 @@ void SceneManager::fillHollow() {
 	});
 }
 
+void SceneManager::hollow(int shellThickness) {
+	_sceneGraph.foreachGroup([&] (int nodeId) {
+		scenegraph::SceneGraphNode *node = sceneGraphNode(nodeId);
+		if (node == nullptr || node->type() != scenegraph::SceneGraphNodeType::Model) {
+			return;
+		}
+		voxel::RawVolume *v = volume(nodeId);
+		if (v == nullptr) {
+			return;
+		}
+		voxel::RawVolumeWrapper wrapper(v);
+		const int removed = voxelutil::hollow(app::App::getInstance()->threadPool(), wrapper, shellThickness);
+		if (removed == 0) {
+			return;
+		}
+		Log::debug("Removed %i invisible voxels from node %i", removed, nodeId);
+		modified(nodeId, wrapper.dirtyRegion());
+	});
+}
+
 void SceneManager::fillPlane(const image::ImagePtr &image) {
 	const int nodeId = activeNode();
 	if (nodeId == InvalidNodeId) {
@@ -340,12 +466,28 @@ bool SceneManager::save(const io::FileDescription& file, bool autosave) {
 		return false;
 	}
 
+	// all voxels must be in memory for saving
+	const core::DynamicArray<int> &lazyLoaded = loadLazyVolumes();
 	voxelformat::SaveContext saveCtx;
 	saveCtx.thumbnailCreator = voxelrender::volumeThumbnail;
-	if (voxelformat::saveFormat(filePtr, &_lastFilename.desc, _sceneGraph, saveCtx)) {
+	const bool saved = saveScene(filePtr, _lastFilename, _sceneGraph, _nodeDataCache, saveCtx);
+	if (filePtr->name() == _lazyVolumesFile) {
+		// the locations of the voxels in the file are no longer valid
+		_lazyVolumes.clear();
+	} else {
+		for (int nodeId : lazyLoaded) {
+			if (!lazyVolumeNeeded(_sceneGraph.node(nodeId))) {
+				unloadLazyVolume(nodeId);
+			}
+		}
+	}
+	if (saved) {
 		if (!autosave) {
 			_dirty = false;
 			_lastFilename = file;
+			// the journal is only valid for the complete file
+			filePtr->close();
+			startJournal(filePtr->name());
 		}
 		core::Var::get(cfg::VoxEditLastFile)->setVal(filePtr->name());
 		_needAutoSave = false;
@@ -446,15 +588,32 @@ bool SceneManager::load(const io::FileDescription& file) {
 		return false;
 	}
 	core::ThreadPool& threadPool = app::App::getInstance()->threadPool();
-	_loadingFuture = threadPool.enqueue([filePtr] () {
-		scenegraph::SceneGraph newSceneGraph;
+	const bool lazyLoad = _lazyLoad->boolVal() && core::string::extractExtension(filePtr->name()) == "vengi";
+	_loadingFuture = threadPool.enqueue([filePtr, lazyLoad] () {
+		LoadedSceneGraph loaded;
+		loaded.filename = filePtr->name();
 		io::FileStream stream(filePtr);
 		voxelformat::LoadContext loadCtx;
-		voxelformat::loadFormat(filePtr->name(), stream, newSceneGraph, loadCtx);
-		mergeIfNeeded(newSceneGraph);
+		if (lazyLoad) {
+			voxelformat::VENGIFormat format;
+			format.loadVisibleModels(filePtr->name(), stream, loaded.sceneGraph, loaded.lazyNodes, loadCtx);
+			if (loaded.sceneGraph.size() > voxelrender::RawVolumeRenderer::MAX_VOLUMES) {
+				// the nodes are merged - this needs all voxels
+				for (const auto &entry : loaded.lazyNodes) {
+					scenegraph::SceneGraphNode &node = loaded.sceneGraph.node(entry->key);
+					if (voxel::RawVolume *v = voxelformat::VENGIFormat::loadNodeVolume(stream, entry->value, node.palette())) {
+						node.setVolume(v, true);
+					}
+				}
+				loaded.lazyNodes.clear();
+			}
+		} else {
+			voxelformat::loadFormat(filePtr->name(), stream, loaded.sceneGraph, loadCtx);
+		}
+		mergeIfNeeded(loaded.sceneGraph);
 		// TODO: stuff that happens in RawVolumeRenderer::extractRegion and
 		// RawVolumeRenderer::scheduleExtractions should happen here
-		return core::move(newSceneGraph);
+		return core::move(loaded);
 	});
 	_lastFilename.set(filePtr->name(), &file.desc);
 	return true;
@@ -483,9 +642,39 @@ void SceneManager::setMousePos(int x, int y) {
 	_traceViaMouse = true;
 }
 
+template<class MAP>
+static void accumulateRegion(MAP &regions, int nodeId, const voxel::Region &region) {
+	voxel::Region accumulated = region;
+	voxel::Region existing;
+	if (regions.get(nodeId, existing)) {
+		accumulated.accumulate(existing);
+	}
+	regions.put(nodeId, accumulated);
+}
+
 void SceneManager::modified(int nodeId, const voxel::Region& modifiedRegion, bool markUndo, uint64_t renderRegionMillis) {
 	Log::debug("Modified node %i, record undo state: %s", nodeId, markUndo ? "true" : "false");
 	voxel::logRegion("Modified", modifiedRegion);
+	forgetLazyVolume(nodeId);
+	_nodeDataCache.remove(nodeId);
+	// the voxels are in memory again - a modification must not get lost by decompressing old voxels
+	_compressedVolumes.remove(nodeId);
+	_volumeLastUsed.put(nodeId, app::App::getInstance()->timeProvider()->tickSeconds());
+	// the volume might have been modified in place (e.g. translated by a script) - invalidate the cached regions
+	if (_sceneGraph.hasNode(nodeId)) {
+		_sceneGraph.node(nodeId).markDirty();
+	}
+	if (_strokeActive) {
+		// an invalid region marks the whole volume
+		const voxel::Region &region = modifiedRegion.isValid() ? modifiedRegion : _sceneGraph.node(nodeId).region();
+		accumulateRegion(_strokeRenderRegions, nodeId, region);
+		// the modifications without undo state of a stroke (e.g. the first half of a mirrored shape) are part of
+		// the single undo state of the stroke, too
+		accumulateRegion(_strokeUndoRegions, nodeId, region);
+		markDirty();
+		resetLastTrace();
+		return;
+	}
 	if (markUndo) {
 		scenegraph::SceneGraphNode &node = _sceneGraph.node(nodeId);
 		_mementoHandler.markModification(node, modifiedRegion);
@@ -497,6 +686,42 @@ void SceneManager::modified(int nodeId, const voxel::Region& modifiedRegion, boo
 	resetLastTrace();
 }
 
+void SceneManager::beginStroke() {
+	if (_strokeActive) {
+		return;
+	}
+	Log::debug("Begin stroke");
+	_strokeActive = true;
+}
+
+void SceneManager::flushStrokeRenderRegions() {
+	if (_strokeRenderRegions.empty()) {
+		return;
+	}
+	core_trace_scoped(FlushStrokeRenderRegions);
+	for (const auto &entry : _strokeRenderRegions) {
+		if (_sceneGraph.hasNode(entry->key)) {
+			_sceneRenderer.updateNodeRegion(entry->key, entry->value);
+		}
+	}
+	_strokeRenderRegions.clear();
+}
+
+void SceneManager::endStroke() {
+	if (!_strokeActive) {
+		return;
+	}
+	Log::debug("End stroke");
+	_strokeActive = false;
+	flushStrokeRenderRegions();
+	for (const auto &entry : _strokeUndoRegions) {
+		if (_sceneGraph.hasNode(entry->key)) {
+			_mementoHandler.markModification(_sceneGraph.node(entry->key), entry->value);
+		}
+	}
+	_strokeUndoRegions.clear();
+}
+
 void SceneManager::colorToNewNode(const voxel::Voxel voxelColor) {
 	const voxel::Region &region = _sceneGraph.groupRegion();
 	if (!region.isValid()) {
@@ -620,6 +845,7 @@ void SceneManager::resizeAll(const glm::ivec3& size) {
 voxel::RawVolume* SceneManager::volume(int nodeId) {
 	scenegraph::SceneGraphNode* node = sceneGraphNode(nodeId);
 	core_assert_msg(node != nullptr, "Node with id %i wasn't found in the scene graph", nodeId);
+	loadLazyVolume(nodeId);
 	return node->volume();
 }
 
@@ -653,6 +879,13 @@ bool SceneManager::setActivePalette(const voxel::Palette &palette, bool searchBe
 		Log::warn("Failed to set the active palette - node with id %i is no model node", nodeId);
 		return false;
 	}
+	if (_actionRecorder.active()) {
+		Action action;
+		action.type = ActionType::Palette;
+		action.palette.setValue(palette);
+		action.steps = searchBestColors ? 1 : 0;
+		recordAction(action);
+	}
 	if (searchBestColors) {
 		voxel::RawVolume *v = node.volume();
 		voxel::RawVolumeWrapper wrapper(v);
@@ -734,15 +967,21 @@ bool SceneManager::mementoPaletteChange(const MementoState& s) {
 bool SceneManager::mementoModification(const MementoState& s) {
 	Log::debug("Memento: modification in volume of node %i (%s)", s.nodeId, s.name.c_str());
 	if (scenegraph::SceneGraphNode *node = sceneGraphNode(s.nodeId)) {
-		if (node->region() != s.dataRegion()) {
+		const bool newVolume = node->region() != s.dataRegion();
+		if (newVolume) {
 			node->setVolume(new voxel::RawVolume(s.dataRegion()), true);
 		}
-		MementoData::toVolume(node->volume(), s.data);
+		// only the voxels that differ from the current state are written and re-extracted
+		voxel::Region modifiedRegion;
+		MementoData::toVolume(node->volume(), s.data, &modifiedRegion);
+		if (newVolume) {
+			modifiedRegion = s.dataRegion();
+		}
 		node->setName(s.name);
 		if (s.palette.hasValue()) {
 			node->setPalette(*s.palette.value());
 		}
-		modified(node->id(), s.data.region(), false);
+		modified(node->id(), modifiedRegion, false);
 		return true;
 	}
 	Log::warn("Failed to handle memento state - node id %i not found (%s)", s.nodeId, s.name.c_str());
@@ -842,6 +1081,13 @@ bool SceneManager::mementoStateExecute(const MementoState &s, bool isRedo) {
 
 bool SceneManager::undo(int n) {
 	Log::debug("undo %i steps", n);
+	endStroke();
+	if (_actionRecorder.active()) {
+		Action action;
+		action.type = ActionType::Undo;
+		action.steps = n;
+		recordAction(action);
+	}
 	for (int i = 0; i < n; ++i) {
 		if (!doUndo()) {
 			return false;
@@ -852,6 +1098,13 @@ bool SceneManager::undo(int n) {
 
 bool SceneManager::redo(int n) {
 	Log::debug("redo %i steps", n);
+	endStroke();
+	if (_actionRecorder.active()) {
+		Action action;
+		action.type = ActionType::Redo;
+		action.steps = n;
+		recordAction(action);
+	}
 	for (int i = 0; i < n; ++i) {
 		if (!doRedo()) {
 			return false;
@@ -867,7 +1120,13 @@ bool SceneManager::doUndo() {
 	}
 
 	const MementoState& s = _mementoHandler.undo();
-	return mementoStateExecute(s, false);
+	if (!mementoStateExecute(s, false)) {
+		return false;
+	}
+	if (_journal.active()) {
+		_journal.append(s);
+	}
+	return true;
 }
 
 bool SceneManager::doRedo() {
@@ -877,7 +1136,13 @@ bool SceneManager::doRedo() {
 	}
 
 	const MementoState& s = _mementoHandler.redo();
-	return mementoStateExecute(s, true);
+	if (!mementoStateExecute(s, true)) {
+		return false;
+	}
+	if (_journal.active()) {
+		_journal.append(s);
+	}
+	return true;
 }
 
 bool SceneManager::saveSelection(const io::FileDescription& file) {
@@ -1003,6 +1268,7 @@ int SceneManager::mergeNodes(const core::DynamicArray<int>& nodeIds) {
 		if (node == nullptr || node->type() != scenegraph::SceneGraphNodeType::Model) {
 			continue;
 		}
+		loadLazyVolume(nodeId);
 		scenegraph::copyNode(*node, copiedNode, true);
 		newSceneGraph.emplace(core::move(copiedNode));
 	}
@@ -1086,10 +1352,71 @@ void SceneManager::resetSceneState() {
 	resetLastTrace();
 }
 
+void SceneManager::startJournal(const core::String &filename) {
+	if (!_journalEnabled->boolVal()) {
+		stopJournal();
+		return;
+	}
+	// the states up to now are part of the file
+	_mementoHandler.setJournal(_journal.start(filename, _sceneGraph) ? &_journal : nullptr);
+}
+
+void SceneManager::stopJournal() {
+	_mementoHandler.setJournal(nullptr);
+	_journal.stop();
+}
+
+void SceneManager::recoverJournal(const core::String &filename) {
+	core::DynamicArray<MementoState> states;
+	if (!MementoJournal::load(filename, _sceneGraph, states)) {
+		startJournal(filename);
+		return;
+	}
+	core_trace_scoped(RecoverJournal);
+	int applied = 0;
+	for (MementoState &s : states) {
+		if (s.type == MementoType::Modification) {
+			loadLazyVolume(s.nodeId);
+			if (s.data.isDelta()) {
+				const scenegraph::SceneGraphNode &node = _sceneGraph.node(s.nodeId);
+				if (node.volume() != nullptr) {
+					s.data = MementoData::resolveDelta(s.data, *node.volume());
+				} else {
+					s.data = MementoData();
+				}
+			}
+		}
+		if ((s.type == MementoType::Modification && !s.hasVolumeData()) || !mementoStateExecute(s, true)) {
+			Log::warn("Failed to replay the journal state %i of %s", applied, filename.c_str());
+			break;
+		}
+		++applied;
+	}
+	states.erase(applied, states.size() - applied);
+	// the replayed states are the new base of the undo stack
+	resetSceneState();
+	if (!states.empty()) {
+		Log::info("Recovered %i changes from the journal of %s", (int)states.size(), filename.c_str());
+		markDirty();
+	}
+	// the file itself is unchanged - the new journal must contain the replayed states, too
+	startJournal(filename);
+	if (_journal.active()) {
+		for (const MementoState &s : states) {
+			if (!_journal.append(s)) {
+				break;
+			}
+		}
+		_journal.waitForPendingWrites();
+	}
+}
+
 void SceneManager::onNewNodeAdded(int newNodeId, bool isChildren) {
 	if (newNodeId == InvalidNodeId) {
 		return;
 	}
+	// the node ids might get re-used
+	_nodeDataCache.remove(newNodeId);
 
 	if (!isChildren) {
 		_sceneGraph.updateTransforms();
@@ -1128,10 +1455,17 @@ int SceneManager::addNodeToSceneGraph(scenegraph::SceneGraphNode &node, int pare
 	return newNodeId;
 }
 
-bool SceneManager::loadSceneGraph(scenegraph::SceneGraph&& sceneGraph) {
+bool SceneManager::loadSceneGraph(scenegraph::SceneGraph&& sceneGraph, LazyVolumes &&lazyVolumes) {
 	core_trace_scoped(LoadSceneGraph);
+	_autoSaveCancel = true;
+	cancelScript();
 	_sceneGraph = core::move(sceneGraph);
 	_sceneRenderer.clear();
+	_lazyVolumes = core::move(lazyVolumes);
+	_nodeDataCache.clear();
+	_compressedVolumes.clear();
+	_volumeLastUsed.clear();
+	stopJournal();
 
 	const size_t nodesAdded = _sceneGraph.size();
 	if (nodesAdded == 0) {
@@ -1200,6 +1534,7 @@ bool SceneManager::setSceneGraphNodeVolume(scenegraph::SceneGraphNode &node, vox
 		return false;
 	}
 	node.setVolume(volume, true);
+	_nodeDataCache.remove(node.id());
 
 	const voxel::Region& region = volume->region();
 	updateGridRenderer(region);
@@ -1218,8 +1553,15 @@ bool SceneManager::newScene(bool force, const core::String& name, const voxel::R
 	if (dirty() && !force) {
 		return false;
 	}
+	_autoSaveCancel = true;
+	cancelScript();
 	_sceneGraph.clear();
 	_sceneRenderer.clear();
+	_lazyVolumes.clear();
+	_nodeDataCache.clear();
+	_compressedVolumes.clear();
+	_volumeLastUsed.clear();
+	stopJournal();
 
 	voxel::RawVolume* v = new voxel::RawVolume(region);
 	scenegraph::SceneGraphNode node;
@@ -1298,6 +1640,7 @@ void SceneManager::shift(int nodeId, const glm::ivec3& m) {
 	}
 	voxel::Region region = v->region();
 	v->translate(m);
+	node->markDirty();
 	region.accumulate(v->region());
 	modified(nodeId, region);
 }
@@ -1344,6 +1687,10 @@ bool SceneManager::setGridResolution(int resolution) {
 void SceneManager::render(voxelrender::RenderContext &renderContext, const video::Camera& camera, uint8_t renderMask) {
 	const bool renderScene = (renderMask & RenderScene) != 0u;
 	if (renderScene) {
+		if (&camera == _camera) {
+			// the result is used by the next traces - see mouseRayTrace()
+			_pickRequested = _gpuPicking->boolVal() && !renderContext.sceneMode && _sceneRenderer.pick(_mouseCursor);
+		}
 		_sceneRenderer.renderScene(renderContext, camera, _sceneGraph, _currentFrameIdx);
 	}
 	const bool renderUI = (renderMask & RenderUI) != 0u;
@@ -1360,6 +1707,11 @@ void SceneManager::construct() {
 	_movement.construct();
 
 	_autoSaveSecondsDelay = core::Var::get(cfg::VoxEditAutoSaveSeconds, "180");
+	_lazyLoad = core::Var::get(cfg::VoxEditLazyLoad, "false", "Only load the voxels of hidden model nodes in vengi files once they are needed");
+	_lazyLoadCache = core::Var::get(cfg::VoxEditLazyLoadCache, "16", "The amount of lazy loaded volumes that are kept in memory after they are no longer needed");
+	_compressCold = core::Var::get(cfg::VoxEditCompressCold, "5", "Compress the voxels of model nodes in memory that are not needed and were not used for the given minutes - 0 disables it");
+	_journalEnabled = core::Var::get(cfg::VoxEditJournal, "true", "Append the changes since the last save to a journal next to the scene file to recover them after a crash");
+	_gpuPicking = core::Var::get(cfg::VoxEditGpuPicking, "true", "Take the hovered voxel from a pick pass on the gpu instead of a raycast on the cpu", core::Var::boolValidator);
 
 	command::Command::registerCommand("xs", [&] (const command::CmdArgs& args) {
 		if (args.empty()) {
@@ -1380,7 +1732,7 @@ void SceneManager::construct() {
 		if (!runScript(luaScript, luaArgs)) {
 			Log::error("Failed to execute %s", args[0].c_str());
 		} else {
-			Log::info("Executed script %s", args[0].c_str());
+			Log::info("Started script %s", args[0].c_str());
 		}
 	}).setHelp("Executes a lua script to modify the current active volume")
 		.setArgumentCompleter(voxelgenerator::scriptCompleter(io::filesystem()));
@@ -1446,6 +1798,12 @@ void SceneManager::construct() {
 			Log::info("Usage: select [all|none|invert]");
 			return;
 		}
+		if (_actionRecorder.active()) {
+			Action action;
+			action.type = ActionType::Select;
+			action.str = args[0];
+			recordAction(action);
+		}
 		if (args[0] == "none") {
 			_modifier.unselect();
 		} else if (args[0] == "all") {
@@ -1549,6 +1907,11 @@ void SceneManager::construct() {
 		fillHollow();
 	}).setHelp("Fill the inner parts of closed models");
 
+	command::Command::registerCommand("hollow", [&] (const command::CmdArgs& args) {
+		const int shellThickness = args.empty() ? 1 : core::string::toInt(args[0]);
+		hollow(shellThickness);
+	}).setHelp("Remove the voxels that are not visible from outside - the optional parameter is the thickness of the kept shell");
+
 	command::Command::registerCommand("setreferenceposition", [&] (const command::CmdArgs& args) {
 		if (args.size() != 3) {
 			Log::info("Expected to get x, y and z coordinates");
@@ -1698,6 +2061,26 @@ void SceneManager::construct() {
 		cut();
 	}).setHelp("Cut selection");
 
+	command::Command::registerCommand("actionrecord", [this] (const command::CmdArgs& args) {
+		if (args.empty()) {
+			Log::info("Usage: actionrecord <file>");
+			return;
+		}
+		_actionRecorder.start(args[0]);
+	}).setHelp("Record the editing actions into the given file - see actionreplay");
+
+	command::Command::registerCommand("actionrecordstop", [this] (const command::CmdArgs& args) {
+		_actionRecorder.stop();
+	}).setHelp("Stop the action recording");
+
+	command::Command::registerCommand("actionreplay", [this] (const command::CmdArgs& args) {
+		if (args.empty()) {
+			Log::info("Usage: actionreplay <file>");
+			return;
+		}
+		replayActions(args[0]);
+	}).setHelp("Execute the actions of the given recording again and log the time they took");
+
 	command::Command::registerCommand("undo", [&] (const command::CmdArgs& args) {
 		undo();
 	}).setHelp("Undo your last step");
@@ -2031,12 +2414,7 @@ void SceneManager::renderText(const char *str, int size, int thickness, int spac
 		return;
 	}
 	voxel::RawVolumeWrapper wrapper = _modifier.createRawVolumeWrapper(v);
-	const char **s = &str;
-	glm::ivec3 pos = referencePosition();
-	for (int c = core::utf8::next(s); c != -1; c = core::utf8::next(s)) {
-		pos.x += _voxelFont.renderCharacter(c, size, thickness, pos, wrapper, _modifier.cursorVoxel());
-		pos.x += spacing;
-	}
+	_voxelFont.renderText(str, size, thickness, spacing, referencePosition(), wrapper, _modifier.cursorVoxel());
 
 	modified(activeNode(), wrapper.dirtyRegion());
 }
@@ -2087,6 +2465,10 @@ bool SceneManager::init() {
 		Log::error("Failed to initialize the memento handler");
 		return false;
 	}
+	if (!_journal.init()) {
+		Log::error("Failed to initialize the memento journal");
+		return false;
+	}
 	if (!_sceneRenderer.init()) {
 		Log::error("Failed to initialize the scene renderer");
 		return false;
@@ -2113,16 +2495,119 @@ bool SceneManager::init() {
 }
 
 bool SceneManager::runScript(const core::String& script, const core::DynamicArray<core::String>& args) {
+	if (isScriptRunning()) {
+		Log::warn("Another script is still running");
+		return false;
+	}
 	const int nodeId = activeNode();
 	voxel::RawVolume* v = volume(nodeId);
 	if (v == nullptr) {
 		return false;
 	}
 	const voxel::Region& region = _modifier.createRegion(v);
-	voxel::Region dirtyRegion = voxel::Region::InvalidRegion;
-	const bool retVal = _luaGenerator.exec(script, _sceneGraph, nodeId, region, _modifier.cursorVoxel(), dirtyRegion, args);
-	modified(nodeId, dirtyRegion);
-	return retVal;
+	// the script works on a copy of the node - the scene can be modified while the script is running
+	core::SharedPtr<ScriptResult> staged = core::make_shared<ScriptResult>();
+	const scenegraph::SceneGraphNode &node = _sceneGraph.node(nodeId);
+	staged->nodeId = nodeId;
+	staged->stagedNodeId = scenegraph::addNodeToSceneGraph(staged->sceneGraph, node, staged->sceneGraph.root().id());
+	if (staged->stagedNodeId == InvalidNodeId) {
+		Log::error("Failed to stage node %i for the script execution", nodeId);
+		return false;
+	}
+	staged->sceneGraph.setActiveNode(staged->stagedNodeId);
+	if (_actionRecorder.active()) {
+		Action action;
+		action.type = ActionType::Script;
+		action.modifier = _modifier.state();
+		action.str = script;
+		action.args = args;
+		recordAction(action);
+	}
+
+	_scriptCancel = false;
+	_scriptSteps = 0;
+	const voxel::Voxel cursorVoxel = _modifier.cursorVoxel();
+	voxelgenerator::LUAGenerator *luaGenerator = &_luaGenerator;
+	const core::AtomicBool *cancel = &_scriptCancel;
+	core::AtomicInt *steps = &_scriptSteps;
+	core::ThreadPool &threadPool = app::App::getInstance()->threadPool();
+	_scriptFuture = threadPool.enqueue([staged, script, args, region, cursorVoxel, luaGenerator, cancel, steps]() {
+		ScriptResult &result = *staged.get();
+		result.success = luaGenerator->exec(script, result.sceneGraph, result.stagedNodeId, region, cursorVoxel,
+											result.dirtyRegion, args, [cancel, steps](uint64_t) {
+												steps->increment();
+												return !*cancel;
+											});
+		return core::move(result);
+	});
+	return _scriptFuture.valid();
+}
+
+bool SceneManager::isScriptRunning() const {
+	return _scriptFuture.valid();
+}
+
+void SceneManager::cancelScript() {
+	if (isScriptRunning()) {
+		_scriptCancel = true;
+	}
+}
+
+uint64_t SceneManager::scriptInstructions() const {
+	return (uint64_t)(int)_scriptSteps * voxelgenerator::LUAGenerator::ProgressInstructions;
+}
+
+void SceneManager::finishScript(bool wait) {
+	if (!_scriptFuture.valid()) {
+		return;
+	}
+	if (!wait) {
+		using namespace std::chrono_literals;
+		if (_scriptFuture.wait_for(0ms) != std::future_status::ready) {
+			return;
+		}
+	}
+	ScriptResult result = _scriptFuture.get();
+	_scriptFuture = std::future<ScriptResult>();
+	if (_scriptCancel) {
+		Log::info("Script execution was cancelled");
+		return;
+	}
+	if (!result.success) {
+		Log::error("Failed to execute the script");
+		return;
+	}
+	mergeScriptResult(result);
+}
+
+void SceneManager::mergeScriptResult(ScriptResult &result) {
+	core_trace_scoped(MergeScriptResult);
+	scenegraph::SceneGraphNode *node = sceneGraphNode(result.nodeId);
+	if (node == nullptr || node->type() != scenegraph::SceneGraphNodeType::Model) {
+		Log::warn("The node %i of the script doesn't exist anymore", result.nodeId);
+		return;
+	}
+	scenegraph::SceneGraphNode &stagedNode = result.sceneGraph.node(result.stagedNodeId);
+	if (stagedNode.palette().hash() != node->palette().hash()) {
+		node->setPalette(stagedNode.palette());
+	}
+	voxel::RawVolume *stagedVolume = stagedNode.volume();
+	if (stagedVolume->region() != node->region()) {
+		// the script resized or cropped the volume
+		stagedNode.releaseOwnership();
+		if (setNewVolume(result.nodeId, stagedVolume)) {
+			modified(result.nodeId, stagedVolume->region());
+		}
+	} else if (result.dirtyRegion.isValid()) {
+		// the node might have been modified while the script was running - only the voxels of the script are taken
+		const voxel::Region &copied = node->volume()->copyRegion(*stagedVolume, result.dirtyRegion, result.dirtyRegion.getLowerCorner());
+		modified(result.nodeId, copied);
+	}
+	// the nodes that were created by the script are children of the staged node
+	const scenegraph::SceneGraphNodeChildren children = stagedNode.children();
+	for (int childId : children) {
+		addNodeToSceneGraph(result.sceneGraph.node(childId), result.nodeId);
+	}
 }
 
 bool SceneManager::animateActive() const {
@@ -2164,14 +2649,27 @@ bool SceneManager::update(double nowSeconds) {
 		using namespace std::chrono_literals;
 		std::future_status status = _loadingFuture.wait_for(1ms);
 		if (status == std::future_status::ready) {
-			if (loadSceneGraph(core::move(_loadingFuture.get()))) {
+			LoadedSceneGraph loaded = _loadingFuture.get();
+			LazyVolumes lazyVolumes;
+			for (const auto &entry : loaded.lazyNodes) {
+				LazyVolume lazyVolume;
+				lazyVolume.location = entry->value;
+				lazyVolumes.put(entry->key, lazyVolume);
+			}
+			_lazyVolumesFile = loaded.filename;
+			if (loadSceneGraph(core::move(loaded.sceneGraph), core::move(lazyVolumes))) {
 				_needAutoSave = false;
 				_dirty = false;
 				loadedNewScene = true;
+				recoverJournal(loaded.filename);
 			}
-			_loadingFuture = std::future<scenegraph::SceneGraph>();
+			_loadingFuture = std::future<LoadedSceneGraph>();
 		}
 	}
+	finishScript(false);
+	updateLazyVolumes();
+	updateColdVolumes(nowSeconds);
+	_mementoHandler.updateJournal();
 
 	_movement.update(nowSeconds);
 	video::Camera *camera = activeCamera();
@@ -2181,6 +2679,11 @@ bool SceneManager::update(double nowSeconds) {
 	}
 
 	_modifier.update(nowSeconds);
+	// all modifications of the stroke in this frame are extracted in one batch
+	flushStrokeRenderRegions();
+	if (_modifier.updateShapePreview()) {
+		_sceneRenderer.setShapePreview(_modifier.shapePreview(), activePalette());
+	}
 	_sceneRenderer.update();
 	setGridResolution(_gridSize->intVal());
 	for (int i = 0; i < lengthof(DIRECTIONS); ++i) {
@@ -2220,6 +2723,14 @@ void SceneManager::shutdown() {
 	}
 
 	autosave();
+	finishAutoSave(true);
+	endStroke();
+	cancelScript();
+	finishScript(true);
+	// the journal is only kept if voxedit didn't shut down cleanly
+	stopJournal();
+	_journal.shutdown();
+	_actionRecorder.stop();
 
 	_sceneRenderer.shutdown();
 	_sceneGraph.clear();
@@ -2349,25 +2860,51 @@ void SceneManager::traceScene(bool force) {
 	core_trace_scoped(EditorSceneOnProcessUpdateRay);
 	_lastRaytraceX = _mouseCursor.x;
 	_lastRaytraceY = _mouseCursor.y;
+	updateSceneBVH();
 	float intersectDist = _camera->farPlane();
 	const math::Ray& ray = _camera->mouseRay(_mouseCursor);
-	for (scenegraph::SceneGraphNode &node : _sceneGraph) {
-		if (!node.visible()) {
-			continue;
-		}
-		const voxel::Region& region = node.region();
+	// the hierarchy only returns the nodes whose bounds are hit - the exact test is done on the oriented box
+	_sceneBVH.raycast(ray.origin, ray.direction, _camera->farPlane(), [&] (int idx) {
+		const SceneTraceNode &traceNode = _sceneTraceNodes[idx];
 		float distance = 0.0f;
-		const math::OBB<float>& obb = toOBB(true, region, node.pivot(), node.transformForFrame(_currentFrameIdx));
-		if (obb.intersect(ray.origin, ray.direction, _camera->farPlane(), distance)) {
+		if (traceNode.obb.intersect(ray.origin, ray.direction, _camera->farPlane(), distance)) {
 			if (distance < intersectDist) {
 				intersectDist = distance;
-				_sceneModeNodeIdTrace = node.id();
+				_sceneModeNodeIdTrace = traceNode.nodeId;
 			}
 		}
-	}
+	});
 	Log::trace("Hovered node: %i", _sceneModeNodeIdTrace);
 }
 
+void SceneManager::updateSceneBVH() {
+	// the node revisions are only increasing - the sum changes with every modification of a model node
+	uint32_t nodeRevisions = 0u;
+	for (const scenegraph::SceneGraphNode &node : _sceneGraph) {
+		nodeRevisions += node.revision();
+	}
+	if (_sceneBVHValid && _sceneBVHRevision == _sceneGraph.revision() && _sceneBVHNodeRevisions == nodeRevisions &&
+		_sceneBVHFrameIdx == _currentFrameIdx) {
+		return;
+	}
+	core_trace_scoped(EditorSceneUpdateBVH);
+	_sceneBVHValid = true;
+	_sceneBVHRevision = _sceneGraph.revision();
+	_sceneBVHNodeRevisions = nodeRevisions;
+	_sceneBVHFrameIdx = _currentFrameIdx;
+	_sceneBVH.clear();
+	_sceneTraceNodes.clear();
+	for (const scenegraph::SceneGraphNode &node : _sceneGraph) {
+		if (!node.visible()) {
+			continue;
+		}
+		const math::OBB<float> &obb = toOBB(true, node.region(), node.pivot(), node.transformForFrame(_currentFrameIdx));
+		_sceneBVH.add((int)_sceneTraceNodes.size(), obb.toAABB());
+		_sceneTraceNodes.push_back(SceneTraceNode{node.id(), obb});
+	}
+	_sceneBVH.build();
+}
+
 void SceneManager::updateCursor() {
 	if (_modifier.modifierTypeRequiresExistingVoxel()) {
 		if (_result.didHit) {
@@ -2392,6 +2929,32 @@ void SceneManager::updateCursor() {
 	}
 }
 
+bool SceneManager::gpuPickTrace(const voxel::RawVolume *v, const voxelrender::PickResult &pick, const glm::vec3 &rayDirection) {
+	// the voxels behind other nodes and the empty space of the volume are still traced on the cpu
+	if (!pick.didHit() || pick.idx != _sceneGraph.activeNode()) {
+		return false;
+	}
+	// the pick pass might have been rendered before the volume was modified
+	if (!v->region().containsPoint(pick.voxel) || voxel::isAir(v->voxel(pick.voxel).getMaterial())) {
+		return false;
+	}
+	// the positive faces come first - see voxel::FaceNames
+	const int face = (int)pick.face;
+	glm::ivec3 normal(0);
+	normal[face % 3] = face < 3 ? 1 : -1;
+	const glm::ivec3 &previousPosition = pick.voxel + normal;
+
+	_result.didHit = true;
+	_result.hitVoxel = pick.voxel;
+	_result.hitFace = pick.face;
+	_result.direction = rayDirection;
+	_result.validPreviousPosition = v->region().containsPoint(previousPosition);
+	_result.previousPosition = previousPosition;
+	_result.firstValidPosition = false;
+	_result.firstInvalidPosition = false;
+	return true;
+}
+
 bool SceneManager::mouseRayTrace(bool force) {
 	// mouse tracing is disabled - e.g. because the voxel cursor was moved by keyboard
 	// shortcuts. In this case the execution of the modifier would result in a
@@ -2413,6 +2976,25 @@ bool SceneManager::mouseRayTrace(bool force) {
 		return false;
 	}
 	const math::Ray& ray = camera->mouseRay(_mouseCursor);
+	// the locked axes and the modified volumes need the cpu raycast
+	if (_pickRequested && !force && _lockedAxis == math::Axis::None) {
+		voxelrender::PickResult pick;
+		if (_sceneRenderer.pickResult(pick) && pick.pixel == _mouseCursor) {
+			_pickWaitTraces = 0;
+			if (gpuPickTrace(v, pick, ray.direction)) {
+				core_trace_scoped(EditorSceneOnProcessUpdatePick);
+				_lastRaytraceX = _mouseCursor.x;
+				_lastRaytraceY = _mouseCursor.y;
+				updateCursor();
+				return true;
+			}
+		} else if (_pickWaitTraces < MaxPickWaitTraces) {
+			// the pick pass for this mouse position is not yet finished - keep the cursor for now
+			++_pickWaitTraces;
+			return true;
+		}
+	}
+	_pickWaitTraces = 0;
 	const float rayLength = camera->farPlane();
 
 	const glm::vec3& dirWithLength = ray.direction * rayLength;
@@ -2666,6 +3248,223 @@ bool SceneManager::nodeRemove(int nodeId, bool recursive) {
 	return false;
 }
 
+bool SceneManager::lazyVolumeNeeded(const scenegraph::SceneGraphNode &node) const {
+	if (node.visible() || node.locked() || node.id() == activeNode()) {
+		return true;
+	}
+	for (auto iter = _sceneGraph.begin(scenegraph::SceneGraphNodeType::ModelReference); iter != _sceneGraph.end(); ++iter) {
+		if ((*iter).visible() && (*iter).reference() == node.id()) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SceneManager::loadLazyVolume(int nodeId) {
+	const double nowSeconds = app::App::getInstance()->timeProvider()->tickSeconds();
+	_volumeLastUsed.put(nodeId, nowSeconds);
+	if (!decompressVolume(nodeId)) {
+		return false;
+	}
+	auto iter = _lazyVolumes.find(nodeId);
+	if (iter == _lazyVolumes.end()) {
+		return true;
+	}
+	LazyVolume &lazyVolume = iter->value;
+	lazyVolume.lastUsedSeconds = nowSeconds;
+	if (lazyVolume.loaded) {
+		return true;
+	}
+	scenegraph::SceneGraphNode *node = sceneGraphNode(nodeId);
+	if (node == nullptr) {
+		_lazyVolumes.remove(nodeId);
+		return false;
+	}
+	io::FileStream stream(io::filesystem()->open(_lazyVolumesFile));
+	voxel::RawVolume *v = voxelformat::VENGIFormat::loadNodeVolume(stream, lazyVolume.location, node->palette());
+	if (v == nullptr) {
+		Log::error("Failed to load the voxels of node %i from %s", nodeId, _lazyVolumesFile.c_str());
+		return false;
+	}
+	Log::debug("Loaded the voxels of node %i", nodeId);
+	node->setVolume(v, true);
+	lazyVolume.loaded = true;
+	return true;
+}
+
+core::DynamicArray<int> SceneManager::loadLazyVolumes() {
+	core::DynamicArray<int> loaded;
+	for (const auto &entry : _lazyVolumes) {
+		if (!entry->value.loaded) {
+			loaded.push_back(entry->key);
+		}
+	}
+	for (int nodeId : loaded) {
+		loadLazyVolume(nodeId);
+	}
+	core::DynamicArray<int> decompressed;
+	for (const auto &entry : _compressedVolumes) {
+		decompressed.push_back(entry->key);
+	}
+	for (int nodeId : decompressed) {
+		// the last access time is not updated - the volumes are compressed again by the caller
+		if (decompressVolume(nodeId)) {
+			loaded.push_back(nodeId);
+		}
+	}
+	return loaded;
+}
+
+void SceneManager::unloadLazyVolume(int nodeId) {
+	auto iter = _lazyVolumes.find(nodeId);
+	if (iter == _lazyVolumes.end()) {
+		if (_compressCold->floatVal() > 0.0f) {
+			compressVolume(nodeId);
+		}
+		return;
+	}
+	if (!iter->value.loaded) {
+		return;
+	}
+	scenegraph::SceneGraphNode *node = sceneGraphNode(nodeId);
+	if (node == nullptr) {
+		_lazyVolumes.remove(nodeId);
+		return;
+	}
+	Log::debug("Unload the voxels of node %i", nodeId);
+	// the voxels can be loaded from the scene file again
+	node->setVolume(new voxel::RawVolume(voxel::Region(0, 0)), true);
+	iter->value.loaded = false;
+}
+
+void SceneManager::updateLazyVolumes() {
+	if (_lazyVolumes.empty()) {
+		return;
+	}
+	core::DynamicArray<int> needed;
+	core::DynamicArray<int> cached;
+	for (const auto &entry : _lazyVolumes) {
+		if (!_sceneGraph.hasNode(entry->key)) {
+			continue;
+		}
+		if (lazyVolumeNeeded(_sceneGraph.node(entry->key))) {
+			needed.push_back(entry->key);
+		} else if (entry->value.loaded) {
+			cached.push_back(entry->key);
+		}
+	}
+	for (int nodeId : needed) {
+		loadLazyVolume(nodeId);
+	}
+	const int maxCached = core_max(0, _lazyLoadCache->intVal());
+	if ((int)cached.size() <= maxCached) {
+		return;
+	}
+	cached.sort([this](int a, int b) {
+		LazyVolume lazyA;
+		LazyVolume lazyB;
+		_lazyVolumes.get(a, lazyA);
+		_lazyVolumes.get(b, lazyB);
+		return lazyA.lastUsedSeconds < lazyB.lastUsedSeconds;
+	});
+	const int unload = (int)cached.size() - maxCached;
+	for (int i = 0; i < unload; ++i) {
+		unloadLazyVolume(cached[i]);
+	}
+}
+
+void SceneManager::forgetLazyVolume(int nodeId) {
+	_lazyVolumes.remove(nodeId);
+}
+
+bool SceneManager::compressVolume(int nodeId) {
+	if (_compressedVolumes.hasKey(nodeId) || _lazyVolumes.hasKey(nodeId)) {
+		return false;
+	}
+	scenegraph::SceneGraphNode *node = sceneGraphNode(nodeId);
+	if (node == nullptr || node->type() != scenegraph::SceneGraphNodeType::Model || node->volume() == nullptr) {
+		return false;
+	}
+	// not worth the effort for small volumes
+	const voxel::Region &region = node->region();
+	if (region.voxels() < 32 * 32 * 32) {
+		return false;
+	}
+	core_trace_scoped(CompressVolume);
+	// the fastest zlib level - the decompression speed doesn't depend on it
+	MementoData data = MementoData::fromVolume(node->volume(), region, 1);
+	if (data.size() == 0u) {
+		Log::warn("Failed to compress the voxels of node %i", nodeId);
+		return false;
+	}
+	Log::debug("Compressed the voxels of node %i from %i to %i bytes", nodeId,
+			   (int)(region.voxels() * sizeof(voxel::Voxel)), (int)data.size());
+	_compressedVolumes.emplace(nodeId, core::move(data));
+	node->setVolume(new voxel::RawVolume(voxel::Region(0, 0)), true);
+	return true;
+}
+
+bool SceneManager::decompressVolume(int nodeId) {
+	auto iter = _compressedVolumes.find(nodeId);
+	if (iter == _compressedVolumes.end()) {
+		return true;
+	}
+	scenegraph::SceneGraphNode *node = sceneGraphNode(nodeId);
+	if (node == nullptr) {
+		_compressedVolumes.remove(nodeId);
+		return false;
+	}
+	core_trace_scoped(DecompressVolume);
+	const MementoData &data = iter->value;
+	voxel::RawVolume *v = new voxel::RawVolume(data.region());
+	if (!MementoData::toVolume(v, data)) {
+		Log::error("Failed to decompress the voxels of node %i", nodeId);
+		delete v;
+		return false;
+	}
+	Log::debug("Decompressed the voxels of node %i", nodeId);
+	node->setVolume(v, true);
+	_compressedVolumes.remove(nodeId);
+	return true;
+}
+
+void SceneManager::updateColdVolumes(double nowSeconds) {
+	core::DynamicArray<int> needed;
+	for (const auto &entry : _compressedVolumes) {
+		if (_sceneGraph.hasNode(entry->key) && lazyVolumeNeeded(_sceneGraph.node(entry->key))) {
+			needed.push_back(entry->key);
+		}
+	}
+	for (int nodeId : needed) {
+		loadLazyVolume(nodeId);
+	}
+	const double coldSeconds = _compressCold->floatVal() * 60.0;
+	if (coldSeconds <= 0.0 || nowSeconds < _nextColdVolumeCheck) {
+		return;
+	}
+	// checking every node is too expensive for every frame
+	_nextColdVolumeCheck = nowSeconds + 1.0;
+	core::DynamicArray<int> cold;
+	for (auto iter = _sceneGraph.begin(scenegraph::SceneGraphNodeType::Model); iter != _sceneGraph.end(); ++iter) {
+		const scenegraph::SceneGraphNode &node = *iter;
+		if (_compressedVolumes.hasKey(node.id()) || _lazyVolumes.hasKey(node.id())) {
+			continue;
+		}
+		double lastUsedSeconds;
+		if (!_volumeLastUsed.get(node.id(), lastUsedSeconds)) {
+			_volumeLastUsed.put(node.id(), nowSeconds);
+			continue;
+		}
+		if (nowSeconds - lastUsedSeconds < coldSeconds || lazyVolumeNeeded(node)) {
+			continue;
+		}
+		cold.push_back(node.id());
+	}
+	for (int nodeId : cold) {
+		compressVolume(nodeId);
+	}
+}
+
 void SceneManager::markDirty() {
 	_needAutoSave = true;
 	_dirty = true;
@@ -2684,6 +3483,8 @@ bool SceneManager::nodeRemove(scenegraph::SceneGraphNode &node, bool recursive)
 	for (int nodeId : removeReferenceNodes) {
 		nodeRemove(_sceneGraph.node(nodeId), recursive);
 	}
+	// the memento state needs the voxels
+	loadLazyVolume(nodeId);
 	// TODO: memento and recursive... - we only record the one node in the memento state - not the children
 	_mementoHandler.markNodeRemoved(node);
 	if (!_sceneGraph.removeNode(nodeId, recursive)) {
@@ -2691,6 +3492,35 @@ bool SceneManager::nodeRemove(scenegraph::SceneGraphNode &node, bool recursive)
 		// TODO: _mementoHandler.removeLast();
 		return false;
 	}
+	// the node ids might get re-used
+	core::DynamicArray<int> removedLazyVolumes;
+	for (const auto &entry : _lazyVolumes) {
+		if (!_sceneGraph.hasNode(entry->key)) {
+			removedLazyVolumes.push_back(entry->key);
+		}
+	}
+	for (int removedNodeId : removedLazyVolumes) {
+		forgetLazyVolume(removedNodeId);
+	}
+	core::DynamicArray<int> removedNodeData;
+	for (const auto &entry : _nodeDataCache) {
+		if (!_sceneGraph.hasNode(entry->key)) {
+			removedNodeData.push_back(entry->key);
+		}
+	}
+	for (int removedNodeId : removedNodeData) {
+		_nodeDataCache.remove(removedNodeId);
+	}
+	core::DynamicArray<int> removedVolumes;
+	for (const auto &entry : _volumeLastUsed) {
+		if (!_sceneGraph.hasNode(entry->key)) {
+			removedVolumes.push_back(entry->key);
+		}
+	}
+	for (int removedNodeId : removedVolumes) {
+		_volumeLastUsed.remove(removedNodeId);
+		_compressedVolumes.remove(removedNodeId);
+	}
 	if (_sceneGraph.empty()) {
 		const voxel::Region region(glm::ivec3(0), glm::ivec3(31));
 		scenegraph::SceneGraphNode node(scenegraph::SceneGraphNodeType::Model);
@@ -2708,6 +3538,7 @@ bool SceneManager::nodeRemove(scenegraph::SceneGraphNode &node, bool recursive)
 }
 
 void SceneManager::nodeDuplicate(const scenegraph::SceneGraphNode &node) {
+	loadLazyVolume(node.id());
 	const int newNodeId = scenegraph::addNodeToSceneGraph(_sceneGraph, node, node.parent(), true);
 	onNewNodeAdded(newNodeId, false);
 }
@@ -2756,6 +3587,108 @@ void SceneManager::nodeForeachGroup(const std::function<void(int)>& f) {
 	_sceneGraph.foreachGroup(f);
 }
 
+int SceneManager::executeModifier() {
+	if (_actionRecorder.active()) {
+		Action action;
+		action.type = ActionType::Modifier;
+		action.modifier = _modifier.state();
+		recordAction(action);
+	}
+	int nodes = 0;
+	auto func = [&] (int nodeId) {
+		if (scenegraph::SceneGraphNode *node = sceneGraphNode(nodeId)) {
+			if (!node->visible()) {
+				return;
+			}
+			Log::debug("Execute modifier action for node %i", nodeId);
+			voxel::RawVolume* v = volume(nodeId);
+			if (v == nullptr) {
+				return;
+			}
+			_modifier.aabbAction(v, [&] (const voxel::Region& region, ModifierType type, bool markUndo) {
+				if (type != ModifierType::Select && type != ModifierType::ColorPicker) {
+					modified(nodeId, region, markUndo);
+				}
+			});
+			++nodes;
+		}
+	};
+	nodeForeachGroup(func);
+	return nodes;
+}
+
+void SceneManager::recordAction(const Action &action) {
+	if (_replayingActions || !_actionRecorder.active()) {
+		return;
+	}
+	Action recorded = action;
+	recorded.nodeId = activeNode();
+	_actionRecorder.record(recorded);
+}
+
+bool SceneManager::replayActions(const core::String &file, core::DynamicArray<ActionTiming> *timings) {
+	core::DynamicArray<Action> actions;
+	if (!ActionRecorder::load(file, actions)) {
+		return false;
+	}
+	core_trace_scoped(ReplayActions);
+	finishScript(true);
+	_replayingActions = true;
+	double totalMillis[(int)ActionType::Max] {};
+	int counts[(int)ActionType::Max] {};
+	const uint64_t resolution = core::TimeProvider::highResTimeResolution();
+	for (const Action &action : actions) {
+		if (action.nodeId != InvalidNodeId && action.nodeId != activeNode() && !nodeActivate(action.nodeId)) {
+			Log::warn("The node %i of the %s action doesn't exist - was the recording started for another scene?",
+					  action.nodeId, ActionTypeStr[(int)action.type]);
+		}
+		const uint64_t start = core::TimeProvider::highResTime();
+		switch (action.type) {
+		case ActionType::Modifier:
+			_modifier.setState(action.modifier);
+			executeModifier();
+			_modifier.aabbAbort();
+			break;
+		case ActionType::Undo:
+			undo(action.steps);
+			break;
+		case ActionType::Redo:
+			redo(action.steps);
+			break;
+		case ActionType::Palette:
+			setActivePalette(*action.palette.value(), action.steps != 0);
+			break;
+		case ActionType::Script:
+			_modifier.setState(action.modifier);
+			if (runScript(action.str, action.args)) {
+				finishScript(true);
+			}
+			break;
+		case ActionType::Select:
+			command::executeCommands("select " + action.str);
+			break;
+		default:
+			break;
+		}
+		const double millis = (double)(core::TimeProvider::highResTime() - start) * 1000.0 / (double)resolution;
+		totalMillis[(int)action.type] += millis;
+		++counts[(int)action.type];
+		if (timings != nullptr) {
+			timings->push_back({action.type, millis});
+		}
+	}
+	_replayingActions = false;
+
+	Log::info("Replayed %i actions of %s", (int)actions.size(), file.c_str());
+	for (int i = 0; i < (int)ActionType::Max; ++i) {
+		if (counts[i] > 0) {
+			Log::info(" * %-8s %6i actions %10.3f ms (%.3f ms per action)", ActionTypeStr[i], counts[i], totalMillis[i],
+					  totalMillis[i] / (double)counts[i]);
+		}
+	}
+	return true;
+}
+
 bool SceneManager::nodeActivate(int nodeId) {
 	if (!_sceneGraph.hasNode(nodeId)) {
 		Log::warn("Given node id %i doesn't exist", nodeId);
@@ -2765,6 +3698,7 @@ bool SceneManager::nodeActivate(int nodeId) {
 		return true;
 	}
 	Log::debug("Activate node %i", nodeId);
+	loadLazyVolume(nodeId);
 	scenegraph::SceneGraphNode &node = _sceneGraph.node(nodeId);
 	if (node.type() == scenegraph::SceneGraphNodeType::Camera) {
 		video::Camera *camera = activeCamera();
@@ -7,7 +7,11 @@
 #include "core/Enum.h"
 #include "core/ScopedPtr.h"
 #include "core/collection/DynamicArray.h"
+#include "core/collection/Map.h"
+#include "core/concurrent/Atomic.h"
 #include "io/FormatDescription.h"
+#include "math/BVH.h"
+#include "math/OBB.h"
 #include "util/Movement.h"
 #include "voxel/Voxel.h"
 #include "voxelfont/VoxelFont.h"
@@ -18,10 +22,13 @@
 #include "voxelgenerator/TreeContext.h"
 #include "voxelgenerator/LSystem.h"
 #include "voxelformat/Format.h"
+#include "voxelformat/VENGIFormat.h"
 #include "core/Var.h"
 #include "core/Singleton.h"
 #include "command/ActionButton.h"
 #include "MementoHandler.h"
+#include "ActionRecorder.h"
+#include "MementoJournal.h"
 #include "voxelgenerator/LUAGenerator.h"
 #include "modifier/ModifierType.h"
 #include "modifier/ModifierFacade.h"
@@ -68,7 +75,126 @@ private:
 	util::Movement _movement;
 	voxelfont::VoxelFont _voxelFont;
 	core::ScopedPtr<voxel::RawVolume> _copy;
-	std::future<scenegraph::SceneGraph> _loadingFuture;
+	/**
+	 * @brief The result of the asynchronous scene loading
+	 */
+	struct LoadedSceneGraph {
+		scenegraph::SceneGraph sceneGraph;
+		/**
+		 * @brief The hidden model nodes that were loaded without their voxels (see @c cfg::VoxEditLazyLoad)
+		 */
+		voxelformat::VENGIFormat::NodeDataLocations lazyNodes;
+		core::String filename;
+	};
+	std::future<LoadedSceneGraph> _loadingFuture;
+
+	/**
+	 * @brief The autosave is done from a snapshot of the scene graph on a worker thread
+	 */
+	struct AutoSaveResult {
+		core::String filename;
+		bool saved = false;
+	};
+	std::future<AutoSaveResult> _autoSaveFuture;
+	/**
+	 * @brief If set, a running autosave doesn't replace the autosave file - the snapshot is outdated
+	 */
+	core::AtomicBool _autoSaveCancel { false };
+
+	/**
+	 * @brief The result of a lua script that was executed on a staged copy of a model node on a worker thread
+	 */
+	struct ScriptResult {
+		/**
+		 * @brief The staged copy of the target node and the nodes that were created by the script
+		 */
+		scenegraph::SceneGraph sceneGraph;
+		int stagedNodeId = InvalidNodeId;
+		/**
+		 * @brief The id of the target node in the scene graph of the scene manager
+		 */
+		int nodeId = InvalidNodeId;
+		voxel::Region dirtyRegion = voxel::Region::InvalidRegion;
+		bool success = false;
+	};
+	std::future<ScriptResult> _scriptFuture;
+	/**
+	 * @brief If set, the running script is aborted from the lua hook and the result is not merged
+	 */
+	core::AtomicBool _scriptCancel { false };
+	/**
+	 * @brief The amount of voxelgenerator::LUAGenerator::ProgressInstructions steps of the running script
+	 */
+	core::AtomicInt _scriptSteps { 0 };
+
+	/**
+	 * @brief Applies the changes of a finished script to the scene - this records a single undo state
+	 */
+	void finishScript(bool wait);
+	void mergeScriptResult(ScriptResult &result);
+
+	/**
+	 * @brief A model node whose voxels are loaded from the scene file on demand
+	 *
+	 * The voxels are loaded as soon as the node is visible, active, locked or referenced by a visible model
+	 * reference. If the node isn't needed anymore, the volume is kept until more than @c cfg::VoxEditLazyLoadCache
+	 * of these volumes are loaded. The least recently used ones are unloaded then. Once a node is modified, it's
+	 * removed from here and stays in memory.
+	 */
+	struct LazyVolume {
+		voxelformat::VENGIFormat::NodeDataLocation location;
+		bool loaded = false;
+		double lastUsedSeconds = 0.0;
+	};
+	using LazyVolumes = core::Map<int, LazyVolume>;
+	LazyVolumes _lazyVolumes;
+	core::String _lazyVolumesFile;
+	core::VarPtr _lazyLoad;
+	core::VarPtr _lazyLoadCache;
+	/**
+	 * @brief The compressed voxels of the model nodes from the last save to a vengi file
+	 *
+	 * Only the model nodes that were modified since then are compressed again - an entry is removed as soon as
+	 * the node is modified.
+	 */
+	voxelformat::VENGIFormat::NodeDataCache _nodeDataCache;
+	/**
+	 * @brief The compressed voxels of the model nodes that weren't needed and not used for @c cfg::VoxEditCompressCold
+	 * minutes
+	 *
+	 * The volume of such a node is replaced by an empty one and the voxels are decompressed again as soon as the node
+	 * is needed or its volume is accessed (see @c loadLazyVolume()).
+	 */
+	core::Map<int, MementoData> _compressedVolumes;
+	/**
+	 * @brief The seconds of the last access to the volume of a model node
+	 */
+	core::Map<int, double> _volumeLastUsed;
+	core::VarPtr _compressCold;
+	double _nextColdVolumeCheck = 0.0;
+	/**
+	 * @brief The states that were applied since the last save - replayed if the scene wasn't saved before the next start
+	 */
+	MementoJournal _journal;
+	core::VarPtr _journalEnabled;
+	/**
+	 * @brief The user level actions are written into a file while the recording is active
+	 * @sa replayActions()
+	 */
+	ActionRecorder _actionRecorder;
+	/** the actions are not recorded again while they are replayed */
+	bool _replayingActions = false;
+	/**
+	 * @brief A brush stroke is active - the modifications are accumulated instead of being applied one by one
+	 * @sa beginStroke()
+	 */
+	bool _strokeActive = false;
+	/** the modified regions of the stroke per node id that need a new mesh - flushed once per frame */
+	core::Map<int, voxel::Region, 11> _strokeRenderRegions;
+	/** the modified regions of the stroke per node id that get a single undo state at the end of the stroke */
+	core::Map<int, voxel::Region, 11> _strokeUndoRegions;
+
+	void flushStrokeRenderRegions();
 	// TODO: move this out of the mgr class - this should be unit testable in headless mode
 	SceneRenderer _sceneRenderer;
 
@@ -89,6 +215,35 @@ private:
 
 	bool _traceViaMouse = true;
 	int _sceneModeNodeIdTrace = -1;
+	/**
+	 * @brief Use the pick pass of the renderer for the hovered voxel instead of a cpu raycast
+	 */
+	core::VarPtr _gpuPicking;
+	/**
+	 * @brief A pick pass was requested for the mouse cursor with the last render call
+	 */
+	bool _pickRequested = false;
+	/**
+	 * @brief The amount of traces that waited for the pick result of the current mouse position - the cpu raycast
+	 * is done after @c MaxPickWaitTraces
+	 */
+	int _pickWaitTraces = 0;
+	static constexpr int MaxPickWaitTraces = 3;
+
+	struct SceneTraceNode {
+		int nodeId;
+		math::OBB<float> obb;
+	};
+	/**
+	 * @brief The world space bounds of the visible model nodes for the scene mode tracing. The hierarchy is
+	 * rebuilt if the scene graph, any of the model nodes or the current frame changed.
+	 */
+	math::BVH _sceneBVH;
+	core::DynamicArray<SceneTraceNode> _sceneTraceNodes;
+	bool _sceneBVHValid = false;
+	uint32_t _sceneBVHRevision = 0u;
+	uint32_t _sceneBVHNodeRevisions = 0u;
+	scenegraph::FrameIndex _sceneBVHFrameIdx = 0;
 
 	io::FileDescription _lastFilename;
 	double _lastAutoSave = 0u;
@@ -131,6 +286,15 @@ private:
 	 * are left, scene is no longer dirty and so on.
 	 */
 	void resetSceneState();
+	/**
+	 * @brief Starts a new journal for the given (just written) scene file
+	 */
+	void startJournal(const core::String &filename);
+	void stopJournal();
+	/**
+	 * @brief Replays the journal of the given scene file that was left over by a crash
+	 */
+	void recoverJournal(const core::String &filename);
 	/**
 	 * @param[in] nodeId The node to set the volume for
 	 * @param[in] volume The new volume - the ownership is taken over by the node if the return value of this function is @c true. If
@@ -139,15 +303,63 @@ private:
 	 */
 	bool setNewVolume(int nodeId, voxel::RawVolume* volume, bool deleteMesh = true);
 	void autosave();
+	/**
+	 * @brief Copies the scene graph and saves the copy on a worker thread into a temp file that replaces the given
+	 * file once it's completely written
+	 */
+	bool startAutoSave(const io::FileDescription& file);
+	/**
+	 * @brief Handles the result of a finished autosave
+	 * @param[in] wait Block until the running autosave is done
+	 */
+	void finishAutoSave(bool wait);
 	void setReferencePosition(const glm::ivec3& pos);
 	void updateGridRenderer(const voxel::Region& region);
 	void zoom(video::Camera& camera, float level) const;
 	bool mouseRayTrace(bool force);
+	/**
+	 * @brief Fills the trace result with the voxel that the gpu rendered below the mouse cursor
+	 * @return @c false if the pick result can't be used - the cpu raycast has to be done then
+	 */
+	bool gpuPickTrace(const voxel::RawVolume *v, const voxelrender::PickResult &pick, const glm::vec3 &rayDirection);
 	void updateCursor();
 	void traceScene(bool force);
+	void updateSceneBVH();
+
+	bool lazyVolumeNeeded(const scenegraph::SceneGraphNode &node) const;
+	/**
+	 * @brief Makes sure that the voxels of the given node are in memory - they are either loaded from the scene file
+	 * or decompressed
+	 */
+	bool loadLazyVolume(int nodeId);
+	/**
+	 * @return The ids of the nodes that were loaded or decompressed by this call
+	 */
+	core::DynamicArray<int> loadLazyVolumes();
+	/**
+	 * @brief Unloads the voxels of a lazy loaded node - or compresses them again if they were decompressed by
+	 * @c loadLazyVolumes()
+	 */
+	void unloadLazyVolume(int nodeId);
+	bool compressVolume(int nodeId);
+	bool decompressVolume(int nodeId);
+	/**
+	 * @brief Loads the needed volumes and unloads the least recently used volumes that are no longer needed
+	 */
+	void updateLazyVolumes();
+	/**
+	 * @brief The node was modified or removed - the volume is no longer loaded from the scene file
+	 */
+	void forgetLazyVolume(int nodeId);
 protected:
+	/**
+	 * @brief Decompresses the volumes that are needed again and compresses the volumes of the model nodes that
+	 * are not needed and were not used for @c cfg::VoxEditCompressCold minutes
+	 */
+	void updateColdVolumes(double nowSeconds);
+	bool volumeCompressed(int nodeId) const;
 	bool setSceneGraphNodeVolume(scenegraph::SceneGraphNode &node, voxel::RawVolume* volume);
-	bool loadSceneGraph(scenegraph::SceneGraph&& sceneGraph);
+	bool loadSceneGraph(scenegraph::SceneGraph&& sceneGraph, LazyVolumes &&lazyVolumes = LazyVolumes());
 	int activeNode() const;
 	int addModelChild(const core::String& name, int width, int height, int depth);
 
@@ -157,6 +369,11 @@ protected:
 	 */
 	void moveCursor(int x, int y, int z);
 	void fillHollow();
+	/**
+	 * @brief Removes the voxels that are not visible from outside of the models of the active group
+	 * @sa voxelutil::hollow()
+	 */
+	void hollow(int shellThickness);
 
 	void colorToNewNode(const voxel::Voxel voxelColor);
 	void crop();
@@ -248,6 +465,15 @@ public:
 	const glm::ivec3& referencePosition() const;
 
 	void modified(int nodeId, const voxel::Region& modifiedRegion, bool markUndo = true, uint64_t renderRegionMillis = 0);
+	/**
+	 * @brief Starts to accumulate the modifications of a brush stroke
+	 *
+	 * The dirty regions of the modified() calls are merged - the meshes are extracted once per frame and a single
+	 * undo state per node is created in endStroke().
+	 */
+	void beginStroke();
+	void endStroke();
+	bool strokeActive() const;
 	voxel::RawVolume* volume(int nodeId);
 	const voxel::RawVolume* volume(int nodeId) const;
 	voxel::Palette &activePalette() const;
@@ -309,6 +535,7 @@ public:
 	bool load(const io::FileDescription& file);
 	bool load(const io::FileDescription& file, const uint8_t *data, size_t size);
 	bool isLoading() const;
+	bool isAutoSaving() const;
 
 	bool undo(int n = 1);
 	bool redo(int n = 1);
@@ -329,7 +556,42 @@ public:
 	bool import(const core::String& file);
 	bool importDirectory(const core::String& directory, const io::FormatDescription *format = nullptr, int depth = 3);
 
+	/**
+	 * @brief Starts the given lua script for the active node on a worker thread
+	 *
+	 * The script operates on a staged copy of the node. Once the script is done, the modified voxels and the newly
+	 * created nodes are merged into the scene in update().
+	 * @note Scripts can only access the staged node and the nodes they create
+	 * @return @c false if the script couldn't get started - e.g. because another script is still running
+	 */
 	bool runScript(const core::String& script, const core::DynamicArray<core::String>& args);
+	bool isScriptRunning() const;
+	/**
+	 * @brief Executes the current modifier action for the active node and the visible nodes of its group
+	 * @return The amount of nodes the action was executed for
+	 */
+	int executeModifier();
+	/**
+	 * @brief Records the given action if the action recording is active
+	 */
+	void recordAction(const Action &action);
+	/**
+	 * @brief Executes the actions of the given recording and measures the time of each of them
+	 *
+	 * The recording must be replayed on the scene it was started with - the script actions are finished before the
+	 * next action is executed.
+	 * @param[out] timings The time each action took - optional
+	 */
+	bool replayActions(const core::String &file, core::DynamicArray<ActionTiming> *timings = nullptr);
+	ActionRecorder &actionRecorder();
+	/**
+	 * @brief Aborts the running script - the changes of the script are discarded
+	 */
+	void cancelScript();
+	/**
+	 * @return The amount of lua instructions the running script has executed so far
+	 */
+	uint64_t scriptInstructions() const;
 
 	bool newScene(bool force, const core::String& name, const voxel::Region& region);
 	int addNodeToSceneGraph(scenegraph::SceneGraphNode &node, int parent = 0);
@@ -387,6 +649,7 @@ public:
 	ModifierFacade& modifier();
 	const MementoHandler& mementoHandler() const;
 	MementoHandler& mementoHandler();
+	const SceneRenderer& sceneRenderer() const;
 	voxelgenerator::LUAGenerator& luaGenerator();
 	const scenegraph::SceneGraph &sceneGraph() const;
 
@@ -420,6 +683,10 @@ public:
 	void nodeForeachGroup(const std::function<void(int)>& f);
 };
 
+inline bool SceneManager::volumeCompressed(int nodeId) const {
+	return _compressedVolumes.hasKey(nodeId);
+}
+
 inline bool SceneManager::hasClipboardCopy() const {
 	return _copy != nullptr;
 }
@@ -455,6 +722,14 @@ inline math::Axis SceneManager::lockedAxis() const {
 	return _lockedAxis;
 }
 
+inline bool SceneManager::strokeActive() const {
+	return _strokeActive;
+}
+
+inline ActionRecorder& SceneManager::actionRecorder() {
+	return _actionRecorder;
+}
+
 inline const MementoHandler& SceneManager::mementoHandler() const {
 	return _mementoHandler;
 }
@@ -463,6 +738,10 @@ inline MementoHandler& SceneManager::mementoHandler() {
 	return _mementoHandler;
 }
 
+inline const SceneRenderer& SceneManager::sceneRenderer() const {
+	return _sceneRenderer;
+}
+
 inline bool SceneManager::dirty() const {
 	return _dirty;
 }
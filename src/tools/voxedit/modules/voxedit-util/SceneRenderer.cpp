@@ -37,18 +37,14 @@ bool SceneRenderer::init() {
 		Log::error("Failed to initialize the volume renderer");
 		return false;
 	}
-	if (!_shapeRenderer.init()) {
-		Log::error("Failed to initialize the shape renderer");
+	if (!_shapeBatcher.init()) {
+		Log::error("Failed to initialize the shape batcher");
 		return false;
 	}
 	if (!_gridRenderer.init()) {
 		Log::error("Failed to initialize the grid renderer");
 		return false;
 	}
-
-	for (int i = 0; i < lengthof(_planeMeshIndex); ++i) {
-		_planeMeshIndex[i] = -1;
-	}
 	return true;
 }
 
@@ -58,12 +54,20 @@ void SceneRenderer::clear() {
 
 void SceneRenderer::shutdown() {
 	_volumeRenderer.shutdown();
-	_shapeRenderer.shutdown();
+	_shapeBatcher.shutdown();
 	_shapeBuilder.shutdown();
+	_aabbShapeBuilder.shutdown();
+	for (int i = 0; i < lengthof(_planeShapeBuilder); ++i) {
+		_planeShapeBuilder[i].shutdown();
+	}
 	_gridRenderer.shutdown();
+}
 
-	_aabbMeshIndex = -1;
-	_highlightMeshIndex = -1;
+void SceneRenderer::setShapePreview(voxel::RawVolume *volume, const voxel::Palette &palette) {
+	if (volume != nullptr) {
+		_previewPalette = palette;
+	}
+	_volumeRenderer.setPreviewVolume(volume, &_previewPalette);
 }
 
 void SceneRenderer::updateGridRegion(const voxel::Region &region) {
@@ -140,24 +144,20 @@ void SceneRenderer::updateLockedPlane(math::Axis lockedAxis, math::Axis axis, co
 		return;
 	}
 	const int index = math::getIndexForAxis(axis);
-	int32_t &meshIndex = _planeMeshIndex[index];
+	video::ShapeBuilder &shapeBuilder = _planeShapeBuilder[index];
 	if ((lockedAxis & axis) == math::Axis::None) {
-		if (meshIndex != -1) {
-			_shapeRenderer.deleteMesh(meshIndex);
-			meshIndex = -1;
-		}
+		shapeBuilder.clear();
 		return;
 	}
 
 	const glm::vec4 colors[] = {core::Color::LightRed, core::Color::LightGreen, core::Color::LightBlue};
-	updateShapeBuilderForPlane(_shapeBuilder, sceneGraph.region(), false, cursorPosition, axis,
+	updateShapeBuilderForPlane(shapeBuilder, sceneGraph.region(), false, cursorPosition, axis,
 							   core::Color::alpha(colors[index], 0.4f));
-	_shapeRenderer.createOrUpdate(meshIndex, _shapeBuilder);
 }
 
 void SceneRenderer::updateAABBMesh(bool sceneMode, const scenegraph::SceneGraph &sceneGraph,
 								   scenegraph::FrameIndex frame) {
-	_shapeBuilder.clear();
+	_aabbShapeBuilder.clear();
 	for (scenegraph::SceneGraphNode &node : sceneGraph) {
 		if (!node.visible()) {
 			continue;
@@ -166,13 +166,12 @@ void SceneRenderer::updateAABBMesh(bool sceneMode, const scenegraph::SceneGraph
 		core_assert(v != nullptr);
 		const voxel::Region &region = node.region();
 		if (node.id() == sceneGraph.activeNode()) {
-			_shapeBuilder.setColor(core::Color::White);
+			_aabbShapeBuilder.setColor(core::Color::White);
 		} else {
-			_shapeBuilder.setColor(core::Color::Gray);
+			_aabbShapeBuilder.setColor(core::Color::Gray);
 		}
-		_shapeBuilder.obb(toOBB(sceneMode, region, node.pivot(), node.transformForFrame(frame)));
+		_aabbShapeBuilder.obb(toOBB(sceneMode, region, node.pivot(), node.transformForFrame(frame)));
 	}
-	_shapeRenderer.createOrUpdate(_aabbMeshIndex, _shapeBuilder);
 }
 
 void SceneRenderer::update() {
@@ -202,20 +201,25 @@ void SceneRenderer::renderUI(voxelrender::RenderContext &renderContext, const vi
 	video::ScopedState depthTest(video::State::DepthTest, true);
 	video::ScopedState blend(video::State::Blend, true);
 	if (renderContext.sceneMode) {
+		if (_showGrid->boolVal()) {
+			_gridRenderer.renderPlane(camera, (float)sceneGraph.region().getLowerY());
+		}
 		if (_showAABB->boolVal()) {
-			_shapeRenderer.render(_aabbMeshIndex, camera);
+			// all node bounding boxes are in one batch
+			_shapeBatcher.add(_aabbShapeBuilder);
 		}
 	} else if (scenegraph::SceneGraphNode *n = sceneGraphModelNode(sceneGraph, sceneGraph.activeNode())) {
 		const voxel::Region &region = n->region();
 		_gridRenderer.render(camera, toAABB(region));
 
 		if (_showLockedAxis->boolVal()) {
-			for (int i = 0; i < lengthof(_planeMeshIndex); ++i) {
+			for (int i = 0; i < lengthof(_planeShapeBuilder); ++i) {
 				// TODO: fix z-fighting
-				_shapeRenderer.render(_planeMeshIndex[i], camera);
+				_shapeBatcher.add(_planeShapeBuilder[i]);
 			}
 		}
 	}
+	_shapeBatcher.flush(camera);
 
 	const core::TimeProviderPtr &timeProvider = app::App::getInstance()->timeProvider();
 	const uint64_t highlightMillis = _highlightRegion.remaining(timeProvider->tickNow());
@@ -225,8 +229,8 @@ void SceneRenderer::renderUI(voxelrender::RenderContext &renderContext, const vi
 		_shapeBuilder.setColor(core::Color::alpha(core::Color::Green, 0.2f));
 		_shapeBuilder.cube(_highlightRegion.value().getLowerCornerf(),
 						   _highlightRegion.value().getUpperCornerf() + 1.0f);
-		_shapeRenderer.createOrUpdate(_highlightMeshIndex, _shapeBuilder);
-		_shapeRenderer.render(_highlightMeshIndex, camera);
+		_shapeBatcher.add(_shapeBuilder);
+		_shapeBatcher.flush(camera);
 		video::polygonOffset(glm::vec2(0.0f));
 	}
 }
@@ -5,11 +5,12 @@
 #include "core/TimedValue.h"
 #include "math/Axis.h"
 #include "render/GridRenderer.h"
-#include "render/ShapeRenderer.h"
+#include "render/ShapeBatcher.h"
 #include "video/ShapeBuilder.h"
 #include "scenegraph/SceneGraph.h"
 #include "voxelrender/RawVolumeRenderer.h"
 #include "voxelrender/SceneGraphRenderer.h"
+#include "voxel/Palette.h"
 
 namespace voxedit {
 
@@ -18,7 +19,9 @@ private:
 	voxelrender::SceneGraphRenderer _volumeRenderer;
 	render::GridRenderer _gridRenderer;
 	video::ShapeBuilder _shapeBuilder;
-	render::ShapeRenderer _shapeRenderer;
+	video::ShapeBuilder _aabbShapeBuilder;
+	video::ShapeBuilder _planeShapeBuilder[3];
+	render::ShapeBatcher _shapeBatcher;
 
 	core::VarPtr _showGrid;
 	core::VarPtr _showLockedAxis;
@@ -30,10 +33,6 @@ private:
 	core::VarPtr _ambientColor;
 	core::VarPtr _diffuseColor;
 
-	int32_t _planeMeshIndex[3] = {-1, -1, -1};
-	int32_t _highlightMeshIndex = -1;
-	int32_t _aabbMeshIndex = -1;
-
 	struct DirtyRegion {
 		voxel::Region region;
 		int nodeId;
@@ -43,6 +42,10 @@ private:
 
 	using TimedRegion = core::TimedValue<voxel::Region>;
 	TimedRegion _highlightRegion;
+	/**
+	 * @brief The renderer only keeps a pointer to the palette of the preview volume
+	 */
+	voxel::Palette _previewPalette;
 
 	void updateAABBMesh(bool sceneMode, const scenegraph::SceneGraph &sceneGraph, scenegraph::FrameIndex frameIdx);
 	bool extractVolume(const scenegraph::SceneGraph &sceneGraph);
@@ -59,6 +62,29 @@ public:
 	void updateLockedPlanes(math::Axis lockedAxis, const scenegraph::SceneGraph &sceneGraph, const glm::ivec3& cursorPosition);
 	void updateNodeRegion(int nodeId, const voxel::Region &region, uint64_t renderRegionMillis = 0);
 	void updateGridRegion(const voxel::Region &region);
+	/**
+	 * @return The amount of regions that are waiting for the mesh extraction
+	 */
+	int pendingExtractions() const;
+	/**
+	 * @return @c true if the meshes of the scene are not yet up to date
+	 */
+	bool hasPendingWork() const;
+	/**
+	 * @brief Requests to pick the voxel at the given mouse position on the gpu with the next renderScene() call
+	 * @return @c false if the voxels can't be picked on the gpu - use the cpu raycast then
+	 */
+	bool pick(const glm::ivec2 &pixel);
+	/**
+	 * @param[out] result The newest pick result - the index is the node id of the hit node
+	 */
+	bool pickResult(voxelrender::PickResult &result);
+	/**
+	 * @brief Shows the voxels of the modifier shape before it is executed
+	 * @param volume Not owned by the renderer - @c nullptr removes the preview
+	 * @sa voxelrender::SceneGraphRenderer::setPreviewVolume()
+	 */
+	void setShapePreview(voxel::RawVolume *volume, const voxel::Palette &palette);
 
 	void renderUI(voxelrender::RenderContext &renderContext, const video::Camera &camera,
 				  const scenegraph::SceneGraph &sceneGraph);
@@ -66,4 +92,20 @@ public:
 					 const scenegraph::SceneGraph &sceneGraph, scenegraph::FrameIndex frame);
 };
 
+inline int SceneRenderer::pendingExtractions() const {
+	return (int)_extractRegions.size() + _volumeRenderer.pendingExtractions();
+}
+
+inline bool SceneRenderer::hasPendingWork() const {
+	return !_extractRegions.empty() || _volumeRenderer.hasPendingWork();
+}
+
+inline bool SceneRenderer::pick(const glm::ivec2 &pixel) {
+	return _volumeRenderer.pick(pixel);
+}
+
+inline bool SceneRenderer::pickResult(voxelrender::PickResult &result) {
+	return _volumeRenderer.pickResult(result);
+}
+
 } // namespace voxedit
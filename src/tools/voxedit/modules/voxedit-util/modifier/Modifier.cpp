@@ -6,6 +6,7 @@
 #include "math/Axis.h"
 #include "core/Color.h"
 #include "core/StringUtil.h"
+#include "core/Trace.h"
 #include "command/Command.h"
 #include "ui/dearimgui/imgui_internal.h"
 #include "voxedit-util/modifier/Selection.h"
@@ -105,14 +106,75 @@ void Modifier::shutdown() {
 	reset();
 }
 
+// limit the interpolated executions per frame if the cursor jumps far
+static constexpr int MaxStrokeSteps = 1024;
+
 void Modifier::update(double nowSeconds) {
-	if (!singleMode()) {
+	if (!singleMode() || !_actionExecuteButton.pressed()) {
+		_strokePositionValid = false;
+		return;
+	}
+	if (!_strokePositionValid) {
+		_actionExecuteButton.execute(true);
+		_strokePosition = _cursorPosition;
+		_strokePositionValid = true;
 		return;
 	}
-	if (_actionExecuteButton.pressed() && nowSeconds >= _nextSingleExecution) {
+	if (_strokePosition == _cursorPosition) {
+		return;
+	}
+	// execute the action on the line from the last executed position to the cursor
+	const glm::ivec3 cursorPosition = _cursorPosition;
+	const glm::ivec3 delta = cursorPosition - _strokePosition;
+	const glm::ivec3 absDelta = glm::abs(delta);
+	const int steps = core_min(core_max(absDelta.x, core_max(absDelta.y, absDelta.z)), MaxStrokeSteps);
+	for (int i = 1; i <= steps; ++i) {
+		const float t = (float)i / (float)steps;
+		_cursorPosition = _strokePosition + glm::ivec3(glm::round(glm::vec3(delta) * t));
 		_actionExecuteButton.execute(true);
-		_nextSingleExecution = nowSeconds + 0.1;
 	}
+	_cursorPosition = cursorPosition;
+	_strokePosition = cursorPosition;
+}
+
+ModifierState Modifier::state() const {
+	ModifierState state;
+	state.modifierType = _modifierType;
+	state.shapeType = _shapeType;
+	state.cursorVoxel = _cursorVoxel;
+	state.hitCursorVoxel = _hitCursorVoxel;
+	state.aabbFirstPos = _aabbFirstPos;
+	state.aabbSecondPos = _aabbSecondPos;
+	state.cursorPosition = _cursorPosition;
+	state.referencePosition = _referencePos;
+	state.mirrorPosition = _mirrorPos;
+	state.aabbSecondActionDirection = _aabbSecondActionDirection;
+	state.mirrorAxis = _mirrorAxis;
+	state.face = _face;
+	state.gridResolution = _gridResolution;
+	state.aabbMode = _aabbMode;
+	state.secondPosValid = _secondPosValid;
+	state.center = _center;
+	return state;
+}
+
+void Modifier::setState(const ModifierState &state) {
+	_modifierType = state.modifierType;
+	_shapeType = state.shapeType;
+	setCursorVoxel(state.cursorVoxel);
+	_hitCursorVoxel = state.hitCursorVoxel;
+	_aabbFirstPos = state.aabbFirstPos;
+	_aabbSecondPos = state.aabbSecondPos;
+	_cursorPosition = state.cursorPosition;
+	_face = state.face;
+	_aabbSecondActionDirection = state.aabbSecondActionDirection;
+	_gridResolution = core_max(1, state.gridResolution);
+	_aabbMode = state.aabbMode;
+	_secondPosValid = state.secondPosValid;
+	_center = state.center;
+	// the overrides update the renderer
+	setReferencePosition(state.referencePosition);
+	setMirrorAxis(state.mirrorAxis, state.mirrorPosition);
 }
 
 void Modifier::reset() {
@@ -199,12 +261,15 @@ void Modifier::invert(const voxel::Region &region) {
 	if (!_selectionValid) {
 		select(region.getLowerCorner(), region.getUpperCorner());
 	} else {
-		// TODO:
+		_selectionMask.invert(region);
+		_selections = _selectionMask.toRegions();
+		_selectionValid = !_selections.empty();
 	}
 }
 
 void Modifier::unselect() {
 	_selections.clear();
+	_selectionMask.clear();
 	_selectionValid = false;
 }
 
@@ -229,10 +294,11 @@ bool Modifier::select(const glm::ivec3 &mins, const glm::ivec3 &maxs) {
 		}
 	}
 	_selections.push_back(sel);
+	_selectionMask.select(sel);
 	return true;
 }
 
-math::Axis Modifier::getSizeAndHeightFromAxisAndDim(math::Axis axis, const glm::ivec3& dimensions, double &size, double &height) const {
+math::Axis Modifier::getSizeAndHeightFromAxisAndDim(math::Axis axis, const glm::ivec3& dimensions, double &size, double &height) {
 	if (axis == math::Axis::None) {
 		axis = math::Axis::Y;
 	}
@@ -261,12 +327,8 @@ void Modifier::setReferencePosition(const glm::ivec3 &pos) {
 	_referencePos = pos;
 }
 
-bool Modifier::executeShapeAction(ModifierVolumeWrapper& wrapper, const glm::ivec3& mins, const glm::ivec3& maxs, const std::function<void(const voxel::Region& region, ModifierType type, bool markUndo)>& callback, bool markUndo) {
-	glm::ivec3 operateMins = mins;
-	glm::ivec3 operateMaxs = maxs;
-
-	const voxel::Region region(operateMins, operateMaxs);
-	voxel::logRegion("Shape action execution", region);
+bool Modifier::createShape(ModifierVolumeWrapper &wrapper, const voxel::Region &region, ShapeType shapeType,
+						   math::Axis axis, const voxel::Voxel &voxel) {
 	const glm::ivec3& center = region.getCenter();
 	glm::ivec3 centerBottom = center;
 	centerBottom.y = region.getLowerY();
@@ -274,36 +336,45 @@ bool Modifier::executeShapeAction(ModifierVolumeWrapper& wrapper, const glm::ive
 
 	double size = 0.0;
 	double height = 0.0;
-	const math::Axis axis = getSizeAndHeightFromAxisAndDim(_aabbSecondActionDirection, dimensions, size, height);
+	const math::Axis shapeAxis = getSizeAndHeightFromAxisAndDim(axis, dimensions, size, height);
 
-	switch (_shapeType) {
+	switch (shapeType) {
 	case ShapeType::AABB:
-		voxelgenerator::shape::createCubeNoCenter(wrapper, operateMins, dimensions, _cursorVoxel);
+		wrapper.fill(region, voxel);
 		break;
 	case ShapeType::Torus: {
 		const double minorRadius = size / 5.0;
 		const double majorRadius = size / 2.0 - minorRadius;
-		voxelgenerator::shape::createTorus(wrapper, center, minorRadius, majorRadius, _cursorVoxel);
+		voxelgenerator::shape::createTorus(wrapper, center, minorRadius, majorRadius, voxel);
 		break;
 	}
 	case ShapeType::Cylinder: {
 		const double radius = size / 2.0;
-		voxelgenerator::shape::createCylinder(wrapper, centerBottom, axis, (int)glm::round(radius), (int)glm::round(height), _cursorVoxel);
+		voxelgenerator::shape::createCylinder(wrapper, centerBottom, shapeAxis, (int)glm::round(radius), (int)glm::round(height), voxel);
 		break;
 	}
 	case ShapeType::Cone:
-		voxelgenerator::shape::createCone(wrapper, center, dimensions, _cursorVoxel);
+		voxelgenerator::shape::createCone(wrapper, center, dimensions, voxel);
 		break;
 	case ShapeType::Dome:
-		voxelgenerator::shape::createDome(wrapper, center, dimensions, _cursorVoxel);
+		voxelgenerator::shape::createDome(wrapper, center, dimensions, voxel);
 		break;
 	case ShapeType::Ellipse:
-		voxelgenerator::shape::createEllipse(wrapper, center, dimensions, _cursorVoxel);
+		voxelgenerator::shape::createEllipse(wrapper, center, dimensions, voxel);
 		break;
 	case ShapeType::Max:
 		Log::warn("Invalid shape type selected - can't perform action");
 		return false;
 	}
+	return true;
+}
+
+bool Modifier::executeShapeAction(ModifierVolumeWrapper& wrapper, const glm::ivec3& mins, const glm::ivec3& maxs, const std::function<void(const voxel::Region& region, ModifierType type, bool markUndo)>& callback, bool markUndo) {
+	const voxel::Region region(mins, maxs);
+	voxel::logRegion("Shape action execution", region);
+	if (!createShape(wrapper, region, _shapeType, _aabbSecondActionDirection, _cursorVoxel)) {
+		return false;
+	}
 	const voxel::Region& modifiedRegion = wrapper.dirtyRegion();
 	if (modifiedRegion.isValid()) {
 		voxel::logRegion("Dirty region", modifiedRegion);
@@ -312,6 +383,45 @@ bool Modifier::executeShapeAction(ModifierVolumeWrapper& wrapper, const glm::ive
 	return true;
 }
 
+ShapeParameters Modifier::shapeParameters() const {
+	ShapeParameters params;
+	const math::AABB<int> a = aabb();
+	params.region = voxel::Region(a.mins(), a.maxs());
+	params.shapeType = _shapeType;
+	params.axis = _aabbSecondActionDirection;
+	params.voxel = _cursorVoxel;
+	glm::ivec3 minsMirror = a.mins();
+	glm::ivec3 maxsMirror = a.maxs();
+	if (getMirrorAABB(minsMirror, maxsMirror)) {
+		// same as aabbAction() - intersecting shapes are merged into one
+		const math::AABB<int> second(minsMirror, maxsMirror);
+		if (math::intersects(a, second)) {
+			params.region = voxel::Region(a.mins(), maxsMirror);
+		} else {
+			params.mirrorRegion = voxel::Region(minsMirror, maxsMirror);
+		}
+	}
+	return params;
+}
+
+voxel::RawVolume *Modifier::voxelizeShape(const ShapeParameters &params) {
+	if (!params.region.isValid()) {
+		return nullptr;
+	}
+	core_trace_scoped(VoxelizeShape);
+	voxel::Region region = params.region;
+	if (params.mirrorRegion.isValid()) {
+		region.accumulate(params.mirrorRegion);
+	}
+	voxel::RawVolume *volume = new voxel::RawVolume(region);
+	ModifierVolumeWrapper wrapper(volume, ModifierType::Place);
+	createShape(wrapper, params.region, params.shapeType, params.axis, params.voxel);
+	if (params.mirrorRegion.isValid()) {
+		createShape(wrapper, params.mirrorRegion, params.shapeType, params.axis, params.voxel);
+	}
+	return volume;
+}
+
 bool Modifier::needsSecondAction() {
 	if (singleMode() || isMode(ModifierType::Line)) {
 		return false;
@@ -503,7 +613,7 @@ bool Modifier::aabbAction(voxel::RawVolume *volume, const Callback &callback) {
 		return planeModifier(volume, callback);
 	}
 
-	ModifierVolumeWrapper wrapper(volume, _modifierType, _selections);
+	ModifierVolumeWrapper wrapper(volume, _modifierType, _selectionMask.empty() ? nullptr : &_selectionMask);
 	const math::AABB<int> a = aabb();
 	glm::ivec3 minsMirror = a.mins();
 	glm::ivec3 maxsMirror = a.maxs();
@@ -17,6 +17,7 @@
 #include "ModifierButton.h"
 #include "math/AABB.h"
 #include "Selection.h"
+#include "SelectionMask.h"
 #include "ModifierVolumeWrapper.h"
 
 namespace voxedit {
@@ -43,6 +44,55 @@ static constexpr const char* ShapeTypeStr[ShapeType::Max] {
 };
 static_assert(lengthof(ShapeTypeStr) == (int)ShapeType::Max, "Array size mismatch");
 
+/**
+ * @brief Everything that is needed to voxelize the shape of the current aabb - this allows to do it on a worker
+ * @sa Modifier::shapeParameters()
+ * @sa Modifier::voxelizeShape()
+ */
+struct ShapeParameters {
+	voxel::Region region = voxel::Region::InvalidRegion;
+	/**
+	 * @brief The region of the mirrored shape - invalid if there is no mirror axis or the shapes intersect
+	 */
+	voxel::Region mirrorRegion = voxel::Region::InvalidRegion;
+	ShapeType shapeType = ShapeType::AABB;
+	math::Axis axis = math::Axis::None;
+	voxel::Voxel voxel;
+
+	inline bool operator==(const ShapeParameters &other) const {
+		return region == other.region && mirrorRegion == other.mirrorRegion && shapeType == other.shapeType &&
+			   axis == other.axis && voxel.isSame(other.voxel);
+	}
+
+	inline bool operator!=(const ShapeParameters &other) const {
+		return !(*this == other);
+	}
+};
+
+/**
+ * @brief Everything that aabbAction() depends on - this allows to execute a recorded action again
+ * @sa Modifier::state()
+ * @sa Modifier::setState()
+ */
+struct ModifierState {
+	ModifierType modifierType = ModifierType::Place;
+	ShapeType shapeType = ShapeType::AABB;
+	voxel::Voxel cursorVoxel;
+	voxel::Voxel hitCursorVoxel;
+	glm::ivec3 aabbFirstPos{0};
+	glm::ivec3 aabbSecondPos{0};
+	glm::ivec3 cursorPosition{0};
+	glm::ivec3 referencePosition{0};
+	glm::ivec3 mirrorPosition{0};
+	math::Axis aabbSecondActionDirection = math::Axis::None;
+	math::Axis mirrorAxis = math::Axis::None;
+	voxel::FaceNames face = voxel::FaceNames::Max;
+	int gridResolution = 1;
+	bool aabbMode = false;
+	bool secondPosValid = false;
+	bool center = false;
+};
+
 /**
  * @brief This class is responsible for manipulating the volume with the configured shape and for
  * doing the selection.
@@ -52,17 +102,25 @@ static_assert(lengthof(ShapeTypeStr) == (int)ShapeType::Max, "Array size mismatc
  */
 class Modifier : public core::IComponent {
 protected:
+	/**
+	 * @brief The selected boxes - e.g. for rendering and the clipboard
+	 */
 	Selections _selections;
+	/**
+	 * @brief The selected voxels for the membership tests while modifying a volume
+	 */
+	SelectionMask _selectionMask;
 	bool _selectionValid = false;
 	bool _secondPosValid = false;
 	bool _aabbMode = false; /** true if the current action spans an aabb */
 	bool _center = false;
 	bool _locked = false;
 	/**
-	 * timer value which indicates the next execution time in case you keep the
-	 * modifier triggered
+	 * the cursor position of the last execution while the modifier is kept triggered in single mode - the
+	 * positions in between are interpolated to not leave gaps if the cursor moves fast
 	 */
-	double _nextSingleExecution = 0;
+	glm::ivec3 _strokePosition {0};
+	bool _strokePositionValid = false;
 
 	glm::ivec3 _aabbFirstPos {0};
 	glm::ivec3 _aabbSecondPos {0};
@@ -100,7 +158,9 @@ protected:
 
 	glm::ivec3 firstPos() const;
 	bool getMirrorAABB(glm::ivec3& mins, glm::ivec3& maxs) const;
-	math::Axis getSizeAndHeightFromAxisAndDim(math::Axis axis, const glm::ivec3& dimensions, double &size, double &height) const;
+	static math::Axis getSizeAndHeightFromAxisAndDim(math::Axis axis, const glm::ivec3& dimensions, double &size, double &height);
+	static bool createShape(ModifierVolumeWrapper &wrapper, const voxel::Region &region, ShapeType shapeType,
+							math::Axis axis, const voxel::Voxel &voxel);
 	bool executeShapeAction(ModifierVolumeWrapper& wrapper, const glm::ivec3& mins, const glm::ivec3& maxs, const std::function<void(const voxel::Region& region, ModifierType type, bool markUndo)>& callback, bool markUndo);
 
 	math::AABB<int> aabb() const;
@@ -195,6 +255,15 @@ public:
 	 * @param callback Called for every region that was modified for the current active modifier.
 	 */
 	bool aabbAction(voxel::RawVolume *volume, const Callback &callback);
+	/**
+	 * @brief The shape that aabbAction() would create for the current aabb
+	 */
+	ShapeParameters shapeParameters() const;
+	/**
+	 * @brief Creates a volume that only contains the voxels of the given shape - e.g. for a preview
+	 * @return A new volume that the caller owns or @c nullptr if the region is invalid
+	 */
+	static voxel::RawVolume *voxelizeShape(const ShapeParameters &params);
 
 	bool lineModifier(voxel::RawVolume *&volume, const Callback &callback);
 	bool planeModifier(voxel::RawVolume *&volume, const Callback &callback);
@@ -223,6 +292,12 @@ public:
 	void setGridResolution(int resolution);
 	int gridResolution() const;
 
+	ModifierState state() const;
+	/**
+	 * @brief Restores the state of a previous state() call - the selection is not part of the state
+	 */
+	void setState(const ModifierState &state);
+
 	void reset();
 };
 
@@ -32,6 +32,10 @@ bool ModifierButton::handleDown(int32_t key, double pressedMillis) {
 			sceneMgr().trace(false, true);
 		}
 		modifier.aabbStart();
+		if (modifier.singleMode()) {
+			// the executions while the button is held are merged into one undo state
+			sceneMgr().beginStroke();
+		}
 	}
 	return initialDown;
 }
@@ -50,6 +54,7 @@ bool ModifierButton::handleUp(int32_t key, double releasedMillis) {
 			return allUp;
 		}
 		execute(false);
+		sceneMgr().endStroke();
 	} else {
 		Log::debug("Not all modifier keys were released - skipped action execution");
 	}
@@ -58,26 +63,7 @@ bool ModifierButton::handleUp(int32_t key, double releasedMillis) {
 
 void ModifierButton::execute(bool single) {
 	Modifier& modifier = sceneMgr().modifier();
-	int nodes = 0;
-	auto func = [&] (int nodeId) {
-		if (scenegraph::SceneGraphNode *node = sceneMgr().sceneGraphNode(nodeId)) {
-			if (!node->visible()) {
-				return;
-			}
-			Log::debug("Execute modifier action for node %i", nodeId);
-			voxel::RawVolume* v = sceneMgr().volume(nodeId);
-			if (v == nullptr) {
-				return;
-			}
-			modifier.aabbAction(v, [&] (const voxel::Region& region, ModifierType type, bool markUndo) {
-				if (type != ModifierType::Select && type != ModifierType::ColorPicker) {
-					sceneMgr().modified(nodeId, region, markUndo);
-				}
-			});
-			++nodes;
-		}
-	};
-	sceneMgr().nodeForeachGroup(func);
+	const int nodes = sceneMgr().executeModifier();
 	if (_oldType != ModifierType::None) {
 		modifier.setModifierType(_oldType);
 		sceneMgr().trace(false, true);
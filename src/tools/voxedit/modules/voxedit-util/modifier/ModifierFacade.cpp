@@ -3,6 +3,8 @@
  */
 
 #include "ModifierFacade.h"
+#include "app/App.h"
+#include "core/concurrent/ThreadPool.h"
 #include "voxel/Face.h"
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/gtx/transform.hpp>
@@ -14,10 +16,76 @@ bool ModifierFacade::init() {
 }
 
 void ModifierFacade::shutdown() {
+	resetShapePreview();
+	if (_shapePreviewFuture.valid()) {
+		delete _shapePreviewFuture.get();
+	}
 	Super::shutdown();
 	_modifierRenderer.shutdown();
 }
 
+bool ModifierFacade::wantsShapePreview() const {
+	if (_locked || !_aabbMode || _shapeType == ShapeType::AABB) {
+		return false;
+	}
+	// the aabb already shows the result of the other modes
+	return isMode(ModifierType::Place) && !isMode(ModifierType::Line) && !isMode(ModifierType::Path) && !planeMode();
+}
+
+void ModifierFacade::resetShapePreview() {
+	// the running job is dropped once it's done
+	++_shapePreviewGeneration;
+	_shapePreviewParameters = ShapeParameters();
+	_shapePreviewRequested = false;
+	delete _shapePreview;
+	_shapePreview = nullptr;
+}
+
+bool ModifierFacade::updateShapePreview() {
+	bool changed = false;
+	if (_shapePreviewFuture.valid() &&
+		_shapePreviewFuture.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		voxel::RawVolume *volume = _shapePreviewFuture.get();
+		if (_shapePreviewFutureGeneration == _shapePreviewGeneration) {
+			delete _shapePreview;
+			_shapePreview = volume;
+			changed = true;
+		} else {
+			delete volume;
+		}
+	}
+
+	if (!wantsShapePreview()) {
+		if (_shapePreviewParameters.region.isValid() || _shapePreview != nullptr) {
+			changed |= _shapePreview != nullptr;
+			resetShapePreview();
+		}
+		return changed;
+	}
+
+	const ShapeParameters &params = shapeParameters();
+	if (params != _shapePreviewParameters) {
+		changed |= _shapePreview != nullptr;
+		resetShapePreview();
+		_shapePreviewParameters = params;
+		_shapePreviewRequested = true;
+	}
+
+	// only one job at a time - the newest parameters are voxelized once the running job is done
+	if (_shapePreviewRequested && !_shapePreviewFuture.valid()) {
+		_shapePreviewRequested = false;
+		const int generation = _shapePreviewGeneration;
+		_shapePreviewFutureGeneration = generation;
+		_shapePreviewFuture = app::App::getInstance()->threadPool().enqueue([this, params, generation]() -> voxel::RawVolume * {
+			if (generation != _shapePreviewGeneration) {
+				return nullptr;
+			}
+			return voxelizeShape(params);
+		});
+	}
+	return changed;
+}
+
 bool ModifierFacade::setMirrorAxis(math::Axis axis, const glm::ivec3& mirrorPos) {
 	if (Super::setMirrorAxis(axis, mirrorPos)) {
 		_modifierRenderer.updateMirrorPlane(axis, mirrorPos);
@@ -64,7 +132,10 @@ void ModifierFacade::render(const video::Camera& camera) {
 			}
 		}
 
-		_modifierRenderer.renderAABBMode(camera);
+		if (_shapePreview == nullptr) {
+			// the voxels of the shape are rendered by the scene renderer once the preview is done
+			_modifierRenderer.renderAABBMode(camera);
+		}
 	}
 	const glm::ivec3 pos = aabbPosition();
 	const glm::mat4& translate = glm::translate(glm::vec3(pos));
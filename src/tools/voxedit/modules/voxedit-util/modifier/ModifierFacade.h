@@ -7,6 +7,8 @@
 #include "Modifier.h"
 #include "ModifierRenderer.h"
 #include "core/IComponent.h"
+#include "core/concurrent/Atomic.h"
+#include <future>
 
 namespace voxedit {
 
@@ -15,6 +17,22 @@ private:
 	using Super = Modifier;
 	ModifierRenderer _modifierRenderer;
 
+	/**
+	 * @brief The voxelized shape of the current aabb - @c nullptr until the worker finished
+	 */
+	voxel::RawVolume *_shapePreview = nullptr;
+	std::future<voxel::RawVolume *> _shapePreviewFuture;
+	/**
+	 * @brief Increased for every change of the shape - the results of the older jobs are dropped
+	 */
+	core::AtomicInt _shapePreviewGeneration{0};
+	int _shapePreviewFutureGeneration = 0;
+	ShapeParameters _shapePreviewParameters;
+	bool _shapePreviewRequested = false;
+
+	bool wantsShapePreview() const;
+	void resetShapePreview();
+
 public:
 	bool init() override;
 	void shutdown() override;
@@ -25,6 +43,22 @@ public:
 	void setReferencePosition(const glm::ivec3& pos) override;
 	bool setMirrorAxis(math::Axis axis, const glm::ivec3 &mirrorPos) override;
 	void render(const video::Camera& camera);
+
+	/**
+	 * @brief Voxelizes the shape of the current aabb on a worker - a job that is still running when the shape
+	 * changes again is dropped. The aabb is rendered until the new preview is available.
+	 * @return @c true if shapePreview() changed - the previous preview volume was deleted and must no longer be
+	 * rendered
+	 */
+	bool updateShapePreview();
+	/**
+	 * @return The voxels of the shape that the current aabb would create or @c nullptr
+	 */
+	voxel::RawVolume *shapePreview();
 };
 
+inline voxel::RawVolume *ModifierFacade::shapePreview() {
+	return _shapePreview;
+}
+
 }
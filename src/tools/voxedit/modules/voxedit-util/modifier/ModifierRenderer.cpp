@@ -22,27 +22,35 @@ bool ModifierRenderer::init() {
 		Log::error("Failed to initialize the shape renderer");
 		return false;
 	}
+	if (!_shapeBatcher.init()) {
+		Log::error("Failed to initialize the shape batcher");
+		return false;
+	}
+	if (!_selectionRenderer.init()) {
+		Log::error("Failed to initialize the selection renderer");
+		return false;
+	}
+	_selectionRenderer.setColor(core::Color::Yellow);
 
-	_shapeBuilder.clear();
-	_shapeBuilder.setColor(core::Color::alpha(core::Color::SteelBlue, 0.8f));
-	_shapeBuilder.sphere(8, 6, 0.5f);
-	_referencePointMesh = _shapeRenderer.create(_shapeBuilder);
+	_referencePointShape.clear();
+	_referencePointShape.setColor(core::Color::alpha(core::Color::SteelBlue, 0.8f));
+	_referencePointShape.sphere(8, 6, 0.5f);
 
 	return true;
 }
 
 void ModifierRenderer::shutdown() {
-	_mirrorMeshIndex = -1;
 	_aabbMeshIndex = -1;
-	_selectionIndex = -1;
-	_voxelCursorMesh = -1;
-	_referencePointMesh = -1;
 	_shapeRenderer.shutdown();
+	_shapeBatcher.shutdown();
+	_selectionRenderer.shutdown();
 	_shapeBuilder.shutdown();
+	_voxelCursorShape.shutdown();
+	_mirrorShape.shutdown();
+	_referencePointShape.shutdown();
 }
 
 void ModifierRenderer::updateCursor(const voxel::Voxel& voxel, voxel::FaceNames face, bool flip) {
-	_shapeBuilder.clear();
 	video::ShapeBuilderCube flags = video::ShapeBuilderCube::All;
 	switch (face) {
 	case voxel::FaceNames::PositiveX:
@@ -90,18 +98,16 @@ void ModifierRenderer::updateCursor(const voxel::Voxel& voxel, voxel::FaceNames
 	case voxel::FaceNames::Max:
 		return;
 	}
-	_shapeBuilder.setColor(core::Color::alpha(core::Color::Red, 0.6f));
-	_shapeBuilder.cube(glm::vec3(0.0f), glm::vec3(1.0f), flags);
-	_shapeRenderer.createOrUpdate(_voxelCursorMesh, _shapeBuilder);
+	_voxelCursorShape.clear();
+	_voxelCursorShape.setColor(core::Color::alpha(core::Color::Red, 0.6f));
+	_voxelCursorShape.cube(glm::vec3(0.0f), glm::vec3(1.0f), flags);
 }
 
 void ModifierRenderer::updateSelectionBuffers(const Selections& selections) {
-	_shapeBuilder.clear();
-	_shapeBuilder.setColor(core::Color::Yellow);
+	_selectionRenderer.clear();
 	for (const Selection &selection : selections) {
-		_shapeBuilder.aabb(selection.getLowerCorner(), selection.getUpperCorner() + glm::one<glm::ivec3>());
+		_selectionRenderer.add(selection.getLowerCorner(), selection.getUpperCorner() + glm::one<glm::ivec3>());
 	}
-	_shapeRenderer.createOrUpdate(_selectionIndex, _shapeBuilder);
 }
 
 void ModifierRenderer::updateAABBMirrorMesh(const glm::vec3& mins, const glm::vec3& maxs,
@@ -129,9 +135,10 @@ void ModifierRenderer::renderAABBMode(const video::Camera& camera) {
 void ModifierRenderer::render(const video::Camera& camera, const glm::mat4& model) {
 	const video::ScopedState depthTest(video::State::DepthTest, false);
 	const video::ScopedState cullFace(video::State::CullFace, false);
-	_shapeRenderer.render(_voxelCursorMesh, camera, model);
-	_shapeRenderer.render(_mirrorMeshIndex, camera);
-	_shapeRenderer.render(_referencePointMesh, camera, _referencePointModelMatrix);
+	_shapeBatcher.add(_voxelCursorShape, model);
+	_shapeBatcher.add(_mirrorShape);
+	_shapeBatcher.add(_referencePointShape, _referencePointModelMatrix);
+	_shapeBatcher.flush(camera);
 }
 
 void ModifierRenderer::updateReferencePosition(const glm::ivec3 &pos) {
@@ -140,21 +147,17 @@ void ModifierRenderer::updateReferencePosition(const glm::ivec3 &pos) {
 }
 
 void ModifierRenderer::renderSelection(const video::Camera& camera) {
-	_shapeRenderer.render(_selectionIndex, camera);
+	_selectionRenderer.render(camera);
 }
 
 void ModifierRenderer::updateMirrorPlane(math::Axis axis, const glm::ivec3& mirrorPos) {
 	if (axis == math::Axis::None) {
-		if (_mirrorMeshIndex != -1) {
-			_shapeRenderer.deleteMesh(_mirrorMeshIndex);
-			_mirrorMeshIndex = -1;
-		}
+		_mirrorShape.clear();
 		return;
 	}
 
-	updateShapeBuilderForPlane(_shapeBuilder, sceneMgr().sceneGraph().region(), true, mirrorPos, axis,
+	updateShapeBuilderForPlane(_mirrorShape, sceneMgr().sceneGraph().region(), true, mirrorPos, axis,
 			core::Color::alpha(core::Color::LightGray, 0.3f));
-	_shapeRenderer.createOrUpdate(_mirrorMeshIndex, _shapeBuilder);
 }
 
 }
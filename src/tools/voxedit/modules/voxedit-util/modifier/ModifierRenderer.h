@@ -6,6 +6,8 @@
 
 #include "core/IComponent.h"
 #include "math/Axis.h"
+#include "render/BoxRenderer.h"
+#include "render/ShapeBatcher.h"
 #include "render/ShapeRenderer.h"
 #include "video/ShapeBuilder.h"
 #include "../modifier/Selection.h"
@@ -18,11 +20,14 @@ class ModifierRenderer : public core::IComponent {
 private:
 	video::ShapeBuilder _shapeBuilder;
 	render::ShapeRenderer _shapeRenderer;
+	// the cursor, the mirror plane and the reference point are rendered in one batch
+	render::ShapeBatcher _shapeBatcher;
+	// every selection is an instance of a unit cube outline
+	render::BoxRenderer _selectionRenderer;
+	video::ShapeBuilder _voxelCursorShape;
+	video::ShapeBuilder _mirrorShape;
+	video::ShapeBuilder _referencePointShape;
 	int32_t _aabbMeshIndex = -1;
-	int32_t _selectionIndex = -1;
-	int32_t _mirrorMeshIndex = -1;
-	int32_t _voxelCursorMesh = -1;
-	int32_t _referencePointMesh = -1;
 	glm::mat4 _referencePointModelMatrix{1.0f};
 
 public:
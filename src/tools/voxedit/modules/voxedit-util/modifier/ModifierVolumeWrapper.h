@@ -6,7 +6,7 @@
 
 #include "voxel/RawVolume.h"
 #include "ModifierType.h"
-#include "Selection.h"
+#include "SelectionMask.h"
 
 namespace voxedit {
 
@@ -16,7 +16,10 @@ namespace voxedit {
 class ModifierVolumeWrapper {
 private:
 	voxel::RawVolume* _volume;
-	const Selections _selections;
+	/**
+	 * @brief If not @c null only the selected voxels are modified
+	 */
+	const SelectionMask *_selection;
 	voxel::Region _region;
 	voxel::Region _dirtyRegion = voxel::Region::InvalidRegion;
 	const ModifierType _modifierType;
@@ -26,6 +29,18 @@ private:
 	bool _update;
 	bool _force;
 
+	void fillRegion(const voxel::Region& region, const voxel::Voxel& voxel) {
+		const voxel::Region& filled = _volume->fill(region, voxel);
+		if (!filled.isValid()) {
+			return;
+		}
+		if (_dirtyRegion.isValid()) {
+			_dirtyRegion.accumulate(filled);
+		} else {
+			_dirtyRegion = filled;
+		}
+	}
+
 public:
 	class Sampler : public voxel::RawVolume::Sampler {
 	private:
@@ -40,8 +55,8 @@ public:
 		Sampler(ModifierVolumeWrapper& volume) : Super(volume.volume()) {};
 	};
 
-	ModifierVolumeWrapper(voxel::RawVolume* volume, ModifierType modifierType, const Selections &selections) :
-			_volume(volume), _selections(selections), _region(volume->region()), _modifierType(modifierType) {
+	ModifierVolumeWrapper(voxel::RawVolume* volume, ModifierType modifierType, const SelectionMask *selection = nullptr) :
+			_volume(volume), _selection(selection), _region(volume->region()), _modifierType(modifierType) {
 		_eraseVoxels = (_modifierType & ModifierType::Erase) == ModifierType::Erase;
 		_overwrite = (_modifierType & ModifierType::Place) == ModifierType::Place && _eraseVoxels;
 		_update = (_modifierType & ModifierType::Paint) == ModifierType::Paint;
@@ -89,10 +104,10 @@ public:
 	}
 
 	inline bool skip(int x, int y, int z) const {
-		if (_selections.empty()) {
+		if (_selection == nullptr) {
 			return !_region.containsPoint(x, y, z);
 		}
-		return !contains(_selections, x, y, z);
+		return !_selection->contains(x, y, z);
 	}
 
 	/**
@@ -129,6 +144,45 @@ public:
 		return true;
 	}
 
+	/**
+	 * @brief Fills the given region with the modifier type rules of setVoxel(). If the existing voxels don't need to
+	 * be checked, the region is filled row by row. With a selection only the selected runs of each row are visited.
+	 */
+	void fill(const voxel::Region& region, const voxel::Voxel& voxel) {
+		voxel::Region cropped = region;
+		cropped.cropTo(_region);
+		if (!cropped.isValid()) {
+			return;
+		}
+		voxel::Voxel placeVoxel = voxel;
+		if (!_overwrite && _eraseVoxels) {
+			placeVoxel = voxel::createVoxel(voxel::VoxelType::Air, 0);
+		}
+		if (_selection != nullptr) {
+			_selection->visitRows(cropped, [&](int x1, int x2, int y, int z) {
+				if (_force) {
+					fillRegion(voxel::Region(x1, y, z, x2, y, z), placeVoxel);
+					return;
+				}
+				for (int x = x1; x <= x2; ++x) {
+					setVoxel(x, y, z, voxel);
+				}
+			});
+			return;
+		}
+		if (!_force) {
+			for (int z = cropped.getLowerZ(); z <= cropped.getUpperZ(); ++z) {
+				for (int y = cropped.getLowerY(); y <= cropped.getUpperY(); ++y) {
+					for (int x = cropped.getLowerX(); x <= cropped.getUpperX(); ++x) {
+						setVoxel(x, y, z, voxel);
+					}
+				}
+			}
+			return;
+		}
+		fillRegion(cropped, placeVoxel);
+	}
+
 	inline bool setVoxels(int x, int z, const voxel::Voxel* voxels, int amount) {
 		for (int y = 0; y < amount; ++y) {
 			setVoxel(x, y, z, voxels[y]);
@@ -0,0 +1,168 @@
+/**
+ * @file
+ */
+
+#include "SelectionMask.h"
+#include "core/Trace.h"
+
+namespace voxedit {
+
+void SelectionMask::clear() {
+	_bricks.clear();
+}
+
+void SelectionMask::apply(const voxel::Region &region, Op op) {
+	if (!region.isValid()) {
+		return;
+	}
+	core_trace_scoped(SelectionMaskApply);
+	const glm::ivec3 &mins = region.getLowerCorner();
+	const glm::ivec3 &maxs = region.getUpperCorner();
+	const glm::ivec3 brickMins = mins >> BrickShift;
+	const glm::ivec3 brickMaxs = maxs >> BrickShift;
+	for (int bz = brickMins.z; bz <= brickMaxs.z; ++bz) {
+		for (int by = brickMins.y; by <= brickMaxs.y; ++by) {
+			for (int bx = brickMins.x; bx <= brickMaxs.x; ++bx) {
+				const glm::ivec3 brickPos(bx, by, bz);
+				const glm::ivec3 brickLower = brickPos << BrickShift;
+				const glm::ivec3 lower = glm::max(mins, brickLower) - brickLower;
+				const glm::ivec3 upper = glm::min(maxs, brickLower + BrickMask) - brickLower;
+
+				// the bits of the region in one z slice of the brick
+				const uint64_t row = (0xffull >> (BrickMask - upper.x + lower.x)) << lower.x;
+				uint64_t word = 0u;
+				for (int y = lower.y; y <= upper.y; ++y) {
+					word |= row << (y * BrickSize);
+				}
+
+				auto iter = _bricks.find(brickPos);
+				if (iter == _bricks.end()) {
+					if (op == Op::Clear) {
+						continue;
+					}
+					_bricks.put(brickPos, Brick());
+					iter = _bricks.find(brickPos);
+				}
+				Brick &brick = iter->value;
+				bool used = false;
+				for (int z = 0; z < BrickSize; ++z) {
+					if (z >= lower.z && z <= upper.z) {
+						switch (op) {
+						case Op::Set:
+							brick.words[z] |= word;
+							break;
+						case Op::Clear:
+							brick.words[z] &= ~word;
+							break;
+						case Op::Toggle:
+							brick.words[z] ^= word;
+							break;
+						}
+					}
+					used |= brick.words[z] != 0u;
+				}
+				if (!used) {
+					_bricks.remove(brickPos);
+				}
+			}
+		}
+	}
+}
+
+void SelectionMask::select(const voxel::Region &region) {
+	apply(region, Op::Set);
+}
+
+void SelectionMask::unselect(const voxel::Region &region) {
+	apply(region, Op::Clear);
+}
+
+void SelectionMask::invert(const voxel::Region &region) {
+	apply(region, Op::Toggle);
+}
+
+voxel::Region SelectionMask::bounds() const {
+	voxel::Region bounds = voxel::Region::InvalidRegion;
+	for (auto iter = _bricks.begin(); iter != _bricks.end(); ++iter) {
+		const glm::ivec3 brickLower = iter->key << BrickShift;
+		const Brick &brick = iter->value;
+		for (int z = 0; z < BrickSize; ++z) {
+			if (brick.words[z] == 0u) {
+				continue;
+			}
+			for (int y = 0; y < BrickSize; ++y) {
+				const uint8_t bits = (uint8_t)(brick.words[z] >> (y * BrickSize));
+				if (bits == 0u) {
+					continue;
+				}
+				int lowerX = 0;
+				while (((bits >> lowerX) & 1u) == 0u) {
+					++lowerX;
+				}
+				int upperX = BrickMask;
+				while (((bits >> upperX) & 1u) == 0u) {
+					--upperX;
+				}
+				const voxel::Region row(brickLower + glm::ivec3(lowerX, y, z), brickLower + glm::ivec3(upperX, y, z));
+				if (bounds.isValid()) {
+					bounds.accumulate(row);
+				} else {
+					bounds = row;
+				}
+			}
+		}
+	}
+	return bounds;
+}
+
+Selections SelectionMask::toRegions() const {
+	core_trace_scoped(SelectionMaskToRegions);
+	Selections regions;
+	// the boxes of the current z slice - the runs are merged along y
+	Selections slice;
+	// the indices of the boxes in the result list that end at the previous slice
+	core::DynamicArray<size_t> open;
+	core::DynamicArray<size_t> nextOpen;
+	int sliceZ = 0;
+
+	auto flushSlice = [&]() {
+		nextOpen.clear();
+		for (const voxel::Region &r : slice) {
+			bool merged = false;
+			for (size_t idx : open) {
+				voxel::Region &o = regions[idx];
+				if (o.getUpperZ() == sliceZ - 1 && o.getLowerX() == r.getLowerX() && o.getUpperX() == r.getUpperX() &&
+					o.getLowerY() == r.getLowerY() && o.getUpperY() == r.getUpperY()) {
+					o.setUpperZ(sliceZ);
+					nextOpen.push_back(idx);
+					merged = true;
+					break;
+				}
+			}
+			if (!merged) {
+				nextOpen.push_back(regions.size());
+				regions.push_back(r);
+			}
+		}
+		open = nextOpen;
+		slice.clear();
+	};
+
+	visitRows(bounds(), [&](int x1, int x2, int y, int z) {
+		if (z != sliceZ) {
+			flushSlice();
+			sliceZ = z;
+		}
+		for (voxel::Region &r : slice) {
+			if (r.getUpperY() == y - 1 && r.getLowerX() == x1 && r.getUpperX() == x2) {
+				r.setUpperY(y);
+				return;
+			}
+		}
+		slice.push_back(voxel::Region(x1, y, z, x2, y, z));
+	});
+	flushSlice();
+	return regions;
+}
+
+} // namespace voxedit
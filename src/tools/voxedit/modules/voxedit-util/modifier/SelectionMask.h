@@ -0,0 +1,142 @@
+/**
+ * @file
+ */
+
+#pragma once
+
+#include "Selection.h"
+#include "core/GLM.h"
+#include "core/collection/HashMap.h"
+#include <glm/gtx/hash.hpp>
+
+namespace voxedit {
+
+/**
+ * @brief Sparse bit mask of the selected voxels
+ *
+ * The mask is split into bricks of 8x8x8 voxels - only bricks with at least one selected voxel are stored. Each
+ * brick holds one 64 bit word per z slice with the bit @c x+y*8 - so a row of a brick is one byte. This makes the
+ * membership test independent of the number of selected boxes.
+ */
+class SelectionMask {
+public:
+	static constexpr int BrickShift = 3;
+	static constexpr int BrickSize = 1 << BrickShift;
+	static constexpr int BrickMask = BrickSize - 1;
+
+private:
+	struct Brick {
+		uint64_t words[BrickSize]{};
+	};
+	using Bricks = core::HashMap<glm::ivec3, Brick, glm::hash<glm::ivec3>>;
+	Bricks _bricks;
+
+	enum class Op { Set, Clear, Toggle };
+	void apply(const voxel::Region &region, Op op);
+
+	/**
+	 * @return The bits of the given brick row - bit @c n is the voxel at the brick local x coordinate @c n
+	 */
+	inline uint8_t rowBits(const glm::ivec3 &brick, int y, int z) const {
+		auto iter = _bricks.find(brick);
+		if (iter == _bricks.end()) {
+			return 0u;
+		}
+		return (uint8_t)(iter->value.words[z & BrickMask] >> ((y & BrickMask) * BrickSize));
+	}
+
+public:
+	void clear();
+	/**
+	 * @return @c true if no voxel is selected
+	 */
+	inline bool empty() const {
+		return _bricks.empty();
+	}
+
+	/**
+	 * @brief Adds the voxels of the region to the selection (union)
+	 */
+	void select(const voxel::Region &region);
+	/**
+	 * @brief Removes the voxels of the region from the selection
+	 */
+	void unselect(const voxel::Region &region);
+	/**
+	 * @brief Toggles the selection state of all voxels in the given region
+	 */
+	void invert(const voxel::Region &region);
+
+	inline bool contains(int x, int y, int z) const {
+		const uint8_t bits = rowBits(glm::ivec3(x, y, z) >> BrickShift, y, z);
+		return (bits >> (x & BrickMask)) & 1u;
+	}
+
+	inline bool contains(const glm::ivec3 &pos) const {
+		return contains(pos.x, pos.y, pos.z);
+	}
+
+	/**
+	 * @return The bounding box of the selected voxels or voxel::Region::InvalidRegion if nothing is selected
+	 */
+	voxel::Region bounds() const;
+
+	/**
+	 * @brief Converts the mask into a list of non overlapping boxes - e.g. for rendering
+	 */
+	Selections toRegions() const;
+
+	/**
+	 * @brief Calls the given functor for each run of selected voxels in a row of the given region
+	 *
+	 * The functor is called with @c (x1,x2,y,z) where @c x1 and @c x2 are the inclusive bounds of the run.
+	 */
+	template<class FUNC>
+	void visitRows(const voxel::Region &region, FUNC &&func) const {
+		if (!region.isValid() || _bricks.empty()) {
+			return;
+		}
+		const int lx = region.getLowerX();
+		const int ux = region.getUpperX();
+		for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+			for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+				// a run can span several bricks
+				bool open = false;
+				int runStart = 0;
+				for (int bx = lx >> BrickShift; bx <= (ux >> BrickShift); ++bx) {
+					const int brickX = bx << BrickShift;
+					uint8_t bits = rowBits(glm::ivec3(bx, y >> BrickShift, z >> BrickShift), y, z);
+					// mask out the voxels outside of the region
+					if (brickX < lx) {
+						bits &= (uint8_t)(0xffu << (lx - brickX));
+					}
+					if (brickX + BrickMask > ux) {
+						bits &= (uint8_t)(0xffu >> (brickX + BrickMask - ux));
+					}
+					if (bits == 0xffu) {
+						if (!open) {
+							open = true;
+							runStart = brickX;
+						}
+						continue;
+					}
+					for (int i = 0; i < BrickSize; ++i) {
+						const bool set = (bits >> i) & 1u;
+						if (set && !open) {
+							open = true;
+							runStart = brickX + i;
+						} else if (!set && open) {
+							open = false;
+							func(runStart, brickX + i - 1, y, z);
+						}
+					}
+				}
+				if (open) {
+					func(runStart, ux, y, z);
+				}
+			}
+		}
+	}
+};
+
+} // namespace voxedit
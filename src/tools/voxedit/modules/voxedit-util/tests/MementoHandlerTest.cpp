@@ -3,6 +3,7 @@
  */
 
 #include "../MementoHandler.h"
+#include "../Config.h"
 #include "app/tests/AbstractTest.h"
 #include "scenegraph/SceneGraphNode.h"
 #include "voxel/RawVolume.h"
@@ -18,11 +19,13 @@ protected:
 		return core::make_shared<voxel::RawVolume>(region);
 	}
 	void SetUp() override {
+		app::AbstractTest::SetUp();
 		ASSERT_TRUE(mementoHandler.init());
 	}
 
 	void TearDown() override {
 		mementoHandler.shutdown();
+		app::AbstractTest::TearDown();
 	}
 };
 
@@ -545,6 +548,117 @@ TEST_F(MementoHandlerTest, testAddNewNodeEdit) {
 	}
 }
 
+TEST_F(MementoHandlerTest, testDeltaUndoRedo) {
+	core::SharedPtr<voxel::RawVolume> volume = create(8);
+	mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region::InvalidRegion, glm::vec3(0.0f), glm::mat4(1.0f), InvalidKeyFrame);
+	for (int i = 1; i < 5; ++i) {
+		volume->setVoxel(i, i, i, voxel::createVoxel(voxel::VoxelType::Generic, i));
+		mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region::InvalidRegion, glm::vec3(0.0f), glm::mat4(1.0f), InvalidKeyFrame);
+		mementoHandler.waitForPendingStates();
+		EXPECT_TRUE(mementoHandler.state().data.isDelta()) << "Only the changed voxels should get stored for state " << i;
+	}
+	for (int i = 4; i >= 1; --i) {
+		const MementoState &s = mementoHandler.undo();
+		ASSERT_TRUE(s.hasVolumeData());
+		ASSERT_FALSE(s.data.isDelta());
+		voxel::RawVolume v(s.dataRegion());
+		ASSERT_TRUE(MementoData::toVolume(&v, s.data));
+		EXPECT_TRUE(voxel::isAir(v.voxel(i, i, i).getMaterial())) << "Voxel " << i << " should be removed by the undo";
+		if (i > 1) {
+			EXPECT_EQ(i - 1, v.voxel(i - 1, i - 1, i - 1).getColor());
+		}
+	}
+	const MementoState &s = mementoHandler.redo();
+	ASSERT_TRUE(s.hasVolumeData());
+	voxel::RawVolume v(s.dataRegion());
+	ASSERT_TRUE(MementoData::toVolume(&v, s.data));
+	EXPECT_EQ(1, v.voxel(1, 1, 1).getColor());
+	EXPECT_TRUE(voxel::isAir(v.voxel(2, 2, 2).getMaterial()));
+}
+
+TEST_F(MementoHandlerTest, testUndoModifiedRegion) {
+	core::SharedPtr<voxel::RawVolume> volume = create(16);
+	mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region::InvalidRegion, glm::vec3(0.0f), glm::mat4(1.0f), InvalidKeyFrame);
+	volume->setVoxel(2, 3, 4, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	volume->setVoxel(5, 3, 6, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region::InvalidRegion, glm::vec3(0.0f), glm::mat4(1.0f), InvalidKeyFrame);
+
+	const MementoState &s = mementoHandler.undo();
+	ASSERT_TRUE(s.hasVolumeData());
+	voxel::Region modifiedRegion;
+	ASSERT_TRUE(MementoData::toVolume(volume.get(), s.data, &modifiedRegion));
+	EXPECT_EQ(voxel::Region(glm::ivec3(2, 3, 4), glm::ivec3(5, 3, 6)), modifiedRegion)
+		<< "Only the region of the changed voxels should be reported";
+	EXPECT_TRUE(voxel::isAir(volume->voxel(2, 3, 4).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(volume->voxel(5, 3, 6).getMaterial()));
+
+	ASSERT_TRUE(MementoData::toVolume(volume.get(), s.data, &modifiedRegion));
+	EXPECT_FALSE(modifiedRegion.isValid()) << "Nothing should be changed if the volume already has the voxels";
+}
+
+TEST_F(MementoHandlerTest, testMemoryBudget) {
+	core::Var::getSafe(cfg::VoxEditUndoMemory)->setVal("1");
+	core::DynamicArray<core::SharedPtr<voxel::RawVolume>> volumes;
+	uint32_t seed = 42u;
+	for (int n = 0; n < 4; ++n) {
+		core::SharedPtr<voxel::RawVolume> volume = create(64);
+		const voxel::Region &region = volume->region();
+		for (int z = 0; z <= region.getUpperZ(); ++z) {
+			for (int y = 0; y <= region.getUpperY(); ++y) {
+				for (int x = 0; x <= region.getUpperX(); ++x) {
+					seed = seed * 1664525u + 1013904223u;
+					volume->setVoxel(x, y, z, voxel::createVoxel(voxel::VoxelType::Generic, (seed >> 24) % 255 + 1));
+				}
+			}
+		}
+		const MementoType type = n == 0 ? MementoType::Modification : MementoType::SceneNodeAdded;
+		mementoHandler.markUndo(0, n, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), type, voxel::Region::InvalidRegion, glm::vec3(0.0f), glm::mat4(1.0f), 0);
+		volumes.push_back(volume);
+	}
+	mementoHandler.waitForPendingStates();
+	EXPECT_EQ(4, (int)mementoHandler.stateSize());
+	EXPECT_LE(mementoHandler.memoryUsage(), 1024u * 1024u);
+	EXPECT_TRUE(mementoHandler.states()[1].data.spilled());
+	EXPECT_FALSE(mementoHandler.state().data.spilled()) << "The current state should stay in memory";
+
+	mementoHandler.undo();
+	const MementoState &s = mementoHandler.undo();
+	EXPECT_EQ(2, s.nodeId);
+	ASSERT_TRUE(s.hasVolumeData());
+	ASSERT_FALSE(s.data.spilled());
+	voxel::RawVolume v(s.dataRegion());
+	ASSERT_TRUE(MementoData::toVolume(&v, s.data));
+	const voxel::RawVolume *expected = volumes[2].get();
+	for (int z = 0; z < 64; ++z) {
+		for (int y = 0; y < 64; ++y) {
+			for (int x = 0; x < 64; ++x) {
+				ASSERT_TRUE(expected->voxel(x, y, z).isSame(v.voxel(x, y, z)));
+			}
+		}
+	}
+	core::Var::getSafe(cfg::VoxEditUndoMemory)->setVal("512");
+}
+
+TEST_F(MementoHandlerTest, testUndoPendingState) {
+	core::SharedPtr<voxel::RawVolume> volume = create(32);
+	mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region::InvalidRegion, glm::vec3(0.0f), glm::mat4(1.0f), InvalidKeyFrame);
+	volume->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	mementoHandler.markUndo(0, 0, InvalidNodeId, "", scenegraph::SceneGraphNodeType::Model, volume.get(), MementoType::Modification, voxel::Region::InvalidRegion, glm::vec3(0.0f), glm::mat4(1.0f), InvalidKeyFrame);
+	// the volume is changed after the state was added - the state must not see this
+	volume->setVoxel(3, 2, 1, voxel::createVoxel(voxel::VoxelType::Generic, 2));
+	const MementoState &s = mementoHandler.undo();
+	ASSERT_TRUE(s.hasVolumeData());
+	ASSERT_FALSE(s.data.pending());
+	voxel::RawVolume v(s.dataRegion());
+	ASSERT_TRUE(MementoData::toVolume(&v, s.data));
+	EXPECT_TRUE(voxel::isAir(v.voxel(1, 2, 3).getMaterial()));
+	EXPECT_TRUE(voxel::isAir(v.voxel(3, 2, 1).getMaterial()));
+	const MementoState &r = mementoHandler.redo();
+	ASSERT_TRUE(MementoData::toVolume(&v, r.data));
+	EXPECT_EQ(1, v.voxel(1, 2, 3).getColor());
+	EXPECT_TRUE(voxel::isAir(v.voxel(3, 2, 1).getMaterial()));
+}
+
 #if 0
 // TODO
 TEST_F(MementoHandlerTest, testSceneNodeRenamed) {
@@ -0,0 +1,142 @@
+/**
+ * @file
+ */
+
+#include "../MementoJournal.h"
+#include "../MementoHandler.h"
+#include "app/tests/AbstractTest.h"
+#include "io/Filesystem.h"
+#include "scenegraph/SceneGraph.h"
+#include "scenegraph/SceneGraphNode.h"
+#include "voxel/RawVolume.h"
+
+namespace voxedit {
+
+class MementoJournalTest : public app::AbstractTest {
+protected:
+	MementoHandler mementoHandler;
+	MementoJournal journal;
+	const core::String sceneFile = "mementojournaltest.vengi";
+
+	int createSceneGraph(scenegraph::SceneGraph &sceneGraph) const {
+		scenegraph::SceneGraphNode group(scenegraph::SceneGraphNodeType::Group);
+		group.setName("group");
+		const int groupId = sceneGraph.emplace(core::move(group));
+		scenegraph::SceneGraphNode node;
+		node.setVolume(new voxel::RawVolume(voxel::Region(0, 3)), true);
+		node.setName("model");
+		return sceneGraph.emplace(core::move(node), groupId);
+	}
+
+	void writeSceneFile() {
+		const io::FilePtr &file = io::filesystem()->open(sceneFile, io::FileMode::SysWrite);
+		const uint8_t data[] = {1, 2, 3, 4};
+		ASSERT_EQ((long)sizeof(data), file->write(data, sizeof(data)));
+		file->close();
+	}
+
+	void SetUp() override {
+		app::AbstractTest::SetUp();
+		ASSERT_TRUE(mementoHandler.init());
+		ASSERT_TRUE(journal.init());
+		writeSceneFile();
+	}
+
+	void TearDown() override {
+		mementoHandler.setJournal(nullptr);
+		journal.stop();
+		journal.shutdown();
+		mementoHandler.shutdown();
+		io::filesystem()->removeFile(MementoJournal::journalPath(sceneFile));
+		io::filesystem()->removeFile(sceneFile);
+		app::AbstractTest::TearDown();
+	}
+};
+
+TEST_F(MementoJournalTest, testAppendAndLoad) {
+	scenegraph::SceneGraph sceneGraph;
+	const int nodeId = createSceneGraph(sceneGraph);
+	scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	mementoHandler.markInitialNodeState(node);
+	ASSERT_TRUE(journal.start(sceneFile, sceneGraph));
+	mementoHandler.setJournal(&journal);
+
+	node.volume()->setVoxel(1, 2, 3, voxel::createVoxel(voxel::VoxelType::Generic, 1));
+	mementoHandler.markModification(node, voxel::Region(1, 3));
+	node.setName("renamed");
+	mementoHandler.markNodeRenamed(node);
+	mementoHandler.updateJournal(true);
+	ASSERT_TRUE(journal.waitForPendingWrites());
+
+	// the node ids differ after the scene file was loaded again
+	scenegraph::SceneGraph loadedSceneGraph;
+	loadedSceneGraph.emplace(scenegraph::SceneGraphNode(scenegraph::SceneGraphNodeType::Group));
+	const int loadedNodeId = createSceneGraph(loadedSceneGraph);
+	ASSERT_NE(nodeId, loadedNodeId);
+	core::DynamicArray<MementoState> states;
+	ASSERT_FALSE(MementoJournal::load(sceneFile, loadedSceneGraph, states))
+		<< "The node structure of the scene graph differs";
+
+	scenegraph::SceneGraph sameSceneGraph;
+	const int sameNodeId = createSceneGraph(sameSceneGraph);
+	ASSERT_TRUE(MementoJournal::load(sceneFile, sameSceneGraph, states));
+	ASSERT_EQ(2, (int)states.size());
+	EXPECT_EQ(MementoType::Modification, states[0].type);
+	EXPECT_EQ(sameNodeId, states[0].nodeId);
+	EXPECT_TRUE(states[0].hasVolumeData());
+	EXPECT_EQ(MementoType::SceneNodeRenamed, states[1].type);
+	EXPECT_EQ("renamed", states[1].name);
+
+	const scenegraph::SceneGraphNode &sameNode = sameSceneGraph.node(sameNodeId);
+	MementoData data = states[0].data;
+	if (data.isDelta()) {
+		data = MementoData::resolveDelta(data, *sameNode.volume());
+	}
+	voxel::RawVolume volume(sameNode.region());
+	ASSERT_TRUE(MementoData::toVolume(&volume, data));
+	EXPECT_EQ(1, volume.voxel(1, 2, 3).getColor());
+}
+
+TEST_F(MementoJournalTest, testTruncatedTail) {
+	scenegraph::SceneGraph sceneGraph;
+	const int nodeId = createSceneGraph(sceneGraph);
+	scenegraph::SceneGraphNode &node = sceneGraph.node(nodeId);
+	mementoHandler.markInitialNodeState(node);
+	ASSERT_TRUE(journal.start(sceneFile, sceneGraph));
+	mementoHandler.setJournal(&journal);
+	node.setName("renamed");
+	mementoHandler.markNodeRenamed(node);
+	mementoHandler.updateJournal(true);
+	ASSERT_TRUE(journal.waitForPendingWrites());
+
+	// simulate a crash while the next entry was written
+	{
+		const core::String &path = MementoJournal::journalPath(sceneFile);
+		uint8_t *buf = nullptr;
+		const int len = io::filesystem()->open(path, io::FileMode::SysRead)->read((void **)&buf);
+		ASSERT_GT(len, 0);
+		const uint8_t tail[] = {'E', 'N', 'T', 'R', 0xff};
+		const io::FilePtr &file = io::filesystem()->open(path, io::FileMode::SysWrite);
+		file->write(buf, len);
+		file->write(tail, sizeof(tail));
+		delete[] buf;
+	}
+	core::DynamicArray<MementoState> states;
+	ASSERT_TRUE(MementoJournal::load(sceneFile, sceneGraph, states));
+	ASSERT_EQ(1, (int)states.size());
+	EXPECT_EQ("renamed", states[0].name);
+}
+
+TEST_F(MementoJournalTest, testStopOnStructuralChange) {
+	scenegraph::SceneGraph sceneGraph;
+	const int nodeId = createSceneGraph(sceneGraph);
+	mementoHandler.markInitialNodeState(sceneGraph.node(nodeId));
+	ASSERT_TRUE(journal.start(sceneFile, sceneGraph));
+	mementoHandler.setJournal(&journal);
+	mementoHandler.markNodeRemoved(sceneGraph.node(nodeId));
+	mementoHandler.updateJournal(true);
+	EXPECT_FALSE(journal.active());
+	EXPECT_FALSE(io::filesystem()->open(MementoJournal::journalPath(sceneFile), io::FileMode::SysRead)->exists());
+}
+
+} // namespace voxedit
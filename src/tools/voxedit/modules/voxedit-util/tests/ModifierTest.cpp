@@ -129,6 +129,27 @@ TEST_F(ModifierTest, testModifierSelection) {
 	modifier.shutdown();
 }
 
+TEST_F(ModifierTest, testModifierInvertSelection) {
+	const voxel::Region region(-10, 10);
+	voxel::RawVolume volume(region);
+
+	Modifier modifier;
+	ASSERT_TRUE(modifier.init());
+	select(volume, modifier, glm::ivec3(-1), glm::ivec3(1));
+	modifier.invert(voxel::Region(-3, 3));
+	EXPECT_FALSE(modifier.selections().empty());
+	for (const Selection &sel : modifier.selections()) {
+		EXPECT_FALSE(voxel::intersects(sel, voxel::Region(-1, 1)));
+	}
+
+	prepare(modifier, glm::ivec3(-3), glm::ivec3(3), ModifierType::Place);
+	modifier.aabbAction(&volume, [&] (const voxel::Region &, ModifierType, bool) {});
+	EXPECT_TRUE(voxel::isAir(volume.voxel(0, 0, 0).getMaterial()));
+	EXPECT_FALSE(voxel::isAir(volume.voxel(-3, -3, -3).getMaterial()));
+	EXPECT_FALSE(voxel::isAir(volume.voxel(2, 0, 0).getMaterial()));
+	modifier.shutdown();
+}
+
 TEST_F(ModifierTest, testCenterPositive) {
 	Modifier modifier;
 	ASSERT_TRUE(modifier.init());
@@ -149,6 +170,37 @@ TEST_F(ModifierTest, testCenterNegative) {
 	modifier.shutdown();
 }
 
+TEST_F(ModifierTest, testVoxelizeShapeMatchesAction) {
+	Modifier modifier;
+	ASSERT_TRUE(modifier.init());
+	modifier.setShapeType(ShapeType::Ellipse);
+	prepare(modifier, glm::ivec3(-4), glm::ivec3(4), ModifierType::Place);
+	const ShapeParameters &params = modifier.shapeParameters();
+	EXPECT_EQ(voxel::Region(-4, 4), params.region);
+	EXPECT_FALSE(params.mirrorRegion.isValid());
+	voxel::RawVolume *preview = Modifier::voxelizeShape(params);
+	ASSERT_NE(nullptr, preview);
+
+	voxel::RawVolume volume(voxel::Region(-6, 6));
+	EXPECT_TRUE(modifier.aabbAction(&volume, [&](const voxel::Region &, ModifierType, bool) {}));
+	const voxel::Region &region = preview->region();
+	int voxels = 0;
+	for (int z = region.getLowerZ(); z <= region.getUpperZ(); ++z) {
+		for (int y = region.getLowerY(); y <= region.getUpperY(); ++y) {
+			for (int x = region.getLowerX(); x <= region.getUpperX(); ++x) {
+				const voxel::Voxel &expected = volume.voxel(x, y, z);
+				EXPECT_TRUE(expected.isSame(preview->voxel(x, y, z))) << x << ":" << y << ":" << z;
+				if (!voxel::isAir(expected.getMaterial())) {
+					++voxels;
+				}
+			}
+		}
+	}
+	EXPECT_GT(voxels, 0);
+	delete preview;
+	modifier.shutdown();
+}
+
 TEST_F(ModifierTest, DISABLED_testPlace) {
 	// TODO: implement me
 }
@@ -4,6 +4,7 @@
 
 #include "../SceneManager.h"
 #include "../Config.h"
+#include "io/Filesystem.h"
 #include "video/tests/AbstractGLTest.h"
 #include "voxel/RawVolume.h"
 #include "voxelrender/RawVolumeRenderer.h"
@@ -287,6 +288,24 @@ TEST_F(SceneManagerTest, testCopyPaste) {
 	EXPECT_EQ(1, testVolume()->voxel(0, 0, 0).getColor());
 }
 
+TEST_F(SceneManagerTest, testRunScript) {
+	const core::String script = R"(
+		function main(node, region, color)
+			node:volume():setVoxel(0, 0, 0, color)
+			node:volume():setVoxel(1, 1, 1, color)
+		end
+	)";
+	EXPECT_EQ(1u, mementoHandler().stateSize());
+	ASSERT_TRUE(runScript(script, {}));
+	EXPECT_FALSE(runScript(script, {})) << "Only one script should run at a time";
+	while (isScriptRunning()) {
+		update(0.0);
+	}
+	EXPECT_EQ(1, testVolume()->voxel(0, 0, 0).getColor());
+	EXPECT_EQ(1, testVolume()->voxel(1, 1, 1).getColor());
+	EXPECT_EQ(2u, mementoHandler().stateSize());
+}
+
 TEST_F(SceneManagerTest, testMergeSimple) {
 	int secondNodeId = addModelChild("second node", 10, 10, 10);
 	int thirdNodeId = addModelChild("third node", 10, 10, 10);
@@ -316,6 +335,114 @@ TEST_F(SceneManagerTest, testMergeSimple) {
 	EXPECT_EQ(nullptr, sceneGraphNode(thirdNodeId));
 }
 
+TEST_F(SceneManagerTest, testLazyLoadHiddenNode) {
+	const int visibleNodeId = sceneGraph().activeNode();
+	const int hiddenNodeId = addModelChild("hidden node", 4, 4, 4);
+	ASSERT_NE(-1, hiddenNodeId);
+	EXPECT_TRUE(nodeActivate(hiddenNodeId));
+	testSetVoxel(glm::ivec3(1, 1, 1));
+	const voxel::Region hiddenRegion = volume(hiddenNodeId)->region();
+	EXPECT_TRUE(nodeSetVisible(hiddenNodeId, false));
+	EXPECT_TRUE(nodeActivate(visibleNodeId));
+
+	io::FileDescription file;
+	file.set("testlazyload.vengi");
+	ASSERT_TRUE(save(file));
+
+	const core::VarPtr &lazyLoad = core::Var::getSafe(cfg::VoxEditLazyLoad);
+	lazyLoad->setVal(true);
+	ASSERT_TRUE(load(file));
+	while (isLoading()) {
+		update(0.0);
+	}
+	update(0.0);
+	lazyLoad->setVal(false);
+
+	int nodeId = -1;
+	for (auto iter = sceneGraph().begin(); iter != sceneGraph().end(); ++iter) {
+		if ((*iter).name() == "hidden node") {
+			nodeId = (*iter).id();
+		}
+	}
+	ASSERT_NE(-1, nodeId);
+	EXPECT_NE(hiddenRegion, sceneGraphNode(nodeId)->region()) << "The hidden node should not be loaded yet";
+
+	const voxel::RawVolume *v = volume(nodeId);
+	ASSERT_NE(nullptr, v);
+	EXPECT_EQ(hiddenRegion, v->region());
+	EXPECT_EQ(1, countVoxels(*v, modifier().cursorVoxel()));
+}
+
+TEST_F(SceneManagerTest, testCompressColdNode) {
+	const int visibleNodeId = sceneGraph().activeNode();
+	const int coldNodeId = addModelChild("cold node", 40, 40, 40);
+	ASSERT_NE(-1, coldNodeId);
+	EXPECT_TRUE(nodeActivate(coldNodeId));
+	testSetVoxel(glm::ivec3(1, 1, 1));
+	const voxel::Region coldRegion = volume(coldNodeId)->region();
+	EXPECT_TRUE(nodeSetVisible(coldNodeId, false));
+	EXPECT_TRUE(nodeActivate(visibleNodeId));
+
+	const double nowSeconds = app::App::getInstance()->timeProvider()->tickSeconds();
+	updateColdVolumes(nowSeconds);
+	EXPECT_FALSE(volumeCompressed(coldNodeId)) << "The node was used just now";
+	updateColdVolumes(nowSeconds + 3600.0);
+	ASSERT_TRUE(volumeCompressed(coldNodeId));
+	EXPECT_FALSE(volumeCompressed(visibleNodeId)) << "Visible nodes must stay in memory";
+	EXPECT_NE(coldRegion, sceneGraphNode(coldNodeId)->region());
+
+	const voxel::RawVolume *v = volume(coldNodeId);
+	ASSERT_NE(nullptr, v);
+	EXPECT_FALSE(volumeCompressed(coldNodeId));
+	EXPECT_EQ(coldRegion, v->region());
+	EXPECT_EQ(1, countVoxels(*v, modifier().cursorVoxel()));
+}
+
+TEST_F(SceneManagerTest, testRecordAndReplayActions) {
+	const core::String recording = "testrecordactions.vact";
+	ASSERT_TRUE(actionRecorder().start(recording));
+	modifier().setCursorPosition(glm::ivec3(0, 0, 0), voxel::FaceNames::NegativeX);
+	modifier().aabbStart();
+	EXPECT_EQ(1, executeModifier());
+	modifier().setCursorPosition(glm::ivec3(1, 1, 1), voxel::FaceNames::NegativeX);
+	modifier().aabbStart();
+	EXPECT_EQ(1, executeModifier());
+	EXPECT_TRUE(undo());
+	actionRecorder().stop();
+	EXPECT_EQ(1, countVoxels(*volume(sceneGraph().activeNode()), modifier().cursorVoxel()));
+
+	const voxel::Region region{0, 1};
+	ASSERT_TRUE(newScene(true, "replay", region));
+	EXPECT_EQ(0, countVoxels(*volume(sceneGraph().activeNode()), modifier().cursorVoxel()));
+	core::DynamicArray<ActionTiming> timings;
+	ASSERT_TRUE(replayActions(recording, &timings));
+	ASSERT_EQ(3u, timings.size());
+	EXPECT_EQ(ActionType::Modifier, timings[0].type);
+	EXPECT_EQ(ActionType::Undo, timings[2].type);
+	const voxel::RawVolume *v = volume(sceneGraph().activeNode());
+	EXPECT_EQ(1, countVoxels(*v, modifier().cursorVoxel()));
+	EXPECT_TRUE(voxel::isBlocked(v->voxel(0, 0, 0).getMaterial()));
+	EXPECT_FALSE(actionRecorder().active());
+	io::filesystem()->removeFile(recording);
+}
+
+TEST_F(SceneManagerTest, testStrokeSingleUndoState) {
+	const size_t states = mementoHandler().stateSize();
+	const int nodeId = sceneGraph().activeNode();
+	beginStroke();
+	for (int i = 0; i < 2; ++i) {
+		modifier().setCursorPosition(glm::ivec3(i, i, i), voxel::FaceNames::NegativeX);
+		modifier().aabbStart();
+		EXPECT_EQ(1, executeModifier());
+	}
+	EXPECT_EQ(states, mementoHandler().stateSize()) << "No undo state should be created during the stroke";
+	endStroke();
+	EXPECT_EQ(states + 1, mementoHandler().stateSize());
+	EXPECT_EQ(2, countVoxels(*volume(nodeId), modifier().cursorVoxel()));
+	EXPECT_TRUE(undo());
+	EXPECT_EQ(0, countVoxels(*volume(nodeId), modifier().cursorVoxel()));
+}
+
 TEST_F(SceneManagerTest, DISABLED_testMergeTransform) {
 	// TODO:
 }
@@ -0,0 +1,82 @@
+/**
+ * @file
+ */
+
+#include "app/tests/AbstractTest.h"
+#include "../modifier/SelectionMask.h"
+
+namespace voxedit {
+
+class SelectionMaskTest : public app::AbstractTest {
+protected:
+	int count(const SelectionMask &mask, const voxel::Region &region) {
+		int n = 0;
+		mask.visitRows(region, [&](int x1, int x2, int, int) { n += x2 - x1 + 1; });
+		return n;
+	}
+};
+
+TEST_F(SelectionMaskTest, testSelect) {
+	SelectionMask mask;
+	EXPECT_TRUE(mask.empty());
+	const voxel::Region region(-5, -3, 2, 9, 4, 12);
+	mask.select(region);
+	EXPECT_FALSE(mask.empty());
+	EXPECT_TRUE(mask.contains(-5, -3, 2));
+	EXPECT_TRUE(mask.contains(9, 4, 12));
+	EXPECT_FALSE(mask.contains(-6, -3, 2));
+	EXPECT_FALSE(mask.contains(10, 4, 12));
+	EXPECT_EQ(region, mask.bounds());
+	EXPECT_EQ(region.voxels(), count(mask, voxel::Region(-20, 20)));
+}
+
+TEST_F(SelectionMaskTest, testUnion) {
+	SelectionMask mask;
+	mask.select(voxel::Region(0, 3));
+	mask.select(voxel::Region(2, 5));
+	EXPECT_EQ(voxel::Region(0, 5), mask.bounds());
+	EXPECT_EQ(64 + 64 - 8, count(mask, voxel::Region(-20, 20)));
+	const Selections &regions = mask.toRegions();
+	int voxels = 0;
+	for (const Selection &sel : regions) {
+		voxels += sel.voxels();
+	}
+	EXPECT_EQ(64 + 64 - 8, voxels);
+}
+
+TEST_F(SelectionMaskTest, testUnselect) {
+	SelectionMask mask;
+	mask.select(voxel::Region(0, 15));
+	mask.unselect(voxel::Region(0, 15));
+	EXPECT_TRUE(mask.empty());
+	EXPECT_FALSE(mask.bounds().isValid());
+}
+
+TEST_F(SelectionMaskTest, testInvert) {
+	SelectionMask mask;
+	mask.select(voxel::Region(2, 5));
+	mask.invert(voxel::Region(0, 7));
+	EXPECT_FALSE(mask.contains(3, 3, 3));
+	EXPECT_TRUE(mask.contains(0, 0, 0));
+	EXPECT_TRUE(mask.contains(7, 7, 7));
+	EXPECT_EQ(512 - 64, count(mask, voxel::Region(0, 7)));
+	mask.invert(voxel::Region(0, 7));
+	EXPECT_EQ(voxel::Region(2, 5), mask.bounds());
+	const Selections &regions = mask.toRegions();
+	ASSERT_EQ(1u, regions.size());
+	EXPECT_EQ(voxel::Region(2, 5), regions[0]);
+}
+
+TEST_F(SelectionMaskTest, testVisitRowsAcrossBricks) {
+	SelectionMask mask;
+	mask.select(voxel::Region(-10, 0, 0, 20, 0, 0));
+	int runs = 0;
+	mask.visitRows(voxel::Region(-4, 0, 0, 30, 0, 0), [&](int x1, int x2, int, int) {
+		EXPECT_EQ(-4, x1);
+		EXPECT_EQ(20, x2);
+		++runs;
+	});
+	EXPECT_EQ(1, runs);
+}
+
+} // namespace voxedit
@@ -4,11 +4,7 @@
 
 #include "Clipboard.h"
 #include "voxedit-util/modifier/Selection.h"
-#include "voxelutil/VolumeMerger.h"
-#include "voxelutil/VolumeCropper.h"
-#include "voxel/RawVolumeWrapper.h"
 #include "core/Log.h"
-#include <glm/common.hpp>
 
 namespace voxedit {
 namespace tool {
@@ -29,33 +25,24 @@ voxel::RawVolume* cut(voxel::RawVolume *volume, const Selections &selections, vo
 	}
 
 	voxel::RawVolume* v = new voxel::RawVolume(volume, selections);
+	static constexpr voxel::Voxel AIR;
 	for (const Selection &selection : selections) {
-		const glm::ivec3& mins = selection.getLowerCorner();
-		const glm::ivec3& maxs = selection.getUpperCorner();
-		static constexpr voxel::Voxel AIR;
-		voxel::RawVolumeWrapper wrapper(volume, selection);
-		for (int32_t x = mins.x; x <= maxs.x; ++x) {
-			for (int32_t y = mins.y; y <= maxs.y; ++y) {
-				for (int32_t z = mins.z; z <= maxs.z; ++z) {
-					wrapper.setVoxel(x, y, z, AIR);
-				}
-			}
+		const voxel::Region &cleared = volume->fill(selection, AIR);
+		if (!cleared.isValid()) {
+			continue;
 		}
 		if (modifiedRegion.isValid()) {
-			modifiedRegion.accumulate(wrapper.dirtyRegion());
+			modifiedRegion.accumulate(cleared);
 		} else {
-			modifiedRegion = wrapper.dirtyRegion();
+			modifiedRegion = cleared;
 		}
 	}
 	return v;
 }
 
 void paste(voxel::RawVolume* out, const voxel::RawVolume* in, const glm::ivec3& referencePosition, voxel::Region& modifiedRegion) {
-	voxel::Region region = in->region();
-	region.shift(-region.getLowerCorner());
-	region.shift(referencePosition);
-	modifiedRegion = region;
-	voxelutil::mergeVolumes(out, in, region, in->region(), voxelutil::MergeSkipEmpty());
+	// the air of the copied volume doesn't overwrite the voxels of the target volume
+	modifiedRegion = out->copyRegion(*in, in->region(), referencePosition, true);
 	Log::debug("Pasted %s", modifiedRegion.toString().c_str());
 }
 